@@ -23,6 +23,8 @@ function config_cmake() {
     cp ../cmake/config.cmake .
     echo "set(RAF_USE_LLVM llvm-config-8)" >> config.cmake
     echo "set(RAF_USE_GTEST ON)" >> config.cmake
+    # Build the runtime library too, so its smoke test checks that it links.
+    echo "set(RAF_BUILD_RUNTIME ON)" >> config.cmake
     echo "set(CMAKE_BUILD_TYPE Release)" >> config.cmake
 
     if [[ $PLATFORM == "CPU" ]]; then
@@ -27,6 +27,10 @@ set(HIDE_PRIVATE_SYMBOLS ON)
 # RAF_USE_GTEST. Option: [ON/OFF]
 set(RAF_USE_GTEST ON)
 
+# RAF_BUILD_RUNTIME. Option: [ON/OFF]. The runtime library raf_runtime, which runs the executables
+# saved by SaveToFile with their kernel bundles, without Python and the passes.
+set(RAF_BUILD_RUNTIME OFF)
+
 # RAF_USE_CUDA. Option: [ON/OFF]
 set(RAF_USE_CUDA OFF)
 
@@ -36,6 +40,12 @@ set(RAF_CUDA_ARCH 70)
 # RAF_USE_CUBLAS. Option: [ON/OFF]
 set(RAF_USE_CUBLAS OFF)
 
+# RAF_USE_CUPTI. Option: [ON/OFF]. The CUPTI kernel timeline, which requires CUDA.
+set(RAF_USE_CUPTI OFF)
+
+# RAF_USE_CBLAS. Option: [OFF/MKL/ON/Path-To-OpenBLAS]. MKL is searched under $ENV{MKLROOT}
+set(RAF_USE_CBLAS OFF)
+
 # RAF_USE_CUDNN. Option: [ON/OFF/Path-To-CUDNN]. You may use environment variables, like $ENV{CUDNN_HOME}
 set(RAF_USE_CUDNN OFF)
 
@@ -50,3 +60,6 @@ set(RAF_USE_NCCL OFF)
 
 # RAF_USE_CUTLASS. Option: [ON/OFF].
 set(RAF_USE_CUTLASS OFF)
+
+# RAF_USE_TENSORRT. Option: [ON/OFF/Path-To-TensorRT]. It requires RAF_USE_CUDA.
+set(RAF_USE_TENSORRT OFF)
@@ -0,0 +1,28 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+##############################################################################
+# Provide:
+#  - RAF_CBLAS_INCLUDE
+#  - RAF_CBLAS_LIBRARY
+
+if (${RAF_USE_CBLAS} STREQUAL "OFF")
+  message(STATUS "Build without CPU BLAS support")
+  set(RAF_CBLAS_INCLUDE "")
+  set(RAF_CBLAS_LIBRARY "")
+elseif (${RAF_USE_CBLAS} STREQUAL "MKL")
+  find_path(RAF_CBLAS_INCLUDE mkl_cblas.h HINTS $ENV{MKLROOT} PATH_SUFFIXES include)
+  find_library(RAF_CBLAS_LIBRARY mkl_rt HINTS $ENV{MKLROOT} PATH_SUFFIXES lib lib/intel64)
+  if (NOT RAF_CBLAS_INCLUDE OR NOT RAF_CBLAS_LIBRARY)
+    message(FATAL_ERROR "Cannot find MKL. Please set MKLROOT.")
+  endif()
+  message(STATUS "Found RAF_CBLAS_LIBRARY = ${RAF_CBLAS_LIBRARY}")
+else()
+  # OpenBLAS, which is searched under the given path if RAF_USE_CBLAS is a path.
+  find_path(RAF_CBLAS_INCLUDE cblas.h HINTS ${RAF_USE_CBLAS} PATH_SUFFIXES include include/openblas)
+  find_library(RAF_CBLAS_LIBRARY openblas HINTS ${RAF_USE_CBLAS} PATH_SUFFIXES lib lib64)
+  if (NOT RAF_CBLAS_INCLUDE OR NOT RAF_CBLAS_LIBRARY)
+    message(FATAL_ERROR "Cannot find OpenBLAS")
+  endif()
+  message(STATUS "Found RAF_CBLAS_LIBRARY = ${RAF_CBLAS_LIBRARY}")
+endif()
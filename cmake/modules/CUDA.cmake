@@ -3,14 +3,18 @@
 
 # Provides:
 #  - RAF_CUDA_INCLUDE
+#  - RAF_CUDA_LIBRARY
 #
 #  See https://cmake.org/cmake/help/latest/module/FindCUDA.html
 if (${RAF_USE_CUDA} STREQUAL "OFF")
   message(STATUS "Build without CUDA")
   set(RAF_CUDA_INCLUDE "")
+  set(RAF_CUDA_LIBRARY "")
 else()
   find_package(CUDA REQUIRED)
   message(STATUS "Found CUDA ${CUDA_VERSION_STRING} at ${CUDA_TOOLKIT_ROOT_DIR}")
   set(RAF_CUDA_INCLUDE ${CUDA_INCLUDE_DIRS})
   message(STATUS "Found RAF_CUDA_INCLUDE = ${RAF_CUDA_INCLUDE}")
+  # The driver API, e.g., the virtual memory management of virtual_pool.
+  set(RAF_CUDA_LIBRARY ${CUDA_CUDA_LIBRARY})
 endif()
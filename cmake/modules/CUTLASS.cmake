@@ -73,6 +73,7 @@ function(raf_customized_cutlass_kernels)
     PRIVATE
     ${PROJECT_SOURCE_DIR}/src/op/dialect/cutlass/operation_table_ext.cu
     ${PROJECT_SOURCE_DIR}/src/op/dialect/cutlass/singleton_ext.cu
+    ${PROJECT_SOURCE_DIR}/src/op/dialect/cutlass/grouped_gemm_ext.cu
   )
 endfunction()
 
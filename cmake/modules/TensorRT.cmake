@@ -0,0 +1,42 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+##############################################################################
+# Provide:
+#  - RAF_TENSORRT_FOUND
+#  - RAF_TENSORRT_INCLUDE
+#  - RAF_TENSORRT_LIBRARY
+
+include(FindPackageHandleStandardArgs)
+if (${RAF_USE_TENSORRT} STREQUAL "OFF")
+  message(STATUS "Build without TensorRT support")
+  set(RAF_TENSORRT_FOUND FALSE)
+  set(RAF_TENSORRT_INCLUDE "")
+  set(RAF_TENSORRT_LIBRARY "")
+else()
+  if (${RAF_USE_CUDA} STREQUAL "OFF")
+    message(FATAL_ERROR "Cannot enable TensorRT without using CUDA.")
+  endif()
+
+  if (${RAF_USE_TENSORRT} STREQUAL "ON")
+    set(__hint_dir "")
+  else()
+    set(__hint_dir ${RAF_USE_TENSORRT})
+  endif()
+
+  find_path(RAF_TENSORRT_INCLUDE NvInfer.h
+    HINTS ${__hint_dir} ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES include include/x86_64-linux-gnu)
+
+  find_library(RAF_TENSORRT_LIBRARY nvinfer
+    HINTS ${__hint_dir} ${CUDA_TOOLKIT_ROOT_DIR}
+    PATH_SUFFIXES lib lib64 lib/x86_64-linux-gnu)
+
+  find_package_handle_standard_args(RAF_TENSORRT DEFAULT_MSG
+    RAF_TENSORRT_INCLUDE RAF_TENSORRT_LIBRARY)
+  if (NOT ${RAF_TENSORRT_FOUND})
+    message(FATAL_ERROR "Please specify the path to TensorRT by setting RAF_USE_TENSORRT")
+  endif()
+  message(STATUS "Found RAF_TENSORRT_INCLUDE = ${RAF_TENSORRT_INCLUDE}")
+  message(STATUS "Found RAF_TENSORRT_LIBRARY = ${RAF_TENSORRT_LIBRARY}")
+endif()
@@ -0,0 +1,93 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file include/cutlass_ext/library/grouped_gemm_ext.h
+ * \brief Grouped gemm operations, which run the gemms of all groups in one kernel launch
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cuda_runtime.h>
+#include "cutlass/library/library.h"
+
+#include "./library_ext.h"
+
+namespace cutlass {
+namespace library {
+
+/*!
+ * \brief Arguments of a grouped gemm. The rows of A (of shape [M, K]) are split into
+ * problem_count consecutive groups, whose sizes are given by the device array group_sizes.
+ * The i-th group of rows is multiplied by the i-th matrix of B (of shape [problem_count, K, N]),
+ * and D = epilogue(alpha * A_i * B_i + beta * C) is written to the same rows of D. All the
+ * matrices are row major, and C and D are of shape [M, N].
+ */
+struct GroupedGemmArgumentsExt {
+  /*! \brief The number of groups */
+  int problem_count;
+  /*! \brief The total number of rows of A */
+  int M;
+  /*! \brief The number of columns of B */
+  int N;
+  /*! \brief The reduction dimension */
+  int K;
+  /*! \brief The device array of group sizes */
+  void const* group_sizes;
+  /*! \brief Data type of group sizes, which is kS32 or kS64 */
+  NumericTypeID element_group_sizes;
+  /*! \brief Pointer to A matrix in Global Memory */
+  void const* A;
+  /*! \brief Pointer to B matrices in Global Memory */
+  void const* B;
+  /*! \brief Pointer to C matrix in Global Memory */
+  void const* C;
+  /*! \brief Pointer to D matrix in Global Memory */
+  void* D;
+  /*! \brief The alpha scalar */
+  float alpha;
+  /*! \brief The beta scalar */
+  float beta;
+  /*! \brief The number of persistent threadblocks. Use the occupancy of the device if <= 0 */
+  int threadblock_count;
+};
+
+/*! \brief A grouped gemm kernel with a fixed tile shape, data type and epilogue */
+class GroupedGemmOperationExt {
+ public:
+  virtual ~GroupedGemmOperationExt() {
+  }
+
+  /*! \brief The unique name of the kernel */
+  virtual std::string const& name() const = 0;
+
+  /*! \brief The minimum compute capability required by the kernel */
+  virtual int minimum_compute_capability() const = 0;
+
+  /*! \brief The alignment (in units of elements) required for K and N */
+  virtual int alignment() const = 0;
+
+  /*! \brief The maximum number of threadblocks of the kernel that can be resident on one SM */
+  virtual int maximum_active_blocks() const = 0;
+
+  /*! \brief The size of device workspace in bytes that holds the problem of each group */
+  virtual size_t get_workspace_size(int problem_count) const = 0;
+
+  /*! \brief Run the grouped gemm on the stream */
+  virtual Status run(GroupedGemmArgumentsExt const& args, void* workspace,
+                     cudaStream_t stream) const = 0;
+};
+
+/*!
+ * \brief Returns all the grouped gemm kernels for the given data type and epilogue.
+ * \param element Data type of A, B, C and D. The accumulation is in float.
+ * \param epilogue_math_op Epilogue operator
+ */
+std::vector<GroupedGemmOperationExt const*> const& GetGroupedGemmOperationsExt(
+    NumericTypeID element, EpilogueKindExt epilogue_math_op);
+
+}  // namespace library
+}  // namespace cutlass
@@ -0,0 +1,107 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file block_allocator.h
+ * \brief The paged block allocator of the KV caches
+ */
+#pragma once
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "./memory_pool.h"
+#include "./value.h"
+
+namespace raf {
+namespace memory_pool {
+
+/*!
+ * \brief A paged allocator of the KV caches of many concurrent sequences. The caches of all the
+ * layers are carved out of one arena allocated from the memory pool of the device, where the
+ * key (or value) cache of a layer is of (num_blocks, num_heads, block_size, head_dim), and a
+ * block holds block_size tokens of a sequence. A sequence owns a list of blocks, i.e., its row of
+ * the block table, which grows by a block at a time, so a sequence only holds the memory of the
+ * tokens it has, instead of a contiguous cache of the max length.
+ */
+class BlockAllocatorObj : public ir::Object {
+ public:
+  /*! \brief The device of the caches. */
+  Device device;
+  /*! \brief The number of the blocks of each cache. */
+  int64_t num_blocks;
+  /*! \brief The number of the tokens of a block. */
+  int64_t block_size;
+  /*! \brief The key and value caches of the layers, i.e., [k0, v0, k1, v1, ...]. */
+  ir::Array<value::Value> caches;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("num_blocks", &num_blocks);
+    v->Visit("block_size", &block_size);
+    v->Visit("caches", &caches);
+  }
+
+  /*!
+   * \brief Make the sequence own enough blocks for the given number of tokens. The blocks are
+   * all or nothing: nothing is allocated if the free blocks are not enough.
+   * \param seq_id The id of the sequence, which is added if it is new.
+   * \param num_tokens The number of the tokens of the sequence.
+   * \return Whether the blocks are allocated.
+   */
+  bool Reserve(int64_t seq_id, int64_t num_tokens);
+
+  /*!
+   * \brief Release the blocks of the sequence, which are reused by the other sequences.
+   * \param seq_id The id of the sequence.
+   */
+  void Free(int64_t seq_id);
+
+  /*!
+   * \brief Get the blocks of the sequence in the order of its tokens.
+   * \param seq_id The id of the sequence.
+   * \return The blocks, which are empty for an unknown sequence.
+   */
+  std::vector<int64_t> GetBlocks(int64_t seq_id);
+
+  /*! \brief The number of the blocks that are not owned by any sequence. */
+  int64_t NumFreeBlocks();
+
+ public:
+  static constexpr const char* _type_key = "raf.memory_pool.BlockAllocator";
+  RAF_FINAL_OBJECT(BlockAllocatorObj, ir::Object);
+
+ private:
+  /*! \brief The arena holding all the caches. */
+  std::shared_ptr<Memory> arena_;
+  /*! \brief The free blocks, where the last one is handed out first. */
+  std::vector<int64_t> free_blocks_;
+  /*! \brief The blocks of each sequence. */
+  std::unordered_map<int64_t, std::vector<int64_t>> tables_;
+  /*! \brief The mutex to access the blocks. */
+  std::mutex mu_;
+
+  friend class BlockAllocator;
+};
+
+class BlockAllocator : public ir::ObjectRef {
+ public:
+  /*!
+   * \brief Allocate the arena of the caches from the memory pool of the device.
+   * \param dev The device of the caches.
+   * \param num_layers The number of the layers, each of which has a key and a value cache.
+   * \param num_blocks The number of the blocks of each cache.
+   * \param block_size The number of the tokens of a block.
+   * \param num_heads The number of the attention heads.
+   * \param head_dim The dim of an attention head.
+   * \param dtype The dtype of the caches.
+   */
+  static BlockAllocator make(const Device& dev, int64_t num_layers, int64_t num_blocks,
+                             int64_t block_size, int64_t num_heads, int64_t head_dim,
+                             DType dtype);
+  RAF_MUTABLE_OBJECT_REF(BlockAllocator, ir::ObjectRef, BlockAllocatorObj);
+};
+
+}  // namespace memory_pool
+}  // namespace raf
@@ -9,11 +9,24 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <dmlc/memory_io.h>
 #include <sys/stat.h>
 #include "./file.h"
 #include "./op.h"
+#include "./remote_cache.h"
 #include "./value.h"
 
 namespace raf {
@@ -24,21 +37,132 @@ using namespace raf::value;
 
 using PackedMetricMap = Map<String, Integer>;
 
-#define RAF_APPEND_BYTES(type, nbytes, value)                               \
-  {                                                                         \
-    constexpr int NUM_BYTES = nbytes;                                       \
-    union UNION {                                                           \
-      type v;                                                               \
-      struct {                                                              \
-        uint8_t bytes[NUM_BYTES];                                           \
-      };                                                                    \
-    } u;                                                                    \
-    u.v = value;                                                            \
-    static_assert(sizeof(UNION) == sizeof(uint8_t) * NUM_BYTES, "invalid"); \
-    static_assert(sizeof(UNION) == sizeof(type), "invalid");                \
-    for (int i = 0; i < NUM_BYTES; ++i) {                                   \
-      byte_vector.push_back(u.bytes[i]);                                    \
-    }                                                                       \
+/*! \brief A 128-bit hash, e.g., of the bytes of a cache key. */
+struct Hash128 {
+  uint64_t lo = 0;
+  uint64_t hi = 0;
+
+  bool operator==(const Hash128& other) const {
+    return lo == other.lo && hi == other.hi;
+  }
+  bool operator!=(const Hash128& other) const {
+    return !(*this == other);
+  }
+
+  /*! \brief The 32-digit hex string, e.g., the name of a persistent cache entry. */
+  std::string ToString() const {
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(hi),
+             static_cast<unsigned long long>(lo));
+    return std::string(buf, 32);
+  }
+};
+
+struct Hash128Hasher {
+  size_t operator()(const Hash128& hash) const {
+    return static_cast<size_t>(hash.lo);
+  }
+};
+
+/*! \brief The finalizer of MurmurHash3, which mixes all the bits of a 64-bit word. */
+inline uint64_t HashMix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/*!
+ * \brief The streaming 128-bit hash of bytes in the way of MurmurHash3, which mixes a 64-bit word
+ * at a time into two lanes. The hash only depends on the bytes, no matter how they are split
+ * into the updates, so a key is hashed while it is built without a second pass.
+ */
+class StreamHasher128 {
+ public:
+  void Update(const void* data, size_t size) {
+    if (size == 0) {
+      return;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    length_ += size;
+    if (tail_size_ > 0) {
+      size_t n = kWordSize - tail_size_;
+      n = size < n ? size : n;
+      std::memcpy(tail_ + tail_size_, bytes, n);
+      tail_size_ += n;
+      bytes += n;
+      size -= n;
+      if (tail_size_ < kWordSize) {
+        return;
+      }
+      MixWord(tail_);
+      tail_size_ = 0;
+    }
+    for (; size >= kWordSize; bytes += kWordSize, size -= kWordSize) {
+      MixWord(bytes);
+    }
+    std::memcpy(tail_, bytes, size);
+    tail_size_ = size;
+  }
+
+  /*! \brief The hash of the bytes so far, which can be continued by more updates. */
+  Hash128 Finalize() const {
+    StreamHasher128 hasher = *this;
+    if (hasher.tail_size_ > 0) {
+      std::memset(hasher.tail_ + hasher.tail_size_, 0, kWordSize - hasher.tail_size_);
+      hasher.MixWord(hasher.tail_);
+    }
+    uint64_t h1 = hasher.h1_ ^ length_, h2 = hasher.h2_ ^ length_;
+    h1 += h2;
+    h2 += h1;
+    h1 = HashMix64(h1);
+    h2 = HashMix64(h2);
+    h1 += h2;
+    h2 += h1;
+    return Hash128{h1, h2};
+  }
+
+  static Hash128 Hash(const void* data, size_t size) {
+    StreamHasher128 hasher;
+    hasher.Update(data, size);
+    return hasher.Finalize();
+  }
+
+ private:
+  static constexpr size_t kWordSize = 8;
+
+  static inline uint64_t Rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  inline void MixWord(const uint8_t* bytes) {
+    constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+    constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+    uint64_t k;
+    std::memcpy(&k, bytes, kWordSize);
+    h1_ ^= Rotl(k * c1, 31) * c2;
+    h1_ = Rotl(h1_, 27) + h2_;
+    h1_ = h1_ * 5 + 0x52dce729;
+    h2_ ^= Rotl(k * c2, 33) * c1;
+    h2_ = Rotl(h2_, 31) + h1_;
+    h2_ = h2_ * 5 + 0x38495ab5;
+  }
+
+  uint64_t h1_ = 0;
+  uint64_t h2_ = 0;
+  /*! \brief The bytes of the partial word, which are mixed once the word is full. */
+  uint8_t tail_[kWordSize];
+  size_t tail_size_ = 0;
+  uint64_t length_ = 0;
+};
+
+#define RAF_APPEND_BYTES(type, nbytes, value)                  \
+  {                                                            \
+    static_assert(sizeof(type) == (nbytes), "invalid");        \
+    const type v_ = value;                                     \
+    Append(&v_, nbytes);                                       \
   }
 
 #define RAF_DEF_PRIMITIVE(type_code, type, nbytes)                              \
@@ -49,6 +173,11 @@ using PackedMetricMap = Map<String, Integer>;
     return *this;                                                               \
   }
 
+/*!
+ * \brief The builder of a binary cache key. The bytes are appended in bulk to an inline buffer,
+ * which only spills to the heap for long keys, and they are hashed while they are appended, so
+ * the caches look up a key by its 128-bit hash and only compare the bytes to verify a hit.
+ */
 class HashKey {
  public:
   RAF_DEF_PRIMITIVE(0, bool, 1);
@@ -74,17 +203,15 @@ class HashKey {
   }
 
   inline HashKey& operator<<(const std::vector<int64_t>& v) {
-    byte_vector.push_back(13);
-    for (int i = 0, n = v.size(); i < n; ++i) {
-      RAF_APPEND_BYTES(int64_t, 8, v[i]);
-    }
+    AppendCode(13);
+    Append(v.data(), v.size() * sizeof(int64_t));
     RAF_APPEND_BYTES(int64_t, 8, 0);
     return *this;
   }
 
   inline HashKey& operator<<(const tvm::runtime::Optional<ir::Array<value::IntValue>> v) {
     CHECK(v.defined());
-    byte_vector.push_back(13);
+    AppendCode(13);
     tvm::runtime::Array<IntValue> value = v.value();
     for (int i = 0, n = value.size(); i < n; ++i) {
       RAF_APPEND_BYTES(int64_t, 8, value[i]->value);
@@ -94,7 +221,7 @@ class HashKey {
   }
 
   inline HashKey& operator<<(const ir::TensorType& v) {
-    byte_vector.push_back(14);
+    AppendCode(14);
     RAF_APPEND_BYTES(DLDataType, 4, v->dtype);
     for (int i = 0, n = v->shape.size(); i < n; ++i) {
       int64_t dim_i;
@@ -111,11 +238,9 @@ class HashKey {
 
   inline HashKey& operator<<(const DLTensor& v) {
     // N.B.: stride and ctx are not taken into consideration
-    byte_vector.push_back(15);
+    AppendCode(15);
     RAF_APPEND_BYTES(DLDataType, 4, v.dtype);
-    for (int i = 0, n = v.ndim; i < n; ++i) {
-      RAF_APPEND_BYTES(int64_t, 8, v.shape[i]);
-    }
+    Append(v.shape, v.ndim * sizeof(int64_t));
     RAF_APPEND_BYTES(int64_t, 8, 0);
     return *this;
   }
@@ -126,99 +251,570 @@ class HashKey {
   }
 
   inline HashKey& operator<<(const std::string& v) {
-    byte_vector.push_back(16);
-    for (int i = 0, n = v.size(); i < n; ++i) {
-      RAF_APPEND_BYTES(int8_t, 1, v[i]);
-    }
+    AppendCode(16);
+    Append(v.data(), v.size());
     RAF_APPEND_BYTES(int64_t, 8, 0);
     return *this;
   }
 
   inline HashKey& operator<<(const HashKey& other) {
-    byte_vector.insert(byte_vector.end(), other.byte_vector.begin(), other.byte_vector.end());
+    Append(other.data(), other.size());
     return *this;
   }
 
-  HashKey() {
-    byte_vector.reserve(1024);
+  /*! \brief The bytes of the key. */
+  inline const uint8_t* data() const {
+    return heap_.empty() ? small_ : heap_.data();
+  }
+
+  /*! \brief The number of bytes of the key. */
+  inline size_t size() const {
+    return size_;
+  }
+
+  /*! \brief The 128-bit hash of the bytes, which is maintained while they are appended. */
+  inline Hash128 hash() const {
+    return hasher_.Finalize();
+  }
+
+  /*! \brief The bytes of the key as a string, e.g., a key of a std::unordered_map. */
+  inline std::string str() const {
+    return std::string(reinterpret_cast<const char*>(data()), size_);
   }
 
-  std::vector<uint8_t> byte_vector;
+  inline std::vector<uint8_t> bytes() const {
+    return std::vector<uint8_t>(data(), data() + size_);
+  }
+
+ private:
+  /*! \brief The capacity of the inline buffer, which holds the keys of most ops. */
+  static constexpr size_t kInlineSize = 256;
+
+  inline void AppendCode(uint8_t code) {
+    Append(&code, 1);
+  }
+
+  inline void Append(const void* bytes, size_t n) {
+    if (n == 0) {
+      return;
+    }
+    if (heap_.empty() && size_ + n <= kInlineSize) {
+      std::memcpy(small_ + size_, bytes, n);
+    } else {
+      if (heap_.empty()) {
+        heap_.reserve(std::max(2 * kInlineSize, size_ + n));
+        heap_.assign(small_, small_ + size_);
+      }
+      const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+      heap_.insert(heap_.end(), begin, begin + n);
+    }
+    size_ += n;
+    hasher_.Update(bytes, n);
+  }
+
+  /*! \brief The inline buffer of the bytes, until they spill to heap_. */
+  uint8_t small_[kInlineSize];
+  /*! \brief The bytes of a long key, which is empty until the inline buffer is full. */
+  std::vector<uint8_t> heap_;
+  size_t size_ = 0;
+  StreamHasher128 hasher_;
 };
 
 #undef RAF_DEF_PRIMITIVE
 #undef RAF_APPEND_BYTES
 
+/*!
+ * \brief A key of MetaCache, which views the bytes of a HashKey, a string or a byte vector without
+ * a copy, together with their 128-bit hash. The viewed bytes must outlive the key.
+ */
+struct MetaCacheKey {
+  MetaCacheKey(const HashKey& key)  // NOLINT(runtime/explicit)
+      : data(reinterpret_cast<const char*>(key.data())), size(key.size()), hash(key.hash()) {
+  }
+  MetaCacheKey(const std::string& key)  // NOLINT(runtime/explicit)
+      : data(key.data()), size(key.size()), hash(StreamHasher128::Hash(key.data(), key.size())) {
+  }
+  MetaCacheKey(const std::vector<uint8_t>& key)  // NOLINT(runtime/explicit)
+      : data(reinterpret_cast<const char*>(key.data())),
+        size(key.size()),
+        hash(StreamHasher128::Hash(key.data(), key.size())) {
+  }
+
+  inline bool Equals(const std::string& bytes) const {
+    return bytes.size() == size && (size == 0 || std::memcmp(bytes.data(), data, size) == 0);
+  }
+
+  inline std::string str() const {
+    return std::string(data, size);
+  }
+
+  const char* data;
+  size_t size;
+  Hash128 hash;
+};
+
+/*!
+ * \brief A thread-safe cache, which looks up a key by its 128-bit hash and compares the full bytes
+ * only to verify a hit, so a lookup neither copies the key nor hashes it again.
+ */
 template <typename T>
 class MetaCache {
  public:
   ~MetaCache() = default;
 
-  bool Has(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Has(key_str);
-  }
-
-  bool Has(const std::string& key) {
+  bool Has(const MetaCacheKey& key) {
     std::lock_guard<std::mutex> lock(mu_);
-    return cached_.count(key);
-  }
-
-  const T* Get(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Get(key_str);
+    return Find(key) != cached_.end();
   }
 
-  const T* Get(const std::string& key) {
+  const T* Get(const MetaCacheKey& key) {
     std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
+    auto iter = Find(key);
     if (iter == cached_.end()) {
       return nullptr;
     }
-    return &iter->second;
-  }
-
-  void Set(const std::vector<uint8_t>& key, T val) {
-    const std::string key_str(key.begin(), key.end());
-    Set(key_str, val);
+    return &iter->second.second;
   }
 
-  void Set(const std::string& key, T val) {
+  void Set(const MetaCacheKey& key, T val) {
     std::lock_guard<std::mutex> lock(mu_);
-    auto iter = cached_.find(key);
+    auto iter = Find(key);
     if (iter != cached_.end()) {
       LOG(FATAL) << "KeyError: The key is already cached!";
       throw;
     }
-    cached_.emplace(key, val);
+    cached_.emplace(key.hash, std::make_pair(key.str(), std::move(val)));
   }
 
  private:
-  /*! \brief The cache mapping from string key to value. */
-  std::unordered_map<std::string, T> cached_;
+  using Map = std::unordered_multimap<Hash128, std::pair<std::string, T>, Hash128Hasher>;
+
+  typename Map::iterator Find(const MetaCacheKey& key) {
+    auto range = cached_.equal_range(key.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (key.Equals(it->second.first)) {
+        return it;
+      }
+    }
+    return cached_.end();
+  }
+
+  /*!
+   * \brief The cache mapping from the key hash to the key bytes and the value. The values are
+   * stable in the nodes, so the pointers returned by Get stay valid.
+   */
+  Map cached_;
   /*! \brief The thread-safe lock. */
   std::mutex mu_;
 };
 
+/*! \brief The 64-bit FNV-1a hash of the bytes, starting from the seed. */
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0) {
+  uint64_t hash = 14695981039346656037ULL ^ seed;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+/*!
+ * \brief A key of ShardedMetaCache, which is a tag, e.g., the pc of an instruction, and the bytes
+ * it views without a copy. The hash is computed once, so a lookup followed by an insertion does
+ * not hash the bytes again. The viewed bytes must outlive the key.
+ */
+struct CacheKeyView {
+  CacheKeyView(const void* data, size_t size, uint64_t tag = 0)
+      : data(static_cast<const char*>(data)),
+        size(size),
+        tag(tag),
+        hash(HashBytes(data, size, tag * 0x9e3779b97f4a7c15ULL)) {
+  }
+  CacheKeyView(const std::vector<uint8_t>& key, uint64_t tag = 0)  // NOLINT(runtime/explicit)
+      : CacheKeyView(key.data(), key.size(), tag) {
+  }
+  CacheKeyView(const std::string& key, uint64_t tag = 0)  // NOLINT(runtime/explicit)
+      : CacheKeyView(key.data(), key.size(), tag) {
+  }
+  /*! \brief Reuse the hash of a HashKey, which is computed while the key is built. */
+  CacheKeyView(const HashKey& key, uint64_t tag = 0)  // NOLINT(runtime/explicit)
+      : data(reinterpret_cast<const char*>(key.data())),
+        size(key.size()),
+        tag(tag),
+        hash(HashMix64(key.hash().lo ^ (tag * 0x9e3779b97f4a7c15ULL))) {
+  }
+
+  const char* data;
+  size_t size;
+  uint64_t tag;
+  uint64_t hash;
+};
+
+/*!
+ * \brief A thread-safe cache for the lookups from many threads, e.g., the OpEnvs of the VMs
+ * serving the requests of dynamic shapes. The entries are sharded by their precomputed key hashes,
+ * and each shard is guarded by a reader-writer lock, so the hits of different threads neither
+ * copy the key nor contend. With a capacity, the least recently used entries are evicted by the
+ * CLOCK approximation: a hit only marks its entry as referenced under the reader lock, and an
+ * insertion to a full shard evicts the first unreferenced entry after the clock hand, which
+ * clears the marks it passes. Unlike MetaCache, the values are returned by copy, since the
+ * entries may be evicted after a lookup.
+ */
+template <typename T>
+class ShardedMetaCache {
+ public:
+  /*! \brief The callback of an evicted entry, which is called out of the locks. */
+  using FEvict = std::function<void(const std::string& key, uint64_t tag, const T& value)>;
+
+  /*!
+   * \param capacity The max number of the entries, or 0 for unbounded. It is split evenly to the
+   * shards, so the entries of a skewed shard may be evicted before the cache is full.
+   * \param num_shards The number of the shards.
+   */
+  explicit ShardedMetaCache(size_t capacity = 0, size_t num_shards = 16) : shards_(num_shards) {
+    CHECK_GT(num_shards, 0U);
+    SetCapacity(capacity);
+  }
+
+  bool Has(const CacheKeyView& key) {
+    Shard& shard = GetShard(key);
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mu);
+    return shard.Find(key) != shard.entries.end();
+  }
+
+  /*!
+   * \brief Look up a key.
+   * \param key The key.
+   * \param value The value of the key if it is found.
+   * \return Whether the key is found.
+   */
+  bool Get(const CacheKeyView& key, T* value) {
+    Shard& shard = GetShard(key);
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mu);
+    auto it = shard.Find(key);
+    if (it == shard.entries.end()) {
+      return false;
+    }
+    it->referenced.store(true, std::memory_order_relaxed);
+    *value = it->value;
+    return true;
+  }
+
+  /*!
+   * \brief Insert a value unless the key is cached, e.g., by another thread that misses the key at
+   * the same time, which may evict the other entries of the shard.
+   * \param key The key.
+   * \param value The value.
+   * \return The cached value of the key, which is the given one unless the key is cached.
+   */
+  T Set(const CacheKeyView& key, T value) {
+    Shard& shard = GetShard(key);
+    std::vector<Entry> evicted;
+    T ret;
+    {
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mu);
+      auto it = shard.Find(key);
+      if (it != shard.entries.end()) {
+        return it->value;
+      }
+      // A new entry is inserted before the hand, so it is the last to be visited.
+      auto pos = shard.entries.emplace(shard.hand, std::string(key.data, key.size), key.tag,
+                                       key.hash, std::move(value));
+      shard.index.emplace(key.hash, pos);
+      ret = pos->value;
+      size_t capacity = shard_capacity_.load(std::memory_order_relaxed);
+      while (capacity > 0 && shard.entries.size() > capacity) {
+        shard.EvictOne(pos, &evicted);
+      }
+    }
+    NotifyEvicted(&evicted);
+    return ret;
+  }
+
+  /*! \brief Remove a key. Returns whether it is cached. */
+  bool Erase(const CacheKeyView& key) {
+    Shard& shard = GetShard(key);
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mu);
+    auto it = shard.Find(key);
+    if (it == shard.entries.end()) {
+      return false;
+    }
+    shard.Remove(it);
+    return true;
+  }
+
+  /*! \brief Remove all the entries, which are not evictions. */
+  void Clear() {
+    for (auto& shard : shards_) {
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mu);
+      shard.index.clear();
+      shard.entries.clear();
+      shard.hand = shard.entries.end();
+    }
+  }
+
+  /*! \brief The number of the entries. */
+  size_t Size() {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mu);
+      size += shard.entries.size();
+    }
+    return size;
+  }
+
+  /*! \brief Set the capacity, which takes effect from the next insertion of each shard. */
+  void SetCapacity(size_t capacity) {
+    shard_capacity_ = capacity == 0 ? 0 : (capacity + shards_.size() - 1) / shards_.size();
+  }
+
+  /*! \brief Set the callback of the evicted entries. It is not thread-safe with the insertions. */
+  void SetEvictCallback(FEvict callback) {
+    evict_callback_ = std::move(callback);
+  }
+
+  /*! \brief The number of the evicted entries. */
+  uint64_t Evictions() const {
+    return evictions_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Entry {
+    Entry(std::string key, uint64_t tag, uint64_t hash, T value)
+        : key(std::move(key)), tag(tag), hash(hash), value(std::move(value)) {
+    }
+    Entry(Entry&& other)
+        : key(std::move(other.key)),
+          tag(other.tag),
+          hash(other.hash),
+          value(std::move(other.value)) {
+    }
+
+    std::string key;
+    uint64_t tag;
+    uint64_t hash;
+    T value;
+    /*! \brief Whether it is hit since the clock hand passes it. */
+    std::atomic<bool> referenced{false};
+  };
+
+  struct Shard {
+    using Iter = typename std::list<Entry>::iterator;
+
+    Iter Find(const CacheKeyView& key) {
+      auto range = index.equal_range(key.hash);
+      for (auto it = range.first; it != range.second; ++it) {
+        const Entry& entry = *it->second;
+        if (entry.tag == key.tag && entry.key.size() == key.size &&
+            std::memcmp(entry.key.data(), key.data, key.size) == 0) {
+          return it->second;
+        }
+      }
+      return entries.end();
+    }
+
+    void Remove(Iter it) {
+      auto range = index.equal_range(it->hash);
+      for (auto idx = range.first; idx != range.second; ++idx) {
+        if (idx->second == it) {
+          index.erase(idx);
+          break;
+        }
+      }
+      if (hand == it) {
+        ++hand;
+      }
+      entries.erase(it);
+    }
+
+    /*! \brief Evict the first unreferenced entry after the hand, but the one just inserted. */
+    void EvictOne(Iter inserted, std::vector<Entry>* evicted) {
+      while (true) {
+        if (hand == entries.end()) {
+          hand = entries.begin();
+        }
+        if (hand != inserted && !hand->referenced.exchange(false, std::memory_order_relaxed)) {
+          break;
+        }
+        ++hand;
+      }
+      Iter victim = hand;
+      evicted->push_back(std::move(*victim));
+      Remove(victim);
+    }
+
+    /*! \brief The entries in the clock order. */
+    std::list<Entry> entries;
+    /*! \brief The entries of each key hash. */
+    std::unordered_multimap<uint64_t, Iter> index;
+    /*! \brief The clock hand, i.e., the next entry to visit for an eviction. */
+    Iter hand = entries.end();
+    std::shared_timed_mutex mu;
+  };
+
+  inline Shard& GetShard(const CacheKeyView& key) {
+    // The high bits, since the low bits select the buckets of the index.
+    return shards_[(key.hash >> 32) % shards_.size()];
+  }
+
+  void NotifyEvicted(std::vector<Entry>* evicted) {
+    if (evicted->empty()) {
+      return;
+    }
+    evictions_.fetch_add(evicted->size(), std::memory_order_relaxed);
+    if (evict_callback_) {
+      for (const auto& entry : *evicted) {
+        evict_callback_(entry.key, entry.tag, entry.value);
+      }
+    }
+    // The evicted values are released here, out of the lock.
+    evicted->clear();
+  }
+
+  std::vector<Shard> shards_;
+  /*! \brief The max number of the entries of a shard, or 0 for unbounded. */
+  std::atomic<size_t> shard_capacity_{0};
+  std::atomic<uint64_t> evictions_{0};
+  FEvict evict_callback_;
+};
+
 class MetaCacheMetric {
  public:
   virtual std::unordered_map<std::string, size_t> GetMetric() = 0;
 };
 
+/*!
+ * \brief The salt of the persistent entry names, which is the hash of the RAF, TVM, CUDA and cuDNN
+ * versions, so the entries built by another version are never loaded but only garbage collected.
+ */
+Hash128 PersistCacheVersionSalt();
+
+/*!
+ * \brief The index of the entries in a persistent cache directory, which is an append-only log
+ * shared by the processes. A lookup only stats the index file on a miss of the entries loaded so
+ * far, instead of the entry directory of each key. Each line is one of
+ *   "+ <name> <bytes> <ms>": an entry is added;
+ *   "~ <name> <ms>": an entry is loaded, which makes it recently used;
+ * and the log is compacted by the garbage collection, which evicts the least recently used
+ * entries beyond the byte budget. The writes are serialized across the processes by a file lock.
+ */
+class PersistCacheIndex {
+ public:
+  /*! \brief Open the index of a cache directory, or close it with an empty path. */
+  void Open(const std::string& dir);
+
+  /*! \brief Whether the entry is complete, including the ones added by the other processes. */
+  bool Contains(const std::string& name);
+
+  /*! \brief Add a complete entry of the given size in bytes. */
+  void Add(const std::string& name, int64_t nbytes);
+
+  /*! \brief Mark an entry as recently used, at most once per process. */
+  void Touch(const std::string& name);
+
+  /*! \brief The total bytes of the entries. */
+  int64_t TotalBytes();
+
+  /*!
+   * \brief Remove the least recently used entries until their total bytes fit in the budget, and
+   * the temporary entries left by the crashed writers.
+   * \param budget The budget in bytes.
+   * \return The number of removed entries.
+   */
+  int Collect(int64_t budget);
+
+  /*! \brief The name of the index file in a cache directory. */
+  static constexpr const char* INDEX_FILE = "INDEX";
+  /*! \brief The prefix of the entries being written, which are renamed once complete. */
+  static constexpr const char* TEMP_PREFIX = ".tmp.";
+
+ private:
+  struct Record {
+    int64_t nbytes = 0;
+    int64_t atime = 0;
+  };
+
+  /*! \brief Parse the lines appended since the last reload. The caller holds mu_. */
+  void Reload();
+  /*! \brief Apply a line of the log. The caller holds mu_. */
+  void Apply(const std::string& line);
+  /*! \brief Append a line to the log and apply it. The caller holds mu_. */
+  void Append(const std::string& line);
+
+  std::string dir_;
+  std::unordered_map<std::string, Record> records_;
+  /*! \brief The entries touched by this process. */
+  std::unordered_set<std::string> touched_;
+  int64_t total_bytes_ = 0;
+  /*! \brief The inode of the parsed log, which is replaced by a compaction. */
+  ino_t inode_ = 0;
+  /*! \brief The bytes of the log parsed so far. */
+  off_t offset_ = 0;
+  std::mutex mu_;
+};
+
+/*!
+ * \brief The base of persistent caches, which keeps the list of all the persistent caches so
+ * they can be redirected to another directory together.
+ */
+class MetaPersistCacheBase {
+ public:
+  MetaPersistCacheBase() {
+    Registry().push_back(this);
+  }
+
+  /*!
+   * \brief Enable the persistence and store the entries under the given root directory. This is
+   * not thread-safe with the cache accesses.
+   * \param cache_root The root directory of the persistent caches. Empty to disable persistence.
+   */
+  virtual void SetPersistRoot(const std::string& cache_root) = 0;
+
+  /*!
+   * \brief Evict the least recently used persistent entries until they fit in the budget.
+   * \param budget The budget in bytes.
+   * \return The number of evicted entries.
+   */
+  virtual int CollectGarbage(int64_t budget) = 0;
+
+  /*!
+   * \brief Fetch a persistent entry from the remote tier unless it is local.
+   * \param name The name of the entry.
+   * \return Whether the entry is fetched.
+   */
+  virtual bool PrefetchRemote(const std::string& name) = 0;
+
+  /*! \brief The name of the cache, which is also its directory under the persistent root. */
+  virtual const std::string& persist_name() const = 0;
+
+  /*! \brief The list of all the persistent caches. */
+  static std::vector<MetaPersistCacheBase*>& Registry() {
+    static std::vector<MetaPersistCacheBase*> registry;
+    return registry;
+  }
+};
+
+/*!
+ * \brief A MetaCache whose entries are persisted under a directory shared by the processes. An
+ * entry is written to a temporary directory and renamed to its name once complete, so the other
+ * processes never load a partial entry. With RAF_PERSIST_CACHE_LIMIT_MB, the least recently used
+ * entries of each cache are evicted once the cache exceeds the limit. With a RemoteCache backend,
+ * the local misses are fetched from the remote tier and the new entries are uploaded to it.
+ */
 template <typename T>
-class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
+class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric, public MetaPersistCacheBase {
  public:
   MetaPersistCache(const std::string persist_name) : persist_name_(persist_name) {
+    if (const char* limit = getenv("RAF_PERSIST_CACHE_LIMIT_MB")) {
+      limit_ = std::atoll(limit) << 20;
+    }
     // Enable persistent by users.
     const char* enable_persist = getenv("RAF_PERSIST_CACHE");
-    if (enable_persist != nullptr && strcmp(enable_persist, "1") == 0) {
-      DLOG(INFO) << "Persistent for cache " << persist_name_ << " is enabled";
-      persist_ = true;
-    } else {
+    if (enable_persist == nullptr || strcmp(enable_persist, "1") != 0) {
       return;
     }
 
-    // Determine and create the directory for the cache root.
+    // Determine the directory for the cache root.
     const char* temp = getenv("RAF_PERSIST_CACHE_PATH");
     std::string cache_path;
     if (temp == nullptr) {
@@ -228,19 +824,48 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     } else {
       cache_path = std::string(temp);
     }
-    CreateDir(cache_path);
-    path_ = cache_path + "/" + persist_name_;
+    SetPersistRoot(cache_path);
+  }
+
+  void SetPersistRoot(const std::string& cache_root) final {
+    std::lock_guard<std::mutex> lock(mu_);
+    persist_ = !cache_root.empty();
+    remote_missed_.clear();
+    if (!persist_) {
+      index_.Open("");
+      return;
+    }
+    DLOG(INFO) << "Persistent for cache " << persist_name_ << " is enabled under " << cache_root;
+    CreateDir(cache_root);
+    path_ = cache_root + "/" + persist_name_;
 
     // Create the directory for this cache.
     CreateDir(path_);
+    index_.Open(path_);
+    if (limit_ > 0 && index_.TotalBytes() > limit_) {
+      AddMetric("PersistCacheEvict", index_.Collect(limit_));
+    }
   }
 
-  const T* Get(const std::vector<uint8_t>& key) {
-    const std::string key_str(key.begin(), key.end());
-    return Get(key_str);
+  int CollectGarbage(int64_t budget) final {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!persist_) {
+      return 0;
+    }
+    int evicted = index_.Collect(budget);
+    AddMetric("PersistCacheEvict", evicted);
+    return evicted;
+  }
+
+  bool PrefetchRemote(const std::string& name) final {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!persist_ || index_.Contains(name)) {
+      return false;
+    }
+    return FetchRemote(name);
   }
 
-  const T* Get(const std::string& key) {
+  virtual const T* Get(const MetaCacheKey& key) {
     AddMetric("CacheGet", 1);
 
     // Cache hit.
@@ -256,17 +881,30 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     // Cache miss, try to load from the persistent cache.
     std::lock_guard<std::mutex> lock(mu_);
 
-    auto persist_path = GetPersistPath(key);
+    auto name = HashPersistKey(key);
+    auto persist_path = path_ + "/" + name;
 
-    // Persistent cache miss.
-    if (!DirExists(persist_path)) {
+    // Persistent cache miss. An entry is indexed only after it is renamed to its name, so the
+    // entries being written by other processes are not loaded. An indexed entry may be evicted by
+    // another process since the index is loaded, which has no key file.
+    std::string persist_key;
+    if (!index_.Contains(name) || !ReadPersistKey(persist_path, &persist_key)) {
       AddMetric("PersistCacheMiss", 1);
+      if (!FetchRemote(name) || !ReadPersistKey(persist_path, &persist_key)) {
+        return nullptr;
+      }
+    }
+    // The entry is named by the key hash, so its key bytes are compared to rule out a collision.
+    if (!key.Equals(persist_key)) {
+      AddMetric("PersistCacheCollision", 1);
       return nullptr;
     }
     AddMetric("PersistCacheHit", 1);
 
     try {
       MetaCache<T>::Set(key, T::Load(persist_path));
+      index_.Touch(name);
+      RemoteCache::Get()->Record(persist_name_, name);
       return MetaCache<T>::Get(key);
     } catch (dmlc::Error& e) {
       AddMetric("PersistCacheLoadFailure", 1);
@@ -276,12 +914,7 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
     return nullptr;
   }
 
-  void Set(const std::vector<uint8_t>& key, T val) {
-    const std::string key_str(key.begin(), key.end());
-    Set(key_str, val);
-  }
-
-  void Set(const std::string& key, T val) {
+  virtual void Set(const MetaCacheKey& key, T val) {
     AddMetric("CacheSet", 1);
     MetaCache<T>::Set(key, val);
     if (!persist_) {
@@ -290,53 +923,175 @@ class MetaPersistCache : public MetaCache<T>, public MetaCacheMetric {
 
     std::lock_guard<std::mutex> lock(mu_);
 
-    auto persist_path = GetPersistPath(key);
-    CreateDir(persist_path);
+    auto name = HashPersistKey(key);
+    auto persist_path = path_ + "/" + name;
+    auto temp_path = path_ + "/" + PersistCacheIndex::TEMP_PREFIX + name + "." +
+                     std::to_string(getpid());
+    RemovePath(temp_path);
+    CreateDir(temp_path);
 
     // Persist the cache value.
     try {
-      if (!val.Save(persist_path)) {
+      if (!val.Save(temp_path)) {
         throw;
       }
     } catch (dmlc::Error& e) {
       AddMetric("PersistCacheSaveFailure", 1);
       LOG(WARNING) << "Failed to persist cache entry to " << path_ << ": " << e.what();
+      RemovePath(temp_path);
       return;
     }
-
-    std::ofstream metadata_file(persist_path + "/timestamp");
+    std::ofstream key_file(temp_path + "/" + KEY_FILE, std::ios::binary);
+    key_file.write(key.data, key.size);
+    key_file.close();
+    std::ofstream metadata_file(temp_path + "/timestamp");
     metadata_file << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
                   << std::endl;
     metadata_file.close();
+
+    // Rename the complete entry, which is atomic. It fails if another process has persisted the
+    // same key, whose entry is kept.
+    if (std::rename(temp_path.c_str(), persist_path.c_str()) != 0) {
+      RemovePath(temp_path);
+    }
+    index_.Add(name, PathBytes(persist_path));
+    remote_missed_.erase(name);
+    RemoteCache::Get()->Record(persist_name_, name);
+    RemoteCache::Get()->UploadAsync(persist_name_, name, persist_path);
+    if (limit_ > 0 && index_.TotalBytes() > limit_) {
+      AddMetric("PersistCacheEvict", index_.Collect(limit_));
+    }
+  }
+
+  /*!
+   * \brief Lock the key across the processes sharing the persistent cache, so only one of them
+   * computes the value of the key, e.g., benchmarks the algorithms, while the others wait and load
+   * the value after it is set. The key is locked until the returned object is destroyed.
+   * \param key The key to lock.
+   * \return The lock, or nullptr if the persistence is disabled.
+   */
+  std::unique_ptr<FileLock> LockKey(const MetaCacheKey& key) {
+    std::string persist_dir = GetPersistDir();
+    if (persist_dir.empty()) {
+      return nullptr;
+    }
+    return std::make_unique<FileLock>(persist_dir + "/" + HashPersistKey(key) + ".lock");
   }
 
   std::unordered_map<std::string, size_t> GetMetric() override {
+    std::lock_guard<std::mutex> lock(metric_mu_);
     return metrics_;
   }
 
- private:
-  inline std::string GetPersistPath(const std::string& key) {
-    const size_t hashed_key = std::hash<std::string>{}(key);
-    return path_ + "/" + std::to_string(hashed_key);
+  const std::string& persist_name() const final {
+    return persist_name_;
+  }
+
+ protected:
+  /*! \brief The name of the entry directory of the key in the persistent cache. */
+  static inline std::string HashPersistKey(const MetaCacheKey& key) {
+    static const Hash128 salt = PersistCacheVersionSalt();
+    uint64_t words[4] = {salt.lo, salt.hi, key.hash.lo, key.hash.hi};
+    return StreamHasher128::Hash(words, sizeof(words)).ToString();
+  }
+
+  /*! \brief The directory of this cache, or an empty string if persistence is disabled. */
+  inline std::string GetPersistDir() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return persist_ ? path_ : "";
   }
 
   inline void AddMetric(const std::string name, size_t val) {
+    std::lock_guard<std::mutex> lock(metric_mu_);
     metrics_[name] += val;
   }
 
+ private:
+  /*!
+   * \brief Fetch an entry from the remote tier into the local directory, where the keys missed
+   * by the remote tier are not fetched again. The caller holds mu_.
+   */
+  bool FetchRemote(const std::string& name) {
+    if (!RemoteCache::Get()->Enabled() || remote_missed_.count(name)) {
+      return false;
+    }
+    auto persist_path = path_ + "/" + name;
+    auto temp_path = path_ + "/" + PersistCacheIndex::TEMP_PREFIX + name + "." +
+                     std::to_string(getpid());
+    RemovePath(temp_path);
+    CreateDir(temp_path);
+    std::string persist_key;
+    if (!RemoteCache::Get()->Fetch(persist_name_, name, temp_path) ||
+        !ReadPersistKey(temp_path, &persist_key)) {
+      AddMetric("RemoteCacheMiss", 1);
+      RemovePath(temp_path);
+      remote_missed_.insert(name);
+      return false;
+    }
+    AddMetric("RemoteCacheHit", 1);
+    if (std::rename(temp_path.c_str(), persist_path.c_str()) != 0) {
+      RemovePath(temp_path);
+    }
+    index_.Add(name, PathBytes(persist_path));
+    return true;
+  }
+
+  /*! \brief Read the key bytes saved with a persisted entry. Returns whether the entry exists. */
+  static bool ReadPersistKey(const std::string& persist_path, std::string* bytes) {
+    std::ifstream key_file(persist_path + "/" + KEY_FILE, std::ios::binary);
+    if (!key_file.good()) {
+      return false;
+    }
+    bytes->assign(std::istreambuf_iterator<char>(key_file), std::istreambuf_iterator<char>());
+    return true;
+  }
+
+  /*! \brief The file of the key bytes in an entry directory. */
+  static constexpr const char* KEY_FILE = "key";
+
   /*! \brief The cache metrics for analysis. */
   std::unordered_map<std::string, size_t> metrics_;
+  /*! \brief Guard the metrics, which are updated in and out of mu_ and read by the scrapes. */
+  std::mutex metric_mu_;
   /*! \brief Persist directory name. */
   std::string persist_name_;
   /*! \brief Persist directory path. */
   std::string path_;
   /*! \brief Whether to presist values. */
   bool persist_ = false;
+  /*! \brief The index of the persisted entries. */
+  PersistCacheIndex index_;
+  /*! \brief The max bytes of the persisted entries, or 0 for unbounded. */
+  int64_t limit_ = 0;
+  /*! \brief The entries missed by the remote tier. */
+  std::unordered_set<std::string> remote_missed_;
   /*! \brief The thread-safe lock. */
   std::mutex mu_;
 };
 
 PackedMetricMap DumpMetric(const std::string& cache_name);
 
+/*!
+ * \brief Redirect all the persistent caches, i.e., the built kernels and the tuned algorithms, to
+ * the given directory, so the directory can be shipped as a kernel bundle with an executable.
+ * \param cache_root The root directory of the persistent caches. Empty to disable persistence.
+ */
+void SetPersistCacheRoot(const std::string& cache_root);
+
+/*!
+ * \brief Evict the least recently used entries of each persistent cache beyond the budget.
+ * \param budget_mb The budget of each cache in MB.
+ * \return The number of evicted entries.
+ */
+int CollectPersistCache(int64_t budget_mb);
+
+/*!
+ * \brief Fetch the entries in the remote manifest of a model fingerprint into the persistent
+ * caches, so the model is compiled without building the kernels or tuning the algorithms again.
+ * \param fingerprint The fingerprint of the model.
+ * \return The number of fetched entries.
+ */
+int PrefetchRemoteCache(const std::string& fingerprint);
+
 }  // namespace op
 }  // namespace raf
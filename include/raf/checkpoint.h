@@ -0,0 +1,106 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file checkpoint.h
+ * \brief Sharded checkpoints, where each rank writes its own shard in the background.
+ */
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./value.h"
+
+namespace raf {
+namespace distributed {
+namespace checkpoint {
+
+using value::Value;
+
+/*! \brief A checkpoint shard staged in the host memory, which is to be written to a file. */
+struct CheckpointShard {
+  /*! \brief The id of the write. */
+  int64_t id;
+  /*! \brief The path of the shard file. */
+  std::string path;
+  /*! \brief The metadata of the shard, e.g., how the states are partitioned. */
+  std::string meta;
+  /*! \brief The names of the states. */
+  std::vector<std::string> names;
+  /*! \brief The host copies of the states. */
+  std::vector<Value> values;
+};
+
+/*!
+ * \brief The writer of the checkpoint shards. The states are copied to the (pinned) host memory
+ * when saved, and the shards are written to the files by a background thread, so the training
+ * steps after the save are overlapped with the file I/O.
+ */
+class CheckpointWriter {
+ public:
+  static CheckpointWriter* Get();
+
+  /*!
+   * \brief Copy the states to the host memory, and write them to a shard file in the background.
+   * It returns once the states are copied, so they can be updated by the next training steps.
+   * The file is written to a temporary path and renamed, so a partially written shard is never
+   * seen by the readers.
+   * \param path The path of the shard file.
+   * \param meta The metadata of the shard.
+   * \param names The names of the states.
+   * \param values The states.
+   * \return The id of the write, which can be waited by Wait.
+   */
+  int64_t Save(const std::string& path, const std::string& meta,
+               const std::vector<std::string>& names, const std::vector<Value>& values);
+
+  /*!
+   * \brief Wait for a write and raise its error, if any.
+   * \param id The id of the write, or -1 to wait for all pending writes.
+   */
+  void Wait(int64_t id);
+
+ private:
+  CheckpointWriter() = default;
+
+  /*! \brief Copy the values to the host memory, where the device tensors use pinned buffers. */
+  std::vector<Value> Stage(const std::vector<Value>& values);
+
+  /*! \brief The loop of the background thread, which writes the shards in order. */
+  void Run();
+
+  /*! \brief The mutex protecting the states below. */
+  std::mutex mu_;
+  /*! \brief Notified when a shard is queued or written. */
+  std::condition_variable cv_;
+  /*! \brief The shards to be written. */
+  std::deque<CheckpointShard> queue_;
+  /*! \brief The id of the next write. */
+  int64_t next_id_ = 0;
+  /*! \brief The writes before this id are done, because the shards are written in order. */
+  int64_t done_id_ = 0;
+  /*! \brief The errors of the failed writes, which are raised by Wait. */
+  std::unordered_map<int64_t, std::string> errors_;
+  /*! \brief Whether the background thread is started. */
+  bool worker_started_ = false;
+};
+
+/*!
+ * \brief Load a shard written by CheckpointWriter, whose tensors are views of the memory-mapped
+ * file, so only the states read by the caller are paged in.
+ * \param path The path of the shard file.
+ * \param meta The metadata of the shard.
+ * \param names The names of the states.
+ * \param values The states.
+ */
+void LoadShard(const std::string& path, std::string* meta, std::vector<std::string>* names,
+               std::vector<Value>* values);
+
+}  // namespace checkpoint
+}  // namespace distributed
+}  // namespace raf
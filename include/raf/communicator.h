@@ -38,17 +38,38 @@ using namespace raf::value;
   } while (0)
 #endif
 
+/*!
+ * \brief Whether the elastic mode is enabled, where the communicators can be rebuilt for a new
+ * world, so the communication errors are raised instead of terminating the process.
+ */
+bool IsElasticMode();
+
 #ifdef RAF_USE_NCCL
 #define NCCL_CALL(cmd)                                                                            \
   do {                                                                                            \
     ncclResult_t e = cmd;                                                                         \
     if (e != ncclSuccess) {                                                                       \
+      if (::raf::distributed::communicator::IsElasticMode()) {                                    \
+        LOG(FATAL) << "NCCLError: " << __FILE__ << ":" << __LINE__ << ncclGetErrorString(e);      \
+      }                                                                                           \
       LOG(INFO) << "Failed: NCCL error " << __FILE__ << ":" << __LINE__ << ncclGetErrorString(e); \
       exit(EXIT_FAILURE);                                                                         \
     }                                                                                             \
   } while (0)
 #endif
 
+/*! \brief The locality of the device of a rank, which decides the bandwidth between ranks. */
+struct RankTopology {
+  /*! \brief The id of the device on its host. */
+  int32_t device_id = -1;
+  /*! \brief The NUMA node of the device, or -1 if unknown. */
+  int32_t numa_node = -1;
+  /*! \brief Whether a NIC is attached to the NUMA node of the device. */
+  int32_t nic_affinity = 0;
+  /*! \brief The bitmask of the devices on the same host that are connected by NVLink. */
+  uint64_t nvlink_mask = 0;
+};
+
 class CommunicatorObj : public Object {
  public:
   int local_size;
@@ -61,6 +82,8 @@ class CommunicatorObj : public Object {
   int group_id;
   int group_size;
   std::vector<uint64_t> host_ids;
+  /*! \brief The topology of each rank, or empty if it is not discovered. */
+  std::vector<RankTopology> topology;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("local_size", &local_size);
@@ -76,6 +99,13 @@ class CommunicatorObj : public Object {
 
   virtual ~CommunicatorObj() = default;
 
+  /*!
+   * \brief Release the resources of the communicator without synchronizing with the other
+   * ranks, which may have failed. The communicator cannot be used afterwards.
+   */
+  virtual void Abort() {
+  }
+
   static constexpr const char* _type_key = "raf.distributed.Communicator";
   RAF_BASE_OBJECT(CommunicatorObj, Object);
 };
@@ -86,6 +116,15 @@ class Communicator : public ObjectRef {
   static void InitSubCommunicator(CommunicatorObj* sub_comm, const Value rank_list,
                                   const Communicator global_comm);
   static uint64_t GetHostID();
+  /*!
+   * \brief Order the ranks to form a ring with the highest bandwidth, based on the topology of
+   * the communicator. The ranks of a host stay contiguous, and the hosts keep their order.
+   * \param comm The communicator with the topology of all ranks.
+   * \param ranks The ranks to be ordered.
+   * \return The ordered ranks, which are unchanged if the topology is unknown.
+   */
+  static std::vector<int64_t> OrderRanksByTopology(const CommunicatorObj* comm,
+                                                   const std::vector<int64_t>& ranks);
 
   RAF_MUTABLE_OBJECT_REF(Communicator, ObjectRef, CommunicatorObj);
 };
@@ -143,8 +182,27 @@ class CommunicatorPool {
     comm_.clear();
   }
 
+  /*!
+   * \brief Abort and remove all communicators, so they are created again for a new world.
+   * \param generation The generation of the new world, which must be the same on all ranks of
+   * it. The communicators of different generations never exchange their unique ids.
+   */
+  void Rebuild(int generation) {
+    for (auto& it : comm_) {
+      it.second->Abort();
+    }
+    comm_.clear();
+    generation_ = generation;
+  }
+
+  /*! \brief The generation of the world that the communicators are created for. */
+  int generation() const {
+    return generation_;
+  }
+
  private:
   std::map<CommunicatorID, Communicator> comm_;
+  int generation_ = 0;
 };
 
 Communicator GetGlobalCommunicator();
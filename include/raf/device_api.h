@@ -72,6 +72,37 @@ class DeviceAPI {
     return std::make_pair(0, 0);
   };
 
+  /*!
+   * \brief Release the free memory cached by the underlying memory pool of this device back to
+   * the system, if applicable.
+   * \return The number of bytes released.
+   */
+  virtual int64_t ReleaseCachedMemory() {
+    return 0;
+  }
+
+  /*!
+   * \brief Allocate managed memory, which migrates between the host and the device on demand so
+   * that the allocations can oversubscribe the device memory. It is freed by FreeMemory.
+   * \param nbytes The size of the memory in bytes.
+   * \param alignment The alignment of the memory.
+   * \return The allocated memory.
+   */
+  virtual void* AllocManagedMemory(int64_t nbytes, int64_t alignment) {
+    LOG(FATAL) << "Managed memory is not supported on this device";
+    throw;
+  }
+
+  /*!
+   * \brief Hint the driver to migrate the managed memory to the device on the given stream, so
+   * that the work on the stream does not wait for the page faults.
+   * \param ptr The managed memory.
+   * \param nbytes The number of bytes to migrate.
+   * \param stream The stream to migrate on.
+   */
+  virtual void PrefetchMemory(void* ptr, int64_t nbytes, void* stream) {
+  }
+
   /*!
    * \brief Set the device ID for memory allocation. This API is for GPU only.
    * \param dev_id The device id.
@@ -85,6 +116,30 @@ class DeviceAPI {
    */
   virtual void* CreateStream(const Device& dev) = 0;
 
+  /*!
+   * \brief Create a stream with the given priority on given device. The devices without stream
+   * priorities create a default stream.
+   * \param dev The device to create the stream.
+   * \param priority The priority of the stream. A larger value means a higher priority, and 0 is
+   * the default priority.
+   * \return The created stream.
+   */
+  virtual void* CreateStreamWithPriority(const Device& dev, int priority) {
+    return CreateStream(dev);
+  }
+
+  /*!
+   * \brief Create a stream with the given priority and flags on given device. The devices without
+   * the flags create a stream of the priority.
+   * \param dev The device to create the stream.
+   * \param priority The priority of the stream. See CreateStreamWithPriority.
+   * \param non_blocking Whether the stream does not synchronize with the default stream.
+   * \return The created stream.
+   */
+  virtual void* CreateStreamWithFlags(const Device& dev, int priority, bool non_blocking) {
+    return priority == 0 ? CreateStream(dev) : CreateStreamWithPriority(dev, priority);
+  }
+
   /*!
    * \brief Free a stream.
    * \param dev The device to free the stream.
@@ -168,6 +223,14 @@ class DeviceAPI {
    */
   virtual void WaitEvent(void* event) = 0;
 
+  /*!
+   * \brief Query whether the workloads captured by the given event have finished, without
+   * blocking the host thread.
+   * \param event The event to query.
+   * \return Whether the captured workloads have finished.
+   */
+  virtual bool QueryEvent(void* event) = 0;
+
   /*!
    * \brief The the device api of given device type
    * \param device_type The device type.
@@ -176,5 +239,42 @@ class DeviceAPI {
   static std::shared_ptr<DeviceAPI> Get(DevType device_type);
 };
 
+namespace cpu {
+
+/*!
+ * \brief Set the number of the intra-op threads of the CPU kernels launched by the calling thread,
+ * i.e., the TVM thread pool and the BLAS library. The thread pool is only rebuilt when the number
+ * changes, so this is cheap to call before every run.
+ * \param num_threads The number of threads. Non-positive means the default of the thread pool.
+ */
+void SetNumThreads(int num_threads);
+
+/*!
+ * \brief Get the number of the intra-op threads set by the calling thread.
+ * \return The number of threads, or 0 if it is not set.
+ */
+int GetNumThreads();
+
+/*!
+ * \brief Get the number of the NUMA nodes of the host.
+ * \return The number of the NUMA nodes, which is 1 if the host is not NUMA.
+ */
+int GetNumNumaNodes();
+
+/*!
+ * \brief Bind the calling thread and its intra-op threads to the cores of a NUMA node. The large
+ * CPU allocations of the thread are then placed on the node, and served by the memory pool arena
+ * of the node.
+ * \param node The NUMA node.
+ */
+void BindToNumaNode(int node);
+
+/*!
+ * \brief Get the NUMA node the calling thread is bound to.
+ * \return The NUMA node, or -1 if the thread is not bound.
+ */
+int GetNumaNode();
+
+}  // namespace cpu
 }  // namespace device_api
 }  // namespace raf
@@ -20,18 +20,34 @@ class DistConfigObj : public ir::Object {
   int iteration = 0;
   bool enable_data_parallel = false;
   int zero_opt_level = 0;
+  int zero_prefetch_depth = 1;
   bool enable_auto_dp_profiling = false;
   int auto_dp_profiling_start_iter = 2;
   int auto_dp_profiling_end_iter = 4;
   int64_t group_bucket_size = 5000000000;
+  bool enable_hierarchical_allreduce = false;
+  bool enable_topology_aware_ring = false;
+  bool enable_collective_coalescing = false;
+  std::string allreduce_compression = "none";
+  int64_t allreduce_compression_min_elements = 0;
+  double allreduce_topk_ratio = 0.01;
+  bool enable_elastic = false;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("enable_data_parallel", &enable_data_parallel);
     v->Visit("zero_opt_level", &zero_opt_level);
+    v->Visit("zero_prefetch_depth", &zero_prefetch_depth);
     v->Visit("enable_auto_dp_profiling", &enable_auto_dp_profiling);
     v->Visit("auto_dp_profiling_start_iter", &auto_dp_profiling_start_iter);
     v->Visit("auto_dp_profiling_end_iter", &auto_dp_profiling_end_iter);
     v->Visit("group_bucket_size", &group_bucket_size);
+    v->Visit("enable_hierarchical_allreduce", &enable_hierarchical_allreduce);
+    v->Visit("enable_topology_aware_ring", &enable_topology_aware_ring);
+    v->Visit("enable_collective_coalescing", &enable_collective_coalescing);
+    v->Visit("allreduce_compression", &allreduce_compression);
+    v->Visit("allreduce_compression_min_elements", &allreduce_compression_min_elements);
+    v->Visit("allreduce_topk_ratio", &allreduce_topk_ratio);
+    v->Visit("enable_elastic", &enable_elastic);
   }
 
  public:
@@ -19,6 +19,7 @@ namespace event_pool {
 using namespace device_api;
 
 class EventPool;
+class ThreadEventCache;
 
 /*!
  * \brief A representation of event on a device. The events can be used to describe the dependency
@@ -63,7 +64,8 @@ class EventPool {
 
   /*!
    * \brief Get a new event with given flags. The new event can be a new event created by device api
-   * or an event that has been recycled previously.
+   * or an event that has been recycled previously. The events recycled on the calling thread are
+   * reused first without taking the lock of the pool.
    * \param flags The flags of the event. The flags depends on the underlying device. For cuda
    * device, refers to https://docs.nvidia.com/cuda/cuda-runtime-api/group__CUDART__EVENT.html for
    * available flags.
@@ -79,8 +81,9 @@ class EventPool {
   explicit EventPool(const Device& dev);
 
   /*!
-   * \brief Recycle an event. The event will be reused later when user tries to get a new event with
-   * the same flags.
+   * \brief Recycle an event to the shared free list. The event will be reused later when user tries
+   * to get a new event with the same flags. The released events go to the free list of the
+   * releasing thread first, and only its overflow is recycled here.
    *
    * \param flags The flags of the recycled event.
    * \param event The event to be recycled.
@@ -97,6 +100,7 @@ class EventPool {
   std::mutex mutex_;
 
   friend Event;
+  friend ThreadEventCache;
 };
 
 }  // namespace event_pool
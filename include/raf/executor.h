@@ -37,6 +37,16 @@ namespace interpreter {
 value::Value Interpret(ir::Expr expr, ir::Optional<ir::IRModule> mod = {});
 value::Value InvokePrimitive(const op::CallValues& call);
 value::Value InvokeClosure(const op::CallValues& call);
+/*!
+ * \brief Enable or disable the asynchronous eager mode of the interpreter, in which the OpEnvs
+ * are executed by a worker thread and the host only waits for them when it reads the data.
+ * \param enable Whether to enable the asynchronous mode.
+ */
+void SetAsync(bool enable);
+/*! \brief Whether the asynchronous eager mode of the interpreter is enabled. */
+bool IsAsync();
+/*! \brief Wait for all the OpEnvs enqueued by the asynchronous eager mode to finish. */
+void Synchronize();
 }  // namespace interpreter
 }  // namespace executor
 }  // namespace raf
@@ -9,10 +9,15 @@
  */
 #pragma once
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <fstream>
 #include <cerrno>
 #include <cstring>
+#include <string>
 #include "dmlc/logging.h"
 
 namespace raf {
@@ -31,4 +36,106 @@ inline bool DirExists(const std::string& path) {
   ifs.close();
   return ret;
 }
+
+/*! \brief Remove a file, or a directory with all its contents. Returns whether it is removed. */
+inline bool RemovePath(const std::string& path) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) == -1) {
+    return false;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    if (DIR* dir = opendir(path.c_str())) {
+      while (struct dirent* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+          RemovePath(path + "/" + entry->d_name);
+        }
+      }
+      closedir(dir);
+    }
+    return rmdir(path.c_str()) == 0;
+  }
+  return unlink(path.c_str()) == 0;
+}
+
+/*! \brief The total size in bytes of a file, or of the files in a directory. */
+inline int64_t PathBytes(const std::string& path) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) == -1) {
+    return 0;
+  }
+  if (!S_ISDIR(st.st_mode)) {
+    return st.st_size;
+  }
+  int64_t nbytes = 0;
+  if (DIR* dir = opendir(path.c_str())) {
+    while (struct dirent* entry = readdir(dir)) {
+      if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+        nbytes += PathBytes(path + "/" + entry->d_name);
+      }
+    }
+    closedir(dir);
+  }
+  return nbytes;
+}
+
+/*! \brief Copy a file, or a directory with all its contents. Returns whether it is copied. */
+inline bool CopyPath(const std::string& src, const std::string& dst) {
+  struct stat st;
+  if (stat(src.c_str(), &st) == -1) {
+    return false;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    if (mkdir(dst.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == -1 && errno != EEXIST) {
+      return false;
+    }
+    bool copied = true;
+    if (DIR* dir = opendir(src.c_str())) {
+      while (struct dirent* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+          copied &= CopyPath(src + "/" + entry->d_name, dst + "/" + entry->d_name);
+        }
+      }
+      closedir(dir);
+    }
+    return copied;
+  }
+  std::ifstream ifs(src, std::ios::binary);
+  std::ofstream ofs(dst, std::ios::binary);
+  if (st.st_size > 0) {
+    ofs << ifs.rdbuf();
+  }
+  return ifs.good() && ofs.good();
+}
+
+/*!
+ * \brief An exclusive advisory lock of a file, which is held until the object is destroyed. It
+ * serializes the processes working on the same path, e.g., the ranks on the same node. The lock
+ * is given up with a warning if the file cannot be opened.
+ */
+class FileLock {
+ public:
+  explicit FileLock(const std::string& path) {
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+    if (fd_ == -1) {
+      LOG(WARNING) << "Failed to open lock file " << path << ": " << strerror(errno);
+      return;
+    }
+    while (flock(fd_, LOCK_EX) == -1 && errno == EINTR) {
+    }
+  }
+
+  ~FileLock() {
+    if (fd_ != -1) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+  }
+
+  FileLock(const FileLock&) = delete;
+  FileLock& operator=(const FileLock&) = delete;
+
+ private:
+  /*! \brief The file descriptor of the lock file. */
+  int fd_ = -1;
+};
 }  // namespace raf
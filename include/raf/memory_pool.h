@@ -8,16 +8,44 @@
  * \brief Memory pool API
  */
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "./device.h"
 
 namespace raf {
+namespace event_pool {
+class Event;
+}  // namespace event_pool
+
+namespace metrics {
+class Counter;
+}  // namespace metrics
+
 namespace memory_pool {
 
 class MemoryPool;
 
+/*! \brief The partition of the device memory of a tenant, and its counters. */
+struct TenantStats {
+  /*! \brief The max bytes in use. 0 means no limit. */
+  int64_t quota_bytes = 0;
+  /*! \brief The bytes kept for the tenant against the other tenants. */
+  int64_t reserved_bytes = 0;
+  /*! \brief The bytes handed out and not released yet. */
+  int64_t bytes_in_use = 0;
+  /*! \brief The high-water mark of bytes_in_use. */
+  int64_t peak_bytes_in_use = 0;
+  /*! \brief The number of requests. */
+  int64_t num_allocs = 0;
+  /*! \brief The number of requests rejected by the quota or the reservations of the others. */
+  int64_t num_rejected = 0;
+};
+
 /*!
  * \brief A wrapper for a chunk of memory, which may have shared reference to the pool so that they
  * are freed correctly. Interaction between memory pool manager also happens here.
@@ -54,6 +82,86 @@ class Memory {
 
   static MemoryPool* InitPool(const Device& dev, const std::string& name);
 
+  /*!
+   * \brief Release the free memory cached by the pool of the device, including the chunks held
+   * by the thread-local front caches of all the threads, back to the device. This also runs
+   * automatically when an allocation fails.
+   * \param dev The device of the pool.
+   * \return The number of bytes reclaimed.
+   */
+  static int64_t Compact(const Device& dev);
+
+  /*!
+   * \brief Release the memory once the events complete, e.g., the events recorded on the streams
+   * using the memory when it is freed. The memory is not handed out again until then, and it is
+   * released by the following allocations of the device after they poll the events, without
+   * synchronizing the host. Compact and the allocations failing otherwise wait for the events.
+   * \param memory The memory to release.
+   * \param events The events to complete before the memory is reused.
+   */
+  static void FreeAfter(std::shared_ptr<Memory> memory,
+                        std::vector<std::shared_ptr<event_pool::Event> > events);
+
+  /*!
+   * \brief Intern a tag, e.g., an op name, as the index of its slot in the stats of the pools.
+   * \param tag The tag.
+   * \return The index, or -1 if PoolStats::kMaxTags tags are interned already.
+   */
+  static int InternTag(const std::string& tag);
+
+  /*! \brief Get the tags interned so far, indexed by their slots. */
+  static std::vector<std::string> GetTags();
+
+  /*!
+   * \brief Record the bytes currently in use on the device as the high-water mark of the tag, if
+   * it is higher than the recorded one. It takes no lock, so the VM records the tag of each op it
+   * executes, which is interned when the OpEnv is built.
+   * \param dev The device of the pool.
+   * \param tag The index of the tag returned by InternTag. A negative index is ignored.
+   */
+  static void RecordTag(const Device& dev, int tag);
+
+  /*!
+   * \brief Set the max bytes of the thread-local front cache of each thread. The chunks released
+   * on a thread are cached there and reused by the following Alloc of the same size class on the
+   * thread without touching the pool. 0 disables the cache, which is the default unless
+   * RAF_MEMORY_THREAD_CACHE_MB is set. Stream-ordered allocations are not cached.
+   * \param nbytes The max bytes cached per thread.
+   */
+  static void SetThreadCacheSize(int64_t nbytes);
+
+  /*!
+   * \brief Set the partition of the device memory of a tenant, e.g., a model packed on a shared
+   * GPU with the others. The bytes handed out are charged to the current tenant of the allocating
+   * thread, and an allocation fails if it exceeds the quota of the tenant, or if it cuts into the
+   * reservations of the other tenants within the partition capacity of the device.
+   * \param dev The device.
+   * \param tenant The tenant.
+   * \param quota_bytes The max bytes in use by the tenant. 0 means no limit.
+   * \param reserved_bytes The bytes kept for the tenant, which requires the partition capacity.
+   */
+  static void SetTenantQuota(const Device& dev, const std::string& tenant, int64_t quota_bytes,
+                             int64_t reserved_bytes = 0);
+
+  /*!
+   * \brief Set the bytes of the device shared by the tenants, which bounds their reservations and
+   * the bytes in use by all of them. 0 means unbounded, in which case nothing can be reserved.
+   * \param dev The device.
+   * \param nbytes The partition capacity.
+   */
+  static void SetPartitionCapacity(const Device& dev, int64_t nbytes);
+
+  /*!
+   * \brief Set the tenant charged by the allocations of the calling thread. The default tenant is
+   * empty, which has no quota or reservation unless set.
+   * \param tenant The tenant.
+   * \return The previous tenant of the thread.
+   */
+  static std::string SetCurrentTenant(const std::string& tenant);
+
+  /*! \brief Get the stats of the tenants of the device, counted once it is partitioned. */
+  static std::unordered_map<std::string, TenantStats> GetTenantStats(const Device& dev);
+
  public:
   /*! \brief The pointer to the allocated chunk of memory. */
   void* data = nullptr;
@@ -61,6 +169,96 @@ class Memory {
   Device device{};
 };
 
+/*! \brief Charge the allocations of the calling thread to the tenant while it is in the scope. */
+class TenantScope {
+ public:
+  explicit TenantScope(const std::string& tenant) : prev_(Memory::SetCurrentTenant(tenant)) {
+  }
+
+  ~TenantScope() {
+    Memory::SetCurrentTenant(prev_);
+  }
+
+ private:
+  /*! \brief The tenant of the thread before the scope. */
+  std::string prev_;
+};
+
+/*!
+ * \brief The always-on counters of a memory pool. The requests are counted by the memory pool
+ * manager, and the pool counts the requests it has to serve with new memory from the device and
+ * the bytes of its chunks in use, which it returns to the counters in its own release path.
+ */
+struct PoolStats {
+  /*! \brief The number of buckets of the size histogram. Bucket i counts the requests of
+   * [2^(i-1), 2^i) bytes. */
+  static constexpr int kNumBuckets = 48;
+  /*! \brief The max number of the tags interned by Memory::InternTag. */
+  static constexpr int kMaxTags = 4096;
+
+  PoolStats() {
+    for (auto& count : size_histogram) {
+      count = 0;
+    }
+    for (auto& peak : tag_peak_bytes) {
+      peak = 0;
+    }
+  }
+
+  /*! \brief Count a request of the given bytes. */
+  void RecordAlloc(int64_t nbytes) {
+    int bucket = 0;
+    while (bucket + 1 < kNumBuckets && (int64_t(1) << bucket) <= nbytes) {
+      ++bucket;
+    }
+    size_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    num_allocs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /*! \brief Count the bytes of a chunk handed out by the pool in use. */
+  void RecordAcquire(int64_t nbytes) {
+    int64_t in_use = bytes_in_use.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+    int64_t peak = peak_bytes_in_use.load(std::memory_order_relaxed);
+    while (in_use > peak && !peak_bytes_in_use.compare_exchange_weak(peak, in_use)) {
+    }
+  }
+
+  /*! \brief Return the bytes of a chunk released to the pool. */
+  void RecordRelease(int64_t nbytes) {
+    bytes_in_use.fetch_sub(nbytes, std::memory_order_relaxed);
+  }
+
+  /*! \brief Record the given bytes in use as the high-water mark of the tag if it is higher. */
+  void RecordTag(int tag, int64_t in_use) {
+    auto& peak = tag_peak_bytes[tag];
+    int64_t prev = peak.load(std::memory_order_relaxed);
+    while (in_use > prev && !peak.compare_exchange_weak(prev, in_use)) {
+    }
+  }
+
+  /*! \brief The number of requests. */
+  std::atomic<int64_t> num_allocs{0};
+  /*! \brief The number of stream-ordered requests. */
+  std::atomic<int64_t> num_async_allocs{0};
+  /*! \brief The number of requests served by the thread-local front caches. */
+  std::atomic<int64_t> num_thread_cache_hits{0};
+  /*! \brief The number of requests served with new memory from the device. */
+  std::atomic<int64_t> num_device_allocs{0};
+  /*!
+   * \brief The bytes of the chunks handed out by the pool and not released yet, including the
+   * ones parked in the thread-local front caches.
+   */
+  std::atomic<int64_t> bytes_in_use{0};
+  /*! \brief The high-water mark of bytes_in_use. */
+  std::atomic<int64_t> peak_bytes_in_use{0};
+  /*! \brief The histogram of the requested sizes. */
+  std::atomic<int64_t> size_histogram[kNumBuckets];
+  /*! \brief The high-water mark of bytes_in_use of each tag, indexed by Memory::InternTag. */
+  std::atomic<int64_t> tag_peak_bytes[kMaxTags];
+  /*! \brief The metric of the bytes requested from the device of the pool. */
+  metrics::Counter* alloc_bytes = nullptr;
+};
+
 /*!
  * \brief A base class for memory pool.
  * Only interface for implementing new allocation strategy, no static interface is included.
@@ -124,6 +322,30 @@ class MemoryPool {
    * \return A pair of the total size of (used chunks, pool).
    */
   virtual std::pair<float, float> GetPoolSize() = 0;
+
+  /*!
+   * \brief Release the free memory cached by the pool back to the device.
+   *
+   * \return The number of bytes reclaimed.
+   */
+  virtual int64_t Compact() {
+    return 0;
+  }
+
+  /*!
+   * \brief Get the bytes in use. A pool that notices the released chunks lazily, e.g., by their
+   * reference counts, settles them first, which is not cheap, so it is called only by the queries
+   * and when a high-water mark would rise.
+   *
+   * \return The bytes in use.
+   */
+  virtual int64_t GetBytesInUse() {
+    return stats->bytes_in_use.load();
+  }
+
+  /*! \brief The counters of the pool. They are shared with the memory handed out, which may
+   * outlive the pool. */
+  std::shared_ptr<PoolStats> stats = std::make_shared<PoolStats>();
 };
 
 }  // namespace memory_pool
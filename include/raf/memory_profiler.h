@@ -8,6 +8,7 @@
  * \brief memory profiler
  */
 #pragma once
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -56,6 +57,35 @@ struct MemoryStat {
   int num_gc = 0;
 };
 
+/*!
+ * \brief The lifetime of a storage allocated by the VM, which is attributed to the instruction that
+ * allocates it, the IR vars of the storage and the tensors placed in it, and the op that writes it.
+ */
+struct TensorLifetime {
+  std::string device;
+  int64_t nbytes = 0;
+  /*! \brief The timestamps in microseconds of the profiler clock. free_us is 0 if it is alive. */
+  uint64_t alloc_us = 0;
+  uint64_t free_us = 0;
+  int64_t func_index = -1;
+  int64_t pc = -1;
+  int64_t reg = -1;
+  /*! \brief The IR var of the storage, which is empty if the executable has no register names. */
+  std::string var;
+  /*! \brief The IR vars of the tensors placed in the storage. */
+  std::vector<std::string> tensors;
+  /*! \brief The first op that writes the storage, which is empty for the inputs of no op. */
+  std::string op;
+};
+
+/*! \brief The live bytes of a device after an op is launched. */
+struct OpMemoryStep {
+  std::string device;
+  uint64_t time_us;
+  std::string op;
+  int64_t live_bytes;
+};
+
 /*! \brief The memory profiler for all devices. */
 class MemoryProfiler {
  public:
@@ -95,9 +125,62 @@ class MemoryProfiler {
    */
   std::string GetMemoryTrace(const Device& device);
 
+  /*!
+   * \brief Record a storage allocated by the VM.
+   * \param device The device of the storage.
+   * \param nbytes The size of the storage.
+   * \param data The address of the storage, which the tensors are placed by.
+   * \param func_index The VM function that allocates the storage.
+   * \param pc The pc of the allocation.
+   * \param reg The register of the storage.
+   * \param var The IR var of the storage.
+   * \return The id of the lifetime, which is passed to RecordFree.
+   */
+  int64_t RecordAlloc(const Device& device, int64_t nbytes, const void* data, int64_t func_index,
+                      int64_t pc, int64_t reg, const std::string& var);
+
+  /*! \brief Record the end of the lifetime of a storage. */
+  void RecordFree(int64_t id);
+
+  /*!
+   * \brief Record a tensor placed in a live storage.
+   * \param storage The address of the storage.
+   * \param data The address of the tensor.
+   * \param var The IR var of the tensor.
+   */
+  void RecordTensor(const void* storage, const void* data, const std::string& var);
+
+  /*!
+   * \brief Record the launch of an op, which is the producer of the outputs not written before.
+   * \param device The device of the op.
+   * \param op The name of the op.
+   * \param outputs The addresses of the output tensors.
+   */
+  void RecordOp(const Device& device, const std::string& op,
+                const std::vector<const void*>& outputs);
+
+  /*! \brief Get the lifetimes of the storages in the allocation order. */
+  std::vector<TensorLifetime> GetTensorLifetimes();
+
+  /*! \brief Get the live bytes after each op in the launch order. */
+  std::vector<OpMemoryStep> GetOpMemorySteps();
+
  private:
   /*! \brief Mapping from device string to memory stats. */
   std::unordered_map<std::string, MemoryStat> memory_stats_;
+  /*! \brief The lifetimes of the storages, whose index plus id_base_ is the id. */
+  std::vector<TensorLifetime> lifetimes_;
+  /*! \brief The number of the lifetimes before the last reset, so the stale ids are ignored. */
+  int64_t id_base_ = 0;
+  /*! \brief The lifetimes of the live storages and tensors by their addresses. */
+  std::unordered_map<const void*, int64_t> live_;
+  /*! \brief The addresses of each live lifetime, which are erased when it is freed. */
+  std::unordered_map<int64_t, std::vector<const void*>> live_addresses_;
+  /*! \brief The live bytes of each device. */
+  std::unordered_map<std::string, int64_t> live_bytes_;
+  std::vector<OpMemoryStep> op_steps_;
+  /*! \brief Guard the lifetimes, which are freed by whichever thread drops the last reference. */
+  std::mutex timeline_mu_;
   /*! \brief Whether the profiling is enabled. */
   bool is_profiling_ = false;
 };
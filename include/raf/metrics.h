@@ -0,0 +1,182 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file metrics.h
+ * \brief The always-on metrics, i.e., the counters and the summaries of the runs, the kernel
+ * launches, the memory, the caches and the communication, which are aggregated in a registry and
+ * exported in the Prometheus text format.
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./device.h"
+
+namespace raf {
+namespace event_pool {
+class Event;
+}  // namespace event_pool
+
+namespace metrics {
+
+/*! \brief The labels of a metric, e.g., {{"collective", "allreduce"}}. */
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+/*! \brief A monotonic counter, whose update is a relaxed atomic add. */
+class Counter {
+ public:
+  inline void Add(int64_t value = 1) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  inline int64_t value() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+  void Reset() {
+    value_ = 0;
+  }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+/*! \brief The count, the sum and the max of the observed values, e.g., the seconds of the runs. */
+class Summary {
+ public:
+  void Observe(double value);
+
+  inline int64_t count() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  inline double sum() const {
+    return sum_.load(std::memory_order_relaxed);
+  }
+
+  inline double max() const {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  void Reset();
+
+ private:
+  std::atomic<int64_t> count_{0};
+  std::atomic<double> sum_{0};
+  std::atomic<double> max_{0};
+};
+
+/*! \brief A value of a metric at the scrape time. */
+struct Sample {
+  /*! \brief The name of the metric family, e.g., raf_cache_hit_ratio. */
+  std::string name;
+  std::string help;
+  /*! \brief The Prometheus type of the family, i.e., counter or gauge. */
+  std::string type;
+  Labels labels;
+  double value;
+};
+
+/*!
+ * \brief The registry of the metrics. The counters and the summaries are made once, e.g., in a
+ * function-local static at the call site, and updated without locks. The collectors add the
+ * samples which are computed at the scrape time, e.g., from the cache statistics.
+ */
+class MetricsRegistry {
+ public:
+  using Collector = std::function<void(std::vector<Sample>*)>;
+
+  static MetricsRegistry* Get();
+
+  /*! \brief Get or make the counter of the name and the labels. The pointer never changes. */
+  Counter* GetCounter(const std::string& name, const std::string& help, const Labels& labels = {});
+
+  /*! \brief Get or make the summary of the name and the labels. The pointer never changes. */
+  Summary* GetSummary(const std::string& name, const std::string& help, const Labels& labels = {});
+
+  /*! \brief Add a collector, which is called at every scrape. */
+  void AddCollector(Collector collector);
+
+  /*!
+   * \brief All the samples. A summary is flattened into the samples of name_count, name_sum and
+   * name_max.
+   */
+  std::vector<Sample> Collect();
+
+  /*! \brief All the samples in the Prometheus text exposition format. */
+  std::string ExportPrometheus();
+
+  /*! \brief Reset the counters and the summaries to 0. */
+  void Reset();
+
+  /*! \brief Add a callback, which is called at the end of every step, i.e., VM run. */
+  void AddStepCallback(std::function<void()> callback);
+
+  /*! \brief Remove all the step callbacks. */
+  void ClearStepCallbacks();
+
+  /*! \brief Call the step callbacks, which is free when there is none. */
+  inline void Step() {
+    if (has_step_callbacks_.load(std::memory_order_relaxed)) {
+      RunStepCallbacks();
+    }
+  }
+
+ private:
+  MetricsRegistry() = default;
+
+  void RunStepCallbacks();
+
+  /*! \brief The metrics of a name, which are told apart by their labels. */
+  template <typename T>
+  struct Family {
+    std::string help;
+    std::map<Labels, std::unique_ptr<T>> metrics;
+  };
+
+  std::map<std::string, Family<Counter>> counters_;
+  std::map<std::string, Family<Summary>> summaries_;
+  std::vector<Collector> collectors_;
+  std::vector<std::function<void()>> step_callbacks_;
+  std::atomic<bool> has_step_callbacks_{false};
+  std::mutex mu_;
+  /*! \brief The callbacks are called out of mu_, so they can read the metrics. */
+  std::mutex step_mu_;
+};
+
+/*!
+ * \brief Time the device work between Start and Stop on the default stream without blocking the
+ * host. The elapsed time is observed into the summary once the device finishes the work, which is
+ * polled at the next Stop.
+ */
+class DeviceTimer {
+ public:
+  explicit DeviceTimer(Summary* summary) : summary_(summary) {
+  }
+
+  /*! \brief Record the start event on the default stream of the device. */
+  std::shared_ptr<event_pool::Event> Start(const Device& dev);
+
+  /*! \brief Record the end event, and observe the elapsed times of the finished work. */
+  void Stop(const Device& dev, std::shared_ptr<event_pool::Event> start);
+
+ private:
+  Summary* summary_;
+  /*! \brief The start and end events of the work that may not be finished yet. */
+  std::deque<std::pair<std::shared_ptr<event_pool::Event>, std::shared_ptr<event_pool::Event>>>
+      pending_;
+  std::mutex mu_;
+};
+
+}  // namespace metrics
+}  // namespace raf
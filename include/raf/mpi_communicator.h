@@ -19,6 +19,10 @@ namespace communicator {
 
 class MPICommunicatorObj final : public CommunicatorObj {
  public:
+  /*! \brief The MPI communicator of the ranks, which is a split of the world for a rank list. */
+  MPI_Comm mpi_comm = MPI_COMM_WORLD;
+  /*! \brief The global communicator of a sub-communicator, which keeps MPI initialized. */
+  Communicator parent_comm;
   static constexpr const char* _type_key = "raf.distributed.MPICommunicator";
   ~MPICommunicatorObj();
   RAF_FINAL_OBJECT(MPICommunicatorObj, CommunicatorObj);
@@ -22,8 +22,11 @@ class NCCLCommunicatorObj final : public CommunicatorObj {
  public:
   ncclComm_t nccl_comm;
   Communicator parent_comm;  // Prevent MPI Communicator from releasing in advanced
+  /*! \brief Whether the NCCL communicator has been aborted. */
+  bool aborted = false;
   static constexpr const char* _type_key = "raf.distributed.NCCLCommunicator";
   ~NCCLCommunicatorObj();
+  void Abort() final;
   RAF_FINAL_OBJECT(NCCLCommunicatorObj, CommunicatorObj);
 };
 
@@ -91,6 +91,8 @@ class OpEnv {
   std::shared_ptr<requests::Requests> GetRequests() const;
   /*! \brief Data input indices in the argument list. This is used by VM executor. */
   std::vector<int> arg_indices;
+  /*! \brief The tag interned from the name to record the memory peak. This is used by VM. */
+  int memory_tag = -1;
 
   /*!
    * \brief Set the stream to launch the kernels for all enabled backends
@@ -274,6 +276,15 @@ using FRAFFromRelay =
 using FRAFMutationFromRelay = registry::TypedPackedFunc<ir::Array<ir::Array<ir::Expr>>(
     const ir::Var& var, const ir::Call& call)>;
 
+/*!
+ * \brief Estimate the cost of a call analytically from the checked types of its arguments and
+ * its output, without lowering the op.
+ * \param call The call, whose arguments and output are type checked.
+ * \return The FLOPs, the bytes read and the bytes written, or empty if it cannot be estimated,
+ * e.g., when the shapes are dynamic.
+ */
+using FRAFOpCost = registry::TypedPackedFunc<ir::Array<ir::FloatImm>(const ir::Call& call)>;
+
 // Implementation
 template <class T>
 inline std::pair<bool, T> _TryRetrieveAttr(const ir::Op& op, const std::string attr_name) {
@@ -348,3 +359,6 @@ inline T GetOpAttrOrDefault(const ir::Op& op, const std::string attr_name, T def
                                                                        body);
 #define RAF_OP_GRAD_SKIP_INPUTS(op_name, body) \
   RELAY_REGISTER_OP(op_name).set_attr<std::string>("GradientInputSkip", body);
+
+#define RAF_OP_COST(op_name, body) \
+  RELAY_REGISTER_OP(op_name).set_attr<::raf::op::FRAFOpCost>("FRAFOpCost", body);
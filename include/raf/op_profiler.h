@@ -52,6 +52,37 @@ class OpWithData {
 
 using OpWithDataPtr = std::shared_ptr<OpWithData>;
 
+/*! \brief The peak compute and memory bandwidth of a device, i.e., its roofline. */
+struct DevicePeak {
+  /*! \brief The peak compute in GFLOP/s. */
+  double gflops = 0;
+  /*! \brief The peak memory bandwidth in GB/s. */
+  double gbps = 0;
+};
+
+/*! \brief An op placed on the roofline of the device by its profiled latency. */
+struct OpRoofline {
+  /*! \brief The mean profiled latency in microseconds. */
+  double latency_us = 0;
+  /*! \brief The workspace size in bytes. */
+  int64_t workspace_size = 0;
+  /*! \brief The compute estimated by its TVM compute, or 0 if it cannot be estimated. */
+  double gflop = 0;
+  /*! \brief The bytes of the inputs and the outputs, i.e., the compulsory memory traffic. */
+  int64_t bytes = 0;
+  /*! \brief The achieved GFLOP/s and GB/s. */
+  double achieved_gflops = 0;
+  double achieved_gbps = 0;
+  /*! \brief The FLOP per byte. */
+  double arithmetic_intensity = 0;
+  /*! \brief Whether the arithmetic intensity is over the ridge point of the device. */
+  bool compute_bound = false;
+  /*! \brief The latency at the roofline in microseconds, i.e., the bound of the op. */
+  double roofline_latency_us = 0;
+  /*! \brief The roofline latency over the profiled latency, which is at most 1. */
+  double efficiency = 0;
+};
+
 /*! \brief Abstract base class for a profiler to profile per-op latency during compilation. */
 class OpProfiler {
  public:
@@ -97,6 +128,29 @@ class OpProfiler {
                                                       int32_t warmup = 10, int32_t exec_number = 10,
                                                       int32_t repeat = 1);
 
+  /*!
+   * \brief Profile one op, and place it on the roofline of the device by its estimated FLOP and
+   * memory traffic.
+   * \param op The op to be profiled.
+   * \param warmup The number of warmup iterations. Default 10.
+   * \param exec_number The number of execution iterations. Default 10.
+   * \param repeat The number of repeat iterations. Default 1.
+   * \return The roofline analysis of the op.
+   */
+  OpRoofline ProfileRoofline(const Expr& op, int32_t warmup = 10, int32_t exec_number = 10,
+                             int32_t repeat = 1);
+
+  /*!
+   * \brief The roofline of the device, which is detected from the device unless it is set by
+   * SetDevicePeak, or by RAF_PEAK_GFLOPS and RAF_PEAK_GBPS.
+   */
+  DevicePeak GetDevicePeak();
+
+  /*! \brief Override the roofline of the device, e.g., of the tensor cores. */
+  void SetDevicePeak(const DevicePeak& peak) {
+    peak_ = peak;
+  }
+
   /*!
    * \brief Return the OpEnv of the given op if it has been profiled.
    * \param op The op to be queried.
@@ -111,12 +165,29 @@ class OpProfiler {
     return latency_and_workspace_size_cache_.size();
   }
 
+  /*!
+   * \brief Save the latency cache to a file, so that later compilations can reuse the measured
+   * latencies without profiling the ops again. Note that the entries of fused op closures are
+   * keyed by the closure address and only hit in the same process.
+   * \param path The file path.
+   */
+  void SaveLatencyCache(const std::string& path);
+
+  /*!
+   * \brief Load the latency cache saved by SaveLatencyCache. The loaded entries do not overwrite
+   * the ones already in the cache.
+   * \param path The file path.
+   * \return The number of loaded entries, or -1 if the file cannot be read.
+   */
+  int LoadLatencyCache(const std::string& path);
+
   /*!
    * \brief Reset the latency cache.
    */
   void Reset() {
     latency_and_workspace_size_cache_.clear();
     op_env_cache_.clear();
+    gflop_cache_.clear();
   }
 
  protected:
@@ -130,6 +201,13 @@ class OpProfiler {
   LatencyAndWorkspaceMapT latency_and_workspace_size_cache_;
   /*! \brief A cache to store built OpEnv. */
   OpEnvMapT op_env_cache_;
+  /*! \brief A cache of the estimated GFLOP of the calls, keyed by the hash of the call. */
+  std::unordered_map<std::string, float> gflop_cache_;
+  /*! \brief The roofline of the device, which is detected when its gflops is 0. */
+  DevicePeak peak_;
+
+  /*! \brief Detect the roofline of the device from its properties. */
+  virtual DevicePeak DetectDevicePeak() = 0;
 
  private:
   /*!
@@ -195,7 +273,7 @@ class OpProfiler {
   }
 
   inline std::string HashKeyToStr(const HashKey& key) {
-    return std::string(key.byte_vector.begin(), key.byte_vector.end());
+    return key.str();
   }
 
   /*!
@@ -232,6 +310,13 @@ class CPUOpProfiler : public OpProfiler {
   virtual ~CPUOpProfiler() {
   }
 
+ protected:
+  /*!
+   * \brief The roofline of the cores, assuming 2 FP32 FMAs of 8 lanes per cycle at 2.5 GHz and
+   * 10 GB/s per core, which should be set by RAF_PEAK_GFLOPS and RAF_PEAK_GBPS for the accuracy.
+   */
+  DevicePeak DetectDevicePeak() override;
+
  private:
   /*!
    * \brief The function that actually executes the op on the device.
@@ -280,6 +365,10 @@ class CUDAOpProfiler : public OpProfiler {
     }
   }
 
+ protected:
+  /*! \brief The FP32 roofline of the CUDA cores, and the bandwidth of the device memory. */
+  DevicePeak DetectDevicePeak() override;
+
  private:
   /*!
    * \brief The function that actually executes the op on the device.
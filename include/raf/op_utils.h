@@ -121,7 +121,8 @@ inline bool IsInOpSet(const Expr& op, const OpSet& op_set) {
 inline bool IsReshapeOp(const Op& op) {
   static std::unordered_set<Op, ObjectPtrHash, ObjectPtrEqual> reshape_ops{
       Op::Get("raf.op.reshape"), Op::Get("raf.op.expand_dims"), Op::Get("raf.op.squeeze"),
-      Op::Get("raf.op.batch_flatten"), Op::Get("raf.op.reshape_like")};
+      Op::Get("raf.op.batch_flatten"), Op::Get("raf.op.reshape_like"), Op::Get("raf.op.view"),
+      Op::Get("raf.op.checkpoint_boundary")};
   return IsInOpSet(op, reshape_ops);
 }
 
@@ -153,6 +154,13 @@ inline bool IsDefuseTensorOp(const Expr& op) {
   return IsInOpSet(op, defuse_tensor_ops);
 }
 
+inline bool IsDeviceCopyOp(const Expr& op) {
+  static OpSet device_copy_ops = {
+      Op::Get("raf.op.device_copy"),
+  };
+  return IsInOpSet(op, device_copy_ops);
+}
+
 inline size_t GetSizeInBytes(const DLDataType& dtype) {
   return (dtype.bits + 7) / 8;
 }
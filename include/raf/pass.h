@@ -38,12 +38,52 @@ using tvm::transform::PassNode;
  * \param pass_func The packed function that contains the optimization.
  * \param opt_level The optimization level of the function pass.
  * \param name The name of the function pass.
- * \param required The list of the passes that the function pass is dependent on.
+ * \param required The list of the passes that the function pass is dependent on, e.g.,
+ * ToANormalForm for a pass that works in ANF, which is a no-op on the functions in the form.
+ * \param parallel Whether the functions can be transformed concurrently, i.e., the pass function
+ * neither updates the module nor has unsynchronized global states. The results are merged in the
+ * order of the functions, so the module is the same as the sequential one.
  * \return The created function pass.
  */
 TVM_DLL Pass
 CreateRAFFunctionPass(const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func,
-                      int opt_level, String name, tvm::Array<String> required);
+                      int opt_level, String name, tvm::Array<String> required,
+                      bool parallel = false);
+
+/*!
+ * \brief Memoize the results of a deterministic pass across the compilations, e.g., of a
+ * hyperparameter sweep. It is enabled by a non-zero RAF_PASS_CACHE_SIZE or SetPassCacheSize.
+ * \param pass The pass to be cached.
+ * \param key The key of the parameters the pass is created with.
+ * \param config_keys The configs of the pass context read by the pass.
+ * \return The cached pass.
+ */
+Pass CachedPass(Pass pass, String key = "", tvm::Array<String> config_keys = {});
+
+/*! \brief The normal forms of the functions known to the pass manager. */
+namespace normal_form {
+constexpr const char* kANF = "ANF";
+constexpr const char* kBBNF = "BBNF";
+constexpr const char* kGNF = "GNF";
+}  // namespace normal_form
+
+/*!
+ * \brief Get whether a function is known to be in a normal form, i.e., it is the output of the
+ * conversion to the form or of a pass that keeps the form of its input. An ANF function is also
+ * in BBNF. The form is recorded on the immutable function node, so any rewrite of the function
+ * drops it, and the conversions run again on the unknown functions.
+ * \param func The function to be checked.
+ * \param form The normal form in normal_form.
+ * \return Whether the function is known to be in the form.
+ */
+bool InNormalForm(const Function& func, const std::string& form);
+
+/*!
+ * \brief Record that a function is in a normal form, so the conversions to the form skip it.
+ * \param func The function in the form.
+ * \param form The normal form in normal_form.
+ */
+void SetNormalForm(const Function& func, const std::string& form);
 
 /*!
  * \brief A special trace pass that prints the header and IR to LOG(INFO).
@@ -113,6 +153,21 @@ Pass MemoryPlan();
  */
 Pass CanonicalizeOps();
 
+/*!
+ * \brief A pass that converts the conv nets from NCHW to the given layout, and only transposes the
+ * tensors at the boundaries of the converted regions.
+ * \param layout The target layout, which can only be NHWC for now.
+ * \return The created pass.
+ */
+Pass ConvertLayout(String layout);
+
+/*!
+ * \brief A pass that prepacks the constant weights, e.g., bound by BindParam for inference, into
+ * the layouts preferred by the dispatched kernels, and folds the transposes of the constants.
+ * \return The created pass.
+ */
+Pass PrepackWeights();
+
 /*!
  * \brief Create a type inference pass.
  * \return The created pass.
@@ -151,6 +206,14 @@ Pass MergeCompilerRegions();
  */
 Pass PartitionGraph();
 
+/*!
+ * \brief Lower the functions partitioned by PartitionGraph to primitive functions whose dialect
+ * is their target, with the captured vars as parameters, so they are dispatched to the fused
+ * op of the external backend, e.g., a TensorRT engine.
+ * \return The created pass.
+ */
+Pass LowerCompilerRegions();
+
 /*!
  * \brief A pass that casts input(s) of some operators in the expression.
  * \return The created pass.
@@ -163,6 +226,26 @@ Pass AutoCast();
  */
 Pass Rematerialization();
 
+/*!
+ * \brief A pass that reorders the independent ops under the memory budget before
+ * rematerialization, so that fewer tensors have to be rematerialized.
+ * \return The created pass.
+ */
+Pass RematerializationSchedule();
+
+/*!
+ * \brief A pass that offloads activations to the host memory to reduce memory footprint.
+ * \return The created pass.
+ */
+Pass ActivationOffload();
+
+/*!
+ * \brief A pass that compresses the activations stashed for the backward to reduce memory
+ * footprint, which keeps the sign masks of the ReLU outputs or the lossy 16-bit copies.
+ * \return The created pass.
+ */
+Pass ActivationCompression();
+
 /*!
  * \brief A pass that schedules ANF for memory optimization.
  * \return The created pass.
@@ -195,6 +278,43 @@ Pass DeadCodeElimination();
  */
 Pass SimplifyExpr();
 
+/*!
+ * \brief A pass that rewrites the layout ops whose outputs are contiguous elements of their inputs,
+ * i.e., the transposes of unit dims and the contiguous slices and splits, to views that share the
+ * memory of their inputs instead of copying them.
+ * \return The created pass.
+ */
+Pass ViewPropagation();
+
+/*!
+ * \brief A pass that appends the float operands of the quantizable ops, i.e., dense, matmul_nt,
+ * batch_matmul_nt and conv2d, to the output, so their ranges can be calibrated.
+ * \return The created pass.
+ */
+Pass QuantizeCalibrate();
+
+/*!
+ * \brief A pass that rewrites the quantizable ops to the int8 ops with the calibrated scales.
+ * \param scales The scales of the two operands of each quantizable op, in the order of the
+ * operands appended by QuantizeCalibrate.
+ * \return The created pass.
+ */
+Pass QuantizeRealize(Array<FloatImm> scales);
+
+/*!
+ * \brief A pass that eliminates the redundant casts and group casts, e.g. inserted by AutoCast,
+ * so each value is cast to each dtype only once.
+ * \return The created pass.
+ */
+Pass EliminateCast();
+
+/*!
+ * \brief Rewrite the SGD of the dense gradients of embedding to the row-sparse SGD of
+ * embedding_sparse_dx, whose momentum is lazy, i.e., only decayed for the rows in the gradient.
+ * \return The created pass.
+ */
+Pass SparseEmbeddingGrad();
+
 /*! \brief Convert Relay IR to RAF IR.
  * \param disabled_pass A list of pass names to be disabled.
  * \return The created pass.
@@ -228,6 +348,15 @@ Pass AssignDevice(std::string device);
  */
 Pass LiftBranchBody();
 
+/*!
+ * \brief A pass that replaces the if nodes whose branches are small and free of side effects by
+ * running both branches and selecting the results with where, so the VM does not synchronize
+ * the device to read the condition on the host.
+ * \param max_branch_ops The max number of ops of both branches of a speculated if.
+ * \return The created pass.
+ */
+Pass SpeculateIf(int max_branch_ops = 16);
+
 /*!
  * \brief This pass is applied after Lambda lifting. Lambda lifting pass lifts the closures to
  * global scope, but the lifted global function still has the closure within. This makes AD harder.
@@ -255,6 +384,13 @@ Pass FuseTVM();
  */
 Pass DispatchDialect();
 
+/*!
+ * \brief Build the fused functions of the TVM dialect ahead of time in a pool of worker threads,
+ * which size is given by the pass config "raf.tvm.parallel_build_threads". The IR is unchanged.
+ * \return The created pass.
+ */
+Pass PrecompileTVM();
+
 /*!
  * \brief A pass that eliminates dead code.
  * \return The created pass.
@@ -318,6 +454,13 @@ Pass InlineClosure();
  */
 Pass InplaceUpdate();
 
+/*!
+ * \brief This pass marks the may_share in the variables for elementwise and broadcast ops, so the
+ * output overwrites an input of the same shape and dtype that dies at the op.
+ * \return The created pass.
+ */
+Pass ElementwiseInplaceUpdate();
+
 /*!
  * TODO(@hzfan): Update the doc for enforce_memory_share
  * \brief This pass validates and corrects the memory share annotated by the user.
@@ -342,9 +485,19 @@ Pass WavefrontStreamSchedule();
  */
 Pass ASAPStreamSchedule();
 
+/*!
+ * \brief This pass implements a memory-aware stream schedule policy, which launches parallel
+ * branches on multiple streams as long as the estimated peak memory fits into raf.memory_budget,
+ * and serializes them otherwise. It transforms BBNF into ANF and injects stream-related operators.
+ * \return The created pass.
+ */
+Pass MemoryAwareStreamSchedule();
+
 /*!
  * \brief This pass transforms BBNF into ANF and schedules operators to improve overlapping
- * between computation and communication.
+ * between computation and communication. The collectives are issued in the order they become
+ * ready (policy "fifo"), or by when their outputs are needed (policy "priority"), which is
+ * selected by the pass config raf.data_parallel_schedule.policy.
  * \return The created pass.
  */
 Pass DataParallelSchedule();
@@ -357,6 +510,14 @@ Pass DataParallelSchedule();
  */
 Pass EnforceSync();
 
+/*!
+ * \brief This pass works in ANF after the stream schedule, and removes the redundant event waits,
+ * whose dependencies are already implied by other waits, stream barriers or the stream order, and
+ * the events that are no longer waited.
+ * \return The created pass.
+ */
+Pass RemoveRedundantEvents();
+
 /*!
  * \brief This pass works in ANF and adds neccessary memory copy ops before and after
  * multi-input collectives ops to pipeline memory copies.
@@ -364,6 +525,23 @@ Pass EnforceSync();
  */
 Pass AnnotateCollectiveOps();
 
+/*!
+ * \brief This pass works in ANF after type inference. It propagates the sharding specs annotated
+ * by ShardOpCallAttrs to the unannotated ops, and inserts raf.op._reshard where the spec of a
+ * tensor differs from the spec required by its user, with the minimal estimated communication.
+ * \return The created pass.
+ */
+Pass ShardingPropagation();
+
+/*!
+ * \brief This pass works in ANF. It shards the elementwise ops, the layer norms and the dropouts
+ * after the allreduces of the row-parallel matmuls along the sequence, i.e., the first axis, and
+ * converts such an allreduce to a reduce-scatter, and gathers the chunks before the users out of
+ * the sharded regions, e.g., the column-parallel matmuls.
+ * \return The created pass.
+ */
+Pass SequenceParallel();
+
 /*!
  * \brief This pass implements IOS (Inter-Operator-Scheduler) stream schedule policy. It transforms
  * BBNF into ANF and injects stream-related operators (e.g., raf.op.set_stream, raf.op.add_event,
@@ -406,12 +584,45 @@ Pass IOSStreamSchedule();
 Pass Deduplicate(int forward_steps, bool consider_type, bool must_dominate,
                  ir::Optional<ir::String> salt);
 
+/*!
+ * \brief Outline the repeated layers of a GNF IR, e.g. the transformer layers, into a shared
+ * global function called by each layer with its own params, so the later passes and the VM
+ * compiler process one copy of the layer. The layers are found by Deduplicate considering the
+ * types, and only the patterns of at least min_size nodes are outlined, so the small patterns
+ * do not break the fusion.
+ * \param min_size The minimal number of nodes of an outlined layer.
+ * \param must_dominate Whether a layer must be dominated by its output, i.e., it has one output.
+ * \return The created pass.
+ */
+Pass OutlineLayers(int min_size, bool must_dominate);
+
 /*!
  * \brief This pass works in ANF and group allgather operators for ZeRO.
  * \return The created pass.
  */
 Pass GroupAllgather();
 
+/*!
+ * \brief This pass works in ANF and coalesces the consecutive independent collectives of the
+ * same kind into a single NCCL launch, e.g. allgathers into a group allgather.
+ * \return The created pass.
+ */
+Pass CoalesceCollectives();
+
+/*!
+ * \brief This pass works in ANF and groups the independent per-tensor scales, zeros and casts of
+ * the same kind into multi-tensor ops, which take a few kernel launches instead of one per tensor.
+ * \return The created pass.
+ */
+Pass GroupMultiTensorOps();
+
+/*!
+ * \brief This pass works in ANF and batches the independent 2-D GEMMs of the same shapes and kind
+ * into a batch_matmul, which takes one launch instead of a small launch per GEMM.
+ * \return The created pass.
+ */
+Pass BatchGemms();
+
 // Helper functions
 
 /*!
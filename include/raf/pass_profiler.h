@@ -0,0 +1,95 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file pass_profiler.h
+ * \brief The profiler of the compilation, which records the time, the IR size and the host memory
+ * before and after each pass, nested by the sequential passes.
+ */
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "./ir.h"
+
+namespace raf {
+namespace pass_profiler {
+
+using namespace raf::ir;
+
+/*! \brief A run of a pass, or another phase of the compilation, e.g., the VM codegen. */
+struct PassRecord {
+  std::string name;
+  /*! \brief The number of the enclosing records, e.g., 1 for a pass of a top-level sequential. */
+  int depth;
+  /*! \brief The timestamps in microseconds of the profiler clock. */
+  uint64_t start_us;
+  uint64_t end_us = 0;
+  /*! \brief The number of the IR nodes of the module, or -1 if it is unknown. */
+  int64_t nodes_before;
+  int64_t nodes_after = -1;
+  /*! \brief The resident memory of the process in KBs. */
+  int64_t rss_before_kb;
+  int64_t rss_after_kb = 0;
+};
+
+class PassProfiler {
+ public:
+  static PassProfiler* Get();
+
+  void SetProfile(bool profile) {
+    is_profiling_ = profile;
+  }
+
+  inline bool IsProfiling() const {
+    return is_profiling_.load(std::memory_order_relaxed);
+  }
+
+  /*! \brief Get the records in the order they start. */
+  std::vector<PassRecord> GetRecords();
+
+  /*! \brief Reset the records. */
+  void Reset();
+
+  /*!
+   * \brief Record a pass while it is in the scope. It does nothing if the profiler is off when
+   * the scope starts.
+   */
+  class Scope {
+   public:
+    /*!
+     * \param name The name of the record.
+     * \param mod The module before the pass, or an undefined one if the IR size is unknown.
+     */
+    Scope(const std::string& name, const IRModule& mod);
+    ~Scope();
+
+    /*! \brief Set the module after the pass. */
+    void SetResult(const IRModule& mod);
+
+   private:
+    /*! \brief The index of the record, or -1 if the profiler is off. */
+    int64_t index_ = -1;
+    /*! \brief The generation of the records when the scope starts. */
+    uint64_t generation_ = 0;
+    int64_t nodes_after_ = -1;
+  };
+
+ private:
+  PassProfiler() = default;
+
+  std::vector<PassRecord> records_;
+  /*! \brief The number of the resets, so the scopes started before a reset are dropped. */
+  uint64_t generation_ = 0;
+  std::atomic<bool> is_profiling_{false};
+  std::mutex mu_;
+};
+
+/*! \brief The number of the unique expression nodes of the functions in the module. */
+int64_t CountNodes(const IRModule& mod);
+
+}  // namespace pass_profiler
+}  // namespace raf
@@ -8,7 +8,6 @@
  * \brief profiler
  */
 #pragma once
-#include <dmlc/concurrentqueue.h>
 #include <cstdint>
 #include <array>
 #include <utility>
@@ -22,6 +21,7 @@
 #include <sstream>
 #include "device.h"
 #include "device_api.h"
+#include "tracer.h"
 
 #if defined(_WIN32) || defined(_WIN64) || defined(__WINDOWS__)
 #include <windows.h>
@@ -29,20 +29,19 @@
 #include <unistd.h>
 #endif
 
-#define WITH_BASE_PROFILER_LEVEL(LEVEL, DEVICE, NAME, CAT, ARGS, CODE_SNIPPET)                \
-  {                                                                                           \
-    bool _profiling = raf::profiler::Profiler::Get()->IsProfiling(LEVEL);                     \
-    if (_profiling) {                                                                         \
-      auto& _pool = raf::profiler::Profiler::Get()->HelperPool();                             \
-      auto _phelper_index = _pool.size();                                                     \
-      _pool.push_back(raf::profiler::ProfilerHelper(DEVICE.device_id(), DEVICE.device_type(), \
-                                                    NAME, CAT, ARGS));                        \
-      _pool[_phelper_index].start();                                                          \
-      CODE_SNIPPET                                                                            \
-      _pool[_phelper_index].stop();                                                           \
-    } else {                                                                                  \
-      CODE_SNIPPET                                                                            \
-    }                                                                                         \
+#define WITH_BASE_PROFILER_LEVEL(LEVEL, DEVICE, NAME, CAT, ARGS, CODE_SNIPPET)                   \
+  {                                                                                              \
+    bool _profiling = raf::profiler::Profiler::Get()->IsProfiling(LEVEL);                        \
+    if (_profiling) {                                                                            \
+      raf::profiler::ProfilerHelper _phelper(DEVICE.device_id(), DEVICE.device_type(), NAME, CAT, \
+                                             ARGS);                                              \
+      _phelper.start();                                                                          \
+      CODE_SNIPPET                                                                               \
+      _phelper.stop();                                                                           \
+      _phelper.collect();                                                                        \
+    } else {                                                                                     \
+      CODE_SNIPPET                                                                               \
+    }                                                                                            \
   }
 
 #define WITH_BASE_PROFILER(DEVICE, NAME, CAT, ARGS, CODE_SNIPPET) \
@@ -137,28 +136,19 @@ class ProfileStat {
   void EmitEvents(std::ostream* os);
 };
 
-class DeviceStats {
-  using TQueue = dmlc::moodycamel::ConcurrentQueue<ProfileStat*>;
-
- public:
-  /* data */
-  /*! \brief device name */
-  std::string dev_name_;
-  /*! \brief operation execution statistics on this device */
-  std::shared_ptr<TQueue> opr_exec_stats_ = std::make_shared<TQueue>();
-
- public:
-  ~DeviceStats();
-};
-
+/*!
+ * \brief The helper of a profiled code snippet. The strings are interned when it is made, so the
+ * event costs no allocation when it is recorded into the tracer.
+ */
 class ProfilerHelper {
  public:
-  ProfilerHelper(int dev_id, raf::DevType dev_type, std::string name, std::string categories,
-                 std::vector<std::string> args = {})
-      : device_(Device(dev_type, dev_id)),
-        name_(std::move(name)),
-        categories_(std::move(categories)),
-        args(std::move(args)) {
+  ProfilerHelper(int dev_id, raf::DevType dev_type, const std::string& name,
+                 const std::string& categories, const std::string& args = "")
+      : device_(Device(dev_type, dev_id)) {
+    auto tracer = Tracer::Get();
+    name_ = tracer->Intern(name);
+    categories_ = tracer->Intern(categories);
+    args_ = tracer->Intern(args);
     if (dev_type != raf::DevType::kUnknown()) {
       dev_api_ = device_api::DeviceAPI::Get(dev_type);
     }
@@ -169,45 +159,47 @@ class ProfilerHelper {
 
   inline void start();
   inline void stop();
+  /*! \brief Record the event into the tracer. */
   inline void collect();
 
  protected:
   /*! \brief the device on which profiled code runs */
   Device device_;
-  /*! \brief the name annotation of profiling results */
-  std::string name_;
-  /*! \brief the category annotation of profiling results */
-  std::string categories_;
+  /*! \brief the interned name annotation of profiling results */
+  uint32_t name_;
+  /*! \brief the interned category annotation of profiling results */
+  uint32_t categories_;
+  /*! \brief the interned arguments annotation */
+  uint32_t args_;
   /*! \brief profiler start time */
   uint64_t start_time_;
   /*! \brief profiler end time */
   uint64_t end_time_;
   /*! \brief the api of the device on which profiled code runs */
   std::shared_ptr<device_api::DeviceAPI> dev_api_;
-  /*! \brief the arguments annotation */
-  std::vector<std::string> args;
 };
 
+/*!
+ * \brief The profiler, whose events are kept in the ring buffers of the tracer. The events are
+ * only decoded into ProfileStat or the trace events when they are read.
+ */
 class Profiler {
  public:
   ~Profiler();
   static Profiler* Get();  // std::shared_ptr<Profiler>* sp = nullptr);
   void AddNewProfileStat(std::string categories, std::string name, uint64_t start_time,
                          uint64_t end_time, const std::vector<std::string>& args);
+  /*! \brief The events since the last clear in the Chrome trace event format. */
   std::string GetProfile();
+  /*! \brief The events since the last clear. */
   std::vector<ProfileStat> GetProfileStats();
+  /*! \brief Drop the events. */
   void ClearProfile();
 
   inline bool IsProfiling(int level) {
     return profile_level_ >= level;
   }
 
-  void CollectStat() {
-    for (int i = 0; i < helpers_.size(); i++) {
-      helpers_[i].collect();
-    }
-  }
-
   inline int profile_level() const {
     return profile_level_;
   }
@@ -216,21 +208,13 @@ class Profiler {
     profile_level_ = profile_level;
   }
 
-  std::vector<ProfilerHelper>& HelperPool() {
-    return helpers_;
-  }
-
  private:
   Profiler();
 
-  /*! \brief Profile statistics. */
-  DeviceStats profile_stats_;
   /*! \brief Profiling level. */
   int profile_level_{0};
   /*! \brief Mutex for multi-threading. */
   std::recursive_mutex m_;
-  /*! \brief The helper pool. */
-  std::vector<ProfilerHelper> helpers_;
 };
 
 inline void ProfilerHelper::start() {
@@ -248,7 +232,7 @@ inline void ProfilerHelper::stop() {
 }
 
 inline void ProfilerHelper::collect() {
-  Profiler::Get()->AddNewProfileStat(categories_, name_, start_time_, end_time_, args);
+  Tracer::Get()->Record(start_time_, end_time_, name_, categories_, args_);
 }
 
 }  // namespace profiler
@@ -0,0 +1,130 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file remote_cache.h
+ * \brief The remote tier of the persistent caches, which is shared by the nodes of a fleet.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace op {
+
+/*!
+ * \brief A blob store shared by the nodes, e.g., an object store or a directory mounted on all
+ * the nodes. Each object is a directory, keyed by a relative path such as
+ * "<cache name>/<entry name>". The methods may be called from a background thread.
+ */
+class RemoteCacheBackend {
+ public:
+  virtual ~RemoteCacheBackend() = default;
+
+  /*!
+   * \brief Download an object into an empty local directory.
+   * \param key The key of the object.
+   * \param local_dir The local directory.
+   * \return Whether the object exists.
+   */
+  virtual bool Fetch(const std::string& key, const std::string& local_dir) = 0;
+
+  /*!
+   * \brief Upload a local directory as an object, which replaces the object of the same key.
+   * \param key The key of the object.
+   * \param local_dir The local directory.
+   */
+  virtual void Upload(const std::string& key, const std::string& local_dir) = 0;
+};
+
+/*! \brief The backend of a directory mounted on all the nodes, e.g., by NFS. */
+class DirRemoteCacheBackend : public RemoteCacheBackend {
+ public:
+  explicit DirRemoteCacheBackend(const std::string& root);
+
+  bool Fetch(const std::string& key, const std::string& local_dir) override;
+
+  void Upload(const std::string& key, const std::string& local_dir) override;
+
+ private:
+  std::string root_;
+};
+
+/*!
+ * \brief The remote tier behind the persistent caches. A miss of a local persistent cache is
+ * fetched from the backend, and a new local entry is uploaded in the background. The entries
+ * used by a process are recorded, so they can be published as the manifest of a model
+ * fingerprint, which the other nodes prefetch at startup before compiling the model.
+ */
+class RemoteCache {
+ public:
+  /*! \brief The remote cache of the process. */
+  static RemoteCache* Get();
+
+  /*! \brief Set the backend, or disable the remote tier with nullptr. Pending uploads are kept. */
+  void SetBackend(std::shared_ptr<RemoteCacheBackend> backend);
+
+  /*! \brief Whether a backend is set. */
+  bool Enabled();
+
+  /*! \brief Fetch an entry of a persistent cache into an empty local directory. */
+  bool Fetch(const std::string& cache_name, const std::string& entry_name,
+             const std::string& local_dir);
+
+  /*! \brief Upload an entry of a persistent cache in the background. */
+  void UploadAsync(const std::string& cache_name, const std::string& entry_name,
+                   const std::string& local_dir);
+
+  /*! \brief Record an entry used by the process, which is a part of the published manifest. */
+  void Record(const std::string& cache_name, const std::string& entry_name);
+
+  /*! \brief Wait for the pending uploads. */
+  void Flush();
+
+  /*!
+   * \brief Upload the manifest of the entries used by the process for a model fingerprint, after
+   * the pending uploads are done.
+   * \param fingerprint The fingerprint of the model, e.g., the hash of its IR and the device.
+   * \return The number of the entries in the manifest.
+   */
+  int Publish(const std::string& fingerprint);
+
+  /*!
+   * \brief Fetch the manifest of a model fingerprint.
+   * \return The pairs of (cache name, entry name), or empty if there is no manifest.
+   */
+  std::vector<std::pair<std::string, std::string>> FetchManifest(const std::string& fingerprint);
+
+ private:
+  RemoteCache() = default;
+
+  /*! \brief Run the pending uploads. */
+  void UploadLoop();
+
+  std::shared_ptr<RemoteCacheBackend> GetBackend();
+
+  std::shared_ptr<RemoteCacheBackend> backend_;
+  /*! \brief The pending uploads of (key, local directory). */
+  std::deque<std::pair<std::string, std::string>> uploads_;
+  /*! \brief The number of the uploads being run. */
+  int running_ = 0;
+  /*! \brief The entries used by the process. */
+  std::set<std::pair<std::string, std::string>> recorded_;
+  /*! \brief Whether the upload thread is started, which lives until the process exits. */
+  bool worker_started_ = false;
+  std::mutex mu_;
+  std::condition_variable cv_;
+};
+
+}  // namespace op
+}  // namespace raf
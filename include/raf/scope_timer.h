@@ -8,6 +8,7 @@
  * \brief Scope timer that times the execution time of a code scope (e.g., function).
  */
 #pragma once
+#include "raf/metrics.h"
 #include "raf/profiler.h"
 
 namespace raf {
@@ -35,6 +36,11 @@ class ScopeTimerPool {
   }
 
   void AddSample(std::string name, float timed) {
+    // The samples are also summarized in the metrics, which are scraped without the report.
+    metrics::MetricsRegistry::Get()
+        ->GetSummary("raf_scope_timer_seconds", "The seconds of the timed scopes.",
+                     {{"scope", name}})
+        ->Observe(timed);
     std::lock_guard<std::mutex> lock(mutex);
     time_pool[name].push_back(timed);
   }
@@ -10,7 +10,9 @@
 #pragma once
 #include <tvm/node/structural_hash.h>
 #include <tvm/runtime/object.h>
+#include <memory>
 #include <string>
+#include <vector>
 #include "./ir_ext.h"
 #include "./value.h"
 
@@ -28,6 +30,89 @@ class ConstantNode : public ir::ConstantNode {
   RAF_FINAL_OBJECT_NOCHECK(ConstantNode, ir::ConstantNode);
 };
 
+/*!
+ * \brief A reference to a constant stored out-of-line in the binary IR format, which is converted
+ * to ir::ConstantNode of the loaded constant when the IR is loaded.
+ */
+class ConstantRefNode : public ir::ConstantNode {
+ public:
+  /*! \brief The index of the constant in the constant section. */
+  int64_t index;
+
+  static constexpr const char* _type_key = "raf.ir.serialization.ConstantRef";
+  RAF_FINAL_OBJECT_NOCHECK(ConstantRefNode, ir::ConstantNode);
+};
+
+/*! \brief The alignment of the tensor data in the memory-mapped formats. */
+constexpr uint64_t kMappedDataAlignment = 4096;
+
+/*! \brief A read-only memory mapping of a whole file. */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+
+  ~MappedFile();
+
+  const char* data() const {
+    return static_cast<const char*>(addr_);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  void* addr_;
+  size_t size_;
+};
+
+/*!
+ * \brief Serialize values, whose tensors are stored out-of-line in the data region of a
+ * memory-mapped file, e.g., the constants of an executable or an IR module.
+ * \param strm DMLC stream of the metadata.
+ * \param values The values to be serialized.
+ * \param blobs The host tensors to be written to the data region, in order.
+ */
+void SaveMappedValues(dmlc::Stream* strm, const std::vector<value::Value>& values,
+                      std::vector<value::Value>* blobs);
+
+/*!
+ * \brief Deserialize the values saved by SaveMappedValues, whose tensors are views of the mapped
+ * file without a copy, which keep the mapping alive.
+ * \param strm DMLC stream of the metadata.
+ * \param file The mapped file.
+ * \param data The start of the data region in the mapped file.
+ * \return The values.
+ */
+std::vector<value::Value> LoadMappedValues(dmlc::Stream* strm, std::shared_ptr<MappedFile> file,
+                                           const char* data);
+
+/*!
+ * \brief Write the metadata and the data region of the blobs to a file.
+ * \param path The path of the file.
+ * \param meta The metadata, whose u64 at data_offset_pos is patched to the data region offset.
+ * \param data_offset_pos The position of the data region offset in the metadata.
+ * \param blobs The host tensors of the data region given by SaveMappedValues.
+ */
+void WriteMappedFile(const std::string& path, std::string* meta, size_t data_offset_pos,
+                     const std::vector<value::Value>& blobs);
+
+/*!
+ * \brief Save as a binary file, where the constants are stored out-of-line and memory-mapped by
+ * LoadBinary, instead of base64 strings in the JSON. Extended IR is converted before
+ * serialization.
+ * \param node node registered in tvm node system.
+ * \param path The path of the file.
+ */
+void SaveBinary(const ir::ObjectRef& node, const std::string& path);
+
+/*!
+ * \brief Load a binary file saved by SaveBinary.
+ * \param path The path of the file.
+ * \return The loaded node.
+ */
+ir::ObjectRef LoadBinary(const std::string& path);
+
 /*!
  * \brief Save as json string. Extended IR is converted before serialization.
  * \param node node registered in tvm node system.
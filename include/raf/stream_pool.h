@@ -38,8 +38,8 @@ enum StreamTag {
   kCudaCommunicate = 4,
   kMemCpyCudaToCuda1 = 5,
   kMemCpyCudaToCuda2 = 6,
-  kReserved1 = 7,
-  kReserved2 = 8,
+  kMemCpyCudaPeer = 7,
+  kCudaUpdate = 8,
   kReserved3 = 9,
   kReserved4 = 10,
   kReserved5 = 11,
@@ -64,8 +64,9 @@ class StreamTagEnum : public EnumBase<StreamTagEnum, 16, int32_t, StreamTag> {
                            "Memcopy from CUDA to CUDA");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 6, MemCudaToCuda2, kMemCpyCudaToCuda2,
                            "Memcopy from CUDA to CUDA");
-  ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 7, Reserved1, kReserved1, "Reserved for other devices");
-  ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 8, Reserved2, kReserved2, "Reserved for other devices");
+  ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 7, MemCudaPeer, kMemCpyCudaPeer,
+                           "Memcopy between two CUDA devices");
+  ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 8, CudaUpdate, kCudaUpdate, "Cuda optimizer update");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 9, Reserved3, kReserved3, "Reserved for other devices");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 10, Reserved4, kReserved4, "Reserved for other devices");
   ENUM_DEF_ENTRY_WITH_NAME(StreamTagEnum, 11, Reserved5, kReserved5, "Reserved for other devices");
@@ -91,7 +92,40 @@ class Stream final {
 
   void* data() const;
 
-  static std::shared_ptr<Stream> Get(const Device& dev, int tag_idx, int index);
+  /*!
+   * \brief Get a stream from the pool of the device, which is created at the first request.
+   * \param dev The device of the stream.
+   * \param tag_idx The index of the stream tag.
+   * \param index The index of the stream under the tag.
+   * \param priority The priority of the stream. A larger value means a higher priority, and 0 is
+   * the default priority. The streams with different priorities are different streams.
+   * \return The stream.
+   */
+  static std::shared_ptr<Stream> Get(const Device& dev, int tag_idx, int index, int priority = 0);
+
+  /*!
+   * \brief Configure the streams of a tag on the device, which are created at once. The default
+   * priority requests of the tag are then served by these streams, where the index wraps around
+   * the number of the streams, so a schedule of more streams shares the configured ones.
+   * \param dev The device of the streams.
+   * \param tag_idx The index of the stream tag.
+   * \param num_streams The number of the streams of the tag. 0 removes the configuration.
+   * \param priority The priority of the streams. See Get.
+   * \param non_blocking Whether the streams do not synchronize with the default stream, which is
+   * required if the streams are used by the CUDA graph capture together with the default stream.
+   */
+  static void Configure(const Device& dev, int tag_idx, int num_streams, int priority = 0,
+                        bool non_blocking = false);
+
+  /*!
+   * \brief Create a stream that is not pooled, which is freed when released.
+   * \param dev The device of the stream.
+   * \param priority The priority of the stream. See Get.
+   * \param non_blocking Whether the stream does not synchronize with the default stream.
+   * \return The stream.
+   */
+  static std::shared_ptr<Stream> Create(const Device& dev, int priority = 0,
+                                        bool non_blocking = false);
 
   void Wait() const;
 
@@ -0,0 +1,151 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tracer.h
+ * \brief A low-overhead tracer, which records binary events of interned names into a lock-free
+ * ring buffer per thread. The events are only decoded into strings when they are exported.
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace raf {
+namespace profiler {
+
+/*! \brief A duration event of a fixed size, whose strings are interned ids. */
+struct TraceEvent {
+  /*! \brief The start and end timestamps in microseconds. */
+  uint64_t start_us;
+  uint64_t end_us;
+  /*! \brief The interned name, category and arguments of the event. */
+  uint32_t name;
+  uint32_t category;
+  uint32_t args;
+  /*! \brief The index of the thread that recorded the event. */
+  uint32_t thread;
+};
+
+/*!
+ * \brief The ring buffer of the events of a thread. Only the owner thread writes it, so writing an
+ * event is a store and a release of the head. When the buffer is full, the oldest events are
+ * overwritten, so the tracer keeps the latest window of the execution.
+ */
+class TraceBuffer {
+ public:
+  TraceBuffer(uint32_t thread, size_t capacity);
+
+  /*! \brief Record an event. Only called by the owner thread. */
+  inline void Record(uint64_t start_us, uint64_t end_us, uint32_t name, uint32_t category,
+                     uint32_t args) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    events_[head & mask_] = TraceEvent{start_us, end_us, name, category, args, thread_};
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  /*!
+   * \brief Append the events since the last clear to out in the recording order, skipping the
+   * events that are overwritten during the copy.
+   * \return The number of the events that have been overwritten before they are read.
+   */
+  uint64_t Read(std::vector<TraceEvent>* out) const;
+
+  /*! \brief Drop the recorded events. */
+  void Clear() {
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+  }
+
+ private:
+  /*! \brief The thread index in the events. */
+  uint32_t thread_;
+  /*! \brief The capacity minus 1, where the capacity is a power of 2. */
+  uint64_t mask_;
+  /*! \brief The number of the events ever recorded. */
+  std::atomic<uint64_t> head_{0};
+  /*! \brief The head of the last clear. */
+  std::atomic<uint64_t> tail_{0};
+  std::vector<TraceEvent> events_;
+};
+
+class Tracer {
+ public:
+  static Tracer* Get();
+
+  /*!
+   * \brief Intern a string. The id of a string never changes, and the lookup of a string the
+   * thread has seen takes no lock and no allocation. The empty string is 0.
+   */
+  uint32_t Intern(const std::string& str);
+
+  /*! \brief The string of an interned id. */
+  std::string GetString(uint32_t id);
+
+  /*! \brief Record an event into the ring buffer of the current thread. */
+  inline void Record(uint64_t start_us, uint64_t end_us, uint32_t name, uint32_t category,
+                     uint32_t args = 0) {
+    ThreadBuffer()->Record(start_us, end_us, name, category, args);
+  }
+
+  /*!
+   * \brief Make a named track, e.g., of a device stream, whose events are recorded by a single
+   * thread at a time, i.e., the caller must serialize the records of the track.
+   */
+  TraceBuffer* NewTrack(const std::string& name);
+
+  /*! \brief The events of all threads since the last clear, sorted by the start timestamps. */
+  std::vector<TraceEvent> GetEvents();
+
+  /*! \brief Drop the events of all threads. */
+  void Clear();
+
+  /*! \brief The number of the events overwritten before they are read since the last clear. */
+  uint64_t dropped() const {
+    return dropped_;
+  }
+
+  /*!
+   * \brief Export the events in the Chrome trace event format, which is also loaded by Perfetto.
+   * Each event is a complete event on the track of its thread.
+   */
+  std::string ExportChromeTrace();
+
+ private:
+  Tracer();
+
+  /*! \brief The buffer of the current thread, which is created at the first event. */
+  TraceBuffer* ThreadBuffer() {
+    thread_local TraceBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+      buffer = NewBuffer();
+    }
+    return buffer;
+  }
+
+  /*! \brief Make the buffer of the current thread. */
+  TraceBuffer* NewBuffer();
+
+  /*! \brief The capacity of each buffer, from RAF_TRACE_BUFFER_SIZE (in events). */
+  size_t capacity_;
+  /*! \brief The buffers are never freed, so the events of the exited threads are kept. */
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+  /*! \brief The names of the tracks of the buffers. */
+  std::vector<std::string> track_names_;
+  /*! \brief The interned strings. The deque keeps them in place when it grows. */
+  std::deque<std::string> strings_;
+  std::unordered_map<std::string, uint32_t> ids_;
+  /*! \brief The number of the overwritten events. */
+  uint64_t dropped_ = 0;
+  /*! \brief Guard the buffer list, the interned strings and the reads. */
+  std::mutex mu_;
+};
+
+}  // namespace profiler
+}  // namespace raf
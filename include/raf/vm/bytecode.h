@@ -34,6 +34,9 @@ using RegName = int64_t;
  */
 using Index = int64_t;
 
+/*! \brief The alignment of the static arenas, which bounds that of the storages in them. */
+constexpr Index kStaticArenaAlignment = 4096;
+
 /*! \brief An enumeration of Relay's opcodes.
  *
  * The opcode is used to implement instruction
@@ -64,6 +67,8 @@ enum class Opcode {
   // AllocADT = 25U,
   SetShape = 26U,
   Free = 27U,
+  // Release the reference held by a register.
+  Kill = 28U,
 
   // Invoke instructions
   InvokeFunc = 30U,
@@ -71,12 +76,20 @@ enum class Opcode {
   InvokePacked = 32U,
   InvokeJit = 33U,
   InferType = 34U,
+  // Fused InvokeJit followed by a sequence of Free.
+  InvokeJitFree = 35U,
+  // Non-blocking InvokeJit of a collective, which writes a completion handle to dst.
+  InvokeJitAsync = 36U,
+  // Let the current stream wait for the completion handle of an InvokeJitAsync.
+  Wait = 37U,
 
   // Cuda stream instructions
   CudaSetStream = 40U,
   CudaAddEvent = 41U,
   CudaWaitEvent = 42U,
   CudaStreamBarrier = 43U,
+  // Fused CudaSetStream followed by a CudaWaitEvent.
+  CudaSetStreamWait = 44U,
 };
 
 /*! \brief A single virtual machine instruction.
@@ -150,6 +163,15 @@ struct Instruction {
       Index device_id;
       /*! \brief Allocate storage alloc_async if available. */
       bool alloc_async;
+      /*!
+       * \brief The index of the static arena of the function to place the storage in, or -1 to
+       * allocate the storage from the memory pool.
+       */
+      Index arena_index;
+      /*! \brief The offset of the storage in the arena. */
+      Index arena_offset;
+      /*! \brief The size of the arena. */
+      Index arena_size;
     } alloc_storage;
     struct /* AllocTensor Operands */ {
       /*! \brief The storage to allocate from. */
@@ -169,6 +191,10 @@ struct Instruction {
       /*! \brief The memory to be freed. It can be a tensor or a storage. */
       RegName memory;
     } free;
+    struct /* Kill Operands */ {
+      /*! \brief The register to be released. */
+      RegName reg;
+    } kill;
     struct /* AllocTensorReg Operands */ {
       /*! \brief The storage to allocate from. */
       RegName storage;
@@ -200,6 +226,8 @@ struct Instruction {
       RegName data;
       /*! \brief The register containing the shape. */
       RegName shape;
+      /*! \brief The offset of the view in the elements of the data. */
+      Index offset;
     } set_shape;
 
     struct /* InvokeFunc Operands */ {
@@ -235,7 +263,12 @@ struct Instruction {
       Index arity;
       /*! \brief The number of outputs produced by the packed function. */
       Index output_size;
-      /*! \brief The arguments to pass to the packed function. */
+      /*! \brief The number of registers freed after the invocation (InvokeJitFree only). */
+      Index num_frees;
+      /*!
+       * \brief The arguments to pass to the packed function, followed by the `num_frees`
+       * registers to be freed.
+       */
       RegName* args;
     } invoke_jit;
     struct /* InferType Operands */ {
@@ -251,6 +284,8 @@ struct Instruction {
       Index device_id;
       /*! \brief The id of the target stream */
       Index stream_id;
+      /*! \brief The priority of the target stream */
+      Index priority;
     } cuda_set_stream;
     struct /* CudaAddEvent and CudaWaitEvent Operands */ {
       /*! \brief The id of the event need to add or wait on current device */
@@ -258,6 +293,20 @@ struct Instruction {
       /*! \brief The id of the stream need to add or wait on current device */
       Index stream_id;
     } cuda_event;
+    struct /* CudaSetStreamWait Operands */ {
+      /*! \brief The id of the cuda device that we want to set the stream */
+      Index device_id;
+      /*! \brief The id of the target stream */
+      Index stream_id;
+      /*! \brief The id of the event to wait after switching the stream */
+      Index event_id;
+      /*! \brief The id of the stream to wait. -1 for the target stream */
+      Index wait_stream_id;
+    } cuda_set_stream_wait;
+    struct /* Wait Operands */ {
+      /*! \brief The register containing the completion handle. */
+      RegName handle;
+    } wait;
   };
 
   /*!
@@ -327,9 +376,10 @@ struct Instruction {
    * \param data The register containing the data.
    * \param shape The register containing the raw shape.
    * \param dst The destination register.
+   * \param offset The offset of the view in the elements of the data.
    * \return The set shape instruction.
    */
-  static Instruction SetShape(RegName data, RegName shape, RegName dst);
+  static Instruction SetShape(RegName data, RegName shape, RegName dst, Index offset = 0);
   /*!
    * \brief Construct a get field instruction.
    * \param object_reg The register containing the object to project from.
@@ -413,6 +463,14 @@ struct Instruction {
    */
   static Instruction Free(RegName memory);
 
+  /*!
+   * \brief Release the reference held by a register. Unlike Free, the memory is released only
+   * when it is not referred by other values (e.g., tuples) anymore.
+   * \param reg The register to be released.
+   * \return The kill instruction.
+   */
+  static Instruction Kill(RegName reg);
+
   /*!
    * \brief Construct an invoke JIT operator instruction.
    * \param op_reg The register containing the OpValue to invoke.
@@ -431,13 +489,47 @@ struct Instruction {
    * \return The invoke OpType instruction.
    */
   static Instruction InferType(RegName op_reg, const std::vector<RegName>& args, RegName dst);
+  /*!
+   * \brief Construct an InvokeJitFree instruction, which fuses an InvokeJit with the Free
+   * instructions following it.
+   * \param op_reg The register containing the OpValue to invoke.
+   * \param arity The arity of the function.
+   * \param output_size The number of outputs of the packed function.
+   * \param args The argument registers.
+   * \param frees The registers to be freed after the invocation.
+   * \return The invoke JIT and free instruction.
+   */
+  static Instruction InvokeJitFree(RegName op_reg, Index arity, Index output_size,
+                                   const std::vector<RegName>& args,
+                                   const std::vector<RegName>& frees);
+  /*!
+   * \brief Construct an InvokeJitAsync instruction, which launches a collective on the
+   * communication stream after the work on the current stream, without blocking the current
+   * stream.
+   * \param op_reg The register containing the OpValue to invoke.
+   * \param arity The arity of the function.
+   * \param output_size The number of outputs of the packed function.
+   * \param args The argument registers.
+   * \param handle The register to write the completion handle to.
+   * \return The asynchronous invoke JIT instruction.
+   */
+  static Instruction InvokeJitAsync(RegName op_reg, Index arity, Index output_size,
+                                    const std::vector<RegName>& args, RegName handle);
+  /*!
+   * \brief Construct a Wait instruction.
+   * \param handle The register containing the completion handle of an InvokeJitAsync.
+   * \return The wait instruction.
+   */
+  static Instruction Wait(RegName handle);
   /*!
    * \brief Construct a CudaSetStream instruction.
    * \param device_id The id of device we want to set the stream on.
    * \param stream_id The id of target stream.
+   * \param priority The priority of the target stream if it is created by this instruction. A
+   * larger value means a higher priority, and 0 is the default priority.
    * \return The set stream instruction.
    */
-  static Instruction CudaSetStream(Index device_id, Index stream_id);
+  static Instruction CudaSetStream(Index device_id, Index stream_id, Index priority = 0);
   /*!
    * \brief Construct a CudaAddEvent instruction.
    * \param event_id The id of event we would use to record.
@@ -459,6 +551,18 @@ struct Instruction {
    */
   static Instruction CudaStreamBarrier();
 
+  /*!
+   * \brief Construct a CudaSetStreamWait instruction, which fuses a CudaSetStream with the
+   * CudaWaitEvent following it.
+   * \param device_id The id of device we want to set the stream on.
+   * \param stream_id The id of target stream.
+   * \param event_id The id of event we want to wait for.
+   * \param wait_stream_id The id of the stream to wait. -1 for the target stream.
+   * \return The set stream and wait event instruction.
+   */
+  static Instruction CudaSetStreamWait(Index device_id, Index stream_id, Index event_id,
+                                       Index wait_stream_id);
+
   Instruction();
   Instruction(const Instruction& instr);
   Instruction& operator=(const Instruction& instr);
@@ -9,12 +9,15 @@
  */
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include "raf/ir_ext.h"
 #include "raf/registry.h"
+#include "raf/serialization.h"
 #include "raf/value.h"
 
 namespace raf {
@@ -68,6 +71,40 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   static tvm::runtime::Module Load(const std::string& code, const tvm::runtime::Module lib);
 
+  /*!
+   * \brief Save the executable to a file in the memory-mapped format, where the data of every
+   * tensor constant is stored page-aligned after the other sections, so that it can be
+   * mapped instead of parsed and copied when loading.
+   *
+   * \param path The path of the file.
+   */
+  void SaveToFile(const std::string& path);
+
+  /*!
+   * \brief Load a VM executable saved by SaveToFile. The file is memory-mapped and the tensor
+   * constants refer to the mapped pages directly, so they are neither parsed nor copied on the
+   * host. They are uploaded to the device from the mapping the first time they are loaded.
+   *
+   * \param path The path of the file.
+   * \param lib The compiled runtime library.
+   *
+   * \return exe The constructed executable.
+   */
+  static tvm::runtime::Module LoadFromFile(const std::string& path,
+                                           const tvm::runtime::Module lib);
+
+  /*!
+   * \brief Load a VM executable saved by SaveToFile to deploy it with its kernel bundle, e.g., by
+   * the runtime library without Python. The persistent caches are redirected to the bundle, so the
+   * kernels are loaded from the bundle instead of being built when the ops are dispatched.
+   *
+   * \param path The path of the file.
+   * \param bundle The directory of the kernel bundle, e.g., the one given to build_op_envs.
+   *
+   * \return exe The constructed executable.
+   */
+  static tvm::runtime::Module LoadDeployment(const std::string& path, const std::string& bundle);
+
   /*!
    * \brief Get the serialized form of the `functions`. This is
    * essentially bytecode serialization.
@@ -133,6 +170,17 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   std::string GetFunctionParameterName(std::string func, uint32_t index) const;
 
+  /*!
+   * \brief Get a VM function, decoding its bytecode on the first access if the executable was
+   * loaded from a serialized form. This method is thread-safe.
+   * \param func_index The index of the function.
+   * \return The VM function.
+   */
+  const VMFunction& GetVMFunction(Index func_index) const;
+
+  /*! \brief Decode the bytecode of all the functions that have not been decoded yet. */
+  void DecodeAllFunctions() const;
+
   virtual ~Executable() {
   }
 
@@ -151,7 +199,10 @@ class Executable : public tvm::runtime::ModuleNode {
    * corresponds to the position of the `packed_funcs` list in a `VirtualMachine` object.
    */
   std::unordered_map<std::string, Index> primitive_map;
-  /*! \brief The virtual machine's function table. */
+  /*!
+   * \brief The virtual machine's function table. For a loaded executable, the instructions of a
+   * function are empty until it is decoded by GetVMFunction.
+   */
   std::vector<VMFunction> functions;
 
  private:
@@ -169,6 +220,15 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   void SaveConstantSection(dmlc::Stream* strm);
 
+  /*!
+   * \brief Save the constant pool in the memory-mapped format. Tensor constants only have their
+   * metadata saved in the stream, and their data is collected to be written after the sections.
+   *
+   * \param strm The input stream.
+   * \param blobs The host tensors whose data should be written to the data region, in order.
+   */
+  void SaveMappedConstantSection(dmlc::Stream* strm, std::vector<Value>* blobs);
+
   /*!
    * \brief Save primitive op names.
    *
@@ -197,6 +257,16 @@ class Executable : public tvm::runtime::ModuleNode {
    */
   void LoadConstantSection(dmlc::Stream* strm);
 
+  /*!
+   * \brief Load the constant pool in the memory-mapped format.
+   *
+   * \param strm The input stream.
+   * \param file The mapped file, which is kept alive by the tensor constants.
+   * \param data The start of the data region in the mapped file.
+   */
+  void LoadMappedConstantSection(dmlc::Stream* strm,
+                                 std::shared_ptr<serialization::MappedFile> file, const char* data);
+
   /*!
    * \brief Load primitive op names.
    *
@@ -209,10 +279,30 @@ class Executable : public tvm::runtime::ModuleNode {
    *
    * \param strm The input stream.
    */
-  void LoadCodeSection(dmlc::Stream* strm);
+  void LoadCodeSection(dmlc::SeekStream* strm);
+
+  /*! \brief The location of the serialized instructions of a function not decoded yet. */
+  struct LazyCode {
+    /*! \brief The offset of the first instruction in the serialized code. */
+    size_t begin;
+    /*! \brief The number of bytes of the instructions. */
+    size_t nbytes;
+    /*! \brief The number of instructions. */
+    size_t num_instructions;
+    /*! \brief Whether the instructions are still to be decoded. */
+    bool pending;
+  };
 
   /*! \brief The serialized bytecode. */
   std::string code_;
+  /*! \brief The buffer the lazy instructions are decoded from. */
+  const char* code_data_{nullptr};
+  /*! \brief The memory-mapped file backing the constants and code, if any. */
+  std::shared_ptr<serialization::MappedFile> mapped_file_;
+  /*! \brief The functions whose instructions are decoded on demand, indexed by function. */
+  mutable std::vector<LazyCode> lazy_code_;
+  /*! \brief The mutex protecting the lazy decoding. */
+  mutable std::mutex lazy_mutex_;
 };
 
 }  // namespace vm
@@ -0,0 +1,138 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file server.h
+ * \brief The dynamic batching server over the virtual machine.
+ */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "./vm.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+/*! \brief The options of BatchServer. */
+struct BatchServerConfig {
+  /*! \brief The function to serve. */
+  std::string func_name = "main";
+  /*! \brief The max number of rows of a batch, i.e., the sum of the batch axes of its requests. */
+  int64_t max_batch_size = 32;
+  /*! \brief The max time in microseconds the first request of a batch waits for the others. */
+  int64_t max_delay_us = 1000;
+  /*!
+   * \brief The sorted batch sizes to pad the batches to, which should match the buckets of the
+   * CUDA graph cache, so a batch of any size replays a captured graph. The batches are not
+   * padded if it is empty, or if they are larger than all buckets.
+   */
+  std::vector<int64_t> buckets;
+  /*!
+   * \brief The number of the worker threads, each of which runs a batch in its own context. It
+   * should be no more than the max concurrency of the VM.
+   */
+  int num_workers = 1;
+};
+
+/*!
+ * \brief The dynamic batching server over a VM. The requests are queued, and a worker batches
+ * the queued ones when there are enough rows for a full batch or the first one has waited for the
+ * max delay. The rows of the requests are concatenated along the leading axis, and padded with
+ * zeros to a bucket, and the outputs of a request are views of its rows of the batch outputs, so
+ * they are not copied. The leading axes of all inputs and outputs of the function are the batch.
+ */
+class BatchServer : public tvm::runtime::ModuleNode {
+ public:
+  /*!
+   * \param vm The VM module.
+   * \param params The inputs shared by the batches, e.g. the weights, which follow the inputs of
+   * the requests.
+   * \param config The options.
+   */
+  BatchServer(tvm::runtime::Module vm, std::vector<Value> params, BatchServerConfig config);
+
+  virtual ~BatchServer();
+
+  const char* type_key() const final {
+    return "BatchServer";
+  }
+
+  virtual PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self);
+
+  /*!
+   * \brief Queue a request.
+   * \param inputs The host tensors of the request, whose leading axes are the same.
+   * \return The id of the request.
+   */
+  int64_t Submit(std::vector<Value> inputs);
+
+  /*!
+   * \brief Wait for a request and raise its error, if any.
+   * \param id The id of the request.
+   * \return The outputs of the request.
+   */
+  Value Wait(int64_t id);
+
+  /*! \brief Run the queued requests, and stop the workers. */
+  void Stop();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /*! \brief A queued request. */
+  struct Request {
+    int64_t id;
+    std::vector<Value> inputs;
+    int64_t rows;
+    Clock::time_point arrival;
+  };
+
+  /*! \brief The loop of a worker. */
+  void Run();
+
+  /*! \brief Run a batch, and return the outputs of its requests. */
+  std::vector<Value> RunBatch(const std::vector<Request>& batch);
+
+  /*! \brief The VM module, which is kept alive by the server. */
+  tvm::runtime::Module vm_module_;
+  /*! \brief The VM. */
+  VirtualMachine* vm_;
+  /*! \brief The inputs shared by the batches. */
+  std::vector<Value> params_;
+  /*! \brief The options. */
+  BatchServerConfig config_;
+  /*! \brief The workers. */
+  std::vector<std::thread> workers_;
+
+  /*! \brief The mutex protecting the states below. */
+  std::mutex mu_;
+  /*! \brief Notified when a request is queued or the server stops. */
+  std::condition_variable queued_cv_;
+  /*! \brief Notified when a request is done. */
+  std::condition_variable done_cv_;
+  /*! \brief The queued requests. */
+  std::deque<Request> queue_;
+  /*! \brief The number of the rows of the queued requests. */
+  int64_t queued_rows_ = 0;
+  /*! \brief The id of the next request. */
+  int64_t next_id_ = 0;
+  /*! \brief The outputs of the requests that are done and not waited yet. */
+  std::unordered_map<int64_t, Value> results_;
+  /*! \brief The errors of the failed requests that are not waited yet. */
+  std::unordered_map<int64_t, std::string> errors_;
+  /*! \brief Whether the server stops. */
+  bool stop_ = false;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
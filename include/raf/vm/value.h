@@ -8,6 +8,7 @@
  * \brief The values that are specific to VM.
  */
 #pragma once
+#include "raf/event_pool.h"
 #include "raf/ir_ext.h"
 #include "raf/memory_pool.h"
 #include "raf/value.h"
@@ -64,6 +65,24 @@ class StorageValue final : public Value {
   RAF_MUTABLE_OBJECT_REF(StorageValue, Value, StorageValueObj);
 };
 
+/*! \brief An object representing the completion handle of an asynchronous collective. */
+class CollectiveHandleValueObj final : public ValueObj {
+ public:
+  /*! \brief The event recorded on the communication stream after the collective. */
+  std::shared_ptr<event_pool::Event> event;
+
+  static constexpr const char* _type_key = "raf.value.vm.CollectiveHandleValue";
+  RAF_FINAL_OBJECT(CollectiveHandleValueObj, ValueObj);
+};
+
+/*! \brief reference to the completion handle of an asynchronous collective. */
+class CollectiveHandleValue final : public Value {
+ public:
+  static CollectiveHandleValue make(std::shared_ptr<event_pool::Event> event);
+
+  RAF_OBJECT_REF(CollectiveHandleValue, Value, CollectiveHandleValueObj);
+};
+
 }  // namespace vm
 }  // namespace executor
 }  // namespace  raf
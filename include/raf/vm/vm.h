@@ -9,9 +9,15 @@
  */
 #pragma once
 
+#include <deque>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "bytecode.h"
@@ -45,6 +51,11 @@ using namespace raf::stream_pool;
 using namespace raf::event_pool;
 using raf::registry::PackedFunc;
 
+class AsyncCompiler;
+class L2Persistence;
+class NumericsWatchdog;
+class WeightStreamer;
+
 /*! \brief Magic number for NDArray list file  */
 constexpr uint64_t kTVMNDArrayListMagic = 0xF7E58D4F05049CB7;
 
@@ -63,6 +74,11 @@ struct VMFunction {
   std::vector<Instruction> instructions;
   /*! \brief The size of the frame for this function */
   Index register_file_size;
+  /*!
+   * \brief The IR var name of the destination register of each allocation instruction, indexed by
+   * the pc, for the memory profiling. It is not serialized, so it is empty in a loaded executable.
+   */
+  std::vector<std::string> dst_names;
 
   VMFunction(const std::string& name, std::vector<std::string> params,
              std::vector<Instruction> instructions, Index register_file_size)
@@ -78,6 +94,19 @@ struct VMFunction {
   friend std::ostream& operator<<(std::ostream& os, const VMFunction&);
 };
 
+/*!
+ * \brief A register whose shape is set lazily by SetShape, because the actual shape of its
+ * upper-bound tensor is still being copied from the device.
+ */
+struct PendingShape {
+  /*! \brief The upper-bound tensor. */
+  Value data;
+  /*! \brief The pinned host copy of the actual shape. */
+  Value shape;
+  /*! \brief The event recorded after the copy. */
+  std::shared_ptr<Event> copied;
+};
+
 /*!
  * \brief A representation of a stack frame.
  *
@@ -98,6 +127,14 @@ struct VMFrame {
   std::vector<Value> register_file;
   /*! \brief Indicate whether each register is constant. */
   std::vector<bool> is_const;
+  /*! \brief The registers whose shapes are set when they are read. */
+  std::unordered_map<RegName, PendingShape> pending_shapes;
+  /*!
+   * \brief The static arenas of the function and their sizes, allocated on the first
+   * AllocStorage placed in them. They are kept when the frame is recycled and reused if they
+   * are large enough.
+   */
+  std::vector<std::pair<std::shared_ptr<memory_pool::Memory>, int64_t>> arenas;
 
   VMFrame(Index caller_func_index, Index caller_pc, RegName caller_ret_reg, Index num_args,
           Index register_file_size)
@@ -110,6 +147,18 @@ struct VMFrame {
   }
 };
 
+/*!
+ * \brief The events recorded on a stream by the instructions that need a new event per
+ * invocation, e.g., the collectives launched asynchronously. The events are handed out in turn
+ * and reused by the following runs from the start.
+ */
+struct EventRing {
+  /*! \brief The events created so far. */
+  std::vector<std::shared_ptr<Event>> events;
+  /*! \brief The index of the event to hand out next. */
+  size_t next = 0;
+};
+
 /*!
  * \brief VMContextObj holds the runtime data for an execution in the VM.
  */
@@ -117,6 +166,8 @@ class VMContextObj : public ValueObj {
  public:
   /*! \brief The current stack of call frames. */
   std::vector<VMFrame> frames;
+  /*! \brief The popped frames, whose register files are recycled when pushing new frames. */
+  std::vector<VMFrame> frame_arena;
   /*! \brief The fuction table index of the current function. */
   Index func_index{-1};
   /*! \brief The virtual machine PC. */
@@ -135,6 +186,8 @@ class VMContextObj : public ValueObj {
   std::vector<std::vector<std::shared_ptr<Event>>> events;
   /*! \brief The events used in stream barrier. */
   std::vector<std::shared_ptr<Event>> barrier_events;
+  /*! \brief The event rings of the streams, indexed by the device id and the stream id. */
+  std::vector<std::vector<EventRing>> stream_events;
   /*! \brief The streams used in runtime. */
   std::vector<std::vector<std::shared_ptr<Stream>>> streams;
   /*! \brief The index of the barrier event to use for next stream barrier. */
@@ -143,6 +196,26 @@ class VMContextObj : public ValueObj {
   Index current_device_id{0};
   /*! \brief The index of current working stream into cuda_streams. 0 indicates default stream. */
   Index current_stream_id{0};
+  /*! \brief The event recorded on the copy stream when the inputs are staged asynchronously. */
+  std::shared_ptr<Event> input_ready_event;
+  /*! \brief The event to record when the execution finished consuming the staged inputs. */
+  std::shared_ptr<Event> input_consumed_event;
+  /*! \brief Whether to prefetch the managed memory of the upcoming ops. */
+  bool prefetch_managed_memory{false};
+  /*! \brief Whether to only build the OpEnvs without launching them, like the dryrun. */
+  bool build_only{false};
+  /*!
+   * \brief Whether the frees are stream-ordered, i.e., a freed buffer is reused after the events
+   * recorded on the streams launched during its lifetime complete. It is on for the schedules
+   * of multiple streams.
+   */
+  bool stream_ordered_free{false};
+  /*! \brief The number of the launches so far, which orders the launches and the allocations. */
+  uint64_t launch_epoch{0};
+  /*! \brief The launch_epoch of the last launch on each stream of the current device. */
+  std::vector<uint64_t> stream_launch_epochs;
+  /*! \brief The launch_epoch at the allocation of each storage, by its data pointer. */
+  std::unordered_map<const void*, uint64_t> alloc_epochs;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("func_index", &func_index);
@@ -210,17 +283,45 @@ class VMContext : public Value {
   RAF_MUTABLE_OBJECT_REF(VMContext, Value, VMContextObj);
 };
 
-using OpEnvCache = MetaCache<OpEnvPtr>;
+using OpEnvCache = ShardedMetaCache<OpEnvPtr>;
+
+/*!
+ * \brief The call of an InvokeJit instruction precomputed in its first run. The callee, the
+ * constant args and the attrs are already folded into the bound OpEnv, so only the registers of
+ * the tensors it reads are kept.
+ */
+struct PrecomputedCall {
+  /*! \brief The OpEnv bound to the instruction. */
+  OpEnvPtr op_env;
+  /*! \brief The registers of the inputs of the OpEnv, in the order of its arg_indices. */
+  std::vector<Index> input_regs;
+};
+
+using PrecomputedCallPtr = std::shared_ptr<PrecomputedCall>;
 
-/*! \brief The OpEnv cache for a VM function. */
+/*!
+ * \brief The OpEnv cache for a VM function, keyed by the pc of the instruction and the shapes of
+ * its arguments. Its capacity is RAF_VM_OP_ENV_CACHE_CAPACITY, or unbounded if it is not set, in
+ * which case a server of dynamic shapes keeps an OpEnv for every shape it has seen.
+ */
 class VMFuncOpEnvCache {
  public:
+  VMFuncOpEnvCache();
+
+  /*!
+   * \brief Get the cached OpEnv of an instruction.
+   * \param key The key, whose tag is the pc.
+   * \return The OpEnv, or nullptr if it is not cached.
+   */
+  OpEnvPtr Get(const CacheKeyView& key);
+
   /*!
-   * \brief Get the OpEnv cache for a given instruction.
-   * \param pc The program counter
-   * \return The OpEnv cache.
+   * \brief Cache the OpEnv of an instruction.
+   * \param key The key, whose tag is the pc.
+   * \param op_env The OpEnv.
+   * \return The cached OpEnv, which is another one if the key is cached by another thread.
    */
-  std::shared_ptr<OpEnvCache> Get(Index pc);
+  OpEnvPtr Set(const CacheKeyView& key, OpEnvPtr op_env);
 
   /*!
    * \brief Clear the OpEnv cache.
@@ -228,10 +329,7 @@ class VMFuncOpEnvCache {
   void Clear();
 
  private:
-  /*! \brief Cache map from instruction index to OpEnv cache. */
-  std::unordered_map<Index, std::shared_ptr<OpEnvCache>> cache_map_;
-  /*! \brief The mutex for the cache_map_. */
-  std::mutex mu_;
+  OpEnvCache cache_;
 };
 
 /*!
@@ -247,19 +345,29 @@ class VMFuncOpEnvCache {
  */
 class VirtualMachine : public tvm::runtime::ModuleNode {
  public:
-  VirtualMachine(bool enable_cuda_graph, bool dryrun)
-      : exec_(nullptr), dryrun_(dryrun), enable_cuda_graph_(enable_cuda_graph) {
+  VirtualMachine(bool enable_cuda_graph, bool dryrun, bool fast_dispatch = false,
+                 bool static_op_env = false, int max_concurrency = 1)
+      : exec_(nullptr),
+        dryrun_(dryrun),
+        enable_cuda_graph_(enable_cuda_graph),
+        fast_dispatch_(fast_dispatch),
+        static_op_env_(static_op_env),
+        max_concurrency_(max_concurrency) {
+    CHECK_GE(max_concurrency_, 1) << "The max concurrency of VM must be positive";
 #ifndef RAF_USE_CUDA
     if (enable_cuda_graph) {
       LOG(WARNING) << "Because CUDA is not enabled in RAF, CUDA graph will be disabled in the VM.";
       enable_cuda_graph_ = false;
     }
 #endif
-    if (enable_cuda_graph_) {
-      LOG(WARNING) << "Concurrent execution is not supported for VM in CUDA graph mode.";
+    if (enable_cuda_graph_ && max_concurrency_ == 1) {
+      LOG(WARNING) << "Concurrent execution is not supported for VM in CUDA graph mode "
+                   << "with max_concurrency=1.";
     }
   }
 
+  virtual ~VirtualMachine();
+
   const char* type_key() const final {
     return "VirtualMachine";
   }
@@ -299,12 +407,60 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * \return The VM context.
    */
   VMContext PrepareVMContext(const std::string& func_name, const std::vector<Value>& inputs);
+  /*!
+   * \brief Prepare a VM runtime context whose host inputs are uploaded to the device
+   * asynchronously. The inputs are staged through double-buffered pinned host memory and copied
+   * on a dedicated copy stream, so the upload of the next batch overlaps with the execution of
+   * the current one. At most one context can be prefetched ahead of the running one.
+   * \param func_name The entry function name.
+   * \param inputs The inputs to the function.
+   * \return The VM context.
+   */
+  VMContext PrepareVMContextAsync(const std::string& func_name, const std::vector<Value>& inputs);
   /*!
    * \brief Run the virtual machine.
    * \param ctx The runtime context.
    * \return The return value.
    */
   Value Run(VMContext ctx);
+  /*!
+   * \brief Submit a batch to the pipeline of batches. Its inputs are uploaded on the copy stream,
+   * it is executed on the compute stream, and its outputs are downloaded to the pinned host memory
+   * on the other copy stream, without blocking the host. So the upload of the next batch and the
+   * download of the previous one overlap with its execution, and the host prepares the following
+   * batches and processes the previous outputs meanwhile.
+   * \param func_name The entry function name.
+   * \param inputs The inputs to the function.
+   */
+  void SubmitPipelined(const std::string& func_name, const std::vector<Value>& inputs);
+  /*!
+   * \brief Wait for the outputs of the oldest batch submitted to the pipeline.
+   * \return The outputs on the host.
+   */
+  Value FetchPipelined();
+  /*!
+   * \brief Build the OpEnvs of all the instructions on the path executed by the context ahead of
+   * time, so JIT compilation and algorithm search are done before serving. The context runs
+   * outside of the CUDA graph, and its return value is discarded.
+   * \param ctx The runtime context.
+   */
+  void BuildOpEnvs(VMContext ctx);
+  /*!
+   * \brief Upload the new values of the constants, e.g., the weights bound by set_params, into the
+   * back buffers without blocking the running contexts. The values must have the same shapes and
+   * dtypes of the constants.
+   * \param indices The indices of the constants in the executable.
+   * \param values The new values of the constants.
+   */
+  void StageConstants(const std::vector<Index>& indices, const std::vector<Value>& values);
+  /*!
+   * \brief Swap the staged constants in, which are used by the runs launched afterwards. The
+   * OpEnvs and the CUDA graphs stay valid, as the shapes are unchanged. The CUDA graphs capture the
+   * addresses of the constants, so the staged values are copied into the constants for them, which
+   * requires no CUDA graph to run meanwhile.
+   * \return The number of the swapped constants.
+   */
+  int SwapConstants();
   /*!
    * \brief Profile the end-to-end execution latency using virtual machine.
 
@@ -338,6 +494,56 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
  protected:
   /*! \brief Get device for params. */
   Device GetParamsDevice() const;
+  /*!
+   * \brief Build the OpEnvs missed by the runs on background threads, and dispatch the calls to
+   * the fallback OpEnvs of the given dialects meanwhile.
+   * \param num_threads The number of the background threads. Non-positive means disabled.
+   * \param dialects The dialects of the fallback OpEnvs, which are ready to run.
+   */
+  void SetAsyncCompile(int num_threads, const std::unordered_set<std::string>& dialects);
+  /*!
+   * \brief Stream the weights from the pinned host memory instead of keeping them on the device.
+   * \param buffer_bytes The bytes of the rotating device buffer. Non-positive means disabled.
+   * \param min_bytes The min bytes of a streamed constant. The smaller ones stay on the device.
+   */
+  void SetWeightStreaming(int64_t buffer_bytes, int64_t min_bytes);
+  /*!
+   * \brief Check the outputs of the ops for NaNs and Infs on the device during the runs.
+   * \param enable Whether to enable the watchdog, which resets its report.
+   * \param abort Whether to abort the run reading back a step with non-finite values.
+   * \param patterns The substrings of the names of the OpEnvs to check. Empty means all.
+   */
+  void SetNumericsWatchdog(bool enable, bool abort, const std::vector<std::string>& patterns);
+  /*!
+   * \brief Keep the hot tensors, i.e., the parameters and the constants read by several ops,
+   * persisting in the L2 cache of Ampere and later GPUs during their live ranges.
+   * \param max_bytes The max bytes of the L2 cache set aside. Non-positive means disabled.
+   * \param min_reuses The min number of the ops reading a hot tensor.
+   */
+  void SetL2Persistence(int64_t max_bytes, int64_t min_reuses);
+#ifdef RAF_USE_CUDA
+  /*!
+   * \brief Configure the CUDA graph cache.
+   * \param capacity The max number of cached graphs.
+   * \param mem_cap_mb The memory cap in MBs of the cached graphs. Non-positive means unlimited.
+   * \param buckets The buckets to pad the leading axis of inputs to.
+   */
+  void SetCudaGraphCache(int capacity, double mem_cap_mb, const std::vector<int64_t>& buckets);
+  /*!
+   * \brief Bind the inputs of a function to its CUDA graphs by reference, e.g., the weights and
+   * the KV caches of a decoder. They are neither copied into the graphs nor padded, so their
+   * in-place updates persist across the runs, and a graph is captured per their addresses.
+   * \param func_name The function.
+   * \param indices The indices of the persistent inputs.
+   */
+  void SetPersistentInputs(const std::string& func_name, const std::vector<int>& indices);
+  /*! \brief Evict the least recently used CUDA graphs that are over the cache limits. */
+  void EvictCudaGraphs();
+  /*! \brief Get the input shape padded to the smallest bucket along the leading axis. */
+  std::vector<int64_t> GetCudaGraphInputShape(const DLTensor* t) const;
+  /*! \brief Prepare a VM context whose CUDA graph matches the shape signature of the inputs. */
+  VMContext PrepareCudaGraphContext(Index func_index, const std::vector<Value>& inputs);
+#endif
   /*!
    * \brief Allocate memory on given device. For cuda device, it would allocate asynchronously on
    * current stream.
@@ -350,11 +556,78 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   inline std::shared_ptr<Memory> Alloc(const VMContext& ctx, Device dev, int64_t nbytes,
                                        int64_t alignment = kDefaultMemoryAlignment,
                                        bool alloc_async = true) const;
+  /*!
+   * \brief Get the region of an AllocStorage placed in a static arena of the current frame. The
+   * arena is allocated when the frame does not hold one that is large enough.
+   * \param ctx The VM context.
+   * \param dev The device of the arena.
+   * \param instr The AllocStorage instruction.
+   * \return The view of the region in the arena.
+   */
+  std::shared_ptr<Memory> AllocFromArena(VMContext& ctx, Device dev,
+                                         const Instruction& instr) const;
+  /*!
+   * \brief Prefetch the tensors of the next op in program order, which are already defined, to
+   * the device on the current stream. Used with managed_pool, whose memory may have been evicted
+   * to the host.
+   * \param ctx The VM context.
+   */
+  void PrefetchNextOp(VMContext& ctx) const;
+  /*!
+   * \brief Decode a VM function and build its dispatch table, if it has not been loaded yet.
+   * This method is thread-safe.
+   * \param func_index The index of the function.
+   */
+  void LoadFunction(Index func_index);
+  /*! \brief Load all VM functions ahead of time to move the decoding off the first run. */
+  void Warmup();
   /*! \brief Run VM dispatch loop. */
   virtual void RunLoop(VMContext& ctx);
-  /*! \brief Prepare an OpEnv with its inputs and output */
+  /*!
+   * \brief The pre-decoded handler of an instruction.
+   * \return Whether the instruction is the final return.
+   */
+  using InstrHandler = bool (VirtualMachine::*)(VMContext& ctx, const Instruction& instr);
+  /*! \brief Decode an instruction to its handler in the threaded dispatch table. */
+  InstrHandler DecodeInstruction(const Instruction& instr) const;
+  /*!
+   * \brief Run the direct-threaded dispatch loop over the pre-decoded handlers. No profiler hook
+   * is placed around instructions, so this loop is only used when instruction-level profiling
+   * is off.
+   */
+  void RunThreadedLoop(VMContext& ctx);
+  /*! \brief Adapt an instruction handler to the threaded dispatch table. */
+  template <void (VirtualMachine::*FHandle)(VMContext&, const Instruction&)>
+  bool ThreadedHandle(VMContext& ctx, const Instruction& instr);
+  /*! \brief Threaded handlers for the instructions without a standalone handler. */
+  bool ThreadedGoto(VMContext& ctx, const Instruction& instr);
+  bool ThreadedRet(VMContext& ctx, const Instruction& instr);
+  bool ThreadedFatal(VMContext& ctx, const Instruction& instr);
+  /*!
+   * \brief Prepare an OpEnv with its inputs and output, and the readable form of its cache key,
+   * which is only built when the profiler is on.
+   */
   virtual std::tuple<OpEnvPtr, std::vector<Value>, Value, std::string> PrepareOpEnv(
       const VMContext& ctx, const Instruction& instr);
+  /*!
+   * \brief Get the workspace arena shared by the OpEnvs on the current stream, which is grown when
+   * it is smaller than the request.
+   * \param ctx The VM context.
+   * \param dev The device of the workspace.
+   * \param nbytes The number of bytes requested.
+   * \return The workspace arena.
+   */
+  std::shared_ptr<Memory> GetSharedWorkspace(const VMContext& ctx, Device dev, int64_t nbytes);
+  /*! \brief Allocate the workspace requested by an OpEnv before it is executed. */
+  void AllocWorkspace(const VMContext& ctx, const OpEnvPtr& op_env);
+  /*! \brief Read the output registers of an InvokeJit instruction. */
+  Value ReadOutput(const VMContext& ctx, const Instruction& instr);
+  /*! \brief Query the OpEnv cache of an InvokeJit instruction, or dispatch a new OpEnv on miss. */
+  OpEnvPtr GetOrCreateOpEnv(const VMContext& ctx, const Instruction& instr,
+                            const Array<Value>& args, const Value& output,
+                            const HashKey& op_env_cache_key);
+  /*! \brief Bind the streams and the communicators requested by a new OpEnv. */
+  void BindRequests(const VMContext& ctx, const OpEnvPtr& op_env);
   /*! \brief Handle Move instruction*/
   virtual void HandleMove(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle LoadConst instruction*/
@@ -377,6 +650,8 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   virtual void HandleAllocClosure(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle Free instruction*/
   virtual void HandleFree(VMContext& ctx, const Instruction& instr);
+  /*! \brief Handle Kill instruction*/
+  virtual void HandleKill(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle InvokeFunc instruction*/
   virtual void HandleInvokeFunc(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle InvokeClosure instruction*/
@@ -397,14 +672,107 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
   virtual void HandleCudaWaitEvent(VMContext& ctx, const Instruction& instr);
   /*! \brief Handle CudaStreamBarrier instruction*/
   virtual void HandleCudaStreamBarrier(VMContext& ctx, const Instruction& instr);
+  /*! \brief Handle InvokeJitFree instruction*/
+  virtual void HandleInvokeJitFree(VMContext& ctx, const Instruction& instr);
+  /*! \brief Handle CudaSetStreamWait instruction*/
+  virtual void HandleCudaSetStreamWait(VMContext& ctx, const Instruction& instr);
+  /*! \brief Handle InvokeJitAsync instruction*/
+  virtual void HandleInvokeJitAsync(VMContext& ctx, const Instruction& instr);
+  /*! \brief Handle Wait instruction*/
+  virtual void HandleWait(VMContext& ctx, const Instruction& instr);
+  /*! \brief Release the memory held by a register (a storage or a tensor). */
+  void FreeRegister(VMContext& ctx, RegName reg);
+  /*!
+   * \brief Release the memory after the work issued so far on the streams launched since the
+   * memory is allocated, which are the streams that may use it.
+   */
+  void FreeAfterStreams(VMContext& ctx, std::shared_ptr<memory_pool::Memory> memory);
 
  protected:
+  /*! \brief A buffer in the double-buffered input staging area. */
+  struct InputStagingBuffer {
+    /*! \brief The pinned host tensors to stage the inputs. */
+    std::vector<Value> host;
+    /*! \brief The device tensors used as the inputs of the context. */
+    std::vector<Value> device;
+    /*! \brief The event recorded on the copy stream after uploading. */
+    std::shared_ptr<Event> copied;
+    /*! \brief The event recorded after the execution consuming the device tensors. */
+    std::shared_ptr<Event> consumed;
+  };
+  /*! \brief The double-buffered input staging area. */
+  std::vector<InputStagingBuffer> staging_buffers_;
+  /*! \brief The index of the staging buffer to use for the next prefetch. */
+  size_t next_staging_buffer_ = 0;
+  /*! \brief The mutex to access the staging area. */
+  std::mutex staging_mutex_;
+  /*! \brief A batch in the pipeline, whose outputs are being downloaded. */
+  struct PipelinedBatch {
+    /*! \brief The outputs on the device, which are kept until they are downloaded. */
+    Value device_outputs;
+    /*! \brief The outputs in the pinned host memory. */
+    Value host_outputs;
+    /*! \brief The event recorded on the compute stream after the execution. */
+    std::shared_ptr<Event> computed;
+    /*! \brief The event recorded on the copy stream after the download. */
+    std::shared_ptr<Event> downloaded;
+  };
+  /*! \brief The batches in the pipeline from the oldest to the newest. */
+  std::deque<PipelinedBatch> pipelined_batches_;
+  /*! \brief The events of the fetched batches, which are reused by the following batches. */
+  std::vector<std::pair<std::shared_ptr<Event>, std::shared_ptr<Event>>> pipeline_events_;
+  /*! \brief The mutex to access the pipeline. */
+  std::mutex pipeline_mutex_;
+
+  /*!
+   * \brief Resolve the streams used by the instructions of a function into streams_, including
+   * the communication stream requested by the OpEnvs of the collectives.
+   * \param instructions The instructions of the function.
+   * \return Whether the function launches collectives.
+   */
+  bool ResolveStreams(const std::vector<Instruction>& instructions);
+
+  /*! \brief The events taken by a context, which are recycled by the following runs. */
+  struct EventSet {
+    std::vector<std::vector<std::shared_ptr<Event>>> events;
+    std::vector<std::shared_ptr<Event>> barrier_events;
+    std::vector<std::vector<EventRing>> stream_events;
+  };
+  /*!
+   * \brief Hand the recycled events, if any, to the context before it runs, so a steady run
+   * does not take its events from the event pools one by one.
+   */
+  void AcquireEvents(VMContext& ctx);
+  /*! \brief Take back the events of the context after it runs. */
+  void RecycleEvents(VMContext& ctx);
+  /*! \brief The recycled events, of which at most max_concurrency_ sets are kept. */
+  std::vector<EventSet> recycled_events_;
+  /*! \brief The mutex to access the recycled events. */
+  std::mutex recycled_events_mutex_;
+
+  /*!
+   * \brief The workspace arenas shared by the OpEnvs launched on the same CUDA stream, keyed by
+   * the device id and the stream, with their sizes. The work on a stream is serialized, so the
+   * OpEnvs can borrow the same memory at execute time.
+   */
+  std::map<std::pair<int, void*>, std::pair<std::shared_ptr<Memory>, int64_t>> workspaces_;
+  /*! \brief The mutex to access the workspace arenas. */
+  std::mutex workspace_mutex_;
+
   /*! \brief The virtual machine's packed function table. */
   std::vector<PackedFunc> packed_funcs_;
   /*! \brief The executable the VM will operate on. */
   const Executable* exec_;
   /*! \brief The set of devices the VM is executing on. */
   std::vector<Device> devices_;
+  /*!
+   * \brief The streams of the schedules of the loaded functions, indexed by the device id and the
+   * stream id, which are resolved when the functions are loaded and shared by the contexts. The
+   * stream 0 is the default stream.
+   */
+  std::vector<std::vector<std::shared_ptr<Stream>>> streams_;
+  /*! \brief The mutex to access the resolved streams. */
+  std::mutex streams_mutex_;
   /*! \brief The host devices. */
   Device host_device_;
   /*!
@@ -412,17 +780,109 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * object to avoid rellocation of constants during inference.
    */
   std::vector<Value> const_pool_;
+  /*! \brief The mutex to access the constant pool, which is swapped by SwapConstants. */
+  std::mutex const_pool_mutex_;
+  /*! \brief The staged constants to swap into the constant pool, i.e., the back buffers. */
+  std::unordered_map<Index, Value> staged_constants_;
+  /*! \brief The constants swapped out by the last swap, which are reused as the back buffers. */
+  std::unordered_map<Index, Value> spare_constants_;
+  /*! \brief The events of the uploads of the staged constants, and of the swap on the device. */
+  std::shared_ptr<Event> constants_staged_event_;
+  std::shared_ptr<Event> constants_swapped_event_;
+  /*! \brief The mutex to access the staged constants. */
+  std::mutex staged_constants_mutex_;
+  /*!
+   * \brief Whether to take the device constants from the store shared among the VMs, which keys
+   * them by constant_names_ if given or by their contents otherwise.
+   */
+  bool share_constants_ = false;
+  std::unordered_map<Index, std::string> constant_names_;
+  /*!
+   * \brief The streamer of the weights, which keeps the large constants in the pinned host memory
+   * and prefetches them into a rotating device buffer. They are not cached in the constant pool.
+   */
+  std::shared_ptr<WeightStreamer> weight_streamer_;
+  /*! \brief The compiler building the missed OpEnvs in the background, if it is enabled. */
+  std::shared_ptr<AsyncCompiler> async_compiler_;
+  /*! \brief The watchdog checking the outputs of the ops for NaNs and Infs, if it is enabled. */
+  std::shared_ptr<NumericsWatchdog> numerics_watchdog_;
+  /*! \brief The access policy windows of the hot tensors on the streams, if it is enabled. */
+  std::shared_ptr<L2Persistence> l2_persistence_;
   /*!
    * \brief OpEnv cache. Each element in the vector stores the cache for the
    * corresponding VM function. It's a map from pc to the OpEnv cache.
    */
   std::vector<std::shared_ptr<VMFuncOpEnvCache>> op_env_cache_;
+  /*!
+   * \brief The results of the InferType instructions of each VM function, keyed by the pc and the
+   * shape signature of the arguments, so the types of a dynamic model are only inferred once for
+   * each signature. Its capacity is RAF_VM_INFER_TYPE_CACHE_CAPACITY, or unbounded if it is not
+   * set.
+   */
+  std::vector<std::shared_ptr<ShardedMetaCache<Value>>> infer_type_cache_;
+  /*!
+   * \brief The static OpEnv table. Each element in the vector stores the OpEnvs bound to the
+   * instructions of the corresponding VM function, indexed by pc. It is only used when the
+   * shapes of all InvokeJit instructions are static, so an OpEnv bound in the first run is valid
+   * for all following runs. Slots are published and read atomically, so concurrent contexts
+   * read the table without locking.
+   */
+  std::vector<std::vector<OpEnvPtr>> static_op_envs_;
+  /*!
+   * \brief The precomputed calls of the InvokeJit instructions of each VM function, indexed by
+   * pc. Like the static OpEnv table, it is only valid when the shapes are static, and its slots
+   * are published and read atomically.
+   */
+  std::vector<std::vector<PrecomputedCallPtr>> precomputed_calls_;
   /*! \brief Indicates whether to dryrun (skip op execution). */
   bool dryrun_ = false;
   /*! \brief Indicates whether CUDA is used. */
   bool use_cuda_ = false;
   /*! \brief Indicates whether CUDA Graph is enabled when VM is initialized. */
   bool enable_cuda_graph_ = false;
+  /*!
+   * \brief The max number of contexts that can run concurrently. In CUDA graph mode, each
+   * context owns a CUDA graph instance that is captured and replayed on its own stream.
+   */
+  int max_concurrency_ = 1;
+  /*!
+   * \brief The number of the intra-op threads of the CPU kernels, which is applied to the thread
+   * running the VM. Non-positive means the default of the thread pool.
+   */
+  int num_threads_ = 0;
+  /*!
+   * \brief The NUMA node that the thread running the VM is bound to, along with its intra-op
+   * threads and CPU memory. Negative means not bound.
+   */
+  int numa_node_ = -1;
+  /*!
+   * \brief The tenant charged by the memory allocated in the runs, whose partition of the device
+   * memory is set by memory_pool::Memory::SetTenantQuota. Empty means the default tenant.
+   */
+  std::string tenant_;
+  /*! \brief Indicates whether to use the direct-threaded dispatch loop. */
+  bool fast_dispatch_ = false;
+  /*!
+   * \brief Indicates whether to bind OpEnvs to instructions through the static OpEnv table,
+   * which skips building the hash key and locking the OpEnv cache.
+   */
+  bool static_op_env_ = false;
+  /*!
+   * \brief Indicates whether to precompute the call of each InvokeJit instruction in its first
+   * run, so the following runs only read the registers of the tensors fed to the bound OpEnv.
+   */
+  bool precompute_args_ = false;
+  /*!
+   * \brief The pre-decoded dispatch table built when loading the executable. Each element is
+   * the handlers of the instructions in the corresponding VM function, indexed by pc.
+   */
+  std::vector<std::vector<InstrHandler>> dispatch_tables_;
+  /*! \brief Whether each VM function has been loaded by LoadFunction. */
+  std::unique_ptr<std::once_flag[]> function_loaded_;
+  /*! \brief Whether each VM function launches collectives, set by LoadFunction. */
+  std::unique_ptr<bool[]> function_collectives_;
+  /*! \brief The thread loading the VM functions in the background. */
+  std::thread warmup_thread_;
 
 #ifdef RAF_USE_CUDA
   /*!
@@ -431,17 +891,66 @@ class VirtualMachine : public tvm::runtime::ModuleNode {
    * Cached CUDA Graph is stored in this class, as well as stream for capturing.
    */
   class CudaGraphImpl;
-  /*! \brief A pointer into the CUDA Graph instance. */
-  CudaGraphImpl* cuda_graph_impl_ = nullptr;
-  /*! \brief The context associated with the captured CUDA graph. */
-  VMContext cuda_graph_ctx_;
-  /*! \brief Indicate whether the CUDA graph is currently in use by a context. */
-  bool cuda_graph_occupied_ = false;
+  /*! \brief A CUDA graph instance in the cache, together with the context it is captured from. */
+  struct CudaGraphSlot {
+    /*! \brief The shape signature of the function and its inputs captured by the graph. */
+    std::string signature;
+    /*! \brief The pool memory in MBs grown when capturing the graph. */
+    float mem_mb = 0;
+    /*! \brief A pointer into the CUDA Graph instance. */
+    std::shared_ptr<CudaGraphImpl> impl;
+    /*! \brief The context associated with the captured CUDA graph. */
+    VMContext ctx;
+    /*! \brief Indicate whether the CUDA graph is currently in use by a context. */
+    bool occupied = false;
+    /*! \brief Whether the CUDA graph launches collectives. */
+    bool collectives = false;
+  };
+  /*!
+   * \brief The cache of CUDA graph instances keyed by shape signature, ordered from the most
+   * recently used to the least recently used.
+   */
+  std::list<CudaGraphSlot> cuda_graph_slots_;
+  /*! \brief The max number of cached CUDA graphs. */
+  int cuda_graph_cache_size_ = max_concurrency_;
+  /*! \brief The memory cap in MBs of the cached CUDA graphs. Non-positive means unlimited. */
+  double cuda_graph_mem_cap_mb_ = 0;
+  /*! \brief The sorted buckets to pad the leading axis of inputs to. Empty means no padding. */
+  std::vector<int64_t> cuda_graph_buckets_;
+  /*! \brief The indices of the inputs bound to the CUDA graphs by reference, per function. */
+  std::unordered_map<Index, std::unordered_set<int>> cuda_graph_persistent_inputs_;
   /*! \brief The mutex to access CUDA graph related fields. */
   std::mutex cuda_graph_mutex_;
+  /*!
+   * \brief The mutex to serialize CUDA graph capturing, because the working stream of the
+   * backends is a global state during capturing.
+   */
+  std::mutex cuda_graph_capture_mutex_;
+  /*!
+   * \brief The mutex to serialize the replays of the CUDA graphs launching collectives, because
+   * the collectives of a communicator must be issued in the same order on all the ranks.
+   */
+  std::mutex cuda_graph_collective_mutex_;
 #endif
 };
 
+/*!
+ * \brief Create a virtual machine running an executable, which must outlive the virtual machine.
+ *
+ * \param exec The executable.
+ * \param enable_cuda_graph Whether to capture the functions into CUDA graphs.
+ * \param dryrun Whether to skip the execution of the ops.
+ * \param fast_dispatch Whether to use the direct-threaded dispatch loop.
+ * \param static_op_env Whether to bind the OpEnvs to the instructions through the static OpEnv
+ * table.
+ * \param max_concurrency The max number of the concurrent runs.
+ *
+ * \return The virtual machine.
+ */
+tvm::runtime::Module CreateVirtualMachine(const Executable* exec, bool enable_cuda_graph,
+                                          bool dryrun, bool fast_dispatch, bool static_op_env,
+                                          int max_concurrency);
+
 }  // namespace vm
 }  // namespace executor
 }  // namespace raf
@@ -16,10 +16,11 @@ except:  # pylint: disable=bare-except
 # compatible libraries.
 from ._lib import *
 
-from ._core.ndarray import array, ndarray
+from ._core.ndarray import array, from_dlpack, ndarray
 from ._op.imp import *  # pylint: disable=redefined-builtin
 from . import frontend
 from . import amp
+from . import quantization
 from . import random
 from . import build
 from . import ir
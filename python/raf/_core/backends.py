@@ -22,5 +22,16 @@ class CUDNNConfig:  # pylint: disable=too-few-public-methods
         """Set the benchmark flag."""
         _ffi.backend.cudnn.ConfigSetBenchmark(benchmark)
 
+    @property
+    def workspace_limit(self):
+        """Get the workspace limit in bytes. The CUDNN algorithms that require a larger workspace,
+        which is also allocated to benchmark them, are skipped. 0 means no limit."""
+        return _ffi.backend.cudnn.ConfigGetWorkspaceLimit()
+
+    @workspace_limit.setter
+    def workspace_limit(self, workspace_limit):
+        """Set the workspace limit in bytes."""
+        _ffi.backend.cudnn.ConfigSetWorkspaceLimit(workspace_limit)
+
 
 cudnn = CUDNNConfig()
@@ -3,7 +3,7 @@
 
 """RAF executor."""
 # pylint: disable=no-else-return,unidiomatic-typecheck,undefined-variable,invalid-name
-# pylint: disable=protected-access
+# pylint: disable=protected-access,global-statement
 import os
 import tvm
 from tvm import auto_scheduler, autotvm
@@ -31,6 +31,36 @@ def interpret(expr, module=None):
     return _ffi.executor.Interpret(expr, module)
 
 
+def set_async_interpret(enable=True):
+    """Enable or disable the asynchronous eager mode of the interpreter. In this mode, the ops
+    are executed by a worker thread in order, and the host dispatches the next ops without
+    waiting for them. The host only synchronizes when it reads the data, such as converting
+    a tensor to numpy. It can also be enabled by the environment variable RAF_INTERPRETER_ASYNC=1.
+
+    Parameters
+    ----------
+    enable : bool
+        Whether to enable the asynchronous mode. Disabling it waits for the enqueued ops.
+    """
+    _ffi.executor.SetAsyncInterpret(enable)
+
+
+def is_async_interpret():
+    """Whether the asynchronous eager mode of the interpreter is enabled.
+
+    Returns
+    -------
+    ret : bool
+        Whether the asynchronous mode is enabled.
+    """
+    return _ffi.executor.IsAsyncInterpret()
+
+
+def synchronize():
+    """Wait for the ops enqueued by the asynchronous eager mode of the interpreter to finish."""
+    _ffi.executor.Synchronize()
+
+
 class MetaFallbackContext(ApplyHistoryBest):
     """
     The RAF fallback dispatch context, which queries the builtin schedules and outputs
@@ -92,11 +122,28 @@ class MetaFallbackContext(ApplyHistoryBest):
         return None
 
 
-def init_auto_scheduler_dispatch_context():
-    """Initialize auto scheduler dispatch context."""
+_ROOT_DISPATCH_CONTEXT = None
+
+
+def init_auto_scheduler_dispatch_context(records=None):
+    """Initialize auto scheduler dispatch context. It replaces the previous root context if it is
+    the current one.
+
+    Parameters
+    ----------
+    records: Optional[str]
+        The tuning records to be loaded in addition to the builtin schedules.
+    """
+    global _ROOT_DISPATCH_CONTEXT
     verbose = int(os.environ["RAF_SCH_VERBOSE"]) if "RAF_SCH_VERBOSE" in os.environ else 0
     env = MetaFallbackContext(verbose=verbose)
+    if records is not None:
+        env.load(records)
+    root = _ROOT_DISPATCH_CONTEXT
+    if root is not None and auto_scheduler.DispatchContext.current is root:
+        root.__exit__(None, None, None)
     env.__enter__()
+    _ROOT_DISPATCH_CONTEXT = env
 
 
 init_auto_scheduler_dispatch_context()
@@ -119,9 +166,41 @@ class VMExecutor:
 
     dryrun: bool
         Whether to create a dryrun VM that skips the op execution.
+
+    fast_dispatch: bool
+        Whether to use the direct-threaded dispatch loop in the VM.
+
+    static_op_env: bool
+        Whether to bind OpEnvs to VM instructions after the first run. Only valid when the input
+        shapes do not change across runs.
+
+    max_concurrency: int
+        The max number of contexts that can run concurrently in the VM.
+
+    num_threads: int
+        The number of the intra-op threads of the CPU kernels. Non-positive means the default.
+
+    numa_node: int
+        The NUMA node to bind the VM to. Negative means not to bind the VM.
+
+    precompute_args: bool
+        Whether to precompute the op calls of VM instructions after the first run. Only valid
+        when the input shapes do not change across runs.
     """
 
-    def __init__(self, mod, device, enable_cuda_graph=False, dryrun=False):
+    def __init__(
+        self,
+        mod,
+        device,
+        enable_cuda_graph=False,
+        dryrun=False,
+        fast_dispatch=False,
+        static_op_env=False,
+        max_concurrency=1,
+        num_threads=0,
+        numa_node=-1,
+        precompute_args=False,
+    ):  # pylint: disable=too-many-arguments
         if mod is None:
             raise RuntimeError("Must provide module to get VM executor.")
         if "gpu" not in device and "cuda" not in device:
@@ -129,8 +208,19 @@ class VMExecutor:
         self.device = Device(device)
         self.executable = vm.compile(mod, self.device)
         self.vm = vm.VirtualMachine(
-            self.executable, self.device, enable_cuda_graph=enable_cuda_graph, dryrun=dryrun
+            self.executable,
+            self.device,
+            enable_cuda_graph=enable_cuda_graph,
+            dryrun=dryrun,
+            fast_dispatch=fast_dispatch,
+            static_op_env=static_op_env,
+            max_concurrency=max_concurrency,
+            precompute_args=precompute_args,
         )
+        if num_threads > 0:
+            self.vm.set_num_threads(num_threads)
+        if numa_node >= 0:
+            self.vm.set_numa_node(numa_node)
 
     @staticmethod
     def _make_vm_helper(maker, sch_file=None):
@@ -18,7 +18,7 @@ from raf._ffi.binding import (
 )
 from raf._ffi.tensor import MarkNumpy
 from raf._ffi.value import ToTVM
-from raf._lib import _register_func, relay, tvm_ndarray
+from raf._lib import _register_func, relay, tvm, tvm_ndarray
 from raf._lib import TensorContainer as _DLManagedTensor
 
 
@@ -124,6 +124,27 @@ class ndarray:  # pylint: disable=invalid-name,too-many-instance-attributes
     def numpy(self):
         return ToTVM(self.__value).numpy()  # pylint: disable=protected-access
 
+    def __dlpack__(self, stream=None):
+        """Export the array as a DLPack capsule without copying. The capsule keeps the memory
+        of the array alive, so the consumer may outlive the array.
+
+        Parameters
+        ----------
+        stream : Optional[int]
+            The CUDA stream of the consumer, which waits for the ops producing the array. None
+            or 1 is the legacy default stream, where RAF launches the ops, and -1 skips the
+            synchronization.
+
+        Returns
+        -------
+        capsule : PyCapsule
+            The DLPack capsule.
+        """
+        return self.__value.__dlpack__(stream)
+
+    def __dlpack_device__(self):
+        return self.__value.__dlpack_device__()
+
     @property
     def device(self):
         return self.__device
@@ -372,6 +393,35 @@ def array(
     return ndarray(BindNDArray(_np_to_tensor_value(npa, device=device), None, name))
 
 
+@set_module("raf")
+def from_dlpack(tensor, name=""):
+    """Create an array sharing the memory of a tensor of another framework, e.g., PyTorch,
+    without copying. The tensor is kept alive by the array.
+
+    Parameters
+    ----------
+    tensor : object
+        The tensor implementing the DLPack protocol, i.e., __dlpack__ and __dlpack_device__, or
+        a DLPack capsule.
+
+    name : str
+        The name of the array.
+
+    Returns
+    -------
+    ret : ndarray
+        The array.
+    """
+    if hasattr(tensor, "__dlpack__"):
+        device_type, _ = tensor.__dlpack_device__()
+        # RAF launches the ops on the legacy default stream of CUDA, which waits for the
+        # producer of the tensor.
+        is_cuda = device_type == tvm.runtime.Device.kDLCUDA
+        tensor = tensor.__dlpack__(stream=1) if is_cuda else tensor.__dlpack__()
+    value = TensorValue.from_tvm(tvm.nd.from_dlpack(tensor))
+    return ndarray(BindNDArray(value, None, name))
+
+
 _DL_MANAGED_TENSOR_PTR = ctypes.POINTER(_DLManagedTensor)
 
 
@@ -95,6 +95,15 @@ class TensorValue(BaseTensorValue):
     def numpy(self):
         return ToTVM(self).numpy()
 
+    def __dlpack__(self, stream=None):
+        # See ndarray.__dlpack__.
+        stream = 1 if stream is None else stream
+        return ffi.ToDLPack(self, stream).to_dlpack()
+
+    def __dlpack_device__(self):
+        device = self.dltensor_handle.contents.device
+        return (int(device.device_type), int(device.device_id))
+
 
 @register_node("raf.value.TensorTypeValue")
 class TensorTypeValue(BaseTensorValue):
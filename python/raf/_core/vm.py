@@ -3,6 +3,8 @@
 
 """RAF virtual machine and utility functions."""
 # pylint: disable=no-self-use
+import atexit
+
 import numpy as np
 import tvm
 
@@ -22,11 +24,13 @@ class Executable:
         self.mod = mod
         self._function_params = {}
         self._save = self.mod["save"]
+        self._save_to_file = self.mod["save_to_file"]
         self._get_lib = self.mod["get_lib"]
         self._get_bytecode = self.mod["get_bytecode"]
         self._get_stats = self.mod["get_stats"]
         self._get_function_arity = self.mod["get_function_arity"]
         self._get_function_param_name = self.mod["get_function_param_name"]
+        self._get_constants = self.mod["get_constants"]
 
     def save(self):
         """Save the RAF VM Executable.
@@ -93,6 +97,71 @@ class Executable:
         """
         return self._save(), self._get_lib()
 
+    def save_to_file(self, path):
+        """Save the RAF VM Executable to a file in the memory-mapped format.
+
+        Unlike :py:meth:`save`, the data of the tensor constants is stored page-aligned at the
+        end of the file, so :py:meth:`load_from_file` maps it instead of parsing and copying it.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file.
+
+        Returns
+        -------
+        lib : :py:class:`~tvm.runtime.Module`
+            The runtime module that contains the generated code.
+        """
+        self._save_to_file(path)
+        return self._get_lib()
+
+    @staticmethod
+    def load_from_file(path, lib=None):
+        """Construct an executable from a file saved by :py:meth:`save_to_file`.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file.
+
+        lib : Optional[:py:class:`~tvm.runtime.Module`]
+            The runtime module that contains the generated code.
+
+        Returns
+        -------
+        exec: Executable
+            An executable whose tensor constants refer to the mapped file.
+        """
+        if lib is not None and not isinstance(lib, tvm.runtime.Module):
+            raise TypeError(
+                "lib is expected to be the type of tvm.runtime.Module"
+                + ", but received {}".format(type(lib))
+            )
+        return Executable(_ffi.vm.Load_ExecutableFromFile(path, lib))
+
+    @staticmethod
+    def load_deployment(path, bundle):
+        """Construct an executable from a file saved by :py:meth:`save_to_file` with its kernel
+        bundle, as the runtime library does without Python. It redirects the persistent caches to
+        the bundle, so the kernels are loaded from the bundle instead of being built.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file.
+
+        bundle : str
+            The directory of the kernel bundle, e.g., the one given to
+            :py:meth:`VirtualMachine.build_op_envs`.
+
+        Returns
+        -------
+        exec: Executable
+            An executable whose tensor constants refer to the mapped file.
+        """
+        return Executable(_ffi.vm.Load_ExecutableDeployment(path, bundle))
+
     @staticmethod
     def load_exec(bytecode, lib):
         """Construct an executable from saved artifacts.
@@ -216,6 +285,18 @@ class Executable:
         """Return the runtime module contained in a virtual machine executable."""
         return self.mod
 
+    @property
+    def constants(self):
+        """Get the constant pool, whose indices are used by
+        :py:meth:`VirtualMachine.update_constants`.
+
+        Returns
+        -------
+        ret : List[Value]
+            The constants in the order of their indices.
+        """
+        return list(self._get_constants())
+
     def get_function_params(self, func_name):
         """Get VM Function parameters
 
@@ -333,7 +414,8 @@ class VMCompiler:
         """
         return self._get_exec()
 
-    def _unify_device(self, device):
+    @staticmethod
+    def _unify_device(device):
         """Unifiy device to be a dict that maps from device type names to
         the corresponding Device object.
 
@@ -390,15 +472,230 @@ def compile(mod, device=None, params=None):  # pylint: disable=redefined-builtin
     -------
     exec : raf.executor.Executable
         The VM executable that contains both library code and bytecode.
+
+    Notes
+    -----
+    Without params, the executable is reused from the executable cache if the module was
+    compiled for the same devices under the same pass context, e.g., the same model with the
+    same input types. See set_executable_cache_capacity.
     """
+    if not params:
+        return Executable(_ffi.vm.CompileCached(mod, VMCompiler._unify_device(device)))
     compiler = VMCompiler()
-    if params:
-        compiler.set_params(params)
+    compiler.set_params(params)
     compiler.lower(mod, device)
     return Executable(compiler.get_exec())
 
 
+def set_executable_cache_capacity(capacity):
+    """Set the max number of the executables kept by compile, where the least recently used ones
+    are evicted first. Default 16.
+
+    Parameters
+    ----------
+    capacity : int
+        The capacity. 0 to disable the cache.
+    """
+    _ffi.vm.SetExecutableCacheCapacity(capacity)
+
+
+def clear_executable_cache():
+    """Drop the executables kept by compile and reset the statistics of the cache."""
+    _ffi.vm.ClearExecutableCache()
+
+
+def get_executable_cache_stats():
+    """Get the statistics of the executable cache.
+
+    Returns
+    -------
+    ret : Dict[str, int]
+        The number of the cached executables ("size"), and the number of the compilations that
+        reuse ("hits") or build ("misses") an executable.
+    """
+    return {key: value.value for key, value in _ffi.vm.GetExecutableCacheStats().items()}
+
+
 # pylint: disable=protected-access
+def set_kernel_bundle(path):
+    """Store and load the built kernels and the tuned algorithms, e.g., cuDNN algorithms and
+    CUTLASS configs, under the given directory. It redirects the persistent caches, so it
+    should be called before running any model.
+
+    Parameters
+    ----------
+    path : Optional[str]
+        The directory of the kernel bundle. None to stop persisting the caches.
+    """
+    _ffi.cache.SetPersistCacheRoot(path or "")
+
+
+def link_kernel_bundle():
+    """Link the TVM kernels built by this process since the kernel bundle is set into one shared
+    library with an index file under the bundle. A process that sets the bundle loads the
+    library once and resolves the kernels by their keys, instead of loading a shared library
+    per kernel.
+
+    Returns
+    -------
+    ret : int
+        The number of the linked kernels.
+    """
+    return _ffi.cache.BundleTVMCache()
+
+
+_REMOTE_CACHE_AT_EXIT = False
+
+
+def set_remote_cache(path=None, fetch=None, upload=None):
+    """Put a remote tier shared by the nodes behind the persistent caches, i.e., the kernel
+    bundle. A miss of the local caches is fetched from the remote tier, and a new entry is
+    uploaded to it in the background. The pending uploads are flushed at exit.
+
+    Parameters
+    ----------
+    path : Optional[str]
+        A directory mounted on all the nodes as the remote tier.
+
+    fetch : Optional[Callable[[str, str], bool]]
+        Download the object of a key, e.g., "<cache name>/<entry name>", into an empty local
+        directory, and return whether the object exists. It is used with upload instead of path,
+        e.g., to access an object store by its client library.
+
+    upload : Optional[Callable[[str, str], None]]
+        Upload a local directory as the object of a key. It may be called from another thread.
+
+    Both path and the functions are None to disable the remote tier.
+    """
+    if path is not None:
+        _ffi.cache.SetRemoteCacheDir(path)
+    elif fetch is not None and upload is not None:
+        _ffi.cache.SetRemoteCacheFuncs(fetch, upload)
+    else:
+        assert fetch is None and upload is None, "fetch and upload must be given together"
+        _ffi.cache.DisableRemoteCache()
+        return
+    global _REMOTE_CACHE_AT_EXIT  # pylint: disable=global-statement
+    if not _REMOTE_CACHE_AT_EXIT:
+        atexit.register(_ffi.cache.FlushRemoteCache)
+        _REMOTE_CACHE_AT_EXIT = True
+
+
+def publish_remote_cache(fingerprint):
+    """Publish the entries used by this process as the manifest of a model, after uploading
+    the pending entries, so the other nodes prefetch them before compiling the model.
+
+    Parameters
+    ----------
+    fingerprint : str
+        The fingerprint of the model, e.g., its name, version and the device.
+
+    Returns
+    -------
+    ret : int
+        The number of the entries in the manifest.
+    """
+    return _ffi.cache.PublishRemoteCache(fingerprint)
+
+
+def prefetch_remote_cache(fingerprint):
+    """Fetch the entries in the manifest of a model from the remote tier into the persistent
+    caches, which should be called at startup after setting the kernel bundle.
+
+    Parameters
+    ----------
+    fingerprint : str
+        The fingerprint of the model given to publish_remote_cache.
+
+    Returns
+    -------
+    ret : int
+        The number of the fetched entries, which excludes the ones that are already local.
+    """
+    return _ffi.cache.PrefetchRemoteCache(fingerprint)
+
+
+def get_shared_constant_stats():
+    """Get the device constants shared among the VMs.
+
+    Returns
+    -------
+    ret : Tuple[int, int]
+        The number of the shared constants and their bytes.
+    """
+    count, nbytes = _ffi.vm.GetSharedConstantStats()
+    return count.value, nbytes.value
+
+
+def release_shared_constants():
+    """Release the shared constants that are no longer used by any VM, which is also done when a
+    VM sharing the constants is destroyed."""
+    _ffi.vm.ReleaseSharedConstants()
+
+
+def _as_device(device):
+    return device if isinstance(device, Device) else Device(device)
+
+
+def set_tenant_quota(device, tenant, quota_mb, reserved_mb=0):
+    """Set the partition of the device memory of a tenant, which is charged by the VMs set to the
+    tenant by :py:meth:`VirtualMachine.set_tenant`. An allocation of the tenant fails if it exceeds
+    the quota, or if it cuts into the memory reserved by the other tenants.
+
+    Parameters
+    ----------
+    device : Union[str, Device]
+        The device.
+
+    tenant : str
+        The tenant.
+
+    quota_mb : float
+        The max memory in use by the tenant in MBs. 0 means no limit.
+
+    reserved_mb : float
+        The memory kept for the tenant in MBs, which requires the partition capacity set by
+        :py:func:`set_partition_capacity`.
+    """
+    _ffi.memory_pool.SetTenantQuota(_as_device(device), tenant, quota_mb, reserved_mb)
+
+
+def set_partition_capacity(device, capacity_mb):
+    """Set the memory of the device shared by the tenants, which bounds their reservations and
+    the memory in use by all of them. It should leave room for the memory cached by the pool.
+
+    Parameters
+    ----------
+    device : Union[str, Device]
+        The device.
+
+    capacity_mb : float
+        The capacity in MBs. 0 means unbounded, in which case nothing can be reserved.
+    """
+    _ffi.memory_pool.SetPartitionCapacity(_as_device(device), capacity_mb)
+
+
+def get_tenant_stats(device):
+    """Get the partitions of the tenants of the device and their counters.
+
+    Parameters
+    ----------
+    device : Union[str, Device]
+        The device.
+
+    Returns
+    -------
+    ret : Dict[str, Dict[str, int]]
+        The quota, the reservation, the bytes in use and their peak, and the numbers of the
+        requests and the rejected requests of each tenant.
+    """
+    stats = _ffi.memory_pool.GetTenantStats(_as_device(device))
+    return {
+        str(tenant): {key: value.value for key, value in counters.items()}
+        for tenant, counters in stats.items()
+    }
+
+
 def _convert(arg):
     if isinstance(arg, np.ndarray):
         nd_arr = _nd.array(arg, device="cpu")
@@ -407,6 +704,9 @@ def _convert(arg):
         return arg._ndarray__value
     if isinstance(arg, (tuple, list)):
         return TupleValue([_convert(x) for x in arg])
+    if hasattr(arg, "__dlpack__"):
+        # The tensors of the other frameworks, e.g., PyTorch, are consumed in place.
+        return _nd.from_dlpack(arg)._ndarray__value
     raise TypeError("Unsupported type: %s" % (type(arg)))
 
 
@@ -436,20 +736,368 @@ class VirtualMachine:
 
     dryrun: bool
         Whether to create a dryrun VM that skips the op execution.
+
+    fast_dispatch: bool
+        Whether to use the direct-threaded dispatch loop that runs the instructions through
+        a handler table pre-decoded at loading time. Instruction-level profiling (level 2)
+        falls back to the default dispatch loop.
+
+    static_op_env: bool
+        Whether to bind the OpEnv of each op call to its instruction after the first run, and
+        reuse it without querying the OpEnv cache. It should only be enabled when the input
+        shapes of the model do not change across runs.
+
+    precompute_args: bool
+        Whether to precompute the call of each op in its first run, i.e., bind its OpEnv and
+        record the registers of the tensors it reads, so the following runs neither convert the
+        args to the schema nor hash them. It targets the small ops whose launch is bound by the
+        host, and should only be enabled when the input shapes of the model do not change
+        across runs.
+
+    max_concurrency: int
+        The max number of contexts that can run concurrently. In CUDA graph mode, each context
+        owns a CUDA graph instance replayed on its own stream, so up to this number of requests
+        can be in flight on one GPU. Default 1.
     """
 
-    def __init__(self, exe, device, enable_cuda_graph=False, dryrun=False):
+    def __init__(
+        self,
+        exe,
+        device,
+        enable_cuda_graph=False,
+        dryrun=False,
+        fast_dispatch=False,
+        static_op_env=False,
+        max_concurrency=1,
+        precompute_args=False,
+    ):  # pylint: disable=too-many-arguments
         if not isinstance(exe, Executable):
             raise TypeError(
                 "mod is expected to be the type of Executable, but received {}".format(type(exe))
             )
-        self.module = _ffi.vm.VirtualMachine(exe.module, enable_cuda_graph, dryrun)
+        self.module = _ffi.vm.VirtualMachine(
+            exe.module, enable_cuda_graph, dryrun, fast_dispatch, static_op_env, max_concurrency
+        )
         self._exec = exe
         self._set_devices = self.module["set_devices"]
         self._prepare_context = self.module["prepare_context"]
+        self._prepare_context_async = self.module["prepare_context_async"]
         self._run = self.module["run"]
         self._profile = self.module["profile"]
+        self._set_cuda_graph_cache = self.module["set_cuda_graph_cache"]
+        self._set_persistent_inputs = self.module["set_persistent_inputs"]
+        self._warmup = self.module["warmup"]
+        self._build_op_envs = self.module["build_op_envs"]
+        self._set_num_threads = self.module["set_num_threads"]
+        self._set_numa_node = self.module["set_numa_node"]
+        self._set_tenant = self.module["set_tenant"]
+        self._stage_constants = self.module["stage_constants"]
+        self._swap_constants = self.module["swap_constants"]
+        self._get_constant = self.module["get_constant"]
+        self._set_share_constants = self.module["set_share_constants"]
+        self._set_weight_streaming = self.module["set_weight_streaming"]
+        self._get_weight_streaming_stats = self.module["get_weight_streaming_stats"]
+        self._set_l2_persistence = self.module["set_l2_persistence"]
+        self._get_l2_persistence_stats = self.module["get_l2_persistence_stats"]
         self._set_devices(device)
+        if precompute_args:
+            self.module["set_precompute_args"](True)
+
+    def warmup(self, background=False):
+        """Load all the VM functions ahead of time. Otherwise, a function is decoded and its
+        dispatch table is built when it is invoked for the first time.
+
+        Parameters
+        ----------
+        background : bool
+            Whether to load the functions on a background thread and return immediately.
+        """
+        self._warmup(background)
+
+    def set_num_threads(self, num_threads):
+        """Set the number of the intra-op threads of the CPU kernels, i.e., the TVM kernels and
+        the BLAS library. It applies to the thread running the VM, so VMs running on different
+        threads can use different numbers of threads.
+
+        Parameters
+        ----------
+        num_threads : int
+            The number of threads. Non-positive means the default, which is the number of the
+            physical cores or TVM_NUM_THREADS.
+        """
+        self._set_num_threads(num_threads)
+
+    def set_numa_node(self, node):
+        """Bind the VM to a NUMA node, i.e., a socket of the host. The thread running the VM and
+        its intra-op threads run on the cores of the node, and the CPU memory allocated by the VM
+        is placed on the node and pooled in the arena of the node.
+
+        Parameters
+        ----------
+        node : int
+            The NUMA node. Negative means not to bind the VM.
+        """
+        self._set_numa_node(node)
+
+    def set_tenant(self, tenant):
+        """Charge the memory allocated by the VM to a tenant, whose partition of the device memory
+        is set by :py:func:`set_tenant_quota`, so the models packed on a device cannot take the
+        memory of each other.
+
+        Parameters
+        ----------
+        tenant : str
+            The tenant. Empty means the default tenant.
+        """
+        self._set_tenant(tenant)
+
+    def set_cuda_graph_cache(self, capacity, mem_cap_mb=0, buckets=None):
+        """Configure the CUDA graph cache keyed by the shape signature of inputs.
+
+        Parameters
+        ----------
+        capacity : int
+            The max number of cached CUDA graphs. It must be no less than max_concurrency.
+            The least recently used graph is evicted when the cache is full.
+
+        mem_cap_mb : float
+            The memory cap in MBs of the cached CUDA graphs. Non-positive means unlimited.
+
+        buckets : Optional[List[int]]
+            The buckets to pad the leading axis of inputs to, so inputs of different lengths
+            can replay the same graph. The padding is filled with zeros, and the outputs keep
+            the padded shape.
+        """
+        buckets = buckets or []
+        self._set_cuda_graph_cache(capacity, float(mem_cap_mb), *buckets)
+
+    def set_persistent_inputs(self, indices, func_name="main"):
+        """Bind the inputs of a function to its CUDA graphs by reference, e.g., the weights and
+        the KV caches of a decoder. They are neither copied into the graphs nor padded, so the
+        in-place updates of them persist across the runs. A graph is captured per their
+        addresses, so they should be the same tensors across the runs. The persistent inputs
+        must be on the device of the VM. Without CUDA graphs, the inputs on the device are
+        always used by reference.
+
+        Parameters
+        ----------
+        indices : List[int]
+            The indices of the persistent inputs.
+
+        func_name : str
+            The function.
+        """
+        self._set_persistent_inputs(func_name, *indices)
+
+    def share_constants(self, enable=True, names=None):
+        """Take the device constants from the store shared among the VMs in the process, so the
+        replicas or the variants of a model that have the same weights only keep them on the
+        device once. It should be set before the first run, which loads the constants.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to share the constants.
+
+        names : Optional[Dict[int, str]]
+            The names to key the constants by, indexed as :py:attr:`Executable.constants`. The
+            constants with the same name are shared, which must have the same shape and dtype.
+            The other constants are keyed by their contents.
+        """
+        self._set_share_constants(enable, names or {})
+
+    def async_compile(self, num_threads=1, fallback_dialects=("cublas", "cudnn", "cblas")):
+        """Build the OpEnvs missed by the runs, e.g., the TVM kernels to compile and the CUTLASS
+        kernels to tune for the new shapes, on background threads. The missed calls are
+        dispatched to the fallback OpEnvs of the library dialects meanwhile, and the built OpEnvs
+        are switched in on their next calls. A call without a fallback, e.g., of a fused function
+        of many ops, builds its OpEnv in place. It does not apply with CUDA graphs, static OpEnvs
+        or precomputed arguments, which bind the OpEnvs to the instructions.
+
+        Parameters
+        ----------
+        num_threads : int
+            The number of the background threads. Non-positive means not to build in the
+            background, which waits for the OpEnvs being built.
+
+        fallback_dialects : Iterable[str]
+            The dialects of the fallback OpEnvs, which are ready to run without compilation or
+            tuning.
+        """
+        self.module["set_async_compile"](num_threads, *fallback_dialects)
+
+    def wait_async_compile(self):
+        """Wait for the OpEnvs being built in the background."""
+        self.module["wait_async_compile"]()
+
+    def async_compile_stats(self):
+        """Get the stats of the OpEnvs built in the background.
+
+        Returns
+        -------
+        ret : Dict[str, int]
+            The number of the OpEnvs submitted, of the calls served by the fallbacks, and of the
+            OpEnvs built and failed to build.
+        """
+        stats = self.module["get_async_compile_stats"]()
+        return {key: int(value) for key, value in stats.items()}
+
+    def watch_numerics(self, enable=True, ops=None, abort=False):
+        """Check the outputs of the ops for NaNs and Infs during the runs. A small kernel checks
+        each float output of the selected ops right after it on its stream, and the results of a
+        run are copied to the host asynchronously and read back at the end of the next run, so the
+        runs are not synchronized. The first op writing non-finite values in a run is logged by its
+        OpEnv, pc and function. It cannot be enabled with CUDA graphs.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to enable the watchdog. Enabling it again resets its report.
+
+        ops : Optional[List[str]]
+            The substrings of the names of the OpEnvs to check, e.g., "conv2d". None means all.
+
+        abort : bool
+            Whether to abort the run reading back the non-finite values instead of warning.
+        """
+        self.module["set_numerics_watchdog"](enable, abort, *(ops or []))
+
+    def numerics_report(self):
+        """Read back the runs checked by the numerics watchdog, and get its report.
+
+        Returns
+        -------
+        ret : Dict[str, Union[int, float, str]]
+            The number of the runs read back and of those with non-finite values, the number of
+            the non-finite values and the absolute maximum of the finite ones in the last run,
+            and the function, the pc and the OpEnv writing the first non-finite values in the last
+            bad run.
+        """
+        report = self.module["get_numerics_report"]()
+        ret = {key: value for key, value in report.items()}
+        for key in ("num_steps", "num_bad_steps", "num_nonfinite", "first_func", "first_pc"):
+            ret[key] = int(ret[key])
+        ret["abs_max"] = float(ret["abs_max"].value)
+        ret["first_op"] = str(ret["first_op"])
+        return ret
+
+    def stream_weights(self, buffer_mb, min_kb=64):
+        """Keep the weights in the pinned host memory and stream them into a rotating device
+        buffer, so a model larger than the device memory can run. The weights are prefetched on
+        the copy stream in the order they are loaded, and a region of the buffer is reused once
+        the weight in it is freed by the VM. A weight that does not fit into the buffer is copied
+        on the compute stream instead. It only applies to the CUDA devices without CUDA graphs,
+        precomputed arguments or shared constants, and the streamed weights cannot be updated.
+
+        Parameters
+        ----------
+        buffer_mb : float
+            The size in MBs of the rotating device buffer. Non-positive means not to stream.
+
+        min_kb : float
+            The min size in KBs of a streamed weight. The smaller constants stay on the device.
+        """
+        self._set_weight_streaming(int(buffer_mb * 1048576), int(min_kb * 1024))
+
+    def weight_streaming_stats(self):
+        """Get the stats of the weight streaming.
+
+        Returns
+        -------
+        ret : Dict[str, int]
+            The number of the loads of the streamed weights, of the ones prefetched or still
+            resident in the buffer, of the fallbacks copied on the compute stream, and the bytes
+            uploaded to the device.
+        """
+        stats = self._get_weight_streaming_stats()
+        return {key: int(value) for key, value in stats.items()}
+
+    def persist_l2(self, max_mb, min_reuses=2):
+        """Keep the hot tensors, i.e., the parameters and the constants read by several ops such as
+        the small weights, the embedding tables and the KV blocks, persisting in the L2 cache of
+        Ampere and later GPUs during their live ranges. It is ignored by the older GPUs.
+
+        Parameters
+        ----------
+        max_mb : float
+            The max MBs of the L2 cache set aside for the persisting accesses. Non-positive means
+            disabled.
+
+        min_reuses : int
+            The min number of the ops reading a hot tensor.
+        """
+        self._set_l2_persistence(int(max_mb * 1048576), int(min_reuses))
+
+    def l2_persistence_stats(self):
+        """Get the stats of the L2 persistence.
+
+        Returns
+        -------
+        ret : Dict[str, int]
+            The number of the hot tensors chosen, of the access policy windows set on the streams,
+            and the bytes of the L2 cache set aside.
+        """
+        stats = self._get_l2_persistence_stats()
+        return {key: int(value) for key, value in stats.items()}
+
+    def stage_constants(self, constants):
+        """Upload the new values of the constants, e.g., the weights bound by
+        :py:meth:`VMCompiler.set_params`, into the back buffers of the VM. It does not block the
+        running contexts, which keep using the current values until :py:meth:`swap_constants`.
+
+        Parameters
+        ----------
+        constants : Dict[int, Union[raf.ndarray, np.ndarray]]
+            The new values keyed by the indices of the constants in the executable. They must
+            have the same shapes and dtypes as the constants.
+        """
+        indices = list(constants.keys())
+        values = [_convert(constants[index]) for index in indices]
+        self._stage_constants(indices, values)
+
+    def swap_constants(self):
+        """Swap the staged constants in, which are used by the runs launched afterwards. The
+        compiled kernels, OpEnvs and CUDA graphs stay valid. In CUDA graph mode, the staged
+        values are copied into the constants captured by the graphs, so it must not be called
+        while a graph is running.
+
+        Returns
+        -------
+        ret : int
+            The number of the swapped constants.
+        """
+        return self._swap_constants()
+
+    def update_constants(self, constants):
+        """Stage and swap the new values of the constants.
+
+        Parameters
+        ----------
+        constants : Dict[int, Union[raf.ndarray, np.ndarray]]
+            The new values keyed by the indices of the constants in the executable.
+
+        Returns
+        -------
+        ret : int
+            The number of the swapped constants.
+        """
+        self.stage_constants(constants)
+        return self.swap_constants()
+
+    def get_constant(self, index):
+        """Get the current value of a constant.
+
+        Parameters
+        ----------
+        index : int
+            The index of the constant in the executable.
+
+        Returns
+        -------
+        ret : TensorValue
+            The value of the constant.
+        """
+        return self._get_constant(index)
 
     def prepare_context(self, func_name, *args, **kwargs):
         """Create and initiliaze a VM Context given the name of function to invoke and arguments.
@@ -471,21 +1119,84 @@ class VirtualMachine:
             The initialized VM context.
         """
         if kwargs:
-            func_params = self._exec.get_function_params(func_name)
-            new_args = [None] * len(func_params)
-            assert len(args) + len(kwargs) == len(func_params)
-            for k in kwargs:
-                idx = func_params.index(k)
-                new_args[idx] = kwargs[k]
-            idx = 0
-            for i, arg in enumerate(new_args):
-                if arg is None:
-                    new_args[i] = args[idx]
-                    idx += 1
-            args = new_args
+            args = self._bind_kwargs(func_name, args, kwargs)
         cargs = _convert_args(args)
         return self._prepare_context(func_name, *cargs)
 
+    def _bind_kwargs(self, func_name, args, kwargs):
+        func_params = self._exec.get_function_params(func_name)
+        new_args = [None] * len(func_params)
+        assert len(args) + len(kwargs) == len(func_params)
+        for k in kwargs:
+            idx = func_params.index(k)
+            new_args[idx] = kwargs[k]
+        idx = 0
+        for i, arg in enumerate(new_args):
+            if arg is None:
+                new_args[i] = args[idx]
+                idx += 1
+        return new_args
+
+    def prepare_context_async(self, func_name, *args, **kwargs):
+        """Create a VM Context whose host inputs are uploaded to the device asynchronously.
+        The inputs are staged through double-buffered pinned memory and copied on a dedicated
+        copy stream, so the upload overlaps with the execution of the previous context.
+        At most one context can be prefetched ahead of the running one.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        args : list[raf.ndarray] or list[np.ndarray]
+            The arguments to the function.
+
+        kwargs: dict of str to raf.ndarray or np.ndarray
+            Named arguments to the function.
+
+        Returns
+        -------
+        result : VMContext
+            The initialized VM context.
+        """
+        if kwargs:
+            args = self._bind_kwargs(func_name, args, kwargs)
+        cargs = _convert_args(args)
+        return self._prepare_context_async(func_name, *cargs)
+
+    def run_prefetched(self, batches, func_name="main"):
+        """Run the virtual machine over a sequence of batches, uploading the inputs of
+        batch k+1 while batch k is running.
+
+        Parameters
+        ----------
+        batches : Iterable[Union[List, Tuple, Dict]]
+            The batches of arguments. Each batch is either a list of positional arguments
+            or a dict of named arguments.
+
+        func_name : str
+            The name of function to run.
+
+        Returns
+        -------
+        result : Generator[Object]
+            The outputs of each batch in order.
+        """
+
+        def _prepare(batch):
+            if isinstance(batch, dict):
+                return self.prepare_context_async(func_name, **batch)
+            return self.prepare_context_async(func_name, *batch)
+
+        ctx = None
+        for batch in batches:
+            next_ctx = _prepare(batch)
+            if ctx is not None:
+                yield self._run(ctx)
+            ctx = next_ctx
+        if ctx is not None:
+            yield self._run(ctx)
+
     def run(self, *args, func_name="main", **kwargs):
         """Run the virtual machine.
 
@@ -508,6 +1219,72 @@ class VirtualMachine:
         ctx = self.prepare_context(func_name, *args, **kwargs)
         return self._run(ctx)
 
+    def run_pipelined(self, batches, func_name="main", depth=2):
+        """Run the batches in a pipeline. The inputs of a batch are uploaded on the copy stream,
+        the batch is executed on the compute stream, and its outputs are downloaded to the pinned
+        host memory on the other copy stream. Up to depth batches are submitted ahead of the one
+        whose outputs are yielded, so the uploads and the downloads overlap with the executions,
+        and the host work of the caller on the yielded outputs overlaps with the following
+        batches, which keeps the device busy.
+
+        Parameters
+        ----------
+        batches : Iterable[List[Union[raf.ndarray, np.ndarray]]]
+            The arguments of each batch to the function.
+
+        func_name : str
+            The name of function to run.
+
+        depth : int
+            The max number of the batches in flight after the one being processed by the caller.
+
+        Returns
+        -------
+        result : Iterator[Object]
+            The outputs of the batches on the host in order.
+        """
+        assert depth >= 1, "The depth must be positive"
+        submit = self.module["submit_pipelined"]
+        fetch = self.module["fetch_pipelined"]
+        num_pending = 0
+        for args in batches:
+            submit(func_name, *_convert_args(args))
+            num_pending += 1
+            if num_pending > depth:
+                num_pending -= 1
+                yield fetch()
+        for _ in range(num_pending):
+            yield fetch()
+
+    def build_op_envs(self, *args, func_name="main", bundle=None, **kwargs):
+        """Build the OpEnvs of the function ahead of time with sample inputs, so the JIT
+        compilation of kernels and the algorithm search are not paid by the first request.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The sample arguments to the function, whose shapes are the ones to build for.
+
+        func_name : str
+            The name of function to build.
+
+        bundle : Optional[str]
+            The directory to store the built kernels and the tuned algorithms in. A process that
+            calls set_kernel_bundle with this directory before running the executable loads them
+            instead of building them again. The built TVM kernels are also linked into one shared
+            library by link_kernel_bundle. Note that the entries already built in this process
+            before the bundle is set are not stored.
+
+        kwargs: dict of str to raf.ndarray or np.ndarray
+            Named arguments to the function.
+        """
+        if bundle is not None:
+            set_kernel_bundle(bundle)
+        ctx = self.prepare_context(func_name, *args, **kwargs)
+        self._build_op_envs(ctx)
+        if bundle is not None:
+            link_kernel_bundle()
+
     def profile(self, *args, func_name="main", warmup=5, number=10, repeat=10, **kwargs):
         """Profile the virtual machine.
 
@@ -543,3 +1320,112 @@ class VirtualMachine:
         ctx = self.prepare_context(func_name, *args, **kwargs)
         result = [v.value for v in self._profile(ctx, warmup, number, repeat)]
         return result
+
+
+class BatchServer:
+    """The dynamic batching server over a VM, which runs in C++ without the GIL. The requests are
+    queued, and a batch is run when there are enough rows for a full batch or its first request
+    has waited for the max delay. The requests are concatenated along the leading axis and padded
+    with zeros to a bucket, and the outputs of each request are views of its rows of the batch
+    outputs. The leading axes of all inputs and outputs of the function are the batch.
+
+    Parameters
+    ----------
+    vm : VirtualMachine
+        The VM to run the batches.
+
+    params : Optional[List[Union[raf.ndarray, np.ndarray]]]
+        The inputs shared by the batches, e.g. the weights, which follow the inputs of the
+        requests.
+
+    func_name : str
+        The name of the function to serve.
+
+    max_batch_size : int
+        The max number of rows of a batch. Default 32.
+
+    max_delay_us : int
+        The max time in microseconds the first request of a batch waits for the others.
+        Default 1000.
+
+    buckets : Optional[List[int]]
+        The batch sizes to pad the batches to, which should be the buckets of the CUDA graph
+        cache of the VM, so the batches of any size replay the captured graphs.
+
+    num_workers : int
+        The number of the batches run concurrently, each in its own VM context. It should be no
+        more than the max concurrency of the VM. Default 1.
+    """
+
+    def __init__(
+        self,
+        vm,
+        params=None,
+        func_name="main",
+        max_batch_size=32,
+        max_delay_us=1000,
+        buckets=None,
+        num_workers=1,
+    ):  # pylint: disable=too-many-arguments
+        self.module = _ffi.vm.BatchServer(
+            vm.module,
+            _convert_args(params or []),
+            func_name,
+            max_batch_size,
+            max_delay_us,
+            buckets or [],
+            num_workers,
+        )
+        self._vm = vm
+        self._submit = self.module["submit"]
+        self._wait = self.module["wait"]
+        self._stop = self.module["stop"]
+
+    def submit(self, *args):
+        """Queue a request.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The host inputs of the request, whose leading axes are the same.
+
+        Returns
+        -------
+        request_id : int
+            The id of the request to wait for.
+        """
+        return self._submit(*_convert_args(args))
+
+    def wait(self, request_id):
+        """Wait for a request.
+
+        Parameters
+        ----------
+        request_id : int
+            The id of the request.
+
+        Returns
+        -------
+        result : Object
+            The outputs of the request.
+        """
+        return self._wait(request_id)
+
+    def infer(self, *args):
+        """Queue a request and wait for it.
+
+        Parameters
+        ----------
+        args : list[raf.ndarray] or list[np.ndarray]
+            The host inputs of the request.
+
+        Returns
+        -------
+        result : Object
+            The outputs of the request.
+        """
+        return self.wait(self.submit(*args))
+
+    def stop(self):
+        """Run the queued requests and stop the server."""
+        self._stop()
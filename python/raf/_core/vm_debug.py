@@ -9,9 +9,26 @@ from . import vm
 
 
 class VMDebugger(vm.VirtualMachine):
-    """VM debugger to debug the intermediate results."""
+    """VM debugger to debug the intermediate results.
 
-    def __init__(self, exe, device):
+    Parameters
+    ----------
+    exe : Executable
+        The executable to run.
+
+    device : str
+        The runtime device to run the code on.
+
+    timing_only : bool
+        Whether to only time the ops instead of capturing their inputs and outputs. On CUDA, each
+        op is enclosed by a pair of events, which are only read after the run.
+
+    ring_capacity : int
+        The number of the ops timed between two host syncs in the timing mode. The oldest pair of
+        events is read to reuse it when there are more ops in a run.
+    """
+
+    def __init__(self, exe, device, timing_only=False, ring_capacity=4096):
         self.module = _ffi.vm.VMDebugger(exe.module)
         self._exec = exe
         self._set_devices = self.module["set_devices"]
@@ -19,7 +36,9 @@ class VMDebugger(vm.VirtualMachine):
         self._run = self.module["run"]
         self._get_interm_tensors = self.module["get_interm_tensors"]
         self._reset = self.module["reset"]
+        self._get_op_latency = self.module["get_op_latency"]
         self._set_devices(device)
+        self.module["set_timing_mode"](timing_only, ring_capacity)
 
     def get_interm_tensors(self):
         """Get the intermediate results.
@@ -33,6 +52,30 @@ class VMDebugger(vm.VirtualMachine):
         names, ins, outs = res["names"], res["inputs"], res["outputs"]
         return names, ins, outs
 
+    def get_op_latency(self):
+        """Get the latency of each op aggregated over the runs in the timing mode.
+
+        Returns
+        -------
+        ret : List[Dict[str, Union[str, int, float]]]
+            The name, the input and output shapes, the number of the launches, and the total,
+            min and max latency in milliseconds of each op, in the descending order of the total
+            latency.
+        """
+        ret = []
+        for item in self._get_op_latency():
+            ret.append(
+                {
+                    "name": str(item["name"]),
+                    "shapes": str(item["shapes"]),
+                    "count": item["count"].value,
+                    "total_ms": item["total_ms"].value,
+                    "min_ms": item["min_ms"].value,
+                    "max_ms": item["max_ms"].value,
+                }
+            )
+        return sorted(ret, key=lambda x: x["total_ms"], reverse=True)
+
     def reset(self):
         """Reset the states."""
         self._reset()
@@ -49,10 +92,14 @@ class VMDebugExecutor(executor.VMExecutor):
 
     device : str
         The runtime device to run the code on.
+
+    timing_only : bool
+        Whether to only time the ops instead of capturing their inputs and outputs.
     """
 
-    def __init__(self, mod, device):
+    def __init__(self, mod, device, timing_only=False):
         super(VMDebugExecutor, self).__init__(mod, device)
-        self.vm = VMDebugger(self.executable, self.device)
+        self.vm = VMDebugger(self.executable, self.device, timing_only)
         self.get_interm_tensors = self.vm.get_interm_tensors
+        self.get_op_latency = self.vm.get_op_latency
         self.reset = self.vm.reset
@@ -73,13 +73,42 @@ def _cutlass_matmul_fusion(matmul_ops, dtype=None):
     return with_act | with_bias
 
 
+def _cutlass_grouped_matmul_fusion():
+    act_ops = ["raf.op.relu", "raf.op.gelu"]
+    grouped_matmul = is_op("raf.op.grouped_matmul")(*n_wildcards(3))
+    # pattern: grouped_matmul+residual
+    with_residual = is_op("raf.op.add")(grouped_matmul, wildcard(), *n_null_constant(2))
+    # pattern: grouped_matmul+residual+act or grouped_matmul+act
+    with_act = is_ops(act_ops)(with_residual | grouped_matmul)
+    # Unlike matmul, the single grouped matmul is included as there is no cuBLAS alternative
+    return with_act | with_residual | grouped_matmul
+
+
+def _cublaslt_matmul_fusion(matmul_ops):
+    # The bias shapes and dtypes supported by the epilogues are checked in C++ when fusing.
+    act_ops = ["raf.op.relu", "raf.op.gelu"]
+    matmul = call_binary_ops(matmul_ops)
+    with_bias = is_op("raf.op.add")(matmul, wildcard(), *n_null_constant(2))
+    with_act = is_ops(act_ops)(with_bias | matmul)
+    # The cast of the output, e.g. inserted by AutoCast, is fused by writing the output in the
+    # cast dtype, which is only supported without the bias add.
+    with_cast = is_op("raf.op.cast")(with_act | matmul, is_constant(None))
+    return with_cast | with_act | with_bias
+
+
 def _call_conv2d(dtype=None):
     if dtype is None:
         x, w = wildcard(), wildcard()
     else:
         assert isinstance(dtype, str)
         x, w = has_dtype(dtype), has_dtype(dtype)
-    return is_op("raf.op.conv2d")(x, w, *n_wildcards(7))
+
+    def _with_layouts(layout, kernel_layout):
+        layouts = [is_constant(StringValue(val)) for val in [layout, kernel_layout, layout]]
+        return is_op("raf.op.conv2d")(x, w, *n_wildcards(4), *layouts)
+
+    # cuDNN takes the conv2d in either NCHW or NHWC, where NHWC is faster on tensor cores.
+    return _with_layouts("NCHW", "OIHW") | _with_layouts("NHWC", "OHWI")
 
 
 def _call_conv2d_dxw(dtype=None):
@@ -113,6 +142,23 @@ def _cutlass_conv2d_fusion():
     return with_act | with_bias
 
 
+def _cudnn_conv2d_fusion():
+    # The bias must be a vector along the channels, which is checked in C++ when fusing.
+    conv = is_op("raf.op.conv2d")(
+        *n_wildcards(6),
+        is_constant(StringValue("NCHW")),
+        is_constant(StringValue("OIHW")),
+        is_constant(StringValue("NCHW"))
+    )
+    # pattern: conv2d+bias
+    with_bias_add = is_op("raf.op.bias_add")(conv, wildcard(), is_constant(IntValue(1)))
+    with_add = is_op("raf.op.add")(conv, wildcard(), *n_null_constant(2))
+    with_bias = with_bias_add | with_add
+    # pattern: conv2d+bias+act
+    with_act = is_op("raf.op.relu")(with_bias)
+    return with_act | with_bias
+
+
 def _call_pool2d_dx():
     pool_ops = ["raf.op.max_pool2d_dx", "raf.op.avg_pool2d_dx"]
     return is_ops(pool_ops)(*n_wildcards(9))
@@ -128,15 +174,25 @@ register_pattern(_call_pool2d_dx(), "cudnn", 50, "pool2d_dx")
 register_pattern(_call_conv2d_dxw(), "cudnn", 40, "conv2d_dxw")
 
 # conv2d
+register_pattern(_cudnn_conv2d_fusion(), "cudnn", 31, "conv2d_fusion")
 register_pattern(_cutlass_conv2d_fusion(), "cutlass", 30, "conv2d_fusion")
 register_pattern(_call_conv2d(), "cudnn", 29, "conv2d")
 
+# grouped_matmul
+register_pattern(_cutlass_grouped_matmul_fusion(), "cutlass", 25, "grouped_matmul_fusion")
+
 # batch_matmul
-register_pattern(_cutlass_matmul_fusion(BATCH_MATMUL_OPS), "cutlass", 20, "batch_matmul_fusion")
+register_pattern(_cutlass_matmul_fusion(BATCH_MATMUL_OPS), "cutlass", 21, "batch_matmul_fusion")
+register_pattern(
+    _cublaslt_matmul_fusion(BATCH_MATMUL_OPS), "cublaslt", 20, "batch_matmul_fusion"
+)
 register_pattern(call_binary_ops(BATCH_MATMUL_OPS), "cublas", 19, "batch_matmul")
 register_pattern(call_binary_ops(BATCH_MATMUL_OPS), "cutlass", 18, "batch_matmul")
+register_pattern(call_binary_ops(BATCH_MATMUL_OPS), "cblas", 17, "batch_matmul")
 
 # matmul / dense
-register_pattern(_cutlass_matmul_fusion(MATMUL_OPS), "cutlass", 10, "matmul_fusion")
+register_pattern(_cutlass_matmul_fusion(MATMUL_OPS), "cutlass", 11, "matmul_fusion")
+register_pattern(_cublaslt_matmul_fusion(MATMUL_OPS), "cublaslt", 10, "matmul_fusion")
 register_pattern(call_binary_ops(MATMUL_OPS), "cublas", 9, "matmul")
 register_pattern(call_binary_ops(MATMUL_OPS), "cutlass", 8, "matmul")
+register_pattern(call_binary_ops(MATMUL_OPS), "cblas", 7, "matmul")
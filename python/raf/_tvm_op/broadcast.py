@@ -47,3 +47,14 @@ def compute_where(attr, inputs, output_type):
 
 
 _reg.register_broadcast_schedule("raf.op.tvm.where")
+
+
+@register_compute("raf.op.tvm.add_n")
+def compute_add_n(attr, inputs, output_type):
+    out = inputs[0]
+    for x in inputs[1:]:
+        out = _topi.add(out, x)
+    return [out]
+
+
+_reg.register_broadcast_schedule("raf.op.tvm.add_n")
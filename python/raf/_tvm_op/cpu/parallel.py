@@ -0,0 +1,67 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name, no-member
+"""Parallel schedules for the element-wise and reduction ops on CPU, based on
+3rdparty/tvm/python/tvm/topi/x86/injective.py"""
+import tvm
+from tvm import te
+import tvm.topi.utils as utils
+
+
+def schedule_parallel_from_existing(sch, out):
+    """Parallelize the outer axes of an op over the CPU threads, and vectorize the innermost axis
+    if the op is element-wise. The reduction axes stay serial in each thread.
+
+    Parameters
+    ----------
+    sch: Schedule
+         The schedule to update.
+    out: Tensor
+         The tensor representing the op.
+
+    Returns
+    -------
+    sch: Schedule
+         The updated schedule.
+    """
+    axes = sch[out].op.axis
+    if len(axes) >= 5:
+        sch[out].parallel(sch[out].fuse(axes[0], axes[1], axes[2]))
+    elif len(axes) >= 3:
+        sch[out].parallel(sch[out].fuse(axes[0], axes[1]))
+    elif len(axes) >= 1:
+        sch[out].parallel(axes[0])
+    is_reduce = isinstance(out.op, te.ComputeOp) and len(out.op.reduce_axis) > 0
+    if len(axes) >= 2 and not is_reduce and utils.is_const_int(axes[-1].dom.extent):
+        # Vectorize 64 bytes, i.e., one AVX-512 register or two AVX2 registers.
+        lanes = max(512 // tvm.runtime.DataType(out.dtype).bits, 1)
+        lanes = min(lanes, utils.get_const_int(axes[-1].dom.extent))
+        _, inner = sch[out].split(axes[-1], factor=lanes)
+        sch[out].vectorize(inner)
+    return sch
+
+
+def schedule_parallel(outs):
+    """Create the parallel schedule of the ops.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of the ops.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the ops.
+    """
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    sch = te.create_schedule([x.op for x in outs])
+    te.schedule.AutoInlineInjective(sch)
+    scheduled_ops = []
+    for out in outs:
+        # The outputs of a multi-output op share one stage, which is only scheduled once.
+        if isinstance(out.op, te.ComputeOp) and out.op not in scheduled_ops:
+            schedule_parallel_from_existing(sch, out)
+            scheduled_ops.append(out.op)
+    return sch
@@ -173,3 +173,20 @@ def cross_entropy_dtrue_compute(attr, inputs, output_type):  # pylint: disable=u
 
 
 _reg.register_broadcast_schedule("raf.op.tvm.cross_entropy_dtrue")
+
+
+@register_compute("raf.op.tvm.softmax_cross_entropy")
+def softmax_cross_entropy_compute(attr, inputs, output_type):
+    # The TVM dialect is the fallback of the fused CUDA kernel, so it is the cross entropy.
+    return cross_entropy_compute(attr, inputs, output_type)
+
+
+_reg.register_broadcast_schedule("raf.op.tvm.softmax_cross_entropy")
+
+
+@register_compute("raf.op.tvm.softmax_cross_entropy_dpred")
+def softmax_cross_entropy_dpred_compute(attr, inputs, output_type):
+    return cross_entropy_dpred_compute(attr, inputs, output_type)
+
+
+_reg.register_broadcast_schedule("raf.op.tvm.softmax_cross_entropy_dpred")
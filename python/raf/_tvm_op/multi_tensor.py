@@ -0,0 +1,64 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=missing-function-docstring, unused-argument
+"""Compute definition and schedules of the multi-tensor operators."""
+from raf._tvm_op.nn import schedule_generic
+from .._lib import register_compute
+from .._lib import tvm as _tvm
+from .._lib import _reg
+
+_topi = _tvm.topi  # pylint: disable=invalid-name,no-member
+
+
+def _global_norm(inputs):
+    """The L2 norm of all the inputs in float32."""
+    sumsq = None
+    for x in inputs:
+        x = _topi.cast(x, "float32")
+        res = _topi.sum(_topi.multiply(x, x), axis=None, keepdims=False)
+        sumsq = res if sumsq is None else _topi.add(sumsq, res)
+    return _topi.sqrt(sumsq)
+
+
+def _scale(x, scale, dtype):
+    if scale == 0:
+        return _topi.full(x.shape, dtype, 0.0)
+    if scale == 1:
+        return _topi.cast(x, dtype)
+    return _topi.cast(_topi.multiply(x, _tvm.tir.const(scale, x.dtype)), dtype)
+
+
+@register_compute("raf.op.tvm.multi_tensor_scale")
+def multi_tensor_scale_compute(attrs, inputs, output_type):
+    dtype = str(attrs.dtype)
+    return [_scale(x, attrs.scale, dtype) for x in inputs]
+
+
+_reg.register_injective_schedule("raf.op.tvm.multi_tensor_scale")
+
+
+@register_compute("raf.op.tvm.multi_tensor_l2norm")
+def multi_tensor_l2norm_compute(attrs, inputs, output_type):
+    return [_global_norm(inputs)]
+
+
+_reg.register_schedule("raf.op.tvm.multi_tensor_l2norm", schedule_generic)
+
+
+@register_compute("raf.op.tvm.multi_tensor_clip_by_global_norm")
+def multi_tensor_clip_by_global_norm_compute(attrs, inputs, output_type):
+    norm = _global_norm(inputs)
+    max_norm = _tvm.tir.const(attrs.max_norm, "float32")
+    eps = _tvm.tir.const(attrs.eps, "float32")
+    coef = _topi.minimum(
+        _topi.divide(max_norm, _topi.add(norm, eps)), _tvm.tir.const(1.0, "float32")
+    )
+    outputs = []
+    for x in inputs:
+        clipped = _topi.multiply(_topi.cast(x, "float32"), coef)
+        outputs.append(_topi.cast(clipped, x.dtype))
+    return outputs + [norm]
+
+
+_reg.register_schedule("raf.op.tvm.multi_tensor_clip_by_global_norm", schedule_generic)
@@ -4,9 +4,10 @@
 # pylint: disable=missing-function-docstring, missing-module-docstring
 # pylint: disable=unused-argument, invalid-name, too-many-statements
 from functools import reduce
+import math
 import operator
 
-from . import cuda
+from . import cpu, cuda
 from .._lib import register_compute
 from .._lib import generic_func
 from .._lib import tvm as _tvm
@@ -379,6 +380,56 @@ def compute_contrib_dropout_dx(attr, inputs, output_type):
 _reg.register_injective_schedule("raf.op.tvm._contrib_dropout_dx")
 
 
+def _counter_dropout_keep(key, shape, p, offset):
+    """Whether an element is kept by the counter-based dropout. The uniform random number of an
+    element is a hash (splitmix64) of the key, the offset and the element index, as the dropout
+    kernels of the CUDA dialect, so the mask is regenerated instead of being stored."""
+    u64 = lambda value: _tvm.tir.const(value, "uint64")
+    seed = key(*([0] * len(key.shape))) + u64(offset % (1 << 64)) * u64(0xD1B54A32D192ED03)
+
+    def keep(*ix):
+        idx = u64(0)
+        for axis, dim in zip(ix, shape):
+            idx = idx * u64(int(dim)) + _tvm.topi.cast(axis, "uint64")
+        z = seed + (idx + u64(1)) * u64(0x9E3779B97F4A7C15)
+        z = (z ^ (z >> u64(30))) * u64(0xBF58476D1CE4E5B9)
+        z = (z ^ (z >> u64(27))) * u64(0x94D049BB133111EB)
+        z = z ^ (z >> u64(31))
+        uniform = _tvm.topi.cast(z >> u64(40), "float32") * _tvm.tir.const(
+            1.0 / 16777216, "float32"
+        )
+        return uniform >= _tvm.tir.const(p, "float32")
+
+    return keep
+
+
+@register_compute("raf.op.tvm.counter_dropout")
+def compute_counter_dropout(attr, inputs, output_type):
+    x, key = inputs
+    keep = _counter_dropout_keep(key, x.shape, attr.p, attr.offset)
+    scale = _tvm.tir.const(1 / (1 - attr.p), x.dtype)
+    zero = _tvm.tir.const(0, x.dtype)
+    return [
+        _tvm.te.compute(
+            x.shape,
+            lambda *ix: _tvm.te.if_then_else(keep(*ix), x[ix] * scale, zero),
+            tag=_tvm.topi.tag.INJECTIVE,
+        )
+    ]
+
+
+_reg.register_injective_schedule("raf.op.tvm.counter_dropout")
+
+
+@register_compute("raf.op.tvm.counter_dropout_dx")
+def compute_counter_dropout_dx(attr, inputs, output_type):
+    # The gradient is dy dropped by the same mask, which is regenerated from the key.
+    return compute_counter_dropout(attr, inputs, output_type)
+
+
+_reg.register_injective_schedule("raf.op.tvm.counter_dropout_dx")
+
+
 @register_compute("raf.op.tvm.relu_dx")
 @_tvm.te.tag_scope(tag=_tvm.topi.tag.ELEMWISE)
 def compute_relu_dx(attr, inputs, output_type):
@@ -515,6 +566,12 @@ def schedule_generic(attrs, outs, target):
         return _topi.generic.schedule_injective(outs)
 
 
+@schedule_generic.register(["cpu"])
+def schedule_generic_cpu(attrs, outs, target):
+    with target:
+        return cpu.parallel.schedule_parallel(outs)
+
+
 @schedule_generic.register(["cuda", "gpu"])
 def schedule_generic_cuda(attrs, outs, target):
     with target:
@@ -839,6 +896,187 @@ def compute_conv2d_transpose_dw(attr, inputs, output_type):
 _reg.register_schedule("raf.op.tvm.conv2d_transpose_dw", schedule_generic)
 
 
+@register_compute("raf.op.tvm.grouped_matmul")
+def compute_grouped_matmul(attr, inputs, output_type):
+    # The rows of x are split into consecutive groups, and each group is multiplied by its
+    # own weight. The group of a row is found from the inclusive prefix sums of group sizes.
+    x, weight, group_sizes = inputs
+    num_rows, red_size = x.shape
+    num_groups, _, num_cols = weight.shape
+    gidx = _tvm.te.reduce_axis((0, num_groups), name="gidx")
+    ends = _tvm.te.compute(
+        (num_groups,),
+        lambda g: _tvm.te.sum(group_sizes[gidx], axis=gidx, where=gidx <= g),
+        name="group_ends",
+    )
+    eidx = _tvm.te.reduce_axis((0, num_groups), name="eidx")
+    group_ids = _tvm.te.compute(
+        (num_rows,),
+        lambda t: _tvm.te.sum(
+            (ends[eidx] <= t).astype("int32"), axis=eidx, where=eidx < num_groups - 1
+        ),
+        name="group_ids",
+    )
+    k = _tvm.te.reduce_axis((0, red_size), name="k")
+    return [
+        _tvm.te.compute(
+            (num_rows, num_cols),
+            lambda t, n: _tvm.te.sum(x[t, k] * weight[group_ids[t], k, n], axis=k),
+            name="grouped_matmul",
+        )
+    ]
+
+
+_reg.register_schedule("raf.op.tvm.grouped_matmul", schedule_generic)
+
+
+@register_compute("raf.op.tvm.paged_attention")
+def compute_paged_attention(attr, inputs, output_type):
+    # pylint: disable=too-many-locals
+    # The token t of the sequence b is the slot t % block_size of the block
+    # block_table[b, t // block_size], where only the tokens up to the position of a query are
+    # read, so the unused slots and the padding of the table never reach the outputs.
+    q, k_cache, v_cache, block_table, lengths = inputs
+    batch, _, seq_q, dim = q.shape
+    num_blocks, _, block_size, _ = k_cache.shape
+    max_tokens = block_table.shape[1] * block_size
+    scale = attr.scale if attr.scale > 0 else 1.0 / math.sqrt(int(dim))
+
+    def slot(b, t):
+        block = block_table[b, t // block_size].astype("int64")
+        return _tvm.te.max(_tvm.te.min(block, num_blocks - 1), 0), t % block_size
+
+    def visible(b, i, t):
+        return t <= lengths[b].astype("int64") - seq_q + i
+
+    d = _tvm.te.reduce_axis((0, dim), name="d")
+
+    def fdot(b, h, i, t):
+        block, s = slot(b, t)
+        return _tvm.te.sum(
+            q[b, h, i, d].astype("float32") * k_cache[block, h, s, d].astype("float32"), axis=d
+        )
+
+    dot = _tvm.te.compute((batch, q.shape[1], seq_q, max_tokens), fdot, name="dot")
+    score = _tvm.te.compute(
+        dot.shape,
+        lambda b, h, i, t: _tvm.tir.if_then_else(
+            visible(b, i, t), dot[b, h, i, t] * scale, _tvm.tir.const(-1e30, "float32")
+        ),
+        name="score",
+    )
+    m = _tvm.te.reduce_axis((0, max_tokens), name="m")
+    score_max = _tvm.te.compute(
+        score.shape[:-1], lambda b, h, i: _tvm.te.max(score[b, h, i, m], axis=m), name="score_max"
+    )
+    prob = _tvm.te.compute(
+        score.shape,
+        lambda b, h, i, t: _tvm.tir.if_then_else(
+            visible(b, i, t), _tvm.te.exp(score[b, h, i, t] - score_max[b, h, i]), 0.0
+        ),
+        name="prob",
+    )
+    r = _tvm.te.reduce_axis((0, max_tokens), name="r")
+    prob_sum = _tvm.te.compute(
+        score.shape[:-1], lambda b, h, i: _tvm.te.sum(prob[b, h, i, r], axis=r), name="prob_sum"
+    )
+    t = _tvm.te.reduce_axis((0, max_tokens), name="t")
+
+    def fout(b, h, i, c):
+        block, s = slot(b, t)
+        # The unread slots may hold any bits, so they are selected out rather than scaled by 0.
+        value = _tvm.tir.if_then_else(
+            visible(b, i, t), prob[b, h, i, t] * v_cache[block, h, s, c].astype("float32"), 0.0
+        )
+        return _tvm.te.sum(value, axis=t)
+
+    acc = _tvm.te.compute(q.shape, fout, name="acc")
+    # A query without any visible token, e.g., of an idle sequence of the batch, outputs zeros.
+    out = _tvm.te.compute(
+        q.shape,
+        lambda b, h, i, c: _tvm.tir.if_then_else(
+            prob_sum[b, h, i] > 0, acc[b, h, i, c] / prob_sum[b, h, i], 0.0
+        ).astype(q.dtype),
+        name="paged_attention",
+    )
+    return [out]
+
+
+_reg.register_schedule("raf.op.tvm.paged_attention", schedule_generic)
+
+
+@register_compute("raf.op.tvm.qnn_dense")
+def compute_qnn_dense(attr, inputs, output_type):
+    return [_topi.nn.dense(inputs[0], inputs[1], out_dtype="int32")]
+
+
+_reg.register_schedule("raf.op.tvm.qnn_dense", schedule_generic)
+
+
+@register_compute("raf.op.tvm.qnn_batch_matmul_nt")
+def compute_qnn_batch_matmul_nt(attr, inputs, output_type):
+    return [_topi.nn.batch_matmul(inputs[0], inputs[1], out_dtype="int32")]
+
+
+_reg.register_schedule("raf.op.tvm.qnn_batch_matmul_nt", schedule_generic)
+
+
+@register_compute("raf.op.tvm.qnn_conv2d")
+def compute_qnn_conv2d(attr, inputs, output_type):
+    data, kernel = inputs
+    strides, padding, dilation = attr.strides, attr.padding, attr.dilation
+    if attr.data_layout == "NHWC":
+        assert attr.kernel_layout == "OHWI" and attr.groups == 1
+        kernel = _topi.transpose(kernel, [1, 2, 3, 0])
+        return [_topi.nn.conv2d_nhwc(data, kernel, strides, padding, dilation, "int32")]
+    assert attr.data_layout == "NCHW" and attr.kernel_layout == "OIHW"
+    if attr.groups == 1:
+        return [_topi.nn.conv2d_nchw(data, kernel, strides, padding, dilation, "int32")]
+    return [
+        _topi.nn.group_conv2d_nchw(data, kernel, strides, padding, dilation, attr.groups, "int32")
+    ]
+
+
+_reg.register_schedule("raf.op.tvm.qnn_conv2d", schedule_generic)
+
+
+@register_compute("raf.op.tvm.quantize")
+def compute_quantize(attr, inputs, output_type):
+    # The symmetric quantization, which clips to [-127, 127] so the range has no zero point.
+    x = inputs[0]
+    inv_scale = _tvm.tir.const(1.0 / attr.scale, x.dtype)
+    lower = _tvm.tir.const(-127, x.dtype)
+    upper = _tvm.tir.const(127, x.dtype)
+    return [
+        _tvm.te.compute(
+            x.shape,
+            lambda *idx: _tvm.te.max(
+                _tvm.te.min(_tvm.te.round(x[idx] * inv_scale), upper), lower
+            ).astype(attr.dtype),
+            tag=_tvm.topi.tag.ELEMWISE,
+        )
+    ]
+
+
+_reg.register_injective_schedule("raf.op.tvm.quantize")
+
+
+@register_compute("raf.op.tvm.dequantize")
+def compute_dequantize(attr, inputs, output_type):
+    x = inputs[0]
+    scale = _tvm.tir.const(attr.scale, attr.dtype)
+    return [
+        _tvm.te.compute(
+            x.shape,
+            lambda *idx: x[idx].astype(attr.dtype) * scale,
+            tag=_tvm.topi.tag.ELEMWISE,
+        )
+    ]
+
+
+_reg.register_injective_schedule("raf.op.tvm.dequantize")
+
+
 def average(data, axis):
     shape = _topi.utils.get_const_tuple(data.shape)
     shape = [shape[i] for i in axis]
@@ -14,6 +14,7 @@ from .._lib import generic_func
 from .._lib import tvm as _tvm
 from .._lib import _reg
 from .utils import get_cuda_max_thread, profile_schedule
+from .cpu.parallel import schedule_parallel
 
 _topi = _tvm.topi  # pylint: disable=invalid-name, no-member
 
@@ -234,11 +235,39 @@ def schedule_cuda_sum_long_reduce(outs, reduce_last_axis, **kwargs):
     return sch
 
 
+def _find_reduce(tensor):
+    """Find the reduction that the output is computed from. The output itself is the reduction,
+    unless elementwise ops are fused into the epilogue of the reduction.
+
+    Parameters
+    ----------
+    tensor: tvm.te.Tensor
+        The output tensor.
+
+    Returns
+    -------
+    ret: tvm.te.Tensor
+        The reduction tensor. It is the output tensor if no reduction is found.
+    """
+    visited = set()
+    stack = [tensor]
+    while stack:
+        curr = stack.pop()
+        if curr.op in visited or not isinstance(curr.op, _tvm.te.ComputeOp):
+            continue
+        visited.add(curr.op)
+        if curr.op.reduce_axis:
+            return curr
+        stack.extend(curr.op.input_tensors)
+    return tensor
+
+
 @profile_schedule(num_thread=[16, 32, 64, get_cuda_max_thread()], max_block=[128, 256, 512])
 def schedule_cuda_short_reduce(outs, **kwargs):
     """Schedule sum for CUDA. This schedule targets to the sum with short reduction length.
     In this case, each thread is responsible for reduction. The parallelization is across
     the output elements. This is modified from TOPI injective schedule for CUDA.
+    The reduction is computed at the thread of its elementwise epilogue if any.
 
     Parameters
     ----------
@@ -325,9 +354,20 @@ def schedule_cuda_short_reduce(outs, **kwargs):
                     bx, tx = sch[out].split(fused, factor=num_thread)
                 sch[out].bind(tx, _tvm.te.thread_axis("threadIdx.x"))
                 sch[out].bind(bx, _tvm.te.thread_axis("blockIdx.x"))
+
+            red = _find_reduce(out)
+            if red.op != out.op:
+                # The epilogue keeps the reduced shape, so each thread reduces its own element.
+                sch[red].compute_at(sch[out], tx)
     return sch
 
 
+@schedule_sum.register(["cpu"])
+def schedule_sum_cpu(attrs, outs, target):
+    with target:
+        return schedule_parallel(outs)
+
+
 @schedule_sum.register(["cuda", "gpu"])
 def schedule_sum_cuda(attrs, outs, target):
     # pylint: disable=unused-argument
@@ -349,7 +389,7 @@ def schedule_sum_cuda(attrs, outs, target):
         return None
 
     with target:
-        out = outs[0]
+        out = _find_reduce(outs[0])
         num_out_elements = get_num_elements(out.op.axis)
         num_reduce_elements = get_num_elements(out.op.reduce_axis)
 
@@ -31,3 +31,57 @@ def sgd_compute(attr, inputs, output_type):
 
 
 _reg.register_injective_schedule("raf.op.tvm.sgd")
+
+
+def _sparse_sgd_ir(x0, rows, values, v0, v1, x1, learning_rate, mu):
+    """Copy the weight and the momentum, and update the given rows of the copies."""
+    ib = _tvm.tir.ir_builder.create()
+    numel = 1
+    for dim in x0.shape:
+        numel *= dim
+    nrows = rows.shape[0]
+    stride = numel // x0.shape[0]
+    p_x0 = ib.buffer_ptr(x0)
+    p_rows = ib.buffer_ptr(rows)
+    p_values = ib.buffer_ptr(values)
+    p_v0 = ib.buffer_ptr(v0)
+    p_v1 = ib.buffer_ptr(v1)
+    p_x1 = ib.buffer_ptr(x1)
+    with ib.for_range(0, numel, name="i") as i:
+        p_v1[i] = p_v0[i]
+        p_x1[i] = p_x0[i]
+    with ib.for_range(0, nrows, name="i") as i:
+        row = p_rows[i]
+        with ib.if_scope(row >= 0):
+            with ib.for_range(0, stride, name="j") as j:
+                k = row * stride + j
+                p_v1[k] = mu * p_v1[k] + p_values[i * stride + j].astype(v1.dtype)
+                p_x1[k] = p_x1[k] - learning_rate * p_v1[k]
+    return ib.get()
+
+
+@register_compute("raf.op.tvm.sparse_sgd")
+def sparse_sgd_compute(attr, inputs, output_type):
+    # pylint: disable=unused-argument, invalid-name
+    x0, rows, values, v0 = inputs
+    learning_rate = _tvm.tir.const(attr.learning_rate, dtype=x0.dtype)
+    mu = _tvm.tir.const(attr.mu, dtype=x0.dtype)
+    v1, x1 = _tvm.te.extern(
+        [v0.shape, x0.shape],
+        [x0, rows, values, v0],
+        lambda ins, outs: _sparse_sgd_ir(*ins, *outs, learning_rate, mu),
+        dtype=[v0.dtype, x0.dtype],
+        name="sparse_sgd",
+    )
+    return [v1, x1]
+
+
+def schedule_sparse_sgd(attrs, outs, target):
+    # pylint: disable=unused-argument
+    # The full copy makes the outputs correct even if they are not in place of the inputs, which
+    # is only a fallback of the CUDA kernel.
+    with target:
+        return _tvm.te.create_schedule([out.op for out in outs])
+
+
+_reg.register_schedule("raf.op.tvm.sparse_sgd", schedule_sparse_sgd)
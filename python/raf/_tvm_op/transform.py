@@ -120,6 +120,72 @@ def strided_set_compute(attrs, inputs, output_type):
     return [_topi.strided_set(data, v, begin, end, strides)]
 
 
+@register_compute("raf.op.tvm.kv_append")
+def kv_append_compute(attrs, inputs, output_type):
+    cache, v, pos = inputs
+    seq = v.shape[-2]
+
+    def fcompute(*idx):
+        # Every element is read and written at the same index, so the output may be the cache.
+        p = pos[idx[0]] if len(pos.shape) == 1 else pos()
+        step = idx[-2] - p.astype(idx[-2].dtype)
+        in_range = _tvm.tir.all(step >= 0, step < seq)
+        step = _tvm.te.max(_tvm.te.min(step, seq - 1), 0)
+        return _tvm.tir.if_then_else(in_range, v[idx[:-2] + (step, idx[-1])], cache[idx])
+
+    return [_tvm.te.compute(cache.shape, fcompute)]
+
+
+def _paged_kv_append_ir(cache, v, block_table, pos, out):
+    """Copy the cache, and write the steps to the slots of their blocks in the copy."""
+    ib = _tvm.tir.ir_builder.create()
+    num_blocks, heads, block_size, dim = cache.shape
+    batch, _, seq, _ = v.shape
+    max_tokens = block_table.shape[1] * block_size
+    p_cache = ib.buffer_ptr(cache)
+    p_v = ib.buffer_ptr(v)
+    p_table = ib.buffer_ptr(block_table)
+    p_pos = ib.buffer_ptr(pos)
+    p_out = ib.buffer_ptr(out)
+    with ib.for_range(0, num_blocks * heads * block_size * dim, name="i") as i:
+        p_out[i] = p_cache[i]
+    with ib.for_range(0, batch * seq, name="i") as i:
+        b = i // seq
+        t = p_pos[b].astype("int64") + i % seq
+        with ib.if_scope(_tvm.tir.all(t >= 0, t < max_tokens)):
+            block = p_table[b * block_table.shape[1] + t // block_size].astype("int64")
+            with ib.for_range(0, heads, name="h") as h:
+                dst = ((block * heads + h) * block_size + t % block_size) * dim
+                src = ((b * heads + h) * seq + i % seq) * dim
+                with ib.for_range(0, dim, name="d") as d:
+                    p_out[dst + d] = p_v[src + d]
+    return ib.get()
+
+
+@register_compute("raf.op.tvm.paged_kv_append")
+def paged_kv_append_compute(attrs, inputs, output_type):
+    cache, v, block_table, pos = inputs
+    out = _tvm.te.extern(
+        [cache.shape],
+        [cache, v, block_table, pos],
+        lambda ins, outs: _paged_kv_append_ir(*ins, outs[0]),
+        dtype=[cache.dtype],
+        name="paged_kv_append",
+    )
+    return [out]
+
+
+def schedule_paged_kv_append(attrs, outs, target):
+    # pylint: disable=unused-argument
+    # The full copy makes the output correct even if it is not in place of the cache, which is
+    # only a fallback of the CUDA kernel.
+    with target:
+        return _tvm.te.create_schedule([out.op for out in outs])
+
+
+_reg.register_schedule("raf.op.tvm.paged_kv_append", schedule_paged_kv_append)
+
+
 _reg.register_strategy("raf.op.tvm.scatter", strategy.scatter_strategy)
 _reg.register_injective_schedule("raf.op.tvm.scatter_dx")
 _reg.register_injective_schedule("raf.op.tvm.transpose_dx")
@@ -148,6 +214,7 @@ _reg.register_injective_schedule("raf.op.tvm.batch_flatten")
 _reg.register_injective_schedule("raf.op.tvm.arange")
 _reg.register_injective_schedule("raf.op.tvm.strided_slice")
 _reg.register_injective_schedule("raf.op.tvm.strided_set")
+_reg.register_injective_schedule("raf.op.tvm.kv_append")
 _reg.register_reduce_schedule("raf.op.tvm.collapse_sum_like")
 
 
@@ -438,6 +505,64 @@ def embedding_dx_compute(attrs, inputs, output_type):
 
 _reg.register_injective_schedule("raf.op.tvm.embedding_dx")
 
+
+def _embedding_sparse_dx_ir(indices, order, dy, rows, values):
+    """Reduce the rows of dy in the sorted order of the indices, so the rows of the same index
+    are adjacent and each segment of them is summed into the next output row."""
+    ib = _tvm.tir.ir_builder.create()
+    n = indices.shape[0]
+    stride = values.shape[1]
+    p_indices = ib.buffer_ptr(indices)
+    p_order = ib.buffer_ptr(order)
+    p_dy = ib.buffer_ptr(dy)
+    p_rows = ib.buffer_ptr(rows)
+    p_values = ib.buffer_ptr(values)
+    seg = ib.allocate("int64", (1,), name="seg", scope="local")
+    seg[0] = _tvm.tir.const(-1, "int64")
+    with ib.for_range(0, n, name="i") as i:
+        p_rows[i] = _tvm.tir.const(-1, "int64")
+        with ib.for_range(0, stride, name="j") as j:
+            p_values[i * stride + j] = _tvm.tir.const(0, values.dtype)
+    with ib.for_range(0, n, name="i") as i:
+        key = p_indices[p_order[i]].astype("int64")
+        prev = p_indices[p_order[_tvm.te.max(i - 1, 0)]].astype("int64")
+        with ib.if_scope(key >= 0):
+            with ib.if_scope(_tvm.tir.any(i == 0, prev != key)):
+                seg[0] += 1
+                p_rows[seg[0]] = key
+            with ib.for_range(0, stride, name="j") as j:
+                p_values[seg[0] * stride + j] += p_dy[p_order[i] * stride + j]
+    return ib.get()
+
+
+@register_compute("raf.op.tvm.embedding_sparse_dx")
+def embedding_sparse_dx_compute(attrs, inputs, output_type):
+    dy, indices = inputs
+    dims = [int(dim) for dim in attrs.dims]
+    n = int(np.prod(_topi.utils.get_const_tuple(indices.shape)))
+    stride = int(np.prod(dims[1:]))
+    indices = _topi.reshape(indices, (n,))
+    dy = _topi.reshape(dy, (n, stride))
+    # The stable sort keeps the rows of the same index in order, so the sums are deterministic.
+    order = _topi.argsort(indices, axis=0, dtype="int64")
+    rows, values = _tvm.te.extern(
+        [(n,), (n, stride)],
+        [indices, order, dy],
+        lambda ins, outs: _embedding_sparse_dx_ir(ins[0], ins[1], ins[2], outs[0], outs[1]),
+        dtype=["int64", dy.dtype],
+        name="embedding_sparse_dx",
+    )
+    return [rows, _topi.reshape(values, [n] + dims[1:])]
+
+
+def schedule_embedding_sparse_dx(attrs, outs, target):
+    # The segmented reduction is sequential, which is only a fallback of the CUDA kernel.
+    with target:
+        return _tvm.te.create_schedule([out.op for out in outs])
+
+
+_reg.register_schedule("raf.op.tvm.embedding_sparse_dx", schedule_embedding_sparse_dx)
+
 _reg.register_strategy("raf.op.tvm.cumsum", strategy.cumsum_strategy)
 
 
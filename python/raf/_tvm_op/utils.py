@@ -33,6 +33,31 @@ def export_library(mod, path):
     return os.path.exists(path)
 
 
+@tvm._ffi.register_func("raf._tvm_op.utils.export_bundle")
+def export_bundle(mods, path):
+    """Export many built TVM runtime modules to be one shared library (.so) file. The functions
+    of the modules are resolved by their names after the library is loaded, so the function
+    names must be distinct.
+
+    Parameters
+    ----------
+    mods : List[tvm.runtime.Module]
+        The TVM runtime modules to be exported. The first module imports the others.
+    path : str
+        The path to the shared library file.
+
+    Returns
+    -------
+    bool
+        Whether the export was successful.
+    """
+    root = mods[0]
+    for mod in mods[1:]:
+        root.import_module(mod)
+    root.export_library(path)
+    return os.path.exists(path)
+
+
 @tvm._ffi.register_func("raf._tvm_op.utils.load_module")
 def load_module(path):
     """Load a module from a .so file.
@@ -4,11 +4,11 @@
 """Functions for enabling AMP (automatic mixed precision)."""
 # pylint: disable=protected-access
 from raf._ffi.pass_ import AutoCast, InferType
-from raf._lib import relay
+from raf._lib import relay, tvm
 from raf.frontend.model import FrameworkModel
 
 
-def autocast(model, args=None):
+def autocast(model, args=None, dtype=None, out_dtype=None):
     """Convert a model running in single precison to half precision.
 
     Parameters
@@ -18,10 +18,31 @@ def autocast(model, args=None):
 
     args: Optional[List[raf.ndarray]]
         The input data of the model.
+
+    dtype: Optional[str]
+        The AMP dtype, float16 or bfloat16. If not given, it is "raf.amp.dtype" of the current
+        pass context, which is float16 by default. bfloat16 has the range of float32, so the
+        training does not need loss scaling.
+
+    out_dtype: Optional[str]
+        The dtype of the outputs of the casted ops. It is the AMP dtype if not given.
     """
     args = args if args is not None else []
     mod = model._internal(*args).mod
-    mod = AutoCast()(mod)
+    if dtype is not None:
+        curr = tvm.transform.PassContext.current()
+        config = dict(curr.config)
+        config["raf.amp.dtype"] = dtype
+        config["raf.amp.out_dtype"] = out_dtype if out_dtype is not None else dtype
+        with tvm.transform.PassContext(
+            opt_level=curr.opt_level,
+            required_pass=curr.required_pass,
+            disabled_pass=curr.disabled_pass,
+            config=config,
+        ):
+            mod = AutoCast()(mod)
+    else:
+        mod = AutoCast()(mod)
     mod = InferType()(mod)
     return FrameworkModel(mod, mod, model.state(), dict())
 
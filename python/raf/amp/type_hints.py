@@ -117,6 +117,9 @@ register_op_cast_rule("raf.op.batch_matmul", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_nt", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tn", generic_cast(True, 2))
 register_op_cast_rule("raf.op.batch_matmul_tt", generic_cast(True, 2))
+register_op_cast_rule("raf.op.grouped_matmul", generic_cast(True, 2))
+register_op_cast_rule("raf.op.block_sparse_matmul_sdd", generic_cast(True, 2))
+register_op_cast_rule("raf.op.block_sparse_matmul_dsd", generic_cast(True, 2))
 
 # Never cast.
 register_op_cast_rule("raf.op.arange", generic_cast(False, 3))
@@ -126,10 +129,20 @@ register_op_cast_rule("raf.op.reciprocal", generic_cast(False, 1))
 register_op_cast_rule("raf.op.softmax", generic_cast(False, 1))
 register_op_cast_rule("raf.op.softmax_dx", generic_cast(False, 2))
 register_op_cast_rule("raf.op.lans", generic_cast(False, 2))
+register_op_cast_rule("raf.op.adam", generic_cast(False, 2))
+register_op_cast_rule("raf.op.adamw", generic_cast(False, 2))
+register_op_cast_rule("raf.op.multi_tensor_scale", generic_cast(False, 1))
+register_op_cast_rule("raf.op.multi_tensor_l2norm", generic_cast(False, 1))
+register_op_cast_rule("raf.op.multi_tensor_clip_by_global_norm", generic_cast(False, 1))
 register_op_cast_rule("raf.op.log_softmax", generic_cast(False, 1))
 register_op_cast_rule("raf.op.log_softmax_dx", generic_cast(False, 2))
 register_op_cast_rule("raf.op.erf", generic_cast(False, 1))
 register_op_cast_rule("raf.op.erf_dx", generic_cast(False, 3))
+register_op_cast_rule("raf.op.quantize", generic_cast(False, 1))
+register_op_cast_rule("raf.op.dequantize", generic_cast(False, 1))
+register_op_cast_rule("raf.op.qnn_dense", generic_cast(False, 2))
+register_op_cast_rule("raf.op.qnn_batch_matmul_nt", generic_cast(False, 2))
+register_op_cast_rule("raf.op.qnn_conv2d", generic_cast(False, 2))
 register_op_cast_rule("raf.op.gelu", generic_cast(False, 1))
 register_op_cast_rule("raf.op.gelu_dx", generic_cast(False, 3))
 register_op_cast_rule("raf.op.smooth_l1_loss", generic_cast(False, 2))
@@ -146,6 +159,7 @@ register_op_cast_rule("raf.op.cross_entropy_dtrue", generic_cast(False, 2))
 # over float32, so never cast.
 register_op_cast_rule("raf.op.take_dx", generic_cast(3, False))
 register_op_cast_rule("raf.op.embedding_dx", generic_cast(2, False))
+register_op_cast_rule("raf.op.embedding_sparse_dx", generic_cast(2, False))
 
 # FIXME: These ops should support float16, but the current TVM code results in
 # either runtime error or mismatch outputs.
@@ -225,6 +239,7 @@ register_op_cast_rule("raf.op.negative", infer_cast(1))
 register_op_cast_rule("raf.op.logical_not", infer_cast(1))
 register_op_cast_rule("raf.op.relu", infer_cast(1))
 register_op_cast_rule("raf.op.copy", infer_cast(1))
+register_op_cast_rule("raf.op.checkpoint_boundary", infer_cast(1))
 register_op_cast_rule("raf.op.abs", infer_cast(1))
 register_op_cast_rule("raf.op.all", infer_cast(1))
 register_op_cast_rule("raf.op.any", infer_cast(1))
@@ -274,6 +289,7 @@ register_op_cast_rule("raf.op.mean_dx", infer_cast(1))
 register_op_cast_rule("raf.op.get_reduce_axis", infer_cast(2))
 register_op_cast_rule("raf.op.get_kept_dims", infer_cast(2))
 register_op_cast_rule("raf.op.sgd", infer_cast(1))
+register_op_cast_rule("raf.op.sparse_sgd", infer_cast(1))
 register_op_cast_rule("raf.op.shape", infer_cast(1))
 register_op_cast_rule("raf.op.swap_axis", infer_cast(1))
 register_op_cast_rule("raf.op.repeat", infer_cast(1))
@@ -298,6 +314,15 @@ register_op_cast_rule("raf.op.get_valid_counts", infer_cast(1))
 register_op_cast_rule("raf.op.bias_add", infer_cast(2))
 register_op_cast_rule("raf.op._contrib_dropout", infer_cast(1))
 register_op_cast_rule("raf.op._contrib_dropout_dx", infer_cast(1))
+register_op_cast_rule("raf.op.counter_dropout", infer_cast(1))
+register_op_cast_rule("raf.op.counter_dropout_dx", infer_cast(1))
+# The fused kernels accumulate in float32, so the logits are kept in the AMP dtype.
+register_op_cast_rule("raf.op.softmax_cross_entropy", infer_cast([1]))
+register_op_cast_rule("raf.op.softmax_cross_entropy_dpred", infer_cast([0, 2]))
+register_op_cast_rule("raf.op._vocab_parallel_cross_entropy", infer_cast([1]))
+register_op_cast_rule("raf.op._vocab_parallel_cross_entropy_dpred", infer_cast([0, 2]))
+register_op_cast_rule("raf.op.block_sparse_softmax", infer_cast(1))
+register_op_cast_rule("raf.op.block_sparse_softmax_dx", infer_cast(2))
 register_op_cast_rule("raf.op.non_max_suppression", infer_cast(1))
 register_op_cast_rule("raf.op._allreduce", infer_cast(1))
 register_op_cast_rule("raf.op._allgather", infer_cast(1))
@@ -417,6 +442,8 @@ register_op_cast_rule("raf.op.batch_norm_train", op_cast_norm(1))
 # and we have not figured out the reason. However, it does not affect the convergence of AMP models
 # so we still cast it.
 register_op_cast_rule("raf.op.batch_norm_train_dxwb", op_cast_norm(2))
+register_op_cast_rule("raf.op._sync_batch_norm_train", op_cast_norm(1))
+register_op_cast_rule("raf.op._sync_batch_norm_train_dxwb", op_cast_norm(2))
 
 
 register_op_cast_rule("raf.op.layer_norm", infer_cast(1))
@@ -451,6 +478,41 @@ register_op_cast_rule("raf.op.layer_norm_train", op_cast_layer_norm_train)
 register_op_cast_rule("raf.op.layer_norm_train_dx", op_cast_layer_norm_train_dx)
 
 
+def op_cast_add_dropout_layer_norm(args, ret_type, amp_dtype):
+    """Follow the dtype of the 1st arg for the inputs, residual, scale and bias, as the
+    layer_norm_train does."""
+    dtype = args[0].checked_type.dtype
+    return [PrimType(dtype) for _ in range(4)] + [PrimType(None) for _ in range(len(args) - 4)]
+
+
+def op_cast_add_dropout_layer_norm_dx(args, ret_type, amp_dtype):
+    """It has args in order (dy, pre_norm, scale, mean, invvar, mask, p, eps)."""
+    dtype = args[1].checked_type.dtype
+    ret = [PrimType(dtype) for _ in range(3)] + [PrimType("float32"), PrimType("float32")]
+    ret += [PrimType(None) for _ in range(len(args) - 5)]
+    return ret
+
+
+register_op_cast_rule("raf.op.add_dropout_layer_norm", op_cast_add_dropout_layer_norm)
+register_op_cast_rule("raf.op.add_dropout_layer_norm_dx", op_cast_add_dropout_layer_norm_dx)
+
+
+def op_cast_embedding_layer_norm(args, ret_type, amp_dtype):
+    """It has args in order (word, word_ids, pos, pos_ids, scale, bias, token_type,
+    token_type_ids, p, eps, seed). The tables, scale and bias follow the dtype of the word table,
+    and the ids and an absent token type are kept."""
+    dtype = args[0].checked_type.dtype
+    ret = [PrimType(dtype), PrimType(None)] * 2 + [PrimType(dtype), PrimType(dtype)]
+    has_token_type = isinstance(args[6].checked_type, tvm.ir.TensorType)
+    ret += [PrimType(dtype if has_token_type else None), PrimType(None)]
+    ret += [PrimType(None) for _ in range(len(args) - 8)]
+    return ret
+
+
+register_op_cast_rule("raf.op.embedding_layer_norm", op_cast_embedding_layer_norm)
+register_op_cast_rule("raf.op.embedding_layer_norm_dx", op_cast_add_dropout_layer_norm_dx)
+
+
 def op_cast_concatenate(args, ret_type, amp_dtype):
     """Concatenate may have too many inputs that exceeds the GPU register when using the injective
     schedule with float16, so we make a heuristic that prevents concat from being executed with
@@ -471,6 +533,17 @@ register_op_cast_rule("raf.op.concatenate", op_cast_concatenate)
 register_op_cast_rule("raf.op.concatenate_dx", op_cast_concatenate)
 
 
+def op_cast_add_n(args, ret_type, amp_dtype):
+    """The inputs of add_n must be of the same dtype, so they follow the dtype of the majority."""
+    in_types = args[0].checked_type.fields
+    cast_to_amp = sum([check_dtype(t, amp_dtype) for t in in_types]) > len(in_types) // 2
+    target_dtype = amp_dtype if cast_to_amp else "float32"
+    return [TupleType([PrimType(target_dtype) for _ in in_types])]
+
+
+register_op_cast_rule("raf.op.add_n", op_cast_add_n)
+
+
 def op_cast_split(args, ret_type, amp_dtype):
     """Split generates a tuple output but its behavior is quite simple, so it is safe
     to always let it follow the argument dtype.
@@ -22,6 +22,16 @@ def with_cublas():
     return build_info.use_cublas() != "OFF"
 
 
+def with_cupti():
+    """Whether build with CUPTI, which records the kernel timeline of the device."""
+    return build_info.use_cupti() != "OFF"
+
+
+def with_cblas():
+    """Whether build with a CPU BLAS library, i.e., MKL or OpenBLAS."""
+    return build_info.use_cblas() != "OFF"
+
+
 def with_cudnn():
     """Whether build with CUDNN. if true, return the CUDNN version, or None otherwise."""
     if build_info.use_cudnn() != "OFF":
@@ -51,6 +61,11 @@ def with_cutlass():
     return build_info.use_cutlass() != "OFF"
 
 
+def with_tensorrt():
+    """Whether TensorRT is enabled."""
+    return build_info.use_tensorrt() != "OFF"
+
+
 def cmake_build_type():
     """Return cmake build type"""
     return build_info.cmake_build_type()
@@ -68,19 +83,34 @@ def build_with(backend):  # pylint: disable=too-many-return-statements
     -------
     Whether the backend is built with RAF.
     """
-    assert backend in ["tvm", "cuda", "cudnn", "cutlass", "cublas", "nccl"], (
-        "Invalid backend: %s" % backend
-    )
+    assert backend in [
+        "tvm",
+        "cuda",
+        "cudnn",
+        "cutlass",
+        "cublas",
+        "cublaslt",
+        "cblas",
+        "mpi",
+        "nccl",
+        "tensorrt",
+    ], ("Invalid backend: %s" % backend)
     if backend == "tvm":
         return True  # it seems like that we always build with TVM
     if backend == "cuda":
         return with_cuda() is not None
-    if backend == "cublas":
+    if backend in ("cublas", "cublaslt"):
         return with_cublas()
+    if backend == "cblas":
+        return with_cblas()
     if backend == "cudnn":
         return with_cudnn() is not None
     if backend == "cutlass":
         return with_cutlass()
+    if backend == "mpi":
+        return with_mpi()
     if backend == "nccl":
         return with_nccl() is not None
+    if backend == "tensorrt":
+        return with_tensorrt()
     return False
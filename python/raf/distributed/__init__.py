@@ -14,8 +14,17 @@ from .op import (
     group_allgather,
     group_reduce_scatter,
     all_to_all,
+    all_to_allv,
+    expert_dispatch,
+    expert_combine,
+    vocab_parallel_cross_entropy,
+    sync_batch_norm,
     gather,
     scatter,
 )
 from .config import DistConfig, get_config
 from .communicator import get_communicator, set_default_communicator
+from .bucket_tuner import BucketSizeTuner
+from .elastic import ElasticSnapshot, take_snapshot, rebuild, restore_snapshot
+from .checkpoint import CheckpointHandle, save_checkpoint, load_checkpoint
+from .planner import CommModel, ModelProfile, ParallelPlan, profile_model, plan_parallelism
@@ -0,0 +1,142 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Auto-tuning the bucket size of the grouped collectives in data parallel training."""
+import numpy as np
+
+import raf._ffi.distributed as ffi
+from .communicator import get_communicator
+from .config import get_config
+
+# The candidate bucket sizes in the number of elements.
+DEFAULT_CANDIDATES = [2500000, 10000000, 40000000, 160000000, 5000000000]
+
+
+def _max_across_ranks(values):
+    """Take the element-wise maximum of the given values across all ranks, so that all ranks
+    make the same decision."""
+    # pylint: disable=import-outside-toplevel
+    import raf
+    from .op import allreduce
+
+    comm = get_communicator()
+    if comm.size == 1:
+        return values
+
+    class AllreduceMax(raf.Model):
+        # pylint: disable=missing-function-docstring
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return allreduce(x, "max")
+
+    device = f"cuda({comm.local_rank})"
+    model = AllreduceMax()
+    model.to(device=device)
+    out = model(raf.array(np.array(values, dtype="float32"), device=device))
+    return out.numpy().tolist()
+
+
+class BucketSizeTuner:
+    """Tune the bucket size (i.e., group_bucket_size of the dist config) of the grouped
+    collectives, such as the grouped reduce_scatter of ZeRO-2 and the grouped allgather of
+    ZeRO-3, by the measured latency of the training iterations.
+
+    The profiling iterations [auto_dp_profiling_start_iter, auto_dp_profiling_end_iter] of the
+    dist config are evenly divided among the candidates. Since the first iteration of each
+    candidate includes the compilation, it is a warm-up iteration unless each candidate only has
+    one iteration. After the profiling iterations, the candidate with the lowest average latency
+    (the maximum across all ranks) is used for the rest of the training. Tuning is only enabled
+    when enable_auto_dp_profiling of the dist config is set.
+
+    The usage is as follows, where the model has to be traced and compiled again whenever the
+    bucket size is changed:
+
+    .. code-block:: python
+
+        tuner = BucketSizeTuner()
+        for _ in range(num_iters):
+            if tuner.begin():
+                vm = compile_model()
+            start = time.time()
+            run_and_sync(vm)
+            tuner.end(time.time() - start)
+
+    Parameters
+    ----------
+    candidates: Optional[List[int]]
+        The candidate bucket sizes in the number of elements. If not specified,
+        DEFAULT_CANDIDATES is used.
+    """
+
+    def __init__(self, candidates=None):
+        dcfg = get_config()
+        self.candidates = list(candidates) if candidates else list(DEFAULT_CANDIDATES)
+        self.enabled = bool(dcfg.enable_auto_dp_profiling)
+        self.start_iter = dcfg.auto_dp_profiling_start_iter
+        self.end_iter = dcfg.auto_dp_profiling_end_iter
+        num_profile_iters = self.end_iter - self.start_iter + 1
+        if self.enabled and num_profile_iters < len(self.candidates):
+            raise ValueError(
+                "Need at least %d profiling iterations to tune %d bucket sizes, but got %d"
+                % (len(self.candidates), len(self.candidates), num_profile_iters)
+            )
+        self.iters_per_candidate = max(1, num_profile_iters // len(self.candidates))
+        self.iteration = 0
+        self.latencies = [[] for _ in self.candidates]
+        self.best = None
+        self.curr = dcfg.group_bucket_size
+
+    def _candidate_index(self, iteration):
+        """The candidate used by the given profiling iteration, or None if it is not profiled."""
+        if not self.enabled or iteration < self.start_iter or iteration > self.end_iter:
+            return None
+        idx = (iteration - self.start_iter) // self.iters_per_candidate
+        return idx if idx < len(self.candidates) else None
+
+    def _set_bucket_size(self, bucket_size):
+        """Set the bucket size and return whether it is changed."""
+        if bucket_size == self.curr:
+            return False
+        self.curr = bucket_size
+        ffi.GroupBucketSize(bucket_size)
+        return True
+
+    def begin(self):
+        """Begin an iteration and set the bucket size of this iteration.
+
+        Returns
+        -------
+        ret: bool
+            Whether the bucket size is changed, in which case the model has to be recompiled.
+        """
+        idx = self._candidate_index(self.iteration)
+        if idx is not None:
+            return self._set_bucket_size(self.candidates[idx])
+        if self.enabled and self.iteration > self.end_iter and self.best is None:
+            self.best = self._select()
+            return self._set_bucket_size(self.best)
+        return False
+
+    def end(self, latency):
+        """End the iteration with its latency.
+
+        Parameters
+        ----------
+        latency: float
+            The latency of this iteration.
+        """
+        idx = self._candidate_index(self.iteration)
+        if idx is not None:
+            warmup = (self.iteration - self.start_iter) % self.iters_per_candidate == 0
+            if not warmup or self.iters_per_candidate == 1:
+                self.latencies[idx].append(latency)
+        self.iteration += 1
+
+    def _select(self):
+        """Select the candidate with the lowest average latency across all ranks."""
+        means = [float(np.mean(lat)) if lat else float("inf") for lat in self.latencies]
+        means = _max_across_ranks(means)
+        return self.candidates[int(np.argmin(means))]
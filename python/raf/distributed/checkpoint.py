@@ -0,0 +1,169 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+"""Sharded checkpoints, where each rank writes the states it owns to its own shard file in
+parallel, and the ZeRO partitioned states are re-partitioned when loaded by a world of another
+size. A checkpoint directory has a manifest written by rank 0 and a shard file of each rank."""
+import json
+import math
+import os
+
+import numpy as np
+
+import raf._ffi.distributed as ffi
+from raf._core.ndarray import ndarray
+from .communicator import get_communicator
+from .elastic import _get_full_length
+
+MANIFEST_NAME = "manifest.json"
+
+
+def _shard_path(path, rank):
+    return os.path.join(path, "shard_%d.bin" % rank)
+
+
+class CheckpointHandle:
+    """The handle of a checkpoint being written in the background.
+
+    Parameters
+    ----------
+    write_id : int
+        The id of the write of the shard of this rank.
+    """
+
+    def __init__(self, write_id):
+        self.write_id = write_id
+
+    def wait(self):
+        """Wait for the shard of this rank to be written, and raise the error if it fails."""
+        ffi.WaitCheckpoint(self.write_id)
+
+
+def save_checkpoint(model, path, step=0, blocking=False):
+    """Save the states of the model, including the optimizer states, to a sharded checkpoint.
+    All ranks must save the checkpoint together. Each rank writes the ZeRO partitions it owns,
+    and the replicated states are distributed over the ranks, so no state is written twice.
+    The states are copied to the pinned host memory before it returns, and the shard file is
+    written in the background, so the next training steps are overlapped with the file I/O.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model, which is usually wrapped by an optimizer.
+    path : str
+        The checkpoint directory, which is shared by all ranks.
+    step : int
+        The training step to be resumed from.
+    blocking : bool
+        Whether to wait for the shard to be written before returning.
+
+    Returns
+    -------
+    ret : CheckpointHandle
+        The handle to wait for the write.
+    """
+    comm = get_communicator()
+    os.makedirs(path, exist_ok=True)
+    state = model.state()
+    states = {}
+    names, values = [], []
+    for idx, (name, value) in enumerate(sorted(state.items())):
+        full_length = _get_full_length(name, state) if comm.size > 1 else None
+        info = {"dtype": value.dtype, "shape": list(value.shape)}
+        if full_length is not None:
+            info["shape"][0] = full_length
+            info["partition"] = value.shape[0]
+            owned = True
+        else:
+            info["owner"] = idx % comm.size
+            owned = info["owner"] == comm.rank
+        states[name] = info
+        if owned:
+            names.append(name)
+            values.append(value._ndarray__value)
+    meta = json.dumps({"step": step, "rank": comm.rank, "world_size": comm.size})
+    write_id = ffi.SaveCheckpointShard(_shard_path(path, comm.rank), meta, names, values)
+    if comm.rank == 0:
+        manifest = {"step": step, "world_size": comm.size, "states": states}
+        tmp_path = os.path.join(path, MANIFEST_NAME + ".tmp")
+        with open(tmp_path, "w") as out_file:
+            json.dump(manifest, out_file)
+        os.replace(tmp_path, os.path.join(path, MANIFEST_NAME))
+    handle = CheckpointHandle(write_id)
+    if blocking:
+        handle.wait()
+    return handle
+
+
+class _ShardReader:
+    """Open the shard files on demand, whose states are views of the memory-mapped files."""
+
+    def __init__(self, path, step):
+        self.path = path
+        self.step = step
+        self.shards = {}
+
+    def get(self, rank, name):
+        """Get a state in the shard of a rank as a numpy array."""
+        if rank not in self.shards:
+            shard_path = _shard_path(self.path, rank)
+            assert os.path.exists(shard_path), "The shard %s is missing" % shard_path
+            meta, states = ffi.LoadCheckpointShard(shard_path)
+            assert json.loads(meta)["step"] == self.step, "The shard %s is stale" % shard_path
+            self.shards[rank] = states
+        return self.shards[rank][name].numpy()
+
+
+def load_checkpoint(model, path):
+    """Load the states of the model from a sharded checkpoint, which may be saved by a world of
+    another size. Each rank only reads the rows of the ZeRO partitioned states it owns.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model built for the current world, which has the same states as the checkpoint.
+    path : str
+        The checkpoint directory.
+
+    Returns
+    -------
+    ret : int
+        The training step to be resumed from.
+    """
+    with open(os.path.join(path, MANIFEST_NAME), "r") as in_file:
+        manifest = json.load(in_file)
+    reader = _ShardReader(path, manifest["step"])
+    comm = get_communicator()
+    for name, value in model.state().items():
+        assert name in manifest["states"], "%s is not in the checkpoint" % name
+        info = manifest["states"][name]
+        full_shape = tuple(info["shape"])
+        assert isinstance(value, ndarray)
+        if "owner" in info and tuple(value.shape) == full_shape:
+            value[:] = np.ascontiguousarray(reader.get(info["owner"], name))
+            continue
+        length = full_shape[0]
+        if tuple(value.shape) == full_shape:
+            begin, end = 0, length
+        else:
+            # The ZeRO partition of this rank, where the last partition is zero-padded.
+            msg = "Mismatched shape of %s: %s vs. %s" % (name, value.shape, full_shape)
+            assert tuple(value.shape)[1:] == full_shape[1:], msg
+            part = value.shape[0]
+            begin, end = min(comm.rank * part, length), min((comm.rank + 1) * part, length)
+        pieces = []
+        if "owner" in info:
+            pieces.append(reader.get(info["owner"], name)[begin:end])
+        else:
+            src_part = info["partition"]
+            for src_rank in range(begin // src_part, math.ceil(end / src_part)):
+                src_begin = src_rank * src_part
+                data = reader.get(src_rank, name)
+                pieces.append(data[max(begin - src_begin, 0) : end - src_begin])
+        rows = np.concatenate(pieces) if pieces else np.zeros((0,) + full_shape[1:], value.dtype)
+        if rows.shape[0] < value.shape[0]:
+            pad = np.zeros((value.shape[0] - rows.shape[0],) + full_shape[1:], rows.dtype)
+            rows = np.concatenate([rows, pad])
+        value[:] = np.ascontiguousarray(rows)
+    return manifest["step"]
@@ -28,6 +28,15 @@ class DistConfig(Object):
         self.zero_opt_level_ = value
         ffi.ZeroOpt(value)
 
+    @property
+    def zero_prefetch_depth(self):
+        return self.zero_prefetch_depth_
+
+    @zero_prefetch_depth.setter
+    def zero_prefetch_depth(self, value):
+        self.zero_prefetch_depth_ = value
+        ffi.ZeroPrefetchDepth(value)
+
     @property
     def enable_auto_dp_profiling(self):
         return self.enable_auto_dp_profiling_
@@ -55,13 +64,84 @@ class DistConfig(Object):
         self.auto_dp_profiling_end_iter_ = value
         ffi.AutoDPProfilingEndIter(value)
 
+    @property
+    def enable_hierarchical_allreduce(self):
+        return self.enable_hierarchical_allreduce_
+
+    @enable_hierarchical_allreduce.setter
+    def enable_hierarchical_allreduce(self, value):
+        self.enable_hierarchical_allreduce_ = value
+        ffi.EnableHierarchicalAllreduce(value)
+
+    @property
+    def enable_topology_aware_ring(self):
+        return self.enable_topology_aware_ring_
+
+    @enable_topology_aware_ring.setter
+    def enable_topology_aware_ring(self, value):
+        self.enable_topology_aware_ring_ = value
+        ffi.EnableTopologyAwareRing(value)
+
+    @property
+    def enable_collective_coalescing(self):
+        return self.enable_collective_coalescing_
+
+    @enable_collective_coalescing.setter
+    def enable_collective_coalescing(self, value):
+        self.enable_collective_coalescing_ = value
+        ffi.EnableCollectiveCoalescing(value)
+
+    @property
+    def allreduce_compression(self):
+        return self.allreduce_compression_
+
+    @allreduce_compression.setter
+    def allreduce_compression(self, value):
+        self.allreduce_compression_ = value
+        ffi.AllreduceCompression(value)
+
+    @property
+    def allreduce_compression_min_elements(self):
+        return self.allreduce_compression_min_elements_
+
+    @allreduce_compression_min_elements.setter
+    def allreduce_compression_min_elements(self, value):
+        self.allreduce_compression_min_elements_ = value
+        ffi.AllreduceCompressionMinElements(value)
+
+    @property
+    def allreduce_topk_ratio(self):
+        return self.allreduce_topk_ratio_
+
+    @allreduce_topk_ratio.setter
+    def allreduce_topk_ratio(self, value):
+        self.allreduce_topk_ratio_ = value
+        ffi.AllreduceTopkRatio(value)
+
+    @property
+    def enable_elastic(self):
+        return self.enable_elastic_
+
+    @enable_elastic.setter
+    def enable_elastic(self, value):
+        self.enable_elastic_ = value
+        ffi.EnableElastic(value)
+
     def dumps(self):
         attr_keys = [
             "enable_data_parallel",
             "zero_opt_level",
+            "zero_prefetch_depth",
             "enable_auto_dp_profiling",
             "auto_dp_profiling_start_iter",
             "auto_dp_profiling_end_iter",
+            "enable_hierarchical_allreduce",
+            "enable_topology_aware_ring",
+            "enable_collective_coalescing",
+            "allreduce_compression",
+            "allreduce_compression_min_elements",
+            "allreduce_topk_ratio",
+            "enable_elastic",
         ]
         return {attr: getattr(self, attr) for attr in attr_keys}
 
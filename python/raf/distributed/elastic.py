@@ -0,0 +1,165 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+"""Elastic data parallelism, which rebuilds the communicators for a new world in the process
+instead of restarting the job from a checkpoint."""
+import numpy as np
+
+import raf._ffi.distributed as ffi
+from raf._core.ndarray import ndarray
+from .communicator import get_communicator
+from .config import get_config
+from .op import allgather
+
+# The suffixes of the optimizer states and parameters that are partitioned by ZeRO.
+ZERO_SUFFIXES = (".sgd_w", ".sgd_v", ".lans_w", ".m", ".v", ".zero_shard")
+
+
+class ElasticSnapshot:
+    """An in-memory snapshot of the model states on the host, where each ZeRO partitioned state
+    is gathered from all ranks, so it can be re-partitioned for a world of another size.
+
+    Parameters
+    ----------
+    states : Dict[str, numpy.ndarray]
+        The full value of each state.
+    world_size : int
+        The size of the world when the snapshot is taken.
+    step : int
+        The training step when the snapshot is taken.
+    """
+
+    def __init__(self, states, world_size, step):
+        self.states = states
+        self.world_size = world_size
+        self.step = step
+
+
+def _make_allgather(device):
+    """Make a model that allgathers a tensor along the first axis."""
+    # pylint: disable=import-outside-toplevel, missing-function-docstring
+    from raf.model.model import Model
+    from raf.model.trace import trace
+
+    class Allgather(Model):
+        def build(self):
+            pass
+
+        @trace
+        def forward(self, x):
+            return allgather(x, axis=0)
+
+    model = Allgather()
+    model.to(device=device)
+    return model
+
+
+def _get_full_length(name, state):
+    """Get the length of the first axis of the parameter, which the state is partitioned from,
+    or None if the state is not partitioned."""
+    suffix = next((s for s in ZERO_SUFFIXES if name.endswith(s)), None)
+    if suffix is None or get_config().zero_opt_level == 0:
+        return None
+    prefix = name[: -len(suffix)]
+    for key, param in state.items():
+        if key in (prefix, "model." + prefix) and not key.endswith(ZERO_SUFFIXES):
+            return param.shape[0] if param.shape else None
+    # The ZeRO-3 partitions are attributes of the data parallel model.
+    if prefix.startswith("ad_model."):
+        return _get_full_length("model." + prefix[len("ad_model.") :] + suffix, state)
+    return None
+
+
+def take_snapshot(model, step=0):
+    """Copy the states of the model, including the optimizer states, to the host memory. All
+    ranks must take the snapshot together, because the partitioned states are allgathered.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model, which is usually wrapped by an optimizer.
+    step : int
+        The training step to be resumed from.
+
+    Returns
+    -------
+    ret : ElasticSnapshot
+        The snapshot.
+    """
+    comm = get_communicator()
+    state = model.state()
+    states = {}
+    gather = None
+    for name, value in state.items():
+        full_length = _get_full_length(name, state)
+        if full_length is not None and comm.size > 1:
+            if gather is None:
+                gather = _make_allgather(value.device)
+            # Remove the zero-padding of the last partition.
+            states[name] = gather(value).numpy()[:full_length]
+        else:
+            states[name] = value.numpy()
+    return ElasticSnapshot(states, comm.size, step)
+
+
+def rebuild(generation, size, rank, local_size, local_rank):
+    """Abort the communicators and join a new world, which may have a different size after a
+    rank fails or a new one joins. The communicators are created again for the new world when
+    used. All ranks of the new world, including the new ones, must use the same generation.
+    The models and executors created before must be built again, because their communication
+    resources and ZeRO partitions are for the previous world.
+
+    Parameters
+    ----------
+    generation : int
+        The generation of the new world, which increases for each rebuild.
+    size : int
+        The number of ranks in the new world.
+    rank : int
+        The rank of this process in the new world.
+    local_size : int
+        The number of ranks on this host in the new world.
+    local_rank : int
+        The rank of this process on this host in the new world.
+    """
+    assert get_config().enable_elastic, "The elastic mode is not enabled"
+    ffi.RebuildCommunicators(generation, size, rank, local_size, local_rank)
+    comm = get_communicator()
+    comm.size, comm.rank = size, rank
+    comm.local_size, comm.local_rank = local_size, local_rank
+
+
+def restore_snapshot(model, snapshot):
+    """Restore the states of the model from a snapshot, where the partitioned states are
+    re-partitioned for the current world.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The model built for the current world, which has the same states as the snapshot.
+    snapshot : ElasticSnapshot
+        The snapshot to be restored.
+
+    Returns
+    -------
+    ret : int
+        The training step to be resumed from.
+    """
+    # pylint: disable=import-outside-toplevel
+    from raf.optim.utils import split_ndarray_with_padding
+
+    comm = get_communicator()
+    for name, value in model.state().items():
+        assert name in snapshot.states, "%s is not in the snapshot" % name
+        full = snapshot.states[name]
+        if tuple(value.shape) != full.shape:
+            full = split_ndarray_with_padding(full, comm.size)[comm.rank]
+        assert tuple(value.shape) == full.shape, "Mismatched shape of %s: %s vs. %s" % (
+            name,
+            value.shape,
+            full.shape,
+        )
+        assert isinstance(value, ndarray)
+        value[:] = np.ascontiguousarray(full)
+    return snapshot.step
@@ -284,6 +284,144 @@ def all_to_all(x, split_axis=0, concat_axis=0, rank_list=None):
     return y
 
 
+def all_to_allv(x, send_counts, rank_list=None):
+    """Performs an all-to-all communication with a variable number of rows per rank.
+
+    Parameters
+    ----------
+    x : Tensor
+        The tensor to perform all-to-all on. Its first axis is evenly split into n segments
+        of capacity rows, and the first send_counts[i] rows of segment i are sent to rank i.
+    send_counts : Tensor
+        The int64 tensor of shape (n,) with the number of rows sent to each rank.
+    rank_list : List[List[int]]
+        The list of ranks to communicate. This parameter will split the ranks
+        (MPI / NCCL processes) into multiple groups as specified by the user,
+        and each rank will only communicate within the group. If the rank list
+        leaves empty, the ranks won't get split.
+
+    Returns
+    -------
+    ret: Tuple[Tensor, Tensor]
+        The received tensor with the same shape as x, where the first recv_counts[i] rows of
+        segment i are received from rank i and the remaining rows are undefined, and the
+        received counts recv_counts.
+    """
+    return sym._all_to_allv(x, send_counts, rank_list=rank_list)
+
+
+def vocab_parallel_cross_entropy(y_true, y_pred, rank_list=None):
+    """The fused softmax cross entropy of the logits sharded along the vocab, e.g., by a
+    column-parallel output projection. Each rank holds the shard of (n, v) of the vocab starting
+    at rank * v, and only the per-row stats are allreduced, so the logits of the full vocab are
+    never gathered. The gradient to the local shard recomputes the stats instead of storing the
+    softmax.
+
+    Parameters
+    ----------
+    y_true : Tensor
+        The int64 labels of (n,) in the full vocab.
+    y_pred : Tensor
+        The local shard of the logits of (n, v).
+    rank_list : List[List[int]]
+        The list of ranks to communicate. This parameter will split the ranks
+        (MPI / NCCL processes) into multiple groups as specified by the user,
+        and each rank will only communicate within the group. If the rank list
+        leaves empty, the ranks won't get split.
+
+    Returns
+    -------
+    ret: Tensor
+        The mean loss of (1,) over the rows, which is the same on all the ranks of the group.
+    """
+    return sym._vocab_parallel_cross_entropy(y_true, y_pred, rank_list=rank_list)
+
+
+def sync_batch_norm(
+    x, running_mean, running_var, w=None, b=None, momentum=0.1, eps=1e-5, rank_list=None
+):
+    """The batch norm of training whose mean and variance are of the global batch of the ranks,
+    e.g., for the small per-GPU batches of data parallelism. The per-channel sums of x and x * x
+    of each rank are reduced in one fused kernel and summed by a single allreduce, and so are
+    the sums of the backward.
+
+    Parameters
+    ----------
+    x : Tensor
+        The local batch of (n, c, ...).
+    running_mean : Tensor
+        The float32 running mean of (c,), which is updated in place.
+    running_var : Tensor
+        The float32 running variance of (c,), which is updated in place.
+    w : Optional[Tensor]
+        The float32 scale of (c,).
+    b : Optional[Tensor]
+        The float32 shift of (c,).
+    momentum : float
+        The momentum of the running stats.
+    eps : float
+        The epsilon added to the variance.
+    rank_list : List[List[int]]
+        The list of ranks to communicate. This parameter will split the ranks
+        (MPI / NCCL processes) into multiple groups as specified by the user,
+        and each rank will only communicate within the group. If the rank list
+        leaves empty, the ranks won't get split.
+
+    Returns
+    -------
+    ret: Tuple[Tensor, Tensor, Tensor]
+        The normalized local batch, and the updated running mean and variance.
+    """
+    return sym._sync_batch_norm_train(
+        x, running_mean, running_var, w, b, momentum, eps, rank_list=rank_list
+    )
+
+
+def expert_dispatch(x, send_counts, rank_list=None):
+    """Dispatches the routed tokens to the experts on the other ranks for expert parallelism.
+    Only the routed tokens are sent, instead of the whole capacity of each expert.
+
+    Parameters
+    ----------
+    x : Tensor
+        The tokens of shape (n * capacity, ...), where segment i holds the tokens routed to the
+        experts on rank i.
+    send_counts : Tensor
+        The int64 tensor of shape (n,) with the number of tokens routed to each rank.
+    rank_list : List[List[int]]
+        The list of ranks of the expert parallel groups.
+
+    Returns
+    -------
+    ret: Tuple[Tensor, Tensor]
+        The tokens received by the local experts, and the number of tokens from each rank,
+        which is required to combine the expert outputs.
+    """
+    return all_to_allv(x, send_counts, rank_list)
+
+
+def expert_combine(y, recv_counts, rank_list=None):
+    """Sends the outputs of the local experts back to the ranks that dispatched the tokens,
+    which reverses expert_dispatch.
+
+    Parameters
+    ----------
+    y : Tensor
+        The outputs of the local experts, in the layout of the tokens returned by
+        expert_dispatch.
+    recv_counts : Tensor
+        The number of tokens received from each rank, returned by expert_dispatch.
+    rank_list : List[List[int]]
+        The list of ranks of the expert parallel groups.
+
+    Returns
+    -------
+    ret: Tensor
+        The expert outputs in the layout of the tokens given to expert_dispatch.
+    """
+    return sym._all_to_allv(y, recv_counts, rank_list=rank_list)[0]
+
+
 def gather(x, root):
     """Performs a gather communication across all ranks.
 
@@ -0,0 +1,600 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Planning the parallel strategy of a training job, i.e., the degrees of data (with ZeRO), tensor
+and pipeline parallelism, by the predicted throughput within the memory budget of a device.
+
+The compute is estimated by EstimateGFLOPS, the activation memory by EstimateMemory, and the
+collectives by a communication model, which is either analytic or fit by the results of the
+collective benchmark (raf_bench_collectives). The usage is as follows:
+
+.. code-block:: python
+
+    profile = profile_model(model, "cuda", args)
+    with open("bench_collectives.txt") as filep:
+        comm_model = CommModel.from_benchmark(filep.read())
+    plan = plan_parallelism(profile, num_devices=16, memory_budget_mb=30000, comm_model=comm_model)
+    plan.apply()
+    specs = plan.shard_specs(model)
+"""
+import re
+
+from .config import get_config
+
+# The ops whose outputs are reduced among the tensor parallel ranks.
+MATMUL_OPS = [
+    "raf.op.matmul",
+    "raf.op.matmul_nt",
+    "raf.op.matmul_tn",
+    "raf.op.matmul_tt",
+    "raf.op.dense",
+    "raf.op.batch_matmul",
+    "raf.op.batch_matmul_nt",
+    "raf.op.batch_matmul_tn",
+    "raf.op.batch_matmul_tt",
+]
+
+
+def _bus_factor(collective, num_ranks):
+    """The ratio of the bytes on the wire of each rank to the message size, as in nccl-tests."""
+    if collective in ("allreduce", "allreduce_fused"):
+        return 2.0 * (num_ranks - 1) / num_ranks
+    if collective in ("send", "broadcast"):
+        return 1.0
+    return float(num_ranks - 1) / num_ranks
+
+
+def _num_steps(collective, num_ranks):
+    """The number of the latency-bound steps of the ring algorithm of the collective."""
+    if collective in ("allreduce", "allreduce_fused"):
+        return 2 * (num_ranks - 1)
+    if collective in ("send", "broadcast"):
+        return 1
+    return num_ranks - 1
+
+
+class CommModel:
+    """The latency model of the collectives. Without a profile, a collective of n bytes over p
+    ranks takes steps(p) * latency + n * bus_factor(p) / bandwidth, where steps and bus_factor
+    follow the ring algorithms. The collectives in the profile are interpolated by the message
+    size instead, and scaled to other numbers of ranks by the bus factor.
+
+    Parameters
+    ----------
+    bandwidth_gbps: float
+        The bus bandwidth of the analytic model in GB/s.
+
+    latency_us: float
+        The latency of each step of the analytic model in microseconds.
+    """
+
+    def __init__(self, bandwidth_gbps=100.0, latency_us=10.0):
+        self.bandwidth_gbps = bandwidth_gbps
+        self.latency_us = latency_us
+        # The collective -> (the number of ranks, the sorted (bytes, time in us) samples).
+        self.tables = {}
+
+    @staticmethod
+    def from_benchmark(text, bandwidth_gbps=100.0, latency_us=10.0):
+        """Fit the model by the output of raf_bench_collectives. The samples of all dtypes are
+        merged by the message size.
+
+        Parameters
+        ----------
+        text: str
+            The output of the benchmark.
+
+        bandwidth_gbps: float
+            The bus bandwidth for the collectives not in the output.
+
+        latency_us: float
+            The latency of each step for the collectives not in the output.
+
+        Returns
+        -------
+        ret: CommModel
+            The fit model.
+        """
+        model = CommModel(bandwidth_gbps, latency_us)
+        num_ranks = None
+        samples = {}
+        for line in text.splitlines():
+            token = re.match(r"#\s*ranks\s+(\d+)", line.strip())
+            if token:
+                num_ranks = int(token.group(1))
+                continue
+            fields = line.split()
+            if len(fields) != 8 or line.lstrip().startswith("#") or fields[0] == "op":
+                continue
+            nbytes, time_us = int(fields[2]), float(fields[5])
+            samples.setdefault(fields[0], {})[nbytes] = time_us
+        if samples and num_ranks is None:
+            raise ValueError("The number of ranks is not found in the benchmark output")
+        for name, points in samples.items():
+            model.tables[name] = (num_ranks, sorted(points.items()))
+        return model
+
+    def time_us(self, collective, nbytes, num_ranks):
+        """Predict the latency of a collective.
+
+        Parameters
+        ----------
+        collective: str
+            The collective, e.g., allreduce, reduce_scatter, allgather, all_to_all or send.
+
+        nbytes: float
+            The message size in bytes, i.e., the buffer size used by nccl-tests.
+
+        num_ranks: int
+            The number of ranks.
+
+        Returns
+        -------
+        ret: float
+            The latency in microseconds.
+        """
+        if num_ranks <= 1 and collective != "send":
+            return 0.0
+        table = self.tables.get(collective)
+        if table is None and collective == "send":
+            table = self.tables.get("broadcast")
+        if table is None or table[0] <= 1:
+            steps = _num_steps(collective, num_ranks)
+            wire = nbytes * _bus_factor(collective, num_ranks)
+            return steps * self.latency_us + wire / (self.bandwidth_gbps * 1e3)
+        profiled_ranks, points = table
+        if nbytes <= points[0][0]:
+            time_us = points[0][1]
+        else:
+            # Interpolate linearly between the samples, and extrapolate by the last bandwidth.
+            idx = 1
+            while idx + 1 < len(points) and points[idx][0] < nbytes:
+                idx += 1
+            (lo_bytes, lo_us), (hi_bytes, hi_us) = points[idx - 1], points[idx]
+            time_us = lo_us + (hi_us - lo_us) * (nbytes - lo_bytes) / max(hi_bytes - lo_bytes, 1)
+        if collective == "send" or profiled_ranks == num_ranks:
+            return time_us
+        scale = _bus_factor(collective, num_ranks) / _bus_factor(collective, profiled_ranks)
+        return time_us * scale
+
+
+class ModelProfile:
+    """The costs of one training iteration of a model at the global batch size.
+
+    Parameters
+    ----------
+    gflops: float
+        The GFLOPs of the forward and the backward.
+
+    param_bytes: int
+        The bytes of the parameters, which are also the bytes of the gradients.
+
+    activation_bytes: int
+        The peak bytes of the activations, excluding the parameters.
+
+    batch_size: int
+        The global batch size.
+
+    tp_comm_bytes: int
+        The bytes of the outputs of the matmuls in the forward, which are reduced among the tensor
+        parallel ranks either in the forward or in the backward.
+
+    num_tp_comms: int
+        The number of the matmuls in the forward.
+
+    num_layers: Optional[int]
+        The number of the layers, which bounds the number of the pipeline stages.
+
+    device_gflops: Optional[float]
+        The peak compute of a device in GFLOP/s.
+    """
+
+    # pylint: disable=too-many-arguments, too-few-public-methods
+    def __init__(
+        self,
+        gflops,
+        param_bytes,
+        activation_bytes,
+        batch_size,
+        tp_comm_bytes=0,
+        num_tp_comms=0,
+        num_layers=None,
+        device_gflops=None,
+    ):
+        self.gflops = gflops
+        self.param_bytes = param_bytes
+        self.activation_bytes = activation_bytes
+        self.batch_size = batch_size
+        self.tp_comm_bytes = tp_comm_bytes
+        self.num_tp_comms = num_tp_comms
+        self.num_layers = num_layers
+        self.device_gflops = device_gflops
+
+
+def _get_tensor_bytes(ty):
+    """The bytes of a tensor type, or the sum of the bytes of the tensors in a tuple type."""
+    # pylint: disable=import-outside-toplevel
+    import tvm
+    from tvm import relay
+
+    if isinstance(ty, relay.TupleType):
+        return sum(_get_tensor_bytes(field) for field in ty.fields)
+    if not isinstance(ty, relay.TensorType):
+        return 0
+    nbytes = max(tvm.runtime.DataType(ty.dtype).bits // 8, 1)
+    for dim in ty.shape:
+        nbytes *= int(dim)
+    return nbytes
+
+
+def profile_model(model, device, args, backward_ratio=2.0, num_layers=None, batch_size=None):
+    """Profile the costs of a forward model for planning.
+
+    Parameters
+    ----------
+    model: Model
+        The forward model.
+
+    device: str
+        The device to estimate the costs on.
+
+    args: List[ndarray]
+        The inputs of the model at the global batch size.
+
+    backward_ratio: float
+        The ratio of the GFLOPs of the backward to the forward.
+
+    num_layers: Optional[int]
+        The number of the layers, which bounds the number of the pipeline stages.
+
+    batch_size: Optional[int]
+        The global batch size, which is the first dimension of the first input by default.
+
+    Returns
+    -------
+    ret: ModelProfile
+        The profile of the model.
+    """
+    # pylint: disable=import-outside-toplevel, protected-access
+    import tvm
+    from raf._core.device import Device
+    from raf._ffi.op_profiler import GetDevicePeak
+    from raf._ffi.pass_ import EstimateGFLOPS, InferType
+    from raf.model.model import get_peak_memory, _get_nbytes
+
+    mod = InferType()(model._internal(*args).mod)
+    with Device(device):
+        gflops = sum(gf.value for gf in EstimateGFLOPS(mod).values())
+    activation_mb = get_peak_memory(model, device, args, include_param=False)
+    param_bytes = sum(_get_nbytes(param) for param in model.state().values())
+
+    matmul_bytes = []
+
+    def visit(expr):
+        if (
+            isinstance(expr, tvm.relay.Call)
+            and isinstance(expr.op, tvm.ir.Op)
+            and expr.op.name in MATMUL_OPS
+        ):
+            matmul_bytes.append(_get_tensor_bytes(expr.checked_type))
+
+    tvm.relay.analysis.post_order_visit(mod["main"], visit)
+    device_gflops = float(GetDevicePeak(Device(device))[0].value)
+    return ModelProfile(
+        gflops=gflops * (1.0 + backward_ratio),
+        param_bytes=param_bytes,
+        activation_bytes=int(activation_mb * 1048576),
+        batch_size=batch_size if batch_size is not None else int(args[0].shape[0]),
+        tp_comm_bytes=sum(matmul_bytes),
+        num_tp_comms=len(matmul_bytes),
+        num_layers=num_layers,
+        device_gflops=device_gflops,
+    )
+
+
+class ParallelPlan:
+    """A parallel strategy and its predicted costs per iteration. The ranks are arranged with the
+    tensor parallel ranks innermost, so they stay within a node, and the pipeline stages
+    outermost, i.e., rank = (stage * dp + dp_rank) * tp + tp_rank.
+
+    Parameters
+    ----------
+    dp: int
+        The data parallel degree.
+
+    tp: int
+        The tensor parallel degree.
+
+    pp: int
+        The number of the pipeline stages.
+
+    zero_opt_level: int
+        The ZeRO level of the data parallelism.
+
+    num_micro_batches: int
+        The number of the micro-batches of the pipeline.
+    """
+
+    # pylint: disable=too-many-arguments, invalid-name
+    def __init__(self, dp, tp, pp, zero_opt_level, num_micro_batches):
+        self.dp = dp
+        self.tp = tp
+        self.pp = pp
+        self.zero_opt_level = zero_opt_level
+        self.num_micro_batches = num_micro_batches
+        # The predicted costs, set by the planner.
+        self.iteration_us = 0.0
+        self.memory_bytes = 0
+        self.throughput = 0.0
+        self.breakdown = {}
+
+    def apply(self, dcfg=None):
+        """Set the data parallelism and ZeRO of the dist config to the plan. The pipeline stages
+        are applied by with_pipeline_parallel with num_micro_batches, and the tensor
+        parallelism by the specs of shard_specs.
+
+        Parameters
+        ----------
+        dcfg: Optional[DistConfig]
+            The dist config, which is the global one by default.
+
+        Returns
+        -------
+        ret: DistConfig
+            The dist config.
+        """
+        dcfg = dcfg if dcfg is not None else get_config()
+        dcfg.enable_data_parallel = self.dp > 1
+        dcfg.zero_opt_level = self.zero_opt_level
+        return dcfg
+
+    def tp_ranks(self, rank):
+        """The tensor parallel ranks of the given rank."""
+        base = rank - rank % self.tp
+        return list(range(base, base + self.tp))
+
+    def shard_specs(self, model, rank=None, min_elements=1):
+        """The specs of the tensor parallel parameters of the model, which are the annotations
+        for ShardingPropagation. The weights of two or more dimensions are sharded alternately
+        along their last and first dimensions in the order of the model state, following the
+        column and row parallel layers of Megatron, so the output of every other matmul stays
+        sharded.
+
+        Parameters
+        ----------
+        model: Model
+            The model.
+
+        rank: Optional[int]
+            The rank, which is the rank of the global communicator by default.
+
+        min_elements: int
+            The minimum number of elements of a sharded weight.
+
+        Returns
+        -------
+        ret: Dict[str, ShardSpec]
+            The specs of the sharded parameters by their names. Empty if tp is 1.
+        """
+        # pylint: disable=import-outside-toplevel
+        if self.tp == 1:
+            return {}
+        from .communicator import get_communicator
+        from .sharding.utils import make_shard_spec
+
+        rank = get_communicator().rank if rank is None else rank
+        ranks = self.tp_ranks(rank)
+        specs = {}
+        column = True
+        for name, param in model.state().items():
+            shape = [int(dim) for dim in param.shape]
+            numel = 1
+            for dim in shape:
+                numel *= dim
+            if len(shape) < 2 or numel < min_elements:
+                continue
+            axis = len(shape) - 1 if column else 0
+            if shape[axis] % self.tp != 0:
+                continue
+            phy_shape = [1] * len(shape)
+            phy_shape[axis] = self.tp
+            specs[name] = make_shard_spec(phy_shape, ranks=ranks, mutable=False)
+            column = not column
+        return specs
+
+    def __repr__(self):
+        return (
+            "ParallelPlan(dp=%d, tp=%d, pp=%d, zero_opt_level=%d, num_micro_batches=%d, "
+            "iteration=%.1fus, memory=%.1fMB, throughput=%.1f samples/s)"
+            % (
+                self.dp,
+                self.tp,
+                self.pp,
+                self.zero_opt_level,
+                self.num_micro_batches,
+                self.iteration_us,
+                self.memory_bytes / 1048576.0,
+                self.throughput,
+            )
+        )
+
+
+def _divisors(num):
+    return [i for i in range(1, num + 1) if num % i == 0]
+
+
+def estimate_plan(
+    plan, profile, comm_model, device_gflops, optimizer_state_ratio=2.0, dp_overlap=0.0
+):
+    """Predict the iteration latency and the peak memory of a device of the plan, which are set
+    to the plan.
+
+    Parameters
+    ----------
+    plan: ParallelPlan
+        The plan.
+
+    profile: ModelProfile
+        The profile of the model.
+
+    comm_model: CommModel
+        The latency model of the collectives.
+
+    device_gflops: float
+        The achievable compute of a device in GFLOP/s.
+
+    optimizer_state_ratio: float
+        The ratio of the bytes of the optimizer states to the parameters, e.g., 2 for Adam.
+
+    dp_overlap: float
+        The fraction of the data parallel collectives hidden by the backward.
+
+    Returns
+    -------
+    ret: ParallelPlan
+        The plan with its predicted costs.
+    """
+    # pylint: disable=too-many-arguments, too-many-locals
+    dp, tp, pp, m = plan.dp, plan.tp, plan.pp, plan.num_micro_batches
+    zero = plan.zero_opt_level
+    num_devices = dp * tp * pp
+
+    # Memory: the model states are sharded by tp and pp, and then by dp for the ZeRO levels. A
+    # stage of the 1F1B schedule keeps the activations of up to pp micro-batches.
+    states = profile.param_bytes / float(tp * pp)
+    params = states / dp if zero >= 3 else states
+    grads = states / dp if zero >= 2 else states
+    opt_states = optimizer_state_ratio * states / (dp if zero >= 1 else 1)
+    activations = profile.activation_bytes / float(dp * tp * pp) * min(pp, m) / m
+    plan.memory_bytes = int(params + grads + opt_states + activations)
+
+    # Compute, with the bubble of the pipeline.
+    compute_us = profile.gflops / num_devices / device_gflops * 1e6
+    compute_us *= (m + pp - 1) / float(m)
+
+    # Tensor parallelism reduces the output of each matmul of the stage and micro-batch.
+    tp_us = 0.0
+    if tp > 1 and profile.num_tp_comms > 0:
+        nbytes = profile.tp_comm_bytes / float(profile.num_tp_comms * dp * m)
+        tp_us = m * profile.num_tp_comms / float(pp) * comm_model.time_us("allreduce", nbytes, tp)
+
+    # Pipeline parallelism sends the activation and its gradient of each micro-batch, whose
+    # size is estimated by the average output of the matmuls.
+    pp_us = 0.0
+    if pp > 1:
+        boundary = profile.tp_comm_bytes / float(max(profile.num_tp_comms, 1) * dp * m)
+        pp_us = 2 * m * comm_model.time_us("send", boundary / tp, 2)
+
+    # Data parallelism reduces the gradients; ZeRO-3 also gathers the parameters in the forward
+    # and the backward.
+    dp_us = 0.0
+    if dp > 1:
+        if zero >= 3:
+            dp_us = comm_model.time_us("reduce_scatter", states, dp)
+            dp_us += 2 * comm_model.time_us("allgather", states, dp)
+        else:
+            dp_us = comm_model.time_us("allreduce", states, dp)
+        dp_us *= 1.0 - dp_overlap
+
+    plan.iteration_us = compute_us + tp_us + pp_us + dp_us
+    plan.throughput = profile.batch_size / plan.iteration_us * 1e6
+    plan.breakdown = {"compute": compute_us, "tp": tp_us, "pp": pp_us, "dp": dp_us}
+    return plan
+
+
+def plan_parallelism(
+    profile,
+    num_devices,
+    memory_budget_mb,
+    comm_model=None,
+    devices_per_node=8,
+    max_micro_batches=32,
+    compute_efficiency=0.5,
+    optimizer_state_ratio=2.0,
+    dp_overlap=0.0,
+    strategies=("dp", "zero", "tp", "pp"),
+    return_all=False,
+):
+    """Search the parallel strategies of the devices for the best predicted throughput within the
+    memory budget. Among the plans of the same latency, the one with the least tensor and
+    pipeline parallelism and the lowest ZeRO level is preferred.
+
+    Parameters
+    ----------
+    profile: ModelProfile
+        The profile of the model.
+
+    num_devices: int
+        The number of the devices.
+
+    memory_budget_mb: float
+        The memory budget of a device in MBs.
+
+    comm_model: Optional[CommModel]
+        The latency model of the collectives, which is analytic by default.
+
+    devices_per_node: int
+        The number of the devices of a node, which bounds the tensor parallel degree.
+
+    max_micro_batches: int
+        The max number of the micro-batches of the pipeline.
+
+    compute_efficiency: float
+        The fraction of the peak compute of a device achieved by the model.
+
+    optimizer_state_ratio: float
+        The ratio of the bytes of the optimizer states to the parameters, e.g., 2 for Adam.
+
+    dp_overlap: float
+        The fraction of the data parallel collectives hidden by the backward.
+
+    strategies: Sequence[str]
+        The strategies to search among "dp", "zero", "tp" and "pp".
+
+    return_all: bool
+        Whether to return all the plans within the budget in the order of the preference.
+
+    Returns
+    -------
+    ret: Union[ParallelPlan, List[ParallelPlan]]
+        The best plan, or all the plans within the budget.
+    """
+    # pylint: disable=too-many-arguments, too-many-locals, invalid-name
+    comm_model = comm_model if comm_model is not None else CommModel()
+    if not profile.device_gflops:
+        raise ValueError("The peak GFLOP/s of the device is not set in the profile")
+    device_gflops = profile.device_gflops * compute_efficiency
+    budget = memory_budget_mb * 1048576
+    plans = []
+    for tp in _divisors(num_devices):
+        if tp > 1 and ("tp" not in strategies or devices_per_node % tp != 0):
+            continue
+        for pp in _divisors(num_devices // tp):
+            if pp > 1 and ("pp" not in strategies or (profile.num_layers or pp) < pp):
+                continue
+            dp = num_devices // (tp * pp)
+            if (dp > 1 and "dp" not in strategies) or profile.batch_size % dp != 0:
+                continue
+            zero_levels = [0, 1, 2, 3] if dp > 1 and "zero" in strategies else [0]
+            local_batch = profile.batch_size // dp
+            micro_batches = [1]
+            if pp > 1:
+                micro_batches = [m for m in _divisors(local_batch) if m <= max_micro_batches]
+            for zero in zero_levels:
+                for m in micro_batches:
+                    plan = estimate_plan(
+                        ParallelPlan(dp, tp, pp, zero, m),
+                        profile,
+                        comm_model,
+                        device_gflops,
+                        optimizer_state_ratio,
+                        dp_overlap,
+                    )
+                    if plan.memory_bytes <= budget:
+                        plans.append(plan)
+    if not plans:
+        raise ValueError(
+            "No parallel strategy of %d devices fits in %.1f MBs" % (num_devices, memory_budget_mb)
+        )
+    plans.sort(key=lambda p: (round(p.iteration_us, 3), p.tp, p.pp, p.zero_opt_level, p.dp))
+    return plans if return_all else plans[0]
@@ -9,7 +9,7 @@ import hashlib
 import torch
 
 from raf import distributed as dist
-from .._core.ndarray import ndarray
+from .._core.ndarray import from_dlpack
 from .._lib import relay
 from .._ffi.pass_ import FromRelay, SwitchTrainOp, validate_relay_param_name
 from ..frontend.model import FrameworkModel
@@ -171,7 +171,8 @@ def from_pytorch(model, shape_dict, model_file=None, hash_file=None):
     for var in relay_mod["main"].params:
         name = var.name_hint
         if name in relay_params:
-            array_value = ndarray(relay_params[name].numpy())
+            # The parameters are shared with the Relay arrays without copying.
+            array_value = from_dlpack(relay_params[name].to_dlpack())
             valid_name = validate_relay_param_name(name)
             meta_params[valid_name] = array_value
             if name in param_dict:
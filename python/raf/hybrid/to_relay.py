@@ -5,6 +5,7 @@
 # pylint: disable=protected-access, too-many-locals
 import ast
 import inspect
+from collections import defaultdict
 from typing import Callable, Dict, List
 
 from raf._lib import relay
@@ -19,11 +20,14 @@ HybridModule = Dict[relay.GlobalVar, relay.Function]
 
 
 class BB2Relay(NodeVisitor):
-    def __init__(self):
+    def __init__(self, inlined=()):
         super(BB2Relay, self).__init__(strict=True)
         self.local_names = None
         self.func_tab = None
         self.jumps = None
+        # The BBs jumped to from one place, which are inlined there instead of called, so the
+        # header of a while loop calls itself in the tail position and compiles into a VM loop.
+        self.inlined = inlined
 
     def _serialize(self, sym_tab: SymTab):
         ret = []
@@ -33,6 +37,13 @@ class BB2Relay(NodeVisitor):
 
         return ret
 
+    def _jump(self, bb: BasicBlock, sym_tab: SymTab) -> relay.Expr:
+        if bb in self.inlined:
+            return BB2Relay(self.inlined).run(
+                bb=bb, sym_tab=dict(sym_tab), local_names=self.local_names, func_tab=self.func_tab
+            )
+        return relay.Call(self.func_tab[bb], self._serialize(sym_tab))
+
     def run(
         self, bb: BasicBlock, sym_tab: SymTab, local_names: List[str], func_tab: FuncTab
     ) -> relay.Expr:
@@ -77,16 +88,14 @@ class BB2Relay(NodeVisitor):
         self, node: None, sym_tab: SymTab
     ):  # pylint: disable=invalid-name,unused-argument
         (jump,) = self.jumps
-        args = self._serialize(sym_tab)
 
-        return relay.Call(self.func_tab[jump], args)
+        return self._jump(jump, sym_tab)
 
     def visit_If(self, node: ast.If, sym_tab: SymTab):  # pylint: disable=invalid-name
         test = node.test(sym_tab)
-        args = self._serialize(sym_tab)
         then_, else_ = self.jumps
-        then_ = relay.Call(self.func_tab[then_], args)
-        else_ = relay.Call(self.func_tab[else_], args)
+        then_ = self._jump(then_, sym_tab)
+        else_ = self._jump(else_, sym_tab)
 
         return relay.If(test, then_, else_)
 
@@ -101,14 +110,23 @@ def cfg2relay(
     func_name = get_func_name(pyfunc)
     func_tab: FuncTab = {}
 
+    in_degree = defaultdict(int)
+    for bb in cfg.bbs:
+        for succ in bb.jumps:
+            in_degree[succ] += 1
+    inlined = {bb for bb in cfg.bbs if bb is not cfg.entry and in_degree[bb] == 1}
+
     for idx, bb in enumerate(cfg.bbs):
-        func_tab[bb] = relay.GlobalVar("{}${}".format(func_name, idx))
+        if bb not in inlined:
+            func_tab[bb] = relay.GlobalVar("{}${}".format(func_name, idx))
     # make function bodies
     hybrid_module: HybridModule = {}
 
     for bb in cfg.bbs:
+        if bb in inlined:
+            continue
         sym_tab = {name: relay.Var(name) for name in local_names}
-        body = BB2Relay().run(
+        body = BB2Relay(inlined).run(
             bb=bb, sym_tab=dict(sym_tab), local_names=local_names, func_tab=func_tab
         )
         params = [sym_tab[name] for name in local_names]
@@ -9,8 +9,8 @@ from .._core import module
 from .._lib import PassContext
 from . import dataflow_pattern
 from . import op
-from .serialization import save_json, load_json
+from .serialization import save_json, load_json, save_binary, load_binary
 from .constant import to_value, const
-from .pass_manager import RAFSequential
+from .pass_manager import RAFSequential, set_pass_cache_size, clear_pass_cache
 from .scope_builder import ScopeBuilder
 from .anf_builder import ANFBuilder
@@ -52,3 +52,22 @@ class RAFSequential(Pass):
 @register_node("raf.pass_.RAFFunctionPass")
 class RAFFunctionPass(Pass):
     """A pass that works on each tvm.relay.Function in a module."""
+
+
+def set_pass_cache_size(size):
+    """Set the maximum number of the pass results memoized across the compilations, e.g., of a
+    hyperparameter sweep. The results of the deterministic passes such as AutoDiff, InferType and
+    FuseTVM are reused when the input module is structurally equal and the pass context is the
+    same. It is 0 by default, which disables the cache, or RAF_PASS_CACHE_SIZE if set.
+
+    Parameters
+    ----------
+    size : int
+        The maximum number of the cached results. The least recently used results are dropped.
+    """
+    pass_.SetPassCacheSize(size)
+
+
+def clear_pass_cache():
+    """Drop all the memoized pass results."""
+    pass_.ClearPassCache()
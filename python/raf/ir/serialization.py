@@ -2,7 +2,7 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """IR serialization."""
-from raf._ffi.ir.serialization import SaveJSON, LoadJSON
+from raf._ffi.ir.serialization import SaveJSON, LoadJSON, SaveBinary, LoadBinary
 
 
 def save_json(node):
@@ -35,3 +35,35 @@ def load_json(json):
         A loaded TVM object
     """
     return LoadJSON(json)
+
+
+def save_binary(node, path):
+    """Save object as a binary file. Unlike save_json, the constants are stored out-of-line
+    in an aligned data region, which is memory-mapped instead of decoded by load_binary.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    path : str
+        The path of the file.
+    """
+    SaveBinary(node, path)
+
+
+def load_binary(path):
+    """Load a binary file saved by save_binary. The loaded constants are views of the
+    memory-mapped file.
+
+    Parameters
+    ----------
+    path : str
+        The path of the file.
+
+    Returns
+    -------
+    node : Object
+        A loaded TVM object
+    """
+    return LoadBinary(path)
@@ -4,5 +4,6 @@
 """Model block definition."""
 from .model import Model
 from .trace import trace, trace_mutate_attr
-from .nn import BatchNorm, Conv2d, Linear
+from .nn import BatchNorm, SyncBatchNorm, Conv2d, Linear, BlockSparseAttention, block_sparse_layout
 from .structure import Sequential
+from .decode import KVCache, DecodeExecutor, PagedKVCache
@@ -0,0 +1,313 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init,protected-access
+"""Stateful autoregressive decoding, where the KV caches are preallocated on the device and
+updated in place by kv_append, so a step only computes the attention of the new tokens over the
+cached prefix instead of recomputing the whole prefix. The paged caches share a pool of blocks
+among many sequences of different lengths, so a sequence only holds the memory of its tokens."""
+import numpy as np
+
+import raf._ffi.memory_pool as ffi
+from raf._core.core_utils import register_node
+from raf._core.device import Device
+from raf._core.executor import VMExecutor
+from raf._core.ndarray import array, ndarray
+from raf._lib import Object
+from raf._op import sym
+
+from .model import Model
+from .trace import _get_func_inputs, trace
+
+# The additive mask of the invisible keys, which is finite so fully masked tiles of the fused
+# attention do not produce NaNs, and representable in float16.
+_MASK_VALUE = -1e4
+
+
+class KVCache(Model):
+    """The preallocated key and value caches of the layers of a decoder, each of which is of
+    (batch_size, num_heads, max_len, head_dim). A decoder holds the cache as an attribute, so the
+    caches are its parameters, and its layers call the cache to append the keys and values of the
+    new tokens in place.
+
+    Parameters
+    ----------
+    num_layers : int
+        The number of the layers.
+    batch_size : int
+        The number of the sequences decoded together.
+    num_heads : int
+        The number of the attention heads.
+    max_len : int
+        The max length of the sequences.
+    head_dim : int
+        The dim of an attention head.
+    dtype : str
+        The dtype of the caches.
+    device : str
+        The device of the caches, which should be the device of the decoding.
+    """
+
+    # pylint: disable=too-many-arguments
+    def build(
+        self, num_layers, batch_size, num_heads, max_len, head_dim, dtype="float32", device="cpu"
+    ):
+        shape = (batch_size, num_heads, max_len, head_dim)
+        for layer in range(num_layers):
+            setattr(self, "k%d" % layer, array(np.zeros(shape, dtype=dtype), device=device))
+            setattr(self, "v%d" % layer, array(np.zeros(shape, dtype=dtype), device=device))
+        self.num_layers = num_layers
+        self.max_len = max_len
+        self.dtype = dtype
+        # The number of the cached tokens of each sequence.
+        self.lengths = np.zeros(batch_size, dtype="int64")
+        # The number of the keys attended by the step being traced, i.e., its length bucket.
+        self.bucket = max_len
+
+    @trace
+    def forward(self, layer, k, v, pos):
+        """Append the keys and values of the new tokens of a layer, which are of (batch_size,
+        num_heads, seq, head_dim), to the caches at pos, and return the keys and values of the
+        bucket, i.e., the first self.bucket positions of the caches, to attend to."""
+        shape = getattr(self, "k%d" % layer).shape
+        k_cache = sym.kv_append(getattr(self, "k%d" % layer), k, pos)
+        v_cache = sym.kv_append(getattr(self, "v%d" % layer), v, pos)
+        return self._take_bucket(k_cache, shape), self._take_bucket(v_cache, shape)
+
+    def _take_bucket(self, cache, shape):
+        if self.bucket == self.max_len:
+            return cache
+        return sym.strided_slice(cache, [0, 0, 0], [shape[0], shape[1], self.bucket])
+
+    def reset(self, lengths=None):
+        """Start new sequences, whose first lengths tokens, if any, are already cached."""
+        self.lengths[:] = 0 if lengths is None else lengths
+
+
+class DecodeExecutor:
+    """Run the steps of an autoregressive decoder over a KVCache. The decoder is traced and
+    compiled per length bucket, i.e., the number of the attended keys rounded up to a bucket, so
+    the shapes of a bucket are static, and its CUDA graph is captured once and replayed by all
+    its steps. The parameters, including the caches, are bound to the graphs by reference, so
+    neither the weights nor the caches are copied by a step.
+
+    The decoder is called by forward(x, pos, mask), where x is the new tokens of (batch_size, seq,
+    ...), pos of (batch_size,) is the number of the cached tokens of each sequence, where the new
+    keys and values are appended, and mask of (batch_size, seq, bucket) is the additive mask of
+    the keys that each new token can attend to, which covers both the padding of the bucket and
+    the causality of the new tokens.
+
+    Parameters
+    ----------
+    model : raf.Model
+        The decoder, which holds the cache.
+    cache : KVCache
+        The cache of the decoder.
+    device : str
+        The device to decode on.
+    buckets : Optional[List[int]]
+        The sorted length buckets. The default is the powers of 2 from 16 up to the max length.
+    enable_cuda_graph : bool
+        Whether to replay the steps of each bucket with a CUDA graph on CUDA devices.
+    """
+
+    def __init__(self, model, cache, device, buckets=None, enable_cuda_graph=True):
+        # pylint: disable=too-many-arguments
+        if buckets is None:
+            buckets = [16]
+            while buckets[-1] < cache.max_len:
+                buckets.append(buckets[-1] * 2)
+        self.buckets = sorted(min(bucket, cache.max_len) for bucket in buckets)
+        if self.buckets[-1] < cache.max_len:
+            self.buckets.append(cache.max_len)
+        self.model = model
+        self.cache = cache
+        self.device = device
+        self.enable_cuda_graph = enable_cuda_graph
+        # The compiled steps keyed by the bucket and the shape of the new tokens.
+        self._steps = {}
+
+    def _get_step(self, bucket, args):
+        key = (bucket, tuple(args[0].shape))
+        if key not in self._steps:
+            # Setting the bucket invalidates the traces of the decoder.
+            self.cache.bucket = bucket
+            record = self.model._internal(*args)
+            executor = VMExecutor(record.mod, self.device, enable_cuda_graph=self.enable_cuda_graph)
+            num_params = len(record.named_params)
+            executor.vm.set_persistent_inputs(list(range(len(args), len(args) + num_params)))
+            self._steps[key] = (executor.vm, record)
+        return self._steps[key]
+
+    def step(self, x):
+        """Run a step of the new tokens, append their keys and values to the cache, and return
+        the outputs of the decoder.
+
+        Parameters
+        ----------
+        x : Union[raf.ndarray, np.ndarray]
+            The new tokens of (batch_size, seq, ...).
+
+        Returns
+        -------
+        result : Object
+            The outputs of the decoder.
+        """
+        seq = x.shape[1]
+        pos = self.cache.lengths
+        lengths = pos + seq
+        assert lengths.max() <= self.cache.max_len, "The sequences exceed the max length"
+        bucket = next(b for b in self.buckets if b >= lengths.max())
+        # The new token i of a sequence attends to the keys before pos + i + 1.
+        ends = pos[:, None] + np.arange(seq) + 1
+        visible = np.arange(bucket)[None, None, :] < ends[:, :, None]
+        mask = np.where(visible, 0, _MASK_VALUE).astype(self.cache.dtype)
+        if isinstance(x, np.ndarray):
+            x = array(x, device=self.device)
+        args = [x, array(pos, device=self.device), array(mask, device=self.device)]
+        vm, record = self._get_step(bucket, args)
+        out = vm.run(*_get_func_inputs(record, args, {}, get_handle=False))
+        self.cache.lengths[:] = lengths
+        return out
+
+
+@register_node("raf.memory_pool.BlockAllocator")
+class BlockAllocator(Object):
+    """The allocator of the blocks of the paged KV caches, whose arena is allocated from the
+    memory pool of the device. See PagedKVCache."""
+
+
+class PagedKVCache(Model):
+    """The paged key and value caches of the layers of a decoder, which are shared by many
+    concurrent sequences. Each cache is of (num_blocks, num_heads, block_size, head_dim), and the
+    token t of a sequence is the slot t % block_size of the block t // block_size of its row of the
+    block table. The blocks are handed out to a sequence as it grows, and reused by the other
+    sequences once it is freed, so the memory is not fragmented by the sequences of different
+    lengths.
+
+    A step of a batch is prepared by prepare(seq_ids, seq), which allocates the blocks of the new
+    tokens and returns the block table, the positions and the lengths of the batch, which are
+    passed to the layers as inputs, so the shapes of a step do not depend on the lengths.
+
+    Parameters
+    ----------
+    num_layers : int
+        The number of the layers.
+    num_blocks : int
+        The number of the blocks of each cache.
+    block_size : int
+        The number of the tokens of a block.
+    num_heads : int
+        The number of the attention heads.
+    head_dim : int
+        The dim of an attention head.
+    max_blocks : int
+        The max number of the blocks of a sequence, i.e., the width of the block table.
+    dtype : str
+        The dtype of the caches.
+    device : str
+        The device of the caches, which should be the device of the decoding.
+    """
+
+    # pylint: disable=too-many-arguments
+    def build(
+        self,
+        num_layers,
+        num_blocks,
+        block_size,
+        num_heads,
+        head_dim,
+        max_blocks,
+        dtype="float32",
+        device="cpu",
+    ):
+        self._allocator = ffi.BlockAllocator(
+            Device(device), num_layers, num_blocks, block_size, num_heads, head_dim, dtype
+        )
+        for layer in range(num_layers):
+            caches = self._allocator.caches
+            setattr(self, "k%d" % layer, ndarray.from_tensor_value(caches[2 * layer]))
+            setattr(self, "v%d" % layer, ndarray.from_tensor_value(caches[2 * layer + 1]))
+        self.num_layers = num_layers
+        self.block_size = block_size
+        self.max_blocks = max_blocks
+        self.device = device
+        # The number of the cached tokens of each sequence.
+        self.lengths = {}
+
+    @trace
+    def forward(self, layer, q, k, v, block_table, pos, lengths):
+        """Append the keys and values of the new tokens of a layer, which are of (batch_size,
+        num_heads, seq, head_dim), to the caches, and return the attention of the queries q of the
+        new tokens over the cached tokens of their sequences."""
+        k_cache = sym.paged_kv_append(getattr(self, "k%d" % layer), k, block_table, pos)
+        v_cache = sym.paged_kv_append(getattr(self, "v%d" % layer), v, block_table, pos)
+        return sym.paged_attention(q, k_cache, v_cache, block_table, lengths)
+
+    def reserve(self, seq_id, num_tokens):
+        """Allocate the blocks of num_tokens new tokens of the sequence, which is added if it is
+        new. Nothing is allocated if the free blocks are not enough, so a scheduler can admit or
+        preempt the sequences by the result.
+
+        Parameters
+        ----------
+        seq_id : int
+            The id of the sequence.
+        num_tokens : int
+            The number of the new tokens.
+
+        Returns
+        -------
+        ret : bool
+            Whether the blocks are allocated.
+        """
+        num_tokens += self.lengths.get(seq_id, 0)
+        if num_tokens > self.max_blocks * self.block_size:
+            return False
+        return bool(ffi.BlockAllocatorReserve(self._allocator, seq_id, num_tokens))
+
+    def free(self, seq_id):
+        """Release the blocks of the finished sequence."""
+        ffi.BlockAllocatorFree(self._allocator, seq_id)
+        self.lengths.pop(seq_id, None)
+
+    @property
+    def num_free_blocks(self):
+        """The number of the blocks that are not owned by any sequence."""
+        return int(ffi.BlockAllocatorNumFreeBlocks(self._allocator))
+
+    def prepare(self, seq_ids, seq):
+        """Allocate the blocks of seq new tokens of each sequence of the batch, and return the
+        inputs of the step.
+
+        Parameters
+        ----------
+        seq_ids : List[Optional[int]]
+            The sequences of the batch, where None is an idle slot, whose steps are dropped and
+            whose outputs are zeros.
+        seq : int
+            The number of the new tokens of each sequence.
+
+        Returns
+        -------
+        ret : Tuple[raf.ndarray, raf.ndarray, raf.ndarray]
+            The block table of (batch_size, max_blocks), the positions of the new tokens of
+            (batch_size,), and the lengths of the sequences including the new tokens of
+            (batch_size,), which are int64 on the device of the caches.
+        """
+        batch_size = len(seq_ids)
+        table = np.zeros((batch_size, self.max_blocks), dtype="int64")
+        # The steps of the idle slots are appended beyond the table, so they are dropped.
+        pos = np.full((batch_size,), self.max_blocks * self.block_size, dtype="int64")
+        lengths = np.zeros((batch_size,), dtype="int64")
+        for i, seq_id in enumerate(seq_ids):
+            if seq_id is None:
+                continue
+            if not self.reserve(seq_id, seq):
+                raise RuntimeError("Out of the KV cache blocks for sequence %d" % seq_id)
+            blocks = [block.value for block in ffi.BlockAllocatorGetBlocks(self._allocator, seq_id)]
+            table[i, : len(blocks)] = blocks
+            pos[i] = self.lengths.get(seq_id, 0)
+            lengths[i] = pos[i] + seq
+            self.lengths[seq_id] = int(lengths[i])
+        return tuple(array(x, device=self.device) for x in (table, pos, lengths))
@@ -299,4 +299,125 @@ def get_peak_memory(model, device, args, include_param=True):
     return max(trace, key=lambda x: x[1])[1]
 
 
+def _get_nbytes(array):
+    token = re.search(r"(\d+)$", array.dtype)
+    nbits = int(token.group(1)) if token else 8
+    nsize = 1
+    for shape in array.shape:
+        nsize *= shape
+    return nsize * nbits / 8
+
+
+def predict_memory(model, device, args, include_workspace=True):
+    """A utility function to predict the peak memory consumption before compilation.
+    Unlike get_peak_memory, the prediction is based on the liveness of the tensors in the
+    un-optimized IR, so it does not compile the model and only takes a fraction of the time.
+
+    Parameters
+    ----------
+    model: raf.model.BaseModel
+        The target model, or the model wrapped by an optimizer for training.
+
+    device: str
+        The target device.
+
+    args: List[raf.ndarray]
+        The input arguments of the model.
+
+    include_workspace: bool
+        Whether to build the ops to get their workspace sizes.
+
+    Returns
+    -------
+    ret: Dict[str, Any]
+        The predicted memory in MBs, including the peak and its breakdown to "parameter",
+        "gradient", "optimizer_state", "buffer" (other model states), "input", "activation",
+        and "workspace". The gradient size is derived from the learnable parameters and is
+        partitioned when ZeRO level is at least 2, while the optimizer states are already
+        partitioned when the optimizer is built with ZeRO enabled. "trace" is the list of
+        (op name, activation MBs, workspace MBs) of each op.
+    """
+    # pylint: disable=import-outside-toplevel
+    from raf import distributed as dist
+    from raf._ffi.pass_ import PredictMemory, InferType, ToGraphNormalForm, ToANormalForm
+    from raf.ir.pass_manager import RAFSequential
+
+    mod = model._internal(*args).mod
+    mod = RAFSequential([ToGraphNormalForm(), ToANormalForm(), InferType()])(mod)
+    with Device(device):
+        pred = PredictMemory(mod, Device(device), include_workspace)
+
+    # Classify the model states.
+    params, states, buffers = 0.0, 0.0, 0.0
+    direct_states = {arr._ndarray__handle for arr in _get_attr_params_value(model)}
+    visited = set()
+    for arr in model.state().values():
+        handle = arr._ndarray__handle
+        if handle in visited:
+            continue
+        visited.add(handle)
+        nbytes = _get_nbytes(arr) / 1048576.0
+        if arr.requires_grad and "float" in arr.dtype:
+            params += nbytes
+        elif handle in direct_states and _get_attr_models_value(model):
+            # The non-learnable states of a wrapper model are the optimizer states.
+            states += nbytes
+        else:
+            buffers += nbytes
+
+    # Gradients are only produced when the model is wrapped by an optimizer.
+    grads = 0.0
+    if states > 0:
+        grads = params
+        if dist.get_config().zero_opt_level >= 2:
+            grads /= dist.get_communicator().size
+        grads = min(grads, pred["activation"].value)
+
+    return {
+        "peak": pred["peak"].value,
+        "parameter": params,
+        "gradient": grads,
+        "optimizer_state": states,
+        "buffer": buffers,
+        "input": max(pred["param"].value - params - states - buffers, 0.0),
+        "activation": pred["activation"].value - grads,
+        "workspace": pred["workspace"].value,
+        "trace": [(name.value, act.value, ws.value) for name, act, ws in pred["trace"]],
+    }
+
+
+def search_max_batch_size(get_model_and_args, device, budget_mbs, max_batch_size=1024):
+    """A utility function to search for the maximum batch size whose predicted peak memory fits
+    into the budget. The peak memory is assumed to be monotonic to the batch size.
+
+    Parameters
+    ----------
+    get_model_and_args: Callable[[int], Tuple[raf.model.BaseModel, List[raf.ndarray]]]
+        A function that returns the model and its input arguments of the given batch size.
+
+    device: str
+        The target device.
+
+    budget_mbs: float
+        The memory budget in MBs.
+
+    max_batch_size: int
+        The upper bound of the batch size to search.
+
+    Returns
+    -------
+    ret: int
+        The maximum batch size that fits into the budget, or 0 if even batch size 1 does not fit.
+    """
+    low, high = 0, max_batch_size
+    while low < high:
+        mid = (low + high + 1) // 2
+        model, args = get_model_and_args(mid)
+        if predict_memory(model, device, args)["peak"] <= budget_mbs:
+            low = mid
+        else:
+            high = mid - 1
+    return low
+
+
 # pylint: enable=protected-access
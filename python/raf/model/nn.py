@@ -143,6 +143,31 @@ class BatchNorm(Model):  # pylint: disable=too-many-instance-attributes
         return ret
 
 
+class SyncBatchNorm(BatchNorm):
+    """The batch norm whose training stats are reduced across the ranks of rank_list."""
+
+    # pylint: disable=arguments-differ
+    def build(self, num_features, eps=1e-5, momentum=0.1, affine=True, rank_list=None):
+        self.rank_list = rank_list
+        BatchNorm.build(self, num_features, eps, momentum, affine)
+
+    @trace
+    def forward(self, x):
+        ret = sym._sync_batch_norm_train(  # pylint: disable=protected-access
+            x=x,
+            w=self.w,
+            b=self.b,
+            running_mean=self.running_mean,
+            running_var=self.running_var,
+            eps=self.eps,
+            momentum=self.momentum,
+            rank_list=self.rank_list,
+        )
+        trace_mutate_attr(self, "running_mean", ret[1])
+        trace_mutate_attr(self, "running_var", ret[2])
+        return ret[0]
+
+
 class Linear(Model):
     def build(self, in_features, out_features, bias=True):
         self.in_features = in_features
@@ -203,3 +228,49 @@ class GELU(Model):
                 sym.multiply(sym.erf(sym.multiply(x, self._inv_sqrt_2)), self._inv_2),
             ),
         )
+
+
+def block_sparse_layout(num_blocks, local=1, num_global=0, causal=False):
+    """Make the block layout of the local and global sparse attention, which is the descriptor
+    (num_block_rows, num_block_cols, mask...) of the block-sparse ops.
+
+    Parameters
+    ----------
+    num_blocks : int
+        The number of the blocks of the sequence.
+    local : int
+        The number of the blocks on each side of the diagonal that each block attends to.
+    num_global : int
+        The number of the leading global blocks, which attend to and are attended by all blocks.
+    causal : bool
+        Whether to drop the blocks above the diagonal.
+
+    Returns
+    -------
+    layout : Tuple[int]
+        The block layout.
+    """
+    row = np.arange(num_blocks).reshape(-1, 1)
+    col = np.arange(num_blocks).reshape(1, -1)
+    mask = (np.abs(row - col) <= local) | (row < num_global) | (col < num_global)
+    if causal:
+        mask &= col <= row
+    return (num_blocks, num_blocks) + tuple(int(m) for m in mask.flatten())
+
+
+class BlockSparseAttention(Model):
+    """The attention over the non-zero blocks of a block layout, whose compute and memory scale
+    with the non-zero blocks instead of the square of the sequence length. The inputs are of
+    (batch * heads, seq, head_dim), where seq is the number of the blocks times block."""
+
+    def build(self, layout, head_dim, block=32, causal=False):
+        self.layout = tuple(layout)
+        self.block = block
+        self.scale = 1.0 / math.sqrt(head_dim)
+        self.causal = causal
+
+    @trace
+    def forward(self, q, k, v):
+        score = sym.block_sparse_matmul_sdd(q, k, self.layout, self.block)
+        prob = sym.block_sparse_softmax(score, self.layout, self.block, self.scale, self.causal)
+        return sym.block_sparse_matmul_dsd(prob, v, self.layout, self.block)
@@ -118,14 +118,31 @@ def _unwrap(result):
     return result
 
 
+def _get_input_signature(args, kwargs):
+    """The shapes and dtypes of the inputs, so that each signature has its own trace record
+    and thus its own module, which the executable cache of the VM keys on."""
+
+    def get_signature(x):
+        if isinstance(x, ndarray):
+            return (tuple(x.shape), x.dtype)
+        if isinstance(x, (tuple, list)):
+            return tuple(get_signature(i) for i in x)
+        return type(x).__name__
+
+    signature = [get_signature(x) for x in args]
+    signature += [(key, get_signature(kwargs[key])) for key in sorted(kwargs)]
+    return str(signature)
+
+
 def _get_trace_record(pyfunc, args, kwargs):
     model = args[0]
     func_name = get_func_name(pyfunc)
-    record = cacher.get_cache(model, "trace@" + func_name, None)
+    key = "trace@" + func_name + "@" + _get_input_signature(args[1:], kwargs)
+    record = cacher.get_cache(model, key, None)
     if record is not None:
         return record
     record = _do_tracing(pyfunc, args, kwargs)
-    cacher.set_cache(model, "trace@" + func_name, record)
+    cacher.set_cache(model, key, record)
     return record
 
 
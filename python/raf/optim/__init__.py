@@ -2,7 +2,8 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Optimizers, e.g., SGD."""
-from . import sgd, lans
+from . import sgd, lans, adam
 from .sgd import SGD
 from .lans import LANS
+from .adam import with_adam, with_adamw
 from .optim import inline
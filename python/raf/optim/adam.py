@@ -0,0 +1,425 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=invalid-name, too-many-instance-attributes, too-many-locals, too-many-statements, protected-access, too-many-arguments, too-many-branches
+"""Adam and AdamW optimizers built on the multi-tensor fused Adam op."""
+import numpy as np
+
+from raf._core.core_utils import get_chained_attr
+from raf._core.ndarray import array, ndarray
+from raf.model import trace, Model, trace_mutate_attr
+from raf.model.trace import _get_func_inputs
+from raf._op import sym as _op
+from .. import distributed as dist
+from .data_parallel import with_data_parallel
+from ..distributed.op import allgather
+from .optim import with_autodiff
+from .utils import has_grad, split_ndarray_with_padding
+
+# The number of elements sharing the scales of the 8-bit states, i.e., kStateBlockSize of the
+# CUDA kernels.
+_STATE_BLOCK_SIZE = 2048
+
+
+def _split_by_numel(entries, num_buckets):
+    """Split the entries into at most num_buckets consecutive groups of similar total sizes."""
+    total = sum(np.prod(entry[3].shape) for entry in entries)
+    bucket_size = max(1, int(np.ceil(total / max(num_buckets, 1))))
+    buckets, curr, curr_size = [], [], 0
+    for entry in entries:
+        curr.append(entry)
+        curr_size += np.prod(entry[3].shape)
+        if curr_size >= bucket_size and len(buckets) < num_buckets - 1:
+            buckets.append(curr)
+            curr, curr_size = [], 0
+    if curr:
+        buckets.append(curr)
+    return buckets
+
+
+def with_adam(
+    lr=1e-3,
+    betas=(0.9, 0.999),
+    eps=1e-8,
+    weight_decay=0.0,
+    bias_correction=True,
+    adamw=False,
+    grad_scale=1.0,
+    overlap_buckets=1,
+    dynamic_loss_scale=False,
+    init_scale=2.0**16,
+    scale_window=2000,
+    max_grad_norm=None,
+    offload=False,
+    quantize_states=False,
+):
+    """Optimizer : Adam
+    # References
+    - Adam: A Method for Stochastic Optimization. https://arxiv.org/abs/1412.6980
+    - Decoupled Weight Decay Regularization. https://arxiv.org/abs/1711.05101
+
+    All parameters are updated by one fused Adam op that covers many tensors per kernel launch.
+    Parameters that are not float32 keep float32 master weights, and the op writes the updated
+    weights back to the parameters in their own dtype.
+
+    Parameters
+    ----------
+    lr: Optional[Float]
+        Learning rate. Default: 1e-3
+
+    betas: Optional[Tuple[Float, Float]]
+        Coefficients used for computing running averages of gradient and its square.
+        Default: (0.9, 0.999)
+
+    eps: Optional[Float]
+        Term added to the denominator to improve numerical stability. Default: 1e-8
+
+    weight_decay: Optional[Float]
+        Weight decay. It is a L2 penalty in Adam and a decoupled decay in AdamW. Default: 0
+
+    bias_correction: Optional[bool]
+        Whether to apply the bias correction of the moments. Default: True
+
+    adamw: Optional[bool]
+        Whether to use AdamW (decoupled weight decay). Default: False
+
+    grad_scale: Optional[Float]
+        The loss scale to divide the gradients by before the update. Default: 1
+
+    overlap_buckets: Optional[int]
+        The number of groups the parameters are split into under ZeRO. Each group is updated
+        by its own Adam op and then all-gathered, so the all-gather of a group can overlap
+        the update of the next one. Default: 1
+
+    dynamic_loss_scale: Optional[bool]
+        Whether to scale the loss dynamically, in which case grad_scale is ignored. The dy is
+        multiplied by the loss scale kept on the device, and the Adam op checks the gradients
+        for inf and nan. A step with inf or nan is skipped and halves the loss scale, all on the
+        device, so it does not sync the host. It requires all the parameters to be updated by
+        one Adam op without ZeRO. Default: False
+
+    init_scale: Optional[Float]
+        The initial loss scale of the dynamic loss scaling. Default: 65536
+
+    scale_window: Optional[int]
+        The number of the finite steps after which the dynamic loss scale is doubled.
+        Default: 2000
+
+    max_grad_norm: Optional[Float]
+        If given, the gradients are clipped by their global L2 norm to this value before the
+        update. The norm and the clipping of all the gradients take one multi-tensor op, and
+        the norm is never read by the host. It does not support ZeRO or the dynamic loss
+        scaling, and requires the gradients of the same dtype. Default: None
+
+    offload: Optional[bool]
+        Whether to offload the optimizer states to the pinned host memory, which holds the
+        float32 master weights and the moments (or their shards under ZeRO). The gradients are
+        copied to the host, updated by the multi-threaded host Adam op, and the weights are
+        copied back in the dtype of the parameters. It trades the device memory of the states
+        for the copies, and does not support the dynamic loss scaling. Default: False
+
+    quantize_states: Optional[bool]
+        Whether to store the moments in 8 bits, which takes a quarter of the memory of the
+        float32 moments. Each block of 2048 elements is quantized by its own absmax (dynamic
+        quantization per block), and the op dequantizes and requantizes the blocks inside the
+        fused update kernel. It works with ZeRO, where the moment shards are quantized, but not
+        with offloading. Default: False
+
+    Returns
+    ret : function
+        The wrapper which wraps a model with Adam
+    """
+    op_name = "adamw" if adamw else "adam"
+
+    def decorator(model):
+        class AdamWrapper(Model):
+            """Adam wrapper model
+
+            Parameters
+            ----------
+            model: the forward model
+            """
+
+            # pylint: disable=attribute-defined-outside-init
+            def build(self, model):
+                self.model = model
+                assert dist.get_config().zero_opt_level < 3, "Adam does not support ZeRO-3 yet"
+                self.ad_model = with_data_parallel(with_autodiff(model))
+                self.one = array(1.0, dtype="float32")
+                device = None
+                dcfg = dist.get_config()
+                comm = dist.get_communicator()
+                self.params = {}
+                self.zeros = {}
+                # The weight copies on the host in the dtype of the low-precision parameters.
+                self.host_copies = {}
+                # The scales of the 8-bit moments of each parameter.
+                self.scales = {}
+                host = "cuda_host" if offload else None
+                assert not (quantize_states and offload), "8-bit states do not support offloading"
+                for name, param in self.model.state().items():
+                    if param.requires_grad is True:
+                        if device is None:
+                            device = param.device
+                        else:
+                            assert device == param.device
+                        assert isinstance(param, ndarray), "Only `raf.ndarray` can be optimized!"
+                        if "float" not in param.dtype:
+                            continue
+                        # Keep a float32 master weight for low-precision parameters. With
+                        # ZeRO, the master weight and the moments are the local shards.
+                        part_shape = param.shape
+                        if dcfg.zero_opt_level:
+                            param_nd = param.to(device="cpu")
+                            if param.dtype != "float32":
+                                param_nd = param_nd.to(dtype="float32")
+                            slice_param = split_ndarray_with_padding(param_nd, comm.size)[comm.rank]
+                            weight = ndarray(
+                                slice_param,
+                                device=host or param.device,
+                                name=f"{name}.adam_w",
+                                dtype="float32",
+                            )
+                            setattr(self, f"{name}.adam_w", weight)
+                            part_shape = slice_param.shape
+                        elif offload:
+                            weight = ndarray(
+                                param.to(device="cpu", dtype="float32"),
+                                device=host,
+                                name=f"{name}.adam_w",
+                                dtype="float32",
+                            )
+                            setattr(self, f"{name}.adam_w", weight)
+                        elif param.dtype != "float32":
+                            weight = ndarray(
+                                param.to(dtype="float32"),
+                                device=param.device,
+                                name=f"{name}.adam_w",
+                                dtype="float32",
+                            )
+                            setattr(self, f"{name}.adam_w", weight)
+                        else:
+                            weight = param
+                        if param.dtype not in self.zeros:
+                            self.zeros[param.dtype] = array(0.0, dtype=param.dtype)
+                        if offload and param.dtype != "float32":
+                            copy = array(
+                                np.zeros(part_shape, dtype=param.dtype),
+                                device=host,
+                                name=f"{name}.adam_copy",
+                            )
+                            setattr(self, f"{name}.adam_copy", copy)
+                            self.host_copies[name] = copy
+                        if quantize_states:
+                            m_i = array(
+                                np.zeros(part_shape, "int8"), device=device, name=f"{name}.m"
+                            )
+                            v_i = array(
+                                np.zeros(part_shape, "uint8"), device=device, name=f"{name}.v"
+                            )
+                            nblocks = -(-int(np.prod(part_shape)) // _STATE_BLOCK_SIZE)
+                            scales = array(
+                                np.zeros(2 * nblocks, dtype="float32"),
+                                device=device,
+                                name=f"{name}.adam_scales",
+                            )
+                            setattr(self, f"{name}.adam_scales", scales)
+                            self.scales[name] = scales
+                        else:
+                            npa = np.zeros(part_shape, dtype="float32")
+                            m_i = array(npa, device=host or device, name=f"{name}.m")
+                            v_i = array(npa, device=host or device, name=f"{name}.v")
+                        setattr(self, f"{name}.m", m_i)
+                        setattr(self, f"{name}.v", v_i)
+                        self.params[param._ndarray__handle] = (name, param, weight, m_i, v_i)
+                assert device is not None
+                self.device = device
+                self.step = array(0.0, dtype="float32", device=device, name="step")
+                if dynamic_loss_scale:
+                    assert not dcfg.zero_opt_level, "Dynamic loss scaling does not support ZeRO"
+                    assert not offload, "Dynamic loss scaling does not support offloading"
+                    # The loss scale, the finite steps, the skipped steps and the inf flag.
+                    npa = np.array([init_scale, 0, 0, 0], dtype="float32")
+                    self.loss_scaler = array(npa, device=device, name="loss_scaler")
+                if max_grad_norm is not None:
+                    # The gradients are sharded by ZeRO, and scaled by the dynamic loss scale.
+                    assert not dcfg.zero_opt_level, "Gradient clipping does not support ZeRO"
+                    assert not dynamic_loss_scale, "Clipping does not support dynamic loss scale"
+
+            def _update(self, entries, step, mixed_precision):
+                """Apply one fused Adam op to the entries of (name, grad, param, w, m, v)."""
+                g_list = [entry[1] for entry in entries]
+                tensor_list = g_list + [entry[3] for entry in entries]
+                tensor_list += [entry[4] for entry in entries] + [entry[5] for entry in entries]
+                if mixed_precision:
+                    tensor_list += [entry[2] for entry in entries]
+                if quantize_states:
+                    tensor_list += [self.scales[entry[0]] for entry in entries]
+                if dynamic_loss_scale:
+                    tensor_list.append(self.loss_scaler)
+                return getattr(_op, op_name)(
+                    tensor_list,
+                    step,
+                    lr,
+                    betas[0],
+                    betas[1],
+                    eps,
+                    weight_decay,
+                    bias_correction,
+                    grad_scale,
+                    mixed_precision,
+                    dynamic_loss_scale,
+                    scale_window,
+                    quantize_states,
+                )
+
+            @trace
+            def forward(self, dy, *args, **kwargs):
+                dcfg = dist.get_config()
+                comm = dist.get_communicator()
+                if dynamic_loss_scale:
+                    scale = _op.squeeze(_op.strided_slice(self.loss_scaler, [0], [1], [1]))
+                    dy = _op.multiply(dy, _op.cast_like(scale, dy))
+                y, dxs = self.ad_model(dy, *args, **kwargs)
+                record = self.ad_model._internal(dy, *args, **kwargs)
+                inputs = _get_func_inputs(record, [dy, *args], kwargs)
+                inputs = inputs[1:]  # remove dy
+                # update step
+                next_step = _op.add(self.step, self.one, out=self.step)
+                trace_mutate_attr(self, "step", next_step)
+                # The updates are grouped by whether the op writes back low-precision copies.
+                groups = {False: [], True: []}
+                for i, param in enumerate(inputs):
+                    dxi = dxs[i] if len(inputs) > 1 else dxs
+                    if param in self.params and has_grad(dxi):
+                        name, p, w, m, v = self.params[param]
+                        # The offloaded update writes the copies on the host even with ZeRO.
+                        mixed_precision = p.dtype != "float32" and (
+                            offload or not dcfg.zero_opt_level
+                        )
+                        groups[mixed_precision].append((name, dxi, p, w, m, v))
+                if max_grad_norm is not None and (groups[False] or groups[True]):
+                    # The gradients are still multiplied by the loss scale.
+                    clipped = _op.multi_tensor_clip_by_global_norm(
+                        [entry[1] for entry in groups[False] + groups[True]],
+                        max_grad_norm * grad_scale,
+                    )
+                    idx = 0
+                    for group in groups.values():
+                        for i, entry in enumerate(group):
+                            group[i] = (entry[0], clipped[idx]) + entry[2:]
+                            idx += 1
+                if dynamic_loss_scale:
+                    # The loss scaler is updated once per step by the only Adam op.
+                    assert not (groups[False] and groups[True]), (
+                        "Dynamic loss scaling requires the parameters to be all float32 or all "
+                        "low-precision"
+                    )
+
+                step = next_step
+                if offload and (groups[False] or groups[True]):
+                    step = _op.device_copy(next_step, self.device, "cuda_host")
+                for mixed_precision, entries in groups.items():
+                    if not entries:
+                        continue
+                    buckets = [entries]
+                    if dcfg.zero_opt_level > 0 or offload:
+                        buckets = _split_by_numel(entries, overlap_buckets)
+                    for bucket in buckets:
+                        ntensor = len(bucket)
+                        update_entries = bucket
+                        if offload:
+                            # Copy the gradients to the host, where the copies are written.
+                            update_entries = [
+                                (
+                                    name,
+                                    _op.device_copy(g, self.device, "cuda_host"),
+                                    self.host_copies.get(name, p),
+                                    w,
+                                    m,
+                                    v,
+                                )
+                                for name, g, p, w, m, v in bucket
+                            ]
+                        output_list = self._update(update_entries, step, mixed_precision)
+                        if dynamic_loss_scale:
+                            trace_mutate_attr(self, "loss_scaler", output_list[-1])
+                        for idx, (name, _, p, w, _, _) in enumerate(bucket):
+                            new_w = output_list[idx + ntensor]
+                            next_m = output_list[idx + 2 * ntensor]
+                            next_v = output_list[idx + 3 * ntensor]
+                            param_model = get_chained_attr(self.model, name.split(".")[:-1])
+                            if offload:
+                                # Upload the weight in the dtype of the parameter.
+                                if mixed_precision:
+                                    new_w = output_list[idx + 4 * ntensor]
+                                new_w = _op.device_copy(new_w, "cuda_host", self.device)
+                            if dcfg.zero_opt_level > 0:
+                                if p.dtype != "float32" and not offload:
+                                    new_w = _op.cast(new_w, p.dtype)
+                                new_weight = allgather(new_w, axis=0)
+                                # Slice to remove the zero-padding if needed.
+                                if w.shape[0] * comm.size > p.shape[0]:
+                                    new_weight = _op.strided_slice(
+                                        new_weight, [0], [p.shape[0]], [1]
+                                    )
+                                next_w = _op.add(new_weight, self.zeros[p.dtype], out=p)
+                            elif offload:
+                                next_w = new_w
+                            elif mixed_precision:
+                                # The op writes the updated weight to the parameter in place.
+                                next_w = output_list[idx + 4 * ntensor]
+                            else:
+                                next_w = new_w
+                            trace_mutate_attr(param_model, name.split(".")[-1], next_w)
+                            trace_mutate_attr(self, f"{name}.m", next_m)
+                            trace_mutate_attr(self, f"{name}.v", next_v)
+                            if quantize_states:
+                                # The scales are the last group.
+                                next_scales = output_list[idx + (4 + mixed_precision) * ntensor]
+                                trace_mutate_attr(self, f"{name}.adam_scales", next_scales)
+                return y
+
+        return AdamWrapper(model)
+
+    return decorator
+
+
+def with_adamw(
+    lr=1e-3,
+    betas=(0.9, 0.999),
+    eps=1e-8,
+    weight_decay=0.01,
+    bias_correction=True,
+    grad_scale=1.0,
+    overlap_buckets=1,
+    dynamic_loss_scale=False,
+    init_scale=2.0**16,
+    scale_window=2000,
+    max_grad_norm=None,
+    offload=False,
+    quantize_states=False,
+):
+    """Optimizer : AdamW, i.e., Adam with decoupled weight decay. See with_adam for the
+    parameters. The default weight decay is 0.01.
+
+    Returns
+    ret : function
+        The wrapper which wraps a model with AdamW
+    """
+    return with_adam(
+        lr,
+        betas,
+        eps,
+        weight_decay,
+        bias_correction,
+        True,
+        grad_scale,
+        overlap_buckets,
+        dynamic_loss_scale,
+        init_scale,
+        scale_window,
+        max_grad_norm,
+        offload,
+        quantize_states,
+    )
@@ -12,11 +12,18 @@ The methodologies includes:
                  optimizer can have a partitioned optimizer status. Note that optimizers must
                  consider gradient partitioning if applied; otherwise the result will be incorrect.
    2.2 (ZeRO-2): Use reduce instead of all-reduce in (1) to obtain only a partition of gradients.
+   2.3 (ZeRO-3): In addition to (2.2), partition the learnable parameters at rest. Each parameter
+                 is allgathered right before the layer using it, and the allgathers are issued
+                 `zero_prefetch_depth` layers ahead to overlap with the computation. The wrapped
+                 model only reads the partitioned parameters, so the wrapped optimizer has to
+                 update the partitions (`zero_shards`) instead of the full parameters.
 """
 from raf.ir import RAFSequential
 from .optim import inline
+from .utils import split_ndarray_with_padding
 from .. import distributed as dist
-from .._ffi.pass_ import PartitionGradient, InferType
+from .._core.ndarray import Symbol, ndarray
+from .._ffi.pass_ import PartitionGradient, PartitionParameter, InferType
 from ..model import Model, trace
 from ..model.trace import _get_func_inputs
 
@@ -36,6 +43,24 @@ def with_data_parallel(model):
         def build(self, model):
             # pylint: disable=attribute-defined-outside-init, missing-function-docstring
             self.model = model
+            # The names of the partitioned parameters for ZeRO-3.
+            self.zero_shards = []
+            dcfg = dist.get_config()
+            if dcfg.zero_opt_level < 3:
+                return
+            comm = dist.get_communicator()
+            for name, param in model.state().items():
+                if param.requires_grad and "float" in param.dtype:
+                    param_nd = param.to(device="cpu")
+                    shard = ndarray(
+                        split_ndarray_with_padding(param_nd, comm.size)[comm.rank],
+                        device=param.device,
+                        name=f"{name}.zero_shard",
+                        dtype=param.dtype,
+                    )
+                    shard.requires_grad = True
+                    setattr(self, f"{name}.zero_shard", shard)
+                    self.zero_shards.append(name)
 
         @trace
         def forward(self, *args, **kwargs):
@@ -44,11 +69,25 @@ def with_data_parallel(model):
             comm = dist.get_communicator()
             record = self.model._internal(*args, **kwargs)
             mod = record.mod
+            inputs = _get_func_inputs(record, args, kwargs)
 
             # TODO: Refactor AutoDataParallel to let it work on the IR after InlineBackward
             # so that it can be applied here.
             # if dcfg.enable_data_parallel:
             #     passes.append(AutoDataParallel())
+            if self.zero_shards:
+                # Replace the full parameters with their partitions.
+                mod = InferType()(mod)
+                state = self.model.state()
+                handles = {state[name]._ndarray__handle: name for name in self.zero_shards}
+                params, sharded = [], []
+                for i, (var, handle) in enumerate(zip(mod["main"].params, inputs)):
+                    if handle in handles:
+                        params.append(var)
+                        sharded.append(i)
+                        shard = getattr(self, f"{handles[handle]}.zero_shard")
+                        inputs[i] = shard._ndarray__handle
+                mod = PartitionParameter(params, comm.size, dcfg.zero_prefetch_depth)(mod)
             if dcfg.zero_opt_level > 0:
                 passes = []
                 passes.append(InferType())
@@ -59,10 +98,16 @@ def with_data_parallel(model):
                 )
                 seq = RAFSequential(passes, name="with_data_parallel")
                 mod = seq(mod)
-            inputs = _get_func_inputs(record, args, kwargs)
             out = inline(mod["main"], inputs)
             y = out[0]
             dxs = out[1]
+            if self.zero_shards:
+                # The partitions are the first parameters of this model, so reorder the gradients
+                # (of all inputs but dy) to match the inputs of this model.
+                num_args = len(inputs) - len(record.named_params)
+                others = [i for i in range(num_args, len(inputs)) if i not in sharded]
+                order = list(range(1, num_args)) + sharded + others
+                dxs = Symbol.make_tuple([dxs[i - 1] for i in order])
             return y, dxs
 
     return DataParallelWrapper(model)
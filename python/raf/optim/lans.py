@@ -15,6 +15,7 @@ from .. import distributed as dist
 from .data_parallel import with_data_parallel
 from ..distributed.op import allgather
 from .optim import with_autodiff
+from .adam import _STATE_BLOCK_SIZE
 from .utils import has_grad, split_ndarray_with_padding
 
 
@@ -112,6 +113,7 @@ def with_lans(
     grad_averaging=True,
     mode=True,
     normalize_grad=True,
+    quantize_states=False,
 ):
     """Optimizer : LANS
     # References
@@ -133,6 +135,10 @@ def with_lans(
     weight_decay: Optional[Float]
         Weight decay (L2 penalty). Default: 0.01
 
+    quantize_states: Optional[bool]
+        Whether to store the moments in 8 bits with a scale per block of 2048 elements, which
+        are dequantized inside the fused update kernel. See with_adam. Default: False
+
     Returns
     ret : function
         The wrapper which wraps a model with LANS
@@ -163,6 +169,7 @@ def with_lans(
             # pylint: disable=attribute-defined-outside-init
             def build(self, model):
                 self.model = model
+                assert dist.get_config().zero_opt_level < 3, "LANS does not support ZeRO-3 yet"
                 self.ad_model = with_data_parallel(with_autodiff(model))
                 self.bias_correction = bias_correction
                 self.mode = mode
@@ -182,6 +189,8 @@ def with_lans(
                 dcfg = dist.get_config()
                 comm = dist.get_communicator()
                 self.params = {}
+                # The scales of the 8-bit moments of each parameter.
+                self.scales = {}
                 for name, param in self.model.state().items():
                     if param.requires_grad is True:
                         if device is None:
@@ -218,9 +227,25 @@ def with_lans(
                             setattr(self, f"{name}.lans_w", weight)
                         else:
                             weight = param
-                        npa = np.zeros(part_shape, dtype="float32")
-                        m_i = array(npa, device=device, name=f"{name}.m")
-                        v_i = array(npa, device=device, name=f"{name}.v")
+                        if quantize_states:
+                            m_i = array(
+                                np.zeros(part_shape, "int8"), device=device, name=f"{name}.m"
+                            )
+                            v_i = array(
+                                np.zeros(part_shape, "uint8"), device=device, name=f"{name}.v"
+                            )
+                            nblocks = -(-int(np.prod(part_shape)) // _STATE_BLOCK_SIZE)
+                            scales = array(
+                                np.zeros(2 * nblocks, dtype="float32"),
+                                device=device,
+                                name=f"{name}.lans_scales",
+                            )
+                            setattr(self, f"{name}.lans_scales", scales)
+                            self.scales[name] = scales
+                        else:
+                            npa = np.zeros(part_shape, dtype="float32")
+                            m_i = array(npa, device=device, name=f"{name}.m")
+                            v_i = array(npa, device=device, name=f"{name}.v")
                         setattr(self, f"{name}.m", m_i)
                         setattr(self, f"{name}.v", v_i)
                         self.params[param._ndarray__handle] = (name, param, weight, m_i, v_i)
@@ -244,6 +269,7 @@ def with_lans(
                 x_list = []
                 m_list = []
                 v_list = []
+                scales_list = []
                 ntensor = 0
                 for i, param in enumerate(inputs):
                     dxi = dxs[i] if len(inputs) > 1 else dxs
@@ -256,6 +282,8 @@ def with_lans(
                         x_list.append(w)
                         m_list.append(m)
                         v_list.append(v)
+                        if quantize_states:
+                            scales_list.append(self.scales[name])
                         ntensor += 1
 
                 if self.dtype != "float32":
@@ -264,7 +292,7 @@ def with_lans(
                     for i in range(ntensor):
                         g_list.append(fp32_g[i])
 
-                tensor_list = g_list + x_list + m_list + v_list
+                tensor_list = g_list + x_list + m_list + v_list + scales_list
                 output_list = _op.lans(
                     tensor_list,
                     next_step,
@@ -277,6 +305,7 @@ def with_lans(
                     self.grad_averaging,
                     self.mode,
                     self.normalize_grad,
+                    quantize_states,
                 )
 
                 out_idx = 0
@@ -311,6 +340,9 @@ def with_lans(
                             trace_mutate_attr(param_model, name.split(".")[-1], next_w)
                             trace_mutate_attr(self, f"{name}.m", next_m)
                             trace_mutate_attr(self, f"{name}.v", next_v)
+                            if quantize_states:
+                                next_scales = output_list[out_idx + 4 * ntensor]
+                                trace_mutate_attr(self, f"{name}.lans_scales", next_scales)
                             out_idx += 1
                 return y
 
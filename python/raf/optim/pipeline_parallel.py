@@ -0,0 +1,79 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""A pipeline parallel wrapper. Assuming the input model includes forward/backward computations,
+and outputs 1) forward result as well as 2) all calculated gradients, e.g., the model wrapped by
+with_autodiff. This wrapper partitions the model into pipeline stages over the ranks, where each
+rank runs one stage of the micro-batches in the 1F1B order, and passes the tensors crossing the
+stages with send/recv.
+
+Note that each rank only returns the gradients computed by its stage, and the others are NoGrad,
+so a wrapped optimizer only updates the parameters of this stage.
+"""
+from raf.ir import RAFSequential
+from .optim import inline
+from .. import distributed as dist
+from .._ffi.pass_ import PipelineParallel, InferType
+from ..model import Model, trace
+from ..model.trace import _get_func_inputs
+
+
+def with_pipeline_parallel(model, num_micro_batches=1):
+    """Enable pipeline parallel to the model with all ranks in the global communicator.
+
+    Parameters
+    ----------
+    model: Model
+        The model with forward, backward, and output gradients, whose first input is dy.
+
+    num_micro_batches: int
+        The number of micro-batches, which split the batch inputs along the first axis. The
+        gradients are accumulated over the micro-batches, and the forward output is the sum of
+        the micro-batch outputs if it is a scalar (e.g., the loss), or their concatenation
+        otherwise.
+
+    Returns
+    -------
+    ret: Model
+        The pipeline parallel model.
+    """
+
+    class PipelineParallelWrapper(Model):
+        """Pipeline parallel model
+
+        Parameters
+        ----------
+        model: Model
+            The model with forward, backward, and output gradients.
+        """
+
+        def build(self, model):
+            # pylint: disable=attribute-defined-outside-init, missing-function-docstring
+            self.model = model
+
+        @trace
+        def forward(self, dy, *args, **kwargs):
+            # pylint: disable=protected-access, missing-function-docstring
+            comm = dist.get_communicator()
+            record = self.model._internal(dy, *args, **kwargs)
+            mod = InferType()(record.mod)
+            func = mod["main"]
+            # The inputs other than dy and the model parameters are split into micro-batches,
+            # and so is dy if the forward output is not a scalar.
+            num_inputs = 1 + len(args) + len(kwargs)
+            batch_inputs = list(func.params[1:num_inputs])
+            if func.checked_type.ret_type.fields[0].shape:
+                batch_inputs.append(func.params[0])
+            passes = [
+                PipelineParallel(comm.size, comm.rank, num_micro_batches, batch_inputs),
+                InferType(),
+            ]
+            seq = RAFSequential(passes, name="with_pipeline_parallel")
+            mod = seq(mod)
+            inputs = _get_func_inputs(record, [dy, *args], kwargs)
+            out = inline(mod["main"], inputs)
+            y = out[0]
+            dxs = out[1]
+            return y, dxs
+
+    return PipelineParallelWrapper(model)
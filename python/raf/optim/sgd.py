@@ -10,7 +10,8 @@ from raf._core.ndarray import ndarray, array
 from raf.model import trace, Model, trace_mutate_attr
 from raf.model.trace import _get_func_inputs
 from raf._op import imp
-from raf._op.sym import multiply, add, subtract, strided_slice, cast
+from raf._op.sym import multiply, add, subtract, strided_slice, cast, sgd
+from raf._lib import tvm
 from .. import distributed as dist
 from .data_parallel import with_data_parallel
 from ..distributed.op import allgather
@@ -72,6 +73,14 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
     Returns
     ret : function
         The wrapper which wraps a model with sgd
+
+    Notes
+    -----
+    If "raf.sparse_embedding_grad" of the pass context is set when the model is traced and
+    compiled, the gradients of embedding are applied in the row-sparse form, i.e., the SGD only
+    updates the rows of the weight and the momentum that are looked up. The momentum of the
+    other rows is not decayed, so the update is the same as the dense SGD only if momentum is 0.
+    With data parallelism the rows are allgathered instead of allreducing the dense gradients.
     """
 
     def get_model_dtype(model):
@@ -118,17 +127,21 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                 dcfg = dist.get_config()
                 comm = dist.get_communicator()
                 self.params = {}
+                # The parameters partitioned at rest by ZeRO-3, whose partitions are updated.
+                self.zero_shards = set(self.ad_model.zero_shards)
                 for name, param in self.model.state().items():
                     # For each tensor "param" that requires gradient (i.e., training weights),
                     # create a tensor "param.sgd_v" to be its SGD variant.
                     if param.requires_grad:
                         assert isinstance(param, ndarray), "Only `raf.ndarray` can be optimized!"
+                        if name in self.zero_shards:
+                            param = getattr(self.ad_model, f"{name}.zero_shard")
 
                         # By default we directly use the model parameter as the SGD weight.
                         v_w = param
 
                         status_shape = param.shape
-                        if dcfg.zero_opt_level:
+                        if dcfg.zero_opt_level and name not in self.zero_shards:
                             # If optimizer status partitioning is enable, then the first axis of
                             # variant and weight is partitioned to 1/n. Accordingly, we have to
                             # also keep a param.w (size 1/n) locally.
@@ -183,6 +196,8 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                 inputs = inputs[1:]  # remove dy
                 dcfg = dist.get_config()
                 comm = dist.get_communicator()
+                config = tvm.transform.PassContext.current().config
+                sparse_grad = bool(config.get("raf.sparse_embedding_grad", False))
                 for i, param in enumerate(inputs):
                     dxi = dxs[i] if len(inputs) > 1 else dxs
                     if param in self.params and has_grad(dxi):
@@ -194,10 +209,17 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                             dxi = cast(dxi, "float32")
 
                         # Inplace update the local SGD variant and weight (float32).
-                        new_sgd_v = add(multiply(self.momentum, sgd_v), dxi, out=sgd_v)
-                        new_sgd_w = subtract(
-                            sgd_w, multiply(self.learning_rate, new_sgd_v), out=sgd_w
-                        )
+                        if sparse_grad and dcfg.zero_opt_level == 0:
+                            # The SGD op is rewritten to the row-sparse SGD if the gradient is
+                            # of embedding.
+                            new_sgd = sgd(sgd_w, dxi, sgd_v, learning_rate, momentum)
+                            new_sgd_w = new_sgd[1]
+                            trace_mutate_attr(self, f"{name}.sgd_v", new_sgd[0])
+                        else:
+                            new_sgd_v = add(multiply(self.momentum, sgd_v), dxi, out=sgd_v)
+                            new_sgd_w = subtract(
+                                sgd_w, multiply(self.learning_rate, new_sgd_v), out=sgd_w
+                            )
 
                         # Cast the updated SGD weight to the model parameter dtype.
                         if self.dtype != "float32":
@@ -205,7 +227,7 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
 
                         # If the SGD status is partitioned, use all-gather to sync
                         # the updated weights.
-                        if dcfg.zero_opt_level > 0:
+                        if dcfg.zero_opt_level > 0 and name not in self.zero_shards:
                             new_sgd_w = allgather(new_sgd_w, axis=0)
                             # Slice to remove the zero-padding if needed.
                             if sgd_w.shape[0] * comm.size > weight.shape[0]:
@@ -217,8 +239,11 @@ def with_sgd(learning_rate=0.1, momentum=0.01):
                         )
 
                         # Put the updated weight to the model output to avoid being dead code.
-                        param_model = get_chained_attr(self.model, name.split(".")[:-1])
-                        trace_mutate_attr(param_model, name.split(".")[-1], new_weight)
+                        if name in self.zero_shards:
+                            trace_mutate_attr(self.ad_model, f"{name}.zero_shard", new_weight)
+                        else:
+                            param_model = get_chained_attr(self.model, name.split(".")[:-1])
+                            trace_mutate_attr(param_model, name.split(".")[-1], new_weight)
                 return y
 
         return SGDWrapper(model)
@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Functions for the int8 post-training quantization."""
+# pylint: disable=protected-access
+import numpy as np
+
+from raf._core.executor import VMExecutor
+from raf._ffi.pass_ import InferType, QuantizeCalibrate, QuantizeRealize
+from raf._lib import tvm
+from raf.frontend.model import FrameworkModel
+from raf.model.trace import _get_func_inputs
+
+
+def calibrate(model, dataset, device="cpu", eps=1e-8):
+    """Calibrate the per-tensor scales of the operands of the quantizable ops, i.e., dense,
+    batch_matmul_nt and conv2d, by running the model in float32 on the calibration data.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model running in float32.
+
+    dataset : List[List[raf.ndarray]]
+        The inputs of the model for calibration, which should be representative of the inference
+        inputs.
+
+    device : str
+        The device to run the calibration on.
+
+    eps : float
+        The minimal absolute maximum of an operand, avoiding the zero scale of constant zeros.
+
+    Returns
+    -------
+    scales : List[float]
+        The symmetric scales of the operands, in the order expected by quantize_model.
+    """
+    record = model._internal(*dataset[0])
+    mod = QuantizeCalibrate()(InferType()(record.mod))
+    executor = VMExecutor(mod, device).make_executor()
+    amax = None
+    for args in dataset:
+        out = executor(*_get_func_inputs(record, args, {}, get_handle=False))
+        curr = [np.abs(operand.numpy()).max() for operand in out[1]]
+        amax = curr if amax is None else np.maximum(amax, curr)
+    return [float(max(x, eps)) / 127 for x in amax]
+
+
+def quantize_model(model, scales, args=None):
+    """Convert a model running in float32 to run the quantizable ops in int8.
+
+    Parameters
+    ----------
+    model : raf.model.Model
+        The model running in float32.
+
+    scales : List[float]
+        The scales of the operands from calibrate.
+
+    args : Optional[List[raf.ndarray]]
+        The input data of the model.
+
+    Returns
+    -------
+    ret : raf.frontend.FrameworkModel
+        The quantized model, whose outputs are still in float32.
+    """
+    args = args if args is not None else []
+    mod = model._internal(*args).mod
+    scales = [tvm.tir.FloatImm("float64", scale) for scale in scales]
+    mod = QuantizeRealize(scales)(InferType()(mod))
+    return FrameworkModel(mod, mod, model.state(), dict())
@@ -0,0 +1,419 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, too-many-arguments, too-many-locals, import-outside-toplevel
+"""The end-to-end benchmark suite of the models in raf.testing, which runs each on the VM with a
+fixed config, records its throughput, latency percentiles, peak memory and compile time to a JSON
+file, and compares them to a baseline to catch the performance regressions, e.g.,
+
+    python3 -m raf.testing.benchmark --output current.json --baseline baseline.json
+"""
+import argparse
+import json
+import platform
+import sys
+import time
+
+import numpy as np
+
+import raf
+from raf._core.executor import VMExecutor
+from raf.model.trace import _get_func_inputs
+from .common import randn_torch, randint
+from .._ffi import pass_
+
+# The metrics of a result, and whether a larger value is better.
+METRICS = {
+    "throughput": True,
+    "latency_mean_ms": False,
+    "latency_p50_ms": False,
+    "latency_p90_ms": False,
+    "latency_p99_ms": False,
+    "peak_memory_mb": False,
+    "compile_s": False,
+}
+
+
+class BenchmarkConfig:
+    """The fixed config of a benchmark.
+
+    Parameters
+    ----------
+    model : str
+        The model in MODELS.
+
+    batch_size : int
+        The batch size.
+
+    train : bool
+        Whether to benchmark a training step with the SGD optimizer, or the inference.
+
+    amp : bool
+        Whether to run in the automatic mixed precision.
+
+    cuda_graph : bool
+        Whether to run the VM with CUDA graph.
+
+    stream_schedule_policy : str
+        The stream schedule policy of the VM compiler, e.g., sequential, wavefront or asap.
+
+    device : str
+        The device.
+    """
+
+    def __init__(
+        self,
+        model,
+        batch_size=1,
+        train=False,
+        amp=False,
+        cuda_graph=False,
+        stream_schedule_policy="sequential",
+        device="cuda",
+    ):
+        self.model = model
+        self.batch_size = batch_size
+        self.train = train
+        self.amp = amp
+        self.cuda_graph = cuda_graph
+        self.stream_schedule_policy = stream_schedule_policy
+        self.device = device
+
+    @property
+    def name(self):
+        """The unique name of the config, which keys the baseline."""
+        name = f"{self.model}/bs{self.batch_size}/{'train' if self.train else 'infer'}"
+        if self.amp:
+            name += "/amp"
+        if self.cuda_graph:
+            name += "/cuda_graph"
+        if self.stream_schedule_policy != "sequential":
+            name += f"/{self.stream_schedule_policy}"
+        return name + f"/{self.device}"
+
+    def to_dict(self):
+        """The config in a dict."""
+        return dict(self.__dict__)
+
+
+def _train_step(model, train):
+    # The training step of a model that returns the loss.
+    return raf.optim.sgd.with_sgd(learning_rate=0.1, momentum=0.01)(model) if train else model
+
+
+def _get_resnet50(batch_size, device, train):
+    from . import resnet
+
+    model, _ = resnet.get_model([3, 4, 6, 3], train=train)
+    (args, _) = resnet.get_input(batch_size=batch_size, device=device, train=train)
+    return _train_step(model, train), list(args)
+
+
+def _get_mlp(batch_size, device, train):
+    from . import mlp
+
+    config = (784, 10, 256, 256)
+    model, _ = mlp.get_model(config, train=train)
+    (args, _) = mlp.get_input(config, batch_size=batch_size, device=device, train=train)
+    return _train_step(model, train), list(args)
+
+
+def _get_inception_v3(batch_size, device, train):
+    from . import inception
+
+    model, _ = inception.get_model()
+    ((m_x, m_y), _) = inception.get_input(batch_size=batch_size, device=device)
+    if not train:
+        model.infer_mode()
+        return model, [m_x]
+    return _train_step(model, train), [m_x, m_y]
+
+
+def _get_transformer(config, batch_size, device, train, seq_length=128):
+    from .pt_models import append_loss_n_optimizer, get_transformer_model_by_config
+
+    model, out_shape = get_transformer_model_by_config(config, batch_size, seq_length)
+    model.to(device=device)
+    m_x, _ = randint((batch_size, seq_length), high=config.vocab_size, device=device)
+    if not train:
+        model.infer_mode()
+        return model, [m_x]
+    m_y, _ = randint((batch_size * seq_length,), high=out_shape[-1], device=device)
+    return append_loss_n_optimizer(model, [m_x], out_shape, m_y), [m_x]
+
+
+def _get_bert_block(batch_size, device, train):
+    import transformers
+
+    config = transformers.BertConfig(num_hidden_layers=2)
+    config.architectures = ["BertModel"]
+    return _get_transformer(config, batch_size, device, train)
+
+
+def _get_gpt2_block(batch_size, device, train):
+    import transformers
+
+    config = transformers.GPT2Config(n_layer=2)
+    config.architectures = ["GPT2Model"]
+    return _get_transformer(config, batch_size, device, train)
+
+
+# The model builders, which take the batch size, the device and whether to train, and return the
+# model and its inputs. A training model is a step of the SGD optimizer, which takes the gradient
+# of the loss before the inputs.
+MODELS = {
+    "resnet50": _get_resnet50,
+    "mlp": _get_mlp,
+    "inception_v3": _get_inception_v3,
+    "bert_block": _get_bert_block,
+    "gpt2_block": _get_gpt2_block,
+}
+
+# The default suite, which covers the CUDA graph, the AMP and the stream schedule policies.
+DEFAULT_SUITE = [
+    BenchmarkConfig("mlp", batch_size=64),
+    BenchmarkConfig("mlp", batch_size=64, train=True),
+    BenchmarkConfig("mlp", batch_size=64, cuda_graph=True),
+    BenchmarkConfig("resnet50", batch_size=32),
+    BenchmarkConfig("resnet50", batch_size=32, amp=True),
+    BenchmarkConfig("resnet50", batch_size=32, cuda_graph=True),
+    BenchmarkConfig("resnet50", batch_size=32, stream_schedule_policy="wavefront"),
+    BenchmarkConfig("resnet50", batch_size=32, train=True),
+    BenchmarkConfig("resnet50", batch_size=32, train=True, amp=True),
+    BenchmarkConfig("inception_v3", batch_size=16, stream_schedule_policy="asap"),
+    BenchmarkConfig("inception_v3", batch_size=16, train=True),
+    BenchmarkConfig("bert_block", batch_size=8),
+    BenchmarkConfig("bert_block", batch_size=8, train=True, amp=True),
+    BenchmarkConfig("gpt2_block", batch_size=8),
+    BenchmarkConfig("gpt2_block", batch_size=8, train=True),
+]
+
+
+def _percentile(values, percent):
+    return float(np.percentile(np.array(values), percent))
+
+
+def run_benchmark(config, warmup=5, number=50):
+    """Run a benchmark.
+
+    Parameters
+    ----------
+    config : BenchmarkConfig
+        The config.
+
+    warmup : int
+        The number of the runs before the measurement, which include the JIT of the kernels.
+
+    number : int
+        The number of the measured runs, each of which synchronizes the device.
+
+    Returns
+    -------
+    ret : Dict
+        The result, with the config, the throughput in samples per second, the mean and the
+        percentiles of the latency in milliseconds, the peak memory of the device in MBs, and the
+        compile time in seconds, i.e., the VM compilation and the first run that builds the
+        kernels.
+    """
+    from raf.utils import memory_profiler
+
+    device = config.device
+    model, args = MODELS[config.model](config.batch_size, device, config.train)
+    model.to(device=device)
+    if config.train:
+        m_dy, _ = randn_torch((), device=device, requires_grad=False)
+        args = [m_dy] + args
+    if config.amp:
+        model = raf.amp.autocast(model, args)
+    record = model._internal(*args)
+    inputs = _get_func_inputs(record, args, {}, get_handle=False)
+
+    pass_config = {"raf.stream_schedule.policy": config.stream_schedule_policy}
+    start = time.perf_counter()
+    with raf.ir.PassContext(opt_level=3, config=pass_config):
+        mod = pass_.InferType()(record.mod)
+        executor = VMExecutor(mod, device, enable_cuda_graph=config.cuda_graph)
+    vm = executor.make_executor()
+
+    memory_profiler.reset()
+    memory_profiler.start()
+    dev = raf.Device(device)
+    tvm_device = raf._lib.tvm.nd.device(device)
+    vm(*inputs)
+    tvm_device.sync()
+    compile_s = time.perf_counter() - start
+    for _ in range(warmup):
+        vm(*inputs)
+    tvm_device.sync()
+    latencies = []
+    for _ in range(number):
+        start = time.perf_counter()
+        vm(*inputs)
+        tvm_device.sync()
+        latencies.append((time.perf_counter() - start) * 1e3)
+    memory_profiler.stop()
+    peak_memory_mb = float(memory_profiler.get_max_memory_info(dev)["max_used"].value)
+    mean = float(np.mean(latencies))
+    return {
+        "name": config.name,
+        "config": config.to_dict(),
+        "throughput": config.batch_size / mean * 1e3,
+        "latency_mean_ms": mean,
+        "latency_p50_ms": _percentile(latencies, 50),
+        "latency_p90_ms": _percentile(latencies, 90),
+        "latency_p99_ms": _percentile(latencies, 99),
+        "peak_memory_mb": peak_memory_mb,
+        "compile_s": compile_s,
+    }
+
+
+def compare(results, baseline, threshold=0.05, metrics=None):
+    """Compare the results to the baseline.
+
+    Parameters
+    ----------
+    results : List[Dict]
+        The results of run_suite.
+
+    baseline : Union[str, Dict, List[Dict]]
+        The baseline results, the output dict of run_suite, or its file.
+
+    threshold : float
+        The relative change of a metric in the worse direction that is a regression.
+
+    metrics : Optional[List[str]]
+        The metrics to compare. Default is all the metrics, but the compile time.
+
+    Returns
+    -------
+    ret : List[Dict]
+        A comparison of each metric of each benchmark in both, with the baseline and current
+        values, the relative change, and whether it regresses. The benchmarks that are only in
+        one of them are skipped.
+    """
+    if isinstance(baseline, str):
+        with open(baseline, "r") as in_file:
+            baseline = json.load(in_file)
+    if isinstance(baseline, dict):
+        baseline = baseline["results"]
+    metrics = metrics or [m for m in METRICS if m != "compile_s"]
+    base = {r["name"]: r for r in baseline if "error" not in r}
+    ret = []
+    for result in results:
+        if "error" in result or result["name"] not in base:
+            continue
+        for metric in metrics:
+            old, new = base[result["name"]][metric], result[metric]
+            change = (new - old) / old if old else 0.0
+            worse = -change if METRICS[metric] else change
+            ret.append(
+                {
+                    "name": result["name"],
+                    "metric": metric,
+                    "baseline": old,
+                    "current": new,
+                    "change": change,
+                    "regression": worse > threshold,
+                }
+            )
+    return ret
+
+
+def run_suite(configs=None, output=None, baseline=None, threshold=0.05, warmup=5, number=50):
+    """Run the benchmarks, write their results and compare them to the baseline.
+
+    Parameters
+    ----------
+    configs : Optional[List[BenchmarkConfig]]
+        The benchmarks. Default is DEFAULT_SUITE.
+
+    output : Optional[str]
+        The JSON file to write the results.
+
+    baseline : Optional[Union[str, Dict]]
+        The baseline to compare, e.g., the output of the last release.
+
+    threshold : float
+        The relative change that is a regression.
+
+    warmup : int
+        The number of the warmup runs of each benchmark.
+
+    number : int
+        The number of the measured runs of each benchmark.
+
+    Returns
+    -------
+    ret : Dict
+        The context of the machine, the results, where a failed benchmark has its error instead
+        of the metrics, and the comparisons if the baseline is given.
+    """
+    configs = DEFAULT_SUITE if configs is None else configs
+    results = []
+    for config in configs:
+        if config.device == "cuda" and not raf.build.with_cuda():
+            continue
+        try:
+            results.append(run_benchmark(config, warmup, number))
+        except Exception as err:  # pylint: disable=broad-except
+            results.append({"name": config.name, "config": config.to_dict(), "error": str(err)})
+    ret = {
+        "context": {
+            "raf_version": raf.__version__,
+            "git_version": raf.build.git_version(),
+            "host": platform.node(),
+            "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        },
+        "results": results,
+    }
+    if baseline is not None:
+        ret["comparisons"] = compare(results, baseline, threshold)
+    if output is not None:
+        with open(output, "w") as out_file:
+            json.dump(ret, out_file, indent=2)
+    return ret
+
+
+def report(suite):
+    """The results and the regressions of run_suite in a pretty string."""
+    lines = [
+        f"{'benchmark':<48} {'samples/s':>10} {'p50(ms)':>9} {'p99(ms)':>9} {'mem(MB)':>9} "
+        f"{'compile(s)':>10}"
+    ]
+    for r in suite["results"]:
+        if "error" in r:
+            lines.append(f"{r['name']:<48} failed: {r['error'].splitlines()[0]}")
+            continue
+        lines.append(
+            f"{r['name']:<48} {r['throughput']:>10.1f} {r['latency_p50_ms']:>9.2f} "
+            f"{r['latency_p99_ms']:>9.2f} {r['peak_memory_mb']:>9.1f} {r['compile_s']:>10.1f}"
+        )
+    regressions = [c for c in suite.get("comparisons", []) if c["regression"]]
+    if "comparisons" in suite:
+        lines.append(f"{len(regressions)} regression(s) to the baseline")
+    for c in regressions:
+        lines.append(
+            f"  {c['name']} {c['metric']}: {c['baseline']:.3f} -> {c['current']:.3f} "
+            f"({c['change'] * 100:+.1f}%)"
+        )
+    return "\n".join(lines)
+
+
+def main(argv=None):
+    """The command line, which exits with 1 if any benchmark regresses."""
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--output", help="The JSON file of the results.")
+    parser.add_argument("--baseline", help="The JSON file of the baseline results.")
+    parser.add_argument("--threshold", type=float, default=0.05)
+    parser.add_argument("--filter", default="", help="Only run the benchmarks with the substring.")
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--number", type=int, default=50)
+    opts = parser.parse_args(argv)
+    configs = [c for c in DEFAULT_SUITE if opts.filter in c.name]
+    suite = run_suite(configs, opts.output, opts.baseline, opts.threshold, opts.warmup, opts.number)
+    print(report(suite))
+    return int(any(c["regression"] for c in suite.get("comparisons", [])))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
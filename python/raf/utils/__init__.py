@@ -2,5 +2,6 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Utilities"""
+from . import metrics
 from .memory_profiler import *
 from .profiler import *
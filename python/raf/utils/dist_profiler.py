@@ -0,0 +1,270 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals
+"""The distributed profiling, which aligns the profiler traces of the ranks by a barrier-based
+clock sync over the NCCL communicator, merges them into one timeline with a process per rank, and
+reports the stragglers, i.e., the rank and the op that delay each collective."""
+import glob
+import json
+import os
+
+from raf._ffi.distributed import SyncClock
+from .trace_analysis import HOST_CATEGORIES, is_communication, load_events, normalize_op_name
+
+# The offset of the profiler clock of this rank to the one of rank 0, set by sync_clock.
+_CLOCK_OFFSET_US = None
+
+
+def sync_clock(rounds=20):
+    """Estimate the offset of the profiler clock of this rank to the one of rank 0 by the
+    barriers of the global NCCL communicator. All ranks must call it together.
+
+    Parameters
+    ----------
+    rounds : int
+        The number of the barriers, whose median offset is taken.
+
+    Returns
+    -------
+    ret : int
+        The clock of this rank minus the clock of rank 0 in microseconds.
+    """
+    # pylint: disable=global-statement, import-outside-toplevel
+    global _CLOCK_OFFSET_US
+    from raf.distributed import get_communicator
+
+    offsets = [offset.value for offset in SyncClock(rounds)]
+    _CLOCK_OFFSET_US = offsets[get_communicator().rank]
+    return _CLOCK_OFFSET_US
+
+
+def dump_rank_trace(directory, trace=None, rank=None, offset_us=None):
+    """Dump the trace of this rank with its rank and clock offset, which merge_traces reads.
+
+    Parameters
+    ----------
+    directory : str
+        The directory of the traces of all ranks, e.g., on a shared file system.
+
+    trace : Optional[Dict]
+        The trace to dump. Default is raf.utils.profiler.get().
+
+    rank : Optional[int]
+        The rank. Default is the rank of the global communicator.
+
+    offset_us : Optional[int]
+        The clock offset. Default is the one of the last sync_clock, or 0 if it is not called.
+
+    Returns
+    -------
+    ret : str
+        The path of the dumped trace.
+    """
+    # pylint: disable=import-outside-toplevel
+    if trace is None:
+        from . import profiler
+
+        trace = profiler.get()
+    if rank is None:
+        from raf.distributed import get_communicator
+
+        rank = get_communicator().rank
+    if offset_us is None:
+        offset_us = _CLOCK_OFFSET_US or 0
+    os.makedirs(directory, exist_ok=True)
+    path = os.path.join(directory, f"trace_rank{rank}.json")
+    with open(path, "w") as out_file:
+        json.dump(dict(trace, raf_rank=rank, raf_clock_offset_us=offset_us), out_file)
+    return path
+
+
+def _load_rank_traces(traces):
+    if isinstance(traces, str):
+        traces = sorted(glob.glob(os.path.join(traces, "trace_rank*.json")))
+    ret = []
+    for trace in traces:
+        if isinstance(trace, str):
+            with open(trace, "r") as in_file:
+                trace = json.load(in_file)
+        ret.append(trace)
+    return sorted(ret, key=lambda t: t["raf_rank"])
+
+
+def merge_traces(traces, filename=None):
+    """Merge the traces of the ranks into one timeline, where each rank is a process, and the
+    timestamps are shifted to the clock of rank 0.
+
+    Parameters
+    ----------
+    traces : Union[str, List[Union[str, Dict]]]
+        The directory of dump_rank_trace, or the traces or their paths.
+
+    filename : Optional[str]
+        The path to write the merged trace in the Chrome trace event format.
+
+    Returns
+    -------
+    ret : Dict
+        The merged trace.
+    """
+    events = []
+    for trace in _load_rank_traces(traces):
+        rank = trace["raf_rank"]
+        offset = trace.get("raf_clock_offset_us", 0)
+        events.append(
+            {"name": "process_name", "ph": "M", "pid": rank, "args": {"name": f"Rank {rank}"}}
+        )
+        events.append(
+            {"name": "process_sort_index", "ph": "M", "pid": rank, "args": {"sort_index": rank}}
+        )
+        for e in trace["traceEvents"]:
+            e = dict(e, pid=rank)
+            if "ts" in e:
+                e["ts"] = e["ts"] - offset
+            events.append(e)
+    merged = {"traceEvents": events, "displayTimeUnit": "ms"}
+    if filename is not None:
+        with open(filename, "w") as out_file:
+            json.dump(merged, out_file)
+    return merged
+
+
+def _device_ops(events):
+    # The op events on the device streams, without the host events and the CUPTI kernels.
+    return [
+        e for e in events if e.stream not in HOST_CATEGORIES and not e.category.startswith("CUPTI")
+    ]
+
+
+def _median(values):
+    values = sorted(values)
+    return values[len(values) // 2]
+
+
+class StragglerReport:
+    """The stragglers of the collectives of the ranks.
+
+    Attributes
+    ----------
+    collectives : List[Dict]
+        A record of each collective instance, i.e., the k-th call of a collective on every rank,
+        in the launch order. It has the collective name, the index k, the start on each rank, the
+        straggler rank that starts last, the skew between the first and last starts, the total
+        wait of the other ranks, and the delaying op, i.e., the last op of the straggler before the
+        collective, with its duration and its median duration on the other ranks.
+
+    rank_delay : Dict[int, float]
+        The total wait of the other ranks caused by each rank in microseconds.
+
+    op_delay : Dict[str, float]
+        The total wait caused by each delaying op in microseconds.
+    """
+
+    def __init__(self):
+        self.collectives = []
+        self.rank_delay = {}
+        self.op_delay = {}
+
+    def top(self, top_k=10):
+        """The collective instances of the largest total waits."""
+        return sorted(self.collectives, key=lambda c: c["wait"], reverse=True)[:top_k]
+
+    def report(self, top_k=10):
+        """The report in a pretty string."""
+        lines = ["Stragglers (us):"]
+        for rank, delay in sorted(self.rank_delay.items(), key=lambda x: x[1], reverse=True):
+            lines.append(f"  rank {rank}: caused {delay:.1f} of waiting")
+        lines.append("Delaying ops (us):")
+        for name, delay in sorted(self.op_delay.items(), key=lambda x: x[1], reverse=True)[:top_k]:
+            lines.append(f"  {name}: caused {delay:.1f} of waiting")
+        lines.append("Worst collectives:")
+        for c in self.top(top_k):
+            op = c["delaying_op"] or "<none>"
+            lines.append(
+                f"  {c['collective']}#{c['index']}: rank {c['straggler']} late by "
+                f"{c['skew']:.1f}, after {op} ({c['delaying_op_us']:.1f} vs. median "
+                f"{c['delaying_op_median_us']:.1f})"
+            )
+        return "\n".join(lines)
+
+
+def straggler_report(traces):
+    """Find the stragglers of the collectives from the traces of the ranks. The k-th call of a
+    collective on a rank is matched to the k-th call of it on the others, and the rank that starts
+    it last delays all the others, which wait in the collective until it arrives.
+
+    Parameters
+    ----------
+    traces : Union[str, Dict, List[Union[str, Dict]]]
+        The merged trace of merge_traces, the directory of dump_rank_trace, or the traces of the
+        ranks or their paths.
+
+    Returns
+    -------
+    ret : StragglerReport
+        The report.
+    """
+    merged = traces if isinstance(traces, dict) else merge_traces(traces)
+    per_rank = {}
+    for e in merged["traceEvents"]:
+        if e.get("ph") != "M":
+            per_rank.setdefault(e["pid"], []).append(e)
+    ops = {rank: _device_ops(load_events(events)) for rank, events in per_rank.items()}
+
+    def keys_of(events):
+        # The key of the k-th call of an op is its name without the dialect and the unique suffix,
+        # and k.
+        keys = []
+        counts = {}
+        for e in events:
+            name = normalize_op_name(e.name)
+            keys.append((name, counts.get(name, 0)))
+            counts[name] = keys[-1][1] + 1
+        return keys
+
+    keys = {rank: keys_of(events) for rank, events in ops.items()}
+    indices = {rank: {key: i for i, key in enumerate(keys[rank])} for rank in ops}
+    ranks = sorted(ops)
+    ret = StragglerReport()
+    if not ranks:
+        return ret
+    for key, i in sorted(indices[ranks[0]].items(), key=lambda x: x[1]):
+        if not is_communication(ops[ranks[0]][i]) or any(key not in indices[r] for r in ranks):
+            continue
+        starts = {r: ops[r][indices[r][key]].start for r in ranks}
+        straggler = max(ranks, key=lambda r: starts[r])
+        wait = sum(starts[straggler] - start for start in starts.values())
+        record = {
+            "collective": key[0],
+            "index": key[1],
+            "starts": starts,
+            "straggler": straggler,
+            "skew": starts[straggler] - min(starts.values()),
+            "wait": wait,
+            "delaying_op": None,
+            "delaying_op_us": 0.0,
+            "delaying_op_median_us": 0.0,
+        }
+        # The last op of the straggler that ends before the collective starts.
+        straggler_ops = ops[straggler]
+        prev = [
+            j
+            for j in range(indices[straggler][key])
+            if not is_communication(straggler_ops[j]) and straggler_ops[j].end <= starts[straggler]
+        ]
+        if prev:
+            j = max(prev, key=lambda j: straggler_ops[j].end)
+            op, op_key = straggler_ops[j], keys[straggler][j]
+            others = [
+                ops[r][indices[r][op_key]].duration
+                for r in ranks
+                if r != straggler and op_key in indices[r]
+            ]
+            record["delaying_op"] = op_key[0]
+            record["delaying_op_us"] = op.duration
+            record["delaying_op_median_us"] = _median(others) if others else op.duration
+            ret.op_delay[op_key[0]] = ret.op_delay.get(op_key[0], 0.0) + wait
+        ret.rank_delay[straggler] = ret.rank_delay.get(straggler, 0.0) + wait
+        ret.collectives.append(record)
+    return ret
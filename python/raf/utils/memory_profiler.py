@@ -2,9 +2,16 @@
 # SPDX-License-Identifier: Apache-2.0
 
 """Memory Profiler."""
+import difflib
+import json
+import os
 
 from raf._ffi.memory_profiler import EnableMemoryProfiler, DisableMemoryeProfiler
 from raf._ffi.memory_profiler import ResetMemoryProfiler, GetMaxMemoryInfo, GetMemoryTrace
+from raf._ffi.memory_profiler import GetTensorTimeline, GetOpMemorySteps
+from .trace_analysis import normalize_op_name
+
+_MB = 1048576.0
 
 
 def start():
@@ -53,3 +60,224 @@ def get_memory_trace(device):
         The complete trace in a string.
     """
     return GetMemoryTrace(device)
+
+
+def get_tensor_timeline(device=None):
+    """Get the lifetimes of the storages allocated by the VM while profiling.
+
+    Parameters
+    ----------
+    device: Optional[Union[str, Device]]
+        The device to get, or None for all devices.
+
+    Returns
+    -------
+    ret: List[Dict[str, Any]]
+        The lifetimes in the allocation order. Each has the device, the nbytes, the alloc_us and
+        the free_us (0 if it is alive) in the profiler clock, the func_index, the pc and the
+        register of the allocation, the IR var of the storage and the tensors placed in it,
+        and the op that first writes it.
+    """
+    device = None if device is None else str(device)
+    ret = []
+    for entry in GetTensorTimeline():
+        lifetime = {
+            "device": str(entry["device"]),
+            "nbytes": entry["nbytes"].value,
+            "alloc_us": entry["alloc_us"].value,
+            "free_us": entry["free_us"].value,
+            "func_index": entry["func_index"].value,
+            "pc": entry["pc"].value,
+            "register": entry["register"].value,
+            "var": str(entry["var"]),
+            "tensors": [str(t) for t in entry["tensors"]],
+            "op": str(entry["op"]),
+        }
+        if device is None or lifetime["device"] == device:
+            ret.append(lifetime)
+    return ret
+
+
+def get_op_memory_steps(device=None):
+    """Get the live bytes of the VM storages after each launched op.
+
+    Parameters
+    ----------
+    device: Optional[Union[str, Device]]
+        The device to get, or None for all devices.
+
+    Returns
+    -------
+    ret: List[Dict[str, Any]]
+        The steps in the launch order, each of which has the device, the time_us, the op and the
+        live_bytes.
+    """
+    device = None if device is None else str(device)
+    ret = []
+    for entry in GetOpMemorySteps():
+        step = {
+            "device": str(entry["device"]),
+            "time_us": entry["time_us"].value,
+            "op": str(entry["op"]),
+            "live_bytes": entry["live_bytes"].value,
+        }
+        if device is None or step["device"] == device:
+            ret.append(step)
+    return ret
+
+
+def live_tensors(timeline, time_us):
+    """Get the storages alive at the time, from the largest.
+
+    Parameters
+    ----------
+    timeline: List[Dict[str, Any]]
+        The lifetimes from get_tensor_timeline.
+
+    time_us: int
+        The time in the profiler clock, e.g., the time_us of an op step.
+
+    Returns
+    -------
+    ret: List[Dict[str, Any]]
+        The live lifetimes sorted by nbytes in the descending order.
+    """
+    alive = [
+        t
+        for t in timeline
+        if t["alloc_us"] <= time_us and (t["free_us"] == 0 or t["free_us"] > time_us)
+    ]
+    return sorted(alive, key=lambda t: t["nbytes"], reverse=True)
+
+
+def tensor_timeline_trace_events(timeline=None, steps=None):
+    """Convert the tensor timeline to the Chrome trace events, which can be merged with the events
+    of the profiler, e.g., raf.utils.profiler.get()["traceEvents"], to see the lifetimes against
+    the ops.
+
+    Parameters
+    ----------
+    timeline: Optional[List[Dict[str, Any]]]
+        The lifetimes from get_tensor_timeline. Default is all the recorded lifetimes.
+
+    steps: Optional[List[Dict[str, Any]]]
+        The op steps from get_op_memory_steps. Default is all the recorded steps.
+
+    Returns
+    -------
+    ret: List[Dict[str, Any]]
+        An async event of each lifetime on the "Memory <device>" track, whose name is the IR var
+        of its first tensor, and a counter of the live MBs of each device at each op.
+    """
+    timeline = get_tensor_timeline() if timeline is None else timeline
+    steps = get_op_memory_steps() if steps is None else steps
+    pid = os.getpid()
+    end_us = max([t["free_us"] for t in timeline] + [s["time_us"] for s in steps] + [0])
+    events = []
+    for idx, lifetime in enumerate(timeline):
+        name = lifetime["tensors"][0] if lifetime["tensors"] else lifetime["var"]
+        common = {
+            "name": name,
+            "cat": "Memory " + lifetime["device"],
+            "id": idx,
+            "pid": pid,
+            "tid": "Memory " + lifetime["device"],
+        }
+        args = {
+            "MB": lifetime["nbytes"] / _MB,
+            "op": lifetime["op"],
+            "storage": lifetime["var"],
+            "tensors": lifetime["tensors"],
+            "func_index": lifetime["func_index"],
+            "pc": lifetime["pc"],
+            "register": lifetime["register"],
+        }
+        events.append(dict(common, ph="b", ts=lifetime["alloc_us"], args=args))
+        events.append(dict(common, ph="e", ts=lifetime["free_us"] or end_us))
+    for step in steps:
+        events.append(
+            {
+                "name": "Live MB " + step["device"],
+                "ph": "C",
+                "ts": step["time_us"],
+                "pid": pid,
+                "args": {"MB": step["live_bytes"] / _MB},
+            }
+        )
+    return events
+
+
+def dump_tensor_timeline(filename="memory_trace.json", trace=None):
+    """Dump the tensor timeline in the Chrome trace event format, which can be loaded by
+    chrome://tracing or Perfetto.
+
+    Parameters
+    ----------
+    filename: str
+        The location to store the trace.
+
+    trace: Optional[Dict[str, Any]]
+        The trace of the profiler to merge with, e.g., raf.utils.profiler.get(), so the lifetimes
+        are shown against the ops.
+    """
+    events = list(trace["traceEvents"]) if trace is not None else []
+    events += tensor_timeline_trace_events()
+    with open(filename, "w") as f:  # pylint: disable=invalid-name
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+
+
+def diff_with_estimate(estimate, device=None, top_k=3):
+    """Compare the measured live memory after each op with the prediction of EstimateMemory.
+
+    Parameters
+    ----------
+    estimate: List[Tuple[str, float]]
+        The estimated memory trace of (op name, MBs) from EstimateMemory, e.g., by
+        raf.model.trace_memory. Set include_param to False to match the VM storages, which do not
+        include the inputs.
+
+    device: Optional[Union[str, Device]]
+        The device of the profiled run. Default is all devices.
+
+    top_k: int
+        The number of the largest live tensors listed at each op.
+
+    Returns
+    -------
+    ret: List[Dict[str, Any]]
+        A row of each op matched by name in order, with the op, the measured_mb, the estimated_mb,
+        the diff_mb (measured minus estimated) and the largest live tensors. The row of an op in
+        one trace only has None for the other.
+    """
+    timeline = get_tensor_timeline(device)
+    steps = get_op_memory_steps(device)
+    est_names = [normalize_op_name(name) for name, _ in estimate]
+    meas_names = [normalize_op_name(s["op"]) for s in steps]
+
+    def _row(step, est):
+        measured = step["live_bytes"] / _MB if step is not None else None
+        estimated = est[1] if est is not None else None
+        diff = measured - estimated if step is not None and est is not None else None
+        tensors = []
+        if step is not None:
+            for t in live_tensors(timeline, step["time_us"])[:top_k]:
+                name = t["tensors"][0] if t["tensors"] else t["var"]
+                tensors.append((name, t["op"], t["nbytes"] / _MB))
+        return {
+            "op": step["op"] if step is not None else est[0],
+            "measured_mb": measured,
+            "estimated_mb": estimated,
+            "diff_mb": diff,
+            "live_tensors": tensors,
+        }
+
+    rows = []
+    matcher = difflib.SequenceMatcher(None, meas_names, est_names, autojunk=False)
+    for tag, i_1, i_2, j_1, j_2 in matcher.get_opcodes():
+        if tag == "equal":
+            for i, j in zip(range(i_1, i_2), range(j_1, j_2)):
+                rows.append(_row(steps[i], estimate[j]))
+        else:
+            rows += [_row(steps[i], None) for i in range(i_1, i_2)]
+            rows += [_row(None, estimate[j]) for j in range(j_1, j_2)]
+    return rows
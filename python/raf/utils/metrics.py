@@ -0,0 +1,61 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The always-on metrics, e.g., the VM run time, the op launches, the memory allocated, the cache
+hit ratios and the communicated bytes."""
+from raf._ffi.metrics import GetMetrics, ExportPrometheus, Reset
+from raf._ffi.metrics import AddStepCallback, ClearStepCallbacks
+
+
+def get():
+    """Get the current values of the metrics.
+
+    Returns
+    -------
+    ret : Dict[str, float]
+        The values keyed by the series in the Prometheus format,
+        e.g., raf_comm_bytes_total{collective="allreduce"}.
+    """
+    return {str(k): float(v.value) for k, v in GetMetrics().items()}
+
+
+def dump_prometheus(filename=None):
+    """Export the metrics in the Prometheus text exposition format, which can be served to the
+    Prometheus server, or written to the textfile collector of the node exporter.
+
+    Parameters
+    ----------
+    filename : Optional[str]
+        The file to write the metrics. If None, the metrics are only returned.
+
+    Returns
+    -------
+    ret : str
+        The metrics in the Prometheus text format.
+    """
+    text = ExportPrometheus()
+    if filename is not None:
+        with open(filename, "w") as out_file:
+            out_file.write(text)
+    return text
+
+
+def reset():
+    """Reset the counters and the summaries to 0. The cache statistics are not reset."""
+    Reset()
+
+
+def register_callback(callback):
+    """Register a callback that is called with the metrics at the end of every VM run.
+
+    Parameters
+    ----------
+    callback : Callable[[Dict[str, float]], None]
+        The callback, which receives the result of get().
+    """
+    AddStepCallback(lambda: callback(get()))
+
+
+def clear_callbacks():
+    """Remove all the registered callbacks."""
+    ClearStepCallbacks()
@@ -0,0 +1,134 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The profiler of the compilation, which records the time, the IR size and the host memory of
+each pass, nested by the sequential passes, and reports them in a table or a trace."""
+import json
+
+from raf._ffi.pass_profiler import EnablePassProfiler, DisablePassProfiler
+from raf._ffi.pass_profiler import ResetPassProfiler, GetPassProfile
+
+
+def start():
+    """Start to record the passes."""
+    EnablePassProfiler()
+
+
+def stop():
+    """Stop to record the passes."""
+    DisablePassProfiler()
+
+
+def reset():
+    """Clear the records."""
+    ResetPassProfiler()
+
+
+def get():
+    """Get the records in the order they start.
+
+    Returns
+    -------
+    ret : List[Dict]
+        A record of each pass run, with its name, its depth of nesting, its start and end in
+        microseconds, its self time in microseconds excluding the nested records, the number of
+        the IR nodes before and after it (-1 if unknown), and the resident memory of the process
+        in KBs before and after it.
+    """
+    records = []
+    for entry in GetPassProfile():
+        record = {key: entry[key].value for key in entry if key != "name"}
+        record["name"] = str(entry["name"])
+        record["self_us"] = record["end_us"] - record["start_us"]
+        records.append(record)
+    # The self time of a record excludes its direct children, i.e., the next deeper records
+    # until the record ends.
+    stack = []
+    for record in records:
+        while stack and stack[-1]["depth"] >= record["depth"]:
+            stack.pop()
+        if stack and stack[-1]["depth"] == record["depth"] - 1:
+            stack[-1]["self_us"] -= record["end_us"] - record["start_us"]
+        stack.append(record)
+    return records
+
+
+def report(records=None, top=None):
+    """The total time, IR size change and memory change of each pass in a table, sorted by the
+    self time.
+
+    Parameters
+    ----------
+    records : Optional[List[Dict]]
+        The records. Default is get().
+
+    top : Optional[int]
+        The number of the passes to show. Default is all.
+
+    Returns
+    -------
+    ret : str
+        The table.
+    """
+    records = get() if records is None else records
+    summary = {}
+    for record in records:
+        item = summary.setdefault(
+            record["name"], {"count": 0, "total_us": 0, "self_us": 0, "nodes": 0, "rss_kb": 0}
+        )
+        item["count"] += 1
+        item["total_us"] += record["end_us"] - record["start_us"]
+        item["self_us"] += record["self_us"]
+        if record["nodes_before"] >= 0 and record["nodes_after"] >= 0:
+            item["nodes"] += record["nodes_after"] - record["nodes_before"]
+        item["rss_kb"] += record["rss_after_kb"] - record["rss_before_kb"]
+    items = sorted(summary.items(), key=lambda x: x[1]["self_us"], reverse=True)
+    if top is not None:
+        items = items[:top]
+    width = max([len("Pass")] + [len(name) for name, _ in items])
+    lines = [
+        f"{'Pass':<{width}}  {'Count':>5}  {'Total(ms)':>10}  {'Self(ms)':>10}  "
+        f"{'dNodes':>8}  {'dRSS(MB)':>9}"
+    ]
+    for name, item in items:
+        lines.append(
+            f"{name:<{width}}  {item['count']:>5}  {item['total_us'] / 1e3:>10.3f}  "
+            f"{item['self_us'] / 1e3:>10.3f}  {item['nodes']:>8}  {item['rss_kb'] / 1024:>9.2f}"
+        )
+    return "\n".join(lines)
+
+
+def dump_trace(filename="pass_profile.json", records=None):
+    """Dump the records in the Chrome trace event format, where the nested passes are nested
+    slices.
+
+    Parameters
+    ----------
+    filename : str
+        The path of the trace.
+
+    records : Optional[List[Dict]]
+        The records. Default is get().
+    """
+    records = get() if records is None else records
+    events = []
+    for record in records:
+        events.append(
+            {
+                "name": record["name"],
+                "cat": "Pass",
+                "ph": "X",
+                "ts": record["start_us"],
+                "dur": record["end_us"] - record["start_us"],
+                "pid": 0,
+                "tid": 0,
+                "args": {
+                    "nodes_before": record["nodes_before"],
+                    "nodes_after": record["nodes_after"],
+                    "rss_before_kb": record["rss_before_kb"],
+                    "rss_after_kb": record["rss_after_kb"],
+                },
+            }
+        )
+    with open(filename, "w") as out_file:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, out_file)
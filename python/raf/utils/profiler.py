@@ -6,23 +6,37 @@ import json
 from raf import build
 from raf._ffi.profiler import EnableProfiler, DisableProfiler
 from raf._ffi.profiler import CollectBaseProfile, CollectCudaProfile, GetProfile
-from raf._ffi.profiler import ClearProfile, ClearCudaProfile
+from raf._ffi.profiler import ClearProfile, ClearCudaProfile, DumpTrace
+from raf._ffi.profiler import EnableCuptiProfiler, DisableCuptiProfiler
+from raf._ffi.profiler import CollectCuptiProfile, ClearCuptiProfile
 
 
-def start(prof_level=1):
+def start(prof_level=1, cupti=False):
     """Enable the profiler in backend and start to profile the execution from now.
 
     Parameters
     ----------
     prof_level : int
         Specify the profiling level.
+
+    cupti : bool
+        Whether to also record every kernel, memcpy and memset on the device with CUPTI, including
+        the ones launched inside cuDNN, cuBLAS and NCCL. The device activities are on the tracks of
+        their streams, and their args have the op name and the pc of the VM instruction that
+        launches them. The host dispatch of each instruction is in the "HostDispatch" category.
+        Requires RAF built with CUPTI.
     """
     EnableProfiler(prof_level)
+    if cupti:
+        assert build.with_cupti(), "RAF is not built with CUPTI"
+        EnableCuptiProfiler()
 
 
 def stop():
     """Disable the profiler in backend and stop to profile the execution from now."""
     DisableProfiler()
+    if build.with_cupti():
+        DisableCuptiProfiler()
 
 
 def clear():
@@ -30,6 +44,16 @@ def clear():
     ClearProfile()
     if build.with_cuda():
         ClearCudaProfile()
+    if build.with_cupti():
+        ClearCuptiProfile()
+
+
+def _collect():
+    CollectBaseProfile()
+    if build.with_cuda():
+        CollectCudaProfile()
+    if build.with_cupti():
+        CollectCuptiProfile()
 
 
 def dump(filename="profile.json"):
@@ -52,12 +76,24 @@ def get():
     ----------
         The profiling results in json format.
     """
-    CollectBaseProfile()
-    if build.with_cuda():
-        CollectCudaProfile()
+    _collect()
     return json.loads(GetProfile())
 
 
+def dump_trace(filename="trace.json"):
+    """Dump the profiling results to `filename` in the Chrome trace event format, which can be
+    loaded by chrome://tracing or Perfetto. Unlike `dump`, each event is a complete event on the
+    track of the thread that records it.
+
+    Parameters
+    ----------
+    filename : str
+        The location to store the trace. Default location is "trace.json" in the current folder.
+    """
+    _collect()
+    DumpTrace(filename)
+
+
 def get_duration(data, event, category=None):
     """
     Get the duration of given event on given category in milliseconds.
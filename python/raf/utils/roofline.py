@@ -0,0 +1,104 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""The roofline report of the ops of a module, which ranks the ops by their gaps to the roofline of
+the device, so the kernel work (fusion, tuning) can focus on the ops that lose the most time."""
+from raf._core.device import Device
+from raf._ffi.op_profiler import RooflineReport, GetDevicePeak, SetDevicePeak
+
+
+def set_device_peak(device, gflops, gbps):
+    """Override the roofline of the device, which is detected from the device by default, or set by
+    the environment variables RAF_PEAK_GFLOPS and RAF_PEAK_GBPS.
+
+    Parameters
+    ----------
+    device : Union[str, Device]
+        The device.
+
+    gflops : float
+        The peak compute in GFLOP/s.
+
+    gbps : float
+        The peak memory bandwidth in GB/s.
+    """
+    SetDevicePeak(Device(device) if isinstance(device, str) else device, gflops, gbps)
+
+
+def profile(mod, device, warmup=10, number=10, repeat=1):
+    """Profile every call in the main function of the module, and place it on the roofline.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module, whose calls are JITed and run on dummy inputs.
+
+    device : Union[str, Device]
+        The device.
+
+    warmup : int
+        The number of the warmup iterations of each op.
+
+    number : int
+        The number of the iterations of each op.
+
+    repeat : int
+        The number of the repeats of each op.
+
+    Returns
+    -------
+    ret : List[Dict[str, Union[str, float]]]
+        The roofline of each op in the descending order of the gap, i.e., the profiled latency
+        minus the roofline latency in microseconds. The bound of each op is either "compute" or
+        "memory".
+    """
+    device = Device(device) if isinstance(device, str) else device
+    ret = []
+    for entry in RooflineReport(mod, device, warmup, number, repeat):
+        item = {}
+        for key, value in entry.items():
+            item[str(key)] = str(value) if key in ("name", "op", "bound") else float(value.value)
+        item["gap"] = max(0.0, item["latency"] - item["roofline_latency"])
+        ret.append(item)
+    ret.sort(key=lambda item: -item["gap"])
+    return ret
+
+
+def report(mod, device, top=None, **kwargs):
+    """The roofline report of the module in text. See profile for the arguments.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module.
+
+    device : Union[str, Device]
+        The device.
+
+    top : Optional[int]
+        The number of the ops with the largest gaps to report, or all if None.
+
+    Returns
+    -------
+    ret : str
+        The report.
+    """
+    device = Device(device) if isinstance(device, str) else device
+    entries = profile(mod, device, **kwargs)
+    gflops, gbps = [float(x.value) for x in GetDevicePeak(device)]
+    total = sum(item["latency"] for item in entries)
+    gap = sum(item["gap"] for item in entries)
+    lines = [
+        f"Roofline of {device}: {gflops:.1f} GFLOP/s, {gbps:.1f} GB/s",
+        f"Total: {total:.2f} us, {gap:.2f} us over the roofline",
+        f"{'name':<24}{'op':<32}{'bound':<9}{'us':>10}{'roof us':>10}{'GFLOP/s':>10}"
+        f"{'GB/s':>9}{'eff':>7}",
+    ]
+    for item in entries[:top]:
+        lines.append(
+            f"{item['name'][:23]:<24}{item['op'][:31]:<32}{item['bound']:<9}"
+            f"{item['latency']:>10.2f}{item['roofline_latency']:>10.2f}"
+            f"{item['achieved_gflops']:>10.2f}{item['achieved_gbps']:>9.2f}"
+            f"{item['efficiency'] * 100:>6.1f}%"
+        )
+    return "\n".join(lines)
@@ -0,0 +1,468 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals, too-many-branches, too-few-public-methods
+"""The critical-path and idle-time analysis of the profiler traces, which tells which part of the
+execution bounds the latency, e.g., the host launches, the exposed communication or the serialized
+ops, and whether a multi-stream schedule (raf.stream_schedule.policy) is worth its compile time."""
+import json
+import os
+import re
+
+from raf._ffi.analysis import GetDependencyGraphNodesEdges
+
+# The categories of the host-side events, which are not on the device streams.
+HOST_CATEGORIES = {"VMInstruction", "HostDispatch"}
+
+# The dialects in the op env names, e.g., raf_op_cublas_matmul.
+_DIALECTS = ("tvm", "cublas", "cudnn", "cutlass", "nccl", "cuda", "cblas")
+
+
+class TraceEvent:
+    """A duration event of the trace on a device stream or the host.
+
+    Parameters
+    ----------
+    name : str
+        The name of the event, e.g., the op env name.
+
+    category : str
+        The category of the event, e.g., the stream name.
+
+    stream : str
+        The stream that runs the event, or the category of a host event.
+
+    start : float
+        The start timestamp in microseconds.
+
+    end : float
+        The end timestamp in microseconds.
+
+    args : str
+        The arguments of the event, e.g., the op env cache key.
+    """
+
+    __slots__ = ["name", "category", "stream", "start", "end", "args"]
+
+    def __init__(self, name, category, stream, start, end, args=""):
+        self.name = name
+        self.category = category
+        self.stream = stream
+        self.start = start
+        self.end = end
+        self.args = args
+
+    @property
+    def duration(self):
+        """The duration in microseconds."""
+        return self.end - self.start
+
+    def __repr__(self):
+        return f"TraceEvent({self.name}, {self.stream}, {self.start}, {self.end})"
+
+
+def load_events(trace):
+    """Load the duration events of a trace, which is either the B/E pairs of
+    raf.utils.profiler.get() or the complete events of raf.utils.profiler.dump_trace().
+
+    Parameters
+    ----------
+    trace : Union[Dict, str]
+        The trace, its JSON string or the path of its JSON file.
+
+    Returns
+    -------
+    ret : List[TraceEvent]
+        The events sorted by their start timestamps.
+    """
+    if isinstance(trace, str):
+        if os.path.exists(trace):
+            with open(trace, "r") as in_file:
+                trace = json.load(in_file)
+        else:
+            trace = json.loads(trace)
+    raw = trace["traceEvents"] if isinstance(trace, dict) else trace
+    tracks = {}
+    for e in raw:
+        if e.get("ph") == "M" and e.get("name") == "thread_name":
+            tracks[(e.get("pid"), e.get("tid"))] = e["args"]["name"]
+
+    def make(e, start, end):
+        category = e.get("cat", "")
+        args = e.get("args", {}).get("args_string", "")
+        # The CUPTI activities are on the tracks of their device streams.
+        stream = category
+        if category.startswith("CUPTI"):
+            stream = tracks.get((e.get("pid"), e.get("tid")), category)
+        return TraceEvent(e["name"], category, stream, float(start), float(end), args)
+
+    events = []
+    begins = {}
+    for e in raw:
+        phase = e.get("ph")
+        if phase == "X":
+            events.append(make(e, e["ts"], e["ts"] + e.get("dur", 0)))
+        elif phase in ("B", "E"):
+            key = (e.get("pid"), e.get("tid"), e["name"], e.get("cat", ""))
+            if phase == "B":
+                begins.setdefault(key, []).append(e)
+            elif begins.get(key):
+                begin = begins[key].pop()
+                events.append(make(begin, begin["ts"], e["ts"]))
+    events.sort(key=lambda e: e.start)
+    return events
+
+
+def normalize_op_name(name):
+    """The op of an op env name, e.g., matmul of raf_op_cublas_matmul_2.
+
+    Parameters
+    ----------
+    name : str
+        The op env name, or the op name such as raf.op.matmul.
+
+    Returns
+    -------
+    ret : str
+        The op name without the prefix, the dialect and the unique suffix.
+    """
+    name = name.replace(".", "_")
+    name = re.sub(r"_\d+$", "", name)
+    if name.startswith("raf_op_"):
+        name = name[len("raf_op_") :]
+        for dialect in _DIALECTS:
+            if name.startswith(dialect + "_"):
+                name = name[len(dialect) + 1 :]
+                break
+    return name
+
+
+def dependencies_from_expr(expr, events):
+    """Match the events of the ops to the calls of an expression, and get their data dependencies
+    from raf.analysis.GetDependencyGraphNodesEdges. The i-th call of an op in the topological order
+    of the dependency graph is matched to the i-th event of the op in the trace, so the trace must
+    have a single execution of the expression, and the ops must not be renamed after the
+    expression, e.g., by the fusion.
+
+    Parameters
+    ----------
+    expr : raf.ir.Expr
+        The expression, e.g., the body of the main function in the graph normal form.
+
+    events : List[TraceEvent]
+        The device events, sorted by their start timestamps.
+
+    Returns
+    -------
+    ret : Dict[int, Set[int]]
+        The indices of the events that each event depends on.
+    """
+    graph = GetDependencyGraphNodesEdges(expr, True, False)
+    nodes = list(graph["nodes"])
+    node_index = {node: i for i, node in enumerate(nodes)}
+    # The events of each op in the order they run.
+    by_op = {}
+    for i, e in enumerate(events):
+        by_op.setdefault(normalize_op_name(e.name), []).append(i)
+    matched = {}
+    seen = {}
+    for i, node in enumerate(nodes):
+        op = getattr(node, "op", None)
+        op_name = getattr(op, "name", None)
+        if op_name is None:
+            continue
+        key = normalize_op_name(op_name)
+        count = seen.get(key, 0)
+        seen[key] = count + 1
+        if count < len(by_op.get(key, [])):
+            matched[i] = by_op[key][count]
+    # The tuples and the unmatched calls pass their dependencies through.
+    inputs = {i: set() for i in range(len(nodes))}
+    for user, arg in graph["edges"]:
+        inputs[node_index[user]].add(node_index[arg])
+    resolved = {}
+
+    def event_inputs(i):
+        if i not in resolved:
+            resolved[i] = set()
+            for j in inputs[i]:
+                resolved[i] |= {matched[j]} if j in matched else event_inputs(j)
+        return resolved[i]
+
+    deps = {}
+    for i, event in matched.items():
+        deps[event] = event_inputs(i)
+    return deps
+
+
+def _union(intervals):
+    merged = []
+    for start, end in sorted(intervals):
+        if merged and start <= merged[-1][1]:
+            merged[-1][1] = max(merged[-1][1], end)
+        else:
+            merged.append([start, end])
+    return merged
+
+
+def _length(intervals):
+    return sum(end - start for start, end in intervals)
+
+
+def _subtract(intervals, others):
+    """The parts of the merged intervals that are not covered by the merged others."""
+    ret = []
+    j = 0
+    for start, end in intervals:
+        while j < len(others) and others[j][1] <= start:
+            j += 1
+        k = j
+        while k < len(others) and others[k][0] < end:
+            if others[k][0] > start:
+                ret.append([start, others[k][0]])
+            start = max(start, others[k][1])
+            k += 1
+        if start < end:
+            ret.append([start, end])
+    return ret
+
+
+def is_communication(event):
+    """Whether an event is a communication, i.e., an NCCL op or kernel."""
+    return "nccl" in event.name.lower()
+
+
+class TraceAnalysis:
+    """The result of analyze.
+
+    Attributes
+    ----------
+    makespan : float
+        The microseconds from the start of the first device event to the end of the last one.
+
+    critical_path : List[TraceEvent]
+        The chain of the events that ends the last, where each event waits for the latest of its
+        dependencies and its predecessor on the same stream.
+
+    critical_path_wait : float
+        The microseconds that the critical path waits between its events, i.e., the host launches.
+
+    dependency_bound : float
+        The longest chain of the durations by the data dependencies, which is the latency of an
+        ideal schedule on unlimited streams. It is the busiest stream if there is no dependency.
+
+    streams : Dict[str, Dict[str, float]]
+        The busy microseconds and the utilization of each stream.
+
+    communication : float
+        The microseconds of the communication.
+
+    exposed_communication : float
+        The microseconds of the communication that no computation overlaps.
+
+    host_gaps : List[Tuple[float, float, str]]
+        The intervals where no stream is busy, and the event after each of them, in descending
+        order of their lengths.
+
+    host_bound : float
+        The total microseconds of the host gaps.
+
+    multi_stream_gain : float
+        The microseconds that a multi-stream schedule may save, i.e., the busy time of the
+        computation minus the dependency bound.
+
+    schedule_policy : str
+        The recommended raf.stream_schedule.policy.
+
+    opportunities : List[Tuple[float, str]]
+        The estimated saving in microseconds and the description of the top opportunities.
+    """
+
+    def __init__(self):
+        self.makespan = 0.0
+        self.critical_path = []
+        self.critical_path_wait = 0.0
+        self.dependency_bound = 0.0
+        self.streams = {}
+        self.communication = 0.0
+        self.exposed_communication = 0.0
+        self.host_gaps = []
+        self.host_bound = 0.0
+        self.multi_stream_gain = 0.0
+        self.schedule_policy = "sequential"
+        self.opportunities = []
+
+    def report(self):
+        """The analysis in text."""
+        lines = [f"Makespan: {self.makespan / 1e3:.3f} ms"]
+        lines.append(
+            f"Critical path: {len(self.critical_path)} events, "
+            f"{self.critical_path_wait / 1e3:.3f} ms waiting between them"
+        )
+        lines.append(f"Dependency bound: {self.dependency_bound / 1e3:.3f} ms")
+        for stream, stat in sorted(self.streams.items()):
+            lines.append(
+                f"  {stream}: busy {stat['busy'] / 1e3:.3f} ms, "
+                f"utilization {stat['utilization'] * 100:.1f}%"
+            )
+        lines.append(
+            f"Communication: {self.communication / 1e3:.3f} ms, "
+            f"exposed {self.exposed_communication / 1e3:.3f} ms"
+        )
+        lines.append(
+            f"Host-bound gaps: {self.host_bound / 1e3:.3f} ms in {len(self.host_gaps)} gaps"
+        )
+        lines.append(f"Recommended raf.stream_schedule.policy: {self.schedule_policy}")
+        lines.append("Top opportunities:")
+        for saving, desc in self.opportunities:
+            lines.append(f"  {saving / 1e3:.3f} ms: {desc}")
+        return "\n".join(lines)
+
+
+def analyze(
+    trace,
+    expr=None,
+    deps=None,
+    min_gap=1.0,
+    min_gain_ratio=0.05,
+    ios_gain_ratio=0.2,
+    top_k=5,
+):
+    """Analyze the critical path and the idle time of a trace of a single execution.
+
+    Parameters
+    ----------
+    trace : Union[Dict, str, List[TraceEvent]]
+        The trace of raf.utils.profiler.get() or raf.utils.profiler.dump_trace(), or its events.
+
+    expr : Optional[raf.ir.Expr]
+        The executed expression, whose dependency graph gives the data dependencies of the events.
+        See dependencies_from_expr.
+
+    deps : Optional[Dict[int, Set[int]]]
+        The indices of the device events that each device event depends on, which overrides expr.
+
+    min_gap : float
+        The host gaps shorter than this in microseconds are ignored.
+
+    min_gain_ratio : float
+        A multi-stream schedule is recommended only if it may save this ratio of the makespan.
+
+    ios_gain_ratio : float
+        The IOS schedule, whose search profiles the candidate schedules at the compile time, is
+        recommended only if it may save this ratio of the makespan. Otherwise the wavefront
+        schedule is recommended.
+
+    top_k : int
+        The number of the opportunities to report.
+
+    Returns
+    -------
+    ret : TraceAnalysis
+        The analysis.
+    """
+    events = trace if isinstance(trace, list) else load_events(trace)
+    events = [e for e in events if e.category not in HOST_CATEGORIES]
+    ret = TraceAnalysis()
+    if not events:
+        return ret
+    if deps is None and expr is not None:
+        deps = dependencies_from_expr(expr, events)
+    begin = min(e.start for e in events)
+    end = max(e.end for e in events)
+    ret.makespan = end - begin
+
+    # Utilization of the streams.
+    per_stream = {}
+    for e in events:
+        per_stream.setdefault(e.stream, []).append((e.start, e.end))
+    for stream, intervals in per_stream.items():
+        busy = _length(_union(intervals))
+        ret.streams[stream] = {"busy": busy, "utilization": busy / ret.makespan if busy else 0.0}
+
+    # The communication that no computation overlaps.
+    comm = _union([(e.start, e.end) for e in events if is_communication(e)])
+    compute = _union([(e.start, e.end) for e in events if not is_communication(e)])
+    ret.communication = _length(comm)
+    ret.exposed_communication = _length(_subtract(comm, compute))
+
+    # The gaps where the devices wait for the host.
+    busy = _union([(e.start, e.end) for e in events])
+    gaps = []
+    for prev, cur in zip(busy, busy[1:]):
+        if cur[0] - prev[1] >= min_gap:
+            after = next(e.name for e in events if e.start >= cur[0])
+            gaps.append((prev[1], cur[0], after))
+    gaps.sort(key=lambda gap: gap[0] - gap[1])
+    ret.host_gaps = gaps
+    ret.host_bound = sum(gap[1] - gap[0] for gap in gaps)
+
+    # The predecessors of each event: its data dependencies and the previous event on its stream.
+    # The events are sorted by their starts, so a dependency that starts later is a wrong match.
+    preds = [{j for j in deps.get(i, ()) if j < i} if deps else set() for i in range(len(events))]
+    last = {}
+    for i, e in enumerate(events):
+        if e.stream in last:
+            preds[i].add(last[e.stream])
+        last[e.stream] = i
+
+    # The critical path follows the predecessor that ends the latest back from the last event.
+    cur = max(range(len(events)), key=lambda i: events[i].end)
+    path = [cur]
+    while preds[cur]:
+        prev = max(preds[cur], key=lambda i: events[i].end)
+        ret.critical_path_wait += max(0.0, events[cur].start - events[prev].end)
+        cur = prev
+        path.append(cur)
+    ret.critical_path = [events[i] for i in reversed(path)]
+
+    # The longest chain of the durations by the data dependencies only.
+    if deps:
+        finish = [0.0] * len(events)
+        for i, e in enumerate(events):
+            ready = max((finish[j] for j in deps.get(i, ()) if j < i), default=0.0)
+            finish[i] = ready + e.duration
+        ret.dependency_bound = max(finish)
+    else:
+        ret.dependency_bound = max(_length(_union(v)) for v in per_stream.values())
+    ret.multi_stream_gain = max(0.0, _length(compute) - ret.dependency_bound)
+    if ret.multi_stream_gain >= ios_gain_ratio * ret.makespan:
+        ret.schedule_policy = "ios"
+    elif ret.multi_stream_gain >= min_gain_ratio * ret.makespan:
+        ret.schedule_policy = "wavefront"
+
+    # The opportunities.
+    opportunities = []
+    if ret.host_bound > 0:
+        worst = ", ".join(f"{g[1] - g[0]:.1f} us before {g[2]}" for g in gaps[:3])
+        opportunities.append(
+            (
+                ret.host_bound,
+                "The devices wait for the host launches, e.g., "
+                f"{worst}. Fuse the small ops or use the CUDA graph.",
+            )
+        )
+    if ret.exposed_communication > 0:
+        opportunities.append(
+            (
+                ret.exposed_communication,
+                "The communication is not overlapped with the computation. Schedule it on the "
+                "communication stream earlier, or tune the bucket sizes.",
+            )
+        )
+    if ret.multi_stream_gain > 0 and deps:
+        opportunities.append(
+            (
+                ret.multi_stream_gain,
+                "The independent ops run serially. Set raf.stream_schedule.policy to "
+                f"{ret.schedule_policy if ret.schedule_policy != 'sequential' else 'wavefront'}.",
+            )
+        )
+    on_path = {}
+    for e in ret.critical_path:
+        on_path[e.name] = on_path.get(e.name, 0.0) + e.duration
+    for name, duration in sorted(on_path.items(), key=lambda kv: -kv[1])[:top_k]:
+        opportunities.append((duration, f"{name} is on the critical path."))
+    opportunities.sort(key=lambda opp: -opp[0])
+    ret.opportunities = opportunities[:top_k]
+    return ret
@@ -7,13 +7,15 @@ The tuning utilities.
 # pylint: disable=too-many-locals, too-many-arguments, protected-access
 # pylint: disable=missing-class-docstring, missing-function-docstring, no-self-use
 # pylint: disable=attribute-defined-outside-init
+import hashlib
 import os
 from copy import copy
 
 import tvm
 
 import raf
-from raf._core.executor import MetaFallbackContext
+from raf import _ffi
+from raf._core.executor import MetaFallbackContext, init_auto_scheduler_dispatch_context
 from raf._core.ndarray import array
 from raf._core.executor import VMExecutor
 from raf.model.trace import _get_func_inputs
@@ -22,7 +24,9 @@ from tvm import auto_scheduler, autotvm
 from tvm.auto_scheduler import compute_dag
 
 
-def extract_tuning_tasks(mod_or_executor, args, device, *, fusion=False, pass_seq=None):
+def extract_tuning_tasks(
+    mod_or_executor, args, device, *, fusion=False, pass_seq=None, include_simple_tasks=False
+):
     """Extract tuning tasks from the given function and the target.
 
     Parameters
@@ -42,6 +46,10 @@ def extract_tuning_tasks(mod_or_executor, args, device, *, fusion=False, pass_se
     pass_seq: Optional[RAFSequential]
         A pass sequence to be applied.
 
+    include_simple_tasks: bool
+        Whether to extract the tasks without complex ops, e.g., the fused elementwise ops, which
+        are skipped by default. Default: False.
+
     Returns
     -------
     task_n_weights: Tuple[List[SearchTask], List[int]]
@@ -73,9 +81,11 @@ def extract_tuning_tasks(mod_or_executor, args, device, *, fusion=False, pass_se
     old_autotvm_silent = autotvm.GLOBAL_SCOPE.silent
     autotvm.GLOBAL_SCOPE.silent = True
 
-    env_tracing_task = auto_scheduler.relay_integration.TracingEnvironment(
-        auto_scheduler.relay_integration.TracingMode.EXTRACT_COMPLEX_TASK_ONLY
-    )
+    tracing_mode = auto_scheduler.relay_integration.TracingMode
+    mode = tracing_mode.EXTRACT_COMPLEX_TASK_ONLY
+    if include_simple_tasks:
+        mode = tracing_mode.EXTRACT_TASK
+    env_tracing_task = auto_scheduler.relay_integration.TracingEnvironment(mode)
     with env_tracing_task:
         with raf.ir.PassContext(
             config={"relay.backend.use_auto_scheduler": True, "raf.tvm.allow_jit_failure": True},
@@ -165,7 +175,8 @@ def run_tuning(
     pass_seq=None,
     n_trials=lambda l: 300 * min(l, 100),
     only_tune_tasks_with_name=None,
-    only_extract_tasks=False
+    only_extract_tasks=False,
+    include_simple_tasks=False
 ):
     """Tune the given tasks.
 
@@ -201,10 +212,19 @@ def run_tuning(
 
     only_extract_tasks: bool
         Whether to extract and print tasks only without actual tuning them.
+
+    include_simple_tasks: bool
+        Whether to also tune the tasks without complex ops, e.g., the fused elementwise ops.
+        Default: False.
     """
     print("Extracting tasks...")
     tasks, weights = extract_tuning_tasks(
-        model_or_executor, args, device, fusion=fusion, pass_seq=pass_seq
+        model_or_executor,
+        args,
+        device,
+        fusion=fusion,
+        pass_seq=pass_seq,
+        include_simple_tasks=include_simple_tasks,
     )
     ori_task_num = len(tasks)
 
@@ -231,6 +251,25 @@ def run_tuning(
     tune_tasks(tasks, weights, log_file, n_trials)
 
 
+def set_schedule_database(log_file):
+    """Compile the TVM dialect ops, including the fused ops, with the best schedules in the
+    tuning records, e.g., the log file of run_tuning. It applies to all the executors in this
+    process. The kernels compiled with the records are cached separately from the ones compiled
+    with the builtin schedules, and the records are identified by their content.
+
+    Parameters
+    ----------
+    log_file: Optional[str]
+        The tuning records. None to stop using the records.
+    """
+    tag = ""
+    if log_file is not None:
+        with open(log_file, "rb") as records:
+            tag = "schedule_database:" + hashlib.sha1(records.read()).hexdigest()
+    init_auto_scheduler_dispatch_context(log_file)
+    _ffi.cache.SetTVMScheduleDatabaseTag(tag)
+
+
 def tune_op(
     sch_file,
     model_cls,
@@ -0,0 +1,71 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Microbenchmark of the host-side dispatch of the VM, which runs a chain of small ops on the
+switch dispatch loop and on the direct-threaded one (fast_dispatch), and reports the time per
+executed instruction. The ops are tiny, so the time is dominated by the dispatch. With --dryrun
+the ops are skipped, which leaves the dispatch only. For example,
+    python3 scripts/benchmark/bench_vm_dispatch.py --device cpu --num-ops 256
+"""
+# pylint: disable=attribute-defined-outside-init,protected-access
+import argparse
+
+import raf
+from raf._core.executor import VMExecutor
+from raf.testing import randn
+
+
+def make_chain(num_ops, shape, device):
+    """Make the module of a chain of additions on a small tensor."""
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = x
+            for _ in range(num_ops):
+                y = raf.add(y, x)
+            return y
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    return model._internal(m_x).mod, m_x
+
+
+def count_instructions(executable):
+    """Count the instructions of the bytecode, which has no branches, so each one runs once."""
+    lines = executable.bytecode.splitlines()
+    return sum(1 for line in lines if "# " in line and ": " in line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--device", default="cpu")
+    parser.add_argument("--num-ops", type=int, default=256)
+    parser.add_argument("--shape", type=int, nargs="+", default=[1])
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--number", type=int, default=100)
+    parser.add_argument("--repeat", type=int, default=10)
+    parser.add_argument("--dryrun", action="store_true", help="Skip the execution of the ops")
+    args = parser.parse_args()
+
+    mod, m_x = make_chain(args.num_ops, args.shape, args.device)
+    results = {}
+    for name, fast_dispatch in [("switch", False), ("threaded", True)]:
+        executor = VMExecutor(mod, args.device, dryrun=args.dryrun, fast_dispatch=fast_dispatch)
+        num_instrs = count_instructions(executor.executable)
+        lat = executor.make_profiler(args.warmup, args.number, args.repeat)(m_x)
+        # The latency is in ms, and the best repeat is reported as the least disturbed one.
+        results[name] = min(lat) * 1e6 / num_instrs
+        print(
+            "%-8s %6d instructions, %8.4f ms per run, %8.1f ns per instruction"
+            % (name, num_instrs, min(lat), results[name])
+        )
+    print("speedup of threaded dispatch: %.2fx" % (results["switch"] / results["threaded"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -63,6 +63,7 @@ OPS = [
     Op(name="sqrt_dx", schema_name="unary_dx"),
     Op(name="add", schema_name="binary_ufunc"),
     Op(name="subtract", schema_name="binary_ufunc"),
+    Op(name="add_n", schema_name="add_n"),
     Op(name="multiply", schema_name="binary"),
     Op(name="divide", schema_name="binary"),
     Op(name="floor_divide", schema_name="binary"),
@@ -87,6 +88,12 @@ OPS = [
     Op(name="batch_matmul_nt", schema_name="binary"),
     Op(name="batch_matmul_tn", schema_name="binary"),
     Op(name="batch_matmul_tt", schema_name="binary"),
+    Op(name="grouped_matmul", schema_name="grouped_matmul"),
+    Op(name="qnn_dense", schema_name="binary"),
+    Op(name="qnn_batch_matmul_nt", schema_name="binary"),
+    Op(name="qnn_conv2d", schema_name="conv"),
+    Op(name="quantize", schema_name="quantize"),
+    Op(name="dequantize", schema_name="dequantize"),
     Op(name="smooth_l1_loss", schema_name="loss"),
     Op(name="smooth_l1_loss_dpred", schema_name="loss"),
     Op(name="smooth_l1_loss_dtrue", schema_name="loss"),
@@ -96,7 +103,10 @@ OPS = [
     Op(name="cross_entropy", schema_name="loss"),
     Op(name="cross_entropy_dpred", schema_name="loss_dtp"),
     Op(name="cross_entropy_dtrue", schema_name="loss_dtp"),
+    Op(name="softmax_cross_entropy", schema_name="loss"),
+    Op(name="softmax_cross_entropy_dpred", schema_name="loss_dtp"),
     Op(name="reshape", schema_name="reshape"),
+    Op(name="view", schema_name="view"),
     Op(name="reshape_like", schema_name="binary_like"),
     Op(name="resize2d", schema_name="resize2d"),
     Op(name="resize2d_dx", schema_name="resize2d_dx"),
@@ -118,13 +128,20 @@ OPS = [
     Op(name="get_reduce_axis", schema_name="binary"),
     Op(name="get_kept_dims", schema_name="binary"),
     Op(name="sgd", schema_name="sgd"),
+    Op(name="sparse_sgd", schema_name="sparse_sgd"),
     Op(name="lans", schema_name="lans"),
+    Op(name="adam", schema_name="adam"),
+    Op(name="adamw", schema_name="adam"),
+    Op(name="multi_tensor_scale", schema_name="multi_tensor_scale"),
+    Op(name="multi_tensor_l2norm", schema_name="multi_tensor_l2norm"),
+    Op(name="multi_tensor_clip_by_global_norm", schema_name="multi_tensor_clip_by_global_norm"),
     Op(name="shape", schema_name="unary"),
     Op(name="swap_axis", schema_name="swap_axis"),
     Op(name="take", schema_name="take"),
     Op(name="take_dx", schema_name="take_dx"),
     Op(name="embedding", schema_name="embedding"),
     Op(name="embedding_dx", schema_name="embedding_dx"),
+    Op(name="embedding_sparse_dx", schema_name="embedding_dx"),
     Op(name="dense", schema_name="binary"),
     Op(name="repeat", schema_name="repeat"),
     Op(name="repeat_dx", schema_name="repeat_dx"),
@@ -134,6 +151,8 @@ OPS = [
     Op(name="strided_slice", schema_name="strided_slice"),
     Op(name="strided_slice_dx", schema_name="strided_slice_dx"),
     Op(name="strided_set", schema_name="strided_set"),
+    Op(name="kv_append", schema_name="kv_append"),
+    Op(name="paged_kv_append", schema_name="paged_kv_append"),
     Op(name="sequence_mask", schema_name="sequence_mask"),
     Op(name="reverse_sequence", schema_name="reverse_sequence"),
     Op(name="reverse", schema_name="reverse"),
@@ -152,6 +171,17 @@ OPS = [
     Op(name="scatter_dx", schema_name="scatter_dx"),
     Op(name="layer_norm_dx", schema_name="layer_norm_dx"),
     Op(name="layer_norm_train_dx", schema_name="layer_norm_train_dx"),
+    Op(name="attention", schema_name="attention"),
+    Op(name="attention_dx", schema_name="attention_dx"),
+    Op(name="paged_attention", schema_name="paged_attention"),
+    Op(name="block_sparse_matmul_sdd", schema_name="block_sparse_sdd"),
+    Op(name="block_sparse_matmul_dsd", schema_name="block_sparse_dsd"),
+    Op(name="block_sparse_softmax", schema_name="block_sparse_softmax"),
+    Op(name="block_sparse_softmax_dx", schema_name="block_sparse_softmax_dx"),
+    Op(name="add_dropout_layer_norm", schema_name="add_dropout_layer_norm"),
+    Op(name="add_dropout_layer_norm_dx", schema_name="add_dropout_layer_norm_dx"),
+    Op(name="embedding_layer_norm", schema_name="embedding_layer_norm"),
+    Op(name="embedding_layer_norm_dx", schema_name="add_dropout_layer_norm_dx"),
     Op(name="concatenate_dx", schema_name="concatenate"),
     Op(name="clip", schema_name="clip"),
     Op(name="clip_dx", schema_name="clip_dx"),
@@ -159,6 +189,8 @@ OPS = [
     Op(name="bias_add", schema_name="bias_add"),
     Op(name="_contrib_dropout", schema_name="dropout"),
     Op(name="_contrib_dropout_dx", schema_name="dropout_dx"),
+    Op(name="counter_dropout", schema_name="counter_dropout"),
+    Op(name="counter_dropout_dx", schema_name="counter_dropout_dx"),
     Op(name="non_max_suppression", schema_name="non_max_suppression"),
     Op(name="stream_sync", schema_name="stream"),
     Op(name="fuse_tensor", schema_name="fuse_tensor"),
@@ -174,6 +206,7 @@ OPS = [
     Op(name="sort", schema_name="sort"),
     Op(name="compiler_begin", schema_name="unary"),
     Op(name="compiler_end", schema_name="unary"),
+    Op(name="checkpoint_boundary", schema_name="unary"),
     Op(name="full", schema_name="full"),
     Op(name="full_like", schema_name="full_like"),
     Op(name="where", schema_name="where"),
@@ -210,6 +243,16 @@ OPS = [
     Op(name="_group_reduce_scatter", schema_name="group_reduce_scatter"),
     Op(name="_broadcast", schema_name="broadcast"),
     Op(name="_all_to_all", schema_name="all_to_all"),
+    Op(name="_all_to_allv", schema_name="all_to_allv"),
+    Op(name="_vocab_parallel_cross_entropy", schema_name="vocab_parallel_cross_entropy"),
+    Op(
+        name="_vocab_parallel_cross_entropy_dpred",
+        schema_name="vocab_parallel_cross_entropy_dpred",
+    ),
+    Op(name="_sync_batch_norm_train", schema_name="sync_batch_norm"),
+    Op(name="_sync_batch_norm_train_dxwb", schema_name="sync_batch_norm_dxwb"),
+    Op(name="_sequence_scatter", schema_name="sequence_parallel"),
+    Op(name="_sequence_gather", schema_name="sequence_parallel"),
     Op(name="_gather", schema_name="gather_scatter"),
     Op(name="_scatter", schema_name="gather_scatter"),
     Op(name="_send", schema_name="send"),
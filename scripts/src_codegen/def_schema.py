@@ -153,6 +153,18 @@ SCHEMAS = {
         Arg(name="reserve_space", cxx_type="value::BaseTensorValue"),
         Arg(name="p", cxx_type="double", cxx_default=0.5),
     ],
+    "nn.h::counter_dropout": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="key", cxx_type="value::BaseTensorValue"),
+        Arg(name="p", cxx_type="double", cxx_default=0.5),
+        Arg(name="offset", cxx_type="int64_t", cxx_default=0),
+    ],
+    "nn.h::counter_dropout_dx": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="key", cxx_type="value::BaseTensorValue"),
+        Arg(name="p", cxx_type="double", cxx_default=0.5),
+        Arg(name="offset", cxx_type="int64_t", cxx_default=0),
+    ],
     "nn.h::local_response_norm": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="size", cxx_type="int64_t"),
@@ -292,6 +304,101 @@ SCHEMAS = {
         Arg(name="axis", cxx_type="int64_t", cxx_default=-1),
         Arg(name="eps", cxx_type="double", cxx_default=1e-5),
     ],
+    "nn.h::attention": [
+        Arg(name="q", cxx_type="value::BaseTensorValue"),
+        Arg(name="k", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="mask", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="causal", cxx_type="bool", cxx_default=False),
+        Arg(name="scale", cxx_type="double", cxx_default=0.0),
+        Arg(name="dropout_p", cxx_type="double", cxx_default=0.0),
+        Arg(name="seed", cxx_type="int64_t", cxx_default=0),
+    ],
+    "nn.h::attention_dx": [
+        Arg(name="q", cxx_type="value::BaseTensorValue"),
+        Arg(name="k", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="mask", cxx_type=OptionalTensor),
+        Arg(name="out", cxx_type="value::BaseTensorValue"),
+        Arg(name="lse", cxx_type="value::BaseTensorValue"),
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="causal", cxx_type="bool", cxx_default=False),
+        Arg(name="scale", cxx_type="double", cxx_default=0.0),
+        Arg(name="dropout_p", cxx_type="double", cxx_default=0.0),
+        Arg(name="seed", cxx_type="int64_t", cxx_default=0),
+    ],
+    "nn.h::paged_attention": [
+        Arg(name="q", cxx_type="value::BaseTensorValue"),
+        Arg(name="k_cache", cxx_type="value::BaseTensorValue"),
+        Arg(name="v_cache", cxx_type="value::BaseTensorValue"),
+        Arg(name="block_table", cxx_type="value::BaseTensorValue"),
+        Arg(name="lengths", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="double", cxx_default=0.0),
+    ],
+    "nn.h::embedding_layer_norm": [
+        Arg(name="word", cxx_type="value::BaseTensorValue"),
+        Arg(name="word_ids", cxx_type="value::BaseTensorValue"),
+        Arg(name="pos", cxx_type="value::BaseTensorValue"),
+        Arg(name="pos_ids", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="bias", cxx_type="value::BaseTensorValue"),
+        Arg(name="token_type", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="token_type_ids", cxx_type=OptionalTensor, cxx_default="nullptr"),
+        Arg(name="p", cxx_type="double", cxx_default=0.0),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+        Arg(name="seed", cxx_type="int64_t", cxx_default=0),
+    ],
+    "nn.h::block_sparse_sdd": [
+        Arg(name="x1", cxx_type="value::BaseTensorValue"),
+        Arg(name="x2", cxx_type="value::BaseTensorValue"),
+        Arg(name="layout", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="block", cxx_type="int64_t", cxx_default=32),
+    ],
+    "nn.h::block_sparse_dsd": [
+        Arg(name="a", cxx_type="value::BaseTensorValue"),
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="layout", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="block", cxx_type="int64_t", cxx_default=32),
+        Arg(name="transpose_a", cxx_type="bool", cxx_default=False),
+    ],
+    "nn.h::block_sparse_softmax": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="layout", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="block", cxx_type="int64_t", cxx_default=32),
+        Arg(name="scale", cxx_type="double", cxx_default=1.0),
+        Arg(name="causal", cxx_type="bool", cxx_default=False),
+    ],
+    "nn.h::block_sparse_softmax_dx": [
+        Arg(name="y", cxx_type="value::BaseTensorValue"),
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="layout", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="block", cxx_type="int64_t", cxx_default=32),
+        Arg(name="scale", cxx_type="double", cxx_default=1.0),
+    ],
+    "nn.h::add_dropout_layer_norm": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="residual", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="bias", cxx_type="value::BaseTensorValue"),
+        Arg(name="p", cxx_type="double", cxx_default=0.0),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+        Arg(name="seed", cxx_type="int64_t", cxx_default=0),
+    ],
+    "nn.h::add_dropout_layer_norm_dx": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="pre_norm", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="value::BaseTensorValue"),
+        Arg(name="mean", cxx_type="value::BaseTensorValue"),
+        Arg(name="invvar", cxx_type="value::BaseTensorValue"),
+        Arg(name="mask", cxx_type="value::BaseTensorValue"),
+        Arg(name="p", cxx_type="double", cxx_default=0.0),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+    ],
+    "nn.h::grouped_matmul": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="weight", cxx_type="value::BaseTensorValue"),
+        Arg(name="group_sizes", cxx_type="value::BaseTensorValue"),
+    ],
     "nn.h::split": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="indices_or_sections", cxx_type="value::Value", cxx_default="nullptr"),
@@ -307,6 +414,16 @@ SCHEMAS = {
         Arg(name="dy", cxx_type="value::BaseTensorValue"),
         Arg(name="threshold", cxx_type="double", cxx_default=0.0),
     ],
+    "nn.h::quantize": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="double"),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"int8"', py_default='"int8"'),
+    ],
+    "nn.h::dequantize": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="scale", cxx_type="double"),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='"float32"', py_default='"float32"'),
+    ],
     "loss.h::loss": [
         Arg(name="y_true", cxx_type="value::BaseTensorValue"),
         Arg(name="y_pred", cxx_type="value::BaseTensorValue"),
@@ -341,6 +458,9 @@ SCHEMAS = {
         Arg(name="x1", cxx_type="value::Value"),
         Arg(name="x2", cxx_type="value::Value"),
     ],
+    "ufunc.h::add_n": [
+        Arg(name="x", cxx_type="std::vector<value::BaseTensorValue>", cxx_normalizer="TensorTuple"),
+    ],
     "ufunc.h::ternary": [
         Arg(name="x1", cxx_type="value::Value"),
         Arg(name="x2", cxx_type="value::Value"),
@@ -547,6 +667,11 @@ SCHEMAS = {
         ),
         Arg(name="slice_mode", cxx_type="std::string", cxx_default='"end"', py_default='"end"'),
     ],
+    "transform.h::view": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="shape", cxx_type="std::vector<int64_t>", cxx_normalizer="IntTuple"),
+        Arg(name="offset", cxx_type="int64_t", cxx_default=0, py_default=0),
+    ],
     "transform.h::strided_set": [
         Arg(name="data", cxx_type="value::BaseTensorValue"),
         Arg(name="v", cxx_type="value::BaseTensorValue"),
@@ -560,6 +685,17 @@ SCHEMAS = {
             py_default="None",
         ),
     ],
+    "transform.h::kv_append": [
+        Arg(name="cache", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="pos", cxx_type="value::BaseTensorValue"),
+    ],
+    "transform.h::paged_kv_append": [
+        Arg(name="cache", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="block_table", cxx_type="value::BaseTensorValue"),
+        Arg(name="pos", cxx_type="value::BaseTensorValue"),
+    ],
     "likes.h::sum_dx": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="dy", cxx_type="value::BaseTensorValue"),
@@ -675,6 +811,14 @@ SCHEMAS = {
         Arg(name="learning_rate", cxx_type="double"),
         Arg(name="mu", cxx_type="double"),
     ],
+    "optimizer.h::sparse_sgd": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="rows", cxx_type="value::BaseTensorValue"),
+        Arg(name="values", cxx_type="value::BaseTensorValue"),
+        Arg(name="v", cxx_type="value::BaseTensorValue"),
+        Arg(name="learning_rate", cxx_type="double"),
+        Arg(name="mu", cxx_type="double"),
+    ],
     "optimizer.h::lans": [
         Arg(
             name="tensor_list",
@@ -691,6 +835,51 @@ SCHEMAS = {
         Arg(name="grad_averaging", cxx_type="int"),
         Arg(name="mode", cxx_type="int"),
         Arg(name="normalize_grad", cxx_type="bool"),
+        Arg(name="quantize_states", cxx_type="bool", cxx_default=False),
+    ],
+    "optimizer.h::adam": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="step", cxx_type="value::BaseTensorValue"),
+        Arg(name="learning_rate", cxx_type="float"),
+        Arg(name="beta1", cxx_type="float"),
+        Arg(name="beta2", cxx_type="float"),
+        Arg(name="eps", cxx_type="float"),
+        Arg(name="weight_decay", cxx_type="float"),
+        Arg(name="bias_correction", cxx_type="bool", cxx_default=True),
+        Arg(name="grad_scale", cxx_type="float", cxx_default="1.0", py_default="1.0"),
+        Arg(name="mixed_precision", cxx_type="bool", cxx_default=False),
+        Arg(name="dynamic_loss_scale", cxx_type="bool", cxx_default=False),
+        Arg(name="scale_window", cxx_type="int", cxx_default=2000),
+        Arg(name="quantize_states", cxx_type="bool", cxx_default=False),
+    ],
+    "optimizer.h::multi_tensor_scale": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="scale", cxx_type="double", cxx_default=1.0),
+        Arg(name="dtype", cxx_type="std::string", cxx_default='""', py_default='""'),
+    ],
+    "optimizer.h::multi_tensor_l2norm": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+    ],
+    "optimizer.h::multi_tensor_clip_by_global_norm": [
+        Arg(
+            name="tensor_list",
+            cxx_type="std::vector<value::BaseTensorValue>",
+            cxx_normalizer="TensorTuple",
+        ),
+        Arg(name="max_norm", cxx_type="double"),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-6),
     ],
     "stream.h::stream": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
@@ -745,6 +934,44 @@ SCHEMAS = {
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="rank_list", cxx_type="value::Value", cxx_default="nullptr"),
     ],
+    "communication.h::all_to_allv": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="send_counts", cxx_type="value::BaseTensorValue"),
+        Arg(name="rank_list", cxx_type="value::Value", cxx_default="nullptr"),
+    ],
+    "communication.h::vocab_parallel_cross_entropy": [
+        Arg(name="y_true", cxx_type="value::BaseTensorValue"),
+        Arg(name="y_pred", cxx_type="value::BaseTensorValue"),
+        Arg(name="rank_list", cxx_type="value::Value", cxx_default="nullptr"),
+    ],
+    "communication.h::vocab_parallel_cross_entropy_dpred": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="y_true", cxx_type="value::BaseTensorValue"),
+        Arg(name="y_pred", cxx_type="value::BaseTensorValue"),
+        Arg(name="rank_list", cxx_type="value::Value", cxx_default="nullptr"),
+    ],
+    "communication.h::sync_batch_norm": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="running_mean", cxx_type="value::BaseTensorValue"),
+        Arg(name="running_var", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue", cxx_default="nullptr"),
+        Arg(name="b", cxx_type="value::BaseTensorValue", cxx_default="nullptr"),
+        Arg(name="momentum", cxx_type="double", cxx_default=0.1),
+        Arg(name="eps", cxx_type="double", cxx_default=1e-5),
+        Arg(name="rank_list", cxx_type="value::Value", cxx_default="nullptr"),
+    ],
+    "communication.h::sync_batch_norm_dxwb": [
+        Arg(name="dy", cxx_type="value::BaseTensorValue"),
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="w", cxx_type="value::BaseTensorValue"),
+        Arg(name="b", cxx_type="value::BaseTensorValue"),
+        Arg(name="eps", cxx_type="double"),
+        Arg(name="rank_list", cxx_type="value::Value", cxx_default="nullptr"),
+    ],
+    "communication.h::sequence_parallel": [
+        Arg(name="x", cxx_type="value::BaseTensorValue"),
+        Arg(name="rank_list", cxx_type="value::Value", cxx_default="nullptr"),
+    ],
     "communication.h::send": [
         Arg(name="x", cxx_type="value::BaseTensorValue"),
         Arg(name="peer", cxx_type="int"),
@@ -891,6 +1118,7 @@ SCHEMAS = {
             py_default="None",
         ),
         Arg(name="own", cxx_type="bool", cxx_default=True),
+        Arg(name="offset", cxx_type="int64_t", cxx_default=0),
     ],
     "vm.h::free": [
         Arg(name="memory", cxx_type="value::BaseTensorValue"),
@@ -907,6 +1135,7 @@ SCHEMAS = {
     "vm.h::set_shape": [
         Arg(name="data", cxx_type="value::BaseTensorValue"),
         Arg(name="shape", cxx_type="value::Value"),
+        Arg(name="offset", cxx_type="int64_t", cxx_default=0, py_default=0),
     ],
     "transform.h::argwhere": [
         Arg(name="condition", cxx_type="value::BaseTensorValue"),
@@ -914,6 +1143,7 @@ SCHEMAS = {
     "stream.h::set_stream": [
         Arg(name="device_id", cxx_type="int64_t"),
         Arg(name="stream_id", cxx_type="int64_t"),
+        Arg(name="priority", cxx_type="int64_t", cxx_default=0, py_default=0),
     ],
     "stream.h::event": [
         Arg(name="event_id", cxx_type="int64_t"),
@@ -274,6 +274,29 @@ Node* CreateNewNode(Arena* arena) {
   return node;
 }
 
+CSRGraph::CSRGraph(const std::vector<Node*>& nodes) : nodes_(nodes) {
+  int n = size();
+  index_.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    index_[nodes_[i]] = i;
+  }
+  auto build = [&](NodeList Node::*list, std::vector<int>* offsets, std::vector<int>* indices) {
+    offsets->resize(n + 1);
+    (*offsets)[0] = 0;
+    for (int i = 0; i < n; ++i) {
+      for (auto iit = (nodes_[i]->*list).head; iit; iit = iit->next) {
+        int j = index(iit->value);
+        if (j >= 0) {
+          indices->push_back(j);
+        }
+      }
+      (*offsets)[i + 1] = static_cast<int>(indices->size());
+    }
+  };
+  build(&Node::parents, &parent_offsets_, &parent_indices_);
+  build(&Node::children, &child_offsets_, &child_indices_);
+}
+
 }  // namespace dependency_graph
 
 DependencyGraph CreateDependencyGraph(Arena* arena, const Expr& e, bool prune_atomic_nodes,
@@ -9,6 +9,9 @@
  */
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 namespace raf {
 namespace analysis {
 namespace dependency_graph {
@@ -54,6 +57,77 @@ size_t GetListSize(const tvm::relay::LinkedList<Node*>& node_list);
  */
 Node* CreateNewNode(Arena* arena);
 
+/*!
+ * \brief A read-only snapshot of the edges among given nodes in the compressed sparse row (CSR)
+ * format. The nodes are numbered by their positions in the given order, and the parents and
+ * children of each node are stored contiguously by the numbers, so the degrees are O(1) and the
+ * traversals do not chase the linked lists. Create it after the graph is no longer modified, and
+ * share it among the analyses of the graph.
+ */
+class CSRGraph {
+ public:
+  /*! \brief The numbers of the parents or children of a node. */
+  struct Range {
+    const int* first;
+    const int* last;
+    const int* begin() const {
+      return first;
+    }
+    const int* end() const {
+      return last;
+    }
+    int size() const {
+      return static_cast<int>(last - first);
+    }
+  };
+
+  /*!
+   * \brief Create the CSR graph. The edges to the nodes not in the list are skipped, and the
+   * duplicated edges are kept as in the linked lists.
+   * \param nodes The nodes, e.g., the post DFS order of a dependency graph.
+   */
+  explicit CSRGraph(const std::vector<Node*>& nodes);
+
+  /*! \brief The number of the nodes. */
+  int size() const {
+    return static_cast<int>(nodes_.size());
+  }
+
+  /*! \brief The node of number i. */
+  Node* node(int i) const {
+    return nodes_[i];
+  }
+
+  /*! \brief The number of the node, or -1 if it is not in the graph. */
+  int index(const Node* node) const {
+    auto it = index_.find(node);
+    return it == index_.end() ? -1 : it->second;
+  }
+
+  /*! \brief The parents of node i, i.e., the nodes depending on it. */
+  Range parents(int i) const {
+    return {parent_indices_.data() + parent_offsets_[i],
+            parent_indices_.data() + parent_offsets_[i + 1]};
+  }
+
+  /*! \brief The children of node i, i.e., the nodes it depends on. */
+  Range children(int i) const {
+    return {child_indices_.data() + child_offsets_[i],
+            child_indices_.data() + child_offsets_[i + 1]};
+  }
+
+ private:
+  /*! \brief The nodes, and the number of each node. */
+  std::vector<Node*> nodes_;
+  std::unordered_map<const Node*, int> index_;
+  /*! \brief The parents of node i are parent_indices_[parent_offsets_[i]:parent_offsets_[i+1]]. */
+  std::vector<int> parent_offsets_;
+  std::vector<int> parent_indices_;
+  /*! \brief The children of node i, in the same layout as the parents. */
+  std::vector<int> child_offsets_;
+  std::vector<int> child_indices_;
+};
+
 }  // namespace dependency_graph
 }  // namespace analysis
 }  // namespace raf
@@ -12,6 +12,7 @@
 #include <cuda.h>
 #include <cuda_runtime.h>
 #include <cuda_fp16.h>
+#include <cuda_bf16.h>
 
 #include "raf/device.h"
 
@@ -34,8 +35,21 @@
         << "CUDA error " << e << ": " << cudaGetErrorString(e); \
   } while (false)
 
+// Wrap CUDA driver API calls with error checking.
+#define CU_CALL(func)                                                      \
+  do {                                                                     \
+    CUresult e = (func);                                                   \
+    if (e != CUDA_SUCCESS) {                                               \
+      const char* msg = nullptr;                                           \
+      cuGetErrorString(e, &msg);                                           \
+      LOG(FATAL) << "CUDA driver error " << e << ": " << (msg ? msg : ""); \
+    }                                                                      \
+  } while (false)
+
 template <typename T, int value,
-          typename std::enable_if<std::is_same<T, __half>::value, int>::type = 0>
+          typename std::enable_if<std::is_same<T, __half>::value ||
+                                      std::is_same<T, __nv_bfloat16>::value,
+                                  int>::type = 0>
 inline const void* const_typed_addr() {
   float tmp = static_cast<float>(value);
   static const T a = static_cast<T>(tmp);
@@ -43,7 +57,9 @@ inline const void* const_typed_addr() {
 }
 
 template <typename T, int value,
-          typename std::enable_if<!std::is_same<T, __half>::value, int>::type = 0>
+          typename std::enable_if<!std::is_same<T, __half>::value &&
+                                      !std::is_same<T, __nv_bfloat16>::value,
+                                  int>::type = 0>
 inline const void* const_typed_addr() {
   static const T a = static_cast<T>(value);
   return static_cast<const void*>(&a);
@@ -56,8 +72,12 @@ inline const void* const_addr(cudaDataType_t dt) {
       return const_typed_addr<int8_t, value>();
     case CUDA_R_8U:
       return const_typed_addr<uint8_t, value>();
+    case CUDA_R_32I:
+      return const_typed_addr<int32_t, value>();
     case CUDA_R_16F:
       return const_typed_addr<__half, value>();
+    case CUDA_R_16BF:
+      return const_typed_addr<__nv_bfloat16, value>();
     case CUDA_R_32F:
       return const_typed_addr<float, value>();
     case CUDA_R_64F:
@@ -83,6 +103,8 @@ inline std::shared_ptr<void> shared_addr(cudaDataType_t dt, float value) {
       return shared_typed_addr<uint8_t>(value);
     case CUDA_R_16F:
       return shared_typed_addr<__half>(value);
+    case CUDA_R_16BF:
+      return shared_typed_addr<__nv_bfloat16>(value);
     case CUDA_R_32F:
       return shared_typed_addr<float>(value);
     case CUDA_R_64F:
@@ -106,6 +128,9 @@ inline DType::operator cudaDataType_t() const {
     case kDLUInt:
       if (bits == 8) return CUDA_R_8U;
       break;
+    case kDLBfloat:
+      if (bits == 16) return CUDA_R_16BF;
+      break;
     case kDLFloat:
       if (bits == 16) return CUDA_R_16F;
       if (bits == 32) return CUDA_R_32F;
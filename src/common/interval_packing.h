@@ -0,0 +1,109 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/common/interval_packing.h
+ * \brief Utilities to pack buffers with known live intervals into a single buffer.
+ */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace raf {
+namespace common {
+namespace interval_packing {
+
+/*! \brief A buffer that is live in the inclusive range [start, end] of program points. */
+struct Interval {
+  /*! \brief The first program point at which the buffer is live. */
+  int64_t start;
+  /*! \brief The last program point at which the buffer is live. */
+  int64_t end;
+  /*! \brief The size of the buffer in bytes. */
+  int64_t size;
+  /*! \brief The alignment of the offset of the buffer. */
+  int64_t alignment = 1;
+  /*! \brief The assigned offset, filled by PackIntervals. */
+  int64_t offset = 0;
+};
+
+inline int64_t AlignUp(int64_t value, int64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/*!
+ * \brief Assign offsets to the buffers so that buffers with overlapping live intervals do not
+ * overlap in memory. The buffers are placed from the largest to the smallest, each to the
+ * smallest gap left by the placed buffers it overlaps with (greedy-by-size best-fit).
+ * \param intervals The buffers, whose offsets are updated in place.
+ * \return The size of the single buffer holding all of them.
+ */
+inline int64_t PackIntervals(std::vector<Interval>* intervals) {
+  auto& bufs = *intervals;
+  std::vector<size_t> order(bufs.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return bufs[a].size != bufs[b].size ? bufs[a].size > bufs[b].size
+                                        : bufs[a].start < bufs[b].start;
+  });
+  int64_t peak = 0;
+  std::vector<size_t> placed;
+  for (size_t i : order) {
+    auto& buf = bufs[i];
+    std::vector<size_t> live;
+    for (size_t j : placed) {
+      if (bufs[j].start <= buf.end && buf.start <= bufs[j].end) {
+        live.push_back(j);
+      }
+    }
+    std::sort(live.begin(), live.end(),
+              [&](size_t a, size_t b) { return bufs[a].offset < bufs[b].offset; });
+    int64_t best = -1;
+    int64_t best_gap = 0;
+    int64_t top = 0;
+    for (size_t j : live) {
+      int64_t offset = AlignUp(top, buf.alignment);
+      int64_t gap = bufs[j].offset - offset;
+      if (gap >= buf.size && (best == -1 || gap < best_gap)) {
+        best = offset;
+        best_gap = gap;
+      }
+      top = std::max(top, bufs[j].offset + bufs[j].size);
+    }
+    buf.offset = best == -1 ? AlignUp(top, buf.alignment) : best;
+    peak = std::max(peak, buf.offset + buf.size);
+    placed.push_back(i);
+  }
+  return peak;
+}
+
+/*!
+ * \brief The largest total size of the buffers live at the same program point, which no
+ * packing can go below.
+ * \param intervals The buffers.
+ * \return The lower bound of the packed size.
+ */
+inline int64_t GetLowerBound(const std::vector<Interval>& intervals) {
+  // Sizes allocated and released at each program point.
+  std::map<int64_t, int64_t> delta;
+  for (const auto& buf : intervals) {
+    delta[buf.start] += buf.size;
+    delta[buf.end + 1] -= buf.size;
+  }
+  int64_t live = 0, bound = 0;
+  for (const auto& kv : delta) {
+    live += kv.second;
+    bound = std::max(bound, live);
+  }
+  return bound;
+}
+
+}  // namespace interval_packing
+}  // namespace common
+}  // namespace raf
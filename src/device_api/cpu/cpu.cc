@@ -7,7 +7,17 @@
  * \file src/device_api/cpu/cpu.cc
  * \brief CPU device API
  */
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "raf/device_api.h"
 #include "raf/registry.h"
 
@@ -15,6 +25,69 @@ namespace raf {
 namespace device_api {
 namespace cpu {
 
+/*! \brief The number of the intra-op threads set by the current thread. */
+thread_local int num_threads_ = 0;
+/*! \brief The NUMA node the current thread is bound to, or -1 if it is not bound. */
+thread_local int numa_node_ = -1;
+
+/*! \brief The allocations from this size are placed on the NUMA node of the allocating thread. */
+constexpr int64_t kNumaBindBytes = 1 << 16;
+
+/*! \brief Get the CPUs of a NUMA node from its cpulist in sysfs, e.g., "0-15,32-47". */
+std::vector<int> GetNumaNodeCPUs(int node) {
+  std::vector<int> cpus;
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  std::string range;
+  while (std::getline(file, range, ',')) {
+    std::istringstream is(range);
+    int begin = 0, end = 0;
+    char dash = 0;
+    // The cpulist of a memory-only node is empty.
+    if (!(is >> begin)) {
+      continue;
+    }
+    end = (is >> dash >> end) ? end : begin;
+    for (int i = begin; i <= end; ++i) {
+      cpus.push_back(i);
+    }
+  }
+  return cpus;
+}
+
+/*!
+ * \brief Set the preferred NUMA node of the pages in the range, which takes effect as the pages
+ * are touched for the first time. A failure only loses the locality, so it is ignored.
+ */
+void BindMemoryToNode(void* ptr, int64_t nbytes, int node) {
+#ifdef __linux__
+  constexpr int kMpolPreferred = 1;
+  constexpr int kMaskBits = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> mask(node / kMaskBits + 1, 0);
+  mask[node / kMaskBits] = 1UL << (node % kMaskBits);
+  syscall(SYS_mbind, ptr, nbytes, kMpolPreferred, mask.data(), mask.size() * kMaskBits + 1, 0);
+#endif
+}
+
+/*!
+ * \brief Rebuild the TVM thread pool of the calling thread. On a bound NUMA node, the workers
+ * share the cores of the node, so the pages they touch first are placed on the node.
+ */
+void ConfigThreadPool(int num_threads) {
+  static const auto* fconfig = tvm::runtime::Registry::Get("runtime.config_threadpool");
+  CHECK(fconfig != nullptr) << "The TVM thread pool is not available";
+  if (numa_node_ < 0) {
+    // Mode 1 binds the workers to the big cores.
+    (*fconfig)(1, num_threads);
+    return;
+  }
+  tvm::runtime::Array<tvm::runtime::String> cpus;
+  for (int cpu : GetNumaNodeCPUs(numa_node_)) {
+    cpus.push_back(std::to_string(cpu));
+  }
+  // Mode -3 lets each worker run on any of the given cores.
+  (*fconfig)(-3, num_threads > 0 ? num_threads : static_cast<int>(cpus.size()), cpus);
+}
+
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   CPUDeviceAPI() = default;
@@ -27,6 +100,11 @@ class CPUDeviceAPI final : public DeviceAPI {
 
   void* AllocMemory(int64_t nbytes, int64_t alignment) override {
     void* ptr = nullptr;
+    bool bind = numa_node_ >= 0 && nbytes >= kNumaBindBytes;
+    if (bind) {
+      // Align to pages, so the binding does not move the pages of the other allocations.
+      alignment = std::max<int64_t>(alignment, sysconf(_SC_PAGESIZE));
+    }
     // TODO(@junrushao1994): do not throw like this
     // TODO(@junrushao1994): recover the SGX and Android part
 #if _MSC_VER
@@ -39,6 +117,9 @@ class CPUDeviceAPI final : public DeviceAPI {
     if (ret != 0) {
       throw std::bad_alloc();
     }
+    if (bind) {
+      BindMemoryToNode(ptr, nbytes, numa_node_);
+    }
 #endif
     return ptr;
   }
@@ -119,6 +200,10 @@ class CPUDeviceAPI final : public DeviceAPI {
     throw;
   }
 
+  bool QueryEvent(void* event) override {
+    throw;
+  }
+
   void SetDevice(const int device_id) override {
     throw;
   }
@@ -128,7 +213,59 @@ class CPUDeviceAPI final : public DeviceAPI {
   }
 };
 
+void SetNumThreads(int num_threads) {
+  num_threads = std::max(num_threads, 0);
+  if (num_threads == num_threads_) {
+    return;
+  }
+  // The TVM thread pool is owned by the calling thread, so each VM running on its own thread
+  // gets its own workers.
+  ConfigThreadPool(num_threads);
+  num_threads_ = num_threads;
+}
+
+int GetNumThreads() {
+  return num_threads_;
+}
+
+int GetNumNumaNodes() {
+  int num_nodes = 0;
+  while (std::ifstream("/sys/devices/system/node/node" + std::to_string(num_nodes) + "/cpulist")) {
+    ++num_nodes;
+  }
+  return std::max(num_nodes, 1);
+}
+
+void BindToNumaNode(int node) {
+  if (node == numa_node_) {
+    return;
+  }
+  CHECK(node >= 0 && node < GetNumNumaNodes()) << "Invalid NUMA node " << node;
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : GetNumaNodeCPUs(node)) {
+    CPU_SET(cpu, &cpuset);
+  }
+  CHECK_EQ(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset), 0)
+      << "Failed to bind the thread to NUMA node " << node;
+#else
+  LOG(WARNING) << "Binding to NUMA nodes is only supported on Linux";
+#endif
+  numa_node_ = node;
+  ConfigThreadPool(num_threads_);
+}
+
+int GetNumaNode() {
+  return numa_node_;
+}
+
 RAF_REGISTER_GLOBAL("raf.device_api._make.cpu").set_body_typed(CPUDeviceAPI::make);
+RAF_REGISTER_GLOBAL("raf.device_api.cpu.SetNumThreads").set_body_typed(SetNumThreads);
+RAF_REGISTER_GLOBAL("raf.device_api.cpu.GetNumThreads").set_body_typed(GetNumThreads);
+RAF_REGISTER_GLOBAL("raf.device_api.cpu.GetNumNumaNodes").set_body_typed(GetNumNumaNodes);
+RAF_REGISTER_GLOBAL("raf.device_api.cpu.BindToNumaNode").set_body_typed(BindToNumaNode);
+RAF_REGISTER_GLOBAL("raf.device_api.cpu.GetNumaNode").set_body_typed(GetNumaNode);
 
 }  // namespace cpu
 }  // namespace device_api
@@ -8,6 +8,8 @@
  * \brief CUDA device API
  */
 #include <tvm/runtime/device_api.h>
+#include <map>
+#include <mutex>
 #include "raf/op.h"
 #include "raf/device_api.h"
 #include "raf/registry.h"
@@ -45,6 +47,21 @@ class CUDADeviceAPI final : public DeviceAPI {
     CUDA_CALL_IF_DRIVER_IS_LOADED(cudaFree(ptr));
   }
 
+  void* AllocManagedMemory(int64_t nbytes, int64_t alignment) override {
+    CUDA_CALL(cudaSetDevice(device_id_));
+    void* ptr = nullptr;
+    // cudaMallocManaged aligns to at least 256 bytes.
+    CHECK_EQ(256 % alignment, 0) << "Managed memory does not support alignment " << alignment;
+    CUDA_CALL(cudaMallocManaged(&ptr, nbytes, cudaMemAttachGlobal));
+    // Prefer the device, so the pages only move to the host under memory pressure.
+    CUDA_CALL(cudaMemAdvise(ptr, nbytes, cudaMemAdviseSetPreferredLocation, device_id_));
+    return ptr;
+  }
+
+  void PrefetchMemory(void* ptr, int64_t nbytes, void* stream) override {
+    CUDA_CALL(cudaMemPrefetchAsync(ptr, nbytes, device_id_, static_cast<cudaStream_t>(stream)));
+  }
+
 #if CUDA_VERSION >= 11030
   void SetDevice(const int dev_id) override {
     device_id_ = dev_id;
@@ -71,6 +88,19 @@ class CUDADeviceAPI final : public DeviceAPI {
     return {used, allocated};
   }
 
+  int64_t ReleaseCachedMemory() override {
+    cudaMemPool_t mem_pool;
+    CUDA_CALL(cudaSetDevice(device_id_));
+    CUDA_CALL(cudaDeviceGetDefaultMemPool(&mem_pool, device_id_));
+    // The memory freed by cudaFreeAsync returns to the pool only when the streams reach the frees.
+    CUDA_CALL(cudaDeviceSynchronize());
+    cuuint64_t before, after;
+    CUDA_CALL(cudaMemPoolGetAttribute(mem_pool, cudaMemPoolAttrReservedMemCurrent, &before));
+    CUDA_CALL(cudaMemPoolTrimTo(mem_pool, 0));
+    CUDA_CALL(cudaMemPoolGetAttribute(mem_pool, cudaMemPoolAttrReservedMemCurrent, &after));
+    return before - after;
+  }
+
   void* AllocMemoryAsync(int64_t nbytes, void* stream,
                          int64_t alignment = kDefaultMemoryAlignment) {
     static auto cuda_pool = GetCUDAMemoryPool(device_id_);
@@ -133,8 +163,8 @@ class CUDADeviceAPI final : public DeviceAPI {
       if (from->device.device_id == to->device.device_id) {
         HandleCopy(from_data_ptr, to_data_ptr, nbytes, cudaMemcpyDeviceToDevice, cu_stream);
       } else {
-        cudaMemcpyPeerAsync(to_data_ptr, to->device.device_id, from_data_ptr,
-                            from->device.device_id, nbytes, cu_stream);
+        PeerCopy(from_data_ptr, from->device.device_id, to_data_ptr, to->device.device_id, nbytes,
+                 cu_stream);
       }
     } else if (from_dev_type == kDLCUDA && to_dev_type == kDLCPU) {
       // GPU to CPU.
@@ -159,6 +189,30 @@ class CUDADeviceAPI final : public DeviceAPI {
     return ret;
   }
 
+  void* CreateStreamWithPriority(const Device& dev, int priority) override {
+    CHECK_EQ(dev.device_type(), DevType::kCUDA());
+    CUDA_CALL(cudaSetDevice(dev.device_id()));
+    // CUDA uses lower numbers for higher priorities, in range [greatest, least].
+    int least = 0, greatest = 0;
+    CUDA_CALL(cudaDeviceGetStreamPriorityRange(&least, &greatest));
+    int cuda_priority = std::max(greatest, std::min(least, -priority));
+    cudaStream_t ret = nullptr;
+    CUDA_CALL(cudaStreamCreateWithPriority(&ret, cudaStreamDefault, cuda_priority));
+    return ret;
+  }
+
+  void* CreateStreamWithFlags(const Device& dev, int priority, bool non_blocking) override {
+    CHECK_EQ(dev.device_type(), DevType::kCUDA());
+    CUDA_CALL(cudaSetDevice(dev.device_id()));
+    int least = 0, greatest = 0;
+    CUDA_CALL(cudaDeviceGetStreamPriorityRange(&least, &greatest));
+    int cuda_priority = std::max(greatest, std::min(least, -priority));
+    cudaStream_t ret = nullptr;
+    CUDA_CALL(cudaStreamCreateWithPriority(
+        &ret, non_blocking ? cudaStreamNonBlocking : cudaStreamDefault, cuda_priority));
+    return ret;
+  }
+
   void FreeStream(const Device& dev, void* stream) override {
     CHECK_EQ(dev.device_type(), DevType::kCUDA());
     CUDA_CALL(cudaSetDevice(dev.device_id()));
@@ -224,6 +278,16 @@ class CUDADeviceAPI final : public DeviceAPI {
     CUDA_CALL(cudaEventSynchronize(static_cast<cudaEvent_t>(event)));
   }
 
+  bool QueryEvent(void* event) override {
+    CHECK(event != nullptr) << "Cannot query a null event";
+    cudaError_t status = cudaEventQuery(static_cast<cudaEvent_t>(event));
+    if (status == cudaErrorNotReady) {
+      return false;
+    }
+    CUDA_CALL(status);
+    return true;
+  }
+
   static void* make() {
     return new CUDADeviceAPI();
   }
@@ -240,6 +304,92 @@ class CUDADeviceAPI final : public DeviceAPI {
     }
   }
 
+  /*! \brief The resources to pipeline the chunks of the peer copies from a device. */
+  struct PeerCopyPipeline {
+    cudaStream_t stream = nullptr;
+    cudaEvent_t fork = nullptr;
+    cudaEvent_t join = nullptr;
+  };
+
+  /*!
+   * \brief Enable the access from dev_id to the memory of peer_id once per pair, so that the peer
+   * copies go through NVLink or PCIe directly instead of being staged in the host memory.
+   */
+  static void EnablePeerAccess(int dev_id, int peer_id) {
+    static std::mutex mu;
+    static std::map<std::pair<int, int>, bool> enabled;
+    std::lock_guard<std::mutex> lock(mu);
+    auto key = std::make_pair(dev_id, peer_id);
+    if (enabled.count(key)) {
+      return;
+    }
+    int can_access = 0;
+    CUDA_CALL(cudaDeviceCanAccessPeer(&can_access, dev_id, peer_id));
+    if (can_access) {
+      CUDA_CALL(cudaSetDevice(dev_id));
+      cudaError_t status = cudaDeviceEnablePeerAccess(peer_id, 0);
+      if (status == cudaErrorPeerAccessAlreadyEnabled) {
+        // Enabled by others, e.g., NCCL. Clear the sticky error.
+        cudaGetLastError();
+      } else {
+        CUDA_CALL(status);
+      }
+    }
+    enabled[key] = can_access;
+  }
+
+  /*! \brief Get the auxiliary stream and events of the peer copies from dev_id. */
+  static PeerCopyPipeline GetPeerCopyPipeline(int dev_id) {
+    static std::mutex mu;
+    static std::map<int, PeerCopyPipeline> pipelines;
+    std::lock_guard<std::mutex> lock(mu);
+    auto it = pipelines.find(dev_id);
+    if (it != pipelines.end()) {
+      return it->second;
+    }
+    PeerCopyPipeline pipeline;
+    CUDA_CALL(cudaSetDevice(dev_id));
+    CUDA_CALL(cudaStreamCreateWithFlags(&pipeline.stream, cudaStreamNonBlocking));
+    CUDA_CALL(cudaEventCreateWithFlags(&pipeline.fork, cudaEventDisableTiming));
+    CUDA_CALL(cudaEventCreateWithFlags(&pipeline.join, cudaEventDisableTiming));
+    pipelines[dev_id] = pipeline;
+    return pipeline;
+  }
+
+  /*!
+   * \brief Copy between two GPUs. A large copy on a non-default stream is split into chunks,
+   * which alternate between the given stream and an auxiliary one so that both copy engines
+   * are busy. The given stream waits for the auxiliary one, so the copy still looks like a
+   * single asynchronous operation on the given stream to its consumers.
+   */
+  void PeerCopy(const void* from, int from_id, void* to, int to_id, size_t nbytes,
+                cudaStream_t cu_stream) {
+    EnablePeerAccess(from_id, to_id);
+    EnablePeerAccess(to_id, from_id);
+    CUDA_CALL(cudaSetDevice(from_id));
+    if (cu_stream == nullptr || nbytes <= kPeerCopyChunkBytes) {
+      CUDA_CALL(cudaMemcpyPeerAsync(to, to_id, from, from_id, nbytes, cu_stream));
+      return;
+    }
+    auto pipeline = GetPeerCopyPipeline(from_id);
+    CUDA_CALL(cudaSetDevice(from_id));
+    CUDA_CALL(cudaEventRecord(pipeline.fork, cu_stream));
+    CUDA_CALL(cudaStreamWaitEvent(pipeline.stream, pipeline.fork, 0));
+    cudaStream_t streams[2] = {cu_stream, pipeline.stream};
+    const size_t chunk = kPeerCopyChunkBytes;
+    for (size_t offset = 0, i = 0; offset < nbytes; offset += chunk, ++i) {
+      size_t size = std::min(chunk, nbytes - offset);
+      CUDA_CALL(cudaMemcpyPeerAsync(static_cast<char*>(to) + offset, to_id,
+                                    static_cast<const char*>(from) + offset, from_id, size,
+                                    streams[i % 2]));
+    }
+    CUDA_CALL(cudaEventRecord(pipeline.join, pipeline.stream));
+    CUDA_CALL(cudaStreamWaitEvent(cu_stream, pipeline.join, 0));
+  }
+
+  /*! \brief The chunk size of the pipelined peer copies. */
+  static constexpr size_t kPeerCopyChunkBytes = 4 << 20;
+
   int device_id_;
   // using cuda default stream if stream is not set explicitly
   void* stream_ = nullptr;
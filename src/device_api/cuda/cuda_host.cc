@@ -8,6 +8,9 @@
  * \brief CUDA host (CPU pinned memory) device API.
  */
 #include <tvm/runtime/device_api.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "raf/device_api.h"
 #include "raf/registry.h"
 #include "../../common/cuda_utils.h"
@@ -16,11 +19,22 @@ namespace raf {
 namespace device_api {
 namespace cuda_host {
 
+/*!
+ * \brief The CUDA host device API. Pinned memory is pooled by size class, because cudaMallocHost
+ * and cudaFreeHost are slow and synchronize the device. A freed buffer is cached for the next
+ * request of its size class unless the idle bytes would exceed the cap, which is set by
+ * RAF_PINNED_POOL_SIZE_MB (1024 by default, 0 to disable pooling).
+ */
 class CUDAHostDeviceAPI final : public DeviceAPI {
  public:
-  CUDAHostDeviceAPI() = default;
+  CUDAHostDeviceAPI() {
+    const char* val = getenv("RAF_PINNED_POOL_SIZE_MB");
+    max_cached_bytes_ = (val == nullptr ? 1024 : atol(val)) * 1048576;
+  }
 
-  ~CUDAHostDeviceAPI() = default;
+  ~CUDAHostDeviceAPI() {
+    ReleaseCached();
+  }
 
   int GetDeviceCount() override {
     int count = 0;
@@ -29,13 +43,45 @@ class CUDAHostDeviceAPI final : public DeviceAPI {
   }
 
   void* AllocMemory(int64_t nbytes, int64_t alignment) override {
-    void* ptr = nullptr;
     CHECK_EQ(512 % alignment, 0);
-    CUDA_CALL(cudaMallocHost(&ptr, nbytes));
+    int64_t size_class = GetSizeClass(nbytes);
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = free_buffers_.find(size_class);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= size_class;
+      return ptr;
+    }
+    void* ptr = nullptr;
+    if (cudaMallocHost(&ptr, size_class) != cudaSuccess) {
+      // Return the idle buffers to the driver and retry.
+      cudaGetLastError();
+      ReleaseCached();
+      CUDA_CALL(cudaMallocHost(&ptr, size_class));
+    }
+    buffer_sizes_[ptr] = size_class;
     return ptr;
   }
 
+  int64_t ReleaseCachedMemory() override {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t nbytes = cached_bytes_;
+    ReleaseCached();
+    return nbytes;
+  }
+
   void FreeMemory(void* ptr) override {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = buffer_sizes_.find(ptr);
+    CHECK(it != buffer_sizes_.end()) << "The pinned memory is not allocated by CUDAHostDeviceAPI";
+    int64_t size_class = it->second;
+    if (cached_bytes_ + size_class <= max_cached_bytes_) {
+      free_buffers_[size_class].push_back(ptr);
+      cached_bytes_ += size_class;
+      return;
+    }
+    buffer_sizes_.erase(it);
     CUDA_CALL_IF_DRIVER_IS_LOADED(cudaFreeHost(ptr));
   }
 
@@ -104,9 +150,55 @@ class CUDAHostDeviceAPI final : public DeviceAPI {
     throw;
   }
 
+  bool QueryEvent(void* event) override {
+    throw;
+  }
+
   static void* make() {
     return new CUDAHostDeviceAPI();
   }
+
+ private:
+  /*!
+   * \brief Get the size class of a request, which is the next power of two no less than 4KB for
+   * requests up to 64MB, and the next multiple of 2MB for larger ones.
+   */
+  static int64_t GetSizeClass(int64_t nbytes) {
+    constexpr int64_t kMinBytes = 4096;
+    constexpr int64_t kMaxPowerOfTwoBytes = 64 << 20;
+    constexpr int64_t kLargeRoundBytes = 2 << 20;
+    if (nbytes > kMaxPowerOfTwoBytes) {
+      return (nbytes + kLargeRoundBytes - 1) / kLargeRoundBytes * kLargeRoundBytes;
+    }
+    int64_t size = kMinBytes;
+    while (size < nbytes) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  /*! \brief Free the cached buffers. The caller must hold the lock unless destructing. */
+  void ReleaseCached() {
+    for (auto& kv : free_buffers_) {
+      for (void* ptr : kv.second) {
+        buffer_sizes_.erase(ptr);
+        CUDA_CALL_IF_DRIVER_IS_LOADED(cudaFreeHost(ptr));
+      }
+    }
+    free_buffers_.clear();
+    cached_bytes_ = 0;
+  }
+
+  /*! \brief The size class of each buffer allocated from the driver and not freed yet. */
+  std::unordered_map<void*, int64_t> buffer_sizes_;
+  /*! \brief The idle buffers of each size class. */
+  std::unordered_map<int64_t, std::vector<void*>> free_buffers_;
+  /*! \brief The bytes of the idle buffers. */
+  int64_t cached_bytes_ = 0;
+  /*! \brief The max bytes of the idle buffers. */
+  int64_t max_cached_bytes_ = 0;
+  /*! \brief The mutex to access the buffers. */
+  std::mutex mu_;
 };
 
 RAF_REGISTER_GLOBAL("raf.device_api._make.cuda_host").set_body_typed(CUDAHostDeviceAPI::make);
@@ -0,0 +1,191 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/distributed/common/checkpoint.cc
+ * \brief Implementation of the sharded checkpoints.
+ */
+#include <dmlc/memory_io.h>
+#include <tvm/runtime/ndarray.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include "raf/checkpoint.h"
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+#include "raf/serialization.h"
+#include "raf/stream_pool.h"
+
+namespace raf {
+namespace distributed {
+namespace checkpoint {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+using stream_pool::Stream;
+
+/*! \brief Magic number for the checkpoint shard format. */
+constexpr uint64_t kCheckpointShardMagic = 0xD225DE2F42141521;
+
+CheckpointWriter* CheckpointWriter::Get() {
+  // It is never destroyed, as the background thread may still be writing at exit.
+  static CheckpointWriter* inst = new CheckpointWriter();
+  return inst;
+}
+
+std::vector<Value> CheckpointWriter::Stage(const std::vector<Value>& values) {
+  std::vector<Value> staged(values.size());
+  std::vector<std::shared_ptr<Stream>> streams;
+  for (size_t i = 0; i < values.size(); ++i) {
+    const auto* tensor = values[i].as<TensorValueObj>();
+    if (tensor == nullptr) {
+      // The other values are immutable.
+      staged[i] = values[i];
+      continue;
+    }
+    const DLTensor* src = tensor->tensor.operator->();
+    CHECK(tvm::runtime::IsContiguous(*src)) << "Only contiguous states can be checkpointed";
+    Device dev = src->device;
+    bool on_cuda = dev.device_type() == DevType::kCUDA();
+    // The pinned buffers are copied to at the full bandwidth asynchronously, and they are
+    // reused by the later checkpoints via the pool.
+    Device host = on_cuda ? Device(DevType::kCUDAHost(), 0) : Device(DevType::kCPU(), 0);
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    auto mem = memory_pool::Memory::Alloc(host, tvm::runtime::GetDataSize(*src));
+    staged[i] = TensorValue::Assemble(host, DType(src->dtype), shape, {}, mem->data, mem);
+    DLTensor* dst = Downcast<TensorValue>(staged[i])->tensor.operator->();
+    if (!on_cuda) {
+      DeviceAPI::Get(dev.device_type())->CopyDataFromTo(const_cast<DLTensor*>(src), dst);
+      continue;
+    }
+    auto api = DeviceAPI::Get(dev.device_type());
+    auto stream = Stream::Get(dev, stream_pool::kMemCpyCudaToCpu, 0);
+    if (std::find(streams.begin(), streams.end(), stream) == streams.end()) {
+      // The states may still be written by the last training step.
+      api->WaitDevice(dev);
+      streams.push_back(stream);
+    }
+    api->CopyDataFromTo(const_cast<DLTensor*>(src), dst, stream->data());
+  }
+  for (const auto& stream : streams) {
+    DeviceAPI::Get(DevType::kCUDA())->WaitStream(stream->data());
+  }
+  return staged;
+}
+
+int64_t CheckpointWriter::Save(const std::string& path, const std::string& meta,
+                               const std::vector<std::string>& names,
+                               const std::vector<Value>& values) {
+  CHECK_EQ(names.size(), values.size()) << "Mismatched number of names and states";
+  CheckpointShard shard{0, path, meta, names, Stage(values)};
+  std::lock_guard<std::mutex> lock(mu_);
+  shard.id = next_id_++;
+  queue_.push_back(std::move(shard));
+  if (!worker_started_) {
+    std::thread(&CheckpointWriter::Run, this).detach();
+    worker_started_ = true;
+  }
+  cv_.notify_all();
+  return queue_.back().id;
+}
+
+void CheckpointWriter::Wait(int64_t id) {
+  std::unique_lock<std::mutex> lock(mu_);
+  int64_t target = id < 0 ? next_id_ : id + 1;
+  cv_.wait(lock, [this, target]() { return done_id_ >= target; });
+  std::string error;
+  for (auto it = errors_.begin(); it != errors_.end();) {
+    if (it->first < target && (id < 0 || it->first == id)) {
+      error = it->second;
+      it = errors_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  lock.unlock();
+  CHECK(error.empty()) << "Failed to write the checkpoint: " << error;
+}
+
+void CheckpointWriter::Run() {
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    cv_.wait(lock, [this]() { return !queue_.empty(); });
+    CheckpointShard shard = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    std::string error;
+    try {
+      std::string meta;
+      dmlc::MemoryStringStream strm(&meta);
+      strm.Write(kCheckpointShardMagic);
+      // The offset of the data region is patched after the metadata is written.
+      size_t data_offset_pos = meta.size();
+      strm.Write(static_cast<uint64_t>(0));
+      strm.Write(shard.meta);
+      strm.Write(shard.names);
+      std::vector<Value> blobs;
+      ir::serialization::SaveMappedValues(&strm, shard.values, &blobs);
+      std::string tmp_path = shard.path + ".tmp." + std::to_string(getpid());
+      ir::serialization::WriteMappedFile(tmp_path, &meta, data_offset_pos, blobs);
+      CHECK_EQ(std::rename(tmp_path.c_str(), shard.path.c_str()), 0)
+          << "Cannot rename " << tmp_path << " to " << shard.path;
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    // Release the host buffers before the waiters are notified.
+    shard.values.clear();
+    lock.lock();
+    if (!error.empty()) {
+      errors_[shard.id] = error;
+    }
+    done_id_ = shard.id + 1;
+    cv_.notify_all();
+  }
+}
+
+void LoadShard(const std::string& path, std::string* meta, std::vector<std::string>* names,
+               std::vector<Value>* values) {
+  auto file = std::make_shared<ir::serialization::MappedFile>(path);
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(file->data()), file->size());
+  uint64_t magic, data_offset;
+  CHECK(strm.Read(&magic) && magic == kCheckpointShardMagic) << "Invalid checkpoint " << path;
+  CHECK(strm.Read(&data_offset) && data_offset <= file->size()) << "Invalid checkpoint " << path;
+  CHECK(strm.Read(meta) && strm.Read(names)) << "Invalid checkpoint " << path;
+  *values = ir::serialization::LoadMappedValues(&strm, file, file->data() + data_offset);
+  CHECK_EQ(names->size(), values->size()) << "Invalid checkpoint " << path;
+}
+
+RAF_REGISTER_GLOBAL("raf.distributed.SaveCheckpointShard")
+    .set_body_typed([](std::string path, std::string meta, Array<String> names,
+                       Array<Value> values) {
+      return CheckpointWriter::Get()->Save(path, meta,
+                                           std::vector<std::string>(names.begin(), names.end()),
+                                           std::vector<Value>(values.begin(), values.end()));
+    });
+
+RAF_REGISTER_GLOBAL("raf.distributed.WaitCheckpoint").set_body_typed([](int64_t id) {
+  CheckpointWriter::Get()->Wait(id);
+});
+
+RAF_REGISTER_GLOBAL("raf.distributed.LoadCheckpointShard")
+    .set_body_typed([](std::string path) -> Array<ObjectRef> {
+      std::string meta;
+      std::vector<std::string> names;
+      std::vector<Value> values;
+      LoadShard(path, &meta, &names, &values);
+      Map<String, Value> states;
+      for (size_t i = 0; i < names.size(); ++i) {
+        states.Set(names[i], values[i]);
+      }
+      return {String(meta), states};
+    });
+
+}  // namespace checkpoint
+}  // namespace distributed
+}  // namespace raf
@@ -8,6 +8,8 @@
  * \brief Implementation of Communicator.
  */
 
+#include <algorithm>
+#include <unordered_map>
 #include "raf/communicator.h"
 
 namespace raf {
@@ -93,6 +95,55 @@ uint64_t Communicator::GetHostID() {
   return hash;
 }
 
+std::vector<int64_t> Communicator::OrderRanksByTopology(const CommunicatorObj* comm,
+                                                        const std::vector<int64_t>& ranks) {
+  const auto& topo = comm->topology;
+  if (topo.size() != static_cast<size_t>(comm->size)) {
+    return ranks;
+  }
+  // NVLink is preferred over PCIe within a NUMA node, which is preferred over crossing the nodes.
+  auto link_score = [&topo](int64_t a, int64_t b) {
+    int32_t dev = topo[b].device_id;
+    if (dev >= 0 && dev < 64 && ((topo[a].nvlink_mask >> dev) & 1)) {
+      return 2;
+    }
+    return topo[a].numa_node >= 0 && topo[a].numa_node == topo[b].numa_node ? 1 : 0;
+  };
+  std::vector<uint64_t> hosts;
+  std::unordered_map<uint64_t, std::vector<int64_t>> ranks_of_host;
+  for (auto rank : ranks) {
+    uint64_t host = comm->host_ids.at(rank);
+    if (ranks_of_host.count(host) == 0) {
+      hosts.push_back(host);
+    }
+    ranks_of_host[host].push_back(rank);
+  }
+  std::vector<int64_t> ordered;
+  for (auto host : hosts) {
+    // Start from a rank close to a NIC, which links this host to the neighbor hosts in the ring,
+    // and then greedily append the unvisited rank with the fastest link to the last one.
+    auto& group = ranks_of_host[host];
+    auto start = std::find_if(group.begin(), group.end(),
+                              [&topo](int64_t rank) { return topo[rank].nic_affinity; });
+    std::vector<bool> visited(group.size(), false);
+    size_t curr = start != group.end() ? start - group.begin() : 0;
+    for (size_t n = 0; n < group.size(); ++n) {
+      visited[curr] = true;
+      ordered.push_back(group[curr]);
+      int64_t last = group[curr];
+      int best_score = -1;
+      for (size_t i = 0; i < group.size(); ++i) {
+        int score = visited[i] ? -1 : link_score(last, group[i]);
+        if (score > best_score) {
+          best_score = score;
+          curr = i;
+        }
+      }
+    }
+  }
+  return ordered;
+}
+
 VoidCommunicator VoidCommunicator::make(Value rank_list) {
   auto obj = make_object<VoidCommunicatorObj>();
 
@@ -173,6 +224,21 @@ void SetGlobalLocalSize(int local_size) {
   GetGlobalCommunicator()->local_size = local_size;
 }
 
+void RebuildCommunicators(int generation, int size, int rank, int local_size, int local_rank) {
+  CHECK(IsElasticMode()) << "Communicators can only be rebuilt in the elastic mode";
+  auto comm = GetGlobalCommunicator();
+  CHECK(comm->IsInstance<communicator::VoidCommunicatorObj>())
+      << "Only the world of VoidCommunicator can be changed";
+  CHECK_GT(generation, CommunicatorPool::Get()->generation())
+      << "The generation of the new world must be greater than the current one";
+  CHECK(rank >= 0 && rank < size) << "Invalid rank " << rank << " of world size " << size;
+  CommunicatorPool::Get()->Rebuild(generation);
+  SetGlobalSize(size);
+  SetGlobalRank(rank);
+  SetGlobalLocalSize(local_size);
+  SetGlobalLocalRank(local_rank);
+}
+
 RAF_REGISTER_GLOBAL("raf.distributed.communicator._make.void")
     .set_body_typed(VoidCommunicator::make);
 
@@ -180,6 +246,7 @@ RAF_REGISTER_GLOBAL("raf.distributed.RemoveCommunicator").set_body_typed([]() {
   CommunicatorPool::Get()->Remove();
 });
 
+RAF_REGISTER_GLOBAL("raf.distributed.RebuildCommunicators").set_body_typed(RebuildCommunicators);
 RAF_REGISTER_GLOBAL("raf.distributed.GetGlobalCommunicator").set_body_typed(GetGlobalCommunicator);
 RAF_REGISTER_GLOBAL("raf.distributed.SetDefaultCommunicator")
     .set_body_typed(SetDefaultCommunicator);
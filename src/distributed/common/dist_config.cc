@@ -35,6 +35,11 @@ void ZeroOpt(int opt_level) {
   DistConfig::Global()->zero_opt_level = opt_level;
 }
 
+void ZeroPrefetchDepth(int depth) {
+  CHECK_GE(depth, 0) << "The prefetch depth must be non-negative, but got " << depth;
+  DistConfig::Global()->zero_prefetch_depth = depth;
+}
+
 void EnableAutoDPProfiling(bool enable_auto_dp_profiling) {
   DistConfig::Global()->enable_auto_dp_profiling = enable_auto_dp_profiling;
 }
@@ -47,14 +52,68 @@ void AutoDPProfilingEndIter(int auto_dp_profiling_end_iter) {
   DistConfig::Global()->auto_dp_profiling_end_iter = auto_dp_profiling_end_iter;
 }
 
+void GroupBucketSize(int64_t group_bucket_size) {
+  DistConfig::Global()->group_bucket_size = group_bucket_size;
+}
+
+void EnableHierarchicalAllreduce(bool enable) {
+  DistConfig::Global()->enable_hierarchical_allreduce = enable;
+}
+
+void EnableTopologyAwareRing(bool enable) {
+  DistConfig::Global()->enable_topology_aware_ring = enable;
+}
+
+void EnableCollectiveCoalescing(bool enable) {
+  DistConfig::Global()->enable_collective_coalescing = enable;
+}
+
+void AllreduceCompression(std::string method) {
+  CHECK(method == "none" || method == "fp16" || method == "bf16" || method == "topk")
+      << "Invalid allreduce compression " << method << ", candidates are none, fp16, bf16 and topk";
+  DistConfig::Global()->allreduce_compression = method;
+}
+
+void AllreduceCompressionMinElements(int64_t min_elements) {
+  DistConfig::Global()->allreduce_compression_min_elements = min_elements;
+}
+
+void AllreduceTopkRatio(double ratio) {
+  CHECK(ratio > 0 && ratio <= 1) << "The top-k ratio must be in (0, 1], but got " << ratio;
+  DistConfig::Global()->allreduce_topk_ratio = ratio;
+}
+
+void EnableElastic(bool enable) {
+  DistConfig::Global()->enable_elastic = enable;
+}
+
+namespace communicator {
+bool IsElasticMode() {
+  return DistConfig::Global()->enable_elastic;
+}
+}  // namespace communicator
+
 RAF_REGISTER_GLOBAL("raf.distributed.GlobalDistConfig").set_body_typed(DistConfig::Global);
 RAF_REGISTER_GLOBAL("raf.distributed.EnableDataParallel").set_body_typed(EnableDataParallel);
 RAF_REGISTER_GLOBAL("raf.distributed.ZeroOpt").set_body_typed(ZeroOpt);
+RAF_REGISTER_GLOBAL("raf.distributed.ZeroPrefetchDepth").set_body_typed(ZeroPrefetchDepth);
 RAF_REGISTER_GLOBAL("raf.distributed.EnableAutoDPProfiling").set_body_typed(EnableAutoDPProfiling);
 RAF_REGISTER_GLOBAL("raf.distributed.AutoDPProfilingStartIter")
     .set_body_typed(AutoDPProfilingStartIter);
 RAF_REGISTER_GLOBAL("raf.distributed.AutoDPProfilingEndIter")
     .set_body_typed(AutoDPProfilingEndIter);
+RAF_REGISTER_GLOBAL("raf.distributed.GroupBucketSize").set_body_typed(GroupBucketSize);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableHierarchicalAllreduce")
+    .set_body_typed(EnableHierarchicalAllreduce);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableTopologyAwareRing")
+    .set_body_typed(EnableTopologyAwareRing);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableCollectiveCoalescing")
+    .set_body_typed(EnableCollectiveCoalescing);
+RAF_REGISTER_GLOBAL("raf.distributed.AllreduceCompression").set_body_typed(AllreduceCompression);
+RAF_REGISTER_GLOBAL("raf.distributed.AllreduceCompressionMinElements")
+    .set_body_typed(AllreduceCompressionMinElements);
+RAF_REGISTER_GLOBAL("raf.distributed.AllreduceTopkRatio").set_body_typed(AllreduceTopkRatio);
+RAF_REGISTER_GLOBAL("raf.distributed.EnableElastic").set_body_typed(EnableElastic);
 
 RAF_REGISTER_OBJECT_REFLECT(DistConfigObj);
 
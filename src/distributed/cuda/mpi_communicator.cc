@@ -15,12 +15,34 @@ namespace distributed {
 namespace communicator {
 
 MPICommunicatorObj::~MPICommunicatorObj() {
-  MPI_CALL(MPI_Finalize());
+  if (!parent_comm.defined()) {
+    MPI_CALL(MPI_Finalize());
+    return;
+  }
+  int finalized = 0;
+  MPI_CALL(MPI_Finalized(&finalized));
+  if (!finalized && mpi_comm != MPI_COMM_SELF && mpi_comm != MPI_COMM_NULL) {
+    MPI_CALL(MPI_Comm_free(&mpi_comm));
+  }
 }
 
 MPICommunicator MPICommunicator::make(Value rank_list) {
-  CHECK(!rank_list.defined()) << "MPICommunicator doesn't support creating sub-communicators yet.";
   auto obj = make_object<MPICommunicatorObj>();
+  if (rank_list.defined()) {
+    // Split the world by the groups of the rank list, which is the same on all the ranks, and the
+    // ranks not in any group are on their own.
+    auto global_comm = GetGlobalCommunicator();
+    CHECK(global_comm->IsInstance<MPICommunicatorObj>())
+        << "The MPI sub-communicators require the global MPI communicator";
+    InitSubCommunicator(obj.get(), rank_list, global_comm);
+    int color = obj->group_id >= 0 ? obj->group_id : MPI_UNDEFINED;
+    MPI_CALL(MPI_Comm_split(MPI_COMM_WORLD, color, obj->rank, &obj->mpi_comm));
+    if (obj->mpi_comm == MPI_COMM_NULL) {
+      obj->mpi_comm = MPI_COMM_SELF;
+    }
+    obj->parent_comm = global_comm;
+    return MPICommunicator(obj);
+  }
 
   int initialized = 0;
   MPI_CALL(MPI_Initialized(&initialized));
@@ -0,0 +1,80 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/distributed/cuda/nccl_clock_sync.cc
+ * \brief The barrier-based clock synchronization of the ranks over the NCCL communicator, which
+ * aligns the profiler traces of the ranks.
+ */
+#include <algorithm>
+#include "raf/nccl_communicator.h"
+#include "raf/profiler.h"
+#include "../../common/cuda_utils.h"
+
+namespace raf {
+namespace distributed {
+namespace communicator {
+
+/*!
+ * \brief Estimate the profiler clock of each rank minus the one of rank 0 of the global NCCL
+ * communicator. Every round, all ranks leave an allreduce barrier at about the same time, and
+ * read their clocks; the offset is the median over the rounds, which filters the rounds that a
+ * rank is descheduled when it leaves the barrier.
+ * \param rounds The number of the barriers.
+ * \return The offset of each rank in microseconds, which is the same on all ranks.
+ */
+Array<IntImm> SyncClock(int rounds) {
+  CHECK_GT(rounds, 0) << "The clock sync needs at least one round";
+  auto comm = Communicator::Get("nccl");
+  ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm)->nccl_comm;
+  int size = comm->size;
+  CUDA_CALL(cudaSetDevice(comm->local_rank));
+  cudaStream_t stream;
+  CUDA_CALL(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+  int64_t* barrier;
+  int64_t* clocks;
+  CUDA_CALL(cudaMalloc(&barrier, sizeof(int64_t)));
+  CUDA_CALL(cudaMalloc(&clocks, sizeof(int64_t) * rounds * (size + 1)));
+  CUDA_CALL(cudaMemsetAsync(barrier, 0, sizeof(int64_t), stream));
+
+  std::vector<int64_t> local(rounds);
+  // The first barrier is not timed, since it includes the connection setup of NCCL.
+  for (int r = -1; r < rounds; ++r) {
+    NCCL_CALL(ncclAllReduce(barrier, barrier, 1, ncclInt64, ncclSum, nccl_comm, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+    if (r >= 0) {
+      local[r] = static_cast<int64_t>(profiler::ProfileStat::NowInMicrosec());
+    }
+  }
+  // The clocks of the ranks are gathered after the rounds, so they do not delay the barriers.
+  int64_t* gathered = clocks + rounds;
+  CUDA_CALL(cudaMemcpyAsync(clocks, local.data(), sizeof(int64_t) * rounds,
+                            cudaMemcpyHostToDevice, stream));
+  NCCL_CALL(ncclAllGather(clocks, gathered, rounds, ncclInt64, nccl_comm, stream));
+  std::vector<int64_t> all(rounds * size);
+  CUDA_CALL(cudaMemcpyAsync(all.data(), gathered, sizeof(int64_t) * rounds * size,
+                            cudaMemcpyDeviceToHost, stream));
+  CUDA_CALL(cudaStreamSynchronize(stream));
+  CUDA_CALL(cudaFree(barrier));
+  CUDA_CALL(cudaFree(clocks));
+  CUDA_CALL(cudaStreamDestroy(stream));
+
+  Array<IntImm> offsets;
+  std::vector<int64_t> diffs(rounds);
+  for (int rank = 0; rank < size; ++rank) {
+    for (int r = 0; r < rounds; ++r) {
+      diffs[r] = all[rank * rounds + r] - all[r];
+    }
+    std::nth_element(diffs.begin(), diffs.begin() + rounds / 2, diffs.end());
+    offsets.push_back(IntImm(DataType::Int(64), diffs[rounds / 2]));
+  }
+  return offsets;
+}
+
+RAF_REGISTER_GLOBAL("raf.distributed.SyncClock").set_body_typed(SyncClock);
+
+}  // namespace communicator
+}  // namespace distributed
+}  // namespace raf
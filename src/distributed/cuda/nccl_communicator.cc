@@ -8,7 +8,13 @@
  * \brief NCCL Communicator.
  */
 
+#include <dirent.h>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <numeric>
+#include <thread>
 #include "raf/mpi_communicator.h"
 #include "raf/nccl_communicator.h"
 #include "./nccl_utils.h"
@@ -35,6 +41,16 @@ class NCCLIdSyncHelper {
     } else {
       base_path_ = std::string(temp);
     }
+    int generation = CommunicatorPool::Get()->generation();
+    if (generation > 0) {
+      // The ids of the previous worlds are left in the store, so each world has its own one.
+      base_path_ += "/" + std::to_string(generation);
+      int res = syscall(std::bind(::access, base_path_.c_str(), F_OK));
+      if (res < 0) {
+        int rv = syscall(std::bind(mkdir, base_path_.c_str(), S_IRWXU | S_IRWXG | S_IRWXO));
+        SYSASSERT(rv, "mkdir");
+      }
+    }
     this->Append();
   }
 
@@ -68,14 +84,203 @@ class NCCLIdSyncHelper {
   int count_{0};
 };
 
+/*! \brief Read the NUMA node from the sysfs entry of a PCI device, or -1 if unknown. */
+int32_t ReadNumaNode(const std::string& device_path) {
+  std::ifstream fin(device_path + "/numa_node");
+  int32_t numa_node = -1;
+  if (!(fin >> numa_node)) {
+    return -1;
+  }
+  return numa_node;
+}
+
+/*!
+ * \brief Discover the topology of a device on this host. The NVLink peers are the devices with
+ * native P2P atomics, which are only supported over NVLink.
+ */
+RankTopology DiscoverTopology(int device_id) {
+  RankTopology topo;
+  topo.device_id = device_id;
+  char bus_id[32];
+  if (cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), device_id) == cudaSuccess) {
+    std::string bus(bus_id);
+    std::transform(bus.begin(), bus.end(), bus.begin(), ::tolower);
+    topo.numa_node = ReadNumaNode("/sys/bus/pci/devices/" + bus);
+  }
+  if (DIR* dir = opendir("/sys/class/infiniband")) {
+    while (dirent* entry = readdir(dir)) {
+      if (entry->d_name[0] == '.') {
+        continue;
+      }
+      auto nic_path = std::string("/sys/class/infiniband/") + entry->d_name + "/device";
+      if (topo.numa_node >= 0 && ReadNumaNode(nic_path) == topo.numa_node) {
+        topo.nic_affinity = 1;
+      }
+    }
+    closedir(dir);
+  }
+  int num_devices = 0;
+  cudaGetDeviceCount(&num_devices);
+  for (int peer = 0; peer < num_devices && peer < 64; ++peer) {
+    int atomic = 0;
+    if (peer != device_id &&
+        cudaDeviceGetP2PAttribute(&atomic, cudaDevP2PAttrNativeAtomicSupported, device_id,
+                                  peer) == cudaSuccess &&
+        atomic) {
+      topo.nvlink_mask |= uint64_t(1) << peer;
+    }
+  }
+  return topo;
+}
+
+/*!
+ * \brief Get the topology of all ranks, where the device of a rank is its local rank. The
+ * topology is allgathered by MPI, or discovered locally if all ranks are on this host.
+ */
+std::vector<RankTopology> GatherTopology(const Communicator& global_comm) {
+  std::vector<RankTopology> topology(global_comm->size);
+  if (global_comm->IsInstance<MPICommunicatorObj>()) {
+    topology[global_comm->rank] = DiscoverTopology(global_comm->local_rank);
+    MPI_CALL(MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, &topology[0],
+                           sizeof(RankTopology), MPI_BYTE, MPI_COMM_WORLD));
+    return topology;
+  }
+  for (int rank = 0; rank < global_comm->size; ++rank) {
+    if (global_comm->host_ids.at(rank) != global_comm->host_ids.at(global_comm->rank)) {
+      return {};
+    }
+    topology[rank] = DiscoverTopology(rank);
+  }
+  return topology;
+}
+
+#if NCCL_VERSION_CODE >= 21400
+#define RAF_NCCL_NONBLOCKING_INIT 1
+#endif
+#if NCCL_VERSION_CODE >= 21801
+#define RAF_NCCL_COMM_SPLIT 1
+#endif
+
+/*!
+ * \brief The seconds to wait for the initialization of a NCCL communicator before aborting it, set
+ * by RAF_NCCL_INIT_TIMEOUT. It is 0 by default, which blocks until the peers join.
+ */
+int GetInitTimeout() {
+  static int timeout = []() {
+    const char* val = getenv("RAF_NCCL_INIT_TIMEOUT");
+    return val == nullptr ? 0 : atoi(val);
+  }();
+  return timeout;
+}
+
+/*!
+ * \brief Whether to split the sub-communicators from the global one instead of initializing them
+ * from the unique ids, which skips the exchange of the ids and the bootstrap of the new ranks.
+ * It is set by RAF_NCCL_COMM_SPLIT, which is 1 by default.
+ */
+bool UseCommSplit() {
+  static bool split = []() {
+    const char* val = getenv("RAF_NCCL_COMM_SPLIT");
+    return val == nullptr || atoi(val) != 0;
+  }();
+  return split;
+}
+
+#ifdef RAF_NCCL_NONBLOCKING_INIT
+/*! \brief The config of the communicators, which are initialized asynchronously under a timeout. */
+ncclConfig_t MakeInitConfig() {
+  ncclConfig_t config = NCCL_CONFIG_INITIALIZER;
+  config.blocking = GetInitTimeout() > 0 ? 0 : 1;
+  return config;
+}
+
+/*! \brief Check the result of an init call, which is in progress if it is non-blocking. */
+void CheckInitResult(ncclResult_t result) {
+  if (result != ncclInProgress) {
+    NCCL_CALL(result);
+  }
+}
+
+/*! \brief Wait for the non-blocking initialization of comm, and abort it after the timeout. */
+void WaitForInit(ncclComm_t comm) {
+  int timeout = GetInitTimeout();
+  if (timeout <= 0) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  ncclResult_t state = ncclInProgress;
+  while (true) {
+    NCCL_CALL(ncclCommGetAsyncError(comm, &state));
+    if (state != ncclInProgress) {
+      break;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - start);
+    if (elapsed.count() >= timeout) {
+      ncclCommAbort(comm);
+      LOG(FATAL) << "Timeout after " << timeout << " s to initialize the NCCL communicator, "
+                 << "where some ranks may have failed or not joined";
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  NCCL_CALL(state);
+}
+#endif
+
+/*! \brief Initialize the NCCL communicator of the rank from the unique id. */
+void InitCommRank(ncclComm_t* comm, int size, const ncclUniqueId& nccl_id, int rank) {
+#ifdef RAF_NCCL_NONBLOCKING_INIT
+  ncclConfig_t config = MakeInitConfig();
+  CheckInitResult(ncclCommInitRankConfig(comm, size, nccl_id, rank, &config));
+  WaitForInit(*comm);
+#else
+  NCCL_CALL(ncclCommInitRank(comm, size, nccl_id, rank));
+#endif
+}
+
+#ifdef RAF_NCCL_COMM_SPLIT
+/*!
+ * \brief Split the NCCL communicator of the sub-communicator from the global one. Every rank of
+ * the world calls it for the same rank list, which is how the sub-communicators are created from
+ * the ids as well. The ranks not in the list are split into their own standalone communicators.
+ */
+void SplitComm(NCCLCommunicatorObj* obj) {
+  auto global = Downcast<NCCLCommunicator>(Communicator::Get("nccl"));
+  int color = obj->group_id >= 0 ? obj->group_id : obj->group_size + obj->world_rank;
+  ncclConfig_t config = MakeInitConfig();
+  CheckInitResult(ncclCommSplit(global->nccl_comm, color, obj->rank, &obj->nccl_comm, &config));
+  WaitForInit(obj->nccl_comm);
+}
+#endif
+
 NCCLCommunicatorObj::~NCCLCommunicatorObj() {
-  NCCL_CALL(ncclCommDestroy(nccl_comm));
+  if (!aborted) {
+    NCCL_CALL(ncclCommDestroy(nccl_comm));
+  }
+}
+
+void NCCLCommunicatorObj::Abort() {
+  // ncclCommDestroy waits for the pending operations, which never finish if a peer has failed.
+  if (!aborted) {
+    aborted = true;
+    NCCL_CALL(ncclCommAbort(nccl_comm));
+  }
 }
 
 NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
   auto global_comm = GetGlobalCommunicator();
   auto obj = make_object<NCCLCommunicatorObj>();
 
+#ifdef RAF_NCCL_COMM_SPLIT
+  if (rank_list.defined() && UseCommSplit()) {
+    InitSubCommunicator(obj.get(), rank_list, global_comm);
+    cudaSetDevice(global_comm->local_rank);
+    obj->parent_comm = global_comm;
+    SplitComm(obj.get());
+    return NCCLCommunicator(obj);
+  }
+#endif
+
   std::unique_ptr<NCCLIdSyncHelper> helper{nullptr};
   if (global_comm->IsInstance<VoidCommunicatorObj>()) {
     helper = std::make_unique<NCCLIdSyncHelper>();
@@ -98,6 +303,7 @@ NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
     obj->host_ids = global_comm->host_ids;
     obj->parent_comm = global_comm;
     cudaSetDevice(obj->local_rank);
+    obj->topology = GatherTopology(global_comm);
     // sync NCCL id between ranks
     if (global_comm->IsInstance<MPICommunicatorObj>()) {
       MPI_CALL(MPI_Bcast(reinterpret_cast<void*>(&nccl_id), sizeof(nccl_id), MPI_BYTE,
@@ -108,7 +314,7 @@ NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
       std::iota(vec.begin(), vec.end(), 0);
       helper->Sync(&nccl_id, obj->rank, vec);
     }
-    NCCL_CALL(ncclCommInitRank(&obj->nccl_comm, obj->size, nccl_id, obj->rank));
+    InitCommRank(&obj->nccl_comm, obj->size, nccl_id, obj->rank);
   } else {
     // Create Sub-communicator
     InitSubCommunicator(obj.get(), rank_list, global_comm);
@@ -155,7 +361,7 @@ NCCLCommunicator NCCLCommunicator::make(Value rank_list) {
         helper->Sync(&nccl_id, global_comm->rank, vec);
       }
     }
-    NCCL_CALL(ncclCommInitRank(&obj->nccl_comm, obj->size, root_nccl_id, obj->rank));
+    InitCommRank(&obj->nccl_comm, obj->size, root_nccl_id, obj->rank);
   }
 
   return NCCLCommunicator(obj);
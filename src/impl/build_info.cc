@@ -31,6 +31,14 @@ std::string UseCuBLAS() {
   return RAF_USE_CUBLAS;
 }
 
+std::string UseCUPTI() {
+  return RAF_USE_CUPTI;
+}
+
+std::string UseCBLAS() {
+  return RAF_USE_CBLAS;
+}
+
 std::string UseCuDNN() {
   return RAF_USE_CUDNN;
 }
@@ -66,6 +74,10 @@ std::string UseCUTLASS() {
   return RAF_USE_CUTLASS;
 }
 
+std::string UseTensorRT() {
+  return RAF_USE_TENSORRT;
+}
+
 std::string CudaVersion() {
   return RAF_CUDA_VERSION;
 }
@@ -82,6 +94,8 @@ RAF_REGISTER_GLOBAL("raf.build_info.git_version").set_body_typed(GitVersion);
 RAF_REGISTER_GLOBAL("raf.build_info.cuda_version").set_body_typed(CudaVersion);
 RAF_REGISTER_GLOBAL("raf.build_info.use_cuda").set_body_typed(UseCUDA);
 RAF_REGISTER_GLOBAL("raf.build_info.use_cublas").set_body_typed(UseCuBLAS);
+RAF_REGISTER_GLOBAL("raf.build_info.use_cupti").set_body_typed(UseCUPTI);
+RAF_REGISTER_GLOBAL("raf.build_info.use_cblas").set_body_typed(UseCBLAS);
 RAF_REGISTER_GLOBAL("raf.build_info.use_cudnn").set_body_typed(UseCuDNN);
 RAF_REGISTER_GLOBAL("raf.build_info.cudnn_version").set_body_typed(CudnnVersion);
 RAF_REGISTER_GLOBAL("raf.build_info.cmake_build_type").set_body_typed(CmakeBuildType);
@@ -89,6 +103,7 @@ RAF_REGISTER_GLOBAL("raf.build_info.use_llvm").set_body_typed(UseLLVM);
 RAF_REGISTER_GLOBAL("raf.build_info.use_mpi").set_body_typed(UseMPI);
 RAF_REGISTER_GLOBAL("raf.build_info.use_nccl").set_body_typed(UseNCCL);
 RAF_REGISTER_GLOBAL("raf.build_info.use_cutlass").set_body_typed(UseCUTLASS);
+RAF_REGISTER_GLOBAL("raf.build_info.use_tensorrt").set_body_typed(UseTensorRT);
 RAF_REGISTER_GLOBAL("raf.build_info.nccl_version").set_body_typed(NCCLVersion);
 }  // namespace build_info
 }  // namespace raf
@@ -0,0 +1,258 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/cache.cc
+ * \brief The RAF cache.
+ */
+#include <dirent.h>
+#include <algorithm>
+#include <sstream>
+#include <tvm/runtime/c_runtime_api.h>
+#include "raf/cache.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace build_info {
+std::string GitVersion();
+std::string CudaVersion();
+std::string CudnnVersion();
+}  // namespace build_info
+
+namespace op {
+
+Hash128 PersistCacheVersionSalt() {
+  std::string version = build_info::GitVersion() + ";" + TVM_VERSION + ";" +
+                        build_info::CudaVersion() + ";" + build_info::CudnnVersion();
+  return StreamHasher128::Hash(version.data(), version.size());
+}
+
+constexpr const char* PersistCacheIndex::INDEX_FILE;
+constexpr const char* PersistCacheIndex::TEMP_PREFIX;
+
+namespace {
+/*! \brief The temporary entries older than this are left by the crashed writers. */
+constexpr int64_t kStaleTempMillis = 3600 * 1000;
+
+int64_t NowInMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
+void PersistCacheIndex::Open(const std::string& dir) {
+  std::lock_guard<std::mutex> lock(mu_);
+  dir_ = dir;
+  records_.clear();
+  touched_.clear();
+  total_bytes_ = 0;
+  inode_ = 0;
+  offset_ = 0;
+  if (!dir_.empty()) {
+    Reload();
+  }
+}
+
+bool PersistCacheIndex::Contains(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (records_.count(name)) {
+    return true;
+  }
+  Reload();
+  return records_.count(name) > 0;
+}
+
+void PersistCacheIndex::Add(const std::string& name, int64_t nbytes) {
+  std::lock_guard<std::mutex> lock(mu_);
+  std::ostringstream os;
+  os << "+ " << name << " " << nbytes << " " << NowInMillis() << "\n";
+  Append(os.str());
+  touched_.insert(name);
+}
+
+void PersistCacheIndex::Touch(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!touched_.insert(name).second) {
+    return;
+  }
+  std::ostringstream os;
+  os << "~ " << name << " " << NowInMillis() << "\n";
+  Append(os.str());
+}
+
+int64_t PersistCacheIndex::TotalBytes() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return total_bytes_;
+}
+
+int PersistCacheIndex::Collect(int64_t budget) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (dir_.empty()) {
+    return 0;
+  }
+  FileLock file_lock(dir_ + "/" + INDEX_FILE + ".lock");
+  Reload();
+
+  // Remove the temporary entries of the writers that crashed before renaming them.
+  int64_t now = NowInMillis();
+  if (DIR* dir = opendir(dir_.c_str())) {
+    std::string prefix = TEMP_PREFIX;
+    while (struct dirent* entry = readdir(dir)) {
+      std::string path = dir_ + "/" + entry->d_name;
+      struct stat st;
+      if (std::string(entry->d_name).compare(0, prefix.size(), prefix) == 0 &&
+          stat(path.c_str(), &st) == 0 && now - st.st_mtime * 1000 > kStaleTempMillis) {
+        RemovePath(path);
+      }
+    }
+    closedir(dir);
+  }
+  if (total_bytes_ <= budget) {
+    return 0;
+  }
+
+  // Evict the least recently used entries.
+  std::vector<std::pair<int64_t, std::string>> lru;
+  for (const auto& it : records_) {
+    lru.emplace_back(it.second.atime, it.first);
+  }
+  std::sort(lru.begin(), lru.end());
+  int evicted = 0;
+  for (const auto& it : lru) {
+    if (total_bytes_ <= budget) {
+      break;
+    }
+    RemovePath(dir_ + "/" + it.second);
+    total_bytes_ -= records_[it.second].nbytes;
+    records_.erase(it.second);
+    ++evicted;
+  }
+
+  // Compact the log to the remaining entries, which replaces it atomically.
+  std::string index_path = dir_ + "/" + INDEX_FILE;
+  std::string temp_path = index_path + "." + std::to_string(getpid());
+  {
+    std::ofstream ofs(temp_path);
+    for (const auto& it : records_) {
+      ofs << "+ " << it.first << " " << it.second.nbytes << " " << it.second.atime << "\n";
+    }
+  }
+  std::rename(temp_path.c_str(), index_path.c_str());
+  struct stat st;
+  if (stat(index_path.c_str(), &st) == 0) {
+    inode_ = st.st_ino;
+    offset_ = st.st_size;
+  }
+  return evicted;
+}
+
+void PersistCacheIndex::Reload() {
+  std::string index_path = dir_ + "/" + INDEX_FILE;
+  struct stat st;
+  if (stat(index_path.c_str(), &st) != 0) {
+    return;
+  }
+  if (st.st_ino != inode_ || st.st_size < offset_) {
+    // The log is compacted by another process.
+    records_.clear();
+    total_bytes_ = 0;
+    inode_ = st.st_ino;
+    offset_ = 0;
+  }
+  if (st.st_size == offset_) {
+    return;
+  }
+  std::ifstream ifs(index_path, std::ios::binary);
+  ifs.seekg(offset_);
+  std::string lines((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  // Only parse the complete lines, as a line may be being appended.
+  size_t end = lines.rfind('\n');
+  if (end == std::string::npos) {
+    return;
+  }
+  std::istringstream iss(lines.substr(0, end + 1));
+  std::string line;
+  while (std::getline(iss, line)) {
+    Apply(line);
+  }
+  offset_ += end + 1;
+}
+
+void PersistCacheIndex::Apply(const std::string& line) {
+  std::istringstream iss(line);
+  std::string op, name;
+  iss >> op >> name;
+  if (op == "+") {
+    Record record;
+    iss >> record.nbytes >> record.atime;
+    auto it = records_.find(name);
+    if (it != records_.end()) {
+      total_bytes_ -= it->second.nbytes;
+    }
+    records_[name] = record;
+    total_bytes_ += record.nbytes;
+  } else if (op == "~") {
+    auto it = records_.find(name);
+    if (it != records_.end()) {
+      iss >> it->second.atime;
+    }
+  }
+}
+
+void PersistCacheIndex::Append(const std::string& line) {
+  if (dir_.empty()) {
+    return;
+  }
+  // The lock keeps the line from being lost by a concurrent compaction.
+  FileLock file_lock(dir_ + "/" + INDEX_FILE + ".lock");
+  std::string index_path = dir_ + "/" + INDEX_FILE;
+  int fd = open(index_path.c_str(), O_WRONLY | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP);
+  if (fd == -1) {
+    LOG(WARNING) << "Failed to open the index " << index_path << ": " << strerror(errno);
+    return;
+  }
+  ssize_t written = write(fd, line.data(), line.size());
+  close(fd);
+  if (written != static_cast<ssize_t>(line.size())) {
+    LOG(WARNING) << "Failed to append to the index " << index_path;
+    return;
+  }
+  // Parse the lines of the other processes before this one, so the offset stays at a line end.
+  Reload();
+}
+
+void SetPersistCacheRoot(const std::string& cache_root) {
+  for (auto* cache : MetaPersistCacheBase::Registry()) {
+    cache->SetPersistRoot(cache_root);
+  }
+}
+
+int CollectPersistCache(int64_t budget_mb) {
+  int evicted = 0;
+  for (auto* cache : MetaPersistCacheBase::Registry()) {
+    evicted += cache->CollectGarbage(budget_mb << 20);
+  }
+  return evicted;
+}
+
+int PrefetchRemoteCache(const std::string& fingerprint) {
+  int fetched = 0;
+  for (const auto& entry : RemoteCache::Get()->FetchManifest(fingerprint)) {
+    for (auto* cache : MetaPersistCacheBase::Registry()) {
+      if (cache->persist_name() == entry.first && cache->PrefetchRemote(entry.second)) {
+        ++fetched;
+      }
+    }
+  }
+  return fetched;
+}
+
+RAF_REGISTER_GLOBAL("raf.cache.SetPersistCacheRoot").set_body_typed(SetPersistCacheRoot);
+RAF_REGISTER_GLOBAL("raf.cache.CollectPersistCache").set_body_typed(CollectPersistCache);
+RAF_REGISTER_GLOBAL("raf.cache.PrefetchRemoteCache").set_body_typed(PrefetchRemoteCache);
+
+}  // namespace op
+}  // namespace raf
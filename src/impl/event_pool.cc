@@ -10,7 +10,9 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "raf/device_api.h"
 #include "raf/registry.h"
 #include "raf/event_pool.h"
@@ -21,20 +23,73 @@ namespace event_pool {
 using device_api::DeviceAPI;
 using registry::PerDeviceStore;
 
+/*!
+ * \brief The events recycled on a thread, which are handed out again by the GetEvent of the same
+ * thread without taking the lock of the pool. A free list holds at most kCapacity events, and the
+ * overflow, as well as the events left when the thread exits, go back to the pool.
+ */
+class ThreadEventCache {
+ public:
+  static constexpr size_t kCapacity = 256;
+
+  ~ThreadEventCache() {
+    for (auto& kv : lists_) {
+      for (void* event : kv.second) {
+        kv.first.first->RecycleEvent(kv.first.second, event);
+      }
+    }
+  }
+
+  static ThreadEventCache* Get() {
+    static thread_local ThreadEventCache cache;
+    return &cache;
+  }
+
+  void* Pop(EventPool* pool, uint32_t flags) {
+    auto it = lists_.find({pool, flags});
+    if (it == lists_.end() || it->second.empty()) {
+      return nullptr;
+    }
+    void* event = it->second.back();
+    it->second.pop_back();
+    return event;
+  }
+
+  bool Push(EventPool* pool, uint32_t flags, void* event) {
+    auto& list = lists_[{pool, flags}];
+    if (list.size() >= kCapacity) {
+      return false;
+    }
+    list.push_back(event);
+    return true;
+  }
+
+ private:
+  struct KeyHash {
+    size_t operator()(const std::pair<EventPool*, uint32_t>& key) const {
+      return std::hash<EventPool*>()(key.first) ^ (static_cast<size_t>(key.second) << 1);
+    }
+  };
+
+  /*! \brief The free lists of each pool and flags. */
+  std::unordered_map<std::pair<EventPool*, uint32_t>, std::vector<void*>, KeyHash> lists_;
+};
+
 class Event::Impl {
  public:
-  explicit Impl(Device dev, uint32_t flags, void* event)
-      : device_(std::move(dev)), flags_(flags), event_(event) {
+  explicit Impl(EventPool* pool, uint32_t flags, void* event)
+      : pool_(pool), flags_(flags), event_(event) {
   }
 
   ~Impl() {
-    if (event_ != nullptr) {
-      EventPool::Get(device_)->RecycleEvent(flags_, event_);
+    if (event_ != nullptr && !ThreadEventCache::Get()->Push(pool_, flags_, event_)) {
+      pool_->RecycleEvent(flags_, event_);
     }
   }
 
  public:
-  Device device_;
+  /*! \brief The pool of the event, which lives as long as the process. */
+  EventPool* pool_;
   uint32_t flags_;
   void* event_;
 };
@@ -55,16 +110,18 @@ EventPool::~EventPool() {
 }
 
 std::shared_ptr<Event> EventPool::GetEvent(uint32_t flags) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto& pool = freed_events_[flags];
-  void* event;
-  if (!pool.empty()) {
-    event = pool.back();
-    pool.pop_back();
-  } else {
-    event = api_->CreateEvent(device_, flags);
+  void* event = ThreadEventCache::Get()->Pop(this, flags);
+  if (event == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& pool = freed_events_[flags];
+    if (!pool.empty()) {
+      event = pool.back();
+      pool.pop_back();
+    } else {
+      event = api_->CreateEvent(device_, flags);
+    }
   }
-  return std::shared_ptr<Event>(new Event(std::make_unique<Event::Impl>(device_, flags, event)));
+  return std::shared_ptr<Event>(new Event(std::make_unique<Event::Impl>(this, flags, event)));
 }
 
 EventPool::EventPool(const Device& dev) : device_(dev), api_(DeviceAPI::Get(dev.device_type())) {
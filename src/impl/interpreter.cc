@@ -16,6 +16,7 @@
 #include "raf/tensor.h"
 #include "raf/value.h"
 #include "raf/binding.h"
+#include "raf/cache.h"
 #include "raf/profiler.h"
 #include "raf/communicator.h"
 #include "dmlc/thread_local.h"
@@ -23,7 +24,15 @@
 #include "../requests.h"
 #include "../op/schema/reduce.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
 #include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace raf {
 namespace executor {
@@ -106,6 +115,99 @@ class SymbolTable {
   }
 };
 
+/*!
+ * \brief The queue of the asynchronous eager mode. A worker thread executes the enqueued tasks in
+ * order, so the host can dispatch the next ops while the previous ones are running.
+ */
+class AsyncQueue {
+ public:
+  static AsyncQueue* Get() {
+    // Intentionally leaked, so that the worker thread outlives the static destructors.
+    static AsyncQueue* inst = new AsyncQueue();
+    return inst;
+  }
+
+  void Enqueue(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (worker_id_ == std::thread::id()) {
+      std::thread worker([this]() { Loop(); });
+      worker_id_ = worker.get_id();
+      worker.detach();
+    }
+    tasks_.push_back(std::move(task));
+    ++num_pending_;
+    task_cv_.notify_one();
+  }
+
+  void Synchronize() {
+    std::string error_msg;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      // The ops executed by the worker, such as device copies, are already in order.
+      if (std::this_thread::get_id() == worker_id_) {
+        return;
+      }
+      done_cv_.wait(lock, [this]() { return num_pending_ == 0; });
+      std::swap(error_msg, error_msg_);
+    }
+    if (!error_msg.empty()) {
+      LOG(FATAL) << "An asynchronously executed op failed: " << error_msg;
+      throw;
+    }
+  }
+
+ private:
+  AsyncQueue() = default;
+
+  void Loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        task_cv_.wait(lock, [this]() { return !tasks_.empty(); });
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      std::string error_msg;
+      try {
+        task();
+      } catch (const std::exception& e) {
+        error_msg = e.what();
+      }
+      // Release the values captured by the task before the host is notified.
+      task = nullptr;
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!error_msg.empty() && error_msg_.empty()) {
+        error_msg_ = error_msg;
+      }
+      if (--num_pending_ == 0) {
+        done_cv_.notify_all();
+      }
+    }
+  }
+
+  /*! \brief The mutex of the tasks and the states. */
+  std::mutex mu_;
+  /*! \brief Notified when a task is enqueued. */
+  std::condition_variable task_cv_;
+  /*! \brief Notified when all the tasks are done. */
+  std::condition_variable done_cv_;
+  /*! \brief The tasks to execute. */
+  std::deque<std::function<void()>> tasks_;
+  /*! \brief The number of tasks that are enqueued but not done. */
+  int64_t num_pending_ = 0;
+  /*! \brief The error of the first failed task since the last synchronization. */
+  std::string error_msg_;
+  /*! \brief The id of the worker thread, which is started on the first task. */
+  std::thread::id worker_id_;
+};
+
+/*! \brief Whether the asynchronous eager mode is enabled, initialized by RAF_INTERPRETER_ASYNC. */
+static std::atomic<bool> async_enabled([]() {
+  const char* env = getenv("RAF_INTERPRETER_ASYNC");
+  return env != nullptr && std::string(env) == "1";
+}());
+
 class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Executor {
  public:
   SymbolTable st;
@@ -113,7 +215,12 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
 
  public:
   Interpreter() = default;
-  ~Interpreter() = default;
+  ~Interpreter() {
+    // The enqueued tasks refer to this interpreter to request their resources.
+    if (IsAsync()) {
+      AsyncQueue::Get()->Synchronize();
+    }
+  }
 
   Value Eval(const Expr& expr) {
     return ExprFunctor<Value(const Expr& n)>::VisitExpr(expr);
@@ -176,7 +283,7 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
       call_values->args = fschema[opv->op](args);
       Value output_value;
       WITH_BASE_PROFILER(call_values->device, opv->op->name, "SchedulingCommunication", {},
-                         { output_value = InvokePrimitive(call_values); });
+                         { output_value = InvokePrimitive(call_values, &args); });
       return output_value;
     }
     LOG(FATAL) << "ValueError: type " << call_values->callee->GetTypeKey() << " is not callable";
@@ -206,7 +313,11 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
   }
 
   Value VisitExpr_(const IfNode* node) override {
-    bool result = GetScalarValueData<bool>(Eval(node->cond));
+    Value cond = Eval(node->cond);
+    if (IsAsync()) {
+      AsyncQueue::Get()->Synchronize();
+    }
+    bool result = GetScalarValueData<bool>(cond);
     return result ? Eval(node->true_branch) : Eval(node->false_branch);
   }
 
@@ -244,7 +355,15 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
   }
 
  public:
-  Value InvokePrimitive(const CallValues& call) {
+  /*!
+   * \brief Invoke a primitive op.
+   * \param call The call values.
+   * \param args The arguments of the call. If given, the declared output and the dispatched
+   * OpEnv are memoized for the calls of the same op with the same argument types and attributes,
+   * so that they are only declared and dispatched once.
+   * \return The output of the call.
+   */
+  Value InvokePrimitive(const CallValues& call, const Array<Value>* args = nullptr) {
     const Op& op = Downcast<OpValue>(call->callee)->op;
     bool use_upper_bound = false;
     static auto upper_bound_map = Op::GetAttrMap<Op>("TRAFUpperBoundOp");
@@ -252,15 +371,40 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
       call->callee = OpValue::make(upper_bound_map[op]);
       use_upper_bound = true;
     }
+    std::string memo_key;
+    bool use_memo = args != nullptr && !use_upper_bound && MakeMemoKey(op, *args, &memo_key);
+    if (use_memo) {
+      auto it = memo_.find(memo_key);
+      if (it != memo_.end()) {
+        const PrimitiveMemo& memo = it->second;
+        call->out = AssembleLike(memo.out);
+        call->device = memo.device;
+        AllocOutputBuffer(call->out);
+        InvokePrimitiveOpEnv(memo.op_env, call, false, args);
+        return call->out;
+      }
+    }
+    // The declare functions may read the data of the host tensors, which must be ready.
+    if (IsAsync() && (args == nullptr || HasHostTensor(*args))) {
+      AsyncQueue::Get()->Synchronize();
+    }
     RunDeclare(call);
     if (!call->callee.defined()) {
       return call->out;
     }
     ICHECK(call->out.defined()) << "ValueError: Tensor compute of " << op->name
                                 << " is not implemented.";
+    // Outputs that alias the inputs are decided by the declare function, which cannot be skipped.
+    Value declared_out = use_memo ? AssembleLike(call->out) : Value();
     AllocOutputBuffer(call->out);
     std::shared_ptr<OpEnv> op_env = Dispatch(call);
     if (op_env != nullptr) {
+      if (declared_out.defined() && IsValidArgIndices(op_env->arg_indices, args->size())) {
+        if (memo_.size() >= kMaxMemoSize) {
+          memo_.clear();
+        }
+        memo_[memo_key] = PrimitiveMemo{declared_out, call->device, op_env};
+      }
       InvokePrimitiveOpEnv(std::move(op_env), call, use_upper_bound);
     } else {
       LOG(FATAL) << "ValueError: Cannot dispatch " << op->name << "@" << call->device.c_str();
@@ -276,8 +420,60 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
     f(call);
   }
 
+  /*!
+   * \brief Execute an OpEnv, which is enqueued in the asynchronous eager mode unless the actual
+   * output shape has to be known by the host.
+   * \param op_env The OpEnv.
+   * \param call The call values.
+   * \param use_upper_bound Whether the output is the upper bound of the actual output.
+   * \param args If given, the OpEnv is executed with the arguments at its argument indices
+   * instead of the call values, because it may be dispatched for a previous call.
+   */
   void InvokePrimitiveOpEnv(std::shared_ptr<OpEnv> op_env, const CallValues& call,
-                            bool use_upper_bound) {
+                            bool use_upper_bound, const Array<Value>* args = nullptr) {
+    std::vector<Value> inputs;
+    if (args != nullptr) {
+      for (int i : op_env->arg_indices) {
+        inputs.push_back((*args)[i]);
+      }
+    }
+    if (IsAsync() && !use_upper_bound) {
+      // The task holds the OpEnv, the call and the inputs, so the memories they refer to are kept
+      // until the task is done.
+      bool with_args = args != nullptr;
+      AsyncQueue::Get()->Enqueue([this, op_env, call, inputs, with_args]() {
+        ExecuteOpEnv(op_env, call, with_args ? &inputs : nullptr);
+      });
+    } else {
+      if (IsAsync()) {
+        AsyncQueue::Get()->Synchronize();
+      }
+      ExecuteOpEnv(op_env, call, args != nullptr ? &inputs : nullptr);
+    }
+
+    // note: The next op holds a reference to this op. It will make sure that the memories requested
+    // by this op will not be freed after the return of this op.
+    call->out->op_env = std::move(op_env);
+
+    if (use_upper_bound) {
+      auto tup = Downcast<TupleValue>(call->out);
+      auto data = Downcast<TensorValue>(tup->fields[0]);
+      auto shape_data = Downcast<TensorValue>(tup->fields[1]);
+      shape_data = Downcast<TensorValue>(CopyTo(shape_data, Device(DevType::kCPU(), 0)));
+      auto shape = common::shape_utils::GetShapeVecFromData(shape_data);
+      auto new_out = data.CreateView(shape);
+      call->out = new_out;
+    }
+  }
+
+  /*!
+   * \brief Request the resources of an OpEnv and execute it.
+   * \param op_env The OpEnv.
+   * \param call The call values.
+   * \param inputs If given, the inputs at the argument indices of the OpEnv.
+   */
+  void ExecuteOpEnv(const std::shared_ptr<OpEnv>& op_env, const CallValues& call,
+                    const std::vector<Value>* inputs) {
     const Op& op = Downcast<OpValue>(call->callee)->op;
     std::shared_ptr<Requests> req = op_env->GetRequests();
     {
@@ -311,35 +507,29 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
     }
 
     // note: Execute the Operator.
-    WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {}, { op_env->Execute(call); });
+    if (inputs != nullptr) {
+      WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {},
+                         { op_env->Execute(*inputs, call->out); });
+    } else {
+      WITH_BASE_PROFILER(call->device, op->name, "CUDA_CALL", {}, { op_env->Execute(call); });
+    }
 
     {
-      // note: Force op to run synchronously.
+      // note: Force op to run synchronously. In the asynchronous eager mode, only the worker
+      // thread waits for it.
       for (int i = 0, n = req->stream.size(); i < n; ++i) {
         req->stream[i].stream->Wait();
       }
-      // note: Free the workspace of this op.
+      // note: Free the workspace of this op. The requests are kept, so that they are requested
+      // again when the OpEnv is reused.
       WITH_BASE_PROFILER(call->device, op->name, "WorkspaceClear", {}, {
-        req->workspace.clear();
-        req->workspace.shrink_to_fit();
+        for (auto& entry : req->workspace) {
+          entry.memory = nullptr;
+        }
       });
-
-      req->stream.clear();
-      req->stream.shrink_to_fit();
-    }
-
-    // note: The next op holds a reference to this op. It will make sure that the memories requested
-    // by this op will not be freed after the return of this op.
-    call->out->op_env = std::move(op_env);
-
-    if (use_upper_bound) {
-      auto tup = Downcast<TupleValue>(call->out);
-      auto data = Downcast<TensorValue>(tup->fields[0]);
-      auto shape_data = Downcast<TensorValue>(tup->fields[1]);
-      shape_data = Downcast<TensorValue>(CopyTo(shape_data, Device(DevType::kCPU(), 0)));
-      auto shape = common::shape_utils::GetShapeVecFromData(shape_data);
-      auto new_out = data.CreateView(shape);
-      call->out = new_out;
+      for (auto& entry : req->stream) {
+        entry.stream = nullptr;
+      }
     }
   }
 
@@ -394,6 +584,126 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
   }
 
  private:
+  /*! \brief The memoized declared output and dispatched OpEnv of a primitive call. */
+  struct PrimitiveMemo {
+    /*! \brief The declared output, whose tensors are not allocated. */
+    Value out;
+    /*! \brief The device of the call. */
+    Device device;
+    /*! \brief The dispatched OpEnv, which keeps its requests across the calls. */
+    std::shared_ptr<OpEnv> op_env;
+  };
+
+  /*! \brief The maximum number of memoized calls, after which the memo is cleared. */
+  static constexpr size_t kMaxMemoSize = 4096;
+
+  /*!
+   * \brief Hash an argument of a primitive call by its type, or by its value if it is not a
+   * tensor.
+   * \return Whether the argument can be hashed.
+   */
+  static bool HashArg(const Value& value, HashKey* key) {
+    if (!value.defined() || value->IsInstance<NoGradValueObj>()) {
+      *key << static_cast<uint8_t>(0);
+    } else if (const auto* tv = value.as<TensorValueObj>()) {
+      const DLTensor* t = GetRef<TensorValue>(tv);
+      // The declare functions read the shapes given by integer tensors on the host.
+      if (t->strides != nullptr ||
+          (t->device.device_type == kDLCPU && t->dtype.code != kDLFloat && t->ndim <= 1)) {
+        return false;
+      }
+      *key << static_cast<uint8_t>(1) << t->device << *t;
+    } else if (const auto* iv = value.as<IntValueObj>()) {
+      *key << static_cast<uint8_t>(2) << DLDataType(iv->dtype) << iv->value;
+    } else if (const auto* fv = value.as<FloatValueObj>()) {
+      *key << static_cast<uint8_t>(3) << DLDataType(fv->dtype) << fv->value;
+    } else if (const auto* bv = value.as<BoolValueObj>()) {
+      *key << static_cast<uint8_t>(4) << bv->value;
+    } else if (const auto* sv = value.as<StringValueObj>()) {
+      *key << static_cast<uint8_t>(5) << sv->value;
+    } else if (const auto* tup = value.as<TupleValueObj>()) {
+      *key << static_cast<uint8_t>(6) << static_cast<int64_t>(tup->fields.size());
+      for (const auto& field : tup->fields) {
+        if (!HashArg(field, key)) {
+          return false;
+        }
+      }
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Make the memo key of a primitive call.
+   * \return Whether the call can be memoized.
+   */
+  static bool MakeMemoKey(const Op& op, const Array<Value>& args, std::string* memo_key) {
+    HashKey key;
+    key << op->name;
+    for (const auto& arg : args) {
+      if (!HashArg(arg, &key)) {
+        return false;
+      }
+    }
+    *memo_key = key.str();
+    return true;
+  }
+
+  /*! \brief Whether any of the values is or contains a tensor on the host. */
+  static bool HasHostTensor(const Array<Value>& values) {
+    for (const auto& value : values) {
+      if (const auto* tv = value.as<TensorValueObj>()) {
+        const DLTensor* t = GetRef<TensorValue>(tv);
+        if (t->device.device_type == kDLCPU) {
+          return true;
+        }
+      } else if (const auto* tup = value.as<TupleValueObj>()) {
+        if (HasHostTensor(tup->fields)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /*! \brief Whether the argument indices of an OpEnv are all in range. */
+  static bool IsValidArgIndices(const std::vector<int>& arg_indices, size_t n_args) {
+    for (int i : arg_indices) {
+      if (i < 0 || i >= static_cast<int>(n_args)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Assemble a new output with the same types as a declared output.
+   * \return The new output, or an undefined value if the declared output is not a (tuple of)
+   * unallocated tensor.
+   */
+  static Value AssembleLike(const Value& out) {
+    if (const auto* tv = out.as<TensorValueObj>()) {
+      const DLTensor* t = GetRef<TensorValue>(tv);
+      if (t->data != nullptr) {
+        return Value();
+      }
+      return TensorValue::Assemble(t->device, t->dtype,
+                                   std::vector<int64_t>(t->shape, t->shape + t->ndim));
+    } else if (const auto* tup = out.as<TupleValueObj>()) {
+      Array<Value> fields;
+      for (const auto& field : tup->fields) {
+        Value new_field = field->IsInstance<TensorValueObj>() ? AssembleLike(field) : Value();
+        if (!new_field.defined()) {
+          return Value();
+        }
+        fields.push_back(new_field);
+      }
+      return TupleValue::make(fields);
+    }
+    return Value();
+  }
+
   void AllocOutputBuffer(Value& out) {
     std::vector<DLTensor*> out_tensors;
     std::vector<TensorValue> out_tvs;
@@ -424,6 +734,9 @@ class Interpreter final : public ExprFunctor<Value(const Expr& n)>, public Execu
       }
     }
   }
+
+  /*! \brief The memoized primitive calls, keyed by the op and the types of the arguments. */
+  std::unordered_map<std::string, PrimitiveMemo> memo_;
 };
 
 class IntrpThreadEntry {
@@ -462,11 +775,29 @@ Value InvokeClosure(const CallValues& call) {
   return ret;
 }
 
+void SetAsync(bool enable) {
+  if (!enable) {
+    Synchronize();
+  }
+  async_enabled = enable;
+}
+
+bool IsAsync() {
+  return async_enabled;
+}
+
+void Synchronize() {
+  AsyncQueue::Get()->Synchronize();
+}
+
 ObjectRef _Interpret(Expr expr, Optional<IRModule> mod) {
   return DeTuple(Interpret(expr, mod));
 }
 
 RAF_REGISTER_GLOBAL("raf.executor.Interpret").set_body_typed(_Interpret);
+RAF_REGISTER_GLOBAL("raf.executor.SetAsyncInterpret").set_body_typed(SetAsync);
+RAF_REGISTER_GLOBAL("raf.executor.IsAsyncInterpret").set_body_typed(IsAsync);
+RAF_REGISTER_GLOBAL("raf.executor.Synchronize").set_body_typed(Synchronize);
 }  // namespace interpreter
 }  // namespace executor
 }  // namespace raf
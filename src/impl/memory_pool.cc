@@ -7,9 +7,19 @@
  * \file src/impl/memory_pool.cc
  * \brief RAF memory pool manager
  */
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <list>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include "raf/device.h"
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
+#include "raf/ir.h"
 #include "raf/memory_pool.h"
+#include "raf/metrics.h"
 #include "raf/registry.h"
 
 #ifdef RAF_USE_CUDA
@@ -49,15 +59,19 @@ class MemoryPoolManager {
    */
   MemoryPool* GetPool(const Device& dev, const std::string& name) {
     thread_local char maker_name[128];
-    std::shared_ptr<MemoryPool>& result = reg.Get(dev);
+    auto& store = GetStore(dev);
+    std::shared_ptr<MemoryPool>& result = store.Get(GetStoreKey(dev));
     if (result == nullptr) {
-      std::lock_guard<std::mutex> lock(reg.mutex_);
+      std::lock_guard<std::mutex> lock(store.mutex_);
       if (result == nullptr) {
         // ok, it is truly a nullptr
         std::string pool_name = (name == "") ? default_strategies[dev.device_type()] : name;
         snprintf(maker_name, sizeof(maker_name), "raf.memory_pool._make.%s", pool_name.c_str());
         void* ret = GetPackedFunc(maker_name)(dev);
         result.reset(static_cast<MemoryPool*>(ret));
+        result->stats->alloc_bytes = metrics::MetricsRegistry::Get()->GetCounter(
+            "raf_memory_alloc_bytes_total", "The bytes handed out by the memory pools.",
+            {{"device", dev.c_str()}});
         return result.get();
       }
     }
@@ -66,13 +80,34 @@ class MemoryPoolManager {
   }
 
   void Remove(const Device& dev) {
-    std::lock_guard<std::mutex> lock(reg.mutex_);
-    std::shared_ptr<MemoryPool>& result = reg.Get(dev);
+    auto& store = GetStore(dev);
+    std::lock_guard<std::mutex> lock(store.mutex_);
+    std::shared_ptr<MemoryPool>& result = store.Get(GetStoreKey(dev));
     result = nullptr;
   }
 
+ private:
+  /*! \brief Whether the pool of the device is the arena of the NUMA node of the calling thread. */
+  static bool UseNumaArena(const Device& dev) {
+    return dev.device_type() == DevType::kCPU() && device_api::cpu::GetNumaNode() >= 0;
+  }
+
+  PerDeviceStore<MemoryPool, false>& GetStore(const Device& dev) {
+    return UseNumaArena(dev) ? numa_reg : reg;
+  }
+
+  /*! \brief The NUMA arenas are indexed by the nodes. */
+  static Device GetStoreKey(const Device& dev) {
+    return UseNumaArena(dev) ? Device(DevType::kCPU(), device_api::cpu::GetNumaNode()) : dev;
+  }
+
  public:
   PerDeviceStore<MemoryPool, false> reg;
+  /*!
+   * \brief The CPU pools of the NUMA nodes, which serve the threads bound to the nodes, so the
+   * chunks reused by a thread stay on its node.
+   */
+  PerDeviceStore<MemoryPool, false> numa_reg;
 };
 
 inline void CheckAlignment(int64_t alignment) {
@@ -81,22 +116,639 @@ inline void CheckAlignment(int64_t alignment) {
       << kDefaultMemoryAlignment;
 }
 
+/*! \brief Whether to count the requests in PoolStats. It is on unless RAF_MEMORY_STATS=0. */
+inline bool StatsEnabled() {
+  static bool enabled = []() {
+    const char* val = getenv("RAF_MEMORY_STATS");
+    return val == nullptr || atoi(val) != 0;
+  }();
+  return enabled;
+}
+
+/*! \brief Count a request of the given bytes in the stats of the pool and the device metrics. */
+inline void CountAlloc(MemoryPool* pool, int64_t nbytes) {
+  pool->stats->RecordAlloc(nbytes);
+  pool->stats->alloc_bytes->Add(nbytes);
+}
+
+/*!
+ * \brief The partitions of the device memory among the tenants, e.g., the models packed on a
+ * shared GPU. The bytes are charged to a tenant before they are allocated, so a tenant over its
+ * partition fails without touching the pool and the other tenants, and the charge is returned when
+ * the memory is released, which may be on another thread. A device is only accounted once its
+ * partitions are set, and the unpartitioned devices cost a relaxed load per allocation.
+ */
+class TenantRegistry {
+ public:
+  struct DevicePartitions;
+
+  struct Partition {
+    TenantStats stats;
+    /*! \brief The device partitions the tenant belongs to, which are never destroyed. */
+    DevicePartitions* device = nullptr;
+  };
+
+  struct DevicePartitions {
+    /*! \brief The bytes shared by the tenants. 0 means unbounded. */
+    int64_t capacity = 0;
+    /*! \brief The bytes in use by all the tenants. */
+    int64_t bytes_in_use = 0;
+    std::unordered_map<std::string, std::shared_ptr<Partition>> tenants;
+  };
+
+  static TenantRegistry* Get() {
+    static TenantRegistry* instance = new TenantRegistry();
+    return instance;
+  }
+
+  static std::string& CurrentTenant() {
+    thread_local std::string tenant;
+    return tenant;
+  }
+
+  bool Enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void SetQuota(const Device& dev, const std::string& tenant, int64_t quota_bytes,
+                int64_t reserved_bytes) {
+    CHECK_GE(quota_bytes, 0) << "The quota of tenant " << tenant << " must be non-negative";
+    CHECK_GE(reserved_bytes, 0) << "The reservation of tenant " << tenant
+                                << " must be non-negative";
+    CHECK(quota_bytes == 0 || reserved_bytes <= quota_bytes)
+        << "The reservation of tenant " << tenant << " is larger than its quota";
+    std::lock_guard<std::mutex> lock(mu_);
+    DevicePartitions* device = GetDevice(dev);
+    CHECK(reserved_bytes == 0 || device->capacity > 0)
+        << "The partition capacity of " << dev.c_str() << " must be set to reserve memory";
+    const auto& partition = GetPartition(device, tenant);
+    CHECK(reserved_bytes == 0 ||
+          GetReservedBytes(device) - partition->stats.reserved_bytes + reserved_bytes <=
+              device->capacity)
+        << "The reservations of the tenants exceed the partition capacity of " << dev.c_str();
+    partition->stats.quota_bytes = quota_bytes;
+    partition->stats.reserved_bytes = reserved_bytes;
+    enabled_ = true;
+  }
+
+  void SetCapacity(const Device& dev, int64_t nbytes) {
+    CHECK_GE(nbytes, 0) << "The partition capacity must be non-negative";
+    std::lock_guard<std::mutex> lock(mu_);
+    DevicePartitions* device = GetDevice(dev);
+    int64_t reserved = GetReservedBytes(device);
+    CHECK(nbytes == 0 ? reserved == 0 : reserved <= nbytes)
+        << "The partition capacity of " << dev.c_str() << " is smaller than the " << reserved
+        << " bytes reserved by the tenants";
+    device->capacity = nbytes;
+    enabled_ = true;
+  }
+
+  /*!
+   * \brief Charge the bytes to the current tenant of the thread, or fail if they exceed its quota
+   * or cut into the unused reservations of the other tenants.
+   * \return The partition charged, or nullptr if the device is not partitioned.
+   */
+  std::shared_ptr<Partition> Charge(const Device& dev, int64_t nbytes) {
+    const std::string& tenant = CurrentTenant();
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = devices_.find(GetKey(dev));
+    if (it == devices_.end()) {
+      return nullptr;
+    }
+    DevicePartitions* device = it->second.get();
+    std::shared_ptr<Partition> partition = GetPartition(device, tenant);
+    TenantStats& stats = partition->stats;
+    // The unused reservations of the other tenants.
+    int64_t reserved = 0;
+    for (const auto& kv : device->tenants) {
+      if (kv.second != partition) {
+        const TenantStats& other = kv.second->stats;
+        reserved += std::max<int64_t>(other.reserved_bytes - other.bytes_in_use, 0);
+      }
+    }
+    if (stats.quota_bytes > 0 && stats.bytes_in_use + nbytes > stats.quota_bytes) {
+      stats.num_rejected++;
+      LOG(FATAL) << "Tenant \"" << tenant << "\" failed to allocate " << nbytes << " bytes on "
+                 << dev.c_str() << ", which exceeds its quota of " << stats.quota_bytes
+                 << " bytes with " << stats.bytes_in_use << " bytes in use";
+    }
+    if (device->capacity > 0 && device->bytes_in_use + nbytes + reserved > device->capacity) {
+      stats.num_rejected++;
+      LOG(FATAL) << "Tenant \"" << tenant << "\" failed to allocate " << nbytes << " bytes on "
+                 << dev.c_str() << ", which has " << device->capacity - device->bytes_in_use
+                 << " bytes free in the partitions, " << reserved
+                 << " bytes of that reserved by the other tenants";
+    }
+    stats.bytes_in_use += nbytes;
+    stats.peak_bytes_in_use = std::max(stats.peak_bytes_in_use, stats.bytes_in_use);
+    stats.num_allocs++;
+    device->bytes_in_use += nbytes;
+    return partition;
+  }
+
+  void Uncharge(Partition* partition, int64_t nbytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    partition->stats.bytes_in_use -= nbytes;
+    partition->device->bytes_in_use -= nbytes;
+  }
+
+  std::unordered_map<std::string, TenantStats> GetStats(const Device& dev) {
+    std::unordered_map<std::string, TenantStats> ret;
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = devices_.find(GetKey(dev));
+    if (it != devices_.end()) {
+      for (const auto& kv : it->second->tenants) {
+        ret[kv.first] = kv.second->stats;
+      }
+    }
+    return ret;
+  }
+
+ private:
+  static int64_t GetKey(const Device& dev) {
+    return static_cast<int64_t>(static_cast<int>(dev.device_type())) << 32 | dev.device_id();
+  }
+
+  DevicePartitions* GetDevice(const Device& dev) {
+    auto& device = devices_[GetKey(dev)];
+    if (device == nullptr) {
+      device = std::make_unique<DevicePartitions>();
+    }
+    return device.get();
+  }
+
+  static const std::shared_ptr<Partition>& GetPartition(DevicePartitions* device,
+                                                        const std::string& tenant) {
+    auto& partition = device->tenants[tenant];
+    if (partition == nullptr) {
+      partition = std::make_shared<Partition>();
+      partition->device = device;
+    }
+    return partition;
+  }
+
+  static int64_t GetReservedBytes(const DevicePartitions* device) {
+    int64_t ret = 0;
+    for (const auto& kv : device->tenants) {
+      ret += kv.second->stats.reserved_bytes;
+    }
+    return ret;
+  }
+
+  /*! \brief Whether any device is partitioned. */
+  std::atomic<bool> enabled_{false};
+  std::unordered_map<int64_t, std::unique_ptr<DevicePartitions>> devices_;
+  /*! \brief The mutex to access the partitions. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief The bytes charged to the current tenant for a request. The charge is moved to the memory
+ * handed out, and the rest is returned when the request fails.
+ */
+class TenantCharge {
+ public:
+  TenantCharge(const Device& dev, int64_t nbytes) {
+    if (nbytes > 0 && TenantRegistry::Get()->Enabled()) {
+      partition_ = TenantRegistry::Get()->Charge(dev, nbytes);
+      nbytes_ = nbytes;
+    }
+  }
+
+  ~TenantCharge() {
+    if (partition_ != nullptr && nbytes_ > 0) {
+      TenantRegistry::Get()->Uncharge(partition_.get(), nbytes_);
+    }
+  }
+
+  /*!
+   * \brief Move the given bytes of the charge to the memory handed out, which returns them when
+   * released.
+   * \return The partition charged, or nullptr if the device is not partitioned.
+   */
+  std::shared_ptr<TenantRegistry::Partition> Move(int64_t nbytes) {
+    if (partition_ != nullptr) {
+      nbytes_ -= nbytes;
+    }
+    return partition_;
+  }
+
+ private:
+  std::shared_ptr<TenantRegistry::Partition> partition_;
+  /*! \brief The bytes charged and not moved to the memory yet. */
+  int64_t nbytes_ = 0;
+};
+
+/*!
+ * \brief The memory released after its events, e.g., the frees of a multi-stream schedule, which
+ * wait for the kernels still using the memory on the other streams. The allocations of a device
+ * poll the events of its entries and release the completed ones, so the pool reuses a buffer only
+ * after its users finished, without synchronizing the host.
+ */
+class DeferredFrees {
+ public:
+  static DeferredFrees* Get() {
+    static DeferredFrees* inst = new DeferredFrees();
+    return inst;
+  }
+
+  void Add(std::shared_ptr<Memory> memory, std::vector<std::shared_ptr<event_pool::Event>> events) {
+    std::lock_guard<std::mutex> lock(mu_);
+    entries_.push_back({std::move(memory), std::move(events)});
+    size_.store(entries_.size(), std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Release the entries of the device whose events completed.
+   * \param dev The device.
+   * \param wait Whether to wait for the events, so all the entries of the device are released.
+   * \return Whether any entry is released.
+   */
+  bool Reclaim(const Device& dev, bool wait) {
+    if (size_.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    // The memory is returned to the pool after the lock is released.
+    std::vector<std::shared_ptr<Memory>> released;
+    std::lock_guard<std::mutex> lock(mu_);
+    auto api = device_api::DeviceAPI::Get(dev.device_type());
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      const Device& mem_dev = it->memory->device;
+      if (mem_dev.device_type() == dev.device_type() && mem_dev.device_id() == dev.device_id() &&
+          Complete(api.get(), &it->events, wait)) {
+        released.push_back(std::move(it->memory));
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    size_.store(entries_.size(), std::memory_order_relaxed);
+    return !released.empty();
+  }
+
+ private:
+  struct Entry {
+    std::shared_ptr<Memory> memory;
+    std::vector<std::shared_ptr<event_pool::Event>> events;
+  };
+
+  /*! \brief Whether the events completed. The completed events are dropped. */
+  static bool Complete(device_api::DeviceAPI* api,
+                       std::vector<std::shared_ptr<event_pool::Event>>* events, bool wait) {
+    while (!events->empty()) {
+      void* event = events->back()->data();
+      if (wait) {
+        api->WaitEvent(event);
+      } else if (!api->QueryEvent(event)) {
+        return false;
+      }
+      events->pop_back();
+    }
+    return true;
+  }
+
+  std::list<Entry> entries_;
+  /*! \brief The number of the entries, so the allocations take no lock if there is none. */
+  std::atomic<size_t> size_{0};
+  std::mutex mu_;
+};
+
+/*!
+ * \brief Allocate from the pool, and wait for the deferred frees of the device and retry if the
+ * pool runs out of memory.
+ */
+inline std::shared_ptr<Memory> AllocOrWaitFrees(const Device& dev, MemoryPool* pool,
+                                                int64_t nbytes, int64_t alignment) {
+  try {
+    return pool->Alloc(nbytes, alignment);
+  } catch (const dmlc::Error& e) {
+    if (!DeferredFrees::Get()->Reclaim(dev, true)) {
+      throw;
+    }
+    return pool->Alloc(nbytes, alignment);
+  }
+}
+
 int64_t Memory::GetAllocBytes(const Device& dev, int64_t nbytes) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   return mgr->GetPool(dev, "")->GetAllocBytes(nbytes);
 }
 
+/*!
+ * \brief A thread-local front cache of the memory pools. A chunk released by the user is kept in
+ * the cache of the releasing thread, and handed out again to the next request of the same size
+ * class on that thread, so the common case of allocating and freeing similar sizes on one thread
+ * never reaches the shared pool state. Each size class keeps a bounded magazine of chunks, and
+ * the cache is bounded by the size set by Memory::SetThreadCacheSize. It is disabled by default.
+ * The caches are registered, so Memory::Compact drains the caches of all the threads. Each cache
+ * has its own mutex, which is only contended by the drains.
+ */
+class ThreadCache {
+ public:
+  /*! \brief The max number of chunks cached per size class. */
+  static constexpr size_t kMagazineSize = 16;
+
+  struct Key {
+    int device_type;
+    int device_id;
+    int64_t nbytes;
+    int64_t alignment;
+    /*! \brief The NUMA node of the pool arena, or -1 for the pool of the device. */
+    int numa_node;
+
+    bool operator==(const Key& other) const {
+      return device_type == other.device_type && device_id == other.device_id &&
+             nbytes == other.nbytes && alignment == other.alignment &&
+             numa_node == other.numa_node;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      size_t ret = std::hash<int64_t>()(key.nbytes);
+      ret = ret * 31 + std::hash<int64_t>()(key.alignment);
+      ret = ret * 31 + std::hash<int>()(key.numa_node);
+      ret = ret * 31 + std::hash<int>()(key.device_type);
+      return ret * 31 + std::hash<int>()(key.device_id);
+    }
+  };
+
+  ThreadCache() {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    Registry().insert(this);
+  }
+
+  ~ThreadCache() {
+    {
+      std::lock_guard<std::mutex> lock(RegistryMutex());
+      Registry().erase(this);
+    }
+    Alive() = false;
+  }
+
+  /*! \brief The thread-local cache, or nullptr if the thread is exiting. */
+  static ThreadCache* Get() {
+    // Alive is trivially destructible, so it can be read after the cache is destructed.
+    if (!Alive()) {
+      return nullptr;
+    }
+    thread_local ThreadCache cache;
+    return &cache;
+  }
+
+  /*! \brief The max bytes cached per thread. 0 disables the cache. */
+  static std::atomic<int64_t>& Capacity() {
+    static std::atomic<int64_t> capacity{[]() -> int64_t {
+      const char* val = getenv("RAF_MEMORY_THREAD_CACHE_MB");
+      return val == nullptr ? 0 : atol(val) * 1048576;
+    }()};
+    return capacity;
+  }
+
+  /*! \brief The generation of the pools, which is bumped when any pool is removed. */
+  static std::atomic<uint64_t>& Generation() {
+    static std::atomic<uint64_t> generation{0};
+    return generation;
+  }
+
+  /*!
+   * \brief Take a cached chunk of the size class.
+   * \param key The size class.
+   * \param generation The current generation, which is set to hand out the chunk.
+   * \return The chunk, or nullptr if none is cached.
+   */
+  std::shared_ptr<Memory> Pop(const Key& key, uint64_t* generation) {
+    std::lock_guard<std::mutex> lock(mu_);
+    *generation = Sync();
+    auto it = bins_.find(key);
+    if (it == bins_.end() || it->second.empty()) {
+      return nullptr;
+    }
+    std::shared_ptr<Memory> memory = std::move(it->second.back());
+    it->second.pop_back();
+    cached_bytes_ -= key.nbytes;
+    return memory;
+  }
+
+  void Push(const Key& key, std::shared_ptr<Memory> memory, uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (generation != Sync() ||
+        cached_bytes_ + key.nbytes > Capacity().load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto& bin = bins_[key];
+    if (bin.size() >= kMagazineSize) {
+      return;
+    }
+    bin.push_back(std::move(memory));
+    cached_bytes_ += key.nbytes;
+  }
+
+  /*!
+   * \brief Drop the chunks of the device cached by all the threads, so they are returned to the
+   * pool right away.
+   * \param dev The device.
+   * \return The bytes of the dropped chunks.
+   */
+  static int64_t DrainAll(const Device& dev) {
+    int64_t total = 0;
+    std::vector<std::shared_ptr<Memory>> dropped;
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    for (ThreadCache* cache : Registry()) {
+      std::lock_guard<std::mutex> cache_lock(cache->mu_);
+      for (auto it = cache->bins_.begin(); it != cache->bins_.end();) {
+        const Key& key = it->first;
+        if (key.device_type == dev.device_type() && key.device_id == dev.device_id()) {
+          int64_t nbytes = key.nbytes * it->second.size();
+          cache->cached_bytes_ -= nbytes;
+          total += nbytes;
+          std::move(it->second.begin(), it->second.end(), std::back_inserter(dropped));
+          it = cache->bins_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    return total;
+  }
+
+ private:
+  /*!
+   * \brief Drop the cached chunks if the pools have been changed since they were cached. It is
+   * called with mu_ held.
+   * \return The current generation.
+   */
+  uint64_t Sync() {
+    uint64_t generation = Generation().load(std::memory_order_relaxed);
+    if (generation != generation_) {
+      bins_.clear();
+      cached_bytes_ = 0;
+      generation_ = generation;
+    }
+    return generation;
+  }
+
+  static bool& Alive() {
+    thread_local bool alive = true;
+    return alive;
+  }
+
+  /*! \brief The caches of the live threads. They are leaked to outlive the exiting threads. */
+  static std::unordered_set<ThreadCache*>& Registry() {
+    static auto* registry = new std::unordered_set<ThreadCache*>();
+    return *registry;
+  }
+
+  static std::mutex& RegistryMutex() {
+    static auto* mu = new std::mutex();
+    return *mu;
+  }
+
+  /*! \brief The magazines of the size classes. Each chunk is shared with the pool. */
+  std::unordered_map<Key, std::vector<std::shared_ptr<Memory>>, KeyHash> bins_;
+  /*! \brief The bytes of the cached chunks. */
+  int64_t cached_bytes_ = 0;
+  /*! \brief The generation of the pools the cached chunks belong to. */
+  uint64_t generation_ = Generation().load();
+  /*! \brief The mutex to access the magazines, which is taken by the drains of other threads. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief The release of a chunk handed out to the user. It is the deleter of the only pointer
+ * wrapping the chunk, which returns the charge of the tenant and puts the chunk into the cache of
+ * the releasing thread, so a request allocates one wrapper at most however many of them are
+ * enabled, and none unless the device is partitioned or the thread cache is on. The bytes in use
+ * are counted by the pool itself.
+ */
+struct Release {
+  /*! \brief The chunk of the pool. */
+  std::shared_ptr<Memory> memory;
+  /*! \brief The bytes handed out. */
+  int64_t nbytes = 0;
+  /*! \brief The partition charged, or nullptr if the device is not partitioned. */
+  std::shared_ptr<TenantRegistry::Partition> partition;
+  /*! \brief Whether the chunk is put into the thread cache, and its size class and generation. */
+  bool cached = false;
+  ThreadCache::Key key{};
+  uint64_t generation = 0;
+
+  void operator()(Memory*) {
+    if (partition != nullptr) {
+      TenantRegistry::Get()->Uncharge(partition.get(), nbytes);
+    }
+    if (cached) {
+      if (auto cache = ThreadCache::Get()) {
+        cache->Push(key, std::move(memory), generation);
+      }
+    }
+    // The deleter may be destroyed later than it is called, so release the memory right away.
+    memory.reset();
+  }
+};
+
+/*!
+ * \brief Hand out a chunk of the pool to the user, which is counted in the stats of the pool and
+ * charged to the tenant until it is released.
+ * \param pool The pool of the chunk.
+ * \param nbytes The bytes handed out.
+ * \param memory The chunk.
+ * \param charge The charge of the request, whose bytes are moved to the chunk.
+ * \param key The size class to put the chunk into the thread cache when it is released, if any.
+ * \param generation The generation of the pools when the chunk is allocated.
+ * \return The pointer sharing the chunk.
+ */
+std::shared_ptr<Memory> HandOut(MemoryPool* pool, int64_t nbytes, std::shared_ptr<Memory> memory,
+                                TenantCharge* charge, const ThreadCache::Key* key = nullptr,
+                                uint64_t generation = 0) {
+  if (memory->data == nullptr) {
+    return memory;
+  }
+  if (StatsEnabled()) {
+    CountAlloc(pool, nbytes);
+  }
+  Release release;
+  release.nbytes = nbytes;
+  release.partition = charge->Move(nbytes);
+  if (key != nullptr) {
+    release.cached = true;
+    release.key = *key;
+    release.generation = generation;
+  }
+  if (release.partition == nullptr && !release.cached) {
+    return memory;
+  }
+  Memory* raw = memory.get();
+  release.memory = std::move(memory);
+  return std::shared_ptr<Memory>(raw, std::move(release));
+}
+
 std::shared_ptr<Memory> Memory::Alloc(const Device& dev, int64_t nbytes, int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   CheckAlignment(alignment);
-  return mgr->GetPool(dev, "")->Alloc(nbytes, alignment);
+  MemoryPool* pool = mgr->GetPool(dev, "");
+  int64_t alloc_bytes = pool->GetAllocBytes(nbytes);
+  DeferredFrees::Get()->Reclaim(dev, false);
+  TenantCharge charge(dev, alloc_bytes);
+  if (nbytes == 0 || ThreadCache::Capacity().load(std::memory_order_relaxed) == 0) {
+    return HandOut(pool, alloc_bytes, AllocOrWaitFrees(dev, pool, nbytes, alignment), &charge);
+  }
+  int numa_node = dev.device_type() == DevType::kCPU() ? device_api::cpu::GetNumaNode() : -1;
+  ThreadCache::Key key{dev.device_type(), dev.device_id(), alloc_bytes, alignment, numa_node};
+  if (auto cache = ThreadCache::Get()) {
+    uint64_t generation = 0;
+    if (auto memory = cache->Pop(key, &generation)) {
+      pool->stats->num_thread_cache_hits.fetch_add(1, std::memory_order_relaxed);
+      return HandOut(pool, key.nbytes, std::move(memory), &charge, &key, generation);
+    }
+  }
+  uint64_t generation = ThreadCache::Generation().load(std::memory_order_relaxed);
+  std::shared_ptr<Memory> memory;
+  try {
+    memory = pool->Alloc(key.nbytes, alignment);
+  } catch (const dmlc::Error& e) {
+    // The pool cannot reclaim the chunks held by the thread caches, so release them and retry.
+    DLOG(WARNING) << "Failed to allocate " << key.nbytes << " bytes. Reclaimed "
+                  << Memory::Compact(dev) << " bytes and retry";
+    generation = ThreadCache::Generation().load(std::memory_order_relaxed);
+    memory = pool->Alloc(key.nbytes, alignment);
+  }
+  return HandOut(pool, key.nbytes, std::move(memory), &charge, &key, generation);
+}
+
+int64_t Memory::Compact(const Device& dev) {
+  MemoryPoolManager* mgr = MemoryPoolManager::Get();
+  DeferredFrees::Get()->Reclaim(dev, true);
+  // Return the chunks cached by all the threads to the pool first, so the pool can free them.
+  ThreadCache::DrainAll(dev);
+  return mgr->GetPool(dev, "")->Compact();
+}
+
+void Memory::SetThreadCacheSize(int64_t nbytes) {
+  CHECK_GE(nbytes, 0) << "The size of the thread cache must be non-negative";
+  ThreadCache::Capacity() = nbytes;
+  // Drop the chunks cached so far, which may exceed the new size.
+  ThreadCache::Generation()++;
+}
+
+void Memory::FreeAfter(std::shared_ptr<Memory> memory,
+                       std::vector<std::shared_ptr<event_pool::Event>> events) {
+  if (memory == nullptr || events.empty()) {
+    return;
+  }
+  DeferredFrees::Get()->Add(std::move(memory), std::move(events));
 }
 
 std::shared_ptr<Memory> Memory::AllocAsync(const Device& dev, int64_t nbytes, void* stream,
                                            int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   CheckAlignment(alignment);
-  return mgr->GetPool(dev, "")->AllocAsync(nbytes, stream, alignment);
+  MemoryPool* pool = mgr->GetPool(dev, "");
+  pool->stats->num_async_allocs.fetch_add(1, std::memory_order_relaxed);
+  DeferredFrees::Get()->Reclaim(dev, false);
+  int64_t alloc_bytes = pool->GetAllocBytes(nbytes);
+  TenantCharge charge(dev, alloc_bytes);
+  return HandOut(pool, alloc_bytes, pool->AllocAsync(nbytes, stream, alignment), &charge);
 }
 
 std::vector<std::shared_ptr<Memory> > Memory::AllocBatch(const Device& dev,
@@ -104,7 +756,21 @@ std::vector<std::shared_ptr<Memory> > Memory::AllocBatch(const Device& dev,
                                                          int64_t alignment) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   CheckAlignment(alignment);
-  return mgr->GetPool(dev, "")->AllocBatch(nbytes, alignment);
+  MemoryPool* pool = mgr->GetPool(dev, "");
+  std::vector<int64_t> alloc_bytes;
+  int64_t total_bytes = 0;
+  for (int64_t n : nbytes) {
+    alloc_bytes.push_back(pool->GetAllocBytes(n));
+    total_bytes += alloc_bytes.back();
+  }
+  // The batch is charged as a whole, so it either fits in the partition or fails as a whole.
+  DeferredFrees::Get()->Reclaim(dev, false);
+  TenantCharge charge(dev, total_bytes);
+  auto ret = pool->AllocBatch(nbytes, alignment);
+  for (size_t i = 0; i < ret.size(); ++i) {
+    ret[i] = HandOut(pool, alloc_bytes[i], std::move(ret[i]), &charge);
+  }
+  return ret;
 }
 
 std::pair<float, float> Memory::GetPoolSize(const Device& dev) {
@@ -114,16 +780,95 @@ std::pair<float, float> Memory::GetPoolSize(const Device& dev) {
 
 void Memory::RemovePool(const Device& dev) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
+  // The cached chunks of the removed pool must not be handed out for the new pool.
+  ThreadCache::Generation()++;
   mgr->Remove(dev);
 }
 
 MemoryPool* Memory::ResetPool(const Device& dev) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   std::string pool_name = mgr->GetPool(dev, "")->GetName();
+  ThreadCache::Generation()++;
   mgr->Remove(dev);
   return mgr->GetPool(dev, pool_name);
 }
 
+/*! \brief The tags interned by Memory::InternTag, which are shared by the pools. */
+class TagRegistry {
+ public:
+  static TagRegistry* Get() {
+    static TagRegistry* instance = new TagRegistry();
+    return instance;
+  }
+
+  int Intern(const std::string& tag) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = indices_.find(tag);
+    if (it != indices_.end()) {
+      return it->second;
+    }
+    int index = tags_.size();
+    if (index >= PoolStats::kMaxTags) {
+      return -1;
+    }
+    indices_.emplace(tag, index);
+    tags_.push_back(tag);
+    return index;
+  }
+
+  std::vector<std::string> GetTags() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return tags_;
+  }
+
+ private:
+  std::vector<std::string> tags_;
+  std::unordered_map<std::string, int> indices_;
+  /*! \brief The mutex to access the tags. */
+  std::mutex mu_;
+};
+
+int Memory::InternTag(const std::string& tag) {
+  return TagRegistry::Get()->Intern(tag);
+}
+
+std::vector<std::string> Memory::GetTags() {
+  return TagRegistry::Get()->GetTags();
+}
+
+void Memory::RecordTag(const Device& dev, int tag) {
+  if (tag < 0 || !StatsEnabled()) {
+    return;
+  }
+  MemoryPool* pool = MemoryPoolManager::Get()->GetPool(dev, "");
+  PoolStats* stats = pool->stats.get();
+  if (stats->bytes_in_use.load(std::memory_order_relaxed) >
+      stats->tag_peak_bytes[tag].load(std::memory_order_relaxed)) {
+    // The bytes in use may still count the chunks released without the pool noticing.
+    stats->RecordTag(tag, pool->GetBytesInUse());
+  }
+}
+
+void Memory::SetTenantQuota(const Device& dev, const std::string& tenant, int64_t quota_bytes,
+                            int64_t reserved_bytes) {
+  TenantRegistry::Get()->SetQuota(dev, tenant, quota_bytes, reserved_bytes);
+}
+
+void Memory::SetPartitionCapacity(const Device& dev, int64_t nbytes) {
+  TenantRegistry::Get()->SetCapacity(dev, nbytes);
+}
+
+std::string Memory::SetCurrentTenant(const std::string& tenant) {
+  std::string& current = TenantRegistry::CurrentTenant();
+  std::string prev = current;
+  current = tenant;
+  return prev;
+}
+
+std::unordered_map<std::string, TenantStats> Memory::GetTenantStats(const Device& dev) {
+  return TenantRegistry::Get()->GetStats(dev);
+}
+
 MemoryPool* Memory::GetPool(const Device& dev) {
   MemoryPoolManager* mgr = MemoryPoolManager::Get();
   return mgr->GetPool(dev, "");
@@ -178,5 +923,97 @@ RAF_REGISTER_GLOBAL("raf.memory_pool.ResetPool").set_body_typed([](const Device&
   return ResetPool(dev);
 });
 
+RAF_REGISTER_GLOBAL("raf.memory_pool.Compact").set_body_typed([](const Device& dev) {
+  return Memory::Compact(dev);
+});
+
+/*!
+ * \brief Get the counters of the memory pool of the given device.
+ *
+ * \param dev The device that the pool belongs to.
+ * \return The counters, the cache hit rate, the bytes used and reserved by the pool, the
+ * histogram of the requested sizes, and the high-water marks of the tags.
+ */
+ir::Map<ir::String, ir::ObjectRef> GetStats(const Device& dev) {
+  using namespace raf::ir;
+  auto make_int = [](int64_t value) { return IntImm(DataType::Int(64), value); };
+  MemoryPool* pool = Memory::GetPool(dev);
+  const PoolStats& stats = *pool->stats;
+  Map<String, ObjectRef> ret;
+  ret.Set("name", String(pool->GetName()));
+  int64_t num_allocs = stats.num_allocs.load();
+  ret.Set("num_allocs", make_int(num_allocs));
+  ret.Set("num_async_allocs", make_int(stats.num_async_allocs.load()));
+  ret.Set("num_thread_cache_hits", make_int(stats.num_thread_cache_hits.load()));
+  ret.Set("num_device_allocs", make_int(stats.num_device_allocs.load()));
+  double hit_rate =
+      num_allocs == 0 ? 0.0 : 1.0 - static_cast<double>(stats.num_device_allocs) / num_allocs;
+  ret.Set("cache_hit_rate", FloatImm(DataType::Float(64), std::max(hit_rate, 0.0)));
+  ret.Set("bytes_in_use", make_int(pool->GetBytesInUse()));
+  ret.Set("peak_bytes_in_use", make_int(stats.peak_bytes_in_use.load()));
+  auto pool_size = pool->GetPoolSize();
+  ret.Set("used_mb", FloatImm(DataType::Float(64), pool_size.first));
+  ret.Set("reserved_mb", FloatImm(DataType::Float(64), pool_size.second));
+  Array<IntImm> histogram;
+  for (const auto& count : stats.size_histogram) {
+    histogram.push_back(make_int(count.load()));
+  }
+  ret.Set("size_histogram", histogram);
+  Map<String, IntImm> tags;
+  std::vector<std::string> tag_names = Memory::GetTags();
+  for (size_t i = 0; i < tag_names.size(); ++i) {
+    // The tags are shared by the pools, and the ones not recorded in this pool are left out.
+    if (int64_t peak = stats.tag_peak_bytes[i].load()) {
+      tags.Set(tag_names[i], make_int(peak));
+    }
+  }
+  ret.Set("tag_peak_bytes", tags);
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.GetStats").set_body_typed(GetStats);
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.SetThreadCacheSize").set_body_typed([](double size_mb) {
+  Memory::SetThreadCacheSize(static_cast<int64_t>(size_mb * 1048576));
+});
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.SetTenantQuota")
+    .set_body_typed([](const Device& dev, const std::string& tenant, double quota_mb,
+                       double reserved_mb) {
+      Memory::SetTenantQuota(dev, tenant, static_cast<int64_t>(quota_mb * 1048576),
+                             static_cast<int64_t>(reserved_mb * 1048576));
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.SetPartitionCapacity")
+    .set_body_typed([](const Device& dev, double capacity_mb) {
+      Memory::SetPartitionCapacity(dev, static_cast<int64_t>(capacity_mb * 1048576));
+    });
+
+/*!
+ * \brief Get the partitions of the tenants of the given device and their counters.
+ *
+ * \param dev The device that the partitions belong to.
+ * \return The quota, the reservation and the counters of each tenant.
+ */
+ir::Map<ir::String, ir::Map<ir::String, ir::IntImm>> GetTenantStats(const Device& dev) {
+  using namespace raf::ir;
+  auto make_int = [](int64_t value) { return IntImm(DataType::Int(64), value); };
+  Map<String, Map<String, IntImm>> ret;
+  for (const auto& kv : Memory::GetTenantStats(dev)) {
+    const TenantStats& stats = kv.second;
+    Map<String, IntImm> tenant;
+    tenant.Set("quota_bytes", make_int(stats.quota_bytes));
+    tenant.Set("reserved_bytes", make_int(stats.reserved_bytes));
+    tenant.Set("bytes_in_use", make_int(stats.bytes_in_use));
+    tenant.Set("peak_bytes_in_use", make_int(stats.peak_bytes_in_use));
+    tenant.Set("num_allocs", make_int(stats.num_allocs));
+    tenant.Set("num_rejected", make_int(stats.num_rejected));
+    ret.Set(kv.first, tenant);
+  }
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.GetTenantStats").set_body_typed(GetTenantStats);
+
 }  // namespace memory_pool
 }  // namespace raf
@@ -0,0 +1,243 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/remote_cache.cc
+ * \brief The remote tier of the persistent caches.
+ */
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "raf/file.h"
+#include "raf/registry.h"
+#include "raf/remote_cache.h"
+
+namespace raf {
+namespace op {
+
+using registry::PackedFunc;
+
+namespace {
+/*! \brief The key of the manifest of a model fingerprint. */
+std::string ManifestKey(const std::string& fingerprint) {
+  return "manifests/" + fingerprint;
+}
+
+/*! \brief Create the missing parent directories of a path under the root. */
+void CreateParentDirs(const std::string& root, const std::string& key) {
+  for (size_t pos = key.find('/'); pos != std::string::npos; pos = key.find('/', pos + 1)) {
+    CreateDir(root + "/" + key.substr(0, pos));
+  }
+}
+}  // namespace
+
+DirRemoteCacheBackend::DirRemoteCacheBackend(const std::string& root) : root_(root) {
+  CreateDir(root_);
+}
+
+bool DirRemoteCacheBackend::Fetch(const std::string& key, const std::string& local_dir) {
+  std::string path = root_ + "/" + key;
+  if (!DirExists(path)) {
+    return false;
+  }
+  return CopyPath(path, local_dir);
+}
+
+void DirRemoteCacheBackend::Upload(const std::string& key, const std::string& local_dir) {
+  // Copy to a temporary directory and rename it, so the other nodes never fetch a partial object.
+  std::string path = root_ + "/" + key;
+  std::string temp_path = path + ".tmp." + std::to_string(getpid());
+  CreateParentDirs(root_, key);
+  RemovePath(temp_path);
+  CHECK(CopyPath(local_dir, temp_path)) << "Failed to copy " << local_dir << " to " << temp_path;
+  RemovePath(path);
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    RemovePath(temp_path);
+  }
+}
+
+/*!
+ * \brief The backend of the functions registered by the frontend, e.g., which access an object
+ * store by its client library.
+ */
+class PackedFuncRemoteCacheBackend : public RemoteCacheBackend {
+ public:
+  PackedFuncRemoteCacheBackend(PackedFunc fetch, PackedFunc upload)
+      : fetch_(std::move(fetch)), upload_(std::move(upload)) {
+  }
+
+  bool Fetch(const std::string& key, const std::string& local_dir) override {
+    return fetch_(key, local_dir);
+  }
+
+  void Upload(const std::string& key, const std::string& local_dir) override {
+    upload_(key, local_dir);
+  }
+
+ private:
+  PackedFunc fetch_;
+  PackedFunc upload_;
+};
+
+RemoteCache* RemoteCache::Get() {
+  // It is never destroyed, as the uploads may call into the frontend, which is finalized first.
+  static RemoteCache* inst = new RemoteCache();
+  return inst;
+}
+
+void RemoteCache::SetBackend(std::shared_ptr<RemoteCacheBackend> backend) {
+  std::lock_guard<std::mutex> lock(mu_);
+  backend_ = std::move(backend);
+  if (backend_ && !worker_started_) {
+    std::thread(&RemoteCache::UploadLoop, this).detach();
+    worker_started_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool RemoteCache::Enabled() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return backend_ != nullptr;
+}
+
+std::shared_ptr<RemoteCacheBackend> RemoteCache::GetBackend() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return backend_;
+}
+
+bool RemoteCache::Fetch(const std::string& cache_name, const std::string& entry_name,
+                        const std::string& local_dir) {
+  auto backend = GetBackend();
+  if (backend == nullptr) {
+    return false;
+  }
+  try {
+    return backend->Fetch(cache_name + "/" + entry_name, local_dir);
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Failed to fetch " << cache_name << "/" << entry_name << ": " << e.what();
+    return false;
+  }
+}
+
+void RemoteCache::UploadAsync(const std::string& cache_name, const std::string& entry_name,
+                              const std::string& local_dir) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (backend_ == nullptr) {
+    return;
+  }
+  uploads_.emplace_back(cache_name + "/" + entry_name, local_dir);
+  cv_.notify_all();
+}
+
+void RemoteCache::Record(const std::string& cache_name, const std::string& entry_name) {
+  std::lock_guard<std::mutex> lock(mu_);
+  recorded_.emplace(cache_name, entry_name);
+}
+
+void RemoteCache::Flush() {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return (uploads_.empty() || backend_ == nullptr) && running_ == 0; });
+}
+
+void RemoteCache::UploadLoop() {
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    cv_.wait(lock, [this]() { return !uploads_.empty() && backend_ != nullptr; });
+    auto upload = std::move(uploads_.front());
+    uploads_.pop_front();
+    auto backend = backend_;
+    ++running_;
+    lock.unlock();
+    try {
+      // The local entry may be evicted by the garbage collection before it is uploaded.
+      if (DirExists(upload.second)) {
+        backend->Upload(upload.first, upload.second);
+      }
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "Failed to upload " << upload.first << ": " << e.what();
+    }
+    lock.lock();
+    --running_;
+    cv_.notify_all();
+  }
+}
+
+int RemoteCache::Publish(const std::string& fingerprint) {
+  Flush();
+  auto backend = GetBackend();
+  if (backend == nullptr) {
+    return 0;
+  }
+  std::ostringstream os;
+  int num_entries = 0;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& it : recorded_) {
+      os << it.first << " " << it.second << "\n";
+    }
+    num_entries = recorded_.size();
+  }
+  char temp_dir[] = "/tmp/raf_manifest_XXXXXX";
+  CHECK(mkdtemp(temp_dir) != nullptr) << "Failed to create a temporary directory";
+  {
+    std::ofstream ofs(std::string(temp_dir) + "/manifest");
+    ofs << os.str();
+  }
+  try {
+    backend->Upload(ManifestKey(fingerprint), temp_dir);
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Failed to publish the manifest of " << fingerprint << ": " << e.what();
+    num_entries = 0;
+  }
+  RemovePath(temp_dir);
+  return num_entries;
+}
+
+std::vector<std::pair<std::string, std::string>> RemoteCache::FetchManifest(
+    const std::string& fingerprint) {
+  std::vector<std::pair<std::string, std::string>> entries;
+  auto backend = GetBackend();
+  if (backend == nullptr) {
+    return entries;
+  }
+  char temp_dir[] = "/tmp/raf_manifest_XXXXXX";
+  CHECK(mkdtemp(temp_dir) != nullptr) << "Failed to create a temporary directory";
+  try {
+    if (backend->Fetch(ManifestKey(fingerprint), temp_dir)) {
+      std::ifstream ifs(std::string(temp_dir) + "/manifest");
+      std::string cache_name, entry_name;
+      while (ifs >> cache_name >> entry_name) {
+        entries.emplace_back(cache_name, entry_name);
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Failed to fetch the manifest of " << fingerprint << ": " << e.what();
+  }
+  RemovePath(temp_dir);
+  return entries;
+}
+
+RAF_REGISTER_GLOBAL("raf.cache.SetRemoteCacheDir").set_body_typed([](std::string root) {
+  RemoteCache::Get()->SetBackend(root.empty() ? nullptr
+                                              : std::make_shared<DirRemoteCacheBackend>(root));
+});
+RAF_REGISTER_GLOBAL("raf.cache.SetRemoteCacheFuncs")
+    .set_body_typed([](PackedFunc fetch, PackedFunc upload) {
+      RemoteCache::Get()->SetBackend(
+          std::make_shared<PackedFuncRemoteCacheBackend>(std::move(fetch), std::move(upload)));
+    });
+RAF_REGISTER_GLOBAL("raf.cache.DisableRemoteCache").set_body_typed([]() {
+  RemoteCache::Get()->SetBackend(nullptr);
+});
+RAF_REGISTER_GLOBAL("raf.cache.FlushRemoteCache").set_body_typed([]() {
+  RemoteCache::Get()->Flush();
+});
+RAF_REGISTER_GLOBAL("raf.cache.PublishRemoteCache").set_body_typed([](std::string fingerprint) {
+  return RemoteCache::Get()->Publish(fingerprint);
+});
+
+}  // namespace op
+}  // namespace raf
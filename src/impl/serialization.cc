@@ -7,10 +7,22 @@
  * \file src/impl/serialization.cc
  * \brief RAF serialization underlying implementation
  */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <dmlc/memory_io.h>
 #include <tvm/node/serialization.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include "raf/memory_pool.h"
 #include "raf/pass.h"
 #include "raf/registry.h"
 #include "raf/serialization.h"
+#include "../common/shape_utils.h"
 
 namespace raf {
 namespace ir {
@@ -20,6 +32,13 @@ using namespace value;
 
 class IRRewrite4Saver : public ir::ExprMutator {
  public:
+  /*!
+   * \param constants The constants to be stored out-of-line, which are referred by their indices
+   * in the IR, or nullptr to embed the constants in the IR.
+   */
+  explicit IRRewrite4Saver(std::vector<Value>* constants = nullptr) : constants_(constants) {
+  }
+
   ir::Expr VisitExpr(const ir::Expr& expr) override {
     auto ret = ir::ExprMutator::VisitExpr(expr);
     ret->checked_type_ = expr->checked_type_;
@@ -43,11 +62,26 @@ class IRRewrite4Saver : public ir::ExprMutator {
 
   ir::Expr VisitExpr_(const tvm::relay::ConstantNode* _node) override {
     const ir::ConstantNode* node = static_cast<const ir::ConstantNode*>(_node);
+    if (constants_ != nullptr) {
+      auto it = constant_index_.find(node->value.get());
+      if (it == constant_index_.end()) {
+        it = constant_index_.emplace(node->value.get(), constants_->size()).first;
+        constants_->push_back(Downcast<Value>(node->value));
+      }
+      ir::ObjectPtr<ConstantRefNode> n = ir::make_object<ConstantRefNode>();
+      n->index = it->second;
+      return ir::Expr(n);
+    }
     ir::ObjectPtr<serialization::ConstantNode> n = ir::make_object<serialization::ConstantNode>();
     n->data = node->data;
     n->value = node->value;
     return ir::Expr(n);
   }
+
+ private:
+  std::vector<Value>* constants_;
+  /*! \brief The indices of the saved constants, so a shared constant is saved once. */
+  std::unordered_map<const Object*, int64_t> constant_index_;
 };
 
 class IRRewrite4Loader : public ir::ExprMutator {
@@ -78,29 +112,29 @@ class IRRewrite4Loader : public ir::ExprMutator {
   }
 };
 
-template <typename T>
-ir::ObjectRef Normalize(const ir::ObjectRef& n) {
+template <typename T, typename... Args>
+ir::ObjectRef Normalize(const ir::ObjectRef& n, Args... args) {
   if (const ir::IRModuleNode* mod = n.as<ir::IRModuleNode>()) {
     ir::IRModule updated_mod = ir::IRModule();
     for (auto kv : mod->functions) {
-      ir::Expr func = T()(kv.second);
+      ir::Expr func = T(args...)(kv.second);
       // updated_mod->Add cannot be used, which runs InferType automatically
       // However, InferType cannot visit serialization::ConstantNode
       updated_mod->AddUnchecked(kv.first, Downcast<ir::Function>(func));
     }
     return updated_mod;
   } else if (const ExprNode* e = n.as<ExprNode>()) {
-    return T().VisitExpr(GetRef<ir::Expr>(e));
+    return T(args...).VisitExpr(GetRef<ir::Expr>(e));
   } else if (const ir::ArrayNode* a = n.as<ir::ArrayNode>()) {
     Array<ir::ObjectRef, ir::ObjectRef> updated_array;
     for (const auto& x : *a) {
-      updated_array.push_back(Normalize<T>(x));
+      updated_array.push_back(Normalize<T>(x, args...));
     }
     return updated_array;
   } else if (const ir::MapNode* m = n.as<ir::MapNode>()) {
     Map<ir::ObjectRef, ir::ObjectRef> updated_map;
     for (const auto& kv : *m) {
-      updated_map.Set(kv.first, Normalize<T>(kv.second));
+      updated_map.Set(kv.first, Normalize<T>(kv.second, args...));
     }
     return updated_map;
   }
@@ -119,6 +153,189 @@ ir::ObjectPtr<ir::Object> CreateConstantNode(const std::string& s) {
   return ir::MakeConstantNode(tvm::LoadJSON(s));
 }
 
+/*! \brief The constants of the binary IR being loaded by this thread. */
+thread_local const std::vector<Value>* loading_constants = nullptr;
+
+ir::ObjectPtr<ir::Object> CreateConstantRefNode(const std::string& s) {
+  CHECK(loading_constants != nullptr) << "ConstantRef can only be loaded by LoadBinary";
+  size_t index = std::stoull(s);
+  CHECK_LT(index, loading_constants->size()) << "Invalid constant index " << index;
+  return ir::MakeConstantNode((*loading_constants)[index]);
+}
+
+MappedFile::MappedFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Cannot open " << path;
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << path;
+  size_ = st.st_size;
+  // The mapping is private, so an accidental write to a constant only touches a copy of the
+  // page instead of the file.
+  addr_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  CHECK(addr_ != MAP_FAILED) << "Cannot mmap " << path;
+}
+
+MappedFile::~MappedFile() {
+  munmap(addr_, size_);
+}
+
+/*! \brief A chunk of host memory inside a mapped file, which keeps the mapping alive. */
+class MappedMemory : public memory_pool::Memory {
+ public:
+  MappedMemory(std::shared_ptr<MappedFile> file, const char* data) : file_(file) {
+    this->data = const_cast<char*>(data);
+    this->device = Device(DevType::kCPU(), 0);
+  }
+
+ private:
+  std::shared_ptr<MappedFile> file_;
+};
+
+/*! \brief The kind of an entry in the memory-mapped values. */
+enum MappedValueKind : uint8_t {
+  /*! \brief The value is serialized inline. */
+  kInlineValue = 0,
+  /*! \brief The tensor data is stored in the data region. */
+  kMappedTensor = 1,
+};
+
+inline uint64_t AlignMappedOffset(uint64_t offset) {
+  return (offset + kMappedDataAlignment - 1) / kMappedDataAlignment * kMappedDataAlignment;
+}
+
+void SaveMappedValues(dmlc::Stream* strm, const std::vector<Value>& values,
+                      std::vector<Value>* blobs) {
+  strm->Write(static_cast<uint64_t>(values.size()));
+  uint64_t offset = 0;
+  for (const auto& blob : *blobs) {
+    const DLTensor* dlt = Downcast<TensorValue>(blob);
+    offset = AlignMappedOffset(offset + common::shape_utils::BytesCompactTensor(*dlt));
+  }
+  for (const auto& value : values) {
+    const auto* tensor = value.as<TensorValueObj>();
+    if (tensor == nullptr) {
+      strm->Write(static_cast<uint8_t>(kInlineValue));
+      SerializeValue(strm, value);
+      continue;
+    }
+    // The pinned host tensors are written directly.
+    auto dev_type = tensor->tensor->device.device_type;
+    Value host = value;
+    if (dev_type != kDLCPU && dev_type != kDLCUDAHost) {
+      host = CopyTo(value, Device(DevType::kCPU(), 0));
+    }
+    const DLTensor* dlt = Downcast<TensorValue>(host);
+    CHECK(dlt->strides == nullptr) << "Only compact tensors can be mapped";
+    uint64_t nbytes = common::shape_utils::BytesCompactTensor(*dlt);
+    strm->Write(static_cast<uint8_t>(kMappedTensor));
+    strm->Write(dlt->dtype);
+    strm->Write(std::vector<int64_t>(dlt->shape, dlt->shape + dlt->ndim));
+    strm->Write(offset);
+    strm->Write(nbytes);
+    blobs->push_back(host);
+    offset = AlignMappedOffset(offset + nbytes);
+  }
+}
+
+std::vector<Value> LoadMappedValues(dmlc::Stream* strm, std::shared_ptr<MappedFile> file,
+                                    const char* data) {
+  uint64_t size;
+  CHECK(strm->Read(&size)) << "Invalid mapped values";
+  std::vector<Value> values;
+  values.reserve(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    uint8_t kind;
+    CHECK(strm->Read(&kind)) << "Invalid mapped values";
+    if (kind == kInlineValue) {
+      values.push_back(DeserializeValue(strm));
+      continue;
+    }
+    CHECK_EQ(kind, kMappedTensor) << "Invalid mapped values";
+    DLDataType dtype;
+    std::vector<int64_t> shape;
+    uint64_t offset, nbytes;
+    CHECK(strm->Read(&dtype) && strm->Read(&shape) && strm->Read(&offset) && strm->Read(&nbytes))
+        << "Invalid mapped values";
+    CHECK_LE(data + offset + nbytes, file->data() + file->size()) << "Truncated mapped file";
+    auto mem = std::make_shared<MappedMemory>(file, data + offset);
+    values.push_back(TensorValue::Assemble(mem->device, dtype, shape, {}, mem->data, mem));
+  }
+  return values;
+}
+
+void WriteMappedFile(const std::string& path, std::string* meta, size_t data_offset_pos,
+                     const std::vector<Value>& blobs) {
+  uint64_t data_offset = AlignMappedOffset(meta->size());
+  std::memcpy(&(*meta)[data_offset_pos], &data_offset, sizeof(data_offset));
+
+  std::ofstream fout(path, std::ios::binary);
+  CHECK(fout.is_open()) << "Cannot open " << path << " for writing";
+  fout.write(meta->data(), meta->size());
+  uint64_t pos = meta->size();
+  auto pad_to = [&fout, &pos](uint64_t target) {
+    static const char zeros[kMappedDataAlignment] = {0};
+    while (pos < target) {
+      uint64_t n = std::min<uint64_t>(target - pos, kMappedDataAlignment);
+      fout.write(zeros, n);
+      pos += n;
+    }
+  };
+  pad_to(data_offset);
+  for (const auto& blob : blobs) {
+    const DLTensor* dlt = Downcast<TensorValue>(blob);
+    uint64_t nbytes = common::shape_utils::BytesCompactTensor(*dlt);
+    fout.write(static_cast<const char*>(dlt->data) + dlt->byte_offset, nbytes);
+    pos += nbytes;
+    pad_to(AlignMappedOffset(pos - data_offset) + data_offset);
+  }
+  CHECK(fout.good()) << "Failed to write " << path;
+}
+
+/*! \brief Magic number for the binary IR format. */
+constexpr uint64_t kIRMappedMagic = 0xD225DE2F42141520;
+
+void SaveBinary(const ir::ObjectRef& node, const std::string& path) {
+  std::vector<Value> constants;
+  std::string json = tvm::SaveJSON(Normalize<IRRewrite4Saver>(node, &constants));
+  std::string meta;
+  dmlc::MemoryStringStream strm(&meta);
+  strm.Write(kIRMappedMagic);
+  strm.Write(std::string(TVM_VERSION));
+  // The offset of the data region is patched after the metadata is written.
+  size_t data_offset_pos = meta.size();
+  strm.Write(static_cast<uint64_t>(0));
+  strm.Write(json);
+  std::vector<Value> blobs;
+  SaveMappedValues(&strm, constants, &blobs);
+  WriteMappedFile(path, &meta, data_offset_pos, blobs);
+}
+
+ir::ObjectRef LoadBinary(const std::string& path) {
+  auto file = std::make_shared<MappedFile>(path);
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(file->data()), file->size());
+  uint64_t magic, data_offset;
+  std::string version, json;
+  CHECK(strm.Read(&magic) && magic == kIRMappedMagic) << "Invalid binary IR file " << path;
+  CHECK(strm.Read(&version) && version == TVM_VERSION)
+      << "The binary IR file " << path << " is saved by TVM " << version;
+  CHECK(strm.Read(&data_offset) && data_offset <= file->size()) << "Invalid header of " << path;
+  CHECK(strm.Read(&json)) << "Invalid binary IR file " << path;
+  // The constants are views of the mapped file, which are loaded before the IR refers to them.
+  std::vector<Value> constants = LoadMappedValues(&strm, file, file->data() + data_offset);
+  const std::vector<Value>* prev = loading_constants;
+  loading_constants = &constants;
+  ir::ObjectRef ret;
+  try {
+    ret = Normalize<IRRewrite4Loader>(tvm::LoadJSON(json));
+  } catch (...) {
+    loading_constants = prev;
+    throw;
+  }
+  loading_constants = prev;
+  return ret;
+}
+
 void SerializeValue(dmlc::Stream* strm, const Value& value) {
   if (!value.defined()) {
     strm->Write(static_cast<uint8_t>(kNullptr));
@@ -246,6 +463,15 @@ RAF_REGISTER_OBJECT_REFLECT(ConstantNode)
       return tvm::SaveJSON(static_cast<const ConstantNode*>(n)->value);
     });
 
+RAF_REGISTER_OBJECT_REFLECT(ConstantRefNode)
+    .set_creator(CreateConstantRefNode)
+    .set_repr_bytes([](const ir::Object* n) -> std::string {
+      return std::to_string(static_cast<const ConstantRefNode*>(n)->index);
+    });
+
+RAF_REGISTER_GLOBAL("raf.ir.serialization.SaveBinary").set_body_typed(SaveBinary);
+RAF_REGISTER_GLOBAL("raf.ir.serialization.LoadBinary").set_body_typed(LoadBinary);
+
 RAF_REGISTER_GLOBAL("raf.ir.serialization.SaveJSON")
     .set_body([](tvm::runtime::TVMArgs args, tvm::runtime::TVMRetValue* ret) {
       CHECK(args.size() == 1);
@@ -7,9 +7,12 @@
  * \file src/impl/stream_pool.cc
  * \brief RAF stream pool underlying implementation
  */
+#include <map>
 #include <mutex>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 #include "raf/device_api.h"
 #include "raf/registry.h"
 #include "raf/stream_pool.h"
@@ -34,8 +37,14 @@ int Tag::GetTagIndex_(const std::string& tag) {
 
 class Stream::Impl {
  public:
-  explicit Impl(const Device& dev) : device(dev), api(DeviceAPI::Get(dev.device_type())) {
-    this->stream = api->CreateStream(dev);
+  explicit Impl(const Device& dev, int priority = 0, bool non_blocking = false)
+      : device(dev), api(DeviceAPI::Get(dev.device_type())) {
+    if (non_blocking) {
+      this->stream = api->CreateStreamWithFlags(dev, priority, non_blocking);
+    } else {
+      this->stream =
+          priority == 0 ? api->CreateStream(dev) : api->CreateStreamWithPriority(dev, priority);
+    }
   }
 
   ~Impl() {
@@ -61,10 +70,40 @@ class StreamPool {
         j = nullptr;
       }
     }
+    priority_pool.clear();
+    configured.clear();
+  }
+
+  void Configure(int tag_index, int num_streams, int priority, bool non_blocking) {
+    CHECK_GE(num_streams, 0);
+    std::vector<std::shared_ptr<Stream>> streams;
+    for (int i = 0; i < num_streams; ++i) {
+      streams.push_back(
+          std::make_shared<Stream>(new Stream::Impl(device, priority, non_blocking)));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (streams.empty()) {
+      configured.erase(tag_index);
+    } else {
+      configured[tag_index] = std::move(streams);
+    }
   }
 
-  std::shared_ptr<Stream> GetStream(int tag_index, int index) {
+  std::shared_ptr<Stream> GetStream(int tag_index, int index, int priority = 0) {
     std::lock_guard<std::mutex> lock(mutex);
+    if (priority == 0) {
+      auto it = configured.find(tag_index);
+      if (it != configured.end()) {
+        return it->second[index % it->second.size()];
+      }
+    }
+    if (priority != 0) {
+      auto& stream = priority_pool[std::make_tuple(tag_index, index, priority)];
+      if (stream == nullptr) {
+        stream = std::make_shared<Stream>(new Stream::Impl(device, priority));
+      }
+      return stream;
+    }
     if (tag_index >= static_cast<int>(pool.size())) {
       pool.resize(tag_index + 1);
     }
@@ -94,6 +133,10 @@ class StreamPool {
   Device device;
   std::shared_ptr<DeviceAPI> api;
   std::vector<std::vector<std::shared_ptr<Stream>>> pool;
+  /*! \brief The streams with non-default priorities, keyed by (tag index, index, priority). */
+  std::map<std::tuple<int, int, int>, std::shared_ptr<Stream>> priority_pool;
+  /*! \brief The configured streams of the tags, keyed by the tag index. */
+  std::unordered_map<int, std::vector<std::shared_ptr<Stream>>> configured;
   std::mutex mutex;
 };
 
@@ -110,9 +153,24 @@ void Stream::Wait() const {
   impl->api->WaitStream(data());
 }
 
-std::shared_ptr<Stream> Stream::Get(const Device& dev, int tag_index, int index) {
-  return StreamPool::Get(dev)->GetStream(tag_index, index);
+std::shared_ptr<Stream> Stream::Get(const Device& dev, int tag_index, int index, int priority) {
+  return StreamPool::Get(dev)->GetStream(tag_index, index, priority);
+}
+
+void Stream::Configure(const Device& dev, int tag_index, int num_streams, int priority,
+                       bool non_blocking) {
+  StreamPool::Get(dev)->Configure(tag_index, num_streams, priority, non_blocking);
 }
 
+std::shared_ptr<Stream> Stream::Create(const Device& dev, int priority, bool non_blocking) {
+  return std::make_shared<Stream>(new Stream::Impl(dev, priority, non_blocking));
+}
+
+RAF_REGISTER_GLOBAL("raf.stream_pool.Configure")
+    .set_body_typed([](const Device& dev, int tag_index, int num_streams, int priority,
+                       bool non_blocking) {
+      Stream::Configure(dev, tag_index, num_streams, priority, non_blocking);
+    });
+
 }  // namespace stream_pool
 }  // namespace raf
@@ -108,7 +108,12 @@ class Tensor::Impl {
     container->dl_tensor = tensor->dl_tensor;
     std::vector<int64_t> shape(tensor->dl_tensor.shape,
                                tensor->dl_tensor.shape + tensor->dl_tensor.ndim);
-    container->strides_ = Shape2Strides<int64_t>(shape);
+    // The tensors from the other frameworks may be strided views.
+    container->strides_ = tensor->dl_tensor.strides == nullptr
+                              ? Shape2Strides<int64_t>(shape)
+                              : std::vector<int64_t>(tensor->dl_tensor.strides,
+                                                     tensor->dl_tensor.strides +
+                                                         tensor->dl_tensor.ndim);
     container->shape_ = std::move(shape);
     container->dl_tensor.shape = const_cast<int64_t*>(container->shape_.data());
     container->dl_tensor.strides = dmlc::BeginPtr(container->strides_);
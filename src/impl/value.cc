@@ -11,6 +11,8 @@
 #include <tvm/runtime/ndarray.h>
 #include <tvm/node/functor.h>
 #include <tvm/ir/module.h>
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
 #include "raf/executor.h"
 #include "raf/ir_ext.h"
 #include "raf/registry.h"
@@ -307,7 +309,22 @@ TensorValue FromTVM(tvm::runtime::NDArray array) {
 
 /*** External symbols ***/
 tvm::runtime::NDArray ToTVM(TensorValue value) {
-  DLManagedTensor* tensor = value->tensor.ToDLPack();
+  // The host may read the data, which could be written by the asynchronously executed ops.
+  if (executor::interpreter::IsAsync()) {
+    executor::interpreter::Synchronize();
+  }
+  // The DLPack tensor holds the tensor value rather than the tensor, so the memory of the value
+  // from the pool outlives the value when the array is shared with the other frameworks.
+  DLManagedTensor* tensor = new DLManagedTensor();
+  tensor->manager_ctx = new TensorValue(value);
+  tensor->deleter = [](DLManagedTensor* self) {
+    delete static_cast<TensorValue*>(self->manager_ctx);
+    delete self;
+  };
+  tensor->dl_tensor = *value->tensor.operator->();
+  if (common::shape_utils::IsCompact(tensor->dl_tensor)) {
+    tensor->dl_tensor.strides = nullptr;
+  }
   if (tensor->dl_tensor.strides != nullptr) {
     tensor->deleter(tensor);
     LOG(FATAL) << "NotImplementedError: strided tensor not supported";
@@ -316,6 +333,24 @@ tvm::runtime::NDArray ToTVM(TensorValue value) {
   return tvm::runtime::NDArray::FromDLPack(tensor);
 }
 
+tvm::runtime::NDArray ToDLPack(TensorValue value, int64_t stream) {
+  const DLTensor* tensor = value->tensor.operator->();
+  // Per the DLPack protocol, the consumer passes its stream, which then waits for the producer.
+  // RAF produces the tensors on the legacy default stream, so the consumers on it (1) need no
+  // synchronization, and -1 asks for none.
+  if (executor::interpreter::IsAsync()) {
+    executor::interpreter::Synchronize();
+  }
+  if (tensor->device.device_type == kDLCUDA && stream != -1 && stream != 1) {
+    Device dev(tensor->device);
+    auto api = device_api::DeviceAPI::Get(dev.device_type());
+    auto event = event_pool::EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+    api->EventRecordOnStream(event->data(), nullptr /* default stream */);
+    api->StreamWaitEvent(reinterpret_cast<void*>(stream), event->data());
+  }
+  return ToTVM(value);
+}
+
 ObjectRef DeTuple(Value value) {
   if (value->IsInstance<TensorValueObj>() || value->IsInstance<NoGradValueObj>()) {
     return std::move(value);
@@ -341,6 +376,9 @@ Value CopyTo(Value src, const Device& dev) {
   if (!src.defined()) {
     return src;
   }
+  if (executor::interpreter::IsAsync()) {
+    executor::interpreter::Synchronize();
+  }
   if (src.as<TensorValueObj>()) {
     auto tensor = Downcast<TensorValue>(src)->tensor;
     if (tensor->device.device_type != dev.device_type()) {
@@ -363,6 +401,9 @@ void CopyTo(Value src, Value dst) {
   if (!src.defined()) {
     return;
   }
+  if (executor::interpreter::IsAsync()) {
+    executor::interpreter::Synchronize();
+  }
 
   if (src.as<TensorValueObj>()) {
     CHECK(dst.as<TensorValueObj>());
@@ -428,6 +469,7 @@ RAF_REGISTER_GLOBAL("raf.value.AssembleTensorValue")
 RAF_REGISTER_GLOBAL("raf.value.DeTuple").set_body_typed(DeTuple);
 RAF_REGISTER_GLOBAL("raf.value.FromTVM").set_body_typed(FromTVM);
 RAF_REGISTER_GLOBAL("raf.value.ToTVM").set_body_typed(ToTVM);
+RAF_REGISTER_GLOBAL("raf.value.ToDLPack").set_body_typed(ToDLPack);
 RAF_REGISTER_GLOBAL("raf.value._make.TupleValue").set_body_typed(TupleValue::make);
 RAF_REGISTER_GLOBAL("raf.value._make.IntValue").set_body_typed(IntValue::make);
 RAF_REGISTER_GLOBAL("raf.value._make.FloatValue").set_body_typed(FloatValue::make);
@@ -0,0 +1,216 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/async_compiler.cc
+ * \brief Build the OpEnvs missed by the VM on background threads, with the fallback OpEnvs of the
+ * library dialects used in the meantime.
+ */
+#include <tvm/runtime/device_api.h>
+#include <algorithm>
+
+#include "dmlc/logging.h"
+#include "raf/dialect.h"
+#include "raf/ir_ext.h"
+#include "raf/memory_pool.h"
+#include "./async_compiler.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+AsyncCompiler::AsyncCompiler(int num_threads, std::unordered_set<std::string> dialects)
+    : dialects_(std::move(dialects)) {
+  CHECK_GT(num_threads, 0) << "The number of the background threads must be positive";
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+AsyncCompiler::~AsyncCompiler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+OpEnvPtr AsyncCompiler::Poll(const std::string& key, bool* done) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  *done = it->second.done;
+  if (!it->second.done) {
+    stats_.num_fallback_calls++;
+    return it->second.fallback;
+  }
+  OpEnvPtr ret = it->second.compiled ? it->second.compiled : it->second.fallback;
+  entries_.erase(it);
+  return ret;
+}
+
+OpEnvPtr AsyncCompiler::DispatchFallback(const CallValues& call) {
+  // The call of a primitive function is dispatched to a fallback of its op if it only calls one
+  // op, whose args are the params of the function or the constants, e.g., the attributes.
+  CallValues op_call = call;
+  std::vector<int> param_indices;
+  std::string preferred;
+  if (const auto* closure = call->callee.as<ClosureValueObj>()) {
+    const auto* body = closure->func->body.as<CallNode>();
+    if (body == nullptr || !body->op->IsInstance<OpNode>()) {
+      return nullptr;
+    }
+    preferred = closure->func->GetAttr<String>(attr::kDialect).value_or("");
+    Array<Value> closure_args = GetListArgs(call->args);
+    Array<Value> args;
+    for (const auto& arg : body->args) {
+      if (const auto* constant = arg.as<ConstantNode>()) {
+        args.push_back(Downcast<Value>(constant->value));
+        param_indices.push_back(-1);
+        continue;
+      }
+      const auto& params = closure->func->params;
+      auto it = std::find(params.begin(), params.end(), arg);
+      if (it == params.end()) {
+        return nullptr;
+      }
+      param_indices.push_back(it - params.begin());
+      args.push_back(closure_args[it - params.begin()]);
+    }
+    Op op = Downcast<Op>(body->op);
+    op_call = CallValues::make();
+    op_call->callee = OpValue::make(op);
+    op_call->args = GetOpAttr<FRAFSchema>(IsDialectOp(op) ? GetBaseOp(op) : op, "FRAFSchema")(args);
+    op_call->device = call->device;
+    op_call->out = call->out;
+  }
+
+  Op op = Downcast<OpValue>(op_call->callee)->op;
+  if (IsDialectOp(op)) {
+    preferred = GetDialect(op);
+    op = GetBaseOp(op);
+  } else if (call->callee.as<OpValueObj>() && OpEnvMaker::Get(op->name) != nullptr) {
+    // The base op is implemented without dialects.
+    return nullptr;
+  }
+  auto dialect_list = OpDialect::GetDispatchList(op, call->device.device_type());
+  if (preferred.empty() && !dialect_list.empty()) {
+    preferred = dialect_list.front().dialect;
+  }
+  if (preferred.empty() || dialects_.count(preferred)) {
+    return nullptr;
+  }
+  for (const auto& entry : dialect_list) {
+    if (entry.dialect == preferred || !dialects_.count(entry.dialect)) {
+      continue;
+    }
+    auto dialect_op = Op::Get(entry.dialect_op);
+    dialect_op->op_type = op->op_type;
+    auto maker = OpEnvMaker::Get(dialect_op->name);
+    if (maker == nullptr) {
+      continue;
+    }
+    auto env = OpEnvPtr((*maker)(op_call));
+    if (env == nullptr || env->HasError()) {
+      continue;
+    }
+    if (!param_indices.empty()) {
+      // The OpEnv reads the args of the op, which are mapped back to the params of the function.
+      for (int& index : env->arg_indices) {
+        index = param_indices[index];
+        if (index < 0) {
+          return nullptr;
+        }
+      }
+    }
+    DLOG(INFO) << "Dispatch to the fallback " << dialect_op->name;
+    return env;
+  }
+  return nullptr;
+}
+
+void AsyncCompiler::Compile(const std::string& key, OpEnvPtr fallback, FCompile fcompile) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries_[key];
+    entry.fallback = std::move(fallback);
+    tasks_.emplace_back(key, std::move(fcompile));
+    stats_.num_submitted++;
+  }
+  cv_.notify_all();
+}
+
+void AsyncCompiler::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return tasks_.empty() && num_running_ == 0; });
+}
+
+AsyncCompileStats AsyncCompiler::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void AsyncCompiler::WorkerLoop() {
+  while (true) {
+    std::pair<std::string, FCompile> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+      if (stop_) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      num_running_++;
+    }
+    OpEnvPtr op_env;
+    try {
+      op_env = task.second();
+    } catch (const dmlc::Error& e) {
+      LOG(WARNING) << "Failed to build the OpEnv in the background, so its fallback is kept: "
+                   << e.what();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& entry = entries_[task.first];
+      entry.compiled = op_env;
+      entry.done = true;
+      num_running_--;
+      if (op_env) {
+        stats_.num_compiled++;
+      } else {
+        stats_.num_failed++;
+      }
+    }
+    cv_.notify_all();
+  }
+}
+
+Value CloneForCompile(const Value& value, const Device& device) {
+  if (const auto* tuple = value.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tuple->fields) {
+      fields.push_back(CloneForCompile(field, device));
+    }
+    return TupleValue::make(fields);
+  }
+  const auto* tensor = value.as<TensorValueObj>();
+  if (tensor == nullptr) {
+    return value;
+  }
+  const DLTensor* src = tensor->tensor.operator->();
+  std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+  auto mem = memory_pool::Memory::Alloc(device, tvm::runtime::GetDataSize(*src));
+  return TensorValue::Assemble(device, DType(src->dtype), shape, {}, mem->data, mem);
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
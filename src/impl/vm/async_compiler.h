@@ -0,0 +1,145 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/async_compiler.h
+ * \brief Build the OpEnvs missed by the VM on background threads, with the fallback OpEnvs of the
+ * library dialects used in the meantime.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/op.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief The stats of the background compilation. */
+struct AsyncCompileStats {
+  /*! \brief The number of the OpEnvs submitted to build in the background. */
+  int64_t num_submitted = 0;
+  /*! \brief The number of the calls served by the fallback OpEnvs. */
+  int64_t num_fallback_calls = 0;
+  /*! \brief The number of the OpEnvs built, which are switched in on their next calls. */
+  int64_t num_compiled = 0;
+  /*! \brief The number of the OpEnvs failed to build, whose fallbacks are kept. */
+  int64_t num_failed = 0;
+};
+
+/*!
+ * \brief Build the OpEnvs missed by the VM on a pool of background threads. The call missing an
+ * OpEnv, e.g., a TVM kernel to compile or a CUTLASS kernel to tune, is dispatched to a fallback
+ * OpEnv of a library dialect, e.g., cuBLAS or cuDNN, which is ready to run, while the preferred
+ * OpEnv is built in the background on the copies of its buffers. The following calls use the
+ * fallback until the preferred OpEnv is built, which is then switched into the OpEnv cache.
+ */
+class AsyncCompiler {
+ public:
+  /*! \brief The function to build an OpEnv. */
+  using FCompile = std::function<OpEnvPtr()>;
+
+  /*!
+   * \param num_threads The number of the background threads.
+   * \param dialects The dialects of the fallback OpEnvs, which are ready to run without
+   * compilation or tuning.
+   */
+  AsyncCompiler(int num_threads, std::unordered_set<std::string> dialects);
+
+  ~AsyncCompiler();
+
+  /*!
+   * \brief Look up the OpEnv being built for a key.
+   * \param key The key, e.g., the cache key of the OpEnv and the pc.
+   * \param done Whether the OpEnv is built, in which case it is no longer tracked.
+   * \return The built OpEnv, or its fallback if it is not built or failed to build, or nullptr if
+   * the key is not being built.
+   */
+  OpEnvPtr Poll(const std::string& key, bool* done);
+
+  /*!
+   * \brief Dispatch a call to a fallback OpEnv of the fallback dialects.
+   * \param call The call.
+   * \return The fallback OpEnv, or nullptr if the call is dispatched to one of the fallback
+   * dialects anyway or no fallback applies, in which case the call should be built in place.
+   */
+  OpEnvPtr DispatchFallback(const CallValues& call);
+
+  /*!
+   * \brief Build an OpEnv in the background.
+   * \param key The key.
+   * \param fallback The fallback OpEnv used until it is built.
+   * \param fcompile The function to build the OpEnv.
+   */
+  void Compile(const std::string& key, OpEnvPtr fallback, FCompile fcompile);
+
+  /*! \brief Wait for all the OpEnvs submitted to be built. */
+  void Wait();
+
+  /*! \brief Get the stats. */
+  AsyncCompileStats GetStats();
+
+ private:
+  /*! \brief An OpEnv being built. */
+  struct Entry {
+    /*! \brief The fallback OpEnv. */
+    OpEnvPtr fallback;
+    /*! \brief The built OpEnv, or nullptr if it failed to build. */
+    OpEnvPtr compiled;
+    /*! \brief Whether it is built. */
+    bool done = false;
+  };
+
+  /*! \brief Build the submitted OpEnvs until the compiler is destroyed. */
+  void WorkerLoop();
+
+  /*! \brief The fallback dialects. */
+  std::unordered_set<std::string> dialects_;
+  /*! \brief The OpEnvs being built, keyed by their keys. */
+  std::unordered_map<std::string, Entry> entries_;
+  /*! \brief The keys and the functions to build, in the order they are submitted. */
+  std::deque<std::pair<std::string, FCompile>> tasks_;
+  /*! \brief The number of the tasks being built. */
+  int num_running_ = 0;
+  /*! \brief The background threads. */
+  std::vector<std::thread> threads_;
+  /*! \brief The stats. */
+  AsyncCompileStats stats_;
+  /*! \brief Whether the background threads are stopping. */
+  bool stop_ = false;
+  /*! \brief The mutex to access the entries and the tasks. */
+  std::mutex mutex_;
+  /*! \brief Notified when a task is submitted or built. */
+  std::condition_variable cv_;
+};
+
+/*!
+ * \brief Make a copy of a value with the same shapes and dtypes in newly allocated device memory,
+ * so an OpEnv built in the background, e.g., tuned by running the candidate kernels, does not
+ * touch the buffers of the running call.
+ * \param value The value.
+ * \param device The device.
+ * \return The copy, whose contents are not initialized.
+ */
+Value CloneForCompile(const Value& value, const Device& device);
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
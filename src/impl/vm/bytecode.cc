@@ -73,6 +73,7 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::SetShape:
       this->set_shape.data = instr.set_shape.data;
       this->set_shape.shape = instr.set_shape.shape;
+      this->set_shape.offset = instr.set_shape.offset;
       return;
     case Opcode::InvokePacked:
       this->invoke_packed.packed_index = instr.invoke_packed.packed_index;
@@ -114,11 +115,18 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::Free:
       this->free = instr.free;
       return;
+    case Opcode::Kill:
+      this->kill = instr.kill;
+      return;
     case Opcode::InvokeJit:
+    case Opcode::InvokeJitFree:
+    case Opcode::InvokeJitAsync:
       this->invoke_jit.op_reg = instr.invoke_jit.op_reg;
       this->invoke_jit.arity = instr.invoke_jit.arity;
       this->invoke_jit.output_size = instr.invoke_jit.output_size;
-      this->invoke_jit.args = Duplicate<RegName>(instr.invoke_jit.args, instr.invoke_jit.arity);
+      this->invoke_jit.num_frees = instr.invoke_jit.num_frees;
+      this->invoke_jit.args = Duplicate<RegName>(
+          instr.invoke_jit.args, instr.invoke_jit.arity + instr.invoke_jit.num_frees);
       return;
     case Opcode::InferType:
       this->infer_type.op_reg = instr.infer_type.op_reg;
@@ -128,6 +136,7 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::CudaSetStream:
       this->cuda_set_stream.device_id = instr.cuda_set_stream.device_id;
       this->cuda_set_stream.stream_id = instr.cuda_set_stream.stream_id;
+      this->cuda_set_stream.priority = instr.cuda_set_stream.priority;
       return;
     case Opcode::CudaAddEvent:
     case Opcode::CudaWaitEvent:
@@ -136,6 +145,12 @@ Instruction::Instruction(const Instruction& instr) {
       return;
     case Opcode::CudaStreamBarrier:
       return;
+    case Opcode::CudaSetStreamWait:
+      this->cuda_set_stream_wait = instr.cuda_set_stream_wait;
+      return;
+    case Opcode::Wait:
+      this->wait = instr.wait;
+      return;
     default:
       std::ostringstream out;
       out << "Invalid instruction " << static_cast<int>(instr.op);
@@ -168,6 +183,7 @@ Instruction& Instruction::operator=(const Instruction& instr) {
       return *this;
     case Opcode::AllocTensor:
       this->alloc_tensor.storage = instr.alloc_tensor.storage;
+      this->alloc_tensor.offset = instr.alloc_tensor.offset;
       this->alloc_tensor.ndim = instr.alloc_tensor.ndim;
       this->alloc_tensor.shape =
           Duplicate<int64_t>(instr.alloc_tensor.shape, instr.alloc_tensor.ndim);
@@ -176,6 +192,7 @@ Instruction& Instruction::operator=(const Instruction& instr) {
       return *this;
     case Opcode::AllocTensorReg:
       this->alloc_tensor_reg.storage = instr.alloc_tensor_reg.storage;
+      this->alloc_tensor_reg.offset = instr.alloc_tensor_reg.offset;
       this->alloc_tensor_reg.shape_register = instr.alloc_tensor_reg.shape_register;
       this->alloc_tensor_reg.dtype = instr.alloc_tensor_reg.dtype;
       this->alloc_tensor_reg.own = instr.alloc_tensor_reg.own;
@@ -196,6 +213,7 @@ Instruction& Instruction::operator=(const Instruction& instr) {
     case Opcode::SetShape:
       this->set_shape.data = instr.set_shape.data;
       this->set_shape.shape = instr.set_shape.shape;
+      this->set_shape.offset = instr.set_shape.offset;
       return *this;
     case Opcode::InvokePacked:
       this->invoke_packed.packed_index = instr.invoke_packed.packed_index;
@@ -220,11 +238,15 @@ Instruction& Instruction::operator=(const Instruction& instr) {
           Duplicate<RegName>(instr.invoke_func.args, instr.invoke_func.num_args);
       return *this;
     case Opcode::InvokeJit:
+    case Opcode::InvokeJitFree:
+    case Opcode::InvokeJitAsync:
       this->invoke_jit.op_reg = instr.invoke_jit.op_reg;
       this->invoke_jit.arity = instr.invoke_jit.arity;
       this->invoke_jit.output_size = instr.invoke_jit.output_size;
+      this->invoke_jit.num_frees = instr.invoke_jit.num_frees;
       FreeIf(this->invoke_jit.args);
-      this->invoke_jit.args = Duplicate<RegName>(instr.invoke_jit.args, instr.invoke_jit.arity);
+      this->invoke_jit.args = Duplicate<RegName>(
+          instr.invoke_jit.args, instr.invoke_jit.arity + instr.invoke_jit.num_frees);
       return *this;
     case Opcode::InferType:
       this->infer_type.op_reg = instr.infer_type.op_reg;
@@ -250,9 +272,13 @@ Instruction& Instruction::operator=(const Instruction& instr) {
     case Opcode::Free:
       this->free = instr.free;
       return *this;
+    case Opcode::Kill:
+      this->kill = instr.kill;
+      return *this;
     case Opcode::CudaSetStream:
       this->cuda_set_stream.device_id = instr.cuda_set_stream.device_id;
       this->cuda_set_stream.stream_id = instr.cuda_set_stream.stream_id;
+      this->cuda_set_stream.priority = instr.cuda_set_stream.priority;
       return *this;
     case Opcode::CudaAddEvent:
     case Opcode::CudaWaitEvent:
@@ -261,6 +287,12 @@ Instruction& Instruction::operator=(const Instruction& instr) {
       return *this;
     case Opcode::CudaStreamBarrier:
       return *this;
+    case Opcode::CudaSetStreamWait:
+      this->cuda_set_stream_wait = instr.cuda_set_stream_wait;
+      return *this;
+    case Opcode::Wait:
+      this->wait = instr.wait;
+      return *this;
     default:
       std::ostringstream out;
       out << "Invalid instruction " << static_cast<int>(instr.op);
@@ -280,12 +312,15 @@ Instruction::~Instruction() {
     case Opcode::LoadConsti:
     case Opcode::AllocStorage:
     case Opcode::Free:
+    case Opcode::Kill:
     case Opcode::SetShape:
     case Opcode::Fatal:
     case Opcode::CudaSetStream:
     case Opcode::CudaAddEvent:
     case Opcode::CudaWaitEvent:
     case Opcode::CudaStreamBarrier:
+    case Opcode::CudaSetStreamWait:
+    case Opcode::Wait:
       return;
     case Opcode::AllocTensor:
       delete[] this->alloc_tensor.shape;
@@ -306,6 +341,8 @@ Instruction::~Instruction() {
       delete[] this->invoke_func.args;
       return;
     case Opcode::InvokeJit:
+    case Opcode::InvokeJitFree:
+    case Opcode::InvokeJitAsync:
       delete[] this->invoke_jit.args;
       return;
     case Opcode::InferType:
@@ -387,6 +424,9 @@ Instruction Instruction::AllocStorage(RegName size, Index alignment, DLDataType
   instr.alloc_storage.device_type = device_type;
   instr.alloc_storage.device_id = device_id;
   instr.alloc_storage.alloc_async = alloc_async;
+  instr.alloc_storage.arena_index = -1;
+  instr.alloc_storage.arena_offset = 0;
+  instr.alloc_storage.arena_size = 0;
   return instr;
 }
 
@@ -397,6 +437,13 @@ Instruction Instruction::Free(RegName memory) {
   return instr;
 }
 
+Instruction Instruction::Kill(RegName reg) {
+  Instruction instr;
+  instr.op = Opcode::Kill;
+  instr.kill.reg = reg;
+  return instr;
+}
+
 Instruction Instruction::AllocTuple(const std::vector<RegName>& fields, Index dst) {
   Instruction instr;
   instr.op = Opcode::AllocTuple;
@@ -423,12 +470,13 @@ Instruction Instruction::AllocClosure(Index func_index, const std::vector<RegNam
   return instr;
 }
 
-Instruction Instruction::SetShape(RegName data, RegName shape, RegName dst) {
+Instruction Instruction::SetShape(RegName data, RegName shape, RegName dst, Index offset) {
   Instruction instr;
   instr.op = Opcode::SetShape;
   instr.dst = dst;
   instr.set_shape.data = data;
   instr.set_shape.shape = shape;
+  instr.set_shape.offset = offset;
   return instr;
 }
 
@@ -517,6 +565,7 @@ Instruction Instruction::InvokeJit(RegName op_reg, Index arity, Index output_siz
   instr.invoke_jit.op_reg = op_reg;
   instr.invoke_jit.arity = arity;
   instr.invoke_jit.output_size = output_size;
+  instr.invoke_jit.num_frees = 0;
   instr.invoke_jit.args = new RegName[arity];
   for (Index i = 0; i < arity; ++i) {
     instr.invoke_jit.args[i] = args[i];
@@ -524,6 +573,40 @@ Instruction Instruction::InvokeJit(RegName op_reg, Index arity, Index output_siz
   return instr;
 }
 
+Instruction Instruction::InvokeJitFree(RegName op_reg, Index arity, Index output_size,
+                                       const std::vector<RegName>& args,
+                                       const std::vector<RegName>& frees) {
+  Instruction instr;
+  instr.op = Opcode::InvokeJitFree;
+  instr.invoke_jit.op_reg = op_reg;
+  instr.invoke_jit.arity = arity;
+  instr.invoke_jit.output_size = output_size;
+  instr.invoke_jit.num_frees = frees.size();
+  instr.invoke_jit.args = new RegName[arity + frees.size()];
+  for (Index i = 0; i < arity; ++i) {
+    instr.invoke_jit.args[i] = args[i];
+  }
+  for (size_t i = 0; i < frees.size(); ++i) {
+    instr.invoke_jit.args[arity + i] = frees[i];
+  }
+  return instr;
+}
+
+Instruction Instruction::InvokeJitAsync(RegName op_reg, Index arity, Index output_size,
+                                        const std::vector<RegName>& args, RegName handle) {
+  Instruction instr = InvokeJit(op_reg, arity, output_size, args);
+  instr.op = Opcode::InvokeJitAsync;
+  instr.dst = handle;
+  return instr;
+}
+
+Instruction Instruction::Wait(RegName handle) {
+  Instruction instr;
+  instr.op = Opcode::Wait;
+  instr.wait.handle = handle;
+  return instr;
+}
+
 Instruction Instruction::InferType(RegName op_reg, const std::vector<RegName>& args, RegName dst) {
   Instruction instr;
   instr.op = Opcode::InferType;
@@ -537,11 +620,12 @@ Instruction Instruction::InferType(RegName op_reg, const std::vector<RegName>& a
   return instr;
 }
 
-Instruction Instruction::CudaSetStream(Index device_id, Index stream_id) {
+Instruction Instruction::CudaSetStream(Index device_id, Index stream_id, Index priority) {
   Instruction instr;
   instr.op = Opcode::CudaSetStream;
   instr.cuda_set_stream.device_id = device_id;
   instr.cuda_set_stream.stream_id = stream_id;
+  instr.cuda_set_stream.priority = priority;
   return instr;
 }
 
@@ -567,6 +651,17 @@ Instruction Instruction::CudaStreamBarrier() {
   return instr;
 }
 
+Instruction Instruction::CudaSetStreamWait(Index device_id, Index stream_id, Index event_id,
+                                           Index wait_stream_id) {
+  Instruction instr;
+  instr.op = Opcode::CudaSetStreamWait;
+  instr.cuda_set_stream_wait.device_id = device_id;
+  instr.cuda_set_stream_wait.stream_id = stream_id;
+  instr.cuda_set_stream_wait.event_id = event_id;
+  instr.cuda_set_stream_wait.wait_stream_id = wait_stream_id;
+  return instr;
+}
+
 void DLDatatypePrint(std::ostream& os, const DLDataType& dtype) {
   switch (dtype.code) {
     case kDLInt:
@@ -657,6 +752,9 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
     case Opcode::SetShape: {
       os << "set_shape $" << instr.dst << " $" << instr.set_shape.data << " $"
          << instr.set_shape.shape;
+      if (instr.set_shape.offset != 0) {
+        os << " " << instr.set_shape.offset;
+      }
       break;
     }
     case Opcode::If: {
@@ -700,12 +798,20 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
       if (instr.alloc_storage.alloc_async) {
         os << "(async)";
       }
+      if (instr.alloc_storage.arena_index >= 0) {
+        os << " arena[" << instr.alloc_storage.arena_index << "]+"
+           << instr.alloc_storage.arena_offset << "/" << instr.alloc_storage.arena_size;
+      }
       break;
     }
     case Opcode::Free: {
       os << "free $" << instr.free.memory;
       break;
     }
+    case Opcode::Kill: {
+      os << "kill $" << instr.kill.reg;
+      break;
+    }
     case Opcode::InvokeJit: {
       Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
       os << "invoke_jit $" << instr.invoke_jit.op_reg << " (in: $"
@@ -714,6 +820,29 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
          << ")";
       break;
     }
+    case Opcode::InvokeJitFree: {
+      Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
+      os << "invoke_jit_free $" << instr.invoke_jit.op_reg << " (in: $"
+         << StrJoin<RegName>(instr.invoke_jit.args, 0, num_inputs, ", $") << ", out: $"
+         << StrJoin<RegName>(instr.invoke_jit.args, num_inputs, instr.invoke_jit.output_size, ", $")
+         << ", free: $"
+         << StrJoin<RegName>(instr.invoke_jit.args, instr.invoke_jit.arity,
+                             instr.invoke_jit.num_frees, ", $")
+         << ")";
+      break;
+    }
+    case Opcode::InvokeJitAsync: {
+      Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
+      os << "invoke_jit_async $" << instr.dst << " $" << instr.invoke_jit.op_reg << " (in: $"
+         << StrJoin<RegName>(instr.invoke_jit.args, 0, num_inputs, ", $") << ", out: $"
+         << StrJoin<RegName>(instr.invoke_jit.args, num_inputs, instr.invoke_jit.output_size, ", $")
+         << ")";
+      break;
+    }
+    case Opcode::Wait: {
+      os << "wait $" << instr.wait.handle;
+      break;
+    }
     case Opcode::InferType: {
       os << "infer_type $" << instr.dst << " $" << instr.infer_type.op_reg << "($"
          << StrJoin<RegName>(instr.infer_type.args, 0, instr.infer_type.num_args, ",$") << ")";
@@ -722,6 +851,9 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
     case Opcode::CudaSetStream: {
       os << "cuda_set_stream " << instr.cuda_set_stream.device_id << " "
          << instr.cuda_set_stream.stream_id;
+      if (instr.cuda_set_stream.priority != 0) {
+        os << " priority=" << instr.cuda_set_stream.priority;
+      }
       break;
     }
     case Opcode::CudaAddEvent: {
@@ -734,6 +866,13 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
     }
     case Opcode::CudaStreamBarrier: {
       os << "cuda_stream_barrier";
+      break;
+    }
+    case Opcode::CudaSetStreamWait: {
+      os << "cuda_set_stream_wait " << instr.cuda_set_stream_wait.device_id << " "
+         << instr.cuda_set_stream_wait.stream_id << " " << instr.cuda_set_stream_wait.event_id
+         << " " << instr.cuda_set_stream_wait.wait_stream_id;
+      break;
     }
     default:
       LOG(FATAL) << "should never hit this case" << static_cast<int>(instr.op);
@@ -7,7 +7,13 @@
  * \file src/impl/vm/compiler.cc
  * \brief The RAF virtual machine compiler.
  */
+#include <algorithm>
+#include <list>
+#include <map>
+#include <mutex>
 #include <tvm/ir/module.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/ir/type_functor.h>
 #include <tvm/target/target.h>
 #include <tvm/tir/op.h>
@@ -16,11 +22,15 @@
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/attrs/memory.h>
 #include "raf/op.h"
+#include "raf/op_utils.h"
 #include "raf/ir_ext.h"
 #include "raf/binding.h"
 #include "raf/type.h"
 #include "raf/pass.h"
+#include "raf/pass_profiler.h"
 #include "raf/dist_config.h"
+#include "raf/stream_pool.h"
+#include "../../common/interval_packing.h"
 #include "./compiler.h"
 
 namespace tvm {
@@ -199,6 +209,209 @@ struct TagCompare : ConditionNode {
   }
 };
 
+/*!
+ * \brief Collect the calls of a function to itself in the tail positions of an expr, i.e., the
+ * results of the expr, of its let chains and of the branches of its Ifs.
+ */
+static void FindTailCalls(const Expr& expr, const GlobalVar& self,
+                          std::unordered_set<const CallNode*>* calls) {
+  Expr body = expr;
+  while (const auto* let = body.as<LetNode>()) {
+    if (let->body.same_as(let->var)) {
+      body = let->value;
+      break;
+    }
+    body = let->body;
+  }
+  if (const auto* if_node = body.as<IfNode>()) {
+    FindTailCalls(if_node->true_branch, self, calls);
+    FindTailCalls(if_node->false_branch, self, calls);
+  } else if (const auto* call = body.as<CallNode>()) {
+    if (call->op.same_as(self)) {
+      calls->insert(call);
+    }
+  }
+}
+
+/*! \brief Collect the let bindings of an expr, including the ones in the branches of its Ifs. */
+static void CollectLets(const Expr& expr, std::vector<const LetNode*>* lets) {
+  Expr body = expr;
+  while (const auto* let = body.as<LetNode>()) {
+    lets->push_back(let);
+    if (let->value.as<IfNode>()) {
+      CollectLets(let->value, lets);
+    }
+    body = let->body;
+  }
+  if (const auto* if_node = body.as<IfNode>()) {
+    CollectLets(if_node->true_branch, lets);
+    CollectLets(if_node->false_branch, lets);
+  }
+}
+
+/*! \brief Whether the callee of an invoke_op runs a non-deterministic op, e.g., a dropout. */
+static bool IsNonDeterministicCallee(const Expr& callee) {
+  Expr expr = callee;
+  if (const auto* konst = callee.as<ConstantNode>()) {
+    if (const auto* opv = konst->value.as<OpValueObj>()) {
+      return IsNonDeterministicOp(opv->op);
+    } else if (const auto* closure = konst->value.as<ClosureValueObj>()) {
+      expr = closure->func;
+    }
+  }
+  bool found = false;
+  tvm::relay::PostOrderVisit(expr, [&found](const Expr& e) {
+    if (const auto* op = e.as<OpNode>()) {
+      found |= IsNonDeterministicOp(GetRef<Op>(op));
+    }
+  });
+  return found;
+}
+
+std::vector<Let> FindLoopInvariants(const Function& func, const GlobalVar& self,
+                                    const std::unordered_set<const CallNode*>& tail_calls) {
+  static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+  static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+  static const Op& set_shape_op = Op::Get("raf.op.vm.set_shape");
+  static const Op& infer_type_op = Op::Get("raf.op.vm.infer_type");
+  static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+  static const Op& free_op = Op::Get("raf.op.vm.free");
+  std::unordered_set<const VarNode*> invariant_params;
+  for (size_t i = 0; i < func->params.size(); ++i) {
+    bool invariant = true;
+    for (const auto* call : tail_calls) {
+      invariant &= call->args[i].same_as(func->params[i]);
+    }
+    if (invariant) {
+      invariant_params.insert(func->params[i].get());
+    }
+  }
+
+  // The candidates in their order, from the let chain before the first If and from the leading
+  // let chain of its branch that loops.
+  std::vector<const LetNode*> chain;
+  auto collect_chain = [&chain](Expr body) -> const IfNode* {
+    while (const auto* let = body.as<LetNode>()) {
+      if (const auto* if_node = let->value.as<IfNode>()) {
+        return if_node;
+      }
+      chain.push_back(let);
+      body = let->body;
+    }
+    return body.as<IfNode>();
+  };
+  if (const auto* if_node = collect_chain(func->body)) {
+    std::unordered_set<const CallNode*> true_calls, false_calls;
+    FindTailCalls(if_node->true_branch, self, &true_calls);
+    FindTailCalls(if_node->false_branch, self, &false_calls);
+    if (true_calls.empty() != false_calls.empty()) {
+      collect_chain(true_calls.empty() ? if_node->false_branch : if_node->true_branch);
+    }
+  }
+  std::vector<const LetNode*> lets;
+  CollectLets(func->body, &lets);
+  std::unordered_map<const VarNode*, Expr> values;
+  for (const auto* let : lets) {
+    values[let->var.get()] = let->value;
+  }
+  auto is_hoistable = [&](const Expr& value) {
+    if (value.as<ConstantNode>() || value.as<VarNode>() || value.as<TupleNode>() ||
+        value.as<TupleGetItemNode>()) {
+      return true;
+    }
+    if (const auto* fn = value.as<FunctionNode>()) {
+      return fn->HasNonzeroAttr(attr::kPrimitive) && !IsNonDeterministicCallee(value);
+    }
+    const auto* call = value.as<CallNode>();
+    if (call == nullptr) {
+      return false;
+    }
+    if (call->op.same_as(invoke_op)) {
+      Expr callee = call->args[0];
+      if (const auto* var = callee.as<VarNode>()) {
+        auto it = values.find(var);
+        if (it != values.end()) {
+          callee = it->second;
+        }
+      }
+      return !IsNonDeterministicCallee(callee);
+    }
+    return call->op.same_as(alloc_storage_op) || call->op.same_as(alloc_tensor_op) ||
+           call->op.same_as(set_shape_op) || call->op.same_as(infer_type_op);
+  };
+
+  // Hoist the candidates depending only on the invariants, and then exclude the storages and the
+  // tensors shared with the iterations until it converges.
+  std::unordered_set<const VarNode*> hoisted, banned;
+  while (true) {
+    hoisted.clear();
+    for (const auto* let : chain) {
+      if (banned.count(let->var.get()) || !is_hoistable(let->value)) {
+        continue;
+      }
+      bool invariant = true;
+      for (const auto& var : tvm::relay::FreeVars(let->value)) {
+        invariant &= invariant_params.count(var.get()) || hoisted.count(var.get());
+      }
+      if (invariant) {
+        hoisted.insert(let->var.get());
+      }
+    }
+    size_t num_banned = banned.size();
+    auto ban = [&](const Expr& expr) {
+      if (const auto* var = expr.as<VarNode>()) {
+        if (hoisted.count(var)) {
+          banned.insert(var);
+        }
+      }
+    };
+    for (const auto* let : lets) {
+      if (hoisted.count(let->var.get())) {
+        continue;
+      }
+      const auto* call = let->value.as<CallNode>();
+      bool is_free = call != nullptr && call->op.same_as(free_op);
+      for (const auto& var : tvm::relay::FreeVars(let->value)) {
+        auto it = values.find(var.get());
+        const auto* alloc = it == values.end() ? nullptr : it->second.as<CallNode>();
+        if (is_free || (alloc != nullptr && alloc->op.same_as(alloc_storage_op))) {
+          ban(var);
+        }
+      }
+      if (call != nullptr && call->op.same_as(invoke_op)) {
+        // The outputs are written by the iterations.
+        ban(call->args[2]);
+        if (const auto* var = call->args[2].as<VarNode>()) {
+          auto it = values.find(var);
+          if (it != values.end() && it->second.as<TupleNode>()) {
+            for (const auto& field : Downcast<Tuple>(it->second)->fields) {
+              ban(field);
+            }
+          }
+        }
+      }
+    }
+    // The ops of the next iteration may write the values carried to it in place.
+    for (const auto* call : tail_calls) {
+      for (size_t i = 0; i < func->params.size(); ++i) {
+        if (!invariant_params.count(func->params[i].get())) {
+          ban(call->args[i]);
+        }
+      }
+    }
+    if (banned.size() == num_banned) {
+      break;
+    }
+  }
+  std::vector<Let> ret;
+  for (const auto* let : chain) {
+    if (hoisted.count(let->var.get())) {
+      ret.push_back(GetRef<Let>(let));
+    }
+  }
+  return ret;
+}
+
 class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
  public:
   VMFunctionCompiler(VMCompilerContext* context, DeviceMap device_map)
@@ -211,7 +424,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
     for (auto param : func->params) {
       auto arg_register = NewRegister();
       CHECK_EQ(i, arg_register);
-      var_register_map_.insert({param, arg_register});
+      BindRegister(param, arg_register);
       params_.push_back(param->name_hint());
       ++i;
     }
@@ -227,23 +440,59 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       for (auto param : inner_func->params) {
         auto arg_register = NewRegister();
         CHECK_EQ(i, arg_register);
-        var_register_map_.insert({param, arg_register});
+        BindRegister(param, arg_register);
         params_.push_back(param->name_hint());
         ++i;
       }
       this->VisitExpr(inner_func->body);
     } else {
+      // A function calling itself in the tail positions, e.g., a loop of the hybrid Python, is
+      // compiled into a loop instead of the frames, whose invariants are hoisted before its head.
+      if (pass::PassContext::Current()->GetConfig("raf.vm.compile_loops", Bool(true)).value()) {
+        FindTailCalls(func->body, var, &tail_calls_);
+      }
+      if (!tail_calls_.empty()) {
+        for (const auto& let : FindLoopInvariants(func, var, tail_calls_)) {
+          expr_map_[let->var] = let->value;
+          this->VisitExpr(let->value);
+          BindRegister(let->var, this->last_register_);
+          hoisted_.insert(let->var);
+        }
+        loop_head_ = instructions_.size();
+      }
       this->VisitExpr(func->body);
     }
     instructions_.push_back(Instruction::Ret(last_register_));
     return VMFunction(var->name_hint, params_, instructions_, registers_num_);
   }
 
+  /*! \brief The IR var name of each virtual register, which is empty for a temporary. */
+  std::vector<std::string> RegisterNames() const {
+    auto names = register_names_;
+    names.resize(registers_num_);
+    return names;
+  }
+
  protected:
   size_t NewRegister() {
     return registers_num_++;
   }
 
+  /*!
+   * \brief Bind the var to the register. The register is named by the last var bound to it, e.g.,
+   * the let var of an op, which is bound to the tensor allocated for its output by ManifestAlloc.
+   */
+  void BindRegister(const Var& var, Index reg) {
+    var_register_map_.insert({var, reg});
+    if (reg < 0) {
+      return;
+    }
+    if (register_names_.size() <= static_cast<size_t>(reg)) {
+      register_names_.resize(reg + 1);
+    }
+    register_names_[reg] = var->name_hint();
+  }
+
   inline void Emit(const Instruction& instr) {
     DLOG(INFO) << "VMCompiler::Emit: instr=" << instr;
     CHECK((int)instr.op < 100) << "Invalid opcode " << (int)instr.op;
@@ -261,11 +510,13 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       case Opcode::InvokeClosure:
       case Opcode::InferType:
       case Opcode::SetShape:
+      case Opcode::InvokeJitAsync:
         last_register_ = instr.dst;
         break;
       case Opcode::InvokePacked:
       case Opcode::InvokeJit:
       case Opcode::Free:
+      case Opcode::Kill:
       case Opcode::If:
       case Opcode::Ret:
       case Opcode::Goto:
@@ -274,6 +525,9 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       case Opcode::CudaAddEvent:
       case Opcode::CudaWaitEvent:
       case Opcode::CudaStreamBarrier:
+      case Opcode::InvokeJitFree:
+      case Opcode::CudaSetStreamWait:
+      case Opcode::Wait:
         last_register_ = -1;
         break;
     }
@@ -318,10 +572,14 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
     // Iteratively visit let nodes to avoid stack overflow.
     while (body->IsInstance<LetNode>()) {
       Let let = Downcast<Let>(body);
+      if (hoisted_.count(let->var)) {
+        body = let->body;
+        continue;
+      }
       DLOG(INFO) << PrettyPrint(let->value);
       expr_map_[let->var] = let->value;
       this->VisitExpr(let->value);
-      var_register_map_.insert({let->var, this->last_register_});
+      BindRegister(let->var, this->last_register_);
       body = let->body;
     }
     this->VisitExpr(body);
@@ -412,8 +670,9 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
           .Match("raf.op.vm.alloc_tensor",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
                    bool own = true;
-                   if (args.size() == 5) {
-                     // The last "own" argument is usually specified by the MemoryPlan pass
+                   Index offset = 0;
+                   if (args.size() >= 5) {
+                     // The "own" argument is usually specified by the MemoryPlan pass
                      // to indicate that this tensor is not the final output so it should not
                      // own the memory pointer.
                      CHECK(args[4].as<ConstantNode>());
@@ -423,6 +682,16 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                    } else {
                      CHECK_EQ(args.size(), 4);
                    }
+                   if (args.size() == 6) {
+                     // The "offset" argument is specified by the MemoryPlan pass when
+                     // multiple tensors are packed into one storage.
+                     CHECK(args[5].as<ConstantNode>());
+                     auto offset_val = args[5].as<ConstantNode>()->value;
+                     CHECK(offset_val->IsInstance<IntValueObj>());
+                     offset = offset_val.as<IntValueObj>()->value;
+                   } else {
+                     CHECK_LE(args.size(), 5);
+                   }
 
                    // The storage will be passed dynamically.
                    this->VisitExpr(args[0]);
@@ -448,12 +717,12 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                        raw_shape.push_back(imm->value);
                      }
                      // Add context field.
-                     Emit(Instruction::AllocTensor(storage_register, 0, raw_shape, dtype,
+                     Emit(Instruction::AllocTensor(storage_register, offset, raw_shape, dtype,
                                                    NewRegister(), own));
                    } else {
                      this->VisitExpr(args[1]);
-                     Emit(Instruction::AllocTensorReg(storage_register, 0, last_register_, dtype,
-                                                      NewRegister(), own));
+                     Emit(Instruction::AllocTensorReg(storage_register, offset, last_register_,
+                                                      dtype, NewRegister(), own));
                    }
                  })
           .Match("raf.op.vm.alloc_storage",
@@ -510,18 +779,26 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                  })
           .Match("raf.op.vm.set_shape",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
-                   CHECK_EQ(args.size(), 2);
+                   CHECK(args.size() == 2 || args.size() == 3);
+                   Index offset = 0;
+                   if (args.size() == 3) {
+                     // The offset of a view in the elements of the data.
+                     CHECK(args[2].as<ConstantNode>());
+                     auto offset_val = args[2].as<ConstantNode>()->value;
+                     CHECK(offset_val->IsInstance<IntValueObj>());
+                     offset = offset_val.as<IntValueObj>()->value;
+                   }
                    this->VisitExpr(args[0]);
                    auto data_reg = last_register_;
                    // The shape argument may be a constant or a tensor
                    this->VisitExpr(args[1]);
                    auto shape_reg = last_register_;
-                   Emit(Instruction::SetShape(data_reg, shape_reg, NewRegister()));
+                   Emit(Instruction::SetShape(data_reg, shape_reg, NewRegister(), offset));
                  })
           .Match(
               "raf.op.set_stream",
               [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
-                CHECK_EQ(args.size(), 2);
+                CHECK(args.size() == 2 || args.size() == 3);
                 this->VisitExpr(args[0]);
                 Expr device_id_expr;
                 if (args[0].as<VarNode>()) {
@@ -538,7 +815,15 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
                   stream_id_expr = args[1];
                 }
                 Index stream_id = stream_id_expr.as<ConstantNode>()->value.as<IntValueObj>()->value;
-                Emit(Instruction::CudaSetStream(device_id, stream_id));
+                Index priority = 0;
+                if (args.size() == 3) {
+                  Expr priority_expr = args[2];
+                  if (args[2].as<VarNode>()) {
+                    priority_expr = expr_map_[GetRef<Var>(args[2].as<VarNode>())];
+                  }
+                  priority = priority_expr.as<ConstantNode>()->value.as<IntValueObj>()->value;
+                }
+                Emit(Instruction::CudaSetStream(device_id, stream_id, priority));
               })
           .Match("raf.op.add_event",
                  [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
@@ -626,7 +911,9 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       // perhaps establish as an invariance(all functions in mod must be relay::Function)
       auto func = Downcast<Function>(context_->module->Lookup(global));
 
-      if (tvm::relay::vm::IsClosure(func)) {
+      if (tail_calls_.count(call_node)) {
+        EmitLoopBack(args_registers);
+      } else if (tvm::relay::vm::IsClosure(func)) {
         auto arity = func->params.size();
         Emit(Instruction::AllocClosure(it->second, args_registers, NewRegister()));
       } else {
@@ -658,6 +945,26 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
     }
   }
 
+  /*!
+   * \brief Jump back to the loop head for a tail call of the function to itself. The arguments are
+   * moved into the parameters through temporaries, because an argument may be another parameter.
+   */
+  void EmitLoopBack(const std::vector<Index>& args_registers) {
+    std::vector<std::pair<Index, Index>> moves;
+    for (size_t i = 0; i < args_registers.size(); ++i) {
+      if (args_registers[i] != static_cast<Index>(i)) {
+        Emit(Instruction::Move(args_registers[i], NewRegister()));
+        moves.emplace_back(last_register_, i);
+      }
+    }
+    for (const auto& move : moves) {
+      Emit(Instruction::Move(move.first, move.second));
+    }
+    Emit(Instruction::Goto(loop_head_ - static_cast<Index>(instructions_.size())));
+    // The control never falls through, so the result is never read.
+    last_register_ = NewRegister();
+  }
+
   /*!
    * \brief Compile a match value
    * Generate byte code that compute the value specificed in val
@@ -765,6 +1072,8 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
   std::vector<std::string> params_;
   /*! \brief Map from var to register number. */
   std::unordered_map<Var, RegName, ObjectPtrHash, ObjectPtrEqual> var_register_map_;
+  /*! \brief The name of each register, which is the name of the last var bound to it. */
+  std::vector<std::string> register_names_;
   /*! \brief Last used register number. */
   Index last_register_;
   /*! \brief Total number of virtual registers allocated. */
@@ -773,8 +1082,776 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
   VMCompilerContext* context_;
   /*! \brief Device map. */
   DeviceMap device_map_;
+  /*! \brief The tail calls of the function to itself, which jump back to the loop head. */
+  std::unordered_set<const CallNode*> tail_calls_;
+  /*! \brief The loop invariants hoisted before the loop head. */
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> hoisted_;
+  /*! \brief The pc of the loop head. */
+  Index loop_head_ = 0;
 };
 
+std::vector<Instruction> FuseInstructions(const std::vector<Instruction>& instructions) {
+  size_t n = instructions.size();
+  // Instructions that are jump targets cannot be absorbed into a superinstruction.
+  std::vector<bool> is_target(n + 1, false);
+  for (size_t pc = 0; pc < n; ++pc) {
+    const auto& instr = instructions[pc];
+    if (instr.op == Opcode::If) {
+      is_target[pc + instr.if_op.true_offset] = true;
+      is_target[pc + instr.if_op.false_offset] = true;
+    } else if (instr.op == Opcode::Goto) {
+      is_target[pc + instr.pc_offset] = true;
+    }
+  }
+
+  std::vector<Instruction> fused;
+  // Map from the old pc to the new pc of the (super)instruction starting there.
+  std::vector<Index> new_pc(n + 1, -1);
+  // Map from the new pc back to the old pc, used to patch the jump offsets.
+  std::vector<size_t> old_pc;
+  size_t pc = 0;
+  while (pc < n) {
+    const auto& instr = instructions[pc];
+    new_pc[pc] = fused.size();
+    old_pc.push_back(pc);
+    if (instr.op == Opcode::InvokeJit) {
+      std::vector<RegName> frees;
+      size_t next = pc + 1;
+      while (next < n && instructions[next].op == Opcode::Free && !is_target[next]) {
+        frees.push_back(instructions[next].free.memory);
+        ++next;
+      }
+      if (!frees.empty()) {
+        const auto& jit = instr.invoke_jit;
+        std::vector<RegName> args(jit.args, jit.args + jit.arity);
+        fused.push_back(
+            Instruction::InvokeJitFree(jit.op_reg, jit.arity, jit.output_size, args, frees));
+        pc = next;
+        continue;
+      }
+    } else if (instr.op == Opcode::CudaSetStream && instr.cuda_set_stream.priority == 0 &&
+               pc + 1 < n && instructions[pc + 1].op == Opcode::CudaWaitEvent &&
+               !is_target[pc + 1]) {
+      // CudaSetStreamWait has no priority, so the set stream with a priority is not fused.
+      const auto& wait = instructions[pc + 1].cuda_event;
+      fused.push_back(Instruction::CudaSetStreamWait(instr.cuda_set_stream.device_id,
+                                                     instr.cuda_set_stream.stream_id,
+                                                     wait.event_id, wait.stream_id));
+      pc += 2;
+      continue;
+    }
+    fused.push_back(instr);
+    ++pc;
+  }
+  new_pc[n] = fused.size();
+
+  // Patch the relative offsets of the control instructions.
+  for (size_t i = 0; i < fused.size(); ++i) {
+    auto& instr = fused[i];
+    Index from = old_pc[i];
+    if (instr.op == Opcode::If) {
+      instr.if_op.true_offset = new_pc[from + instr.if_op.true_offset] - static_cast<Index>(i);
+      instr.if_op.false_offset = new_pc[from + instr.if_op.false_offset] - static_cast<Index>(i);
+    } else if (instr.op == Opcode::Goto) {
+      instr.pc_offset = new_pc[from + instr.pc_offset] - static_cast<Index>(i);
+    }
+  }
+  return fused;
+}
+
+/*!
+ * \brief Apply a function to every register operand of an instruction.
+ * \param instr The instruction to visit.
+ * \param fvisit The function taking the register (by reference) and whether it is a definition.
+ */
+template <typename FVisit>
+void VisitRegisters(Instruction* instr, FVisit fvisit) {
+  switch (instr->op) {
+    case Opcode::Move:
+      fvisit(instr->from, false);
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::Ret:
+      fvisit(instr->result, false);
+      break;
+    case Opcode::LoadConst:
+    case Opcode::LoadConsti:
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::GetField:
+      fvisit(instr->get_field.object, false);
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::If:
+      fvisit(instr->if_op.test, false);
+      fvisit(instr->if_op.target, false);
+      break;
+    case Opcode::AllocStorage:
+      fvisit(instr->alloc_storage.allocation_size, false);
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::AllocTensor:
+      fvisit(instr->alloc_tensor.storage, false);
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::AllocTensorReg:
+      fvisit(instr->alloc_tensor_reg.storage, false);
+      fvisit(instr->alloc_tensor_reg.shape_register, false);
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::AllocTuple:
+      for (Index i = 0; i < instr->alloc_tuple.num_fields; ++i) {
+        fvisit(instr->alloc_tuple.fields[i], false);
+      }
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::AllocClosure:
+      for (Index i = 0; i < instr->alloc_closure.num_free_vars; ++i) {
+        fvisit(instr->alloc_closure.free_vars[i], false);
+      }
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::SetShape:
+      fvisit(instr->set_shape.data, false);
+      fvisit(instr->set_shape.shape, false);
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::Free:
+      fvisit(instr->free.memory, false);
+      break;
+    case Opcode::Kill:
+      fvisit(instr->kill.reg, false);
+      break;
+    case Opcode::InvokeFunc:
+      for (Index i = 0; i < instr->invoke_func.num_args; ++i) {
+        fvisit(instr->invoke_func.args[i], false);
+      }
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::InvokeClosure:
+      fvisit(instr->invoke_closure.closure, false);
+      for (Index i = 0; i < instr->invoke_closure.num_args; ++i) {
+        fvisit(instr->invoke_closure.args[i], false);
+      }
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::InvokePacked:
+      for (Index i = 0; i < instr->invoke_packed.arity; ++i) {
+        fvisit(instr->invoke_packed.args[i], false);
+      }
+      break;
+    case Opcode::InvokeJit:
+    case Opcode::InvokeJitFree:
+      fvisit(instr->invoke_jit.op_reg, false);
+      for (Index i = 0; i < instr->invoke_jit.arity + instr->invoke_jit.num_frees; ++i) {
+        fvisit(instr->invoke_jit.args[i], false);
+      }
+      break;
+    case Opcode::InvokeJitAsync:
+      fvisit(instr->invoke_jit.op_reg, false);
+      for (Index i = 0; i < instr->invoke_jit.arity; ++i) {
+        fvisit(instr->invoke_jit.args[i], false);
+      }
+      fvisit(instr->dst, true);
+      break;
+    case Opcode::Wait:
+      fvisit(instr->wait.handle, false);
+      break;
+    case Opcode::InferType:
+      fvisit(instr->infer_type.op_reg, false);
+      for (Index i = 0; i < instr->infer_type.num_args; ++i) {
+        fvisit(instr->infer_type.args[i], false);
+      }
+      fvisit(instr->dst, true);
+      break;
+    default:
+      // Fatal, Goto and the CUDA stream instructions have no register operands.
+      break;
+  }
+}
+
+/*!
+ * \brief Extend the live intervals in program order of the registers live into the loops, i.e.,
+ * the parameters and the registers used before a loop head and in the loop, to the backward Goto
+ * of the loop, so they survive all the iterations.
+ */
+static void ExtendLoopIntervals(const std::vector<Instruction>& instructions, Index num_params,
+                                const std::vector<Index>& start, std::vector<Index>* end) {
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t pc = 0; pc < instructions.size(); ++pc) {
+      const auto& instr = instructions[pc];
+      if (instr.op != Opcode::Goto || instr.pc_offset > 0) {
+        continue;
+      }
+      Index back = pc;
+      Index head = back + instr.pc_offset;
+      for (size_t reg = 0; reg < end->size(); ++reg) {
+        bool live_in =
+            static_cast<Index>(reg) < num_params || (start[reg] >= 0 && start[reg] < head);
+        if (live_in && (*end)[reg] >= head && (*end)[reg] < back) {
+          (*end)[reg] = back;
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+size_t InsertKills(VMFunction* func) {
+  auto& instructions = func->instructions;
+  size_t n = instructions.size();
+  Index num_regs = func->register_file_size;
+  Index num_params = func->params.size();
+  for (const auto& instr : instructions) {
+    if (instr.op == Opcode::CudaSetStream || instr.op == Opcode::CudaSetStreamWait) {
+      return 0;
+    }
+  }
+
+  // The first and the last use of each register, and whether it holds a value that can be
+  // released.
+  std::vector<Index> start(num_regs, -1), end(num_regs, -1);
+  std::vector<bool> killable(num_regs, false);
+  // The storages each register refers to through the views that do not own the memory.
+  std::vector<std::vector<RegName>> storages(num_regs);
+  auto inherit = [&](RegName dst, RegName src) {
+    if (src >= 0 && dst != src) {
+      storages[dst].insert(storages[dst].end(), storages[src].begin(), storages[src].end());
+    }
+  };
+  for (size_t pc = 0; pc < n; ++pc) {
+    auto& instr = instructions[pc];
+    VisitRegisters(&instr, [&](RegName& reg, bool is_def) {
+      if (reg < 0) {
+        return;
+      }
+      CHECK_LT(reg, num_regs) << "Invalid register $" << reg;
+      if (start[reg] == -1) {
+        start[reg] = pc;
+      }
+      end[reg] = std::max(end[reg], static_cast<Index>(pc));
+      if (is_def && reg >= num_params) {
+        killable[reg] = instr.op != Opcode::LoadConst && instr.op != Opcode::LoadConsti;
+      }
+    });
+    switch (instr.op) {
+      case Opcode::AllocTensor:
+        if (!instr.alloc_tensor.own) {
+          storages[instr.dst].push_back(instr.alloc_tensor.storage);
+        }
+        break;
+      case Opcode::AllocTensorReg:
+        if (!instr.alloc_tensor_reg.own) {
+          storages[instr.dst].push_back(instr.alloc_tensor_reg.storage);
+        }
+        break;
+      case Opcode::SetShape:
+        inherit(instr.dst, instr.set_shape.data);
+        break;
+      case Opcode::Move:
+        inherit(instr.dst, instr.from);
+        break;
+      case Opcode::GetField:
+        inherit(instr.dst, instr.get_field.object);
+        break;
+      case Opcode::AllocTuple:
+        for (Index i = 0; i < instr.alloc_tuple.num_fields; ++i) {
+          inherit(instr.dst, instr.alloc_tuple.fields[i]);
+        }
+        break;
+      case Opcode::AllocClosure:
+        for (Index i = 0; i < instr.alloc_closure.num_free_vars; ++i) {
+          inherit(instr.dst, instr.alloc_closure.free_vars[i]);
+        }
+        break;
+      case Opcode::InvokeFunc:
+        // The callee may return the views passed to it.
+        for (Index i = 0; i < instr.invoke_func.num_args; ++i) {
+          inherit(instr.dst, instr.invoke_func.args[i]);
+        }
+        break;
+      case Opcode::InvokeClosure:
+        inherit(instr.dst, instr.invoke_closure.closure);
+        for (Index i = 0; i < instr.invoke_closure.num_args; ++i) {
+          inherit(instr.dst, instr.invoke_closure.args[i]);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  ExtendLoopIntervals(instructions, num_params, start, &end);
+  for (Index reg = 0; reg < num_regs; ++reg) {
+    for (RegName storage : storages[reg]) {
+      end[storage] = std::max(end[storage], end[reg]);
+    }
+  }
+  ExtendLoopIntervals(instructions, num_params, start, &end);
+
+  // The registers to be killed after each instruction.
+  std::vector<std::vector<RegName>> kills(n);
+  size_t num_kills = 0;
+  for (Index reg = 0; reg < num_regs; ++reg) {
+    if (!killable[reg] || end[reg] == -1) {
+      continue;
+    }
+    auto op = instructions[end[reg]].op;
+    if (op == Opcode::If || op == Opcode::Goto || op == Opcode::Ret || op == Opcode::Fatal) {
+      continue;
+    }
+    kills[end[reg]].push_back(reg);
+    num_kills++;
+  }
+  if (num_kills == 0) {
+    return 0;
+  }
+
+  std::vector<Instruction> killed;
+  // Map from the old pc to the new pc of the instruction.
+  std::vector<Index> new_pc(n + 1, -1);
+  for (size_t pc = 0; pc < n; ++pc) {
+    new_pc[pc] = killed.size();
+    killed.push_back(instructions[pc]);
+    for (RegName reg : kills[pc]) {
+      killed.push_back(Instruction::Kill(reg));
+    }
+  }
+  new_pc[n] = killed.size();
+
+  // Patch the relative offsets of the control instructions.
+  for (size_t pc = 0; pc < n; ++pc) {
+    auto& instr = killed[new_pc[pc]];
+    if (instr.op == Opcode::If) {
+      instr.if_op.true_offset = new_pc[pc + instr.if_op.true_offset] - new_pc[pc];
+      instr.if_op.false_offset = new_pc[pc + instr.if_op.false_offset] - new_pc[pc];
+    } else if (instr.op == Opcode::Goto) {
+      instr.pc_offset = new_pc[pc + instr.pc_offset] - new_pc[pc];
+    }
+  }
+  instructions = std::move(killed);
+  return num_kills;
+}
+
+size_t InsertCollectiveWaits(VMFunction* func, const std::vector<Value>& constants,
+                             Index device_id) {
+  auto& instructions = func->instructions;
+  size_t n = instructions.size();
+  for (const auto& instr : instructions) {
+    switch (instr.op) {
+      case Opcode::CudaSetStream:
+      case Opcode::CudaAddEvent:
+      case Opcode::CudaWaitEvent:
+      case Opcode::CudaStreamBarrier:
+      case Opcode::CudaSetStreamWait:
+        return 0;
+      default:
+        break;
+    }
+  }
+  std::vector<bool> is_target(n + 1, false);
+  for (size_t pc = 0; pc < n; ++pc) {
+    const auto& instr = instructions[pc];
+    if (instr.op == Opcode::If) {
+      is_target[pc + instr.if_op.true_offset] = true;
+      is_target[pc + instr.if_op.false_offset] = true;
+    } else if (instr.op == Opcode::Goto) {
+      is_target[pc + instr.pc_offset] = true;
+    }
+  }
+
+  Index num_regs = func->register_file_size;
+  // The constant loaded to each register, and the tensors, tuple fields and storages each
+  // register refers to.
+  std::vector<Index> const_index(num_regs, -1);
+  std::vector<std::vector<RegName>> refs(num_regs);
+  auto inherit = [&](RegName dst, RegName src) {
+    if (src >= 0 && dst != src) {
+      refs[dst].push_back(src);
+      refs[dst].insert(refs[dst].end(), refs[src].begin(), refs[src].end());
+    }
+  };
+  auto is_collective = [&](RegName op_reg) {
+    if (op_reg < 0 || const_index[op_reg] < 0) {
+      return false;
+    }
+    auto opv = constants[const_index[op_reg]].as<OpValueObj>();
+    if (opv == nullptr) {
+      return false;
+    }
+    return op::IsCollectiveOp(op::IsDialectOp(opv->op) ? op::GetBaseOp(opv->op) : opv->op);
+  };
+
+  // A launched collective whose handle has not been waited yet.
+  struct Pending {
+    /*! \brief The register of the completion handle. */
+    RegName handle;
+    /*! \brief The registers whose memory the collective may read or write. */
+    std::unordered_set<RegName> regs;
+    /*! \brief The Kill and Free of these registers, which are moved after the Wait. */
+    std::vector<Instruction> deferred;
+  };
+  std::vector<Pending> pending;
+  std::vector<Instruction> out;
+  // Collectives are serialized on the communication stream, so waiting for a handle also
+  // completes all the collectives launched before it.
+  auto wait = [&](size_t i) {
+    out.push_back(Instruction::Wait(pending[i].handle));
+    for (size_t j = 0; j <= i; ++j) {
+      out.insert(out.end(), pending[j].deferred.begin(), pending[j].deferred.end());
+    }
+    pending.erase(pending.begin(), pending.begin() + i + 1);
+  };
+  auto find_pending = [&](RegName reg) {
+    for (size_t i = pending.size(); i-- > 0;) {
+      if (pending[i].regs.count(reg)) {
+        return static_cast<int64_t>(i);
+      }
+    }
+    return static_cast<int64_t>(-1);
+  };
+
+  std::vector<Index> new_pc(n + 1, -1);
+  size_t num_async = 0;
+  for (size_t pc = 0; pc < n; ++pc) {
+    Instruction instr = instructions[pc];
+    bool is_control = instr.op == Opcode::If || instr.op == Opcode::Goto ||
+                      instr.op == Opcode::Ret || instr.op == Opcode::Fatal;
+    // The handles are not defined on the other paths, so all of them are waited before the
+    // control flow joins or leaves.
+    if (!pending.empty() && (is_target[pc] || is_control)) {
+      wait(pending.size() - 1);
+    }
+    new_pc[pc] = out.size();
+    bool is_async = (instr.op == Opcode::InvokeJit || instr.op == Opcode::InvokeJitFree) &&
+                    is_collective(instr.invoke_jit.op_reg);
+    if (instr.op == Opcode::Kill || instr.op == Opcode::Free) {
+      RegName reg = instr.op == Opcode::Kill ? instr.kill.reg : instr.free.memory;
+      auto i = find_pending(reg);
+      if (i >= 0) {
+        pending[i].deferred.push_back(instr);
+        continue;
+      }
+    } else if (!is_async) {
+      // Wait as late as possible, i.e., right before the first instruction that touches the
+      // memory of a pending collective. The next collectives are ordered by the stream instead.
+      int64_t last = -1;
+      VisitRegisters(&instr, [&](RegName& reg, bool is_def) {
+        if (reg >= 0) {
+          last = std::max(last, find_pending(reg));
+        }
+      });
+      if (last >= 0) {
+        wait(last);
+      }
+    }
+
+    if (is_async) {
+      const auto& jit = instr.invoke_jit;
+      std::vector<RegName> args(jit.args, jit.args + jit.arity);
+      Pending p;
+      p.handle = num_regs++;
+      for (RegName arg : args) {
+        p.regs.insert(arg);
+        p.regs.insert(refs[arg].begin(), refs[arg].end());
+      }
+      // The tuples and views that refer to the arguments also touch their memory.
+      for (Index reg = 0; reg < static_cast<Index>(refs.size()); ++reg) {
+        for (RegName ref : refs[reg]) {
+          if (p.regs.count(ref)) {
+            p.regs.insert(reg);
+            break;
+          }
+        }
+      }
+      for (Index i = 0; i < jit.num_frees; ++i) {
+        p.deferred.push_back(Instruction::Free(jit.args[jit.arity + i]));
+      }
+      out.push_back(
+          Instruction::InvokeJitAsync(jit.op_reg, jit.arity, jit.output_size, args, p.handle));
+      pending.push_back(std::move(p));
+      num_async++;
+      continue;
+    }
+
+    switch (instr.op) {
+      case Opcode::LoadConst:
+        const_index[instr.dst] = instr.const_index;
+        break;
+      case Opcode::AllocTensor:
+        inherit(instr.dst, instr.alloc_tensor.storage);
+        break;
+      case Opcode::AllocTensorReg:
+        inherit(instr.dst, instr.alloc_tensor_reg.storage);
+        break;
+      case Opcode::SetShape:
+        inherit(instr.dst, instr.set_shape.data);
+        break;
+      case Opcode::Move:
+        inherit(instr.dst, instr.from);
+        break;
+      case Opcode::GetField:
+        inherit(instr.dst, instr.get_field.object);
+        break;
+      case Opcode::AllocTuple:
+        for (Index i = 0; i < instr.alloc_tuple.num_fields; ++i) {
+          inherit(instr.dst, instr.alloc_tuple.fields[i]);
+        }
+        break;
+      default:
+        break;
+    }
+    out.push_back(instr);
+  }
+  CHECK(pending.empty()) << "Function " << func->name << " does not end with a Ret";
+  new_pc[n] = out.size();
+  if (num_async == 0) {
+    return 0;
+  }
+
+  // Patch the relative offsets of the control instructions, which are never moved.
+  for (size_t pc = 0; pc < n; ++pc) {
+    if (instructions[pc].op != Opcode::If && instructions[pc].op != Opcode::Goto) {
+      continue;
+    }
+    auto& instr = out[new_pc[pc]];
+    if (instr.op == Opcode::If) {
+      instr.if_op.true_offset = new_pc[pc + instr.if_op.true_offset] - new_pc[pc];
+      instr.if_op.false_offset = new_pc[pc + instr.if_op.false_offset] - new_pc[pc];
+    } else {
+      instr.pc_offset = new_pc[pc + instr.pc_offset] - new_pc[pc];
+    }
+  }
+  // Run the computation on a stream other than the legacy default stream, which implicitly
+  // synchronizes with the communication stream.
+  CHECK_EQ(num_regs, func->register_file_size + static_cast<Index>(num_async));
+  out.insert(out.begin(), Instruction::CudaSetStream(device_id, stream_pool::kCudaCompute, 0));
+  func->instructions = std::move(out);
+  func->register_file_size = num_regs;
+  return num_async;
+}
+
+void AllocateRegisters(VMFunction* func) {
+  auto& instructions = func->instructions;
+  Index num_regs = func->register_file_size;
+  Index num_params = func->params.size();
+  // Overwriting a reused register drops the last reference to its value on the host, which is
+  // only safe when the kernels reading it are ordered before the next one on a single stream, the
+  // same as the kills.
+  for (const auto& instr : instructions) {
+    if (instr.op == Opcode::CudaSetStream || instr.op == Opcode::CudaSetStreamWait) {
+      return;
+    }
+  }
+  // The live interval of each virtual register in program order. The VM bytecode only jumps
+  // forward except for the loops, whose live-in registers are extended to their backward Gotos,
+  // so every path from a definition to a use stays within this interval.
+  std::vector<Index> start(num_regs, -1), end(num_regs, -1);
+  // Registers written by LoadConst are marked as constant in the frame and the flag is never
+  // reset, so they are only reused by other constants.
+  std::vector<bool> is_const(num_regs, false);
+  // (source, view) pairs: a view does not own the memory of its source, so the source has to
+  // stay alive as long as the view does.
+  std::vector<std::pair<RegName, RegName>> aliases;
+  for (Index i = 0; i < num_params; ++i) {
+    start[i] = end[i] = 0;
+  }
+  for (size_t pc = 0; pc < instructions.size(); ++pc) {
+    auto& instr = instructions[pc];
+    VisitRegisters(&instr, [&](RegName& reg, bool is_def) {
+      if (reg < 0) {
+        return;
+      }
+      CHECK_LT(reg, num_regs) << "Invalid register $" << reg;
+      if (start[reg] == -1) {
+        start[reg] = pc;
+      }
+      end[reg] = std::max(end[reg], static_cast<Index>(pc));
+    });
+    if (instr.op == Opcode::LoadConst) {
+      is_const[instr.dst] = true;
+    } else if (instr.op == Opcode::AllocTensor && !instr.alloc_tensor.own) {
+      aliases.emplace_back(instr.alloc_tensor.storage, instr.dst);
+    } else if (instr.op == Opcode::AllocTensorReg && !instr.alloc_tensor_reg.own) {
+      aliases.emplace_back(instr.alloc_tensor_reg.storage, instr.dst);
+    } else if (instr.op == Opcode::SetShape) {
+      aliases.emplace_back(instr.set_shape.data, instr.dst);
+    }
+  }
+  ExtendLoopIntervals(instructions, num_params, start, &end);
+  // Visit the latest views first so that the extension propagates along chains of views.
+  for (auto it = aliases.rbegin(); it != aliases.rend(); ++it) {
+    end[it->first] = std::max(end[it->first], end[it->second]);
+  }
+  ExtendLoopIntervals(instructions, num_params, start, &end);
+
+  // Linear scan over the live intervals. Parameters are pinned to their registers because
+  // PushFrame writes the arguments to the first registers of the frame.
+  std::vector<RegName> mapping(num_regs, -1);
+  std::vector<RegName> order;
+  for (Index reg = num_params; reg < num_regs; ++reg) {
+    if (start[reg] != -1) {
+      order.push_back(reg);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](RegName a, RegName b) { return start[a] < start[b]; });
+  // The physical registers in use, ordered by the end of their current interval.
+  std::multimap<Index, RegName> active;
+  std::vector<bool> phys_const;
+  std::vector<RegName> free_regs[2];
+  for (Index i = 0; i < num_params; ++i) {
+    mapping[i] = i;
+    phys_const.push_back(false);
+    active.emplace(end[i], i);
+  }
+  for (RegName reg : order) {
+    while (!active.empty() && active.begin()->first < start[reg]) {
+      RegName phys = active.begin()->second;
+      free_regs[phys_const[phys]].push_back(phys);
+      active.erase(active.begin());
+    }
+    auto& pool = free_regs[is_const[reg]];
+    RegName phys;
+    if (pool.empty()) {
+      phys = phys_const.size();
+      phys_const.push_back(is_const[reg]);
+    } else {
+      phys = pool.back();
+      pool.pop_back();
+    }
+    mapping[reg] = phys;
+    active.emplace(end[reg], phys);
+  }
+
+  for (auto& instr : instructions) {
+    VisitRegisters(&instr, [&](RegName& reg, bool is_def) {
+      if (reg >= 0) {
+        reg = mapping[reg];
+      }
+    });
+  }
+  func->register_file_size = phys_const.size();
+}
+
+void PlanStaticArenas(VMFunction* func, const std::vector<Value>& constants) {
+  auto& instructions = func->instructions;
+  for (const auto& instr : instructions) {
+    switch (instr.op) {
+      case Opcode::If:
+      case Opcode::Goto:
+      case Opcode::CudaSetStream:
+      case Opcode::CudaAddEvent:
+      case Opcode::CudaWaitEvent:
+      case Opcode::CudaStreamBarrier:
+      case Opcode::CudaSetStreamWait:
+      case Opcode::InvokeJitAsync:
+        // The live intervals in program order are only exact for straight-line code on
+        // a single stream.
+        return;
+      default:
+        break;
+    }
+  }
+
+  // A candidate storage and the live interval of it and all the tensors viewing it.
+  struct Region {
+    Index pc;
+    Index size;
+    Index alignment;
+    Index start;
+    Index end;
+    bool escaped;
+  };
+  std::vector<Region> regions;
+  std::unordered_map<RegName, Index> const_index;
+  // The region of each register holding a candidate storage or a view of it.
+  std::unordered_map<RegName, Index> region_of;
+  for (size_t pc = 0; pc < instructions.size(); ++pc) {
+    auto& instr = instructions[pc];
+    bool escapes = false;
+    switch (instr.op) {
+      case Opcode::Ret:
+      case Opcode::Move:
+      case Opcode::AllocTuple:
+      case Opcode::AllocClosure:
+      case Opcode::InvokeFunc:
+      case Opcode::InvokeClosure:
+      case Opcode::InvokePacked:
+        escapes = true;
+        break;
+      default:
+        break;
+    }
+    VisitRegisters(&instr, [&](RegName& reg, bool is_def) {
+      auto it = region_of.find(reg);
+      if (is_def || it == region_of.end()) {
+        return;
+      }
+      auto& region = regions[it->second];
+      region.end = pc;
+      region.escaped |= escapes;
+    });
+    if (instr.op == Opcode::LoadConst) {
+      const_index[instr.dst] = instr.const_index;
+    } else if (instr.op == Opcode::AllocStorage) {
+      auto it = const_index.find(instr.alloc_storage.allocation_size);
+      if (it == const_index.end()) {
+        continue;
+      }
+      const auto* size = constants[it->second].as<IntValueObj>();
+      auto alignment = instr.alloc_storage.alignment;
+      if (size == nullptr || size->value <= 0 || alignment <= 0 ||
+          kStaticArenaAlignment % alignment != 0) {
+        continue;
+      }
+      region_of[instr.dst] = regions.size();
+      regions.push_back({static_cast<Index>(pc), size->value, alignment, static_cast<Index>(pc),
+                         static_cast<Index>(pc), false});
+    } else if (instr.op == Opcode::AllocTensor || instr.op == Opcode::AllocTensorReg ||
+               instr.op == Opcode::SetShape) {
+      RegName src = instr.op == Opcode::AllocTensor      ? instr.alloc_tensor.storage
+                    : instr.op == Opcode::AllocTensorReg ? instr.alloc_tensor_reg.storage
+                                                         : instr.set_shape.data;
+      auto it = region_of.find(src);
+      if (it != region_of.end()) {
+        region_of[instr.dst] = it->second;
+      }
+    }
+  }
+
+  // One arena per device, packed by the live intervals of the regions in it.
+  std::map<std::pair<Index, Index>, Index> arena_of;
+  std::vector<std::vector<Index>> members;
+  std::vector<std::vector<common::interval_packing::Interval>> arenas;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    const auto& region = regions[i];
+    if (region.escaped) {
+      continue;
+    }
+    const auto& alloc = instructions[region.pc].alloc_storage;
+    auto key = std::make_pair(alloc.device_type, alloc.device_id);
+    auto it = arena_of.find(key);
+    if (it == arena_of.end()) {
+      it = arena_of.emplace(key, arenas.size()).first;
+      members.emplace_back();
+      arenas.emplace_back();
+    }
+    members[it->second].push_back(region.pc);
+    arenas[it->second].push_back({region.start, region.end, region.size, region.alignment});
+  }
+  for (size_t arena = 0; arena < arenas.size(); ++arena) {
+    Index arena_size = common::interval_packing::PackIntervals(&arenas[arena]);
+    for (size_t i = 0; i < members[arena].size(); ++i) {
+      auto& alloc = instructions[members[arena][i]].alloc_storage;
+      alloc.arena_index = arena;
+      alloc.arena_offset = arenas[arena][i].offset;
+      alloc.arena_size = arena_size;
+    }
+  }
+}
+
 void VMCompiler::SetParam(const std::string& name, Value data_in) {
   params_[name] = data_in;
 }
@@ -796,6 +1873,7 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
 
   // Run the optimizations necessary to target the VM.
   context_.module = OptimizeModule(mod, device_map_);
+  pass_profiler::PassProfiler::Scope codegen_scope("VMCompiler::Codegen", context_.module);
 
   // Populate the global map.
   //
@@ -807,12 +1885,54 @@ void VMCompiler::Lower(IRModule mod, const DeviceMap& device_map) {
   // the global state.
   exec_->functions.resize(context_.module->functions.size());
 
+  bool fuse_instructions = pass::PassContext::Current()
+                               ->GetConfig("raf.vm.fuse_instructions", Bool(true))
+                               .value();
+  bool reuse_registers =
+      pass::PassContext::Current()->GetConfig("raf.vm.reuse_registers", Bool(true)).value();
+  bool static_arena =
+      pass::PassContext::Current()->GetConfig("raf.vm.static_arena", Bool(false)).value();
+  bool early_free =
+      pass::PassContext::Current()->GetConfig("raf.vm.early_free", Bool(true)).value();
+  bool async_collectives =
+      pass::PassContext::Current()->GetConfig("raf.vm.async_collectives", Bool(false)).value() &&
+      device_map_.size() == 1U && (*device_map_.begin()).second.device_type() == DevType::kCUDA();
+
   for (auto named_func : context_.module->functions) {
     auto gvar = named_func.first;
     if (auto* n = named_func.second.as<FunctionNode>()) {
       auto func = GetRef<Function>(n);
       VMFunctionCompiler func_compiler(&context_, device_map_);
       auto vm_func = func_compiler.Compile(gvar, func);
+      if (fuse_instructions) {
+        vm_func.instructions = FuseInstructions(vm_func.instructions);
+      }
+      if (early_free) {
+        auto num_kills = InsertKills(&vm_func);
+        DLOG(INFO) << "Inserted " << num_kills << " kills to " << vm_func.name;
+      }
+      if (async_collectives) {
+        // Run after InsertKills, whose kills of the collective buffers are moved after the waits.
+        auto device_id = (*device_map_.begin()).second.device_id();
+        auto num_async = InsertCollectiveWaits(&vm_func, context_.constants, device_id);
+        DLOG(INFO) << "Made " << num_async << " collectives asynchronous in " << vm_func.name;
+      }
+      if (static_arena) {
+        // Run before the register allocation, which lets a register hold several storages.
+        PlanStaticArenas(&vm_func, context_.constants);
+      }
+      // Name the allocations before the registers are reused, which makes a register hold
+      // several vars. The passes above may add registers, which are not named.
+      auto register_names = func_compiler.RegisterNames();
+      for (const auto& instr : vm_func.instructions) {
+        bool is_alloc = instr.op == Opcode::AllocStorage || instr.op == Opcode::AllocTensor ||
+                        instr.op == Opcode::AllocTensorReg;
+        bool named = is_alloc && static_cast<size_t>(instr.dst) < register_names.size();
+        vm_func.dst_names.push_back(named ? register_names[instr.dst] : "");
+      }
+      if (reuse_registers) {
+        AllocateRegisters(&vm_func);
+      }
 
       size_t func_index = context_.global_map.at(gvar);
       CHECK(func_index < exec_->functions.size());
@@ -851,22 +1971,82 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
   // optimization passes that work on ANF
   pass_seqs.push_back(pass::GradInputSelect());
   pass_seqs.push_back(pass::InlineLet());
+  // run both small branches of an if and select the results on the device.
+  int speculate_if = pass_ctx->GetConfig("raf.speculate_if", Integer(0)).value().IntValue();
+  if (speculate_if > 0) {
+    pass_seqs.push_back(pass::SpeculateIf(speculate_if));
+  }
   pass_seqs.push_back(pass::DeadCodeElimination());
+  // offload the supported regions to an external backend, e.g., TensorRT engines for inference.
+  auto partition_target = pass_ctx->GetConfig<tvm::String>("raf.partition.target", "");
+  if (!partition_target.value().empty() && device_t == DevType::kCUDA()) {
+    pass_seqs.push_back(pass::InferType());
+    pass_seqs.push_back(pass::AnnotateTarget({partition_target.value()}));
+    pass_seqs.push_back(pass::MergeCompilerRegions());
+    pass_seqs.push_back(pass::PartitionGraph());
+    pass_seqs.push_back(pass::LowerCompilerRegions());
+    pass_seqs.push_back(pass::InferType());
+  }
+  // cast each value to each dtype only once, e.g. the weights cast by AutoCast.
+  pass_seqs.push_back(pass::EliminateCast());
+  // apply the gradients of embedding in the row-sparse form.
+  if (pass_ctx->GetConfig("raf.sparse_embedding_grad", Bool(false)).value()) {
+    pass_seqs.push_back(pass::SparseEmbeddingGrad());
+  }
+  // group the per-parameter elementwise ops, e.g. the casts of the weights, into multi-tensor ops.
+  if (pass_ctx->GetConfig("raf.group_multi_tensor_ops", Bool(false)).value()) {
+    pass_seqs.push_back(pass::GroupMultiTensorOps());
+  }
+  // batch the independent small GEMMs of the same shapes, e.g. of the heads or the experts.
+  if (pass_ctx->GetConfig("raf.batch_gemms", Bool(false)).value()) {
+    pass_seqs.push_back(pass::BatchGemms());
+  }
+  // convert the conv nets to NHWC, which is the native layout of tensor cores.
+  auto layout = pass_ctx->GetConfig<tvm::String>("raf.layout.convert", "");
+  if (!layout.value().empty() && device_t == DevType::kCUDA()) {
+    pass_seqs.push_back(pass::ConvertLayout(layout.value()));
+  }
+  // transform the constant weights once instead of on every call, e.g., for inference.
+  if (pass_ctx->GetConfig("raf.prepack_weights", Bool(false)).value()) {
+    pass_seqs.push_back(pass::PrepackWeights());
+  }
   // enable group all gather for ZeRO.
   if (dcfg->zero_opt_level > 1 && dcfg->group_bucket_size > 1 && device_t == DevType::kCUDA()) {
     pass_seqs.push_back(pass::GroupAllgather());
   }
+  // coalesce the small collectives, e.g. of tensor parallelism, into fewer NCCL launches.
+  if (dcfg->enable_collective_coalescing && device_t == DevType::kCUDA()) {
+    pass_seqs.push_back(pass::CoalesceCollectives());
+  }
 
   bool enable_stream_schedule = true;
+  // The minimal number of nodes of an outlined layer, or 0 to disable the layer outlining.
+  int outline_layers = pass_ctx->GetConfig("raf.vm.outline_layers", Integer(0)).value().IntValue();
   if (!pass_ctx->GetConfig("raf.vm.optimize.anf_only", Bool(false)).value()) {
     // optimization passes that work on BBNF
     pass_seqs.push_back(pass::ToGraphNormalForm());
+    if (outline_layers > 0) {
+      // Outline the repeated layers to a shared function, so each layer is simplified, fused,
+      // dispatched and compiled once instead of once per copy.
+      pass_seqs.push_back(pass::OutlineLayers(outline_layers, false));
+    }
     pass_seqs.push_back(pass::ToBasicBlockNormalForm());
     pass_seqs.push_back(pass::SimplifyExpr());
     pass_seqs.push_back(pass::InferType());
+    pass_seqs.push_back(pass::ViewPropagation());
+    pass_seqs.push_back(pass::InferType());
+    if (pass_ctx->GetConfig("raf.compress_activation.enable", Bool(false)).value()) {
+      // Compress before the fusion, so the codecs are fused into their neighbours.
+      pass_seqs.push_back(pass::ActivationCompression());
+    }
     pass_seqs.push_back(pass::FuseDialect());
     pass_seqs.push_back(pass::FuseTVM());
     pass_seqs.push_back(pass::DispatchDialect());
+    if (pass_ctx->GetConfig("raf.tvm.parallel_build_threads", Integer(0)).value().IntValue() > 1) {
+      // Build the TVM fused ops in parallel, so they are not built one by one when dispatched.
+      pass_seqs.push_back(pass::InferType());
+      pass_seqs.push_back(pass::PrecompileTVM());
+    }
     // We need to erase the type after dialect dispatching because dialect ops may have different
     // output type than the base ops.
     pass_seqs.push_back(pass::EraseType());
@@ -899,9 +2079,12 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
         } else if (policy_name == "ios") {
           pass_seqs.push_back(pass::InferType());
           pass_seqs.push_back(pass::IOSStreamSchedule());
+        } else if (policy_name == "memory_aware") {
+          pass_seqs.push_back(pass::InferType());
+          pass_seqs.push_back(pass::MemoryAwareStreamSchedule());
         } else {
           LOG(FATAL) << "Cannot recognize schedule policy: " << policy_name << ", candidates are \n"
-                     << "  sequential, wavefront, asap, and ios" << std::endl;
+                     << "  sequential, wavefront, asap, ios, and memory_aware" << std::endl;
         }
       }
     } else {
@@ -911,15 +2094,23 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
   } else {
     enable_stream_schedule = false;
   }
+  bool remove_redundant_events =
+      pass_ctx->GetConfig("raf.stream_schedule.remove_redundant_events", Bool(true)).value();
+  if (enable_stream_schedule && remove_redundant_events) {
+    pass_seqs.push_back(pass::RemoveRedundantEvents());
+  }
 
   // optimization passes that work on ANF
   pass_seqs.push_back(pass::InlinePrimitives());
   pass_seqs.push_back(pass::InferType());
   pass_seqs.push_back(pass::InplaceUpdate());
 
-  if (pass_ctx->GetConfig("raf.use_multi_func", Bool(false)).value()) {
+  if (pass_ctx->GetConfig("raf.use_multi_func", Bool(false)).value() ||
+      (outline_layers > 0 && !enable_stream_schedule)) {
     // The memory-related passes below do not support multi-function, so we need to inline
-    // all functions here. This one pass actually runs LambdaLift, inline, and DCE.
+    // all functions here. This one pass actually runs LambdaLift, inline, and DCE. The inlined
+    // layers still share their fused functions, so they are compiled once. Otherwise, the
+    // outlined layers are kept and invoked by the VM, which also shrinks the instructions.
     pass_seqs.push_back(pass::FullInline());
   }
 
@@ -928,7 +2119,24 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const DeviceMap& device
     pass_seqs.push_back(pass::InferType());
     pass_seqs.push_back(pass::MemorySchedule());
     pass_seqs.push_back(pass::InferType());
-    pass_seqs.push_back(pass::Rematerialization());
+    // Reorder the independent ops under the memory budget, so fewer tensors are rematerialized.
+    pass_seqs.push_back(pass::RematerializationSchedule());
+    pass_seqs.push_back(pass::InferType());
+    if (pass_ctx->GetConfig("raf.offload.enable", Bool(false)).value()) {
+      // Offloading activations trades the recompute FLOPs for host-device copies.
+      pass_seqs.push_back(pass::ActivationOffload());
+      if (remove_redundant_events) {
+        pass_seqs.push_back(pass::RemoveRedundantEvents());
+      }
+    } else {
+      pass_seqs.push_back(pass::Rematerialization());
+    }
+  }
+  if (!enable_stream_schedule &&
+      pass_ctx->GetConfig("raf.inplace_update.elementwise", Bool(false)).value()) {
+    // Run after the passes that reorder or recompute ops, which may extend the live ranges.
+    pass_seqs.push_back(pass::InferType());
+    pass_seqs.push_back(pass::ElementwiseInplaceUpdate());
   }
   // TODO(@hzfan): Currently disable the ValidateInplaceUpdate pass because it removes the may_share
   // attr in some cases without any error messages.
@@ -957,6 +2165,102 @@ tvm::runtime::Module CreateVMCompiler() {
   return tvm::runtime::Module(exec);
 }
 
+/*!
+ * \brief The executables compiled by CompileCached, where the most recently used one comes first.
+ * An entry is keyed by the module, the devices, the pass context and the distributed configs that
+ * the compilation reads, so a model switching between a few input shapes, i.e., the types of
+ * the parameters of main, reuses its executables instead of compiling them again.
+ */
+class ExecutableCache {
+ public:
+  static ExecutableCache* Get() {
+    static ExecutableCache* cache = new ExecutableCache();
+    return cache;
+  }
+
+  tvm::runtime::Module Compile(IRModule mod, const DeviceMap& device_map) {
+    auto key = MakeKey(mod, device_map);
+    size_t hash = tvm::StructuralHash()(key);
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->hash == hash && tvm::StructuralEqual()(it->key, key)) {
+          entries_.splice(entries_.begin(), entries_, it);
+          ++hits_;
+          return it->exec;
+        }
+      }
+    }
+    auto compiler = make_object<VMCompiler>();
+    compiler->Lower(mod, device_map);
+    auto exec = compiler->GetFunction("get_executable", compiler)();
+    std::lock_guard<std::mutex> lock(mu_);
+    ++misses_;
+    if (capacity_ > 0) {
+      entries_.push_front({hash, key, exec});
+      while (entries_.size() > capacity_) {
+        entries_.pop_back();
+      }
+    }
+    return exec;
+  }
+
+  void SetCapacity(int64_t capacity) {
+    std::lock_guard<std::mutex> lock(mu_);
+    capacity_ = std::max<int64_t>(capacity, 0);
+    while (entries_.size() > capacity_) {
+      entries_.pop_back();
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    entries_.clear();
+    hits_ = misses_ = 0;
+  }
+
+  Map<String, Integer> Stats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {{"size", Integer(static_cast<int>(entries_.size()))},
+            {"hits", Integer(static_cast<int>(hits_))},
+            {"misses", Integer(static_cast<int>(misses_))}};
+  }
+
+ private:
+  struct Entry {
+    size_t hash;
+    Array<ObjectRef> key;
+    tvm::runtime::Module exec;
+  };
+
+  static Array<ObjectRef> MakeKey(const IRModule& mod, const DeviceMap& device_map) {
+    Array<Integer> devices;
+    for (const auto& kv : device_map) {
+      devices.push_back(kv.first);
+      devices.push_back(Integer(static_cast<int>(kv.second.device_type())));
+      devices.push_back(Integer(kv.second.device_id()));
+    }
+    auto pass_ctx = pass::PassContext::Current();
+    auto dcfg = DistConfig::Global();
+    Array<ObjectRef> dist = {Bool(dcfg->enable_data_parallel), Integer(dcfg->zero_opt_level),
+                             IntImm(tvm::DataType::Int(64), dcfg->group_bucket_size),
+                             Bool(dcfg->enable_collective_coalescing)};
+    return {mod,
+            devices,
+            pass_ctx->config,
+            Integer(pass_ctx->opt_level),
+            pass_ctx->required_pass,
+            pass_ctx->disabled_pass,
+            dist};
+  }
+
+  std::mutex mu_;
+  std::list<Entry> entries_;
+  size_t capacity_ = 16;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+};
+
 PackedFunc VMCompiler::GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) {
   if (name == "lower") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
@@ -1001,8 +2305,30 @@ PackedFunc VMCompiler::GetFunction(const std::string& name, const ObjectPtr<Obje
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.optimize.anf_only", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.use_multi_func", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.outline_layers", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.fuse_instructions", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.reuse_registers", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.static_arena", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.early_free", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.async_collectives", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.vm.compile_loops", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.speculate_if", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.partition.target", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.remove_redundant_events", Bool);
 
 RAF_REGISTER_GLOBAL("raf.vm.VMCompiler").set_body_typed(CreateVMCompiler);
+RAF_REGISTER_GLOBAL("raf.vm.CompileCached").set_body_typed([](IRModule mod, DeviceMap device_map) {
+  return ExecutableCache::Get()->Compile(mod, device_map);
+});
+RAF_REGISTER_GLOBAL("raf.vm.SetExecutableCacheCapacity").set_body_typed([](int64_t capacity) {
+  ExecutableCache::Get()->SetCapacity(capacity);
+});
+RAF_REGISTER_GLOBAL("raf.vm.ClearExecutableCache").set_body_typed([]() {
+  ExecutableCache::Get()->Clear();
+});
+RAF_REGISTER_GLOBAL("raf.vm.GetExecutableCacheStats").set_body_typed([]() {
+  return ExecutableCache::Get()->Stats();
+});
 
 }  // namespace vm
 }  // namespace executor
@@ -56,6 +56,83 @@ struct VMCompilerContext {
   std::vector<Value> constants;
 };
 
+/*!
+ * \brief Peephole pass that merges common instruction sequences into superinstructions:
+ * InvokeJit followed by Free becomes InvokeJitFree, and CudaSetStream followed by
+ * CudaWaitEvent becomes CudaSetStreamWait. Jump targets are never absorbed and the
+ * offsets of If and Goto are patched accordingly.
+ *
+ * \param instructions The instructions of a VM function.
+ * \return The fused instructions.
+ */
+std::vector<Instruction> FuseInstructions(const std::vector<Instruction>& instructions);
+
+/*!
+ * \brief Find the bindings of a function looping by the tail calls to itself that are the same in
+ * all the iterations, so they can be hoisted before the loop head. They are the deterministic
+ * computations and their allocations that depend only on the constants and on the parameters passed
+ * unchanged by the tail calls, taken from the let chain before the first If and from the leading
+ * let chain of its branch that loops. The storages used by the other bindings, e.g., by the tensors
+ * of the iterations or by the frees, the tensors written by the other ops and the values carried
+ * to the next iteration are not hoisted.
+ *
+ * \param func The function.
+ * \param self The global var of the function.
+ * \param tail_calls The tail calls of the function to itself.
+ * \return The bindings to hoist in their order.
+ */
+std::vector<Let> FindLoopInvariants(const Function& func, const GlobalVar& self,
+                                    const std::unordered_set<const CallNode*>& tail_calls);
+
+/*!
+ * \brief Register allocation pass that lets virtual registers with disjoint live ranges share
+ * the same register, which shrinks the register file of the function and releases dead values
+ * early. The parameters keep their registers. The functions scheduled to multiple streams are
+ * left unchanged, since a dropped value may still be read by a kernel on another stream.
+ *
+ * \param func The VM function to be updated in place.
+ */
+void AllocateRegisters(VMFunction* func);
+
+/*!
+ * \brief Insert a Kill right after the last use of each register, including the registers of
+ * tuples, their fields and the results of closures, so the values referred only by dead registers
+ * are released early. A storage is kept alive as long as the views allocated from it with no
+ * ownership, even when the views are put into tuples. Functions with multiple CUDA streams are
+ * left unchanged.
+ *
+ * \param func The VM function to be updated in place.
+ * \return The number of inserted Kill instructions.
+ */
+size_t InsertKills(VMFunction* func);
+
+/*!
+ * \brief Turn the collectives into InvokeJitAsync, which launch them on the communication stream
+ * without blocking the computation, and insert a Wait of the returned handle right before the
+ * first instruction that touches the memory of the collective, i.e., any of its arguments, their
+ * storages or the tuples and views referring to them. The Kill and Free of that memory are moved
+ * after the Wait. All handles are waited before control flow, and the computation is moved off the
+ * legacy default stream. Functions with multiple CUDA streams are left unchanged.
+ *
+ * \param func The VM function to be updated in place.
+ * \param constants The constants of the executable.
+ * \param device_id The id of the CUDA device.
+ * \return The number of asynchronous collectives.
+ */
+size_t InsertCollectiveWaits(VMFunction* func, const std::vector<Value>& constants,
+                             Index device_id);
+
+/*!
+ * \brief Place the storages of constant sizes that never escape the function into static arenas,
+ * one per device, by packing their live intervals. The VM then allocates each arena once
+ * per frame, sized to the peak of the plan, and the AllocStorage becomes an offset into it.
+ * Functions with control flow or multiple CUDA streams are left unchanged.
+ *
+ * \param func The VM function to be updated in place.
+ * \param constants The constants of the executable.
+ */
+void PlanStaticArenas(VMFunction* func, const std::vector<Value>& constants);
+
 class VMCompiler : public tvm::runtime::ModuleNode {
  public:
   virtual ~VMCompiler() {
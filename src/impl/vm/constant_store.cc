@@ -0,0 +1,147 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/constant_store.cc
+ * \brief The device constants shared among the virtual machines in the process.
+ */
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+#include "raf/registry.h"
+#include "./constant_store.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+namespace {
+
+/*! \brief The FNV-1a hash of the data, which mixes a word at a time. */
+uint64_t HashBytes(const void* data, size_t nbytes) {
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  const char* bytes = static_cast<const char*>(data);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= nbytes; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * prime;
+  }
+  for (; i < nbytes; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(bytes[i])) * prime;
+  }
+  return hash;
+}
+
+/*! \brief Whether the tensors have the same shape and dtype. */
+bool SameType(const DLTensor* lhs, const DLTensor* rhs) {
+  return lhs->ndim == rhs->ndim && tvm::runtime::TypeEqual(lhs->dtype, rhs->dtype) &&
+         std::equal(lhs->shape, lhs->shape + lhs->ndim, rhs->shape);
+}
+
+const char* GetData(const DLTensor* t) {
+  return static_cast<const char*>(t->data) + t->byte_offset;
+}
+
+}  // namespace
+
+ConstantStore* ConstantStore::Get() {
+  static ConstantStore* store = new ConstantStore();
+  return store;
+}
+
+Value ConstantStore::Acquire(const Value& constant, const Device& device,
+                             const std::string& name) {
+  const auto* tensor = constant.as<TensorValueObj>();
+  if (tensor == nullptr) {
+    return Value();
+  }
+  const DLTensor* t = tensor->tensor.operator->();
+  if (t->device.device_type != kDLCPU || !tvm::runtime::IsContiguous(*t)) {
+    return Value();
+  }
+  size_t nbytes = tvm::runtime::GetDataSize(*t);
+  std::ostringstream os;
+  os << device.c_str() << "/";
+  if (name.empty()) {
+    os << "#" << std::hex << HashBytes(GetData(t), nbytes);
+  } else {
+    os << "@" << name;
+  }
+  std::string key = os.str();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entries = entries_[key];
+  for (const auto& entry : entries) {
+    const DLTensor* host = Downcast<TensorValue>(entry.host)->tensor.operator->();
+    if (!name.empty()) {
+      CHECK(SameType(host, t)) << "The shared constant " << name
+                               << " has a different shape or dtype";
+      return entry.device;
+    }
+    if (SameType(host, t) && std::memcmp(GetData(host), GetData(t), nbytes) == 0) {
+      return entry.device;
+    }
+  }
+  Entry entry;
+  entry.host = constant;
+  entry.device = CopyTo(constant, device);
+  entries.push_back(entry);
+  return entry.device;
+}
+
+bool ConstantStore::IsShared(const Value& value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& it : entries_) {
+    for (const auto& entry : it.second) {
+      if (entry.device.same_as(value)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void ConstantStore::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto& entries = it->second;
+    // The copies only referenced by the store are not used by any virtual machine.
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const Entry& entry) { return entry.device.use_count() == 1; }),
+                  entries.end());
+    it = entries.empty() ? entries_.erase(it) : std::next(it);
+  }
+}
+
+std::pair<int64_t, int64_t> ConstantStore::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t count = 0;
+  int64_t nbytes = 0;
+  for (const auto& it : entries_) {
+    for (const auto& entry : it.second) {
+      count++;
+      const DLTensor* t = Downcast<TensorValue>(entry.device)->tensor.operator->();
+      nbytes += tvm::runtime::GetDataSize(*t);
+    }
+  }
+  return {count, nbytes};
+}
+
+RAF_REGISTER_GLOBAL("raf.vm.GetSharedConstantStats").set_body_typed([]() {
+  auto stats = ConstantStore::Get()->GetStats();
+  return Array<Integer>{Integer(stats.first), Integer(stats.second)};
+});
+
+RAF_REGISTER_GLOBAL("raf.vm.ReleaseSharedConstants").set_body_typed([]() {
+  ConstantStore::Get()->Release();
+});
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,72 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/constant_store.h
+ * \brief The device constants shared among the virtual machines in the process.
+ */
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*!
+ * \brief The store of the device copies of the constants, shared among the virtual machines, e.g.,
+ * the replicas or the variants of a base model served in one process, so their weights are only
+ * on the device once. A constant is keyed by its device and either an explicit name or the hash of
+ * its content, for which the contents are compared to rule out the collisions. The store holds a
+ * reference to each copy, and drops it once no virtual machine uses it.
+ */
+class ConstantStore {
+ public:
+  static ConstantStore* Get();
+
+  /*!
+   * \brief Get the shared device copy of a host constant, which is created on the first request.
+   * \param constant The host constant.
+   * \param device The device.
+   * \param name The name of the constant, or empty to key it by its content.
+   * \return The device copy, or an undefined value if the constant cannot be shared.
+   */
+  Value Acquire(const Value& constant, const Device& device, const std::string& name);
+
+  /*! \brief Whether the device copy is shared, in which case it must not be updated in place. */
+  bool IsShared(const Value& value);
+
+  /*! \brief Drop the copies not used by any virtual machine. */
+  void Release();
+
+  /*! \brief The number of the shared copies and their bytes. */
+  std::pair<int64_t, int64_t> GetStats();
+
+ private:
+  /*! \brief A shared copy, and the host constant it is copied from. */
+  struct Entry {
+    Value host;
+    Value device;
+  };
+
+  /*! \brief The entries of each key, which are more than one only for the hash collisions. */
+  std::unordered_map<std::string, std::vector<Entry>> entries_;
+  /*! \brief The mutex to access the entries. */
+  std::mutex mutex_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -18,6 +18,8 @@
 #include <sstream>
 #include <vector>
 
+#include "raf/cache.h"
+#include "raf/file.h"
 #include "raf/serialization.h"
 #include "raf/vm/vm.h"
 #include "./serialize_util.h"
@@ -49,6 +51,15 @@ PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Obje
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Stats(); });
   } else if (name == "save") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Save(); });
+  } else if (name == "save_to_file") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string path = args[0];
+      this->SaveToFile(path);
+    });
+  } else if (name == "get_constants") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = Array<Value>(constants.begin(), constants.end());
+    });
   } else if (name == "get_function_arity") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       std::string func_name = args[0];
@@ -92,6 +103,7 @@ std::string Executable::GetFunctionParameterName(std::string func_name, uint32_t
 
 std::string Executable::GetBytecode() const {
   std::ostringstream oss;
+  DecodeAllFunctions();
 
   for (size_t i = 0; i < functions.size(); ++i) {
     const auto& func = functions[i];
@@ -172,6 +184,8 @@ void SaveHeader(dmlc::Stream* strm) {
 }
 
 TVMByteArray Executable::Save() {
+  // The lazy instructions are decoded from code_, which is overwritten below.
+  DecodeAllFunctions();
   // Initialize the stream object.
   code_.clear();
   dmlc::MemoryStringStream strm(&code_);
@@ -219,6 +233,29 @@ void Executable::SaveConstantSection(dmlc::Stream* strm) {
   }
 }
 
+void Executable::SaveMappedConstantSection(dmlc::Stream* strm, std::vector<Value>* blobs) {
+  serialization::SaveMappedValues(strm, constants, blobs);
+}
+
+void Executable::SaveToFile(const std::string& path) {
+  DecodeAllFunctions();
+  std::string meta;
+  dmlc::MemoryStringStream strm(&meta);
+  strm.Write(kMetaVMMappedMagic);
+  strm.Write(std::string(TVM_VERSION));
+  // The offset of the data region is patched after all sections are written.
+  size_t data_offset_pos = meta.size();
+  strm.Write(static_cast<uint64_t>(0));
+
+  std::vector<Value> blobs;
+  SaveGlobalSection(&strm);
+  SaveMappedConstantSection(&strm, &blobs);
+  SavePrimitiveOpNames(&strm);
+  SaveCodeSection(&strm);
+
+  serialization::WriteMappedFile(path, &meta, data_offset_pos, blobs);
+}
+
 void Executable::SavePrimitiveOpNames(dmlc::Stream* strm) {
   std::vector<std::string> primitive_names;
   for (const auto& it : this->primitive_map) {
@@ -328,12 +365,19 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       fields.push_back(instr.alloc_storage.device_id);
       fields.push_back(instr.dst);
       fields.push_back(instr.alloc_storage.alloc_async);
+      fields.push_back(instr.alloc_storage.arena_index);
+      fields.push_back(instr.alloc_storage.arena_offset);
+      fields.push_back(instr.alloc_storage.arena_size);
       break;
     }
     case Opcode::Free: {
       fields.push_back(instr.free.memory);
       break;
     }
+    case Opcode::Kill: {
+      fields.push_back(instr.kill.reg);
+      break;
+    }
     case Opcode::AllocTuple: {
       // Number of fields = 2 + instr.num_fields
       fields.assign({instr.alloc_tuple.num_fields, instr.dst});
@@ -353,10 +397,11 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       break;
     }
     case Opcode::SetShape: {
-      // Number of fields = 3
+      // Number of fields = 4
       fields.push_back(instr.set_shape.data);
       fields.push_back(instr.set_shape.shape);
       fields.push_back(instr.dst);
+      fields.push_back(instr.set_shape.offset);
       break;
     }
     case Opcode::If: {
@@ -414,6 +459,29 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
                     instr.invoke_jit.args + instr.invoke_jit.arity);
       break;
     }
+    case Opcode::InvokeJitFree: {
+      // Number of fields = 4 + instr.arity + instr.num_frees
+      fields.assign({instr.invoke_jit.op_reg, instr.invoke_jit.arity, instr.invoke_jit.output_size,
+                     instr.invoke_jit.num_frees});
+      // Save the args and the freed registers.
+      fields.insert(fields.end(), instr.invoke_jit.args,
+                    instr.invoke_jit.args + instr.invoke_jit.arity + instr.invoke_jit.num_frees);
+      break;
+    }
+    case Opcode::InvokeJitAsync: {
+      // Number of fields = 4 + instr.arity
+      fields.assign({instr.invoke_jit.op_reg, instr.invoke_jit.arity, instr.invoke_jit.output_size,
+                     instr.dst});
+      // Save the args.
+      fields.insert(fields.end(), instr.invoke_jit.args,
+                    instr.invoke_jit.args + instr.invoke_jit.arity);
+      break;
+    }
+    case Opcode::Wait: {
+      // Number of fields = 1
+      fields.push_back(instr.wait.handle);
+      break;
+    }
     case Opcode::InferType: {
       // Number of fields = 3 + instr.num_args
       fields.assign({instr.infer_type.op_reg, instr.infer_type.num_args, instr.dst});
@@ -424,9 +492,10 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       break;
     }
     case Opcode::CudaSetStream: {
-      // Number of fields = 2
+      // Number of fields = 3
       fields.push_back(instr.cuda_set_stream.device_id);
       fields.push_back(instr.cuda_set_stream.stream_id);
+      fields.push_back(instr.cuda_set_stream.priority);
       break;
     }
     case Opcode::CudaAddEvent:
@@ -440,6 +509,13 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       // Number of fields = 0
       break;
     }
+    case Opcode::CudaSetStreamWait: {
+      // Number of fields = 4
+      fields.assign({instr.cuda_set_stream_wait.device_id, instr.cuda_set_stream_wait.stream_id,
+                     instr.cuda_set_stream_wait.event_id,
+                     instr.cuda_set_stream_wait.wait_stream_id});
+      break;
+    }
     default:
       LOG(FATAL) << "Invalid opcode" << static_cast<int>(instr.op);
       break;
@@ -481,6 +557,7 @@ tvm::runtime::Module Executable::Load(const std::string& code, const tvm::runtim
   auto exec = make_object<Executable>();
   exec->lib = lib;
   exec->code_ = code;
+  exec->code_data_ = exec->code_.data();
   dmlc::MemoryStringStream strm(&exec->code_);
 
   // Load header.
@@ -501,6 +578,46 @@ tvm::runtime::Module Executable::Load(const std::string& code, const tvm::runtim
   return tvm::runtime::Module(exec);
 }
 
+void Executable::LoadMappedConstantSection(dmlc::Stream* strm,
+                                           std::shared_ptr<serialization::MappedFile> file,
+                                           const char* data) {
+  auto values = serialization::LoadMappedValues(strm, file, data);
+  constants.insert(constants.end(), values.begin(), values.end());
+}
+
+tvm::runtime::Module Executable::LoadFromFile(const std::string& path,
+                                              const tvm::runtime::Module lib) {
+  auto file = std::make_shared<serialization::MappedFile>(path);
+  auto exec = make_object<Executable>();
+  exec->lib = lib;
+  exec->code_data_ = file->data();
+  exec->mapped_file_ = file;
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(file->data()), file->size());
+
+  uint64_t header;
+  STREAM_CHECK(strm.Read(&header), "header");
+  STREAM_CHECK(header == kMetaVMMappedMagic, "header");
+  std::string version;
+  STREAM_CHECK(strm.Read(&version), "version");
+  STREAM_CHECK(version == TVM_VERSION, "version");
+  uint64_t data_offset;
+  STREAM_CHECK(strm.Read(&data_offset), "header");
+  STREAM_CHECK(data_offset <= file->size(), "header");
+
+  exec->LoadGlobalSection(&strm);
+  exec->LoadMappedConstantSection(&strm, file, file->data() + data_offset);
+  exec->LoadPrimitiveOpNames(&strm);
+  exec->LoadCodeSection(&strm);
+  return tvm::runtime::Module(exec);
+}
+
+tvm::runtime::Module Executable::LoadDeployment(const std::string& path,
+                                                const std::string& bundle) {
+  CHECK(DirExists(bundle)) << "The kernel bundle " << bundle << " does not exist";
+  raf::op::SetPersistCacheRoot(bundle);
+  return LoadFromFile(path, tvm::runtime::Module());
+}
+
 void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   std::vector<std::string> globals;
   STREAM_CHECK(strm->Read(&globals), "global");
@@ -559,6 +676,12 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       DCHECK(instr.fields.empty());
       return Instruction::Fatal();
     }
+    case Opcode::CudaSetStreamWait: {
+      // Number of fields = 4
+      DCHECK_EQ(instr.fields.size(), 4U);
+      return Instruction::CudaSetStreamWait(instr.fields[0], instr.fields[1], instr.fields[2],
+                                            instr.fields[3]);
+    }
     case Opcode::InvokePacked: {
       // Number of fields = 3 + instr.arity
       DCHECK_GE(instr.fields.size(), 3U);
@@ -649,21 +772,34 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       RegName dst = instr.fields[7];
       bool alloc_async = instr.fields[8];
 
-      return Instruction::AllocStorage(allocation_size, alignment, dtype, device_type, device_id,
-                                       dst, alloc_async);
+      auto ret = Instruction::AllocStorage(allocation_size, alignment, dtype, device_type,
+                                           device_id, dst, alloc_async);
+      if (instr.fields.size() > 9) {
+        // The static arena placement is absent in the executables saved before it was added.
+        ret.alloc_storage.arena_index = instr.fields[9];
+        ret.alloc_storage.arena_offset = instr.fields[10];
+        ret.alloc_storage.arena_size = instr.fields[11];
+      }
+      return ret;
     }
     case Opcode::Free: {
       DCHECK_EQ(instr.fields.size(), 1U);
       RegName memory_reg = instr.fields[0];
       return Instruction::Free(memory_reg);
     }
+    case Opcode::Kill: {
+      DCHECK_EQ(instr.fields.size(), 1U);
+      return Instruction::Kill(instr.fields[0]);
+    }
     case Opcode::SetShape: {
       DCHECK_GE(instr.fields.size(), 3U);
       RegName data = instr.fields[0];
       RegName shape = instr.fields[1];
       RegName dst = instr.fields[2];
+      // The executables saved before the views have no offset.
+      Index offset = instr.fields.size() > 3 ? instr.fields[3] : 0;
 
-      return Instruction::SetShape(data, shape, dst);
+      return Instruction::SetShape(data, shape, dst, offset);
     }
     case Opcode::If: {
       // Number of fields = 4
@@ -730,6 +866,37 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       std::vector<RegName> args = ExtractFields(instr.fields, 3, arity);
       return Instruction::InvokeJit(op_reg, arity, output_size, args);
     }
+    case Opcode::InvokeJitFree: {
+      // Number of fields = 4 + instr.arity + instr.num_frees
+      DCHECK_GE(instr.fields.size(), 4U);
+      DCHECK_EQ(instr.fields.size(),
+                4U + static_cast<size_t>(instr.fields[1]) + static_cast<size_t>(instr.fields[3]));
+
+      RegName op_reg = instr.fields[0];
+      Index arity = instr.fields[1];
+      Index output_size = instr.fields[2];
+      Index num_frees = instr.fields[3];
+      std::vector<RegName> args = ExtractFields(instr.fields, 4, arity);
+      std::vector<RegName> frees = ExtractFields(instr.fields, 4 + arity, num_frees);
+      return Instruction::InvokeJitFree(op_reg, arity, output_size, args, frees);
+    }
+    case Opcode::InvokeJitAsync: {
+      // Number of fields = 4 + instr.arity
+      DCHECK_GE(instr.fields.size(), 4U);
+      DCHECK_EQ(instr.fields.size(), 4U + static_cast<size_t>(instr.fields[1]));
+
+      RegName op_reg = instr.fields[0];
+      Index arity = instr.fields[1];
+      Index output_size = instr.fields[2];
+      RegName handle = instr.fields[3];
+      std::vector<RegName> args = ExtractFields(instr.fields, 4, arity);
+      return Instruction::InvokeJitAsync(op_reg, arity, output_size, args, handle);
+    }
+    case Opcode::Wait: {
+      // Number of fields = 1
+      DCHECK_EQ(instr.fields.size(), 1U);
+      return Instruction::Wait(instr.fields[0]);
+    }
     case Opcode::InferType: {
       // Number of fields = 3 + instr.num_args
       DCHECK_GE(instr.fields.size(), 3U);
@@ -742,9 +909,10 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       return Instruction::InferType(op_reg, args, dst);
     }
     case Opcode::CudaSetStream: {
-      // Number of fields = 2
-      DCHECK_EQ(instr.fields.size(), 2U);
-      return Instruction::CudaSetStream(instr.fields[0], instr.fields[1]);
+      // Number of fields = 3, or 2 for the executables without stream priorities.
+      DCHECK(instr.fields.size() == 2U || instr.fields.size() == 3U);
+      Index priority = instr.fields.size() == 3U ? instr.fields[2] : 0;
+      return Instruction::CudaSetStream(instr.fields[0], instr.fields[1], priority);
     }
     case Opcode::CudaAddEvent: {
       // Number of fields = 2
@@ -759,7 +927,7 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
     case Opcode::CudaStreamBarrier: {
       // Number of fields = 0
       DCHECK(instr.fields.empty());
-      return Instruction::Fatal();
+      return Instruction::CudaStreamBarrier();
     }
     default:
       LOG(FATAL) << "Invalid opcode" << instr.opcode;
@@ -767,34 +935,68 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
   }
 }
 
-void Executable::LoadCodeSection(dmlc::Stream* strm) {
+void Executable::LoadCodeSection(dmlc::SeekStream* strm) {
   // Load the number of functions.
   uint64_t sz;
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "code");
 
   size_t num_funcs = static_cast<size_t>(sz);
   this->functions.resize(num_funcs);
+  this->lazy_code_.resize(num_funcs);
   for (size_t i = 0; i < num_funcs; i++) {
     // Load the function info.
     VMFunctionSerializer loaded_func;
     STREAM_CHECK(loaded_func.Load(strm), "code/function");
 
-    // Load the instructions.
-    std::vector<Instruction> instructions;
+    // Skip the instructions, which are decoded when the function is used for the first time.
+    // Each instruction is serialized as a vector of Index, i.e., its length followed by the data.
+    size_t begin = strm->Tell();
     for (size_t j = 0; j < loaded_func.num_instructions; j++) {
-      VMInstructionSerializer instr;
-      std::vector<Index> instr_fields;
-      STREAM_CHECK(instr.Load(strm), "code/instruction");
-      instructions.push_back(DeserializeInstruction(instr));
+      uint64_t num_fields;
+      STREAM_CHECK(strm->Read(&num_fields, sizeof(num_fields)), "code/instruction");
+      strm->Seek(strm->Tell() + num_fields * sizeof(Index));
     }
 
     // Create the VM function.
-    VMFunction vm_func = VMFunction(loaded_func.name, loaded_func.params, instructions,
+    VMFunction vm_func = VMFunction(loaded_func.name, loaded_func.params, {},
                                     loaded_func.register_file_size);
     auto it = this->global_map.find(loaded_func.name);
     CHECK(it != this->global_map.end());
     CHECK_LE(it->second, this->global_map.size());
     this->functions[it->second] = vm_func;
+    this->lazy_code_[it->second] = {begin, strm->Tell() - begin, loaded_func.num_instructions,
+                                    loaded_func.num_instructions > 0};
+  }
+}
+
+const VMFunction& Executable::GetVMFunction(Index func_index) const {
+  CHECK(func_index >= 0 && static_cast<size_t>(func_index) < functions.size())
+      << "Invalid function index " << func_index;
+  if (lazy_code_.empty()) {
+    return functions[func_index];
+  }
+  std::lock_guard<std::mutex> lock(lazy_mutex_);
+  auto& lazy = lazy_code_[func_index];
+  if (lazy.pending) {
+    CHECK(code_data_ != nullptr);
+    dmlc::MemoryFixedSizeStream strm(const_cast<char*>(code_data_ + lazy.begin), lazy.nbytes);
+    std::vector<Instruction> instructions;
+    instructions.reserve(lazy.num_instructions);
+    for (size_t j = 0; j < lazy.num_instructions; j++) {
+      VMInstructionSerializer instr;
+      STREAM_CHECK(instr.Load(&strm), "code/instruction");
+      instructions.push_back(DeserializeInstruction(instr));
+    }
+    // Decoding is logically const: it only materializes what the executable already holds.
+    const_cast<Executable*>(this)->functions[func_index].instructions = std::move(instructions);
+    lazy.pending = false;
+  }
+  return functions[func_index];
+}
+
+void Executable::DecodeAllFunctions() const {
+  for (size_t i = 0; i < functions.size(); ++i) {
+    GetVMFunction(i);
   }
 }
 
@@ -848,6 +1050,16 @@ RAF_REGISTER_GLOBAL("raf.vm.Load_Executable")
       return Executable::Load(code, lib);
     });
 
+RAF_REGISTER_GLOBAL("raf.vm.Load_ExecutableFromFile")
+    .set_body_typed([](std::string path, tvm::runtime::Module lib) {
+      return Executable::LoadFromFile(path, lib);
+    });
+
+RAF_REGISTER_GLOBAL("raf.vm.Load_ExecutableDeployment")
+    .set_body_typed([](std::string path, std::string bundle) {
+      return Executable::LoadDeployment(path, bundle);
+    });
+
 }  // namespace vm
 }  // namespace executor
 }  // namespace raf
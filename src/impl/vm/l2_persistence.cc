@@ -0,0 +1,254 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/l2_persistence.cc
+ * \brief Keep the hot tensors persisting in the L2 cache during their live ranges.
+ */
+#include <tvm/runtime/device_api.h>
+#include <algorithm>
+#include <map>
+
+#include "./l2_persistence.h"
+
+#ifdef RAF_USE_CUDA
+#include <cuda_runtime.h>
+#include "../../common/cuda_utils.h"
+#endif
+
+// The access policy windows are introduced by CUDA 11.0.
+#if defined(RAF_USE_CUDA) && CUDART_VERSION >= 11000
+#define RAF_USE_L2_PERSISTENCE
+#endif
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+std::vector<HotTensor> FindHotTensors(const VMFunction& func, int64_t min_reuses) {
+  const auto& instrs = func.instructions;
+  Index num_regs = func.register_file_size;
+  Index num_params = func.params.size();
+  // The tensor held by each register in the order of the pcs: a parameter is identified by its
+  // register, a constant by num_regs plus its index, since it may be loaded into several
+  // registers, and -1 is any other value.
+  std::vector<int64_t> values(num_regs, -1);
+  for (Index i = 0; i < num_params && i < num_regs; ++i) {
+    values[i] = i;
+  }
+  // The readers of each tensor, and the register read by the first one.
+  std::map<int64_t, std::vector<Index>> readers;
+  std::map<int64_t, RegName> first_regs;
+  // The windows are bound to a stream and reset at the last reader, so a live range must not
+  // cross a switch of the streams, a branch or a return.
+  std::vector<int64_t> barriers(instrs.size() + 1, 0);
+  for (Index pc = 0; pc < static_cast<Index>(instrs.size()); ++pc) {
+    const auto& instr = instrs[pc];
+    barriers[pc + 1] = barriers[pc];
+    switch (instr.op) {
+      case Opcode::InvokeJit:
+      case Opcode::InvokeJitFree:
+      case Opcode::InvokeJitAsync: {
+        Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
+        for (Index i = 0; i < num_inputs; ++i) {
+          RegName reg = instr.invoke_jit.args[i];
+          int64_t value = values[reg];
+          if (value < 0) {
+            continue;
+          }
+          auto& pcs = readers[value];
+          if (pcs.empty()) {
+            first_regs[value] = reg;
+          }
+          if (pcs.empty() || pcs.back() != pc) {
+            pcs.push_back(pc);
+          }
+        }
+        // The outputs are written in place.
+        for (Index i = num_inputs; i < instr.invoke_jit.arity; ++i) {
+          values[instr.invoke_jit.args[i]] = -1;
+        }
+        if (instr.op == Opcode::InvokeJitAsync) {
+          values[instr.dst] = -1;
+        }
+        break;
+      }
+      case Opcode::LoadConst:
+        values[instr.dst] = num_regs + instr.const_index;
+        break;
+      case Opcode::Move:
+      case Opcode::LoadConsti:
+      case Opcode::GetField:
+      case Opcode::AllocStorage:
+      case Opcode::AllocTensor:
+      case Opcode::AllocTensorReg:
+      case Opcode::AllocTuple:
+      case Opcode::AllocClosure:
+      case Opcode::SetShape:
+      case Opcode::InvokeFunc:
+      case Opcode::InvokeClosure:
+      case Opcode::InferType:
+        values[instr.dst] = -1;
+        break;
+      case Opcode::If:
+      case Opcode::Goto:
+      case Opcode::Ret:
+      case Opcode::CudaSetStream:
+        ++barriers[pc + 1];
+        break;
+      default:
+        break;
+    }
+  }
+  std::vector<HotTensor> candidates;
+  for (const auto& it : readers) {
+    const auto& pcs = it.second;
+    int64_t reuses = pcs.size();
+    if (reuses < std::max<int64_t>(min_reuses, 1) ||
+        barriers[pcs.front()] != barriers[pcs.back()]) {
+      continue;
+    }
+    candidates.push_back({first_regs[it.first], pcs.front(), pcs.back(), reuses});
+  }
+  // Choose the ones read by more ops first, and then the shorter ones, which leave more room.
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const HotTensor& a, const HotTensor& b) {
+                     if (a.reuses != b.reuses) {
+                       return a.reuses > b.reuses;
+                     }
+                     return a.end - a.begin < b.end - b.begin;
+                   });
+  // The chosen live ranges from their begins to their ends.
+  std::map<Index, HotTensor> chosen;
+  for (const auto& hot : candidates) {
+    auto next = chosen.lower_bound(hot.begin);
+    if (next != chosen.end() && next->first <= hot.end) {
+      continue;
+    }
+    if (next != chosen.begin() && std::prev(next)->second.end >= hot.begin) {
+      continue;
+    }
+    chosen.emplace(hot.begin, hot);
+  }
+  std::vector<HotTensor> ret;
+  for (const auto& it : chosen) {
+    ret.push_back(it.second);
+  }
+  return ret;
+}
+
+#ifdef RAF_USE_L2_PERSISTENCE
+/*! \brief Set the access policy window of the stream, and whether it succeeds. */
+static bool SetWindow(void* stream, const cudaAccessPolicyWindow& window) {
+  cudaStreamAttrValue attr = {};
+  attr.accessPolicyWindow = window;
+  cudaError_t err = cudaStreamSetAttribute(static_cast<cudaStream_t>(stream),
+                                           cudaStreamAttributeAccessPolicyWindow, &attr);
+  if (err != cudaSuccess) {
+    // Clear the sticky error of the runtime, so the next CUDA_CALL does not see it.
+    cudaGetLastError();
+    LOG(WARNING) << "Failed to set the access policy window of the stream, so the L2 persistence "
+                 << "is disabled: " << cudaGetErrorString(err);
+    return false;
+  }
+  return true;
+}
+#endif
+
+L2Persistence::L2Persistence(const Executable* exec, const Device& device, int64_t max_bytes,
+                             int64_t min_reuses)
+    : device_(device) {
+  // The instructions of a loaded executable are decoded lazily, so they are read by GetVMFunction.
+  for (size_t i = 0; i < exec->functions.size(); ++i) {
+    const auto& func = exec->GetVMFunction(i);
+    Plan plan;
+    plan.begins.assign(func.instructions.size(), -1);
+    plan.ends.assign(func.instructions.size(), false);
+    for (const auto& hot : FindHotTensors(func, min_reuses)) {
+      plan.begins[hot.begin] = hot.reg;
+      plan.ends[hot.end] = true;
+      ++num_hot_tensors_;
+    }
+    plans_.push_back(std::move(plan));
+  }
+#ifdef RAF_USE_L2_PERSISTENCE
+  int max_persisting = 0;
+  int max_window = 0;
+  CUDA_CALL(cudaDeviceGetAttribute(&max_persisting, cudaDevAttrMaxPersistingL2CacheSize,
+                                   device_.device_id()));
+  CUDA_CALL(cudaDeviceGetAttribute(&max_window, cudaDevAttrMaxAccessPolicyWindowSize,
+                                   device_.device_id()));
+  if (max_persisting <= 0 || max_window <= 0) {
+    LOG(WARNING) << "The device does not support the persisting L2 cache, so it is ignored.";
+    return;
+  }
+  persisting_bytes_ = std::min<int64_t>(max_bytes, max_persisting);
+  max_window_bytes_ = max_window;
+  // The limit is of the current device.
+  int prev_device = 0;
+  CUDA_CALL(cudaGetDevice(&prev_device));
+  CUDA_CALL(cudaSetDevice(device_.device_id()));
+  CUDA_CALL(cudaDeviceSetLimit(cudaLimitPersistingL2CacheSize, persisting_bytes_));
+  CUDA_CALL(cudaSetDevice(prev_device));
+  enabled_ = true;
+#else
+  LOG(WARNING) << "The persisting L2 cache needs CUDA 11.0 or later, so it is ignored.";
+#endif
+}
+
+void L2Persistence::Begin(const Value& value, void* stream) {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  const auto* tensor = value.as<TensorValueObj>();
+  if (tensor == nullptr || tensor->tensor->device.device_type != kDLCUDA) {
+    return;
+  }
+#ifdef RAF_USE_L2_PERSISTENCE
+  const DLTensor* dl = tensor->tensor.operator->();
+  int64_t nbytes = std::min<int64_t>(tvm::runtime::GetDataSize(*dl), max_window_bytes_);
+  if (nbytes == 0) {
+    return;
+  }
+  cudaAccessPolicyWindow window = {};
+  window.base_ptr = static_cast<char*>(dl->data) + dl->byte_offset;
+  window.num_bytes = nbytes;
+  window.hitRatio = std::min(1.0f, static_cast<float>(persisting_bytes_) / nbytes);
+  window.hitProp = cudaAccessPropertyPersisting;
+  window.missProp = cudaAccessPropertyStreaming;
+  if (!SetWindow(stream, window)) {
+    enabled_ = false;
+    return;
+  }
+  ++num_windows_;
+#endif
+}
+
+void L2Persistence::End(void* stream) {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+#ifdef RAF_USE_L2_PERSISTENCE
+  // An empty window makes the accesses of the stream normal again.
+  cudaAccessPolicyWindow window = {};
+  window.hitProp = cudaAccessPropertyNormal;
+  window.missProp = cudaAccessPropertyNormal;
+  if (!SetWindow(stream, window)) {
+    enabled_ = false;
+  }
+#endif
+}
+
+L2PersistenceStats L2Persistence::GetStats() const {
+  L2PersistenceStats stats;
+  stats.num_hot_tensors = num_hot_tensors_;
+  stats.num_windows = num_windows_.load();
+  stats.persisting_bytes = enabled_.load() ? persisting_bytes_ : 0;
+  return stats;
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,117 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/l2_persistence.h
+ * \brief Keep the hot tensors, e.g., the small weights reused by several ops, the embedding tables
+ * and the KV blocks, persisting in the L2 cache during their live ranges.
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/value.h"
+#include "raf/vm/vm.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::value;
+
+/*! \brief The stats of the L2 persistence. */
+struct L2PersistenceStats {
+  /*! \brief The number of the hot tensors chosen by the analysis of all the functions. */
+  int64_t num_hot_tensors = 0;
+  /*! \brief The number of the access policy windows set on the streams. */
+  int64_t num_windows = 0;
+  /*! \brief The bytes of the L2 cache set aside for the persisting accesses. */
+  int64_t persisting_bytes = 0;
+};
+
+/*! \brief A hot tensor of a function and its live range. */
+struct HotTensor {
+  /*! \brief The register of the tensor, which is a parameter or a constant of the function. */
+  RegName reg;
+  /*! \brief The pcs of the first and the last op reading the tensor. */
+  Index begin, end;
+  /*! \brief The number of the ops reading the tensor. */
+  int64_t reuses;
+};
+
+/*!
+ * \brief Choose the hot tensors of a function by the liveness of its registers. The candidates are
+ * the parameters and the constants of the function, which are written once and read by at least
+ * min_reuses ops. A stream has one access policy window at a time, so the live ranges of the
+ * chosen ones do not overlap, and the ones read by more ops are chosen first.
+ * \param func The function.
+ * \param min_reuses The min number of the ops reading a hot tensor.
+ * \return The hot tensors in the order of their live ranges.
+ */
+std::vector<HotTensor> FindHotTensors(const VMFunction& func, int64_t min_reuses);
+
+/*!
+ * \brief The L2 persistence of the hot tensors on Ampere and later GPUs. The access policy window
+ * of a hot tensor is set on the executing stream before the first op reading it, so its accesses
+ * persist in the L2 cache set aside, and the window is reset after the last op reading it. The
+ * window covers up to the max window size of the device, and the hit ratio is scaled down if the
+ * tensor is larger than the set-aside cache, so the persisting lines do not thrash.
+ */
+class L2Persistence {
+ public:
+  /*!
+   * \param exec The executable, whose functions are analyzed once.
+   * \param device The device.
+   * \param max_bytes The max bytes of the L2 cache set aside for the persisting accesses.
+   * \param min_reuses The min number of the ops reading a hot tensor.
+   */
+  L2Persistence(const Executable* exec, const Device& device, int64_t max_bytes,
+                int64_t min_reuses);
+
+  /*! \brief Get the register of the hot tensor whose window begins at the pc, or -1. */
+  RegName GetBegin(Index func_index, Index pc) const {
+    return plans_[func_index].begins[pc];
+  }
+
+  /*! \brief Whether a window ends after the pc. */
+  bool IsEnd(Index func_index, Index pc) const {
+    return plans_[func_index].ends[pc];
+  }
+
+  /*! \brief Set the window of a hot tensor on the stream. */
+  void Begin(const Value& value, void* stream);
+
+  /*! \brief Reset the window of the stream. */
+  void End(void* stream);
+
+  /*! \brief Get the stats. */
+  L2PersistenceStats GetStats() const;
+
+ private:
+  /*! \brief The windows of the hot tensors of a function, indexed by the pcs. */
+  struct Plan {
+    std::vector<RegName> begins;
+    std::vector<bool> ends;
+  };
+
+  /*! \brief The device. */
+  Device device_;
+  /*! \brief The plans of the functions. */
+  std::vector<Plan> plans_;
+  /*! \brief Whether the device supports the windows. */
+  std::atomic<bool> enabled_{false};
+  /*! \brief The max bytes of a window and of the set-aside cache. */
+  int64_t max_window_bytes_ = 0;
+  int64_t persisting_bytes_ = 0;
+  int64_t num_hot_tensors_ = 0;
+  std::atomic<int64_t> num_windows_{0};
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
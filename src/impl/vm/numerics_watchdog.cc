@@ -0,0 +1,199 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/numerics_watchdog.cc
+ * \brief Check the outputs of the ops for the non-finite values on the device during the runs.
+ */
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/ndarray.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "raf/device_api.h"
+#include "./numerics_watchdog.h"
+
+#ifdef RAF_USE_CUDA
+#include <cuda_runtime.h>
+#include "../../common/cuda_utils.h"
+#include "../../op/dialect/cuda/kernels/kernel_util.cuh"
+#endif
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using device_api::DeviceAPI;
+using event_pool::EventPool;
+using memory_pool::Memory;
+
+NumericsWatchdog::NumericsWatchdog(const Device& device, std::vector<std::string> patterns,
+                                   bool abort)
+    : device_(device), patterns_(std::move(patterns)), abort_(abort) {
+  if (device_.device_type() == DevType::kCUDA()) {
+#ifdef RAF_USE_CUDA
+    static_assert(sizeof(Record) == sizeof(op::cuda::NumericsRecord),
+                  "The host record must have the layout of the device record");
+    record_ = Memory::Alloc(device_, sizeof(Record));
+    CUDA_CALL(cudaMemset(record_->data, 0, sizeof(Record)));
+    Device pinned(DevType::kCUDAHost(), 0);
+    for (int i = 0; i < 2; ++i) {
+      copies_[i] = Memory::Alloc(pinned, sizeof(Record));
+      copied_[i] = EventPool::Get(device_)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+    }
+#else
+    LOG(FATAL) << "CUDA is not enabled";
+#endif
+  } else {
+    record_ = Memory::Alloc(device_, sizeof(Record));
+    std::memset(record_->data, 0, sizeof(Record));
+  }
+}
+
+void NumericsWatchdog::Check(const std::string& op_name, const Value& output, int64_t func_index,
+                             int64_t pc, void* stream) {
+  uint64_t tag = (static_cast<uint64_t>(func_index) << 32) | static_cast<uint32_t>(pc);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sites_.find(tag);
+    if (it == sites_.end()) {
+      bool selected = patterns_.empty() ||
+                      std::any_of(patterns_.begin(), patterns_.end(), [&](const std::string& p) {
+                        return op_name.find(p) != std::string::npos;
+                      });
+      it = sites_.emplace(tag, Site{selected, op_name}).first;
+    }
+    if (!it->second.selected) {
+      return;
+    }
+  }
+  if (const auto* tuple = output.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      if (const auto* tensor = field.as<TensorValueObj>()) {
+        CheckTensor(tensor->tensor.operator->(), tag, stream);
+      }
+    }
+  } else if (const auto* tensor = output.as<TensorValueObj>()) {
+    CheckTensor(tensor->tensor.operator->(), tag, stream);
+  }
+}
+
+void NumericsWatchdog::CheckTensor(const DLTensor* tensor, uint64_t tag, void* stream) {
+  const DLDataType& dtype = tensor->dtype;
+  bool is_float = (dtype.code == kDLFloat && (dtype.bits == 16 || dtype.bits == 32)) ||
+                  (dtype.code == kDLBfloat && dtype.bits == 16);
+  if (!is_float || dtype.lanes != 1 || tensor->device.device_type != device_.device_type() ||
+      !tvm::runtime::IsContiguous(*tensor)) {
+    return;
+  }
+  int64_t n = 1;
+  for (int i = 0; i < tensor->ndim; ++i) {
+    n *= tensor->shape[i];
+  }
+  const char* data = static_cast<const char*>(tensor->data) + tensor->byte_offset;
+  if (device_.device_type() == DevType::kCUDA()) {
+#ifdef RAF_USE_CUDA
+    op::cuda::check_numerics_cuda(data, n, dtype, tag,
+                                  static_cast<op::cuda::NumericsRecord*>(record_->data), stream);
+#endif
+    return;
+  }
+  if (dtype.code != kDLFloat || dtype.bits != 32) {
+    // The half-precision values on the CPU are not checked.
+    return;
+  }
+  auto* record = static_cast<Record*>(record_->data);
+  const float* values = reinterpret_cast<const float*>(data);
+  uint64_t num_nonfinite = 0;
+  float abs_max = 0.0f;
+  for (int64_t i = 0; i < n; ++i) {
+    if (std::isfinite(values[i])) {
+      abs_max = std::max(abs_max, std::fabs(values[i]));
+    } else {
+      num_nonfinite++;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  record->abs_max = std::max(record->abs_max, abs_max);
+  record->num_nonfinite += num_nonfinite;
+  if (num_nonfinite > 0 && record->first_tag == 0) {
+    record->first_tag = tag + 1;
+  }
+}
+
+void NumericsWatchdog::EndStep(void* stream) {
+  if (device_.device_type() != DevType::kCUDA()) {
+    Record record;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::memcpy(&record, record_->data, sizeof(Record));
+      std::memset(record_->data, 0, sizeof(Record));
+    }
+    Inspect(record);
+    return;
+  }
+#ifdef RAF_USE_CUDA
+  auto api = DeviceAPI::Get(device_.device_type());
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  int slot = next_copy_;
+  CUDA_CALL(cudaMemcpyAsync(copies_[slot]->data, record_->data, sizeof(Record),
+                            cudaMemcpyDeviceToHost, cuda_stream));
+  CUDA_CALL(cudaMemsetAsync(record_->data, 0, sizeof(Record), cuda_stream));
+  api->EventRecordOnStream(copied_[slot]->data(), stream);
+  pending_[slot] = true;
+  // The last step has been copied long before, so this hardly ever waits.
+  int last = 1 - slot;
+  if (pending_[last]) {
+    api->WaitEvent(copied_[last]->data());
+    pending_[last] = false;
+    Inspect(*static_cast<const Record*>(copies_[last]->data));
+  }
+  next_copy_ = last;
+#endif
+}
+
+NumericsReport NumericsWatchdog::GetReport() {
+#ifdef RAF_USE_CUDA
+  for (int slot : {next_copy_, 1 - next_copy_}) {
+    if (pending_[slot]) {
+      DeviceAPI::Get(device_.device_type())->WaitEvent(copied_[slot]->data());
+      pending_[slot] = false;
+      Inspect(*static_cast<const Record*>(copies_[slot]->data));
+    }
+  }
+#endif
+  std::lock_guard<std::mutex> lock(mutex_);
+  return report_;
+}
+
+void NumericsWatchdog::Inspect(const Record& record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  report_.num_steps++;
+  report_.num_nonfinite = record.num_nonfinite;
+  report_.abs_max = record.abs_max;
+  if (record.num_nonfinite == 0) {
+    return;
+  }
+  report_.num_bad_steps++;
+  uint64_t tag = record.first_tag - 1;
+  report_.first_func = static_cast<int64_t>(tag >> 32);
+  report_.first_pc = static_cast<int64_t>(tag & 0xFFFFFFFFULL);
+  auto it = sites_.find(tag);
+  report_.first_op = it != sites_.end() ? it->second.op_name : "";
+  std::ostringstream os;
+  os << "Found " << record.num_nonfinite << " NaN or Inf values in step " << report_.num_steps
+     << ", which are first written by " << report_.first_op << " at pc " << report_.first_pc
+     << " of function " << report_.first_func;
+  if (abort_) {
+    LOG(FATAL) << os.str();
+  }
+  LOG(WARNING) << os.str();
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,122 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/numerics_watchdog.h
+ * \brief Check the outputs of the ops for the non-finite values on the device during the runs.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/event_pool.h"
+#include "raf/memory_pool.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::value;
+
+/*! \brief The report of the numerics checked by the watchdog. */
+struct NumericsReport {
+  /*! \brief The number of the steps read back. */
+  int64_t num_steps = 0;
+  /*! \brief The number of the steps with non-finite values. */
+  int64_t num_bad_steps = 0;
+  /*! \brief The number of the non-finite values in the last step read back. */
+  int64_t num_nonfinite = 0;
+  /*! \brief The absolute maximum of the finite values in the last step read back. */
+  double abs_max = 0;
+  /*!
+   * \brief The function, the pc and the OpEnv of the first op writing non-finite values in the
+   * last bad step.
+   */
+  int64_t first_func = -1;
+  int64_t first_pc = -1;
+  std::string first_op;
+};
+
+/*!
+ * \brief The numerics watchdog, which checks the outputs of the selected ops for NaNs and Infs and
+ * reduces their absolute maximum right after the ops on their streams. The results accumulate in a
+ * small record on the device, which is copied to the pinned host memory at the end of each run,
+ * i.e., a step, and read back at the end of the next step, so the runs are not synchronized. On
+ * the CPU, the outputs are checked in place and each step is read back at its end.
+ */
+class NumericsWatchdog {
+ public:
+  /*!
+   * \param device The device of the runs.
+   * \param patterns The substrings of the names of the OpEnvs to check. Empty means all.
+   * \param abort Whether to abort the run reading back a step with non-finite values.
+   */
+  NumericsWatchdog(const Device& device, std::vector<std::string> patterns, bool abort);
+
+  /*!
+   * \brief Check the output of an op if it is selected.
+   * \param op_name The name of the OpEnv.
+   * \param output The output.
+   * \param func_index The function.
+   * \param pc The pc of the op.
+   * \param stream The stream of the op.
+   */
+  void Check(const std::string& op_name, const Value& output, int64_t func_index, int64_t pc,
+             void* stream);
+
+  /*! \brief Copy the record of the step to the host on the stream, and read back the last one. */
+  void EndStep(void* stream);
+
+  /*! \brief Read back the steps not read yet, which waits for them, and get the report. */
+  NumericsReport GetReport();
+
+ private:
+  /*! \brief The record of a step, which has the layout of the one on the device. */
+  struct Record {
+    uint64_t num_nonfinite;
+    uint64_t first_tag;
+    float abs_max;
+  };
+  /*! \brief An op checked, keyed by its tag. */
+  struct Site {
+    bool selected;
+    std::string op_name;
+  };
+
+  /*! \brief Check a tensor on the device or the host. */
+  void CheckTensor(const DLTensor* tensor, uint64_t tag, void* stream);
+  /*! \brief Read back the record of a step copied to the host, and report its non-finite values. */
+  void Inspect(const Record& record);
+
+  /*! \brief The device. */
+  Device device_;
+  /*! \brief The substrings of the names of the OpEnvs to check. */
+  std::vector<std::string> patterns_;
+  /*! \brief Whether to abort on the non-finite values. */
+  bool abort_;
+  /*! \brief The ops checked so far. */
+  std::unordered_map<uint64_t, Site> sites_;
+  /*! \brief The record of the current step, on the device or the host. */
+  std::shared_ptr<memory_pool::Memory> record_;
+  /*! \brief The double-buffered pinned copies of the records of the steps, and their events. */
+  std::shared_ptr<memory_pool::Memory> copies_[2];
+  std::shared_ptr<event_pool::Event> copied_[2];
+  bool pending_[2] = {false, false};
+  int next_copy_ = 0;
+  /*! \brief The report. */
+  NumericsReport report_;
+  /*! \brief The mutex to access the sites and the report. */
+  std::mutex mutex_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -24,6 +24,8 @@ namespace vm {
 
 /*! \brief The magic number for the serialized VM bytecode file  */
 constexpr uint64_t kMetaVMBytecodeMagic = 0xD225DE2F4214151D;
+/*! \brief Magic number for the memory-mapped VM executable format. */
+constexpr uint64_t kMetaVMMappedMagic = 0xD225DE2F4214151E;
 
 template <typename T>
 static inline size_t VectorHash(size_t key, const std::vector<T>& values) {
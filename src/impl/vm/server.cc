@@ -0,0 +1,288 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/server.cc
+ * \brief Implementation of the dynamic batching server over the virtual machine.
+ */
+#include <algorithm>
+#include <cstring>
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "raf/metrics.h"
+#include "raf/registry.h"
+#include "raf/vm/server.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+namespace {
+
+/*! \brief The number of the rows of a tensor, i.e., the length of its leading axis. */
+int64_t NumRows(const Value& value) {
+  const auto* tensor = value.as<TensorValueObj>();
+  CHECK(tensor != nullptr) << "The inputs of a request must be tensors, but got "
+                           << value->GetTypeKey();
+  const DLTensor* t = tensor->tensor.operator->();
+  CHECK_GE(t->ndim, 1) << "The inputs of a request must have the batch axis";
+  return t->shape[0];
+}
+
+/*! \brief The view of the rows [begin, begin + rows) of a batch output, which may be a tuple. */
+Value SliceRows(const Value& value, int64_t begin, int64_t rows, int64_t batch_rows) {
+  if (const auto* tup = value.as<TupleValueObj>()) {
+    Array<Value> fields;
+    for (const auto& field : tup->fields) {
+      fields.push_back(SliceRows(field, begin, rows, batch_rows));
+    }
+    return TupleValue::make(fields);
+  }
+  const auto* tensor = value.as<TensorValueObj>();
+  if (tensor == nullptr) {
+    return value;
+  }
+  const DLTensor* t = tensor->tensor.operator->();
+  CHECK(t->ndim >= 1 && t->shape[0] == batch_rows)
+      << "The outputs of a batch must have the batch axis";
+  CHECK(tvm::runtime::IsContiguous(*t)) << "The outputs of a batch must be contiguous";
+  std::vector<int64_t> shape(t->shape, t->shape + t->ndim);
+  shape[0] = rows;
+  int64_t row_bytes = batch_rows == 0 ? 0 : tvm::runtime::GetDataSize(*t) / batch_rows;
+  char* data = static_cast<char*>(t->data) + t->byte_offset + begin * row_bytes;
+  Device dev = t->device;
+  if (tensor->mem != nullptr) {
+    // The view shares the memory of the batch output, which is kept by the view.
+    return TensorValue::Assemble(dev, DType(t->dtype), shape, {}, data, tensor->mem);
+  }
+  // The output is not owned by the memory pool, so the rows are copied out.
+  auto mem = memory_pool::Memory::Alloc(dev, rows * row_bytes);
+  auto ret = TensorValue::Assemble(dev, DType(t->dtype), shape, {}, mem->data, mem);
+  DLTensor src = *t;
+  src.shape = shape.data();
+  src.data = data;
+  src.byte_offset = 0;
+  DeviceAPI::Get(dev.device_type())->CopyDataFromTo(&src, ret->tensor.operator->());
+  return ret;
+}
+
+}  // namespace
+
+BatchServer::BatchServer(tvm::runtime::Module vm, std::vector<Value> params,
+                         BatchServerConfig config)
+    : vm_module_(vm), params_(std::move(params)), config_(std::move(config)) {
+  vm_ = dynamic_cast<VirtualMachine*>(vm_module_.operator->());
+  CHECK(vm_ != nullptr) << "The module is not a virtual machine";
+  CHECK_GT(config_.max_batch_size, 0) << "The max batch size must be positive";
+  CHECK_GE(config_.max_delay_us, 0) << "The max delay must be non-negative";
+  CHECK_GT(config_.num_workers, 0) << "The number of workers must be positive";
+  std::sort(config_.buckets.begin(), config_.buckets.end());
+  for (int i = 0; i < config_.num_workers; ++i) {
+    workers_.emplace_back(&BatchServer::Run, this);
+  }
+}
+
+BatchServer::~BatchServer() {
+  Stop();
+}
+
+int64_t BatchServer::Submit(std::vector<Value> inputs) {
+  CHECK(!inputs.empty()) << "A request must have inputs";
+  int64_t rows = NumRows(inputs[0]);
+  for (const auto& input : inputs) {
+    CHECK_EQ(NumRows(input), rows) << "The inputs of a request must have the same batch size";
+  }
+  CHECK_LE(rows, config_.max_batch_size) << "The request is larger than the max batch size";
+  std::lock_guard<std::mutex> lock(mu_);
+  CHECK(!stop_) << "The server is stopped";
+  int64_t id = next_id_++;
+  queue_.push_back({id, std::move(inputs), rows, Clock::now()});
+  queued_rows_ += rows;
+  queued_cv_.notify_all();
+  return id;
+}
+
+Value BatchServer::Wait(int64_t id) {
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait(lock, [this, id]() { return results_.count(id) || errors_.count(id); });
+  auto it = errors_.find(id);
+  if (it != errors_.end()) {
+    std::string error = std::move(it->second);
+    errors_.erase(it);
+    lock.unlock();
+    LOG(FATAL) << "Failed to serve the request " << id << ": " << error;
+  }
+  Value ret = std::move(results_[id]);
+  results_.erase(id);
+  return ret;
+}
+
+void BatchServer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (stop_) {
+      return;
+    }
+    stop_ = true;
+    queued_cv_.notify_all();
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void BatchServer::Run() {
+  static auto* batch_rows = metrics::MetricsRegistry::Get()->GetSummary(
+      "raf_vm_server_batch_rows", "The number of the rows of the batches run by the servers.");
+  static auto* queue_seconds = metrics::MetricsRegistry::Get()->GetSummary(
+      "raf_vm_server_queue_seconds", "The time the requests wait in the queues of the servers.");
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    queued_cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // The server stops after the queued requests are run.
+      return;
+    }
+    auto deadline = queue_.front().arrival + std::chrono::microseconds(config_.max_delay_us);
+    queued_cv_.wait_until(lock, deadline, [this]() {
+      return stop_ || queue_.empty() || queued_rows_ >= config_.max_batch_size;
+    });
+    if (queue_.empty()) {
+      // Another worker has taken the requests.
+      continue;
+    }
+    std::vector<Request> batch;
+    int64_t rows = 0;
+    while (!queue_.empty() && rows + queue_.front().rows <= config_.max_batch_size) {
+      rows += queue_.front().rows;
+      queued_rows_ -= queue_.front().rows;
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    lock.unlock();
+    auto now = Clock::now();
+    for (const auto& request : batch) {
+      queue_seconds->Observe(std::chrono::duration<double>(now - request.arrival).count());
+    }
+    batch_rows->Observe(rows);
+    std::vector<Value> outputs;
+    std::string error;
+    try {
+      outputs = RunBatch(batch);
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    lock.lock();
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (error.empty()) {
+        results_[batch[i].id] = std::move(outputs[i]);
+      } else {
+        errors_[batch[i].id] = error;
+      }
+    }
+    done_cv_.notify_all();
+  }
+}
+
+std::vector<Value> BatchServer::RunBatch(const std::vector<Request>& batch) {
+  int64_t rows = 0;
+  for (const auto& request : batch) {
+    rows += request.rows;
+  }
+  // Pad to the smallest bucket that holds the batch, or keep the size if there is none.
+  int64_t padded = rows;
+  auto bucket = std::lower_bound(config_.buckets.begin(), config_.buckets.end(), rows);
+  if (bucket != config_.buckets.end()) {
+    padded = *bucket;
+  }
+  size_t num_inputs = batch[0].inputs.size();
+  std::vector<Value> inputs;
+  for (size_t i = 0; i < num_inputs; ++i) {
+    const DLTensor* first = batch[0].inputs[i].as<TensorValueObj>()->tensor.operator->();
+    std::vector<int64_t> shape(first->shape, first->shape + first->ndim);
+    shape[0] = 1;
+    int64_t row_bytes = 1;
+    for (auto dim : shape) {
+      row_bytes *= dim;
+    }
+    row_bytes *= (first->dtype.bits * first->dtype.lanes + 7) / 8;
+    shape[0] = padded;
+    Device cpu(DevType::kCPU(), 0);
+    auto mem = memory_pool::Memory::Alloc(cpu, padded * row_bytes);
+    char* dst = static_cast<char*>(mem->data);
+    for (const auto& request : batch) {
+      CHECK_EQ(request.inputs.size(), num_inputs) << "The requests have different inputs";
+      const DLTensor* src = request.inputs[i].as<TensorValueObj>()->tensor.operator->();
+      CHECK(src->device.device_type == kDLCPU && tvm::runtime::IsContiguous(*src))
+          << "The inputs of a request must be contiguous host tensors";
+      CHECK(src->ndim == first->ndim && std::equal(src->shape + 1, src->shape + src->ndim,
+                                                   first->shape + 1) &&
+            tvm::runtime::TypeEqual(src->dtype, first->dtype))
+          << "The requests of a batch must have the same shapes except the batch axis";
+      int64_t nbytes = request.rows * row_bytes;
+      std::memcpy(dst, static_cast<const char*>(src->data) + src->byte_offset, nbytes);
+      dst += nbytes;
+    }
+    std::memset(dst, 0, (padded - rows) * row_bytes);
+    inputs.push_back(TensorValue::Assemble(cpu, DType(first->dtype), shape, {}, mem->data, mem));
+  }
+  inputs.insert(inputs.end(), params_.begin(), params_.end());
+  VMContext ctx = vm_->PrepareVMContext(config_.func_name, inputs);
+  Value output = vm_->Run(ctx);
+  std::vector<Value> outputs;
+  int64_t begin = 0;
+  for (const auto& request : batch) {
+    outputs.push_back(SliceRows(output, begin, request.rows, padded));
+    begin += request.rows;
+  }
+  return outputs;
+}
+
+PackedFunc BatchServer::GetFunction(const std::string& name,
+                                    const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "submit") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::vector<Value> inputs(args.size());
+      for (int i = 0; i < args.size(); ++i) {
+        inputs[i] = args[i];
+      }
+      *rv = Submit(std::move(inputs));
+    });
+  } else if (name == "wait") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      *rv = Wait(args[0]);
+    });
+  } else if (name == "stop") {
+    return PackedFunc(
+        [sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) { Stop(); });
+  }
+  LOG(FATAL) << "Unknown packed function: " << name;
+  return PackedFunc([sptr_to_self, name](registry::TVMArgs args, registry::TVMRetValue* rv) {});
+}
+
+RAF_REGISTER_GLOBAL("raf.vm.BatchServer")
+    .set_body_typed([](tvm::runtime::Module vm, Array<Value> params, String func_name,
+                       int64_t max_batch_size, int64_t max_delay_us, Array<Integer> buckets,
+                       int num_workers) {
+      BatchServerConfig config;
+      config.func_name = func_name;
+      config.max_batch_size = max_batch_size;
+      config.max_delay_us = max_delay_us;
+      for (const auto& bucket : buckets) {
+        config.buckets.push_back(bucket.IntValue());
+      }
+      config.num_workers = num_workers;
+      auto server = make_object<BatchServer>(
+          vm, std::vector<Value>(params.begin(), params.end()), std::move(config));
+      return tvm::runtime::Module(server);
+    });
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
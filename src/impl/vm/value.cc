@@ -27,6 +27,12 @@ StorageValue StorageValue::make(std::shared_ptr<memory_pool::Memory> buffer) {
   return StorageValue(node);
 }
 
+CollectiveHandleValue CollectiveHandleValue::make(std::shared_ptr<event_pool::Event> event) {
+  auto node = make_object<CollectiveHandleValueObj>();
+  node->event = std::move(event);
+  return CollectiveHandleValue(node);
+}
+
 RAF_REGISTER_OBJECT_REFLECT(VMClosureValueObj);
 
 }  // namespace vm
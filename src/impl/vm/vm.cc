@@ -14,14 +14,20 @@
 #include <tvm/runtime/device_api.h>
 
 #include <algorithm>
+#include <atomic>
+#include <list>
 #include <chrono>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "raf/communicator.h"
+#include "raf/executor.h"
 #include "raf/memory_pool.h"
 #include "raf/ir_ext.h"
 #include "raf/op.h"
@@ -34,20 +40,30 @@
 #include "raf/device_api.h"
 #include "raf/profiler.h"
 #include "raf/memory_profiler.h"
+#include "raf/metrics.h"
 #include "raf/stream_pool.h"
 #include "../../requests.h"
 #include "../../op/ty/utils.h"
 #include "../../common/shape_utils.h"
+#include "./async_compiler.h"
+#include "./constant_store.h"
+#include "./l2_persistence.h"
+#include "./numerics_watchdog.h"
+#include "./weight_streamer.h"
 
 #include "raf/device_api.h"
 #include "raf/registry.h"
 
 #include "../../profiler/cuda/cuda_profiler.h"
+#include "../../profiler/cupti/cupti_profiler.h"
 #ifdef RAF_USE_CUDA
 #include "../../common/cuda_utils.h"
 #include "../../op/dialect/cudnn/cudnn_utils.h"
 #include "../../op/dialect/cublas/cublas_utils.h"
 #endif
+#ifdef RAF_USE_NCCL
+#include <nccl.h>
+#endif
 
 namespace raf {
 namespace executor {
@@ -79,8 +95,24 @@ inline std::shared_ptr<Event> GetEventById(const VMContext& ctx, Index device_id
   return ctx->events[device_id][event_id];
 }
 
-inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_id,
+inline std::shared_ptr<Event> GetStreamEvent(const VMContext& ctx, Index device_id,
                                              Index stream_id) {
+  if (device_id >= ctx->stream_events.size()) {
+    ctx->stream_events.resize(device_id + 1);
+  }
+  if (stream_id >= ctx->stream_events[device_id].size()) {
+    ctx->stream_events[device_id].resize(stream_id + 1);
+  }
+  auto& ring = ctx->stream_events[device_id][stream_id];
+  if (ring.next == ring.events.size()) {
+    Device device(DevType::kCUDA(), static_cast<int>(device_id));
+    ring.events.push_back(EventPool::Get(device)->GetEvent(0x02 /*cudaEventDisableTiming*/));
+  }
+  return ring.events[ring.next++];
+}
+
+inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_id,
+                                             Index stream_id, Index priority = 0) {
   if (device_id >= ctx->streams.size()) {
     ctx->streams.resize(device_id + 1);
   }
@@ -93,12 +125,20 @@ inline std::shared_ptr<Stream> GetStreamById(const VMContext& ctx, Index device_
     } else {
       Device device(DevType::kCUDA(), static_cast<int>(device_id));
       ctx->streams[device_id][stream_id] =
-          Stream::Get(device, kCudaCompute, static_cast<int>(stream_id));
+          Stream::Get(device, kCudaCompute, static_cast<int>(stream_id), priority);
     }
   }
   return ctx->streams[device_id][stream_id];
 }
 
+/*! \brief Record a launch on the stream, so the buffers freed later wait for the stream. */
+inline void RecordLaunch(const VMContext& ctx, Index stream_id) {
+  if (stream_id >= ctx->stream_launch_epochs.size()) {
+    ctx->stream_launch_epochs.resize(stream_id + 1, 0);
+  }
+  ctx->stream_launch_epochs[stream_id] = ++ctx->launch_epoch;
+}
+
 const char* GetStreamName(Index stream_id) {
   static std::vector<std::string> names = {"Default Stream"};
   while (stream_id >= names.size()) {
@@ -107,6 +147,108 @@ const char* GetStreamName(Index stream_id) {
   return names[stream_id].c_str();
 }
 
+/*!
+ * \brief The IR var name of the destination of the instruction at the pc, or %reg if the
+ * executable has no names.
+ */
+std::string DstName(const VMFunction& func, Index pc, RegName reg) {
+  if (pc >= 0 && static_cast<size_t>(pc) < func.dst_names.size() && !func.dst_names[pc].empty()) {
+    return func.dst_names[pc];
+  }
+  return "%" + std::to_string(reg);
+}
+
+/*! \brief Collect the addresses of the tensors in the value, which may be a nested tuple. */
+void CollectTensorData(const Value& value, std::vector<const void*>* data) {
+  if (const auto* tensor = value.as<TensorValueObj>()) {
+    data->push_back(tensor->tensor->data);
+  } else if (const auto* tuple = value.as<TupleValueObj>()) {
+    for (const auto& field : tuple->fields) {
+      CollectTensorData(field, data);
+    }
+  }
+}
+
+/*!
+ * \brief Observe the wall time and the device time of a VM run when it goes out of the scope, and
+ * end the step of the metrics.
+ */
+class RunMetrics {
+ public:
+  RunMetrics(const Device& dev, bool use_device_timer)
+      : dev_(dev), start_us_(profiler::ProfileStat::NowInMicrosec()) {
+    if (use_device_timer) {
+      device_start_ = DeviceTimer()->Start(dev);
+    }
+  }
+
+  ~RunMetrics() {
+    static auto* wall = metrics::MetricsRegistry::Get()->GetSummary(
+        "raf_vm_run_seconds", "The host wall time of the VM runs in seconds.");
+    if (device_start_ != nullptr) {
+      DeviceTimer()->Stop(dev_, std::move(device_start_));
+    }
+    wall->Observe((profiler::ProfileStat::NowInMicrosec() - start_us_) / 1e6);
+    metrics::MetricsRegistry::Get()->Step();
+  }
+
+ private:
+  static metrics::DeviceTimer* DeviceTimer() {
+    static auto* timer = new metrics::DeviceTimer(metrics::MetricsRegistry::Get()->GetSummary(
+        "raf_vm_device_seconds", "The device time of the VM runs on the default stream."));
+    return timer;
+  }
+
+  Device dev_;
+  uint64_t start_us_;
+  std::shared_ptr<Event> device_start_;
+};
+
+/*!
+ * \brief Append the signature of an argument of InferType, i.e., the dtypes and shapes of its
+ * tensors and the values of its scalars, to the key. The values of the scalar tensors are also
+ * appended, since they may be read by the type functions, e.g. the bounds of arange.
+ * \return Whether the inferred type only depends on the signature, otherwise it is not cached.
+ */
+bool AppendShapeSignature(const Value& value, HashKey* key) {
+  if (!value.defined()) {
+    *key << static_cast<uint8_t>(0);
+  } else if (const auto* tensor = value.as<TensorValueObj>()) {
+    const DLTensor* t = tensor->tensor.operator->();
+    *key << static_cast<uint8_t>(1) << *t;
+    if (t->ndim == 0) {
+      size_t nbytes = (t->dtype.bits * t->dtype.lanes + 7) / 8;
+      if (t->device.device_type != kDLCPU || nbytes > sizeof(uint64_t)) {
+        // Reading a device scalar would synchronize the device, as the type function does.
+        return false;
+      }
+      uint64_t bits = 0;
+      std::memcpy(&bits, static_cast<const char*>(t->data) + t->byte_offset, nbytes);
+      *key << bits;
+    }
+  } else if (const auto* tup = value.as<TupleValueObj>()) {
+    *key << static_cast<uint8_t>(2) << static_cast<int64_t>(tup->fields.size());
+    for (const auto& field : tup->fields) {
+      if (!AppendShapeSignature(field, key)) {
+        return false;
+      }
+    }
+  } else if (const auto* iv = value.as<IntValueObj>()) {
+    *key << static_cast<uint8_t>(3) << iv->dtype.operator DLDataType() << iv->value;
+  } else if (const auto* fv = value.as<FloatValueObj>()) {
+    *key << static_cast<uint8_t>(4) << fv->dtype.operator DLDataType() << fv->value;
+  } else if (const auto* bv = value.as<BoolValueObj>()) {
+    *key << static_cast<uint8_t>(5) << bv->value;
+  } else if (const auto* sv = value.as<StringValueObj>()) {
+    *key << static_cast<uint8_t>(6) << sv->value;
+  } else if (value->IsInstance<NoGradValueObj>() || value->IsInstance<VoidValueObj>()) {
+    *key << static_cast<uint8_t>(7);
+  } else {
+    return false;
+  }
+  return true;
+}
+
 void TensorRepr(std::ostringstream& os, const TensorValueObj* tensor) {
   const DLTensor* t = tensor->tensor.operator->();
   os << "T<";
@@ -150,14 +292,35 @@ VMContext VMContext::make(const Executable* exec) {
   return VMContext(ptr);
 }
 
+/*! \brief Wait for the actual shape of a pending register, and set the shape of its tensor. */
+void ResolvePendingShape(VMFrame* frame, RegName reg) {
+  auto it = frame->pending_shapes.find(reg);
+  PendingShape pending = std::move(it->second);
+  frame->pending_shapes.erase(it);
+  DeviceAPI::Get(DevType::kCUDA())->WaitEvent(pending.copied->data());
+  // The pinned memory is read as the host memory.
+  DLTensor shape = *Downcast<TensorValue>(pending.shape)->tensor.operator->();
+  shape.device = DLDevice{kDLCPU, 0};
+  frame->register_file[reg] = Downcast<TensorValue>(pending.data)
+                                  .CreateView(common::shape_utils::GetShapeVecFromData(&shape));
+}
+
 inline Value VMContext::ReadRegister(Index reg) const {
   auto self = this->operator->();
-  return self->frames.back().register_file[reg];
+  VMFrame& frame = self->frames.back();
+  if (!frame.pending_shapes.empty() && frame.pending_shapes.count(reg)) {
+    ResolvePendingShape(&frame, reg);
+  }
+  return frame.register_file[reg];
 }
 
 inline void VMContext::WriteRegister(Index reg, const Value& val) {
   auto self = this->operator->();
-  self->frames.back().register_file[reg] = val;
+  VMFrame& frame = self->frames.back();
+  if (!frame.pending_shapes.empty()) {
+    frame.pending_shapes.erase(reg);
+  }
+  frame.register_file[reg] = val;
 }
 
 inline int64_t VMContext::LoadTensorInt(Index r) const {
@@ -210,8 +373,22 @@ inline void VMContext::PushFrame(Index func_index, const std::vector<Value>& arg
   CHECK_EQ(func.params.size(), args.size())
       << "Number of arguments mismatches: " << func.params.size() << " vs " << args.size();
   auto ret_pc = self->pc + 1;
-  auto frame = VMFrame(self->func_index, ret_pc, ret_reg, args.size(), func.register_file_size);
-  self->frames.push_back(frame);
+  if (self->frame_arena.empty()) {
+    self->frames.emplace_back(self->func_index, ret_pc, ret_reg, args.size(),
+                              func.register_file_size);
+  } else {
+    // Reuse a popped frame, so the register file only grows when this function needs more
+    // registers than any frame released before.
+    self->frames.push_back(std::move(self->frame_arena.back()));
+    self->frame_arena.pop_back();
+    VMFrame& frame = self->frames.back();
+    frame.caller_func_index = self->func_index;
+    frame.caller_return_pc = ret_pc;
+    frame.caller_return_register = ret_reg;
+    frame.num_args = args.size();
+    frame.register_file.resize(func.register_file_size);
+    frame.is_const.assign(func.register_file_size, false);
+  }
   for (size_t i = 0; i < args.size(); ++i) {
     WriteRegister(i, args[i]);
   }
@@ -223,28 +400,47 @@ inline void VMContext::PushFrame(Index func_index, const std::vector<Value>& arg
 inline Index VMContext::PopFrame() {
   auto self = this->operator->();
   CHECK_GT(self->frames.size(), 0);
-  const VMFrame& fr = self->frames.back();
+  VMFrame& fr = self->frames.back();
+  Index caller_return_register = fr.caller_return_register;
   self->func_index = fr.caller_func_index;
   self->pc = fr.caller_return_pc;
-  self->code = self->exec->functions[self->func_index].instructions.data();
+  if (self->frames.size() > 1) {
+    // The outermost frame returns to no function, whose instructions may not be decoded yet.
+    self->code = self->exec->functions[self->func_index].instructions.data();
+  }
+  // Release the values held by the frame but keep the capacity of its register file.
+  fr.register_file.clear();
+  fr.pending_shapes.clear();
+  self->frame_arena.push_back(std::move(fr));
   self->frames.pop_back();
-  return fr.caller_return_register;
+  return caller_return_register;
 }
 
-std::shared_ptr<OpEnvCache> VMFuncOpEnvCache::Get(Index pc) {
-  std::lock_guard<std::mutex> lock(mu_);
-  auto it = cache_map_.find(pc);
-  if (it != cache_map_.end()) {
-    return it->second;
-  }
-  auto cache = std::make_shared<OpEnvCache>();
-  cache_map_.emplace(pc, cache);
-  return cache;
+VMFuncOpEnvCache::VMFuncOpEnvCache() {
+  static const size_t capacity = []() {
+    const char* val = getenv("RAF_VM_OP_ENV_CACHE_CAPACITY");
+    return val == nullptr ? 0 : std::stoul(val);
+  }();
+  cache_.SetCapacity(capacity);
+  static auto* evictions = metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_vm_op_env_cache_evictions_total",
+      "The OpEnvs evicted from the full OpEnv caches of the VMs.");
+  cache_.SetEvictCallback(
+      [](const std::string& key, uint64_t pc, const OpEnvPtr& op_env) { evictions->Add(); });
+}
+
+OpEnvPtr VMFuncOpEnvCache::Get(const CacheKeyView& key) {
+  OpEnvPtr op_env;
+  cache_.Get(key, &op_env);
+  return op_env;
+}
+
+OpEnvPtr VMFuncOpEnvCache::Set(const CacheKeyView& key, OpEnvPtr op_env) {
+  return cache_.Set(key, std::move(op_env));
 }
 
 void VMFuncOpEnvCache::Clear() {
-  std::lock_guard<std::mutex> lock(mu_);
-  cache_map_.clear();
+  cache_.Clear();
 }
 
 #ifdef RAF_USE_CUDA
@@ -257,7 +453,6 @@ class VirtualMachine::CudaGraphImpl {
   ~CudaGraphImpl() {
     CUDA_CALL(cudaGraphDestroy(graph_));
     CUDA_CALL(cudaGraphExecDestroy(exec_));
-    CUDA_CALL(cudaStreamDestroy(stream_for_graph_));
   }
 
   void GetKernelInfo() {
@@ -269,29 +464,74 @@ class VirtualMachine::CudaGraphImpl {
     CHECK_GT(numNodes, 0) << "Generated CUDA Graph is empty";
   }
 
-  void BeginCapture() {
-    stream_for_graph_ = static_cast<cudaStream_t>(
-        raf::device_api::DeviceAPI::Get(device_.device_type())->CreateStream(device_));
-
+  /*!
+   * \brief Begin capturing on the graph stream, which is the default stream of the schedule.
+   * The side streams of the schedule wait for the start of the capture, so they are captured
+   * into the same graph.
+   * \param side_streams The other streams used by the schedule.
+   */
+  void BeginCapture(const std::vector<std::shared_ptr<Stream>>& side_streams) {
+    // The graph stream does not synchronize with the legacy default stream, which cannot be
+    // used during the capture.
+    graph_stream_ = Stream::Create(device_, 0, /*non_blocking=*/true);
+    stream_for_graph_ = static_cast<cudaStream_t>(graph_stream_->data());
+    side_streams_ = side_streams;
+
+    // The backends create their handles of the streams on the first use, which is not captured.
+    for (const auto& stream : side_streams_) {
+      OpEnv::SetStreamForAllBackends(device_, stream->data());
+    }
     OpEnv::SetStreamForAllBackends(device_, stream_for_graph_);
     CUDA_CALL(cudaStreamBeginCapture(stream_for_graph_, cudaStreamCaptureModeRelaxed));
+    if (!side_streams_.empty()) {
+      auto fork = NewEvent();
+      CUDA_CALL(cudaEventRecord(static_cast<cudaEvent_t>(fork->data()), stream_for_graph_));
+      for (const auto& stream : side_streams_) {
+        CUDA_CALL(cudaStreamWaitEvent(static_cast<cudaStream_t>(stream->data()),
+                                      static_cast<cudaEvent_t>(fork->data()), 0));
+      }
+    }
+  }
+
+  /*! \brief The stream captured by the graph. */
+  const std::shared_ptr<Stream>& stream() const {
+    return graph_stream_;
   }
 
   void EndCapture() {
+    // Join the side streams back to the graph stream, as a capture must end where it began.
+    for (const auto& stream : side_streams_) {
+      auto join = NewEvent();
+      CUDA_CALL(cudaEventRecord(static_cast<cudaEvent_t>(join->data()),
+                                static_cast<cudaStream_t>(stream->data())));
+      CUDA_CALL(cudaStreamWaitEvent(stream_for_graph_, static_cast<cudaEvent_t>(join->data()), 0));
+    }
     CUDA_CALL(cudaStreamEndCapture(stream_for_graph_, &graph_));
+    capture_events_.clear();
+    side_streams_.clear();
     CUDA_CALL(cudaGraphInstantiate(&exec_, graph_, NULL, NULL, 0));
     GetKernelInfo();
     is_captured_ = true;
   }
 
   void Invoke() {
-    CUDA_CALL(cudaGraphLaunch(exec_, NULL));
+    CUDA_CALL(cudaGraphLaunch(exec_, stream_for_graph_));
     CUDA_CALL(cudaStreamSynchronize(stream_for_graph_));
   }
 
  private:
+  std::shared_ptr<Event> NewEvent() {
+    capture_events_.push_back(EventPool::Get(device_)->GetEvent(0x02 /*cudaEventDisableTiming*/));
+    return capture_events_.back();
+  }
+
   bool is_captured_ = false;
+  std::shared_ptr<Stream> graph_stream_;
   cudaStream_t stream_for_graph_;
+  /*! \brief The side streams forked from the graph stream during the capture. */
+  std::vector<std::shared_ptr<Stream>> side_streams_;
+  /*! \brief The events forking and joining the side streams during the capture. */
+  std::vector<std::shared_ptr<Event>> capture_events_;
   cudaGraph_t graph_;
   cudaGraphExec_t exec_;
   Device device_;
@@ -322,6 +562,222 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       }
       this->SetDevices(devices);
     });
+  } else if (name == "prepare_context_async") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      CHECK(exec_) << "The executable is not loaded yet.";
+      std::string func_name = args[0];
+      std::vector<Value> inputs(args.size() - 1);
+      for (size_t i = 1; i < args.size(); ++i) {
+        inputs[i - 1] = args[i];
+      }
+      *rv = PrepareVMContextAsync(func_name, inputs);
+    });
+  } else if (name == "set_cuda_graph_cache") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+#ifdef RAF_USE_CUDA
+      int capacity = args[0];
+      double mem_cap_mb = args[1];
+      std::vector<int64_t> buckets;
+      for (int i = 2; i < args.size(); ++i) {
+        buckets.push_back(args[i].operator int64_t());
+      }
+      this->SetCudaGraphCache(capacity, mem_cap_mb, buckets);
+#else
+      LOG(WARNING) << "Because CUDA is not enabled in RAF, the CUDA graph cache is ignored.";
+#endif
+    });
+  } else if (name == "set_persistent_inputs") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+#ifdef RAF_USE_CUDA
+      std::string func_name = args[0];
+      std::vector<int> indices;
+      for (int i = 1; i < args.size(); ++i) {
+        indices.push_back(args[i]);
+      }
+      this->SetPersistentInputs(func_name, indices);
+#endif
+      // Without CUDA graphs, the inputs on the device are always used by reference.
+    });
+  } else if (name == "stage_constants") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      CHECK(exec_) << "The executable is not loaded yet.";
+      Array<Integer> indices = args[0];
+      Array<Value> values = args[1];
+      std::vector<Index> index_vec;
+      for (const auto& index : indices) {
+        index_vec.push_back(index->value);
+      }
+      this->StageConstants(index_vec, std::vector<Value>(values.begin(), values.end()));
+    });
+  } else if (name == "swap_constants") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      *rv = this->SwapConstants();
+    });
+  } else if (name == "set_share_constants") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      bool share = args[0];
+      Map<Integer, String> names = args[1];
+      std::lock_guard<std::mutex> lock(const_pool_mutex_);
+      share_constants_ = share;
+      constant_names_.clear();
+      for (const auto& it : names) {
+        constant_names_[it.first->value] = it.second;
+      }
+    });
+  } else if (name == "get_constant") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      CHECK(exec_) << "The executable is not loaded yet.";
+      int64_t index = args[0];
+      CHECK(index >= 0 && index < static_cast<int64_t>(exec_->constants.size()))
+          << "Invalid constant index " << index;
+      std::lock_guard<std::mutex> lock(const_pool_mutex_);
+      if (index < static_cast<int64_t>(const_pool_.size()) && const_pool_[index].defined()) {
+        *rv = const_pool_[index];
+      } else {
+        *rv = exec_->constants[index];
+      }
+    });
+  } else if (name == "submit_pipelined") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      std::string func_name = args[0];
+      std::vector<Value> inputs(args.size() - 1);
+      for (size_t i = 1; i < args.size(); ++i) {
+        inputs[i - 1] = args[i];
+      }
+      this->SubmitPipelined(func_name, inputs);
+    });
+  } else if (name == "fetch_pipelined") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      *rv = this->FetchPipelined();
+    });
+  } else if (name == "set_async_compile") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      int num_threads = args[0];
+      std::unordered_set<std::string> dialects;
+      for (int i = 1; i < args.size(); ++i) {
+        dialects.insert(args[i].operator std::string());
+      }
+      this->SetAsyncCompile(num_threads, dialects);
+    });
+  } else if (name == "wait_async_compile") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      if (async_compiler_) {
+        async_compiler_->Wait();
+      }
+    });
+  } else if (name == "get_async_compile_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      AsyncCompileStats stats;
+      if (async_compiler_) {
+        stats = async_compiler_->GetStats();
+      }
+      auto make_int = [](int64_t value) { return IntImm(DataType::Int(64), value); };
+      Map<String, ObjectRef> ret;
+      ret.Set("num_submitted", make_int(stats.num_submitted));
+      ret.Set("num_fallback_calls", make_int(stats.num_fallback_calls));
+      ret.Set("num_compiled", make_int(stats.num_compiled));
+      ret.Set("num_failed", make_int(stats.num_failed));
+      *rv = ret;
+    });
+  } else if (name == "set_numerics_watchdog") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      bool enable = args[0];
+      bool abort = args[1];
+      std::vector<std::string> patterns;
+      for (int i = 2; i < args.size(); ++i) {
+        patterns.push_back(args[i].operator std::string());
+      }
+      this->SetNumericsWatchdog(enable, abort, patterns);
+    });
+  } else if (name == "get_numerics_report") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      NumericsReport report;
+      if (numerics_watchdog_) {
+        report = numerics_watchdog_->GetReport();
+      }
+      auto make_int = [](int64_t value) { return IntImm(DataType::Int(64), value); };
+      Map<String, ObjectRef> ret;
+      ret.Set("num_steps", make_int(report.num_steps));
+      ret.Set("num_bad_steps", make_int(report.num_bad_steps));
+      ret.Set("num_nonfinite", make_int(report.num_nonfinite));
+      ret.Set("abs_max", FloatImm(DataType::Float(64), report.abs_max));
+      ret.Set("first_func", make_int(report.first_func));
+      ret.Set("first_pc", make_int(report.first_pc));
+      ret.Set("first_op", String(report.first_op));
+      *rv = ret;
+    });
+  } else if (name == "set_weight_streaming") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      int64_t buffer_bytes = args[0];
+      int64_t min_bytes = args[1];
+      this->SetWeightStreaming(buffer_bytes, min_bytes);
+    });
+  } else if (name == "get_weight_streaming_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      WeightStreamingStats stats;
+      if (weight_streamer_) {
+        stats = weight_streamer_->GetStats();
+      }
+      auto make_int = [](int64_t value) { return IntImm(DataType::Int(64), value); };
+      Map<String, ObjectRef> ret;
+      ret.Set("num_loads", make_int(stats.num_loads));
+      ret.Set("num_prefetched", make_int(stats.num_prefetched));
+      ret.Set("num_fallbacks", make_int(stats.num_fallbacks));
+      ret.Set("uploaded_bytes", make_int(stats.uploaded_bytes));
+      *rv = ret;
+    });
+  } else if (name == "set_l2_persistence") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      int64_t max_bytes = args[0];
+      int64_t min_reuses = args[1];
+      this->SetL2Persistence(max_bytes, min_reuses);
+    });
+  } else if (name == "get_l2_persistence_stats") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      L2PersistenceStats stats;
+      if (l2_persistence_) {
+        stats = l2_persistence_->GetStats();
+      }
+      auto make_int = [](int64_t value) { return IntImm(DataType::Int(64), value); };
+      Map<String, ObjectRef> ret;
+      ret.Set("num_hot_tensors", make_int(stats.num_hot_tensors));
+      ret.Set("num_windows", make_int(stats.num_windows));
+      ret.Set("persisting_bytes", make_int(stats.persisting_bytes));
+      *rv = ret;
+    });
+  } else if (name == "set_precompute_args") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      this->precompute_args_ = args[0];
+    });
+  } else if (name == "set_num_threads") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      this->num_threads_ = args[0];
+    });
+  } else if (name == "set_numa_node") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      int node = args[0];
+      CHECK_LT(node, device_api::cpu::GetNumNumaNodes()) << "Invalid NUMA node " << node;
+      this->numa_node_ = node;
+    });
+  } else if (name == "set_tenant") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      this->tenant_ = args[0].operator std::string();
+    });
+  } else if (name == "build_op_envs") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      VMContext ctx = args[0];
+      BuildOpEnvs(ctx);
+    });
+  } else if (name == "warmup") {
+    return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
+      CHECK(exec_) << "The executable is not loaded yet.";
+      bool background = args[0];
+      if (!background) {
+        Warmup();
+      } else if (!warmup_thread_.joinable()) {
+        warmup_thread_ = std::thread([this]() { Warmup(); });
+      }
+    });
   } else if (name == "prepare_context") {
     return PackedFunc([sptr_to_self, this](registry::TVMArgs args, registry::TVMRetValue* rv) {
       CHECK(exec_) << "The executable is not loaded yet.";
@@ -338,11 +794,28 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
   }
 }
 
+VirtualMachine::~VirtualMachine() {
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
+  if (share_constants_) {
+    const_pool_.clear();
+    spare_constants_.clear();
+    ConstantStore::Get()->Release();
+  }
+}
+
 void VirtualMachine::LoadExecutable(const Executable* exec) {
   CHECK(exec) << "The executable is not created yet.";
   exec_ = exec;
+  static const size_t infer_type_cache_capacity = []() {
+    const char* val = getenv("RAF_VM_INFER_TYPE_CACHE_CAPACITY");
+    return val == nullptr ? 0 : std::stoul(val);
+  }();
   for (int i = 0; i < exec_->functions.size(); ++i) {
     op_env_cache_.push_back(std::make_shared<VMFuncOpEnvCache>());
+    infer_type_cache_.push_back(
+        std::make_shared<ShardedMetaCache<Value>>(infer_type_cache_capacity));
   }
 
   tvm::runtime::Module lib = exec_->lib;
@@ -360,16 +833,55 @@ void VirtualMachine::LoadExecutable(const Executable* exec) {
     CHECK(pf != nullptr) << "Cannot find function in module: " << packed_name;
     packed_funcs_[packed_index] = pf;
   }
+
+  // Reserve the per-function dispatch tables and static OpEnv tables. They are filled by
+  // LoadFunction when a function is invoked for the first time, so functions never called are
+  // neither decoded from the executable nor pre-decoded for the dispatch loop.
+  dispatch_tables_.clear();
+  dispatch_tables_.resize(exec_->functions.size());
+  static_op_envs_.clear();
+  static_op_envs_.resize(exec_->functions.size());
+  precomputed_calls_.clear();
+  precomputed_calls_.resize(exec_->functions.size());
+  function_loaded_.reset(new std::once_flag[exec_->functions.size()]);
+  function_collectives_.reset(new bool[exec_->functions.size()]());
+}
+
+void VirtualMachine::LoadFunction(Index func_index) {
+  std::call_once(function_loaded_[func_index], [&]() {
+    const auto& instructions = exec_->GetVMFunction(func_index).instructions;
+    auto& table = dispatch_tables_[func_index];
+    table.reserve(instructions.size());
+    for (const auto& instr : instructions) {
+      table.push_back(DecodeInstruction(instr));
+    }
+    if (static_op_env_) {
+      static_op_envs_[func_index].resize(instructions.size(), nullptr);
+    }
+    precomputed_calls_[func_index].resize(instructions.size(), nullptr);
+    function_collectives_[func_index] = ResolveStreams(instructions);
+  });
+}
+
+void VirtualMachine::Warmup() {
+  for (size_t i = 0; i < exec_->functions.size(); ++i) {
+    LoadFunction(i);
+  }
 }
 
 VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
                                            const std::vector<Value>& inputs) {
+  memory_pool::TenantScope tenant_scope(tenant_);
   auto gvit = exec_->global_map.find(func_name);
   CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
   auto func_index = gvit->second;
   const auto& vm_func = exec_->functions[func_index];
   CHECK_EQ(inputs.size(), vm_func.params.size())
       << "The number of inputs doesn't match the number of parameters for function " << func_name;
+  // The inputs may be written by the ops that are asynchronously executed by the interpreter.
+  if (executor::interpreter::IsAsync()) {
+    executor::interpreter::Synchronize();
+  }
 
   auto fcreate_ctx = [&]() {
     auto ctx = VMContext::make(exec_);
@@ -384,66 +896,641 @@ VMContext VirtualMachine::PrepareVMContext(const std::string& func_name,
   };
 #ifdef RAF_USE_CUDA
   if (enable_cuda_graph_) {
-    std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
-    // Check if there is another context using the CUDA graph
-    CHECK(!cuda_graph_occupied_) << "VM in CUDA graph mode doesn't support concurrent execution";
-    if (!cuda_graph_ctx_.defined() || cuda_graph_ctx_->entry_func_index != func_index) {
-      // Initialize the cuda graph context for the first time, or reset the cuda graph context
-      // because this time invokes a different function
-      cuda_graph_impl_ = nullptr;
-      cuda_graph_ctx_ = fcreate_ctx();
+    return PrepareCudaGraphContext(func_index, inputs);
+  }
+#endif
+  auto ctx = fcreate_ctx();
+  return ctx;
+}
+
+VMContext VirtualMachine::PrepareVMContextAsync(const std::string& func_name,
+                                                const std::vector<Value>& inputs) {
+  memory_pool::TenantScope tenant_scope(tenant_);
+  Device dev = devices_[0];
+  if (dev.device_type() != DevType::kCUDA() || enable_cuda_graph_) {
+    // Staging only helps host-to-device uploads, and CUDA graph contexts own their inputs.
+    return PrepareVMContext(func_name, inputs);
+  }
+  auto gvit = exec_->global_map.find(func_name);
+  CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
+  auto func_index = gvit->second;
+  CHECK_EQ(inputs.size(), exec_->functions[func_index].params.size())
+      << "The number of inputs doesn't match the number of parameters for function " << func_name;
+
+  std::lock_guard<std::mutex> lock(staging_mutex_);
+  if (staging_buffers_.empty()) {
+    staging_buffers_.resize(2);
+  }
+  auto& buf = staging_buffers_[next_staging_buffer_];
+  next_staging_buffer_ = (next_staging_buffer_ + 1) % staging_buffers_.size();
+
+  auto api = DeviceAPI::Get(dev.device_type());
+  auto copy_stream = Stream::Get(dev, kMemCpyCpuToCuda, 0);
+  if (buf.copied == nullptr) {
+    buf.copied = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+    buf.consumed = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+  } else {
+    // The pinned buffers are still read by the last upload from this buffer.
+    api->WaitEvent(buf.copied->data());
+  }
+  // The device buffers may still be read by the last execution using this buffer.
+  api->StreamWaitEvent(copy_stream->data(), buf.consumed->data());
+
+  buf.host.resize(inputs.size());
+  buf.device.resize(inputs.size());
+  Device pinned(DevType::kCUDAHost(), 0);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const auto* tensor = inputs[i].as<TensorValueObj>();
+    if (tensor == nullptr || tensor->tensor->device.device_type != kDLCPU) {
+      // Only stage host tensors. Others are copied synchronously.
+      buf.host[i] = Value();
+      buf.device[i] = CopyTo(inputs[i], dev);
+      continue;
+    }
+    const DLTensor* src = tensor->tensor.operator->();
+    CHECK(tvm::runtime::IsContiguous(*src)) << "Only contiguous inputs can be staged";
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    int64_t nbytes = tvm::runtime::GetDataSize(*src);
+    auto fmatch = [&](const Value& v) {
+      if (!v.defined()) {
+        return false;
+      }
+      const DLTensor* t = Downcast<TensorValue>(v)->tensor.operator->();
+      return std::vector<int64_t>(t->shape, t->shape + t->ndim) == shape &&
+             tvm::runtime::TypeEqual(t->dtype, src->dtype);
+    };
+    if (!fmatch(buf.host[i]) || !fmatch(buf.device[i])) {
+      auto host_mem = memory_pool::Memory::Alloc(pinned, nbytes);
+      auto dev_mem = memory_pool::Memory::Alloc(dev, nbytes);
+      buf.host[i] =
+          TensorValue::Assemble(pinned, DType(src->dtype), shape, {}, host_mem->data, host_mem);
+      buf.device[i] =
+          TensorValue::Assemble(dev, DType(src->dtype), shape, {}, dev_mem->data, dev_mem);
+    }
+    DLTensor* host = Downcast<TensorValue>(buf.host[i])->tensor.operator->();
+    DLTensor* device = Downcast<TensorValue>(buf.device[i])->tensor.operator->();
+    std::memcpy(host->data, static_cast<const char*>(src->data) + src->byte_offset, nbytes);
+    api->CopyDataFromTo(host, device, copy_stream->data());
+  }
+  api->EventRecordOnStream(buf.copied->data(), copy_stream->data());
+
+  auto ctx = VMContext::make(exec_);
+  ctx->entry_func_index = func_index;
+  ctx->inputs = buf.device;
+  ctx->input_ready_event = buf.copied;
+  ctx->input_consumed_event = buf.consumed;
+  return ctx;
+}
+
+void VirtualMachine::StageConstants(const std::vector<Index>& indices,
+                                    const std::vector<Value>& values) {
+  CHECK_EQ(indices.size(), values.size()) << "The numbers of the constants and values differ";
+  std::lock_guard<std::mutex> lock(staged_constants_mutex_);
+  Device dev = devices_[0];
+  auto api = DeviceAPI::Get(dev.device_type());
+  std::shared_ptr<Stream> copy_stream;
+  void* stream = nullptr;
+  if (dev.device_type() == DevType::kCUDA()) {
+    copy_stream = Stream::Get(dev, kMemCpyCpuToCuda, 0);
+    stream = copy_stream->data();
+    if (constants_staged_event_ == nullptr) {
+      constants_staged_event_ = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+      constants_swapped_event_ = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
     } else {
-      for (int i = 0; i < inputs.size(); i++) {
-        Value new_arg = inputs[i];
-        Value graph_arg = cuda_graph_ctx_->inputs[i];
-        if (new_arg.as<TensorValueObj>()) {
-          CHECK(graph_arg.as<TensorValueObj>()) << "Value type mismatch, cannot copy";
-          Downcast<TensorValue>(new_arg)->tensor.CopyTo(Downcast<TensorValue>(graph_arg)->tensor);
-        } else {
-          LOG(FATAL) << "Unsupported Value Type for reusing CUDA Graph";
-        }
+      // The spare buffers may still be read by the runs launched before the last swap.
+      api->StreamWaitEvent(stream, constants_swapped_event_->data());
+    }
+  }
+  for (size_t i = 0; i < indices.size(); ++i) {
+    Index index = indices[i];
+    CHECK(index >= 0 && index < static_cast<Index>(exec_->constants.size()))
+        << "Invalid constant index " << index;
+    const auto* old_tensor = exec_->constants[index].as<TensorValueObj>();
+    const auto* new_tensor = values[i].as<TensorValueObj>();
+    CHECK(old_tensor && new_tensor) << "Only the tensor constants can be updated";
+    CHECK(!weight_streamer_ || !weight_streamer_->IsStreamed(index))
+        << "The streamed constant " << index << " cannot be updated";
+    const DLTensor* old_t = old_tensor->tensor.operator->();
+    DLTensor* src = const_cast<DLTensor*>(new_tensor->tensor.operator->());
+    std::vector<int64_t> shape(old_t->shape, old_t->shape + old_t->ndim);
+    CHECK(std::vector<int64_t>(src->shape, src->shape + src->ndim) == shape &&
+          tvm::runtime::TypeEqual(src->dtype, old_t->dtype))
+        << "The new value of constant " << index << " must have the same shape and dtype";
+    Value& back = staged_constants_[index];
+    if (!back.defined()) {
+      auto it = spare_constants_.find(index);
+      // A spare buffer still held by a register or the caller cannot be overwritten.
+      if (it != spare_constants_.end() && it->second.use_count() == 1) {
+        back = it->second;
+      } else {
+        int64_t nbytes = tvm::runtime::GetDataSize(*old_t);
+        auto mem = memory_pool::Memory::Alloc(dev, nbytes);
+        back = TensorValue::Assemble(dev, DType(old_t->dtype), shape, {}, mem->data, mem);
+      }
+      if (it != spare_constants_.end()) {
+        spare_constants_.erase(it);
       }
-      DLOG(INFO) << "Updated the inputs to the cached CUDA Graph.";
     }
-    cuda_graph_occupied_ = true;
-    return cuda_graph_ctx_;
+    api->CopyDataFromTo(src, Downcast<TensorValue>(back)->tensor.operator->(), stream);
+  }
+  if (copy_stream != nullptr) {
+    api->EventRecordOnStream(constants_staged_event_->data(), stream);
+  }
+}
+
+int VirtualMachine::SwapConstants() {
+  std::lock_guard<std::mutex> stage_lock(staged_constants_mutex_);
+  if (staged_constants_.empty()) {
+    return 0;
+  }
+  Device dev = devices_[0];
+  auto api = DeviceAPI::Get(dev.device_type());
+  bool cuda = dev.device_type() == DevType::kCUDA();
+  if (cuda) {
+    // The runs launched afterwards read the staged constants after the uploads.
+    api->StreamWaitEvent(nullptr /* default stream */, constants_staged_event_->data());
+  }
+  std::lock_guard<std::mutex> lock(const_pool_mutex_);
+  if (const_pool_.size() < exec_->constants.size()) {
+    const_pool_.resize(exec_->constants.size());
+  }
+  int num_swapped = static_cast<int>(staged_constants_.size());
+#ifdef RAF_USE_CUDA
+  if (enable_cuda_graph_) {
+    {
+      std::lock_guard<std::mutex> graph_lock(cuda_graph_mutex_);
+      for (const auto& slot : cuda_graph_slots_) {
+        CHECK(!slot.occupied) << "Cannot swap the constants while the CUDA graphs are running";
+      }
+    }
+    // The graphs are launched on their own streams, which do not wait for the default stream.
+    api->WaitEvent(constants_staged_event_->data());
+    for (auto& it : staged_constants_) {
+      Value& front = const_pool_[it.first];
+      if (!front.defined()) {
+        // Not captured by any graph yet.
+        front = it.second;
+        continue;
+      }
+      CHECK(!share_constants_ || !ConstantStore::Get()->IsShared(front))
+          << "Cannot update the shared constant " << it.first
+          << " captured by the CUDA graphs in place";
+      api->CopyDataFromTo(Downcast<TensorValue>(it.second)->tensor.operator->(),
+                          Downcast<TensorValue>(front)->tensor.operator->(), nullptr);
+      spare_constants_[it.first] = it.second;
+    }
+    api->WaitDevice(dev);
+    staged_constants_.clear();
+    return num_swapped;
   }
 #endif
-  auto ctx = fcreate_ctx();
-  return ctx;
+  for (auto& it : staged_constants_) {
+    Value& front = const_pool_[it.first];
+    if (front.defined()) {
+      spare_constants_[it.first] = front;
+    }
+    front = it.second;
+  }
+  staged_constants_.clear();
+  if (cuda) {
+    // The runs before the swap end on the default stream, after which the spare ones are free.
+    api->EventRecordOnStream(constants_swapped_event_->data(), nullptr /* default stream */);
+  }
+  return num_swapped;
+}
+
+#ifdef RAF_USE_CUDA
+void VirtualMachine::SetCudaGraphCache(int capacity, double mem_cap_mb,
+                                       const std::vector<int64_t>& buckets) {
+  std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
+  CHECK_GE(capacity, max_concurrency_)
+      << "The CUDA graph cache must be able to hold the graphs of all concurrent contexts";
+  cuda_graph_cache_size_ = capacity;
+  cuda_graph_mem_cap_mb_ = mem_cap_mb;
+  cuda_graph_buckets_ = buckets;
+  std::sort(cuda_graph_buckets_.begin(), cuda_graph_buckets_.end());
+  EvictCudaGraphs();
+}
+
+void VirtualMachine::SetPersistentInputs(const std::string& func_name,
+                                         const std::vector<int>& indices) {
+  CHECK(exec_) << "The executable is not loaded yet.";
+  auto gvit = exec_->global_map.find(func_name);
+  CHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
+  int num_params = exec_->functions[gvit->second].params.size();
+  std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
+  auto& persistent = cuda_graph_persistent_inputs_[gvit->second];
+  persistent.clear();
+  for (int index : indices) {
+    CHECK(index >= 0 && index < num_params)
+        << "Invalid input index " << index << " of " << func_name;
+    persistent.insert(index);
+  }
+}
+
+void VirtualMachine::EvictCudaGraphs() {
+  auto total_mem_mb = [this]() {
+    double total = 0;
+    for (const auto& slot : cuda_graph_slots_) {
+      total += slot.mem_mb;
+    }
+    return total;
+  };
+  // Evict from the least recently used end, skipping the graphs in use.
+  auto it = cuda_graph_slots_.end();
+  while (it != cuda_graph_slots_.begin()) {
+    bool over_size = cuda_graph_slots_.size() > cuda_graph_cache_size_;
+    bool over_mem = cuda_graph_mem_cap_mb_ > 0 && total_mem_mb() > cuda_graph_mem_cap_mb_;
+    if (!over_size && !over_mem) {
+      break;
+    }
+    --it;
+    if (!it->occupied) {
+      DLOG(INFO) << "Evict the CUDA graph of " << it->signature;
+      it = cuda_graph_slots_.erase(it);
+    }
+  }
+}
+
+std::vector<int64_t> VirtualMachine::GetCudaGraphInputShape(const DLTensor* t) const {
+  std::vector<int64_t> shape(t->shape, t->shape + t->ndim);
+  if (t->ndim == 0) {
+    return shape;
+  }
+  // Pad the leading axis, so the original data is a contiguous prefix of the padded tensor.
+  auto bucket = std::lower_bound(cuda_graph_buckets_.begin(), cuda_graph_buckets_.end(), shape[0]);
+  if (bucket != cuda_graph_buckets_.end()) {
+    shape[0] = *bucket;
+  }
+  return shape;
+}
+
+VMContext VirtualMachine::PrepareCudaGraphContext(Index func_index,
+                                                  const std::vector<Value>& inputs) {
+  std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
+  // The shape signature of the graph: the function and the (padded) shapes of the inputs, and
+  // the addresses of the persistent inputs, which are captured by reference.
+  static const std::unordered_set<int> no_persistent;
+  auto pit = cuda_graph_persistent_inputs_.find(func_index);
+  const auto& persistent =
+      pit != cuda_graph_persistent_inputs_.end() ? pit->second : no_persistent;
+  Device dev = devices_[0];
+  std::vector<std::vector<int64_t>> shapes;
+  std::ostringstream os;
+  os << func_index << ":";
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const auto* tensor = inputs[i].as<TensorValueObj>();
+    CHECK(tensor) << "Unsupported Value Type for reusing CUDA Graph";
+    const DLTensor* t = tensor->tensor.operator->();
+    if (persistent.count(i)) {
+      CHECK(Device(t->device) == dev)
+          << "The persistent input " << i << " must be on the device of the VM";
+      shapes.emplace_back(t->shape, t->shape + t->ndim);
+      os << t->data << "+" << t->byte_offset << "@";
+    } else {
+      shapes.push_back(GetCudaGraphInputShape(t));
+    }
+    for (auto dim : shapes.back()) {
+      os << dim << "x";
+    }
+    os << tvm::runtime::DLDataType2String(t->dtype) << ",";
+  }
+  std::string signature = os.str();
+
+  int num_occupied = 0;
+  auto hit = cuda_graph_slots_.end();
+  for (auto it = cuda_graph_slots_.begin(); it != cuda_graph_slots_.end(); ++it) {
+    num_occupied += it->occupied;
+    if (!it->occupied && hit == cuda_graph_slots_.end() && it->signature == signature) {
+      hit = it;
+    }
+  }
+  CHECK_LT(num_occupied, max_concurrency_)
+      << "All " << max_concurrency_
+      << " CUDA graph contexts are in use. Increase max_concurrency of the VM "
+      << "to run more contexts concurrently";
+
+  if (hit == cuda_graph_slots_.end()) {
+    // Shape signature miss. Create a new context whose graph is captured in the first run.
+    CudaGraphSlot slot;
+    slot.signature = signature;
+    slot.ctx = VMContext::make(exec_);
+    slot.ctx->entry_func_index = func_index;
+    slot.ctx->inputs.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (persistent.count(i)) {
+        slot.ctx->inputs[i] = inputs[i];
+        continue;
+      }
+      const DLTensor* t = Downcast<TensorValue>(inputs[i])->tensor.operator->();
+      int64_t nbytes = t->dtype.bits / 8 * t->dtype.lanes;
+      for (auto dim : shapes[i]) {
+        nbytes *= dim;
+      }
+      auto mem = memory_pool::Memory::Alloc(dev, nbytes);
+      slot.ctx->inputs[i] =
+          TensorValue::Assemble(dev, DType(t->dtype), shapes[i], {}, mem->data, mem);
+    }
+    cuda_graph_slots_.push_front(std::move(slot));
+  } else {
+    // Move the hit graph to the most recently used end.
+    cuda_graph_slots_.splice(cuda_graph_slots_.begin(), cuda_graph_slots_, hit);
+  }
+  auto& slot = cuda_graph_slots_.front();
+
+  // Copy the inputs into the (prefix of the) tensors captured by the graph, and zero the padding.
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (persistent.count(i)) {
+      // The graph reads the persistent input itself, as the signature pins its address.
+      continue;
+    }
+    auto new_arg = Downcast<TensorValue>(inputs[i]);
+    auto graph_arg = Downcast<TensorValue>(slot.ctx->inputs[i]);
+    const DLTensor* src = new_arg->tensor.operator->();
+    const DLTensor* dst = graph_arg->tensor.operator->();
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    new_arg->tensor.CopyTo(graph_arg.CreateView(shape)->tensor);
+    size_t copied = tvm::runtime::GetDataSize(*src);
+    size_t total = tvm::runtime::GetDataSize(*dst);
+    if (total > copied) {
+      CUDA_CALL(cudaMemset(static_cast<char*>(dst->data) + copied, 0, total - copied));
+    }
+  }
+  DLOG(INFO) << "Updated the inputs to the CUDA Graph of " << signature;
+  slot.occupied = true;
+  EvictCudaGraphs();
+  return slot.ctx;
+}
+#endif
+
+void VirtualMachine::BuildOpEnvs(VMContext ctx) {
+  LoadFunction(ctx->entry_func_index);
+  ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
+  RunLoop(ctx);
+  if (ctx->current_stream_id != 0) {
+    OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
+  }
+#ifdef RAF_USE_CUDA
+  if (enable_cuda_graph_) {
+    // Release the CUDA graph slot taken by the context, which is not captured.
+    std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
+    for (auto& s : cuda_graph_slots_) {
+      if (s.ctx.get() == ctx.get()) {
+        s.occupied = false;
+      }
+    }
+  }
+#endif
+  DeviceAPI::Get(devices_[0].device_type())->WaitDevice(devices_[0]);
 }
 
 Value VirtualMachine::Run(VMContext ctx) {
+  memory_pool::TenantScope tenant_scope(tenant_);
+  // Bind before configuring the threads, so the intra-op threads are created on the node.
+  if (numa_node_ >= 0) {
+    device_api::cpu::BindToNumaNode(numa_node_);
+  }
+  if (num_threads_ > 0) {
+    device_api::cpu::SetNumThreads(num_threads_);
+  }
+  // The device time is not observed in the dryrun, which launches nothing, or for the CUDA graphs,
+  // which are launched on their own streams.
+  utils::RunMetrics run_metrics(devices_[0], use_cuda_ && !dryrun_ && !enable_cuda_graph_);
   auto frun = [&]() {
     // ctx->pc will be reset to 0 in the PushFrame
+    LoadFunction(ctx->entry_func_index);
     ctx.PushFrame(ctx->entry_func_index, ctx->inputs, -1);
     RunLoop(ctx);
   };
+  if (ctx->streams.empty()) {
+    // The streams are resolved once when the functions are loaded, so the dispatch loop neither
+    // locks the stream pool nor creates the streams.
+    LoadFunction(ctx->entry_func_index);
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    ctx->streams = streams_;
+  }
 #ifdef RAF_USE_CUDA
   if (enable_cuda_graph_) {
-    CHECK(ctx.get() == cuda_graph_ctx_.get()) << "Wrong VMContext provided for CUDA graph.";
-    if (!cuda_graph_impl_) {
-      cuda_graph_impl_ = new CudaGraphImpl(devices_[0]);
+    CudaGraphSlot* slot = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
+      for (auto& s : cuda_graph_slots_) {
+        if (s.ctx.get() == ctx.get()) {
+          slot = &s;
+          break;
+        }
+      }
+    }
+    CHECK(slot != nullptr && slot->occupied) << "Wrong VMContext provided for CUDA graph.";
+    if (!slot->impl) {
+      std::lock_guard<std::mutex> capture_lock(cuda_graph_capture_mutex_);
+      auto pool_mb_before = memory_pool::Memory::GetPoolSize(devices_[0]).second;
+      slot->collectives = function_collectives_[ctx->entry_func_index];
+      if (slot->collectives) {
+#if defined RAF_USE_NCCL && NCCL_VERSION_CODE < 20906
+        LOG(FATAL) << "Capturing the collectives into a CUDA graph requires NCCL 2.9.6 or later";
+#endif
+        // The OpEnvs of the collectives create their communicators, which initializes NCCL
+        // collectively with the other ranks and cannot be captured, so they are built by a pass
+        // launching nothing before the capture.
+        ctx->build_only = true;
+        frun();
+        ctx->build_only = false;
+        OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
+        DeviceAPI::Get(devices_[0].device_type())->WaitDevice(devices_[0]);
+      }
+      slot->impl = std::make_shared<CudaGraphImpl>(devices_[0]);
       DLOG(INFO) << "Begin capturing CUDA graph.";
-      cuda_graph_impl_->BeginCapture();
+      // All the streams of the schedule are captured, where its default stream is the graph
+      // stream.
+      Index device_id = devices_[0].device_id();
+      if (ctx->streams.size() <= device_id) {
+        ctx->streams.resize(device_id + 1);
+      }
+      auto& streams = ctx->streams[device_id];
+      if (streams.empty()) {
+        streams.resize(1);
+      }
+      std::vector<std::shared_ptr<Stream>> side_streams;
+      for (size_t i = 1; i < streams.size(); ++i) {
+        if (streams[i] != nullptr) {
+          side_streams.push_back(streams[i]);
+        }
+      }
+      slot->impl->BeginCapture(side_streams);
+      streams[0] = slot->impl->stream();
       frun();
-      cuda_graph_impl_->EndCapture();
+      slot->impl->EndCapture();
+      OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
+      // Account the memory that the pool grows for this graph towards the cache memory cap.
+      slot->mem_mb = memory_pool::Memory::GetPoolSize(devices_[0]).second - pool_mb_before;
       DLOG(INFO) << "CUDA graph captured.";
     }
-    cuda_graph_impl_->Invoke();
+    if (slot->collectives) {
+      // The graphs replaying the collectives are launched one at a time, and every rank replays
+      // its graphs in the same order as it runs the function, so the collectives match.
+      std::lock_guard<std::mutex> replay_lock(cuda_graph_collective_mutex_);
+      slot->impl->Invoke();
+    } else {
+      // Each CUDA graph is launched on its own stream, so the graphs of different contexts can
+      // run concurrently.
+      slot->impl->Invoke();
+    }
     std::lock_guard<std::mutex> lock(cuda_graph_mutex_);
-    cuda_graph_occupied_ = false;
+    slot->occupied = false;
     // TODO(@icemelon9, @zhiics): May need to copy the return register to the host device to
     // avoid data race
     return ctx->return_register;
   }
 #endif
+  if (ctx->input_ready_event != nullptr) {
+    // Wait for the inputs uploaded on the copy stream without blocking the host.
+    DeviceAPI::Get(devices_[0].device_type())
+        ->StreamWaitEvent(nullptr /* default stream */, ctx->input_ready_event->data());
+  }
+  AcquireEvents(ctx);
+  if (use_cuda_ && !dryrun_) {
+    // The streams of the schedule may read a freed buffer after the host moves on, so the frees
+    // wait for them instead of returning the buffers to the pool right away.
+    Index device_id = devices_[0].device_id();
+    size_t num_streams = 0;
+    if (device_id < ctx->streams.size()) {
+      for (const auto& stream : ctx->streams[device_id]) {
+        num_streams += stream != nullptr;
+      }
+    }
+    ctx->stream_ordered_free = num_streams > 1;
+    ctx->launch_epoch = 0;
+    ctx->stream_launch_epochs.clear();
+    ctx->alloc_epochs.clear();
+  }
   frun();
   if (ctx->current_stream_id != 0) {
     // reset the working stream to default stream.
     OpEnv::SetStreamForAllBackends(devices_[0], nullptr);
   }
-  return ctx->return_register;
+  if (ctx->input_consumed_event != nullptr) {
+    // Release the staged inputs for the following uploads once the execution finished.
+    DeviceAPI::Get(devices_[0].device_type())
+        ->EventRecordOnStream(ctx->input_consumed_event->data(), nullptr /* default stream */);
+  }
+  if (numerics_watchdog_ && !dryrun_) {
+    numerics_watchdog_->EndStep(nullptr /* default stream */);
+  }
+  RecycleEvents(ctx);
+  return ctx->return_register;
+}
+
+void VirtualMachine::SubmitPipelined(const std::string& func_name,
+                                     const std::vector<Value>& inputs) {
+  CHECK(exec_) << "The executable is not loaded yet.";
+  std::lock_guard<std::mutex> lock(pipeline_mutex_);
+  Device dev = devices_[0];
+  PipelinedBatch batch;
+  VMContext ctx = PrepareVMContextAsync(func_name, inputs);
+  batch.device_outputs = Run(ctx);
+  if (dev.device_type() != DevType::kCUDA() || enable_cuda_graph_) {
+    // The CUDA graphs are replayed synchronously, so there is nothing to overlap.
+    batch.host_outputs = CopyTo(batch.device_outputs, Device(DevType::kCPU(), 0));
+    pipelined_batches_.push_back(std::move(batch));
+    return;
+  }
+  if (pipeline_events_.empty()) {
+    auto pool = EventPool::Get(dev);
+    pipeline_events_.emplace_back(pool->GetEvent(0x02 /*cudaEventDisableTiming*/),
+                                  pool->GetEvent(0x02 /*cudaEventDisableTiming*/));
+  }
+  std::tie(batch.computed, batch.downloaded) = pipeline_events_.back();
+  pipeline_events_.pop_back();
+
+  // The outputs are downloaded on the copy stream after the execution on the default stream, so
+  // the next batch is executed meanwhile.
+  auto api = DeviceAPI::Get(dev.device_type());
+  auto copy_stream = Stream::Get(dev, kMemCpyCudaToCpu, 0);
+  api->EventRecordOnStream(batch.computed->data(), nullptr /* default stream */);
+  api->StreamWaitEvent(copy_stream->data(), batch.computed->data());
+  Device pinned(DevType::kCUDAHost(), 0);
+  std::function<Value(const Value&)> download = [&](const Value& value) -> Value {
+    if (const auto* tuple = value.as<TupleValueObj>()) {
+      Array<Value> fields;
+      for (const auto& field : tuple->fields) {
+        fields.push_back(download(field));
+      }
+      return TupleValue::make(fields);
+    }
+    const auto* tensor = value.as<TensorValueObj>();
+    if (tensor == nullptr || tensor->tensor->device.device_type != kDLCUDA) {
+      return value;
+    }
+    const DLTensor* src = tensor->tensor.operator->();
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    auto mem = memory_pool::Memory::Alloc(pinned, tvm::runtime::GetDataSize(*src));
+    auto ret = TensorValue::Assemble(pinned, DType(src->dtype), shape, {}, mem->data, mem);
+    api->CopyDataFromTo(const_cast<DLTensor*>(src), ret->tensor.operator->(), copy_stream->data());
+    return ret;
+  };
+  batch.host_outputs = download(batch.device_outputs);
+  api->EventRecordOnStream(batch.downloaded->data(), copy_stream->data());
+  if (ctx->input_consumed_event != nullptr) {
+    // The outputs may be the staged inputs, which are consumed after the download.
+    api->EventRecordOnStream(ctx->input_consumed_event->data(), copy_stream->data());
+  }
+  pipelined_batches_.push_back(std::move(batch));
+}
+
+Value VirtualMachine::FetchPipelined() {
+  std::unique_lock<std::mutex> lock(pipeline_mutex_);
+  CHECK(!pipelined_batches_.empty()) << "No batch is submitted to the pipeline";
+  PipelinedBatch batch = std::move(pipelined_batches_.front());
+  pipelined_batches_.pop_front();
+  lock.unlock();
+  if (batch.downloaded != nullptr) {
+    DeviceAPI::Get(devices_[0].device_type())->WaitEvent(batch.downloaded->data());
+    lock.lock();
+    pipeline_events_.emplace_back(batch.computed, batch.downloaded);
+  }
+  return batch.host_outputs;
+}
+
+void VirtualMachine::AcquireEvents(VMContext& ctx) {
+  if (!ctx->events.empty() || !ctx->barrier_events.empty() || !ctx->stream_events.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(recycled_events_mutex_);
+  if (recycled_events_.empty()) {
+    return;
+  }
+  EventSet& set = recycled_events_.back();
+  ctx->events = std::move(set.events);
+  ctx->barrier_events = std::move(set.barrier_events);
+  ctx->stream_events = std::move(set.stream_events);
+  recycled_events_.pop_back();
+}
+
+void VirtualMachine::RecycleEvents(VMContext& ctx) {
+  // The events may still be pending on the device. Recording an event again only affects the
+  // waits enqueued after it, as a wait captures the latest record when it is enqueued, so the
+  // following runs can reuse the events without synchronizing the streams.
+  if (ctx->events.empty() && ctx->barrier_events.empty() && ctx->stream_events.empty()) {
+    return;
+  }
+  EventSet set;
+  set.events = std::move(ctx->events);
+  set.barrier_events = std::move(ctx->barrier_events);
+  set.stream_events = std::move(ctx->stream_events);
+  for (auto& rings : set.stream_events) {
+    for (auto& ring : rings) {
+      ring.next = 0;
+    }
+  }
+  ctx->events.clear();
+  ctx->barrier_events.clear();
+  ctx->stream_events.clear();
+  ctx->current_barrier_event_index = 0;
+  std::lock_guard<std::mutex> lock(recycled_events_mutex_);
+  if (recycled_events_.size() < static_cast<size_t>(max_concurrency_)) {
+    recycled_events_.push_back(std::move(set));
+  }
 }
 
 Array<FloatValue> VirtualMachine::Profile(VMContext ctx, int warmup, int number, int repeat) {
@@ -497,6 +1584,114 @@ void VirtualMachine::SetDevices(const std::vector<Device>& devices) {
   }
 }
 
+void VirtualMachine::SetWeightStreaming(int64_t buffer_bytes, int64_t min_bytes) {
+  CHECK(exec_) << "The executable is not loaded yet.";
+  std::lock_guard<std::mutex> lock(const_pool_mutex_);
+  if (buffer_bytes <= 0) {
+    weight_streamer_ = nullptr;
+    return;
+  }
+  if (!use_cuda_) {
+    LOG(WARNING) << "The weights are only streamed to the CUDA devices, so it is ignored.";
+    return;
+  }
+  // The CUDA graphs and the precomputed calls bind the addresses of the weights, which change
+  // with their regions of the buffer.
+  CHECK(!enable_cuda_graph_) << "The weights cannot be streamed with the CUDA graphs.";
+  CHECK(!precompute_args_) << "The weights cannot be streamed with the precomputed arguments.";
+  CHECK(!share_constants_) << "The weights cannot be streamed with the shared constants.";
+  weight_streamer_ =
+      std::make_shared<WeightStreamer>(exec_, GetParamsDevice(), buffer_bytes, min_bytes);
+  for (size_t i = 0; i < const_pool_.size(); ++i) {
+    if (weight_streamer_->IsStreamed(i)) {
+      const_pool_[i] = Value();
+    }
+  }
+}
+
+bool VirtualMachine::ResolveStreams(const std::vector<Instruction>& instructions) {
+  // The collectives are the InvokeJit of the ops loaded as constants, which may be fused with the
+  // Free after them into InvokeJitFree.
+  std::unordered_map<RegName, Index> const_regs;
+  bool collectives = false;
+  for (const auto& instr : instructions) {
+    if (instr.op == Opcode::LoadConst) {
+      const_regs[instr.dst] = instr.const_index;
+    } else if (instr.op == Opcode::InvokeJitAsync) {
+      collectives = true;
+    } else if (instr.op == Opcode::InvokeJit || instr.op == Opcode::InvokeJitFree) {
+      auto it = const_regs.find(instr.invoke_jit.op_reg);
+      if (it == const_regs.end()) {
+        continue;
+      }
+      if (auto opv = exec_->constants[it->second].as<OpValueObj>()) {
+        collectives |=
+            op::IsCollectiveOp(op::IsDialectOp(opv->op) ? op::GetBaseOp(opv->op) : opv->op);
+      }
+    }
+  }
+  if (!use_cuda_) {
+    return collectives;
+  }
+  std::lock_guard<std::mutex> lock(streams_mutex_);
+  // The priorities of the streams set by the function, where the first one of a stream wins.
+  std::map<std::pair<Index, Index>, Index> priorities;
+  for (const auto& instr : instructions) {
+    if (instr.op == Opcode::CudaSetStream) {
+      priorities.emplace(
+          std::make_pair(instr.cuda_set_stream.device_id, instr.cuda_set_stream.stream_id),
+          instr.cuda_set_stream.priority);
+    }
+  }
+  auto fresolve = [&](Index device_id, Index stream_id) {
+    if (stream_id < 0) {
+      return;
+    }
+    if (device_id >= streams_.size()) {
+      streams_.resize(device_id + 1);
+    }
+    if (stream_id >= streams_[device_id].size()) {
+      streams_[device_id].resize(stream_id + 1);
+    }
+    auto& stream = streams_[device_id][stream_id];
+    if (stream != nullptr) {
+      return;
+    }
+    if (stream_id == 0) {
+      stream = std::make_shared<Stream>(nullptr);
+    } else {
+      auto it = priorities.find(std::make_pair(device_id, stream_id));
+      Index priority = it == priorities.end() ? 0 : it->second;
+      Device device(DevType::kCUDA(), static_cast<int>(device_id));
+      stream = Stream::Get(device, kCudaCompute, static_cast<int>(stream_id), priority);
+    }
+  };
+  Index device_id = devices_[0].device_id();
+  for (const auto& instr : instructions) {
+    switch (instr.op) {
+      case Opcode::CudaSetStream:
+        fresolve(instr.cuda_set_stream.device_id, instr.cuda_set_stream.stream_id);
+        break;
+      case Opcode::CudaSetStreamWait:
+        fresolve(instr.cuda_set_stream_wait.device_id, instr.cuda_set_stream_wait.stream_id);
+        fresolve(instr.cuda_set_stream_wait.device_id, instr.cuda_set_stream_wait.wait_stream_id);
+        break;
+      case Opcode::CudaAddEvent:
+      case Opcode::CudaWaitEvent:
+        fresolve(device_id, instr.cuda_event.stream_id);
+        break;
+      default:
+        break;
+    }
+  }
+  if (collectives) {
+    // The OpEnvs of the collectives run on the communication stream, which has to be resolved
+    // before a CUDA graph is captured, even if their OpEnvs are built by another context.
+    fresolve(device_id, kCudaCommunicate);
+  }
+  return collectives;
+}
+
 inline std::shared_ptr<Memory> VirtualMachine::Alloc(const VMContext& ctx, Device dev,
                                                      int64_t nbytes, int64_t alignment,
                                                      bool alloc_async) const {
@@ -517,6 +1712,80 @@ inline std::shared_ptr<Memory> VirtualMachine::Alloc(const VMContext& ctx, Devic
   }
 }
 
+/*!
+ * \brief A view of a region in a static arena. It keeps the arena alive, and releases nothing
+ * by itself.
+ */
+class ArenaMemory final : public Memory {
+ public:
+  ArenaMemory(std::shared_ptr<Memory> arena, int64_t offset) : arena(std::move(arena)) {
+    this->data = static_cast<char*>(this->arena->data) + offset;
+    this->device = this->arena->device;
+  }
+
+  /*! \brief The arena holding the region. */
+  std::shared_ptr<Memory> arena;
+};
+
+std::shared_ptr<Memory> VirtualMachine::AllocFromArena(VMContext& ctx, Device dev,
+                                                       const Instruction& instr) const {
+  auto& arenas = ctx->frames.back().arenas;
+  const auto& alloc = instr.alloc_storage;
+  if (arenas.size() <= static_cast<size_t>(alloc.arena_index)) {
+    arenas.resize(alloc.arena_index + 1);
+  }
+  auto& arena = arenas[alloc.arena_index];
+  // The arenas of a recycled frame may belong to another function.
+  if (arena.first == nullptr || arena.first->device.device_type() != dev.device_type() ||
+      arena.first->device.device_id() != dev.device_id() || arena.second < alloc.arena_size) {
+    arena.first = memory_pool::Memory::Alloc(dev, alloc.arena_size, kStaticArenaAlignment);
+    arena.second = alloc.arena_size;
+  }
+  return std::make_shared<ArenaMemory>(arena.first, alloc.arena_offset);
+}
+
+void VirtualMachine::PrefetchNextOp(VMContext& ctx) const {
+#ifdef RAF_USE_CUDA
+  // The bytecode follows the order of the liveness analysis of the memory plan, so the next op
+  // in the straight-line code is the next one to run.
+  constexpr Index kLookahead = 16;
+  const auto& instructions = exec_->functions[ctx->func_index].instructions;
+  Index end = std::min<Index>(instructions.size(), ctx->pc + 1 + kLookahead);
+  for (Index pc = ctx->pc + 1; pc < end; ++pc) {
+    const auto& instr = instructions[pc];
+    if (instr.op == Opcode::If || instr.op == Opcode::Goto || instr.op == Opcode::Ret ||
+        instr.op == Opcode::InvokeFunc || instr.op == Opcode::InvokeClosure) {
+      return;
+    }
+    if (instr.op != Opcode::InvokeJit && instr.op != Opcode::InvokeJitFree) {
+      continue;
+    }
+    auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
+    auto api = DeviceAPI::Get(devices_[0].device_type());
+    auto fprefetch = [&](const Value& value) {
+      if (const auto* t = value.as<TensorValueObj>()) {
+        const DLTensor* tensor = t->tensor.operator->();
+        if (tensor->device.device_type == kDLCUDA && tensor->data != nullptr) {
+          api->PrefetchMemory(tensor->data, tvm::runtime::GetDataSize(*tensor), stream->data());
+        }
+      }
+    };
+    const auto& register_file = ctx->frames.back().register_file;
+    for (Index i = 0; i < instr.invoke_jit.arity; ++i) {
+      const Value& value = register_file[instr.invoke_jit.args[i]];
+      if (const auto* tuple = value.as<TupleValueObj>()) {
+        for (const auto& field : tuple->fields) {
+          fprefetch(field);
+        }
+      } else {
+        fprefetch(value);
+      }
+    }
+    return;
+  }
+#endif
+}
+
 void VirtualMachine::RunLoop(VMContext& ctx) {
   CHECK(this->exec_);
   CHECK_GT(ctx->frames.size(), 0) << "The call stack is empty";
@@ -528,8 +1797,14 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
   }
 #endif
   ctx->current_device_id = 0;
+  ctx->prefetch_managed_memory =
+      use_cuda_ && memory_pool::Memory::GetPool(devices_[0])->GetName() == "managed_pool";
   ctx->current_stream_id = 0;
   ctx->current_barrier_event_index = 0;
+  if (fast_dispatch_ && !profiler::Profiler::Get()->IsProfiling(2)) {
+    RunThreadedLoop(ctx);
+    return;
+  }
   while (true) {
   main_loop:
     auto const& instr = ctx->code[ctx->pc];
@@ -596,6 +1871,11 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
                                  { HandleFree(ctx, instr); });
         goto main_loop;
       }
+      case Opcode::Kill: {
+        WITH_BASE_PROFILER_LEVEL(2, host_device_, "Kill", "VMInstruction", {},
+                                 { HandleKill(ctx, instr); });
+        goto main_loop;
+      }
       case Opcode::SetShape: {
         WITH_BASE_PROFILER_LEVEL(2, host_device_, "SetShape", "VMInstruction", {},
                                  { HandleSetShape(ctx, instr); });
@@ -653,6 +1933,122 @@ void VirtualMachine::RunLoop(VMContext& ctx) {
                                  HandleCudaStreamBarrier(ctx, instr););
         goto main_loop;
       }
+      case Opcode::InvokeJitFree: {
+        WITH_BASE_PROFILER_LEVEL(2, host_device_, "InvokeJitFree", "VMInstruction", {},
+                                 { HandleInvokeJitFree(ctx, instr); });
+        goto main_loop;
+      }
+      case Opcode::CudaSetStreamWait: {
+        WITH_BASE_PROFILER_LEVEL(2, host_device_, "CudaSetStreamWait", "VMInstruction", {},
+                                 HandleCudaSetStreamWait(ctx, instr););
+        goto main_loop;
+      }
+      case Opcode::InvokeJitAsync: {
+        WITH_BASE_PROFILER_LEVEL(2, host_device_, "InvokeJitAsync", "VMInstruction", {},
+                                 { HandleInvokeJitAsync(ctx, instr); });
+        goto main_loop;
+      }
+      case Opcode::Wait: {
+        WITH_BASE_PROFILER_LEVEL(2, host_device_, "Wait", "VMInstruction", {},
+                                 { HandleWait(ctx, instr); });
+        goto main_loop;
+      }
+    }
+  }
+}
+
+template <void (VirtualMachine::*FHandle)(VMContext&, const Instruction&)>
+bool VirtualMachine::ThreadedHandle(VMContext& ctx, const Instruction& instr) {
+  (this->*FHandle)(ctx, instr);
+  return false;
+}
+
+bool VirtualMachine::ThreadedGoto(VMContext& ctx, const Instruction& instr) {
+  ctx->pc += instr.pc_offset;
+  return false;
+}
+
+bool VirtualMachine::ThreadedRet(VMContext& ctx, const Instruction& instr) {
+  return HandleRet(ctx, instr);
+}
+
+bool VirtualMachine::ThreadedFatal(VMContext& ctx, const Instruction& instr) {
+  if (instr.op == Opcode::InvokePacked) {
+    LOG(FATAL) << "Not supported.";
+  }
+  throw std::runtime_error("VM encountered fatal error");
+}
+
+VirtualMachine::InstrHandler VirtualMachine::DecodeInstruction(const Instruction& instr) const {
+  switch (instr.op) {
+    case Opcode::Move:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleMove>;
+    case Opcode::LoadConst:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleLoadConst>;
+    case Opcode::LoadConsti:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleLoadConsti>;
+    case Opcode::GetField:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleGetField>;
+    case Opcode::Goto:
+      return &VirtualMachine::ThreadedGoto;
+    case Opcode::If:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleIf>;
+    case Opcode::AllocStorage:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleAllocStorage>;
+    case Opcode::AllocTensor:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleAllocTensor>;
+    case Opcode::AllocTensorReg:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleAllocTensorReg>;
+    case Opcode::AllocTuple:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleAllocTuple>;
+    case Opcode::AllocClosure:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleAllocClosure>;
+    case Opcode::Free:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleFree>;
+    case Opcode::Kill:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleKill>;
+    case Opcode::SetShape:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleSetShape>;
+    case Opcode::InvokeFunc:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleInvokeFunc>;
+    case Opcode::InvokeClosure:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleInvokeClosure>;
+    case Opcode::InvokeJit:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleInvokeJit>;
+    case Opcode::InferType:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleInferType>;
+    case Opcode::Ret:
+      return &VirtualMachine::ThreadedRet;
+    case Opcode::CudaSetStream:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleCudaSetStream>;
+    case Opcode::CudaAddEvent:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleCudaAddEvent>;
+    case Opcode::CudaWaitEvent:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleCudaWaitEvent>;
+    case Opcode::CudaStreamBarrier:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleCudaStreamBarrier>;
+    case Opcode::InvokeJitFree:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleInvokeJitFree>;
+    case Opcode::CudaSetStreamWait:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleCudaSetStreamWait>;
+    case Opcode::InvokeJitAsync:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleInvokeJitAsync>;
+    case Opcode::Wait:
+      return &VirtualMachine::ThreadedHandle<&VirtualMachine::HandleWait>;
+    default:
+      return &VirtualMachine::ThreadedFatal;
+  }
+}
+
+void VirtualMachine::RunThreadedLoop(VMContext& ctx) {
+  // The handlers are virtual, so overridden handlers (e.g., in VMDebugger) are still honored.
+  // The table of the current function is re-fetched after every instruction because
+  // InvokeFunc, InvokeClosure and Ret switch the function being executed.
+  while (true) {
+    const auto& table = dispatch_tables_[ctx->func_index];
+    InstrHandler handler = table[ctx->pc];
+    if ((this->*handler)(ctx, ctx->code[ctx->pc])) {
+      return;
     }
   }
 }
@@ -668,15 +2064,37 @@ void VirtualMachine::HandleLoadConst(VMContext& ctx, const Instruction& instr) {
   // We cache the allocated object in the constant pool. To measure, the
   // first iteration will set the pool up. The other iterations will
   // directly reuse the allocated objects.
+  // The constants may be swapped by SwapConstants meanwhile.
+  std::unique_lock<std::mutex> lock(const_pool_mutex_);
+  if (weight_streamer_ && weight_streamer_->IsStreamed(instr.const_index)) {
+    // The streamed weight is uploaded on the copy stream, which the compute stream waits for.
+    auto streamer = weight_streamer_;
+    lock.unlock();
+    auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
+    ctx.WriteRegister(instr.dst, streamer->Load(ctx->func_index, instr.const_index,
+                                                stream->data()));
+    ctx->frames.back().is_const[instr.dst] = true;
+    ctx->pc++;
+    return;
+  }
   if (const_pool_.size() <= static_cast<size_t>(instr.const_index)) {
     const_pool_.resize(instr.const_index + 1);
   }
 
   if (!const_pool_[instr.const_index].defined()) {
+    Value constant;
+    if (share_constants_) {
+      auto it = constant_names_.find(instr.const_index);
+      constant = ConstantStore::Get()->Acquire(constant_obj, devices_[0],
+                                               it != constant_names_.end() ? it->second : "");
+    }
     // TODO(@zhiics): device could be obtained from the device list.
-    const_pool_[instr.const_index] = CopyTo(constant_obj, devices_[0]);
+    const_pool_[instr.const_index] =
+        constant.defined() ? constant : CopyTo(constant_obj, devices_[0]);
   }
-  ctx.WriteRegister(instr.dst, const_pool_[instr.const_index]);
+  Value constant = const_pool_[instr.const_index];
+  lock.unlock();
+  ctx.WriteRegister(instr.dst, constant);
   ctx->frames.back().is_const[instr.dst] = true;
   ctx->pc++;
 }
@@ -717,7 +2135,28 @@ void VirtualMachine::HandleAllocStorage(VMContext& ctx, const Instruction& instr
              << " alloc_async=" << alloc_async;
 
   auto dev = Device(instr.alloc_storage.device_type, instr.alloc_storage.device_id);
-  auto buffer = Alloc(ctx, dev, size, alignment, alloc_async);
+  std::shared_ptr<Memory> buffer;
+  // The addresses captured by a CUDA graph have to outlive the context, so the arenas held by
+  // the frames are not used in that mode.
+  if (instr.alloc_storage.arena_index >= 0 && !enable_cuda_graph_) {
+    buffer = AllocFromArena(ctx, dev, instr);
+  } else {
+    buffer = Alloc(ctx, dev, size, alignment, alloc_async);
+  }
+  auto profiler = memory_profiler::MemoryProfiler::Get();
+  if (profiler->IsProfiling() && buffer != nullptr) {
+    const auto& func = exec_->functions[ctx->func_index];
+    int64_t id = profiler->RecordAlloc(dev, size, buffer->data, ctx->func_index, ctx->pc,
+                                       instr.dst, utils::DstName(func, ctx->pc, instr.dst));
+    // Record the free when the last reference of the storage is gone, e.g., by Free, Kill, or
+    // overwriting the register, and then release the storage.
+    buffer = std::shared_ptr<Memory>(buffer.get(), [buffer, id](Memory*) {
+      memory_profiler::MemoryProfiler::Get()->RecordFree(id);
+    });
+  }
+  if (ctx->stream_ordered_free && buffer != nullptr && buffer->data != nullptr) {
+    ctx->alloc_epochs[buffer->data] = ctx->launch_epoch;
+  }
   auto storage = StorageValue::make(buffer);
   ctx.WriteRegister(instr.dst, storage);
   ctx->pc++;
@@ -735,8 +2174,14 @@ void VirtualMachine::HandleAllocTensor(VMContext& ctx, const Instruction& instr)
   if (instr.alloc_tensor.own) {
     mem = storage->buffer;
   }
+  auto data = static_cast<char*>(storage->buffer->data) + instr.alloc_tensor.offset;
   auto tensor = TensorValue::Assemble(storage->buffer->device, instr.alloc_tensor.dtype, shape, {},
-                                      storage->buffer->data, mem);
+                                      data, mem);
+  auto profiler = memory_profiler::MemoryProfiler::Get();
+  if (profiler->IsProfiling()) {
+    const auto& func = exec_->functions[ctx->func_index];
+    profiler->RecordTensor(storage->buffer->data, data, utils::DstName(func, ctx->pc, instr.dst));
+  }
   ctx.WriteRegister(instr.dst, tensor);
   ctx->pc++;
 }
@@ -755,8 +2200,14 @@ void VirtualMachine::HandleAllocTensorReg(VMContext& ctx, const Instruction& ins
   if (instr.alloc_tensor_reg.own) {
     mem = storage->buffer;
   }
+  auto data = static_cast<char*>(storage->buffer->data) + instr.alloc_tensor_reg.offset;
   auto tensor = TensorValue::Assemble(storage->buffer->device, instr.alloc_tensor_reg.dtype, shape,
-                                      {}, storage->buffer->data, mem);
+                                      {}, data, mem);
+  auto profiler = memory_profiler::MemoryProfiler::Get();
+  if (profiler->IsProfiling()) {
+    const auto& func = exec_->functions[ctx->func_index];
+    profiler->RecordTensor(storage->buffer->data, data, utils::DstName(func, ctx->pc, instr.dst));
+  }
   ctx.WriteRegister(instr.dst, tensor);
   ctx->pc++;
 }
@@ -780,18 +2231,55 @@ void VirtualMachine::HandleAllocClosure(VMContext& ctx, const Instruction& instr
   ctx->pc++;
 }
 
-void VirtualMachine::HandleFree(VMContext& ctx, const Instruction& instr) {
-  RegName reg = instr.free.memory;
+void VirtualMachine::FreeRegister(VMContext& ctx, RegName reg) {
   auto reg_val = ctx.ReadRegister(reg);
+  std::shared_ptr<memory_pool::Memory> memory;
   if (reg_val->IsInstance<StorageValueObj>()) {
     auto storage_val = Downcast<StorageValue>(reg_val);
-    storage_val->buffer.reset();
+    memory = std::move(storage_val->buffer);
   } else {
     CHECK(reg_val->IsInstance<TensorValueObj>())
         << "Expected StorageValue or TensorValue, but got " << reg_val->GetTypeKey();
     auto tensor_val = Downcast<TensorValue>(reg_val);
-    tensor_val->mem.reset();
+    memory = std::move(tensor_val->mem);
+  }
+  if (ctx->stream_ordered_free && memory != nullptr) {
+    FreeAfterStreams(ctx, std::move(memory));
+  }
+}
+
+void VirtualMachine::FreeAfterStreams(VMContext& ctx, std::shared_ptr<memory_pool::Memory> memory) {
+  uint64_t alloc_epoch = 0;
+  auto it = ctx->alloc_epochs.find(memory->data);
+  if (it != ctx->alloc_epochs.end()) {
+    alloc_epoch = it->second;
+    ctx->alloc_epochs.erase(it);
+  }
+  if (memory->device.device_type() != DevType::kCUDA()) {
+    return;
+  }
+  // An event per stream launched since the allocation, or since the run started if the memory is
+  // not allocated by this run, e.g., the tensor of an input.
+  Index device_id = ctx->current_device_id;
+  auto api = DeviceAPI::Get(DevType::kCUDA());
+  std::vector<std::shared_ptr<Event>> events;
+  for (size_t i = 0; i < ctx->stream_launch_epochs.size(); ++i) {
+    if (ctx->stream_launch_epochs[i] > alloc_epoch) {
+      auto stream = utils::GetStreamById(ctx, device_id, i);
+      events.push_back(EventPool::Get(memory->device)->GetEvent(0x02 /*cudaEventDisableTiming*/));
+      api->EventRecordOnStream(events.back()->data(), stream->data());
+    }
   }
+  memory_pool::Memory::FreeAfter(std::move(memory), std::move(events));
+}
+
+void VirtualMachine::HandleFree(VMContext& ctx, const Instruction& instr) {
+  FreeRegister(ctx, instr.free.memory);
+  ctx->pc++;
+}
+
+void VirtualMachine::HandleKill(VMContext& ctx, const Instruction& instr) {
+  ctx.WriteRegister(instr.kill.reg, Value());
   ctx->pc++;
 }
 
@@ -800,6 +2288,7 @@ void VirtualMachine::HandleInvokeFunc(VMContext& ctx, const Instruction& instr)
   for (Index i = 0; i < instr.invoke_func.num_args; ++i) {
     args.push_back(ctx.ReadRegister(instr.invoke_func.args[i]));
   }
+  LoadFunction(instr.invoke_func.func_index);
   ctx.PushFrame(instr.invoke_func.func_index, args, instr.dst);
 }
 
@@ -812,6 +2301,7 @@ void VirtualMachine::HandleInvokeClosure(VMContext& ctx, const Instruction& inst
   for (Index i = 0; i < instr.invoke_closure.num_args; ++i) {
     args.push_back(ctx.ReadRegister(instr.invoke_closure.args[i]));
   }
+  LoadFunction(closure->func_index);
   ctx.PushFrame(closure->func_index, args, instr.dst);
 }
 
@@ -822,22 +2312,60 @@ void VirtualMachine::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   std::string op_env_cache_key;
 
   std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
-  if (!dryrun_) {  // Skip the execution in dryrun mode
+  if (!dryrun_ && !ctx->build_only) {  // Skip the execution in dryrun mode
+    static auto* launches = metrics::MetricsRegistry::Get()->GetCounter(
+        "raf_vm_op_launches_total", "The number of the ops launched by the VMs.");
+    launches->Add();
 #ifdef RAF_USE_CUDA
     if (use_cuda_) {
-      WITH_CUDA_PROFILER(
-          devices_[0],
-          utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data(),
-          op_env->name(), utils::GetStreamName(ctx->current_stream_id), {op_env_cache_key},
-          { op_env->Execute(inputs, output); });
+      void* stream =
+          utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+      if (l2_persistence_) {
+        RegName hot_reg = l2_persistence_->GetBegin(ctx->func_index, ctx->pc);
+        if (hot_reg >= 0) {
+          l2_persistence_->Begin(ctx.ReadRegister(hot_reg), stream);
+        }
+      }
+      // CUPTI sees the kernels launched inside the libraries, e.g., cuDNN, cuBLAS and NCCL, and
+      // attributes them to this instruction.
+      WITH_CUPTI_CORRELATION(ctx->func_index, ctx->pc, op_env->name(), {
+        WITH_CUDA_PROFILER(devices_[0], stream, op_env->name(),
+                           utils::GetStreamName(ctx->current_stream_id), {op_env_cache_key},
+                           { op_env->Execute(inputs, output); });
+      });
+      if (l2_persistence_ && l2_persistence_->IsEnd(ctx->func_index, ctx->pc)) {
+        l2_persistence_->End(stream);
+      }
     } else
 #endif
     {  // cpu
       WITH_BASE_PROFILER(devices_[0], op_env->name(), "ComputationOperator", {op_env_cache_key},
                          { op_env->Execute(inputs, output); });
     }
+    if (numerics_watchdog_) {
+      void* stream = nullptr;
+#ifdef RAF_USE_CUDA
+      if (use_cuda_) {
+        stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+      }
+#endif
+      numerics_watchdog_->Check(op_env->name(), output, ctx->func_index, ctx->pc, stream);
+    }
+    if (ctx->prefetch_managed_memory) {
+      // Migrate the inputs of the next op in bulk after this one, instead of by page faults.
+      PrefetchNextOp(ctx);
+    }
+    if (ctx->stream_ordered_free) {
+      utils::RecordLaunch(ctx, ctx->current_stream_id);
+    }
   }
   PROFILE_MEMORY(devices_[0], op_env->name());
+  if (memory_profiler::MemoryProfiler::Get()->IsProfiling()) {
+    std::vector<const void*> outputs;
+    utils::CollectTensorData(output, &outputs);
+    memory_profiler::MemoryProfiler::Get()->RecordOp(devices_[0], op_env->name(), outputs);
+  }
+  memory_pool::Memory::RecordTag(devices_[0], op_env->memory_tag);
 
   // Release workspace memory.
   // TODO(yaoyaoding): It seems that we can not release the workspace once we launched the
@@ -863,10 +2391,45 @@ void VirtualMachine::HandleSetShape(VMContext& ctx, const Instruction& instr) {
       shape.push_back(Downcast<IntValue>(tuple->fields[i])->value);
     }
   } else {
+#ifdef RAF_USE_CUDA
+    const auto* shape_tensor = raw_shape.as<TensorValueObj>();
+    if (!enable_cuda_graph_ && shape_tensor != nullptr &&
+        shape_tensor->tensor->device.device_type == kDLCUDA) {
+      // The actual shape written by an upper-bound op is copied to the pinned memory on the
+      // stream of the op, and the copy is only waited when the register is read, so the host
+      // keeps issuing the instructions in between instead of synchronizing the device here.
+      const DLTensor* src = shape_tensor->tensor.operator->();
+      Device dev(DevType::kCUDA(), static_cast<int>(ctx->current_device_id));
+      Device pinned(DevType::kCUDAHost(), 0);
+      auto mem = memory_pool::Memory::Alloc(pinned, tvm::runtime::GetDataSize(*src));
+      auto host_shape =
+          TensorValue::Assemble(pinned, DType(src->dtype), std::vector<int64_t>{src->shape[0]}, {},
+                                mem->data, mem);
+      auto api = DeviceAPI::Get(DevType::kCUDA());
+      auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
+      api->CopyDataFromTo(const_cast<DLTensor*>(src), host_shape->tensor.operator->(),
+                          stream->data());
+      auto copied = EventPool::Get(dev)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+      api->EventRecordOnStream(copied->data(), stream->data());
+      ctx.WriteRegister(instr.dst, data);
+      ctx->frames.back().pending_shapes[instr.dst] = {data, host_shape, copied};
+      ctx->pc++;
+      return;
+    }
+#endif
     raw_shape = CopyTo(raw_shape, Device(DevType::kCPU(), 0));
     shape = common::shape_utils::GetShapeVecFromData(raw_shape);
   }
-  ctx.WriteRegister(instr.dst, data.CreateView(shape));
+  if (instr.set_shape.offset == 0) {
+    ctx.WriteRegister(instr.dst, data.CreateView(shape));
+  } else {
+    // The view of the contiguous elements starting at the offset, e.g., a slice or a split.
+    const DLTensor* dl = data->tensor.operator->();
+    int64_t nbytes = (dl->dtype.bits * dl->dtype.lanes + 7) / 8;
+    void* ptr = static_cast<char*>(dl->data) + dl->byte_offset + instr.set_shape.offset * nbytes;
+    ctx.WriteRegister(instr.dst,
+                      TensorValue::make(data->tensor.CreateView(shape, {}, ptr), data->mem));
+  }
   ctx->pc++;
 }
 
@@ -889,8 +2452,36 @@ void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
   for (Index i = 0; i < instr.infer_type.num_args; i++) {
     args.push_back(ctx.ReadRegister(instr.infer_type.args[i]));
   }
-  // infer type
   const Value& callee = ctx.ReadRegister(instr.infer_type.op_reg);
+  // Look up the result of the same shape signature, where the constants are skipped since they
+  // are the same for the pc. The closures made at runtime are not cached by their addresses.
+  HashKey key;
+  bool cacheable = ctx.IsConst(instr.infer_type.op_reg) || callee->IsInstance<OpValueObj>();
+  if (const auto* opv = callee.as<OpValueObj>()) {
+    key << reinterpret_cast<uint64_t>(opv->op.get());
+  }
+  for (Index i = 0; i < instr.infer_type.num_args && cacheable; i++) {
+    if (!ctx.IsConst(instr.infer_type.args[i])) {
+      cacheable = utils::AppendShapeSignature(args[i], &key);
+    }
+  }
+  auto& infer_type_cache = infer_type_cache_[ctx->func_index];
+  CacheKeyView cache_key(key, ctx->pc);
+  static auto* hits = metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_vm_infer_type_cache_total", "The lookups of the InferType caches of the VMs.",
+      {{"result", "hit"}});
+  static auto* misses = metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_vm_infer_type_cache_total", "The lookups of the InferType caches of the VMs.",
+      {{"result", "miss"}});
+  Value cached;
+  if (cacheable && infer_type_cache->Get(cache_key, &cached)) {
+    hits->Add();
+    ctx.WriteRegister(instr.dst, cached);
+    ctx->pc++;
+    return;
+  }
+  misses->Add();
+  // infer type
   Type ret_type;
   Array<Value> ret_tup;
   if (const auto* opv = callee.as<OpValueObj>()) {
@@ -930,7 +2521,13 @@ void VirtualMachine::HandleInferType(VMContext& ctx, const Instruction& instr) {
   } else {
     LOG(FATAL) << "Unknown type " << ret_type->_type_key;
   }
-  ctx.WriteRegister(instr.dst, TupleValue::make(ret_tup));
+  Value ret = TupleValue::make(ret_tup);
+  if (cacheable) {
+    // The result is immutable, so it is shared by the contexts. The inferred closure is also
+    // reused, so its OpEnv is not dispatched again.
+    ret = infer_type_cache->Set(cache_key, ret);
+  }
+  ctx.WriteRegister(instr.dst, ret);
   ctx->pc++;
 }
 
@@ -938,7 +2535,7 @@ void VirtualMachine::HandleCudaSetStream(VMContext& ctx, const Instruction& inst
   Index device_id = instr.cuda_set_stream.device_id;
   Index stream_id = instr.cuda_set_stream.stream_id;
   Device device(DevType::kCUDA(), static_cast<int>(device_id));
-  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
+  auto stream = utils::GetStreamById(ctx, device_id, stream_id, instr.cuda_set_stream.priority);
   OpEnv::SetStreamForAllBackends(device, stream->data());
   ctx->current_device_id = device_id;
   ctx->current_stream_id = stream_id;
@@ -992,129 +2589,421 @@ void VirtualMachine::HandleCudaStreamBarrier(VMContext& ctx, const Instruction&
    * We can also use cudaDeviceSynchronize() to implement the stream barrier op, but this function
    * would block the host thread, which may hurt the performance.
    */
-  api->EventRecordOnStream(ctx->barrier_events[ctx->current_barrier_event_index]->data(),
-                           nullptr /* default stream */);
+  Index device_id = ctx->current_device_id;
+  auto stream = utils::GetStreamById(ctx, device_id, 0);
+  auto barrier = ctx->barrier_events[ctx->current_barrier_event_index];
+  if (stream->data() == nullptr) {
+    api->EventRecordOnStream(barrier->data(), nullptr /* default stream */);
+    ctx->pc++;
+    return;
+  }
+  // When capturing a CUDA graph, the default stream of the schedule is the graph stream, which
+  // does not synchronize with the other streams implicitly, so the barrier joins the other
+  // streams into the graph stream and forks them from the barrier explicitly.
+  auto& streams = ctx->streams[device_id];
+  for (size_t i = 1; i < streams.size(); ++i) {
+    if (streams[i] != nullptr) {
+      auto join = utils::GetStreamEvent(ctx, device_id, i);
+      api->EventRecordOnStream(join->data(), streams[i]->data());
+      api->StreamWaitEvent(stream->data(), join->data());
+    }
+  }
+  api->EventRecordOnStream(barrier->data(), stream->data());
+  for (size_t i = 1; i < streams.size(); ++i) {
+    if (streams[i] != nullptr) {
+      api->StreamWaitEvent(streams[i]->data(), barrier->data());
+    }
+  }
   ctx->pc++;
 }
 
-std::tuple<std::shared_ptr<OpEnv>, std::vector<Value>, Value, std::string>
-VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
-  Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
-  Array<Value> args;
-  Value output;
+void VirtualMachine::HandleInvokeJitFree(VMContext& ctx, const Instruction& instr) {
+  // HandleInvokeJit advances the pc, and the fused Free instructions do not touch it.
+  HandleInvokeJit(ctx, instr);
+  const RegName* frees = instr.invoke_jit.args + instr.invoke_jit.arity;
+  for (Index i = 0; i < instr.invoke_jit.num_frees; ++i) {
+    FreeRegister(ctx, frees[i]);
+  }
+}
 
-  // extract the input args and prepare the hash key to query op env
-  std::ostringstream os;
-  for (Index i = 0; i < num_inputs; i++) {
-    Index reg_idx = instr.invoke_jit.args[i];
-    auto reg = ctx.ReadRegister(reg_idx);
-    args.push_back(reg);
-    if (ctx.IsConst(reg_idx)) {
-      // Skip constatnts in the hash key
-      continue;
+void VirtualMachine::HandleCudaSetStreamWait(VMContext& ctx, const Instruction& instr) {
+  Index device_id = instr.cuda_set_stream_wait.device_id;
+  Index stream_id = instr.cuda_set_stream_wait.stream_id;
+  Device device(DevType::kCUDA(), static_cast<int>(device_id));
+  auto stream = utils::GetStreamById(ctx, device_id, stream_id);
+  OpEnv::SetStreamForAllBackends(device, stream->data());
+  ctx->current_device_id = device_id;
+  ctx->current_stream_id = stream_id;
+
+  Index wait_stream_id = instr.cuda_set_stream_wait.wait_stream_id;
+  auto wait_stream =
+      wait_stream_id == -1 ? stream : utils::GetStreamById(ctx, device_id, wait_stream_id);
+  auto event = utils::GetEventById(ctx, device_id, instr.cuda_set_stream_wait.event_id);
+  DeviceAPI::Get(DevType::kCUDA())->StreamWaitEvent(wait_stream->data(), event->data());
+  ctx->pc++;
+}
+
+void VirtualMachine::HandleInvokeJitAsync(VMContext& ctx, const Instruction& instr) {
+#ifdef RAF_USE_CUDA
+  if (use_cuda_) {
+    Index device_id = ctx->current_device_id;
+    auto api = DeviceAPI::Get(DevType::kCUDA());
+    auto stream = utils::GetStreamById(ctx, device_id, ctx->current_stream_id);
+    auto comm_stream = utils::GetStreamById(ctx, device_id, kCudaCommunicate);
+    // The collective starts after the work issued so far on the current stream, which produces
+    // its inputs, but the current stream does not wait for it until the Wait of the handle.
+    auto ready = utils::GetStreamEvent(ctx, device_id, ctx->current_stream_id);
+    api->EventRecordOnStream(ready->data(), stream->data());
+    api->StreamWaitEvent(comm_stream->data(), ready->data());
+    // HandleInvokeJit advances the pc.
+    HandleInvokeJit(ctx, instr);
+    if (ctx->stream_ordered_free) {
+      utils::RecordLaunch(ctx, kCudaCommunicate);
     }
-    if (auto tensor = reg.as<TensorValueObj>()) {
-      utils::TensorRepr(os, tensor);
-    } else if (auto tup = reg.as<TupleValueObj>()) {
-      os << "(";
-      for (auto field : tup->fields) {
-        auto t = field.as<TensorValueObj>();
-        if (t != nullptr) {
-          utils::TensorRepr(os, t);
-        }
-        os << ",";
+    auto done = utils::GetStreamEvent(ctx, device_id, kCudaCommunicate);
+    api->EventRecordOnStream(done->data(), comm_stream->data());
+    ctx.WriteRegister(instr.dst, CollectiveHandleValue::make(done));
+    return;
+  }
+#endif
+  // The collectives run synchronously without CUDA, so the handle is always complete.
+  HandleInvokeJit(ctx, instr);
+  ctx.WriteRegister(instr.dst, CollectiveHandleValue::make(nullptr));
+}
+
+void VirtualMachine::HandleWait(VMContext& ctx, const Instruction& instr) {
+  auto handle = Downcast<CollectiveHandleValue>(ctx.ReadRegister(instr.wait.handle));
+  if (handle->event != nullptr) {
+    auto stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id);
+    DeviceAPI::Get(DevType::kCUDA())->StreamWaitEvent(stream->data(), handle->event->data());
+  }
+  ctx->pc++;
+}
+
+OpEnvPtr VirtualMachine::GetOrCreateOpEnv(const VMContext& ctx, const Instruction& instr,
+                                          const Array<Value>& args, const Value& output,
+                                          const HashKey& op_env_cache_key) {
+  // check the OpEnv cache, where the key is hashed while it is built
+  auto& op_env_cache = op_env_cache_[ctx->func_index];
+  CacheKeyView cache_key(op_env_cache_key, ctx->pc);
+  static auto* hits = metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_vm_op_env_cache_total", "The lookups of the OpEnv caches of the VMs.",
+      {{"result", "hit"}});
+  static auto* misses = metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_vm_op_env_cache_total", "The lookups of the OpEnv caches of the VMs.",
+      {{"result", "miss"}});
+  if (auto cached = op_env_cache->Get(cache_key)) {
+    // Cache hit. Reuse the OpEnv from the cache.
+    hits->Add();
+    return cached;
+  }
+  misses->Add();
+  // Create a new OpEnv.
+  auto call_values = CallValues::make();
+  Value callee = ctx.ReadRegister(instr.invoke_jit.op_reg);
+  const auto* op = callee.as<OpValueObj>();
+  const auto* closure = callee.as<ClosureValueObj>();
+  call_values->callee = callee;
+  if (op) {
+    call_values->args = GetOpAttr<FRAFSchema>(op->op, "FRAFSchema")(args);
+  } else {
+    call_values->args = MakeListArgs(args);
+  }
+  call_values->device = devices_[0];
+  call_values->out = output;
+  if (async_compiler_) {
+    // The OpEnv being built in the background is switched in once it is built, and the fallback
+    // is used meanwhile.
+    std::string async_key(reinterpret_cast<const char*>(op_env_cache_key.data()),
+                          op_env_cache_key.size());
+    async_key += "@" + std::to_string(ctx->func_index) + ":" + std::to_string(ctx->pc);
+    bool done = false;
+    if (OpEnvPtr op_env = async_compiler_->Poll(async_key, &done)) {
+      if (!done) {
+        return op_env;
       }
-      os << ")";
-    } else {
-      LOG(FATAL) << "Unsupported non-const register type: " << reg->GetTypeKey();
+      BindRequests(ctx, op_env);
+      return op_env_cache->Set(cache_key, op_env);
+    }
+    if (OpEnvPtr fallback = async_compiler_->DispatchFallback(call_values)) {
+      // The OpEnv is built on the copies of the buffers, which may be run by the tuning.
+      Device dev = devices_[0];
+      Array<Value> compile_args;
+      for (size_t i = 0; i < args.size(); ++i) {
+        bool is_const = ctx.IsConst(instr.invoke_jit.args[i]);
+        compile_args.push_back(is_const ? args[i] : CloneForCompile(args[i], dev));
+      }
+      auto compile_call = CallValues::make();
+      compile_call->callee = callee;
+      compile_call->args = op ? GetOpAttr<FRAFSchema>(op->op, "FRAFSchema")(compile_args)
+                              : MakeListArgs(compile_args);
+      compile_call->device = dev;
+      compile_call->out = CloneForCompile(output, dev);
+      async_compiler_->Compile(async_key, fallback, [compile_call, dev]() {
+        OpEnvPtr op_env = Dispatch(compile_call);
+        // The copies are released after the kernels run by the tuning.
+        DeviceAPI::Get(dev.device_type())->WaitDevice(dev);
+        return op_env;
+      });
+      BindRequests(ctx, fallback);
+      return fallback;
+    }
+  }
+  OpEnvPtr op_env = Dispatch(call_values);
+  CHECK(op_env != nullptr) << "ValueError: Cannot dispatch "
+                           << (op ? op->op->name : PrettyPrint(closure->func)) << " @"
+                           << call_values->device.c_str();
+  BindRequests(ctx, op_env);
+  // add to cache
+  return op_env_cache->Set(cache_key, op_env);
+}
+
+void VirtualMachine::BindRequests(const VMContext& ctx, const OpEnvPtr& op_env) {
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  op_env->memory_tag = memory_pool::Memory::InternTag(op_env->name());
+  // prepare distributed requests
+  for (size_t i = 0; i < requests->distributed.size(); i++) {
+    Requests::DistributedRequest& entry = requests->distributed[i];
+    *entry.dest = (void*)(Communicator::Get(entry.name, entry.rank_list).as<CommunicatorObj>());
+  }
+#ifdef RAF_USE_CUDA
+  // prepare cuda stream requests
+  for (size_t i = 0; i < requests->stream.size(); i++) {
+    Requests::StreamRequest& entry = requests->stream[i];
+    // currently ignores the stream_idx field in requests, all requests with the same tag_idx will
+    // get the same cuda stream in vm
+    std::shared_ptr<Stream> stream =
+        utils::GetStreamById(ctx, entry.device.device_id(), entry.tag_idx);
+    *entry.dest = stream->data();
+    entry.stream = stream;
+  }
+#endif
+}
+
+void VirtualMachine::SetAsyncCompile(int num_threads,
+                                     const std::unordered_set<std::string>& dialects) {
+  if (num_threads <= 0) {
+    if (async_compiler_) {
+      async_compiler_->Wait();
     }
-    os << ",";
+    async_compiler_ = nullptr;
+    return;
+  }
+  // The fallbacks would be bound to the instructions or captured by the CUDA graphs for good.
+  CHECK(!enable_cuda_graph_) << "The OpEnvs cannot be built in the background with CUDA graphs.";
+  CHECK(!static_op_env_) << "The OpEnvs cannot be built in the background with the static OpEnvs.";
+  CHECK(!precompute_args_)
+      << "The OpEnvs cannot be built in the background with the precomputed arguments.";
+  async_compiler_ = std::make_shared<AsyncCompiler>(num_threads, dialects);
+}
+
+void VirtualMachine::SetNumericsWatchdog(bool enable, bool abort,
+                                         const std::vector<std::string>& patterns) {
+  if (!enable) {
+    numerics_watchdog_ = nullptr;
+    return;
+  }
+  // The checks would be captured into the graphs, whose steps are never read back.
+  CHECK(!enable_cuda_graph_) << "The numerics watchdog cannot be enabled with CUDA graphs.";
+  numerics_watchdog_ = std::make_shared<NumericsWatchdog>(devices_[0], patterns, abort);
+}
+
+void VirtualMachine::SetL2Persistence(int64_t max_bytes, int64_t min_reuses) {
+  CHECK(exec_) << "The executable is not loaded yet.";
+  if (max_bytes <= 0) {
+    l2_persistence_ = nullptr;
+    return;
+  }
+  if (!use_cuda_) {
+    LOG(WARNING) << "The L2 persistence is only for the CUDA devices, so it is ignored.";
+    return;
   }
+  // The graphs keep the attributes of the streams when they are captured, instead of the windows
+  // set around the instructions.
+  CHECK(!enable_cuda_graph_) << "The L2 persistence cannot be enabled with CUDA graphs.";
+  l2_persistence_ = std::make_shared<L2Persistence>(exec_, devices_[0], max_bytes, min_reuses);
+}
 
-  // extract the output
-  os << "|";
+Value VirtualMachine::ReadOutput(const VMContext& ctx, const Instruction& instr) {
+  Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
   if (instr.invoke_jit.output_size == 1) {
-    output = ctx.ReadRegister(instr.invoke_jit.args[num_inputs]);
-    utils::TensorRepr(os, output.as<TensorValueObj>());
-  } else {
-    os << "(";
-    Array<Value> outs;
-    for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
-      Value val = ctx.ReadRegister(instr.invoke_jit.args[i]);
-      outs.push_back(val);
-      utils::TensorRepr(os, val.as<TensorValueObj>());
-      os << ",";
+    return ctx.ReadRegister(instr.invoke_jit.args[num_inputs]);
+  }
+  Array<Value> outs;
+  for (Index i = num_inputs; i < instr.invoke_jit.arity; i++) {
+    outs.push_back(ctx.ReadRegister(instr.invoke_jit.args[i]));
+  }
+  return TupleValue::make(outs);
+}
+
+std::tuple<std::shared_ptr<OpEnv>, std::vector<Value>, Value, std::string>
+VirtualMachine::PrepareOpEnv(const VMContext& ctx, const Instruction& instr) {
+  Index num_inputs = instr.invoke_jit.arity - instr.invoke_jit.output_size;
+
+  // In the precomputed mode, the args are not converted or hashed again after the first run.
+  // Only the tensors read by the bound OpEnv are patched in from their registers. The profiler
+  // records the readable cache key, so it takes the full path.
+  PrecomputedCallPtr* precomputed = nullptr;
+  if (precompute_args_ && !profiler::Profiler::Get()->IsProfiling(1)) {
+    precomputed = &precomputed_calls_[ctx->func_index][ctx->pc];
+    if (PrecomputedCallPtr call = std::atomic_load(precomputed)) {
+      std::vector<Value> inputs;
+      inputs.reserve(call->input_regs.size());
+      for (Index reg : call->input_regs) {
+        inputs.push_back(ctx.ReadRegister(reg));
+      }
+      AllocWorkspace(ctx, call->op_env);
+      return std::make_tuple(call->op_env, std::move(inputs), ReadOutput(ctx, instr),
+                             std::string());
     }
-    os << ")";
-    output = TupleValue::make(outs);
   }
-  std::string op_env_cache_key = os.str();
 
-  // check the OpEnv cache
+  // extract the input args and the output
+  Array<Value> args;
+  for (Index i = 0; i < num_inputs; i++) {
+    args.push_back(ctx.ReadRegister(instr.invoke_jit.args[i]));
+  }
+  Value output = ReadOutput(ctx, instr);
+
+  // In the static OpEnv mode, the OpEnv bound to this instruction is reused without building the
+  // hash key or touching the locked cache.
   std::shared_ptr<OpEnv> op_env;
-  auto op_env_cache = op_env_cache_[ctx->func_index]->Get(ctx->pc);
-  if (auto p = op_env_cache->Get(op_env_cache_key)) {
-    // Cache hit. Reuse the OpEnv from the cache.
-    op_env = *p;
-  } else {
-    // Create a new OpEnv.
-    auto call_values = CallValues::make();
-    Value callee = ctx.ReadRegister(instr.invoke_jit.op_reg);
-    const auto* op = callee.as<OpValueObj>();
-    const auto* closure = callee.as<ClosureValueObj>();
-    call_values->callee = callee;
-    if (op) {
-      call_values->args = GetOpAttr<FRAFSchema>(op->op, "FRAFSchema")(args);
+  std::string op_env_cache_key;
+  OpEnvPtr* static_op_env = nullptr;
+  if (static_op_env_) {
+    static_op_env = &static_op_envs_[ctx->func_index][ctx->pc];
+    op_env = std::atomic_load(static_op_env);
+  }
+
+  if (op_env == nullptr) {
+    // prepare the binary hash key to query op env. Its readable form is only built for the
+    // profiler, which records it as the args of the op.
+    bool readable = profiler::Profiler::Get()->IsProfiling(1);
+    HashKey key;
+    std::ostringstream os;
+    auto add_repr = [&](const char* repr) {
+      if (readable) {
+        os << repr;
+      }
+    };
+    auto add_tensor = [&](const TensorValueObj* tensor) {
+      key << *tensor->tensor.operator->();
+      if (readable) {
+        utils::TensorRepr(os, tensor);
+      }
+    };
+    auto add_tuple = [&](const TupleValueObj* tup) {
+      key << static_cast<int64_t>(tup->fields.size());
+      add_repr("(");
+      for (auto field : tup->fields) {
+        auto t = field.as<TensorValueObj>();
+        if (t != nullptr) {
+          add_tensor(t);
+        } else {
+          key << false;
+        }
+        add_repr(",");
+      }
+      add_repr(")");
+    };
+    for (Index i = 0; i < num_inputs; i++) {
+      if (ctx.IsConst(instr.invoke_jit.args[i])) {
+        // Skip constatnts in the hash key
+        continue;
+      }
+      const auto& reg = args[i];
+      if (auto tensor = reg.as<TensorValueObj>()) {
+        add_tensor(tensor);
+      } else if (auto tup = reg.as<TupleValueObj>()) {
+        add_tuple(tup);
+      } else {
+        LOG(FATAL) << "Unsupported non-const register type: " << reg->GetTypeKey();
+      }
+      add_repr(",");
+    }
+    add_repr("|");
+    if (instr.invoke_jit.output_size == 1) {
+      add_tensor(output.as<TensorValueObj>());
     } else {
-      call_values->args = MakeListArgs(args);
-    }
-    call_values->device = devices_[0];
-    call_values->out = output;
-    op_env = Dispatch(call_values);
-    CHECK(op_env != nullptr) << "ValueError: Cannot dispatch "
-                             << (op ? op->op->name : PrettyPrint(closure->func)) << " @"
-                             << call_values->device.c_str();
-    std::shared_ptr<Requests> requests = op_env->GetRequests();
-    // prepare distributed requests
-    for (size_t i = 0; i < requests->distributed.size(); i++) {
-      Requests::DistributedRequest& entry = requests->distributed[i];
-      *entry.dest = (void*)(Communicator::Get(entry.name, entry.rank_list).as<CommunicatorObj>());
+      add_tuple(output.as<TupleValueObj>());
     }
-#ifdef RAF_USE_CUDA
-    // prepare cuda stream requests
-    for (size_t i = 0; i < requests->stream.size(); i++) {
-      Requests::StreamRequest& entry = requests->stream[i];
-      // currently ignores the stream_idx field in requests, all requests with the same tag_idx will
-      // get the same cuda stream in vm
-      std::shared_ptr<Stream> stream =
-          utils::GetStreamById(ctx, entry.device.device_id(), entry.tag_idx);
-      *entry.dest = stream->data();
-      entry.stream = stream;
+    if (readable) {
+      op_env_cache_key = os.str();
+    }
+    op_env = GetOrCreateOpEnv(ctx, instr, args, output, key);
+    if (static_op_env != nullptr) {
+      std::atomic_store(static_op_env, op_env);
     }
-#endif
-    // add to cache
-    op_env_cache->Set(op_env_cache_key, op_env);
-  }
-
-  std::shared_ptr<Requests> requests = op_env->GetRequests();
-  for (size_t i = 0; i < requests->workspace.size(); i++) {
-    Requests::WorkspaceRequest& entry = requests->workspace[i];
-    auto buf = Alloc(ctx, entry.device, entry.nbytes);
-    entry.memory = buf;
-    *entry.dest = buf->data;
   }
+  AllocWorkspace(ctx, op_env);
 
   std::vector<Value> inputs;
   for (int i : op_env->arg_indices) {
     CHECK_GE(i, 0) << "Invalid input index: " << i;
     inputs.push_back(args[i]);
   }
+  if (precomputed != nullptr) {
+    auto call = std::make_shared<PrecomputedCall>();
+    call->op_env = op_env;
+    for (int i : op_env->arg_indices) {
+      call->input_regs.push_back(instr.invoke_jit.args[i]);
+    }
+    std::atomic_store(precomputed, call);
+  }
   return std::make_tuple(op_env, std::move(inputs), std::move(output), op_env_cache_key);
 }
 
+void VirtualMachine::AllocWorkspace(const VMContext& ctx, const OpEnvPtr& op_env) {
+  std::shared_ptr<Requests> requests = op_env->GetRequests();
+  // The addresses captured by a CUDA graph must not be reused by other OpEnvs, and the work on
+  // the host is not ordered by a stream, so the workspace is only shared by CUDA OpEnvs otherwise.
+  auto align = [](int64_t nbytes) {
+    return (nbytes + kDefaultMemoryAlignment - 1) / kDefaultMemoryAlignment *
+           kDefaultMemoryAlignment;
+  };
+  bool share_workspace = !requests->workspace.empty() && !enable_cuda_graph_;
+  int64_t total_nbytes = 0;
+  for (const auto& entry : requests->workspace) {
+    share_workspace &= entry.device.device_type() == DevType::kCUDA() &&
+                       entry.device.device_id() == requests->workspace[0].device.device_id();
+    total_nbytes += align(entry.nbytes);
+  }
+  if (share_workspace) {
+    auto buf = GetSharedWorkspace(ctx, requests->workspace[0].device, total_nbytes);
+    int64_t offset = 0;
+    for (auto& entry : requests->workspace) {
+      entry.memory = buf;
+      *entry.dest = static_cast<char*>(buf->data) + offset;
+      offset += align(entry.nbytes);
+    }
+  } else {
+    for (size_t i = 0; i < requests->workspace.size(); i++) {
+      Requests::WorkspaceRequest& entry = requests->workspace[i];
+      auto buf = Alloc(ctx, entry.device, entry.nbytes);
+      entry.memory = buf;
+      *entry.dest = buf->data;
+    }
+  }
+}
+
+std::shared_ptr<Memory> VirtualMachine::GetSharedWorkspace(const VMContext& ctx, Device dev,
+                                                           int64_t nbytes) {
+  void* stream = utils::GetStreamById(ctx, ctx->current_device_id, ctx->current_stream_id)->data();
+  std::lock_guard<std::mutex> lock(workspace_mutex_);
+  auto& workspace = workspaces_[std::make_pair(dev.device_id(), stream)];
+  if (workspace.first == nullptr || workspace.second < nbytes) {
+    // The smaller arena is released in the stream order, after the work using it.
+    workspace.first = Alloc(ctx, dev, nbytes);
+    workspace.second = nbytes;
+  }
+  return workspace.first;
+}
+
 tvm::runtime::Module CreateVirtualMachine(const Executable* exec, bool enable_cuda_graph,
-                                          bool dryrun) {
-  auto vm = make_object<VirtualMachine>(enable_cuda_graph, dryrun);
+                                          bool dryrun, bool fast_dispatch, bool static_op_env,
+                                          int max_concurrency) {
+  auto vm = make_object<VirtualMachine>(enable_cuda_graph, dryrun, fast_dispatch, static_op_env,
+                                        max_concurrency);
   vm->LoadExecutable(exec);
   return tvm::runtime::Module(vm);
 }
@@ -1123,9 +3012,13 @@ RAF_REGISTER_GLOBAL("raf.vm.VirtualMachine").set_body([](tvm::TVMArgs args, tvm:
   tvm::runtime::Module mod = args[0];
   bool enable_cuda_graph = args[1];
   bool dryrun = args[2];
+  bool fast_dispatch = args[3];
+  bool static_op_env = args[4];
+  int max_concurrency = args[5];
   const auto* exec = dynamic_cast<Executable*>(mod.operator->());
   CHECK(exec) << "The virtual machine executable has not been defined yet.";
-  *rv = CreateVirtualMachine(exec, enable_cuda_graph, dryrun);
+  *rv = CreateVirtualMachine(exec, enable_cuda_graph, dryrun, fast_dispatch, static_op_env,
+                             max_concurrency);
 });
 
 }  // namespace vm
@@ -7,6 +7,8 @@
  * \file src/impl/vm/vm_debugger.cc
  * \brief The implementation for RAF virtual machine debugger.
  */
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -22,6 +24,8 @@ namespace raf {
 namespace executor {
 namespace vm {
 
+using device_api::DeviceAPI;
+
 std::string GetShapeStr(const Value& value) {
   std::stringstream ss;
   ss << "(";
@@ -49,6 +53,25 @@ std::string GetShapeStr(const Value& value) {
   return ss.str();
 }
 
+/*! \brief The shapes of the inputs and the output of an op call. */
+std::string GetOpShapeStr(const std::vector<Value>& inputs, const Value& output) {
+  std::stringstream ss;
+  ss << "[";
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (i > 0) {
+      ss << ",";
+    }
+    ss << GetShapeStr(inputs[i]);
+  }
+  ss << "]";
+  ss << "," << GetShapeStr(output);
+  return ss.str();
+}
+
+VMDebugger::~VMDebugger() {
+  FreeRing();
+}
+
 PackedFunc VMDebugger::GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) {
   if (name == "get_interm_tensors") {
     return PackedFunc([sptr_to_self, this](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
@@ -64,6 +87,38 @@ PackedFunc VMDebugger::GetFunction(const std::string& name, const ObjectPtr<Obje
       ICHECK_EQ(args.size(), 1U);
       VMContext ctx = args[0];
       *rv = Run(ctx);
+      if (timing_only_) {
+        DrainTimings();
+      }
+    });
+  } else if (name == "set_timing_mode") {
+    return PackedFunc([sptr_to_self, this](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
+      ICHECK_EQ(args.size(), 2U);
+      bool timing_only = args[0];
+      int64_t capacity = args[1];
+      CHECK_GT(capacity, 0) << "The ring of the timing events cannot be empty";
+      DrainTimings();
+      FreeRing();
+      timing_only_ = timing_only;
+      ring_capacity_ = capacity;
+    });
+  } else if (name == "get_op_latency") {
+    return PackedFunc([sptr_to_self, this](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
+      ICHECK_EQ(args.size(), 0U);
+      DrainTimings();
+      auto to_float = [](double value) { return FloatImm(DataType::Float(64), value); };
+      Array<ObjectRef> res;
+      for (const auto& lat : latencies_) {
+        Map<String, ObjectRef> item;
+        item.Set("name", String(lat.name));
+        item.Set("shapes", String(lat.shapes));
+        item.Set("count", Integer(lat.count));
+        item.Set("total_ms", to_float(lat.total_ms));
+        item.Set("min_ms", to_float(lat.count > 0 ? lat.min_ms : 0));
+        item.Set("max_ms", to_float(lat.max_ms));
+        res.push_back(item);
+      }
+      *rv = res;
     });
   } else if (name == "reset") {
     return PackedFunc([sptr_to_self, this](tvm::TVMArgs args, tvm::TVMRetValue* rv) {
@@ -72,6 +127,9 @@ PackedFunc VMDebugger::GetFunction(const std::string& name, const ObjectPtr<Obje
       op_names_.clear();
       op_inputs_.clear();
       op_outputs_.clear();
+      DrainTimings();
+      op_index_.clear();
+      latencies_.clear();
       for (auto op_env_cache : op_env_cache_) {
         op_env_cache->Clear();
       }
@@ -82,6 +140,10 @@ PackedFunc VMDebugger::GetFunction(const std::string& name, const ObjectPtr<Obje
 }
 
 void VMDebugger::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
+  if (timing_only_) {
+    HandleInvokeJitTiming(ctx, instr);
+    return;
+  }
   OpEnvPtr op_env;
   std::vector<Value> inputs;
   Value output;
@@ -93,18 +155,7 @@ void VMDebugger::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
 
   if (op_invokes_.find(op_env.get()) == op_invokes_.end()) {
     op_invokes_[op_env.get()] = 0;
-
-    std::stringstream ss;
-    ss << "[";
-    for (size_t i = 0; i < inputs.size(); ++i) {
-      if (i > 0) {
-        ss << ",";
-      }
-      ss << GetShapeStr(inputs[i]);
-    }
-    ss << "]";
-    ss << "," << GetShapeStr(output);
-    op_shapes_[op_env.get()] = ss.str();
+    op_shapes_[op_env.get()] = GetOpShapeStr(inputs, output);
   }
   op_invokes_[op_env.get()]++;
 
@@ -118,6 +169,100 @@ void VMDebugger::HandleInvokeJit(VMContext& ctx, const Instruction& instr) {
   op_names_.push_back(op_env->name());
 }
 
+void VMDebugger::HandleInvokeJitTiming(VMContext& ctx, const Instruction& instr) {
+  OpEnvPtr op_env;
+  std::vector<Value> inputs;
+  Value output;
+  std::string op_env_cache_key;
+
+  std::tie(op_env, inputs, output, op_env_cache_key) = PrepareOpEnv(ctx, instr);
+  auto it = op_index_.find(op_env.get());
+  if (it == op_index_.end()) {
+    it = op_index_.emplace(op_env.get(), static_cast<int>(latencies_.size())).first;
+    OpLatency lat;
+    lat.name = op_env->name();
+    lat.shapes = GetOpShapeStr(inputs, output);
+    latencies_.push_back(lat);
+  }
+  const Device& dev = devices_[0];
+  if (dev.device_type() == DevType::kCUDA()) {
+    auto device_api = DeviceAPI::Get(DevType::kCUDA());
+    TimingSlot& slot = NextSlot(dev);
+    slot.op = it->second;
+    // The ops read the current stream from the device API, so the events enclose their kernels.
+    void* stream = device_api->GetStream();
+    device_api->EventRecordOnStream(slot.start, stream);
+    op_env->Execute(inputs, output);
+    device_api->EventRecordOnStream(slot.end, stream);
+  } else {
+    auto start = std::chrono::steady_clock::now();
+    op_env->Execute(inputs, output);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    AddLatency(it->second, elapsed.count());
+  }
+  ctx->pc++;
+}
+
+VMDebugger::TimingSlot& VMDebugger::NextSlot(const Device& dev) {
+  if (ring_.empty()) {
+    auto device_api = DeviceAPI::Get(dev.device_type());
+    ring_device_ = dev;
+    ring_.resize(ring_capacity_);
+    for (auto& slot : ring_) {
+      slot.start = device_api->CreateEvent(dev);
+      slot.end = device_api->CreateEvent(dev);
+    }
+  }
+  TimingSlot& slot = ring_[ring_head_];
+  if (ring_pending_ == ring_.size()) {
+    // The ring is full and the head is the oldest slot, which is likely done already.
+    auto device_api = DeviceAPI::Get(ring_device_.device_type());
+    device_api->WaitEvent(slot.end);
+    AddLatency(slot.op, device_api->EventElapsedTimeInMilliSeconds(slot.start, slot.end));
+    ring_pending_--;
+  }
+  ring_head_ = (ring_head_ + 1) % ring_.size();
+  ring_pending_++;
+  return slot;
+}
+
+void VMDebugger::DrainTimings() {
+  if (ring_pending_ == 0) {
+    return;
+  }
+  auto device_api = DeviceAPI::Get(ring_device_.device_type());
+  size_t first = (ring_head_ + ring_.size() - ring_pending_) % ring_.size();
+  // Wait for all the streams once instead of for each event.
+  device_api->WaitDevice(ring_device_);
+  for (size_t i = 0; i < ring_pending_; ++i) {
+    const TimingSlot& slot = ring_[(first + i) % ring_.size()];
+    AddLatency(slot.op, device_api->EventElapsedTimeInMilliSeconds(slot.start, slot.end));
+  }
+  ring_pending_ = 0;
+}
+
+void VMDebugger::AddLatency(int op, double ms) {
+  OpLatency& lat = latencies_[op];
+  lat.count++;
+  lat.total_ms += ms;
+  lat.min_ms = std::min(lat.min_ms, ms);
+  lat.max_ms = std::max(lat.max_ms, ms);
+}
+
+void VMDebugger::FreeRing() {
+  if (ring_.empty()) {
+    return;
+  }
+  auto device_api = DeviceAPI::Get(ring_device_.device_type());
+  for (auto& slot : ring_) {
+    device_api->FreeEvent(ring_device_, slot.start);
+    device_api->FreeEvent(ring_device_, slot.end);
+  }
+  ring_.clear();
+  ring_head_ = 0;
+  ring_pending_ = 0;
+}
+
 tvm::runtime::Module CreateVMDebugger(const Executable* exec) {
   auto vm = make_object<VMDebugger>();
   vm->LoadExecutable(exec);
@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -25,12 +26,57 @@ class VMDebugger : public VirtualMachine {
   VMDebugger() : VirtualMachine(false, false) {
   }
 
+  ~VMDebugger();
+
   PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
 
  protected:
   void HandleInvokeJit(VMContext& ctx, const Instruction& instr) final;
 
  private:
+  /*! \brief The start and end events of an op launch to time, and the index of the op. */
+  struct TimingSlot {
+    void* start = nullptr;
+    void* end = nullptr;
+    int op = -1;
+  };
+
+  /*! \brief The latency of an op env aggregated over its launches. */
+  struct OpLatency {
+    std::string name;
+    std::string shapes;
+    int64_t count = 0;
+    double total_ms = 0;
+    double min_ms = std::numeric_limits<double>::max();
+    double max_ms = 0;
+  };
+
+  /*!
+   * \brief Time the op launch without capturing the values. On CUDA, the launch is enclosed by a
+   * pair of events in the ring, which are only read after the run or when the ring is full.
+   */
+  void HandleInvokeJitTiming(VMContext& ctx, const Instruction& instr);
+  /*! \brief Get the next slot of the ring, reading the oldest one if the ring is full. */
+  TimingSlot& NextSlot(const Device& dev);
+  /*! \brief Read the elapsed time of all the recorded slots, which waits for them. */
+  void DrainTimings();
+  /*! \brief Add the latency of a launch to its op. */
+  void AddLatency(int op, double ms);
+  /*! \brief Free the events of the ring. */
+  void FreeRing();
+
+  /*! \brief Whether to only time the ops instead of capturing their inputs and outputs. */
+  bool timing_only_ = false;
+  /*! \brief The number of the slots of the ring, i.e., the launches timed without a host sync. */
+  int64_t ring_capacity_ = 4096;
+  /*! \brief The ring of the events, the next slot, and the number of the slots not read yet. */
+  std::vector<TimingSlot> ring_;
+  Device ring_device_;
+  size_t ring_head_ = 0;
+  size_t ring_pending_ = 0;
+  /*! \brief The index of each op env in latencies_, which are in the first invoke order. */
+  std::unordered_map<OpEnv*, int> op_index_;
+  std::vector<OpLatency> latencies_;
   /*! \brief the number of times of op call */
   std::unordered_map<OpEnv*, int> op_invokes_;
   /*! \brief the input and output shape string of op call */
@@ -0,0 +1,222 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/weight_streamer.cc
+ * \brief Stream the weights of a model larger than the device memory from the pinned host memory.
+ */
+#include <tvm/runtime/device_api.h>
+#include <algorithm>
+#include <cstring>
+
+#include "raf/device_api.h"
+#include "./weight_streamer.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using device_api::DeviceAPI;
+using memory_pool::Memory;
+
+/*! \brief The alignment of the regions in the buffer. */
+constexpr int64_t kRegionAlignment = 256;
+
+/*! \brief The device memory of a slot, which releases the slot when it is destroyed. */
+class StreamedMemory final : public Memory {
+ public:
+  StreamedMemory(std::shared_ptr<WeightStreamer> streamer, uint64_t id, void* data)
+      : streamer_(std::move(streamer)), id_(id) {
+    this->data = data;
+    this->device = streamer_->device_;
+  }
+
+  ~StreamedMemory() {
+    streamer_->Release(id_);
+  }
+
+ private:
+  /*! \brief The streamer, which also keeps the buffer alive. */
+  std::shared_ptr<WeightStreamer> streamer_;
+  /*! \brief The serial number of the slot. */
+  uint64_t id_;
+};
+
+WeightStreamer::WeightStreamer(const Executable* exec, const Device& device, int64_t buffer_bytes,
+                               int64_t min_bytes)
+    : device_(device), capacity_(buffer_bytes) {
+  Device pinned(DevType::kCUDAHost(), 0);
+  for (size_t i = 0; i < exec->constants.size(); ++i) {
+    const auto* tensor = exec->constants[i].as<TensorValueObj>();
+    if (tensor == nullptr || tensor->tensor->device.device_type != kDLCPU) {
+      continue;
+    }
+    const DLTensor* src = tensor->tensor.operator->();
+    int64_t nbytes = tvm::runtime::GetDataSize(*src);
+    if (nbytes < min_bytes || !tvm::runtime::IsContiguous(*src)) {
+      continue;
+    }
+    std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+    auto mem = Memory::Alloc(pinned, nbytes);
+    std::memcpy(mem->data, static_cast<const char*>(src->data) + src->byte_offset, nbytes);
+    host_[i] = TensorValue::Assemble(pinned, DType(src->dtype), shape, {}, mem->data, mem);
+  }
+  // The load order of the constants, where a constant loaded more than once keeps the first. The
+  // functions of a loaded executable are decoded here, since their instructions are decoded lazily.
+  for (size_t func = 0; func < exec->functions.size(); ++func) {
+    auto& order = orders_[func];
+    auto& positions = positions_[func];
+    for (const auto& instr : exec->GetVMFunction(func).instructions) {
+      if (instr.op == Opcode::LoadConst && IsStreamed(instr.const_index) &&
+          !positions.count(instr.const_index)) {
+        positions[instr.const_index] = order.size();
+        order.push_back(instr.const_index);
+      }
+    }
+  }
+  buffer_ = Memory::Alloc(device_, capacity_);
+  copy_stream_ = Stream::Get(device_, kMemCpyCpuToCuda, 0);
+}
+
+Value WeightStreamer::Load(Index func_index, Index const_index, void* stream) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto api = DeviceAPI::Get(device_.device_type());
+  stats_.num_loads++;
+  Slot* slot = nullptr;
+  auto it = resident_.find(const_index);
+  if (it != resident_.end()) {
+    slot = FindSlot(it->second);
+    stats_.num_prefetched++;
+  } else {
+    slot = Upload(const_index);
+  }
+  std::shared_ptr<Memory> mem;
+  const DLTensor* host = Downcast<TensorValue>(host_.at(const_index))->tensor.operator->();
+  std::vector<int64_t> shape(host->shape, host->shape + host->ndim);
+  if (slot == nullptr) {
+    // The regions are held by the live tensors, so copy it to a new tensor on the compute stream.
+    stats_.num_fallbacks++;
+    stats_.uploaded_bytes += tvm::runtime::GetDataSize(*host);
+    mem = Memory::Alloc(device_, tvm::runtime::GetDataSize(*host));
+    auto ret = TensorValue::Assemble(device_, DType(host->dtype), shape, {}, mem->data, mem);
+    api->CopyDataFromTo(const_cast<DLTensor*>(host), ret->tensor.operator->(), stream);
+    lock.unlock();
+    return ret;
+  }
+  slot->stream = stream;
+  mem = Acquire(slot);
+  api->StreamWaitEvent(stream, slot->copied->data());
+  Prefetch(func_index, const_index);
+  auto ret = TensorValue::Assemble(device_, DType(host->dtype), shape, {}, mem->data, mem);
+  lock.unlock();
+  return ret;
+}
+
+WeightStreamingStats WeightStreamer::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+WeightStreamer::Slot* WeightStreamer::Upload(Index const_index) {
+  const DLTensor* host = Downcast<TensorValue>(host_.at(const_index))->tensor.operator->();
+  int64_t nbytes = tvm::runtime::GetDataSize(*host);
+  int64_t aligned = (nbytes + kRegionAlignment - 1) / kRegionAlignment * kRegionAlignment;
+  if (aligned > capacity_) {
+    return nullptr;
+  }
+  int64_t offset = slots_.empty() ? 0 : head_;
+  if (offset + aligned > capacity_) {
+    offset = 0;
+  }
+  auto overlaps = [&](const Slot& slot) {
+    return slot.offset < offset + aligned && offset < slot.offset + slot.nbytes;
+  };
+  // Evict the oldest slots until the region is free, which requires them to be loaded and then
+  // released. The prefetched slots are not evicted before they are loaded.
+  std::vector<std::shared_ptr<Event>> waits;
+  size_t num_evicted = 0;
+  while (std::any_of(slots_.begin() + num_evicted, slots_.end(), overlaps)) {
+    const Slot& oldest = slots_[num_evicted];
+    if (oldest.released == nullptr || !oldest.mem.expired()) {
+      return nullptr;
+    }
+    waits.push_back(oldest.released);
+    num_evicted++;
+  }
+  for (size_t i = 0; i < num_evicted; ++i) {
+    resident_.erase(slots_.front().const_index);
+    slots_.pop_front();
+  }
+
+  auto api = DeviceAPI::Get(device_.device_type());
+  void* stream = copy_stream_->data();
+  for (const auto& event : waits) {
+    api->StreamWaitEvent(stream, event->data());
+  }
+  Slot slot;
+  slot.id = next_id_++;
+  slot.const_index = const_index;
+  slot.offset = offset;
+  slot.nbytes = aligned;
+  slot.copied = EventPool::Get(device_)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+  std::vector<int64_t> shape(host->shape, host->shape + host->ndim);
+  auto dst = TensorValue::Assemble(device_, DType(host->dtype), shape, {},
+                                   static_cast<char*>(buffer_->data) + offset);
+  api->CopyDataFromTo(const_cast<DLTensor*>(host), dst->tensor.operator->(), stream);
+  api->EventRecordOnStream(slot.copied->data(), stream);
+  stats_.uploaded_bytes += nbytes;
+  head_ = offset + aligned;
+  resident_[const_index] = slot.id;
+  slots_.push_back(std::move(slot));
+  return &slots_.back();
+}
+
+void WeightStreamer::Prefetch(Index func_index, Index const_index) {
+  const auto& order = orders_.at(func_index);
+  size_t pos = positions_.at(func_index).at(const_index);
+  // Continue with the loads of the next run after the last one.
+  for (size_t i = 1; i < order.size(); ++i) {
+    Index next = order[(pos + i) % order.size()];
+    if (!resident_.count(next) && Upload(next) == nullptr) {
+      break;
+    }
+  }
+}
+
+std::shared_ptr<Memory> WeightStreamer::Acquire(Slot* slot) {
+  auto mem = slot->mem.lock();
+  if (mem == nullptr) {
+    mem = std::make_shared<StreamedMemory>(shared_from_this(), slot->id,
+                                           static_cast<char*>(buffer_->data) + slot->offset);
+    slot->mem = mem;
+  }
+  return mem;
+}
+
+void WeightStreamer::Release(uint64_t id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Slot* slot = FindSlot(id);
+  if (slot == nullptr) {
+    return;
+  }
+  if (slot->released == nullptr) {
+    slot->released = EventPool::Get(device_)->GetEvent(0x02 /*cudaEventDisableTiming*/);
+  }
+  // The kernels reading the tensor are launched on the compute stream before it is released.
+  DeviceAPI::Get(device_.device_type())->EventRecordOnStream(slot->released->data(), slot->stream);
+}
+
+WeightStreamer::Slot* WeightStreamer::FindSlot(uint64_t id) {
+  for (auto& slot : slots_) {
+    if (slot.id == id) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
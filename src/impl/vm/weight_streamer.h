@@ -0,0 +1,146 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/impl/vm/weight_streamer.h
+ * \brief Stream the weights of a model larger than the device memory from the pinned host memory.
+ */
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "raf/device.h"
+#include "raf/event_pool.h"
+#include "raf/memory_pool.h"
+#include "raf/stream_pool.h"
+#include "raf/value.h"
+#include "raf/vm/executable.h"
+
+namespace raf {
+namespace executor {
+namespace vm {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*! \brief The stats of the weight streaming. */
+struct WeightStreamingStats {
+  /*! \brief The number of the loads of the streamed constants. */
+  int64_t num_loads = 0;
+  /*! \brief The number of the loads whose uploads were prefetched or are still resident. */
+  int64_t num_prefetched = 0;
+  /*! \brief The number of the loads that did not fit into the buffer and were copied in place. */
+  int64_t num_fallbacks = 0;
+  /*! \brief The bytes uploaded to the device. */
+  int64_t uploaded_bytes = 0;
+};
+
+/*!
+ * \brief Keep the large tensor constants, i.e., the weights, in the pinned host memory, and stream
+ * them into a rotating device buffer right before they are loaded. The constants are prefetched in
+ * the order they are loaded by each function, which is the liveness order of the weights, on the
+ * copy stream shared with the input staging, and the compute stream waits for the upload by an
+ * event. A region of the buffer is reused once the device tensor in it is released by the VM,
+ * i.e., its register is overwritten or freed, so the compute stream records an event that the
+ * copy stream waits for before overwriting the region. As many following constants as fit into
+ * the buffer are prefetched, and the loads of the next run are prefetched at the end of a run.
+ */
+class WeightStreamer : public std::enable_shared_from_this<WeightStreamer> {
+ public:
+  /*!
+   * \brief Create the streamer, which copies the streamed constants to the pinned host memory.
+   * \param exec The executable.
+   * \param device The device.
+   * \param buffer_bytes The bytes of the rotating device buffer.
+   * \param min_bytes The min bytes of a streamed constant. The smaller ones stay on the device.
+   */
+  WeightStreamer(const Executable* exec, const Device& device, int64_t buffer_bytes,
+                 int64_t min_bytes);
+
+  /*! \brief Whether the constant is streamed. */
+  bool IsStreamed(Index const_index) const {
+    return host_.count(const_index) > 0;
+  }
+
+  /*!
+   * \brief Load a streamed constant for the LoadConst of a function, and prefetch the following
+   * ones. The compute stream waits for its upload.
+   * \param func_index The function.
+   * \param const_index The constant.
+   * \param stream The compute stream.
+   * \return The device tensor, which holds its region of the buffer until it is released.
+   */
+  Value Load(Index func_index, Index const_index, void* stream);
+
+  /*! \brief Get the stats. */
+  WeightStreamingStats GetStats();
+
+ private:
+  friend class StreamedMemory;
+
+  /*! \brief A constant uploaded to a region of the buffer. */
+  struct Slot {
+    /*! \brief The serial number of the slot. */
+    uint64_t id;
+    /*! \brief The constant. */
+    Index const_index;
+    /*! \brief The offset and the bytes of the region. */
+    int64_t offset, nbytes;
+    /*! \brief The event recorded on the copy stream after the upload. */
+    std::shared_ptr<Event> copied;
+    /*! \brief The event recorded on the compute stream when the device tensor is released. */
+    std::shared_ptr<Event> released;
+    /*! \brief The compute stream of the last load. */
+    void* stream = nullptr;
+    /*! \brief The device memory handed out for the slot, if it is not released. */
+    std::weak_ptr<memory_pool::Memory> mem;
+  };
+
+  /*! \brief Upload a constant to a new slot, or return nullptr if the buffer is full. */
+  Slot* Upload(Index const_index);
+  /*! \brief Prefetch the constants loaded after the given one by the function. */
+  void Prefetch(Index func_index, Index const_index);
+  /*! \brief Hand out the device memory of a slot. */
+  std::shared_ptr<memory_pool::Memory> Acquire(Slot* slot);
+  /*! \brief Release the device memory of a slot, which is called by its destructor. */
+  void Release(uint64_t id);
+  /*! \brief Find the slot of the serial number, or nullptr. */
+  Slot* FindSlot(uint64_t id);
+
+  /*! \brief The device. */
+  Device device_;
+  /*! \brief The pinned host copies of the streamed constants. */
+  std::unordered_map<Index, Value> host_;
+  /*! \brief The streamed constants in the order they are loaded by each function. */
+  std::unordered_map<Index, std::vector<Index>> orders_;
+  /*! \brief The position of each constant in the load order of each function. */
+  std::unordered_map<Index, std::unordered_map<Index, size_t>> positions_;
+  /*! \brief The rotating device buffer. */
+  std::shared_ptr<memory_pool::Memory> buffer_;
+  /*! \brief The bytes of the buffer. */
+  int64_t capacity_;
+  /*! \brief The offset to place the next slot. */
+  int64_t head_ = 0;
+  /*! \brief The slots in the buffer from the oldest to the newest. */
+  std::deque<Slot> slots_;
+  /*! \brief The slot of each resident constant. */
+  std::unordered_map<Index, uint64_t> resident_;
+  /*! \brief The serial number of the next slot. */
+  uint64_t next_id_ = 0;
+  /*! \brief The copy stream. */
+  std::shared_ptr<Stream> copy_stream_;
+  /*! \brief The stats. */
+  WeightStreamingStats stats_;
+  /*! \brief The mutex to access the slots. */
+  std::mutex mutex_;
+};
+
+}  // namespace vm
+}  // namespace executor
+}  // namespace raf
@@ -0,0 +1,119 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/block_allocator/block_allocator.cc
+ * \brief The paged block allocator of the KV caches
+ */
+#include <algorithm>
+#include "raf/block_allocator.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+BlockAllocator BlockAllocator::make(const Device& dev, int64_t num_layers, int64_t num_blocks,
+                                    int64_t block_size, int64_t num_heads, int64_t head_dim,
+                                    DType dtype) {
+  CHECK_GT(num_layers, 0);
+  CHECK_GT(num_blocks, 0);
+  CHECK_GT(block_size, 0);
+  CHECK_GT(num_heads, 0);
+  CHECK_GT(head_dim, 0);
+  ObjectPtr<BlockAllocatorObj> n = make_object<BlockAllocatorObj>();
+  n->device = dev;
+  n->num_blocks = num_blocks;
+  n->block_size = block_size;
+  std::vector<int64_t> shape{num_blocks, num_heads, block_size, head_dim};
+  int64_t nbytes = num_blocks * num_heads * block_size * head_dim * ((dtype.bits + 7) / 8);
+  // Each cache starts at an aligned offset of the arena.
+  int64_t stride = (nbytes + kDefaultMemoryAlignment - 1) / kDefaultMemoryAlignment *
+                   kDefaultMemoryAlignment;
+  n->arena_ = Memory::Alloc(dev, stride * num_layers * 2);
+  Array<Value> caches;
+  for (int64_t i = 0; i < num_layers * 2; ++i) {
+    void* data = static_cast<char*>(n->arena_->data) + stride * i;
+    caches.push_back(TensorValue::Assemble(dev, dtype, shape, {}, data, n->arena_));
+  }
+  n->caches = caches;
+  // The blocks are handed out from the back, so the sequences start at the first blocks.
+  n->free_blocks_.resize(num_blocks);
+  for (int64_t i = 0; i < num_blocks; ++i) {
+    n->free_blocks_[i] = num_blocks - 1 - i;
+  }
+  return BlockAllocator(n);
+}
+
+bool BlockAllocatorObj::Reserve(int64_t seq_id, int64_t num_tokens) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& blocks = tables_[seq_id];
+  int64_t needed = (num_tokens + block_size - 1) / block_size - blocks.size();
+  if (needed > static_cast<int64_t>(free_blocks_.size())) {
+    return false;
+  }
+  for (int64_t i = 0; i < needed; ++i) {
+    blocks.push_back(free_blocks_.back());
+    free_blocks_.pop_back();
+  }
+  return true;
+}
+
+void BlockAllocatorObj::Free(int64_t seq_id) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = tables_.find(seq_id);
+  if (it == tables_.end()) {
+    return;
+  }
+  // The blocks of the sequence are reused in the order they were handed out.
+  free_blocks_.insert(free_blocks_.end(), it->second.rbegin(), it->second.rend());
+  tables_.erase(it);
+}
+
+std::vector<int64_t> BlockAllocatorObj::GetBlocks(int64_t seq_id) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = tables_.find(seq_id);
+  return it == tables_.end() ? std::vector<int64_t>() : it->second;
+}
+
+int64_t BlockAllocatorObj::NumFreeBlocks() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return free_blocks_.size();
+}
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.BlockAllocator")
+    .set_body_typed([](const Device& dev, int64_t num_layers, int64_t num_blocks,
+                       int64_t block_size, int64_t num_heads, int64_t head_dim,
+                       std::string dtype) {
+      return BlockAllocator::make(dev, num_layers, num_blocks, block_size, num_heads, head_dim,
+                                  DType(String2DLDataType(dtype)));
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.BlockAllocatorReserve")
+    .set_body_typed([](BlockAllocator allocator, int64_t seq_id, int64_t num_tokens) {
+      return allocator->Reserve(seq_id, num_tokens);
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.BlockAllocatorFree")
+    .set_body_typed([](BlockAllocator allocator, int64_t seq_id) { allocator->Free(seq_id); });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.BlockAllocatorGetBlocks")
+    .set_body_typed([](BlockAllocator allocator, int64_t seq_id) {
+      Array<IntImm> ret;
+      for (int64_t block : allocator->GetBlocks(seq_id)) {
+        ret.push_back(IntImm(DataType::Int(64), block));
+      }
+      return ret;
+    });
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.BlockAllocatorNumFreeBlocks")
+    .set_body_typed([](BlockAllocator allocator) { return allocator->NumFreeBlocks(); });
+
+RAF_REGISTER_OBJECT_REFLECT(BlockAllocatorObj);
+
+}  // namespace memory_pool
+}  // namespace raf
@@ -0,0 +1,418 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/caching_pool/caching_pool.cc
+ * \brief A memory pool that caches segments and serves requests by best-fit block splitting
+ */
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <unordered_set>
+#include "raf/device_api.h"
+#include "raf/ir.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace memory_pool {
+namespace caching_pool {
+
+using device_api::DeviceAPI;
+using ir::DataType;
+using ir::FloatImm;
+using ir::Map;
+using ir::String;
+
+/*! \brief The granularity of block sizes. */
+constexpr int64_t kBlockRoundBytes = 512;
+/*! \brief The largest request served from the small size class. */
+constexpr int64_t kSmallRequestBytes = 1 << 20;
+/*! \brief The size of the segments of the small size class. */
+constexpr int64_t kSmallSegmentBytes = 2 << 20;
+/*! \brief The granularity of the segments of the large size class. */
+constexpr int64_t kLargeSegmentRoundBytes = 2 << 20;
+/*! \brief The smallest remainder of a large block that is split off as a free block. */
+constexpr int64_t kLargeSplitBytes = 1 << 20;
+
+inline int64_t RoundUp(int64_t nbytes, int64_t unit) {
+  return (nbytes + unit - 1) / unit * unit;
+}
+
+/*!
+ * \brief A block of a segment. The blocks of a segment are a doubly linked list in the address
+ * order, so a freed block can be coalesced with its free neighbours.
+ */
+struct Block {
+  /*! \brief The address of the block. */
+  char* ptr;
+  /*! \brief The size of the block in bytes. */
+  int64_t size;
+  /*! \brief The bytes requested by the user, which is 0 for free blocks. */
+  int64_t requested = 0;
+  /*! \brief Whether the block belongs to the small size class. */
+  bool is_small;
+  /*! \brief Whether the block is handed out. */
+  bool allocated = false;
+  /*! \brief The previous block in the same segment. */
+  Block* prev = nullptr;
+  /*! \brief The next block in the same segment. */
+  Block* next = nullptr;
+
+  Block(char* ptr, int64_t size, bool is_small) : ptr(ptr), size(size), is_small(is_small) {
+  }
+};
+
+/*! \brief Order the free blocks by size then address, so lower_bound finds the best fit. */
+struct BlockComparator {
+  bool operator()(const Block* a, const Block* b) const {
+    if (a->size != b->size) {
+      return a->size < b->size;
+    }
+    return a->ptr < b->ptr;
+  }
+};
+
+using FreeBlocks = std::set<Block*, BlockComparator>;
+
+/*!
+ * \brief The allocator managing the segments and blocks of a pool. It is shared by the pool and
+ * the memory handed out, so the memory stays valid after the pool is removed.
+ */
+class BlockAllocator {
+ public:
+  BlockAllocator(Device dev, std::shared_ptr<DeviceAPI> api, std::shared_ptr<PoolStats> stats)
+      : device(dev), api(std::move(api)), stats(std::move(stats)) {
+  }
+
+  ~BlockAllocator() {
+    for (Block* segment : segments_) {
+      api->FreeMemory(segment->ptr);
+      for (Block* block = segment; block != nullptr;) {
+        Block* next = block->next;
+        delete block;
+        block = next;
+      }
+    }
+  }
+
+  Block* Alloc(int64_t nbytes, int64_t alignment) {
+    std::lock_guard<std::mutex> lock(mu_);
+    // Alignments beyond the block granularity are met by padding the block.
+    int64_t size = RoundUp(nbytes + std::max<int64_t>(alignment - kBlockRoundBytes, 0),
+                           kBlockRoundBytes);
+    bool is_small = size <= kSmallRequestBytes;
+    FreeBlocks& pool = is_small ? small_blocks_ : large_blocks_;
+
+    Block* block = FindFreeBlock(&pool, size);
+    if (block == nullptr) {
+      int64_t segment_size =
+          is_small ? kSmallSegmentBytes : RoundUp(size, kLargeSegmentRoundBytes);
+      block = AllocSegment(segment_size, is_small);
+      if (block == nullptr) {
+        // Out of memory. Return the cached segments that are entirely free to the device.
+        int64_t free_nbytes = FreeUnusedSegments() + api->ReleaseCachedMemory();
+        DLOG(WARNING) << "Failed to allocate a segment of " << segment_size
+                      << " bytes. Released " << free_nbytes << " bytes of cached segments";
+        block = AllocSegment(segment_size, is_small);
+      }
+      if (block == nullptr) {
+        LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << nbytes << " bytes; Already reserved "
+                   << reserved_bytes_ << " bytes and allocated " << allocated_bytes_ << " bytes";
+        throw;
+      }
+    }
+
+    // Split the remainder off as a free block if it is large enough to be reused.
+    int64_t remaining = block->size - size;
+    if (remaining >= (is_small ? kBlockRoundBytes : kLargeSplitBytes)) {
+      Block* rest = new Block(block->ptr + size, remaining, is_small);
+      rest->prev = block;
+      rest->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = rest;
+      }
+      block->next = rest;
+      block->size = size;
+      pool.insert(rest);
+    }
+    block->allocated = true;
+    block->requested = nbytes;
+    allocated_bytes_ += block->size;
+    requested_bytes_ += nbytes;
+    return block;
+  }
+
+  void Free(Block* block) {
+    std::lock_guard<std::mutex> lock(mu_);
+    FreeBlocks& pool = block->is_small ? small_blocks_ : large_blocks_;
+    block->allocated = false;
+    allocated_bytes_ -= block->size;
+    requested_bytes_ -= block->requested;
+    block->requested = 0;
+    // Coalesce with the free neighbours.
+    if (block->prev != nullptr && !block->prev->allocated) {
+      Block* prev = block->prev;
+      pool.erase(prev);
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = prev;
+      }
+      delete block;
+      block = prev;
+    }
+    if (block->next != nullptr && !block->next->allocated) {
+      Block* next = block->next;
+      pool.erase(next);
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next != nullptr) {
+        next->next->prev = block;
+      }
+      delete next;
+    }
+    pool.insert(block);
+  }
+
+  int64_t FreeUnusedSegments() {
+    int64_t total_free = 0;
+    for (auto it = segments_.begin(); it != segments_.end();) {
+      Block* segment = *it;
+      if (segment->allocated || segment->next != nullptr) {
+        ++it;
+        continue;
+      }
+      (segment->is_small ? small_blocks_ : large_blocks_).erase(segment);
+      total_free += segment->size;
+      reserved_bytes_ -= segment->size;
+      api->FreeMemory(segment->ptr);
+      delete segment;
+      it = segments_.erase(it);
+    }
+    return total_free;
+  }
+
+  /*! \brief Return the segments without any block in use, and the memory cached by the device,
+   * back to the device. */
+  int64_t Compact() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return FreeUnusedSegments() + api->ReleaseCachedMemory();
+  }
+
+  /*! \brief Get the bytes of the blocks handed out and of the segments reserved. */
+  std::pair<int64_t, int64_t> GetPoolSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {allocated_bytes_, reserved_bytes_};
+  }
+
+  /*! \brief Get the statistics of the pool, in bytes unless the name says otherwise. */
+  std::unordered_map<std::string, int64_t> GetStats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t largest_free = 0;
+    int64_t num_free_blocks = small_blocks_.size() + large_blocks_.size();
+    for (const FreeBlocks* pool : {&small_blocks_, &large_blocks_}) {
+      if (!pool->empty()) {
+        largest_free = std::max(largest_free, (*pool->rbegin())->size);
+      }
+    }
+    return {
+        {"reserved", reserved_bytes_},
+        {"allocated", allocated_bytes_},
+        {"requested", requested_bytes_},
+        // The free bytes the pool cannot give back to the device without compaction.
+        {"fragmented", reserved_bytes_ - allocated_bytes_ - UnusedSegmentBytes()},
+        {"largest_free_block", largest_free},
+        {"num_segments", static_cast<int64_t>(segments_.size())},
+        {"num_free_blocks", num_free_blocks},
+    };
+  }
+
+ private:
+  Block* FindFreeBlock(FreeBlocks* pool, int64_t size) {
+    Block key(nullptr, size, false);
+    auto it = pool->lower_bound(&key);
+    if (it == pool->end()) {
+      return nullptr;
+    }
+    Block* block = *it;
+    pool->erase(it);
+    return block;
+  }
+
+  Block* AllocSegment(int64_t nbytes, bool is_small) {
+    void* data = nullptr;
+    try {
+      data = api->AllocMemory(nbytes, kBlockRoundBytes);
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    }
+    Block* segment = new Block(static_cast<char*>(data), nbytes, is_small);
+    segments_.insert(segment);
+    stats->num_device_allocs.fetch_add(1, std::memory_order_relaxed);
+    reserved_bytes_ += nbytes;
+    return segment;
+  }
+
+  int64_t UnusedSegmentBytes() {
+    int64_t total = 0;
+    for (Block* segment : segments_) {
+      if (!segment->allocated && segment->next == nullptr) {
+        total += segment->size;
+      }
+    }
+    return total;
+  }
+
+ public:
+  /*! \brief The device of the pool. */
+  Device device;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api;
+  /*! \brief The counters of the pool. */
+  std::shared_ptr<PoolStats> stats;
+
+ private:
+  /*! \brief The first blocks of the segments allocated from the device. */
+  std::unordered_set<Block*> segments_;
+  /*! \brief The free blocks of the small size class. */
+  FreeBlocks small_blocks_;
+  /*! \brief The free blocks of the large size class. */
+  FreeBlocks large_blocks_;
+  /*! \brief The bytes of the segments. */
+  int64_t reserved_bytes_ = 0;
+  /*! \brief The bytes of the blocks handed out. */
+  int64_t allocated_bytes_ = 0;
+  /*! \brief The bytes requested by the user of the blocks handed out. */
+  int64_t requested_bytes_ = 0;
+  /*! \brief The mutex to access the blocks. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A wrapper which holds a block of a cached segment. The block is returned to the pool
+ * when the wrapper is destructed.
+ */
+class BlockMemory final : public Memory {
+ public:
+  explicit BlockMemory(Block* block, int64_t alignment, int64_t nbytes,
+                       std::shared_ptr<BlockAllocator> allocator)
+      : block(block), nbytes(nbytes), allocator(std::move(allocator)) {
+    this->data = reinterpret_cast<void*>(
+        RoundUp(reinterpret_cast<int64_t>(block->ptr), std::max(alignment, kBlockRoundBytes)));
+    this->device = this->allocator->device;
+  }
+
+  ~BlockMemory() {
+    allocator->stats->RecordRelease(nbytes);
+    allocator->Free(block);
+  }
+
+ public:
+  /*! \brief The block held by this memory. */
+  Block* block;
+  /*! \brief The bytes counted in use, i.e., the requested bytes rounded by the pool. */
+  int64_t nbytes;
+  /*! \brief The allocator owning the block. */
+  std::shared_ptr<BlockAllocator> allocator;
+};
+
+/*!
+ * \brief A Memory Pool that caches the segments allocated from the device and serves requests by
+ * best-fit block splitting. Requests are rounded to 512 bytes instead of 4KB pages, and freed
+ * blocks are coalesced with their free neighbours, so memory of one size can be reused by
+ * requests of other sizes.
+ *
+ * Requests up to 1MB are served from the small size class, whose segments are 2MB. Larger
+ * requests are served from the large size class, whose segments are rounded to 2MB. Separating
+ * the classes keeps short-lived small tensors from fragmenting the segments of large ones.
+ *
+ * The pool holds the cached segments until it is destructed, or until an allocation fails, in
+ * which case the segments without any block in use are returned to the device first.
+ *
+ * \sa BlockAllocator
+ */
+class CachingPool final : public MemoryPool {
+ public:
+  explicit CachingPool(Device dev) {
+    auto api = DeviceAPI::Get(dev.device_type());
+    if (dev.device_type() == DevType::kCUDA()) {
+      api->SetDevice(dev.device_id());
+    }
+    allocator = std::make_shared<BlockAllocator>(dev, api, stats);
+  }
+
+  std::string GetName() {
+    return "caching_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return RoundUp(nbytes, kBlockRoundBytes);
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      auto mem = std::make_shared<Memory>();
+      mem->device = allocator->device;
+      return mem;
+    }
+    Block* block = allocator->Alloc(nbytes, alignment);
+    int64_t alloc_bytes = GetAllocBytes(nbytes);
+    stats->RecordAcquire(alloc_bytes);
+    return std::make_shared<BlockMemory>(block, alignment, alloc_bytes, allocator);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
+    throw;
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto ret = allocator->GetPoolSize();
+    return {BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second)};
+  }
+
+  int64_t Compact() override {
+    return allocator->Compact();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    return new CachingPool(dev);
+  }
+
+  /*! \brief The allocator managing the cached segments. */
+  std::shared_ptr<BlockAllocator> allocator;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.caching_pool").set_body_typed([](const Device& dev) {
+  return CachingPool::make(dev);
+});
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.caching_pool.GetStats").set_body_typed([](const Device& dev) {
+  auto pool = dynamic_cast<CachingPool*>(Memory::GetPool(dev));
+  CHECK(pool != nullptr) << "The memory pool of " << dev.c_str() << " is not a caching_pool";
+  Map<String, FloatImm> ret;
+  for (const auto& it : pool->allocator->GetStats()) {
+    ret.Set(it.first, FloatImm(DataType::Float(64), static_cast<double>(it.second)));
+  }
+  return ret;
+});
+
+}  // namespace caching_pool
+}  // namespace memory_pool
+}  // namespace raf
@@ -21,41 +21,55 @@ using device_api::DeviceAPI;
 
 class NonOwnedMemory final : public Memory {
  public:
-  explicit NonOwnedMemory(void* data, const Device& dev, std::shared_ptr<DeviceAPI> api) {
+  explicit NonOwnedMemory(void* data, const Device& dev, std::shared_ptr<DeviceAPI> api,
+                          std::shared_ptr<PoolStats> stats, int64_t nbytes) {
     this->data = data;
     this->device = dev;
     this->api = std::move(api);
+    this->stats = std::move(stats);
+    this->nbytes = nbytes;
   }
 
   ~NonOwnedMemory() {
     if (data != nullptr) {
       api->FreeMemory(data);
+      stats->RecordRelease(nbytes);
     }
   }
 
  public:
   std::shared_ptr<DeviceAPI> api;
+  /*! \brief The counters of the pool, which count the bytes in use. */
+  std::shared_ptr<PoolStats> stats;
+  int64_t nbytes;
 };
 
 class NonOwnedAsyncMemory final : public Memory {
  public:
   explicit NonOwnedAsyncMemory(void* data, void* stream, const Device& dev,
-                               std::shared_ptr<DeviceAPI> api) {
+                               std::shared_ptr<DeviceAPI> api, std::shared_ptr<PoolStats> stats,
+                               int64_t nbytes) {
     this->data = data;
     this->stream = stream;
     this->device = dev;
     this->api = std::move(api);
+    this->stats = std::move(stats);
+    this->nbytes = nbytes;
   }
 
   ~NonOwnedAsyncMemory() {
     if (data != nullptr) {
       api->FreeMemoryAsync(data, stream);
+      stats->RecordRelease(nbytes);
     }
   }
 
  public:
   std::shared_ptr<DeviceAPI> api;
   void* stream;
+  /*! \brief The counters of the pool, which count the bytes in use. */
+  std::shared_ptr<PoolStats> stats;
+  int64_t nbytes;
 };
 
 class NoPool final : public MemoryPool {
@@ -82,8 +96,10 @@ class NoPool final : public MemoryPool {
     void* data = nullptr;
     if (nbytes > 0) {
       data = api->AllocMemory(nbytes, alignment);
+      stats->num_device_allocs.fetch_add(1, std::memory_order_relaxed);
+      stats->RecordAcquire(nbytes);
     }
-    return std::make_shared<NonOwnedMemory>(data, device, api);
+    return std::make_shared<NonOwnedMemory>(data, device, api, stats, nbytes);
   }
 
   std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
@@ -92,8 +108,10 @@ class NoPool final : public MemoryPool {
     void* data = nullptr;
     if (nbytes > 0) {
       data = api->AllocMemoryAsync(nbytes, stream, alignment);
+      stats->num_device_allocs.fetch_add(1, std::memory_order_relaxed);
+      stats->RecordAcquire(nbytes);
     }
-    return std::make_shared<NonOwnedAsyncMemory>(data, stream, device, api);
+    return std::make_shared<NonOwnedAsyncMemory>(data, stream, device, api, stats, nbytes);
   }
 
   std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
@@ -8,8 +8,10 @@
  * \brief A memory pool that use page as memory unit
  */
 #include <atomic>
+#include <mutex>
 #include <tvm/relay/transform.h>
 #include "raf/device_api.h"
+#include "raf/event_pool.h"
 #include "raf/memory_pool.h"
 #include "raf/registry.h"
 
@@ -18,6 +20,8 @@ namespace memory_pool {
 namespace page_unit_pool {
 
 using device_api::DeviceAPI;
+using event_pool::Event;
+using event_pool::EventPool;
 
 /*!
  * \brief A wrapper which holds the a chunck of memory that owned by nobody.
@@ -41,9 +45,75 @@ class NonOwnedMemory final : public Memory {
     }
   }
 
+  /*!
+   * \brief Whether the chunk can be handed out for the work on the given stream. A chunk released
+   * on a stream is reusable right away on the same stream, as the stream orders the new work after
+   * the old one, and is reusable on other streams once the work recorded at release completes.
+   * \param stream The stream to use the chunk on.
+   */
+  bool IsReusableOn(void* stream) {
+    std::lock_guard<std::mutex> lock(mu);
+    if (release_event == nullptr || release_stream == stream) {
+      return true;
+    }
+    if (api->QueryEvent(release_event->data())) {
+      release_event = nullptr;
+      release_stream = nullptr;
+      return true;
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Mark the chunk as released on the given stream.
+   * \param stream The stream the chunk was used on.
+   * \param event The event recorded on the stream at release.
+   */
+  void Release(void* stream, std::shared_ptr<Event> event) {
+    std::lock_guard<std::mutex> lock(mu);
+    release_stream = stream;
+    release_event = std::move(event);
+  }
+
  public:
   /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
   std::shared_ptr<DeviceAPI> api;
+  /*! \brief The stream the chunk was last released on by a stream-ordered allocation. */
+  void* release_stream = nullptr;
+  /*! \brief The event recorded on release_stream at release, or nullptr if nothing is pending. */
+  std::shared_ptr<Event> release_event;
+  /*! \brief The mutex to access the release stream and event. */
+  std::mutex mu;
+  /*! \brief Whether the chunk is counted in the bytes in use of the pool. */
+  bool handed_out = false;
+};
+
+/*!
+ * \brief A wrapper of a pooled chunk handed out for the work on a stream. When it is destructed,
+ * an event is recorded on the stream, so the chunk is not reused by other streams before the work
+ * issued to the stream finishes.
+ *
+ * \sa NonOwnedMemory
+ */
+class StreamOrderedMemory final : public Memory {
+ public:
+  explicit StreamOrderedMemory(std::shared_ptr<NonOwnedMemory> chunk, void* stream)
+      : chunk(std::move(chunk)), stream(stream) {
+    this->data = this->chunk->data;
+    this->device = this->chunk->device;
+  }
+
+  ~StreamOrderedMemory() {
+    auto event = EventPool::Get(device)->GetEvent();
+    chunk->api->EventRecordOnStream(event->data(), stream);
+    chunk->Release(stream, std::move(event));
+  }
+
+ public:
+  /*! \brief The pooled chunk. */
+  std::shared_ptr<NonOwnedMemory> chunk;
+  /*! \brief The stream the chunk is used on. */
+  void* stream;
 };
 
 /*!
@@ -58,6 +128,15 @@ class NonOwnedMemory final : public Memory {
  * As the pool hold a reference to each memory chunck allocate, thus the memory chunck won't be
  * freed once it is allocated, until user's application finishes or fails.
  *
+ * The pool holds a reference to each chunck, so it notices that a chunck is released when it
+ * finds the chunck free, i.e., when it reuses or frees the chunck, or when it settles the chunks
+ * to check whether the bytes in use reach a new peak. Until then, the released chuncks are still
+ * counted in the bytes in use, but not in their peak.
+ *
+ * Chuncks allocated by AllocAsync are stream-ordered: a chunck released on a stream is reused on
+ * the same stream right away, and on other streams only after the event recorded at release
+ * completes, so no synchronization is needed on either path.
+ *
  * \example Assume the Page Size is 4KB. When user requests a chunck of memory with size 2KB, the
  * user will actually get a memory chunck with size 4KB, wrapped in NonOwnedMemory.
  *
@@ -95,6 +174,7 @@ class PageUnitPool : public MemoryPool {
   int64_t FreeUnusedChunks() {
     // Remove the memory from the pool and return the freed memory in bytes.
     // Since this is the last share_ptr, the removed memory will be deconstructed and freed.
+    SettleReleases();
     int64_t total_free = 0;
     curr_pool_size = 0;
 
@@ -105,26 +185,76 @@ class PageUnitPool : public MemoryPool {
 
     for (auto nbytes : page_nbytes) {
       auto nchunk = _pool[nbytes].size();
-      _pool[nbytes].remove_if([](std::shared_ptr<Memory>& mem) { return mem.use_count() == 1; });
+      _pool[nbytes].remove_if(
+          [](std::shared_ptr<NonOwnedMemory>& mem) { return mem.use_count() == 1; });
       total_free += nbytes * (nchunk - _pool[nbytes].size());
       curr_pool_size += nbytes * _pool[nbytes].size();
     }
     return total_free;
   }
 
+  int64_t Compact() override {
+    return FreeUnusedChunks() + api->ReleaseCachedMemory();
+  }
+
+  int64_t GetBytesInUse() override {
+    SettleReleases();
+    return stats->bytes_in_use.load();
+  }
+
+  /*! \brief Return the bytes of the chuncks released since they were handed out. */
+  void SettleReleases() {
+    for (const auto& kv : _pool) {
+      for (const auto& chunk : kv.second) {
+        if (chunk->handed_out && chunk.use_count() == 1) {
+          chunk->handed_out = false;
+          stats->RecordRelease(kv.first);
+        }
+      }
+    }
+  }
+
+  /*!
+   * \brief Count a chunck handed out in the bytes in use, unless it is still counted since it was
+   * handed out last time. The released chuncks are settled first if the bytes would reach a new
+   * peak, so the peak does not count them.
+   */
+  std::shared_ptr<NonOwnedMemory> HandOut(std::shared_ptr<NonOwnedMemory> chunk, int64_t nbytes) {
+    if (!chunk->handed_out) {
+      if (stats->bytes_in_use.load(std::memory_order_relaxed) + nbytes >
+          stats->peak_bytes_in_use.load(std::memory_order_relaxed)) {
+        SettleReleases();
+      }
+      chunk->handed_out = true;
+      stats->RecordAcquire(nbytes);
+    }
+    return chunk;
+  }
+
   std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    return AllocChunk(nbytes, alignment, nullptr);
+  }
+
+  /*!
+   * \brief Allocate a chunk for the work on the given stream, reusing a free chunk in the pool if
+   * it is reusable on the stream.
+   * \param nbytes The size of the chunk.
+   * \param alignment The alignment of the chunk.
+   * \param stream The stream to use the chunk on, or nullptr for the default stream.
+   */
+  std::shared_ptr<NonOwnedMemory> AllocChunk(int64_t nbytes, int64_t alignment, void* stream) {
     nbytes = GetAllocBytes(nbytes);
     CHECK_GE(nbytes, 0);
 
     // Find whether there are available memory chuncks in the pool.
     // If so, return the available memory chunck.
     if (_pool.find(nbytes) == _pool.end()) {
-      _pool.insert({nbytes, std::list<std::shared_ptr<Memory>>()});
+      _pool.insert({nbytes, std::list<std::shared_ptr<NonOwnedMemory>>()});
     }
     for (const auto& it : _pool[nbytes]) {
       if (it.use_count() == 1) {
         int64_t address = (int64_t)it->data;
-        if (address % alignment == 0) return it;
+        if (address % alignment == 0 && it->IsReusableOn(stream)) return HandOut(it, nbytes);
       }
     }
 
@@ -134,12 +264,17 @@ class PageUnitPool : public MemoryPool {
       data = AllocDeviceMemory(nbytes, alignment);
 
       // Out of memory or exceed the user-specified limitation, free unused chunks on other pages.
+      // On out of memory, also release the memory cached by the device.
       size_t free_nbytes = SIZE_MAX;
-      if ((max_pool_size > 0 && curr_pool_size >= max_pool_size) ||
-          (data == nullptr && free_nbytes > 0)) {
-        free_nbytes = FreeUnusedChunks();
+      if (data == nullptr) {
+        free_nbytes = Compact();
         DLOG(WARNING) << "Failed to allocate " << BytesToMegaBytes(nbytes)
-                      << " MBs). Ran GC and got " << BytesToMegaBytes(free_nbytes) << " more MBs";
+                      << " MBs). Compacted and got " << BytesToMegaBytes(free_nbytes)
+                      << " more MBs";
+      } else if (max_pool_size > 0 && curr_pool_size >= max_pool_size) {
+        free_nbytes = FreeUnusedChunks();
+        DLOG(WARNING) << "Pool size exceeds the limit. Ran GC and got "
+                      << BytesToMegaBytes(free_nbytes) << " more MBs";
       }
 
       // Re-allocate the desired chunk if needed.
@@ -155,9 +290,10 @@ class PageUnitPool : public MemoryPool {
         throw;
       }
       curr_pool_size += nbytes;
-      std::shared_ptr<Memory> new_mem = std::make_shared<NonOwnedMemory>(data, device, api);
+      stats->num_device_allocs.fetch_add(1, std::memory_order_relaxed);
+      auto new_mem = std::make_shared<NonOwnedMemory>(data, device, api);
       _pool[nbytes].push_back(new_mem);
-      return new_mem;
+      return HandOut(new_mem, nbytes);
     } else {
       return std::make_shared<NonOwnedMemory>(data, device, api);
     }
@@ -165,8 +301,12 @@ class PageUnitPool : public MemoryPool {
 
   std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
                                      int64_t alignment = kDefaultMemoryAlignment) override {
-    LOG(FATAL) << "Please use NoPool to use AllocAsync.";
-    throw;
+    auto chunk = AllocChunk(nbytes, alignment, stream);
+    if (chunk->data == nullptr || device.device_type() != DevType::kCUDA()) {
+      // Only CUDA work is stream-ordered.
+      return chunk;
+    }
+    return std::make_shared<StreamOrderedMemory>(chunk, stream);
   }
 
   std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
@@ -226,13 +366,53 @@ class PageUnitPool : public MemoryPool {
   /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
   std::shared_ptr<DeviceAPI> api;
   /*! \brief The pool that hold the references to NonOwnedMemory. */
-  std::unordered_map<int64_t, std::list<std::shared_ptr<Memory>>> _pool;
+  std::unordered_map<int64_t, std::list<std::shared_ptr<NonOwnedMemory>>> _pool;
+};
+
+/*!
+ * \brief A PageUnitPool backed by managed memory, so that the allocations can oversubscribe the
+ * device memory: the pages not touched recently are evicted to the host instead of failing with
+ * Out-Of-Memory. The VM prefetches the memory of the upcoming ops to hide the page faults.
+ * Stream-ordered allocations are served by the same managed chunks.
+ *
+ * \sa PageUnitPool
+ */
+class ManagedPool final : public PageUnitPool {
+ public:
+  explicit ManagedPool(Device dev, int64_t pool_limit = 0) : PageUnitPool(dev, pool_limit) {
+  }
+
+  std::string GetName() {
+    return "managed_pool";
+  }
+
+  inline void* AllocDeviceMemory(int64_t nbytes, int64_t alignment) override {
+    try {
+      return api->AllocManagedMemory(nbytes, alignment);
+    } catch (const dmlc::Error& e) {
+      return nullptr;
+    }
+  }
+
+  static void* make(const Device& dev) {
+    int64_t max_pool_limit = 0;
+    if (const char* val = getenv("RAF_MEMORY_POOL_SIZE_LIMIT")) {
+      max_pool_limit = atol(val);
+    }
+    CHECK(dev.device_type() == DevType::kCUDA())
+        << "managed_pool only supports CUDA devices, but got " << dev.c_str();
+    return new ManagedPool(dev, max_pool_limit);
+  }
 };
 
 RAF_REGISTER_GLOBAL("raf.memory_pool._make.page_unit_pool").set_body_typed([](const Device& dev) {
   return PageUnitPool::make(dev);
 });
 
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.managed_pool").set_body_typed([](const Device& dev) {
+  return ManagedPool::make(dev);
+});
+
 }  // namespace page_unit_pool
 }  // namespace memory_pool
 }  // namespace raf
@@ -0,0 +1,614 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/memory_pool/virtual_pool/virtual_pool.cc
+ * \brief A memory pool that grows one virtual segment per stream and maps the physical pages on
+ * demand with the CUDA virtual memory management
+ */
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "raf/device_api.h"
+#include "raf/ir.h"
+#include "raf/memory_pool.h"
+#include "raf/registry.h"
+
+#ifdef RAF_USE_CUDA
+#include "../../common/cuda_utils.h"
+#endif
+
+#if defined(RAF_USE_CUDA) && CUDA_VERSION >= 10020
+#define RAF_USE_VIRTUAL_POOL 1
+#else
+#define RAF_USE_VIRTUAL_POOL 0
+#endif
+
+namespace raf {
+namespace memory_pool {
+namespace virtual_pool {
+
+using device_api::DeviceAPI;
+using ir::DataType;
+using ir::FloatImm;
+using ir::Map;
+using ir::String;
+
+#if RAF_USE_VIRTUAL_POOL
+
+/*! \brief The granularity of block sizes. */
+constexpr int64_t kBlockRoundBytes = 512;
+
+inline int64_t RoundUp(int64_t nbytes, int64_t unit) {
+  return (nbytes + unit - 1) / unit * unit;
+}
+
+struct Segment;
+
+/*!
+ * \brief A block of a segment. The blocks of a segment are a doubly linked list in the address
+ * order, which covers the segment up to its frontier, so a freed block can be coalesced with its
+ * free neighbours.
+ */
+struct Block {
+  /*! \brief The address of the block. */
+  char* ptr;
+  /*! \brief The size of the block in bytes. */
+  int64_t size;
+  /*! \brief The segment of the block. */
+  Segment* segment;
+  /*! \brief The bytes requested by the user, which is 0 for free blocks. */
+  int64_t requested = 0;
+  /*! \brief Whether the block is handed out. */
+  bool allocated = false;
+  /*! \brief The previous block in the same segment. */
+  Block* prev = nullptr;
+  /*! \brief The next block in the same segment. */
+  Block* next = nullptr;
+
+  Block(char* ptr, int64_t size, Segment* segment) : ptr(ptr), size(size), segment(segment) {
+  }
+};
+
+/*! \brief Order the free blocks by size then address, so lower_bound finds the best fit. */
+struct BlockComparator {
+  bool operator()(const Block* a, const Block* b) const {
+    if (a->size != b->size) {
+      return a->size < b->size;
+    }
+    return a->ptr < b->ptr;
+  }
+};
+
+/*!
+ * \brief A contiguous range of virtual addresses reserved for a stream. The blocks grow at the
+ * frontier, and the physical pages are mapped when a block on them is handed out.
+ */
+struct Segment {
+  /*! \brief The first address of the range. */
+  CUdeviceptr base = 0;
+  /*! \brief The bytes of the range. */
+  int64_t reserved = 0;
+  /*! \brief The end of the blocks, which is aligned to the pages. */
+  int64_t frontier = 0;
+  /*! \brief The last block in the address order. */
+  Block* last = nullptr;
+  /*! \brief The free blocks. */
+  std::set<Block*, BlockComparator> free_blocks;
+  /*! \brief The physical memory of each page up to the frontier. */
+  std::vector<CUmemGenericAllocationHandle> pages;
+  /*! \brief Whether each page up to the frontier is mapped. */
+  std::vector<bool> mapped;
+};
+
+/*!
+ * \brief Unwrap the result of a driver call in a destructor, where the driver may have been shut
+ * down already. \sa CUDA_CALL_IF_DRIVER_IS_LOADED
+ */
+inline void CheckIfDriverIsLoaded(CUresult e) {
+  CHECK(e == CUDA_SUCCESS || e == CUDA_ERROR_DEINITIALIZED) << "CUDA driver error " << e;
+}
+
+/*! \brief Make the primary context of the pool current on the calling thread in the scope. */
+class ContextScope {
+ public:
+  explicit ContextScope(CUcontext ctx) {
+    CU_CALL(cuCtxPushCurrent(ctx));
+  }
+
+  ~ContextScope() {
+    CUcontext ctx;
+    CheckIfDriverIsLoaded(cuCtxPopCurrent(&ctx));
+  }
+};
+
+/*!
+ * \brief The allocator managing the segments of a pool. It is shared by the pool and the memory
+ * handed out, so the memory stays valid after the pool is removed.
+ */
+class VirtualAllocator {
+ public:
+  VirtualAllocator(Device dev, std::shared_ptr<DeviceAPI> api, std::shared_ptr<PoolStats> stats)
+      : device(dev), api(std::move(api)), stats(std::move(stats)) {
+    CUdevice cu_device;
+    CU_CALL(cuInit(0));
+    CU_CALL(cuDeviceGet(&cu_device, dev.device_id()));
+    int supported = 0;
+    CU_CALL(cuDeviceGetAttribute(
+        &supported, CU_DEVICE_ATTRIBUTE_VIRTUAL_ADDRESS_MANAGEMENT_SUPPORTED, cu_device));
+    CHECK(supported) << "virtual_pool is not supported by " << dev.c_str();
+    CU_CALL(cuDevicePrimaryCtxRetain(&ctx_, cu_device));
+    cu_device_ = cu_device;
+
+    prop_.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+    prop_.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    prop_.location.id = dev.device_id();
+    access_.location = prop_.location;
+    access_.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+    size_t granularity = 0;
+    CU_CALL(cuMemGetAllocationGranularity(&granularity, &prop_,
+                                          CU_MEM_ALLOC_GRANULARITY_RECOMMENDED));
+    page_bytes_ = granularity;
+    // Each segment can grow to the whole device, since the virtual addresses are plenty.
+    size_t total_bytes = 0;
+    CU_CALL(cuDeviceTotalMem(&total_bytes, cu_device));
+    segment_bytes_ = RoundUp(total_bytes, page_bytes_);
+  }
+
+  ~VirtualAllocator() {
+    if (cuCtxPushCurrent(ctx_) == CUDA_SUCCESS) {
+      for (auto& it : segments_) {
+        Segment* segment = it.second;
+        for (size_t i = 0; i < segment->pages.size(); ++i) {
+          if (segment->mapped[i]) {
+            CheckIfDriverIsLoaded(cuMemUnmap(segment->base + i * page_bytes_, page_bytes_));
+            CheckIfDriverIsLoaded(cuMemRelease(segment->pages[i]));
+          }
+        }
+        CheckIfDriverIsLoaded(cuMemAddressFree(segment->base, segment->reserved));
+        for (Block* block = segment->last; block != nullptr;) {
+          Block* prev = block->prev;
+          delete block;
+          block = prev;
+        }
+        delete segment;
+      }
+      CUcontext ctx;
+      CheckIfDriverIsLoaded(cuCtxPopCurrent(&ctx));
+      CheckIfDriverIsLoaded(cuDevicePrimaryCtxRelease(cu_device_));
+    }
+  }
+
+  Block* Alloc(int64_t nbytes, int64_t alignment, void* stream) {
+    std::lock_guard<std::mutex> lock(mu_);
+    ContextScope scope(ctx_);
+    // Alignments beyond the block granularity are met by padding the block.
+    int64_t size = RoundUp(nbytes + std::max<int64_t>(alignment - kBlockRoundBytes, 0),
+                           kBlockRoundBytes);
+    Segment* segment = GetSegment(stream);
+    Block* block = FindFreeBlock(segment, size);
+    if (block == nullptr) {
+      block = Grow(segment, size);
+      if (block == nullptr) {
+        LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << nbytes
+                   << " bytes beyond the virtual segment of " << segment->reserved << " bytes";
+        throw;
+      }
+    }
+
+    // Split the remainder off as a free block. It costs no physical memory until it is handed
+    // out, so it is split off regardless of its size.
+    int64_t remaining = block->size - size;
+    if (remaining >= kBlockRoundBytes) {
+      Block* rest = new Block(block->ptr + size, remaining, segment);
+      rest->prev = block;
+      rest->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = rest;
+      } else {
+        segment->last = rest;
+      }
+      block->next = rest;
+      block->size = size;
+      segment->free_blocks.insert(rest);
+    }
+    block->allocated = true;
+    block->requested = nbytes;
+    allocated_bytes_ += block->size;
+    requested_bytes_ += nbytes;
+
+    if (!MapPages(block)) {
+      // Out of memory. Unmap the pages of the free blocks, which moves no block, and retry.
+      int64_t free_nbytes = ReleaseFreePages();
+      DLOG(WARNING) << "Failed to map the pages of " << block->size << " bytes. Released "
+                    << free_nbytes << " bytes of free pages";
+      if (!MapPages(block)) {
+        FreeBlock(block);
+        LOG(FATAL) << "Out-Of-Memory. Tried to allocate " << nbytes << " bytes; Already mapped "
+                   << mapped_bytes_ << " bytes and allocated " << allocated_bytes_ << " bytes";
+        throw;
+      }
+    }
+    return block;
+  }
+
+  void Free(Block* block) {
+    std::lock_guard<std::mutex> lock(mu_);
+    FreeBlock(block);
+  }
+
+  /*! \brief Unmap the pages of the free blocks and return them to the device. */
+  int64_t Compact() {
+    std::lock_guard<std::mutex> lock(mu_);
+    ContextScope scope(ctx_);
+    return ReleaseFreePages();
+  }
+
+  /*! \brief Get the bytes of the blocks handed out and of the pages mapped. */
+  std::pair<int64_t, int64_t> GetPoolSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {allocated_bytes_, mapped_bytes_};
+  }
+
+  /*! \brief Get the statistics of the pool, in bytes unless the name says otherwise. */
+  std::unordered_map<std::string, int64_t> GetStats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    int64_t frontier = 0;
+    int64_t num_free_blocks = 0;
+    for (const auto& it : segments_) {
+      frontier += it.second->frontier;
+      num_free_blocks += it.second->free_blocks.size();
+    }
+    return {
+        {"reserved", static_cast<int64_t>(segments_.size()) * segment_bytes_},
+        {"frontier", frontier},
+        {"mapped", mapped_bytes_},
+        {"allocated", allocated_bytes_},
+        {"requested", requested_bytes_},
+        {"page_size", page_bytes_},
+        {"num_segments", static_cast<int64_t>(segments_.size())},
+        {"num_free_blocks", num_free_blocks},
+    };
+  }
+
+ private:
+  /*! \brief Get the segment of the stream, which is reserved at the first request. */
+  Segment* GetSegment(void* stream) {
+    auto it = segments_.find(stream);
+    if (it != segments_.end()) {
+      return it->second;
+    }
+    Segment* segment = new Segment();
+    CU_CALL(cuMemAddressReserve(&segment->base, segment_bytes_, page_bytes_, 0, 0));
+    segment->reserved = segment_bytes_;
+    segments_[stream] = segment;
+    return segment;
+  }
+
+  Block* FindFreeBlock(Segment* segment, int64_t size) {
+    Block key(nullptr, size, segment);
+    auto it = segment->free_blocks.lower_bound(&key);
+    if (it == segment->free_blocks.end()) {
+      return nullptr;
+    }
+    Block* block = *it;
+    segment->free_blocks.erase(it);
+    return block;
+  }
+
+  /*!
+   * \brief Advance the frontier of the segment, so its last block is free and has the given bytes
+   * at least. No physical memory is mapped here.
+   * \return The last block, which is taken out of the free blocks, or nullptr if the segment is
+   * exhausted.
+   */
+  Block* Grow(Segment* segment, int64_t size) {
+    Block* last = segment->last;
+    bool extend = last != nullptr && !last->allocated;
+    int64_t frontier = RoundUp(segment->frontier + size - (extend ? last->size : 0), page_bytes_);
+    if (frontier > segment->reserved) {
+      return nullptr;
+    }
+    int64_t grown = frontier - segment->frontier;
+    if (extend) {
+      segment->free_blocks.erase(last);
+      last->size += grown;
+    } else {
+      Block* block = new Block(reinterpret_cast<char*>(segment->base + segment->frontier), grown,
+                               segment);
+      block->prev = last;
+      if (last != nullptr) {
+        last->next = block;
+      }
+      segment->last = last = block;
+    }
+    segment->frontier = frontier;
+    segment->pages.resize(frontier / page_bytes_);
+    segment->mapped.resize(frontier / page_bytes_, false);
+    return last;
+  }
+
+  /*! \brief Map the pages under the block which are not mapped yet. Return false if the device
+   * is out of memory. */
+  bool MapPages(Block* block) {
+    Segment* segment = block->segment;
+    int64_t offset = reinterpret_cast<CUdeviceptr>(block->ptr) - segment->base;
+    int64_t begin = offset / page_bytes_;
+    int64_t end = RoundUp(offset + block->size, page_bytes_) / page_bytes_;
+    for (int64_t i = begin; i < end; ++i) {
+      if (segment->mapped[i]) {
+        continue;
+      }
+      CUmemGenericAllocationHandle handle;
+      CUresult e = cuMemCreate(&handle, page_bytes_, &prop_, 0);
+      if (e == CUDA_ERROR_OUT_OF_MEMORY) {
+        return false;
+      }
+      CU_CALL(e);
+      CUdeviceptr ptr = segment->base + i * page_bytes_;
+      CU_CALL(cuMemMap(ptr, page_bytes_, 0, handle, 0));
+      CU_CALL(cuMemSetAccess(ptr, page_bytes_, &access_, 1));
+      segment->pages[i] = handle;
+      segment->mapped[i] = true;
+      mapped_bytes_ += page_bytes_;
+      stats->num_device_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  void FreeBlock(Block* block) {
+    Segment* segment = block->segment;
+    block->allocated = false;
+    allocated_bytes_ -= block->size;
+    requested_bytes_ -= block->requested;
+    block->requested = 0;
+    // Coalesce with the free neighbours.
+    if (block->prev != nullptr && !block->prev->allocated) {
+      Block* prev = block->prev;
+      segment->free_blocks.erase(prev);
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next != nullptr) {
+        block->next->prev = prev;
+      } else {
+        segment->last = prev;
+      }
+      delete block;
+      block = prev;
+    }
+    if (block->next != nullptr && !block->next->allocated) {
+      Block* next = block->next;
+      segment->free_blocks.erase(next);
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next != nullptr) {
+        next->next->prev = block;
+      } else {
+        segment->last = block;
+      }
+      delete next;
+    }
+    segment->free_blocks.insert(block);
+  }
+
+  /*!
+   * \brief Unmap the pages entirely covered by the free blocks, and pull the frontier of each
+   * segment back to its last block in use. The addresses of the blocks in use never change.
+   * \return The bytes of the pages unmapped.
+   */
+  int64_t ReleaseFreePages() {
+    // The blocks freed on the host may still be used by the kernels queued on their streams.
+    api->WaitDevice(device);
+    int64_t total_free = 0;
+    for (auto& it : segments_) {
+      Segment* segment = it.second;
+      for (Block* block : segment->free_blocks) {
+        int64_t offset = reinterpret_cast<CUdeviceptr>(block->ptr) - segment->base;
+        int64_t end = (offset + block->size) / page_bytes_;
+        for (int64_t i = RoundUp(offset, page_bytes_) / page_bytes_; i < end; ++i) {
+          if (segment->mapped[i]) {
+            CU_CALL(cuMemUnmap(segment->base + i * page_bytes_, page_bytes_));
+            CU_CALL(cuMemRelease(segment->pages[i]));
+            segment->mapped[i] = false;
+            total_free += page_bytes_;
+          }
+        }
+      }
+      Block* last = segment->last;
+      if (last != nullptr && !last->allocated) {
+        int64_t frontier =
+            RoundUp(reinterpret_cast<CUdeviceptr>(last->ptr) - segment->base, page_bytes_);
+        segment->free_blocks.erase(last);
+        last->size -= segment->frontier - frontier;
+        if (last->size == 0) {
+          segment->last = last->prev;
+          if (last->prev != nullptr) {
+            last->prev->next = nullptr;
+          }
+          delete last;
+        } else {
+          segment->free_blocks.insert(last);
+        }
+        segment->frontier = frontier;
+        segment->pages.resize(frontier / page_bytes_);
+        segment->mapped.resize(frontier / page_bytes_);
+      }
+    }
+    mapped_bytes_ -= total_free;
+    return total_free;
+  }
+
+ public:
+  /*! \brief The device of the pool. */
+  Device device;
+  /*! \brief The pointer to the DeviceAPI which determines the context of memory. */
+  std::shared_ptr<DeviceAPI> api;
+  /*! \brief The counters of the pool. */
+  std::shared_ptr<PoolStats> stats;
+
+ private:
+  /*! \brief The driver device of the pool. */
+  CUdevice cu_device_;
+  /*! \brief The primary context of the device, which is shared with the runtime. */
+  CUcontext ctx_;
+  /*! \brief The properties of the physical pages. */
+  CUmemAllocationProp prop_ = {};
+  /*! \brief The access of the device to the mapped pages. */
+  CUmemAccessDesc access_ = {};
+  /*! \brief The bytes of a physical page, i.e., the granularity of the mapping. */
+  int64_t page_bytes_ = 0;
+  /*! \brief The bytes of virtual addresses reserved for a segment. */
+  int64_t segment_bytes_ = 0;
+  /*! \brief The segment of each stream, where the synchronous requests use the null stream. */
+  std::unordered_map<void*, Segment*> segments_;
+  /*! \brief The bytes of the pages mapped. */
+  int64_t mapped_bytes_ = 0;
+  /*! \brief The bytes of the blocks handed out. */
+  int64_t allocated_bytes_ = 0;
+  /*! \brief The bytes requested by the user of the blocks handed out. */
+  int64_t requested_bytes_ = 0;
+  /*! \brief The mutex to access the segments. */
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A wrapper which holds a block of a virtual segment. The block is returned to the pool
+ * when the wrapper is destructed.
+ */
+class BlockMemory final : public Memory {
+ public:
+  explicit BlockMemory(Block* block, int64_t alignment, int64_t nbytes,
+                       std::shared_ptr<VirtualAllocator> allocator)
+      : block(block), nbytes(nbytes), allocator(std::move(allocator)) {
+    this->data = reinterpret_cast<void*>(
+        RoundUp(reinterpret_cast<int64_t>(block->ptr), std::max(alignment, kBlockRoundBytes)));
+    this->device = this->allocator->device;
+  }
+
+  ~BlockMemory() {
+    allocator->stats->RecordRelease(nbytes);
+    allocator->Free(block);
+  }
+
+ public:
+  /*! \brief The block held by this memory. */
+  Block* block;
+  /*! \brief The bytes counted in use, i.e., the requested bytes rounded by the pool. */
+  int64_t nbytes;
+  /*! \brief The allocator owning the block. */
+  std::shared_ptr<VirtualAllocator> allocator;
+};
+
+/*!
+ * \brief A Memory Pool backed by the CUDA virtual memory management. Each stream has one
+ * contiguous range of virtual addresses as large as the device, which grows at its frontier. The
+ * physical pages are mapped when a block on them is handed out, and are unmapped by compaction,
+ * so the free memory of a segment is given back to the device page by page, without moving or
+ * freeing the blocks in use.
+ *
+ * Since a request beyond the free blocks just advances the frontier, which merges with the free
+ * tail, the pool does not fail for fragmentation, e.g., when the shapes change across the
+ * iterations of dynamic-shape training. When the device is out of physical memory, the free
+ * pages of all the segments are unmapped and the mapping is retried.
+ *
+ * Blocks freed on a stream are reused by the requests on the same stream only, so the
+ * stream-ordered requests are safe without synchronization. The synchronous requests use the
+ * segment of the null stream.
+ *
+ * \sa VirtualAllocator
+ */
+class VirtualPool final : public MemoryPool {
+ public:
+  explicit VirtualPool(Device dev) {
+    auto api = DeviceAPI::Get(dev.device_type());
+    api->SetDevice(dev.device_id());
+    allocator = std::make_shared<VirtualAllocator>(dev, api, stats);
+  }
+
+  std::string GetName() {
+    return "virtual_pool";
+  }
+
+  int64_t GetAllocBytes(int64_t nbytes) override {
+    return RoundUp(nbytes, kBlockRoundBytes);
+  }
+
+  std::shared_ptr<Memory> Alloc(int64_t nbytes, int64_t alignment) override {
+    return AllocAsync(nbytes, nullptr, alignment);
+  }
+
+  std::shared_ptr<Memory> AllocAsync(int64_t nbytes, void* stream,
+                                     int64_t alignment = kDefaultMemoryAlignment) override {
+    CHECK_GE(nbytes, 0);
+    if (nbytes == 0) {
+      auto mem = std::make_shared<Memory>();
+      mem->device = allocator->device;
+      return mem;
+    }
+    Block* block = allocator->Alloc(nbytes, alignment, stream);
+    int64_t alloc_bytes = GetAllocBytes(nbytes);
+    stats->RecordAcquire(alloc_bytes);
+    return std::make_shared<BlockMemory>(block, alignment, alloc_bytes, allocator);
+  }
+
+  std::vector<std::shared_ptr<Memory>> AllocBatch(const std::vector<int64_t>& nbytes,
+                                                  int64_t alignment) override {
+    std::vector<std::shared_ptr<Memory>> ret;
+    ret.reserve(nbytes.size());
+    for (int64_t bytes : nbytes) {
+      ret.emplace_back(Alloc(bytes, alignment));
+    }
+    return ret;
+  }
+
+  std::pair<float, float> GetPoolSize() override {
+    auto ret = allocator->GetPoolSize();
+    return {BytesToMegaBytes(ret.first), BytesToMegaBytes(ret.second)};
+  }
+
+  int64_t Compact() override {
+    return allocator->Compact();
+  }
+
+ public:
+  static void* make(const Device& dev) {
+    CHECK(dev.device_type() == DevType::kCUDA())
+        << "virtual_pool only supports CUDA devices, but got " << dev.c_str();
+    return new VirtualPool(dev);
+  }
+
+  /*! \brief The allocator managing the virtual segments. */
+  std::shared_ptr<VirtualAllocator> allocator;
+};
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.virtual_pool").set_body_typed([](const Device& dev) {
+  return VirtualPool::make(dev);
+});
+
+RAF_REGISTER_GLOBAL("raf.memory_pool.virtual_pool.GetStats").set_body_typed([](const Device& dev) {
+  auto pool = dynamic_cast<VirtualPool*>(Memory::GetPool(dev));
+  CHECK(pool != nullptr) << "The memory pool of " << dev.c_str() << " is not a virtual_pool";
+  Map<String, FloatImm> ret;
+  for (const auto& it : pool->allocator->GetStats()) {
+    ret.Set(it.first, FloatImm(DataType::Float(64), static_cast<double>(it.second)));
+  }
+  return ret;
+});
+
+#else
+
+RAF_REGISTER_GLOBAL("raf.memory_pool._make.virtual_pool").set_body_typed([](const Device& dev) {
+  LOG(FATAL) << "virtual_pool requires RAF built with CUDA 10.2 or later";
+  return static_cast<void*>(nullptr);
+});
+
+#endif
+
+}  // namespace virtual_pool
+}  // namespace memory_pool
+}  // namespace raf
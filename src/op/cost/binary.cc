@@ -0,0 +1,49 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/cost/binary.cc
+ * \brief Analytic cost functions of binary operators
+ */
+#include "./cost_utils.h"
+
+namespace raf {
+namespace op {
+namespace cost {
+
+RAF_OP_COST("raf.op.add", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.subtract", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.multiply", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.power", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.divide", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.floor_divide", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.mod", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.less", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.greater", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.less_equal", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.greater_equal", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.equal", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.not_equal", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.maximum", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.minimum", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.logical_and", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.logical_or", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.logical_xor", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.left_shift", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.right_shift", ElementwiseCost<1>);
+
+Array<FloatImm> AddNCost(const Call& call) {
+  // add_n takes a tuple of tensors, so n - 1 additions per output element.
+  const auto* tuple = call->args[0]->checked_type().as<TupleTypeNode>();
+  int num_inputs = tuple ? tuple->fields.size() : 1;
+  double numel = NumElements(call->checked_type());
+  return MakeCost(call, numel < 0 ? -1 : numel * std::max(num_inputs - 1, 0));
+}
+
+RAF_OP_COST("raf.op.add_n", AddNCost);
+
+}  // namespace cost
+}  // namespace op
+}  // namespace raf
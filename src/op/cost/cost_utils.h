@@ -0,0 +1,150 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/cost/cost_utils.h
+ * \brief Helper functions for the analytic cost functions of the ops.
+ */
+#pragma once
+#include <algorithm>
+#include <string>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace op {
+namespace cost {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*! \brief The number of elements of a tensor type, or -1 if it is dynamic or not a tensor. */
+inline double NumElements(const Type& type) {
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return -1;
+  }
+  double ret = 1;
+  for (const auto& dim : ttype->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return -1;
+    }
+    ret *= imm->value;
+  }
+  return ret;
+}
+
+/*! \brief The bytes of a tensor type, or of the tensors of a tuple, or -1 if any is dynamic. */
+inline double BytesOf(const Type& type) {
+  if (const auto* tuple = type.as<TupleTypeNode>()) {
+    double ret = 0;
+    for (const auto& field : tuple->fields) {
+      double bytes = BytesOf(field);
+      if (bytes < 0) {
+        return -1;
+      }
+      ret += bytes;
+    }
+    return ret;
+  }
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return 0;
+  }
+  double numel = NumElements(type);
+  return numel < 0 ? -1 : numel * ((ttype->dtype.bits() * ttype->dtype.lanes() + 7) / 8);
+}
+
+/*!
+ * \brief The dim of a tensor type at the axis, which counts from the end if negative, or -1 if it
+ * is dynamic or out of the dims.
+ */
+inline double DimOf(const Type& type, int axis) {
+  const auto* ttype = type.as<TensorTypeNode>();
+  int ndim = ttype ? ttype->shape.size() : 0;
+  axis = axis < 0 ? axis + ndim : axis;
+  if (axis < 0 || axis >= ndim) {
+    return -1;
+  }
+  const auto* imm = ttype->shape[axis].as<IntImmNode>();
+  return imm == nullptr ? -1 : imm->value;
+}
+
+/*! \brief The string of a constant argument, or empty if it is not a constant string. */
+inline std::string GetConstString(const Expr& arg) {
+  if (const auto* constant = arg.as<ConstantNode>()) {
+    if (const auto* str = constant->value.as<StringValueObj>()) {
+      return str->value;
+    }
+  }
+  return "";
+}
+
+/*!
+ * \brief Make the cost of a call with the given FLOPs. The tensors of the arguments are read and
+ * the output is written, where the constant arguments other than tensors are the attributes.
+ * \param call The call.
+ * \param flops The FLOPs, which is unknown if negative.
+ * \return The cost, or empty if it is unknown.
+ */
+inline Array<FloatImm> MakeCost(const Call& call, double flops) {
+  double bytes_read = 0;
+  for (const auto& arg : call->args) {
+    if (const auto* constant = arg.as<ConstantNode>()) {
+      if (!constant->value.as<TensorValueObj>()) {
+        continue;
+      }
+    }
+    double bytes = BytesOf(arg->checked_type());
+    if (bytes < 0) {
+      return {};
+    }
+    bytes_read += bytes;
+  }
+  double bytes_written = BytesOf(call->checked_type());
+  if (flops < 0 || bytes_written < 0) {
+    return {};
+  }
+  auto f32 = DataType::Float(32);
+  return {FloatImm(f32, flops), FloatImm(f32, bytes_read), FloatImm(f32, bytes_written)};
+}
+
+/*! \brief The cost of an elementwise op, which takes the given FLOPs per output element. */
+template <int kFLOPsPerElement>
+inline Array<FloatImm> ElementwiseCost(const Call& call) {
+  double numel = 0;
+  if (const auto* tuple = call->checked_type().as<TupleTypeNode>()) {
+    // E.g., the primary output of batch_norm_train, which comes with the running stats.
+    numel = NumElements(tuple->fields[0]);
+  } else {
+    numel = NumElements(call->checked_type());
+  }
+  return MakeCost(call, numel < 0 ? -1 : numel * kFLOPsPerElement);
+}
+
+/*! \brief The cost of an op which takes the given FLOPs per element of its first argument. */
+template <int kFLOPsPerElement>
+inline Array<FloatImm> InputElementwiseCost(const Call& call) {
+  CHECK(!call->args.empty());
+  double numel = NumElements(call->args[0]->checked_type());
+  return MakeCost(call, numel < 0 ? -1 : numel * kFLOPsPerElement);
+}
+
+/*! \brief The cost of an op moving the memory without computation. */
+inline Array<FloatImm> MemoryCost(const Call& call) {
+  return MakeCost(call, 0);
+}
+
+/*! \brief The cost of an op which neither computes nor moves the data, e.g., reshape. */
+inline Array<FloatImm> ZeroCost(const Call& call) {
+  auto f32 = DataType::Float(32);
+  return {FloatImm(f32, 0), FloatImm(f32, 0), FloatImm(f32, 0)};
+}
+
+}  // namespace cost
+}  // namespace op
+}  // namespace raf
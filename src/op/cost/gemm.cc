@@ -0,0 +1,43 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/cost/gemm.cc
+ * \brief Analytic cost functions of GEMM operators
+ */
+#include "./cost_utils.h"
+
+namespace raf {
+namespace op {
+namespace cost {
+
+/*!
+ * \brief The cost of a (batched) matmul, which takes a multiply-add per output element and
+ * reduced element. The reduced dim is the last dim of the first operand unless it is transposed.
+ */
+template <bool kTransposeA>
+Array<FloatImm> MatmulCost(const Call& call) {
+  double numel = NumElements(call->checked_type());
+  double k = DimOf(call->args[0]->checked_type(), kTransposeA ? -2 : -1);
+  return MakeCost(call, numel < 0 || k < 0 ? -1 : 2 * numel * k);
+}
+
+RAF_OP_COST("raf.op.matmul", MatmulCost<false>);
+RAF_OP_COST("raf.op.matmul_nt", MatmulCost<false>);
+RAF_OP_COST("raf.op.matmul_tn", MatmulCost<true>);
+RAF_OP_COST("raf.op.matmul_tt", MatmulCost<true>);
+RAF_OP_COST("raf.op.batch_matmul", MatmulCost<false>);
+RAF_OP_COST("raf.op.batch_matmul_nt", MatmulCost<false>);
+RAF_OP_COST("raf.op.batch_matmul_tn", MatmulCost<true>);
+RAF_OP_COST("raf.op.batch_matmul_tt", MatmulCost<true>);
+RAF_OP_COST("raf.op.dense", MatmulCost<false>);
+RAF_OP_COST("raf.op.qnn_dense", MatmulCost<false>);
+RAF_OP_COST("raf.op.qnn_batch_matmul_nt", MatmulCost<false>);
+// Each row of x is multiplied by the weight of its group.
+RAF_OP_COST("raf.op.grouped_matmul", MatmulCost<false>);
+
+}  // namespace cost
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,140 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/cost/nn.cc
+ * \brief Analytic cost functions of neural network operators
+ */
+#include "./cost_utils.h"
+
+namespace raf {
+namespace op {
+namespace cost {
+
+/*!
+ * \brief The FLOPs of a convolution, which takes a multiply-add per element of a feature map and
+ * element of the weight of its channel.
+ * \param feature The type of the feature map, e.g., the output of conv2d.
+ * \param weight The type of the weight.
+ * \param channel_axis The axis of the weight of the channels of the feature map.
+ * \return The FLOPs, or -1 if the shapes are dynamic.
+ */
+double ConvFLOPs(const Type& feature, const Type& weight, int channel_axis) {
+  double channels = DimOf(weight, channel_axis);
+  double numel_feature = NumElements(feature);
+  double numel_weight = NumElements(weight);
+  if (channels <= 0 || numel_feature < 0 || numel_weight < 0) {
+    return -1;
+  }
+  return 2 * numel_feature * numel_weight / channels;
+}
+
+/*! \brief The axis of the channel in the kernel layout of the call, 0 if it is unknown. */
+int KernelAxis(const Call& call, char channel) {
+  // The kernel_layout is the 8th argument of conv2d and conv2d_transpose.
+  std::string kernel_layout = call->args.size() > 7 ? GetConstString(call->args[7]) : "";
+  auto pos = kernel_layout.find(channel);
+  return pos == std::string::npos ? 0 : pos;
+}
+
+Array<FloatImm> Conv2dCost(const Call& call) {
+  // The schema of conv2d is x, w, stride, padding, dilation, groups, layout, kernel_layout.
+  return MakeCost(call, ConvFLOPs(call->checked_type(), call->args[1]->checked_type(),
+                                  KernelAxis(call, 'O')));
+}
+
+RAF_OP_COST("raf.op.conv2d", Conv2dCost);
+RAF_OP_COST("raf.op.qnn_conv2d", Conv2dCost);
+
+Array<FloatImm> Conv2dDxCost(const Call& call) {
+  // The schema of conv2d_dx is w, y, dy, shape, ..., which computes dx by the same multiply-adds
+  // as the forward in OIHW.
+  return MakeCost(call, ConvFLOPs(call->args[2]->checked_type(), call->args[0]->checked_type(), 0));
+}
+
+Array<FloatImm> Conv2dDwCost(const Call& call) {
+  // The schema of conv2d_dw is x, y, dy, shape, ..., where the output is the weight.
+  return MakeCost(call, ConvFLOPs(call->args[2]->checked_type(), call->checked_type(), 0));
+}
+
+RAF_OP_COST("raf.op.conv2d_dx", Conv2dDxCost);
+RAF_OP_COST("raf.op.conv2d_dw", Conv2dDwCost);
+
+Array<FloatImm> Conv2dTransposeCost(const Call& call) {
+  // The transposed convolution takes a multiply-add per element of its input and element of the
+  // weight of its input channel, which is I in the kernel layout, IOHW by default.
+  return MakeCost(call, ConvFLOPs(call->args[0]->checked_type(), call->args[1]->checked_type(),
+                                  KernelAxis(call, 'I')));
+}
+
+Array<FloatImm> Conv2dTransposeDxCost(const Call& call) {
+  // The schema of conv2d_transpose_dx is w, y, dy, shape, ..., where the output is the input.
+  return MakeCost(call, ConvFLOPs(call->checked_type(), call->args[0]->checked_type(), 0));
+}
+
+Array<FloatImm> Conv2dTransposeDwCost(const Call& call) {
+  // The schema of conv2d_transpose_dw is x, y, dy, shape, ..., where the output is the weight.
+  return MakeCost(call, ConvFLOPs(call->args[0]->checked_type(), call->checked_type(), 0));
+}
+
+RAF_OP_COST("raf.op.conv2d_transpose", Conv2dTransposeCost);
+RAF_OP_COST("raf.op.conv2d_transpose_dx", Conv2dTransposeDxCost);
+RAF_OP_COST("raf.op.conv2d_transpose_dw", Conv2dTransposeDwCost);
+
+// The pooling windows read each input element about once.
+RAF_OP_COST("raf.op.max_pool2d", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.avg_pool2d", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.adaptive_max_pool2d", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.adaptive_avg_pool2d", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.max_pool2d_dx", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.avg_pool2d_dx", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.adaptive_max_pool2d_dx", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.adaptive_avg_pool2d_dx", InputElementwiseCost<1>);
+
+// Max, subtract, exp, sum and divide (or log) per element.
+RAF_OP_COST("raf.op.softmax", ElementwiseCost<5>);
+RAF_OP_COST("raf.op.log_softmax", ElementwiseCost<5>);
+RAF_OP_COST("raf.op.softmax_dx", ElementwiseCost<4>);
+RAF_OP_COST("raf.op.log_softmax_dx", ElementwiseCost<4>);
+
+// The mean, the variance, and the normalization with the scale and the bias per element.
+RAF_OP_COST("raf.op.batch_norm_train", ElementwiseCost<8>);
+RAF_OP_COST("raf.op.batch_norm_infer", ElementwiseCost<4>);
+RAF_OP_COST("raf.op.batch_norm_train_dxwb", InputElementwiseCost<10>);
+RAF_OP_COST("raf.op.layer_norm", ElementwiseCost<8>);
+RAF_OP_COST("raf.op.layer_norm_train", ElementwiseCost<8>);
+RAF_OP_COST("raf.op.layer_norm_dx", ElementwiseCost<10>);
+RAF_OP_COST("raf.op.layer_norm_train_dx", ElementwiseCost<10>);
+RAF_OP_COST("raf.op.add_dropout_layer_norm", ElementwiseCost<11>);
+RAF_OP_COST("raf.op.add_dropout_layer_norm_dx", ElementwiseCost<12>);
+
+RAF_OP_COST("raf.op.bias_add", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.threshold", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.threshold_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op._contrib_dropout", ElementwiseCost<2>);
+RAF_OP_COST("raf.op._contrib_dropout_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.counter_dropout", ElementwiseCost<2>);
+RAF_OP_COST("raf.op.counter_dropout_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.pad", MemoryCost);
+
+Array<FloatImm> AttentionCost(const Call& call) {
+  // q and k are of shape [batch, heads, seq, head_dim]. Both q * k^T and p * v take a multiply-add
+  // per element of the scores and head dim, besides the softmax of the scores.
+  const auto& q = call->args[0]->checked_type();
+  double numel_q = NumElements(q);
+  double head_dim = DimOf(q, -1);
+  double kv_seq = DimOf(call->args[1]->checked_type(), -2);
+  if (numel_q < 0 || head_dim <= 0 || kv_seq < 0) {
+    return {};
+  }
+  double numel_scores = numel_q / head_dim * kv_seq;
+  return MakeCost(call, 4 * numel_scores * head_dim + 5 * numel_scores);
+}
+
+RAF_OP_COST("raf.op.attention", AttentionCost);
+
+}  // namespace cost
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,35 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/cost/reduce.cc
+ * \brief Analytic cost functions of reduction operators
+ */
+#include "./cost_utils.h"
+
+namespace raf {
+namespace op {
+namespace cost {
+
+// A reduction takes an operation per element of its input.
+RAF_OP_COST("raf.op.sum", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.mean", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.max", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.min", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.prod", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.argmax", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.argmin", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.all", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.any", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.l2norm", InputElementwiseCost<2>);
+
+// The gradients broadcast the output gradient back to the input.
+RAF_OP_COST("raf.op.sum_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.mean_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.prod_dx", ElementwiseCost<2>);
+
+}  // namespace cost
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,65 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/cost/transform.cc
+ * \brief Analytic cost functions of transform operators
+ */
+#include "./cost_utils.h"
+
+namespace raf {
+namespace op {
+namespace cost {
+
+// The views of their inputs.
+RAF_OP_COST("raf.op.reshape", ZeroCost);
+RAF_OP_COST("raf.op.reshape_like", ZeroCost);
+RAF_OP_COST("raf.op.view", ZeroCost);
+RAF_OP_COST("raf.op.expand_dims", ZeroCost);
+RAF_OP_COST("raf.op.squeeze", ZeroCost);
+RAF_OP_COST("raf.op.batch_flatten", ZeroCost);
+RAF_OP_COST("raf.op.size", ZeroCost);
+
+// The ops copying or generating the data without computation.
+RAF_OP_COST("raf.op.transpose", MemoryCost);
+RAF_OP_COST("raf.op.transpose_dx", MemoryCost);
+RAF_OP_COST("raf.op.swap_axis", MemoryCost);
+RAF_OP_COST("raf.op.broadcast_to", MemoryCost);
+RAF_OP_COST("raf.op.broadcast_to_like", MemoryCost);
+RAF_OP_COST("raf.op.repeat", MemoryCost);
+RAF_OP_COST("raf.op.reverse", MemoryCost);
+RAF_OP_COST("raf.op.reverse_sequence", MemoryCost);
+RAF_OP_COST("raf.op.strided_slice", MemoryCost);
+RAF_OP_COST("raf.op.strided_slice_dx", MemoryCost);
+RAF_OP_COST("raf.op.strided_set", MemoryCost);
+RAF_OP_COST("raf.op.concatenate", MemoryCost);
+RAF_OP_COST("raf.op.concatenate_dx", MemoryCost);
+RAF_OP_COST("raf.op.split", MemoryCost);
+RAF_OP_COST("raf.op.stack", MemoryCost);
+RAF_OP_COST("raf.op.take", MemoryCost);
+RAF_OP_COST("raf.op.embedding", MemoryCost);
+RAF_OP_COST("raf.op.gather", MemoryCost);
+RAF_OP_COST("raf.op.gather_nd", MemoryCost);
+RAF_OP_COST("raf.op.adv_index", MemoryCost);
+RAF_OP_COST("raf.op.cast", MemoryCost);
+RAF_OP_COST("raf.op.cast_like", MemoryCost);
+RAF_OP_COST("raf.op.group_cast", MemoryCost);
+RAF_OP_COST("raf.op.full", MemoryCost);
+RAF_OP_COST("raf.op.full_like", MemoryCost);
+RAF_OP_COST("raf.op.arange", MemoryCost);
+RAF_OP_COST("raf.op.mesh_grid", MemoryCost);
+RAF_OP_COST("raf.op.sequence_mask", MemoryCost);
+
+// The elementwise ops.
+RAF_OP_COST("raf.op.clip", ElementwiseCost<2>);
+RAF_OP_COST("raf.op.clip_dx", ElementwiseCost<2>);
+RAF_OP_COST("raf.op.where", ElementwiseCost<1>);
+// The sum of the broadcast axes.
+RAF_OP_COST("raf.op.collapse_sum_like", InputElementwiseCost<1>);
+RAF_OP_COST("raf.op.cumsum", ElementwiseCost<1>);
+
+}  // namespace cost
+}  // namespace op
+}  // namespace raf
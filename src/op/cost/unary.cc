@@ -0,0 +1,58 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/cost/unary.cc
+ * \brief Analytic cost functions of unary operators
+ */
+#include "./cost_utils.h"
+
+namespace raf {
+namespace op {
+namespace cost {
+
+RAF_OP_COST("raf.op.negative", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.rsqrt", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.logical_not", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.relu", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.gelu", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.tanh", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.sigmoid", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.abs", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.ceil", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.floor", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.log", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.log2", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.exp", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.cos", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.sin", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.sign", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.round", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.erf", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.sqrt", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.atan", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.reciprocal", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.trunc", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.relu_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.gelu_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.tanh_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.sigmoid_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.erf_dx", ElementwiseCost<1>);
+RAF_OP_COST("raf.op.sqrt_dx", ElementwiseCost<1>);
+
+RAF_OP_COST("raf.op.copy", MemoryCost);
+RAF_OP_COST("raf.op.zeros_like", MemoryCost);
+RAF_OP_COST("raf.op.ones_like", MemoryCost);
+
+// The ops reading the shapes only.
+RAF_OP_COST("raf.op.shape", ZeroCost);
+RAF_OP_COST("raf.op.ndarray_size", ZeroCost);
+RAF_OP_COST("raf.op.numel", ZeroCost);
+RAF_OP_COST("raf.op.shape_as_tensor", ZeroCost);
+RAF_OP_COST("raf.op.checkpoint_boundary", ZeroCost);
+
+}  // namespace cost
+}  // namespace op
+}  // namespace raf
@@ -38,6 +38,23 @@ RAF_OP_DECLARE("raf.op.compiler_end", [](const CallValues& call) {
   call->device = x->device;
 });
 
+RAF_OP_DECLARE("raf.op.checkpoint_boundary", [](const CallValues& call) {
+  const auto* args = call->args.as<UnaryArgs>();
+  CHECK(args != nullptr);
+  DLTensor* x = args->x;
+  call->device = x->device;
+  call->callee = ir::NullValue<OpValue>();
+  // The boundary only annotates the tensor for Rematerialization, so it is a view of its input.
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  std::vector<int64_t> strides;
+  if (x->strides != nullptr) {
+    strides.assign(x->strides, x->strides + x->ndim);
+  }
+  void* data = x->data == nullptr ? nullptr : static_cast<char*>(x->data) + x->byte_offset;
+  auto value = Downcast<TensorValue>(args->x);
+  call->out = TensorValue::make(value->tensor.CreateView(shape, strides, data), value->mem);
+});
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
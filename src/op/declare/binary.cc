@@ -108,6 +108,27 @@ RAF_OP_DECLARE("raf.op.add", [](const CallValues& call) {
   throw;
 });
 
+RAF_OP_DECLARE("raf.op.add_n", [](const CallValues& call) {
+  const auto* args = call->args.as<AddNArgs>();
+  CHECK(args != nullptr);
+  const std::vector<BaseTensorValue>& x = args->x;
+  CHECK_GE(x.size(), 1U);
+  DLTensor* x0 = x[0];
+  for (const auto& i : x) {
+    DLTensor* xi = i;
+    CHECK_EQ(xi->ndim, x0->ndim) << "ValueError: add_n expects the inputs of the same shape";
+    for (int k = 0; k < x0->ndim; ++k) {
+      CHECK_EQ(xi->shape[k], x0->shape[k])
+          << "ValueError: add_n expects the inputs of the same shape";
+    }
+  }
+  std::vector<int64_t> shape(x0->shape, x0->shape + x0->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x0->device,
+                                    /*dtype=*/x0->dtype,
+                                    /*shape=*/shape);
+  call->device = x0->device;
+});
+
 RAF_OP_DECLARE("raf.op.subtract", [](const CallValues& call) {
   const auto* args = call->args.as<BinaryUfuncArgs>();
   CHECK(args != nullptr);
@@ -205,6 +205,159 @@ RAF_OP_DECLARE("raf.op._all_to_all", AllToAll)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFCollective>("TRAFCollective", true);
 
+void AllToAllv(const CallValues& call) {
+  const auto* args = call->args.as<AllToAllvArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* send_counts = args->send_counts;
+  call->device = x->device;
+  int64_t size;
+  if (args->rank_list.defined()) {
+    size = Communicator::Get("void", args->rank_list)->size;
+  } else {
+    size = GetGlobalCommunicator()->size;
+  }
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  CHECK(shape[0] % size == 0) << "Input tensor with first dim shape " << shape[0]
+                              << " cannot be split into " << size << " segments evenly";
+  CHECK(send_counts->ndim == 1 && send_counts->shape[0] == size &&
+        send_counts->dtype.code == kDLInt && send_counts->dtype.bits == 64)
+      << "Expected the send counts to be an int64 tensor of shape (" << size << ",)";
+  call->out = TupleValue::make({TensorValue::Assemble(/*dev=*/x->device,
+                                                      /*dtype=*/x->dtype,
+                                                      /*shape=*/shape),
+                                TensorValue::Assemble(/*dev=*/send_counts->device,
+                                                      /*dtype=*/send_counts->dtype,
+                                                      /*shape=*/{size})});
+}
+
+RAF_OP_DECLARE("raf.op._all_to_allv", AllToAllv)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
+void VocabParallelCrossEntropy(const CallValues& call) {
+  const auto* args = call->args.as<VocabParallelCrossEntropyArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* pred = args->y_pred;
+  const DLTensor* true_ = args->y_true;
+  CHECK_EQ(pred->ndim, 2);
+  CHECK_EQ(true_->ndim, 1) << "vocab_parallel_cross_entropy expects the labels of (n,)";
+  CHECK_EQ(pred->shape[0], true_->shape[0]);
+  call->device = pred->device;
+  call->out = TensorValue::Assemble(/*dev=*/pred->device,
+                                    /*dtype=*/pred->dtype,
+                                    /*shape=*/std::vector<int64_t>{1});
+}
+
+RAF_OP_DECLARE("raf.op._vocab_parallel_cross_entropy", VocabParallelCrossEntropy)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
+void VocabParallelCrossEntropyDpred(const CallValues& call) {
+  const auto* args = call->args.as<VocabParallelCrossEntropyDpredArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* pred = args->y_pred;
+  const DLTensor* true_ = args->y_true;
+  CHECK_EQ(pred->ndim, 2);
+  CHECK_EQ(pred->shape[0], true_->shape[0]);
+  call->device = pred->device;
+  call->out = TensorValue::Assemble(/*dev=*/pred->device,
+                                    /*dtype=*/pred->dtype,
+                                    /*shape=*/std::vector<int64_t>{pred->shape[0], pred->shape[1]});
+}
+
+RAF_OP_DECLARE("raf.op._vocab_parallel_cross_entropy_dpred", VocabParallelCrossEntropyDpred)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
+void SyncBatchNormTrain(const CallValues& call) {
+  const auto* args = call->args.as<SyncBatchNormArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CHECK_GE(x->ndim, 2) << "sync_batch_norm expects the input of (n, c, ...)";
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  TensorValue y = TensorValue::Assemble(/*dev=*/x->device,
+                                        /*dtype=*/x->dtype,
+                                        /*shape=*/shape);
+  TensorValue running_mean = Downcast<TensorValue>(args->running_mean);
+  std::vector<int64_t> running_mean_shape(running_mean->tensor.Shape().begin(),
+                                          running_mean->tensor.Shape().end());
+  running_mean = running_mean.CreateView(running_mean_shape);
+  TensorValue running_var = Downcast<TensorValue>(args->running_var);
+  std::vector<int64_t> running_var_shape(running_var->tensor.Shape().begin(),
+                                         running_var->tensor.Shape().end());
+  running_var = running_var.CreateView(running_var_shape);
+  call->out = TupleValue::make(tvm::Array<Value>({y, running_mean, running_var}));
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._sync_batch_norm_train", SyncBatchNormTrain)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{1, 1}, {2, 2}});
+
+void SyncBatchNormTrainDxwb(const CallValues& call) {
+  const auto* args = call->args.as<SyncBatchNormDxwbArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  std::vector<int64_t> xshape(x->shape, x->shape + x->ndim);
+  std::vector<int64_t> wshape(w->shape, w->shape + w->ndim);
+  TensorValue dx = TensorValue::Assemble(/*dev=*/x->device,
+                                         /*dtype=*/x->dtype,
+                                         /*shape=*/xshape);
+  TensorValue dw = TensorValue::Assemble(/*dev=*/w->device,
+                                         /*dtype=*/w->dtype,
+                                         /*shape=*/wshape);
+  TensorValue db = TensorValue::Assemble(/*dev=*/w->device,
+                                         /*dtype=*/w->dtype,
+                                         /*shape=*/wshape);
+  call->out = TupleValue::make(tvm::Array<Value>({dx, dw, db}));
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op._sync_batch_norm_train_dxwb", SyncBatchNormTrainDxwb)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
+/*! \brief The shape of a sequence-parallel tensor whose first axis is scattered or gathered. */
+template <bool scatter>
+void SequenceParallel(const CallValues& call) {
+  const auto* args = call->args.as<SequenceParallelArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  CHECK(x->ndim > 0) << "The sequence-parallel tensor should have the sequence axis";
+  int size;
+  if (args->rank_list.defined()) {
+    size = Communicator::Get("void", args->rank_list)->size;
+  } else {
+    size = GetGlobalCommunicator()->size;
+  }
+  if (scatter) {
+    CHECK(shape[0] % size == 0) << "Input tensor with first dim shape " << shape[0]
+                                << " cannot be scattered to " << size << " devices evenly";
+    shape[0] = shape[0] / size;
+  } else {
+    shape[0] = shape[0] * size;
+  }
+  call->device = x->device;
+  call->out = TensorValue::Assemble(/*ctx=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/shape);
+}
+
+static const auto SequenceScatter = SequenceParallel<true>;
+static const auto SequenceGather = SequenceParallel<false>;
+
+RAF_OP_DECLARE("raf.op._sequence_scatter", SequenceScatter)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
+RAF_OP_DECLARE("raf.op._sequence_gather", SequenceGather)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFCollective>("TRAFCollective", true);
+
 RAF_OP_DECLARE("raf.op._send", Send)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFCollective>("TRAFCollective", true);
@@ -7,9 +7,11 @@
  * \file src/op/declare/gemm.cc
  * \brief Declaration of genmm-related operators
  */
+#include <algorithm>
 #include "raf/op.h"
 #include "raf/tensor.h"
 #include "../schema/ufunc.h"
+#include "../schema/nn.h"
 
 namespace raf {
 namespace op {
@@ -128,6 +130,67 @@ RAF_OP_DECLARE("raf.op.dense", [](const CallValues& call) {
   }
 });
 
+/*!
+ * \brief The int8 GEMMs, i.e., dense and batch_matmul_nt, whose int32 outputs are accumulated
+ * without overflow and rescaled by dequantize.
+ */
+template <bool batched>
+void QnnGemmDecl(const CallValues& call) {
+  const auto* args = call->args.as<schema::BinaryArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* a = args->x1;
+  const DLTensor* b = args->x2;
+  // a is of shape [(k1,) n, m], and b is of shape [(k2,) n2, m]
+  CHECK_EQ(a->ndim, 2 + batched);
+  CHECK_EQ(b->ndim, 2 + batched);
+  CHECK_EQ(a->shape[1 + batched], b->shape[1 + batched]);
+  CHECK(DType(a->dtype) == DType(DTypeCode::kInt(), 8) &&
+        DType(b->dtype) == DType(DTypeCode::kInt(), 8))
+      << "Only int8 is supported!";
+  std::vector<int64_t> oshape{a->shape[batched], b->shape[batched]};
+  if (batched) {
+    int64_t k1 = a->shape[0];
+    int64_t k2 = b->shape[0];
+    CHECK(k1 == k2 || k1 == 1 || k2 == 1)
+        << "Incompatible broadcast batch size " << k1 << " and " << k2;
+    oshape.insert(oshape.begin(), std::max(k1, k2));
+  }
+  call->out = TensorValue::Assemble(/*dev=*/a->device, /*dtype=*/DType(DTypeCode::kInt(), 32),
+                                    /*shape=*/oshape);
+  call->device = a->device;
+  for (int i = 0; i < a->ndim; ++i) {
+    if (!a->shape[i] || !b->shape[i]) {
+      call->callee = ir::NullValue<OpValue>();
+    }
+  }
+}
+
+RAF_OP_DECLARE("raf.op.qnn_dense", QnnGemmDecl<false>);
+RAF_OP_DECLARE("raf.op.qnn_batch_matmul_nt", QnnGemmDecl<true>);
+
+RAF_OP_DECLARE("raf.op.grouped_matmul", [](const CallValues& call) {
+  const auto* args = call->args.as<schema::GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->weight;
+  const DLTensor* group_sizes = args->group_sizes;
+  // x is of shape [T, K], the rows of x are split into G consecutive groups whose sizes are
+  // given by group_sizes, and the i-th group is multiplied by weight[i] of shape [K, N].
+  CHECK_EQ(x->ndim, 2);
+  CHECK_EQ(w->ndim, 3);
+  CHECK_EQ(group_sizes->ndim, 1);
+  CHECK_EQ(x->shape[1], w->shape[1]);
+  CHECK_EQ(w->shape[0], group_sizes->shape[0]);
+  CHECK(x->dtype.code == kDLFloat) << "Only float types are supported!";
+  CHECK(group_sizes->dtype.code == kDLInt) << "group_sizes must be integers!";
+  call->out = TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/x->dtype,
+                                    /*shape=*/std::vector<int64_t>{x->shape[0], w->shape[2]});
+  call->device = x->device;
+  if (!x->shape[0] || !x->shape[1] || !w->shape[0] || !w->shape[2]) {
+    call->callee = ir::NullValue<OpValue>();
+  }
+});
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
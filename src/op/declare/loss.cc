@@ -128,6 +128,33 @@ RAF_OP_DECLARE("raf.op.cross_entropy_dtrue", [](const CallValues& call) {
   call->device = true_->device;
 });
 
+RAF_OP_DECLARE("raf.op.softmax_cross_entropy", [](const CallValues& call) {
+  const auto* args = call->args.as<LossArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* pred = args->y_pred;
+  const DLTensor* true_ = args->y_true;
+  CHECK_EQ(pred->ndim, 2);
+  CHECK_EQ(true_->ndim, 1) << "softmax_cross_entropy expects the labels of (n,)";
+  CHECK_EQ(pred->shape[0], true_->shape[0]);
+  call->out = TensorValue::Assemble(/*dev=*/pred->device,
+                                    /*dtype=*/pred->dtype,
+                                    /*shape=*/std::vector<int64_t>{1});
+  call->device = pred->device;
+});
+
+RAF_OP_DECLARE("raf.op.softmax_cross_entropy_dpred", [](const CallValues& call) {
+  const auto* args = call->args.as<LossDtpArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* pred = args->y_pred;
+  const DLTensor* true_ = args->y_true;
+  CHECK_EQ(pred->ndim, 2);
+  CHECK_EQ(true_->ndim, 1) << "softmax_cross_entropy expects the labels of (n,)";
+  CHECK_EQ(pred->shape[0], true_->shape[0]);
+  call->out = TensorValue::Assemble(pred->device, pred->dtype,
+                                    std::vector<int64_t>{pred->shape[0], pred->shape[1]});
+  call->device = pred->device;
+});
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
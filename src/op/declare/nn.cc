@@ -95,6 +95,44 @@ void Conv2D(const CallValues& call) {
 
 RAF_OP_DECLARE("raf.op.conv2d", Conv2D);
 
+RAF_OP_DECLARE("raf.op.qnn_conv2d", [](const CallValues& call) {
+  // The int8 conv2d accumulates in int32, and otherwise has the shape of conv2d.
+  const auto* args = call->args.as<ConvArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* w = args->w;
+  CHECK(DType(x->dtype) == DType(DTypeCode::kInt(), 8) &&
+        DType(w->dtype) == DType(DTypeCode::kInt(), 8))
+      << "Only int8 is supported!";
+  Conv2D(call);
+  const DLTensor* out = Downcast<TensorValue>(call->out);
+  std::vector<int64_t> oshape(out->shape, out->shape + out->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/DType(DTypeCode::kInt(), 32),
+                                    /*shape=*/oshape);
+});
+
+RAF_OP_DECLARE("raf.op.quantize", [](const CallValues& call) {
+  const auto* args = call->args.as<QuantizeArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CHECK(args->dtype == "int8") << "Only int8 quantization is supported, but got " << args->dtype;
+  CHECK_GT(args->scale, 0) << "The scale must be positive";
+  call->out = TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/DType(DTypeCode::kInt(), 8),
+                                    /*shape=*/std::vector<int64_t>(x->shape, x->shape + x->ndim));
+  call->device = x->device;
+});
+
+RAF_OP_DECLARE("raf.op.dequantize", [](const CallValues& call) {
+  const auto* args = call->args.as<DequantizeArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CHECK(x->dtype.code == kDLInt) << "Only integers can be dequantized!";
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/ir::String2DLDataType(args->dtype),
+                                    /*shape=*/std::vector<int64_t>(x->shape, x->shape + x->ndim));
+  call->device = x->device;
+});
+
 void Conv2dTrans(const CallValues& call) {
   // N.B.: NCHW + IOHW
   const auto* args = call->args.as<ConvTransArgs>();
@@ -445,6 +483,36 @@ void DropoutDx(const CallValues& call) {
 
 RAF_OP_DECLARE("raf.op._contrib_dropout_dx", DropoutDx);
 
+void CounterDropout(const CallValues& call) {
+  const auto* args = call->args.as<CounterDropoutArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  const DLTensor* key = args->key;
+  CHECK_EQ(tvm::runtime::DLDataType2String(key->dtype), "uint64")
+      << "The type of key must be uint64";
+  CHECK(args->p >= 0 && args->p < 1) << "The dropout rate " << args->p << " is out of [0, 1)";
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/shape);
+  call->device = x->device;
+}
+
+RAF_OP_DECLARE("raf.op.counter_dropout", CounterDropout);
+
+void CounterDropoutDx(const CallValues& call) {
+  const auto* args = call->args.as<CounterDropoutDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* dy = args->dy;
+  std::vector<int64_t> shape(dy->shape, dy->shape + dy->ndim);
+  call->out = TensorValue::Assemble(/*dev=*/dy->device,
+                                    /*dtype=*/dy->dtype,
+                                    /*shape=*/shape);
+  call->device = dy->device;
+}
+
+RAF_OP_DECLARE("raf.op.counter_dropout_dx", CounterDropoutDx);
+
 void LayerNorm(const CallValues& call) {
   const auto* args = call->args.as<LayerNormArgs>();
   CHECK(args != nullptr);
@@ -611,6 +679,391 @@ void LayerNormTrain(const CallValues& call) {
 }
 RAF_OP_DECLARE("raf.op.layer_norm_train", LayerNormTrain);
 
+/*!
+ * \brief Check the shapes of the attention, where q, k and v are in the layout of
+ * (batch, [heads,] seq, head_dim), and the additive mask is broadcast as (batch, 1, ..., seq_k).
+ */
+void CheckAttentionShapes(const DLTensor* q, const DLTensor* k, const DLTensor* v,
+                          const DLTensor* mask) {
+  CHECK(q->ndim == 3 || q->ndim == 4) << "Expected q of 3 or 4 dims, but got " << q->ndim;
+  CHECK_EQ(k->ndim, q->ndim);
+  CHECK_EQ(v->ndim, q->ndim);
+  int ndim = q->ndim;
+  for (int i = 0; i < ndim - 2; ++i) {
+    CHECK_EQ(k->shape[i], q->shape[i]);
+    CHECK_EQ(v->shape[i], q->shape[i]);
+  }
+  CHECK_EQ(k->shape[ndim - 1], q->shape[ndim - 1]) << "Mismatched head dims of q and k";
+  CHECK_EQ(v->shape[ndim - 1], q->shape[ndim - 1]) << "Mismatched head dims of q and v";
+  CHECK_EQ(v->shape[ndim - 2], k->shape[ndim - 2]) << "Mismatched sequence lengths of k and v";
+  if (mask != nullptr) {
+    CHECK_EQ(mask->shape[mask->ndim - 1], k->shape[ndim - 2]) << "Mismatched mask length";
+    int64_t batch = 1;
+    for (int i = 0; i < mask->ndim - 1; ++i) {
+      batch *= mask->shape[i];
+    }
+    CHECK_EQ(batch, q->shape[0]) << "Expected a mask of shape (batch, 1, ..., seq_k)";
+  }
+}
+
+void Attention(const CallValues& call) {
+  const auto* args = call->args.as<AttentionArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* q = args->q;
+  const DLTensor* k = args->k;
+  const DLTensor* v = args->v;
+  const DLTensor* mask = nullptr;
+  if (args->mask.defined()) {
+    mask = args->mask.value();
+  }
+  CheckAttentionShapes(q, k, v, mask);
+  CHECK(args->dropout_p >= 0 && args->dropout_p < 1) << "Invalid dropout_p " << args->dropout_p;
+  std::vector<int64_t> shape(q->shape, q->shape + q->ndim);
+  TensorValue out = TensorValue::Assemble(/*dev=*/q->device,
+                                          /*dtype=*/q->dtype,
+                                          /*shape=*/shape);
+  // The log-sum-exp of each row of the attention scores, which is kept for the backward.
+  shape.pop_back();
+  TensorValue lse = TensorValue::Assemble(/*dev=*/q->device,
+                                          /*dtype=*/String2DLDataType("float32"),
+                                          /*shape=*/shape);
+  call->device = q->device;
+  call->out = TupleValue::make(tvm::Array<Value>({out, lse}));
+}
+
+RAF_OP_DECLARE("raf.op.attention", Attention).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void AttentionDx(const CallValues& call) {
+  const auto* args = call->args.as<AttentionDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* q = args->q;
+  const DLTensor* k = args->k;
+  const DLTensor* v = args->v;
+  const DLTensor* mask = nullptr;
+  if (args->mask.defined()) {
+    mask = args->mask.value();
+  }
+  CheckAttentionShapes(q, k, v, mask);
+  Array<Value> grads;
+  for (const DLTensor* x : {q, k, v}) {
+    grads.push_back(TensorValue::Assemble(/*dev=*/x->device,
+                                          /*dtype=*/x->dtype,
+                                          /*shape=*/std::vector<int64_t>(x->shape,
+                                                                         x->shape + x->ndim)));
+  }
+  call->device = q->device;
+  call->out = TupleValue::make(grads);
+}
+
+RAF_OP_DECLARE("raf.op.attention_dx", AttentionDx).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief The attention of the new tokens q of (batch, heads, seq_q, dim) over the paged caches of
+ * (num_blocks, heads, block_size, dim), where the keys and values of the sequence b are read
+ * through its row of block_table of (batch, max_blocks). lengths[b] is the number of the cached
+ * tokens of the sequence including the new ones, so the query i is at the token
+ * lengths[b] - seq_q + i and attends to the tokens up to it.
+ */
+void PagedAttention(const CallValues& call) {
+  const auto* args = call->args.as<PagedAttentionArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* q = args->q;
+  const DLTensor* k_cache = args->k_cache;
+  const DLTensor* v_cache = args->v_cache;
+  const DLTensor* block_table = args->block_table;
+  const DLTensor* lengths = args->lengths;
+  CHECK_EQ(q->ndim, 4) << "paged_attention expects q of (batch, heads, seq_q, dim)";
+  CHECK_EQ(k_cache->ndim, 4) << "paged_attention expects the caches of (num_blocks, heads, "
+                                "block_size, dim)";
+  for (int i = 0; i < 4; ++i) {
+    CHECK_EQ(v_cache->shape[i], k_cache->shape[i]) << "Mismatched shapes of the caches";
+  }
+  CHECK_EQ(k_cache->shape[1], q->shape[1]) << "Mismatched heads of q and the caches";
+  CHECK_EQ(k_cache->shape[3], q->shape[3]) << "Mismatched head dims of q and the caches";
+  CHECK(block_table->ndim == 2 && block_table->shape[0] == q->shape[0])
+      << "paged_attention expects a block table of (batch, max_blocks)";
+  CHECK(lengths->ndim == 1 && lengths->shape[0] == q->shape[0])
+      << "paged_attention expects a length per sequence";
+  call->device = q->device;
+  call->out = TensorValue::Assemble(/*dev=*/q->device,
+                                    /*dtype=*/q->dtype,
+                                    /*shape=*/std::vector<int64_t>(q->shape, q->shape + q->ndim));
+}
+
+RAF_OP_DECLARE("raf.op.paged_attention", PagedAttention)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+
+/*!
+ * \brief The block-sparse product of x1 of (batch, m, k) and x2 of (batch, n, k), i.e., x1 * x2^T,
+ * which only computes the non-zero blocks of the layout of (m / block) x (n / block) blocks. The
+ * output is the compact blocks of (batch, nnz, block, block).
+ */
+void BlockSparseSdd(const CallValues& call) {
+  const auto* args = call->args.as<BlockSparseSddArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x1 = args->x1;
+  const DLTensor* x2 = args->x2;
+  CHECK(x1->ndim == 3 && x2->ndim == 3) << "block_sparse_matmul_sdd expects x1 of (batch, m, k) "
+                                           "and x2 of (batch, n, k)";
+  CHECK_EQ(x1->shape[0], x2->shape[0]) << "Mismatched batches of x1 and x2";
+  CHECK_EQ(x1->shape[2], x2->shape[2]) << "Mismatched inner dims of x1 and x2";
+  BlockSparseShape shape = GetBlockSparseShape(args->layout, args->block);
+  CHECK(x1->shape[1] == shape.rows * args->block && x2->shape[1] == shape.cols * args->block)
+      << "The block layout of " << shape.rows << " x " << shape.cols << " blocks of "
+      << args->block << " does not match x1 and x2";
+  call->device = x1->device;
+  std::vector<int64_t> oshape{x1->shape[0], shape.nnz, args->block, args->block};
+  call->out = TensorValue::Assemble(/*dev=*/x1->device,
+                                    /*dtype=*/x1->dtype,
+                                    /*shape=*/oshape);
+}
+
+RAF_OP_DECLARE("raf.op.block_sparse_matmul_sdd", BlockSparseSdd)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief The product of the block-sparse a of (batch, nnz, block, block) and the dense x of
+ * (batch, r, k), i.e., a * x, or a^T * x if transpose_a, where the inner dim r is the cols of the
+ * layout, or its rows if transposed. The output is dense.
+ */
+void BlockSparseDsd(const CallValues& call) {
+  const auto* args = call->args.as<BlockSparseDsdArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* a = args->a;
+  const DLTensor* x = args->x;
+  CHECK(a->ndim == 4 && x->ndim == 3) << "block_sparse_matmul_dsd expects a of (batch, nnz, "
+                                         "block, block) and x of (batch, r, k)";
+  BlockSparseShape shape = GetBlockSparseShape(args->layout, args->block);
+  CHECK(a->shape[0] == x->shape[0] && a->shape[1] == shape.nnz && a->shape[2] == args->block &&
+        a->shape[3] == args->block)
+      << "The blocks of a do not match the block layout";
+  int64_t inner = args->transpose_a ? shape.rows : shape.cols;
+  int64_t outer = args->transpose_a ? shape.cols : shape.rows;
+  CHECK_EQ(x->shape[1], inner * args->block) << "The inner dim of x does not match the layout";
+  call->device = x->device;
+  std::vector<int64_t> oshape{x->shape[0], outer * args->block, x->shape[2]};
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/oshape);
+}
+
+RAF_OP_DECLARE("raf.op.block_sparse_matmul_dsd", BlockSparseDsd)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief The softmax of each row of the block-sparse x of (batch, nnz, block, block) over its
+ * non-zero blocks, where each input is scaled by scale first. The zero blocks are out of the
+ * softmax, and the inputs above the diagonal are also out if causal.
+ */
+void BlockSparseSoftmax(const CallValues& call) {
+  const auto* args = call->args.as<BlockSparseSoftmaxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  BlockSparseShape shape = GetBlockSparseShape(args->layout, args->block);
+  CHECK(x->ndim == 4 && x->shape[1] == shape.nnz && x->shape[2] == args->block &&
+        x->shape[3] == args->block)
+      << "The blocks of x do not match the block layout";
+  call->device = x->device;
+  call->out = TensorValue::Assemble(/*dev=*/x->device,
+                                    /*dtype=*/x->dtype,
+                                    /*shape=*/std::vector<int64_t>(x->shape, x->shape + x->ndim));
+}
+
+RAF_OP_DECLARE("raf.op.block_sparse_softmax", BlockSparseSoftmax)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void BlockSparseSoftmaxDx(const CallValues& call) {
+  const auto* args = call->args.as<BlockSparseSoftmaxDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* y = args->y;
+  const DLTensor* dy = args->dy;
+  BlockSparseShape shape = GetBlockSparseShape(args->layout, args->block);
+  CHECK(y->ndim == 4 && y->shape[1] == shape.nnz && y->shape[2] == args->block &&
+        y->shape[3] == args->block)
+      << "The blocks of y do not match the block layout";
+  std::vector<int64_t> oshape(y->shape, y->shape + y->ndim);
+  CHECK(std::vector<int64_t>(dy->shape, dy->shape + dy->ndim) == oshape)
+      << "Mismatched shapes of y and dy";
+  call->device = y->device;
+  call->out = TensorValue::Assemble(/*dev=*/y->device,
+                                    /*dtype=*/y->dtype,
+                                    /*shape=*/oshape);
+}
+
+RAF_OP_DECLARE("raf.op.block_sparse_softmax_dx", BlockSparseSoftmaxDx)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief Check the shapes of the fused add + dropout + layer_norm, which normalizes the last axis
+ * of residual + dropout(x) with the scale and bias of the last dimension.
+ */
+void CheckAddDropoutLayerNormShapes(const DLTensor* x, const DLTensor* residual,
+                                    const DLTensor* scale) {
+  CHECK_EQ(residual->ndim, x->ndim);
+  for (int i = 0; i < x->ndim; ++i) {
+    CHECK_EQ(residual->shape[i], x->shape[i]) << "Mismatched shapes of x and residual";
+  }
+  CHECK(scale->ndim == 1 && scale->shape[0] == x->shape[x->ndim - 1])
+      << "Expected the scale of the last dimension";
+}
+
+void AddDropoutLayerNorm(const CallValues& call) {
+  const auto* args = call->args.as<AddDropoutLayerNormArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x = args->x;
+  CheckAddDropoutLayerNormShapes(x, args->residual, args->scale);
+  CHECK(args->p >= 0 && args->p < 1) << "Invalid p " << args->p;
+  std::vector<int64_t> shape(x->shape, x->shape + x->ndim);
+  int64_t n = 1;
+  for (int i = 0; i < x->ndim - 1; ++i) {
+    n *= x->shape[i];
+  }
+  TensorValue y = TensorValue::Assemble(/*dev=*/x->device,
+                                        /*dtype=*/x->dtype,
+                                        /*shape=*/shape);
+  TensorValue mean = TensorValue::Assemble(/*dev=*/x->device,
+                                           /*dtype=*/String2DLDataType("float32"),
+                                           /*shape=*/{n});
+  TensorValue invvar = TensorValue::Assemble(/*dev=*/x->device,
+                                             /*dtype=*/String2DLDataType("float32"),
+                                             /*shape=*/{n});
+  // The input of the layer_norm, which is kept for the backward.
+  TensorValue pre_norm = TensorValue::Assemble(/*dev=*/x->device,
+                                               /*dtype=*/x->dtype,
+                                               /*shape=*/shape);
+  // The dropout mask is empty if there is no dropout.
+  std::vector<int64_t> mask_shape;
+  if (args->p > 0) {
+    mask_shape = shape;
+  }
+  TensorValue mask = TensorValue::Assemble(/*dev=*/x->device,
+                                           /*dtype=*/DType(DTypeCode::kUInt(), 8),
+                                           /*shape=*/mask_shape);
+  call->device = x->device;
+  call->out = TupleValue::make(tvm::Array<Value>({y, mean, invvar, pre_norm, mask}));
+}
+
+RAF_OP_DECLARE("raf.op.add_dropout_layer_norm", AddDropoutLayerNorm)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void AddDropoutLayerNormDx(const CallValues& call) {
+  const auto* args = call->args.as<AddDropoutLayerNormDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* dy = args->dy;
+  const DLTensor* scale = args->scale;
+  CheckAddDropoutLayerNormShapes(dy, args->pre_norm, scale);
+  std::vector<int64_t> shape(dy->shape, dy->shape + dy->ndim);
+  std::vector<int64_t> scale_shape(scale->shape, scale->shape + scale->ndim);
+  Array<Value> grads;
+  for (int i = 0; i < 2; ++i) {
+    grads.push_back(TensorValue::Assemble(/*dev=*/dy->device,
+                                          /*dtype=*/dy->dtype,
+                                          /*shape=*/shape));
+  }
+  for (int i = 0; i < 2; ++i) {
+    grads.push_back(TensorValue::Assemble(/*dev=*/dy->device,
+                                          /*dtype=*/scale->dtype,
+                                          /*shape=*/scale_shape));
+  }
+  call->device = dy->device;
+  call->out = TupleValue::make(grads);
+}
+
+RAF_OP_DECLARE("raf.op.add_dropout_layer_norm_dx", AddDropoutLayerNormDx)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief Check the shapes of the fused embedding + layer_norm, which gathers the rows of the
+ * tables of (num, hidden) by the ids of the same shape, sums and normalizes them.
+ */
+void CheckEmbeddingLayerNormShapes(const std::vector<const DLTensor*>& tables,
+                                   const std::vector<const DLTensor*>& ids,
+                                   const DLTensor* scale) {
+  int64_t hidden = tables[0]->shape[1];
+  for (size_t i = 0; i < tables.size(); ++i) {
+    CHECK(tables[i]->ndim == 2 && tables[i]->shape[1] == hidden)
+        << "embedding_layer_norm expects the tables of (num, hidden)";
+    CHECK(std::vector<int64_t>(ids[i]->shape, ids[i]->shape + ids[i]->ndim) ==
+          std::vector<int64_t>(ids[0]->shape, ids[0]->shape + ids[0]->ndim))
+        << "embedding_layer_norm expects the ids of the same shape";
+  }
+  CHECK(scale->ndim == 1 && scale->shape[0] == hidden) << "Expected the scale of the hidden dim";
+}
+
+void EmbeddingLayerNorm(const CallValues& call) {
+  const auto* args = call->args.as<EmbeddingLayerNormArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* word = args->word;
+  const DLTensor* word_ids = args->word_ids;
+  std::vector<const DLTensor*> tables{word, args->pos};
+  std::vector<const DLTensor*> ids{word_ids, args->pos_ids};
+  CHECK_EQ(args->token_type.defined(), args->token_type_ids.defined())
+      << "embedding_layer_norm expects both the token type table and ids, or neither";
+  if (args->token_type.defined()) {
+    tables.push_back(args->token_type.value());
+    ids.push_back(args->token_type_ids.value());
+  }
+  CheckEmbeddingLayerNormShapes(tables, ids, args->scale);
+  CHECK(args->p >= 0 && args->p < 1) << "Invalid p " << args->p;
+  std::vector<int64_t> shape(word_ids->shape, word_ids->shape + word_ids->ndim);
+  int64_t n = 1;
+  for (int64_t dim : shape) {
+    n *= dim;
+  }
+  shape.push_back(word->shape[1]);
+  TensorValue y = TensorValue::Assemble(/*dev=*/word->device,
+                                        /*dtype=*/word->dtype,
+                                        /*shape=*/shape);
+  TensorValue mean = TensorValue::Assemble(/*dev=*/word->device,
+                                           /*dtype=*/String2DLDataType("float32"),
+                                           /*shape=*/{n});
+  TensorValue invvar = TensorValue::Assemble(/*dev=*/word->device,
+                                             /*dtype=*/String2DLDataType("float32"),
+                                             /*shape=*/{n});
+  // The sum of the embeddings, i.e., the input of the layer_norm, which is kept for the backward.
+  TensorValue pre_norm = TensorValue::Assemble(/*dev=*/word->device,
+                                               /*dtype=*/word->dtype,
+                                               /*shape=*/shape);
+  // The dropout mask of the output is empty if there is no dropout.
+  std::vector<int64_t> mask_shape;
+  if (args->p > 0) {
+    mask_shape = shape;
+  }
+  TensorValue mask = TensorValue::Assemble(/*dev=*/word->device,
+                                           /*dtype=*/DType(DTypeCode::kUInt(), 8),
+                                           /*shape=*/mask_shape);
+  call->device = word->device;
+  call->out = TupleValue::make(tvm::Array<Value>({y, mean, invvar, pre_norm, mask}));
+}
+
+RAF_OP_DECLARE("raf.op.embedding_layer_norm", EmbeddingLayerNorm)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+void EmbeddingLayerNormDx(const CallValues& call) {
+  const auto* args = call->args.as<AddDropoutLayerNormDxArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* dy = args->dy;
+  const DLTensor* scale = args->scale;
+  CheckAddDropoutLayerNormShapes(dy, args->pre_norm, scale);
+  std::vector<int64_t> shape(dy->shape, dy->shape + dy->ndim);
+  std::vector<int64_t> scale_shape(scale->shape, scale->shape + scale->ndim);
+  // The gradients of the sum of the embeddings, which feeds embedding_dx, the scale and the bias.
+  Array<Value> grads{TensorValue::Assemble(/*dev=*/dy->device,
+                                           /*dtype=*/dy->dtype,
+                                           /*shape=*/shape)};
+  for (int i = 0; i < 2; ++i) {
+    grads.push_back(TensorValue::Assemble(/*dev=*/dy->device,
+                                          /*dtype=*/scale->dtype,
+                                          /*shape=*/scale_shape));
+  }
+  call->device = dy->device;
+  call->out = TupleValue::make(grads);
+}
+
+RAF_OP_DECLARE("raf.op.embedding_layer_norm_dx", EmbeddingLayerNormDx)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque);
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
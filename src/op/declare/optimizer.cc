@@ -41,15 +41,64 @@ RAF_OP_DECLARE("raf.op.sgd", [](const CallValues& call) {
       /*shape=*/std::vector<int64_t>(dx->shape, dx->shape + dx->ndim));
   call->out = TupleValue::make(tvm::Array<Value>({v1, x1}));
   call->device = dx->device;
-});
+}).set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 1}, {2, 0}});
+
+/*!
+ * \brief SGD of a row-sparse gradient, e.g., of embedding_sparse_dx. Only the given rows of the
+ * weight and the momentum are updated, and the rows of -1 are skipped. The momentum of the other
+ * rows is not decayed, i.e., the lazy momentum, which is the same as SGD if mu is 0.
+ */
+RAF_OP_DECLARE("raf.op.sparse_sgd", [](const CallValues& call) {
+  const auto* args = call->args.as<SparseSgdArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* x0 = args->x;
+  const DLTensor* rows = args->rows;
+  const DLTensor* values = args->values;
+  const DLTensor* v0 = args->v;
+  CHECK_EQ(rows->ndim, 1);
+  CHECK_EQ(values->ndim, x0->ndim);
+  CHECK_EQ(values->shape[0], rows->shape[0]);
+  CHECK_EQ(v0->ndim, x0->ndim);
+  for (int i = 0; i < x0->ndim; ++i) {
+    CHECK(i == 0 || values->shape[i] == x0->shape[i]);
+    CHECK_EQ(v0->shape[i], x0->shape[i]);
+  }
+  std::vector<int64_t> shape(x0->shape, x0->shape + x0->ndim);
+  auto v1 = TensorValue::Assemble(/*dev=*/x0->device, /*dtype=*/x0->dtype, /*shape=*/shape);
+  auto x1 = TensorValue::Assemble(/*dev=*/x0->device, /*dtype=*/x0->dtype, /*shape=*/shape);
+  call->out = TupleValue::make(tvm::Array<Value>({v1, x1}));
+  call->device = x0->device;
+}).set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 1}, {3, 0}});
+
+/*!
+ * \brief Check the 8-bit states of an optimizer in the tensor list, i.e., the int8 first moments
+ * and the uint8 second moments of the groups m and v, and the 1-D float32 scales of the last group.
+ */
+void CheckQuantizedStates(const std::vector<BaseTensorValue>& tensor_list, int ntensors, int m,
+                          int v, int scales) {
+  for (int i = 0; i < ntensors; ++i) {
+    const DLTensor* m_i = tensor_list[m * ntensors + i];
+    const DLTensor* v_i = tensor_list[v * ntensors + i];
+    const DLTensor* scales_i = tensor_list[scales * ntensors + i];
+    CHECK(DType(m_i->dtype) == DType(DTypeCode::kInt(), 8) &&
+          DType(v_i->dtype) == DType(DTypeCode::kUInt(), 8))
+        << "The 8-bit states should be int8 first moments and uint8 second moments";
+    CHECK(scales_i->ndim == 1 && DType(scales_i->dtype) == DType(DTypeCode::kFloat(), 32))
+        << "The scales of the 8-bit states should be 1-D float32";
+  }
+}
 
 void LansDecl(const CallValues& call) {
   const auto* args = call->args.as<LansArgs>();
   CHECK(args != nullptr);
-  CHECK(args->tensor_list.size() % 4 == 0);
+  int ngroups = args->quantize_states ? 5 : 4;
+  CHECK(args->tensor_list.size() % ngroups == 0);
   const DLTensor* x = args->tensor_list[0];
   call->device = x->device;
-  int ntensors = args->tensor_list.size() / 4;
+  int ntensors = args->tensor_list.size() / ngroups;
+  if (args->quantize_states) {
+    CheckQuantizedStates(args->tensor_list, ntensors, 2, 3, 4);
+  }
   Array<Value> output;
   for (int i = 0; i < args->tensor_list.size(); ++i) {
     output.push_back(args->tensor_list[i]);
@@ -60,6 +109,140 @@ void LansDecl(const CallValues& call) {
 RAF_OP_DECLARE("raf.op.lans", LansDecl)
     .set_attr<TOpPattern>("TOpPattern", kOpaque)
     .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*!
+ * \brief The tensor list of Adam has 4 groups (gradients, fp32 weights, first and second moments),
+ * and a 5th group of the low-precision weight copies in the mixed precision mode. With the 8-bit
+ * states, the moments are int8 and uint8, and another group of their scales follows. With the
+ * dynamic loss scaling, the last tensor is the loss scaler of 4 floats. All the tensors are updated
+ * in place, so the outputs are the inputs.
+ */
+void AdamDecl(const CallValues& call) {
+  const auto* args = call->args.as<AdamArgs>();
+  CHECK(args != nullptr);
+  int ngroups = 4 + args->mixed_precision + args->quantize_states;
+  int nstates = args->quantize_states ? 2 : 4;
+  int nscaler = args->dynamic_loss_scale ? 1 : 0;
+  int nlist = static_cast<int>(args->tensor_list.size()) - nscaler;
+  CHECK(nlist > 0 && nlist % ngroups == 0)
+      << "Adam expects " << ngroups << " groups of tensors, but got " << nlist << " tensors";
+  int ntensors = nlist / ngroups;
+  for (int i = 0; i < ntensors; ++i) {
+    const DLTensor* g = args->tensor_list[i];
+    // The scales have their own shape.
+    for (int j = 1; j < ngroups - args->quantize_states; ++j) {
+      const DLTensor* t = args->tensor_list[j * ntensors + i];
+      CHECK_EQ(t->ndim, g->ndim);
+      for (int k = 0; k < g->ndim; ++k) {
+        CHECK_EQ(t->shape[k], g->shape[k]);
+      }
+      if (j < nstates) {
+        CHECK(DType(t->dtype) == DType(DTypeCode::kFloat(), 32))
+            << "Adam keeps the weights and the moments in float32";
+      }
+    }
+  }
+  if (args->quantize_states) {
+    CheckQuantizedStates(args->tensor_list, ntensors, 2, 3, ngroups - 1);
+  }
+  if (nscaler) {
+    const DLTensor* scaler = args->tensor_list.back();
+    CHECK(scaler->ndim == 1 && scaler->shape[0] == 4 &&
+          DType(scaler->dtype) == DType(DTypeCode::kFloat(), 32))
+        << "The loss scaler of Adam should be 4 floats";
+    CHECK_GT(args->scale_window, 0);
+  }
+  const DLTensor* x = args->tensor_list[0];
+  call->device = x->device;
+  Array<Value> output;
+  for (const auto& t : args->tensor_list) {
+    output.push_back(t);
+  }
+  call->out = TupleValue::make(output);
+}
+
+RAF_OP_DECLARE("raf.op.adam", AdamDecl)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+RAF_OP_DECLARE("raf.op.adamw", AdamDecl)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*!
+ * \brief Check that the tensor list of a multi-tensor op is non-empty and of the same dtype, which
+ * is the dtype the kernels are instantiated for.
+ */
+DLDataType CheckMultiTensorList(const std::vector<BaseTensorValue>& tensor_list) {
+  CHECK(!tensor_list.empty()) << "Multi-tensor ops expect at least one tensor";
+  const DLTensor* x0 = tensor_list[0];
+  for (const auto& t : tensor_list) {
+    const DLTensor* x = t;
+    CHECK(DType(x->dtype) == DType(x0->dtype))
+        << "Multi-tensor ops expect the tensors of the same dtype, but got "
+        << DType(x->dtype).c_str() << " and " << DType(x0->dtype).c_str();
+  }
+  return x0->dtype;
+}
+
+/*!
+ * \brief Scale each tensor of the list and cast it to dtype, or to its own dtype if dtype is
+ * empty. A scale of 0 zeros the tensors, and a scale of 1 casts them.
+ */
+RAF_OP_DECLARE("raf.op.multi_tensor_scale", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorScaleArgs>();
+  CHECK(args != nullptr);
+  DLDataType dtype = CheckMultiTensorList(args->tensor_list);
+  if (!args->dtype.empty()) {
+    dtype = ir::String2DLDataType(args->dtype);
+  }
+  Array<Value> output;
+  for (const auto& t : args->tensor_list) {
+    const DLTensor* x = t;
+    output.push_back(TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/dtype,
+                                           /*shape=*/std::vector<int64_t>(x->shape,
+                                                                          x->shape + x->ndim)));
+  }
+  call->out = TupleValue::make(output);
+  call->device = args->tensor_list[0]->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*! \brief The L2 norm of all the tensors of the list, as if they were concatenated, in float32. */
+RAF_OP_DECLARE("raf.op.multi_tensor_l2norm", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorL2normArgs>();
+  CHECK(args != nullptr);
+  CheckMultiTensorList(args->tensor_list);
+  const DLTensor* x0 = args->tensor_list[0];
+  call->out = TensorValue::Assemble(/*dev=*/x0->device, /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                    /*shape=*/std::vector<int64_t>());
+  call->device = x0->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
+/*!
+ * \brief Clip the tensors of the list by their global L2 norm, i.e., scale them all by
+ * min(1, max_norm / (norm + eps)). The outputs are the clipped tensors followed by the norm in
+ * float32. The norm is only read on the device, so the clipping never syncs the host.
+ */
+RAF_OP_DECLARE("raf.op.multi_tensor_clip_by_global_norm", [](const CallValues& call) {
+  const auto* args = call->args.as<MultiTensorClipByGlobalNormArgs>();
+  CHECK(args != nullptr);
+  CheckMultiTensorList(args->tensor_list);
+  CHECK_GT(args->max_norm, 0) << "The max norm of the clipping should be positive";
+  Array<Value> output;
+  for (const auto& t : args->tensor_list) {
+    const DLTensor* x = t;
+    output.push_back(TensorValue::Assemble(/*dev=*/x->device, /*dtype=*/x->dtype,
+                                           /*shape=*/std::vector<int64_t>(x->shape,
+                                                                          x->shape + x->ndim)));
+  }
+  const DLTensor* x0 = args->tensor_list[0];
+  output.push_back(TensorValue::Assemble(/*dev=*/x0->device,
+                                         /*dtype=*/DType(DTypeCode::kFloat(), 32),
+                                         /*shape=*/std::vector<int64_t>()));
+  call->out = TupleValue::make(output);
+  call->device = x0->device;
+}).set_attr<TOpPattern>("TOpPattern", kOpaque);
+
 }  // namespace declare
 }  // namespace op
 }  // namespace raf
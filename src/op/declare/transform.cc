@@ -177,6 +177,28 @@ RAF_OP_DECLARE("raf.op.reshape_like", [](const CallValues& call) {
   call->out = Downcast<TensorValue>(args->x).CreateView(shape);
 });
 
+RAF_OP_DECLARE("raf.op.view", [](const CallValues& call) {
+  const auto* args = call->args.as<ViewArgs>();
+  CHECK(args != nullptr);
+  DLTensor* x = args->x;
+  CHECK(IsCompact(*x)) << "NotImplementedError: for now we only support view on contiguous tensor";
+  int64_t origin = std::accumulate(x->shape, x->shape + x->ndim, 1LL, std::multiplies<int64_t>());
+  int64_t size =
+      std::accumulate(args->shape.begin(), args->shape.end(), 1LL, std::multiplies<int64_t>());
+  CHECK(args->offset >= 0 && args->offset + size <= origin)
+      << "ValueError: The view of " << size << " elements at " << args->offset
+      << " is out of the " << origin << " elements of the tensor";
+  call->device = x->device;
+  call->callee = ir::NullValue<OpValue>();
+  // The view is the contiguous elements of the tensor starting at the offset.
+  int64_t nbytes = (x->dtype.bits * x->dtype.lanes + 7) / 8;
+  void* data = x->data == nullptr
+                   ? nullptr
+                   : static_cast<char*>(x->data) + x->byte_offset + args->offset * nbytes;
+  auto value = Downcast<TensorValue>(args->x);
+  call->out = TensorValue::make(value->tensor.CreateView(args->shape, {}, data), value->mem);
+});
+
 RAF_OP_DECLARE("raf.op.resize2d", [](const CallValues& call) {
   const auto* args = call->args.as<Resize2DArgs>();
   CHECK(args != nullptr);
@@ -290,7 +312,35 @@ RAF_OP_DECLARE("raf.op.embedding_dx", [](const CallValues& call) {
   call->device = dy->device;
 });
 
-RAF_OP_DECLARE("raf.op.expand_dims", [](const CallValues& call) {
+/*!
+ * \brief The row-sparse gradient of embedding, i.e., the unique rows in the ascending order and
+ * the sums of their gradients. The outputs are sized by the number of indices, and the rows after
+ * the unique ones are -1 with zero values. Negative indices are ignored, so the op also coalesces
+ * the concatenated row-sparse gradients.
+ */
+RAF_OP_DECLARE("raf.op.embedding_sparse_dx", [](const CallValues& call) {
+  const auto* args = call->args.as<EmbeddingDxArgs>();
+  CHECK(args != nullptr);
+  DLTensor* dy = args->dy;
+  DLTensor* indices = args->indices;
+  std::vector<int64_t> num_weight = GetShapeVecFromValue(args->num_weight);
+  int64_t n = 1;
+  for (int i = 0; i < indices->ndim; ++i) {
+    n *= indices->shape[i];
+  }
+  std::vector<int64_t> shape{n};
+  shape.insert(shape.end(), num_weight.begin() + 1, num_weight.end());
+  auto rows = TensorValue::Assemble(/*dev=*/dy->device,
+                                    /*dtype=*/DType(DTypeCode::kInt(), 64),
+                                    /*shape=*/{n});
+  auto values = TensorValue::Assemble(/*dev=*/dy->device,
+                                      /*dtype=*/dy->dtype,
+                                      /*shape=*/shape);
+  call->out = TupleValue::make(tvm::Array<Value>({rows, values}));
+  call->device = dy->device;
+});
+
+RAF_OP_DECLARE("raf.op.expand_dims",[](const CallValues& call) {
   const auto* args = call->args.as<ExpandDimsArgs>();
   CHECK(args != nullptr);
   DLTensor* x = args->x;
@@ -455,6 +505,69 @@ RAF_OP_DECLARE("raf.op.strided_set", [](const CallValues& call) {
                                     /*shape=*/shape);
 });
 
+/*!
+ * \brief Write the steps v of (..., seq, dim) into the cache of (..., max_len, dim) at the
+ * position pos along the second last axis, in place. pos is an integer scalar, or a vector of a
+ * position per row of the leading (batch) axis, which is on the device so a decode step does
+ * not depend on the host. The steps beyond max_len are dropped.
+ */
+RAF_OP_DECLARE("raf.op.kv_append", [](const CallValues& call) {
+  const auto* args = call->args.as<KvAppendArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* cache = args->cache;
+  const DLTensor* v = args->v;
+  const DLTensor* pos = args->pos;
+  CHECK_GE(cache->ndim, 2) << "kv_append expects the cache of (..., max_len, dim)";
+  CHECK_EQ(cache->ndim, v->ndim) << "kv_append expects the cache and v of the same rank";
+  for (int i = 0; i < cache->ndim; ++i) {
+    if (i != cache->ndim - 2) {
+      CHECK_EQ(cache->shape[i], v->shape[i])
+          << "Mismatched shapes of the cache and v at axis " << i;
+    }
+  }
+  CHECK(DType(cache->dtype) == DType(v->dtype)) << "kv_append expects v of the cache dtype";
+  CHECK(pos->dtype.code == kDLInt) << "kv_append expects integer positions";
+  CHECK(pos->ndim == 0 || (pos->ndim == 1 && cache->ndim > 2 && pos->shape[0] == cache->shape[0]))
+      << "kv_append expects a scalar position or a position per row of the batch axis";
+  // The cache is updated in place, so the output is the cache.
+  call->out = args->cache;
+  call->device = cache->device;
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
+/*!
+ * \brief Write the steps v of (batch, heads, seq, dim) into the paged cache of (num_blocks, heads,
+ * block_size, dim) in place, where the step s of the sequence b goes to the token pos[b] + s,
+ * i.e., the slot t % block_size of the block block_table[b, t / block_size]. The steps beyond
+ * the blocks of the table are dropped.
+ */
+RAF_OP_DECLARE("raf.op.paged_kv_append", [](const CallValues& call) {
+  const auto* args = call->args.as<PagedKvAppendArgs>();
+  CHECK(args != nullptr);
+  const DLTensor* cache = args->cache;
+  const DLTensor* v = args->v;
+  const DLTensor* block_table = args->block_table;
+  const DLTensor* pos = args->pos;
+  CHECK_EQ(cache->ndim, 4) << "paged_kv_append expects the cache of (num_blocks, heads, "
+                              "block_size, dim)";
+  CHECK_EQ(v->ndim, 4) << "paged_kv_append expects v of (batch, heads, seq, dim)";
+  CHECK_EQ(cache->shape[1], v->shape[1]) << "Mismatched heads of the cache and v";
+  CHECK_EQ(cache->shape[3], v->shape[3]) << "Mismatched dims of the cache and v";
+  CHECK(DType(cache->dtype) == DType(v->dtype)) << "paged_kv_append expects v of the cache dtype";
+  CHECK(block_table->dtype.code == kDLInt && pos->dtype.code == kDLInt)
+      << "paged_kv_append expects integer block tables and positions";
+  CHECK(block_table->ndim == 2 && block_table->shape[0] == v->shape[0])
+      << "paged_kv_append expects a block table of (batch, max_blocks)";
+  CHECK(pos->ndim == 1 && pos->shape[0] == v->shape[0])
+      << "paged_kv_append expects a position per sequence";
+  // The cache is updated in place, so the output is the cache.
+  call->out = args->cache;
+  call->device = cache->device;
+})
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TRAFInplaceUpdate>("TRAFInplaceUpdate", {{0, 0}});
+
 RAF_OP_DECLARE("raf.op.sequence_mask", [](const CallValues& call) {
   const auto* args = call->args.as<SequenceMaskArgs>();
   CHECK(args != nullptr);
@@ -0,0 +1,46 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cblas/cblas_utils.cc
+ * \brief Helper functions for the CPU BLAS libraries
+ */
+#ifdef RAF_CBLAS_MKL
+#include <mkl.h>
+#endif
+#include "raf/device_api.h"
+#include "raf/dialect.h"
+#include "./cblas_utils.h"
+
+#ifndef RAF_CBLAS_MKL
+extern "C" void openblas_set_num_threads(int num_threads);
+#endif
+
+namespace raf {
+namespace op {
+namespace cblas {
+
+void SyncNumThreads() {
+  // The number of threads last applied to the BLAS library by this thread.
+  thread_local int curr = 0;
+  int num_threads = device_api::cpu::GetNumThreads();
+  if (num_threads <= 0 || num_threads == curr) {
+    return;
+  }
+#ifdef RAF_CBLAS_MKL
+  // MKL keeps the setting per thread, so the VMs on different threads do not interfere.
+  mkl_set_num_threads_local(num_threads);
+#else
+  // OpenBLAS only has a process-wide setting, which is applied by the last VM that runs.
+  openblas_set_num_threads(num_threads);
+#endif
+  curr = num_threads;
+}
+
+RAF_REGISTER_DIALECT("cblas").set_enable(DevType::kCPU());
+
+}  // namespace cblas
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,39 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cblas/cblas_utils.h
+ * \brief Helper functions for the CPU BLAS libraries
+ */
+#pragma once
+#ifdef RAF_CBLAS_MKL
+#include <mkl_cblas.h>
+#else
+#include <cblas.h>
+#endif
+#include "raf/device.h"
+
+namespace raf {
+namespace op {
+namespace cblas {
+
+/*!
+ * \brief Let the BLAS library on the calling thread use the intra-op threads set by
+ * device_api::cpu::SetNumThreads, so the BLAS kernels follow the thread setting of the VM.
+ */
+void SyncNumThreads();
+
+/*!
+ * \brief Whether the BLAS library supports the data type.
+ * \param dtype The data type.
+ * \return Whether the data type is float32 or float64.
+ */
+inline bool IsBlasDType(const DLDataType& dtype) {
+  return dtype.code == kDLFloat && dtype.lanes == 1 && (dtype.bits == 32 || dtype.bits == 64);
+}
+
+}  // namespace cblas
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,139 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cblas/matmul.cc
+ * \brief The matmul and batch_matmul ops of the CPU BLAS libraries
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "./cblas_utils.h"
+#include "../../schema/ufunc.h"
+
+namespace raf {
+namespace op {
+namespace cblas {
+namespace manual {
+
+using namespace raf::value;
+
+/*!
+ * \brief Compute c = op(a) * op(b) in the row-major layout, where a and b are 2D, or 3D with the
+ * same batch size or a batch size of 1 to be broadcast. The batches run one after another, and
+ * each GEMM is parallelized by the BLAS library.
+ */
+void GemmImpl(DLTensor* a, bool transpose_a, DLTensor* b, bool transpose_b, DLTensor* c) {
+  SyncNumThreads();
+  int ndim = c->ndim;
+  int m = c->shape[ndim - 2];
+  int n = c->shape[ndim - 1];
+  int k = a->shape[ndim - (transpose_a ? 2 : 1)];
+  int lda = std::max(1, transpose_a ? m : k);
+  int ldb = std::max(1, transpose_b ? k : n);
+  int ldc = std::max(1, n);
+  int64_t batch = ndim == 3 ? c->shape[0] : 1;
+  int64_t stride_a = ndim == 3 && a->shape[0] > 1 ? int64_t(m) * k : 0;
+  int64_t stride_b = ndim == 3 && b->shape[0] > 1 ? int64_t(k) * n : 0;
+  int64_t stride_c = int64_t(m) * n;
+  CBLAS_TRANSPOSE trans_a = transpose_a ? CblasTrans : CblasNoTrans;
+  CBLAS_TRANSPOSE trans_b = transpose_b ? CblasTrans : CblasNoTrans;
+  for (int64_t i = 0; i < batch; ++i) {
+    if (c->dtype.bits == 32) {
+      const float* pa = static_cast<const float*>(a->data) + i * stride_a;
+      const float* pb = static_cast<const float*>(b->data) + i * stride_b;
+      float* pc = static_cast<float*>(c->data) + i * stride_c;
+      cblas_sgemm(CblasRowMajor, trans_a, trans_b, m, n, k, 1.0f, pa, lda, pb, ldb, 0.0f, pc, ldc);
+    } else {
+      const double* pa = static_cast<const double*>(a->data) + i * stride_a;
+      const double* pb = static_cast<const double*>(b->data) + i * stride_b;
+      double* pc = static_cast<double*>(c->data) + i * stride_c;
+      cblas_dgemm(CblasRowMajor, trans_a, trans_b, m, n, k, 1.0, pa, lda, pb, ldb, 0.0, pc, ldc);
+    }
+  }
+}
+
+template <bool batched, bool transpose_a, bool transpose_b>
+class MatmulImpl : public raf::op::OpEnv {
+  std::string env_name_;
+
+ public:
+  explicit MatmulImpl(const CallValues& cv) {
+    auto op = ir::Op::Get(batched ? "raf.op.batch_matmul" : "raf.op.matmul");
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {
+        fschema_index[op]("x1"),
+        fschema_index[op]("x2"),
+    };
+    auto args = cv->args.as<op::schema::BinaryArgs>();
+    CHECK(args != nullptr);
+    std::string op_name = batched ? "raf.op.cblas.batch_matmul" : "raf.op.cblas.matmul";
+    if (transpose_a || transpose_b) {
+      op_name += "_";
+      op_name += (transpose_a) ? "t" : "n";
+      op_name += (transpose_b) ? "t" : "n";
+    }
+    env_name_ = TruncateName(GetUniqueName(op_name));
+    // Leave the other dtypes, e.g. float16, to the next dialect.
+    const DLTensor* out = cv->out;
+    if (!IsBlasDType(out->dtype) || args->x1->dtype.bits != out->dtype.bits ||
+        args->x2->dtype.bits != out->dtype.bits) {
+      this->error_msgs.push_back("[CBLAS] Only float32 and float64 GEMMs are supported");
+    }
+  }
+
+  std::string name() const override {
+    return env_name_;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BinaryArgs>();
+    GemmImpl(args->x1, transpose_a, args->x2, transpose_b, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) {
+    DLTensor* x1 = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x2 = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    GemmImpl(x1, transpose_a, x2, transpose_b, out);
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MatmulImpl<batched, transpose_a, transpose_b>(cv);
+  }
+};
+
+using MatmulNN = MatmulImpl<false, false, false>;
+using MatmulNT = MatmulImpl<false, false, true>;
+using MatmulTN = MatmulImpl<false, true, false>;
+using MatmulTT = MatmulImpl<false, true, true>;
+using BatchMatmulNN = MatmulImpl<true, false, false>;
+using BatchMatmulNT = MatmulImpl<true, false, true>;
+using BatchMatmulTN = MatmulImpl<true, true, false>;
+using BatchMatmulTT = MatmulImpl<true, true, true>;
+
+RAF_REGISTER_DIALECT_OP(cblas, matmul, 15);
+RAF_REGISTER_DIALECT_OP(cblas, matmul_nt, 15);
+RAF_REGISTER_DIALECT_OP(cblas, matmul_tn, 15);
+RAF_REGISTER_DIALECT_OP(cblas, matmul_tt, 15);
+RAF_REGISTER_DIALECT_OP(cblas, dense, 15);
+RAF_REGISTER_DIALECT_OP(cblas, batch_matmul, 15);
+RAF_REGISTER_DIALECT_OP(cblas, batch_matmul_nt, 15);
+RAF_REGISTER_DIALECT_OP(cblas, batch_matmul_tn, 15);
+RAF_REGISTER_DIALECT_OP(cblas, batch_matmul_tt, 15);
+RAF_OP_ENV_MAKER("raf.op.cblas.matmul", MatmulNN::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.matmul_nt", MatmulNT::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.matmul_tn", MatmulTN::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.matmul_tt", MatmulTT::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.dense", MatmulNT::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.batch_matmul", BatchMatmulNN::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.batch_matmul_nt", BatchMatmulNT::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.batch_matmul_tn", BatchMatmulTN::make);
+RAF_OP_ENV_MAKER("raf.op.cblas.batch_matmul_tt", BatchMatmulTT::make);
+
+}  // namespace manual
+}  // namespace cblas
+}  // namespace op
+}  // namespace raf
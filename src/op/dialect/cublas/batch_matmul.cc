@@ -59,6 +59,23 @@ void GemmBatchedImpl(DLTensor* a, bool transpose_a, DLTensor* b, bool transpose_
     strideB = 0;
   }
 
+  // The int8 GEMMs accumulate in int32.
+  if (c->dtype.code == kDLInt && c->dtype.bits == 32 && a->dtype.code == kDLInt &&
+      a->dtype.bits == 8) {
+    CUBLAS_CALL(cublasGemmStridedBatchedEx(
+        handle, transb, transa, m, n, k, const_addr<1>(CUDA_R_32I), b->data, CUDA_R_8I, ldb,
+        strideB, a->data, CUDA_R_8I, lda, strideA, const_addr<0>(CUDA_R_32I), c->data, CUDA_R_32I,
+        m, strideC, batch_count, CUBLAS_COMPUTE_32I, CUBLAS_GEMM_DEFAULT));
+    return;
+  }
+  if (c->dtype.code == kDLBfloat && c->dtype.bits == 16) {
+    CUBLAS_CALL(cublasGemmStridedBatchedEx(
+        handle, transb, transa, m, n, k, const_addr<1>(CUDA_R_32F), b->data,
+        cudaDataType_t(DType(b->dtype)), ldb, strideB, a->data, cudaDataType_t(DType(a->dtype)),
+        lda, strideA, const_addr<0>(CUDA_R_32F), c->data, cudaDataType_t(DType(c->dtype)), m,
+        strideC, batch_count, CUDA_R_32F, CUBLAS_GEMM_DEFAULT_TENSOR_OP));
+    return;
+  }
   if (c->dtype.code == kDLFloat) {
     switch (c->dtype.bits) {
       case 16: {
@@ -143,14 +160,27 @@ using BatchMatmulNT = BatchMatmulImpl<false, true>;
 using BatchMatmulTN = BatchMatmulImpl<true, false>;
 using BatchMatmulTT = BatchMatmulImpl<true, true>;
 
+/*! \brief Make the int8 GEMM, or leave it to the next dialect if cuBLAS does not support it. */
+OpEnv* MakeQnnBatchMatmulNT(const CallValues& cv) {
+  auto args = cv->args.as<op::schema::BinaryArgs>();
+  CHECK(args != nullptr);
+  OpEnv* env = BatchMatmulNT::make(cv);
+  if (!IsInt8GemmSupported(args->x1, args->x2)) {
+    env->error_msgs.push_back("[cuBLAS] The int8 GEMM requires the dims in multiples of 4");
+  }
+  return env;
+}
+
 RAF_REGISTER_DIALECT_OP(cublas, batch_matmul, 15);
 RAF_REGISTER_DIALECT_OP(cublas, batch_matmul_nt, 15);
 RAF_REGISTER_DIALECT_OP(cublas, batch_matmul_tn, 15);
 RAF_REGISTER_DIALECT_OP(cublas, batch_matmul_tt, 15);
+RAF_REGISTER_DIALECT_OP(cublas, qnn_batch_matmul_nt, 15);
 RAF_OP_ENV_MAKER("raf.op.cublas.batch_matmul", BatchMatmulNN::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.batch_matmul_nt", BatchMatmulNT::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.batch_matmul_tn", BatchMatmulTN::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.batch_matmul_tt", BatchMatmulTT::make);
+RAF_OP_ENV_MAKER("raf.op.cublas.qnn_batch_matmul_nt", MakeQnnBatchMatmulNT);
 
 }  // namespace manual
 }  // namespace cublas
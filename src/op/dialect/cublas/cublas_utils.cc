@@ -9,6 +9,8 @@
  */
 #include <cublas_v2.h>
 #include <algorithm>
+#include <cstdlib>
+#include <string>
 #include "dmlc/thread_local.h"
 #include "./cublas_utils.h"
 
@@ -17,17 +19,57 @@ namespace op {
 namespace cublas {
 
 using CUBlasThreadStore = dmlc::ThreadLocalStore<CUBlasThreadEntry>;
+using CUBlasLtThreadStore = dmlc::ThreadLocalStore<CUBlasLtThreadEntry>;
 
 CUBlasThreadEntry::CUBlasThreadEntry() {
   CUBLAS_CALL(cublasCreate(&handle));
   CUBLASTryEnableTensorCore(handle);
+  stream_handles[nullptr] = handle;
+}
+
+void CUBlasThreadEntry::SetStream(cudaStream_t stream) {
+  if (stream == this->stream) {
+    return;
+  }
+  auto& stream_handle = stream_handles[stream];
+  if (stream_handle == nullptr) {
+    CUBLAS_CALL(cublasCreate(&stream_handle));
+    CUBLASTryEnableTensorCore(stream_handle);
+    CUBLAS_CALL(cublasSetStream(stream_handle, stream));
+#if CUDA_VERSION >= 11040
+    // By default, the handles share the workspace, which serializes the GEMMs on the streams.
+    // The size can be set in MBs by the environment variable RAF_CUBLAS_WORKSPACE_MB.
+    static const int64_t workspace_bytes = [] {
+      const char* env = getenv("RAF_CUBLAS_WORKSPACE_MB");
+      return (env ? std::stoll(env) : 4) << 20;
+    }();
+    if (workspace_bytes > 0) {
+      int device_id;
+      CUDA_CALL(cudaGetDevice(&device_id));
+      workspaces.push_back(
+          memory_pool::Memory::Alloc(Device(DevType::kCUDA(), device_id), workspace_bytes));
+      CUBLAS_CALL(cublasSetWorkspace(stream_handle, workspaces.back()->data, workspace_bytes));
+    }
+#endif
+  }
+  handle = stream_handle;
+  this->stream = stream;
 }
 
 CUBlasThreadEntry* CUBlasThreadEntry::ThreadLocal() {
   return CUBlasThreadStore::Get();
 }
 
+CUBlasLtThreadEntry::CUBlasLtThreadEntry() {
+  CUBLAS_CALL(cublasLtCreate(&handle));
+}
+
+CUBlasLtThreadEntry* CUBlasLtThreadEntry::ThreadLocal() {
+  return CUBlasLtThreadStore::Get();
+}
+
 RAF_REGISTER_DIALECT("cublas").set_enable(DevType::kCUDA());
+RAF_REGISTER_DIALECT("cublaslt").set_enable(DevType::kCUDA());
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.cublas.allow_tf32", tvm::Bool);
 
 }  // namespace cublas
@@ -9,9 +9,14 @@
  */
 #pragma once
 #include <cublas_v2.h>
+#include <cublasLt.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "raf/device.h"
 #include "raf/enum_base.h"
 #include "raf/ir_ext.h"
+#include "raf/memory_pool.h"
 #include "raf/pass.h"
 #include "../../../common/cuda_utils.h"
 
@@ -43,6 +48,10 @@ inline const char* cublasGetErrorString(cublasStatus_t status) {
       return "CUBLAS_STATUS_EXECUTION_FAILED";
     case CUBLAS_STATUS_INTERNAL_ERROR:
       return "CUBLAS_STATUS_INTERNAL_ERROR";
+    case CUBLAS_STATUS_NOT_SUPPORTED:
+      return "CUBLAS_STATUS_NOT_SUPPORTED";
+    case CUBLAS_STATUS_LICENSE_ERROR:
+      return "CUBLAS_STATUS_LICENSE_ERROR";
     default:
       LOG(FATAL) << "ValueError: Unknown error!\n";
       throw;
@@ -66,13 +75,44 @@ class CUBlasThreadEntry {
  public:
   CUBlasThreadEntry();
   static CUBlasThreadEntry* ThreadLocal();
+  /*!
+   * \brief Switch to the handle of the stream, which is created on the first use of the stream
+   * with its own workspace. The streams do not share a handle or the workspace of cuBLAS, so the
+   * GEMMs on different streams are not serialized by them.
+   * \param stream The stream to launch the kernels on.
+   */
+  void SetStream(cudaStream_t stream);
 
  public:
+  /*! \brief The handle of the current stream. */
   cublasHandle_t handle{nullptr};
+  /*! \brief The current stream. */
+  cudaStream_t stream{nullptr};
+  /*! \brief The handles of the streams used by the thread. */
+  std::unordered_map<cudaStream_t, cublasHandle_t> stream_handles;
+  /*! \brief The workspaces of the handles of the streams. */
+  std::vector<std::shared_ptr<memory_pool::Memory>> workspaces;
+};
+
+class CUBlasLtThreadEntry {
+ public:
+  CUBlasLtThreadEntry();
+  static CUBlasLtThreadEntry* ThreadLocal();
+
+ public:
+  cublasLtHandle_t handle{nullptr};
 };
 
 inline void SetStream(cudaStream_t stream) {
-  cublasSetStream(CUBlasThreadEntry::ThreadLocal()->handle, stream);
+  CUBlasThreadEntry::ThreadLocal()->SetStream(stream);
+}
+
+/*!
+ * \brief Whether cuBLAS supports the int8 GEMM of a and b, where b is transposed as the weight of
+ * dense. The reduction dim and the output dim of b are required to be multiples of 4.
+ */
+inline bool IsInt8GemmSupported(const DLTensor* a, const DLTensor* b) {
+  return a->shape[a->ndim - 1] % 4 == 0 && b->shape[b->ndim - 2] % 4 == 0;
 }
 
 }  // namespace cublas
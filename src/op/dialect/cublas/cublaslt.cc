@@ -0,0 +1,635 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cublas/cublaslt.cc
+ * \brief cuBLASLt GEMM with the bias and activation fused as epilogues.
+ */
+#include <cublasLt.h>
+#include <algorithm>
+#include <unordered_map>
+#include "dmlc/memory_io.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
+#include "raf/cache.h"
+#include "raf/device_api.h"
+#include "raf/ir_ext.h"
+#include "raf/op.h"
+#include "raf/pass.h"
+#include "raf/registry.h"
+#include "raf/value.h"
+#include "./cublas_utils.h"
+#include "../cuda/kernels/kernel_util.cuh"
+#include "../../../common/cuda_utils.h"
+#include "../../../common/shape_utils.h"
+
+namespace raf {
+namespace op {
+namespace cublas {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief The largest workspace the algorithm heuristics may ask for. */
+constexpr uint64_t kLtMaxWorkspaceBytes = 32 << 20;
+/*! \brief The largest pointer alignment assumed when picking an algorithm. */
+constexpr uint32_t kLtMaxAlignment = 16;
+/*! \brief The alignment of the buffers in the fp8 workspace. */
+constexpr int64_t kLtFP8BufferAlignment = 256;
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.cublaslt.fp8", tvm::Bool);
+
+/*! \brief The layout of a GEMM op. */
+struct LtGemmInfo {
+  bool batched;
+  bool transpose_a;
+  bool transpose_b;
+};
+
+/*!
+ * \brief A GEMM, optionally followed by a bias add, an activation and then a cast of the output.
+ */
+struct LtGemmMatch {
+  /*! \brief The layout of the GEMM. */
+  LtGemmInfo gemm;
+  /*! \brief The GEMM call. */
+  Call matmul;
+  /*! \brief The bias, undefined if there is no bias add. */
+  Expr bias;
+  /*! \brief The activation (relu or gelu), empty if there is no activation. */
+  std::string act;
+  /*! \brief Whether the output is cast, so the GEMM writes the output in the cast dtype. */
+  bool cast = false;
+};
+
+/*! \brief How the bias is fed to cuBLASLt. */
+enum class LtBiasMode {
+  /*! \brief No bias. */
+  kNone,
+  /*! \brief A vector along the output columns, added by the bias epilogue. */
+  kVector,
+  /*! \brief A bias of the output shape, read as the matrix C with beta = 1. */
+  kMatrix,
+  /*! \brief Any other broadcast, which cuBLASLt cannot express. */
+  kUnsupported,
+};
+
+std::string GetBaseOpName(const Expr& op) {
+  const auto* node = op.as<OpNode>();
+  if (node == nullptr) {
+    return "";
+  }
+  Op base_op = GetRef<Op>(node);
+  return IsDialectOp(base_op) ? GetBaseOp(base_op)->name : base_op->name;
+}
+
+/*!
+ * \brief Match cast(act(gemm(a, b) + bias)), where the bias add, the activation and the cast are
+ *        optional.
+ *        The ops can be either base ops or dialect ops, so the same matcher works on the graph
+ *        before fusion and on the body of the fused function.
+ */
+bool MatchLtGemm(const Expr& expr, LtGemmMatch* match) {
+  static const std::unordered_map<std::string, LtGemmInfo> gemm_ops = {
+      {"raf.op.dense", {false, false, true}},
+      {"raf.op.matmul", {false, false, false}},
+      {"raf.op.matmul_nt", {false, false, true}},
+      {"raf.op.matmul_tn", {false, true, false}},
+      {"raf.op.matmul_tt", {false, true, true}},
+      {"raf.op.batch_matmul", {true, false, false}},
+      {"raf.op.batch_matmul_nt", {true, false, true}},
+      {"raf.op.batch_matmul_tn", {true, true, false}},
+      {"raf.op.batch_matmul_tt", {true, true, true}}};
+  const auto* call = expr.as<CallNode>();
+  if (call != nullptr && GetBaseOpName(call->op) == "raf.op.cast") {
+    match->cast = true;
+    call = call->args[0].as<CallNode>();
+  }
+  if (call != nullptr) {
+    std::string name = GetBaseOpName(call->op);
+    if (name == "raf.op.relu" || name == "raf.op.gelu") {
+      match->act = name.substr(std::string("raf.op.").size());
+      call = call->args[0].as<CallNode>();
+    }
+  }
+  if (call != nullptr && GetBaseOpName(call->op) == "raf.op.add") {
+    match->bias = call->args[1];
+    call = call->args[0].as<CallNode>();
+  }
+  if (call == nullptr) {
+    return false;
+  }
+  auto it = gemm_ops.find(GetBaseOpName(call->op));
+  if (it == gemm_ops.end()) {
+    return false;
+  }
+  match->gemm = it->second;
+  match->matmul = GetRef<Call>(call);
+  return true;
+}
+
+LtBiasMode GetLtBiasMode(const std::vector<int64_t>& out_shape,
+                         const std::vector<int64_t>& bias_shape, bool batched) {
+  int64_t m = out_shape[out_shape.size() - 2];
+  int64_t n = out_shape.back();
+  int64_t numel = 1;
+  for (auto dim : bias_shape) {
+    numel *= dim;
+  }
+  if (!bias_shape.empty() && bias_shape.back() == n && numel == n) {
+    return LtBiasMode::kVector;
+  }
+  if (bias_shape == out_shape) {
+    return LtBiasMode::kMatrix;
+  }
+  // A bias of (M, N) or (1, M, N) is shared by all the batches.
+  if (batched && (bias_shape == std::vector<int64_t>{m, n} ||
+                  bias_shape == std::vector<int64_t>{1, m, n})) {
+    return LtBiasMode::kMatrix;
+  }
+  return LtBiasMode::kUnsupported;
+}
+
+/*!
+ * \brief Whether cuBLASLt supports the data type and the activation. The GELU epilogue of
+ *        cuBLASLt is the tanh approximation, which is only accurate enough in half precision.
+ */
+bool IsLtSupported(DType dtype, const std::string& act) {
+  bool is_half = (dtype.code == DTypeCode::kFloat() || dtype.code == DTypeCode::kBFloat()) &&
+                 dtype.bits == 16;
+  bool is_float = dtype.code == DTypeCode::kFloat() && dtype.bits == 32;
+  if (dtype.lanes != 1 || !(is_half || is_float)) {
+    return false;
+  }
+  return act != "gelu" || is_half;
+}
+
+bool GetStaticShape(const Type& type, DType* dtype, std::vector<int64_t>* shape) {
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return false;
+  }
+  for (const auto& dim : ttype->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return false;
+    }
+    shape->push_back(imm->value);
+  }
+  *dtype = DType(ttype->dtype);
+  return true;
+}
+
+/*!
+ * \brief Whether cuBLASLt can write the output of a GEMM in another dtype, which is only the case
+ *        of the half-precision operands and the float32 output. The bias of the epilogues has the
+ *        output dtype, so the bias add is not fused with the cast.
+ */
+bool IsLtCastSupported(DType dtype, DType out_dtype, bool with_bias) {
+  if (dtype == out_dtype) {
+    return true;
+  }
+  bool is_half = (dtype.code == DTypeCode::kFloat() || dtype.code == DTypeCode::kBFloat()) &&
+                 dtype.bits == 16 && dtype.lanes == 1;
+  return is_half && out_dtype == DType(DTypeCode::kFloat(), 32) && !with_bias;
+}
+
+/*!
+ * \brief Check whether a match of the cuBLASLt fusion pattern can be offloaded, using the
+ *        inferred types of the graph. Rejected matches are left to the other patterns.
+ * \param expr The matched expression.
+ * \return Whether the match is supported by cuBLASLt.
+ */
+bool LtFusionCheck(const Expr& expr) {
+  LtGemmMatch match;
+  if (!MatchLtGemm(expr, &match)) {
+    return false;
+  }
+  DType dtype, out_dtype;
+  std::vector<int64_t> out_shape, cast_shape;
+  if (!GetStaticShape(match.matmul->checked_type_, &dtype, &out_shape) ||
+      !GetStaticShape(expr->checked_type_, &out_dtype, &cast_shape) ||
+      !IsLtSupported(out_dtype, match.act) ||
+      !IsLtCastSupported(dtype, out_dtype, match.bias.defined())) {
+    return false;
+  }
+  for (const auto& arg : match.matmul->args) {
+    DType arg_dtype;
+    std::vector<int64_t> arg_shape;
+    if (!GetStaticShape(arg->checked_type_, &arg_dtype, &arg_shape) || arg_dtype != dtype) {
+      return false;
+    }
+  }
+  if (match.bias.defined()) {
+    DType bias_dtype;
+    std::vector<int64_t> bias_shape;
+    if (!GetStaticShape(match.bias->checked_type_, &bias_dtype, &bias_shape) ||
+        bias_dtype != dtype ||
+        GetLtBiasMode(out_shape, bias_shape, match.gemm.batched) == LtBiasMode::kUnsupported) {
+      return false;
+    }
+  }
+  return true;
+}
+
+RAF_REGISTER_GLOBAL("raf.op.cublaslt._fusion_check").set_body_typed(LtFusionCheck);
+
+/*! \brief The persist cache entry of the algorithm picked by the cuBLASLt heuristics. */
+class LtMatmulAlgoCacheEntry {
+ public:
+  LtMatmulAlgoCacheEntry(const cublasLtMatmulAlgo_t& algo, uint64_t workspace_size)
+      : algo_(algo), workspace_size_(workspace_size) {
+  }
+
+  const cublasLtMatmulAlgo_t& Algo() const {
+    return algo_;
+  }
+
+  uint64_t WorkspaceSize() const {
+    return workspace_size_;
+  }
+
+  static LtMatmulAlgoCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+
+    cublasLtMatmulAlgo_t algo;
+    uint64_t workspace_size;
+    CHECK_EQ(stream->Read(algo.data, sizeof(algo.data)), sizeof(algo.data));
+    CHECK(stream->Read(&workspace_size));
+    return LtMatmulAlgoCacheEntry(algo, workspace_size);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::SeekStream* stream = &writer;
+    stream->Write(algo_.data, sizeof(algo_.data));
+    stream->Write(workspace_size_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  /*! \brief The opaque algorithm, which is plain data and can be serialized as is. */
+  cublasLtMatmulAlgo_t algo_;
+  /*! \brief The workspace size required by the algorithm. */
+  uint64_t workspace_size_;
+};
+
+MetaPersistCache<LtMatmulAlgoCacheEntry> CacheLtMatmulAlgo("cublaslt_matmul_algo");
+
+/*! \brief The largest power-of-two alignment of a pointer, capped by kLtMaxAlignment. */
+uint32_t GetAlignment(const void* ptr) {
+  uint32_t alignment = kLtMaxAlignment;
+  while (alignment > 1 && reinterpret_cast<uintptr_t>(ptr) % alignment != 0) {
+    alignment /= 2;
+  }
+  return alignment;
+}
+
+/*! \brief Round the bytes up to the alignment of the fp8 workspace buffers. */
+int64_t RoundUpFP8Bytes(int64_t nbytes) {
+  return (nbytes + kLtFP8BufferAlignment - 1) / kLtFP8BufferAlignment * kLtFP8BufferAlignment;
+}
+
+template <typename T>
+void SetLtAttr(cublasLtMatmulDesc_t desc, cublasLtMatmulDescAttributes_t attr, const T& value) {
+  CUBLAS_CALL(cublasLtMatmulDescSetAttribute(desc, attr, &value, sizeof(value)));
+}
+
+cublasLtMatrixLayout_t MakeLtLayout(cudaDataType_t dtype, int64_t rows, int64_t cols,
+                                    int32_t batch, int64_t batch_stride) {
+  cublasLtMatrixLayout_t layout;
+  CUBLAS_CALL(cublasLtMatrixLayoutCreate(&layout, dtype, rows, cols, rows));
+  if (batch > 1) {
+    CUBLAS_CALL(cublasLtMatrixLayoutSetAttribute(layout, CUBLASLT_MATRIX_LAYOUT_BATCH_COUNT,
+                                                 &batch, sizeof(batch)));
+    CUBLAS_CALL(cublasLtMatrixLayoutSetAttribute(
+        layout, CUBLASLT_MATRIX_LAYOUT_STRIDED_BATCH_OFFSET, &batch_stride, sizeof(batch_stride)));
+  }
+  return layout;
+}
+
+/*!
+ * \brief Run the fused functions of the cuBLASLt matmul fusion pattern, i.e.
+ *          - act(gemm_op(a, b) + bias)
+ *          - gemm_op(a, b) + bias
+ *          - act(gemm_op(a, b))
+ *          - cast(act(gemm_op(a, b))), cast(gemm_op(a, b))
+ *        where gemm_op = matmul | matmul_nt | matmul_tn | matmul_tt | dense |
+ *                        batch_matmul | batch_matmul_nt | batch_matmul_tn | batch_matmul_tt
+ *              act = relu | gelu
+ *        The cast of the half-precision GEMM to float32 is done by writing the output in float32.
+ *        The algorithm is picked by the cuBLASLt heuristics and cached by the problem.
+ */
+class CuBLASLtMatmulOpEnv : public raf::op::OpEnv {
+ public:
+  CuBLASLtMatmulOpEnv() = default;
+
+  ~CuBLASLtMatmulOpEnv() {
+    if (desc_ != nullptr) {
+      cublasLtMatmulDescDestroy(desc_);
+    }
+    for (auto layout : {a_desc_, b_desc_, c_desc_, d_desc_}) {
+      if (layout != nullptr) {
+        cublasLtMatrixLayoutDestroy(layout);
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cublaslt.matmul"));
+  }
+
+  void Init(const CallValues& cv) {
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    LtGemmMatch match;
+    CHECK(MatchLtGemm(func->body, &match)) << "Unsupported pattern:\n" << AsText(func);
+    gemm_ = match.gemm;
+    act_ = match.act;
+
+    // The GEMM operands must be the function params to be read from the call arguments.
+    std::vector<Expr> operands{match.matmul->args[0], match.matmul->args[1]};
+    if (match.bias.defined()) {
+      operands.push_back(match.bias);
+    }
+    for (const auto& operand : operands) {
+      size_t idx = 0;
+      while (idx < func->params.size() && !func->params[idx].same_as(operand)) {
+        ++idx;
+      }
+      CHECK_LT(idx, func->params.size()) << "The GEMM operands must be the function params";
+      arg_indices.push_back(idx);
+    }
+    Array<Value> args = GetListArgs(cv->args);
+    DLTensor* a = Downcast<TensorValue>(args[arg_indices[0]]);
+    DLTensor* b = Downcast<TensorValue>(args[arg_indices[1]]);
+    DLTensor* out = cv->out;
+    DLTensor* bias = match.bias.defined() ? Downcast<TensorValue>(args[arg_indices[2]]) : out;
+
+    DType dtype(a->dtype), out_dtype(out->dtype);
+    CHECK(IsLtSupported(out_dtype, act_)) << "Unsupported dtype " << out_dtype.c_str() << " with "
+                                          << (act_.empty() ? "no activation" : act_);
+    CHECK(IsLtCastSupported(dtype, out_dtype, match.bias.defined()))
+        << "Unsupported cast from " << dtype.c_str() << " to " << out_dtype.c_str();
+    CHECK(DType(b->dtype) == dtype && (!match.bias.defined() || DType(bias->dtype) == dtype))
+        << "The operands must have the same dtype";
+    bias_mode_ = LtBiasMode::kNone;
+    if (match.bias.defined()) {
+      bias_mode_ = GetLtBiasMode(GetShape<int64_t>(*out), GetShape<int64_t>(*bias), gemm_.batched);
+      CHECK(bias_mode_ != LtBiasMode::kUnsupported) << "Unsupported bias broadcast";
+    }
+
+    bool batched = gemm_.batched, ta = gemm_.transpose_a, tb = gemm_.transpose_b;
+    int32_t batch = batched ? out->shape[0] : 1;
+    int64_t m = out->shape[batched + 0];
+    int64_t n = out->shape[batched + 1];
+    int64_t k = ta ? a->shape[batched + 0] : a->shape[batched + 1];
+
+    int major, minor;
+    CUDA_CALL(cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor,
+                                     cv->device.device_id()));
+    CUDA_CALL(cudaDeviceGetAttribute(&minor, cudaDevAttrComputeCapabilityMinor,
+                                     cv->device.device_id()));
+    fp8_ = UseFP8(dtype, major, tb && !ta, m, n, k);
+
+    // cuBLASLt is column-major, so out^T = op(b)^T * op(a)^T is computed as in the cuBLAS GEMM.
+    cudaDataType_t data_type = cudaDataType_t(dtype);
+    cudaDataType_t out_type = cudaDataType_t(out_dtype);
+    // The fp8 operands are quantized with per-tensor scales that are applied by cuBLASLt.
+    cudaDataType_t operand_type = data_type;
+#if CUDA_VERSION >= 11080
+    if (fp8_) {
+      operand_type = CUDA_R_8F_E4M3;
+    }
+#endif
+    cublasComputeType_t compute_type = CUBLAS_COMPUTE_32F;
+    bool allow_tf32 = pass::PassContext::Current()
+                          ->GetConfig<tvm::Bool>("raf.cublas.allow_tf32", tvm::Bool(true))
+                          .value();
+    if (dtype.bits == 32 && allow_tf32) {
+      compute_type = CUBLAS_COMPUTE_32F_FAST_TF32;
+    }
+    cublasOperation_t transa = tb ? CUBLAS_OP_T : CUBLAS_OP_N;
+    cublasOperation_t transb = ta ? CUBLAS_OP_T : CUBLAS_OP_N;
+    cublasLtEpilogue_t epilogue = CUBLASLT_EPILOGUE_DEFAULT;
+    bool vector_bias = bias_mode_ == LtBiasMode::kVector;
+    if (act_ == "relu") {
+      epilogue = vector_bias ? CUBLASLT_EPILOGUE_RELU_BIAS : CUBLASLT_EPILOGUE_RELU;
+    } else if (act_ == "gelu") {
+      epilogue = vector_bias ? CUBLASLT_EPILOGUE_GELU_BIAS : CUBLASLT_EPILOGUE_GELU;
+    } else if (vector_bias) {
+      epilogue = CUBLASLT_EPILOGUE_BIAS;
+    }
+    CUBLAS_CALL(cublasLtMatmulDescCreate(&desc_, compute_type, CUDA_R_32F));
+    SetLtAttr(desc_, CUBLASLT_MATMUL_DESC_TRANSA, transa);
+    SetLtAttr(desc_, CUBLASLT_MATMUL_DESC_TRANSB, transb);
+    SetLtAttr(desc_, CUBLASLT_MATMUL_DESC_EPILOGUE, epilogue);
+
+    int64_t a_stride = (batched && a->shape[0] > 1) ? m * k : 0;
+    int64_t b_stride = (batched && b->shape[0] > 1) ? k * n : 0;
+    a_desc_ = MakeLtLayout(operand_type, tb ? k : n, tb ? n : k, batch, b_stride);
+    b_desc_ = MakeLtLayout(operand_type, ta ? m : k, ta ? k : m, batch, a_stride);
+    d_desc_ = MakeLtLayout(out_type, n, m, batch, m * n);
+    if (bias_mode_ == LtBiasMode::kMatrix) {
+      int64_t c_stride = (bias->ndim == out->ndim && bias->shape[0] == batch) ? m * n : 0;
+      c_desc_ = MakeLtLayout(data_type, n, m, batch, c_stride);
+      beta_ = 1.0f;
+    }
+
+    alignment_ = std::min(GetAlignment(a->data), GetAlignment(b->data));
+    alignment_ = std::min(alignment_, GetAlignment(out->data));
+    if (bias_mode_ != LtBiasMode::kNone) {
+      alignment_ = std::min(alignment_, GetAlignment(bias->data));
+    }
+
+    HashKey key;
+    key << major << minor << a->dtype << out->dtype << static_cast<int32_t>(compute_type) << ta
+        << tb << m << n << k << batch << (a_stride > 0) << (b_stride > 0)
+        << static_cast<int32_t>(epilogue) << static_cast<int32_t>(bias_mode_) << alignment_ << fp8_;
+    if (const auto* entry = CacheLtMatmulAlgo.Get(key)) {
+      algo_ = entry->Algo();
+      workspace_size_ = entry->WorkspaceSize();
+    } else {
+      FindAlgo();
+      CacheLtMatmulAlgo.Set(key, LtMatmulAlgoCacheEntry(algo_, workspace_size_));
+    }
+    if (workspace_size_ > 0) {
+      RequestWorkspace(&workspace_, cv->device, workspace_size_);
+    }
+    if (fp8_) {
+      // The amax and the scale of a and b, followed by the quantized a and b.
+      a_numel_ = common::shape_utils::GetNumel(*a);
+      b_numel_ = common::shape_utils::GetNumel(*b);
+      int64_t nbytes = kLtFP8BufferAlignment + RoundUpFP8Bytes(a_numel_) + b_numel_;
+      RequestWorkspace(&fp8_workspace_, cv->device, nbytes);
+    }
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* a = Downcast<TensorValue>(inputs[0]);
+    DLTensor* b = Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = Downcast<TensorValue>(output);
+    const void* c = out->data;
+    uint32_t alignment = std::min(GetAlignment(a->data), GetAlignment(b->data));
+    alignment = std::min(alignment, GetAlignment(out->data));
+    if (bias_mode_ != LtBiasMode::kNone) {
+      DLTensor* bias = Downcast<TensorValue>(inputs[2]);
+      alignment = std::min(alignment, GetAlignment(bias->data));
+      if (bias_mode_ == LtBiasMode::kVector) {
+        SetLtAttr(desc_, CUBLASLT_MATMUL_DESC_BIAS_POINTER, bias->data);
+      } else {
+        c = bias->data;
+      }
+    }
+    CHECK_GE(alignment, alignment_)
+        << "The buffers are less aligned than when the cuBLASLt algorithm was picked";
+    const void* a_data = a->data;
+    const void* b_data = b->data;
+    if (fp8_) {
+      char* base = static_cast<char*>(fp8_workspace_);
+      float* scales = reinterpret_cast<float*>(base);
+      void* a_fp8 = base + kLtFP8BufferAlignment;
+      void* b_fp8 = static_cast<char*>(a_fp8) + RoundUpFP8Bytes(a_numel_);
+      bool bf16 = a->dtype.code == kDLBfloat;
+      cuda::fp8_quantize_cuda(a->data, a_fp8, a_numel_, bf16, scales, scales + 1,
+                              compute_stream_);
+      cuda::fp8_quantize_cuda(b->data, b_fp8, b_numel_, bf16, scales + 2, scales + 3,
+                              compute_stream_);
+#if CUDA_VERSION >= 11080
+      // The cuBLASLt A and B are b and a.
+      const float* b_scale = scales + 3;
+      const float* a_scale = scales + 1;
+      SetLtAttr(desc_, CUBLASLT_MATMUL_DESC_A_SCALE_POINTER, b_scale);
+      SetLtAttr(desc_, CUBLASLT_MATMUL_DESC_B_SCALE_POINTER, a_scale);
+#endif
+      a_data = a_fp8;
+      b_data = b_fp8;
+    }
+    CUBLAS_CALL(cublasLtMatmul(CUBlasLtThreadEntry::ThreadLocal()->handle, desc_, &alpha_,
+                               b_data, a_desc_, a_data, b_desc_, &beta_, c,
+                               c_desc_ ? c_desc_ : d_desc_, out->data, d_desc_, &algo_,
+                               workspace_, workspace_size_,
+                               static_cast<cudaStream_t>(compute_stream_)));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto env = std::make_unique<CuBLASLtMatmulOpEnv>();
+    try {
+      env->Init(cv);
+    } catch (const dmlc::Error& e) {
+      env->error_msgs.push_back(std::string("[cuBLASLt] Failed to build: ") + e.what());
+    }
+    return env.release();
+  }
+
+ private:
+  /*!
+   * \brief Whether to run the GEMM in fp8, which is experimental and enabled by
+   * "raf.cublaslt.fp8". It requires half-precision operands on Hopper, the TN layout of cuBLASLt,
+   * i.e., only b is transposed, and the dims in multiples of 16.
+   */
+  static bool UseFP8(DType dtype, int major, bool tn_layout, int64_t m, int64_t n, int64_t k) {
+#if CUDA_VERSION >= 11080
+    bool enabled = pass::PassContext::Current()
+                       ->GetConfig<tvm::Bool>("raf.cublaslt.fp8", tvm::Bool(false))
+                       .value();
+    bool is_half = (dtype.code == DTypeCode::kFloat() || dtype.code == DTypeCode::kBFloat()) &&
+                   dtype.bits == 16;
+    return enabled && is_half && major >= 9 && tn_layout && m % 16 == 0 && n % 16 == 0 &&
+           k % 16 == 0;
+#else
+    return false;
+#endif
+  }
+
+  /*! \brief Pick the best algorithm with the cuBLASLt heuristics. */
+  void FindAlgo() {
+    cublasLtMatmulPreference_t pref;
+    CUBLAS_CALL(cublasLtMatmulPreferenceCreate(&pref));
+    auto set_pref = [&pref](cublasLtMatmulPreferenceAttributes_t attr, const auto& value) {
+      CUBLAS_CALL(cublasLtMatmulPreferenceSetAttribute(pref, attr, &value, sizeof(value)));
+    };
+    set_pref(CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES, kLtMaxWorkspaceBytes);
+    set_pref(CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_A_BYTES, alignment_);
+    set_pref(CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_B_BYTES, alignment_);
+    set_pref(CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_C_BYTES, alignment_);
+    set_pref(CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_D_BYTES, alignment_);
+    cublasLtMatmulHeuristicResult_t result;
+    int num_results = 0;
+    cublasStatus_t status = cublasLtMatmulAlgoGetHeuristic(
+        CUBlasLtThreadEntry::ThreadLocal()->handle, desc_, a_desc_, b_desc_,
+        c_desc_ ? c_desc_ : d_desc_, d_desc_, pref, 1, &result, &num_results);
+    cublasLtMatmulPreferenceDestroy(pref);
+    CUBLAS_CALL(status);
+    CHECK_GT(num_results, 0) << "No cuBLASLt algorithm is found";
+    algo_ = result.algo;
+    workspace_size_ = result.workspaceSize;
+  }
+
+  /*! \brief The layout of the GEMM. */
+  LtGemmInfo gemm_{false, false, false};
+  /*! \brief The fused activation. */
+  std::string act_;
+  /*! \brief How the bias is fed to cuBLASLt. */
+  LtBiasMode bias_mode_ = LtBiasMode::kNone;
+  /*! \brief The matmul descriptor, with transposes and the epilogue. */
+  cublasLtMatmulDesc_t desc_ = nullptr;
+  /*! \brief The layouts of b (A in cuBLASLt), a (B in cuBLASLt), the bias as C, and out. */
+  cublasLtMatrixLayout_t a_desc_ = nullptr, b_desc_ = nullptr, c_desc_ = nullptr,
+                         d_desc_ = nullptr;
+  /*! \brief The alignment assumed by the picked algorithm. */
+  uint32_t alignment_ = kLtMaxAlignment;
+  /*! \brief The picked algorithm. */
+  cublasLtMatmulAlgo_t algo_;
+  /*! \brief The workspace and its size. */
+  void* workspace_ = nullptr;
+  uint64_t workspace_size_ = 0;
+  /*! \brief The scaling factors, where beta is 1 if the bias is read as C. */
+  float alpha_ = 1.0f, beta_ = 0.0f;
+  /*! \brief The compute stream. */
+  void* compute_stream_ = nullptr;
+  /*! \brief Whether the operands are quantized to fp8. */
+  bool fp8_ = false;
+  /*! \brief The workspace of the fp8 scales and operands, and the numbers of the elements. */
+  void* fp8_workspace_ = nullptr;
+  int64_t a_numel_ = 0, b_numel_ = 0;
+};
+
+RAF_OP_ENV_MAKER("raf.op.cublaslt._fused_op", CuBLASLtMatmulOpEnv::make);
+
+// The ops in the fused functions. They are never dispatched on their own, so the plevel is -1
+// to avoid conflicting with the auxiliary ops of the other fusion dialects.
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_nt, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_tn, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, matmul_tt, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, dense, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, batch_matmul, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, batch_matmul_nt, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, batch_matmul_tn, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, batch_matmul_tt, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, add, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, relu, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, gelu, -1);
+RAF_REGISTER_DIALECT_OP(cublaslt, cast, -1);
+
+}  // namespace cublas
+}  // namespace op
+}  // namespace raf
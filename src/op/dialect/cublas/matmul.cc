@@ -36,6 +36,23 @@ void GemmImpl(DLTensor* a, bool transpose_a, DLTensor* b, bool transpose_b, DLTe
   int ldb = std::max(1, transpose_b ? k : m);
   int lda = std::max(1, transpose_a ? n : k);
 
+  // The int8 GEMMs accumulate in int32.
+  if (c->dtype.code == kDLInt && c->dtype.bits == 32 && a->dtype.code == kDLInt &&
+      a->dtype.bits == 8) {
+    CUBLAS_CALL(cublasGemmEx(handle, transb, transa, m, n, k, const_addr<1>(CUDA_R_32I), b->data,
+                             CUDA_R_8I, ldb, a->data, CUDA_R_8I, lda, const_addr<0>(CUDA_R_32I),
+                             c->data, CUDA_R_32I, m, CUBLAS_COMPUTE_32I, CUBLAS_GEMM_DEFAULT));
+    return;
+  }
+  // Half-precision GEMMs accumulate in fp32 on the tensor cores.
+  if (c->dtype.code == kDLBfloat && c->dtype.bits == 16) {
+    CUBLAS_CALL(cublasGemmEx(handle, transb, transa, m, n, k, const_addr<1>(CUDA_R_32F), b->data,
+                             cudaDataType_t(DType(b->dtype)), ldb, a->data,
+                             cudaDataType_t(DType(a->dtype)), lda, const_addr<0>(CUDA_R_32F),
+                             c->data, cudaDataType_t(DType(c->dtype)), m, CUDA_R_32F,
+                             CUBLAS_GEMM_DFALT_TENSOR_OP));
+    return;
+  }
   if (c->dtype.code == kDLFloat) {
     switch (c->dtype.bits) {
       case 16: {
@@ -123,16 +140,29 @@ using MatmulNT = MatmulImpl<false, true>;
 using MatmulTN = MatmulImpl<true, false>;
 using MatmulTT = MatmulImpl<true, true>;
 
+/*! \brief Make the int8 GEMM, or leave it to the next dialect if cuBLAS does not support it. */
+OpEnv* MakeQnnDense(const CallValues& cv) {
+  auto args = cv->args.as<op::schema::BinaryArgs>();
+  CHECK(args != nullptr);
+  OpEnv* env = MatmulNT::make(cv);
+  if (!IsInt8GemmSupported(args->x1, args->x2)) {
+    env->error_msgs.push_back("[cuBLAS] The int8 GEMM requires the dims in multiples of 4");
+  }
+  return env;
+}
+
 RAF_REGISTER_DIALECT_OP(cublas, matmul, 15);
 RAF_REGISTER_DIALECT_OP(cublas, matmul_nt, 15);
 RAF_REGISTER_DIALECT_OP(cublas, matmul_tn, 15);
 RAF_REGISTER_DIALECT_OP(cublas, matmul_tt, 15);
 RAF_REGISTER_DIALECT_OP(cublas, dense, 15);
+RAF_REGISTER_DIALECT_OP(cublas, qnn_dense, 15);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul", MatmulNN::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul_nt", MatmulNT::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul_tn", MatmulTN::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.matmul_tt", MatmulTT::make);
 RAF_OP_ENV_MAKER("raf.op.cublas.dense", MatmulNT::make);
+RAF_OP_ENV_MAKER("raf.op.cublas.qnn_dense", MakeQnnDense);
 
 }  // namespace manual
 }  // namespace cublas
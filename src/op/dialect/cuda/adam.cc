@@ -0,0 +1,165 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/adam.cc
+ * \brief Adam and AdamW cuda backend
+ */
+#include <limits>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/optimizer.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief The number of elements updated by a thread block. */
+constexpr int kAdamChunkSize = 65536;
+static_assert(kAdamChunkSize % kStateBlockSize == 0, "A state block cannot span two chunks");
+
+class AdamImpl : public raf::op::OpEnv {
+ public:
+  explicit AdamImpl(const CallValues& cv, bool adamw) : adamw_(adamw) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto adam_op = ir::Op::Get("raf.op.adam");
+    auto args = cv->args.as<op::schema::AdamArgs>();
+    this->arg_indices = {
+        fschema_index[adam_op]("tensor_list"),
+        fschema_index[adam_op]("step"),
+    };
+    learning_rate_ = args->learning_rate;
+    beta1_ = args->beta1;
+    beta2_ = args->beta2;
+    eps_ = args->eps;
+    weight_decay_ = args->weight_decay;
+    bias_correction_ = args->bias_correction;
+    inv_grad_scale_ = 1.0f / args->grad_scale;
+    dynamic_loss_scale_ = args->dynamic_loss_scale;
+    scale_window_ = args->scale_window;
+    quantize_states_ = args->quantize_states;
+
+    int ngroups = 4 + args->mixed_precision + quantize_states_;
+    int ntensors = (args->tensor_list.size() - dynamic_loss_scale_) / ngroups;
+    const DLTensor* g0 = args->tensor_list[0];
+    grad_dtype_ = g0->dtype;
+    copy_dtype_ = DLDataType{kDLFloat, 0, 1};
+    if (args->mixed_precision) {
+      const DLTensor* copy0 = args->tensor_list[4 * ntensors];
+      copy_dtype_ = copy0->dtype;
+    }
+    for (int i = 0; i < ntensors; ++i) {
+      const DLTensor* g = args->tensor_list[i];
+      const DLTensor* copy = args->mixed_precision ? args->tensor_list[4 * ntensors + i] : g;
+      CHECK(DType(g->dtype) == DType(grad_dtype_)) << "Adam expects the same gradient dtype";
+      CHECK(!args->mixed_precision || DType(copy->dtype) == DType(copy_dtype_))
+          << "Adam expects the same dtype of the weight copies";
+      int64_t numel = 1;
+      for (int j = 0; j < g->ndim; ++j) {
+        numel *= g->shape[j];
+      }
+      CHECK_LE(numel, std::numeric_limits<int>::max()) << "The tensor is too large for Adam";
+      if (quantize_states_) {
+        const DLTensor* scales = args->tensor_list[(ngroups - 1) * ntensors + i];
+        CHECK_EQ(scales->shape[0], 2 * ((numel + kStateBlockSize - 1) / kStateBlockSize))
+            << "Adam expects 2 scales per " << kStateBlockSize << " elements of the 8-bit states";
+      }
+      numels_.push_back(numel);
+    }
+
+    const DLTensor* step = args->step;
+    CHECK(step->ndim == 0 && step->device.device_type == kDLCUDA)
+        << "Adam expects a scalar step on the device";
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AdamArgs>();
+    Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
+    Value tuple = TupleValue::make(tvalue);
+    Execute(std::vector<Value>{tuple, args->step}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[0]);
+    DLTensor* step = ir::Downcast<TensorValue>(inputs[1]);
+
+    // The step and the loss scaler are read on the device, so the update never syncs the host.
+    AdamParams params;
+    params.lr = learning_rate_;
+    params.beta1 = beta1_;
+    params.beta2 = beta2_;
+    params.eps = eps_;
+    params.weight_decay = weight_decay_;
+    params.bias_correction = bias_correction_;
+    params.step = static_cast<const float*>(step->data);
+    params.inv_grad_scale = inv_grad_scale_;
+    params.loss_scaler = nullptr;
+    params.adamw = adamw_;
+    params.quantize_states = quantize_states_;
+
+    std::vector<void*> tlist;
+    for (const auto& field : tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      tlist.push_back(tensor->data);
+    }
+    if (dynamic_loss_scale_) {
+      params.loss_scaler = static_cast<float*>(tlist.back());
+      tlist.pop_back();
+    }
+    multi_tensor_adam_cuda(kAdamChunkSize, tlist, numels_, grad_dtype_, copy_dtype_, params,
+                           scale_window_, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(adamw_ ? "raf.op.cuda.adamw" : "raf.op.cuda.adam"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AdamImpl(cv, false);
+  }
+
+  static OpEnv* make_adamw(const CallValues& cv) {
+    return new AdamImpl(cv, true);
+  }
+
+ private:
+  bool adamw_;
+  float learning_rate_;
+  float beta1_;
+  float beta2_;
+  float eps_;
+  float weight_decay_;
+  bool bias_correction_;
+  float inv_grad_scale_;
+  /*! \brief Whether the last tensor of the list is the dynamic loss scaler. */
+  bool dynamic_loss_scale_;
+  /*! \brief The number of the finite steps after which the loss scale is doubled. */
+  int scale_window_;
+  /*! \brief Whether the moments are 8-bit with the block scales. */
+  bool quantize_states_;
+  /*! \brief The dtype of the gradients. */
+  DLDataType grad_dtype_;
+  /*! \brief The dtype of the weight copies, which has 0 bits if there are no copies. */
+  DLDataType copy_dtype_;
+  std::vector<int> numels_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, adam, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.adam", AdamImpl::make);
+RAF_REGISTER_DIALECT_OP(cuda, adamw, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.adamw", AdamImpl::make_adamw);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
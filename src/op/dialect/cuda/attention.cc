@@ -0,0 +1,324 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/attention.cc
+ * \brief attention cuda backend
+ */
+#include <cmath>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "./kernels/attention.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+using namespace c10;
+
+/*! \brief Make the parameters of the attention kernels from the shapes and the options. */
+AttentionParams MakeAttentionParams(const DLTensor* q, const DLTensor* k, bool causal,
+                                    double scale, double dropout_p, int64_t seed) {
+  AttentionParams params;
+  int ndim = q->ndim;
+  params.seq_q = q->shape[ndim - 2];
+  params.seq_k = k->shape[ndim - 2];
+  params.head_dim = q->shape[ndim - 1];
+  params.heads = ndim == 4 ? q->shape[1] : 1;
+  params.batch_heads = q->shape[0] * params.heads;
+  params.scale = scale > 0 ? scale : 1.0 / std::sqrt(static_cast<double>(params.head_dim));
+  params.causal = causal;
+  params.dropout_p = dropout_p;
+  params.seed = static_cast<uint64_t>(seed);
+  CHECK_LE(params.head_dim, kAttentionMaxHeadDim)
+      << "The head dim of the cuda attention is at most " << kAttentionMaxHeadDim;
+  CHECK_LE(params.batch_heads, 65535) << "Too many batches and heads for the cuda attention";
+  CHECK(q->dtype.code == kDLFloat);
+  CHECK((q->dtype.bits == 32) || (q->dtype.bits == 16));
+  return params;
+}
+
+class AttentionImpl : public raf::op::OpEnv {
+ public:
+  explicit AttentionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.attention");
+    auto args = cv->args.as<op::schema::AttentionArgs>();
+    this->arg_indices = {
+        fschema_index[op]("q"),
+        fschema_index[op]("k"),
+        fschema_index[op]("v"),
+    };
+    has_mask_ = args->mask.defined();
+    if (has_mask_) {
+      this->arg_indices.push_back(fschema_index[op]("mask"));
+    }
+    params_ = MakeAttentionParams(args->q, args->k, args->causal, args->scale, args->dropout_p,
+                                  args->seed);
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AttentionArgs>();
+    std::vector<Value> inputs{args->q, args->k, args->v};
+    if (has_mask_) {
+      inputs.push_back(args->mask.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* q = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* k = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[2]);
+    void* mask = nullptr;
+    if (has_mask_) {
+      DLTensor* mask_tensor = ir::Downcast<TensorValue>(inputs[3]);
+      mask = mask_tensor->data;
+    }
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* out = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* lse = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    float* lse_p = static_cast<float*>(lse->data);
+    switch (q->dtype.bits) {
+      case 16: {
+        HostAttentionForward<Half>(static_cast<Half*>(q->data), static_cast<Half*>(k->data),
+                                   static_cast<Half*>(v->data), static_cast<Half*>(mask),
+                                   static_cast<Half*>(out->data), lse_p, params_,
+                                   compute_stream_);
+        break;
+      }
+      case 32: {
+        HostAttentionForward<float>(static_cast<float*>(q->data), static_cast<float*>(k->data),
+                                    static_cast<float*>(v->data), static_cast<float*>(mask),
+                                    static_cast<float*>(out->data), lse_p, params_,
+                                    compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(q->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.attention"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AttentionImpl(cv);
+  }
+
+ private:
+  bool has_mask_;
+  AttentionParams params_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, attention, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.attention", AttentionImpl::make);
+
+class AttentionDxImpl : public raf::op::OpEnv {
+ public:
+  explicit AttentionDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto dx_op = ir::Op::Get("raf.op.attention_dx");
+    auto args = cv->args.as<op::schema::AttentionDxArgs>();
+    this->arg_indices = {
+        fschema_index[dx_op]("q"),   fschema_index[dx_op]("k"),   fschema_index[dx_op]("v"),
+        fschema_index[dx_op]("out"), fschema_index[dx_op]("lse"), fschema_index[dx_op]("dy"),
+    };
+    has_mask_ = args->mask.defined();
+    if (has_mask_) {
+      this->arg_indices.push_back(fschema_index[dx_op]("mask"));
+    }
+    params_ = MakeAttentionParams(args->q, args->k, args->causal, args->scale, args->dropout_p,
+                                  args->seed);
+    const DLTensor* q = args->q;
+    RequestWorkspace(&delta_, q->device,
+                     sizeof(float) * static_cast<int64_t>(params_.batch_heads) * params_.seq_q);
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AttentionDxArgs>();
+    std::vector<Value> inputs{args->q, args->k, args->v, args->out, args->lse, args->dy};
+    if (has_mask_) {
+      inputs.push_back(args->mask.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* q = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* k = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* lse = ir::Downcast<TensorValue>(inputs[4]);
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[5]);
+    void* mask = nullptr;
+    if (has_mask_) {
+      DLTensor* mask_tensor = ir::Downcast<TensorValue>(inputs[6]);
+      mask = mask_tensor->data;
+    }
+    const float* lse_p = static_cast<const float*>(lse->data);
+    float* delta_p = static_cast<float*>(delta_);
+
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* dq = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* dk = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* dv = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    switch (q->dtype.bits) {
+      case 16: {
+        HostAttentionBackward<Half>(
+            static_cast<Half*>(q->data), static_cast<Half*>(k->data), static_cast<Half*>(v->data),
+            static_cast<Half*>(mask), static_cast<Half*>(out->data), static_cast<Half*>(dy->data),
+            lse_p, delta_p, static_cast<Half*>(dq->data), static_cast<Half*>(dk->data),
+            static_cast<Half*>(dv->data), params_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostAttentionBackward<float>(
+            static_cast<float*>(q->data), static_cast<float*>(k->data),
+            static_cast<float*>(v->data), static_cast<float*>(mask),
+            static_cast<float*>(out->data), static_cast<float*>(dy->data), lse_p, delta_p,
+            static_cast<float*>(dq->data), static_cast<float*>(dk->data),
+            static_cast<float*>(dv->data), params_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(q->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.attention_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AttentionDxImpl(cv);
+  }
+
+ private:
+  bool has_mask_;
+  AttentionParams params_;
+  void* delta_ = nullptr;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, attention_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.attention_dx", AttentionDxImpl::make);
+
+class PagedAttentionImpl : public raf::op::OpEnv {
+ public:
+  explicit PagedAttentionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.paged_attention");
+    auto args = cv->args.as<op::schema::PagedAttentionArgs>();
+    this->arg_indices = {
+        fschema_index[op]("q"),
+        fschema_index[op]("k_cache"),
+        fschema_index[op]("v_cache"),
+        fschema_index[op]("block_table"),
+        fschema_index[op]("lengths"),
+    };
+    const DLTensor* q = args->q;
+    const DLTensor* k_cache = args->k_cache;
+    const DLTensor* block_table = args->block_table;
+    const DLTensor* lengths = args->lengths;
+    params_.batch = q->shape[0];
+    params_.heads = q->shape[1];
+    params_.seq_q = q->shape[2];
+    params_.head_dim = q->shape[3];
+    params_.block_size = k_cache->shape[2];
+    params_.max_blocks = block_table->shape[1];
+    params_.scale = args->scale > 0 ? args->scale
+                                    : 1.0 / std::sqrt(static_cast<double>(params_.head_dim));
+    if (params_.head_dim > kAttentionMaxHeadDim ||
+        static_cast<int64_t>(params_.batch) * params_.heads > 65535) {
+      this->error_msgs.push_back("[CUDA] paged_attention does not support the shape");
+    }
+    if (q->dtype.code != kDLFloat || (q->dtype.bits != 32 && q->dtype.bits != 16)) {
+      this->error_msgs.push_back("[CUDA] paged_attention does not support " +
+                                 std::string(DType(q->dtype).c_str()));
+    }
+    if (DType(block_table->dtype) != DType(DTypeCode::kInt(), 64) ||
+        DType(lengths->dtype) != DType(DTypeCode::kInt(), 64)) {
+      this->error_msgs.push_back(
+          "[CUDA] paged_attention only supports int64 block tables and lengths");
+    }
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::PagedAttentionArgs>();
+    Execute(std::vector<Value>{args->q, args->k_cache, args->v_cache, args->block_table,
+                               args->lengths},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* q = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* k_cache = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* v_cache = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* block_table = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* lengths = ir::Downcast<TensorValue>(inputs[4]);
+    const int64_t* table_p = static_cast<const int64_t*>(block_table->data);
+    const int64_t* lengths_p = static_cast<const int64_t*>(lengths->data);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    switch (q->dtype.bits) {
+      case 16: {
+        HostPagedAttentionForward<Half>(
+            static_cast<Half*>(q->data), static_cast<Half*>(k_cache->data),
+            static_cast<Half*>(v_cache->data), table_p, lengths_p,
+            static_cast<Half*>(out->data), params_, compute_stream_);
+        break;
+      }
+      case 32: {
+        HostPagedAttentionForward<float>(
+            static_cast<float*>(q->data), static_cast<float*>(k_cache->data),
+            static_cast<float*>(v_cache->data), table_p, lengths_p,
+            static_cast<float*>(out->data), params_, compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(q->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.paged_attention"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new PagedAttentionImpl(cv);
+  }
+
+ private:
+  PagedAttentionParams params_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, paged_attention, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.paged_attention", PagedAttentionImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,296 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/block_sparse.cc
+ * \brief block-sparse matmul and softmax cuda backend
+ */
+#include <vector>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "raf/memory_pool.h"
+#include "../../schema/nn.h"
+#include "../../ty/utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+using memory_pool::Memory;
+
+/*!
+ * \brief The base of the block-sparse ops, which keeps the table of the block layout on the device
+ * for the lifetime of the OpEnv, since the layout is a constant of the call.
+ */
+class BlockSparseOpEnv : public raf::op::OpEnv {
+ protected:
+  /*! \brief Check the dtype and the batch of the inputs. */
+  void CheckInputs(const std::string& op_name, const std::vector<const DLTensor*>& inputs) {
+    for (const DLTensor* x : inputs) {
+      if (!elementwise_dtype_supported(x->dtype) || DType(x->dtype) != DType(inputs[0]->dtype)) {
+        this->error_msgs.push_back("[CUDA] " + op_name + " does not support " +
+                                   std::string(DType(x->dtype).c_str()));
+        return;
+      }
+    }
+    if (inputs[0]->shape[0] > 65535) {
+      this->error_msgs.push_back("[CUDA] " + op_name + " supports up to 65535 batches");
+    }
+  }
+
+  /*! \brief Build the table of the layout on the device. */
+  void BuildTable(const std::string& op_name, const std::vector<int64_t>& layout, int64_t block,
+                  const Device& device) {
+    if (!block_sparse_block_supported(block)) {
+      this->error_msgs.push_back("[CUDA] " + op_name + " does not support the block size of " +
+                                 std::to_string(block));
+      return;
+    }
+    BlockSparseShape shape = GetBlockSparseShape(layout, block);
+    const int64_t* mask = layout.data() + 2;
+    // The block rows, the block cols and the row pointers of the blocks in the row-major order,
+    // followed by the blocks in the col-major order and the col pointers.
+    std::vector<int> host(3 * shape.nnz + shape.rows + shape.cols + 2);
+    int* block_rows = host.data();
+    int* block_cols = block_rows + shape.nnz;
+    int* row_ptr = block_cols + shape.nnz;
+    int* col_blocks = row_ptr + shape.rows + 1;
+    int* col_ptr = col_blocks + shape.nnz;
+    int nnz = 0;
+    for (int64_t r = 0; r < shape.rows; ++r) {
+      row_ptr[r] = nnz;
+      for (int64_t c = 0; c < shape.cols; ++c) {
+        if (mask[r * shape.cols + c]) {
+          block_rows[nnz] = r;
+          block_cols[nnz] = c;
+          nnz++;
+        }
+      }
+    }
+    row_ptr[shape.rows] = nnz;
+    std::vector<int> col_count(shape.cols + 1, 0);
+    for (int i = 0; i < nnz; ++i) {
+      col_count[block_cols[i] + 1]++;
+    }
+    col_ptr[0] = 0;
+    for (int64_t c = 0; c < shape.cols; ++c) {
+      col_ptr[c + 1] = col_ptr[c] + col_count[c + 1];
+    }
+    std::vector<int> col_fill(col_ptr, col_ptr + shape.cols);
+    for (int i = 0; i < nnz; ++i) {
+      col_blocks[col_fill[block_cols[i]]++] = i;
+    }
+    table_mem_ = Memory::Alloc(device, host.size() * sizeof(int));
+    CUDA_CALL(cudaMemcpy(table_mem_->data, host.data(), host.size() * sizeof(int),
+                         cudaMemcpyHostToDevice));
+    const int* data = static_cast<const int*>(table_mem_->data);
+    table_.rows = shape.rows;
+    table_.cols = shape.cols;
+    table_.nnz = shape.nnz;
+    table_.block = block;
+    table_.block_rows = data + (block_rows - host.data());
+    table_.block_cols = data + (block_cols - host.data());
+    table_.row_ptr = data + (row_ptr - host.data());
+    table_.col_blocks = data + (col_blocks - host.data());
+    table_.col_ptr = data + (col_ptr - host.data());
+  }
+
+  /*! \brief The table of the layout, and its memory on the device. */
+  BlockSparseTable table_;
+  std::shared_ptr<Memory> table_mem_;
+};
+
+class BlockSparseSddImpl : public BlockSparseOpEnv {
+ public:
+  explicit BlockSparseSddImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.block_sparse_matmul_sdd");
+    auto args = cv->args.as<op::schema::BlockSparseSddArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x1"),
+        fschema_index[op]("x2"),
+    };
+    CheckInputs("block_sparse_matmul_sdd", {args->x1, args->x2});
+    if (this->HasError()) {
+      return;
+    }
+    BuildTable("block_sparse_matmul_sdd", args->layout, args->block, cv->device);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BlockSparseSddArgs>();
+    Execute(std::vector<Value>{args->x1, args->x2}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x1 = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x2 = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    block_sparse_sdd_cuda(x1->data, x2->data, out->data, table_, x1->shape[0], x1->shape[2],
+                          x1->dtype, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.block_sparse_matmul_sdd"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new BlockSparseSddImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, block_sparse_matmul_sdd, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.block_sparse_matmul_sdd", BlockSparseSddImpl::make);
+
+class BlockSparseDsdImpl : public BlockSparseOpEnv {
+ public:
+  explicit BlockSparseDsdImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.block_sparse_matmul_dsd");
+    auto args = cv->args.as<op::schema::BlockSparseDsdArgs>();
+    this->arg_indices = {
+        fschema_index[op]("a"),
+        fschema_index[op]("x"),
+    };
+    transpose_a_ = args->transpose_a;
+    CheckInputs("block_sparse_matmul_dsd", {args->a, args->x});
+    if (this->HasError()) {
+      return;
+    }
+    BuildTable("block_sparse_matmul_dsd", args->layout, args->block, cv->device);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BlockSparseDsdArgs>();
+    Execute(std::vector<Value>{args->a, args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* a = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    block_sparse_dsd_cuda(a->data, x->data, out->data, table_, transpose_a_, x->shape[0],
+                          x->shape[2], x->dtype, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.block_sparse_matmul_dsd"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new BlockSparseDsdImpl(cv);
+  }
+
+ private:
+  bool transpose_a_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, block_sparse_matmul_dsd, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.block_sparse_matmul_dsd", BlockSparseDsdImpl::make);
+
+class BlockSparseSoftmaxImpl : public BlockSparseOpEnv {
+ public:
+  explicit BlockSparseSoftmaxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.block_sparse_softmax");
+    auto args = cv->args.as<op::schema::BlockSparseSoftmaxArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    scale_ = args->scale;
+    causal_ = args->causal;
+    CheckInputs("block_sparse_softmax", {args->x});
+    if (this->HasError()) {
+      return;
+    }
+    BuildTable("block_sparse_softmax", args->layout, args->block, cv->device);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BlockSparseSoftmaxArgs>();
+    Execute(std::vector<Value>{args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    block_sparse_softmax_cuda(x->data, out->data, table_, scale_, causal_, x->shape[0], x->dtype,
+                              cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.block_sparse_softmax"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new BlockSparseSoftmaxImpl(cv);
+  }
+
+ private:
+  float scale_;
+  bool causal_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, block_sparse_softmax, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.block_sparse_softmax", BlockSparseSoftmaxImpl::make);
+
+class BlockSparseSoftmaxDxImpl : public BlockSparseOpEnv {
+ public:
+  explicit BlockSparseSoftmaxDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.block_sparse_softmax_dx");
+    auto args = cv->args.as<op::schema::BlockSparseSoftmaxDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("y"),
+        fschema_index[op]("dy"),
+    };
+    scale_ = args->scale;
+    CheckInputs("block_sparse_softmax_dx", {args->y, args->dy});
+    if (this->HasError()) {
+      return;
+    }
+    BuildTable("block_sparse_softmax_dx", args->layout, args->block, cv->device);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::BlockSparseSoftmaxDxArgs>();
+    Execute(std::vector<Value>{args->y, args->dy}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* y = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    block_sparse_softmax_dx_cuda(y->data, dy->data, out->data, table_, scale_, y->shape[0],
+                                 y->dtype, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.block_sparse_softmax_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new BlockSparseSoftmaxDxImpl(cv);
+  }
+
+ private:
+  float scale_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, block_sparse_softmax_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.block_sparse_softmax_dx", BlockSparseSoftmaxDxImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
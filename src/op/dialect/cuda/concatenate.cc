@@ -0,0 +1,139 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/concatenate.cc
+ * \brief concatenate and split cuda backend, which copy all the tensors in one launch
+ */
+#include <vector>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*!
+ * \brief Concatenate copies the rows of each input, i.e., the dims from the axis, to the columns
+ * of the output at the offset of the input, and split copies them back. The layout of the copies
+ * only depends on the shapes, so they are computed once, and the pointers are filled per run.
+ */
+class ConcatenateImpl : public raf::op::OpEnv {
+ public:
+  explicit ConcatenateImpl(const CallValues& cv, bool split) : split_(split) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    std::vector<const DLTensor*> parts;
+    const DLTensor* whole = nullptr;
+    int axis = 0;
+    if (split) {
+      auto args = cv->args.as<op::schema::SplitArgs>();
+      this->arg_indices = {fschema_index[ir::Op::Get("raf.op.split")]("x")};
+      whole = args->x;
+      axis = args->axis;
+      for (const auto& field : ir::Downcast<TupleValue>(cv->out)->fields) {
+        DLTensor* part = ir::Downcast<TensorValue>(field);
+        parts.push_back(part);
+      }
+    } else {
+      auto args = cv->args.as<op::schema::ConcatenateArgs>();
+      this->arg_indices = {fschema_index[ir::Op::Get("raf.op.concatenate")]("x")};
+      DLTensor* out = ir::Downcast<TensorValue>(cv->out);
+      whole = out;
+      axis = args->axis;
+      for (const auto& x : args->x) {
+        parts.push_back(x);
+      }
+    }
+    axis = axis < 0 ? axis + whole->ndim : axis;
+    int64_t elem_bytes = (whole->dtype.bits * whole->dtype.lanes + 7) / 8;
+    rows_ = 1;
+    for (int i = 0; i < axis; ++i) {
+      rows_ *= whole->shape[i];
+    }
+    int64_t offset = 0;
+    for (const DLTensor* part : parts) {
+      if (DType(part->dtype) != DType(whole->dtype)) {
+        this->error_msgs.push_back("[CUDA] concatenate and split expect the same dtype");
+        return;
+      }
+      int64_t row_bytes = elem_bytes;
+      for (int i = axis; i < part->ndim; ++i) {
+        row_bytes *= part->shape[i];
+      }
+      part_bytes_.push_back(row_bytes);
+      offsets_.push_back(offset);
+      offset += row_bytes;
+    }
+    whole_bytes_ = offset;
+  }
+
+  void Execute(const CallValues& cv) override {
+    if (split_) {
+      auto args = cv->args.as<op::schema::SplitArgs>();
+      Execute(std::vector<Value>{args->x}, cv->out);
+    } else {
+      auto args = cv->args.as<op::schema::ConcatenateArgs>();
+      Array<Value> fields = {args->x.begin(), args->x.end()};
+      Execute(std::vector<Value>{TupleValue::make(fields)}, cv->out);
+    }
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    const Value& tuple = split_ ? output : inputs[0];
+    DLTensor* whole = ir::Downcast<TensorValue>(split_ ? inputs[0] : output);
+    auto& fields = ir::Downcast<TupleValue>(tuple)->fields;
+    std::vector<CopySegment> segments;
+    for (size_t i = 0; i < part_bytes_.size(); ++i) {
+      DLTensor* part = ir::Downcast<TensorValue>(fields[i]);
+      void* column = static_cast<uint8_t*>(whole->data) + offsets_[i];
+      if (split_) {
+        segments.push_back({column, part->data, rows_, part_bytes_[i], whole_bytes_,
+                            part_bytes_[i]});
+      } else {
+        segments.push_back({part->data, column, rows_, part_bytes_[i], part_bytes_[i],
+                            whole_bytes_});
+      }
+    }
+    multi_tensor_copy_cuda(segments, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(split_ ? "raf.op.cuda.split" : "raf.op.cuda.concatenate"));
+  }
+
+  static OpEnv* make_concatenate(const CallValues& cv) {
+    return new ConcatenateImpl(cv, false);
+  }
+
+  static OpEnv* make_split(const CallValues& cv) {
+    return new ConcatenateImpl(cv, true);
+  }
+
+ private:
+  /*! \brief Whether the op is split, which copies the whole to the parts. */
+  bool split_;
+  /*! \brief The rows before the axis, and the bytes of a row of the whole. */
+  int64_t rows_ = 1;
+  int64_t whole_bytes_ = 0;
+  /*! \brief The bytes of a row of each part, and its offset in a row of the whole. */
+  std::vector<int64_t> part_bytes_;
+  std::vector<int64_t> offsets_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, concatenate, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.concatenate", ConcatenateImpl::make_concatenate);
+RAF_REGISTER_DIALECT_OP(cuda, split, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.split", ConcatenateImpl::make_split);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,170 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/cross_entropy.cc
+ * \brief softmax_cross_entropy and softmax_cross_entropy_dpred cuda backend
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/loss.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief Check the logits are float32 or float16 of (n, v), and the labels are int64 of (n,). */
+static void CheckCrossEntropyArgs(const DLTensor* y_true, const DLTensor* y_pred,
+                                  std::vector<std::string>* error_msgs) {
+  DType dtype = y_pred->dtype;
+  if (dtype != DType(DTypeCode::kFloat(), 32) && dtype != DType(DTypeCode::kFloat(), 16)) {
+    error_msgs->push_back("[CUDA] softmax_cross_entropy does not support " +
+                          std::string(dtype.c_str()));
+  }
+  if (y_pred->ndim != 2 || y_true->ndim != 1 ||
+      DType(y_true->dtype) != DType(DTypeCode::kInt(), 64)) {
+    error_msgs->push_back("[CUDA] softmax_cross_entropy only supports int64 labels of (n,)");
+  }
+}
+
+/*!
+ * \brief The fused softmax cross entropy, which reduces each row of the logits to its stats in one
+ * pass, so neither the softmax nor the log softmax of (n, v) is materialized.
+ */
+class SoftmaxCrossEntropyImpl : public raf::op::OpEnv {
+ public:
+  explicit SoftmaxCrossEntropyImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.softmax_cross_entropy");
+    auto args = cv->args.as<op::schema::LossArgs>();
+    this->arg_indices = {
+        fschema_index[op]("y_true"),
+        fschema_index[op]("y_pred"),
+    };
+    CheckCrossEntropyArgs(args->y_true, args->y_pred, &this->error_msgs);
+    const DLTensor* y_pred = args->y_pred;
+    n_ = y_pred->shape[0];
+    RequestWorkspace(&stats_, cv->device, 3 * n_ * sizeof(float));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::LossArgs>();
+    Execute(std::vector<value::Value>{args->y_true, args->y_pred}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* y_true = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* y_pred = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    auto labels = static_cast<const int64_t*>(y_true->data);
+    auto max = static_cast<float*>(stats_);
+    int64_t v = y_pred->shape[1];
+    if (y_pred->dtype.bits == 32) {
+      cross_entropy_stats_cuda(static_cast<const float*>(y_pred->data), labels, n_, v, 0, max,
+                               max + n_, max + 2 * n_, stream);
+      cross_entropy_loss_cuda(max, max + n_, max + 2 * n_, n_, static_cast<float*>(out->data),
+                              stream);
+    } else {
+      cross_entropy_stats_cuda(static_cast<const __half*>(y_pred->data), labels, n_, v, 0, max,
+                               max + n_, max + 2 * n_, stream);
+      cross_entropy_loss_cuda(max, max + n_, max + 2 * n_, n_, static_cast<__half*>(out->data),
+                              stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.softmax_cross_entropy"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new SoftmaxCrossEntropyImpl(cv);
+  }
+
+ private:
+  int64_t n_;
+  /*! \brief The max, the sum and the label logit of each row. */
+  void* stats_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, softmax_cross_entropy, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.softmax_cross_entropy", SoftmaxCrossEntropyImpl::make);
+
+/*!
+ * \brief The gradient of the fused softmax cross entropy, which recomputes the stats of the rows
+ * instead of reading a stored softmax, and writes the gradient in a second pass.
+ */
+class SoftmaxCrossEntropyDpredImpl : public raf::op::OpEnv {
+ public:
+  explicit SoftmaxCrossEntropyDpredImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.softmax_cross_entropy_dpred");
+    auto args = cv->args.as<op::schema::LossDtpArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("y_true"),
+        fschema_index[op]("y_pred"),
+    };
+    CheckCrossEntropyArgs(args->y_true, args->y_pred, &this->error_msgs);
+    const DLTensor* y_pred = args->y_pred;
+    n_ = y_pred->shape[0];
+    RequestWorkspace(&stats_, cv->device, 3 * n_ * sizeof(float));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::LossDtpArgs>();
+    Execute(std::vector<value::Value>{args->dy, args->y_true, args->y_pred}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* y_true = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* y_pred = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    auto labels = static_cast<const int64_t*>(y_true->data);
+    auto max = static_cast<float*>(stats_);
+    int64_t v = y_pred->shape[1];
+    if (y_pred->dtype.bits == 32) {
+      auto logits = static_cast<const float*>(y_pred->data);
+      cross_entropy_stats_cuda(logits, labels, n_, v, 0, max, max + n_, max + 2 * n_, stream);
+      cross_entropy_dx_cuda(static_cast<const float*>(dy->data), logits, labels, max, max + n_,
+                            n_, v, 0, static_cast<float*>(out->data), stream);
+    } else {
+      auto logits = static_cast<const __half*>(y_pred->data);
+      cross_entropy_stats_cuda(logits, labels, n_, v, 0, max, max + n_, max + 2 * n_, stream);
+      cross_entropy_dx_cuda(static_cast<const __half*>(dy->data), logits, labels, max, max + n_,
+                            n_, v, 0, static_cast<__half*>(out->data), stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.softmax_cross_entropy_dpred"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new SoftmaxCrossEntropyDpredImpl(cv);
+  }
+
+ private:
+  int64_t n_;
+  /*! \brief The max, the sum and the label logit of each row. */
+  void* stats_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, softmax_cross_entropy_dpred, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.softmax_cross_entropy_dpred", SoftmaxCrossEntropyDpredImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,213 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/elementwise.cc
+ * \brief The elementwise, broadcast and cast ops of the precompiled cuda kernels, which run
+ * without the JIT of TVM, e.g., for the first iteration of a fresh process.
+ */
+#include <type_traits>
+#include <vector>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/ufunc.h"
+#include "../../schema/transform.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+inline std::vector<Value> GetInputs(const schema::UnaryArgs* args) {
+  return {args->x};
+}
+
+inline std::vector<Value> GetInputs(const schema::BinaryArgs* args) {
+  return {args->x1, args->x2};
+}
+
+inline std::vector<Value> GetInputs(const schema::BinaryUfuncArgs* args) {
+  return {args->x1, args->x2};
+}
+
+inline std::vector<Value> GetInputs(const schema::CastArgs* args) {
+  return {args->data};
+}
+
+inline std::vector<std::string> GetArgNames(const schema::UnaryArgs* args) {
+  return {"x"};
+}
+
+inline std::vector<std::string> GetArgNames(const schema::BinaryArgs* args) {
+  return {"x1", "x2"};
+}
+
+inline std::vector<std::string> GetArgNames(const schema::BinaryUfuncArgs* args) {
+  return {"x1", "x2"};
+}
+
+inline std::vector<std::string> GetArgNames(const schema::CastArgs* args) {
+  return {"data"};
+}
+
+/*!
+ * \brief The unary, binary and cast ops of the float tensors, which are dispatched before TVM and
+ * fall back to it for the other dtypes, the scalars, or the broadcasts of too many dims.
+ */
+template <typename TArgs>
+class ElementwiseImpl : public raf::op::OpEnv {
+ public:
+  explicit ElementwiseImpl(const CallValues& cv, const std::string& op_name, ElementwiseOp op)
+      : op_name_(op_name), op_(op) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<TArgs>();
+    for (const auto& name : GetArgNames(args)) {
+      this->arg_indices.push_back(fschema_index[ir::Op::Get(op_name)](name));
+    }
+    const auto* out = cv->out.as<TensorValueObj>();
+    if (out == nullptr) {
+      this->error_msgs.push_back("[CUDA] The elementwise kernels expect a tensor output");
+      return;
+    }
+    const DLTensor* y = out->tensor.operator->();
+    n_ = 1;
+    for (int i = 0; i < y->ndim; ++i) {
+      n_ *= y->shape[i];
+    }
+    std::vector<const DLTensor*> xs;
+    for (const auto& input : GetInputs(args)) {
+      const auto* tensor = input.as<TensorValueObj>();
+      if (tensor == nullptr) {
+        this->error_msgs.push_back("[CUDA] The elementwise kernels expect tensor inputs");
+        return;
+      }
+      xs.push_back(tensor->tensor.operator->());
+    }
+    in_dtype_ = xs[0]->dtype;
+    out_dtype_ = y->dtype;
+    for (const DLTensor* x : xs) {
+      if (!elementwise_dtype_supported(x->dtype) || DType(x->dtype) != DType(in_dtype_)) {
+        this->error_msgs.push_back("[CUDA] The elementwise kernels do not support " +
+                                   std::string(DType(x->dtype).c_str()));
+        return;
+      }
+    }
+    if (!elementwise_dtype_supported(out_dtype_) ||
+        (!std::is_same<TArgs, schema::CastArgs>::value && DType(out_dtype_) != DType(in_dtype_))) {
+      this->error_msgs.push_back("[CUDA] The elementwise kernels do not support the output of " +
+                                 std::string(DType(out_dtype_).c_str()));
+      return;
+    }
+    if (xs.size() == 2 && (!SameShape(xs[0], y) || !SameShape(xs[1], y))) {
+      if (y->ndim > kElementwiseMaxDims) {
+        this->error_msgs.push_back("[CUDA] The broadcast kernels support up to " +
+                                   std::to_string(kElementwiseMaxDims) + " dims");
+        return;
+      }
+      broadcast_ = true;
+      bcast_.ndim = y->ndim;
+      int64_t stride = 1;
+      for (int d = y->ndim - 1; d >= 0; --d) {
+        bcast_.out_strides[d] = stride;
+        stride *= y->shape[d];
+      }
+      SetBroadcastStrides(xs[0], y->ndim, bcast_.x1_strides);
+      SetBroadcastStrides(xs[1], y->ndim, bcast_.x2_strides);
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<TArgs>();
+    Execute(GetInputs(args), cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    void* stream = cuda_device_api->GetStream();
+    DLTensor* y = ir::Downcast<TensorValue>(output);
+    DLTensor* x1 = ir::Downcast<TensorValue>(inputs[0]);
+    if (std::is_same<TArgs, schema::CastArgs>::value) {
+      elementwise_cast_cuda(x1->data, in_dtype_, y->data, out_dtype_, n_, stream);
+    } else if (inputs.size() == 1) {
+      elementwise_unary_cuda(op_, x1->data, y->data, n_, out_dtype_, stream);
+    } else {
+      DLTensor* x2 = ir::Downcast<TensorValue>(inputs[1]);
+      elementwise_binary_cuda(op_, x1->data, x2->data, y->data, n_, out_dtype_,
+                              broadcast_ ? &bcast_ : nullptr, stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda." + op_name_.substr(sizeof("raf.op.") - 1)));
+  }
+
+ private:
+  static bool SameShape(const DLTensor* x, const DLTensor* y) {
+    if (x->ndim != y->ndim) {
+      return false;
+    }
+    for (int i = 0; i < x->ndim; ++i) {
+      if (x->shape[i] != y->shape[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief The strides of x aligned to the trailing dims of ndim, which are 0 if broadcast. */
+  static void SetBroadcastStrides(const DLTensor* x, int ndim, int64_t* strides) {
+    int64_t stride = 1;
+    for (int d = ndim - 1; d >= 0; --d) {
+      int xd = d - (ndim - x->ndim);
+      int64_t dim = xd >= 0 ? x->shape[xd] : 1;
+      strides[d] = dim == 1 ? 0 : stride;
+      stride *= dim;
+    }
+  }
+
+  /*! \brief The base op and its kernel. */
+  std::string op_name_;
+  ElementwiseOp op_;
+  /*! \brief The dtypes of the inputs and the output, and the number of the output elements. */
+  DLDataType in_dtype_;
+  DLDataType out_dtype_;
+  int64_t n_ = 0;
+  /*! \brief Whether the binary op broadcasts, and its layout. */
+  bool broadcast_ = false;
+  ElementwiseBroadcast bcast_;
+};
+
+// Above TVM, which compiles the kernels on the first use, and below the library dialects.
+#define RAF_CUDA_ELEMENTWISE(OP, SCHEMA, KERNEL_OP)                           \
+  RAF_REGISTER_DIALECT_OP(cuda, OP, 12);                                      \
+  RAF_OP_ENV_MAKER("raf.op.cuda." #OP, [](const CallValues& cv) -> OpEnv* {   \
+    return new ElementwiseImpl<schema::SCHEMA>(cv, "raf.op." #OP, KERNEL_OP); \
+  })
+
+RAF_CUDA_ELEMENTWISE(add, BinaryUfuncArgs, ElementwiseOp::kAdd);
+RAF_CUDA_ELEMENTWISE(subtract, BinaryUfuncArgs, ElementwiseOp::kSubtract);
+RAF_CUDA_ELEMENTWISE(multiply, BinaryArgs, ElementwiseOp::kMultiply);
+RAF_CUDA_ELEMENTWISE(divide, BinaryArgs, ElementwiseOp::kDivide);
+RAF_CUDA_ELEMENTWISE(maximum, BinaryArgs, ElementwiseOp::kMaximum);
+RAF_CUDA_ELEMENTWISE(minimum, BinaryArgs, ElementwiseOp::kMinimum);
+RAF_CUDA_ELEMENTWISE(copy, UnaryArgs, ElementwiseOp::kCopy);
+RAF_CUDA_ELEMENTWISE(abs, UnaryArgs, ElementwiseOp::kAbs);
+RAF_CUDA_ELEMENTWISE(negative, UnaryArgs, ElementwiseOp::kNegative);
+RAF_CUDA_ELEMENTWISE(relu, UnaryArgs, ElementwiseOp::kRelu);
+RAF_CUDA_ELEMENTWISE(sigmoid, UnaryArgs, ElementwiseOp::kSigmoid);
+RAF_CUDA_ELEMENTWISE(tanh, UnaryArgs, ElementwiseOp::kTanh);
+RAF_CUDA_ELEMENTWISE(exp, UnaryArgs, ElementwiseOp::kExp);
+RAF_CUDA_ELEMENTWISE(log, UnaryArgs, ElementwiseOp::kLog);
+RAF_CUDA_ELEMENTWISE(sqrt, UnaryArgs, ElementwiseOp::kSqrt);
+RAF_CUDA_ELEMENTWISE(rsqrt, UnaryArgs, ElementwiseOp::kRsqrt);
+RAF_CUDA_ELEMENTWISE(cast, CastArgs, ElementwiseOp::kCopy);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
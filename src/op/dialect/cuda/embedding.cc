@@ -5,12 +5,13 @@
 
 /*!
  * \file src/op/dialect/cuda/embedding.cc
- * \brief embedding_dx cuda backend
+ * \brief embedding_dx and embedding_sparse_dx cuda backend
  */
 #include "raf/op.h"
 #include "raf/op_utils.h"
 #include "raf/device_api.h"
 #include "../../schema/nn.h"
+#include "../../../common/shape_utils.h"
 #include "./kernels/kernel_util.cuh"
 
 namespace raf {
@@ -88,6 +89,79 @@ class EmbeddingDxImpl : public raf::op::OpEnv {
 RAF_REGISTER_DIALECT_OP(cuda, embedding_dx, 20);
 RAF_OP_ENV_MAKER("raf.op.cuda.embedding_dx", EmbeddingDxImpl::make);
 
+class EmbeddingSparseDxImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingSparseDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding_sparse_dx");
+    auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
+    this->arg_indices = {
+        fschema_index[op]("dy"),
+        fschema_index[op]("indices"),
+    };
+    const DLTensor* dy = args->dy;
+    if (dy->dtype.code != kDLFloat || (dy->dtype.bits != 32 && dy->dtype.bits != 16)) {
+      this->error_msgs.push_back("[CUDA] The row-sparse embedding gradient is float32 or float16");
+      return;
+    }
+    const DLTensor* indices = args->indices;
+    n_indices_ = 1;
+    for (int i = 0; i < indices->ndim; ++i) {
+      n_indices_ *= indices->shape[i];
+    }
+    RequestWorkspace(&keys_, cv->device, n_indices_ * sizeof(int64_t));
+    RequestWorkspace(&order_, cv->device, n_indices_ * sizeof(int64_t));
+    RequestWorkspace(&segments_, cv->device, n_indices_ * sizeof(int64_t));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingDxArgs>();
+    Execute(std::vector<value::Value>{args->dy, args->indices}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    TupleValue out = ir::Downcast<TupleValue>(output);
+    DLTensor* rows = ir::Downcast<TensorValue>(out->fields[0]);
+    DLTensor* values = ir::Downcast<TensorValue>(out->fields[1]);
+    int stride = n_indices_ > 0 ? common::shape_utils::GetNumel(*values) / n_indices_ : 0;
+    auto keys = static_cast<int64_t*>(keys_);
+    auto order = static_cast<int64_t*>(order_);
+    auto segments = static_cast<int64_t*>(segments_);
+    auto p_indices = static_cast<const int64_t*>(indices->data);
+    auto p_rows = static_cast<int64_t*>(rows->data);
+    if (dy->dtype.bits == 32) {
+      embedding_sparse_backward_cuda<float>(
+          static_cast<const float*>(dy->data), p_indices, n_indices_, stride, keys, order,
+          segments, p_rows, static_cast<float*>(values->data), cuda_device_api->GetStream());
+    } else {
+      embedding_sparse_backward_cuda<__half>(
+          static_cast<const __half*>(dy->data), p_indices, n_indices_, stride, keys, order,
+          segments, p_rows, static_cast<__half*>(values->data), cuda_device_api->GetStream());
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_sparse_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingSparseDxImpl(cv);
+  }
+
+ private:
+  int64_t n_indices_ = 0;
+  void* keys_ = nullptr;
+  void* order_ = nullptr;
+  void* segments_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_sparse_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_sparse_dx", EmbeddingSparseDxImpl::make);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
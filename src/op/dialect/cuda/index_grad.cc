@@ -0,0 +1,270 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/index_grad.cc
+ * \brief take_dx, gather_dx and gather_nd_dx cuda backend
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/nn.h"
+#include "../../schema/transform.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*!
+ * \brief The average number of the indices per row from which the gradients are reduced by
+ * sorting instead of atomics, which serialize on the same rows.
+ */
+static const int64_t kSortCollisionRatio = 4;
+
+/*!
+ * \brief The strategy to add the gradients of the indexing ops, set by RAF_CUDA_INDEX_GRAD, which
+ * is "auto" (default), "atomic" or "deterministic".
+ */
+enum class IndexGradStrategy { kAuto, kAtomic, kDeterministic };
+
+IndexGradStrategy GetIndexGradStrategy() {
+  static IndexGradStrategy strategy = []() {
+    const char* env = getenv("RAF_CUDA_INDEX_GRAD");
+    if (env == nullptr || strcmp(env, "auto") == 0) {
+      return IndexGradStrategy::kAuto;
+    } else if (strcmp(env, "atomic") == 0) {
+      return IndexGradStrategy::kAtomic;
+    }
+    CHECK_EQ(strcmp(env, "deterministic"), 0)
+        << "RAF_CUDA_INDEX_GRAD is auto, atomic or deterministic, but got " << env;
+    return IndexGradStrategy::kDeterministic;
+  }();
+  return strategy;
+}
+
+/*!
+ * \brief The backward of an indexing op, which adds the rows of dy of (outer, n, inner) to the
+ * rows of dx of (outer, rows, inner) given by the n indices. Only the sizes are known before the
+ * indices, so the strategy is chosen by the average number of the indices per row: the
+ * contention of atomics grows with the collisions, while sorting the indices and reducing the
+ * segments costs the same and is deterministic.
+ */
+class IndexGradImpl : public raf::op::OpEnv {
+ public:
+  /*! \brief The kinds of the indexing ops, which map the indices to the rows differently. */
+  enum Kind { kTake, kGather, kGatherNd };
+
+  void Execute(const CallValues& cv) override {
+    Value dy, indices;
+    if (auto args = cv->args.as<op::schema::TakeDxArgs>()) {
+      dy = args->dy;
+      indices = args->indices;
+    } else if (auto args = cv->args.as<op::schema::GatherDxArgs>()) {
+      dy = args->dy;
+      indices = args->indices;
+    } else {
+      auto gather_nd_args = cv->args.as<op::schema::GatherNdDxArgs>();
+      dy = gather_nd_args->dy;
+      indices = gather_nd_args->indices;
+    }
+    Execute(std::vector<Value>{dy, indices}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* dx = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    auto keys = static_cast<int64_t*>(keys_);
+    if (indices->dtype.bits == 32) {
+      MakeKeys(static_cast<const int32_t*>(indices->data), keys, stream);
+    } else {
+      MakeKeys(static_cast<const int64_t*>(indices->data), keys, stream);
+    }
+    if (dy->dtype.bits == 32) {
+      index_add_cuda<float>(static_cast<const float*>(dy->data), keys, outer_, n_, rows_, inner_,
+                            sorted_, workspace_, static_cast<float*>(dx->data), stream);
+    } else {
+      index_add_cuda<__half>(static_cast<const __half*>(dy->data), keys, outer_, n_, rows_,
+                             inner_, sorted_, workspace_, static_cast<__half*>(dx->data), stream);
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(op_name_));
+  }
+
+  static OpEnv* make_take_dx(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::TakeDxArgs>();
+    auto env = new IndexGradImpl(kTake, "raf.op.take_dx");
+    const DLTensor* x = args->x;
+    const DLTensor* indices = args->indices;
+    env->outer_ = 1;
+    env->rows_ = GetNumel(*x);
+    env->inner_ = 1;
+    if (args->axis.defined()) {
+      int axis = args->axis.as<IntValueObj>()->value;
+      axis = axis < 0 ? axis + x->ndim : axis;
+      env->outer_ = GetNumel(x->shape, x->shape + axis);
+      env->rows_ = x->shape[axis];
+      env->inner_ = GetNumel(x->shape + axis + 1, x->shape + x->ndim);
+    }
+    env->n_ = GetNumel(*indices);
+    env->mode_ = args->mode == "wrap" ? 1 : 0;
+    env->Init(cv, args->dy, indices);
+    return env;
+  }
+
+  static OpEnv* make_gather_dx(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::GatherDxArgs>();
+    auto env = new IndexGradImpl(kGather, "raf.op.gather_dx");
+    const DLTensor* data = args->data;
+    const DLTensor* indices = args->indices;
+    env->outer_ = 1;
+    env->rows_ = GetNumel(*data);
+    env->inner_ = 1;
+    env->n_ = GetNumel(*indices);
+    env->axis_ = args->axis < 0 ? args->axis + data->ndim : args->axis;
+    if (data->ndim > IndexShape::kMaxDims || indices->ndim != data->ndim) {
+      env->error_msgs.push_back("[CUDA] gather_dx supports the same rank of up to 8 dims");
+      return env;
+    }
+    env->index_shape_ = ToIndexShape(indices->shape, indices->ndim);
+    env->data_shape_ = ToIndexShape(data->shape, data->ndim);
+    env->Init(cv, args->dy, indices);
+    return env;
+  }
+
+  static OpEnv* make_gather_nd_dx(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::GatherNdDxArgs>();
+    auto env = new IndexGradImpl(kGatherNd, "raf.op.gather_nd_dx");
+    const DLTensor* data = args->data;
+    const DLTensor* indices = args->indices;
+    int m = indices->ndim > 0 ? indices->shape[0] : 0;
+    if (m == 0 || m > IndexShape::kMaxDims || m > data->ndim) {
+      env->error_msgs.push_back("[CUDA] gather_nd_dx indexes 1 to 8 leading dims");
+      return env;
+    }
+    env->outer_ = 1;
+    env->rows_ = GetNumel(data->shape, data->shape + m);
+    env->inner_ = GetNumel(data->shape + m, data->shape + data->ndim);
+    env->n_ = GetNumel(*indices) / m;
+    env->index_shape_ = ToIndexShape(data->shape, m);
+    env->Init(cv, args->dy, indices);
+    return env;
+  }
+
+ private:
+  IndexGradImpl(Kind kind, std::string op_name) : kind_(kind), op_name_(std::move(op_name)) {
+  }
+
+  static int64_t GetNumel(const int64_t* begin, const int64_t* end) {
+    int64_t numel = 1;
+    for (auto it = begin; it != end; ++it) {
+      numel *= *it;
+    }
+    return numel;
+  }
+
+  static int64_t GetNumel(const DLTensor& tensor) {
+    return common::shape_utils::GetNumel(tensor);
+  }
+
+  static IndexShape ToIndexShape(const int64_t* shape, int ndim) {
+    IndexShape ret;
+    ret.ndim = ndim;
+    std::copy(shape, shape + ndim, ret.dims);
+    return ret;
+  }
+
+  void Init(const CallValues& cv, const DLTensor* dy, const DLTensor* indices) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto op = ir::Op::Get(op_name_);
+    this->arg_indices = {fschema_index[op]("dy"), fschema_index[op]("indices")};
+    bool is_float = dy->dtype.code == kDLFloat && (dy->dtype.bits == 32 || dy->dtype.bits == 16);
+    bool is_index =
+        indices->dtype.code == kDLInt && (indices->dtype.bits == 32 || indices->dtype.bits == 64);
+    if (!is_float || !is_index) {
+      this->error_msgs.push_back("[CUDA] The gradients are float32/16 and the indices int32/64");
+      return;
+    }
+    if (GetNumel(*dy) != outer_ * n_ * inner_) {
+      this->error_msgs.push_back("[CUDA] The gradient does not match the indices");
+      return;
+    }
+    // The half gradients are always accumulated in float by sorting.
+    bool half = dy->dtype.bits == 16;
+    IndexGradStrategy strategy = GetIndexGradStrategy();
+    if (strategy == IndexGradStrategy::kAuto) {
+      sorted_ = half || n_ >= kSortCollisionRatio * std::max(rows_, int64_t(1));
+    } else {
+      sorted_ = half || strategy == IndexGradStrategy::kDeterministic;
+    }
+    if (sorted_ && n_ > std::numeric_limits<int>::max()) {
+      if (half) {
+        this->error_msgs.push_back("[CUDA] Too many indices to sort");
+        return;
+      }
+      sorted_ = false;
+    }
+    RequestWorkspace(&keys_, cv->device, std::max(n_, int64_t(1)) * sizeof(int64_t));
+    size_t workspace_size = index_add_workspace_cuda(n_, sorted_);
+    if (workspace_size > 0) {
+      RequestWorkspace(&workspace_, cv->device, workspace_size);
+    }
+  }
+
+  template <typename I>
+  void MakeKeys(const I* indices, int64_t* keys, void* stream) {
+    if (kind_ == kTake) {
+      take_keys_cuda<I>(indices, n_, rows_, mode_, keys, stream);
+    } else if (kind_ == kGather) {
+      gather_keys_cuda<I>(indices, n_, index_shape_, data_shape_, axis_, keys, stream);
+    } else {
+      gather_nd_keys_cuda<I>(indices, n_, index_shape_, keys, stream);
+    }
+  }
+
+  /*! \brief The kind and the name of the op. */
+  Kind kind_;
+  std::string op_name_;
+  /*! \brief The sizes of dx of (outer, rows, inner) and the number of the indices. */
+  int64_t outer_ = 1, rows_ = 1, inner_ = 1, n_ = 0;
+  /*! \brief The mode of take, i.e., 0: clip, 1: wrap. */
+  int mode_ = 0;
+  /*! \brief The axis of gather. */
+  int axis_ = 0;
+  /*! \brief The shape of the indices of gather, or the indexed dims of gather_nd. */
+  IndexShape index_shape_;
+  /*! \brief The shape of the data of gather. */
+  IndexShape data_shape_;
+  /*! \brief Whether to sort the keys instead of using atomics. */
+  bool sorted_ = false;
+  /*! \brief The rows of the indices, and the workspace of the sort. */
+  void* keys_ = nullptr;
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, take_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.take_dx", IndexGradImpl::make_take_dx);
+RAF_REGISTER_DIALECT_OP(cuda, gather_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.gather_dx", IndexGradImpl::make_gather_dx);
+RAF_REGISTER_DIALECT_OP(cuda, gather_nd_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.gather_nd_dx", IndexGradImpl::make_gather_nd_dx);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,87 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/attention.cuh
+ * \brief Headers of the memory-efficient CUDA attention and attention_dx kernels
+ */
+#pragma once
+#include <cuda_fp16.h>
+#include <stdint.h>
+#include "./Half.h"
+#include "../../../../common/cuda_utils.h"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+/*! \brief The largest head dim supported by the attention kernels. */
+constexpr int kAttentionMaxHeadDim = 256;
+
+/*!
+ * \brief The shapes and options of an attention, where q, k and v are contiguous tensors of
+ * (batch_heads, seq_q or seq_k, head_dim).
+ */
+struct AttentionParams {
+  int batch_heads;
+  /*! \brief The number of heads sharing a row of the mask, which is (batch, seq_k). */
+  int heads;
+  int seq_q;
+  int seq_k;
+  int head_dim;
+  float scale;
+  bool causal;
+  float dropout_p;
+  uint64_t seed;
+};
+
+/*!
+ * \brief Compute the attention without materializing the attention matrix, where the keys and
+ * values are streamed through the shared memory tile by tile with the online softmax.
+ * \param mask The additive mask of (batch, seq_k), or nullptr.
+ * \param lse The log-sum-exp of each row of the scaled scores, of (batch_heads, seq_q).
+ */
+template <typename T>
+void HostAttentionForward(const T* q, const T* k, const T* v, const T* mask, T* out, float* lse,
+                          const AttentionParams& params, void* stream);
+
+/*!
+ * \brief Compute the gradients of the attention, where the attention probabilities are
+ * recomputed from lse tile by tile.
+ * \param delta The workspace of batch_heads * seq_q floats.
+ */
+template <typename T>
+void HostAttentionBackward(const T* q, const T* k, const T* v, const T* mask, const T* out,
+                           const T* dout, const float* lse, float* delta, T* dq, T* dk, T* dv,
+                           const AttentionParams& params, void* stream);
+
+/*!
+ * \brief The shapes and options of an attention over the paged caches of (num_blocks, heads,
+ * block_size, head_dim), where q is a contiguous tensor of (batch, heads, seq_q, head_dim).
+ */
+struct PagedAttentionParams {
+  int batch;
+  int heads;
+  int seq_q;
+  int head_dim;
+  int block_size;
+  /*! \brief The number of the columns of the block table of (batch, max_blocks). */
+  int max_blocks;
+  float scale;
+};
+
+/*!
+ * \brief Compute the attention of the new tokens over the paged caches, where the tiles of the
+ * keys and values are gathered through the block table, and only the tokens up to each query are
+ * read. The query i of the sequence b is at the token lengths[b] - seq_q + i.
+ */
+template <typename T>
+void HostPagedAttentionForward(const T* q, const T* k_cache, const T* v_cache,
+                               const int64_t* block_table, const int64_t* lengths, T* out,
+                               const PagedAttentionParams& params, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
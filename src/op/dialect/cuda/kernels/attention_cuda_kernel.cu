@@ -0,0 +1,529 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/attention_cuda_kernel.cu
+ * \brief Memory-efficient attention forward and backward cuda kernels. Each warp handles a row
+ * of queries (or keys in the backward of dk and dv), and the warps of a thread block share the
+ * tiles of keys and values (or queries) in the shared memory. The attention matrix is never
+ * materialized: the forward uses the online softmax, and the backward recomputes the attention
+ * probabilities from the log-sum-exp of the forward. The paged forward gathers the tiles of
+ * keys and values through a block table instead of reading contiguous tensors.
+ */
+#include <math.h>
+#include "./attention.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+using namespace c10;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+/*! \brief The number of rows handled by a thread block, i.e., one row per warp. */
+constexpr int kRowsPerBlock = 4;
+/*! \brief The number of rows of a tile in the shared memory. */
+constexpr int kTileRows = 16;
+
+__device__ inline float WarpSum(float val) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    val += __shfl_xor_sync(0xffffffff, val, offset);
+  }
+  return val;
+}
+
+/*!
+ * \brief The dropout scale of an element of the attention matrix, i.e., 0 if dropped, or
+ * 1 / (1 - p) otherwise. The random number is a hash (splitmix64) of the seed and the position,
+ * so the backward regenerates the same dropout without storing a mask.
+ */
+__device__ inline float DropoutScale(const AttentionParams& p, int bh, int i, int j) {
+  if (p.dropout_p == 0.f) {
+    return 1.f;
+  }
+  uint64_t z = p.seed + ((static_cast<uint64_t>(bh) * p.seq_q + i) * p.seq_k + j + 1) *
+                            0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z ^= z >> 31;
+  float uniform = (z >> 40) * (1.f / 16777216.f);
+  return uniform < p.dropout_p ? 0.f : 1.f / (1.f - p.dropout_p);
+}
+
+/*! \brief Load a row into the registers of a warp, where lane l holds the columns l + 32 * e. */
+template <typename T, int kPerLane>
+__device__ inline void LoadRow(const T* row, int d, int lane, float scale, float* reg) {
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    int c = lane + e * kWarpSize;
+    reg[e] = c < d ? static_cast<float>(row[c]) * scale : 0.f;
+  }
+}
+
+template <typename T, int kPerLane>
+__device__ inline void StoreRow(const float* reg, int d, int lane, float scale, T* row) {
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    int c = lane + e * kWarpSize;
+    if (c < d) {
+      row[c] = static_cast<T>(reg[e] * scale);
+    }
+  }
+}
+
+/*! \brief The dot product of a row in the registers of a warp and a row in the shared memory. */
+template <int kPerLane>
+__device__ inline float RowDot(const float* reg, const float* row, int d, int lane) {
+  float sum = 0.f;
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    int c = lane + e * kWarpSize;
+    if (c < d) {
+      sum += reg[e] * row[c];
+    }
+  }
+  return WarpSum(sum);
+}
+
+/*! \brief Accumulate a row in the shared memory times a factor to a row in the registers. */
+template <int kPerLane>
+__device__ inline void RowAxpy(float alpha, const float* row, int d, int lane, float* reg) {
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    int c = lane + e * kWarpSize;
+    if (c < d) {
+      reg[e] += alpha * row[c];
+    }
+  }
+}
+
+/*! \brief Load a tile of rows to the shared memory cooperatively, padding it with zeros. */
+template <typename T>
+__device__ inline void LoadTile(const T* src, int rows, int d, float* dst) {
+  for (int idx = threadIdx.x; idx < kTileRows * d; idx += blockDim.x) {
+    dst[idx] = idx / d < rows ? static_cast<float>(src[idx]) : 0.f;
+  }
+}
+
+template <typename T, int kPerLane>
+__global__ void AttentionForwardKernel(const T* q, const T* k, const T* v, const T* mask, T* out,
+                                       float* lse, AttentionParams p) {
+  extern __shared__ float smem[];
+  const int d = p.head_dim;
+  float* k_tile = smem;
+  float* v_tile = smem + kTileRows * d;
+  const int bh = blockIdx.y;
+  const int warp = threadIdx.x / kWarpSize, lane = threadIdx.x % kWarpSize;
+  const int i = blockIdx.x * kRowsPerBlock + warp;
+  const bool valid = i < p.seq_q;
+  const T* mask_row = mask ? mask + static_cast<int64_t>(bh / p.heads) * p.seq_k : nullptr;
+  const int64_t q_offset = (static_cast<int64_t>(bh) * p.seq_q + (valid ? i : 0)) * d;
+
+  float q_reg[kPerLane], acc[kPerLane];
+  LoadRow<T, kPerLane>(q + q_offset, d, lane, p.scale, q_reg);
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    acc[e] = 0.f;
+  }
+  float m = -INFINITY, l = 0.f;
+  // With the causal mask, query i only attends to the keys j <= i.
+  const int end = p.causal ? min(p.seq_k, (blockIdx.x + 1) * kRowsPerBlock) : p.seq_k;
+  for (int start = 0; start < end; start += kTileRows) {
+    const int rows = min(kTileRows, p.seq_k - start);
+    const int64_t kv_offset = (static_cast<int64_t>(bh) * p.seq_k + start) * d;
+    __syncthreads();
+    LoadTile(k + kv_offset, rows, d, k_tile);
+    LoadTile(v + kv_offset, rows, d, v_tile);
+    __syncthreads();
+    if (!valid) {
+      continue;
+    }
+    for (int r = 0; r < rows; ++r) {
+      const int j = start + r;
+      if (p.causal && j > i) {
+        break;
+      }
+      float s = RowDot<kPerLane>(q_reg, k_tile + r * d, d, lane);
+      if (mask_row) {
+        s += static_cast<float>(mask_row[j]);
+      }
+      if (s == -INFINITY) {
+        continue;
+      }
+      // The online softmax rescales the accumulation when the running max changes.
+      const float m_new = fmaxf(m, s);
+      const float correction = expf(m - m_new);
+      const float e_s = expf(s - m_new);
+      l = l * correction + e_s;
+#pragma unroll
+      for (int e = 0; e < kPerLane; ++e) {
+        acc[e] *= correction;
+      }
+      RowAxpy<kPerLane>(e_s * DropoutScale(p, bh, i, j), v_tile + r * d, d, lane, acc);
+      m = m_new;
+    }
+  }
+  if (!valid) {
+    return;
+  }
+  StoreRow<T, kPerLane>(acc, d, lane, l > 0.f ? 1.f / l : 0.f, out + q_offset);
+  if (lane == 0) {
+    // A fully masked row has no probability, which is kept by an infinite log-sum-exp.
+    lse[static_cast<int64_t>(bh) * p.seq_q + i] = l > 0.f ? m + logf(l) : INFINITY;
+  }
+}
+
+/*! \brief Compute delta_i = sum_j P_ij * dP_ij, which equals to the dot of dout_i and out_i. */
+template <typename T, int kPerLane>
+__global__ void AttentionDeltaKernel(const T* out, const T* dout, float* delta, int64_t rows,
+                                     int d) {
+  const int lane = threadIdx.x % kWarpSize;
+  const int64_t row = static_cast<int64_t>(blockIdx.x) * kRowsPerBlock + threadIdx.x / kWarpSize;
+  if (row >= rows) {
+    return;
+  }
+  float out_reg[kPerLane], dout_reg[kPerLane];
+  LoadRow<T, kPerLane>(out + row * d, d, lane, 1.f, out_reg);
+  LoadRow<T, kPerLane>(dout + row * d, d, lane, 1.f, dout_reg);
+  float sum = 0.f;
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    sum += out_reg[e] * dout_reg[e];
+  }
+  sum = WarpSum(sum);
+  if (lane == 0) {
+    delta[row] = sum;
+  }
+}
+
+template <typename T, int kPerLane>
+__global__ void AttentionBackwardDqKernel(const T* q, const T* k, const T* v, const T* mask,
+                                          const T* dout, const float* lse, const float* delta,
+                                          T* dq, AttentionParams p) {
+  extern __shared__ float smem[];
+  const int d = p.head_dim;
+  float* k_tile = smem;
+  float* v_tile = smem + kTileRows * d;
+  const int bh = blockIdx.y;
+  const int warp = threadIdx.x / kWarpSize, lane = threadIdx.x % kWarpSize;
+  const int i = blockIdx.x * kRowsPerBlock + warp;
+  const bool valid = i < p.seq_q;
+  const T* mask_row = mask ? mask + static_cast<int64_t>(bh / p.heads) * p.seq_k : nullptr;
+  const int64_t row = static_cast<int64_t>(bh) * p.seq_q + (valid ? i : 0);
+
+  float q_reg[kPerLane], dout_reg[kPerLane], dq_acc[kPerLane];
+  LoadRow<T, kPerLane>(q + row * d, d, lane, p.scale, q_reg);
+  LoadRow<T, kPerLane>(dout + row * d, d, lane, 1.f, dout_reg);
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    dq_acc[e] = 0.f;
+  }
+  const float lse_i = lse[row], delta_i = delta[row];
+  const int end = p.causal ? min(p.seq_k, (blockIdx.x + 1) * kRowsPerBlock) : p.seq_k;
+  for (int start = 0; start < end; start += kTileRows) {
+    const int rows = min(kTileRows, p.seq_k - start);
+    const int64_t kv_offset = (static_cast<int64_t>(bh) * p.seq_k + start) * d;
+    __syncthreads();
+    LoadTile(k + kv_offset, rows, d, k_tile);
+    LoadTile(v + kv_offset, rows, d, v_tile);
+    __syncthreads();
+    if (!valid) {
+      continue;
+    }
+    for (int r = 0; r < rows; ++r) {
+      const int j = start + r;
+      if (p.causal && j > i) {
+        break;
+      }
+      float s = RowDot<kPerLane>(q_reg, k_tile + r * d, d, lane);
+      if (mask_row) {
+        s += static_cast<float>(mask_row[j]);
+      }
+      const float prob = expf(s - lse_i);
+      const float dp = RowDot<kPerLane>(dout_reg, v_tile + r * d, d, lane) *
+                       DropoutScale(p, bh, i, j);
+      RowAxpy<kPerLane>(prob * (dp - delta_i), k_tile + r * d, d, lane, dq_acc);
+    }
+  }
+  if (valid) {
+    StoreRow<T, kPerLane>(dq_acc, d, lane, p.scale, dq + row * d);
+  }
+}
+
+template <typename T, int kPerLane>
+__global__ void AttentionBackwardDkvKernel(const T* q, const T* k, const T* v, const T* mask,
+                                           const T* dout, const float* lse, const float* delta,
+                                           T* dk, T* dv, AttentionParams p) {
+  extern __shared__ float smem[];
+  const int d = p.head_dim;
+  float* q_tile = smem;
+  float* dout_tile = smem + kTileRows * d;
+  float* lse_tile = smem + 2 * kTileRows * d;
+  float* delta_tile = lse_tile + kTileRows;
+  const int bh = blockIdx.y;
+  const int warp = threadIdx.x / kWarpSize, lane = threadIdx.x % kWarpSize;
+  const int j = blockIdx.x * kRowsPerBlock + warp;
+  const bool valid = j < p.seq_k;
+  const int64_t row = static_cast<int64_t>(bh) * p.seq_k + (valid ? j : 0);
+  const float mask_j =
+      mask && valid ? static_cast<float>(mask[static_cast<int64_t>(bh / p.heads) * p.seq_k + j])
+                    : 0.f;
+
+  float k_reg[kPerLane], v_reg[kPerLane], dk_acc[kPerLane], dv_acc[kPerLane];
+  LoadRow<T, kPerLane>(k + row * d, d, lane, p.scale, k_reg);
+  LoadRow<T, kPerLane>(v + row * d, d, lane, 1.f, v_reg);
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    dk_acc[e] = dv_acc[e] = 0.f;
+  }
+  // With the causal mask, key j is only attended by the queries i >= j.
+  const int begin = p.causal ? blockIdx.x * kRowsPerBlock / kTileRows * kTileRows : 0;
+  for (int start = begin; start < p.seq_q; start += kTileRows) {
+    const int rows = min(kTileRows, p.seq_q - start);
+    const int64_t q_row = static_cast<int64_t>(bh) * p.seq_q + start;
+    __syncthreads();
+    LoadTile(q + q_row * d, rows, d, q_tile);
+    LoadTile(dout + q_row * d, rows, d, dout_tile);
+    if (threadIdx.x < kTileRows) {
+      lse_tile[threadIdx.x] = threadIdx.x < rows ? lse[q_row + threadIdx.x] : INFINITY;
+      delta_tile[threadIdx.x] = threadIdx.x < rows ? delta[q_row + threadIdx.x] : 0.f;
+    }
+    __syncthreads();
+    if (!valid) {
+      continue;
+    }
+    for (int r = 0; r < rows; ++r) {
+      const int i = start + r;
+      if (p.causal && i < j) {
+        continue;
+      }
+      const float s = RowDot<kPerLane>(k_reg, q_tile + r * d, d, lane) + mask_j;
+      const float prob = expf(s - lse_tile[r]);
+      const float z = DropoutScale(p, bh, i, j);
+      RowAxpy<kPerLane>(prob * z, dout_tile + r * d, d, lane, dv_acc);
+      const float dp = RowDot<kPerLane>(v_reg, dout_tile + r * d, d, lane) * z;
+      RowAxpy<kPerLane>(prob * (dp - delta_tile[r]), q_tile + r * d, d, lane, dk_acc);
+    }
+  }
+  if (valid) {
+    StoreRow<T, kPerLane>(dk_acc, d, lane, p.scale, dk + row * d);
+    StoreRow<T, kPerLane>(dv_acc, d, lane, 1.f, dv + row * d);
+  }
+}
+
+template <typename T, int kPerLane>
+void LaunchAttentionForward(const T* q, const T* k, const T* v, const T* mask, T* out, float* lse,
+                            const AttentionParams& params, cudaStream_t stream) {
+  const dim3 blocks((params.seq_q + kRowsPerBlock - 1) / kRowsPerBlock, params.batch_heads);
+  const dim3 threads(kWarpSize * kRowsPerBlock);
+  const size_t nshared = 2 * kTileRows * params.head_dim * sizeof(float);
+  AttentionForwardKernel<T, kPerLane>
+      <<<blocks, threads, nshared, stream>>>(q, k, v, mask, out, lse, params);
+}
+
+template <typename T, int kPerLane>
+void LaunchAttentionBackward(const T* q, const T* k, const T* v, const T* mask, const T* out,
+                             const T* dout, const float* lse, float* delta, T* dq, T* dk, T* dv,
+                             const AttentionParams& params, cudaStream_t stream) {
+  const dim3 threads(kWarpSize * kRowsPerBlock);
+  const int64_t rows = static_cast<int64_t>(params.batch_heads) * params.seq_q;
+  AttentionDeltaKernel<T, kPerLane><<<(rows + kRowsPerBlock - 1) / kRowsPerBlock, threads, 0,
+                                      stream>>>(out, dout, delta, rows, params.head_dim);
+
+  const dim3 dq_blocks((params.seq_q + kRowsPerBlock - 1) / kRowsPerBlock, params.batch_heads);
+  const size_t dq_nshared = 2 * kTileRows * params.head_dim * sizeof(float);
+  AttentionBackwardDqKernel<T, kPerLane>
+      <<<dq_blocks, threads, dq_nshared, stream>>>(q, k, v, mask, dout, lse, delta, dq, params);
+
+  const dim3 dkv_blocks((params.seq_k + kRowsPerBlock - 1) / kRowsPerBlock, params.batch_heads);
+  const size_t dkv_nshared = 2 * kTileRows * (params.head_dim + 1) * sizeof(float);
+  AttentionBackwardDkvKernel<T, kPerLane><<<dkv_blocks, threads, dkv_nshared, stream>>>(
+      q, k, v, mask, dout, lse, delta, dk, dv, params);
+}
+
+/*! \brief Gather a tile of the tokens of a head from the paged cache to the shared memory. */
+template <typename T>
+__device__ inline void LoadPagedTile(const T* cache, const int64_t* table_row, int64_t start,
+                                     int rows, int h, const PagedAttentionParams& p, float* dst) {
+  const int d = p.head_dim;
+  for (int idx = threadIdx.x; idx < kTileRows * d; idx += blockDim.x) {
+    const int r = idx / d;
+    if (r < rows) {
+      const int64_t t = start + r;
+      const int64_t block = table_row[t / p.block_size];
+      const int64_t src = ((block * p.heads + h) * p.block_size + t % p.block_size) * d + idx % d;
+      dst[idx] = static_cast<float>(cache[src]);
+    } else {
+      dst[idx] = 0.f;
+    }
+  }
+}
+
+template <typename T, int kPerLane>
+__global__ void PagedAttentionForwardKernel(const T* q, const T* k_cache, const T* v_cache,
+                                            const int64_t* block_table, const int64_t* lengths,
+                                            T* out, PagedAttentionParams p) {
+  extern __shared__ float smem[];
+  const int d = p.head_dim;
+  float* k_tile = smem;
+  float* v_tile = smem + kTileRows * d;
+  const int bh = blockIdx.y;
+  const int b = bh / p.heads, h = bh % p.heads;
+  const int warp = threadIdx.x / kWarpSize, lane = threadIdx.x % kWarpSize;
+  const int i = blockIdx.x * kRowsPerBlock + warp;
+  const bool valid = i < p.seq_q;
+  const int64_t* table_row = block_table + static_cast<int64_t>(b) * p.max_blocks;
+  // The tokens beyond the blocks of the table are never written, so they are not read either.
+  const int64_t num_tokens = min(lengths[b], static_cast<int64_t>(p.max_blocks) * p.block_size);
+  const int64_t first = lengths[b] - p.seq_q;
+  const int64_t last = first + i;
+  const int64_t q_offset = (static_cast<int64_t>(bh) * p.seq_q + (valid ? i : 0)) * d;
+
+  float q_reg[kPerLane], acc[kPerLane];
+  LoadRow<T, kPerLane>(q + q_offset, d, lane, p.scale, q_reg);
+#pragma unroll
+  for (int e = 0; e < kPerLane; ++e) {
+    acc[e] = 0.f;
+  }
+  float m = -INFINITY, l = 0.f;
+  // The warps of the block attend to the tokens up to the last query of the block.
+  const int64_t end = min(num_tokens, first + min((blockIdx.x + 1) * kRowsPerBlock, p.seq_q));
+  for (int64_t start = 0; start < end; start += kTileRows) {
+    const int rows = static_cast<int>(min(static_cast<int64_t>(kTileRows), end - start));
+    __syncthreads();
+    LoadPagedTile(k_cache, table_row, start, rows, h, p, k_tile);
+    LoadPagedTile(v_cache, table_row, start, rows, h, p, v_tile);
+    __syncthreads();
+    if (!valid) {
+      continue;
+    }
+    for (int r = 0; r < rows; ++r) {
+      if (start + r > last) {
+        break;
+      }
+      const float s = RowDot<kPerLane>(q_reg, k_tile + r * d, d, lane);
+      const float m_new = fmaxf(m, s);
+      const float correction = expf(m - m_new);
+      const float e_s = expf(s - m_new);
+      l = l * correction + e_s;
+#pragma unroll
+      for (int e = 0; e < kPerLane; ++e) {
+        acc[e] *= correction;
+      }
+      RowAxpy<kPerLane>(e_s, v_tile + r * d, d, lane, acc);
+      m = m_new;
+    }
+  }
+  if (valid) {
+    // A query without any visible token, e.g., of an idle sequence of the batch, outputs zeros.
+    StoreRow<T, kPerLane>(acc, d, lane, l > 0.f ? 1.f / l : 0.f, out + q_offset);
+  }
+}
+
+template <typename T, int kPerLane>
+void LaunchPagedAttentionForward(const T* q, const T* k_cache, const T* v_cache,
+                                 const int64_t* block_table, const int64_t* lengths, T* out,
+                                 const PagedAttentionParams& params, cudaStream_t stream) {
+  const dim3 blocks((params.seq_q + kRowsPerBlock - 1) / kRowsPerBlock,
+                    params.batch * params.heads);
+  const dim3 threads(kWarpSize * kRowsPerBlock);
+  const size_t nshared = 2 * kTileRows * params.head_dim * sizeof(float);
+  PagedAttentionForwardKernel<T, kPerLane><<<blocks, threads, nshared, stream>>>(
+      q, k_cache, v_cache, block_table, lengths, out, params);
+}
+
+}  // namespace
+
+template <typename T>
+void HostAttentionForward(const T* q, const T* k, const T* v, const T* mask, T* out, float* lse,
+                          const AttentionParams& params, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  const int per_lane = (params.head_dim + kWarpSize - 1) / kWarpSize;
+  if (per_lane <= 1) {
+    LaunchAttentionForward<T, 1>(q, k, v, mask, out, lse, params, cu_stream);
+  } else if (per_lane <= 2) {
+    LaunchAttentionForward<T, 2>(q, k, v, mask, out, lse, params, cu_stream);
+  } else if (per_lane <= 4) {
+    LaunchAttentionForward<T, 4>(q, k, v, mask, out, lse, params, cu_stream);
+  } else {
+    LaunchAttentionForward<T, 8>(q, k, v, mask, out, lse, params, cu_stream);
+  }
+}
+
+template <typename T>
+void HostAttentionBackward(const T* q, const T* k, const T* v, const T* mask, const T* out,
+                           const T* dout, const float* lse, float* delta, T* dq, T* dk, T* dv,
+                           const AttentionParams& params, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  const int per_lane = (params.head_dim + kWarpSize - 1) / kWarpSize;
+  if (per_lane <= 1) {
+    LaunchAttentionBackward<T, 1>(q, k, v, mask, out, dout, lse, delta, dq, dk, dv, params,
+                                  cu_stream);
+  } else if (per_lane <= 2) {
+    LaunchAttentionBackward<T, 2>(q, k, v, mask, out, dout, lse, delta, dq, dk, dv, params,
+                                  cu_stream);
+  } else if (per_lane <= 4) {
+    LaunchAttentionBackward<T, 4>(q, k, v, mask, out, dout, lse, delta, dq, dk, dv, params,
+                                  cu_stream);
+  } else {
+    LaunchAttentionBackward<T, 8>(q, k, v, mask, out, dout, lse, delta, dq, dk, dv, params,
+                                  cu_stream);
+  }
+}
+
+template <typename T>
+void HostPagedAttentionForward(const T* q, const T* k_cache, const T* v_cache,
+                               const int64_t* block_table, const int64_t* lengths, T* out,
+                               const PagedAttentionParams& params, void* stream) {
+  cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+  const int per_lane = (params.head_dim + kWarpSize - 1) / kWarpSize;
+  if (per_lane <= 1) {
+    LaunchPagedAttentionForward<T, 1>(q, k_cache, v_cache, block_table, lengths, out, params,
+                                      cu_stream);
+  } else if (per_lane <= 2) {
+    LaunchPagedAttentionForward<T, 2>(q, k_cache, v_cache, block_table, lengths, out, params,
+                                      cu_stream);
+  } else if (per_lane <= 4) {
+    LaunchPagedAttentionForward<T, 4>(q, k_cache, v_cache, block_table, lengths, out, params,
+                                      cu_stream);
+  } else {
+    LaunchPagedAttentionForward<T, 8>(q, k_cache, v_cache, block_table, lengths, out, params,
+                                      cu_stream);
+  }
+}
+
+template void HostAttentionForward<float>(const float* q, const float* k, const float* v,
+                                          const float* mask, float* out, float* lse,
+                                          const AttentionParams& params, void* stream);
+
+template void HostAttentionForward<Half>(const Half* q, const Half* k, const Half* v,
+                                         const Half* mask, Half* out, float* lse,
+                                         const AttentionParams& params, void* stream);
+
+template void HostAttentionBackward<float>(const float* q, const float* k, const float* v,
+                                           const float* mask, const float* out,
+                                           const float* dout, const float* lse, float* delta,
+                                           float* dq, float* dk, float* dv,
+                                           const AttentionParams& params, void* stream);
+
+template void HostAttentionBackward<Half>(const Half* q, const Half* k, const Half* v,
+                                          const Half* mask, const Half* out, const Half* dout,
+                                          const float* lse, float* delta, Half* dq, Half* dk,
+                                          Half* dv, const AttentionParams& params, void* stream);
+
+template void HostPagedAttentionForward<float>(const float* q, const float* k_cache,
+                                               const float* v_cache, const int64_t* block_table,
+                                               const int64_t* lengths, float* out,
+                                               const PagedAttentionParams& params, void* stream);
+
+template void HostPagedAttentionForward<Half>(const Half* q, const Half* k_cache,
+                                              const Half* v_cache, const int64_t* block_table,
+                                              const int64_t* lengths, Half* out,
+                                              const PagedAttentionParams& params, void* stream);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
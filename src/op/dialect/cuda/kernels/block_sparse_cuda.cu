@@ -0,0 +1,348 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/block_sparse_cuda.cu
+ * \brief The block-sparse matmul and softmax kernels, whose work and memory scale with the
+ * non-zero blocks of the layout.
+ */
+#include <math.h>
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+/*! \brief The tile of the matmul kernels, which run 16 x 16 threads per block of the output. */
+constexpr int kTile = 16;
+/*! \brief The warps of the softmax kernels per thread block, each of which takes a row. */
+constexpr int kSoftmaxWarps = 4;
+
+__device__ __forceinline__ float WarpReduceMax(float x) {
+  for (int offset = 16; offset > 0; offset >>= 1) {
+    x = fmaxf(x, __shfl_xor_sync(0xffffffff, x, offset));
+  }
+  return x;
+}
+
+__device__ __forceinline__ float WarpReduceSum(float x) {
+  for (int offset = 16; offset > 0; offset >>= 1) {
+    x += __shfl_xor_sync(0xffffffff, x, offset);
+  }
+  return x;
+}
+
+/*! \brief Each thread block computes a non-zero block of the output of one batch. */
+template <typename T, int BLOCK>
+__global__ void BlockSparseSddKernel(const T* x1, const T* x2, T* out, BlockSparseTable table,
+                                     int64_t k) {
+  constexpr int kPer = BLOCK / kTile;
+  __shared__ float a[BLOCK][kTile + 1];
+  __shared__ float b[BLOCK][kTile + 1];
+  int tx = threadIdx.x;
+  int ty = threadIdx.y;
+  int tid = ty * kTile + tx;
+  int64_t blk = blockIdx.x;
+  int64_t batch = blockIdx.y;
+  const T* x1_rows = x1 + (batch * table.rows * BLOCK + table.block_rows[blk] * BLOCK) * k;
+  const T* x2_rows = x2 + (batch * table.cols * BLOCK + table.block_cols[blk] * BLOCK) * k;
+  float acc[kPer][kPer] = {};
+  for (int64_t k0 = 0; k0 < k; k0 += kTile) {
+    for (int i = tid; i < BLOCK * kTile; i += kTile * kTile) {
+      int r = i / kTile;
+      int c = i % kTile;
+      bool valid = k0 + c < k;
+      a[r][c] = valid ? LoadFloat(x1_rows[r * k + k0 + c]) : 0.0f;
+      b[r][c] = valid ? LoadFloat(x2_rows[r * k + k0 + c]) : 0.0f;
+    }
+    __syncthreads();
+#pragma unroll
+    for (int c = 0; c < kTile; ++c) {
+#pragma unroll
+      for (int i = 0; i < kPer; ++i) {
+        float av = a[ty + i * kTile][c];
+#pragma unroll
+        for (int j = 0; j < kPer; ++j) {
+          acc[i][j] += av * b[tx + j * kTile][c];
+        }
+      }
+    }
+    __syncthreads();
+  }
+  T* tile = out + (batch * table.nnz + blk) * BLOCK * BLOCK;
+#pragma unroll
+  for (int i = 0; i < kPer; ++i) {
+#pragma unroll
+    for (int j = 0; j < kPer; ++j) {
+      StoreFloat(acc[i][j], tile + (ty + i * kTile) * BLOCK + tx + j * kTile);
+    }
+  }
+}
+
+/*!
+ * \brief Each thread block computes block x kTile of the output of one batch, by accumulating the
+ * non-zero blocks of its block row of a, or of its block col if transposed.
+ */
+template <typename T, int BLOCK, bool kTranspose>
+__global__ void BlockSparseDsdKernel(const T* a, const T* x, T* out, BlockSparseTable table,
+                                     int64_t k) {
+  constexpr int kPer = BLOCK / kTile;
+  __shared__ float sa[BLOCK][kTile + 1];
+  __shared__ float sx[kTile][kTile + 1];
+  int tx = threadIdx.x;
+  int ty = threadIdx.y;
+  int tid = ty * kTile + tx;
+  int64_t ob = blockIdx.x;
+  int64_t col = blockIdx.y * kTile + tx;
+  int64_t batch = blockIdx.z;
+  int64_t x_rows = (kTranspose ? table.rows : table.cols) * BLOCK;
+  int64_t out_rows = (kTranspose ? table.cols : table.rows) * BLOCK;
+  const int* ptr = kTranspose ? table.col_ptr : table.row_ptr;
+  float acc[kPer] = {};
+  for (int p = ptr[ob]; p < ptr[ob + 1]; ++p) {
+    int id = kTranspose ? table.col_blocks[p] : p;
+    int64_t inner = kTranspose ? table.block_rows[id] : table.block_cols[id];
+    const T* tile = a + (batch * table.nnz + id) * BLOCK * BLOCK;
+    const T* x_rows_in = x + (batch * x_rows + inner * BLOCK) * k;
+    for (int c0 = 0; c0 < BLOCK; c0 += kTile) {
+      for (int i = tid; i < BLOCK * kTile; i += kTile * kTile) {
+        // Both read the consecutive entries of the tile.
+        if (kTranspose) {
+          int r = i % BLOCK;
+          int c = i / BLOCK;
+          sa[r][c] = LoadFloat(tile[(c0 + c) * BLOCK + r]);
+        } else {
+          int r = i / kTile;
+          int c = i % kTile;
+          sa[r][c] = LoadFloat(tile[r * BLOCK + c0 + c]);
+        }
+      }
+      sx[ty][tx] = col < k ? LoadFloat(x_rows_in[(c0 + ty) * k + col]) : 0.0f;
+      __syncthreads();
+#pragma unroll
+      for (int c = 0; c < kTile; ++c) {
+        float xv = sx[c][tx];
+#pragma unroll
+        for (int i = 0; i < kPer; ++i) {
+          acc[i] += sa[ty + i * kTile][c] * xv;
+        }
+      }
+      __syncthreads();
+    }
+  }
+  if (col < k) {
+    // The rows without non-zero blocks are zeros.
+#pragma unroll
+    for (int i = 0; i < kPer; ++i) {
+      StoreFloat(acc[i], out + (batch * out_rows + ob * BLOCK + ty + i * kTile) * k + col);
+    }
+  }
+}
+
+/*! \brief The entries of a row of the block-sparse matrix, which are its blocks row by row. */
+template <int BLOCK>
+struct BlockSparseRow {
+  __device__ BlockSparseRow(const BlockSparseTable& table, int64_t row, int64_t batch)
+      : row(row), r(row % BLOCK) {
+    int64_t rb = row / BLOCK;
+    begin = table.row_ptr[rb];
+    count = (table.row_ptr[rb + 1] - begin) * BLOCK;
+    base = batch * table.nnz + begin;
+  }
+
+  /*! \brief The offset of the entry e of the row. */
+  __device__ int64_t Offset(int e) const {
+    return ((base + e / BLOCK) * BLOCK + r) * BLOCK + e % BLOCK;
+  }
+
+  /*! \brief The col of the entry e of the row in the dense matrix. */
+  __device__ int64_t Col(const BlockSparseTable& table, int e) const {
+    return static_cast<int64_t>(table.block_cols[begin + e / BLOCK]) * BLOCK + e % BLOCK;
+  }
+
+  int64_t row;
+  int r;
+  int begin;
+  int count;
+  int64_t base;
+};
+
+template <typename T, int BLOCK>
+__global__ void BlockSparseSoftmaxKernel(const T* x, T* y, BlockSparseTable table, float scale,
+                                         bool causal) {
+  int lane = threadIdx.x % 32;
+  int64_t row = static_cast<int64_t>(blockIdx.x) * kSoftmaxWarps + threadIdx.x / 32;
+  if (row >= table.rows * BLOCK) {
+    return;
+  }
+  BlockSparseRow<BLOCK> entries(table, row, blockIdx.y);
+  float m = -INFINITY;
+  for (int e = lane; e < entries.count; e += 32) {
+    if (!causal || entries.Col(table, e) <= row) {
+      m = fmaxf(m, LoadFloat(x[entries.Offset(e)]) * scale);
+    }
+  }
+  m = WarpReduceMax(m);
+  float s = 0.0f;
+  for (int e = lane; e < entries.count; e += 32) {
+    if (!causal || entries.Col(table, e) <= row) {
+      s += expf(LoadFloat(x[entries.Offset(e)]) * scale - m);
+    }
+  }
+  s = WarpReduceSum(s);
+  for (int e = lane; e < entries.count; e += 32) {
+    bool masked = causal && entries.Col(table, e) > row;
+    float v = masked ? 0.0f : expf(LoadFloat(x[entries.Offset(e)]) * scale - m) / s;
+    StoreFloat(v, y + entries.Offset(e));
+  }
+}
+
+template <typename T, int BLOCK>
+__global__ void BlockSparseSoftmaxDxKernel(const T* y, const T* dy, T* dx, BlockSparseTable table,
+                                           float scale) {
+  int lane = threadIdx.x % 32;
+  int64_t row = static_cast<int64_t>(blockIdx.x) * kSoftmaxWarps + threadIdx.x / 32;
+  if (row >= table.rows * BLOCK) {
+    return;
+  }
+  BlockSparseRow<BLOCK> entries(table, row, blockIdx.y);
+  float dot = 0.0f;
+  for (int e = lane; e < entries.count; e += 32) {
+    int64_t i = entries.Offset(e);
+    dot += LoadFloat(y[i]) * LoadFloat(dy[i]);
+  }
+  dot = WarpReduceSum(dot);
+  for (int e = lane; e < entries.count; e += 32) {
+    int64_t i = entries.Offset(e);
+    StoreFloat(scale * LoadFloat(y[i]) * (LoadFloat(dy[i]) - dot), dx + i);
+  }
+}
+
+template <typename T, int BLOCK>
+void LaunchSdd(const void* x1, const void* x2, void* out, const BlockSparseTable& table,
+               int64_t batch, int64_t k, cudaStream_t stream) {
+  dim3 threads(kTile, kTile);
+  dim3 blocks(table.nnz, batch);
+  BlockSparseSddKernel<T, BLOCK><<<blocks, threads, 0, stream>>>(
+      static_cast<const T*>(x1), static_cast<const T*>(x2), static_cast<T*>(out), table, k);
+}
+
+template <typename T, int BLOCK>
+void LaunchDsd(const void* a, const void* x, void* out, const BlockSparseTable& table,
+               bool transpose_a, int64_t batch, int64_t k, cudaStream_t stream) {
+  dim3 threads(kTile, kTile);
+  dim3 blocks(transpose_a ? table.cols : table.rows, (k + kTile - 1) / kTile, batch);
+  if (transpose_a) {
+    BlockSparseDsdKernel<T, BLOCK, true><<<blocks, threads, 0, stream>>>(
+        static_cast<const T*>(a), static_cast<const T*>(x), static_cast<T*>(out), table, k);
+  } else {
+    BlockSparseDsdKernel<T, BLOCK, false><<<blocks, threads, 0, stream>>>(
+        static_cast<const T*>(a), static_cast<const T*>(x), static_cast<T*>(out), table, k);
+  }
+}
+
+template <typename T, int BLOCK>
+void LaunchSoftmax(const void* x, void* y, const BlockSparseTable& table, float scale, bool causal,
+                   int64_t batch, cudaStream_t stream) {
+  dim3 blocks((table.rows * BLOCK + kSoftmaxWarps - 1) / kSoftmaxWarps, batch);
+  BlockSparseSoftmaxKernel<T, BLOCK><<<blocks, kSoftmaxWarps * 32, 0, stream>>>(
+      static_cast<const T*>(x), static_cast<T*>(y), table, scale, causal);
+}
+
+template <typename T, int BLOCK>
+void LaunchSoftmaxDx(const void* y, const void* dy, void* dx, const BlockSparseTable& table,
+                     float scale, int64_t batch, cudaStream_t stream) {
+  dim3 blocks((table.rows * BLOCK + kSoftmaxWarps - 1) / kSoftmaxWarps, batch);
+  BlockSparseSoftmaxDxKernel<T, BLOCK><<<blocks, kSoftmaxWarps * 32, 0, stream>>>(
+      static_cast<const T*>(y), static_cast<const T*>(dy), static_cast<T*>(dx), table, scale);
+}
+
+}  // namespace
+
+/*! \brief Call LAUNCH<T, BLOCK>(...) for the dtype and the block size of the table. */
+#define RAF_BLOCK_SPARSE_DISPATCH(LAUNCH, dtype, table, ...)                      \
+  do {                                                                            \
+    if ((dtype).code == kDLFloat && (dtype).bits == 32) {                         \
+      RAF_BLOCK_SPARSE_DISPATCH_BLOCK(LAUNCH, float, table, __VA_ARGS__);         \
+    } else if ((dtype).code == kDLFloat && (dtype).bits == 16) {                  \
+      RAF_BLOCK_SPARSE_DISPATCH_BLOCK(LAUNCH, __half, table, __VA_ARGS__);        \
+    } else if ((dtype).code == kDLBfloat && (dtype).bits == 16) {                 \
+      RAF_BLOCK_SPARSE_DISPATCH_BLOCK(LAUNCH, __nv_bfloat16, table, __VA_ARGS__); \
+    } else {                                                                      \
+      LOG(FATAL) << "Unsupported dtype of the block-sparse kernels: "             \
+                 << DType(dtype).c_str();                                         \
+    }                                                                             \
+  } while (0)
+
+#define RAF_BLOCK_SPARSE_DISPATCH_BLOCK(LAUNCH, T, table, ...)                               \
+  switch ((table).block) {                                                                   \
+    case 16:                                                                                 \
+      LAUNCH<T, 16>(__VA_ARGS__);                                                            \
+      break;                                                                                 \
+    case 32:                                                                                 \
+      LAUNCH<T, 32>(__VA_ARGS__);                                                            \
+      break;                                                                                 \
+    case 64:                                                                                 \
+      LAUNCH<T, 64>(__VA_ARGS__);                                                            \
+      break;                                                                                 \
+    default:                                                                                 \
+      LOG(FATAL) << "Unsupported block size of the block-sparse kernels: " << (table).block; \
+  }
+
+bool block_sparse_block_supported(int64_t block) {
+  return block == 16 || block == 32 || block == 64;
+}
+
+void block_sparse_sdd_cuda(const void* x1, const void* x2, void* out,
+                           const BlockSparseTable& table, int64_t batch, int64_t k,
+                           DLDataType dtype, void* stream) {
+  if (table.nnz == 0 || batch == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  RAF_BLOCK_SPARSE_DISPATCH(LaunchSdd, dtype, table, x1, x2, out, table, batch, k, cuda_stream);
+}
+
+void block_sparse_dsd_cuda(const void* a, const void* x, void* out, const BlockSparseTable& table,
+                           bool transpose_a, int64_t batch, int64_t k, DLDataType dtype,
+                           void* stream) {
+  if (batch == 0 || k == 0 || (transpose_a ? table.cols : table.rows) == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  RAF_BLOCK_SPARSE_DISPATCH(LaunchDsd, dtype, table, a, x, out, table, transpose_a, batch, k,
+                            cuda_stream);
+}
+
+void block_sparse_softmax_cuda(const void* x, void* y, const BlockSparseTable& table, float scale,
+                               bool causal, int64_t batch, DLDataType dtype, void* stream) {
+  if (table.nnz == 0 || batch == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  RAF_BLOCK_SPARSE_DISPATCH(LaunchSoftmax, dtype, table, x, y, table, scale, causal, batch,
+                            cuda_stream);
+}
+
+void block_sparse_softmax_dx_cuda(const void* y, const void* dy, void* dx,
+                                  const BlockSparseTable& table, float scale, int64_t batch,
+                                  DLDataType dtype, void* stream) {
+  if (table.nnz == 0 || batch == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  RAF_BLOCK_SPARSE_DISPATCH(LaunchSoftmaxDx, dtype, table, y, dy, dx, table, scale, batch,
+                            cuda_stream);
+}
+
+#undef RAF_BLOCK_SPARSE_DISPATCH_BLOCK
+#undef RAF_BLOCK_SPARSE_DISPATCH
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,141 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/comm_compression.cu
+ * \brief Kernels to compress and decompress the gradients of collective communication
+ */
+#include <cuda_bf16.h>
+#include <thrust/execution_policy.h>
+#include <thrust/functional.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kThreadsPerBlock = 512;
+
+inline int NumBlocks(int64_t n) {
+  return static_cast<int>((n + kThreadsPerBlock - 1) / kThreadsPerBlock);
+}
+
+__device__ __forceinline__ void StoreFloat(float x, __half* dst) {
+  *dst = __float2half(x);
+}
+
+__device__ __forceinline__ void StoreFloat(float x, __nv_bfloat16* dst) {
+  *dst = __float2bfloat16(x);
+}
+
+__device__ __forceinline__ float LoadFloat(const __half* src) {
+  return __half2float(*src);
+}
+
+__device__ __forceinline__ float LoadFloat(const __nv_bfloat16* src) {
+  return __bfloat162float(*src);
+}
+
+template <typename T>
+__global__ void CompressFloatKernel(const float* __restrict__ src, T* __restrict__ dst,
+                                    int64_t n) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    StoreFloat(src[i], dst + i);
+  }
+}
+
+template <typename T>
+__global__ void DecompressFloatKernel(const T* __restrict__ src, float* __restrict__ dst,
+                                      int64_t n) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    dst[i] = LoadFloat(src + i);
+  }
+}
+
+void compress_float_cuda(const float* src, void* dst, int64_t n, bool bf16, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  auto s = static_cast<cudaStream_t>(stream);
+  if (bf16) {
+    CompressFloatKernel<<<NumBlocks(n), kThreadsPerBlock, 0, s>>>(
+        src, static_cast<__nv_bfloat16*>(dst), n);
+  } else {
+    CompressFloatKernel<<<NumBlocks(n), kThreadsPerBlock, 0, s>>>(src, static_cast<__half*>(dst),
+                                                                   n);
+  }
+}
+
+void decompress_float_cuda(const void* src, float* dst, int64_t n, bool bf16, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  auto s = static_cast<cudaStream_t>(stream);
+  if (bf16) {
+    DecompressFloatKernel<<<NumBlocks(n), kThreadsPerBlock, 0, s>>>(
+        static_cast<const __nv_bfloat16*>(src), dst, n);
+  } else {
+    DecompressFloatKernel<<<NumBlocks(n), kThreadsPerBlock, 0, s>>>(
+        static_cast<const __half*>(src), dst, n);
+  }
+}
+
+/*! \brief Accumulate the gradient to the residual, and compute the magnitude as the sort key. */
+__global__ void AccumulateResidualKernel(const float* __restrict__ grad,
+                                         float* __restrict__ residual, float* __restrict__ keys,
+                                         int64_t n) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    float acc = residual[i] + grad[i];
+    residual[i] = acc;
+    keys[i] = fabsf(acc);
+  }
+}
+
+/*! \brief Take the selected elements out of the residual. */
+__global__ void SelectTopKKernel(const int* __restrict__ indices, float* __restrict__ residual,
+                                 float* __restrict__ values, int64_t k) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < k) {
+    int idx = indices[i];
+    values[i] = residual[idx];
+    residual[idx] = 0.0f;
+  }
+}
+
+__global__ void ScatterAddKernel(const int* __restrict__ indices,
+                                 const float* __restrict__ values, int64_t nnz, float scale,
+                                 float* __restrict__ out) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < nnz) {
+    atomicAdd(out + indices[i], values[i] * scale);
+  }
+}
+
+void topk_compress_cuda(const float* grad, float* residual, int64_t n, int64_t k, float* keys,
+                        int* sorted_indices, int* indices, float* values, void* stream) {
+  auto s = static_cast<cudaStream_t>(stream);
+  AccumulateResidualKernel<<<NumBlocks(n), kThreadsPerBlock, 0, s>>>(grad, residual, keys, n);
+  thrust::sequence(thrust::cuda::par.on(s), sorted_indices, sorted_indices + n);
+  thrust::sort_by_key(thrust::cuda::par.on(s), keys, keys + n, sorted_indices,
+                      thrust::greater<float>());
+  cudaMemcpyAsync(indices, sorted_indices, k * sizeof(int), cudaMemcpyDeviceToDevice, s);
+  SelectTopKKernel<<<NumBlocks(k), kThreadsPerBlock, 0, s>>>(indices, residual, values, k);
+}
+
+void scatter_add_cuda(const int* indices, const float* values, int64_t nnz, float scale,
+                      float* out, int64_t n, void* stream) {
+  auto s = static_cast<cudaStream_t>(stream);
+  cudaMemsetAsync(out, 0, n * sizeof(float), s);
+  ScatterAddKernel<<<NumBlocks(nnz), kThreadsPerBlock, 0, s>>>(indices, values, nnz, scale, out);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
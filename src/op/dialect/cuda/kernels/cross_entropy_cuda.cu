@@ -0,0 +1,218 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/cross_entropy_cuda.cu
+ * \brief The kernels of the fused softmax cross entropy, which never materialize the softmax
+ */
+#include <algorithm>
+#include <math.h>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kCrossEntropyThreads = 256;
+static const int kCrossEntropyMaxBlocks = 65535;
+
+/*! \brief Merge the softmax state (m2, s2) into (m, s), where s is the sum of exp(x - m). */
+__device__ __forceinline__ void MergeSoftmaxState(float* m, float* s, float m2, float s2) {
+  if (m2 == -INFINITY) {
+    return;
+  }
+  if (*m == -INFINITY) {
+    *m = m2;
+    *s = s2;
+    return;
+  }
+  float new_m = fmaxf(*m, m2);
+  *s = *s * expf(*m - new_m) + s2 * expf(m2 - new_m);
+  *m = new_m;
+}
+
+/*! \brief Merge the softmax states of a warp, whose result is in all lanes. */
+__device__ __forceinline__ void WarpReduceSoftmaxState(float* m, float* s) {
+  for (int offset = 16; offset > 0; offset >>= 1) {
+    float m2 = __shfl_xor_sync(0xffffffff, *m, offset);
+    float s2 = __shfl_xor_sync(0xffffffff, *s, offset);
+    MergeSoftmaxState(m, s, m2, s2);
+  }
+}
+
+/*! \brief Merge the softmax states of a block, whose result is in all threads. */
+__device__ void BlockReduceSoftmaxState(float* m, float* s) {
+  __shared__ float warp_m[32];
+  __shared__ float warp_s[32];
+  int lane = threadIdx.x % 32;
+  int warp = threadIdx.x / 32;
+  WarpReduceSoftmaxState(m, s);
+  if (lane == 0) {
+    warp_m[warp] = *m;
+    warp_s[warp] = *s;
+  }
+  __syncthreads();
+  int num_warps = (blockDim.x + 31) / 32;
+  *m = lane < num_warps ? warp_m[lane] : -INFINITY;
+  *s = lane < num_warps ? warp_s[lane] : 0.0f;
+  WarpReduceSoftmaxState(m, s);
+  // The shared memory is reused by the next row.
+  __syncthreads();
+}
+
+/*!
+ * \brief Each block computes the max, the sum of exp(x - max) and the logit of the label of a
+ * row in one pass over the row, where the label is shifted by vocab_start.
+ */
+template <typename T>
+__global__ void CrossEntropyStatsKernel(const T* __restrict__ logits,
+                                        const int64_t* __restrict__ labels, int64_t n, int64_t v,
+                                        int64_t vocab_start, float* __restrict__ max,
+                                        float* __restrict__ sum, float* __restrict__ target) {
+  for (int64_t row = blockIdx.x; row < n; row += gridDim.x) {
+    const T* x = logits + row * v;
+    float m = -INFINITY;
+    float s = 0.0f;
+    for (int64_t j = threadIdx.x; j < v; j += blockDim.x) {
+      float xj = static_cast<float>(x[j]);
+      if (xj > m) {
+        s = s * expf(m - xj) + 1.0f;
+        m = xj;
+      } else {
+        s += expf(xj - m);
+      }
+    }
+    BlockReduceSoftmaxState(&m, &s);
+    if (threadIdx.x == 0) {
+      int64_t label = labels[row] - vocab_start;
+      max[row] = m;
+      sum[row] = s;
+      target[row] = label >= 0 && label < v ? static_cast<float>(x[label]) : 0.0f;
+    }
+  }
+}
+
+template <typename T>
+void cross_entropy_stats_cuda(const T* logits, const int64_t* labels, int64_t n, int64_t v,
+                              int64_t vocab_start, float* max, float* sum, float* target,
+                              void* stream) {
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>(n, kCrossEntropyMaxBlocks));
+  CrossEntropyStatsKernel<<<blocks, kCrossEntropyThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      logits, labels, n, v, vocab_start, max, sum, target);
+}
+
+/*! \brief Rescale the sums of exp(x - local_max) of the rows to the sums of exp(x - max). */
+__global__ void CrossEntropyRescaleKernel(const float* __restrict__ local_max,
+                                          const float* __restrict__ max, int64_t n,
+                                          float* __restrict__ sum) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    sum[i] = local_max[i] == -INFINITY ? 0.0f : sum[i] * expf(local_max[i] - max[i]);
+  }
+}
+
+void cross_entropy_rescale_cuda(const float* local_max, const float* max, int64_t n, float* sum,
+                                void* stream) {
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>(
+      (n + kCrossEntropyThreads - 1) / kCrossEntropyThreads, kCrossEntropyMaxBlocks));
+  CrossEntropyRescaleKernel<<<blocks, kCrossEntropyThreads, 0,
+                              static_cast<cudaStream_t>(stream)>>>(local_max, max, n, sum);
+}
+
+/*! \brief A single block averages log(sum) + max - target of the rows. */
+template <typename T>
+__global__ void CrossEntropyLossKernel(const float* __restrict__ max,
+                                       const float* __restrict__ sum,
+                                       const float* __restrict__ target, int64_t n, T* loss) {
+  __shared__ float warp_acc[32];
+  float acc = 0.0f;
+  for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+    acc += logf(sum[i]) + max[i] - target[i];
+  }
+  for (int offset = 16; offset > 0; offset >>= 1) {
+    acc += __shfl_xor_sync(0xffffffff, acc, offset);
+  }
+  int lane = threadIdx.x % 32;
+  int warp = threadIdx.x / 32;
+  if (lane == 0) {
+    warp_acc[warp] = acc;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    int num_warps = (blockDim.x + 31) / 32;
+    acc = lane < num_warps ? warp_acc[lane] : 0.0f;
+    for (int offset = 16; offset > 0; offset >>= 1) {
+      acc += __shfl_xor_sync(0xffffffff, acc, offset);
+    }
+    if (lane == 0) {
+      loss[0] = static_cast<T>(n > 0 ? acc / n : 0.0f);
+    }
+  }
+}
+
+template <typename T>
+void cross_entropy_loss_cuda(const float* max, const float* sum, const float* target, int64_t n,
+                             T* loss, void* stream) {
+  CrossEntropyLossKernel<<<1, kCrossEntropyThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      max, sum, target, n, loss);
+}
+
+/*! \brief Each thread computes an element of (softmax(x) - onehot(label)) * dy / n. */
+template <typename T>
+__global__ void CrossEntropyDxKernel(const T* __restrict__ dy, const T* __restrict__ logits,
+                                     const int64_t* __restrict__ labels,
+                                     const float* __restrict__ max,
+                                     const float* __restrict__ sum, int64_t n, int64_t v,
+                                     int64_t vocab_start, T* __restrict__ dx) {
+  float scale = static_cast<float>(dy[0]) / n;
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n * v;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    int64_t row = i / v;
+    float p = expf(static_cast<float>(logits[i]) - max[row]) / sum[row];
+    if (labels[row] - vocab_start == i % v) {
+      p -= 1.0f;
+    }
+    dx[i] = static_cast<T>(p * scale);
+  }
+}
+
+template <typename T>
+void cross_entropy_dx_cuda(const T* dy, const T* logits, const int64_t* labels, const float* max,
+                           const float* sum, int64_t n, int64_t v, int64_t vocab_start, T* dx,
+                           void* stream) {
+  int64_t numel = n * v;
+  if (numel == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>(
+      (numel + kCrossEntropyThreads - 1) / kCrossEntropyThreads, kCrossEntropyMaxBlocks));
+  CrossEntropyDxKernel<<<blocks, kCrossEntropyThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      dy, logits, labels, max, sum, n, v, vocab_start, dx);
+}
+
+template void cross_entropy_stats_cuda<float>(const float*, const int64_t*, int64_t, int64_t,
+                                              int64_t, float*, float*, float*, void*);
+template void cross_entropy_stats_cuda<__half>(const __half*, const int64_t*, int64_t, int64_t,
+                                               int64_t, float*, float*, float*, void*);
+template void cross_entropy_loss_cuda<float>(const float*, const float*, const float*, int64_t,
+                                             float*, void*);
+template void cross_entropy_loss_cuda<__half>(const float*, const float*, const float*, int64_t,
+                                              __half*, void*);
+template void cross_entropy_dx_cuda<float>(const float*, const float*, const int64_t*,
+                                           const float*, const float*, int64_t, int64_t, int64_t,
+                                           float*, void*);
+template void cross_entropy_dx_cuda<__half>(const __half*, const __half*, const int64_t*,
+                                            const float*, const float*, int64_t, int64_t, int64_t,
+                                            __half*, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
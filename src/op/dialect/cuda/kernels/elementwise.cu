@@ -0,0 +1,335 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/elementwise.cu
+ * \brief The precompiled elementwise, broadcast and cast cuda kernels, which are instantiated for
+ * each op, dtype and vector width at build time, so the common ops run without JIT.
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kMaxBlocks = 4096;
+/*! \brief The bytes loaded and stored at a time by the vectorized kernels. */
+constexpr int kVecBytes = 16;
+
+template <typename T, int kVec>
+struct alignas(sizeof(T) * kVec) AlignedVector {
+  T val[kVec];
+};
+
+template <ElementwiseOp kOp>
+__device__ __forceinline__ float ApplyUnary(float x) {
+  switch (kOp) {
+    case ElementwiseOp::kAbs:
+      return fabsf(x);
+    case ElementwiseOp::kNegative:
+      return -x;
+    case ElementwiseOp::kRelu:
+      return fmaxf(x, 0.0f);
+    case ElementwiseOp::kSigmoid:
+      return 1.0f / (1.0f + expf(-x));
+    case ElementwiseOp::kTanh:
+      return tanhf(x);
+    case ElementwiseOp::kExp:
+      return expf(x);
+    case ElementwiseOp::kLog:
+      return logf(x);
+    case ElementwiseOp::kSqrt:
+      return sqrtf(x);
+    case ElementwiseOp::kRsqrt:
+      return rsqrtf(x);
+    default:
+      return x;
+  }
+}
+
+template <ElementwiseOp kOp>
+__device__ __forceinline__ float ApplyBinary(float a, float b) {
+  switch (kOp) {
+    case ElementwiseOp::kAdd:
+      return a + b;
+    case ElementwiseOp::kSubtract:
+      return a - b;
+    case ElementwiseOp::kMultiply:
+      return a * b;
+    case ElementwiseOp::kDivide:
+      return a / b;
+    case ElementwiseOp::kMaximum:
+      return fmaxf(a, b);
+    default:
+      return fminf(a, b);
+  }
+}
+
+/*! \brief The float ops are computed in float, so the kernels of each op share one body. */
+template <typename T>
+__device__ __forceinline__ T FromFloat(float x) {
+  T ret;
+  StoreFloat(x, &ret);
+  return ret;
+}
+
+template <ElementwiseOp kOp, typename T, int kVec>
+__global__ void UnaryKernel(const T* x, T* y, int64_t n) {
+  using Vec = AlignedVector<T, kVec>;
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  int64_t tid = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  int64_t nvec = n / kVec;
+  for (int64_t i = tid; i < nvec; i += stride) {
+    Vec in = reinterpret_cast<const Vec*>(x)[i];
+    Vec out;
+#pragma unroll
+    for (int j = 0; j < kVec; ++j) {
+      out.val[j] = FromFloat<T>(ApplyUnary<kOp>(LoadFloat(in.val[j])));
+    }
+    reinterpret_cast<Vec*>(y)[i] = out;
+  }
+  for (int64_t i = nvec * kVec + tid; i < n; i += stride) {
+    y[i] = FromFloat<T>(ApplyUnary<kOp>(LoadFloat(x[i])));
+  }
+}
+
+template <ElementwiseOp kOp, typename T, int kVec>
+__global__ void BinaryKernel(const T* x1, const T* x2, T* y, int64_t n) {
+  using Vec = AlignedVector<T, kVec>;
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  int64_t tid = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  int64_t nvec = n / kVec;
+  for (int64_t i = tid; i < nvec; i += stride) {
+    Vec a = reinterpret_cast<const Vec*>(x1)[i];
+    Vec b = reinterpret_cast<const Vec*>(x2)[i];
+    Vec out;
+#pragma unroll
+    for (int j = 0; j < kVec; ++j) {
+      out.val[j] = FromFloat<T>(ApplyBinary<kOp>(LoadFloat(a.val[j]), LoadFloat(b.val[j])));
+    }
+    reinterpret_cast<Vec*>(y)[i] = out;
+  }
+  for (int64_t i = nvec * kVec + tid; i < n; i += stride) {
+    y[i] = FromFloat<T>(ApplyBinary<kOp>(LoadFloat(x1[i]), LoadFloat(x2[i])));
+  }
+}
+
+template <ElementwiseOp kOp, typename T>
+__global__ void BroadcastKernel(const T* x1, const T* x2, T* y, int64_t n,
+                                ElementwiseBroadcast bcast) {
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < n;
+       i += stride) {
+    int64_t rem = i;
+    int64_t offset_1 = 0;
+    int64_t offset_2 = 0;
+#pragma unroll
+    for (int d = 0; d < kElementwiseMaxDims; ++d) {
+      if (d < bcast.ndim) {
+        int64_t coord = rem / bcast.out_strides[d];
+        rem -= coord * bcast.out_strides[d];
+        offset_1 += coord * bcast.x1_strides[d];
+        offset_2 += coord * bcast.x2_strides[d];
+      }
+    }
+    y[i] = FromFloat<T>(ApplyBinary<kOp>(LoadFloat(x1[offset_1]), LoadFloat(x2[offset_2])));
+  }
+}
+
+template <typename In, typename Out, int kVec>
+__global__ void CastKernel(const In* x, Out* y, int64_t n) {
+  using InVec = AlignedVector<In, kVec>;
+  using OutVec = AlignedVector<Out, kVec>;
+  int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  int64_t tid = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  int64_t nvec = n / kVec;
+  for (int64_t i = tid; i < nvec; i += stride) {
+    InVec in = reinterpret_cast<const InVec*>(x)[i];
+    OutVec out;
+#pragma unroll
+    for (int j = 0; j < kVec; ++j) {
+      out.val[j] = FromFloat<Out>(LoadFloat(in.val[j]));
+    }
+    reinterpret_cast<OutVec*>(y)[i] = out;
+  }
+  for (int64_t i = nvec * kVec + tid; i < n; i += stride) {
+    y[i] = FromFloat<Out>(LoadFloat(x[i]));
+  }
+}
+
+int NumBlocks(int64_t n, int vec) {
+  int64_t threads = (n + vec - 1) / vec;
+  return static_cast<int>(std::min<int64_t>((threads + kBlockSize - 1) / kBlockSize, kMaxBlocks));
+}
+
+bool IsAligned(const void* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % kVecBytes == 0;
+}
+
+template <ElementwiseOp kOp, typename T>
+void LaunchUnary(const void* x, void* y, int64_t n, cudaStream_t stream) {
+  constexpr int kVec = kVecBytes / sizeof(T);
+  const T* in = static_cast<const T*>(x);
+  T* out = static_cast<T*>(y);
+  if (IsAligned(x) && IsAligned(y)) {
+    UnaryKernel<kOp, T, kVec><<<NumBlocks(n, kVec), kBlockSize, 0, stream>>>(in, out, n);
+  } else {
+    UnaryKernel<kOp, T, 1><<<NumBlocks(n, 1), kBlockSize, 0, stream>>>(in, out, n);
+  }
+}
+
+template <ElementwiseOp kOp, typename T>
+void LaunchBinary(const void* x1, const void* x2, void* y, int64_t n,
+                  const ElementwiseBroadcast* bcast, cudaStream_t stream) {
+  constexpr int kVec = kVecBytes / sizeof(T);
+  const T* a = static_cast<const T*>(x1);
+  const T* b = static_cast<const T*>(x2);
+  T* out = static_cast<T*>(y);
+  if (bcast != nullptr) {
+    BroadcastKernel<kOp, T><<<NumBlocks(n, 1), kBlockSize, 0, stream>>>(a, b, out, n, *bcast);
+  } else if (IsAligned(x1) && IsAligned(x2) && IsAligned(y)) {
+    BinaryKernel<kOp, T, kVec><<<NumBlocks(n, kVec), kBlockSize, 0, stream>>>(a, b, out, n);
+  } else {
+    BinaryKernel<kOp, T, 1><<<NumBlocks(n, 1), kBlockSize, 0, stream>>>(a, b, out, n);
+  }
+}
+
+template <typename In, typename Out>
+void LaunchCast(const void* x, void* y, int64_t n, cudaStream_t stream) {
+  // The vector width is of the wider dtype, so both sides load and store at most 16 bytes.
+  constexpr int kVec = kVecBytes / std::max(sizeof(In), sizeof(Out));
+  const In* in = static_cast<const In*>(x);
+  Out* out = static_cast<Out*>(y);
+  if (IsAligned(x) && IsAligned(y)) {
+    CastKernel<In, Out, kVec><<<NumBlocks(n, kVec), kBlockSize, 0, stream>>>(in, out, n);
+  } else {
+    CastKernel<In, Out, 1><<<NumBlocks(n, 1), kBlockSize, 0, stream>>>(in, out, n);
+  }
+}
+
+template <typename T>
+void DispatchUnary(ElementwiseOp op, const void* x, void* y, int64_t n, cudaStream_t stream) {
+  switch (op) {
+#define RAF_ELEMENTWISE_UNARY_CASE(OP)                  \
+  case ElementwiseOp::OP:                               \
+    LaunchUnary<ElementwiseOp::OP, T>(x, y, n, stream); \
+    return;
+    RAF_ELEMENTWISE_UNARY_CASE(kCopy)
+    RAF_ELEMENTWISE_UNARY_CASE(kAbs)
+    RAF_ELEMENTWISE_UNARY_CASE(kNegative)
+    RAF_ELEMENTWISE_UNARY_CASE(kRelu)
+    RAF_ELEMENTWISE_UNARY_CASE(kSigmoid)
+    RAF_ELEMENTWISE_UNARY_CASE(kTanh)
+    RAF_ELEMENTWISE_UNARY_CASE(kExp)
+    RAF_ELEMENTWISE_UNARY_CASE(kLog)
+    RAF_ELEMENTWISE_UNARY_CASE(kSqrt)
+    RAF_ELEMENTWISE_UNARY_CASE(kRsqrt)
+#undef RAF_ELEMENTWISE_UNARY_CASE
+    default:
+      LOG(FATAL) << "Not a unary elementwise op: " << static_cast<int>(op);
+  }
+}
+
+template <typename T>
+void DispatchBinary(ElementwiseOp op, const void* x1, const void* x2, void* y, int64_t n,
+                    const ElementwiseBroadcast* bcast, cudaStream_t stream) {
+  switch (op) {
+#define RAF_ELEMENTWISE_BINARY_CASE(OP)                              \
+  case ElementwiseOp::OP:                                            \
+    LaunchBinary<ElementwiseOp::OP, T>(x1, x2, y, n, bcast, stream); \
+    return;
+    RAF_ELEMENTWISE_BINARY_CASE(kAdd)
+    RAF_ELEMENTWISE_BINARY_CASE(kSubtract)
+    RAF_ELEMENTWISE_BINARY_CASE(kMultiply)
+    RAF_ELEMENTWISE_BINARY_CASE(kDivide)
+    RAF_ELEMENTWISE_BINARY_CASE(kMaximum)
+    RAF_ELEMENTWISE_BINARY_CASE(kMinimum)
+#undef RAF_ELEMENTWISE_BINARY_CASE
+    default:
+      LOG(FATAL) << "Not a binary elementwise op: " << static_cast<int>(op);
+  }
+}
+
+template <typename In>
+void DispatchCastOut(const void* x, void* y, DLDataType y_dtype, int64_t n, cudaStream_t stream) {
+  if (y_dtype.code == kDLFloat && y_dtype.bits == 32) {
+    LaunchCast<In, float>(x, y, n, stream);
+  } else if (y_dtype.code == kDLFloat && y_dtype.bits == 16) {
+    LaunchCast<In, __half>(x, y, n, stream);
+  } else if (y_dtype.code == kDLBfloat && y_dtype.bits == 16) {
+    LaunchCast<In, __nv_bfloat16>(x, y, n, stream);
+  } else {
+    LOG(FATAL) << "Unsupported output dtype of the elementwise kernels: "
+               << DType(y_dtype).c_str();
+  }
+}
+
+}  // namespace
+
+bool elementwise_dtype_supported(DLDataType dtype) {
+  return dtype.lanes == 1 && ((dtype.code == kDLFloat && (dtype.bits == 32 || dtype.bits == 16)) ||
+                              (dtype.code == kDLBfloat && dtype.bits == 16));
+}
+
+void elementwise_unary_cuda(ElementwiseOp op, const void* x, void* y, int64_t n, DLDataType dtype,
+                            void* stream) {
+  if (n == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    DispatchUnary<float>(op, x, y, n, cuda_stream);
+  } else if (dtype.code == kDLFloat && dtype.bits == 16) {
+    DispatchUnary<__half>(op, x, y, n, cuda_stream);
+  } else if (dtype.code == kDLBfloat && dtype.bits == 16) {
+    DispatchUnary<__nv_bfloat16>(op, x, y, n, cuda_stream);
+  } else {
+    LOG(FATAL) << "Unsupported dtype of the elementwise kernels: " << DType(dtype).c_str();
+  }
+}
+
+void elementwise_binary_cuda(ElementwiseOp op, const void* x1, const void* x2, void* y, int64_t n,
+                             DLDataType dtype, const ElementwiseBroadcast* bcast, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    DispatchBinary<float>(op, x1, x2, y, n, bcast, cuda_stream);
+  } else if (dtype.code == kDLFloat && dtype.bits == 16) {
+    DispatchBinary<__half>(op, x1, x2, y, n, bcast, cuda_stream);
+  } else if (dtype.code == kDLBfloat && dtype.bits == 16) {
+    DispatchBinary<__nv_bfloat16>(op, x1, x2, y, n, bcast, cuda_stream);
+  } else {
+    LOG(FATAL) << "Unsupported dtype of the elementwise kernels: " << DType(dtype).c_str();
+  }
+}
+
+void elementwise_cast_cuda(const void* x, DLDataType x_dtype, void* y, DLDataType y_dtype,
+                           int64_t n, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  if (x_dtype.code == kDLFloat && x_dtype.bits == 32) {
+    DispatchCastOut<float>(x, y, y_dtype, n, cuda_stream);
+  } else if (x_dtype.code == kDLFloat && x_dtype.bits == 16) {
+    DispatchCastOut<__half>(x, y, y_dtype, n, cuda_stream);
+  } else if (x_dtype.code == kDLBfloat && x_dtype.bits == 16) {
+    DispatchCastOut<__nv_bfloat16>(x, y, y_dtype, n, cuda_stream);
+  } else {
+    LOG(FATAL) << "Unsupported input dtype of the elementwise kernels: "
+               << DType(x_dtype).c_str();
+  }
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -123,7 +123,8 @@ __global__ void embedding_backward_feature_kernel(const int64_t* indices,
                 add(my_s[threadIdx.x], smem[threadIdx.x + WARP_SIZE * first_remaining_peer]);
             matchmask ^= (1 << first_remaining_peer);
           }
-          if (f < stride) {
+          // The negative indices, e.g., the padding rows of a row-sparse gradient, are skipped.
+          if (f < stride && dst_row >= 0) {
             output[dst_row * stride + f] =
                 add(output[dst_row * stride + f], static_cast<scalar_t>(my_s[threadIdx.x]));
           }
@@ -0,0 +1,95 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/embedding_sparse_dx_cuda.cu
+ * \brief The row-sparse embedding backward by sorting the indices and reducing the segments
+ */
+#include <thrust/execution_policy.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kThreadsPerBlock = 512;
+static const int kFeaturesPerBlock = 128;
+
+/*!
+ * \brief Flag the first position of each segment of the same valid index in the sorted keys, and
+ * reset the output rows to -1.
+ */
+__global__ void MarkSegmentsKernel(const int64_t* __restrict__ keys, int64_t* __restrict__ segments,
+                                   int64_t* __restrict__ rows, int64_t n) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    segments[i] = keys[i] >= 0 && (i == 0 || keys[i] != keys[i - 1]);
+    rows[i] = -1;
+  }
+}
+
+/*!
+ * \brief Each block column starts at a sorted position, and only the starts of the segments sum
+ * the rows of their segments, in the original order of the rows, so the sums are deterministic
+ * without atomics. segments is the inclusive scan of the flags, i.e., 1 + the output row.
+ */
+template <typename T>
+__global__ void SegmentReduceKernel(const T* __restrict__ grad, const int64_t* __restrict__ keys,
+                                    const int64_t* __restrict__ order,
+                                    const int64_t* __restrict__ segments, int64_t n, int stride,
+                                    int64_t* __restrict__ rows, T* __restrict__ values) {
+  int64_t i = blockIdx.x;
+  int f = blockIdx.y * blockDim.x + threadIdx.x;
+  int64_t key = keys[i];
+  if (key < 0 || (i > 0 && keys[i - 1] == key)) {
+    return;
+  }
+  int64_t seg = segments[i] - 1;
+  if (f == 0) {
+    rows[seg] = key;
+  }
+  if (f >= stride) {
+    return;
+  }
+  float acc = 0.0f;
+  for (int64_t j = i; j < n && keys[j] == key; ++j) {
+    acc += static_cast<float>(grad[order[j] * stride + f]);
+  }
+  values[seg * stride + f] = static_cast<T>(acc);
+}
+
+template <typename T>
+void embedding_sparse_backward_cuda(const T* grad, const int64_t* indices, int64_t n, int stride,
+                                    int64_t* keys, int64_t* order, int64_t* segments,
+                                    int64_t* rows, T* values, void* stream) {
+  auto s = static_cast<cudaStream_t>(stream);
+  CUDA_CALL(cudaMemsetAsync(values, 0, n * stride * sizeof(T), s));
+  if (n == 0 || stride == 0) {
+    return;
+  }
+  CUDA_CALL(cudaMemcpyAsync(keys, indices, n * sizeof(int64_t), cudaMemcpyDeviceToDevice, s));
+  thrust::sequence(thrust::cuda::par.on(s), order, order + n);
+  thrust::stable_sort_by_key(thrust::cuda::par.on(s), keys, keys + n, order);
+  int blocks = static_cast<int>((n + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  MarkSegmentsKernel<<<blocks, kThreadsPerBlock, 0, s>>>(keys, segments, rows, n);
+  thrust::inclusive_scan(thrust::cuda::par.on(s), segments, segments + n, segments);
+  dim3 grid(n, (stride + kFeaturesPerBlock - 1) / kFeaturesPerBlock);
+  SegmentReduceKernel<T>
+      <<<grid, kFeaturesPerBlock, 0, s>>>(grad, keys, order, segments, n, stride, rows, values);
+}
+
+template void embedding_sparse_backward_cuda<float>(const float*, const int64_t*, int64_t, int,
+                                                    int64_t*, int64_t*, int64_t*, int64_t*, float*,
+                                                    void*);
+template void embedding_sparse_backward_cuda<__half>(const __half*, const int64_t*, int64_t, int,
+                                                     int64_t*, int64_t*, int64_t*, int64_t*,
+                                                     __half*, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,108 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/fp8_quantize.cu
+ * \brief Kernels to quantize the half-precision GEMM operands to fp8 with per-tensor scaling
+ */
+#include <cuda_bf16.h>
+#include <algorithm>
+#include "./kernel_util.cuh"
+#if CUDA_VERSION >= 11080
+#include <cuda_fp8.h>
+#endif
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+#if CUDA_VERSION >= 11080
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kMaxBlocks = 1024;
+/*! \brief The largest finite value of fp8 e4m3. */
+constexpr float kFP8E4M3Max = 448.0f;
+
+__device__ __forceinline__ float LoadFloat(const __half* src) {
+  return __half2float(*src);
+}
+
+__device__ __forceinline__ float LoadFloat(const __nv_bfloat16* src) {
+  return __bfloat162float(*src);
+}
+
+template <typename T>
+__global__ void AbsMaxKernel(const T* src, int64_t n, float* amax) {
+  __shared__ float smem[kBlockSize];
+  float local = 0.0f;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    local = fmaxf(local, fabsf(LoadFloat(src + i)));
+  }
+  smem[threadIdx.x] = local;
+  __syncthreads();
+  for (int stride = kBlockSize / 2; stride > 0; stride >>= 1) {
+    if (threadIdx.x < stride) {
+      smem[threadIdx.x] = fmaxf(smem[threadIdx.x], smem[threadIdx.x + stride]);
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    // The non-negative floats are ordered as their bits in int.
+    atomicMax(reinterpret_cast<int*>(amax), __float_as_int(smem[0]));
+  }
+}
+
+template <typename T>
+__global__ void QuantizeKernel(const T* src, __nv_fp8_e4m3* dst, int64_t n, const float* amax,
+                               float* scale) {
+  float s = fmaxf(*amax, 1e-12f) / kFP8E4M3Max;
+  if (blockIdx.x == 0 && threadIdx.x == 0) {
+    *scale = s;
+  }
+  float inv_scale = 1.0f / s;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    dst[i] = __nv_fp8_e4m3(LoadFloat(src + i) * inv_scale);
+  }
+}
+
+template <typename T>
+void LaunchQuantize(const T* src, __nv_fp8_e4m3* dst, int64_t n, float* amax, float* scale,
+                    cudaStream_t stream) {
+  int blocks = static_cast<int>(std::min<int64_t>((n + kBlockSize - 1) / kBlockSize, kMaxBlocks));
+  blocks = std::max(blocks, 1);
+  CUDA_CALL(cudaMemsetAsync(amax, 0, sizeof(float), stream));
+  AbsMaxKernel<T><<<blocks, kBlockSize, 0, stream>>>(src, n, amax);
+  QuantizeKernel<T><<<blocks, kBlockSize, 0, stream>>>(src, dst, n, amax, scale);
+}
+
+}  // namespace
+
+void fp8_quantize_cuda(const void* src, void* dst, int64_t n, bool bf16, float* amax, float* scale,
+                       void* stream) {
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  __nv_fp8_e4m3* out = static_cast<__nv_fp8_e4m3*>(dst);
+  if (bf16) {
+    LaunchQuantize(static_cast<const __nv_bfloat16*>(src), out, n, amax, scale, cuda_stream);
+  } else {
+    LaunchQuantize(static_cast<const __half*>(src), out, n, amax, scale, cuda_stream);
+  }
+}
+
+#else
+
+void fp8_quantize_cuda(const void* src, void* dst, int64_t n, bool bf16, float* amax, float* scale,
+                       void* stream) {
+  LOG(FATAL) << "fp8 requires CUDA 11.8 or later";
+}
+
+#endif
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
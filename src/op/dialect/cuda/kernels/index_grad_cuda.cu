@@ -0,0 +1,203 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/index_grad_cuda.cu
+ * \brief The backward of the indexing ops, which scatter-add the rows of dy to the indexed rows
+ * of dx, either by atomics or by sorting the indices and reducing the segments.
+ */
+#include <type_traits>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kThreadsPerBlock = 256;
+static const int kMaxBlocksPerSegment = 64;
+
+/*! \brief Normalize the indices of take to the rows by the mode, i.e., 0: clip, 1: wrap. */
+template <typename I>
+__global__ void TakeKeysKernel(const I* __restrict__ indices, int64_t n, int64_t rows, int mode,
+                               int64_t* __restrict__ keys) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    int64_t index = static_cast<int64_t>(indices[i]);
+    if (mode == 0) {
+      index = min(max(index, int64_t(0)), rows - 1);
+    } else {
+      index = (index % rows + rows) % rows;
+    }
+    keys[i] = index;
+  }
+}
+
+/*! \brief The rows of gather_nd, where indices of (m, n) index the first m dims of the data. */
+template <typename I>
+__global__ void GatherNdKeysKernel(const I* __restrict__ indices, int64_t n, IndexShape shape,
+                                   int64_t* __restrict__ keys) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    int64_t key = 0;
+    for (int m = 0; m < shape.ndim; ++m) {
+      key = key * shape.dims[m] + static_cast<int64_t>(indices[m * n + i]);
+    }
+    keys[i] = key;
+  }
+}
+
+/*!
+ * \brief The flattened positions in the data of gather along the axis, where the element of dy
+ * at the coords in the shape of the indices goes to the coords with the index at the axis.
+ */
+template <typename I>
+__global__ void GatherKeysKernel(const I* __restrict__ indices, int64_t n, IndexShape index_shape,
+                                 IndexShape data_shape, int axis, int64_t* __restrict__ keys) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i >= n) {
+    return;
+  }
+  int64_t rest = i, key = 0, stride = 1;
+  for (int d = index_shape.ndim - 1; d >= 0; --d) {
+    int64_t coord = rest % index_shape.dims[d];
+    rest /= index_shape.dims[d];
+    if (d == axis) {
+      coord = static_cast<int64_t>(indices[i]);
+      coord = coord < 0 ? coord + data_shape.dims[d] : coord;
+    }
+    key += coord * stride;
+    stride *= data_shape.dims[d];
+  }
+  keys[i] = key;
+}
+
+/*! \brief Each thread adds an element of dy of (outer, n, inner) to dx of (outer, rows, inner). */
+__global__ void AtomicIndexAddKernel(const float* __restrict__ dy,
+                                     const int64_t* __restrict__ keys, int64_t outer, int64_t n,
+                                     int64_t rows, int64_t inner, float* __restrict__ dx) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i >= outer * n * inner) {
+    return;
+  }
+  int64_t f = i % inner;
+  int64_t j = i / inner % n;
+  int64_t o = i / inner / n;
+  atomicAdd(dx + (o * rows + keys[j]) * inner + f, dy[i]);
+}
+
+/*!
+ * \brief The block x starts at the sorted position x, and only the starts of the segments sum the
+ * rows of dy of their segments in the original order, so the sums are deterministic.
+ */
+template <typename T>
+__global__ void SegmentIndexAddKernel(const T* __restrict__ dy, const int64_t* __restrict__ keys,
+                                      const int64_t* __restrict__ order, int64_t outer, int64_t n,
+                                      int64_t rows, int64_t inner, T* __restrict__ dx) {
+  int64_t i = blockIdx.x;
+  int64_t key = keys[i];
+  if (i > 0 && keys[i - 1] == key) {
+    return;
+  }
+  int64_t size = outer * inner;
+  for (int64_t t = blockIdx.y * static_cast<int64_t>(blockDim.x) + threadIdx.x; t < size;
+       t += static_cast<int64_t>(blockDim.x) * gridDim.y) {
+    int64_t o = t / inner, f = t % inner;
+    float acc = 0.0f;
+    for (int64_t j = i; j < n && keys[j] == key; ++j) {
+      acc += static_cast<float>(dy[(o * n + order[j]) * inner + f]);
+    }
+    dx[(o * rows + key) * inner + f] = static_cast<T>(acc);
+  }
+}
+
+template <typename I>
+void take_keys_cuda(const I* indices, int64_t n, int64_t rows, int mode, int64_t* keys,
+                    void* stream) {
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>((n + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  TakeKeysKernel<I>
+      <<<blocks, kThreadsPerBlock, 0, static_cast<cudaStream_t>(stream)>>>(indices, n, rows, mode,
+                                                                           keys);
+}
+
+template <typename I>
+void gather_nd_keys_cuda(const I* indices, int64_t n, const IndexShape& shape, int64_t* keys,
+                         void* stream) {
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>((n + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  GatherNdKeysKernel<I>
+      <<<blocks, kThreadsPerBlock, 0, static_cast<cudaStream_t>(stream)>>>(indices, n, shape,
+                                                                           keys);
+}
+
+template <typename I>
+void gather_keys_cuda(const I* indices, int64_t n, const IndexShape& index_shape,
+                      const IndexShape& data_shape, int axis, int64_t* keys, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>((n + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  GatherKeysKernel<I><<<blocks, kThreadsPerBlock, 0, static_cast<cudaStream_t>(stream)>>>(
+      indices, n, index_shape, data_shape, axis, keys);
+}
+
+size_t index_add_workspace_cuda(int64_t n, bool sorted) {
+  if (!sorted) {
+    return 0;
+  }
+  size_t sort_bytes = sort_pairs_workspace_cuda<int64_t, int64_t>(1, n, true);
+  return 2 * n * sizeof(int64_t) + (sort_bytes + 255) / 256 * 256;
+}
+
+template <typename T>
+void index_add_cuda(const T* dy, const int64_t* keys, int64_t outer, int64_t n, int64_t rows,
+                    int64_t inner, bool sorted, void* workspace, T* dx, void* stream) {
+  auto s = static_cast<cudaStream_t>(stream);
+  CUDA_CALL(cudaMemsetAsync(dx, 0, outer * rows * inner * sizeof(T), s));
+  if (outer * n * inner == 0) {
+    return;
+  }
+  if (!sorted) {
+    CHECK((std::is_same<T, float>::value)) << "Only float32 is scatter-added by atomics";
+    int64_t total = outer * n * inner;
+    int blocks = static_cast<int>((total + kThreadsPerBlock - 1) / kThreadsPerBlock);
+    AtomicIndexAddKernel<<<blocks, kThreadsPerBlock, 0, s>>>(
+        reinterpret_cast<const float*>(dy), keys, outer, n, rows, inner,
+        reinterpret_cast<float*>(dx));
+    return;
+  }
+  auto sorted_keys = static_cast<int64_t*>(workspace);
+  int64_t* order = sorted_keys + n;
+  void* sort_workspace = order + n;
+  sort_pairs_cuda<int64_t, int64_t>(keys, 1, n, n, true, sorted_keys, order, sort_workspace, s);
+  int64_t size = outer * inner;
+  int64_t blocks_per_segment = (size + kThreadsPerBlock - 1) / kThreadsPerBlock;
+  dim3 grid(n, min(blocks_per_segment, static_cast<int64_t>(kMaxBlocksPerSegment)));
+  SegmentIndexAddKernel<T>
+      <<<grid, kThreadsPerBlock, 0, s>>>(dy, sorted_keys, order, outer, n, rows, inner, dx);
+}
+
+template void take_keys_cuda<int32_t>(const int32_t*, int64_t, int64_t, int, int64_t*, void*);
+template void take_keys_cuda<int64_t>(const int64_t*, int64_t, int64_t, int, int64_t*, void*);
+template void gather_nd_keys_cuda<int32_t>(const int32_t*, int64_t, const IndexShape&, int64_t*,
+                                           void*);
+template void gather_nd_keys_cuda<int64_t>(const int64_t*, int64_t, const IndexShape&, int64_t*,
+                                           void*);
+template void gather_keys_cuda<int32_t>(const int32_t*, int64_t, const IndexShape&,
+                                        const IndexShape&, int, int64_t*, void*);
+template void gather_keys_cuda<int64_t>(const int64_t*, int64_t, const IndexShape&,
+                                        const IndexShape&, int, int64_t*, void*);
+template void index_add_cuda<float>(const float*, const int64_t*, int64_t, int64_t, int64_t,
+                                    int64_t, bool, void*, float*, void*);
+template void index_add_cuda<__half>(const __half*, const int64_t*, int64_t, int64_t, int64_t,
+                                     int64_t, bool, void*, __half*, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -22,6 +22,106 @@ void embedding_dense_backward_cuda(const scalar_t* grad, accscalar_t* output,
                                    const int64_t* indices, int num, int range,
                                    int stride, void* stream, int64_t element);
 
+/*!
+ * \brief The row-sparse gradient of embedding. The n indices are sorted with their positions, and
+ * the rows of grad of each segment of the same index are summed into the next of the n output
+ * (rows, values). The remaining rows are -1 with zero values, and negative indices are ignored.
+ * The workspace keys, order and segments have n elements.
+ */
+template <typename T>
+void embedding_sparse_backward_cuda(const T* grad, const int64_t* indices, int64_t n, int stride,
+                                    int64_t* keys, int64_t* order, int64_t* segments,
+                                    int64_t* rows, T* values, void* stream);
+
+/*!
+ * \brief SGD of the unique rows of a row-sparse gradient in place: v = mu * v + values and
+ * x -= lr * v for each row, where the rows of -1 are skipped.
+ */
+void sparse_sgd_cuda(const int64_t* rows, const float* values, int64_t nrows, int stride, float lr,
+                     float mu, float* v, float* x, void* stream);
+
+/*!
+ * \brief Write v of (outer, seq, dim) into the cache of (outer, max_len, dim) at the positions
+ * along the max_len axis in place, where the row r of outer is at pos[r / rows_per_pos] on the
+ * device. The steps beyond max_len are dropped. The elements are copied as elem_bytes bits.
+ */
+void kv_append_cuda(const void* v, const int64_t* pos, int64_t outer, int seq, int dim,
+                    int64_t max_len, int64_t rows_per_pos, int elem_bytes, void* cache,
+                    void* stream);
+
+/*!
+ * \brief Write v of (batch, heads, seq, dim) into the paged cache of (num_blocks, heads,
+ * block_size, dim) in place, where the step s of the sequence b goes to the token t = pos[b] + s,
+ * i.e., the slot t % block_size of the block block_table[b * max_blocks + t / block_size]. The
+ * steps beyond the blocks of the table are dropped.
+ */
+void paged_kv_append_cuda(const void* v, const int64_t* block_table, const int64_t* pos,
+                          int batch, int heads, int seq, int dim, int block_size, int max_blocks,
+                          int elem_bytes, void* cache, void* stream);
+
+/*!
+ * \brief The softmax stats of the n rows of the logits of (n, v) in one pass: the max, the sum of
+ * exp(x - max), and the logit of the label, which is 0 if the label is not in [vocab_start,
+ * vocab_start + v), i.e., in another shard of the vocab.
+ */
+template <typename T>
+void cross_entropy_stats_cuda(const T* logits, const int64_t* labels, int64_t n, int64_t v,
+                              int64_t vocab_start, float* max, float* sum, float* target,
+                              void* stream);
+
+/*! \brief Rescale the sums of the stats of local_max to the sums of the stats of max in place. */
+void cross_entropy_rescale_cuda(const float* local_max, const float* max, int64_t n, float* sum,
+                                void* stream);
+
+/*! \brief The loss, i.e., the mean over the n rows of log(sum) + max - target. */
+template <typename T>
+void cross_entropy_loss_cuda(const float* max, const float* sum, const float* target, int64_t n,
+                             T* loss, void* stream);
+
+/*!
+ * \brief The gradient of the loss to the logits of (n, v), i.e., (softmax(x) - onehot(label)) *
+ * dy / n, where the softmax is recomputed from the stats.
+ */
+template <typename T>
+void cross_entropy_dx_cuda(const T* dy, const T* logits, const int64_t* labels, const float* max,
+                           const float* sum, int64_t n, int64_t v, int64_t vocab_start, T* dx,
+                           void* stream);
+
+/*!
+ * \brief The per-channel stats of x of (outer, c, inner) in one pass: the sums of x and x * x at
+ * stats[0:2c], and if dy is given, the sums of dy and dy * x at stats[2c:4c]. The number of the
+ * elements of a channel follows, so summing the stats of the ranks gives the global stats.
+ */
+template <typename T>
+void batch_norm_reduce_cuda(const T* x, const T* dy, int64_t outer, int64_t c, int64_t inner,
+                            float* stats, void* stream);
+
+/*!
+ * \brief The mean and the inverse std of the channels from the stats of x into mean_invstd of 2c.
+ * The running stats are updated in place if they are given.
+ */
+void batch_norm_forward_finalize_cuda(const float* stats, int64_t c, float eps, float momentum,
+                                      float* running_mean, float* running_var,
+                                      float* mean_invstd, void* stream);
+
+/*! \brief Normalize x of (outer, c, inner) into y, where w and b are optional. */
+template <typename T>
+void batch_norm_forward_apply_cuda(const T* x, const float* mean_invstd, const float* w,
+                                   const float* b, int64_t outer, int64_t c, int64_t inner, T* y,
+                                   void* stream);
+
+/*!
+ * \brief The coefficients of 4c of the gradient of x from the global stats of x and dy, and the
+ * gradients of w and b from the local stats, which are skipped if they are nullptr.
+ */
+void batch_norm_backward_finalize_cuda(const float* global, const float* local, int64_t c,
+                                       float eps, float* coefs, float* dw, float* db, void* stream);
+
+/*! \brief The gradient of x of (outer, c, inner) with the coefficients, where w is optional. */
+template <typename T>
+void batch_norm_backward_apply_cuda(const T* dy, const T* x, const float* coefs, const float* w,
+                                    int64_t outer, int64_t c, int64_t inner, T* dx, void* stream);
+
 template <typename T>
 void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const float lr,
                             const float beta1, const float beta2, const float epsilon,
@@ -31,7 +131,343 @@ void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const
                             const bool normalize_grad, const std::vector<int> numels, void* stream,
                             float* output_per_tensor, float* grad_norm_tensor,
                             float* param_norm_tensor, float* update_m_norm, float* q_norm_tensor,
-                            int max_chunks_per_tensor);
+                            int max_chunks_per_tensor, bool quantize_states);
+
+/*!
+ * \brief The number of elements sharing the scales of the 8-bit optimizer states. It divides the
+ * chunk sizes of the multi-tensor optimizers, so a block never spans two chunks. The scales of a
+ * tensor of n elements are the absmax of the first moment of each of its ceil(n / 2048) blocks,
+ * followed by those of the second moment.
+ */
+constexpr int kStateBlockSize = 2048;
+
+/*! \brief The hyper-parameters of an Adam step. */
+struct AdamParams {
+  float lr;
+  float beta1;
+  float beta2;
+  float eps;
+  float weight_decay;
+  /*! \brief Whether to divide the moments by 1 - beta^step. */
+  bool bias_correction;
+  /*! \brief The step on the device, which is read by the kernels to avoid a host sync. */
+  const float* step;
+  /*! \brief The gradients are multiplied by this to undo the static loss scaling. */
+  float inv_grad_scale;
+  /*! \brief The dynamic loss scaler on the device, or nullptr for the static loss scaling. */
+  float* loss_scaler;
+  /*! \brief Decouple the weight decay from the gradients (AdamW) instead of L2 (Adam). */
+  bool adamw;
+  /*! \brief Whether the moments are 8-bit, with their scales as the last group. */
+  bool quantize_states;
+};
+
+/*!
+ * \brief Adam step of a list of tensors in as few launches as possible. tensor_lists holds the
+ * gradients (of grad_dtype), the fp32 weights and the fp32 moments m and v, each of the numels
+ * sizes. If copy_dtype has bits, a 5th group of weight copies of copy_dtype is also updated,
+ * e.g., the half-precision model weights of the fp32 master weights.
+ *
+ * If params.quantize_states is true, m is int8 and v is uint8, and the last group holds the
+ * scales of each tensor, see kStateBlockSize. The moments are dequantized by block in the kernel,
+ * and quantized again by the absmax of their new values, whose magnitudes are 8-bit logarithmic
+ * codes of 12 steps per octave below the absmax.
+ *
+ * If params.loss_scaler is given, it holds 4 floats: the loss scale, the number of the finite
+ * steps since the last change of the scale, the number of the skipped steps, and whether the
+ * gradients of the last step have inf or nan. The gradients are checked on the device, and the
+ * step is skipped if any of them is not finite, in which case the scale is halved. Otherwise the
+ * scale is doubled after scale_window finite steps. The skipped steps are excluded from the step
+ * of the bias correction.
+ */
+void multi_tensor_adam_cuda(int chunk_size, const std::vector<void*>& tensor_lists,
+                            const std::vector<int>& numels, DLDataType grad_dtype,
+                            DLDataType copy_dtype, const AdamParams& params, int scale_window,
+                            void* stream);
+
+/*! \brief Whether the multi-tensor ops have the kernels of dtype, i.e., float32, float16, bf16. */
+bool multi_tensor_dtype_supported(DLDataType dtype);
+
+/*!
+ * \brief Scale a list of tensors in one launch per up to a few hundreds of chunks. tensor_lists
+ * holds the inputs of in_dtype followed by the outputs of out_dtype, each of the numels sizes.
+ * A scale of 0 writes zeros. If norm is given, it is the global norm on the device, and the
+ * tensors are further scaled by min(1, max_norm / (norm + eps)), i.e., clipped by the norm.
+ */
+void multi_tensor_scale_cuda(int chunk_size, const std::vector<void*>& tensor_lists,
+                             const std::vector<int>& numels, DLDataType in_dtype,
+                             DLDataType out_dtype, float scale, const float* norm, float max_norm,
+                             float eps, void* stream);
+
+/*!
+ * \brief The L2 norm of all the tensors of the list into norm on the device. The workspace
+ * partials has max_chunks_per_tensor floats per tensor, so the sum is deterministic.
+ */
+void multi_tensor_global_norm_cuda(int chunk_size, const std::vector<void*>& tensor_list,
+                                   const std::vector<int>& numels, DLDataType dtype,
+                                   float* partials, int max_chunks_per_tensor, float* norm,
+                                   void* stream);
+
+/*! \brief Cast n floats to half (or bfloat16 if bf16 is true) into dst. */
+void compress_float_cuda(const float* src, void* dst, int64_t n, bool bf16, void* stream);
+
+/*! \brief Cast n halves (or bfloat16s if bf16 is true) back to floats into dst. */
+void decompress_float_cuda(const void* src, float* dst, int64_t n, bool bf16, void* stream);
+
+/*!
+ * \brief Top-k sparsification with error feedback. The gradient is accumulated into the residual,
+ * and the k elements of the largest magnitude are taken out of the residual into (indices,
+ * values). The workspace keys and sorted_indices have n elements.
+ */
+void topk_compress_cuda(const float* grad, float* residual, int64_t n, int64_t k, float* keys,
+                        int* sorted_indices, int* indices, float* values, void* stream);
+
+/*! \brief Scatter the nnz scaled (indices, values) into the zero-initialized dense out. */
+void scatter_add_cuda(const int* indices, const float* values, int64_t nnz, float scale,
+                      float* out, int64_t n, void* stream);
+
+/*!
+ * \brief Quantize n halves (or bfloat16s if bf16 is true) to fp8 e4m3 in dst with a per-tensor
+ * scale. The absolute maximum is reduced into amax, and the dequantization scale, i.e., amax
+ * over the largest e4m3 value, is written to scale, all on the device.
+ */
+void fp8_quantize_cuda(const void* src, void* dst, int64_t n, bool bf16, float* amax, float* scale,
+                       void* stream);
+
+/*!
+ * \brief The bytes of the workspace of sort_pairs_cuda to sort num_segments contiguous segments
+ * of len keys.
+ */
+template <typename K, typename I>
+size_t sort_pairs_workspace_cuda(int64_t num_segments, int64_t len, bool ascend);
+
+/*!
+ * \brief Sort each of the num_segments contiguous segments of len keys by radix sort, and write
+ * the first k sorted keys and their positions in the segment to (num_segments, k) out_keys and
+ * out_indices, either of which may be nullptr.
+ */
+template <typename K, typename I>
+void sort_pairs_cuda(const K* keys, int64_t num_segments, int64_t len, int64_t k, bool ascend,
+                     K* out_keys, I* out_indices, void* workspace, void* stream);
+
+/*!
+ * \brief Compact the boxes of data of (batch, n, elem_len) whose scores are above the threshold,
+ * and whose class ids are non-negative if id_index >= 0, to the front of out in their order. The
+ * remaining rows are -1, and out_indices of (batch, n) are their positions or -1.
+ */
+void get_valid_counts_cuda(const float* data, int batch, int64_t n, int elem_len,
+                           float score_threshold, int id_index, int score_index,
+                           int32_t* valid_count, float* out, int32_t* out_indices, void* stream);
+
+/*! \brief The attributes of non-maximum suppression. */
+struct NMSConfig {
+  int64_t top_k;
+  int coord_start;
+  int score_index;
+  int id_index;
+  bool force_suppress;
+  bool return_indices;
+  bool invalid_to_bottom;
+};
+
+/*! \brief The bytes of the workspace of nms_cuda. */
+size_t nms_workspace_cuda(int batch, int64_t n, int elem_len);
+
+/*! \brief The max number of boxes of a batch supported by nms_cuda. */
+size_t nms_max_boxes_cuda();
+
+/*!
+ * \brief Batched non-maximum suppression of data of (batch, n, elem_len). The first valid_count
+ * boxes of each batch are sorted by the scores, capped by top_k, and the pairwise suppressions
+ * are computed as bitmasks, which are reduced greedily on the device. The max output size and
+ * the IoU threshold are read on the device if their pointers are given. The outputs are either
+ * the sorted boxes in out, or the original indices of the kept boxes in box_indices of (batch, n)
+ * and their number in valid_box_count of (batch, 1).
+ */
+void nms_cuda(const float* data, const int32_t* valid_count, const int32_t* indices,
+              const int32_t* max_output_size_ptr, int32_t max_output_size,
+              const float* iou_threshold_ptr, float iou_threshold, int batch, int64_t n,
+              int elem_len, const NMSConfig& config, float* out, int32_t* box_indices,
+              int32_t* valid_box_count, void* workspace, void* stream);
+
+/*! \brief A shape of at most 8 dims passed to the kernels by value. */
+struct IndexShape {
+  static const int kMaxDims = 8;
+  int ndim;
+  int64_t dims[kMaxDims];
+};
+
+/*! \brief The rows of dx indexed by take, where mode 0 clips the indices and 1 wraps them. */
+template <typename I>
+void take_keys_cuda(const I* indices, int64_t n, int64_t rows, int mode, int64_t* keys,
+                    void* stream);
+
+/*! \brief The rows of dx indexed by gather_nd, i.e., of the first shape.ndim dims. */
+template <typename I>
+void gather_nd_keys_cuda(const I* indices, int64_t n, const IndexShape& shape, int64_t* keys,
+                         void* stream);
+
+/*! \brief The flattened positions in dx of the n elements indexed by gather along the axis. */
+template <typename I>
+void gather_keys_cuda(const I* indices, int64_t n, const IndexShape& index_shape,
+                      const IndexShape& data_shape, int axis, int64_t* keys, void* stream);
+
+/*! \brief The bytes of the workspace of index_add_cuda. */
+size_t index_add_workspace_cuda(int64_t n, bool sorted);
+
+/*!
+ * \brief Zero dx of (outer, rows, inner) and add the n rows of dy of (outer, n, inner) to the
+ * rows given by the keys. The rows are added by atomics, which only supports float32, or if
+ * sorted is true, by sorting the keys and reducing each segment of the same key in the order of
+ * the rows, which is deterministic and free of contention under heavy collisions.
+ */
+template <typename T>
+void index_add_cuda(const T* dy, const int64_t* keys, int64_t outer, int64_t n, int64_t rows,
+                    int64_t inner, bool sorted, void* workspace, T* dx, void* stream);
+
+/*!
+ * \brief A copy of rows of row_bytes from src to dst, whose rows are src_stride and dst_stride
+ * bytes apart, e.g., an input of concatenate along an axis.
+ */
+struct CopySegment {
+  const void* src;
+  void* dst;
+  int64_t rows;
+  int64_t row_bytes;
+  int64_t src_stride;
+  int64_t dst_stride;
+};
+
+/*!
+ * \brief Copy all the segments in one launch per up to dozens of segments, which loads and stores
+ * 16 bytes at a time if all the pointers, the row bytes and the strides of a launch are aligned.
+ */
+void multi_tensor_copy_cuda(const std::vector<CopySegment>& segments, void* stream);
+
+/*! \brief The numerics of the tensors checked in a step, accumulated on the device. */
+struct NumericsRecord {
+  /*! \brief The number of the non-finite elements, i.e., NaNs and Infs. */
+  unsigned long long num_nonfinite;
+  /*! \brief The tag of the first tensor with non-finite elements plus 1, or 0 if none. */
+  unsigned long long first_tag;
+  /*! \brief The absolute maximum of the finite elements. */
+  float abs_max;
+};
+
+/*!
+ * \brief Check the n floats, halves or bfloat16s of data for the non-finite elements and reduce
+ * their absolute maximum into the record, where tag identifies the tensor, e.g., by the pc.
+ */
+void check_numerics_cuda(const void* data, int64_t n, DLDataType dtype, uint64_t tag,
+                         NumericsRecord* record, void* stream);
+
+/*! \brief The ops of the precompiled elementwise kernels. */
+enum class ElementwiseOp : int {
+  kAdd,
+  kSubtract,
+  kMultiply,
+  kDivide,
+  kMaximum,
+  kMinimum,
+  kCopy,
+  kAbs,
+  kNegative,
+  kRelu,
+  kSigmoid,
+  kTanh,
+  kExp,
+  kLog,
+  kSqrt,
+  kRsqrt,
+};
+
+/*! \brief The max number of the dims of the broadcast elementwise kernels. */
+constexpr int kElementwiseMaxDims = 6;
+
+/*!
+ * \brief The layout of a broadcast binary op, where the strides of the dims broadcast from 1 are
+ * 0. The output is compact.
+ */
+struct ElementwiseBroadcast {
+  int ndim;
+  int64_t out_strides[kElementwiseMaxDims];
+  int64_t x1_strides[kElementwiseMaxDims];
+  int64_t x2_strides[kElementwiseMaxDims];
+};
+
+/*! \brief Whether the elementwise kernels are instantiated for dtype: float32, float16 or bf16. */
+bool elementwise_dtype_supported(DLDataType dtype);
+
+/*!
+ * \brief y = op(x) of the n elements, which loads and stores 16 bytes at a time if the pointers are
+ * aligned.
+ */
+void elementwise_unary_cuda(ElementwiseOp op, const void* x, void* y, int64_t n, DLDataType dtype,
+                            void* stream);
+
+/*!
+ * \brief y = op(x1, x2) of the n elements of y. The inputs are of the shape of y if bcast is null,
+ * which loads and stores 16 bytes at a time if the pointers are aligned, or broadcast otherwise.
+ */
+void elementwise_binary_cuda(ElementwiseOp op, const void* x1, const void* x2, void* y, int64_t n,
+                             DLDataType dtype, const ElementwiseBroadcast* bcast, void* stream);
+
+/*! \brief Cast the n elements of x to y, where both dtypes are supported by the kernels. */
+void elementwise_cast_cuda(const void* x, DLDataType x_dtype, void* y, DLDataType y_dtype,
+                           int64_t n, void* stream);
+
+/*!
+ * \brief The block layout of a block-sparse matrix of rows x cols blocks on the device, whose nnz
+ * non-zero blocks of block x block are numbered in the row-major order.
+ */
+struct BlockSparseTable {
+  int64_t rows;
+  int64_t cols;
+  int64_t nnz;
+  int block;
+  /*! \brief The block row and the block col of each non-zero block. */
+  const int* block_rows;
+  const int* block_cols;
+  /*! \brief The first non-zero block of each block row, with the end of the last row. */
+  const int* row_ptr;
+  /*!
+   * \brief The non-zero blocks in the col-major order, and the first one of each block col in it,
+   * with the end of the last col.
+   */
+  const int* col_blocks;
+  const int* col_ptr;
+};
+
+/*! \brief Whether the block-sparse kernels are instantiated for the block size. */
+bool block_sparse_block_supported(int64_t block);
+
+/*!
+ * \brief The non-zero blocks of x1 * x2^T of (batch, nnz, block, block), where x1 is of
+ * (batch, rows * block, k) and x2 is of (batch, cols * block, k).
+ */
+void block_sparse_sdd_cuda(const void* x1, const void* x2, void* out,
+                           const BlockSparseTable& table, int64_t batch, int64_t k,
+                           DLDataType dtype, void* stream);
+
+/*!
+ * \brief The dense a * x, or a^T * x if transpose_a, where a is the block-sparse matrix of
+ * (batch, nnz, block, block) and x is of (batch, r, k) with the matching inner dim r.
+ */
+void block_sparse_dsd_cuda(const void* a, const void* x, void* out, const BlockSparseTable& table,
+                           bool transpose_a, int64_t batch, int64_t k, DLDataType dtype,
+                           void* stream);
+
+/*!
+ * \brief The softmax of each row of the block-sparse x scaled by scale over its non-zero blocks,
+ * where the entries above the diagonal are also excluded if causal and get 0.
+ */
+void block_sparse_softmax_cuda(const void* x, void* y, const BlockSparseTable& table, float scale,
+                               bool causal, int64_t batch, DLDataType dtype, void* stream);
+
+/*! \brief The gradient of the block-sparse softmax, scale * y * (dy - sum(y * dy)) of each row. */
+void block_sparse_softmax_dx_cuda(const void* y, const void* dy, void* dx,
+                                  const BlockSparseTable& table, float scale, int64_t batch,
+                                  DLDataType dtype, void* stream);
 
 }  // namespace cuda
 }  // namespace op
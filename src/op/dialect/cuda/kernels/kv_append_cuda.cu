@@ -0,0 +1,134 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/kv_append_cuda.cu
+ * \brief The kernels appending the steps to the contiguous and the paged KV caches in place
+ */
+#include <algorithm>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kKvAppendThreads = 256;
+
+/*!
+ * \brief Each thread copies an element of v of (outer, seq, dim). The rows of outer are grouped
+ * by the batch, where a group of rows_per_pos rows shares a position.
+ */
+template <typename T>
+__global__ void KvAppendKernel(const T* __restrict__ v, const int64_t* __restrict__ pos,
+                               int64_t n, int seq, int dim, int64_t max_len, int64_t rows_per_pos,
+                               T* __restrict__ cache) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    int64_t d = i % dim;
+    int64_t s = (i / dim) % seq;
+    int64_t row = i / dim / seq;
+    int64_t t = pos[row / rows_per_pos] + s;
+    if (t >= 0 && t < max_len) {
+      cache[(row * max_len + t) * dim + d] = v[i];
+    }
+  }
+}
+
+void kv_append_cuda(const void* v, const int64_t* pos, int64_t outer, int seq, int dim,
+                    int64_t max_len, int64_t rows_per_pos, int elem_bytes, void* cache,
+                    void* stream) {
+  int64_t n = outer * seq * dim;
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>((n + kKvAppendThreads - 1) / kKvAppendThreads,
+                                                  65535));
+  auto s = static_cast<cudaStream_t>(stream);
+  // Only the bits are copied, so the kernels are per element size rather than per dtype.
+  switch (elem_bytes) {
+    case 1:
+      KvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint8_t*>(v), pos, n, seq, dim, max_len, rows_per_pos,
+          static_cast<uint8_t*>(cache));
+      break;
+    case 2:
+      KvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint16_t*>(v), pos, n, seq, dim, max_len, rows_per_pos,
+          static_cast<uint16_t*>(cache));
+      break;
+    case 4:
+      KvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint32_t*>(v), pos, n, seq, dim, max_len, rows_per_pos,
+          static_cast<uint32_t*>(cache));
+      break;
+    case 8:
+      KvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint64_t*>(v), pos, n, seq, dim, max_len, rows_per_pos,
+          static_cast<uint64_t*>(cache));
+      break;
+    default:
+      LOG(FATAL) << "Unsupported element size of kv_append: " << elem_bytes;
+  }
+}
+
+/*! \brief Each thread copies an element of v of (batch, heads, seq, dim) to its paged slot. */
+template <typename T>
+__global__ void PagedKvAppendKernel(const T* __restrict__ v, const int64_t* __restrict__ table,
+                                    const int64_t* __restrict__ pos, int64_t n, int heads, int seq,
+                                    int dim, int block_size, int max_blocks,
+                                    T* __restrict__ cache) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    int64_t c = i % dim;
+    int64_t s = (i / dim) % seq;
+    int64_t h = (i / dim / seq) % heads;
+    int64_t b = i / dim / seq / heads;
+    int64_t t = pos[b] + s;
+    if (t >= 0 && t < static_cast<int64_t>(max_blocks) * block_size) {
+      int64_t block = table[b * max_blocks + t / block_size];
+      cache[((block * heads + h) * block_size + t % block_size) * dim + c] = v[i];
+    }
+  }
+}
+
+void paged_kv_append_cuda(const void* v, const int64_t* block_table, const int64_t* pos,
+                          int batch, int heads, int seq, int dim, int block_size, int max_blocks,
+                          int elem_bytes, void* cache, void* stream) {
+  int64_t n = static_cast<int64_t>(batch) * heads * seq * dim;
+  if (n == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>((n + kKvAppendThreads - 1) / kKvAppendThreads,
+                                                  65535));
+  auto s = static_cast<cudaStream_t>(stream);
+  switch (elem_bytes) {
+    case 1:
+      PagedKvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint8_t*>(v), block_table, pos, n, heads, seq, dim, block_size,
+          max_blocks, static_cast<uint8_t*>(cache));
+      break;
+    case 2:
+      PagedKvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint16_t*>(v), block_table, pos, n, heads, seq, dim, block_size,
+          max_blocks, static_cast<uint16_t*>(cache));
+      break;
+    case 4:
+      PagedKvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint32_t*>(v), block_table, pos, n, heads, seq, dim, block_size,
+          max_blocks, static_cast<uint32_t*>(cache));
+      break;
+    case 8:
+      PagedKvAppendKernel<<<blocks, kKvAppendThreads, 0, s>>>(
+          static_cast<const uint64_t*>(v), block_table, pos, n, heads, seq, dim, block_size,
+          max_blocks, static_cast<uint64_t*>(cache));
+      break;
+    default:
+      LOG(FATAL) << "Unsupported element size of paged_kv_append: " << elem_bytes;
+  }
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -29,6 +29,33 @@ void HostLayerNormGradient(const V* dout, const float* mean, const float* invvar
                            V* grad_beta, float* part_gard_gamma, float* part_grad_beta,
                            void* stream, const uint64_t maxGridY);
 
+/*!
+ * \brief The fused sum = residual + dropout(x, p) and output = layer_norm(sum) over the last n2
+ * elements. The sum and the dropout mask (if p > 0) are kept for the backward.
+ */
+template <typename T>
+void HostApplyAddDropoutLayerNorm(T* output, float* mean, float* invvar, T* sum, uint8_t* mask,
+                                  const T* x, const T* residual, int n1, int n2, const T* gamma,
+                                  const T* beta, double epsilon, float p, uint64_t seed,
+                                  void* stream, const uint64_t maxGridY);
+
+/*! \brief The gradient of the dropout of n elements with the kept mask. */
+template <typename T>
+void HostDropoutGradient(const T* dsum, const uint8_t* mask, int64_t n, float p, T* dx,
+                         void* stream);
+
+/*!
+ * \brief The fused sum = word[word_ids] + pos[pos_ids] (+ token_type[token_type_ids]) and
+ * output = dropout(layer_norm(sum), p) over the n1 rows of n2 elements, where token_type is null
+ * if absent. The sum and the dropout mask (if p > 0) are kept for the backward.
+ */
+template <typename T, typename I>
+void HostApplyEmbeddingLayerNorm(T* output, float* mean, float* invvar, T* sum, uint8_t* mask,
+                                 const T* word, const I* word_ids, const T* pos, const I* pos_ids,
+                                 const T* token_type, const I* token_type_ids, int n1, int n2,
+                                 const T* gamma, const T* beta, double epsilon, float p,
+                                 uint64_t seed, void* stream, const uint64_t maxGridY);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
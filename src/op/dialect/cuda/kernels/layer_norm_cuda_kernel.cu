@@ -752,6 +752,336 @@ void HostLayerNormGradient(const V* dout, const float* mean, const float* invvar
                                                              float(epsilon), gamma, grad_input);
 }
 
+
+/*!
+ * \brief The uniform random number in [0, 1) of an element of the dropout. It is a hash
+ * (splitmix64) of the seed and the element index, so no random state is kept on the device.
+ */
+__device__ __forceinline__ float DropoutUniform(uint64_t seed, uint64_t idx) {
+  uint64_t z = seed + (idx + 1) * 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z ^= z >> 31;
+  return (z >> 40) * (1.f / 16777216.f);
+}
+
+template <typename T, int kVec>
+struct alignas(sizeof(T) * kVec) AlignedVector {
+  T val[kVec];
+};
+
+/*! \brief The maximum number of warps of a block in the fused add + dropout + layer_norm. */
+constexpr int kAddDropoutLayerNormMaxWarps = 8;
+
+/*!
+ * \brief The fused add + dropout + layer_norm over the rows of n2 elements, i.e.,
+ * sum = residual + dropout(x), output = layer_norm(sum). One block normalizes one row. Each thread
+ * loads kVec elements at a time and accumulates the row statistics with Welford's algorithm in
+ * the same pass, then the block merges the statistics of the threads.
+ */
+template <typename T, typename U, int kVec>
+__global__ void cuApplyAddDropoutLayerNorm(T* __restrict__ output, U* __restrict__ mean,
+                                           U* __restrict__ invvar, T* __restrict__ sum,
+                                           uint8_t* __restrict__ mask, const T* __restrict__ x,
+                                           const T* __restrict__ residual,
+                                           const T* __restrict__ gamma,
+                                           const T* __restrict__ beta, const int n1, const int n2,
+                                           const U epsilon, const float p, const uint64_t seed) {
+  using Vec = AlignedVector<T, kVec>;
+  __shared__ U s_mu[kAddDropoutLayerNormMaxWarps];
+  __shared__ U s_sigma2[kAddDropoutLayerNormMaxWarps];
+  __shared__ U s_count[kAddDropoutLayerNormMaxWarps];
+  const int numx = blockDim.x * blockDim.y;
+  const int thrx = threadIdx.x + threadIdx.y * blockDim.x;
+  const U scale = p > 0.f ? U(1) / U(1.f - p) : U(1);
+  for (auto i1 = blockIdx.y; i1 < n1; i1 += gridDim.y) {
+    const int64_t row = static_cast<int64_t>(i1) * n2;
+    U mu = U(0), sigma2 = U(0), count = U(0);
+    for (int l = kVec * thrx; l < n2; l += kVec * numx) {
+      Vec vx = *reinterpret_cast<const Vec*>(x + row + l);
+      Vec vr = *reinterpret_cast<const Vec*>(residual + row + l);
+      Vec vs;
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        U curr = static_cast<U>(vx.val[k]);
+        if (p > 0.f) {
+          bool keep = DropoutUniform(seed, row + l + k) >= p;
+          mask[row + l + k] = keep;
+          curr = keep ? curr * scale : U(0);
+        }
+        curr += static_cast<U>(vr.val[k]);
+        vs.val[k] = static_cast<T>(curr);
+        cuWelfordOnlineSum<U>(static_cast<U>(vs.val[k]), mu, sigma2, count);
+      }
+      *reinterpret_cast<Vec*>(sum + row + l) = vs;
+    }
+    // intra-warp reductions
+    for (int offset = 1; offset < blockDim.x; offset *= 2) {
+      U muB = WARP_SHFL_XOR(mu, offset);
+      U sigma2B = WARP_SHFL_XOR(sigma2, offset);
+      U countB = WARP_SHFL_XOR(count, offset);
+      cuChanOnlineSum<U>(muB, sigma2B, countB, mu, sigma2, count);
+    }
+    // inter-warp reductions
+    if (threadIdx.x == 0) {
+      s_mu[threadIdx.y] = mu;
+      s_sigma2[threadIdx.y] = sigma2;
+      s_count[threadIdx.y] = count;
+    }
+    __syncthreads();
+    mu = s_mu[0];
+    sigma2 = s_sigma2[0];
+    count = s_count[0];
+    for (int y = 1; y < blockDim.y; ++y) {
+      cuChanOnlineSum<U>(s_mu[y], s_sigma2[y], s_count[y], mu, sigma2, count);
+    }
+    U c_invvar = rsqrtf(sigma2 / U(n2) + epsilon);
+    // Each thread normalizes the elements it has summed, so no synchronization is needed.
+    for (int l = kVec * thrx; l < n2; l += kVec * numx) {
+      Vec vs = *reinterpret_cast<const Vec*>(sum + row + l);
+      Vec vg = *reinterpret_cast<const Vec*>(gamma + l);
+      Vec vb = *reinterpret_cast<const Vec*>(beta + l);
+      Vec vo;
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        U curr = c_invvar * (static_cast<U>(vs.val[k]) - mu);
+        vo.val[k] = static_cast<T>(static_cast<U>(vg.val[k]) * curr + static_cast<U>(vb.val[k]));
+      }
+      *reinterpret_cast<Vec*>(output + row + l) = vo;
+    }
+    if (threadIdx.x == 0 && threadIdx.y == 0) {
+      mean[i1] = mu;
+      invvar[i1] = c_invvar;
+    }
+    // prevent race where the shared statistics are written again before reads are done
+    __syncthreads();
+  }
+}
+
+/*!
+ * \brief The fused embedding + layer_norm + dropout over the rows of n2 elements. One block
+ * gathers the rows of the tables of the ids of one output row, sums them and accumulates the
+ * Welford statistics in one vectorized pass, then normalizes the sum and drops the output.
+ */
+template <typename T, typename I, typename U, int kVec>
+__global__ void cuApplyEmbeddingLayerNorm(
+    T* __restrict__ output, U* __restrict__ mean, U* __restrict__ invvar, T* __restrict__ sum,
+    uint8_t* __restrict__ mask, const T* __restrict__ word, const I* __restrict__ word_ids,
+    const T* __restrict__ pos, const I* __restrict__ pos_ids, const T* __restrict__ token_type,
+    const I* __restrict__ token_type_ids, const T* __restrict__ gamma, const T* __restrict__ beta,
+    const int n1, const int n2, const U epsilon, const float p, const uint64_t seed) {
+  using Vec = AlignedVector<T, kVec>;
+  __shared__ U s_mu[kAddDropoutLayerNormMaxWarps];
+  __shared__ U s_sigma2[kAddDropoutLayerNormMaxWarps];
+  __shared__ U s_count[kAddDropoutLayerNormMaxWarps];
+  const int numx = blockDim.x * blockDim.y;
+  const int thrx = threadIdx.x + threadIdx.y * blockDim.x;
+  const U scale = p > 0.f ? U(1) / U(1.f - p) : U(1);
+  for (auto i1 = blockIdx.y; i1 < n1; i1 += gridDim.y) {
+    const int64_t row = static_cast<int64_t>(i1) * n2;
+    const T* word_row = word + static_cast<int64_t>(word_ids[i1]) * n2;
+    const T* pos_row = pos + static_cast<int64_t>(pos_ids[i1]) * n2;
+    const T* type_row =
+        token_type ? token_type + static_cast<int64_t>(token_type_ids[i1]) * n2 : nullptr;
+    U mu = U(0), sigma2 = U(0), count = U(0);
+    for (int l = kVec * thrx; l < n2; l += kVec * numx) {
+      Vec vw = *reinterpret_cast<const Vec*>(word_row + l);
+      Vec vp = *reinterpret_cast<const Vec*>(pos_row + l);
+      Vec vt;
+      if (type_row) {
+        vt = *reinterpret_cast<const Vec*>(type_row + l);
+      }
+      Vec vs;
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        U curr = static_cast<U>(vw.val[k]) + static_cast<U>(vp.val[k]);
+        if (type_row) {
+          curr += static_cast<U>(vt.val[k]);
+        }
+        vs.val[k] = static_cast<T>(curr);
+        cuWelfordOnlineSum<U>(static_cast<U>(vs.val[k]), mu, sigma2, count);
+      }
+      *reinterpret_cast<Vec*>(sum + row + l) = vs;
+    }
+    // intra-warp reductions
+    for (int offset = 1; offset < blockDim.x; offset *= 2) {
+      U muB = WARP_SHFL_XOR(mu, offset);
+      U sigma2B = WARP_SHFL_XOR(sigma2, offset);
+      U countB = WARP_SHFL_XOR(count, offset);
+      cuChanOnlineSum<U>(muB, sigma2B, countB, mu, sigma2, count);
+    }
+    // inter-warp reductions
+    if (threadIdx.x == 0) {
+      s_mu[threadIdx.y] = mu;
+      s_sigma2[threadIdx.y] = sigma2;
+      s_count[threadIdx.y] = count;
+    }
+    __syncthreads();
+    mu = s_mu[0];
+    sigma2 = s_sigma2[0];
+    count = s_count[0];
+    for (int y = 1; y < blockDim.y; ++y) {
+      cuChanOnlineSum<U>(s_mu[y], s_sigma2[y], s_count[y], mu, sigma2, count);
+    }
+    U c_invvar = rsqrtf(sigma2 / U(n2) + epsilon);
+    // Each thread normalizes the elements it has summed, so no synchronization is needed.
+    for (int l = kVec * thrx; l < n2; l += kVec * numx) {
+      Vec vs = *reinterpret_cast<const Vec*>(sum + row + l);
+      Vec vg = *reinterpret_cast<const Vec*>(gamma + l);
+      Vec vb = *reinterpret_cast<const Vec*>(beta + l);
+      Vec vo;
+#pragma unroll
+      for (int k = 0; k < kVec; ++k) {
+        U curr = c_invvar * (static_cast<U>(vs.val[k]) - mu);
+        curr = static_cast<U>(vg.val[k]) * curr + static_cast<U>(vb.val[k]);
+        if (p > 0.f) {
+          bool keep = DropoutUniform(seed, row + l + k) >= p;
+          mask[row + l + k] = keep;
+          curr = keep ? curr * scale : U(0);
+        }
+        vo.val[k] = static_cast<T>(curr);
+      }
+      *reinterpret_cast<Vec*>(output + row + l) = vo;
+    }
+    if (threadIdx.x == 0 && threadIdx.y == 0) {
+      mean[i1] = mu;
+      invvar[i1] = c_invvar;
+    }
+    // prevent race where the shared statistics are written again before reads are done
+    __syncthreads();
+  }
+}
+
+/*! \brief The gradient of the dropout, i.e., dx = dsum * mask / (1 - p). */
+template <typename T>
+__global__ void cuDropoutGradient(const T* __restrict__ dsum, const uint8_t* __restrict__ mask,
+                                  const int64_t n, const float scale, T* __restrict__ dx) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; i < n;
+       i += static_cast<int64_t>(blockDim.x) * gridDim.x) {
+    dx[i] = mask[i] ? static_cast<T>(static_cast<float>(dsum[i]) * scale) : static_cast<T>(0.f);
+  }
+}
+
+/*! \brief Whether the pointer is aligned to the given number of bytes. */
+inline bool IsAligned(const void* ptr, size_t alignment) {
+  return ptr == nullptr || reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+template <typename T>
+void HostApplyAddDropoutLayerNorm(T* output, float* mean, float* invvar, T* sum, uint8_t* mask,
+                                  const T* x, const T* residual, int n1, int n2, const T* gamma,
+                                  const T* beta, double epsilon, float p, uint64_t seed,
+                                  void* stream, const uint64_t maxGridY) {
+  const dim3 threads(32, 4, 1);
+  const dim3 blocks(1, std::min((uint64_t)n1, maxGridY), 1);
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  // Load 16 bytes at a time if every row is aligned.
+  constexpr int kVec = 16 / sizeof(T);
+  const size_t bytes = kVec * sizeof(T);
+  bool vectorized = n2 % kVec == 0;
+  for (const void* ptr : {static_cast<const void*>(output), static_cast<const void*>(sum),
+                          static_cast<const void*>(x), static_cast<const void*>(residual),
+                          static_cast<const void*>(gamma), static_cast<const void*>(beta)}) {
+    vectorized = vectorized && IsAligned(ptr, bytes);
+  }
+  if (vectorized) {
+    cuApplyAddDropoutLayerNorm<T, float, kVec><<<blocks, threads, 0, s>>>(
+        output, mean, invvar, sum, mask, x, residual, gamma, beta, n1, n2, float(epsilon), p,
+        seed);
+  } else {
+    cuApplyAddDropoutLayerNorm<T, float, 1><<<blocks, threads, 0, s>>>(
+        output, mean, invvar, sum, mask, x, residual, gamma, beta, n1, n2, float(epsilon), p,
+        seed);
+  }
+}
+
+template <typename T>
+void HostDropoutGradient(const T* dsum, const uint8_t* mask, int64_t n, float p, T* dx,
+                         void* stream) {
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  if (p == 0.f) {
+    CUDA_CALL(cudaMemcpyAsync(dx, dsum, n * sizeof(T), cudaMemcpyDeviceToDevice, s));
+    return;
+  }
+  const int threads = 512;
+  const int blocks = static_cast<int>(std::min<int64_t>((n + threads - 1) / threads, 65535));
+  cuDropoutGradient<T><<<blocks, threads, 0, s>>>(dsum, mask, n, 1.f / (1.f - p), dx);
+}
+
+template <typename T, typename I>
+void HostApplyEmbeddingLayerNorm(T* output, float* mean, float* invvar, T* sum, uint8_t* mask,
+                                 const T* word, const I* word_ids, const T* pos, const I* pos_ids,
+                                 const T* token_type, const I* token_type_ids, int n1, int n2,
+                                 const T* gamma, const T* beta, double epsilon, float p,
+                                 uint64_t seed, void* stream, const uint64_t maxGridY) {
+  const dim3 threads(32, 4, 1);
+  const dim3 blocks(1, std::min((uint64_t)n1, maxGridY), 1);
+  cudaStream_t s = static_cast<cudaStream_t>(stream);
+  // Load 16 bytes at a time if every row is aligned.
+  constexpr int kVec = 16 / sizeof(T);
+  const size_t bytes = kVec * sizeof(T);
+  bool vectorized = n2 % kVec == 0;
+  for (const void* ptr : {static_cast<const void*>(output), static_cast<const void*>(sum),
+                          static_cast<const void*>(word), static_cast<const void*>(pos),
+                          static_cast<const void*>(token_type), static_cast<const void*>(gamma),
+                          static_cast<const void*>(beta)}) {
+    vectorized = vectorized && IsAligned(ptr, bytes);
+  }
+  if (vectorized) {
+    cuApplyEmbeddingLayerNorm<T, I, float, kVec><<<blocks, threads, 0, s>>>(
+        output, mean, invvar, sum, mask, word, word_ids, pos, pos_ids, token_type, token_type_ids,
+        gamma, beta, n1, n2, float(epsilon), p, seed);
+  } else {
+    cuApplyEmbeddingLayerNorm<T, I, float, 1><<<blocks, threads, 0, s>>>(
+        output, mean, invvar, sum, mask, word, word_ids, pos, pos_ids, token_type, token_type_ids,
+        gamma, beta, n1, n2, float(epsilon), p, seed);
+  }
+}
+
+template void HostApplyAddDropoutLayerNorm<Half>(Half* output, float* mean, float* invvar,
+                                                 Half* sum, uint8_t* mask, const Half* x,
+                                                 const Half* residual, int n1, int n2,
+                                                 const Half* gamma, const Half* beta,
+                                                 double epsilon, float p, uint64_t seed,
+                                                 void* stream, const uint64_t maxGridY);
+
+template void HostApplyAddDropoutLayerNorm<float>(float* output, float* mean, float* invvar,
+                                                  float* sum, uint8_t* mask, const float* x,
+                                                  const float* residual, int n1, int n2,
+                                                  const float* gamma, const float* beta,
+                                                  double epsilon, float p, uint64_t seed,
+                                                  void* stream, const uint64_t maxGridY);
+
+template void HostDropoutGradient<Half>(const Half* dsum, const uint8_t* mask, int64_t n, float p,
+                                        Half* dx, void* stream);
+
+template void HostDropoutGradient<float>(const float* dsum, const uint8_t* mask, int64_t n,
+                                         float p, float* dx, void* stream);
+
+template void HostApplyEmbeddingLayerNorm<Half, int64_t>(
+    Half* output, float* mean, float* invvar, Half* sum, uint8_t* mask, const Half* word,
+    const int64_t* word_ids, const Half* pos, const int64_t* pos_ids, const Half* token_type,
+    const int64_t* token_type_ids, int n1, int n2, const Half* gamma, const Half* beta,
+    double epsilon, float p, uint64_t seed, void* stream, const uint64_t maxGridY);
+
+template void HostApplyEmbeddingLayerNorm<Half, int32_t>(
+    Half* output, float* mean, float* invvar, Half* sum, uint8_t* mask, const Half* word,
+    const int32_t* word_ids, const Half* pos, const int32_t* pos_ids, const Half* token_type,
+    const int32_t* token_type_ids, int n1, int n2, const Half* gamma, const Half* beta,
+    double epsilon, float p, uint64_t seed, void* stream, const uint64_t maxGridY);
+
+template void HostApplyEmbeddingLayerNorm<float, int64_t>(
+    float* output, float* mean, float* invvar, float* sum, uint8_t* mask, const float* word,
+    const int64_t* word_ids, const float* pos, const int64_t* pos_ids, const float* token_type,
+    const int64_t* token_type_ids, int n1, int n2, const float* gamma, const float* beta,
+    double epsilon, float p, uint64_t seed, void* stream, const uint64_t maxGridY);
+
+template void HostApplyEmbeddingLayerNorm<float, int32_t>(
+    float* output, float* mean, float* invvar, float* sum, uint8_t* mask, const float* word,
+    const int32_t* word_ids, const float* pos, const int32_t* pos_ids, const float* token_type,
+    const int32_t* token_type_ids, int n1, int n2, const float* gamma, const float* beta,
+    double epsilon, float p, uint64_t seed, void* stream, const uint64_t maxGridY);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
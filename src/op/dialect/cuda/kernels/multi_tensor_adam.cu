@@ -0,0 +1,278 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_adam.cu
+ * \brief Multi-tensor Adam and AdamW cuda kernels. Each thread block updates a chunk of a tensor,
+ * so a launch covers the chunks of many tensors. The moments are optionally 8-bit.
+ */
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kBlockSize = 512;
+
+/*! \brief The indices of the states in the dynamic loss scaler. */
+constexpr int kScale = 0;
+constexpr int kFiniteSteps = 1;
+constexpr int kSkippedSteps = 2;
+constexpr int kFoundInf = 3;
+
+/*! \brief Flag the loss scaler if any gradient of a chunk is inf or nan. */
+template <typename G>
+struct CheckFiniteFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<1>& tl,
+                                             float* loss_scaler) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+    const G* g = static_cast<const G*>(tl.addresses[0][tensor_loc]) + offset;
+    bool finite = true;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+      finite = finite && isfinite(LoadFloat(g[i]));
+    }
+    if (!finite) {
+      loss_scaler[kFoundInf] = 1.0f;
+    }
+  }
+};
+
+__global__ void ResetLossScalerKernel(float* loss_scaler) {
+  loss_scaler[kFoundInf] = 0.0f;
+}
+
+/*! \brief Skip or count the step, and adjust the loss scale accordingly. */
+__global__ void UpdateLossScalerKernel(float* loss_scaler, int scale_window) {
+  if (loss_scaler[kFoundInf] != 0.0f) {
+    loss_scaler[kScale] = fmaxf(loss_scaler[kScale] * 0.5f, 1.0f);
+    loss_scaler[kFiniteSteps] = 0.0f;
+    loss_scaler[kSkippedSteps] += 1.0f;
+  } else if (loss_scaler[kFiniteSteps] + 1.0f >= scale_window) {
+    loss_scaler[kScale] *= 2.0f;
+    loss_scaler[kFiniteSteps] = 0.0f;
+  } else {
+    loss_scaler[kFiniteSteps] += 1.0f;
+  }
+}
+
+/*!
+ * \brief Adam step of a chunk. The addresses are the gradients of G, the fp32 weights, the fp32
+ * moments, and the weight copies of C when depth is 5.
+ */
+template <typename G, typename C, int depth>
+struct AdamFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<depth>& tl,
+                                             AdamParams params) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+    const G* g = static_cast<const G*>(tl.addresses[0][tensor_loc]) + offset;
+    float* w = static_cast<float*>(tl.addresses[1][tensor_loc]) + offset;
+    float* m = static_cast<float*>(tl.addresses[2][tensor_loc]) + offset;
+    float* v = static_cast<float*>(tl.addresses[3][tensor_loc]) + offset;
+    C* copy = nullptr;
+    if (depth == 5) {
+      copy = static_cast<C*>(tl.addresses[depth - 1][tensor_loc]) + offset;
+    }
+    float inv_grad_scale = params.inv_grad_scale;
+    float step = *params.step;
+    if (params.loss_scaler != nullptr) {
+      if (params.loss_scaler[kFoundInf] != 0.0f) {
+        return;
+      }
+      inv_grad_scale = 1.0f / params.loss_scaler[kScale];
+      step -= params.loss_scaler[kSkippedSteps];
+    }
+    float bias_correction1 = params.bias_correction ? 1.0f - powf(params.beta1, step) : 1.0f;
+    float bias_correction2 = params.bias_correction ? 1.0f - powf(params.beta2, step) : 1.0f;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+      float grad = LoadFloat(g[i]) * inv_grad_scale;
+      float weight = w[i];
+      if (!params.adamw) {
+        grad += params.weight_decay * weight;
+      }
+      float next_m = params.beta1 * m[i] + (1.0f - params.beta1) * grad;
+      float next_v = params.beta2 * v[i] + (1.0f - params.beta2) * grad * grad;
+      float update =
+          (next_m / bias_correction1) / (sqrtf(next_v / bias_correction2) + params.eps);
+      if (params.adamw) {
+        update += params.weight_decay * weight;
+      }
+      weight -= params.lr * update;
+      w[i] = weight;
+      m[i] = next_m;
+      v[i] = next_v;
+      if (depth == 5) {
+        StoreFloat(weight, copy + i);
+      }
+    }
+  }
+};
+
+/*!
+ * \brief Adam step of a chunk with the 8-bit moments. The addresses are the gradients of G, the
+ * fp32 weights, the int8 m, the uint8 v, the weight copies of C when depth is 6, and the scales.
+ * The threads of a block update a block of the states together, so the states are requantized
+ * by the absmax of their new values.
+ */
+template <typename G, typename C, int depth>
+struct Adam8bitFunctor {
+  static constexpr int kItems = kStateBlockSize / kBlockSize;
+
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<depth>& tl,
+                                             AdamParams params) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+    int nblocks = (tl.sizes[tensor_loc] + kStateBlockSize - 1) / kStateBlockSize;
+    const G* g = static_cast<const G*>(tl.addresses[0][tensor_loc]) + offset;
+    float* w = static_cast<float*>(tl.addresses[1][tensor_loc]) + offset;
+    int8_t* m = static_cast<int8_t*>(tl.addresses[2][tensor_loc]) + offset;
+    uint8_t* v = static_cast<uint8_t*>(tl.addresses[3][tensor_loc]) + offset;
+    C* copy = nullptr;
+    if (depth == 6) {
+      copy = static_cast<C*>(tl.addresses[4][tensor_loc]) + offset;
+    }
+    float* m_absmax = static_cast<float*>(tl.addresses[depth - 1][tensor_loc]) +
+                      offset / kStateBlockSize;
+    float* v_absmax = m_absmax + nblocks;
+    float inv_grad_scale = params.inv_grad_scale;
+    float step = *params.step;
+    if (params.loss_scaler != nullptr) {
+      if (params.loss_scaler[kFoundInf] != 0.0f) {
+        return;
+      }
+      inv_grad_scale = 1.0f / params.loss_scaler[kScale];
+      step -= params.loss_scaler[kSkippedSteps];
+    }
+    float bias_correction1 = params.bias_correction ? 1.0f - powf(params.beta1, step) : 1.0f;
+    float bias_correction2 = params.bias_correction ? 1.0f - powf(params.beta2, step) : 1.0f;
+    __shared__ float smem[kBlockSize / 32];
+    for (int start = 0, b = 0; start < n; start += kStateBlockSize, ++b) {
+      float prev_m_absmax = m_absmax[b];
+      float prev_v_absmax = v_absmax[b];
+      float next_m[kItems];
+      float next_v[kItems];
+      float next_m_absmax = 0.0f;
+      float next_v_absmax = 0.0f;
+#pragma unroll
+      for (int k = 0; k < kItems; ++k) {
+        int i = start + k * kBlockSize + threadIdx.x;
+        next_m[k] = 0.0f;
+        next_v[k] = 0.0f;
+        if (i >= n) {
+          continue;
+        }
+        float grad = LoadFloat(g[i]) * inv_grad_scale;
+        float weight = w[i];
+        if (!params.adamw) {
+          grad += params.weight_decay * weight;
+        }
+        next_m[k] = params.beta1 * DequantizeSignedState(m[i], prev_m_absmax) +
+                    (1.0f - params.beta1) * grad;
+        next_v[k] = params.beta2 * DequantizeUnsignedState(v[i], prev_v_absmax) +
+                    (1.0f - params.beta2) * grad * grad;
+        float update =
+            (next_m[k] / bias_correction1) / (sqrtf(next_v[k] / bias_correction2) + params.eps);
+        if (params.adamw) {
+          update += params.weight_decay * weight;
+        }
+        weight -= params.lr * update;
+        w[i] = weight;
+        if (depth == 6) {
+          StoreFloat(weight, copy + i);
+        }
+        next_m_absmax = fmaxf(next_m_absmax, fabsf(next_m[k]));
+        next_v_absmax = fmaxf(next_v_absmax, next_v[k]);
+      }
+      next_m_absmax = BlockMax(smem, next_m_absmax);
+      next_v_absmax = BlockMax(smem, next_v_absmax);
+#pragma unroll
+      for (int k = 0; k < kItems; ++k) {
+        int i = start + k * kBlockSize + threadIdx.x;
+        if (i < n) {
+          m[i] = QuantizeSignedState(next_m[k], next_m_absmax);
+          v[i] = QuantizeUnsignedState(next_v[k], next_v_absmax);
+        }
+      }
+      if (threadIdx.x == 0) {
+        m_absmax[b] = next_m_absmax;
+        v_absmax[b] = next_v_absmax;
+      }
+    }
+  }
+};
+
+template <typename G, typename C, int depth>
+void LaunchAdam(int chunk_size, const std::vector<void*>& tensor_lists,
+                const std::vector<int>& numels, const AdamParams& params, void* stream) {
+  if (params.loss_scaler != nullptr) {
+    // The gradients are the first group of the tensor lists.
+    multi_tensor_apply<1>(kBlockSize, chunk_size, tensor_lists, numels, stream,
+                          CheckFiniteFunctor<G>(), params.loss_scaler);
+  }
+  if (params.quantize_states) {
+    // The scales follow the other groups.
+    multi_tensor_apply<depth + 1>(kBlockSize, chunk_size, tensor_lists, numels, stream,
+                                  Adam8bitFunctor<G, C, depth + 1>(), params);
+  } else {
+    multi_tensor_apply<depth>(kBlockSize, chunk_size, tensor_lists, numels, stream,
+                              AdamFunctor<G, C, depth>(), params);
+  }
+}
+
+template <typename G>
+void DispatchCopyType(int chunk_size, const std::vector<void*>& tensor_lists,
+                      const std::vector<int>& numels, DLDataType copy_dtype,
+                      const AdamParams& params, void* stream) {
+  if (copy_dtype.bits == 0) {
+    LaunchAdam<G, float, 4>(chunk_size, tensor_lists, numels, params, stream);
+  } else if (copy_dtype.code == kDLFloat && copy_dtype.bits == 16) {
+    LaunchAdam<G, __half, 5>(chunk_size, tensor_lists, numels, params, stream);
+  } else if (copy_dtype.code == kDLBfloat && copy_dtype.bits == 16) {
+    LaunchAdam<G, __nv_bfloat16, 5>(chunk_size, tensor_lists, numels, params, stream);
+  } else if (copy_dtype.code == kDLFloat && copy_dtype.bits == 32) {
+    LaunchAdam<G, float, 5>(chunk_size, tensor_lists, numels, params, stream);
+  } else {
+    LOG(FATAL) << "Unsupported dtype of the weight copies: " << DType(copy_dtype).c_str();
+  }
+}
+
+}  // namespace
+
+void multi_tensor_adam_cuda(int chunk_size, const std::vector<void*>& tensor_lists,
+                            const std::vector<int>& numels, DLDataType grad_dtype,
+                            DLDataType copy_dtype, const AdamParams& params, int scale_window,
+                            void* stream) {
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  if (params.loss_scaler != nullptr) {
+    ResetLossScalerKernel<<<1, 1, 0, cuda_stream>>>(params.loss_scaler);
+  }
+  if (grad_dtype.code == kDLFloat && grad_dtype.bits == 32) {
+    DispatchCopyType<float>(chunk_size, tensor_lists, numels, copy_dtype, params, stream);
+  } else if (grad_dtype.code == kDLFloat && grad_dtype.bits == 16) {
+    DispatchCopyType<__half>(chunk_size, tensor_lists, numels, copy_dtype, params, stream);
+  } else if (grad_dtype.code == kDLBfloat && grad_dtype.bits == 16) {
+    DispatchCopyType<__nv_bfloat16>(chunk_size, tensor_lists, numels, copy_dtype, params,
+                                    stream);
+  } else {
+    LOG(FATAL) << "Unsupported dtype of the gradients: " << DType(grad_dtype).c_str();
+  }
+  if (params.loss_scaler != nullptr) {
+    UpdateLossScalerKernel<<<1, 1, 0, cuda_stream>>>(params.loss_scaler, scale_window);
+  }
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -4,21 +4,28 @@
  */
 
 /*!
- * \file src/op/dispatch/cuda/kernels/multi_tensor_apply.cuh
- * \brief multi_tennsor header file
+ * \file src/op/dialect/cuda/kernels/multi_tensor_apply.cuh
+ * \brief The multi-tensor apply facility of the CUDA kernels. A launch of multi_tensor_apply covers
+ * the chunks of many tensors, and a user-supplied functor processes the chunk of each thread
+ * block. The elementwise ops over a list of tensors only have to provide the per-element op to
+ * MultiTensorUnaryFunctor, and the reductions can share reduce_block_into_lanes.
  */
 
 // TODO(@zhen-jia): The code structure is mostly migrate from Apex, we should consider the
 //                  copyright when opensource
-
+#pragma once
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <stdint.h>
 #include <vector>
+
 namespace raf{
 namespace op {
 namespace cuda {
 
 // TODO:  Kernel arg size limit may be <4KB for some other cards (ie Jetson)
-constexpr int depth_to_max_tensors[5] = {110, 64, 48, 36, 30};
-constexpr int depth_to_max_blocks[5] = {320, 320, 320, 320, 320};
+constexpr int depth_to_max_tensors[6] = {110, 64, 48, 36, 30, 24};
+constexpr int depth_to_max_blocks[6] = {320, 320, 320, 320, 320, 320};
 
 template<int n> struct TensorListMetadata
 {
@@ -90,7 +97,171 @@ void multi_tensor_apply(int block_size, int chunk_size, const std::vector<T*>& t
     }
   }
 }
+
+__device__ __forceinline__ float LoadFloat(float x) {
+  return x;
+}
+
+__device__ __forceinline__ float LoadFloat(__half x) {
+  return __half2float(x);
+}
+
+__device__ __forceinline__ float LoadFloat(__nv_bfloat16 x) {
+  return __bfloat162float(x);
+}
+
+__device__ __forceinline__ void StoreFloat(float x, float* dst) {
+  *dst = x;
+}
+
+__device__ __forceinline__ void StoreFloat(float x, __half* dst) {
+  *dst = __float2half(x);
+}
+
+__device__ __forceinline__ void StoreFloat(float x, __nv_bfloat16* dst) {
+  *dst = __float2bfloat16(x);
+}
+
+/*! \brief The code steps per octave of the 8-bit optimizer states, whose codes are logarithmic in
+ * the magnitude relative to the absmax of their block. */
+constexpr float kStateStepsPerOctave = 12.0f;
+
+/*! \brief Decode a level of [0, levels] to the magnitude relative to the absmax, where level 0 is
+ * zero and the last level is the absmax. */
+__device__ __forceinline__ float DecodeStateLevel(int level, int levels) {
+  return level == 0 ? 0.0f : exp2f((level - levels) / kStateStepsPerOctave);
+}
+
+/*! \brief Encode a magnitude of [0, 1] relative to the absmax to the nearest level, which is 0 if
+ * it is below the range of the levels. */
+__device__ __forceinline__ int EncodeStateLevel(float ratio, int levels) {
+  if (!(ratio > 0.0f)) {
+    return 0;
+  }
+  int level = levels + __float2int_rn(log2f(ratio) * kStateStepsPerOctave);
+  return min(max(level, 0), levels);
+}
+
+/*! \brief Dequantize a signed 8-bit state, e.g., the first moment of Adam, by its block absmax. */
+__device__ __forceinline__ float DequantizeSignedState(int8_t q, float absmax) {
+  float level = DecodeStateLevel(abs(static_cast<int>(q)), 127);
+  return (q < 0 ? -level : level) * absmax;
+}
+
+/*! \brief Quantize a signed state by the absmax of its block. */
+__device__ __forceinline__ int8_t QuantizeSignedState(float x, float absmax) {
+  int level = absmax > 0.0f ? EncodeStateLevel(fabsf(x) / absmax, 127) : 0;
+  return static_cast<int8_t>(x < 0.0f ? -level : level);
+}
+
+/*! \brief Dequantize an unsigned 8-bit state, e.g., the second moment of Adam, by its block
+ * absmax. */
+__device__ __forceinline__ float DequantizeUnsignedState(uint8_t q, float absmax) {
+  return DecodeStateLevel(q, 255) * absmax;
+}
+
+/*! \brief Quantize a non-negative state by the absmax of its block. */
+__device__ __forceinline__ uint8_t QuantizeUnsignedState(float x, float absmax) {
+  return static_cast<uint8_t>(absmax > 0.0f ? EncodeStateLevel(x / absmax, 255) : 0);
+}
+
+/*!
+ * \brief The max of the non-negative val over the threads of a block, which is returned to all the
+ * threads. x has a float per warp, and the block size is a multiple of 32.
+ */
+__device__ __forceinline__ float BlockMax(float* x, float val) {
+  for (int i = 16; i > 0; i >>= 1) {
+    val = fmaxf(val, __shfl_xor_sync(0xffffffff, val, i));
+  }
+  int warp = threadIdx.x / 32;
+  int lane = threadIdx.x % 32;
+  // x may still be read by the previous call.
+  __syncthreads();
+  if (lane == 0) {
+    x[warp] = val;
+  }
+  __syncthreads();
+  val = lane < blockDim.x / 32 ? x[lane] : 0.0f;
+  for (int i = 16; i > 0; i >>= 1) {
+    val = fmaxf(val, __shfl_xor_sync(0xffffffff, val, i));
+  }
+  return val;
+}
+
+/*!
+ * \brief Apply an elementwise op to a chunk of a list of tensors. The addresses are the inputs of
+ * In and the outputs of Out, which may be the inputs. The op maps a float to a float. Its
+ * Prepare is called once per chunk, e.g., to read the parameters kept on the device.
+ */
+template <typename In, typename Out, typename Op>
+struct MultiTensorUnaryFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<2>& tl, Op op) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+    const In* x = static_cast<const In*>(tl.addresses[0][tensor_loc]) + offset;
+    Out* y = static_cast<Out*>(tl.addresses[1][tensor_loc]) + offset;
+    op.Prepare();
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+      StoreFloat(op(LoadFloat(x[i])), y + i);
+    }
+  }
+};
+
+/*!
+ * \brief Reduce the val of the threads of a block into the first lanes of x, which has a float per
+ * thread. The result is returned to the first lanes threads, or written back to x as well if
+ * share_result is true.
+ */
+template <typename T>
+__device__ __forceinline__ T
+reduce_block_into_lanes(T* x, T val, int lanes = 1,
+                        bool share_result = false)  // lanes is intended to be <= 32.
+{
+  int tid = threadIdx.x + threadIdx.y * blockDim.x;
+  int blockSize = blockDim.x*blockDim.y; // blockSize is intended to be a multiple of 32.
+
+  if(blockSize >= 64)
+  {
+    x[tid] = val;
+    __syncthreads();
+  }
+
+  #pragma unroll
+  for(int i = (blockSize >> 1); i >= 64; i >>= 1)
+  {
+    if(tid < i)
+      x[tid] = x[tid] + x[tid+i];
+    __syncthreads();
+  }
+
+  T final;
+
+  if(tid < 32)
+  {
+    if(blockSize >= 64)
+      final = x[tid] + x[tid+32];
+    else
+      final = val;
+    // __SYNCWARP();
+
+    #pragma unroll
+    for(int i = 16; i >= lanes; i >>= 1)
+      final = final + __shfl_down_sync(0xffffffff, final, i);
+  }
+
+  if(share_result)
+  {
+    if(tid < lanes)
+      x[tid] = final; // EpilogueOp
+    // Make sure the smem result is visible to all warps.
+    __syncthreads();
+  }
+
+  return final;
+}
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
-
@@ -0,0 +1,134 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_copy.cu
+ * \brief The copies of a list of tensors in one launch, e.g., concatenate, split and the fusion of
+ * the tensors of collectives, whose pointers and strides are passed to the kernel as an array.
+ */
+#include <limits>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kThreadsPerBlock = 256;
+constexpr int kUnitsPerThread = 4;
+constexpr int kUnitsPerBlock = kThreadsPerBlock * kUnitsPerThread;
+/*! \brief The segments of a launch, which keep the kernel arguments under 4KB. */
+constexpr int kMaxSegmentsPerLaunch = 64;
+
+/*! \brief The segments of a launch, and the first block of each segment. */
+struct CopyBatch {
+  CopySegment segments[kMaxSegmentsPerLaunch];
+  int block_start[kMaxSegmentsPerLaunch + 1];
+  int num_segments;
+};
+
+/*! \brief Each block copies kUnitsPerBlock units of V of a segment. */
+template <typename V>
+__global__ void MultiTensorCopyKernel(CopyBatch batch) {
+  // The last segment whose first block is not after this block.
+  int lo = 0, hi = batch.num_segments - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (batch.block_start[mid] <= static_cast<int>(blockIdx.x)) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  const CopySegment& seg = batch.segments[lo];
+  const V* src = static_cast<const V*>(seg.src);
+  V* dst = static_cast<V*>(seg.dst);
+  int64_t row_units = seg.row_bytes / sizeof(V);
+  int64_t src_stride = seg.src_stride / sizeof(V);
+  int64_t dst_stride = seg.dst_stride / sizeof(V);
+  int64_t total = seg.rows * row_units;
+  int64_t begin = static_cast<int64_t>(blockIdx.x - batch.block_start[lo]) * kUnitsPerBlock;
+  int64_t end = min(begin + kUnitsPerBlock, total);
+  if (src_stride == row_units && dst_stride == row_units) {
+    for (int64_t u = begin + threadIdx.x; u < end; u += blockDim.x) {
+      dst[u] = src[u];
+    }
+    return;
+  }
+  for (int64_t u = begin + threadIdx.x; u < end; u += blockDim.x) {
+    int64_t r = u / row_units;
+    int64_t c = u - r * row_units;
+    dst[r * dst_stride + c] = src[r * src_stride + c];
+  }
+}
+
+/*! \brief The widest unit of up to 16 bytes that divides all the addresses and sizes. */
+int GetUnitBytes(const CopyBatch& batch) {
+  uint64_t bits = 16;
+  for (int i = 0; i < batch.num_segments; ++i) {
+    const CopySegment& seg = batch.segments[i];
+    bits |= reinterpret_cast<uint64_t>(seg.src) | reinterpret_cast<uint64_t>(seg.dst);
+    bits |= static_cast<uint64_t>(seg.row_bytes) | static_cast<uint64_t>(seg.src_stride) |
+            static_cast<uint64_t>(seg.dst_stride);
+  }
+  return static_cast<int>(bits & ~(bits - 1));
+}
+
+void LaunchBatch(const CopyBatch& batch, cudaStream_t stream) {
+  int unit = GetUnitBytes(batch);
+  CopyBatch launch = batch;
+  int blocks = 0;
+  for (int i = 0; i < launch.num_segments; ++i) {
+    const CopySegment& seg = launch.segments[i];
+    int64_t units = seg.rows * (seg.row_bytes / unit);
+    launch.block_start[i] = blocks;
+    blocks += static_cast<int>((units + kUnitsPerBlock - 1) / kUnitsPerBlock);
+  }
+  launch.block_start[launch.num_segments] = blocks;
+  if (unit == 16) {
+    MultiTensorCopyKernel<uint4><<<blocks, kThreadsPerBlock, 0, stream>>>(launch);
+  } else if (unit == 8) {
+    MultiTensorCopyKernel<uint2><<<blocks, kThreadsPerBlock, 0, stream>>>(launch);
+  } else if (unit == 4) {
+    MultiTensorCopyKernel<uint32_t><<<blocks, kThreadsPerBlock, 0, stream>>>(launch);
+  } else if (unit == 2) {
+    MultiTensorCopyKernel<uint16_t><<<blocks, kThreadsPerBlock, 0, stream>>>(launch);
+  } else {
+    MultiTensorCopyKernel<uint8_t><<<blocks, kThreadsPerBlock, 0, stream>>>(launch);
+  }
+}
+
+}  // namespace
+
+void multi_tensor_copy_cuda(const std::vector<CopySegment>& segments, void* stream) {
+  auto s = static_cast<cudaStream_t>(stream);
+  CopyBatch batch;
+  batch.num_segments = 0;
+  // The blocks of the narrowest units, which bound the grid of a launch.
+  int64_t max_blocks = 0;
+  for (const auto& seg : segments) {
+    if (seg.rows == 0 || seg.row_bytes == 0) {
+      continue;
+    }
+    int64_t blocks = (seg.rows * seg.row_bytes + kUnitsPerBlock - 1) / kUnitsPerBlock;
+    CHECK_LE(blocks, std::numeric_limits<int>::max()) << "The tensor is too large to copy";
+    if (batch.num_segments == kMaxSegmentsPerLaunch ||
+        max_blocks + blocks > std::numeric_limits<int>::max()) {
+      LaunchBatch(batch, s);
+      batch.num_segments = 0;
+      max_blocks = 0;
+    }
+    batch.segments[batch.num_segments++] = seg;
+    max_blocks += blocks;
+  }
+  if (batch.num_segments > 0) {
+    LaunchBatch(batch, s);
+  }
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
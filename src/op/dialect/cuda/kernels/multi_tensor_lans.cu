@@ -25,7 +25,7 @@ template void multi_tensor_lans_cuda<float>(
     const int grad_averaging, const int mode, const bool normalize_grad,
     const std::vector<int> numels, void* stream, float* output_per_tensor, float* grad_norm_tensor,
     float* param_norm_tensor, float* update_m_norm, float* q_norm_tensor,
-    int max_chunks_per_tensor);
+    int max_chunks_per_tensor, bool quantize_states);
 
 typedef enum {
   MOMENT_MODE_0 = 0,  // L2 regularization mode
@@ -38,54 +38,6 @@ __device__ __forceinline__ bool is_aligned(T* p) {
   return ((uint64_t)p) % (ILP*sizeof(T)) == 0;
 }
 
-template <typename T>
-__device__ __forceinline__ T
-reduce_block_into_lanes(T* x, T val, int lanes = 1,
-                        bool share_result = false)  // lanes is intended to be <= 32.
-{
-  int tid = threadIdx.x + threadIdx.y * blockDim.x;
-  int blockSize = blockDim.x*blockDim.y; // blockSize is intended to be a multiple of 32.
-
-  if(blockSize >= 64)
-  {
-    x[tid] = val;
-    __syncthreads();
-  }
-
-  #pragma unroll
-  for(int i = (blockSize >> 1); i >= 64; i >>= 1)
-  {
-    if(tid < i)
-      x[tid] = x[tid] + x[tid+i];
-    __syncthreads();
-  }
-
-  T final;
-
-  if(tid < 32)
-  {
-    if(blockSize >= 64)
-      final = x[tid] + x[tid+32];
-    else
-      final = val;
-    // __SYNCWARP();
-
-    #pragma unroll
-    for(int i = 16; i >= lanes; i >>= 1)
-      final = final + __shfl_down_sync(0xffffffff, final, i);
-  }
-
-  if(share_result)
-  {
-    if(tid < lanes)
-      x[tid] = final; // EpilogueOp
-    // Make sure the smem result is visible to all warps.
-    __syncthreads();
-  }
-
-  return final;
-}
-
 template<typename T>
 __device__ __forceinline__ void load_store(T* dst, T* src, int dst_offset, int src_offset){
   typedef typename std::aligned_storage<ILP*sizeof(T), ILP*alignof(T)>::type LT;
@@ -321,6 +273,86 @@ struct LANSStage1Functor
   }
 };
 
+/*!
+ * \brief Stage 1 of LANS with the 8-bit moments. The addresses are the same as LANSStage1Functor
+ * but the int8 m, the uint8 v and their scales. The threads of a block update a block of the
+ * states together, so the states are requantized by the absmax of their new values.
+ */
+struct LANSStage1QuantizedFunctor {
+  static constexpr int kItems = kStateBlockSize / BLOCK_SIZE;
+
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<6>& tl,
+                                             const float beta1, const float beta2,
+                                             const float beta3, const float beta1_correction,
+                                             const float beta2_correction, const float epsilon,
+                                             adamMode_t mode, const float decay,
+                                             float* per_tensor_grad_norm, bool normalize_grad) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int tensor_num = tl.start_tensor_this_launch + tensor_loc;
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+    int nblocks = (tl.sizes[tensor_loc] + kStateBlockSize - 1) / kStateBlockSize;
+    float grad_norm = per_tensor_grad_norm[tensor_num];
+    float* g = static_cast<float*>(tl.addresses[0][tensor_loc]) + offset;
+    float* q = static_cast<float*>(tl.addresses[1][tensor_loc]) + offset;
+    const float* p = static_cast<const float*>(tl.addresses[2][tensor_loc]) + offset;
+    int8_t* m = static_cast<int8_t*>(tl.addresses[3][tensor_loc]) + offset;
+    uint8_t* v = static_cast<uint8_t*>(tl.addresses[4][tensor_loc]) + offset;
+    float* m_absmax = static_cast<float*>(tl.addresses[5][tensor_loc]) + offset / kStateBlockSize;
+    float* v_absmax = m_absmax + nblocks;
+    __shared__ float smem[BLOCK_SIZE / 32];
+    for (int start = 0, b = 0; start < n; start += kStateBlockSize, ++b) {
+      float prev_m_absmax = m_absmax[b];
+      float prev_v_absmax = v_absmax[b];
+      float next_m[kItems];
+      float next_v[kItems];
+      float next_m_absmax = 0.0f;
+      float next_v_absmax = 0.0f;
+#pragma unroll
+      for (int k = 0; k < kItems; ++k) {
+        int i = start + k * BLOCK_SIZE + threadIdx.x;
+        next_m[k] = 0.0f;
+        next_v[k] = 0.0f;
+        if (i >= n) {
+          continue;
+        }
+        float scaled_grad = g[i];
+        if (normalize_grad && grad_norm != 0.0f) {
+          scaled_grad /= (grad_norm + epsilon);
+        }
+        float param = decay == 0 ? 0.0f : p[i];
+        if (mode == MOMENT_MODE_0) {
+          scaled_grad += decay * param;
+        }
+        next_m[k] = DequantizeSignedState(m[i], prev_m_absmax) * beta1 + beta3 * scaled_grad;
+        next_v[k] = DequantizeUnsignedState(v[i], prev_v_absmax) * beta2 +
+                    (1 - beta2) * scaled_grad * scaled_grad;
+        float denom = sqrtf(next_v[k] / beta2_correction) + epsilon;
+        float scaled_p = mode == MOMENT_MODE_0 ? 0.0f : decay * param;
+        g[i] = (next_m[k] / beta1_correction) / denom + scaled_p;
+        q[i] = scaled_grad / denom + scaled_p;
+        next_m_absmax = fmaxf(next_m_absmax, fabsf(next_m[k]));
+        next_v_absmax = fmaxf(next_v_absmax, next_v[k]);
+      }
+      next_m_absmax = BlockMax(smem, next_m_absmax);
+      next_v_absmax = BlockMax(smem, next_v_absmax);
+#pragma unroll
+      for (int k = 0; k < kItems; ++k) {
+        int i = start + k * BLOCK_SIZE + threadIdx.x;
+        if (i < n) {
+          m[i] = QuantizeSignedState(next_m[k], next_m_absmax);
+          v[i] = QuantizeUnsignedState(next_v[k], next_v_absmax);
+        }
+      }
+      if (threadIdx.x == 0) {
+        m_absmax[b] = next_m_absmax;
+        v_absmax[b] = next_v_absmax;
+      }
+    }
+  }
+};
+
 // Step 2 reads in 'update' value and per-tensor param_norm and update_norm.
 // It computes new parameter value.
 template<typename T>
@@ -407,7 +439,7 @@ void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const
                             const bool normalize_grad, const std::vector<int> numels, void* stream,
                             float* output_per_tensor, float* grad_norm_tensor,
                             float* param_norm_tensor, float* update_m_norm, float* q_norm_tensor,
-                            int max_chunks_per_tensor) {
+                            int max_chunks_per_tensor, bool quantize_states) {
   // Master weight and 32bit momentum(potentially changing) is not handled by this
   // So we assume every tensor are all in the same type
 
@@ -424,11 +456,18 @@ void multi_tensor_lans_cuda(int chunk_size, std::vector<T*> tensor_lists, const
   multi_tensor_l2norm_cuda(chunk_size, param_list, numels, output_per_tensor, param_norm_tensor,
                            stream, max_chunks_per_tensor);
 
-  multi_tensor_apply<5>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
-                        LANSStage1Functor<float>(), beta1, beta2,
-                        beta3,  // 1-beta1 or 1 depends on averaging mode
-                        bias_correction1, bias_correction2, epsilon, (adamMode_t)mode, weight_decay,
-                        grad_norm_tensor, normalize_grad);
+  if (quantize_states) {
+    multi_tensor_apply<6>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
+                          LANSStage1QuantizedFunctor(), beta1, beta2, beta3, bias_correction1,
+                          bias_correction2, epsilon, (adamMode_t)mode, weight_decay,
+                          grad_norm_tensor, normalize_grad);
+  } else {
+    multi_tensor_apply<5>(BLOCK_SIZE, chunk_size, tensor_lists, numels, stream,
+                          LANSStage1Functor<float>(), beta1, beta2,
+                          beta3,  // 1-beta1 or 1 depends on averaging mode
+                          bias_correction1, bias_correction2, epsilon, (adamMode_t)mode,
+                          weight_decay, grad_norm_tensor, normalize_grad);
+  }
 
   // Compute update norms
   multi_tensor_l2norm_cuda(chunk_size, grad_list, numels, output_per_tensor, update_m_norm, stream,
@@ -0,0 +1,160 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/multi_tensor_ops.cu
+ * \brief Multi-tensor scale, cast, zero, global L2 norm and clip-by-global-norm cuda kernels, each
+ * of which covers the chunks of many tensors in a launch.
+ */
+#include "./kernel_util.cuh"
+#include "./multi_tensor_apply.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kBlockSize = 512;
+
+/*!
+ * \brief y = x * scale, which is further clipped by min(1, max_norm / (norm + eps)) if the norm on
+ * the device is given. The outputs are written as zeros if zero is true, even if x is not finite.
+ */
+struct ScaleOp {
+  float scale;
+  bool zero;
+  const float* norm;
+  float max_norm;
+  float eps;
+
+  __device__ __forceinline__ void Prepare() {
+    if (norm != nullptr) {
+      scale *= fminf(1.0f, max_norm / (*norm + eps));
+    }
+  }
+
+  __device__ __forceinline__ float operator()(float x) const {
+    return zero ? 0.0f : x * scale;
+  }
+};
+
+/*!
+ * \brief The sum of the squares of a chunk, which is written to the partial sums of the chunk, so
+ * the norm is reduced in the same order regardless of the launches.
+ */
+template <typename T>
+struct SumSquaresFunctor {
+  __device__ __forceinline__ void operator()(int chunk_size, TensorListMetadata<1>& tl,
+                                             float* partials, int max_chunks_per_tensor) {
+    __shared__ float s_vals[kBlockSize];
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+    const T* x = static_cast<const T*>(tl.addresses[0][tensor_loc]) + offset;
+    float val = 0.0f;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+      float next = LoadFloat(x[i]);
+      val += next * next;
+    }
+    float final = reduce_block_into_lanes(s_vals, val);
+    if (threadIdx.x == 0) {
+      partials[(tl.start_tensor_this_launch + tensor_loc) * max_chunks_per_tensor + chunk_idx] =
+          final;
+    }
+  }
+};
+
+__global__ void GlobalNormKernel(const float* partials, int n, float* norm) {
+  __shared__ float s_vals[kBlockSize];
+  float val = 0.0f;
+  for (int i = threadIdx.x; i < n; i += blockDim.x) {
+    val += partials[i];
+  }
+  float final = reduce_block_into_lanes(s_vals, val);
+  if (threadIdx.x == 0) {
+    *norm = sqrtf(final);
+  }
+}
+
+template <typename In, typename Out>
+void LaunchScale(int chunk_size, const std::vector<void*>& tensor_lists,
+                 const std::vector<int>& numels, const ScaleOp& op, void* stream) {
+  multi_tensor_apply<2>(kBlockSize, chunk_size, tensor_lists, numels, stream,
+                        MultiTensorUnaryFunctor<In, Out, ScaleOp>(), op);
+}
+
+template <typename In>
+void DispatchScaleOut(int chunk_size, const std::vector<void*>& tensor_lists,
+                      const std::vector<int>& numels, DLDataType out_dtype, const ScaleOp& op,
+                      void* stream) {
+  if (out_dtype.code == kDLFloat && out_dtype.bits == 32) {
+    LaunchScale<In, float>(chunk_size, tensor_lists, numels, op, stream);
+  } else if (out_dtype.code == kDLFloat && out_dtype.bits == 16) {
+    LaunchScale<In, __half>(chunk_size, tensor_lists, numels, op, stream);
+  } else if (out_dtype.code == kDLBfloat && out_dtype.bits == 16) {
+    LaunchScale<In, __nv_bfloat16>(chunk_size, tensor_lists, numels, op, stream);
+  } else {
+    LOG(FATAL) << "Unsupported output dtype of multi-tensor ops: " << DType(out_dtype).c_str();
+  }
+}
+
+template <typename T>
+void LaunchSumSquares(int chunk_size, const std::vector<void*>& tensor_list,
+                      const std::vector<int>& numels, float* partials, int max_chunks_per_tensor,
+                      void* stream) {
+  multi_tensor_apply<1>(kBlockSize, chunk_size, tensor_list, numels, stream,
+                        SumSquaresFunctor<T>(), partials, max_chunks_per_tensor);
+}
+
+}  // namespace
+
+bool multi_tensor_dtype_supported(DLDataType dtype) {
+  return (dtype.code == kDLFloat && (dtype.bits == 32 || dtype.bits == 16)) ||
+         (dtype.code == kDLBfloat && dtype.bits == 16);
+}
+
+void multi_tensor_scale_cuda(int chunk_size, const std::vector<void*>& tensor_lists,
+                             const std::vector<int>& numels, DLDataType in_dtype,
+                             DLDataType out_dtype, float scale, const float* norm, float max_norm,
+                             float eps, void* stream) {
+  ScaleOp op{scale, norm == nullptr && scale == 0.0f, norm, max_norm, eps};
+  if (in_dtype.code == kDLFloat && in_dtype.bits == 32) {
+    DispatchScaleOut<float>(chunk_size, tensor_lists, numels, out_dtype, op, stream);
+  } else if (in_dtype.code == kDLFloat && in_dtype.bits == 16) {
+    DispatchScaleOut<__half>(chunk_size, tensor_lists, numels, out_dtype, op, stream);
+  } else if (in_dtype.code == kDLBfloat && in_dtype.bits == 16) {
+    DispatchScaleOut<__nv_bfloat16>(chunk_size, tensor_lists, numels, out_dtype, op, stream);
+  } else {
+    LOG(FATAL) << "Unsupported input dtype of multi-tensor ops: " << DType(in_dtype).c_str();
+  }
+}
+
+void multi_tensor_global_norm_cuda(int chunk_size, const std::vector<void*>& tensor_list,
+                                   const std::vector<int>& numels, DLDataType dtype,
+                                   float* partials, int max_chunks_per_tensor, float* norm,
+                                   void* stream) {
+  int npartials = numels.size() * max_chunks_per_tensor;
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  CUDA_CALL(cudaMemsetAsync(partials, 0, npartials * sizeof(float), cuda_stream));
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    LaunchSumSquares<float>(chunk_size, tensor_list, numels, partials, max_chunks_per_tensor,
+                            stream);
+  } else if (dtype.code == kDLFloat && dtype.bits == 16) {
+    LaunchSumSquares<__half>(chunk_size, tensor_list, numels, partials, max_chunks_per_tensor,
+                             stream);
+  } else if (dtype.code == kDLBfloat && dtype.bits == 16) {
+    LaunchSumSquares<__nv_bfloat16>(chunk_size, tensor_list, numels, partials,
+                                    max_chunks_per_tensor, stream);
+  } else {
+    LOG(FATAL) << "Unsupported input dtype of multi-tensor ops: " << DType(dtype).c_str();
+  }
+  GlobalNormKernel<<<1, kBlockSize, 0, cuda_stream>>>(partials, npartials, norm);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
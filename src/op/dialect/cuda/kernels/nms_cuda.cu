@@ -0,0 +1,394 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/nms_cuda.cu
+ * \brief get_valid_counts and the bitmask-based batched non-maximum suppression
+ */
+#include <cub/cub.cuh>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kThreadsPerBlock = 256;
+static const int kBoxesPerMask = 64;
+static const size_t kAlignment = 256;
+
+/*! \brief The coords, the score and the class id of a box in the masks. */
+struct Box {
+  float l, t, r, b, score, id;
+};
+
+__device__ inline Box LoadBox(const float* box, const NMSConfig& config) {
+  const float* coords = box + config.coord_start;
+  Box ret;
+  ret.l = fminf(coords[0], coords[2]);
+  ret.r = fmaxf(coords[0], coords[2]);
+  ret.t = fminf(coords[1], coords[3]);
+  ret.b = fmaxf(coords[1], coords[3]);
+  ret.score = box[config.score_index];
+  ret.id = config.id_index >= 0 ? box[config.id_index] : 0.0f;
+  return ret;
+}
+
+__device__ inline float IoU(const Box& a, const Box& b) {
+  float w = fmaxf(0.0f, fminf(a.r, b.r) - fmaxf(a.l, b.l));
+  float h = fmaxf(0.0f, fminf(a.b, b.b) - fmaxf(a.t, b.t));
+  float area = w * h;
+  float u = (a.r - a.l) * (a.b - a.t) + (b.r - b.l) * (b.b - b.t) - area;
+  return u <= 0.0f ? 0.0f : area / u;
+}
+
+__device__ inline void FillRow(float* row, int elem_len, float value) {
+  for (int k = 0; k < elem_len; ++k) {
+    row[k] = value;
+  }
+}
+
+/*!
+ * \brief Each block compacts the valid boxes of a batch in their order by a block-wide scan,
+ * and fills the remaining rows with -1.
+ */
+__global__ void GetValidCountsKernel(const float* __restrict__ data, int64_t n, int elem_len,
+                                     float score_threshold, int id_index, int score_index,
+                                     int32_t* __restrict__ valid_count, float* __restrict__ out,
+                                     int32_t* __restrict__ out_indices) {
+  using BlockScan = cub::BlockScan<int, kThreadsPerBlock>;
+  __shared__ typename BlockScan::TempStorage temp;
+  __shared__ int base;
+  int64_t b = blockIdx.x;
+  const float* x = data + b * n * elem_len;
+  float* y = out + b * n * elem_len;
+  int32_t* y_indices = out_indices + b * n;
+  if (threadIdx.x == 0) {
+    base = 0;
+  }
+  __syncthreads();
+  for (int64_t start = 0; start < n; start += kThreadsPerBlock) {
+    int64_t j = start + threadIdx.x;
+    int flag = 0;
+    if (j < n) {
+      const float* box = x + j * elem_len;
+      flag = box[score_index] > score_threshold && (id_index < 0 || box[id_index] >= 0);
+    }
+    int pos, total;
+    BlockScan(temp).ExclusiveSum(flag, pos, total);
+    if (flag) {
+      int64_t dst = base + pos;
+      for (int k = 0; k < elem_len; ++k) {
+        y[dst * elem_len + k] = x[j * elem_len + k];
+      }
+      y_indices[dst] = static_cast<int32_t>(j);
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      base += total;
+    }
+    __syncthreads();
+  }
+  for (int64_t j = base + threadIdx.x; j < n; j += blockDim.x) {
+    FillRow(y + j * elem_len, elem_len, -1.0f);
+    y_indices[j] = -1;
+  }
+  if (threadIdx.x == 0) {
+    valid_count[b] = base;
+  }
+}
+
+void get_valid_counts_cuda(const float* data, int batch, int64_t n, int elem_len,
+                           float score_threshold, int id_index, int score_index,
+                           int32_t* valid_count, float* out, int32_t* out_indices, void* stream) {
+  if (batch == 0) {
+    return;
+  }
+  GetValidCountsKernel<<<batch, kThreadsPerBlock, 0, static_cast<cudaStream_t>(stream)>>>(
+      data, n, elem_len, score_threshold, id_index, score_index, valid_count, out, out_indices);
+}
+
+/*! \brief The buffers of the workspace of nms_cuda. */
+struct NMSWorkspace {
+  /*! \brief The scores to sort, where the invalid boxes are the lowest. */
+  float* keys = nullptr;
+  /*! \brief The positions of the boxes sorted by the scores in descending order. */
+  int32_t* order = nullptr;
+  /*! \brief The workspace of the sort. */
+  void* sort = nullptr;
+  /*! \brief The sorted boxes. */
+  float* sorted = nullptr;
+  /*! \brief The bit j % 64 of masks[i][j / 64] is whether the sorted box i suppresses box j. */
+  uint64_t* masks = nullptr;
+  /*! \brief Whether each sorted box is kept, and the kept sorted positions in order. */
+  int32_t* kept = nullptr;
+  int32_t* keep_list = nullptr;
+  /*! \brief The boxes to run NMS, i.e., the valid ones capped by top_k, and the kept boxes. */
+  int32_t* num_candidates = nullptr;
+  int32_t* num_kept = nullptr;
+  size_t total_bytes = 0;
+};
+
+inline size_t Align(size_t bytes) {
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+inline int64_t NumMaskWords(int64_t n) {
+  return (n + kBoxesPerMask - 1) / kBoxesPerMask;
+}
+
+/*! \brief Lay out the buffers in the workspace, which is nullptr to only compute the size. */
+NMSWorkspace PlanNMSWorkspace(void* workspace, int batch, int64_t n, int elem_len) {
+  int64_t total = batch * n;
+  size_t sizes[] = {
+      total * sizeof(float),
+      total * sizeof(int32_t),
+      sort_pairs_workspace_cuda<float, int32_t>(batch, n, false),
+      total * elem_len * sizeof(float),
+      total * NumMaskWords(n) * sizeof(uint64_t),
+      total * sizeof(int32_t),
+      total * sizeof(int32_t),
+      batch * sizeof(int32_t),
+      batch * sizeof(int32_t),
+  };
+  const int num_buffers = sizeof(sizes) / sizeof(sizes[0]);
+  char* ptrs[num_buffers];
+  size_t offset = 0;
+  for (int i = 0; i < num_buffers; ++i) {
+    ptrs[i] = workspace != nullptr ? static_cast<char*>(workspace) + offset : nullptr;
+    offset += Align(sizes[i]);
+  }
+  NMSWorkspace ws;
+  ws.keys = reinterpret_cast<float*>(ptrs[0]);
+  ws.order = reinterpret_cast<int32_t*>(ptrs[1]);
+  ws.sort = ptrs[2];
+  ws.sorted = reinterpret_cast<float*>(ptrs[3]);
+  ws.masks = reinterpret_cast<uint64_t*>(ptrs[4]);
+  ws.kept = reinterpret_cast<int32_t*>(ptrs[5]);
+  ws.keep_list = reinterpret_cast<int32_t*>(ptrs[6]);
+  ws.num_candidates = reinterpret_cast<int32_t*>(ptrs[7]);
+  ws.num_kept = reinterpret_cast<int32_t*>(ptrs[8]);
+  ws.total_bytes = offset;
+  return ws;
+}
+
+/*! \brief The keys to sort the boxes, where the boxes beyond the valid count go last. */
+__global__ void NMSKeysKernel(const float* __restrict__ data,
+                              const int32_t* __restrict__ valid_count, int64_t total, int64_t n,
+                              int elem_len, int score_index, float* __restrict__ keys) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < total) {
+    bool valid = i % n < valid_count[i / n];
+    keys[i] = valid ? data[i * elem_len + score_index] : -INFINITY;
+  }
+}
+
+/*! \brief Gather the boxes in the sorted order, where only the top_k valid boxes are kept. */
+__global__ void NMSGatherKernel(const float* __restrict__ data,
+                                const int32_t* __restrict__ valid_count,
+                                const int32_t* __restrict__ order, int64_t total, int64_t n,
+                                int elem_len, int64_t top_k, float* __restrict__ sorted,
+                                int32_t* __restrict__ num_candidates) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i >= total) {
+    return;
+  }
+  int64_t b = i / n, j = i % n;
+  int64_t count = min(max(static_cast<int64_t>(valid_count[b]), int64_t(0)), n);
+  if (top_k > 0 && top_k < count) {
+    count = top_k;
+  }
+  if (j == 0) {
+    num_candidates[b] = static_cast<int32_t>(count);
+  }
+  float* row = sorted + i * elem_len;
+  if (j < count) {
+    const float* src = data + (b * n + order[i]) * elem_len;
+    for (int k = 0; k < elem_len; ++k) {
+      row[k] = src[k];
+    }
+  } else {
+    FillRow(row, elem_len, -1.0f);
+  }
+}
+
+/*!
+ * \brief Each block compares the 64 sorted boxes of a row block with the 64 of a column block,
+ * and each thread writes the mask of a row box over the column block.
+ */
+__global__ void NMSMaskKernel(const float* __restrict__ sorted,
+                              const int32_t* __restrict__ num_candidates, int64_t n, int elem_len,
+                              NMSConfig config, const float* iou_threshold_ptr,
+                              float iou_threshold, uint64_t* __restrict__ masks) {
+  __shared__ Box cols[kBoxesPerMask];
+  int64_t b = blockIdx.z;
+  int64_t row_start = blockIdx.y * static_cast<int64_t>(kBoxesPerMask);
+  int64_t col_start = blockIdx.x * static_cast<int64_t>(kBoxesPerMask);
+  int64_t count = num_candidates[b];
+  int64_t col = col_start + threadIdx.x;
+  if (col < count) {
+    cols[threadIdx.x] = LoadBox(sorted + (b * n + col) * elem_len, config);
+  }
+  __syncthreads();
+  int64_t row = row_start + threadIdx.x;
+  if (row >= n) {
+    return;
+  }
+  float threshold = iou_threshold_ptr != nullptr ? *iou_threshold_ptr : iou_threshold;
+  uint64_t bits = 0;
+  if (row < count && col_start + kBoxesPerMask > row + 1) {
+    Box box = LoadBox(sorted + (b * n + row) * elem_len, config);
+    int64_t end = min(static_cast<int64_t>(kBoxesPerMask), count - col_start);
+    for (int64_t c = max(row + 1 - col_start, int64_t(0)); c < end; ++c) {
+      const Box& other = cols[c];
+      bool same_class = config.force_suppress || config.id_index < 0 || other.id == box.id;
+      if (other.score > 0 && same_class && IoU(box, other) >= threshold) {
+        bits |= 1ULL << c;
+      }
+    }
+  }
+  masks[(b * n + row) * gridDim.x + blockIdx.x] = bits;
+}
+
+/*!
+ * \brief Each block greedily visits the sorted boxes of a batch, keeps a box if no kept box
+ * suppresses it, and merges its mask into the suppressed boxes until max_output_size are kept.
+ */
+__global__ void NMSReduceKernel(const float* __restrict__ sorted,
+                                const uint64_t* __restrict__ masks,
+                                const int32_t* __restrict__ num_candidates, int64_t n,
+                                int elem_len, int score_index, int64_t num_words,
+                                const int32_t* max_output_size_ptr, int32_t max_output_size,
+                                int32_t* __restrict__ kept, int32_t* __restrict__ keep_list,
+                                int32_t* __restrict__ num_kept) {
+  extern __shared__ uint64_t removed[];
+  __shared__ int keep;
+  int64_t b = blockIdx.x;
+  int64_t count = num_candidates[b];
+  int64_t max_out = max_output_size_ptr != nullptr ? *max_output_size_ptr : max_output_size;
+  if (max_out < 0) {
+    max_out = n;
+  }
+  for (int64_t w = threadIdx.x; w < num_words; w += blockDim.x) {
+    removed[w] = 0;
+  }
+  for (int64_t j = threadIdx.x; j < n; j += blockDim.x) {
+    kept[b * n + j] = 0;
+  }
+  __syncthreads();
+  int64_t num = 0;
+  for (int64_t j = 0; j < count && num < max_out; ++j) {
+    if (threadIdx.x == 0) {
+      bool suppressed = (removed[j / kBoxesPerMask] >> (j % kBoxesPerMask)) & 1ULL;
+      keep = !suppressed && sorted[(b * n + j) * elem_len + score_index] > -1.0f;
+    }
+    __syncthreads();
+    if (keep) {
+      const uint64_t* mask = masks + (b * n + j) * num_words;
+      for (int64_t w = j / kBoxesPerMask + threadIdx.x; w < num_words; w += blockDim.x) {
+        removed[w] |= mask[w];
+      }
+      if (threadIdx.x == 0) {
+        kept[b * n + j] = 1;
+        keep_list[b * n + num] = static_cast<int32_t>(j);
+      }
+      ++num;
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    num_kept[b] = static_cast<int32_t>(num);
+  }
+}
+
+/*! \brief Write the kept boxes, or their original indices, to the upper-bounded outputs. */
+__global__ void NMSOutputKernel(const float* __restrict__ sorted,
+                                const int32_t* __restrict__ order,
+                                const int32_t* __restrict__ indices,
+                                const int32_t* __restrict__ num_candidates,
+                                const int32_t* __restrict__ kept,
+                                const int32_t* __restrict__ keep_list,
+                                const int32_t* __restrict__ num_kept, int64_t total, int64_t n,
+                                int elem_len, NMSConfig config, float* __restrict__ out,
+                                int32_t* __restrict__ box_indices,
+                                int32_t* __restrict__ valid_box_count) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i >= total) {
+    return;
+  }
+  int64_t b = i / n, r = i % n;
+  int64_t num = num_kept[b];
+  if (config.return_indices) {
+    box_indices[i] = r < num ? indices[b * n + order[b * n + keep_list[i]]] : -1;
+    if (r == 0) {
+      valid_box_count[b] = static_cast<int32_t>(num);
+    }
+    return;
+  }
+  float* row = out + i * elem_len;
+  if (config.invalid_to_bottom) {
+    if (r < num) {
+      const float* src = sorted + (b * n + keep_list[i]) * elem_len;
+      for (int k = 0; k < elem_len; ++k) {
+        row[k] = src[k];
+      }
+    } else {
+      FillRow(row, elem_len, -1.0f);
+    }
+    return;
+  }
+  const float* src = sorted + i * elem_len;
+  for (int k = 0; k < elem_len; ++k) {
+    row[k] = src[k];
+  }
+  if (r < num_candidates[b] && !kept[i]) {
+    row[config.score_index] = -1.0f;
+    if (config.id_index >= 0) {
+      row[config.id_index] = -1.0f;
+    }
+  }
+}
+
+size_t nms_workspace_cuda(int batch, int64_t n, int elem_len) {
+  return PlanNMSWorkspace(nullptr, batch, n, elem_len).total_bytes;
+}
+
+size_t nms_max_boxes_cuda() {
+  // The suppressed bits of a batch are in the shared memory of 48KB.
+  return (48 << 10) / sizeof(uint64_t) * kBoxesPerMask;
+}
+
+void nms_cuda(const float* data, const int32_t* valid_count, const int32_t* indices,
+              const int32_t* max_output_size_ptr, int32_t max_output_size,
+              const float* iou_threshold_ptr, float iou_threshold, int batch, int64_t n,
+              int elem_len, const NMSConfig& config, float* out, int32_t* box_indices,
+              int32_t* valid_box_count, void* workspace, void* stream) {
+  int64_t total = batch * n;
+  if (total == 0) {
+    return;
+  }
+  auto s = static_cast<cudaStream_t>(stream);
+  NMSWorkspace ws = PlanNMSWorkspace(workspace, batch, n, elem_len);
+  int blocks = static_cast<int>((total + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  NMSKeysKernel<<<blocks, kThreadsPerBlock, 0, s>>>(data, valid_count, total, n, elem_len,
+                                                    config.score_index, ws.keys);
+  sort_pairs_cuda<float, int32_t>(ws.keys, batch, n, n, false, nullptr, ws.order, ws.sort, s);
+  NMSGatherKernel<<<blocks, kThreadsPerBlock, 0, s>>>(data, valid_count, ws.order, total, n,
+                                                      elem_len, config.top_k, ws.sorted,
+                                                      ws.num_candidates);
+  int64_t num_words = NumMaskWords(n);
+  dim3 grid(num_words, num_words, batch);
+  NMSMaskKernel<<<grid, kBoxesPerMask, 0, s>>>(ws.sorted, ws.num_candidates, n, elem_len, config,
+                                               iou_threshold_ptr, iou_threshold, ws.masks);
+  NMSReduceKernel<<<batch, kThreadsPerBlock, num_words * sizeof(uint64_t), s>>>(
+      ws.sorted, ws.masks, ws.num_candidates, n, elem_len, config.score_index, num_words,
+      max_output_size_ptr, max_output_size, ws.kept, ws.keep_list, ws.num_kept);
+  NMSOutputKernel<<<blocks, kThreadsPerBlock, 0, s>>>(
+      ws.sorted, ws.order, indices, ws.num_candidates, ws.kept, ws.keep_list, ws.num_kept, total,
+      n, elem_len, config, out, box_indices, valid_box_count);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,101 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/numerics_check.cu
+ * \brief Kernels to check the tensors for the non-finite elements and their absolute maximum
+ */
+#include <cuda_bf16.h>
+#include <algorithm>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kMaxBlocks = 256;
+
+__device__ __forceinline__ float LoadFloat(const float* src) {
+  return *src;
+}
+
+__device__ __forceinline__ float LoadFloat(const __half* src) {
+  return __half2float(*src);
+}
+
+__device__ __forceinline__ float LoadFloat(const __nv_bfloat16* src) {
+  return __bfloat162float(*src);
+}
+
+template <typename T>
+__global__ void CheckNumericsKernel(const T* data, int64_t n, uint64_t tag,
+                                    NumericsRecord* record) {
+  __shared__ float smem_max[kBlockSize];
+  __shared__ unsigned long long smem_count[kBlockSize];
+  float local_max = 0.0f;
+  unsigned long long local_count = 0;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    float x = LoadFloat(data + i);
+    if (isfinite(x)) {
+      local_max = fmaxf(local_max, fabsf(x));
+    } else {
+      local_count++;
+    }
+  }
+  smem_max[threadIdx.x] = local_max;
+  smem_count[threadIdx.x] = local_count;
+  __syncthreads();
+  for (int stride = kBlockSize / 2; stride > 0; stride >>= 1) {
+    if (threadIdx.x < stride) {
+      smem_max[threadIdx.x] = fmaxf(smem_max[threadIdx.x], smem_max[threadIdx.x + stride]);
+      smem_count[threadIdx.x] += smem_count[threadIdx.x + stride];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    // The non-negative floats are ordered as their bits in int.
+    atomicMax(reinterpret_cast<int*>(&record->abs_max), __float_as_int(smem_max[0]));
+    if (smem_count[0] > 0) {
+      atomicAdd(&record->num_nonfinite, smem_count[0]);
+      // The tensors are checked in the order of the ops on the stream, so the first one wins.
+      atomicCAS(&record->first_tag, 0ULL, static_cast<unsigned long long>(tag) + 1);
+    }
+  }
+}
+
+template <typename T>
+void LaunchCheckNumerics(const void* data, int64_t n, uint64_t tag, NumericsRecord* record,
+                         cudaStream_t stream) {
+  int blocks = static_cast<int>(std::min<int64_t>((n + kBlockSize - 1) / kBlockSize, kMaxBlocks));
+  CheckNumericsKernel<T>
+      <<<blocks, kBlockSize, 0, stream>>>(static_cast<const T*>(data), n, tag, record);
+}
+
+}  // namespace
+
+void check_numerics_cuda(const void* data, int64_t n, DLDataType dtype, uint64_t tag,
+                         NumericsRecord* record, void* stream) {
+  if (n == 0) {
+    return;
+  }
+  cudaStream_t cuda_stream = static_cast<cudaStream_t>(stream);
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    LaunchCheckNumerics<float>(data, n, tag, record, cuda_stream);
+  } else if (dtype.code == kDLFloat && dtype.bits == 16) {
+    LaunchCheckNumerics<__half>(data, n, tag, record, cuda_stream);
+  } else if (dtype.code == kDLBfloat && dtype.bits == 16) {
+    LaunchCheckNumerics<__nv_bfloat16>(data, n, tag, record, cuda_stream);
+  } else {
+    LOG(FATAL) << "Unsupported dtype to check the numerics";
+  }
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
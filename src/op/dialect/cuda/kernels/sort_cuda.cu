@@ -0,0 +1,179 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/sort_cuda.cu
+ * \brief Sort, argsort and topk along the last axis by the radix sort of CUB
+ */
+#include <cub/cub.cuh>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kThreadsPerBlock = 512;
+static const size_t kAlignment = 256;
+
+/*! \brief The offset of the segment i. */
+struct SegmentOffset {
+  int len;
+
+  __host__ __device__ int operator()(int i) const {
+    return i * len;
+  }
+};
+
+using OffsetIterator =
+    cub::TransformInputIterator<int, SegmentOffset, cub::CountingInputIterator<int>>;
+
+/*! \brief The buffers of the workspace of sort_pairs_cuda. */
+template <typename K, typename I>
+struct SortWorkspace {
+  /*! \brief The temporary storage of CUB. */
+  void* temp = nullptr;
+  size_t temp_bytes = 0;
+  /*! \brief The positions in the segments, and the sorted keys and indices. */
+  I* positions = nullptr;
+  K* keys = nullptr;
+  I* indices = nullptr;
+  /*! \brief The total bytes. */
+  size_t total_bytes = 0;
+};
+
+inline size_t Align(size_t bytes) {
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+/*!
+ * \brief Run the radix sort of CUB, or only query its temporary storage if temp is nullptr. A
+ * single segment uses the device-wide sort, which is much faster than the segmented one.
+ */
+template <typename K, typename I>
+void RadixSort(void* temp, size_t* temp_bytes, const K* keys_in, K* keys_out, const I* values_in,
+               I* values_out, int num_segments, int len, bool ascend, cudaStream_t stream) {
+  int n = num_segments * len;
+  if (num_segments == 1) {
+    if (ascend) {
+      CUDA_CALL(cub::DeviceRadixSort::SortPairs(temp, *temp_bytes, keys_in, keys_out, values_in,
+                                                values_out, n, 0, sizeof(K) * 8, stream));
+    } else {
+      CUDA_CALL(cub::DeviceRadixSort::SortPairsDescending(temp, *temp_bytes, keys_in, keys_out,
+                                                          values_in, values_out, n, 0,
+                                                          sizeof(K) * 8, stream));
+    }
+    return;
+  }
+  OffsetIterator begin(cub::CountingInputIterator<int>(0), SegmentOffset{len});
+  if (ascend) {
+    CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairs(temp, *temp_bytes, keys_in, keys_out,
+                                                       values_in, values_out, n, num_segments,
+                                                       begin, begin + 1, 0, sizeof(K) * 8, stream));
+  } else {
+    CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairsDescending(
+        temp, *temp_bytes, keys_in, keys_out, values_in, values_out, n, num_segments, begin,
+        begin + 1, 0, sizeof(K) * 8, stream));
+  }
+}
+
+/*! \brief Lay out the buffers in the workspace, which is nullptr to only compute the size. */
+template <typename K, typename I>
+SortWorkspace<K, I> PlanWorkspace(void* workspace, int64_t num_segments, int64_t len,
+                                  bool ascend) {
+  SortWorkspace<K, I> ws;
+  RadixSort<K, I>(nullptr, &ws.temp_bytes, nullptr, nullptr, nullptr, nullptr, num_segments, len,
+                  ascend, nullptr);
+  int64_t n = num_segments * len;
+  size_t offsets[4];
+  offsets[0] = 0;
+  offsets[1] = offsets[0] + Align(ws.temp_bytes);
+  offsets[2] = offsets[1] + Align(n * sizeof(I));
+  offsets[3] = offsets[2] + Align(n * sizeof(K));
+  ws.total_bytes = offsets[3] + Align(n * sizeof(I));
+  if (workspace != nullptr) {
+    char* base = static_cast<char*>(workspace);
+    ws.temp = base + offsets[0];
+    ws.positions = reinterpret_cast<I*>(base + offsets[1]);
+    ws.keys = reinterpret_cast<K*>(base + offsets[2]);
+    ws.indices = reinterpret_cast<I*>(base + offsets[3]);
+  }
+  return ws;
+}
+
+/*! \brief Fill the position of each element in its segment. */
+template <typename I>
+__global__ void FillPositionsKernel(I* __restrict__ positions, int64_t n, int64_t len) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    positions[i] = static_cast<I>(i % len);
+  }
+}
+
+/*! \brief Copy the first k sorted elements of each segment to the outputs, which may be nullptr. */
+template <typename K, typename I>
+__global__ void TakeFirstKKernel(const K* __restrict__ keys, const I* __restrict__ indices,
+                                 int64_t n, int64_t len, int64_t k, K* __restrict__ out_keys,
+                                 I* __restrict__ out_indices) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    int64_t src = i / k * len + i % k;
+    if (out_keys != nullptr) {
+      out_keys[i] = keys[src];
+    }
+    if (out_indices != nullptr) {
+      out_indices[i] = indices[src];
+    }
+  }
+}
+
+template <typename K, typename I>
+size_t sort_pairs_workspace_cuda(int64_t num_segments, int64_t len, bool ascend) {
+  return PlanWorkspace<K, I>(nullptr, num_segments, len, ascend).total_bytes;
+}
+
+template <typename K, typename I>
+void sort_pairs_cuda(const K* keys, int64_t num_segments, int64_t len, int64_t k, bool ascend,
+                     K* out_keys, I* out_indices, void* workspace, void* stream) {
+  int64_t n = num_segments * len;
+  if (n == 0 || k == 0) {
+    return;
+  }
+  auto s = static_cast<cudaStream_t>(stream);
+  auto ws = PlanWorkspace<K, I>(workspace, num_segments, len, ascend);
+  // The sorted results are written to the outputs directly if all of them are taken.
+  bool direct = k == len;
+  K* sorted_keys = direct && out_keys != nullptr ? out_keys : ws.keys;
+  I* sorted_indices = direct && out_indices != nullptr ? out_indices : ws.indices;
+  int blocks = static_cast<int>((n + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  FillPositionsKernel<I><<<blocks, kThreadsPerBlock, 0, s>>>(ws.positions, n, len);
+  RadixSort<K, I>(ws.temp, &ws.temp_bytes, keys, sorted_keys, ws.positions, sorted_indices,
+                  num_segments, len, ascend, s);
+  if (!direct) {
+    int64_t m = num_segments * k;
+    blocks = static_cast<int>((m + kThreadsPerBlock - 1) / kThreadsPerBlock);
+    TakeFirstKKernel<K, I><<<blocks, kThreadsPerBlock, 0, s>>>(sorted_keys, sorted_indices, m,
+                                                                len, k, out_keys, out_indices);
+  }
+}
+
+#define RAF_SORT_PAIRS_CUDA(K, I)                                                              \
+  template size_t sort_pairs_workspace_cuda<K, I>(int64_t, int64_t, bool);                     \
+  template void sort_pairs_cuda<K, I>(const K*, int64_t, int64_t, int64_t, bool, K*, I*, void*, \
+                                      void*);
+
+RAF_SORT_PAIRS_CUDA(float, int32_t);
+RAF_SORT_PAIRS_CUDA(float, int64_t);
+RAF_SORT_PAIRS_CUDA(__half, int32_t);
+RAF_SORT_PAIRS_CUDA(__half, int64_t);
+RAF_SORT_PAIRS_CUDA(int32_t, int32_t);
+RAF_SORT_PAIRS_CUDA(int32_t, int64_t);
+RAF_SORT_PAIRS_CUDA(int64_t, int32_t);
+RAF_SORT_PAIRS_CUDA(int64_t, int64_t);
+
+#undef RAF_SORT_PAIRS_CUDA
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,45 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/sparse_sgd_cuda.cu
+ * \brief The SGD kernel of the row-sparse gradients
+ */
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kFeaturesPerBlock = 128;
+
+/*! \brief Each block column updates a row, so the rows have to be unique. */
+__global__ void SparseSgdKernel(const int64_t* __restrict__ rows,
+                                const float* __restrict__ values, int stride, float lr, float mu,
+                                float* __restrict__ v, float* __restrict__ x) {
+  int64_t row = rows[blockIdx.x];
+  int f = blockIdx.y * blockDim.x + threadIdx.x;
+  if (row < 0 || f >= stride) {
+    return;
+  }
+  int64_t k = row * stride + f;
+  float v1 = mu * v[k] + values[blockIdx.x * static_cast<int64_t>(stride) + f];
+  v[k] = v1;
+  x[k] -= lr * v1;
+}
+
+void sparse_sgd_cuda(const int64_t* rows, const float* values, int64_t nrows, int stride, float lr,
+                     float mu, float* v, float* x, void* stream) {
+  if (nrows == 0 || stride == 0) {
+    return;
+  }
+  dim3 grid(nrows, (stride + kFeaturesPerBlock - 1) / kFeaturesPerBlock);
+  SparseSgdKernel<<<grid, kFeaturesPerBlock, 0, static_cast<cudaStream_t>(stream)>>>(
+      rows, values, stride, lr, mu, v, x);
+}
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,247 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kernels/sync_batch_norm_cuda.cu
+ * \brief The kernels of the batch norm whose stats are reduced across the ranks
+ */
+#include <algorithm>
+#include <math.h>
+#include "./kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+static const int kBatchNormThreads = 256;
+static const int kBatchNormMaxBlocks = 65535;
+
+/*! \brief Sum a value over a block, whose result is in all threads. */
+static __device__ float BlockReduceSum(float val) {
+  __shared__ float warp_acc[32];
+  int lane = threadIdx.x % 32;
+  int warp = threadIdx.x / 32;
+  for (int offset = 16; offset > 0; offset >>= 1) {
+    val += __shfl_xor_sync(0xffffffff, val, offset);
+  }
+  if (lane == 0) {
+    warp_acc[warp] = val;
+  }
+  __syncthreads();
+  int num_warps = (blockDim.x + 31) / 32;
+  val = lane < num_warps ? warp_acc[lane] : 0.0f;
+  for (int offset = 16; offset > 0; offset >>= 1) {
+    val += __shfl_xor_sync(0xffffffff, val, offset);
+  }
+  // The shared memory is reused by the next reduction.
+  __syncthreads();
+  return val;
+}
+
+/*!
+ * \brief Each block reduces a channel of x of (outer, c, inner), and of dy if it is given, in
+ * one pass over the channel.
+ */
+template <typename T>
+__global__ void BatchNormReduceKernel(const T* __restrict__ x, const T* __restrict__ dy,
+                                      int64_t outer, int64_t c, int64_t inner,
+                                      float* __restrict__ stats) {
+  int64_t numel = outer * inner;
+  for (int64_t ch = blockIdx.x; ch < c; ch += gridDim.x) {
+    float sum_x = 0.0f;
+    float sum_x2 = 0.0f;
+    float sum_dy = 0.0f;
+    float sum_dy_x = 0.0f;
+    for (int64_t j = threadIdx.x; j < numel; j += blockDim.x) {
+      int64_t i = (j / inner * c + ch) * inner + j % inner;
+      float xi = static_cast<float>(x[i]);
+      sum_x += xi;
+      sum_x2 += xi * xi;
+      if (dy != nullptr) {
+        float dyi = static_cast<float>(dy[i]);
+        sum_dy += dyi;
+        sum_dy_x += dyi * xi;
+      }
+    }
+    sum_x = BlockReduceSum(sum_x);
+    sum_x2 = BlockReduceSum(sum_x2);
+    if (dy != nullptr) {
+      sum_dy = BlockReduceSum(sum_dy);
+      sum_dy_x = BlockReduceSum(sum_dy_x);
+    }
+    if (threadIdx.x == 0) {
+      stats[ch] = sum_x;
+      stats[c + ch] = sum_x2;
+      if (dy != nullptr) {
+        stats[2 * c + ch] = sum_dy;
+        stats[3 * c + ch] = sum_dy_x;
+      }
+    }
+  }
+  if (blockIdx.x == 0 && threadIdx.x == 0) {
+    stats[(dy != nullptr ? 4 : 2) * c] = static_cast<float>(numel);
+  }
+}
+
+template <typename T>
+void batch_norm_reduce_cuda(const T* x, const T* dy, int64_t outer, int64_t c, int64_t inner,
+                            float* stats, void* stream) {
+  int blocks = static_cast<int>(std::min<int64_t>(std::max<int64_t>(c, 1), kBatchNormMaxBlocks));
+  BatchNormReduceKernel<<<blocks, kBatchNormThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      x, dy, outer, c, inner, stats);
+}
+
+/*!
+ * \brief Each thread computes the mean and the inverse std of a channel from the reduced stats,
+ * and moves the running stats towards them, where the running variance is unbiased.
+ */
+__global__ void BatchNormForwardFinalizeKernel(const float* __restrict__ stats, int64_t c,
+                                               float eps, float momentum,
+                                               float* __restrict__ running_mean,
+                                               float* __restrict__ running_var,
+                                               float* __restrict__ mean_invstd) {
+  float count = stats[2 * c];
+  for (int64_t ch = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; ch < c;
+       ch += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    float mean = stats[ch] / count;
+    float var = fmaxf(stats[c + ch] / count - mean * mean, 0.0f);
+    mean_invstd[ch] = mean;
+    mean_invstd[c + ch] = rsqrtf(var + eps);
+    if (running_mean != nullptr) {
+      float unbiased = count > 1.0f ? var * count / (count - 1.0f) : var;
+      running_mean[ch] = (1.0f - momentum) * running_mean[ch] + momentum * mean;
+      running_var[ch] = (1.0f - momentum) * running_var[ch] + momentum * unbiased;
+    }
+  }
+}
+
+void batch_norm_forward_finalize_cuda(const float* stats, int64_t c, float eps, float momentum,
+                                      float* running_mean, float* running_var,
+                                      float* mean_invstd, void* stream) {
+  int blocks = static_cast<int>(std::min<int64_t>(
+      (std::max<int64_t>(c, 1) + kBatchNormThreads - 1) / kBatchNormThreads, kBatchNormMaxBlocks));
+  BatchNormForwardFinalizeKernel<<<blocks, kBatchNormThreads, 0,
+                                   static_cast<cudaStream_t>(stream)>>>(
+      stats, c, eps, momentum, running_mean, running_var, mean_invstd);
+}
+
+/*! \brief Each thread normalizes an element, i.e., (x - mean) * invstd * w + b. */
+template <typename T>
+__global__ void BatchNormForwardApplyKernel(const T* __restrict__ x,
+                                            const float* __restrict__ mean_invstd,
+                                            const float* __restrict__ w,
+                                            const float* __restrict__ b, int64_t outer, int64_t c,
+                                            int64_t inner, T* __restrict__ y) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+       i < outer * c * inner; i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    int64_t ch = i / inner % c;
+    float scale = mean_invstd[c + ch] * (w != nullptr ? w[ch] : 1.0f);
+    float shift = b != nullptr ? b[ch] : 0.0f;
+    y[i] = static_cast<T>((static_cast<float>(x[i]) - mean_invstd[ch]) * scale + shift);
+  }
+}
+
+template <typename T>
+void batch_norm_forward_apply_cuda(const T* x, const float* mean_invstd, const float* w,
+                                   const float* b, int64_t outer, int64_t c, int64_t inner, T* y,
+                                   void* stream) {
+  int64_t numel = outer * c * inner;
+  if (numel == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>(
+      (numel + kBatchNormThreads - 1) / kBatchNormThreads, kBatchNormMaxBlocks));
+  BatchNormForwardApplyKernel<<<blocks, kBatchNormThreads, 0, static_cast<cudaStream_t>(stream)>>>(
+      x, mean_invstd, w, b, outer, c, inner, y);
+}
+
+/*!
+ * \brief Each thread computes the coefficients of the gradient of a channel from the global
+ * stats, and the gradients of w and b from the local ones.
+ */
+__global__ void BatchNormBackwardFinalizeKernel(const float* __restrict__ global,
+                                                const float* __restrict__ local, int64_t c,
+                                                float eps, float* __restrict__ coefs,
+                                                float* __restrict__ dw, float* __restrict__ db) {
+  float count = global[4 * c];
+  for (int64_t ch = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x; ch < c;
+       ch += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    float mean = global[ch] / count;
+    float var = fmaxf(global[c + ch] / count - mean * mean, 0.0f);
+    float invstd = rsqrtf(var + eps);
+    // sum(dy * (x - mean)) = sum(dy * x) - mean * sum(dy)
+    float sum_dy_xmu = global[3 * c + ch] - mean * global[2 * c + ch];
+    coefs[ch] = mean;
+    coefs[c + ch] = invstd;
+    coefs[2 * c + ch] = global[2 * c + ch] / count;
+    coefs[3 * c + ch] = sum_dy_xmu / count * invstd * invstd;
+    if (dw != nullptr) {
+      dw[ch] = (local[3 * c + ch] - mean * local[2 * c + ch]) * invstd;
+    }
+    if (db != nullptr) {
+      db[ch] = local[2 * c + ch];
+    }
+  }
+}
+
+void batch_norm_backward_finalize_cuda(const float* global, const float* local, int64_t c,
+                                       float eps, float* coefs, float* dw, float* db,
+                                       void* stream) {
+  int blocks = static_cast<int>(std::min<int64_t>(
+      (std::max<int64_t>(c, 1) + kBatchNormThreads - 1) / kBatchNormThreads, kBatchNormMaxBlocks));
+  BatchNormBackwardFinalizeKernel<<<blocks, kBatchNormThreads, 0,
+                                    static_cast<cudaStream_t>(stream)>>>(global, local, c, eps,
+                                                                         coefs, dw, db);
+}
+
+/*! \brief Each thread computes an element of w * invstd * (dy - mean(dy) - (x - mean) * k). */
+template <typename T>
+__global__ void BatchNormBackwardApplyKernel(const T* __restrict__ dy, const T* __restrict__ x,
+                                             const float* __restrict__ coefs,
+                                             const float* __restrict__ w, int64_t outer,
+                                             int64_t c, int64_t inner, T* __restrict__ dx) {
+  for (int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+       i < outer * c * inner; i += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    int64_t ch = i / inner % c;
+    float xmu = static_cast<float>(x[i]) - coefs[ch];
+    float g = static_cast<float>(dy[i]) - coefs[2 * c + ch] - xmu * coefs[3 * c + ch];
+    dx[i] = static_cast<T>(g * coefs[c + ch] * (w != nullptr ? w[ch] : 1.0f));
+  }
+}
+
+template <typename T>
+void batch_norm_backward_apply_cuda(const T* dy, const T* x, const float* coefs, const float* w,
+                                    int64_t outer, int64_t c, int64_t inner, T* dx, void* stream) {
+  int64_t numel = outer * c * inner;
+  if (numel == 0) {
+    return;
+  }
+  int blocks = static_cast<int>(std::min<int64_t>(
+      (numel + kBatchNormThreads - 1) / kBatchNormThreads, kBatchNormMaxBlocks));
+  BatchNormBackwardApplyKernel<<<blocks, kBatchNormThreads, 0,
+                                 static_cast<cudaStream_t>(stream)>>>(dy, x, coefs, w, outer, c,
+                                                                      inner, dx);
+}
+
+template void batch_norm_reduce_cuda<float>(const float*, const float*, int64_t, int64_t, int64_t,
+                                            float*, void*);
+template void batch_norm_reduce_cuda<__half>(const __half*, const __half*, int64_t, int64_t,
+                                             int64_t, float*, void*);
+template void batch_norm_forward_apply_cuda<float>(const float*, const float*, const float*,
+                                                   const float*, int64_t, int64_t, int64_t,
+                                                   float*, void*);
+template void batch_norm_forward_apply_cuda<__half>(const __half*, const float*, const float*,
+                                                    const float*, int64_t, int64_t, int64_t,
+                                                    __half*, void*);
+template void batch_norm_backward_apply_cuda<float>(const float*, const float*, const float*,
+                                                    const float*, int64_t, int64_t, int64_t,
+                                                    float*, void*);
+template void batch_norm_backward_apply_cuda<__half>(const __half*, const __half*, const float*,
+                                                     const float*, int64_t, int64_t, int64_t,
+                                                     __half*, void*);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,160 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/kv_append.cc
+ * \brief kv_append and paged_kv_append cuda backend
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/transform.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+class KvAppendImpl : public raf::op::OpEnv {
+ public:
+  explicit KvAppendImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.kv_append");
+    auto args = cv->args.as<op::schema::KvAppendArgs>();
+    this->arg_indices = {
+        fschema_index[op]("cache"),
+        fschema_index[op]("v"),
+        fschema_index[op]("pos"),
+    };
+    const DLTensor* cache = args->cache;
+    const DLTensor* pos = args->pos;
+    int bits = cache->dtype.bits * cache->dtype.lanes;
+    if (bits % 8 != 0 || bits > 64 || (bits & (bits - 1)) != 0) {
+      this->error_msgs.push_back("[CUDA] kv_append does not support " +
+                                 std::string(DType(cache->dtype).c_str()));
+    }
+    if (DType(pos->dtype) != DType(DTypeCode::kInt(), 64)) {
+      this->error_msgs.push_back("[CUDA] kv_append only supports int64 positions");
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::KvAppendArgs>();
+    Execute(std::vector<value::Value>{args->cache, args->v, args->pos}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* cache = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* pos = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    // The cache is updated in place, so it is only copied if the output is not the cache.
+    if (out->data != cache->data) {
+      CUDA_CALL(cudaMemcpyAsync(out->data, cache->data,
+                                common::shape_utils::BytesCompactTensor(*cache),
+                                cudaMemcpyDeviceToDevice, static_cast<cudaStream_t>(stream)));
+    }
+    int ndim = cache->ndim;
+    int64_t max_len = cache->shape[ndim - 2];
+    int dim = cache->shape[ndim - 1];
+    int seq = v->shape[ndim - 2];
+    int64_t outer = 1;
+    for (int i = 0; i < ndim - 2; ++i) {
+      outer *= cache->shape[i];
+    }
+    // A scalar position is shared by all the rows.
+    bool shared = pos->ndim == 0 || pos->shape[0] == 0;
+    int64_t rows_per_pos = shared ? std::max<int64_t>(outer, 1) : outer / pos->shape[0];
+    kv_append_cuda(v->data, static_cast<const int64_t*>(pos->data), outer, seq, dim, max_len,
+                   rows_per_pos, cache->dtype.bits * cache->dtype.lanes / 8, out->data, stream);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.kv_append"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new KvAppendImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, kv_append, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.kv_append", KvAppendImpl::make);
+
+class PagedKvAppendImpl : public raf::op::OpEnv {
+ public:
+  explicit PagedKvAppendImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.paged_kv_append");
+    auto args = cv->args.as<op::schema::PagedKvAppendArgs>();
+    this->arg_indices = {
+        fschema_index[op]("cache"),
+        fschema_index[op]("v"),
+        fschema_index[op]("block_table"),
+        fschema_index[op]("pos"),
+    };
+    const DLTensor* cache = args->cache;
+    const DLTensor* block_table = args->block_table;
+    const DLTensor* pos = args->pos;
+    int bits = cache->dtype.bits * cache->dtype.lanes;
+    if (bits % 8 != 0 || bits > 64 || (bits & (bits - 1)) != 0) {
+      this->error_msgs.push_back("[CUDA] paged_kv_append does not support " +
+                                 std::string(DType(cache->dtype).c_str()));
+    }
+    if (DType(block_table->dtype) != DType(DTypeCode::kInt(), 64) ||
+        DType(pos->dtype) != DType(DTypeCode::kInt(), 64)) {
+      this->error_msgs.push_back(
+          "[CUDA] paged_kv_append only supports int64 block tables and positions");
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::PagedKvAppendArgs>();
+    Execute(std::vector<value::Value>{args->cache, args->v, args->block_table, args->pos},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* cache = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* v = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* block_table = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* pos = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* out = ir::Downcast<TensorValue>(output);
+    void* stream = cuda_device_api->GetStream();
+    if (out->data != cache->data) {
+      CUDA_CALL(cudaMemcpyAsync(out->data, cache->data,
+                                common::shape_utils::BytesCompactTensor(*cache),
+                                cudaMemcpyDeviceToDevice, static_cast<cudaStream_t>(stream)));
+    }
+    paged_kv_append_cuda(v->data, static_cast<const int64_t*>(block_table->data),
+                         static_cast<const int64_t*>(pos->data), v->shape[0], v->shape[1],
+                         v->shape[2], v->shape[3], cache->shape[2], block_table->shape[1],
+                         cache->dtype.bits * cache->dtype.lanes / 8, out->data, stream);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.paged_kv_append"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new PagedKvAppendImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, paged_kv_append, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.paged_kv_append", PagedKvAppendImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
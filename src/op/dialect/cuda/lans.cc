@@ -21,6 +21,7 @@ using namespace raf::value;
 using device_api::DeviceAPI;
 #define CHUNK_SIZE 65536
 #define FLOAT_BYTES 4
+static_assert(CHUNK_SIZE % kStateBlockSize == 0, "A state block cannot span two chunks");
 
 class LansImpl : public raf::op::OpEnv {
  public:
@@ -47,18 +48,24 @@ class LansImpl : public raf::op::OpEnv {
     grad_averaging_ = args->grad_averaging;
     mode_ = args->mode;
     normalize_grad_ = args->normalize_grad;
+    quantize_states_ = args->quantize_states;
     int64_t tensor_elements = 0;
 
     int n = args->tensor_list.size();
-    CHECK(n % 4 == 0);
-    param_group_n_ = n / 4;
+    int ngroups = quantize_states_ ? 5 : 4;
+    CHECK(n % ngroups == 0);
+    param_group_n_ = n / ngroups;
     for (int i = 0; i < param_group_n_; ++i) {
       DLTensor* t = ir::Downcast<TensorValue>(args->tensor_list[i]);
       int numel = 1;
       for (int j = 0; j < t->ndim; ++j) {
         numel *= t->shape[j];
       }
-      void* q_tensor;
+      if (quantize_states_) {
+        DLTensor* scales = ir::Downcast<TensorValue>(args->tensor_list[4 * param_group_n_ + i]);
+        CHECK_EQ(scales->shape[0], 2 * ((numel + kStateBlockSize - 1) / kStateBlockSize))
+            << "LANS expects 2 scales per " << kStateBlockSize << " elements of the 8-bit states";
+      }
       numels_.push_back(numel);
       tensor_elements += numel;
     }
@@ -117,6 +124,7 @@ class LansImpl : public raf::op::OpEnv {
     for (int i = 1; i < numels_.size(); ++i) {
       tlist.push_back(static_cast<float*>(q_tensor_buf_) + numels_[i - 1]);
     }
+    // The 8-bit states and their scales are passed as they are.
     for (int i = param_group_n_; i < tuple->fields.size(); ++i) {
       DLTensor* tensor = ir::Downcast<TensorValue>(tuple->fields[i]);
       tlist.push_back(static_cast<float*>(tensor->data));
@@ -127,7 +135,7 @@ class LansImpl : public raf::op::OpEnv {
         compute_stream_, static_cast<float*>(output_per_tensor_),
         static_cast<float*>(grad_norm_tensor_), static_cast<float*>(param_norm_tensor_),
         static_cast<float*>(update_m_norm_), static_cast<float*>(q_norm_tensor_),
-        max_chunks_per_tensor_);
+        max_chunks_per_tensor_, quantize_states_);
   }
 
   std::string name() const override {
@@ -148,6 +156,8 @@ class LansImpl : public raf::op::OpEnv {
   int grad_averaging_;
   int mode_;
   bool normalize_grad_;
+  /*! \brief Whether the moments are 8-bit with the block scales. */
+  bool quantize_states_;
   std::vector<int> numels_;
   int param_group_n_;
   void* output_per_tensor_;
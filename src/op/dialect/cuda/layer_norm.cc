@@ -268,6 +268,472 @@ class LayerNormTrainDxImpl : public raf::op::OpEnv {
 RAF_REGISTER_DIALECT_OP(cuda, layer_norm_train_dx, 20);
 RAF_OP_ENV_MAKER("raf.op.cuda.layer_norm_train_dx", LayerNormTrainDxImpl::make);
 
+/*! \brief Get the number of rows and the row size of the normalization over the last axis. */
+void GetLastAxisRows(const DLTensor* x, int* n1, int* n2) {
+  int64_t rows = 1;
+  for (int i = 0; i < x->ndim - 1; ++i) {
+    rows *= x->shape[i];
+  }
+  *n1 = rows;
+  *n2 = x->shape[x->ndim - 1];
+  CHECK(x->dtype.code == kDLFloat);
+  CHECK((x->dtype.bits == 32) || (x->dtype.bits == 16));
+}
+
+class AddDropoutLayerNormImpl : public raf::op::OpEnv {
+ public:
+  explicit AddDropoutLayerNormImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.add_dropout_layer_norm");
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("residual"),
+        fschema_index[op]("scale"),
+        fschema_index[op]("bias"),
+    };
+    eps_ = args->eps;
+    p_ = args->p;
+    seed_ = static_cast<uint64_t>(args->seed);
+    GetLastAxisRows(args->x, &n1_, &n2_);
+
+    cudaDeviceProp deviceProp;
+    CUDA_CALL(cudaGetDeviceProperties(&deviceProp, cv->device.device_id()));
+    maxGridY_ = deviceProp.maxGridSize[1];
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormArgs>();
+    Execute(std::vector<Value>{args->x, args->residual, args->scale, args->bias}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* x = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* residual = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* bias = ir::Downcast<TensorValue>(inputs[3]);
+
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* out = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* mean = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* invvar = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    DLTensor* pre_norm = ir::Downcast<TensorValue>(out_tuple->fields[3]);
+    DLTensor* mask = ir::Downcast<TensorValue>(out_tuple->fields[4]);
+    float* mean_p = static_cast<float*>(mean->data);
+    float* invvar_p = static_cast<float*>(invvar->data);
+    uint8_t* mask_p = p_ > 0 ? static_cast<uint8_t*>(mask->data) : nullptr;
+    // Draw a new dropout mask in every run of this op.
+    uint64_t seed = seed_ + (run_count_++) * 0xD1B54A32D192ED03ull;
+    switch (x->dtype.bits) {
+      case 16: {
+        HostApplyAddDropoutLayerNorm<Half>(
+            static_cast<Half*>(out->data), mean_p, invvar_p, static_cast<Half*>(pre_norm->data),
+            mask_p, static_cast<Half*>(x->data), static_cast<Half*>(residual->data), n1_, n2_,
+            static_cast<Half*>(scale->data), static_cast<Half*>(bias->data), eps_, p_, seed,
+            compute_stream_, maxGridY_);
+        break;
+      }
+      case 32: {
+        HostApplyAddDropoutLayerNorm<float>(
+            static_cast<float*>(out->data), mean_p, invvar_p, static_cast<float*>(pre_norm->data),
+            mask_p, static_cast<float*>(x->data), static_cast<float*>(residual->data), n1_, n2_,
+            static_cast<float*>(scale->data), static_cast<float*>(bias->data), eps_, p_, seed,
+            compute_stream_, maxGridY_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(x->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.add_dropout_layer_norm"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AddDropoutLayerNormImpl(cv);
+  }
+
+ private:
+  double eps_;
+  float p_;
+  uint64_t seed_;
+  /*! \brief The number of runs, which is mixed into the seed of the dropout. */
+  uint64_t run_count_ = 0;
+  int n1_, n2_;
+  uint64_t maxGridY_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, add_dropout_layer_norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.add_dropout_layer_norm", AddDropoutLayerNormImpl::make);
+
+class AddDropoutLayerNormDxImpl : public raf::op::OpEnv {
+ public:
+  explicit AddDropoutLayerNormDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto dx_op = ir::Op::Get("raf.op.add_dropout_layer_norm_dx");
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormDxArgs>();
+    this->arg_indices = {
+        fschema_index[dx_op]("dy"),     fschema_index[dx_op]("pre_norm"),
+        fschema_index[dx_op]("scale"),  fschema_index[dx_op]("mean"),
+        fschema_index[dx_op]("invvar"), fschema_index[dx_op]("mask"),
+    };
+    eps_ = args->eps;
+    p_ = args->p;
+    const DLTensor* dy = args->dy;
+    GetLastAxisRows(dy, &n1_, &n2_);
+    const int part_size = 16;
+    RequestWorkspace(&part_grad_gamma_, dy->device, 4 * part_size * n2_);
+    RequestWorkspace(&part_grad_beta_, dy->device, 4 * part_size * n2_);
+
+    cudaDeviceProp deviceProp;
+    CUDA_CALL(cudaGetDeviceProperties(&deviceProp, cv->device.device_id()));
+    maxGridY_ = deviceProp.maxGridSize[1];
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormDxArgs>();
+    Execute(std::vector<Value>{args->dy, args->pre_norm, args->scale, args->mean, args->invvar,
+                               args->mask},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* pre_norm = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* mean = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* invvar = ir::Downcast<TensorValue>(inputs[4]);
+    DLTensor* mask = ir::Downcast<TensorValue>(inputs[5]);
+    float* mean_p = static_cast<float*>(mean->data);
+    float* invvar_p = static_cast<float*>(invvar->data);
+    const uint8_t* mask_p = p_ > 0 ? static_cast<const uint8_t*>(mask->data) : nullptr;
+
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* dx = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* dresidual = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* dw = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    DLTensor* db = ir::Downcast<TensorValue>(out_tuple->fields[3]);
+    float* part_grad_gamma = static_cast<float*>(part_grad_gamma_);
+    float* part_grad_beta = static_cast<float*>(part_grad_beta_);
+    int64_t n = static_cast<int64_t>(n1_) * n2_;
+    // The gradient of the residual is the gradient of the layer_norm input, and the gradient of
+    // x applies the kept dropout mask to it.
+    switch (dy->dtype.bits) {
+      case 16: {
+        HostLayerNormGradient<Half, Half>(
+            static_cast<Half*>(dy->data), mean_p, invvar_p, static_cast<Half*>(pre_norm->data),
+            n1_, n2_, static_cast<Half*>(scale->data), eps_, static_cast<Half*>(dresidual->data),
+            static_cast<Half*>(dw->data), static_cast<Half*>(db->data), part_grad_gamma,
+            part_grad_beta, compute_stream_, maxGridY_);
+        HostDropoutGradient<Half>(static_cast<Half*>(dresidual->data), mask_p, n, p_,
+                                  static_cast<Half*>(dx->data), compute_stream_);
+        break;
+      }
+      case 32: {
+        HostLayerNormGradient<float, float>(
+            static_cast<float*>(dy->data), mean_p, invvar_p, static_cast<float*>(pre_norm->data),
+            n1_, n2_, static_cast<float*>(scale->data), eps_,
+            static_cast<float*>(dresidual->data), static_cast<float*>(dw->data),
+            static_cast<float*>(db->data), part_grad_gamma, part_grad_beta, compute_stream_,
+            maxGridY_);
+        HostDropoutGradient<float>(static_cast<float*>(dresidual->data), mask_p, n, p_,
+                                   static_cast<float*>(dx->data), compute_stream_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(dy->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.add_dropout_layer_norm_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new AddDropoutLayerNormDxImpl(cv);
+  }
+
+ private:
+  double eps_;
+  float p_;
+  int n1_, n2_;
+  void* part_grad_gamma_ = nullptr;
+  void* part_grad_beta_ = nullptr;
+  uint64_t maxGridY_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, add_dropout_layer_norm_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.add_dropout_layer_norm_dx", AddDropoutLayerNormDxImpl::make);
+
+class EmbeddingLayerNormImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingLayerNormImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.embedding_layer_norm");
+    auto args = cv->args.as<op::schema::EmbeddingLayerNormArgs>();
+    this->arg_indices = {
+        fschema_index[op]("word"),    fschema_index[op]("word_ids"), fschema_index[op]("pos"),
+        fschema_index[op]("pos_ids"), fschema_index[op]("scale"),    fschema_index[op]("bias"),
+    };
+    has_token_type_ = args->token_type.defined();
+    if (has_token_type_) {
+      this->arg_indices.push_back(fschema_index[op]("token_type"));
+      this->arg_indices.push_back(fschema_index[op]("token_type_ids"));
+    }
+    eps_ = args->eps;
+    p_ = args->p;
+    seed_ = static_cast<uint64_t>(args->seed);
+    TupleValue out_tuple = ir::Downcast<TupleValue>(cv->out);
+    GetLastAxisRows(ir::Downcast<TensorValue>(out_tuple->fields[0]), &n1_, &n2_);
+    const DLTensor* word_ids = args->word_ids;
+    ids_bits_ = word_ids->dtype.bits;
+    std::vector<const DLTensor*> ids{word_ids, args->pos_ids};
+    if (has_token_type_) {
+      ids.push_back(args->token_type_ids.value());
+    }
+    for (const DLTensor* id : ids) {
+      if (id->dtype.code != kDLInt || (id->dtype.bits != 32 && id->dtype.bits != 64) ||
+          id->dtype.bits != ids_bits_) {
+        this->error_msgs.push_back("[CUDA] embedding_layer_norm expects the int32 or int64 ids");
+        return;
+      }
+    }
+
+    cudaDeviceProp deviceProp;
+    CUDA_CALL(cudaGetDeviceProperties(&deviceProp, cv->device.device_id()));
+    maxGridY_ = deviceProp.maxGridSize[1];
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::EmbeddingLayerNormArgs>();
+    std::vector<Value> inputs{args->word,    args->word_ids, args->pos,
+                              args->pos_ids, args->scale,    args->bias};
+    if (has_token_type_) {
+      inputs.push_back(args->token_type.value());
+      inputs.push_back(args->token_type_ids.value());
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* out = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* mean = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* invvar = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    DLTensor* sum = ir::Downcast<TensorValue>(out_tuple->fields[3]);
+    DLTensor* mask = ir::Downcast<TensorValue>(out_tuple->fields[4]);
+    std::vector<void*> data;
+    for (const auto& input : inputs) {
+      data.push_back(ir::Downcast<TensorValue>(input)->data);
+    }
+    if (!has_token_type_) {
+      data.push_back(nullptr);
+      data.push_back(nullptr);
+    }
+    float* mean_p = static_cast<float*>(mean->data);
+    float* invvar_p = static_cast<float*>(invvar->data);
+    uint8_t* mask_p = p_ > 0 ? static_cast<uint8_t*>(mask->data) : nullptr;
+    // Draw a new dropout mask in every run of this op.
+    uint64_t seed = seed_ + (run_count_++) * 0xD1B54A32D192ED03ull;
+    switch (out->dtype.bits) {
+      case 16: {
+        Launch<Half>(out, mean_p, invvar_p, sum, mask_p, data, seed);
+        break;
+      }
+      case 32: {
+        Launch<float>(out, mean_p, invvar_p, sum, mask_p, data, seed);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(out->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_layer_norm"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingLayerNormImpl(cv);
+  }
+
+ private:
+  /*!
+   * \brief Launch the kernel of the ids of int32 or int64, where data holds the inputs in the
+   * order of the arg indices, and the null token type table and ids if absent.
+   */
+  template <typename T>
+  void Launch(DLTensor* out, float* mean, float* invvar, DLTensor* sum, uint8_t* mask,
+              const std::vector<void*>& data, uint64_t seed) {
+    auto table = [&](int i) { return static_cast<const T*>(data[i]); };
+    if (ids_bits_ == 64) {
+      auto ids = [&](int i) { return static_cast<const int64_t*>(data[i]); };
+      HostApplyEmbeddingLayerNorm<T, int64_t>(
+          static_cast<T*>(out->data), mean, invvar, static_cast<T*>(sum->data), mask, table(0),
+          ids(1), table(2), ids(3), table(6), ids(7), n1_, n2_, table(4), table(5), eps_, p_, seed,
+          compute_stream_, maxGridY_);
+    } else {
+      auto ids = [&](int i) { return static_cast<const int32_t*>(data[i]); };
+      HostApplyEmbeddingLayerNorm<T, int32_t>(
+          static_cast<T*>(out->data), mean, invvar, static_cast<T*>(sum->data), mask, table(0),
+          ids(1), table(2), ids(3), table(6), ids(7), n1_, n2_, table(4), table(5), eps_, p_, seed,
+          compute_stream_, maxGridY_);
+    }
+  }
+
+  double eps_;
+  float p_;
+  uint64_t seed_;
+  /*! \brief The number of runs, which is mixed into the seed of the dropout. */
+  uint64_t run_count_ = 0;
+  bool has_token_type_;
+  int ids_bits_;
+  int n1_, n2_;
+  uint64_t maxGridY_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_layer_norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_layer_norm", EmbeddingLayerNormImpl::make);
+
+class EmbeddingLayerNormDxImpl : public raf::op::OpEnv {
+ public:
+  explicit EmbeddingLayerNormDxImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto dx_op = ir::Op::Get("raf.op.embedding_layer_norm_dx");
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormDxArgs>();
+    this->arg_indices = {
+        fschema_index[dx_op]("dy"),     fschema_index[dx_op]("pre_norm"),
+        fschema_index[dx_op]("scale"),  fschema_index[dx_op]("mean"),
+        fschema_index[dx_op]("invvar"), fschema_index[dx_op]("mask"),
+    };
+    eps_ = args->eps;
+    p_ = args->p;
+    const DLTensor* dy = args->dy;
+    GetLastAxisRows(dy, &n1_, &n2_);
+    const int part_size = 16;
+    RequestWorkspace(&part_grad_gamma_, dy->device, 4 * part_size * n2_);
+    RequestWorkspace(&part_grad_beta_, dy->device, 4 * part_size * n2_);
+    if (p_ > 0) {
+      // The gradient of the layer_norm output, i.e., dy with the dropout mask applied.
+      RequestWorkspace(&dnorm_, dy->device,
+                       static_cast<int64_t>(n1_) * n2_ * ((dy->dtype.bits + 7) / 8));
+    }
+
+    cudaDeviceProp deviceProp;
+    CUDA_CALL(cudaGetDeviceProperties(&deviceProp, cv->device.device_id()));
+    maxGridY_ = deviceProp.maxGridSize[1];
+
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AddDropoutLayerNormDxArgs>();
+    Execute(std::vector<Value>{args->dy, args->pre_norm, args->scale, args->mean, args->invvar,
+                               args->mask},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* dy = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* pre_norm = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* scale = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* mean = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* invvar = ir::Downcast<TensorValue>(inputs[4]);
+    DLTensor* mask = ir::Downcast<TensorValue>(inputs[5]);
+    float* mean_p = static_cast<float*>(mean->data);
+    float* invvar_p = static_cast<float*>(invvar->data);
+
+    TupleValue out_tuple = ir::Downcast<TupleValue>(output);
+    DLTensor* dsum = ir::Downcast<TensorValue>(out_tuple->fields[0]);
+    DLTensor* dw = ir::Downcast<TensorValue>(out_tuple->fields[1]);
+    DLTensor* db = ir::Downcast<TensorValue>(out_tuple->fields[2]);
+    float* part_grad_gamma = static_cast<float*>(part_grad_gamma_);
+    float* part_grad_beta = static_cast<float*>(part_grad_beta_);
+    int64_t n = static_cast<int64_t>(n1_) * n2_;
+    switch (dy->dtype.bits) {
+      case 16: {
+        Half* dnorm = static_cast<Half*>(dy->data);
+        if (p_ > 0) {
+          dnorm = static_cast<Half*>(dnorm_);
+          HostDropoutGradient<Half>(static_cast<Half*>(dy->data),
+                                    static_cast<const uint8_t*>(mask->data), n, p_, dnorm,
+                                    compute_stream_);
+        }
+        HostLayerNormGradient<Half, Half>(
+            dnorm, mean_p, invvar_p, static_cast<Half*>(pre_norm->data), n1_, n2_,
+            static_cast<Half*>(scale->data), eps_, static_cast<Half*>(dsum->data),
+            static_cast<Half*>(dw->data), static_cast<Half*>(db->data), part_grad_gamma,
+            part_grad_beta, compute_stream_, maxGridY_);
+        break;
+      }
+      case 32: {
+        float* dnorm = static_cast<float*>(dy->data);
+        if (p_ > 0) {
+          dnorm = static_cast<float*>(dnorm_);
+          HostDropoutGradient<float>(static_cast<float*>(dy->data),
+                                     static_cast<const uint8_t*>(mask->data), n, p_, dnorm,
+                                     compute_stream_);
+        }
+        HostLayerNormGradient<float, float>(
+            dnorm, mean_p, invvar_p, static_cast<float*>(pre_norm->data), n1_, n2_,
+            static_cast<float*>(scale->data), eps_, static_cast<float*>(dsum->data),
+            static_cast<float*>(dw->data), static_cast<float*>(db->data), part_grad_gamma,
+            part_grad_beta, compute_stream_, maxGridY_);
+        break;
+      }
+      default: {
+        LOG(FATAL) << "Unsupported dtype: " << DType(dy->dtype).c_str();
+        throw;
+      }
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.embedding_layer_norm_dx"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new EmbeddingLayerNormDxImpl(cv);
+  }
+
+ private:
+  double eps_;
+  float p_;
+  int n1_, n2_;
+  void* part_grad_gamma_ = nullptr;
+  void* part_grad_beta_ = nullptr;
+  void* dnorm_ = nullptr;
+  uint64_t maxGridY_;
+  void* compute_stream_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, embedding_layer_norm_dx, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.embedding_layer_norm_dx", EmbeddingLayerNormDxImpl::make);
+
 }  // namespace cuda
 }  // namespace op
 }  // namespace raf
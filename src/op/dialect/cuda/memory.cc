@@ -5,7 +5,7 @@
 
 /*!
  * \file src/op/dialect/cuda/memory.cc
- * \brief Tensor fusion and defusion operators with asynchronous CUDA memory copy.
+ * \brief Tensor fusion and defusion operators, which copy all the tensors in one launch.
  */
 #include <cuda_runtime.h>
 #include <vector>
@@ -14,6 +14,7 @@
 #include "../../schema/memory.h"
 #include "../../../common/shape_utils.h"
 #include "../../../common/cuda_utils.h"
+#include "./kernels/kernel_util.cuh"
 
 namespace raf {
 namespace op {
@@ -60,14 +61,16 @@ class CudaFuseTensor : public raf::op::OpEnv {
     // Fuse Tensor
     DLTensor* out = output;
     auto tv = Downcast<value::TupleValue>(inputs[0]);
+    std::vector<CopySegment> segments;
     size_t offset = 0;
     for (int i = 0; i < tv->fields.size(); ++i) {
       DLTensor* x = tv->fields[i];
       void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(out->data) + offset;
-      CUDA_CALL(cudaMemcpyAsync(buffer_data_at_offset, x->data, tuple_sizes[i],
-                                cudaMemcpyDeviceToDevice, (cudaStream_t)stream));
+      segments.push_back({x->data, buffer_data_at_offset, 1, tuple_sizes[i], tuple_sizes[i],
+                          tuple_sizes[i]});
       offset += tuple_sizes[i];
     }
+    multi_tensor_copy_cuda(segments, stream);
   }
 
   static OpEnv* make(const CallValues& cv) {
@@ -115,14 +118,16 @@ class CudaDefuseTensor : public raf::op::OpEnv {
     DLTensor* in = inputs[0];
     int64_t nbytes = (in->dtype.bits + 7) / 8;
     auto& of = Downcast<value::TupleValue>(output)->fields;
+    std::vector<CopySegment> segments;
     size_t offset = 0;
     for (int i = 0; i < tuple_sizes.size(); ++i) {
       DLTensor* x = of[i];
       void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(in->data) + offset;
-      CUDA_CALL(cudaMemcpyAsync(x->data, buffer_data_at_offset, tuple_sizes[i],
-                                cudaMemcpyDeviceToDevice, (cudaStream_t)stream));
+      segments.push_back({buffer_data_at_offset, x->data, 1, tuple_sizes[i], tuple_sizes[i],
+                          tuple_sizes[i]});
       offset += tuple_sizes[i];
     }
+    multi_tensor_copy_cuda(segments, stream);
   }
 
   static OpEnv* make(const CallValues& cv) {
@@ -0,0 +1,246 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/multi_tensor.cc
+ * \brief Multi-tensor scale, group_cast, global L2 norm and clip-by-global-norm cuda backend
+ */
+#include <limits>
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/optimizer.h"
+#include "../../schema/transform.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief The number of elements processed by a thread block. */
+constexpr int kMultiTensorChunkSize = 65536;
+
+/*!
+ * \brief The base of the multi-tensor ops, which launch the kernels of the whole tensor list in
+ * as few launches as possible instead of a kernel per tensor.
+ */
+class MultiTensorOpEnv : public raf::op::OpEnv {
+ protected:
+  /*! \brief Collect the sizes of the tensors, and fall back if their dtype has no kernels. */
+  void Init(const CallValues& cv, const std::string& op_name,
+            const std::vector<BaseTensorValue>& tensor_list) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    this->arg_indices = {fschema_index[ir::Op::Get(op_name)]("tensor_list")};
+    const DLTensor* x0 = tensor_list[0];
+    dtype_ = x0->dtype;
+    if (!multi_tensor_dtype_supported(dtype_)) {
+      this->error_msgs.push_back("[CUDA] Multi-tensor ops do not support " +
+                                 std::string(DType(dtype_).c_str()));
+    }
+    max_chunks_per_tensor_ = 0;
+    for (const auto& t : tensor_list) {
+      const DLTensor* x = t;
+      if (DType(x->dtype) != DType(dtype_)) {
+        // The kernels are instantiated for one input dtype, e.g., group_cast may mix them.
+        this->error_msgs.push_back("[CUDA] Multi-tensor ops expect the inputs of the same dtype");
+      }
+      int64_t numel = 1;
+      for (int j = 0; j < x->ndim; ++j) {
+        numel *= x->shape[j];
+      }
+      CHECK_LE(numel, std::numeric_limits<int>::max())
+          << "The tensor is too large for multi-tensor ops";
+      numels_.push_back(numel);
+      int nchunks = (numel + kMultiTensorChunkSize - 1) / kMultiTensorChunkSize;
+      max_chunks_per_tensor_ = std::max(max_chunks_per_tensor_, nchunks);
+    }
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  /*! \brief Request the workspace of the partial sums of the global norm. */
+  void RequestNormWorkspace(const CallValues& cv) {
+    RequestWorkspace(&partials_, cv->device,
+                     sizeof(float) * numels_.size() * std::max(max_chunks_per_tensor_, 1));
+  }
+
+  /*! \brief Pack the tensor list of the schema into the tuple of the inputs. */
+  static Value MakeTuple(const std::vector<BaseTensorValue>& tensor_list) {
+    Array<Value> fields = {tensor_list.begin(), tensor_list.end()};
+    return TupleValue::make(fields);
+  }
+
+  /*! \brief Get the data pointers of the first n fields of the tuple. */
+  static std::vector<void*> GetData(const Value& value, size_t n) {
+    TupleValue tuple = ir::Downcast<TupleValue>(value);
+    std::vector<void*> data;
+    for (size_t i = 0; i < n; ++i) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(tuple->fields[i]);
+      data.push_back(tensor->data);
+    }
+    return data;
+  }
+
+  /*! \brief The global L2 norm of the tensors into norm on the device. */
+  void GlobalNorm(const std::vector<void*>& tensor_list, float* norm) {
+    multi_tensor_global_norm_cuda(kMultiTensorChunkSize, tensor_list, numels_, dtype_,
+                                  static_cast<float*>(partials_), max_chunks_per_tensor_, norm,
+                                  compute_stream_);
+  }
+
+  /*! \brief The dtype of the inputs. */
+  DLDataType dtype_;
+  std::vector<int> numels_;
+  int max_chunks_per_tensor_;
+  void* partials_ = nullptr;
+  void* compute_stream_;
+};
+
+class MultiTensorScaleImpl : public MultiTensorOpEnv {
+ public:
+  explicit MultiTensorScaleImpl(const CallValues& cv, bool group_cast) : group_cast_(group_cast) {
+    std::string dtype;
+    if (group_cast) {
+      auto args = cv->args.as<op::schema::GroupCastArgs>();
+      Init(cv, "raf.op.group_cast", args->tensor_list);
+      dtype = args->dtype;
+      scale_ = 1.0f;
+    } else {
+      auto args = cv->args.as<op::schema::MultiTensorScaleArgs>();
+      Init(cv, "raf.op.multi_tensor_scale", args->tensor_list);
+      dtype = args->dtype;
+      scale_ = args->scale;
+    }
+    out_dtype_ = dtype.empty() ? dtype_ : ir::String2DLDataType(dtype);
+    if (!multi_tensor_dtype_supported(out_dtype_)) {
+      this->error_msgs.push_back("[CUDA] Multi-tensor ops do not support " +
+                                 std::string(DType(out_dtype_).c_str()));
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    if (group_cast_) {
+      auto args = cv->args.as<op::schema::GroupCastArgs>();
+      Execute(std::vector<Value>{MakeTuple(args->tensor_list)}, cv->out);
+    } else {
+      auto args = cv->args.as<op::schema::MultiTensorScaleArgs>();
+      Execute(std::vector<Value>{MakeTuple(args->tensor_list)}, cv->out);
+    }
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    size_t n = numels_.size();
+    std::vector<void*> tlist = GetData(inputs[0], n);
+    std::vector<void*> outputs = GetData(output, n);
+    tlist.insert(tlist.end(), outputs.begin(), outputs.end());
+    multi_tensor_scale_cuda(kMultiTensorChunkSize, tlist, numels_, dtype_, out_dtype_, scale_,
+                            nullptr, 0.0f, 0.0f, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(group_cast_ ? "raf.op.cuda.group_cast"
+                                                  : "raf.op.cuda.multi_tensor_scale"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorScaleImpl(cv, false);
+  }
+
+  static OpEnv* make_group_cast(const CallValues& cv) {
+    return new MultiTensorScaleImpl(cv, true);
+  }
+
+ private:
+  bool group_cast_;
+  float scale_;
+  DLDataType out_dtype_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_scale, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_scale", MultiTensorScaleImpl::make);
+RAF_REGISTER_DIALECT_OP(cuda, group_cast, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.group_cast", MultiTensorScaleImpl::make_group_cast);
+
+class MultiTensorL2normImpl : public MultiTensorOpEnv {
+ public:
+  explicit MultiTensorL2normImpl(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::MultiTensorL2normArgs>();
+    Init(cv, "raf.op.multi_tensor_l2norm", args->tensor_list);
+    RequestNormWorkspace(cv);
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::MultiTensorL2normArgs>();
+    Execute(std::vector<Value>{MakeTuple(args->tensor_list)}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* norm = ir::Downcast<TensorValue>(output);
+    GlobalNorm(GetData(inputs[0], numels_.size()), static_cast<float*>(norm->data));
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_tensor_l2norm"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorL2normImpl(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_l2norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_l2norm", MultiTensorL2normImpl::make);
+
+class MultiTensorClipByGlobalNormImpl : public MultiTensorOpEnv {
+ public:
+  explicit MultiTensorClipByGlobalNormImpl(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::MultiTensorClipByGlobalNormArgs>();
+    Init(cv, "raf.op.multi_tensor_clip_by_global_norm", args->tensor_list);
+    RequestNormWorkspace(cv);
+    max_norm_ = args->max_norm;
+    eps_ = args->eps;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::MultiTensorClipByGlobalNormArgs>();
+    Execute(std::vector<Value>{MakeTuple(args->tensor_list)}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    size_t n = numels_.size();
+    std::vector<void*> tlist = GetData(inputs[0], n);
+    std::vector<void*> outputs = GetData(output, n + 1);
+    // The norm is the last output, which is only read on the device by the scaling.
+    float* norm = static_cast<float*>(outputs.back());
+    outputs.pop_back();
+    GlobalNorm(tlist, norm);
+    tlist.insert(tlist.end(), outputs.begin(), outputs.end());
+    multi_tensor_scale_cuda(kMultiTensorChunkSize, tlist, numels_, dtype_, dtype_, 1.0f, norm,
+                            max_norm_, eps_, compute_stream_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.multi_tensor_clip_by_global_norm"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MultiTensorClipByGlobalNormImpl(cv);
+  }
+
+ private:
+  float max_norm_;
+  float eps_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, multi_tensor_clip_by_global_norm, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.multi_tensor_clip_by_global_norm",
+                 MultiTensorClipByGlobalNormImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
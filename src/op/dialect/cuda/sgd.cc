@@ -0,0 +1,97 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/sgd.cc
+ * \brief sparse_sgd cuda backend
+ */
+#include "raf/op.h"
+#include "raf/device_api.h"
+#include "../../schema/optimizer.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+class SparseSgdImpl : public raf::op::OpEnv {
+ public:
+  explicit SparseSgdImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.sparse_sgd");
+    auto args = cv->args.as<op::schema::SparseSgdArgs>();
+    this->arg_indices = {
+        fschema_index[op]("x"),
+        fschema_index[op]("rows"),
+        fschema_index[op]("values"),
+        fschema_index[op]("v"),
+    };
+    learning_rate_ = args->learning_rate;
+    mu_ = args->mu;
+    DType f32(DTypeCode::kFloat(), 32);
+    const DLTensor* x = args->x;
+    const DLTensor* values = args->values;
+    const DLTensor* v = args->v;
+    if (DType(x->dtype) != f32 || DType(values->dtype) != f32 || DType(v->dtype) != f32) {
+      this->error_msgs.push_back("[CUDA] The sparse SGD only supports float32");
+    }
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::SparseSgdArgs>();
+    Execute(std::vector<value::Value>{args->x, args->rows, args->values, args->v}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* x0 = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* rows = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* values = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* v0 = ir::Downcast<TensorValue>(inputs[3]);
+    TupleValue out = ir::Downcast<TupleValue>(output);
+    DLTensor* v1 = ir::Downcast<TensorValue>(out->fields[0]);
+    DLTensor* x1 = ir::Downcast<TensorValue>(out->fields[1]);
+    void* stream = cuda_device_api->GetStream();
+    // The update is in place, so the inputs are only copied if the outputs are not the inputs.
+    int64_t nbytes = common::shape_utils::BytesCompactTensor(*x0);
+    if (x1->data != x0->data) {
+      CUDA_CALL(cudaMemcpyAsync(x1->data, x0->data, nbytes, cudaMemcpyDeviceToDevice,
+                                static_cast<cudaStream_t>(stream)));
+    }
+    if (v1->data != v0->data) {
+      CUDA_CALL(cudaMemcpyAsync(v1->data, v0->data, nbytes, cudaMemcpyDeviceToDevice,
+                                static_cast<cudaStream_t>(stream)));
+    }
+    int64_t nrows = rows->shape[0];
+    int stride = x0->shape[0] > 0 ? common::shape_utils::GetNumel(*x0) / x0->shape[0] : 0;
+    sparse_sgd_cuda(static_cast<const int64_t*>(rows->data),
+                    static_cast<const float*>(values->data), nrows, stride, learning_rate_, mu_,
+                    static_cast<float*>(v1->data), static_cast<float*>(x1->data), stream);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.sparse_sgd"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new SparseSgdImpl(cv);
+  }
+
+ private:
+  float learning_rate_;
+  float mu_;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, sparse_sgd, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.sparse_sgd", SparseSgdImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
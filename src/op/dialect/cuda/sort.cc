@@ -0,0 +1,195 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/sort.cc
+ * \brief sort, argsort and topk cuda backend by radix sort
+ */
+#include <limits>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/algorithm.h"
+#include "../../../common/shape_utils.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*!
+ * \brief Sort the data along the last axis, and take the first k sorted values and indices. The
+ * segments, i.e., the rows of the last axis, are sorted by the segmented radix sort of CUB, or the
+ * device-wide radix sort if there is only one, e.g., the logits of a single sequence.
+ */
+class SortImpl : public raf::op::OpEnv {
+ public:
+  void Init(const CallValues& cv, const std::string& op_name, const DLTensor* data, int axis,
+            int64_t k, bool is_ascend) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    op_name_ = op_name;
+    this->arg_indices = {fschema_index[ir::Op::Get(op_name)]("data")};
+    if (axis < 0) {
+      axis += data->ndim;
+    }
+    if (axis != data->ndim - 1) {
+      this->error_msgs.push_back("[CUDA] Only sorting along the last axis is supported");
+      return;
+    }
+    DLDataType dtype = data->dtype;
+    bool is_float = dtype.code == kDLFloat && (dtype.bits == 32 || dtype.bits == 16);
+    bool is_int = dtype.code == kDLInt && (dtype.bits == 32 || dtype.bits == 64);
+    if (!is_float && !is_int) {
+      this->error_msgs.push_back("[CUDA] The keys of radix sort are float32/16 or int32/64");
+      return;
+    }
+    if (index_dtype_.code != kDLInt || (index_dtype_.bits != 32 && index_dtype_.bits != 64)) {
+      this->error_msgs.push_back("[CUDA] The indices of radix sort are int32 or int64");
+      return;
+    }
+    len_ =data->ndim > 0 ? data->shape[axis] : 1;
+    num_segments_ = len_ > 0 ? common::shape_utils::GetNumel(*data) / len_ : 0;
+    if (num_segments_ * len_ > std::numeric_limits<int>::max()) {
+      this->error_msgs.push_back("[CUDA] Radix sort supports less than 2^31 elements");
+      return;
+    }
+    k_ = k;
+    is_ascend_ = is_ascend;
+    key_dtype_ = dtype;
+    size_t workspace_size = Dispatch(nullptr, nullptr, nullptr, nullptr);
+    RequestWorkspace(&workspace_, cv->device, workspace_size);
+  }
+
+  void Execute(const CallValues& cv) override {
+    Value data;
+    if (auto args = cv->args.as<op::schema::SortArgs>()) {
+      data = args->data;
+    } else if (auto args = cv->args.as<op::schema::ArgsortArgs>()) {
+      data = args->data;
+    } else {
+      data = cv->args.as<op::schema::TopkArgs>()->data;
+    }
+    Execute(std::vector<Value>{data}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* values = nullptr;
+    DLTensor* indices = nullptr;
+    if (auto tuple = output.as<TupleValueObj>()) {
+      values = ir::Downcast<TensorValue>(tuple->fields[0]);
+      indices = ir::Downcast<TensorValue>(tuple->fields[1]);
+    } else if (returns_values_) {
+      values = ir::Downcast<TensorValue>(output);
+    } else {
+      indices = ir::Downcast<TensorValue>(output);
+    }
+    Dispatch(data, values, indices, workspace_);
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(op_name_));
+  }
+
+  /*! \brief Make a sort, which only returns the values. */
+  static OpEnv* make_sort(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::SortArgs>();
+    const DLTensor* data = args->data;
+    auto env = new SortImpl(/*returns_values=*/true, DLDataType{kDLInt, 32, 1});
+    env->Init(cv, "raf.op.sort", data, args->axis, -1, args->is_ascend);
+    return env;
+  }
+
+  /*! \brief Make an argsort, which only returns the indices. */
+  static OpEnv* make_argsort(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::ArgsortArgs>();
+    const DLTensor* data = args->data;
+    auto env = new SortImpl(/*returns_values=*/false, ir::String2DLDataType(args->dtype));
+    env->Init(cv, "raf.op.argsort", data, args->axis, -1, args->is_ascend);
+    return env;
+  }
+
+  /*! \brief Make a topk, which returns the values, the indices or both per ret_type. */
+  static OpEnv* make_topk(const CallValues& cv) {
+    auto args = cv->args.as<op::schema::TopkArgs>();
+    const DLTensor* data = args->data;
+    int64_t k = args->k.defined() ? GetScalarValueData<int64_t>(args->k) : 1;
+    auto env = new SortImpl(/*returns_values=*/args->ret_type != "indices",
+                            ir::String2DLDataType(args->dtype));
+    env->Init(cv, "raf.op.topk", data, args->axis, k, args->is_ascend);
+    return env;
+  }
+
+ private:
+  SortImpl(bool returns_values, DLDataType index_dtype)
+      : returns_values_(returns_values), index_dtype_(index_dtype) {
+  }
+
+  /*!
+   * \brief Run the sort of the key and index dtypes, or only return the bytes of its workspace if
+   * data is nullptr.
+   */
+  size_t Dispatch(const DLTensor* data, DLTensor* values, DLTensor* indices, void* workspace) {
+    if (index_dtype_.code == kDLInt && index_dtype_.bits == 64) {
+      return DispatchKey<int64_t>(data, values, indices, workspace);
+    }
+    CHECK(index_dtype_.code == kDLInt && index_dtype_.bits == 32)
+        << "The indices of radix sort are int32 or int64";
+    return DispatchKey<int32_t>(data, values, indices, workspace);
+  }
+
+  template <typename I>
+  size_t DispatchKey(const DLTensor* data, DLTensor* values, DLTensor* indices, void* workspace) {
+    if (key_dtype_.code == kDLFloat) {
+      return key_dtype_.bits == 32 ? Run<float, I>(data, values, indices, workspace)
+                                   : Run<__half, I>(data, values, indices, workspace);
+    }
+    return key_dtype_.bits == 32 ? Run<int32_t, I>(data, values, indices, workspace)
+                                 : Run<int64_t, I>(data, values, indices, workspace);
+  }
+
+  template <typename K, typename I>
+  size_t Run(const DLTensor* data, DLTensor* values, DLTensor* indices, void* workspace) {
+    if (data == nullptr) {
+      return sort_pairs_workspace_cuda<K, I>(num_segments_, len_, is_ascend_);
+    }
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    int64_t k = k_ < 0 ? len_ : k_;
+    sort_pairs_cuda<K, I>(static_cast<const K*>(data->data), num_segments_, len_, k, is_ascend_,
+                          values ? static_cast<K*>(values->data) : nullptr,
+                          indices ? static_cast<I*>(indices->data) : nullptr, workspace,
+                          cuda_device_api->GetStream());
+    return 0;
+  }
+
+  /*! \brief The name of the op. */
+  std::string op_name_;
+  /*! \brief Whether the single output is the values or the indices. */
+  bool returns_values_;
+  /*! \brief The dtypes of the keys and the indices. */
+  DLDataType index_dtype_, key_dtype_;
+  /*! \brief The number of the segments and the length of each. */
+  int64_t num_segments_ = 0, len_ = 0;
+  /*! \brief The number of the sorted elements to take, which is -1 for all of them. */
+  int64_t k_ = -1;
+  bool is_ascend_ = true;
+  /*! \brief The workspace of the radix sort. */
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, sort, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.sort", SortImpl::make_sort);
+RAF_REGISTER_DIALECT_OP(cuda, argsort, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.argsort", SortImpl::make_argsort);
+RAF_REGISTER_DIALECT_OP(cuda, topk, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.topk", SortImpl::make_topk);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,201 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cuda/vision.cc
+ * \brief get_valid_counts and non_max_suppression cuda backend
+ */
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "../../schema/vision.h"
+#include "./kernels/kernel_util.cuh"
+
+namespace raf {
+namespace op {
+namespace cuda {
+
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief Whether a tensor is of the dtype. */
+inline bool IsDType(const DLTensor* tensor, DLDataTypeCode code, int bits) {
+  return tensor->dtype.code == code && tensor->dtype.bits == bits && tensor->dtype.lanes == 1;
+}
+
+class GetValidCountsImpl : public raf::op::OpEnv {
+ public:
+  explicit GetValidCountsImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.get_valid_counts");
+    auto args = cv->args.as<op::schema::GetValidCountsArgs>();
+    this->arg_indices = {fschema_index[op]("data")};
+    const DLTensor* data = args->data;
+    if (!IsDType(data, kDLFloat, 32)) {
+      this->error_msgs.push_back("[CUDA] get_valid_counts only supports float32");
+      return;
+    }
+    score_threshold_ = GetScalarValueData<float>(args->score_threshold);
+    id_index_ = args->id_index;
+    score_index_ = args->score_index;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::GetValidCountsArgs>();
+    Execute(std::vector<Value>{args->data}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    TupleValue out = ir::Downcast<TupleValue>(output);
+    DLTensor* valid_count = ir::Downcast<TensorValue>(out->fields[0]);
+    DLTensor* out_data = ir::Downcast<TensorValue>(out->fields[1]);
+    DLTensor* out_indices = ir::Downcast<TensorValue>(out->fields[2]);
+    get_valid_counts_cuda(static_cast<const float*>(data->data), data->shape[0], data->shape[1],
+                          data->shape[2], score_threshold_, id_index_, score_index_,
+                          static_cast<int32_t*>(valid_count->data),
+                          static_cast<float*>(out_data->data),
+                          static_cast<int32_t*>(out_indices->data), cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.get_valid_counts"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new GetValidCountsImpl(cv);
+  }
+
+ private:
+  float score_threshold_ = 0;
+  int id_index_ = 0;
+  int score_index_ = 1;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, get_valid_counts, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.get_valid_counts", GetValidCountsImpl::make);
+
+/*!
+ * \brief Batched non-maximum suppression, where the suppressions are bitmasks and the greedy
+ * selection runs on the device, so the outputs, which are upper-bounded by the number of boxes,
+ * need no synchronization with the host.
+ */
+class NonMaxSuppressionImpl : public raf::op::OpEnv {
+ public:
+  explicit NonMaxSuppressionImpl(const CallValues& cv) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto op = ir::Op::Get("raf.op.non_max_suppression");
+    auto args = cv->args.as<op::schema::NonMaxSuppressionArgs>();
+    this->arg_indices = {
+        fschema_index[op]("data"),
+        fschema_index[op]("valid_count"),
+        fschema_index[op]("indices"),
+        fschema_index[op]("max_output_size"),
+        fschema_index[op]("iou_threshold"),
+    };
+    const DLTensor* data = args->data;
+    if (!IsDType(data, kDLFloat, 32) || !IsDType(args->valid_count, kDLInt, 32) ||
+        !IsDType(args->indices, kDLInt, 32) || !IsDType(args->max_output_size, kDLInt, 32) ||
+        !IsDType(args->iou_threshold, kDLFloat, 32)) {
+      this->error_msgs.push_back(
+          "[CUDA] non_max_suppression only supports float32 boxes and thresholds, and int32 "
+          "counts and indices");
+      return;
+    }
+    batch_ = data->shape[0];
+    n_ = data->shape[1];
+    elem_len_ = data->shape[2];
+    if (args->coord_start < 0 || args->coord_start + 4 > elem_len_) {
+      this->error_msgs.push_back("[CUDA] The coords of the boxes are out of range");
+      return;
+    }
+    if (n_ > static_cast<int64_t>(nms_max_boxes_cuda())) {
+      this->error_msgs.push_back("[CUDA] Too many boxes for non_max_suppression");
+      return;
+    }
+    config_.top_k = args->top_k;
+    config_.coord_start = args->coord_start;
+    config_.score_index = args->score_index;
+    config_.id_index = args->id_index;
+    config_.force_suppress = args->force_suppress;
+    config_.return_indices = args->return_indices;
+    config_.invalid_to_bottom = args->invalid_to_bottom;
+    RequestWorkspace(&workspace_, cv->device, nms_workspace_cuda(batch_, n_, elem_len_));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::NonMaxSuppressionArgs>();
+    Execute(std::vector<Value>{args->data, args->valid_count, args->indices, args->max_output_size,
+                               args->iou_threshold},
+            cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    DLTensor* data = ir::Downcast<TensorValue>(inputs[0]);
+    DLTensor* valid_count = ir::Downcast<TensorValue>(inputs[1]);
+    DLTensor* indices = ir::Downcast<TensorValue>(inputs[2]);
+    DLTensor* max_output_size = ir::Downcast<TensorValue>(inputs[3]);
+    DLTensor* iou_threshold = ir::Downcast<TensorValue>(inputs[4]);
+    // The scalars on the host are passed by value, and the ones on the device are read there.
+    const int32_t* max_output_size_ptr = nullptr;
+    int32_t max_output_size_value = -1;
+    if (max_output_size->device.device_type == kDLCPU) {
+      max_output_size_value = *static_cast<const int32_t*>(max_output_size->data);
+    } else {
+      max_output_size_ptr = static_cast<const int32_t*>(max_output_size->data);
+    }
+    const float* iou_threshold_ptr = nullptr;
+    float iou_threshold_value = 0;
+    if (iou_threshold->device.device_type == kDLCPU) {
+      iou_threshold_value = *static_cast<const float*>(iou_threshold->data);
+    } else {
+      iou_threshold_ptr = static_cast<const float*>(iou_threshold->data);
+    }
+    float* out = nullptr;
+    int32_t* box_indices = nullptr;
+    int32_t* valid_box_count = nullptr;
+    if (config_.return_indices) {
+      TupleValue tuple = ir::Downcast<TupleValue>(output);
+      DLTensor* out_indices = ir::Downcast<TensorValue>(tuple->fields[0]);
+      DLTensor* out_count = ir::Downcast<TensorValue>(tuple->fields[1]);
+      box_indices = static_cast<int32_t*>(out_indices->data);
+      valid_box_count = static_cast<int32_t*>(out_count->data);
+    } else {
+      DLTensor* out_data = ir::Downcast<TensorValue>(output);
+      out = static_cast<float*>(out_data->data);
+    }
+    nms_cuda(static_cast<const float*>(data->data), static_cast<const int32_t*>(valid_count->data),
+             static_cast<const int32_t*>(indices->data), max_output_size_ptr,
+             max_output_size_value, iou_threshold_ptr, iou_threshold_value, batch_, n_, elem_len_,
+             config_, out, box_indices, valid_box_count, workspace_, cuda_device_api->GetStream());
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cuda.non_max_suppression"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NonMaxSuppressionImpl(cv);
+  }
+
+ private:
+  int batch_ = 0;
+  int64_t n_ = 0;
+  int elem_len_ = 0;
+  NMSConfig config_;
+  /*! \brief The workspace of the sort, the masks and the selections. */
+  void* workspace_ = nullptr;
+};
+
+RAF_REGISTER_DIALECT_OP(cuda, non_max_suppression, 20);
+RAF_OP_ENV_MAKER("raf.op.cuda.non_max_suppression", NonMaxSuppressionImpl::make);
+
+}  // namespace cuda
+}  // namespace op
+}  // namespace raf
@@ -77,6 +77,7 @@ template <class Algo, class F>
 void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_t* max_ws_size,
                          std::shared_ptr<Memory>* memory, const Device& device) {
   std::priority_queue<size_t> max_ws_sizes;
+  size_t workspace_limit = CUDNNThreadEntry::ThreadLocal()->workspace_limit;
   for (int i = 0; i < n_algos; ++i) {
     size_t ws_size = 0;
     try {
@@ -84,6 +85,10 @@ void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_
     } catch (const dmlc::Error& e) {
       continue;
     }
+    // Skip the algorithms beyond the limit, so they are not tried by the benchmark.
+    if (workspace_limit > 0 && ws_size > workspace_limit) {
+      continue;
+    }
     max_ws_sizes.push(ws_size);
   }
   while (!max_ws_sizes.empty()) {
@@ -97,17 +102,57 @@ void GetMaxWorkspaceSize(const Algo* algos, int n_algos, F fget_workspace, size_
       continue;
     }
   }
-  CHECK(*memory != nullptr);
+  CHECK(*memory != nullptr) << "Failed to allocate the workspace to benchmark the algorithms";
+}
+
+/*!
+ * \brief The key of an algorithm in the cache. The workspace limit is a part of the key, as the
+ * algorithms picked without the limit may exceed it.
+ */
+HashKey GetAlgoCacheKey(const HashKey& key) {
+  size_t workspace_limit = CUDNNThreadEntry::ThreadLocal()->workspace_limit;
+  if (workspace_limit == 0) {
+    return key;
+  }
+  HashKey hasher;
+  hasher << key << static_cast<int64_t>(workspace_limit);
+  return hasher;
+}
+
+/*!
+ * \brief Pick the first algorithm that succeeds within the workspace limit, where the results are
+ * sorted by the measured time in the benchmark mode, or by the heuristics otherwise.
+ */
+template <class AlgoPerf>
+AlgoPerf SelectAlgoPerf(const AlgoPerf* res, int cnt) {
+  size_t workspace_limit = CUDNNThreadEntry::ThreadLocal()->workspace_limit;
+  for (int i = 0; i < cnt; ++i) {
+    if (res[i].status == CUDNN_STATUS_SUCCESS &&
+        (workspace_limit == 0 || res[i].memory <= workspace_limit)) {
+      return res[i];
+    }
+  }
+  LOG(FATAL) << "ValueError: Cannot find a proper algorithm "
+             << (cnt > 0 ? cudnnGetErrorString(res[0].status) : "")
+             << ", workspace limit: " << workspace_limit << " bytes";
+  throw;
 }
 
 MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>> CacheCudnnConvFwdAlgoPerf(
     "cudnn_conv_fwd_algo_perf");
 
 cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
-    const std::vector<uint8_t>& key, const cudnnTensorDescriptor_t xDesc, const void* x,
+    const HashKey& key, const cudnnTensorDescriptor_t xDesc, const void* x,
     const cudnnFilterDescriptor_t wDesc, const void* w, const cudnnConvolutionDescriptor_t convDesc,
     const cudnnTensorDescriptor_t yDesc, void* y, const Device& device) {
-  if (auto* val = CacheCudnnConvFwdAlgoPerf.Get(key)) {
+  auto cache_key = GetAlgoCacheKey(key);
+  if (auto* val = CacheCudnnConvFwdAlgoPerf.Get(cache_key)) {
+    return val->Value();
+  }
+  // Only one of the processes sharing the persistent cache, e.g., the ranks on the same node,
+  // searches the algorithm, while the others wait and load the result.
+  auto lock = CacheCudnnConvFwdAlgoPerf.LockKey(cache_key);
+  if (auto* val = CacheCudnnConvFwdAlgoPerf.Get(cache_key)) {
     return val->Value();
   }
   static const cudnnConvolutionFwdAlgo_t algos[] = {
@@ -138,15 +183,11 @@ cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
                                                       xDesc, wDesc, convDesc, yDesc, num_algos,
                                                       &cnt, res));
   }
-  if (res[0].status != CUDNN_STATUS_SUCCESS) {
-    LOG(FATAL) << "ValueError: Cannot find a proper algorithm "
-               << cudnnGetErrorString(res[0].status);
-    throw;
-  }
-  CacheCudnnConvFwdAlgoPerf.Set(key,
-                                CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>(res[0]));
+  auto best = SelectAlgoPerf(res, cnt);
+  CacheCudnnConvFwdAlgoPerf.Set(cache_key,
+                                CuDNNConvAlgoCacheEntry<cudnnConvolutionFwdAlgoPerf_t>(best));
   // debug information
-  auto best_algo = res[0].algo;
+  auto best_algo = best.algo;
   DLOG(INFO) << "CUDNN Found " << cnt << " conv2d algorithms, choosing "
              << conv2dFwdAlgoToString(best_algo);
   for (int i = 0; i < cnt; ++i) {
@@ -156,18 +197,25 @@ cudnnConvolutionFwdAlgoPerf_t FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
                << ", math type: " << cudnnMathTypeToString(res[i].mathType)
                << ", status: " << cudnnGetErrorString(res[i].status);
   }
-  return res[0];
+  return best;
 }
 
 MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>>
     CacheCudnnConvBwdDataAlgoPerf("cudnn_conv_bwd_data_algo_perf");
 
 cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper(
-    const std::vector<uint8_t>& key, const cudnnFilterDescriptor_t wDesc, const void* w,
+    const HashKey& key, const cudnnFilterDescriptor_t wDesc, const void* w,
     const cudnnTensorDescriptor_t dyDesc, const void* dy,
     const cudnnConvolutionDescriptor_t convDesc, const cudnnTensorDescriptor_t dxDesc, void* dx,
     const Device& device) {
-  if (auto* val = CacheCudnnConvBwdDataAlgoPerf.Get(key)) {
+  auto cache_key = GetAlgoCacheKey(key);
+  if (auto* val = CacheCudnnConvBwdDataAlgoPerf.Get(cache_key)) {
+    return val->Value();
+  }
+  // Only one of the processes sharing the persistent cache, e.g., the ranks on the same node,
+  // searches the algorithm, while the others wait and load the result.
+  auto lock = CacheCudnnConvBwdDataAlgoPerf.LockKey(cache_key);
+  if (auto* val = CacheCudnnConvBwdDataAlgoPerf.Get(cache_key)) {
     return val->Value();
   }
   static const cudnnConvolutionBwdDataAlgo_t algos[] = {
@@ -194,14 +242,10 @@ cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper
                                                            wDesc, dyDesc, convDesc, dxDesc,
                                                            num_algos, &cnt, res));
   }
-  if (res[0].status != CUDNN_STATUS_SUCCESS) {
-    LOG(FATAL) << "ValueError: Cannot find a proper algorithm "
-               << cudnnGetErrorString(res[0].status);
-    throw;
-  }
-  auto best_algo = res[0].algo;
+  auto best = SelectAlgoPerf(res, cnt);
+  auto best_algo = best.algo;
   CacheCudnnConvBwdDataAlgoPerf.Set(
-      key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>(res[0]));
+      cache_key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdDataAlgoPerf_t>(best));
   // debug information
   DLOG(INFO) << "CUDNN Found " << cnt << " conv2d_dx algorithms , choosing "
              << conv2dBwdDataAlgoToString(best_algo);
@@ -212,18 +256,25 @@ cudnnConvolutionBwdDataAlgoPerf_t FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper
                << ", math type: " << cudnnMathTypeToString(res[i].mathType)
                << ", status: " << cudnnGetErrorString(res[i].status);
   }
-  return res[0];
+  return best;
 }
 
 MetaPersistCache<CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>>
     CacheCudnnConvBwdFilterAlgoPerf("cudnn_conv_bwd_filter_algo_perf");
 
 cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWrapper(
-    const std::vector<uint8_t>& key, const cudnnTensorDescriptor_t xDesc, const void* x,
+    const HashKey& key, const cudnnTensorDescriptor_t xDesc, const void* x,
     const cudnnTensorDescriptor_t dyDesc, const void* dy,
     const cudnnConvolutionDescriptor_t convDesc, const cudnnFilterDescriptor_t dwDesc, void* dw,
     const Device& device) {
-  if (auto* val = CacheCudnnConvBwdFilterAlgoPerf.Get(key)) {
+  auto cache_key = GetAlgoCacheKey(key);
+  if (auto* val = CacheCudnnConvBwdFilterAlgoPerf.Get(cache_key)) {
+    return val->Value();
+  }
+  // Only one of the processes sharing the persistent cache, e.g., the ranks on the same node,
+  // searches the algorithm, while the others wait and load the result.
+  auto lock = CacheCudnnConvBwdFilterAlgoPerf.LockKey(cache_key);
+  if (auto* val = CacheCudnnConvBwdFilterAlgoPerf.Get(cache_key)) {
     return val->Value();
   }
   static const cudnnConvolutionBwdFilterAlgo_t algos[] = {
@@ -250,15 +301,11 @@ cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWra
         CUDNNThreadEntry::ThreadLocal()->handle, xDesc, dyDesc, convDesc, dwDesc, num_algos, &cnt,
         res));
   }
-  if (res[0].status != CUDNN_STATUS_SUCCESS) {
-    LOG(FATAL) << "ValueError: Cannot find a proper algorithm "
-               << cudnnGetErrorString(res[0].status);
-    throw;
-  }
+  auto best = SelectAlgoPerf(res, cnt);
   CacheCudnnConvBwdFilterAlgoPerf.Set(
-      key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>(res[0]));
+      cache_key, CuDNNConvAlgoCacheEntry<cudnnConvolutionBwdFilterAlgoPerf_t>(best));
   // debug information
-  auto best_algo = res[0].algo;
+  auto best_algo = best.algo;
   DLOG(INFO) << "CUDNN Found " << cnt << " conv2d_dw algorithms , choosing "
              << conv2dBwdFilterAlgoToString(best_algo);
   for (int i = 0; i < cnt; ++i) {
@@ -268,14 +315,14 @@ cudnnConvolutionBwdFilterAlgoPerf_t FindcudnnConvolutionBwdFilterAlgoPerf_tExWra
                << ", math type: " << cudnnMathTypeToString(res[i].mathType)
                << ", status: " << cudnnGetErrorString(res[i].status);
   }
-  return res[0];
+  return best;
 }
 
 class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
-  cudnnTensorDescriptor_t xDesc;
-  cudnnFilterDescriptor_t wDesc;
-  cudnnTensorDescriptor_t yDesc;
-  cudnnConvolutionDescriptor_t convDesc;
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnFilterDescriptor_t wDesc = nullptr;
+  cudnnTensorDescriptor_t yDesc = nullptr;
+  cudnnConvolutionDescriptor_t convDesc = nullptr;
   cudnnConvolutionFwdAlgoPerf_t algo;
   size_t workSpaceSizeInBytes;
   void* workSpace;
@@ -290,33 +337,48 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
     DLTensor* x = args->x;
     DLTensor* w = args->w;
     DLTensor* out = cv->out;
+    // NHWC with OHWI filters is the native layout of the tensor core kernels.
+    bool nchw = args->layout == "NCHW" && args->kernel_layout == "OIHW" &&
+                args->out_layout == "NCHW";
+    bool nhwc = args->layout == "NHWC" && args->kernel_layout == "OHWI" &&
+                args->out_layout == "NHWC";
+    if (!nchw && !nhwc) {
+      std::stringstream ss;
+      ss << "[cuDNN] Unsupported layouts: " << args->layout << ", " << args->kernel_layout << ", "
+         << args->out_layout;
+      this->error_msgs.push_back(ss.str());
+      return;
+    }
     auto xDesc_tt = SquashTensorShape(x, {});
-    xDesc = NormalizeTensorType(xDesc_tt);
+    xDesc = NormalizeTensor4d(x, args->layout);
     auto wDesc_tt = SquashTensorShape(args->w, {});
-    wDesc = NormalizeFilter(args->w);
+    wDesc = NormalizeFilter4d(args->w, args->kernel_layout);
     auto yDesc_tt = SquashTensorShape(out, {});
-    yDesc = NormalizeTensorType(yDesc_tt);
+    yDesc = NormalizeTensor4d(out, args->out_layout);
     std::vector<int> stride = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->stride));
     std::vector<int> padding = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->padding));
     std::vector<int> dilation = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->dilation));
     cudnnDataType_t conv_dtype = CUDNNDType(w->dtype);
-    // Use data type fp32 in the convolution descriptor when data type is fp16
-    if (conv_dtype == CUDNN_DATA_HALF) conv_dtype = CUDNN_DATA_FLOAT;
+    // Use data type fp32 in the convolution descriptor when data type is fp16 or bf16
+    if (IsHalfCUDNNDType(conv_dtype)) conv_dtype = CUDNN_DATA_FLOAT;
     CUDNN_CALL(cudnnCreateConvolutionDescriptor(&convDesc));
     CUDNN_CALL(cudnnSetConvolutionNdDescriptor(convDesc, 2, BeginPtr(padding), BeginPtr(stride),
                                                BeginPtr(dilation), CUDNN_CROSS_CORRELATION,
                                                conv_dtype));
     cudnnSetConvolutionGroupCount(convDesc, args->groups);
-    if (ir::DataType(w->dtype).is_float16()) {
+    if (ir::DataType(w->dtype).is_float16() || ir::DataType(w->dtype).is_bfloat16()) {
       cudnnSetConvolutionMathType(convDesc, CUDNN_TENSOR_OP_MATH);
     }
 
     HashKey algo_hasher;
     algo_hasher << args->stride << args->padding << args->dilation << wDesc_tt << xDesc_tt
                 << yDesc_tt;
-    const auto& algo_key = algo_hasher.byte_vector;
-    algo = FindcudnnConvolutionFwdAlgoPerf_tExWrapper(algo_key, xDesc, x->data, wDesc, w->data,
-                                                      convDesc, yDesc, out->data, cv->device);
+    if (nhwc) {
+      algo_hasher << args->layout;
+    }
+    algo = FindcudnnConvolutionFwdAlgoPerf_tExWrapper(algo_hasher, xDesc, x->data, wDesc,
+                                                      w->data, convDesc, yDesc, out->data,
+                                                      cv->device);
     CUDNN_CALL(cudnnGetConvolutionForwardWorkspaceSize(CUDNNThreadEntry::ThreadLocal()->handle,
                                                        xDesc, wDesc, convDesc, yDesc, algo.algo,
                                                        &workSpaceSizeInBytes));
@@ -326,10 +388,17 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
 
  public:
   ~Conv2DImplementedByCUDNNConvolutionForward() {
-    CUDNN_CALL(cudnnDestroyTensorDescriptor(xDesc));
-    CUDNN_CALL(cudnnDestroyFilterDescriptor(wDesc));
-    CUDNN_CALL(cudnnDestroyTensorDescriptor(yDesc));
-    CUDNN_CALL(cudnnDestroyConvolutionDescriptor(convDesc));
+    for (auto desc : {xDesc, yDesc}) {
+      if (desc != nullptr) {
+        CUDNN_CALL(cudnnDestroyTensorDescriptor(desc));
+      }
+    }
+    if (wDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyFilterDescriptor(wDesc));
+    }
+    if (convDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyConvolutionDescriptor(convDesc));
+    }
   }
 
   std::string name() const override {
@@ -371,6 +440,279 @@ class Conv2DImplementedByCUDNNConvolutionForward : public raf::op::OpEnv {
 RAF_REGISTER_DIALECT_OP(cudnn, conv2d, 15);
 RAF_OP_ENV_MAKER("raf.op.cudnn.conv2d", Conv2DImplementedByCUDNNConvolutionForward::make);
 
+/*! \brief A conv2d followed by a per-channel bias add, and optionally a relu. */
+struct ConvBiasActMatch {
+  /*! \brief The conv2d call. */
+  Call conv;
+  /*! \brief The bias add call, i.e., bias_add or add. */
+  Call bias_add;
+  /*! \brief Whether the relu is fused. */
+  bool relu = false;
+};
+
+std::string GetBaseOpName(const Expr& op) {
+  const auto* node = op.as<OpNode>();
+  if (node == nullptr) {
+    return "";
+  }
+  Op base_op = GetRef<Op>(node);
+  return IsDialectOp(base_op) ? GetBaseOp(base_op)->name : base_op->name;
+}
+
+/*!
+ * \brief Match relu(conv2d(x, w) + bias), where the relu is optional and the bias is added by
+ *        either bias_add or add. The ops can be either base ops or dialect ops, so the same
+ *        matcher works on the graph before fusion and on the body of the fused function.
+ */
+bool MatchConvBiasAct(const Expr& expr, ConvBiasActMatch* match) {
+  const auto* call = expr.as<CallNode>();
+  if (call != nullptr && GetBaseOpName(call->op) == "raf.op.relu") {
+    match->relu = true;
+    call = call->args[0].as<CallNode>();
+  }
+  if (call == nullptr) {
+    return false;
+  }
+  std::string bias_op = GetBaseOpName(call->op);
+  if (bias_op != "raf.op.bias_add" && bias_op != "raf.op.add") {
+    return false;
+  }
+  match->bias_add = GetRef<Call>(call);
+  const auto* conv = call->args[0].as<CallNode>();
+  if (conv == nullptr || GetBaseOpName(conv->op) != "raf.op.conv2d") {
+    return false;
+  }
+  match->conv = GetRef<Call>(conv);
+  return true;
+}
+
+/*!
+ * \brief Check whether a match of the cuDNN conv2d fusion pattern can be offloaded, using the
+ *        inferred types of the graph. The bias must be a vector along the output channels, which
+ *        the pattern cannot express. The matches of the other cuDNN patterns are always accepted.
+ * \param expr The matched expression.
+ * \return Whether the match is supported by cuDNN.
+ */
+bool CuDNNFusionCheck(const Expr& expr) {
+  ConvBiasActMatch match;
+  if (!MatchConvBiasAct(expr, &match)) {
+    return true;
+  }
+  const auto* out_type = match.conv->checked_type().as<TensorTypeNode>();
+  const auto* bias_type = match.bias_add->args[1]->checked_type().as<TensorTypeNode>();
+  if (out_type == nullptr || bias_type == nullptr || out_type->shape.size() != 4 ||
+      bias_type->dtype != out_type->dtype ||
+      !(out_type->dtype.is_float() && (out_type->dtype.bits() == 32 ||
+                                       out_type->dtype.bits() == 16))) {
+    return false;
+  }
+  std::vector<int64_t> bias_shape;
+  for (const auto& dim : bias_type->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return false;
+    }
+    bias_shape.push_back(imm->value);
+  }
+  const auto* channels = out_type->shape[1].as<IntImmNode>();
+  if (channels == nullptr) {
+    return false;
+  }
+  int64_t c = channels->value;
+  if (GetBaseOpName(match.bias_add->op) == "raf.op.bias_add") {
+    // The axis is checked by the pattern.
+    return bias_shape == std::vector<int64_t>{c};
+  }
+  // The bias of add must broadcast along the channels, i.e., (C, 1, 1) or (1, C, 1, 1).
+  return bias_shape == std::vector<int64_t>{c, 1, 1} ||
+         bias_shape == std::vector<int64_t>{1, c, 1, 1};
+}
+
+RAF_REGISTER_GLOBAL("raf.op.cudnn._fusion_check").set_body_typed(CuDNNFusionCheck);
+
+/*!
+ * \brief Run the fused functions of the cuDNN conv2d fusion pattern, i.e.
+ *          - relu(conv2d(x, w) + bias)
+ *          - conv2d(x, w) + bias
+ *        in NCHW with cudnnConvolutionBiasActivationForward, so the bias and the activation
+ *        are applied without writing the conv2d output to the global memory in between.
+ */
+class Conv2DBiasActImplementedByCUDNNConvolutionBiasActivationForward : public raf::op::OpEnv {
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnFilterDescriptor_t wDesc = nullptr;
+  cudnnTensorDescriptor_t bDesc = nullptr;
+  cudnnTensorDescriptor_t yDesc = nullptr;
+  cudnnConvolutionDescriptor_t convDesc = nullptr;
+  cudnnActivationDescriptor_t actDesc = nullptr;
+  cudnnConvolutionFwdAlgo_t algo;
+  size_t workSpaceSizeInBytes = 0;
+  void* workSpace = nullptr;
+
+ public:
+  Conv2DBiasActImplementedByCUDNNConvolutionBiasActivationForward() = default;
+
+  ~Conv2DBiasActImplementedByCUDNNConvolutionBiasActivationForward() {
+    for (auto desc : {xDesc, bDesc, yDesc}) {
+      if (desc != nullptr) {
+        CUDNN_CALL(cudnnDestroyTensorDescriptor(desc));
+      }
+    }
+    if (wDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyFilterDescriptor(wDesc));
+    }
+    if (convDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyConvolutionDescriptor(convDesc));
+    }
+    if (actDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyActivationDescriptor(actDesc));
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cudnn.conv2d_bias_act"));
+  }
+
+  void Init(const CallValues& cv) {
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    ConvBiasActMatch match;
+    CHECK(MatchConvBiasAct(func->body, &match)) << "Unsupported pattern:\n" << AsText(func);
+    Array<Value> args = GetListArgs(cv->args);
+    auto get_param_index = [&func](const Expr& expr) {
+      size_t idx = 0;
+      while (idx < func->params.size() && !func->params[idx].same_as(expr)) {
+        ++idx;
+      }
+      return idx;
+    };
+    auto get_value = [&](const Expr& expr) -> Value {
+      if (const auto* node = expr.as<ConstantNode>()) {
+        return Downcast<Value>(node->value);
+      }
+      size_t idx = get_param_index(expr);
+      CHECK_LT(idx, func->params.size()) << "The conv2d arguments must be the function params";
+      return args[idx];
+    };
+    // The tensors must be the function params to be read from the call arguments.
+    for (const auto& operand :
+         {match.conv->args[0], match.conv->args[1], match.bias_add->args[1]}) {
+      size_t idx = get_param_index(operand);
+      CHECK_LT(idx, func->params.size()) << "The conv2d operands must be the function params";
+      arg_indices.push_back(idx);
+    }
+
+    Array<Value> conv_values;
+    for (const auto& arg : match.conv->args) {
+      conv_values.push_back(get_value(arg));
+    }
+    static auto fschema = GetOpAttr<FRAFSchema>(Op::Get("raf.op.conv2d"), "FRAFSchema");
+    Attrs conv_attrs = fschema(conv_values);
+    auto conv_args = conv_attrs.as<raf::op::schema::ConvArgs>();
+    CHECK(conv_args->layout == "NCHW" && conv_args->kernel_layout == "OIHW" &&
+          conv_args->out_layout == "NCHW")
+        << "Only NCHW is supported";
+    DLTensor* x = conv_args->x;
+    DLTensor* w = conv_args->w;
+    DLTensor* bias = Downcast<TensorValue>(args[arg_indices[2]]);
+    DLTensor* out = cv->out;
+    CHECK_EQ(out->ndim, 4);
+    int64_t bias_numel = 1;
+    for (int i = 0; i < bias->ndim; ++i) {
+      bias_numel *= bias->shape[i];
+    }
+    CHECK_EQ(bias_numel, out->shape[1]) << "The bias must be a vector along the output channels";
+
+    auto xDesc_tt = SquashTensorShape(x, {});
+    xDesc = NormalizeTensorType(xDesc_tt);
+    auto wDesc_tt = SquashTensorShape(w, {});
+    wDesc = NormalizeFilter(w);
+    auto yDesc_tt = SquashTensorShape(out, {});
+    yDesc = NormalizeTensorType(yDesc_tt);
+    Array<PrimExpr> bias_shape{Integer(1), Integer(out->shape[1]), Integer(1), Integer(1)};
+    bDesc = NormalizeTensorType(ir::TensorType(bias_shape, ir::DataType(bias->dtype)));
+    std::vector<int> stride =
+        CastVector<int, int64_t>(NormalizeScalarToTuple<2>(conv_args->stride));
+    std::vector<int> padding =
+        CastVector<int, int64_t>(NormalizeScalarToTuple<2>(conv_args->padding));
+    std::vector<int> dilation =
+        CastVector<int, int64_t>(NormalizeScalarToTuple<2>(conv_args->dilation));
+    cudnnDataType_t conv_dtype = CUDNNDType(w->dtype);
+    // Use data type fp32 in the convolution descriptor when data type is fp16 or bf16
+    if (IsHalfCUDNNDType(conv_dtype)) conv_dtype = CUDNN_DATA_FLOAT;
+    CUDNN_CALL(cudnnCreateConvolutionDescriptor(&convDesc));
+    CUDNN_CALL(cudnnSetConvolutionNdDescriptor(convDesc, 2, BeginPtr(padding), BeginPtr(stride),
+                                               BeginPtr(dilation), CUDNN_CROSS_CORRELATION,
+                                               conv_dtype));
+    cudnnSetConvolutionGroupCount(convDesc, conv_args->groups);
+    if (ir::DataType(w->dtype).is_float16() || ir::DataType(w->dtype).is_bfloat16()) {
+      cudnnSetConvolutionMathType(convDesc, CUDNN_TENSOR_OP_MATH);
+    }
+    CUDNN_CALL(cudnnCreateActivationDescriptor(&actDesc));
+    CUDNN_CALL(cudnnSetActivationDescriptor(
+        actDesc, match.relu ? CUDNN_ACTIVATION_RELU : CUDNN_ACTIVATION_IDENTITY,
+        CUDNN_PROPAGATE_NAN, 0.0));
+
+    if (match.relu) {
+      // Share the algorithm with the unfused conv2d of the same problem.
+      HashKey algo_hasher;
+      algo_hasher << conv_args->stride << conv_args->padding << conv_args->dilation << wDesc_tt
+                  << xDesc_tt << yDesc_tt;
+      auto algo_perf = FindcudnnConvolutionFwdAlgoPerf_tExWrapper(
+          algo_hasher, xDesc, x->data, wDesc, w->data, convDesc, yDesc, out->data,
+          cv->device);
+      algo = algo_perf.algo;
+      cudnnSetConvolutionMathType(convDesc, algo_perf.mathType);
+    } else {
+      // The identity activation is only supported by this algorithm.
+      algo = CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_PRECOMP_GEMM;
+    }
+    CUDNN_CALL(cudnnGetConvolutionForwardWorkspaceSize(CUDNNThreadEntry::ThreadLocal()->handle,
+                                                       xDesc, wDesc, convDesc, yDesc, algo,
+                                                       &workSpaceSizeInBytes));
+    RequestWorkspace(&workSpace, cv->device, workSpaceSizeInBytes);
+  }
+
+  void Execute(const CallValues& cv) {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) {
+    CHECK_EQ(inputs.size(), 3);
+    DLTensor* x = Downcast<TensorValue>(inputs[0]);
+    DLTensor* w = Downcast<TensorValue>(inputs[1]);
+    DLTensor* bias = Downcast<TensorValue>(inputs[2]);
+    DLTensor* out = Downcast<TensorValue>(output);
+    // y = act(alpha1 * conv(x, w) + alpha2 * z + bias), where z is the output with alpha2 = 0.
+    CUDNN_CALL(cudnnConvolutionBiasActivationForward(
+        CUDNNThreadEntry::ThreadLocal()->handle, CUDNNDType(out->dtype).const_addr<1>(), xDesc,
+        x->data, wDesc, w->data, convDesc, algo, workSpace, workSpaceSizeInBytes,
+        CUDNNDType(out->dtype).const_addr<0>(), yDesc, out->data, bDesc, bias->data, actDesc,
+        yDesc, out->data));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto env = std::make_unique<Conv2DBiasActImplementedByCUDNNConvolutionBiasActivationForward>();
+    try {
+      env->Init(cv);
+    } catch (const dmlc::Error& e) {
+      env->error_msgs.push_back(std::string("[cuDNN] Failed to build: ") + e.what());
+    }
+    return env.release();
+  }
+};
+
+RAF_OP_ENV_MAKER("raf.op.cudnn._fused_op",
+                 Conv2DBiasActImplementedByCUDNNConvolutionBiasActivationForward::make);
+
+// The bias adds in the fused functions. They are never dispatched on their own, so the plevel is
+// -1 to avoid conflicting with the auxiliary ops of the other fusion dialects.
+RAF_REGISTER_DIALECT_OP(cudnn, bias_add, -1);
+RAF_REGISTER_DIALECT_OP(cudnn, add, -1);
+
 class Conv2DDwImplementedByCUDNNConvolutionBackwardFilter : public raf::op::OpEnv {
   cudnnTensorDescriptor_t xDesc;
   cudnnFilterDescriptor_t dwDesc;
@@ -406,21 +748,21 @@ class Conv2DDwImplementedByCUDNNConvolutionBackwardFilter : public raf::op::OpEn
     std::vector<int> dilation = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->dilation));
     CUDNN_CALL(cudnnCreateConvolutionDescriptor(&convDesc));
     cudnnDataType_t conv_dtype = CUDNNDType(x_or_w->dtype);
-    // Use data type fp32 in the convolution descriptor when data type is fp16
-    if (conv_dtype == CUDNN_DATA_HALF) conv_dtype = CUDNN_DATA_FLOAT;
+    // Use data type fp32 in the convolution descriptor when data type is fp16 or bf16
+    if (IsHalfCUDNNDType(conv_dtype)) conv_dtype = CUDNN_DATA_FLOAT;
     CUDNN_CALL(cudnnSetConvolutionNdDescriptor(convDesc, 2, BeginPtr(padding), BeginPtr(stride),
                                                BeginPtr(dilation), CUDNN_CROSS_CORRELATION,
                                                conv_dtype));
-    if (ir::DataType(x_or_w->dtype).is_float16()) {
+    if (ir::DataType(x_or_w->dtype).is_float16() || ir::DataType(x_or_w->dtype).is_bfloat16()) {
       cudnnSetConvolutionMathType(convDesc, CUDNN_TENSOR_OP_MATH);
     };
     cudnnSetConvolutionGroupCount(convDesc, args->groups);
     HashKey algo_hasher;
     algo_hasher << args->stride << args->padding << args->dilation << xDesc_tt << dyDesc_tt
                 << dwDesc_tt;
-    const auto& algo_key = algo_hasher.byte_vector;
     algo = FindcudnnConvolutionBwdFilterAlgoPerf_tExWrapper(
-        algo_key, xDesc, x_or_w->data, dyDesc, dy->data, convDesc, dwDesc, out->data, cv->device);
+        algo_hasher, xDesc, x_or_w->data, dyDesc, dy->data, convDesc, dwDesc, out->data,
+        cv->device);
     CUDNN_CALL(cudnnGetConvolutionBackwardFilterWorkspaceSize(
         CUDNNThreadEntry::ThreadLocal()->handle, xDesc, dyDesc, convDesc, dwDesc, algo.algo,
         &workSpaceSizeInBytes));
@@ -501,21 +843,21 @@ class Conv2DDxImplementedByCUDNNConvolutionBackwardData : public raf::op::OpEnv
     std::vector<int> dilation = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->dilation));
     CUDNN_CALL(cudnnCreateConvolutionDescriptor(&convDesc));
     cudnnDataType_t conv_dtype = CUDNNDType(x_or_w->dtype);
-    // Use data type fp32 in the convolution descriptor when data type is fp16
-    if (conv_dtype == CUDNN_DATA_HALF) conv_dtype = CUDNN_DATA_FLOAT;
+    // Use data type fp32 in the convolution descriptor when data type is fp16 or bf16
+    if (IsHalfCUDNNDType(conv_dtype)) conv_dtype = CUDNN_DATA_FLOAT;
     CUDNN_CALL(cudnnSetConvolutionNdDescriptor(convDesc, 2, BeginPtr(padding), BeginPtr(stride),
                                                BeginPtr(dilation), CUDNN_CROSS_CORRELATION,
                                                conv_dtype));
-    if (ir::DataType(x_or_w->dtype).is_float16()) {
+    if (ir::DataType(x_or_w->dtype).is_float16() || ir::DataType(x_or_w->dtype).is_bfloat16()) {
       cudnnSetConvolutionMathType(convDesc, CUDNN_TENSOR_OP_MATH);
     };
     cudnnSetConvolutionGroupCount(convDesc, args->groups);
     HashKey algo_hasher;
     algo_hasher << args->stride << args->padding << args->dilation << wDesc_tt << dyDesc_tt
                 << dxDesc_tt;
-    const auto& algo_key = algo_hasher.byte_vector;
     algo = FindcudnnConvolutionBwdDataAlgoPerf_tExWrapper(
-        algo_key, wDesc, x_or_w->data, dyDesc, dy->data, convDesc, dxDesc, out->data, cv->device);
+        algo_hasher, wDesc, x_or_w->data, dyDesc, dy->data, convDesc, dxDesc, out->data,
+        cv->device);
     CUDNN_CALL(cudnnGetConvolutionBackwardDataWorkspaceSize(CUDNNThreadEntry::ThreadLocal()->handle,
                                                             wDesc, dyDesc, convDesc, dxDesc,
                                                             algo.algo, &workSpaceSizeInBytes));
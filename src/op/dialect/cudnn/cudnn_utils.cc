@@ -7,6 +7,9 @@
  * \file src/op/dialect/cudnn/cudnn_utils.h
  * \brief Helper functions for cuDNN
  */
+#include <cstdlib>
+#include <cstring>
+#include <string>
 #include "dmlc/thread_local.h"
 #include "./cudnn_utils.h"
 
@@ -16,6 +19,26 @@ namespace cudnn {
 
 CUDNNThreadEntry::CUDNNThreadEntry() {
   CUDNN_CALL(cudnnCreate(&handle));
+  stream_handles[nullptr] = handle;
+  if (const char* env = getenv("RAF_CUDNN_BENCHMARK")) {
+    benchmark = strcmp(env, "0") != 0;
+  }
+  if (const char* env = getenv("RAF_CUDNN_WORKSPACE_LIMIT_MB")) {
+    workspace_limit = static_cast<size_t>(std::stoll(env)) << 20;
+  }
+}
+
+void CUDNNThreadEntry::SetStream(cudaStream_t stream) {
+  if (stream == this->stream) {
+    return;
+  }
+  auto& stream_handle = stream_handles[stream];
+  if (stream_handle == nullptr) {
+    CUDNN_CALL(cudnnCreate(&stream_handle));
+    CUDNN_CALL(cudnnSetStream(stream_handle, stream));
+  }
+  handle = stream_handle;
+  this->stream = stream;
 }
 
 using CUDNNThreadStore = dmlc::ThreadLocalStore<CUDNNThreadEntry>;
@@ -32,9 +55,22 @@ void CudnnConfigSetBenchmark(bool benchmark) {
   CUDNNThreadEntry::ThreadLocal()->benchmark = benchmark;
 }
 
+int64_t CudnnConfigGetWorkspaceLimit() {
+  return CUDNNThreadEntry::ThreadLocal()->workspace_limit;
+}
+
+void CudnnConfigSetWorkspaceLimit(int64_t workspace_limit) {
+  CHECK_GE(workspace_limit, 0) << "The workspace limit must be non-negative";
+  CUDNNThreadEntry::ThreadLocal()->workspace_limit = workspace_limit;
+}
+
 RAF_REGISTER_DIALECT("cudnn").set_enable(DevType::kCUDA());
 RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigGetBenchmark").set_body_typed(CudnnConfigGetBenchmark);
 RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigSetBenchmark").set_body_typed(CudnnConfigSetBenchmark);
+RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigGetWorkspaceLimit")
+    .set_body_typed(CudnnConfigGetWorkspaceLimit);
+RAF_REGISTER_GLOBAL("raf.backend.cudnn.ConfigSetWorkspaceLimit")
+    .set_body_typed(CudnnConfigSetWorkspaceLimit);
 
 }  // namespace cudnn
 }  // namespace op
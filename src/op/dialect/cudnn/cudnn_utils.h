@@ -11,6 +11,7 @@
 #include <cudnn.h>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <numeric>
@@ -49,6 +50,11 @@ inline DType::operator cudnnDataType_t() const {
       if (bits == 32) return CUDNN_DATA_FLOAT;
       if (bits == 64) return CUDNN_DATA_DOUBLE;
       LOG(FATAL) << "NotImplementedError: " << c_str();
+#if CUDNN_VERSION >= 8100
+    case kDLBfloat:
+      if (bits == 16) return CUDNN_DATA_BFLOAT16;
+      LOG(FATAL) << "NotImplementedError: " << c_str();
+#endif
   }
   LOG(FATAL) << "NotImplementedError: " << c_str();
   throw;
@@ -76,6 +82,10 @@ inline std::string cudnnDataTypeToString(cudnnDataType_t dtype) {
       return "CUDNN_DATA_UINT8";
     case CUDNN_DATA_UINT8x4:
       return "CUDNN_DATA_UINT8x4";
+#endif
+#if CUDNN_VERSION >= 8100
+    case CUDNN_DATA_BFLOAT16:
+      return "CUDNN_DATA_BFLOAT16";
 #endif
     default:
       std::ostringstream oss;
@@ -84,6 +94,16 @@ inline std::string cudnnDataTypeToString(cudnnDataType_t dtype) {
   }
 }
 
+/*! \brief Whether the data type is fp16 or bf16, which are computed in fp32. */
+inline bool IsHalfCUDNNDType(cudnnDataType_t dtype) {
+#if CUDNN_VERSION >= 8100
+  if (dtype == CUDNN_DATA_BFLOAT16) {
+    return true;
+  }
+#endif
+  return dtype == CUDNN_DATA_HALF;
+}
+
 inline std::string cudnnMathTypeToString(cudnnMathType_t type) {
   switch (type) {
     case CUDNN_DEFAULT_MATH:
@@ -174,17 +194,40 @@ class CUDNNThreadEntry {
  public:
   CUDNNThreadEntry();
   static CUDNNThreadEntry* ThreadLocal();
+  /*!
+   * \brief Switch to the handle of the stream, which is created on the first use of the stream.
+   * The streams do not share a handle, so they are not serialized by its state.
+   * \param stream The stream to launch the kernels on.
+   */
+  void SetStream(cudaStream_t stream);
 
  public:
-  /*! \brief cudnn handle. */
+  /*! \brief cudnn handle of the current stream. */
   cudnnHandle_t handle = nullptr;
-  /*! \brief Whether to benchmark the performance when choosing CUDNN algorithms. */
+  /*! \brief The current stream. */
+  cudaStream_t stream = nullptr;
+  /*! \brief The handles of the streams used by the thread. */
+  std::unordered_map<cudaStream_t, cudnnHandle_t> stream_handles;
+  /*!
+   * \brief Whether to benchmark the performance when choosing CUDNN algorithms. Otherwise the
+   * algorithms are picked by the heuristics, which is faster at startup. The default can be set
+   * by the environment variable RAF_CUDNN_BENCHMARK.
+   */
   bool benchmark = true;
+  /*!
+   * \brief The maximum workspace in bytes of the CUDNN algorithms, including the one allocated to
+   * benchmark them. 0 means no limit. The default can be set in MBs by the environment variable
+   * RAF_CUDNN_WORKSPACE_LIMIT_MB.
+   */
+  size_t workspace_limit = 0;
 };
 
 #if CUDNN_VERSION >= 7100
 
-class CUDNNDType final : public EnumBase<CUDNNDType, 9, int32_t, cudnnDataType_t> {
+/*! \brief The number of the data types, which are indexed by their values in cudnnDataType_t. */
+constexpr int kNumCUDNNDTypes = CUDNN_VERSION >= 8100 ? 10 : 9;
+
+class CUDNNDType final : public EnumBase<CUDNNDType, kNumCUDNNDTypes, int32_t, cudnnDataType_t> {
  public:
   ENUM_DEF_HEADER(CUDNNDType, 0, plain);
   ENUM_DEF_ENTRY_WITH_NAME(CUDNNDType, 0, Float, CUDNN_DATA_FLOAT, "float32");
@@ -196,6 +239,9 @@ class CUDNNDType final : public EnumBase<CUDNNDType, 9, int32_t, cudnnDataType_t
   ENUM_DEF_ENTRY_WITH_NAME(CUDNNDType, 6, UChar, CUDNN_DATA_UINT8, "uint8");
   ENUM_DEF_ENTRY_WITH_NAME(CUDNNDType, 7, UCharx4, CUDNN_DATA_INT8x4, "uint8x4");
   ENUM_DEF_ENTRY_WITH_NAME(CUDNNDType, 8, UCharx32, CUDNN_DATA_INT8x32, "uint8x32");
+#if CUDNN_VERSION >= 8100
+  ENUM_DEF_ENTRY_WITH_NAME(CUDNNDType, 9, BFloat16, CUDNN_DATA_BFLOAT16, "bfloat16");
+#endif
 
   explicit CUDNNDType(DType dt) : EnumBase(cudnnDataType_t(dt)) {
   }
@@ -209,6 +255,10 @@ class CUDNNDType final : public EnumBase<CUDNNDType, 9, int32_t, cudnnDataType_t
         return const_typed_addr<float, value>();
       case CUDNN_DATA_HALF:
         return const_typed_addr<float, value>();
+#if CUDNN_VERSION >= 8100
+      case CUDNN_DATA_BFLOAT16:
+        return const_typed_addr<float, value>();
+#endif
       case CUDNN_DATA_DOUBLE:
         return const_typed_addr<double, value>();
       case CUDNN_DATA_INT8:
@@ -329,6 +379,49 @@ inline cudnnFilterDescriptor_t NormalizeFilter(const DLTensor* tv,
   return res;
 }
 
+/*!
+ * \brief Describe a 4-D tensor in the given layout.
+ * \param tensor The tensor, whose shape is in the order of the layout.
+ * \param layout The layout, which is NCHW or NHWC.
+ * \return The tensor descriptor.
+ */
+inline cudnnTensorDescriptor_t NormalizeTensor4d(const DLTensor* tensor,
+                                                 const std::string& layout) {
+  if (layout == "NCHW") {
+    return NormalizeTensorType(SquashTensorShape(tensor, {}));
+  }
+  CHECK_EQ(layout, "NHWC") << "Unsupported layout " << layout;
+  CHECK_EQ(tensor->ndim, 4);
+  const int64_t* shape = tensor->shape;
+  cudnnTensorDescriptor_t res;
+  CUDNN_CALL(cudnnCreateTensorDescriptor(&res));
+  CUDNN_CALL(cudnnSetTensor4dDescriptor(res, CUDNN_TENSOR_NHWC, CUDNNDType(tensor->dtype),
+                                        shape[0], shape[3], shape[1], shape[2]));
+  return res;
+}
+
+/*!
+ * \brief Describe a 4-D convolution filter in the given layout.
+ * \param tensor The filter, whose shape is in the order of the layout.
+ * \param layout The layout, which is OIHW or OHWI.
+ * \return The filter descriptor.
+ */
+inline cudnnFilterDescriptor_t NormalizeFilter4d(const DLTensor* tensor,
+                                                 const std::string& layout) {
+  if (layout == "OIHW") {
+    return NormalizeFilter(tensor);
+  }
+  CHECK_EQ(layout, "OHWI") << "Unsupported kernel layout " << layout;
+  CHECK_EQ(tensor->ndim, 4);
+  const int64_t* shape = tensor->shape;
+  cudnnFilterDescriptor_t res;
+  CUDNN_CALL(cudnnCreateFilterDescriptor(&res));
+  // The dimensions are always given as KCRS, while the format tells the order in the memory.
+  CUDNN_CALL(cudnnSetFilter4dDescriptor(res, CUDNNDType(tensor->dtype), CUDNN_TENSOR_NHWC,
+                                        shape[0], shape[3], shape[1], shape[2]));
+  return res;
+}
+
 inline std::vector<int64_t> MakeAlgoKey(const std::vector<std::vector<int64_t>>& vs) {
   std::vector<int64_t> res;
   for (auto& v : vs) {
@@ -384,7 +477,7 @@ inline ir::Array<ir::Integer> ToArrayOfInteger(const std::vector<T>& v) {
 }
 
 inline void SetStream(cudaStream_t stream) {
-  CUDNN_CALL(cudnnSetStream(CUDNNThreadEntry::ThreadLocal()->handle, stream));
+  CUDNNThreadEntry::ThreadLocal()->SetStream(stream);
 }
 
 inline size_t ComputeStorageInBytes(const ir::TensorType& type) {
@@ -23,9 +23,9 @@ using dmlc::BeginPtr;
 static auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
 
 class AvgPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
-  cudnnTensorDescriptor_t xDesc;
-  cudnnTensorDescriptor_t yDesc;
-  cudnnPoolingDescriptor_t poolingDesc;
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnTensorDescriptor_t yDesc = nullptr;
+  cudnnPoolingDescriptor_t poolingDesc = nullptr;
 
   explicit AvgPool2DImplementedByCUDNNPoolingForward(const CallValues& cv) {
     auto op = Op::Get("raf.op.avg_pool2d");
@@ -35,10 +35,12 @@ class AvgPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
     auto args = cv->args.as<raf::op::schema::PoolArgs>();
     DLTensor* x = args->x;
     DLTensor* out = cv->out;
-    auto xDesc_tt = SquashTensorShape(x, {});
-    xDesc = NormalizeTensorType(xDesc_tt);
-    auto yDesc_tt = SquashTensorShape(out, {});
-    yDesc = NormalizeTensorType(yDesc_tt);
+    if (args->layout != "NCHW" && args->layout != "NHWC") {
+      this->error_msgs.push_back("[cuDNN] Unsupported layout: " + args->layout);
+      return;
+    }
+    xDesc = NormalizeTensor4d(x, args->layout);
+    yDesc = NormalizeTensor4d(out, args->layout);
     std::vector<int> kernel = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->kernel));
     std::vector<int> stride = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->stride));
     std::vector<int> padding = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->padding));
@@ -53,9 +55,14 @@ class AvgPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
 
  public:
   ~AvgPool2DImplementedByCUDNNPoolingForward() {
-    CUDNN_CALL(cudnnDestroyTensorDescriptor(xDesc));
-    CUDNN_CALL(cudnnDestroyTensorDescriptor(yDesc));
-    CUDNN_CALL(cudnnDestroyPoolingDescriptor(poolingDesc));
+    for (auto desc : {xDesc, yDesc}) {
+      if (desc != nullptr) {
+        CUDNN_CALL(cudnnDestroyTensorDescriptor(desc));
+      }
+    }
+    if (poolingDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyPoolingDescriptor(poolingDesc));
+    }
   }
 
   std::string name() const override {
@@ -172,9 +179,9 @@ RAF_REGISTER_DIALECT_OP(cudnn, avg_pool2d_dx, 15);
 RAF_OP_ENV_MAKER("raf.op.cudnn.avg_pool2d_dx", AvgPool2DDxImplementedByCUDNNPoolingBackward::make);
 
 class MaxPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
-  cudnnTensorDescriptor_t xDesc;
-  cudnnTensorDescriptor_t yDesc;
-  cudnnPoolingDescriptor_t poolingDesc;
+  cudnnTensorDescriptor_t xDesc = nullptr;
+  cudnnTensorDescriptor_t yDesc = nullptr;
+  cudnnPoolingDescriptor_t poolingDesc = nullptr;
 
   explicit MaxPool2DImplementedByCUDNNPoolingForward(const CallValues& cv) {
     auto op = Op::Get("raf.op.max_pool2d");
@@ -184,10 +191,12 @@ class MaxPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
     auto args = cv->args.as<raf::op::schema::PoolArgs>();
     DLTensor* x = args->x;
     DLTensor* out = cv->out;
-    auto xDesc_tt = SquashTensorShape(x, {});
-    xDesc = NormalizeTensorType(xDesc_tt);
-    auto yDesc_tt = SquashTensorShape(out, {});
-    yDesc = NormalizeTensorType(yDesc_tt);
+    if (args->layout != "NCHW" && args->layout != "NHWC") {
+      this->error_msgs.push_back("[cuDNN] Unsupported layout: " + args->layout);
+      return;
+    }
+    xDesc = NormalizeTensor4d(x, args->layout);
+    yDesc = NormalizeTensor4d(out, args->layout);
     std::vector<int> kernel = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->kernel));
     std::vector<int> stride = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->stride));
     std::vector<int> padding = CastVector<int, int64_t>(NormalizeScalarToTuple<2>(args->padding));
@@ -199,9 +208,14 @@ class MaxPool2DImplementedByCUDNNPoolingForward : public raf::op::OpEnv {
 
  public:
   ~MaxPool2DImplementedByCUDNNPoolingForward() {
-    CUDNN_CALL(cudnnDestroyTensorDescriptor(xDesc));
-    CUDNN_CALL(cudnnDestroyTensorDescriptor(yDesc));
-    CUDNN_CALL(cudnnDestroyPoolingDescriptor(poolingDesc));
+    for (auto desc : {xDesc, yDesc}) {
+      if (desc != nullptr) {
+        CUDNN_CALL(cudnnDestroyTensorDescriptor(desc));
+      }
+    }
+    if (poolingDesc != nullptr) {
+      CUDNN_CALL(cudnnDestroyPoolingDescriptor(poolingDesc));
+    }
   }
 
   std::string name() const override {
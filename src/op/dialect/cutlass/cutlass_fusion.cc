@@ -8,6 +8,7 @@
  * \brief Implementation of cutlass dispatch for fused functions
  */
 #include <limits>
+#include <sstream>
 
 #include "raf/cache.h"
 #include "raf/value.h"
@@ -22,6 +23,8 @@
 #include "./timer.h"
 #include "./gemm.h"
 #include "./conv.h"
+#include "./grouped_gemm.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
 
 namespace raf {
 namespace op {
@@ -31,32 +34,37 @@ using namespace raf::ir;
 using namespace raf::value;
 using raf::registry::TypedPackedFunc;
 
-/*! \brief The persist cache entry of the best CUTLASS tuned config. */
+/*!
+ * \brief The persist cache entry of the best CUTLASS tuned config. The config is kept as its
+ * text form, which identifies it among the configs listed by the OpEnv, so that configs of
+ * all kinds of kernels can be persisted in the same way.
+ */
 class CUTLASSConfigCacheEntry {
  public:
   explicit CUTLASSConfigCacheEntry() {
   }
 
-  CUTLASSConfigCacheEntry(std::shared_ptr<TunableConfig> config) : config_(config) {
+  CUTLASSConfigCacheEntry(const std::string& config_text) : config_text_(config_text) {
   }
 
-  std::shared_ptr<TunableConfig> GetConfig() {
-    return config_;
+  const std::string& GetConfigText() const {
+    return config_text_;
   }
 
   static CUTLASSConfigCacheEntry Load(const std::string path) {
-    // Not support deserialization yet.
-    throw;
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/config.txt", &data);
+    return CUTLASSConfigCacheEntry(data);
   }
 
   bool Save(const std::string& path) {
-    // Not support serialization yet.
-    return false;
+    tvm::runtime::SaveBinaryToFile(path + "/config.txt", config_text_);
+    return true;
   }
 
  private:
-  /*! \brief The tunable config. */
-  std::shared_ptr<TunableConfig> config_;
+  /*! \brief The text form of the tunable config. */
+  std::string config_text_;
 };
 
 MetaPersistCache<CUTLASSConfigCacheEntry> CacheConfig("cutlass_fusion_config");
@@ -67,16 +75,28 @@ HashKey HashFusedFunc(const Function& func) {
   return key;
 }
 
+std::string ConfigText(const std::shared_ptr<TunableConfig>& config) {
+  std::ostringstream os;
+  config->AsText(os);
+  return os.str();
+}
+
 OpEnv* Tune(const op::CallValues& call, OpEnv* op_env) {
   CutlassOpEnv* env = static_cast<CutlassOpEnv*>(op_env);
   auto key = HashFusedFunc(Downcast<ClosureValue>(call->callee)->func);
+  std::vector<std::shared_ptr<TunableConfig>> tunable = env->ListTunableConfigs();
   std::shared_ptr<TunableConfig> best;
 
-  if (const auto* compiled = CacheConfig.Get(key.byte_vector)) {
-    CUTLASSConfigCacheEntry entry = *compiled;
-    best = entry.GetConfig();
-  } else {
-    std::vector<std::shared_ptr<TunableConfig>> tunable = env->ListTunableConfigs();
+  if (const auto* compiled = CacheConfig.Get(key)) {
+    // The cached config may be gone if the kernels are rebuilt, which leads to tuning again.
+    for (auto& config : tunable) {
+      if (ConfigText(config) == compiled->GetConfigText()) {
+        best = config;
+        break;
+      }
+    }
+  }
+  if (!best) {
     const int number = 10, repeat = 1, min_repeat_ms = 0, cooldown_interval_ms = 0,
               repeats_to_cooldown = 1, limit_zero_time_iterations = 100;
     double min_time = std::numeric_limits<double>::max();
@@ -92,7 +112,8 @@ OpEnv* Tune(const op::CallValues& call, OpEnv* op_env) {
         best = config;
       }
     }
-    CacheConfig.Set(key.byte_vector, CUTLASSConfigCacheEntry(best));
+    CHECK(best) << "No tunable config of CUTLASS kernels";
+    CacheConfig.Set(key, CUTLASSConfigCacheEntry(ConfigText(best)));
   }
 
   env->SetTunableConfig(best);
@@ -108,9 +129,12 @@ OpEnv* Tune(const op::CallValues& call, OpEnv* op_env) {
  *          - gemm_op(a, b)
  *          - gemm_op(a, b) + bias
  *          - epilogue_op(gemm_op(a, b) + bias)
+ *          - grouped_matmul(x, weight, group_sizes)
+ *          - grouped_matmul(x, weight, group_sizes) + residual
+ *          - epilogue_op(grouped_matmul(x, weight, group_sizes) + residual)
  *        where gemm_op = matmul | matmul_nt | matmul_tn | matmul_tt | dense |
  *                        batch_matmul | batch_matmul_nt | batch_matmul_tn | batch_matmul_tt
- *              epilogue_op = relu
+ *              epilogue_op = relu | gelu
  * \param call the call value to be dispatched
  * \return the CUTLASS OpEnv. nullptr if not supported by CUTLASS
  */
@@ -127,7 +151,10 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
       Tune(call, env);
     }
   };
-  if (!pattern_name.compare(0, 6, "matmul") || !pattern_name.compare(0, 12, "batch_matmul")) {
+  if (!pattern_name.compare(0, 14, "grouped_matmul")) {
+    fmake_tune(CutlassGroupedMatmulOpEnv::make);
+  } else if (!pattern_name.compare(0, 6, "matmul") ||
+             !pattern_name.compare(0, 12, "batch_matmul")) {
     fmake_tune(CutlassMatmulOpEnv::make);
   } else if (!pattern_name.compare(0, 4, "conv")) {
     fmake_tune(CutlassConv2dOpEnv::make);
@@ -0,0 +1,211 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file ./src/op/dialect/cutlass/grouped_gemm.cc
+ * \brief Implementation of cutlass grouped gemm dispatch
+ */
+#include "./grouped_gemm.h"
+
+#include "raf/value.h"
+#include "raf/registry.h"
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "tvm/relay/dataflow_pattern.h"
+#include "./cutlass_utils.h"
+#include "./pattern_utils.h"
+#include "../../../common/shape_utils.h"
+
+namespace raf {
+namespace op {
+namespace cutlass {
+
+using namespace raf::ir;
+using namespace raf::value;
+using raf::registry::PackedFunc;
+using raf::registry::TypedPackedFunc;
+
+bool CutlassGroupedMatmulOpEnv::Pattern(const CallValues& cv) {
+  Expr expr = Downcast<ClosureValue>(cv->callee)->func->body;
+  const static std::vector<std::string> epilogue_ops = {"raf.op.cutlass.relu",
+                                                        "raf.op.cutlass.gelu"};
+  auto grouped_matmul = IsOp("raf.op.cutlass.grouped_matmul");
+  auto epilogue = IsOps(epilogue_ops);
+  auto x = IsVar("");
+  auto weight = IsVar("");
+  auto group_sizes = IsVar("");
+  auto residual = IsVar("");
+  DFPattern pat = grouped_matmul({x, weight, group_sizes});
+  DFPattern with_residual = Add()(pat, residual);
+  pat = with_residual || pat;
+  DFPattern with_epilogue = epilogue({pat});
+  pat = with_epilogue || pat;
+
+  if (!RAFMatchPattern(pat, expr)) {
+    LOG(INFO) << "Failed to match the pattern";
+    return false;
+  }
+
+  // RAFRewritePatterns serves as a visitor here: it does not rewrite, instead information
+  // is recorded for later process.
+  TypedPackedFunc<Expr(const Expr&, const Expr&, const Map<DFPattern, Array<Expr>>&)> func(
+      [&](const Expr& pre, const Expr& post, const Map<DFPattern, Array<Expr>>& node_map) {
+        x_ = GetPattern<Var>(node_map, x);
+        weight_ = GetPattern<Var>(node_map, weight);
+        group_sizes_ = GetPattern<Var>(node_map, group_sizes);
+        residual_ = GetPattern<Var>(node_map, residual);
+        epilogue_op_ = GetEpilogueKind(GetPattern<Op>(node_map, epilogue));
+        return post;
+      });
+  DFPatternCallback cb(pat, func.operator PackedFunc(), false);
+  RAFRewritePatterns({cb}, expr);
+  return true;
+}
+
+bool CutlassGroupedMatmulOpEnv::IsValid(const CallValues& cv) {
+  if (!x_.defined() || !weight_.defined() || !group_sizes_.defined()) {
+    return false;
+  }
+  DLTensor* x = GetValue<TensorValue>(cv, x_);
+  DLTensor* weight = GetValue<TensorValue>(cv, weight_);
+  DLTensor* group_sizes = GetValue<TensorValue>(cv, group_sizes_);
+  DLTensor* out = cv->out;
+  bool flag = DType(x->dtype) == DType(out->dtype) && DType(weight->dtype) == DType(out->dtype);
+  flag = flag && group_sizes->dtype.code == kDLInt &&
+         (group_sizes->dtype.bits == 32 || group_sizes->dtype.bits == 64);
+  if (residual_.defined()) {
+    // The residual is read with the layout of the output, so it cannot be broadcast.
+    DLTensor* residual = GetValue<TensorValue>(cv, residual_);
+    flag = flag && DType(residual->dtype) == DType(out->dtype) &&
+           std::vector<int64_t>(residual->shape, residual->shape + residual->ndim) ==
+               std::vector<int64_t>(out->shape, out->shape + out->ndim);
+  }
+  return flag;
+}
+
+std::vector<GroupedGemmOperationExt const*> CutlassGroupedMatmulOpEnv::ListOperations(
+    const CallValues& cv) {
+  DLTensor* x = GetValue<TensorValue>(cv, x_);
+  DLTensor* weight = GetValue<TensorValue>(cv, weight_);
+  DLTensor* out = cv->out;
+  DLTensor* residual = residual_.defined() ? GetValue<TensorValue>(cv, residual_) : out;
+  int n = out->shape[1];
+  int k = x->shape[1];
+  int element_bytes = (out->dtype.bits + 7) / 8;
+  auto is_aligned = [element_bytes](const void* ptr, int alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % (alignment * element_bytes) == 0;
+  };
+  std::vector<GroupedGemmOperationExt const*> ret;
+  for (auto const* op : GetGroupedGemmOperationsExt(GetNumericTypeID(out->dtype), epilogue_op_)) {
+    int alignment = op->alignment();
+    bool aligned = n % alignment == 0 && k % alignment == 0;
+    for (const void* ptr : {x->data, weight->data, residual->data, out->data}) {
+      aligned = aligned && is_aligned(ptr, alignment);
+    }
+    if (aligned && op->minimum_compute_capability() <= compute_capability()) {
+      ret.push_back(op);
+    }
+  }
+  return ret;
+}
+
+void CutlassGroupedMatmulOpEnv::Init(const CallValues& cv) {
+  DLTensor* x = GetValue<TensorValue>(cv, x_);
+  DLTensor* weight = GetValue<TensorValue>(cv, weight_);
+  DLTensor* group_sizes = GetValue<TensorValue>(cv, group_sizes_);
+  DLTensor* out = cv->out;
+  DLTensor* residual = residual_.defined() ? GetValue<TensorValue>(cv, residual_) : out;
+  operations_ = ListOperations(cv);
+  CHECK(!operations_.empty()) << "Cannot find the required grouped GEMM op in CUTLASS for "
+                             << DType(out->dtype) << " with epilogue " << epilogue_op_;
+  grouped_operation_ = operations_[0];
+  for (auto const* op : operations_) {
+    if (op->name() == tunable_.kernel_name) {
+      grouped_operation_ = op;
+    }
+  }
+
+  int problem_count = weight->shape[0];
+  workspace_size_ = grouped_operation_->get_workspace_size(problem_count);
+  RequestWorkspace(&workspace_, device_, workspace_size_);
+
+  grouped_arguments_ = GroupedGemmArgumentsExt{
+      problem_count,
+      static_cast<int>(out->shape[0]),
+      static_cast<int>(out->shape[1]),
+      static_cast<int>(x->shape[1]),
+      group_sizes->data,
+      group_sizes->dtype.bits == 64 ? NumericTypeID::kS64 : NumericTypeID::kS32,
+      x->data,
+      weight->data,
+      residual->data,
+      out->data,
+      1.0f,
+      residual_.defined() ? 1.0f : 0.0f,
+      tunable_.threadblocks_per_sm * device_prop_.multiProcessorCount};
+  arg_indices = GetArgIndices(cv, residual_.defined()
+                                      ? std::vector<Var>({x_, weight_, group_sizes_, residual_})
+                                      : std::vector<Var>({x_, weight_, group_sizes_}));
+}
+
+std::vector<std::shared_ptr<TunableConfig>> CutlassGroupedMatmulOpEnv::ListTunableConfigs() {
+  // Tunable configuration: threadblocks_per_sm
+  // The persistent kernel iterates over the tiles of all groups with a fixed number of
+  // threadblocks. 0 means the maximum occupancy of the kernel.
+  const static std::vector<int> threadblocks_per_sm = {0, 1, 2};
+  std::vector<std::shared_ptr<TunableConfig>> rets;
+  for (auto const* op : operations_) {
+    for (int i_threadblocks_per_sm : threadblocks_per_sm) {
+      if (i_threadblocks_per_sm < op->maximum_active_blocks()) {
+        rets.push_back(
+            std::make_shared<GroupedGemmTunableConfig>(op->name(), i_threadblocks_per_sm));
+      }
+    }
+  }
+  return rets;
+}
+
+void CutlassGroupedMatmulOpEnv::SetTunableConfig(const std::shared_ptr<TunableConfig>& tunable) {
+  tunable_ = *static_cast<GroupedGemmTunableConfig*>(tunable.get());
+}
+
+OpEnv* CutlassGroupedMatmulOpEnv::make(const CallValues& cv) {
+  CutlassGroupedMatmulOpEnv* op_env = new CutlassGroupedMatmulOpEnv(cv);
+  auto matched_pattern = op_env->Pattern(cv);
+  auto valid = matched_pattern && op_env->IsValid(cv);
+  if (!matched_pattern || !valid) {
+    std::stringstream ss;
+    ss << "[CUTLASS] Cannot JIT: matched pattern? " << matched_pattern << ", valid? " << valid;
+    op_env->error_msgs.push_back(ss.str());
+    return op_env;
+  }
+  try {
+    op_env->Init(cv);
+  } catch (const dmlc::Error& e) {
+    std::stringstream ss;
+    ss << "[CUTLASS] Failed to JIT: " << e.what();
+    op_env->error_msgs.push_back(ss.str());
+    return op_env;
+  }
+  return op_env;
+}
+
+void CutlassGroupedMatmulOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
+  DLTensor* out = Downcast<TensorValue>(output);
+  grouped_arguments_.A = Downcast<TensorValue>(inputs[0])->data;
+  grouped_arguments_.B = Downcast<TensorValue>(inputs[1])->data;
+  grouped_arguments_.group_sizes = Downcast<TensorValue>(inputs[2])->data;
+  grouped_arguments_.C = residual_.defined() ? Downcast<TensorValue>(inputs[3])->data : out->data;
+  grouped_arguments_.D = out->data;
+  CUTLASS_CALL(grouped_operation_->run(grouped_arguments_, workspace_, GetStream()));
+}
+
+RAF_REGISTER_DIALECT_OP(cutlass, grouped_matmul, 0);
+
+}  // namespace cutlass
+}  // namespace op
+}  // namespace raf
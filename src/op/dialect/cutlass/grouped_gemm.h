@@ -0,0 +1,106 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file ./src/op/dialect/cutlass/grouped_gemm.h
+ * \brief Implementation of cutlass grouped gemm dispatch
+ */
+#pragma once
+
+#include "cutlass_ext/library/grouped_gemm_ext.h"
+
+#include "raf/value.h"
+#include "raf/registry.h"
+#include "raf/op.h"
+#include "raf/ir.h"
+#include "raf/ir_ext.h"
+#include "./cutlass_utils.h"
+
+namespace raf {
+namespace op {
+namespace cutlass {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+/*! \brief Tunable configurations for cutlass grouped gemm */
+struct GroupedGemmTunableConfig : public TunableConfig {
+  GroupedGemmTunableConfig(std::string kernel_name, int threadblocks_per_sm)
+      : TunableConfig(kernel_name), threadblocks_per_sm(threadblocks_per_sm) {
+  }
+
+  GroupedGemmTunableConfig() : threadblocks_per_sm(0) {
+  }
+
+  virtual void AsText(std::ostream& os) const override {
+    os << "{" << std::endl;
+    os << "  kernel_name: " << kernel_name << std::endl;
+    os << "  threadblocks_per_sm: " << threadblocks_per_sm << std::endl;
+    os << "}" << std::endl;
+  }
+
+  /*!
+   * \brief the number of persistent threadblocks per SM. 0 means the maximum occupancy of
+   * the kernel
+   */
+  int threadblocks_per_sm;
+};
+
+/*! \brief OpEnv for the following pattern:
+ * epilogue_op_(grouped_matmul(x_, weight_, group_sizes_) + residual_),
+ * where 1) the residual is optional and has the same shape as the output;
+ * 2) epilogue_op_ can be relu, gelu or identity.
+ * All the groups are computed by one persistent kernel, instead of one gemm per group.
+ */
+class CutlassGroupedMatmulOpEnv : public CutlassOpEnv {
+ public:
+  explicit CutlassGroupedMatmulOpEnv(const CallValues& cv) : CutlassOpEnv(cv) {
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.cutlass.grouped_matmul"));
+  }
+
+  bool Pattern(const CallValues& cv);
+
+  bool IsValid(const CallValues& cv);
+
+  void Init(const CallValues& cv) override;
+
+  void Execute(const std::vector<Value>& inputs, Value output) override;
+
+  std::vector<std::shared_ptr<TunableConfig>> ListTunableConfigs() override;
+
+  void SetTunableConfig(const std::shared_ptr<TunableConfig>& tunable) override;
+
+  static OpEnv* make(const CallValues& cv);
+
+ private:
+  /*! \brief The kernels that can run the problem, in descending order of preference */
+  std::vector<GroupedGemmOperationExt const*> ListOperations(const CallValues& cv);
+
+  /*! \brief grouped matmul operand x */
+  Var x_;
+  /*! \brief grouped matmul operand weight */
+  Var weight_;
+  /*! \brief the size of each group */
+  Var group_sizes_;
+  /*! \brief residual added to the grouped matmul result */
+  Var residual_;
+  /*! \brief epilogue operator like relu, gelu, etc. */
+  EpilogueKindExt epilogue_op_;
+  /*! \brief the kernels that can run the problem */
+  std::vector<GroupedGemmOperationExt const*> operations_;
+  /*! \brief the selected kernel */
+  GroupedGemmOperationExt const* grouped_operation_{nullptr};
+  /*! \brief grouped gemm arguments */
+  GroupedGemmArgumentsExt grouped_arguments_;
+  /*! \brief Tunable configuration for cutlass grouped gemm */
+  GroupedGemmTunableConfig tunable_;
+};
+
+}  // namespace cutlass
+}  // namespace op
+}  // namespace raf
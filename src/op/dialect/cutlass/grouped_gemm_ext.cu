@@ -0,0 +1,277 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/cutlass/grouped_gemm_ext.cu
+ * \brief Instances of cutlass grouped gemm kernels
+ */
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "cutlass/cutlass.h"
+#include "cutlass/gemm/gemm.h"
+#include "cutlass/gemm/kernel/gemm_grouped.h"
+#include "cutlass/gemm/kernel/default_gemm_grouped.h"
+#include "cutlass/gemm/device/gemm_grouped.h"
+#include "cutlass/epilogue/thread/linear_combination.h"
+#include "cutlass/epilogue/thread/linear_combination_relu.h"
+#include "cutlass/epilogue/thread/linear_combination_gelu.h"
+
+#include "cutlass_ext/library/grouped_gemm_ext.h"
+
+namespace cutlass {
+namespace library {
+
+namespace {
+
+/*! \brief Round up the number of bytes to a multiple of 16 */
+inline size_t round_up_bytes(size_t bytes) {
+  return (bytes + 15) / 16 * 16;
+}
+
+/*!
+ * \brief Build the problem size, the pointers and the leading dimensions of each group from the
+ * group sizes, so that the host does not have to read the group sizes back from the device.
+ */
+template <typename ElementGroupSize, typename Element>
+__global__ void grouped_gemm_setup_kernel(
+  ElementGroupSize const *group_sizes, int problem_count, int N, int K,
+  Element const *A, Element const *B, Element const *C, Element *D,
+  gemm::GemmCoord *problem_sizes, Element **ptr_A, Element **ptr_B, Element **ptr_C,
+  Element **ptr_D, int64_t *lda, int64_t *ldb, int64_t *ldc, int64_t *ldd) {
+
+  int g = blockIdx.x * blockDim.x + threadIdx.x;
+  if (g >= problem_count) {
+    return;
+  }
+  int64_t offset = 0;
+  for (int i = 0; i < g; ++i) {
+    offset += static_cast<int64_t>(group_sizes[i]);
+  }
+  problem_sizes[g] = gemm::GemmCoord(static_cast<int>(group_sizes[g]), N, K);
+  ptr_A[g] = const_cast<Element *>(A) + offset * K;
+  ptr_B[g] = const_cast<Element *>(B) + static_cast<int64_t>(g) * K * N;
+  ptr_C[g] = const_cast<Element *>(C) + offset * N;
+  ptr_D[g] = D + offset * N;
+  lda[g] = K;
+  ldb[g] = N;
+  ldc[g] = N;
+  ldd[g] = N;
+}
+
+template <
+  typename Element,
+  typename OperatorClass,
+  typename ArchTag,
+  typename ThreadblockShape,
+  typename WarpShape,
+  typename InstructionShape,
+  typename EpilogueOutputOp,
+  int Stages,
+  int Alignment
+>
+class GroupedGemmOperation : public GroupedGemmOperationExt {
+public:
+
+  using GemmKernel = typename gemm::kernel::DefaultGemmGrouped<
+    Element, layout::RowMajor, ComplexTransform::kNone, Alignment,
+    Element, layout::RowMajor, ComplexTransform::kNone, Alignment,
+    Element, layout::RowMajor,
+    float,
+    OperatorClass,
+    ArchTag,
+    ThreadblockShape,
+    WarpShape,
+    InstructionShape,
+    EpilogueOutputOp,
+    gemm::threadblock::GemmBatchedIdentityThreadblockSwizzle,
+    Stages>::GemmKernel;
+
+  using Gemm = gemm::device::GemmGrouped<GemmKernel>;
+
+  GroupedGemmOperation(char const *name, int minimum_compute_capability)
+    : name_(name), minimum_compute_capability_(minimum_compute_capability) { }
+
+  std::string const &name() const override {
+    return name_;
+  }
+
+  int minimum_compute_capability() const override {
+    return minimum_compute_capability_;
+  }
+
+  int alignment() const override {
+    return Alignment;
+  }
+
+  int maximum_active_blocks() const override {
+    return Gemm::maximum_active_blocks();
+  }
+
+  size_t get_workspace_size(int problem_count) const override {
+    return round_up_bytes(sizeof(gemm::GemmCoord) * problem_count) +
+           4 * round_up_bytes(sizeof(Element *) * problem_count) +
+           4 * round_up_bytes(sizeof(int64_t) * problem_count);
+  }
+
+  Status run(GroupedGemmArgumentsExt const &args, void *workspace,
+             cudaStream_t stream) const override {
+
+    int count = args.problem_count;
+    char *ptr = static_cast<char *>(workspace);
+    auto take = [&ptr](size_t bytes) {
+      char *ret = ptr;
+      ptr += round_up_bytes(bytes);
+      return ret;
+    };
+    auto *problem_sizes =
+      reinterpret_cast<gemm::GemmCoord *>(take(sizeof(gemm::GemmCoord) * count));
+    Element **ptrs[4];
+    for (auto &p : ptrs) {
+      p = reinterpret_cast<Element **>(take(sizeof(Element *) * count));
+    }
+    int64_t *lds[4];
+    for (auto &p : lds) {
+      p = reinterpret_cast<int64_t *>(take(sizeof(int64_t) * count));
+    }
+
+    Element const *A = static_cast<Element const *>(args.A);
+    Element const *B = static_cast<Element const *>(args.B);
+    Element const *C = static_cast<Element const *>(args.C);
+    Element *D = static_cast<Element *>(args.D);
+    int const kThreads = 128;
+    int blocks = (count + kThreads - 1) / kThreads;
+    if (args.element_group_sizes == NumericTypeID::kS64) {
+      grouped_gemm_setup_kernel<<<blocks, kThreads, 0, stream>>>(
+        static_cast<int64_t const *>(args.group_sizes), count, args.N, args.K, A, B, C, D,
+        problem_sizes, ptrs[0], ptrs[1], ptrs[2], ptrs[3], lds[0], lds[1], lds[2], lds[3]);
+    } else if (args.element_group_sizes == NumericTypeID::kS32) {
+      grouped_gemm_setup_kernel<<<blocks, kThreads, 0, stream>>>(
+        static_cast<int32_t const *>(args.group_sizes), count, args.N, args.K, A, B, C, D,
+        problem_sizes, ptrs[0], ptrs[1], ptrs[2], ptrs[3], lds[0], lds[1], lds[2], lds[3]);
+    } else {
+      return Status::kErrorInvalidDataType;
+    }
+    if (cudaGetLastError() != cudaSuccess) {
+      return Status::kErrorInternal;
+    }
+
+    int threadblock_count = args.threadblock_count;
+    if (threadblock_count <= 0) {
+      threadblock_count = Gemm::sufficient();
+    }
+    typename EpilogueOutputOp::Params epilogue(args.alpha, args.beta);
+    typename Gemm::Arguments arguments(
+      problem_sizes, count, threadblock_count, epilogue,
+      ptrs[0], ptrs[1], ptrs[2], ptrs[3], lds[0], lds[1], lds[2], lds[3]);
+
+    Gemm gemm;
+    Status status = gemm.initialize(arguments, nullptr, stream);
+    if (status != Status::kSuccess) {
+      return status;
+    }
+    return gemm.run(stream);
+  }
+
+private:
+  /// The unique name of the kernel
+  std::string name_;
+  /// The minimum compute capability required by the kernel
+  int minimum_compute_capability_;
+};
+
+/// SIMT kernels, which work on all devices and any alignment
+template <typename Element, typename EpilogueOp, typename ThreadblockShape, typename WarpShape>
+using SimtGroupedGemm = GroupedGemmOperation<
+  Element, arch::OpClassSimt, arch::Sm50, ThreadblockShape, WarpShape,
+  gemm::GemmShape<1, 1, 1>, EpilogueOp, 2, 1>;
+
+/// Tensor core kernels for half precision, which require K and N to be multiples of 8
+template <typename EpilogueOp, typename ThreadblockShape, typename WarpShape>
+using TensorOpGroupedGemm = GroupedGemmOperation<
+  half_t, arch::OpClassTensorOp, arch::Sm80, ThreadblockShape, WarpShape,
+  gemm::GemmShape<16, 8, 16>, EpilogueOp, 3, 8>;
+
+template <template <typename, int, typename, typename> class Epilogue, typename Element>
+void append_simt_operations(std::vector<GroupedGemmOperationExt const *> *ops,
+                            std::string const &prefix) {
+  using EpilogueOp = Epilogue<Element, 1, float, float>;
+  static SimtGroupedGemm<Element, EpilogueOp, gemm::GemmShape<128, 128, 8>,
+                         gemm::GemmShape<32, 64, 8>> large(
+    (prefix + "_simt_128x128x8").c_str(), 50);
+  static SimtGroupedGemm<Element, EpilogueOp, gemm::GemmShape<64, 64, 8>,
+                         gemm::GemmShape<32, 32, 8>> small(
+    (prefix + "_simt_64x64x8").c_str(), 50);
+  ops->push_back(&large);
+  ops->push_back(&small);
+}
+
+template <template <typename, int, typename, typename> class Epilogue>
+void append_tensorop_operations(std::vector<GroupedGemmOperationExt const *> *ops,
+                                std::string const &prefix) {
+  using EpilogueOp = Epilogue<half_t, 8, float, float>;
+  static TensorOpGroupedGemm<EpilogueOp, gemm::GemmShape<128, 128, 32>,
+                             gemm::GemmShape<64, 64, 32>> large(
+    (prefix + "_tensorop_128x128x32").c_str(), 80);
+  static TensorOpGroupedGemm<EpilogueOp, gemm::GemmShape<64, 64, 32>,
+                             gemm::GemmShape<32, 32, 32>> small(
+    (prefix + "_tensorop_64x64x32").c_str(), 80);
+  ops->push_back(&large);
+  ops->push_back(&small);
+}
+
+template <typename ElementOutput, int Count, typename ElementAccumulator, typename ElementCompute>
+using LinearCombination = epilogue::thread::LinearCombination<
+  ElementOutput, Count, ElementAccumulator, ElementCompute>;
+
+template <typename ElementOutput, int Count, typename ElementAccumulator, typename ElementCompute>
+using LinearCombinationRelu = epilogue::thread::LinearCombinationRelu<
+  ElementOutput, Count, ElementAccumulator, ElementCompute>;
+
+template <typename ElementOutput, int Count, typename ElementAccumulator, typename ElementCompute>
+using LinearCombinationGELU = epilogue::thread::LinearCombinationGELU<
+  ElementOutput, Count, ElementAccumulator, ElementCompute>;
+
+template <template <typename, int, typename, typename> class Epilogue>
+std::vector<GroupedGemmOperationExt const *> make_operations(NumericTypeID element,
+                                                            std::string const &epilogue_name) {
+  std::vector<GroupedGemmOperationExt const *> ops;
+  if (element == NumericTypeID::kF32) {
+    append_simt_operations<Epilogue, float>(&ops, "raf_sgemm_grouped_" + epilogue_name);
+  } else if (element == NumericTypeID::kF16) {
+    append_tensorop_operations<Epilogue>(&ops, "raf_hgemm_grouped_" + epilogue_name);
+    append_simt_operations<Epilogue, half_t>(&ops, "raf_hgemm_grouped_" + epilogue_name);
+  }
+  return ops;
+}
+
+} // namespace
+
+std::vector<GroupedGemmOperationExt const *> const &GetGroupedGemmOperationsExt(
+  NumericTypeID element, EpilogueKindExt epilogue_math_op) {
+
+  static std::map<std::pair<NumericTypeID, EpilogueKindExt>,
+                  std::vector<GroupedGemmOperationExt const *>> table;
+  static std::vector<GroupedGemmOperationExt const *> empty;
+  auto key = std::make_pair(element, epilogue_math_op);
+  auto it = table.find(key);
+  if (it != table.end()) {
+    return it->second;
+  }
+  if (epilogue_math_op == EpilogueKindExt::kLinearCombination) {
+    table[key] = make_operations<LinearCombination>(element, "linear");
+  } else if (epilogue_math_op == EpilogueKindExt::kLinearCombinationRelu) {
+    table[key] = make_operations<LinearCombinationRelu>(element, "relu");
+  } else if (epilogue_math_op == EpilogueKindExt::kLinearCombinationGelu) {
+    table[key] = make_operations<LinearCombinationGELU>(element, "gelu");
+  } else {
+    return empty;
+  }
+  return table[key];
+}
+
+} // namespace library
+} // namespace cutlass
@@ -0,0 +1,557 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/mpi/mpi.cc
+ * \brief Communication operators of the CPU tensors implemented by MPI, for the CPU-only clusters.
+ * The reductions are ring reductions chunked into segments, whose transfers overlap with the
+ * reduction of the previous segment on the intra-op threads.
+ */
+#include <tvm/runtime/c_backend_api.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "raf/op_utils.h"
+#include "raf/device_api.h"
+#include "raf/mpi_communicator.h"
+#include "raf/metrics.h"
+#include "../../schema/communication.h"
+#include "../../../common/shape_utils.h"
+
+namespace raf {
+namespace op {
+namespace communication {
+namespace mpi {
+using namespace distributed;
+using namespace distributed::communicator;
+using common::shape_utils::BytesCompactTensor;
+
+RAF_REGISTER_DIALECT("mpi").set_enable(DevType::kCPU());
+
+/*! \brief The bytes of a segment of the ring, which is sent while the last one is reduced. */
+constexpr int64_t kSegmentBytes = 1 << 20;
+/*! \brief The minimal number of elements of a segment to reduce on multiple threads. */
+constexpr int64_t kParallelReduceElements = 1 << 15;
+
+/*! \brief The reduction of the collectives. */
+enum class Computation { kSum, kProd, kMin, kMax, kAvg };
+
+static Computation GetComputation(const std::string& computation) {
+  if (computation == "sum") {
+    return Computation::kSum;
+  } else if (computation == "prod") {
+    return Computation::kProd;
+  } else if (computation == "min") {
+    return Computation::kMin;
+  } else if (computation == "max") {
+    return Computation::kMax;
+  } else if (computation == "avg") {
+    return Computation::kAvg;
+  }
+  LOG(FATAL) << "Invalid computation " << computation;
+  throw;
+}
+
+/*! \brief Whether the dtype can be reduced on the CPU. */
+static bool IsSupportedDType(const DLDataType& dtype) {
+  if (dtype.lanes != 1) {
+    return false;
+  }
+  switch (dtype.code) {
+    case kDLFloat:
+      return dtype.bits == 32 || dtype.bits == 64;
+    case kDLInt:
+      return dtype.bits == 8 || dtype.bits == 32 || dtype.bits == 64;
+    case kDLUInt:
+      return dtype.bits == 8;
+  }
+  return false;
+}
+
+/*! \brief The counter of the bytes of the data that the collectives of the type send or receive. */
+static metrics::Counter* CommBytesCounter(const std::string& collective) {
+  return metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_comm_bytes_total", "The bytes of the data of the collectives on this rank.",
+      {{"collective", collective}});
+}
+
+/*! \brief The elementwise reduction of src into dst of a range, which is a task of the pool. */
+template <typename T>
+struct ReduceTask {
+  T* dst;
+  const T* src;
+  int64_t n;
+  Computation op;
+
+  void Run(int64_t begin, int64_t end) const {
+    switch (op) {
+      case Computation::kSum:
+      case Computation::kAvg:
+        for (int64_t i = begin; i < end; ++i) dst[i] += src[i];
+        break;
+      case Computation::kProd:
+        for (int64_t i = begin; i < end; ++i) dst[i] *= src[i];
+        break;
+      case Computation::kMin:
+        for (int64_t i = begin; i < end; ++i) dst[i] = std::min(dst[i], src[i]);
+        break;
+      case Computation::kMax:
+        for (int64_t i = begin; i < end; ++i) dst[i] = std::max(dst[i], src[i]);
+        break;
+    }
+  }
+
+  static int Lambda(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+    const auto* task = static_cast<const ReduceTask<T>*>(cdata);
+    int64_t step = (task->n + penv->num_task - 1) / penv->num_task;
+    int64_t begin = std::min(task->n, task_id * step);
+    task->Run(begin, std::min(task->n, begin + step));
+    return 0;
+  }
+};
+
+/*! \brief Reduce src into dst, on the intra-op threads of the TVM pool if it is large. */
+template <typename T>
+static void ReduceInto(void* dst, const void* src, int64_t n, Computation op) {
+  ReduceTask<T> task{static_cast<T*>(dst), static_cast<const T*>(src), n, op};
+  if (n < kParallelReduceElements) {
+    task.Run(0, n);
+    return;
+  }
+  TVMBackendParallelLaunch(ReduceTask<T>::Lambda, &task, device_api::cpu::GetNumThreads());
+}
+
+/*! \brief Divide the elements by the number of ranks, which finishes the average. */
+template <typename T>
+static void DivideBy(void* data, int64_t n, int size) {
+  T* ptr = static_cast<T*>(data);
+  for (int64_t i = 0; i < n; ++i) {
+    ptr[i] /= static_cast<T>(size);
+  }
+}
+
+#define RAF_MPI_DTYPE_SWITCH(dtype, TYPE, ...)                    \
+  switch (dtype.code * 256 + dtype.bits) {                        \
+    case kDLFloat * 256 + 32: {                                   \
+      using TYPE = float;                                         \
+      __VA_ARGS__;                                                \
+      break;                                                      \
+    }                                                             \
+    case kDLFloat * 256 + 64: {                                   \
+      using TYPE = double;                                        \
+      __VA_ARGS__;                                                \
+      break;                                                      \
+    }                                                             \
+    case kDLInt * 256 + 8: {                                      \
+      using TYPE = int8_t;                                        \
+      __VA_ARGS__;                                                \
+      break;                                                      \
+    }                                                             \
+    case kDLInt * 256 + 32: {                                     \
+      using TYPE = int32_t;                                       \
+      __VA_ARGS__;                                                \
+      break;                                                      \
+    }                                                             \
+    case kDLInt * 256 + 64: {                                     \
+      using TYPE = int64_t;                                       \
+      __VA_ARGS__;                                                \
+      break;                                                      \
+    }                                                             \
+    case kDLUInt * 256 + 8: {                                     \
+      using TYPE = uint8_t;                                       \
+      __VA_ARGS__;                                                \
+      break;                                                      \
+    }                                                             \
+    default:                                                      \
+      LOG(FATAL) << "Unsupported dtype " << DType(dtype).c_str(); \
+  }
+
+/*!
+ * \brief The ring of the ranks of a communicator, which reduce-scatters and allgathers the chunks
+ * of a buffer in place. The buffer is divided into a chunk per rank, and each step of the ring
+ * sends a chunk to the right rank and receives a chunk from the left one. The chunks are sent in
+ * segments, so the reduction of a segment overlaps with the receiving of the next one.
+ */
+class Ring {
+ public:
+  Ring(MPI_Comm comm, int rank, int size, DLDataType dtype, Computation op, void* segments)
+      : comm_(comm), rank_(rank), size_(size), dtype_(dtype), op_(op), segments_(segments) {
+    elem_bytes_ = GetSizeInBytes(dtype);
+    segment_ = std::max<int64_t>(1, kSegmentBytes / elem_bytes_);
+  }
+
+  /*! \brief The bytes of the double-buffered segments received. */
+  static int64_t SegmentsBytes() {
+    return 2 * kSegmentBytes;
+  }
+
+  /*!
+   * \brief Reduce-scatter the buffer of count elements in place, after which this rank holds the
+   * reduced chunk of its rank, i.e., [ChunkBegin(rank), ChunkBegin(rank + 1)).
+   */
+  void ReduceScatter(void* buffer, int64_t count) {
+    auto* bytes = static_cast<uint8_t*>(buffer);
+    for (int step = 0; step < size_ - 1; ++step) {
+      int send = Mod(rank_ - step - 1);
+      int recv = Mod(rank_ - step - 2);
+      int64_t send_begin = ChunkBegin(send, count), send_end = ChunkBegin(send + 1, count);
+      int64_t recv_begin = ChunkBegin(recv, count), recv_end = ChunkBegin(recv + 1, count);
+      std::vector<MPI_Request> sends;
+      for (int64_t i = send_begin; i < send_end; i += segment_) {
+        sends.emplace_back();
+        MPI_CALL(MPI_Isend(bytes + i * elem_bytes_, Count(std::min(segment_, send_end - i)),
+                           MPI_BYTE, Mod(rank_ + 1), step, comm_, &sends.back()));
+      }
+      MPI_Request recv_req = MPI_REQUEST_NULL;
+      int slot = 0;
+      if (recv_begin < recv_end) {
+        PostRecv(recv_end, recv_begin, slot, step, &recv_req);
+      }
+      for (int64_t i = recv_begin; i < recv_end; i += segment_) {
+        MPI_CALL(MPI_Wait(&recv_req, MPI_STATUS_IGNORE));
+        if (i + segment_ < recv_end) {
+          PostRecv(recv_end, i + segment_, 1 - slot, step, &recv_req);
+        }
+        int64_t n = std::min(segment_, recv_end - i);
+        void* dst = bytes + i * elem_bytes_;
+        const void* src = static_cast<uint8_t*>(segments_) + slot * kSegmentBytes;
+        RAF_MPI_DTYPE_SWITCH(dtype_, T, ReduceInto<T>(dst, src, n, op_));
+        slot = 1 - slot;
+      }
+      if (!sends.empty()) {
+        MPI_CALL(MPI_Waitall(sends.size(), sends.data(), MPI_STATUSES_IGNORE));
+      }
+    }
+    if (op_ == Computation::kAvg) {
+      int64_t begin = ChunkBegin(rank_, count);
+      void* chunk = bytes + begin * elem_bytes_;
+      RAF_MPI_DTYPE_SWITCH(dtype_, T,
+                           DivideBy<T>(chunk, ChunkBegin(rank_ + 1, count) - begin, size_));
+    }
+  }
+
+  /*! \brief Allgather the chunks of the ranks in place, where this rank holds its chunk. */
+  void AllGather(void* buffer, int64_t count) {
+    auto* bytes = static_cast<uint8_t*>(buffer);
+    for (int step = 0; step < size_ - 1; ++step) {
+      int send = Mod(rank_ - step);
+      int recv = Mod(rank_ - step - 1);
+      int64_t send_begin = ChunkBegin(send, count);
+      int64_t recv_begin = ChunkBegin(recv, count);
+      MPI_CALL(MPI_Sendrecv(bytes + send_begin * elem_bytes_,
+                            Count(ChunkBegin(send + 1, count) - send_begin), MPI_BYTE,
+                            Mod(rank_ + 1), step, bytes + recv_begin * elem_bytes_,
+                            Count(ChunkBegin(recv + 1, count) - recv_begin), MPI_BYTE,
+                            Mod(rank_ - 1), step, comm_, MPI_STATUS_IGNORE));
+    }
+  }
+
+  /*! \brief The first element of the chunk of a rank, where the first ranks take the remainder. */
+  int64_t ChunkBegin(int chunk, int64_t count) const {
+    int64_t base = count / size_, remainder = count % size_;
+    return chunk * base + std::min<int64_t>(chunk, remainder);
+  }
+
+ private:
+  int Mod(int rank) const {
+    return ((rank % size_) + size_) % size_;
+  }
+
+  /*! \brief The MPI count of the bytes of n elements. */
+  int Count(int64_t n) const {
+    int64_t bytes = n * elem_bytes_;
+    CHECK_LE(bytes, std::numeric_limits<int>::max()) << "The MPI message is too large";
+    return static_cast<int>(bytes);
+  }
+
+  /*! \brief Receive the segment at the i-th element of a chunk ending at end into the slot. */
+  void PostRecv(int64_t end, int64_t i, int slot, int tag, MPI_Request* req) {
+    void* dst = static_cast<uint8_t*>(segments_) + slot * kSegmentBytes;
+    MPI_CALL(MPI_Irecv(dst, Count(std::min(segment_, end - i)), MPI_BYTE, Mod(rank_ - 1), tag,
+                       comm_, req));
+  }
+
+  MPI_Comm comm_;
+  int rank_, size_;
+  DLDataType dtype_;
+  Computation op_;
+  /*! \brief The double-buffered segments received. */
+  void* segments_;
+  int64_t elem_bytes_;
+  /*! \brief The number of elements of a segment. */
+  int64_t segment_;
+};
+
+class MPIOpEnv : public raf::op::OpEnv {
+ protected:
+  void* communicator;
+
+  explicit MPIOpEnv(const CallValues& cv, const Value& rank_list) {
+    RequestDistributed(&communicator, "mpi", rank_list);
+  }
+
+  const MPICommunicatorObj* GetComm() const {
+    return reinterpret_cast<MPICommunicatorObj*>(communicator);
+  }
+
+  /*! \brief Check the dtypes of the tensors, which are reported as the errors of dispatching. */
+  bool CheckDTypes(const std::vector<const DLTensor*>& tensors) {
+    for (const DLTensor* x : tensors) {
+      if (!IsSupportedDType(x->dtype) || DType(x->dtype) != DType(tensors[0]->dtype)) {
+        this->error_msgs.push_back("[MPI] Unsupported dtype " +
+                                   std::string(DType(x->dtype).c_str()));
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+class MPIAllReduce : public MPIOpEnv {
+  Computation compute;
+  DLDataType dtype;
+  int64_t total_bytes = 0;
+  void* fused_data = nullptr;
+  void* segments = nullptr;
+
+  explicit MPIAllReduce(const CallValues& cv)
+      : MPIOpEnv(cv, cv->args.as<raf::op::schema::AllreduceArgs>()->rank_list) {
+    auto op = ir::Op::Get("raf.op._allreduce");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::AllreduceArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    compute = GetComputation(args->computation);
+    std::vector<const DLTensor*> tensors;
+    for (const auto& x : args->x) {
+      const DLTensor* t = x;
+      tensors.push_back(t);
+      total_bytes += BytesCompactTensor(*t);
+    }
+    if (!CheckDTypes(tensors)) {
+      return;
+    }
+    dtype = tensors[0]->dtype;
+    if (tensors.size() > 1) {
+      RequestWorkspace(&fused_data, cv->device, total_bytes);
+    }
+    RequestWorkspace(&segments, cv->device, Ring::SegmentsBytes());
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._allreduce"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::AllreduceArgs>();
+    Execute({TupleValue::make(ir::Array<Value>(args->x.begin(), args->x.end()))}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("allreduce");
+    comm_bytes->Add(total_bytes);
+    auto tv = Downcast<value::TupleValue>(inputs[0]);
+    ir::Array<Value> outs = tv->fields.size() == 1 ? ir::Array<Value>({output})
+                                                   : Downcast<value::TupleValue>(output)->fields;
+    // The tensors are packed into the fused buffer, which is reduced in place.
+    void* buffer = fused_data;
+    if (tv->fields.size() == 1) {
+      DLTensor* x = tv->fields[0];
+      DLTensor* out = outs[0];
+      buffer = out->data;
+      if (out->data != x->data) {
+        std::memcpy(out->data, x->data, total_bytes);
+      }
+    } else {
+      size_t offset = 0;
+      for (const auto& field : tv->fields) {
+        DLTensor* x = field;
+        size_t bytes = BytesCompactTensor(*x);
+        std::memcpy(static_cast<uint8_t*>(fused_data) + offset, x->data, bytes);
+        offset += bytes;
+      }
+    }
+    const auto* comm = GetComm();
+    if (comm->size > 1) {
+      int64_t count = total_bytes / GetSizeInBytes(dtype);
+      Ring ring(comm->mpi_comm, comm->rank, comm->size, dtype, compute, segments);
+      ring.ReduceScatter(buffer, count);
+      ring.AllGather(buffer, count);
+    }
+    if (tv->fields.size() > 1) {
+      size_t offset = 0;
+      for (const auto& field : outs) {
+        DLTensor* out = field;
+        size_t bytes = BytesCompactTensor(*out);
+        std::memcpy(out->data, static_cast<uint8_t*>(fused_data) + offset, bytes);
+        offset += bytes;
+      }
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIAllReduce(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _allreduce, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._allreduce", MPIAllReduce::make);
+
+class MPIReduceScatter : public MPIOpEnv {
+  Computation compute;
+  DLDataType dtype;
+  void* buffer = nullptr;
+  void* segments = nullptr;
+
+  explicit MPIReduceScatter(const CallValues& cv)
+      : MPIOpEnv(cv, cv->args.as<raf::op::schema::ReduceScatterArgs>()->rank_list) {
+    auto op = ir::Op::Get("raf.op._reduce_scatter");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::ReduceScatterArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    compute = GetComputation(args->computation);
+    const DLTensor* x = args->x;
+    if (!CheckDTypes({x})) {
+      return;
+    }
+    dtype = x->dtype;
+    RequestWorkspace(&buffer, cv->device, BytesCompactTensor(*x));
+    RequestWorkspace(&segments, cv->device, Ring::SegmentsBytes());
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._reduce_scatter"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::ReduceScatterArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("reduce_scatter");
+    DLTensor* x = inputs[0];
+    DLTensor* out = output;
+    int64_t bytes = BytesCompactTensor(*x);
+    comm_bytes->Add(bytes);
+    const auto* comm = GetComm();
+    int64_t count = bytes / GetSizeInBytes(dtype);
+    CHECK_EQ(count % comm->size, 0) << "reduce_scatter expects an even split over the ranks";
+    std::memcpy(buffer, x->data, bytes);
+    Ring ring(comm->mpi_comm, comm->rank, comm->size, dtype, compute, segments);
+    if (comm->size > 1) {
+      ring.ReduceScatter(buffer, count);
+    }
+    int64_t begin = ring.ChunkBegin(comm->rank, count);
+    int64_t chunk = count / comm->size;
+    void* reduced = static_cast<uint8_t*>(buffer) + begin * GetSizeInBytes(dtype);
+    std::memcpy(out->data, reduced, chunk * GetSizeInBytes(dtype));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIReduceScatter(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _reduce_scatter, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._reduce_scatter", MPIReduceScatter::make);
+
+class MPIAllGather : public MPIOpEnv {
+  explicit MPIAllGather(const CallValues& cv)
+      : MPIOpEnv(cv, cv->args.as<raf::op::schema::AllgatherArgs>()->rank_list) {
+    auto op = ir::Op::Get("raf.op._allgather");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::AllgatherArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    CheckDTypes({args->x});
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._allgather"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::AllgatherArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("allgather");
+    DLTensor* x = inputs[0];
+    DLTensor* out = output;
+    int64_t bytes = BytesCompactTensor(*x);
+    comm_bytes->Add(bytes);
+    CHECK_LE(bytes, std::numeric_limits<int>::max()) << "The MPI message is too large";
+    // The tensors are concatenated along the first axis as the NCCL allgather does, and the
+    // other axes are transposed by the frontend.
+    const auto* comm = GetComm();
+    MPI_CALL(MPI_Allgather(x->data, static_cast<int>(bytes), MPI_BYTE, out->data,
+                           static_cast<int>(bytes), MPI_BYTE, comm->mpi_comm));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIAllGather(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _allgather, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._allgather", MPIAllGather::make);
+
+class MPIBroadcast : public MPIOpEnv {
+  int root;
+
+  explicit MPIBroadcast(const CallValues& cv)
+      : MPIOpEnv(cv, cv->args.as<raf::op::schema::BroadcastArgs>()->rank_list) {
+    auto op = ir::Op::Get("raf.op._broadcast");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::BroadcastArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    root = args->root;
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.mpi._broadcast"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::BroadcastArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("broadcast");
+    DLTensor* x = inputs[0];
+    DLTensor* out = output;
+    int64_t bytes = BytesCompactTensor(*x);
+    comm_bytes->Add(bytes);
+    const auto* comm = GetComm();
+    if (comm->rank == root && out->data != x->data) {
+      std::memcpy(out->data, x->data, bytes);
+    }
+    // MPI_Bcast takes an int count, so the large tensors are sent in parts.
+    auto* data = static_cast<uint8_t*>(out->data);
+    constexpr int64_t kMaxPart = std::numeric_limits<int>::max();
+    for (int64_t offset = 0; offset < bytes; offset += kMaxPart) {
+      int n = static_cast<int>(std::min(kMaxPart, bytes - offset));
+      MPI_CALL(MPI_Bcast(data + offset, n, MPI_BYTE, root, comm->mpi_comm));
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new MPIBroadcast(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(mpi, _broadcast, 10);
+RAF_OP_ENV_MAKER("raf.op.mpi._broadcast", MPIBroadcast::make);
+
+}  // namespace mpi
+}  // namespace communication
+}  // namespace op
+}  // namespace raf
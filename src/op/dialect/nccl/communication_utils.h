@@ -33,6 +33,7 @@ inline DType::operator ncclDataType_t() const {
   switch (code) {
     case kDLInt:
       if (bits == 8) return ncclInt8;
+      if (bits == 32) return ncclInt32;
       if (bits == 64) return ncclInt64;
       break;
     case kDLUInt:
@@ -42,6 +43,12 @@ inline DType::operator ncclDataType_t() const {
       if (bits == 16) return ncclFloat16;
       if (bits == 32) return ncclFloat32;
       if (bits == 64) return ncclFloat64;
+      break;
+#if NCCL_VERSION_CODE >= 21000
+    case kDLBfloat:
+      if (bits == 16) return ncclBfloat16;
+      break;
+#endif
   }
   LOG(FATAL) << "NotImplementedError: " << c_str();
   throw;
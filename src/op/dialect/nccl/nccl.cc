@@ -7,13 +7,18 @@
  * \file src/op/dialect/cuda/nccl.cc
  * \brief Communication operators implmentated by NCCL
  */
+#include <numeric>
+#include <unordered_map>
 #include <vector>
 #include <chrono>
 #include <thread>
 #include "raf/op_utils.h"
 #include "raf/dist_config.h"
 #include "raf/nccl_communicator.h"
+#include "raf/memory_pool.h"
+#include "raf/metrics.h"
 #include "../../../src/common/cuda_utils.h"
+#include "../cuda/kernels/kernel_util.cuh"
 #include "../../schema/communication.h"
 #include "./communication_utils.h"
 
@@ -37,12 +42,53 @@ class NCCLOpEnv : public raf::op::OpEnv {
   }
 };
 
+/*! \brief The bytes of a tensor, or of the tensors of a tuple. */
+static size_t BytesOfValue(const value::Value& value) {
+  if (const auto* tv = value.as<value::TupleValueObj>()) {
+    size_t bytes = 0;
+    for (const auto& field : tv->fields) {
+      bytes += BytesOfValue(field);
+    }
+    return bytes;
+  }
+  const DLTensor* x = value;
+  return BytesCompactTensor(*x);
+}
+
+/*! \brief The counter of the bytes of the data that the collectives of the type send or receive. */
+static metrics::Counter* CommBytesCounter(const std::string& collective) {
+  return metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_comm_bytes_total", "The bytes of the data of the collectives on this rank.",
+      {{"collective", collective}});
+}
+
+/*! \brief The compression of the allreduce, which is selected for each bucket by DistConfig. */
+enum class AllReduceCompression { kNone, kFP16, kBF16, kTopK };
+
 class NCCLAllReduce : public NCCLOpEnv {
   void* fused_data;
   size_t total_size = 0;
   std::vector<size_t> tuple_sizes;
   DType dtype;
   ncclRedOp_t compute;
+  /*! \brief The communicators within and across the nodes of the hierarchical allreduce. */
+  void* intra_communicator = nullptr;
+  void* inter_communicator = nullptr;
+  /*! \brief The number of ranks in each node, or 0 if the allreduce is flat. */
+  size_t num_local_ranks = 0;
+  /*! \brief The compression of this bucket. */
+  AllReduceCompression compression = AllReduceCompression::kNone;
+  /*! \brief The half or bfloat16 buffer of the bucket. */
+  void* compressed_data = nullptr;
+  /*! \brief The number of elements sent by each rank in the top-k compression. */
+  int64_t topk = 0;
+  /*! \brief The workspace of the top-k selection, and the (indices, values) of all ranks. */
+  void* topk_keys = nullptr;
+  void* topk_sorted_indices = nullptr;
+  void* topk_indices = nullptr;
+  void* topk_values = nullptr;
+  /*! \brief The accumulated error of the top-k compression, which persists across iterations. */
+  std::shared_ptr<memory_pool::Memory> residual;
 
   explicit NCCLAllReduce(const CallValues& cv) : NCCLOpEnv(cv) {
     auto op = ir::Op::Get("raf.op._allreduce");
@@ -51,6 +97,13 @@ class NCCLAllReduce : public NCCLOpEnv {
     this->arg_indices = {fschema_index[op]("x")};
     RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
     RequestDistributed(&communicator, "nccl", args->rank_list);
+    if (DistConfig::Global()->enable_hierarchical_allreduce && !args->rank_list.defined()) {
+      RequestHierarchicalCommunicators();
+    }
+    if (DistConfig::Global()->enable_topology_aware_ring && !args->rank_list.defined() &&
+        num_local_ranks == 0) {
+      RequestRingCommunicator();
+    }
 
     auto& tv = args->x;
 
@@ -82,6 +135,7 @@ class NCCLAllReduce : public NCCLOpEnv {
     if (tv.size() > 1) {
       RequestWorkspace(&fused_data, cv->device, total_size);
     }
+    SelectCompression(cv->device, args->computation, args->rank_list.defined());
   }
 
  public:
@@ -99,6 +153,8 @@ class NCCLAllReduce : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("allreduce");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     // We can use sleep to test communication scheduling locally.
     // using namespace std::this_thread;
     // using namespace std::chrono;
@@ -108,42 +164,296 @@ class NCCLAllReduce : public NCCLOpEnv {
 
     // Fuse Tensor
     auto tv = Downcast<value::TupleValue>(inputs[0]);
+    if (compression == AllReduceCompression::kFP16 || compression == AllReduceCompression::kBF16) {
+      CastAllReduce(tv->fields,
+                    tv->fields.size() == 1 ? ir::Array<Value>({output})
+                                           : Downcast<value::TupleValue>(output)->fields,
+                    nccl_comm);
+      return;
+    }
     size_t dtype_size = 0;
     if (tv->fields.size() == 1) {
       DLTensor* x = tv->fields[0];
       DLTensor* out = output;
       dtype_size = GetSizeInBytes(x->dtype);
-      NCCL_CALL(ncclAllReduce(x->data, out->data, total_size / dtype_size, dtype, compute,
-                              nccl_comm, (cudaStream_t)stream));
+      Reduce(x->data, out->data, total_size / dtype_size, dtype_size, comm_ref, nccl_comm);
 
     } else {
-      size_t offset = 0;
+      value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
+      auto& of = out->fields;
       for (int i = 0; i < tv->fields.size(); ++i) {
         DLTensor* x = tv->fields[i];
-        void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-        cudaMemcpyAsync(buffer_data_at_offset, x->data, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                        (cudaStream_t)stream);
-        offset += tuple_sizes[i];
         CHECK(dtype_size == 0 || dtype_size == GetSizeInBytes(x->dtype))
             << "AllReduce requires tensors to be the same type.";
         dtype_size = GetSizeInBytes(x->dtype);
         dtype = x->dtype;
       }
 
+      // The tensors of a bucket packed by the memory plan are contiguous, so they are reduced
+      // in place of the fused buffer without copying.
+      void* in_data = ContiguousData(tv->fields);
+      void* out_data = ContiguousData(of);
+      if (in_data == nullptr) {
+        // Fuse Tensor
+        size_t offset = 0;
+        for (int i = 0; i < tv->fields.size(); ++i) {
+          DLTensor* x = tv->fields[i];
+          void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
+          cudaMemcpyAsync(buffer_data_at_offset, x->data, tuple_sizes[i],
+                          cudaMemcpyDeviceToDevice, (cudaStream_t)stream);
+          offset += tuple_sizes[i];
+        }
+        in_data = fused_data;
+      }
+
       // Allreduce
-      NCCL_CALL(ncclAllReduce(fused_data, fused_data, total_size / dtype_size, dtype, compute,
-                              nccl_comm, (cudaStream_t)stream));
-      // UnFuse Tensor
-      value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
-      auto& of = out->fields;
-      for (int i = of.size() - 1; i >= 0; --i) {
-        DLTensor* x = of[i];
-        offset -= tuple_sizes[i];
-        void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
-        cudaMemcpyAsync(x->data, buffer_data_at_offset, tuple_sizes[i], cudaMemcpyDeviceToDevice,
-                        (cudaStream_t)stream);
+      Reduce(in_data, out_data ? out_data : fused_data, total_size / dtype_size, dtype_size,
+             comm_ref, nccl_comm);
+      if (out_data == nullptr) {
+        // UnFuse Tensor
+        size_t offset = total_size;
+        for (int i = of.size() - 1; i >= 0; --i) {
+          DLTensor* x = of[i];
+          offset -= tuple_sizes[i];
+          void* buffer_data_at_offset = reinterpret_cast<uint8_t*>(fused_data) + offset;
+          cudaMemcpyAsync(x->data, buffer_data_at_offset, tuple_sizes[i], cudaMemcpyDeviceToDevice,
+                          (cudaStream_t)stream);
+        }
+      }
+    }
+  }
+
+  /*!
+   * \brief Request the communicators of the hierarchical allreduce, where the ranks are grouped
+   * by their hosts. The allreduce stays flat unless there are multiple hosts, each of which has
+   * the same number (more than one) of ranks.
+   */
+  void RequestHierarchicalCommunicators() {
+    auto global_comm = GetGlobalCommunicator();
+    std::vector<uint64_t> hosts;
+    std::unordered_map<uint64_t, std::vector<int64_t>> ranks_of_host;
+    for (int64_t rank = 0; rank < global_comm->size; ++rank) {
+      uint64_t host = global_comm->host_ids.at(rank);
+      if (ranks_of_host.count(host) == 0) {
+        hosts.push_back(host);
+      }
+      ranks_of_host[host].push_back(rank);
+    }
+    size_t num_local = ranks_of_host[hosts[0]].size();
+    if (hosts.size() < 2 || num_local < 2) {
+      return;
+    }
+    for (auto host : hosts) {
+      if (ranks_of_host[host].size() != num_local) {
+        LOG(WARNING) << "Hierarchical allreduce requires the same number of ranks on each host. "
+                     << "Fall back to the flat allreduce.";
+        return;
+      }
+    }
+    if (DistConfig::Global()->enable_topology_aware_ring) {
+      // The ranks with the same index in the ordered host rings reduce the same chunk.
+      auto nccl_comm = Communicator::Get("nccl");
+      for (auto host : hosts) {
+        ranks_of_host[host] = Communicator::OrderRanksByTopology(nccl_comm.operator->(),
+                                                                 ranks_of_host[host]);
+      }
+    }
+    // The ranks of each host, and the ranks with the same local index on each host.
+    ir::Array<Value> intra_groups, inter_groups;
+    for (auto host : hosts) {
+      ir::Array<Value> group;
+      for (auto rank : ranks_of_host[host]) {
+        group.push_back(ScalarValue::make(rank));
+      }
+      intra_groups.push_back(TupleValue::make(group));
+    }
+    for (size_t i = 0; i < num_local; ++i) {
+      ir::Array<Value> group;
+      for (auto host : hosts) {
+        group.push_back(ScalarValue::make(ranks_of_host[host][i]));
+      }
+      inter_groups.push_back(TupleValue::make(group));
+    }
+    RequestDistributed(&intra_communicator, "nccl", TupleValue::make(intra_groups));
+    RequestDistributed(&inter_communicator, "nccl", TupleValue::make(inter_groups));
+    num_local_ranks = num_local;
+  }
+
+  /*!
+   * \brief Request the global communicator with the ranks ordered by their topology, so that the
+   * ring of the allreduce goes through the fastest links. The sum does not depend on the order.
+   */
+  void RequestRingCommunicator() {
+    auto nccl_comm = Communicator::Get("nccl");
+    std::vector<int64_t> ranks(nccl_comm->size);
+    std::iota(ranks.begin(), ranks.end(), 0);
+    auto ordered = Communicator::OrderRanksByTopology(nccl_comm.operator->(), ranks);
+    if (ordered == ranks) {
+      return;
+    }
+    ir::Array<Value> group;
+    for (auto rank : ordered) {
+      group.push_back(ScalarValue::make(rank));
+    }
+    RequestDistributed(&communicator, "nccl", TupleValue::make({TupleValue::make(group)}));
+  }
+
+  /*!
+   * \brief Allreduce count elements from in_data to out_data. The hierarchical allreduce
+   * reduce-scatters within the node, allreduces 1/L of the data across the nodes, and then
+   * allgathers within the node, where L is the number of ranks in each node. The remaining
+   * elements that cannot be evenly divided by L are allreduced by the flat allreduce.
+   */
+  void AllReduce(void* in_data, void* out_data, size_t count, size_t dtype_size, DType comm_dtype,
+                 ncclComm_t nccl_comm) {
+    size_t chunk = num_local_ranks > 0 ? count / num_local_ranks : 0;
+    auto in_bytes = reinterpret_cast<uint8_t*>(in_data);
+    auto out_bytes = reinterpret_cast<uint8_t*>(out_data);
+    if (chunk > 0) {
+      auto intra_ref =
+          GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(intra_communicator));
+      auto inter_ref =
+          GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(inter_communicator));
+      ncclComm_t intra_comm = Downcast<NCCLCommunicator>(intra_ref)->nccl_comm;
+      ncclComm_t inter_comm = Downcast<NCCLCommunicator>(inter_ref)->nccl_comm;
+      // The chunk reduced by this rank, which is in place for the reduce-scatter and allgather.
+      uint8_t* out_chunk = out_bytes + intra_ref->rank * chunk * dtype_size;
+      NCCL_CALL(ncclReduceScatter(in_bytes, out_chunk, chunk, comm_dtype, compute, intra_comm,
+                                  (cudaStream_t)stream));
+      NCCL_CALL(ncclAllReduce(out_chunk, out_chunk, chunk, comm_dtype, compute, inter_comm,
+                              (cudaStream_t)stream));
+      NCCL_CALL(ncclAllGather(out_chunk, out_bytes, chunk, comm_dtype, intra_comm,
+                              (cudaStream_t)stream));
+    }
+    size_t offset = chunk * num_local_ranks;
+    if (offset < count) {
+      NCCL_CALL(ncclAllReduce(in_bytes + offset * dtype_size, out_bytes + offset * dtype_size,
+                              count - offset, comm_dtype, compute, nccl_comm,
+                              (cudaStream_t)stream));
+    }
+  }
+
+  /*!
+   * \brief Select the compression of this bucket by DistConfig. Only the float32 buckets with at
+   * least allreduce_compression_min_elements elements are compressed, and the reduction must be
+   * sum or avg. The top-k compression only works on the global communicator.
+   */
+  void SelectCompression(const Device& device, const std::string& computation,
+                         bool has_rank_list) {
+    auto dcfg = DistConfig::Global();
+    const std::string& method = dcfg->allreduce_compression;
+    CHECK(method == "none" || method == "fp16" || method == "bf16" || method == "topk")
+        << "Invalid allreduce compression " << method
+        << ", candidates are none, fp16, bf16 and topk";
+    int64_t count = total_size / sizeof(float);
+    if (method == "none" || dtype.code != DTypeCode::kFloat() || dtype.bits != 32 ||
+        (computation != "sum" && computation != "avg") ||
+        count < dcfg->allreduce_compression_min_elements) {
+      return;
+    }
+    if (method == "fp16" || method == "bf16") {
+#if NCCL_VERSION_CODE < 21000
+      CHECK(method == "fp16") << "AllReduce with bfloat16 is not supported in NCCL < 2.10";
+#endif
+      compression = method == "fp16" ? AllReduceCompression::kFP16 : AllReduceCompression::kBF16;
+      RequestWorkspace(&compressed_data, device, count * 2);
+    } else if (!has_rank_list) {
+      int64_t size = GetGlobalCommunicator()->size;
+      compression = AllReduceCompression::kTopK;
+      topk = std::min(count, std::max<int64_t>(1, count * dcfg->allreduce_topk_ratio));
+      RequestWorkspace(&topk_keys, device, count * sizeof(float));
+      RequestWorkspace(&topk_sorted_indices, device, count * sizeof(int));
+      RequestWorkspace(&topk_indices, device, size * topk * sizeof(int));
+      RequestWorkspace(&topk_values, device, size * topk * sizeof(float));
+      residual = memory_pool::Memory::Alloc(device, count * sizeof(float));
+      CUDA_CALL(cudaMemset(residual->data, 0, count * sizeof(float)));
+    }
+  }
+
+  /*! \brief Allreduce the dense bucket, which is sparsified if the top-k compression is used. */
+  void Reduce(void* in_data, void* out_data, size_t count, size_t dtype_size,
+              const Communicator& comm, ncclComm_t nccl_comm) {
+    if (compression == AllReduceCompression::kTopK) {
+      TopKAllReduce(in_data, out_data, count, comm, nccl_comm);
+    } else {
+      AllReduce(in_data, out_data, count, dtype_size, dtype, nccl_comm);
+    }
+  }
+
+  /*!
+   * \brief Allreduce the float tensors in half or bfloat16. The tensors are cast when packing
+   * into and unpacking from the compressed bucket, so the bytes sent are halved.
+   */
+  void CastAllReduce(const ir::Array<Value>& inputs, const ir::Array<Value>& outputs,
+                     ncclComm_t nccl_comm) {
+    bool bf16 = compression == AllReduceCompression::kBF16;
+    DType comm_dtype(bf16 ? DTypeCode::kBFloat() : DTypeCode::kFloat(), 16);
+    auto buffer = reinterpret_cast<uint8_t*>(compressed_data);
+    size_t offset = 0;
+    for (int i = 0; i < inputs.size(); ++i) {
+      DLTensor* x = inputs[i];
+      int64_t numel = tuple_sizes[i] / sizeof(float);
+      raf::op::cuda::compress_float_cuda(static_cast<const float*>(x->data), buffer + offset * 2,
+                                         numel, bf16, stream);
+      offset += numel;
+    }
+    AllReduce(compressed_data, compressed_data, offset, 2, comm_dtype, nccl_comm);
+    offset = 0;
+    for (int i = 0; i < outputs.size(); ++i) {
+      DLTensor* out = outputs[i];
+      int64_t numel = tuple_sizes[i] / sizeof(float);
+      raf::op::cuda::decompress_float_cuda(buffer + offset * 2, static_cast<float*>(out->data),
+                                           numel, bf16, stream);
+      offset += numel;
+    }
+  }
+
+  /*!
+   * \brief Allreduce the top-k elements of the largest magnitudes with error feedback. Each rank
+   * accumulates its gradient into the residual of the previous iterations, and sends the top-k
+   * elements of the residual, which are taken out of the residual. The (indices, values) of all
+   * ranks are then allgathered and scattered into the dense output.
+   */
+  void TopKAllReduce(void* in_data, void* out_data, size_t count, const Communicator& comm,
+                     ncclComm_t nccl_comm) {
+    auto indices = static_cast<int*>(topk_indices);
+    auto values = static_cast<float*>(topk_values);
+    // The selection of this rank is written to its slot, so the allgather is in place.
+    raf::op::cuda::topk_compress_cuda(
+        static_cast<const float*>(in_data), static_cast<float*>(residual->data), count, topk,
+        static_cast<float*>(topk_keys), static_cast<int*>(topk_sorted_indices),
+        indices + comm->rank * topk, values + comm->rank * topk, stream);
+    NCCL_CALL(ncclAllGather(indices + comm->rank * topk, indices, topk, ncclInt32, nccl_comm,
+                            (cudaStream_t)stream));
+    NCCL_CALL(ncclAllGather(values + comm->rank * topk, values, topk, ncclFloat32, nccl_comm,
+                            (cudaStream_t)stream));
+    bool is_avg = false;
+#if NCCL_VERSION_CODE >= 21000
+    is_avg = compute == ncclAvg;
+#endif
+    float scale = is_avg ? 1.0f / comm->size : 1.0f;
+    raf::op::cuda::scatter_add_cuda(indices, values, topk * comm->size, scale,
+                                    static_cast<float*>(out_data), count, stream);
+  }
+
+  /*!
+   * \brief Get the beginning of the given tensors if they are laid out one after another in
+   * the tuple order without paddings, or nullptr otherwise.
+   */
+  void* ContiguousData(const ir::Array<value::Value>& fields) {
+    uint8_t* begin = nullptr;
+    size_t offset = 0;
+    for (int i = 0; i < fields.size(); ++i) {
+      DLTensor* x = fields[i];
+      auto data = reinterpret_cast<uint8_t*>(x->data) + x->byte_offset;
+      if (i == 0) {
+        begin = data;
+      } else if (data != begin + offset) {
+        return nullptr;
       }
+      offset += tuple_sizes[i];
     }
+    return begin;
   }
 
   static OpEnv* make(const CallValues& cv) {
@@ -178,6 +488,8 @@ class NCCLAllGather : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("allgather");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     DLTensor* x = inputs[0];
@@ -223,6 +535,8 @@ class NCCLGroupAllGather : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("group_allgather");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
     ncclComm_t nccl_comm = comm_ptr->nccl_comm;
     value::TupleValue out = tvm::runtime::Downcast<value::TupleValue>(output);
@@ -298,6 +612,8 @@ class NCCLReduceScatter : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("reduce_scatter");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     DLTensor* out = output;
@@ -317,6 +633,92 @@ class NCCLReduceScatter : public NCCLOpEnv {
 RAF_REGISTER_DIALECT_OP(nccl, _reduce_scatter, 10);
 RAF_OP_ENV_MAKER("raf.op.nccl._reduce_scatter", NCCLReduceScatter::make);
 
+/*!
+ * \brief Take the chunk of this rank along the first axis of a replicated tensor, which enters
+ * a sequence-parallel region without communication.
+ */
+class NCCLSequenceScatter : public NCCLOpEnv {
+  explicit NCCLSequenceScatter(const CallValues& cv) : NCCLOpEnv(cv) {
+    auto op = ir::Op::Get("raf.op._sequence_scatter");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::SequenceParallelArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
+    RequestDistributed(&communicator, "nccl", args->rank_list);
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._sequence_scatter"));
+  }
+
+  void Execute(const CallValues& cv) {
+    auto args = cv->args.as<raf::op::schema::SequenceParallelArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
+    DLTensor* x = inputs[0];
+    DLTensor* out = output;
+    size_t chunk = BytesCompactTensor(*out);
+    CUDA_CALL(cudaMemcpyAsync(out->data, static_cast<char*>(x->data) + comm_ref->rank * chunk,
+                              chunk, cudaMemcpyDeviceToDevice, (cudaStream_t)stream));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLSequenceScatter(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _sequence_scatter, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._sequence_scatter", NCCLSequenceScatter::make);
+
+/*!
+ * \brief Gather the chunks of a sequence-parallel region along the first axis for a replicated
+ * consumer. It is an allgather, but its gradient takes the local chunk instead of summing the
+ * chunks of the ranks.
+ */
+class NCCLSequenceGather : public NCCLOpEnv {
+  explicit NCCLSequenceGather(const CallValues& cv) : NCCLOpEnv(cv) {
+    auto op = ir::Op::Get("raf.op._sequence_gather");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    auto args = cv->args.as<raf::op::schema::SequenceParallelArgs>();
+    this->arg_indices = {fschema_index[op]("x")};
+    RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
+    RequestDistributed(&communicator, "nccl", args->rank_list);
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._sequence_gather"));
+  }
+
+  void Execute(const CallValues& cv) {
+    auto args = cv->args.as<raf::op::schema::SequenceParallelArgs>();
+    Execute({args->x}, cv->out);
+  }
+
+  void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("allgather");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
+    auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
+    ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
+    DLTensor* x = inputs[0];
+    DLTensor* out = output;
+    size_t size = BytesCompactTensor(*x) / (x->dtype.bits / 8);
+    NCCL_CALL(
+        ncclAllGather(x->data, out->data, size, DType(x->dtype), nccl_comm, (cudaStream_t)stream));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLSequenceGather(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _sequence_gather, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._sequence_gather", NCCLSequenceGather::make);
+
 class NCCLGroupReduceScatter : public NCCLOpEnv {
   std::vector<size_t> sizes;
   ncclRedOp_t compute;
@@ -373,6 +775,8 @@ class NCCLGroupReduceScatter : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("group_reduce_scatter");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ptr = reinterpret_cast<NCCLCommunicatorObj*>(communicator);
     ncclComm_t nccl_comm = comm_ptr->nccl_comm;
     auto tv = Downcast<value::TupleValue>(inputs[0]);
@@ -426,6 +830,8 @@ class NCCLBroadcast : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("broadcast");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     const DLTensor* x = inputs[0];
@@ -478,6 +884,8 @@ class NCCLAllToAll : public raf::op::OpEnv {
   }
 
   void Execute(const std::vector<Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("all_to_all");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     const DLTensor* x = inputs[0];
@@ -520,6 +928,110 @@ class NCCLAllToAll : public raf::op::OpEnv {
 RAF_REGISTER_DIALECT_OP(nccl, _all_to_all, 10);
 RAF_OP_ENV_MAKER("raf.op.nccl._all_to_all", NCCLAllToAll::make);
 
+class NCCLAllToAllv : public NCCLOpEnv {
+  /*! \brief The counts sent to and received from each rank, copied to the host. */
+  std::vector<int64_t> host_send_counts;
+  std::vector<int64_t> host_recv_counts;
+
+  explicit NCCLAllToAllv(const CallValues& cv) : NCCLOpEnv(cv) {
+    auto op = ir::Op::Get("raf.op._all_to_allv");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("x"), fschema_index[op]("send_counts")};
+    RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
+    auto args = cv->args.as<raf::op::schema::AllToAllvArgs>();
+    RequestDistributed(&communicator, "nccl", args->rank_list);
+#if NCCL_VERSION_CODE < 20700
+    LOG(FATAL) << "AllToAllv is not supported in NCCL < 2.7.0";
+#endif
+  }
+
+ public:
+  ~NCCLAllToAllv() {
+    // Nothing
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._all_to_allv"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::AllToAllvArgs>();
+    Execute({args->x, args->send_counts}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("all_to_allv");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
+    auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
+    ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
+    auto cuda_stream = static_cast<cudaStream_t>(stream);
+    const DLTensor* x = inputs[0];
+    const DLTensor* send_counts = inputs[1];
+    auto out = Downcast<TupleValue>(output);
+    DLTensor* y = out->fields[0];
+    DLTensor* recv_counts = out->fields[1];
+    int num_ranks = comm_ref->size;
+    CHECK_EQ(send_counts->shape[0], num_ranks);
+    cudaStreamCaptureStatus capture_status;
+    CUDA_CALL(cudaStreamIsCapturing(cuda_stream, &capture_status));
+    CHECK_EQ(capture_status, cudaStreamCaptureStatusNone)
+        << "all_to_allv copies the counts to the host, which cannot be captured into a CUDA graph";
+
+    // Exchange the counts first, so that each rank knows how many rows it receives.
+    auto* send_counts_data = static_cast<int64_t*>(send_counts->data);
+    auto* recv_counts_data = static_cast<int64_t*>(recv_counts->data);
+    NCCL_CALL(ncclGroupStart());
+    for (int i = 0; i < num_ranks; ++i) {
+      NCCL_CALL(ncclSend(send_counts_data + i, 1, ncclInt64, i, nccl_comm, cuda_stream));
+      NCCL_CALL(ncclRecv(recv_counts_data + i, 1, ncclInt64, i, nccl_comm, cuda_stream));
+    }
+    NCCL_CALL(ncclGroupEnd());
+    host_send_counts.resize(num_ranks);
+    host_recv_counts.resize(num_ranks);
+    CUDA_CALL(cudaMemcpyAsync(host_send_counts.data(), send_counts_data,
+                              num_ranks * sizeof(int64_t), cudaMemcpyDeviceToHost, cuda_stream));
+    CUDA_CALL(cudaMemcpyAsync(host_recv_counts.data(), recv_counts_data,
+                              num_ranks * sizeof(int64_t), cudaMemcpyDeviceToHost, cuda_stream));
+    CUDA_CALL(cudaStreamSynchronize(cuda_stream));
+
+    // Each rank owns a segment of capacity rows in both x and y, of which only the counted rows
+    // are transferred.
+    int64_t capacity = x->shape[0] / num_ranks;
+    int64_t row_size = 1;
+    for (int i = 1; i < x->ndim; ++i) {
+      row_size *= x->shape[i];
+    }
+    int64_t segment_bytes = capacity * row_size * GetSizeInBytes(x->dtype);
+    char* send_buffer = static_cast<char*>(x->data);
+    char* recv_buffer = static_cast<char*>(y->data);
+    NCCL_CALL(ncclGroupStart());
+    for (int i = 0; i < num_ranks; ++i) {
+      CHECK(host_send_counts[i] >= 0 && host_send_counts[i] <= capacity)
+          << "Cannot send " << host_send_counts[i] << " rows to rank " << i << " with capacity "
+          << capacity;
+      CHECK(host_recv_counts[i] >= 0 && host_recv_counts[i] <= capacity)
+          << "Cannot receive " << host_recv_counts[i] << " rows from rank " << i
+          << " with capacity " << capacity;
+      if (host_send_counts[i] > 0) {
+        NCCL_CALL(ncclSend(send_buffer + i * segment_bytes, host_send_counts[i] * row_size,
+                           DType(x->dtype), i, nccl_comm, cuda_stream));
+      }
+      if (host_recv_counts[i] > 0) {
+        NCCL_CALL(ncclRecv(recv_buffer + i * segment_bytes, host_recv_counts[i] * row_size,
+                           DType(x->dtype), i, nccl_comm, cuda_stream));
+      }
+    }
+    NCCL_CALL(ncclGroupEnd());
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLAllToAllv(cv);
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _all_to_allv, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._all_to_allv", NCCLAllToAllv::make);
+
 class NCCLSend : public NCCLOpEnv {
   int peer;
 
@@ -549,6 +1061,8 @@ class NCCLSend : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("send");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     const DLTensor* x = inputs[0];
@@ -594,6 +1108,8 @@ class NCCLRecv : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("recv");
+    comm_bytes->Add(BytesOfValue(output));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     DLTensor* out = output;
@@ -656,6 +1172,8 @@ class NCCLReduce : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) override {
+    static auto* comm_bytes = CommBytesCounter("reduce");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     const DLTensor* x = inputs[0];
@@ -706,6 +1224,8 @@ class NCCLGather : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("gather");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     const DLTensor* x = inputs[0];
@@ -775,6 +1295,8 @@ class NCCLScatter : public NCCLOpEnv {
   }
 
   void Execute(const std::vector<value::Value>& inputs, value::Value output) {
+    static auto* comm_bytes = CommBytesCounter("scatter");
+    comm_bytes->Add(BytesOfValue(inputs[0]));
     auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
     ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
     const DLTensor* x = inputs[0];
@@ -813,6 +1335,360 @@ class NCCLScatter : public NCCLOpEnv {
 
 RAF_REGISTER_DIALECT_OP(nccl, _scatter, 10);
 RAF_OP_ENV_MAKER("raf.op.nccl._scatter", NCCLScatter::make);
+
+/*!
+ * \brief The base of the cross entropy of the logits sharded along the vocab, where the shard of
+ * each rank is (n, v) and starts at rank * v. Only the stats of the rows are reduced across the
+ * shards, by the allreduces of n and 2n floats, so neither the logits nor the softmax of the full
+ * vocab is gathered.
+ */
+class NCCLVocabParallelCrossEntropyBase : public NCCLOpEnv {
+ protected:
+  int64_t n;
+  /*! \brief The local max, the sum, the label logit and the max of each row. */
+  void* stats = nullptr;
+
+  explicit NCCLVocabParallelCrossEntropyBase(const CallValues& cv, const DLTensor* y_true,
+                                             const DLTensor* y_pred, const Value& rank_list)
+      : NCCLOpEnv(cv) {
+    RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
+    RequestDistributed(&communicator, "nccl", rank_list);
+    DType dtype = y_pred->dtype;
+    CHECK(dtype == DType(DTypeCode::kFloat(), 32) || dtype == DType(DTypeCode::kFloat(), 16))
+        << "vocab_parallel_cross_entropy does not support " << dtype.c_str();
+    CHECK(y_pred->ndim == 2 && y_true->ndim == 1 &&
+          DType(y_true->dtype) == DType(DTypeCode::kInt(), 64))
+        << "vocab_parallel_cross_entropy expects the logits of (n, v) and int64 labels of (n,)";
+    n = y_pred->shape[0];
+    RequestWorkspace(&stats, cv->device, 4 * n * sizeof(float));
+  }
+
+  /*! \brief The vocab of this rank starts at this offset. */
+  int64_t VocabStart(const DLTensor* y_pred) {
+    auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
+    return comm_ref->rank * y_pred->shape[1];
+  }
+
+  /*! \brief Reduce the stats of the rows of the local shard to the stats of the full vocab. */
+  void ReduceStats(const DLTensor* y_true, const DLTensor* y_pred) {
+    static auto* comm_bytes = CommBytesCounter("vocab_parallel_cross_entropy");
+    comm_bytes->Add(3 * n * sizeof(float));
+    auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
+    ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
+    auto cuda_stream = static_cast<cudaStream_t>(stream);
+    auto labels = static_cast<const int64_t*>(y_true->data);
+    auto local_max = static_cast<float*>(stats);
+    float* sum = local_max + n;
+    float* target = local_max + 2 * n;
+    float* max = local_max + 3 * n;
+    int64_t v = y_pred->shape[1];
+    int64_t vocab_start = VocabStart(y_pred);
+    if (y_pred->dtype.bits == 32) {
+      raf::op::cuda::cross_entropy_stats_cuda(static_cast<const float*>(y_pred->data), labels, n,
+                                              v, vocab_start, local_max, sum, target, stream);
+    } else {
+      raf::op::cuda::cross_entropy_stats_cuda(static_cast<const __half*>(y_pred->data), labels, n,
+                                              v, vocab_start, local_max, sum, target, stream);
+    }
+    NCCL_CALL(ncclAllReduce(local_max, max, n, ncclFloat32, ncclMax, nccl_comm, cuda_stream));
+    raf::op::cuda::cross_entropy_rescale_cuda(local_max, max, n, sum, stream);
+    // The label logit is only in one shard, so the sums and the label logits are summed together.
+    NCCL_CALL(ncclAllReduce(sum, sum, 2 * n, ncclFloat32, ncclSum, nccl_comm, cuda_stream));
+  }
+};
+
+class NCCLVocabParallelCrossEntropy : public NCCLVocabParallelCrossEntropyBase {
+  explicit NCCLVocabParallelCrossEntropy(const CallValues& cv,
+                                         const raf::op::schema::VocabParallelCrossEntropyArgs* args)
+      : NCCLVocabParallelCrossEntropyBase(cv, args->y_true, args->y_pred, args->rank_list) {
+    auto op = ir::Op::Get("raf.op._vocab_parallel_cross_entropy");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("y_true"), fschema_index[op]("y_pred")};
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._vocab_parallel_cross_entropy"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::VocabParallelCrossEntropyArgs>();
+    Execute({args->y_true, args->y_pred}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, value::Value output) override {
+    const DLTensor* y_true = inputs[0];
+    const DLTensor* y_pred = inputs[1];
+    DLTensor* out = output;
+    ReduceStats(y_true, y_pred);
+    auto stats_data = static_cast<const float*>(stats);
+    const float* sum = stats_data + n;
+    const float* target = stats_data + 2 * n;
+    const float* max = stats_data + 3 * n;
+    if (y_pred->dtype.bits == 32) {
+      raf::op::cuda::cross_entropy_loss_cuda(max, sum, target, n, static_cast<float*>(out->data),
+                                             stream);
+    } else {
+      raf::op::cuda::cross_entropy_loss_cuda(max, sum, target, n, static_cast<__half*>(out->data),
+                                             stream);
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLVocabParallelCrossEntropy(
+        cv, cv->args.as<raf::op::schema::VocabParallelCrossEntropyArgs>());
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _vocab_parallel_cross_entropy, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._vocab_parallel_cross_entropy", NCCLVocabParallelCrossEntropy::make);
+
+/*! \brief The gradient of the local shard, where the stats are reduced again instead of stored. */
+class NCCLVocabParallelCrossEntropyDpred : public NCCLVocabParallelCrossEntropyBase {
+  explicit NCCLVocabParallelCrossEntropyDpred(
+      const CallValues& cv, const raf::op::schema::VocabParallelCrossEntropyDpredArgs* args)
+      : NCCLVocabParallelCrossEntropyBase(cv, args->y_true, args->y_pred, args->rank_list) {
+    auto op = ir::Op::Get("raf.op._vocab_parallel_cross_entropy_dpred");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("dy"), fschema_index[op]("y_true"),
+                         fschema_index[op]("y_pred")};
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._vocab_parallel_cross_entropy_dpred"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::VocabParallelCrossEntropyDpredArgs>();
+    Execute({args->dy, args->y_true, args->y_pred}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, value::Value output) override {
+    const DLTensor* dy = inputs[0];
+    const DLTensor* y_true = inputs[1];
+    const DLTensor* y_pred = inputs[2];
+    DLTensor* out = output;
+    ReduceStats(y_true, y_pred);
+    auto labels = static_cast<const int64_t*>(y_true->data);
+    auto stats_data = static_cast<const float*>(stats);
+    const float* sum = stats_data + n;
+    const float* max = stats_data + 3 * n;
+    int64_t v = y_pred->shape[1];
+    int64_t vocab_start = VocabStart(y_pred);
+    if (y_pred->dtype.bits == 32) {
+      raf::op::cuda::cross_entropy_dx_cuda(
+          static_cast<const float*>(dy->data), static_cast<const float*>(y_pred->data), labels,
+          max, sum, n, v, vocab_start, static_cast<float*>(out->data), stream);
+    } else {
+      raf::op::cuda::cross_entropy_dx_cuda(
+          static_cast<const __half*>(dy->data), static_cast<const __half*>(y_pred->data), labels,
+          max, sum, n, v, vocab_start, static_cast<__half*>(out->data), stream);
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLVocabParallelCrossEntropyDpred(
+        cv, cv->args.as<raf::op::schema::VocabParallelCrossEntropyDpredArgs>());
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _vocab_parallel_cross_entropy_dpred, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._vocab_parallel_cross_entropy_dpred",
+                 NCCLVocabParallelCrossEntropyDpred::make);
+
+/*!
+ * \brief The base of the batch norm whose per-channel stats are summed across the ranks, so the
+ * mean and the variance are of the global batch. Each pass reduces the local stats in one fused
+ * kernel and sums them by a single allreduce, where the kernels run on the communication stream
+ * to be ordered with the allreduce without any event.
+ */
+class NCCLSyncBatchNormBase : public NCCLOpEnv {
+ protected:
+  int64_t outer;
+  int64_t c;
+  int64_t inner;
+
+  explicit NCCLSyncBatchNormBase(const CallValues& cv, const DLTensor* x, const Value& rank_list)
+      : NCCLOpEnv(cv) {
+    RequestStream(&stream, cv->device, StreamTagEnum::CudaCommunicate());
+    RequestDistributed(&communicator, "nccl", rank_list);
+    DType dtype = x->dtype;
+    CHECK(dtype == DType(DTypeCode::kFloat(), 32) || dtype == DType(DTypeCode::kFloat(), 16))
+        << "sync_batch_norm does not support " << dtype.c_str();
+    CHECK_GE(x->ndim, 2) << "sync_batch_norm expects the input of (n, c, ...)";
+    outer = x->shape[0];
+    c = x->shape[1];
+    inner = 1;
+    for (int i = 2; i < x->ndim; ++i) {
+      inner *= x->shape[i];
+    }
+  }
+
+  /*! \brief The float32 data of an optional parameter, which is nullptr if it is not given. */
+  static float* ParamData(const Value& value) {
+    if (!value.defined()) {
+      return nullptr;
+    }
+    DLTensor* tensor = value;
+    CHECK(DType(tensor->dtype) == DType(DTypeCode::kFloat(), 32))
+        << "sync_batch_norm expects the float32 parameters and running stats";
+    return static_cast<float*>(tensor->data);
+  }
+
+  /*! \brief Sum the stats of numel floats across the ranks from src to dst. */
+  void AllReduceStats(const float* src, float* dst, int64_t numel) {
+    static auto* comm_bytes = CommBytesCounter("sync_batch_norm");
+    comm_bytes->Add(numel * sizeof(float));
+    auto comm_ref = GetRef<Communicator>(reinterpret_cast<CommunicatorObj*>(communicator));
+    ncclComm_t nccl_comm = Downcast<NCCLCommunicator>(comm_ref)->nccl_comm;
+    NCCL_CALL(ncclAllReduce(src, dst, numel, ncclFloat32, ncclSum, nccl_comm,
+                            static_cast<cudaStream_t>(stream)));
+  }
+};
+
+class NCCLSyncBatchNormTrain : public NCCLSyncBatchNormBase {
+  /*! \brief The sums of x and x * x and the count, followed by the mean and the inverse std. */
+  void* stats = nullptr;
+  double eps;
+  double momentum;
+
+  explicit NCCLSyncBatchNormTrain(const CallValues& cv,
+                                  const raf::op::schema::SyncBatchNormArgs* args)
+      : NCCLSyncBatchNormBase(cv, args->x, args->rank_list),
+        eps(args->eps),
+        momentum(args->momentum) {
+    auto op = ir::Op::Get("raf.op._sync_batch_norm_train");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("x"), fschema_index[op]("running_mean"),
+                         fschema_index[op]("running_var"), fschema_index[op]("w"),
+                         fschema_index[op]("b")};
+    RequestWorkspace(&stats, cv->device, (4 * c + 1) * sizeof(float));
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._sync_batch_norm_train"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::SyncBatchNormArgs>();
+    Execute({args->x, args->running_mean, args->running_var, args->w, args->b}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, value::Value output) override {
+    const DLTensor* x = inputs[0];
+    const auto* tuple = output.as<value::TupleValueObj>();
+    CHECK(tuple != nullptr);
+    DLTensor* y = tuple->fields[0];
+    // The running stats of the outputs share the memory of the inputs.
+    float* running_mean = ParamData(tuple->fields[1]);
+    float* running_var = ParamData(tuple->fields[2]);
+    const float* w = ParamData(inputs[3]);
+    const float* b = ParamData(inputs[4]);
+    auto sums = static_cast<float*>(stats);
+    float* mean_invstd = sums + 2 * c + 1;
+    if (x->dtype.bits == 32) {
+      raf::op::cuda::batch_norm_reduce_cuda<float>(static_cast<const float*>(x->data), nullptr,
+                                                  outer, c, inner, sums, stream);
+    } else {
+      raf::op::cuda::batch_norm_reduce_cuda<__half>(static_cast<const __half*>(x->data), nullptr,
+                                                   outer, c, inner, sums, stream);
+    }
+    AllReduceStats(sums, sums, 2 * c + 1);
+    raf::op::cuda::batch_norm_forward_finalize_cuda(sums, c, eps, momentum, running_mean,
+                                                    running_var, mean_invstd, stream);
+    if (x->dtype.bits == 32) {
+      raf::op::cuda::batch_norm_forward_apply_cuda(static_cast<const float*>(x->data),
+                                                   mean_invstd, w, b, outer, c, inner,
+                                                   static_cast<float*>(y->data), stream);
+    } else {
+      raf::op::cuda::batch_norm_forward_apply_cuda(static_cast<const __half*>(x->data),
+                                                   mean_invstd, w, b, outer, c, inner,
+                                                   static_cast<__half*>(y->data), stream);
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLSyncBatchNormTrain(cv, cv->args.as<raf::op::schema::SyncBatchNormArgs>());
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _sync_batch_norm_train, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._sync_batch_norm_train", NCCLSyncBatchNormTrain::make);
+
+/*!
+ * \brief The gradient of the sync batch norm. The stats of x are reduced again together with the
+ * sums of dy and dy * x in the same pass, so the backward needs a single allreduce as well. The
+ * gradients of w and b are of the local batch, which are reduced with the other gradients of
+ * the data parallelism.
+ */
+class NCCLSyncBatchNormTrainDxwb : public NCCLSyncBatchNormBase {
+  /*! \brief The local and the global stats of 4c + 1, followed by the coefficients of 4c. */
+  void* stats = nullptr;
+  double eps;
+
+  explicit NCCLSyncBatchNormTrainDxwb(const CallValues& cv,
+                                      const raf::op::schema::SyncBatchNormDxwbArgs* args)
+      : NCCLSyncBatchNormBase(cv, args->x, args->rank_list), eps(args->eps) {
+    auto op = ir::Op::Get("raf.op._sync_batch_norm_train_dxwb");
+    auto fschema_index = ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    this->arg_indices = {fschema_index[op]("dy"), fschema_index[op]("x"), fschema_index[op]("w")};
+    RequestWorkspace(&stats, cv->device, (12 * c + 2) * sizeof(float));
+  }
+
+ public:
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.nccl._sync_batch_norm_train_dxwb"));
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<raf::op::schema::SyncBatchNormDxwbArgs>();
+    Execute({args->dy, args->x, args->w}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, value::Value output) override {
+    const DLTensor* dy = inputs[0];
+    const DLTensor* x = inputs[1];
+    const float* w = ParamData(inputs[2]);
+    const auto* tuple = output.as<value::TupleValueObj>();
+    CHECK(tuple != nullptr);
+    DLTensor* dx = tuple->fields[0];
+    float* dw = ParamData(tuple->fields[1]);
+    float* db = ParamData(tuple->fields[2]);
+    auto local = static_cast<float*>(stats);
+    float* global = local + 4 * c + 1;
+    float* coefs = global + 4 * c + 1;
+    if (x->dtype.bits == 32) {
+      raf::op::cuda::batch_norm_reduce_cuda(static_cast<const float*>(x->data),
+                                            static_cast<const float*>(dy->data), outer, c, inner,
+                                            local, stream);
+    } else {
+      raf::op::cuda::batch_norm_reduce_cuda(static_cast<const __half*>(x->data),
+                                            static_cast<const __half*>(dy->data), outer, c, inner,
+                                            local, stream);
+    }
+    AllReduceStats(local, global, 4 * c + 1);
+    raf::op::cuda::batch_norm_backward_finalize_cuda(global, local, c, eps, coefs, dw, db, stream);
+    if (x->dtype.bits == 32) {
+      raf::op::cuda::batch_norm_backward_apply_cuda(
+          static_cast<const float*>(dy->data), static_cast<const float*>(x->data), coefs, w,
+          outer, c, inner, static_cast<float*>(dx->data), stream);
+    } else {
+      raf::op::cuda::batch_norm_backward_apply_cuda(
+          static_cast<const __half*>(dy->data), static_cast<const __half*>(x->data), coefs, w,
+          outer, c, inner, static_cast<__half*>(dx->data), stream);
+    }
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new NCCLSyncBatchNormTrainDxwb(cv,
+                                          cv->args.as<raf::op::schema::SyncBatchNormDxwbArgs>());
+  }
+};
+
+RAF_REGISTER_DIALECT_OP(nccl, _sync_batch_norm_train_dxwb, 10);
+RAF_OP_ENV_MAKER("raf.op.nccl._sync_batch_norm_train_dxwb", NCCLSyncBatchNormTrainDxwb::make);
 }  // namespace nccl
 }  // namespace communication
 }  // namespace op
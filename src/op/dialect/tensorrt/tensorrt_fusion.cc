@@ -0,0 +1,236 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/tensorrt/tensorrt_fusion.cc
+ * \brief Run the functions partitioned for TensorRT as TensorRT engines.
+ */
+#include <cuda_runtime.h>
+#include "raf/cache.h"
+#include "raf/device_api.h"
+#include "raf/ir_ext.h"
+#include "raf/op.h"
+#include "raf/pass.h"
+#include "raf/registry.h"
+#include "raf/value.h"
+#include "./tensorrt_utils.h"
+#include "../../../common/cuda_utils.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
+
+namespace raf {
+namespace op {
+namespace tensorrt {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tensorrt.fp16", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tensorrt.max_workspace_mb", tvm::Integer);
+
+/*! \brief The persist cache entry of a serialized TensorRT engine. */
+class TensorRTEngineCacheEntry {
+ public:
+  explicit TensorRTEngineCacheEntry(std::string plan) : plan_(std::move(plan)) {
+  }
+
+  const std::string& Plan() const {
+    return plan_;
+  }
+
+  static TensorRTEngineCacheEntry Load(const std::string& path) {
+    std::string plan;
+    tvm::runtime::LoadBinaryFromFile(path + "/engine.plan", &plan);
+    return TensorRTEngineCacheEntry(plan);
+  }
+
+  bool Save(const std::string& path) {
+    tvm::runtime::SaveBinaryToFile(path + "/engine.plan", plan_);
+    return true;
+  }
+
+ private:
+  /*! \brief The serialized engine. */
+  std::string plan_;
+};
+
+/*!
+ * \brief The serialized engines, keyed by the fused function with its constants, the builder
+ * options, the TensorRT version and the device. Building an engine takes seconds to minutes, so
+ * it is persisted across processes when the persistent cache is enabled.
+ */
+MetaPersistCache<TensorRTEngineCacheEntry> CacheEngine("tensorrt_engine");
+
+/*! \brief The options to build the engines. */
+struct BuildOptions {
+  /*! \brief Whether the engine may run the layers in fp16. */
+  bool fp16;
+  /*! \brief The max workspace of the builder to profile the tactics. */
+  int64_t max_workspace_mb;
+
+  static BuildOptions Current() {
+    auto pass_ctx = pass::PassContext::Current();
+    BuildOptions options;
+    options.fp16 = pass_ctx->GetConfig<tvm::Bool>("raf.tensorrt.fp16", tvm::Bool(false)).value();
+    options.max_workspace_mb =
+        pass_ctx->GetConfig("raf.tensorrt.max_workspace_mb", Integer(1024)).value().IntValue();
+    return options;
+  }
+};
+
+/*!
+ * \brief Build the engine of a fused function.
+ * \param func The fused function.
+ * \param options The build options.
+ * \return The serialized engine.
+ */
+std::string BuildEngine(const Function& func, const BuildOptions& options) {
+  TRTPtr<nvinfer1::IBuilder> builder(nvinfer1::createInferBuilder(*TensorRTLogger::Get()));
+  TRT_CALL(builder.get());
+  uint32_t flags =
+      1U << static_cast<uint32_t>(nvinfer1::NetworkDefinitionCreationFlag::kEXPLICIT_BATCH);
+  TRTPtr<nvinfer1::INetworkDefinition> network(builder->createNetworkV2(flags));
+  TRT_CALL(network.get());
+  std::vector<std::vector<float>> host_weights;
+  BuildNetwork(func, network.get(), &host_weights);
+
+  TRTPtr<nvinfer1::IBuilderConfig> config(builder->createBuilderConfig());
+  TRT_CALL(config.get());
+  size_t workspace = static_cast<size_t>(options.max_workspace_mb) << 20;
+#if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 4)
+  config->setMemoryPoolLimit(nvinfer1::MemoryPoolType::kWORKSPACE, workspace);
+#else
+  config->setMaxWorkspaceSize(workspace);
+#endif
+  if (options.fp16 && builder->platformHasFastFp16()) {
+    config->setFlag(nvinfer1::BuilderFlag::kFP16);
+  }
+  TRTPtr<nvinfer1::IHostMemory> plan(builder->buildSerializedNetwork(*network, *config));
+  CHECK(plan != nullptr) << "Failed to build the TensorRT engine of\n" << AsText(func);
+  return std::string(static_cast<const char*>(plan->data()), plan->size());
+}
+
+/*!
+ * \brief Run a fused function as a TensorRT engine. The engine runs on the compute stream, and
+ * its activations are allocated as the workspace of the OpEnv instead of by TensorRT, so they
+ * are managed by the memory pool of RAF.
+ */
+class TensorRTOpEnv : public raf::op::OpEnv {
+ public:
+  TensorRTOpEnv() = default;
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName("raf.op.tensorrt._fused_op"));
+  }
+
+  void Init(const CallValues& cv) {
+    Function func = Downcast<ClosureValue>(cv->callee)->func;
+    BuildOptions options = BuildOptions::Current();
+    int major, minor;
+    CUDA_CALL(cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor,
+                                     cv->device.device_id()));
+    CUDA_CALL(cudaDeviceGetAttribute(&minor, cudaDevAttrComputeCapabilityMinor,
+                                     cv->device.device_id()));
+    HashKey key;
+    key << getInferLibVersion() << major << minor << options.fp16 << options.max_workspace_mb
+        << AsText(func, true);
+    const TensorRTEngineCacheEntry* entry = CacheEngine.Get(key);
+    if (entry == nullptr) {
+      CacheEngine.Set(key, TensorRTEngineCacheEntry(BuildEngine(func, options)));
+      entry = CacheEngine.Get(key);
+    }
+    const std::string& plan = entry->Plan();
+    engine_.reset(GetRuntime()->deserializeCudaEngine(plan.data(), plan.size()));
+    CHECK(engine_ != nullptr) << "Failed to deserialize the TensorRT engine";
+    context_.reset(engine_->createExecutionContextWithoutDeviceMemory());
+    TRT_CALL(context_.get());
+    size_t workspace_size = engine_->getDeviceMemorySize();
+    if (workspace_size > 0) {
+      RequestWorkspace(&workspace_, cv->device, workspace_size);
+    }
+
+    // The inputs that are not used by the engine, e.g., the ones pruned by TensorRT, are skipped.
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      int index = engine_->getBindingIndex(("input_" + std::to_string(i)).c_str());
+      if (index >= 0) {
+        arg_indices.push_back(i);
+        input_bindings_.push_back(index);
+      }
+    }
+    size_t num_outputs = 1;
+    if (auto tuple = cv->out.as<TupleValueObj>()) {
+      num_outputs = tuple->fields.size();
+    }
+    for (size_t i = 0; i < num_outputs; ++i) {
+      int index = engine_->getBindingIndex(("output_" + std::to_string(i)).c_str());
+      CHECK_GE(index, 0) << "The TensorRT engine has no output " << i;
+      output_bindings_.push_back(index);
+    }
+    bindings_.resize(engine_->getNbBindings(), nullptr);
+    static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+    compute_stream_ = cuda_device_api->GetStream();
+  }
+
+  void Execute(const CallValues& cv) override {
+    Array<Value> args = GetListArgs(cv->args);
+    std::vector<Value> inputs;
+    for (int i : arg_indices) {
+      inputs.push_back(args[i]);
+    }
+    Execute(inputs, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    CHECK_EQ(inputs.size(), input_bindings_.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      DLTensor* tensor = Downcast<TensorValue>(inputs[i]);
+      bindings_[input_bindings_[i]] = tensor->data;
+    }
+    if (auto tuple = output.as<TupleValueObj>()) {
+      for (size_t i = 0; i < output_bindings_.size(); ++i) {
+        DLTensor* tensor = Downcast<TensorValue>(tuple->fields[i]);
+        bindings_[output_bindings_[i]] = tensor->data;
+      }
+    } else {
+      DLTensor* tensor = Downcast<TensorValue>(output);
+      bindings_[output_bindings_[0]] = tensor->data;
+    }
+    // The workspace is only allocated after Init.
+    context_->setDeviceMemory(workspace_);
+    CHECK(context_->enqueueV2(bindings_.data(), static_cast<cudaStream_t>(compute_stream_),
+                              nullptr))
+        << "Failed to run the TensorRT engine";
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    auto env = std::make_unique<TensorRTOpEnv>();
+    try {
+      env->Init(cv);
+    } catch (const dmlc::Error& e) {
+      env->error_msgs.push_back(std::string("[TensorRT] Failed to build: ") + e.what());
+    }
+    return env.release();
+  }
+
+ private:
+  /*! \brief The deserialized engine. */
+  TRTPtr<nvinfer1::ICudaEngine> engine_;
+  /*! \brief The execution context, whose activations are in the workspace. */
+  TRTPtr<nvinfer1::IExecutionContext> context_;
+  /*! \brief The binding indices of the inputs in arg_indices and the outputs. */
+  std::vector<int> input_bindings_, output_bindings_;
+  /*! \brief The buffers of the bindings. */
+  std::vector<void*> bindings_;
+  /*! \brief The workspace of the activations. */
+  void* workspace_ = nullptr;
+  /*! \brief The compute stream. */
+  void* compute_stream_ = nullptr;
+};
+
+RAF_OP_ENV_MAKER("raf.op.tensorrt._fused_op", TensorRTOpEnv::make);
+
+}  // namespace tensorrt
+}  // namespace op
+}  // namespace raf
@@ -0,0 +1,547 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/tensorrt/tensorrt_utils.cc
+ * \brief The TensorRT dialect, the rules to annotate the supported ops, and the conversion of
+ * the fused functions to TensorRT networks.
+ */
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include "raf/op_utils.h"
+#include "./tensorrt_utils.h"
+#include "../../../common/shape_utils.h"
+
+namespace raf {
+namespace op {
+namespace tensorrt {
+
+using namespace raf::ir;
+using namespace raf::value;
+
+RAF_REGISTER_DIALECT("tensorrt").set_enable(DevType::kCUDA());
+
+void TensorRTLogger::log(Severity severity, const char* msg) noexcept {
+  if (severity <= Severity::kERROR) {
+    LOG(ERROR) << "[TensorRT] " << msg;
+  } else if (severity == Severity::kWARNING) {
+    LOG(WARNING) << "[TensorRT] " << msg;
+  } else {
+    DLOG(INFO) << "[TensorRT] " << msg;
+  }
+}
+
+TensorRTLogger* TensorRTLogger::Get() {
+  static TensorRTLogger logger;
+  return &logger;
+}
+
+nvinfer1::IRuntime* GetRuntime() {
+  static TRTPtr<nvinfer1::IRuntime> runtime(nvinfer1::createInferRuntime(*TensorRTLogger::Get()));
+  TRT_CALL(runtime.get());
+  return runtime.get();
+}
+
+nvinfer1::DataType ToTRTDataType(const DType& dtype) {
+  if (dtype.code == DTypeCode::kFloat() && dtype.bits == 32) {
+    return nvinfer1::DataType::kFLOAT;
+  } else if (dtype.code == DTypeCode::kFloat() && dtype.bits == 16) {
+    return nvinfer1::DataType::kHALF;
+  } else if (dtype.code == DTypeCode::kInt() && dtype.bits == 32) {
+    return nvinfer1::DataType::kINT32;
+  } else if (dtype.code == DTypeCode::kInt() && dtype.bits == 8) {
+    return nvinfer1::DataType::kINT8;
+  } else if (dtype.code == DTypeCode::kUInt() && dtype.bits == 1) {
+    return nvinfer1::DataType::kBOOL;
+  }
+  LOG(FATAL) << "NotImplementedError: " << dtype.c_str() << " is not supported by TensorRT";
+  throw;
+}
+
+nvinfer1::Dims ToTRTDims(const std::vector<int64_t>& shape) {
+  CHECK_LE(shape.size(), nvinfer1::Dims::MAX_DIMS) << "TensorRT supports up to "
+                                                    << nvinfer1::Dims::MAX_DIMS << " dims";
+  nvinfer1::Dims dims;
+  dims.nbDims = shape.size();
+  for (size_t i = 0; i < shape.size(); ++i) {
+    dims.d[i] = shape[i];
+  }
+  return dims;
+}
+
+/*! \brief Get the static shape of a tensor type, or return false if it is not static. */
+static bool GetStaticShape(const Type& type, std::vector<int64_t>* shape) {
+  auto ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return false;
+  }
+  shape->clear();
+  for (const auto& dim : ttype->shape) {
+    auto imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return false;
+    }
+    shape->push_back(imm->value);
+  }
+  return true;
+}
+
+/*! \brief Get the value of a constant arg, or the null value if the arg is omitted. */
+static Value GetConstArg(const Array<Expr>& args, size_t i) {
+  if (i >= args.size()) {
+    return NullValue<Value>();
+  }
+  auto node = args[i].as<RelayConstantNode>();
+  CHECK(node != nullptr) << "The arg " << i << " must be a constant";
+  return Downcast<Value>(static_cast<const ConstantNode*>(node)->value);
+}
+
+/*! \brief Whether the arg is a constant, or omitted if it may be omitted. */
+static bool IsConstArg(const Array<Expr>& args, size_t i, bool optional = false) {
+  return i < args.size() ? args[i]->IsInstance<RelayConstantNode>() : optional;
+}
+
+/*! \brief Whether the arg is omitted or a null constant, e.g., the out and where of ufuncs. */
+static bool IsNullArg(const Array<Expr>& args, size_t i) {
+  return IsConstArg(args, i, true) && !GetConstArg(args, i).defined();
+}
+
+/*! \brief Get an int tuple arg with the given length, where a single int is repeated. */
+static std::vector<int64_t> GetIntsArg(const Array<Expr>& args, size_t i, size_t size,
+                                       int64_t default_value) {
+  Value value = GetConstArg(args, i);
+  std::vector<int64_t> ints =
+      value.defined() ? GetShapeVecFromValue(value) : std::vector<int64_t>{default_value};
+  if (ints.size() == 1) {
+    ints.resize(size, ints[0]);
+  }
+  return ints;
+}
+
+/*! \brief Get a scalar arg, or the default value if it is omitted. */
+template <typename T>
+static T GetScalarArg(const Array<Expr>& args, size_t i, T default_value) {
+  Value value = GetConstArg(args, i);
+  return value.defined() ? GetScalarValueData<T>(value) : default_value;
+}
+
+/*! \brief Get a string arg, or the default value if it is omitted. */
+static std::string GetStringArg(const Array<Expr>& args, size_t i,
+                                const std::string& default_value) {
+  Value value = GetConstArg(args, i);
+  if (auto str = value.as<StringValueObj>()) {
+    return str->value;
+  }
+  return default_value;
+}
+
+/*! \brief Whether the tensor args, i.e., the non-constant ones, are static fp16 or fp32 tensors. */
+static bool IsSupportedTensorArgs(const Array<Expr>& args) {
+  for (const auto& arg : args) {
+    if (arg->IsInstance<RelayConstantNode>()) {
+      continue;
+    }
+    std::vector<int64_t> shape;
+    if (!arg->checked_type_.defined() || !GetStaticShape(arg->checked_type(), &shape)) {
+      return false;
+    }
+    DataType dtype = arg->checked_type().as<TensorTypeNode>()->dtype;
+    if (!dtype.is_float() || (dtype.bits() != 16 && dtype.bits() != 32) || dtype.lanes() != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*! \brief Whether the constant arg is a tensor on the host that can be embedded as weights. */
+static bool IsHostTensorArg(const Array<Expr>& args, size_t i) {
+  if (!IsConstArg(args, i)) {
+    return false;
+  }
+  auto tensor = GetConstArg(args, i).as<TensorValueObj>();
+  return tensor != nullptr && tensor->tensor->device.device_type == kDLCPU;
+}
+
+namespace annotate {
+
+bool Elementwise(const Attrs& attrs, const Array<Expr>& args) {
+  return IsSupportedTensorArgs(args) && IsNullArg(args, 2) && IsNullArg(args, 3);
+}
+
+bool TensorArgs(const Attrs& attrs, const Array<Expr>& args) {
+  return IsSupportedTensorArgs(args);
+}
+
+bool Conv2D(const Attrs& attrs, const Array<Expr>& args) {
+  // The kernel is embedded as the weights of the convolution.
+  return IsSupportedTensorArgs(args) && IsHostTensorArg(args, 1) &&
+         GetStringArg(args, 6, "NCHW") == "NCHW" && GetStringArg(args, 7, "OIHW") == "OIHW" &&
+         GetStringArg(args, 8, "NCHW") == "NCHW";
+}
+
+bool Pool2D(const Attrs& attrs, const Array<Expr>& args) {
+  auto dilation = GetIntsArg(args, 4, 2, 1);
+  return IsSupportedTensorArgs(args) && dilation[0] == 1 && dilation[1] == 1 &&
+         GetStringArg(args, 7, "NCHW") == "NCHW";
+}
+
+bool BatchNormInfer(const Attrs& attrs, const Array<Expr>& args) {
+  // The statistics and the affine params are folded into a scale on the host.
+  for (size_t i = 1; i <= 4; ++i) {
+    if (!IsHostTensorArg(args, i)) {
+      return false;
+    }
+    DType dtype(GetConstArg(args, i).as<TensorValueObj>()->tensor->dtype);
+    if (dtype != DType(DTypeCode::kFloat(), 32)) {
+      return false;
+    }
+  }
+  return IsSupportedTensorArgs(args);
+}
+
+}  // namespace annotate
+
+#define RAF_TENSORRT_ANNOTATE(OP, FUNC) \
+  RAF_REGISTER_OP(OP).set_attr<FRAFAnnotateTarget>("target.tensorrt", annotate::FUNC)
+
+RAF_TENSORRT_ANNOTATE("raf.op.add", Elementwise);
+RAF_TENSORRT_ANNOTATE("raf.op.subtract", Elementwise);
+RAF_TENSORRT_ANNOTATE("raf.op.multiply", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.divide", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.maximum", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.minimum", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.relu", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.sigmoid", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.tanh", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.bias_add", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.softmax", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.matmul", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.matmul_nt", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.matmul_tn", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.matmul_tt", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.dense", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.reshape", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.batch_flatten", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.transpose", TensorArgs);
+RAF_TENSORRT_ANNOTATE("raf.op.conv2d", Conv2D);
+RAF_TENSORRT_ANNOTATE("raf.op.max_pool2d", Pool2D);
+RAF_TENSORRT_ANNOTATE("raf.op.avg_pool2d", Pool2D);
+RAF_TENSORRT_ANNOTATE("raf.op.batch_norm_infer", BatchNormInfer);
+
+/*! \brief Convert the calls of a fused function to the layers of a TensorRT network. */
+class NetworkBuilder {
+ public:
+  NetworkBuilder(const Function& func, nvinfer1::INetworkDefinition* network,
+                 std::vector<std::vector<float>>* host_weights)
+      : func_(func), network_(network), host_weights_(host_weights) {
+  }
+
+  void Build() {
+    for (size_t i = 0; i < func_->params.size(); ++i) {
+      const Var& param = func_->params[i];
+      std::vector<int64_t> shape;
+      CHECK(GetStaticShape(param->checked_type(), &shape))
+          << "The input " << param->name_hint() << " must be a tensor of a static shape";
+      DataType dtype = param->checked_type().as<TensorTypeNode>()->dtype;
+      std::string name = "input_" + std::to_string(i);
+      auto input =
+          network_->addInput(name.c_str(), ToTRTDataType(DType(dtype)), ToTRTDims(shape));
+      TRT_CALL(input);
+      tensors_[param] = input;
+    }
+    Expr ret = func_->body;
+    if (ret->IsInstance<LetNode>()) {
+      auto ell = ExplicitLetList::make(ret);
+      for (size_t i = 0; i < ell->vars.size(); ++i) {
+        bindings_[ell->vars[i]] = ell->exprs[i];
+      }
+      ret = ell->ret;
+    }
+    while (auto var = ret.as<VarNode>()) {
+      auto it = bindings_.find(GetRef<Var>(var));
+      if (it == bindings_.end()) {
+        break;
+      }
+      ret = it->second;
+    }
+    Array<Expr> outputs{ret};
+    if (auto tuple = ret.as<TupleNode>()) {
+      outputs = tuple->fields;
+    }
+    std::unordered_set<nvinfer1::ITensor*> marked;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      nvinfer1::ITensor* tensor = Convert(outputs[i]);
+      // An input or an output cannot be marked as another output, so it is copied.
+      if (tensor->isNetworkInput() || marked.count(tensor)) {
+        tensor = AddLayer(network_->addIdentity(*tensor));
+      }
+      std::string name = "output_" + std::to_string(i);
+      tensor->setName(name.c_str());
+      network_->markOutput(*tensor);
+      marked.insert(tensor);
+    }
+  }
+
+ private:
+  /*! \brief Get the output of a layer. */
+  nvinfer1::ITensor* AddLayer(nvinfer1::ILayer* layer) {
+    TRT_CALL(layer);
+    return layer->getOutput(0);
+  }
+
+  /*! \brief Convert an expression to a tensor of the network. */
+  nvinfer1::ITensor* Convert(const Expr& expr) {
+    auto it = tensors_.find(expr);
+    if (it != tensors_.end()) {
+      return it->second;
+    }
+    nvinfer1::ITensor* tensor = nullptr;
+    if (auto var = expr.as<VarNode>()) {
+      auto binding = bindings_.find(GetRef<Var>(var));
+      CHECK(binding != bindings_.end()) << "Unbound var " << var->name_hint();
+      tensor = Convert(binding->second);
+    } else if (auto node = expr.as<RelayConstantNode>()) {
+      tensor = AddConstant(Downcast<Value>(static_cast<const ConstantNode*>(node)->value));
+    } else if (auto call = expr.as<CallNode>()) {
+      tensor = ConvertCall(call);
+    } else {
+      LOG(FATAL) << "NotImplementedError: TensorRT does not support " << expr->GetTypeKey();
+    }
+    tensors_[expr] = tensor;
+    return tensor;
+  }
+
+  /*! \brief Embed a tensor on the host as a constant of the network. */
+  nvinfer1::ITensor* AddConstant(const Value& value) {
+    return AddLayer(network_->addConstant(ToTRTDims(GetShape(value)), ToWeights(value)));
+  }
+
+  /*! \brief Get the shape of a tensor value. */
+  std::vector<int64_t> GetShape(const Value& value) {
+    auto tensor = value.as<TensorValueObj>();
+    CHECK(tensor != nullptr) << "The constant must be a tensor";
+    const DLTensor* dl_tensor = tensor->tensor.operator->();
+    return std::vector<int64_t>(dl_tensor->shape, dl_tensor->shape + dl_tensor->ndim);
+  }
+
+  /*! \brief Refer to the data of a tensor on the host as the weights. */
+  nvinfer1::Weights ToWeights(const Value& value) {
+    auto tensor = value.as<TensorValueObj>();
+    CHECK(tensor != nullptr) << "The constant must be a tensor";
+    const DLTensor* dl_tensor = tensor->tensor.operator->();
+    CHECK_EQ(dl_tensor->device.device_type, kDLCPU) << "The constant must be on the host";
+    int64_t numel = common::shape_utils::GetNumel(*dl_tensor);
+    return nvinfer1::Weights{ToTRTDataType(DType(dl_tensor->dtype)), dl_tensor->data, numel};
+  }
+
+  /*! \brief Copy the weights computed on the host, which live until the build of the engine. */
+  nvinfer1::Weights ToWeights(std::vector<float> data) {
+    host_weights_->push_back(std::move(data));
+    const auto& weights = host_weights_->back();
+    return nvinfer1::Weights{nvinfer1::DataType::kFLOAT, weights.data(),
+                             static_cast<int64_t>(weights.size())};
+  }
+
+  /*! \brief Reshape a tensor to the shape. */
+  nvinfer1::ITensor* Reshape(nvinfer1::ITensor* tensor, const std::vector<int64_t>& shape) {
+    auto layer = network_->addShuffle(*tensor);
+    TRT_CALL(layer);
+    layer->setReshapeDimensions(ToTRTDims(shape));
+    return layer->getOutput(0);
+  }
+
+  /*! \brief Prepend the dims of size 1 to a tensor of a lower rank to broadcast. */
+  nvinfer1::ITensor* ExpandRank(nvinfer1::ITensor* tensor, int ndim) {
+    nvinfer1::Dims dims = tensor->getDimensions();
+    if (dims.nbDims >= ndim) {
+      return tensor;
+    }
+    std::vector<int64_t> shape(ndim - dims.nbDims, 1);
+    shape.insert(shape.end(), dims.d, dims.d + dims.nbDims);
+    return Reshape(tensor, shape);
+  }
+
+  nvinfer1::ITensor* ElementWise(const CallNode* call, nvinfer1::ElementWiseOperation op) {
+    nvinfer1::ITensor* a = Convert(call->args[0]);
+    nvinfer1::ITensor* b = Convert(call->args[1]);
+    int ndim = std::max(a->getDimensions().nbDims, b->getDimensions().nbDims);
+    return AddLayer(network_->addElementWise(*ExpandRank(a, ndim), *ExpandRank(b, ndim), op));
+  }
+
+  nvinfer1::ITensor* Activation(const CallNode* call, nvinfer1::ActivationType type) {
+    return AddLayer(network_->addActivation(*Convert(call->args[0]), type));
+  }
+
+  nvinfer1::ITensor* MatMul(const CallNode* call, bool transpose_a, bool transpose_b) {
+    using MatOp = nvinfer1::MatrixOperation;
+    MatOp op_a = transpose_a ? MatOp::kTRANSPOSE : MatOp::kNONE;
+    MatOp op_b = transpose_b ? MatOp::kTRANSPOSE : MatOp::kNONE;
+    return AddLayer(network_->addMatrixMultiply(*Convert(call->args[0]), op_a,
+                                                *Convert(call->args[1]), op_b));
+  }
+
+  nvinfer1::ITensor* Conv2D(const CallNode* call) {
+    Value w = GetConstArg(call->args, 1);
+    std::vector<int64_t> w_shape = GetShape(w);
+    CHECK_EQ(w_shape.size(), 4U);
+    auto stride = GetIntsArg(call->args, 2, 2, 1);
+    auto padding = GetIntsArg(call->args, 3, 2, 0);
+    auto dilation = GetIntsArg(call->args, 4, 2, 1);
+    int64_t groups = GetScalarArg<int64_t>(call->args, 5, 1);
+    nvinfer1::Weights bias{nvinfer1::DataType::kFLOAT, nullptr, 0};
+    auto layer = network_->addConvolutionNd(*Convert(call->args[0]), w_shape[0],
+                                            ToTRTDims({w_shape[2], w_shape[3]}), ToWeights(w),
+                                            bias);
+    TRT_CALL(layer);
+    layer->setStrideNd(ToTRTDims({stride[0], stride[1]}));
+    // The padding is either symmetric or in the order of top, left, bottom and right.
+    layer->setPrePadding(ToTRTDims({padding[0], padding[1]}));
+    if (padding.size() == 4) {
+      layer->setPostPadding(ToTRTDims({padding[2], padding[3]}));
+    } else {
+      layer->setPostPadding(ToTRTDims({padding[0], padding[1]}));
+    }
+    layer->setDilationNd(ToTRTDims({dilation[0], dilation[1]}));
+    layer->setNbGroups(groups);
+    return layer->getOutput(0);
+  }
+
+  nvinfer1::ITensor* Pool2D(const CallNode* call, nvinfer1::PoolingType type) {
+    auto kernel = GetIntsArg(call->args, 1, 2, 1);
+    auto stride = GetIntsArg(call->args, 2, 2, 1);
+    auto padding = GetIntsArg(call->args, 3, 2, 0);
+    bool ceil_mode = GetScalarArg<bool>(call->args, 5, false);
+    bool include_pad = GetScalarArg<bool>(call->args, 6, true);
+    auto layer =
+        network_->addPoolingNd(*Convert(call->args[0]), type, ToTRTDims({kernel[0], kernel[1]}));
+    TRT_CALL(layer);
+    layer->setStrideNd(ToTRTDims({stride[0], stride[1]}));
+    layer->setPaddingNd(ToTRTDims({padding[0], padding[1]}));
+    if (ceil_mode) {
+      layer->setPaddingMode(nvinfer1::PaddingMode::kEXPLICIT_ROUND_UP);
+    }
+    layer->setAverageCountExcludesPadding(!include_pad);
+    return layer->getOutput(0);
+  }
+
+  nvinfer1::ITensor* BatchNormInfer(const CallNode* call) {
+    auto read = [&](size_t i) {
+      Value value = GetConstArg(call->args, i);
+      const DLTensor* tensor = value.as<TensorValueObj>()->tensor.operator->();
+      const float* data = static_cast<const float*>(tensor->data);
+      return std::vector<float>(data, data + common::shape_utils::GetNumel(*tensor));
+    };
+    std::vector<float> mean = read(1), var = read(2), w = read(3), b = read(4);
+    double eps = GetScalarArg<double>(call->args, 6, 1e-5);
+    // y = (x - mean) / sqrt(var + eps) * w + b = x * scale + shift.
+    std::vector<float> scale(mean.size()), shift(mean.size());
+    for (size_t c = 0; c < mean.size(); ++c) {
+      scale[c] = w[c] / std::sqrt(var[c] + eps);
+      shift[c] = b[c] - mean[c] * scale[c];
+    }
+    nvinfer1::Weights power{nvinfer1::DataType::kFLOAT, nullptr, 0};
+    return AddLayer(network_->addScale(*Convert(call->args[0]), nvinfer1::ScaleMode::kCHANNEL,
+                                       ToWeights(shift), ToWeights(scale), power));
+  }
+
+  nvinfer1::ITensor* BiasAdd(const CallNode* call) {
+    nvinfer1::ITensor* x = Convert(call->args[0]);
+    int ndim = x->getDimensions().nbDims;
+    int64_t axis = GetScalarArg<int64_t>(call->args, 2, 1);
+    axis = axis < 0 ? axis + ndim : axis;
+    std::vector<int64_t> shape(ndim, 1);
+    shape[axis] = x->getDimensions().d[axis];
+    nvinfer1::ITensor* bias = Reshape(Convert(call->args[1]), shape);
+    return AddLayer(network_->addElementWise(*x, *bias, nvinfer1::ElementWiseOperation::kSUM));
+  }
+
+  nvinfer1::ITensor* Softmax(const CallNode* call) {
+    nvinfer1::ITensor* x = Convert(call->args[0]);
+    int64_t axis = GetScalarArg<int64_t>(call->args, 1, -1);
+    axis = axis < 0 ? axis + x->getDimensions().nbDims : axis;
+    auto layer = network_->addSoftMax(*x);
+    TRT_CALL(layer);
+    layer->setAxes(1U << axis);
+    return layer->getOutput(0);
+  }
+
+  nvinfer1::ITensor* Transpose(const CallNode* call) {
+    nvinfer1::ITensor* x = Convert(call->args[0]);
+    int ndim = x->getDimensions().nbDims;
+    Value axes_value = GetConstArg(call->args, 1);
+    std::vector<int64_t> axes;
+    if (axes_value.defined()) {
+      axes = GetShapeVecFromValue(axes_value);
+    }
+    nvinfer1::Permutation perm;
+    for (int i = 0; i < ndim; ++i) {
+      int64_t axis = axes.empty() ? ndim - 1 - i : axes[i];
+      perm.order[i] = axis < 0 ? axis + ndim : axis;
+    }
+    auto layer = network_->addShuffle(*x);
+    TRT_CALL(layer);
+    layer->setFirstTranspose(perm);
+    return layer->getOutput(0);
+  }
+
+  /*! \brief Reshape to the static shape of the output, e.g., of reshape and batch_flatten. */
+  nvinfer1::ITensor* ReshapeLike(const CallNode* call) {
+    std::vector<int64_t> shape;
+    CHECK(GetStaticShape(call->checked_type(), &shape)) << "The output shape must be static";
+    return Reshape(Convert(call->args[0]), shape);
+  }
+
+  nvinfer1::ITensor* ConvertCall(const CallNode* call) {
+    auto op = call->op.as<OpNode>();
+    CHECK(op != nullptr) << "NotImplementedError: TensorRT only supports the calls of ops";
+    const std::string& name = op->name;
+    using EW = nvinfer1::ElementWiseOperation;
+    using Act = nvinfer1::ActivationType;
+    if (name == "raf.op.add") return ElementWise(call, EW::kSUM);
+    if (name == "raf.op.subtract") return ElementWise(call, EW::kSUB);
+    if (name == "raf.op.multiply") return ElementWise(call, EW::kPROD);
+    if (name == "raf.op.divide") return ElementWise(call, EW::kDIV);
+    if (name == "raf.op.maximum") return ElementWise(call, EW::kMAX);
+    if (name == "raf.op.minimum") return ElementWise(call, EW::kMIN);
+    if (name == "raf.op.relu") return Activation(call, Act::kRELU);
+    if (name == "raf.op.sigmoid") return Activation(call, Act::kSIGMOID);
+    if (name == "raf.op.tanh") return Activation(call, Act::kTANH);
+    if (name == "raf.op.matmul") return MatMul(call, false, false);
+    if (name == "raf.op.matmul_nt" || name == "raf.op.dense") return MatMul(call, false, true);
+    if (name == "raf.op.matmul_tn") return MatMul(call, true, false);
+    if (name == "raf.op.matmul_tt") return MatMul(call, true, true);
+    if (name == "raf.op.conv2d") return Conv2D(call);
+    if (name == "raf.op.max_pool2d") return Pool2D(call, nvinfer1::PoolingType::kMAX);
+    if (name == "raf.op.avg_pool2d") return Pool2D(call, nvinfer1::PoolingType::kAVERAGE);
+    if (name == "raf.op.batch_norm_infer") return BatchNormInfer(call);
+    if (name == "raf.op.bias_add") return BiasAdd(call);
+    if (name == "raf.op.softmax") return Softmax(call);
+    if (name == "raf.op.transpose") return Transpose(call);
+    if (name == "raf.op.reshape" || name == "raf.op.batch_flatten") return ReshapeLike(call);
+    LOG(FATAL) << "NotImplementedError: TensorRT does not support " << name;
+    throw;
+  }
+
+  /*! \brief The fused function. */
+  Function func_;
+  /*! \brief The network to build. */
+  nvinfer1::INetworkDefinition* network_;
+  /*! \brief The weights computed on the host. */
+  std::vector<std::vector<float>>* host_weights_;
+  /*! \brief The let-bound values of the vars. */
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> bindings_;
+  /*! \brief The converted tensors of the expressions. */
+  std::unordered_map<Expr, nvinfer1::ITensor*, ObjectPtrHash, ObjectPtrEqual> tensors_;
+};
+
+void BuildNetwork(const Function& func, nvinfer1::INetworkDefinition* network,
+                  std::vector<std::vector<float>>* host_weights) {
+  NetworkBuilder(func, network, host_weights).Build();
+}
+
+}  // namespace tensorrt
+}  // namespace op
+}  // namespace raf
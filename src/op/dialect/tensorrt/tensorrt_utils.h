@@ -0,0 +1,70 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/dialect/tensorrt/tensorrt_utils.h
+ * \brief Helper functions for TensorRT
+ */
+#pragma once
+#include <NvInfer.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "raf/ir_ext.h"
+#include "raf/op.h"
+#include "raf/value.h"
+
+#define TRT_CALL(ptr) \
+  CHECK((ptr) != nullptr) << "TensorRT: failed to call " << #ptr
+
+namespace raf {
+namespace op {
+namespace tensorrt {
+
+/*! \brief The TensorRT objects are destroyed by delete since TensorRT 8. */
+template <typename T>
+using TRTPtr = std::unique_ptr<T>;
+
+/*! \brief Forward the TensorRT messages to the RAF log. */
+class TensorRTLogger : public nvinfer1::ILogger {
+ public:
+  void log(Severity severity, const char* msg) noexcept override;
+
+  /*! \brief Get the logger shared by all builders and runtimes. */
+  static TensorRTLogger* Get();
+};
+
+/*! \brief Get the runtime to deserialize the engines. */
+nvinfer1::IRuntime* GetRuntime();
+
+/*!
+ * \brief Convert a RAF dtype to the TensorRT dtype.
+ * \param dtype The RAF dtype.
+ * \return The TensorRT dtype.
+ */
+nvinfer1::DataType ToTRTDataType(const DType& dtype);
+
+/*!
+ * \brief Convert a static shape to the TensorRT dims.
+ * \param shape The shape.
+ * \return The TensorRT dims.
+ */
+nvinfer1::Dims ToTRTDims(const std::vector<int64_t>& shape);
+
+/*!
+ * \brief Build a TensorRT network of a fused function. The params are the network inputs, named
+ * "input_<i>" by the param index, and the fields of the result are the network outputs, named
+ * "output_<i>". The constants are embedded as weights, which must be on the host.
+ * \param func The fused function.
+ * \param network The network to build.
+ * \param host_weights The weights computed on the host, e.g., the folded batch norms, which
+ * must outlive the build of the engine.
+ */
+void BuildNetwork(const ir::Function& func, nvinfer1::INetworkDefinition* network,
+                  std::vector<std::vector<float>>* host_weights);
+
+}  // namespace tensorrt
+}  // namespace op
+}  // namespace raf
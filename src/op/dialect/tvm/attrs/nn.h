@@ -233,6 +233,36 @@ struct ThresholdDxAttrs : public tvm::AttrsNode<ThresholdDxAttrs> {
   }
 };
 
+/*! \brief Attributes used in quantize and dequantize operators */
+struct QuantizeAttrs : public tvm::AttrsNode<QuantizeAttrs> {
+  double scale;
+  std::string dtype;
+  TVM_DECLARE_ATTRS(QuantizeAttrs, "raf.attrs.QuantizeAttrs") {
+    TVM_ATTR_FIELD(scale).set_default(1.0).describe("The scale of the quantized values");
+    TVM_ATTR_FIELD(dtype).set_default("int8").describe("The output dtype");
+  }
+};
+
+/*! \brief Attributes used in counter_dropout and counter_dropout_dx operators */
+struct CounterDropoutAttrs : public tvm::AttrsNode<CounterDropoutAttrs> {
+  double p;
+  int64_t offset;
+  TVM_DECLARE_ATTRS(CounterDropoutAttrs, "raf.attrs.CounterDropoutAttrs") {
+    TVM_ATTR_FIELD(p).set_default(0.5).describe("The dropout rate");
+    TVM_ATTR_FIELD(offset).set_default(0).describe(
+        "The offset of the random numbers, which tells apart the dropouts of the same key");
+  }
+};
+
+/*! \brief Attributes used in paged_attention operator */
+struct PagedAttentionAttrs : public tvm::AttrsNode<PagedAttentionAttrs> {
+  double scale;
+  TVM_DECLARE_ATTRS(PagedAttentionAttrs, "raf.attrs.PagedAttentionAttrs") {
+    TVM_ATTR_FIELD(scale).set_default(0.0).describe(
+        "The scale of the scores, where 0 means 1 / sqrt(head_dim)");
+  }
+};
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
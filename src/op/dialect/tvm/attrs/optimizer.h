@@ -27,6 +27,24 @@ struct SgdAttrs : public tvm::AttrsNode<SgdAttrs> {
   }
 };
 
+struct MultiTensorScaleAttrs : public tvm::AttrsNode<MultiTensorScaleAttrs> {
+  double scale;
+  DataType dtype;
+  TVM_DECLARE_ATTRS(MultiTensorScaleAttrs, "attrs.MultiTensorScaleAttrs") {
+    TVM_ATTR_FIELD(scale);
+    TVM_ATTR_FIELD(dtype);
+  }
+};
+
+struct ClipByGlobalNormAttrs : public tvm::AttrsNode<ClipByGlobalNormAttrs> {
+  double max_norm;
+  double eps;
+  TVM_DECLARE_ATTRS(ClipByGlobalNormAttrs, "attrs.ClipByGlobalNormAttrs") {
+    TVM_ATTR_FIELD(max_norm);
+    TVM_ATTR_FIELD(eps);
+  }
+};
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
@@ -45,6 +45,21 @@ RAF_TVM_BINARY(less_equal, LessEqual, BinaryArgs);
 RAF_TVM_BINARY(greater, Greater, BinaryArgs);
 RAF_TVM_BINARY(greater_equal, GreaterEqual, BinaryArgs);
 
+std::vector<Value> AddNSchema2Args(const AddNArgs* args) {
+  std::vector<Value> ret;
+  for (auto v : args->x) {
+    ret.push_back(v);
+  }
+  return ret;
+}
+
+std::vector<std::string> AddNSchemaArgNames(const op::CallValues& call) {
+  return {"x"};
+}
+
+RAF_TVM(add_n, AddN, AddNArgs, AddNSchema2Args, AddNSchemaArgNames, GenericAttrs, GenericHasher,
+        kElemWise);
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
@@ -62,6 +62,10 @@ RAF_TVM(cross_entropy_dpred, CrossEntropyDpred, LossDtpArgs, LossDtpSchema2Args,
         LossDtpSchemaArgNames, GenericAttrs, GenericHasher, kElemWise);
 RAF_TVM(cross_entropy_dtrue, CrossEntropyDtrue, LossDtpArgs, LossDtpSchema2Args,
         LossDtpSchemaArgNames, GenericAttrs, GenericHasher, kElemWise);
+RAF_TVM(softmax_cross_entropy, SoftmaxCrossEntropy, LossArgs, LossSchema2Args, LossSchemaArgNames,
+        GenericAttrs, LossHasher, kCommReduce);
+RAF_TVM(softmax_cross_entropy_dpred, SoftmaxCrossEntropyDpred, LossDtpArgs, LossDtpSchema2Args,
+        LossDtpSchemaArgNames, GenericAttrs, GenericHasher, kElemWise);
 
 }  // namespace tvm_dialect
 }  // namespace op
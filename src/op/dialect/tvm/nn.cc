@@ -372,6 +372,82 @@ HashKey BiasAddHasher(const std::vector<Type>& param_types, const Type& y_type,
 RAF_TVM(bias_add, BiasAdd, BiasAddArgs, BiasAddSchema2Args, BiasAddSchemaArgNames,
         BiasAddSchema2Attrs, BiasAddHasher, kBroadcast);
 
+std::vector<Value> GroupedMatmulSchema2Args(const GroupedMatmulArgs* args) {
+  return {args->x, args->weight, args->group_sizes};
+}
+
+std::vector<std::string> GroupedMatmulSchemaArgNames(const op::CallValues& call) {
+  return {"x", "weight", "group_sizes"};
+}
+
+RAF_TVM(qnn_dense, QnnDense, BinaryArgs, BinarySchema2Args, BinarySchemaArgNames, GenericAttrs,
+        GenericHasher, kOutEWiseFusable);
+RAF_TVM(qnn_batch_matmul_nt, QnnBatchMatmulNT, BinaryArgs, BinarySchema2Args,
+        BinarySchemaArgNames, GenericAttrs, GenericHasher, kOutEWiseFusable);
+RAF_TVM(qnn_conv2d, QnnConv2d, ConvArgs, ConvSchema2Args, ConvSchemaArgNames, ConvSchema2Attrs,
+        Conv2dHasher, kOutEWiseFusable);
+
+template <typename T>
+std::vector<Value> QuantizeSchema2Args(const T* args) {
+  return {args->x};
+}
+
+std::vector<std::string> QuantizeSchemaArgNames(const op::CallValues& call) {
+  return {"x"};
+}
+
+template <typename T>
+Attrs QuantizeSchema2Attrs(const T* args) {
+  auto attrs = make_object<QuantizeAttrs>();
+  attrs->scale = args->scale;
+  attrs->dtype = args->dtype;
+  return Attrs(attrs);
+}
+
+template <typename T>
+HashKey QuantizeHasher(const std::vector<Type>& param_types, const Type& y_type, const T* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->scale;
+  key << args->dtype;
+  return key;
+}
+
+// The requantization of the int8 GEMMs, i.e., quantize(dequantize(acc)), is fused into their
+// epilogues, as both ops are element-wise.
+RAF_TVM(quantize, Quantize, QuantizeArgs, QuantizeSchema2Args<QuantizeArgs>,
+        QuantizeSchemaArgNames, QuantizeSchema2Attrs<QuantizeArgs>, QuantizeHasher<QuantizeArgs>,
+        kElemWise);
+RAF_TVM(dequantize, Dequantize, DequantizeArgs, QuantizeSchema2Args<DequantizeArgs>,
+        QuantizeSchemaArgNames, QuantizeSchema2Attrs<DequantizeArgs>,
+        QuantizeHasher<DequantizeArgs>, kElemWise);
+
+RAF_TVM(grouped_matmul, GroupedMatmul, GroupedMatmulArgs, GroupedMatmulSchema2Args,
+        GroupedMatmulSchemaArgNames, GenericAttrs, GenericHasher, kOutEWiseFusable);
+
+std::vector<Value> PagedAttentionSchema2Args(const PagedAttentionArgs* args) {
+  return {args->q, args->k_cache, args->v_cache, args->block_table, args->lengths};
+}
+
+std::vector<std::string> PagedAttentionSchemaArgNames(const op::CallValues& call) {
+  return {"q", "k_cache", "v_cache", "block_table", "lengths"};
+}
+
+Attrs PagedAttentionSchema2Attrs(const PagedAttentionArgs* args) {
+  auto attrs = make_object<PagedAttentionAttrs>();
+  attrs->scale = args->scale;
+  return Attrs(attrs);
+}
+
+HashKey PagedAttentionHasher(const std::vector<Type>& param_types, const Type& y_type,
+                             const PagedAttentionArgs* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->scale;
+  return key;
+}
+
+RAF_TVM(paged_attention, PagedAttention, PagedAttentionArgs, PagedAttentionSchema2Args,
+        PagedAttentionSchemaArgNames, PagedAttentionSchema2Attrs, PagedAttentionHasher, kOpaque);
+
 std::vector<Value> ContribDropoutSchema2Args(const DropoutArgs* args) {
   std::vector<Value> re;
   re.push_back(args->x);
@@ -433,6 +509,48 @@ RAF_TVM(_contrib_dropout_dx, DropoutDx, DropoutDxArgs, ContribDropoutDxSchema2Ar
         ContribDropoutDxSchemaArgNames, ContribDropoutDxSchema2Attrs, ContribDropoutDxHasher,
         kOpaque);
 
+std::vector<Value> CounterDropoutSchema2Args(const CounterDropoutArgs* args) {
+  return {args->x, args->key};
+}
+
+std::vector<std::string> CounterDropoutSchemaArgNames(const op::CallValues& call) {
+  return {"x", "key"};
+}
+
+template <typename T>
+Attrs CounterDropoutSchema2Attrs(const T* args) {
+  auto attrs = make_object<CounterDropoutAttrs>();
+  attrs->p = args->p;
+  attrs->offset = args->offset;
+  return Attrs(attrs);
+}
+
+template <typename T>
+HashKey CounterDropoutHasher(const std::vector<Type>& param_types, const Type& y_type,
+                             const T* args) {
+  HashKey key = GenericHasher<nullptr_t>(param_types, y_type, nullptr);
+  key << args->p;
+  key << args->offset;
+  return key;
+}
+
+// The mask is computed from the key by element, so the dropout is fused with its neighbors.
+RAF_TVM(counter_dropout, CounterDropout, CounterDropoutArgs, CounterDropoutSchema2Args,
+        CounterDropoutSchemaArgNames, CounterDropoutSchema2Attrs<CounterDropoutArgs>,
+        CounterDropoutHasher<CounterDropoutArgs>, kInjective);
+
+std::vector<Value> CounterDropoutDxSchema2Args(const CounterDropoutDxArgs* args) {
+  return {args->dy, args->key};
+}
+
+std::vector<std::string> CounterDropoutDxSchemaArgNames(const op::CallValues& call) {
+  return {"dy", "key"};
+}
+
+RAF_TVM(counter_dropout_dx, CounterDropoutDx, CounterDropoutDxArgs, CounterDropoutDxSchema2Args,
+        CounterDropoutDxSchemaArgNames, CounterDropoutSchema2Attrs<CounterDropoutDxArgs>,
+        CounterDropoutHasher<CounterDropoutDxArgs>, kInjective);
+
 template <typename T>
 std::vector<Value> PoolSchema2Args(const T* args) {
   return {args->x};
@@ -18,6 +18,10 @@ namespace tvm_dialect {
 
 using namespace raf::ir;
 using schema::SgdArgs;
+using schema::MultiTensorClipByGlobalNormArgs;
+using schema::MultiTensorL2normArgs;
+using schema::MultiTensorScaleArgs;
+using schema::SparseSgdArgs;
 
 std::vector<Value> SgdSchema2Args(const SgdArgs* args) {
   return {args->x, args->dx, args->v};
@@ -44,6 +48,83 @@ HashKey SgdHasher(const std::vector<Type>& param_types, const Type& y_type, cons
 RAF_TVM(sgd, OptimizerSgd, SgdArgs, SgdSchema2Args, SgdSchemaArgNames, SgdSchema2Attrs, SgdHasher,
         kInjective);
 
+std::vector<Value> SparseSgdSchema2Args(const SparseSgdArgs* args) {
+  return {args->x, args->rows, args->values, args->v};
+}
+
+std::vector<std::string> SparseSgdSchemaArgNames(const op::CallValues& call) {
+  return {"x", "rows", "values", "v"};
+}
+
+Attrs SparseSgdSchema2Attrs(const SparseSgdArgs* args) {
+  auto attrs = make_object<SgdAttrs>();
+  attrs->learning_rate = args->learning_rate;
+  attrs->mu = args->mu;
+  return Attrs(attrs);
+}
+
+HashKey SparseSgdHasher(const std::vector<Type>& param_types, const Type& y_type,
+                        const SparseSgdArgs* args) {
+  HashKey key = GenericHasher<std::nullptr_t>(param_types, y_type, nullptr);
+  key << args->mu;
+  key << args->learning_rate;
+  return key;
+}
+
+RAF_TVM(sparse_sgd, OptimizerSparseSgd, SparseSgdArgs, SparseSgdSchema2Args,
+        SparseSgdSchemaArgNames, SparseSgdSchema2Attrs, SparseSgdHasher, kOpaque);
+
+template <typename T>
+std::vector<Value> MultiTensorSchema2Args(const T* args) {
+  return std::vector<Value>(args->tensor_list.begin(), args->tensor_list.end());
+}
+
+std::vector<std::string> MultiTensorSchemaArgNames(const op::CallValues& call) {
+  return {"tensor_list"};
+}
+
+Attrs MultiTensorScaleSchema2Attrs(const MultiTensorScaleArgs* args) {
+  auto attrs = make_object<MultiTensorScaleAttrs>();
+  const DLTensor* x0 = args->tensor_list[0];
+  attrs->scale = args->scale;
+  attrs->dtype = DataType(args->dtype.empty() ? x0->dtype : ir::String2DLDataType(args->dtype));
+  return Attrs(attrs);
+}
+
+HashKey MultiTensorScaleHasher(const std::vector<Type>& param_types, const Type& y_type,
+                               const MultiTensorScaleArgs* args) {
+  HashKey key = GenericHasher<std::nullptr_t>(param_types, y_type, nullptr);
+  key << args->scale;
+  return key;
+}
+
+RAF_TVM(multi_tensor_scale, MultiTensorScale, MultiTensorScaleArgs,
+        MultiTensorSchema2Args<MultiTensorScaleArgs>, MultiTensorSchemaArgNames,
+        MultiTensorScaleSchema2Attrs, MultiTensorScaleHasher, kOpaque);
+
+RAF_TVM(multi_tensor_l2norm, MultiTensorL2norm, MultiTensorL2normArgs,
+        MultiTensorSchema2Args<MultiTensorL2normArgs>, MultiTensorSchemaArgNames, GenericAttrs,
+        GenericHasher, kOpaque);
+
+Attrs ClipByGlobalNormSchema2Attrs(const MultiTensorClipByGlobalNormArgs* args) {
+  auto attrs = make_object<ClipByGlobalNormAttrs>();
+  attrs->max_norm = args->max_norm;
+  attrs->eps = args->eps;
+  return Attrs(attrs);
+}
+
+HashKey ClipByGlobalNormHasher(const std::vector<Type>& param_types, const Type& y_type,
+                               const MultiTensorClipByGlobalNormArgs* args) {
+  HashKey key = GenericHasher<std::nullptr_t>(param_types, y_type, nullptr);
+  key << args->max_norm;
+  key << args->eps;
+  return key;
+}
+
+RAF_TVM(multi_tensor_clip_by_global_norm, MultiTensorClipByGlobalNorm,
+        MultiTensorClipByGlobalNormArgs, MultiTensorSchema2Args<MultiTensorClipByGlobalNormArgs>,
+        MultiTensorSchemaArgNames, ClipByGlobalNormSchema2Attrs, ClipByGlobalNormHasher, kOpaque);
+
 }  // namespace tvm_dialect
 }  // namespace op
 }  // namespace raf
@@ -260,6 +260,9 @@ Attrs EmbeddingDxSchema2Attrs(const EmbeddingDxArgs* args) {
 RAF_TVM(embedding_dx, EmbeddingDx, EmbeddingDxArgs, EmbeddingDxSchema2Args,
         EmbeddingDxSchemaArgNames, EmbeddingDxSchema2Attrs, GenericHasher, kOpaque);
 
+RAF_TVM(embedding_sparse_dx, EmbeddingSparseDx, EmbeddingDxArgs, EmbeddingDxSchema2Args,
+        EmbeddingDxSchemaArgNames, EmbeddingDxSchema2Attrs, GenericHasher, kOpaque);
+
 std::vector<Value> SequenceMaskSchema2Args(const SequenceMaskArgs* args) {
   return {args->x, args->sequence_length};
 }
@@ -1119,6 +1122,28 @@ HashKey StridedSetHasher(const std::vector<Type>& param_types, const Type& y_typ
 RAF_TVM(strided_set, StridedSet, StridedSetArgs, StridedSetSchema2Args, StridedSetSchemaArgNames,
         StridedSetSchema2Attrs, StridedSetHasher, kInjective);
 
+std::vector<Value> KvAppendSchema2Args(const KvAppendArgs* args) {
+  return {args->cache, args->v, args->pos};
+}
+
+std::vector<std::string> KvAppendSchemaArgNames(const op::CallValues& call) {
+  return {"cache", "v", "pos"};
+}
+
+RAF_TVM(kv_append, KvAppend, KvAppendArgs, KvAppendSchema2Args, KvAppendSchemaArgNames,
+        GenericAttrs, GenericHasher, kOpaque);
+
+std::vector<Value> PagedKvAppendSchema2Args(const PagedKvAppendArgs* args) {
+  return {args->cache, args->v, args->block_table, args->pos};
+}
+
+std::vector<std::string> PagedKvAppendSchemaArgNames(const op::CallValues& call) {
+  return {"cache", "v", "block_table", "pos"};
+}
+
+RAF_TVM(paged_kv_append, PagedKvAppend, PagedKvAppendArgs, PagedKvAppendSchema2Args,
+        PagedKvAppendSchemaArgNames, GenericAttrs, GenericHasher, kOpaque);
+
 std::vector<Value> WhereSchema2Args(const WhereArgs* args) {
   return {args->condition, args->x, args->y};
 }
@@ -34,9 +34,14 @@ RAF_REGISTER_OBJECT_REFLECT(BatchNormAttrs);
 RAF_REGISTER_OBJECT_REFLECT(PadAttrs);
 RAF_REGISTER_OBJECT_REFLECT(ThresholdAttrs);
 RAF_REGISTER_OBJECT_REFLECT(ThresholdDxAttrs);
+RAF_REGISTER_OBJECT_REFLECT(QuantizeAttrs);
+RAF_REGISTER_OBJECT_REFLECT(PagedAttentionAttrs);
+RAF_REGISTER_OBJECT_REFLECT(CounterDropoutAttrs);
 
 // optimizer attrs
 RAF_REGISTER_OBJECT_REFLECT(SgdAttrs);
+RAF_REGISTER_OBJECT_REFLECT(MultiTensorScaleAttrs);
+RAF_REGISTER_OBJECT_REFLECT(ClipByGlobalNormAttrs);
 
 }  // namespace tvm_dialect
 }  // namespace op
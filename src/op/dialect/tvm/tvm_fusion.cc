@@ -7,6 +7,10 @@
  * \file ./src/op/dialect/tvm/tvm_fusion.cc
  * \brief Implementation of tvm dispatch for fused functions
  */
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 #include "raf/value.h"
 #include "raf/registry.h"
 #include "raf/op.h"
@@ -15,6 +19,8 @@
 #include "raf/pass.h"
 #include "tvm/ir/type_functor.h"
 #include "tvm/auto_scheduler/compute_dag.h"
+#include "tvm/relay/analysis.h"
+#include "tvm/tir/var.h"
 #include "relay/backend/te_compiler.h"
 #include "relay/backend/te_compiler_cache.h"
 #include "./tvm_utils.h"
@@ -254,16 +260,148 @@ class RAF2TVM : public ExprMutator {
 HashKey HashFusedFunc(const Function& func) {
   HashKey key;
   key << raf::ir::AsText(func, true);
+  if (!ScheduleDatabaseTag().empty()) {
+    key << ScheduleDatabaseTag();
+  }
   return key;
 }
 
+/*!
+ * \brief Replace the concrete dims of a TVM function by symbolic dims, so the built kernel serves
+ * the shapes with the same pattern. The dims of the same value share a symbolic dim, and the dims
+ * of 1 are kept to preserve broadcasting.
+ */
+class ShapeSymbolizer : public ExprMutator {
+ public:
+  Expr VisitExpr(const Expr& expr) override {
+    auto ret = ExprMutator::VisitExpr(expr);
+    if (!ret.same_as(expr) && expr->checked_type_.defined()) {
+      ret->checked_type_ = SymbolizeType(expr->checked_type());
+    }
+    return ret;
+  }
+
+  Expr VisitExpr_(const VarNode* node) override {
+    auto var = GetRef<Var>(node);
+    auto it = vmap_.find(var);
+    if (it != vmap_.end()) {
+      return it->second;
+    }
+    auto type = SymbolizeType(node->checked_type());
+    auto new_var = MakeVar(node->name_hint(), type);
+    new_var->checked_type_ = type;
+    vmap_[var] = new_var;
+    return new_var;
+  }
+
+  Expr VisitExpr_(const FunctionNode* node) override {
+    Array<Var> params;
+    for (const auto& param : node->params) {
+      params.push_back(Downcast<Var>(VisitExpr(param)));
+    }
+    Expr body = VisitExpr(node->body);
+    return Function(params, body, SymbolizeType(node->body->checked_type()), {}, node->attrs);
+  }
+
+  Type SymbolizeType(const Type& type) {
+    if (const auto* ttype = type.as<TensorTypeNode>()) {
+      Array<PrimExpr> shape;
+      for (const auto& dim : ttype->shape) {
+        const auto* imm = dim.as<IntImmNode>();
+        if (imm == nullptr || imm->value == 1) {
+          shape.push_back(dim);
+          continue;
+        }
+        auto it = dims_.find(imm->value);
+        if (it == dims_.end()) {
+          auto var = tvm::tir::Var("d" + std::to_string(dims_.size()), imm->dtype);
+          it = dims_.emplace(imm->value, var).first;
+          values.push_back(imm->value);
+        }
+        shape.push_back(it->second);
+      }
+      return TensorType(shape, ttype->dtype);
+    } else if (const auto* tuple = type.as<TupleTypeNode>()) {
+      Array<Type> fields;
+      for (const auto& field : tuple->fields) {
+        fields.push_back(SymbolizeType(field));
+      }
+      return TupleType(fields);
+    } else if (const auto* func_type = type.as<FuncTypeNode>()) {
+      Array<Type> arg_types;
+      for (const auto& arg_type : func_type->arg_types) {
+        arg_types.push_back(SymbolizeType(arg_type));
+      }
+      return FuncType(arg_types, SymbolizeType(func_type->ret_type), func_type->type_params,
+                      func_type->type_constraints);
+    }
+    return type;
+  }
+
+  /*! \brief The concrete values of the symbolic dims in order. */
+  std::vector<int64_t> values;
+
+ private:
+  /*! \brief Maps from the concrete values to the symbolic dims. */
+  std::unordered_map<int64_t, tvm::tir::Var> dims_;
+  /*! \brief Maps from the params to the params with symbolic types. */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> vmap_;
+};
+
+/*!
+ * \brief Compile the TVM function with symbolic dims if it is enabled by the pass config
+ * "raf.tvm.symbolic_shape" and the function only has elementwise and broadcast ops, whose
+ * schedules do not depend on the concrete shapes.
+ * \param func The TVM function, which is replaced by the one with symbolic dims.
+ * \param key The cache key, which is replaced by the key of the symbolic function and the shape
+ * buckets. The dims in the same bucket, i.e., [base^k, base^(k+1)), share a kernel.
+ * \return Whether the function is made symbolic.
+ */
+bool SymbolizeFusedFunc(Function* func, HashKey* key) {
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  if (!pass_ctx->GetConfig("raf.tvm.symbolic_shape", tvm::Bool(false)).value()) {
+    return false;
+  }
+  static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+  bool eligible = true;
+  tvm::relay::PostOrderVisit((*func)->body, [&](const Expr& expr) {
+    if (const auto* call = expr.as<CallNode>()) {
+      const auto* op = call->op.as<OpNode>();
+      if (op == nullptr || fpattern.get(GetRef<Op>(op), kOpaque) > kBroadcast) {
+        eligible = false;
+      }
+    }
+  });
+  if (!eligible) {
+    return false;
+  }
+  int64_t base =
+      pass_ctx->GetConfig("raf.tvm.symbolic_shape_bucket", Integer(2)).value().IntValue();
+  ShapeSymbolizer symbolizer;
+  *func = Downcast<Function>(symbolizer(*func));
+  HashKey new_key;
+  new_key << "symbolic" << raf::ir::AsText(*func, true);
+  for (int64_t value : symbolizer.values) {
+    int64_t bucket = 0;
+    for (int64_t bound = base; base > 1 && bound <= value; bound *= base) {
+      ++bucket;
+    }
+    new_key << bucket;
+  }
+  if (!ScheduleDatabaseTag().empty()) {
+    new_key << ScheduleDatabaseTag();
+  }
+  *key = new_key;
+  return true;
+}
+
 OpEnv* FusedFuncBuild(const op::CallValues& call) {
   tvm::relay::tec::TECompiler te_compiler;
   auto env = std::make_unique<TVMOpEnv>();
   Device dev = call->device;
 
   // Determine cache
-  MetaPersistCache<TVMModuleCacheEntry>* cache;
+  TVMModulePersistCache* cache;
   if (dev.device_type() == DevType::kCPU()) {
     cache = &CacheBuildCpu;
   } else if (dev.device_type() == DevType::kCUDA()) {
@@ -274,6 +412,10 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
   }
 
   tvm::Target target = dev.tvm_target();
+  if (!ScheduleDatabaseTag().empty()) {
+    // Query the tuned schedules of the database when lowering the function.
+    ForceEnableAutoScheduler();
+  }
   CHECK(dev.device_type() == DevType::kCPU() || dev.device_type() == DevType::kCUDA())
       << "NotImplementedError: target is not supported " << dev.device_type().c_str();
   RAF2TVM raf_to_tvm(call, dev.device_type());
@@ -281,17 +423,18 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
   env->env_name = TruncateName(GetUniqueName(raf_to_tvm.func_name));
 
   auto key = HashFusedFunc(Downcast<ClosureValue>(call->callee)->func);
+  SymbolizeFusedFunc(&func, &key);
   TVMModuleCacheEntry entry;
-  if (const auto* compiled = cache->Get(key.byte_vector)) {
+  if (const auto* compiled = cache->Get(key)) {
     entry = *compiled;
   } else {
     te_compiler->Clear();
     try {
+      CheckKernelJit(env->env_name);
       auto cached_key = tvm::relay::tec::CCacheKey(func, target);
       auto cached_func = te_compiler->Lower(cached_key);
-      auto mod = tvm::build(cached_func->funcs, cached_key->target, Target(nullptr));
-      entry = TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);
-      cache->Set(key.byte_vector, entry);
+      entry = BuildTVMModule(cached_func, cached_key->target);
+      cache->Set(key, entry);
     } catch (const dmlc::Error& e) {
       if (!AllowJitFailure()) {
         LOG(FATAL) << "Failed to build a fused op " << env->env_name << ": " << e.what();
@@ -309,6 +452,94 @@ OpEnv* FusedFuncBuild(const op::CallValues& call) {
   return env.release();
 }
 
+/*!
+ * \brief Build the fused functions called by the given calls ahead of time and fill the build
+ * cache, so that FusedFuncBuild hits the cache when the ops are dispatched. The TE lowering runs
+ * serially because the TOPI schedules call back into Python, while the codegen of the lowered
+ * functions runs in a pool of worker threads.
+ * \param calls The calls to fused functions of the TVM dialect.
+ * \param num_threads The number of worker threads.
+ */
+void ParallelBuildFusedFuncs(const Array<Call>& calls, int num_threads) {
+  Device dev = Device::Current(true);
+  TVMModulePersistCache* cache;
+  if (dev.device_type() == DevType::kCPU()) {
+    cache = &CacheBuildCpu;
+  } else if (dev.device_type() == DevType::kCUDA()) {
+    cache = &CacheBuildCuda;
+  } else {
+    LOG(WARNING) << "Skip building fused ops on device " << dev.device_type().c_str();
+    return;
+  }
+  tvm::Target target = dev.tvm_target();
+  if (!ScheduleDatabaseTag().empty()) {
+    ForceEnableAutoScheduler();
+  }
+
+  // Lower the functions that are not in the cache.
+  tvm::relay::tec::TECompiler te_compiler;
+  std::vector<std::string> keys;
+  std::vector<tvm::relay::tec::CachedFunc> lowered;
+  std::unordered_set<std::string> visited;
+  for (const auto& call : calls) {
+    try {
+      RAF2TVM raf_to_tvm(CreateDummyCallValues(call, dev), dev.device_type());
+      Function func = Downcast<Function>(raf_to_tvm());
+      auto key = HashFusedFunc(Downcast<Function>(call->op));
+      SymbolizeFusedFunc(&func, &key);
+      std::string key_str = key.str();
+      if (visited.count(key_str) || cache->Get(key) != nullptr) {
+        continue;
+      }
+      visited.insert(key_str);
+      te_compiler->Clear();
+      lowered.push_back(te_compiler->Lower(tvm::relay::tec::CCacheKey(func, target)));
+      keys.push_back(key_str);
+    } catch (const dmlc::Error& e) {
+      // Leave the failure to FusedFuncBuild, which reports it when the op is dispatched.
+      DLOG(WARNING) << "Failed to lower a fused op ahead of time: " << e.what();
+    }
+  }
+  if (lowered.empty()) {
+    return;
+  }
+
+  // Build the lowered functions concurrently. The worker threads enter the current pass context
+  // because it is thread local.
+  std::vector<TVMModuleCacheEntry> entries(lowered.size());
+  std::vector<uint8_t> built(lowered.size(), 0);
+  std::atomic<size_t> next(0);
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  auto worker = [&]() {
+    tvm::With<tvm::transform::PassContext> ctx(pass_ctx);
+    for (size_t i = next++; i < lowered.size(); i = next++) {
+      try {
+        entries[i] = BuildTVMModule(lowered[i], target);
+        built[i] = 1;
+      } catch (const dmlc::Error& e) {
+        DLOG(WARNING) << "Failed to build a fused op ahead of time: " << e.what();
+      }
+    }
+  };
+  num_threads = std::max(1, std::min(num_threads, static_cast<int>(lowered.size())));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The cache metrics are not synchronized, so the entries are set by this thread.
+  for (size_t i = 0; i < lowered.size(); ++i) {
+    if (built[i]) {
+      cache->Set(keys[i], entries[i]);
+    }
+  }
+}
+
+RAF_REGISTER_GLOBAL("raf.op.tvm._parallel_build").set_body_typed(ParallelBuildFusedFuncs);
+
 /*!
  * \brief Calculate the total computation GFLOPS required by a function.
  * \param call The call values, which callee is a ClosureValue that includes the target function.
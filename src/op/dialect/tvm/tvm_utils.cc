@@ -7,8 +7,13 @@
  * \file ./src/op/dialect/tvm/tvm_utils.cc
  * \brief Implementation of utility methods for TVM dialect.
  */
+#include <sstream>
+#include <unordered_set>
 #include "raf/value.h"
 #include "raf/registry.h"
+#include "tvm/driver/driver_api.h"
+#include "tvm/node/structural_hash.h"
+#include "tvm/tir/function.h"
 #include "./tvm_utils.h"
 #include "../../../common/shape_utils.h"
 
@@ -22,8 +27,8 @@ using namespace raf::registry;
 using common::shape_utils::BytesCompactTensor;
 using common::shape_utils::GetShape;
 
-MetaPersistCache<TVMModuleCacheEntry> CacheBuildCpu("tvm_cpu");
-MetaPersistCache<TVMModuleCacheEntry> CacheBuildCuda("tvm_cuda");
+TVMModulePersistCache CacheBuildCpu("tvm_cpu");
+TVMModulePersistCache CacheBuildCuda("tvm_cuda");
 MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc("tvm_lower");
 
 void GetDLTensor(const Value& v, std::vector<DLTensor>* tensors) {
@@ -128,6 +133,142 @@ void TVMOpEnv::Execute(const std::vector<Value>& inputs, Value output) {
   f.CallPacked(targs, &rv);
 }
 
+std::string& ScheduleDatabaseTag() {
+  static std::string tag;
+  return tag;
+}
+
+TVMModuleCacheEntry BuildTVMModule(const tvm::relay::tec::CachedFunc& cached_func,
+                                   const tvm::Target& target) {
+  std::ostringstream os;
+  os << cached_func->prim_fn_var->name_hint << "_" << std::hex
+     << tvm::StructuralHash()(cached_func->funcs);
+  std::string func_name = os.str();
+  Map<tvm::GlobalVar, tvm::BaseFunc> funcs;
+  for (const auto& it : cached_func->funcs->functions) {
+    if (it.first->name_hint == cached_func->prim_fn_var->name_hint) {
+      auto prim_func = Downcast<tvm::tir::PrimFunc>(it.second);
+      prim_func = WithAttr(std::move(prim_func), tvm::attr::kGlobalSymbol, String(func_name));
+      funcs.Set(tvm::GlobalVar(func_name), prim_func);
+    } else {
+      funcs.Set(it.first, it.second);
+    }
+  }
+  auto mod = tvm::build(tvm::IRModule(funcs), target, Target(nullptr));
+  return TVMModuleCacheEntry(mod, func_name);
+}
+
+const TVMModuleCacheEntry* TVMModulePersistCache::Get(const MetaCacheKey& key) {
+  if (!MetaCache<TVMModuleCacheEntry>::Has(key)) {
+    std::lock_guard<std::mutex> lock(bundle_mu_);
+    LoadBundles();
+    auto it = bundled_.find(HashPersistKey(key));
+    if (it != bundled_.end()) {
+      AddMetric("BundleHit", 1);
+      MetaCache<TVMModuleCacheEntry>::Set(key, it->second);
+    }
+  }
+  return MetaPersistCache<TVMModuleCacheEntry>::Get(key);
+}
+
+void TVMModulePersistCache::Set(const MetaCacheKey& key, TVMModuleCacheEntry val) {
+  MetaPersistCache<TVMModuleCacheEntry>::Set(key, val);
+  if (!GetPersistDir().empty()) {
+    std::lock_guard<std::mutex> lock(bundle_mu_);
+    built_.emplace_back(HashPersistKey(key), val);
+  }
+}
+
+void TVMModulePersistCache::LoadBundles() {
+  std::string cache_dir = GetPersistDir();
+  if (cache_dir == bundle_cache_dir_) {
+    return;
+  }
+  bundle_cache_dir_ = cache_dir;
+  bundled_.clear();
+  if (cache_dir.empty()) {
+    return;
+  }
+  for (int i = 0; DirExists(GetBundlePath(cache_dir, i)); ++i) {
+    auto path = GetBundlePath(cache_dir, i);
+    // The index is written after the shared library, so a bundle without it is incomplete.
+    std::ifstream ifs(path + "/" + BUNDLE_INDEX_FILE);
+    if (!ifs.good()) {
+      continue;
+    }
+    try {
+      tvm::runtime::Module mod = LoadTVMModule(path + "/" + BUNDLE_SO_FILE);
+      std::string hashed_key, func_name;
+      while (ifs >> hashed_key >> func_name) {
+        bundled_.emplace(hashed_key, TVMModuleCacheEntry(mod, func_name));
+      }
+    } catch (const dmlc::Error& e) {
+      AddMetric("BundleLoadFailure", 1);
+      LOG(WARNING) << "Failed to load the bundle " << path << ": " << e.what();
+    }
+  }
+}
+
+int TVMModulePersistCache::Bundle() {
+  static auto f_export = registry::GetPackedFunc("raf._tvm_op.utils.export_bundle");
+  std::lock_guard<std::mutex> lock(bundle_mu_);
+  std::string cache_dir = GetPersistDir();
+  if (cache_dir.empty() || built_.empty()) {
+    return 0;
+  }
+  LoadBundles();
+
+  // The modules must have distinct function names to be linked together.
+  std::vector<std::pair<std::string, TVMModuleCacheEntry>> entries;
+  std::unordered_set<std::string> func_names;
+  Array<tvm::runtime::Module> mods;
+  for (const auto& it : built_) {
+    if (bundled_.count(it.first) || !func_names.insert(it.second.GetFuncName()).second) {
+      continue;
+    }
+    entries.push_back(it);
+    mods.push_back(it.second.GetModule());
+  }
+  built_.clear();
+  if (entries.empty()) {
+    return 0;
+  }
+
+  CreateDir(cache_dir + "/" + BUNDLE_DIR);
+  int idx = 0;
+  while (DirExists(GetBundlePath(cache_dir, idx))) {
+    ++idx;
+  }
+  auto path = GetBundlePath(cache_dir, idx);
+  CreateDir(path);
+  std::string msg;
+  try {
+    bool success = f_export(mods, path + "/" + BUNDLE_SO_FILE);
+    if (!success) {
+      msg = "The shared library is not created";
+    }
+  } catch (const dmlc::Error& e) {
+    msg = e.what();
+  }
+  if (!msg.empty()) {
+    AddMetric("BundleSaveFailure", 1);
+    LOG(WARNING) << "Failed to save the bundle " << path << ": " << msg;
+    return 0;
+  }
+  std::ofstream ofs(path + "/" + BUNDLE_INDEX_FILE);
+  for (const auto& it : entries) {
+    ofs << it.first << " " << it.second.GetFuncName() << std::endl;
+    bundled_.emplace(it.first, it.second);
+  }
+  ofs.close();
+  AddMetric("CacheBundle", entries.size());
+  return entries.size();
+}
+
+int BundleTVMCache() {
+  return CacheBuildCpu.Bundle() + CacheBuildCuda.Bundle();
+}
+
 PackedMetricMap DumpTVMCacheMetric(const std::string& cache_name) {
   static std::unordered_map<std::string, MetaCacheMetric*> name_to_cache = {
       {"tvm_cpu", &CacheBuildCpu},
@@ -149,9 +290,16 @@ PackedMetricMap DumpTVMCacheMetric(const std::string& cache_name) {
 }
 
 RAF_REGISTER_GLOBAL("raf.cache.DumpTVMCacheMetric").set_body_typed(DumpTVMCacheMetric);
+RAF_REGISTER_GLOBAL("raf.cache.BundleTVMCache").set_body_typed(BundleTVMCache);
+RAF_REGISTER_GLOBAL("raf.cache.SetTVMScheduleDatabaseTag").set_body_typed([](std::string tag) {
+  ScheduleDatabaseTag() = tag;
+});
 
 RAF_REGISTER_DIALECT("tvm").set_enable(DevType::kCPU()).set_enable(DevType::kCUDA());
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.allow_jit_failure", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.parallel_build_threads", tvm::Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.symbolic_shape", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.tvm.symbolic_shape_bucket", tvm::Integer);
 
 }  // namespace tvm_dialect
 }  // namespace op
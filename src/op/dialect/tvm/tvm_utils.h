@@ -56,6 +56,35 @@ class TVMOpEnv : public op::OpEnv {
   void Execute(const std::vector<Value>& inputs, Value outputs) override;
 };
 
+/*!
+ * \brief Load a TVM module from a shared library. The runtime library loads it by the TVM runtime
+ * directly, since it runs without Python.
+ * \param path The path of the shared library.
+ * \return The loaded module.
+ */
+inline tvm::runtime::Module LoadTVMModule(const std::string& path) {
+#ifdef RAF_RUNTIME_ONLY
+  CHECK(std::ifstream(path).good()) << "Module file does not exist " << path;
+  return tvm::runtime::Module::LoadFromFile(path);
+#else
+  static auto f_load = registry::GetPackedFunc("raf._tvm_op.utils.load_module");
+  return f_load(path);
+#endif
+}
+
+/*!
+ * \brief Check whether a kernel missing in the caches can be built. The runtime library only runs
+ * the kernels of the kernel bundle, because lowering the ops needs their strategies registered in
+ * Python, so it fails here to let the dispatcher select the next implementation.
+ * \param name The name of the kernel.
+ */
+inline void CheckKernelJit(const std::string& name) {
+#ifdef RAF_RUNTIME_ONLY
+  LOG(FATAL) << "The kernel " << name << " is not in the kernel bundle, and the runtime library "
+             << "does not build kernels";
+#endif
+}
+
 /*! \brief The persist cache entry of TVM modules. */
 class TVMModuleCacheEntry {
  public:
@@ -67,8 +96,7 @@ class TVMModuleCacheEntry {
   }
 
   static TVMModuleCacheEntry Load(const std::string path) {
-    static auto f_load = registry::GetPackedFunc("raf._tvm_op.utils.load_module");
-    tvm::runtime::Module mod = f_load(path + "/" + MOD_SO_FILE);
+    tvm::runtime::Module mod = LoadTVMModule(path + "/" + MOD_SO_FILE);
 
     std::ifstream ifs(path + "/" + FUNC_NAME_FILE);
     std::string func_name;
@@ -81,6 +109,14 @@ class TVMModuleCacheEntry {
     return mod_->GetFunction(func_name_);
   }
 
+  tvm::runtime::Module GetModule() const {
+    return mod_;
+  }
+
+  const std::string& GetFuncName() const {
+    return func_name_;
+  }
+
   bool Save(const std::string& path) {
     static auto f_export = registry::GetPackedFunc("raf._tvm_op.utils.export_library");
     auto bin_path = path + "/" + MOD_SO_FILE;
@@ -105,6 +141,67 @@ class TVMModuleCacheEntry {
   std::string func_name_;
 };
 
+/*!
+ * \brief The persist cache of TVM modules. Besides the directory of each entry, it looks up the
+ * bundles of the cache, each of which links many modules into one shared library with an index
+ * file. A bundle is loaded by a single dlopen and its entries are resolved by their keys, so
+ * loading thousands of cached kernels does not pay the file system calls of each entry.
+ */
+class TVMModulePersistCache : public MetaPersistCache<TVMModuleCacheEntry> {
+ public:
+  using MetaPersistCache<TVMModuleCacheEntry>::Get;
+  using MetaPersistCache<TVMModuleCacheEntry>::Set;
+
+  explicit TVMModulePersistCache(const std::string persist_name)
+      : MetaPersistCache<TVMModuleCacheEntry>(persist_name) {
+  }
+
+  const TVMModuleCacheEntry* Get(const MetaCacheKey& key) final;
+
+  void Set(const MetaCacheKey& key, TVMModuleCacheEntry val) final;
+
+  /*!
+   * \brief Link the modules built by this process since the persistence is enabled into a new
+   * bundle of the cache.
+   * \return The number of modules in the new bundle.
+   */
+  int Bundle();
+
+ private:
+  /*! \brief Load the index and the shared library of each bundle if the directory is changed. */
+  void LoadBundles();
+
+  /*! \brief The directory of the i-th bundle. */
+  static std::string GetBundlePath(const std::string& cache_dir, int i) {
+    return cache_dir + "/" + BUNDLE_DIR + "/" + std::to_string(i);
+  }
+
+  /*! \brief The directory of the bundles under the cache directory. */
+  static constexpr const char* BUNDLE_DIR = "bundles";
+  /*! \brief The shared library of a bundle. */
+  static constexpr const char* BUNDLE_SO_FILE = "tvm_modules.so";
+  /*! \brief The index file of a bundle, which maps the hashed keys to the function names. */
+  static constexpr const char* BUNDLE_INDEX_FILE = "index.txt";
+  /*! \brief The cache directory whose bundles are loaded. */
+  std::string bundle_cache_dir_;
+  /*! \brief The bundled entries indexed by the hashed keys. */
+  std::unordered_map<std::string, TVMModuleCacheEntry> bundled_;
+  /*! \brief The hashed keys and the entries built by this process that are not bundled yet. */
+  std::vector<std::pair<std::string, TVMModuleCacheEntry>> built_;
+  /*! \brief The lock of the bundles. */
+  std::mutex bundle_mu_;
+};
+
+/*!
+ * \brief Build a lowered function to a module. The entry function is suffixed by the structural
+ * hash of the lowered module, so the modules linked into a bundle have distinct symbols.
+ * \param cached_func The lowered function.
+ * \param target The target to build for.
+ * \return The cache entry of the built module.
+ */
+TVMModuleCacheEntry BuildTVMModule(const tvm::relay::tec::CachedFunc& cached_func,
+                                   const tvm::Target& target);
+
 class RelayFuncCacheEntry {
  public:
   explicit RelayFuncCacheEntry() {
@@ -179,6 +276,13 @@ inline bool AllowJitFailure() {
       .value();
 }
 
+/*!
+ * \brief The tag of the schedule database, i.e., the tuning records, that the TVM ops are compiled
+ * with. It is a part of the cache keys, so the kernels compiled with and without the tuned
+ * schedules are not mixed. Empty if no database is set.
+ */
+std::string& ScheduleDatabaseTag();
+
 /*!
  * \brief Modify the configs of the current PassContext to enable auto-scheduler for TVM ops.
  */
@@ -192,8 +296,8 @@ using FRAFAttr = registry::TypedPackedFunc<ir::Attrs(const CallValues& call)>;
 using FRAFArgIndices =
     registry::TypedPackedFunc<ir::Array<tvm::IntImm>(const op::CallValues& call)>;
 
-extern MetaPersistCache<TVMModuleCacheEntry> CacheBuildCpu;
-extern MetaPersistCache<TVMModuleCacheEntry> CacheBuildCuda;
+extern TVMModulePersistCache CacheBuildCpu;
+extern TVMModulePersistCache CacheBuildCuda;
 extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
 
 }  // namespace tvm_dialect
@@ -228,12 +332,16 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
     RType ret;                                                                                     \
     HashKey key;                                                                                   \
     key << #OP << HASH(param_types, ret_type, schema);                                             \
-    if (const auto* compiled = cache->Get(key.byte_vector)) {                                      \
+    if (!ScheduleDatabaseTag().empty()) {                                                          \
+      key << ScheduleDatabaseTag();                                                                \
+    }                                                                                              \
+    if (const auto* compiled = cache->Get(key)) {                                                  \
       ret = *compiled;                                                                             \
     } else {                                                                                       \
+      CheckKernelJit(#OP);                                                                         \
       auto lowered = LowerOp(op, attrs, param_types, ret_type);                                    \
       ret = f_post_lower(lowered);                                                                 \
-      cache->Set(key.byte_vector, ret);                                                            \
+      cache->Set(key, ret);                                                                        \
     }                                                                                              \
     return ret;                                                                                    \
   }                                                                                                \
@@ -265,8 +373,7 @@ extern MetaPersistCache<RelayFuncCacheEntry> CacheLoweredFunc;
           te_compiler->Clear();                                                                    \
           auto key = tvm::relay::tec::CCacheKey(f, target);                                        \
           auto cached_func = te_compiler->Lower(key);                                              \
-          auto mod = tvm::build(cached_func->funcs, key->target, Target(nullptr));                 \
-          return TVMModuleCacheEntry(mod, cached_func->prim_fn_var->name_hint);                    \
+          return BuildTVMModule(cached_func, key->target);                                         \
         });                                                                                        \
     try {                                                                                          \
       auto module_cache_entry = FUNC##CacheCompile(env, call, cache, f_post_lower);                \
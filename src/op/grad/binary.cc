@@ -32,6 +32,22 @@ Array<Expr> AddGrad(const Expr& orig_call, const Array<Expr> orig_args, const Va
 
 RAF_OP_GRAD("raf.op.add", AddGrad);
 
+Array<Expr> AddNGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                     const Expr& dy) {
+  // The inputs are of the same shape, so each of them gets dy as is.
+  int num_inputs = 1;
+  if (auto tuple_node = orig_args[0].as<TupleNode>()) {
+    num_inputs = tuple_node->fields.size();
+  }
+  Array<Expr> tuple;
+  for (int i = 0; i < num_inputs; i++) {
+    tuple.push_back(dy);
+  }
+  return {Tuple(tuple)};
+}
+
+RAF_OP_GRAD("raf.op.add_n", AddNGrad);
+
 Array<Expr> SubGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                     const Expr& dy) {
   const CallNode* call = orig_call.as<CallNode>();
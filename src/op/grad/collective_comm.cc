@@ -35,6 +35,80 @@ Array<Expr> AllToAllGrad(const Expr& orig_call, const Array<Expr> orig_args, con
 
 RAF_OP_GRAD("raf.op._all_to_all", AllToAllGrad);
 
+Array<Expr> AllToAllvGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  // Send the gradients back along the reversed routes, i.e., with the received counts.
+  static auto op_all_to_allv = Op::Get("raf.op._all_to_allv");
+  auto dx = Call(op_all_to_allv, {TupleGetItem(dy, 0), TupleGetItem(y, 1), orig_args[2]});
+  return {TupleGetItem(dx, 0), NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op._all_to_allv", AllToAllvGrad);
+
+Array<Expr> VocabParallelCrossEntropyGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                          const Var& y, const Expr& dy) {
+  static auto op_dpred = Op::Get("raf.op._vocab_parallel_cross_entropy_dpred");
+  return {NullValue<Expr>(), Call(op_dpred, {dy, orig_args[0], orig_args[1], orig_args[2]}),
+          NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op._vocab_parallel_cross_entropy", VocabParallelCrossEntropyGrad);
+
+Array<Expr> SyncBatchNormTrainGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                   const Var& y, const Expr& dy) {
+  // schema for _sync_batch_norm_train is:
+  //    x, running_mean, running_var, w, b, momentum, eps, rank_list
+  // schema for _sync_batch_norm_train_dxwb is:
+  //    dy, x, w, b, eps, rank_list
+  static auto op_dxwb = Op::Get("raf.op._sync_batch_norm_train_dxwb");
+  const Expr& dy0 = AsTupleExpr(dy, 3)[0];
+  const Expr& ret =
+      Call(op_dxwb, {dy0, orig_args[0], orig_args[3], orig_args[4], orig_args[6], orig_args[7]});
+  return {
+      TupleGetItem(ret, 0), NullValue<Expr>(),    NullValue<Expr>(),
+      TupleGetItem(ret, 1), TupleGetItem(ret, 2),
+  };
+}
+
+RAF_OP_GRAD("raf.op._sync_batch_norm_train", SyncBatchNormTrainGrad);
+
+Array<Expr> AllGatherGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dy) {
+  // NCCL gathers along the first axis, and each rank consumes the gathered tensor differently,
+  // e.g., by a column-parallel matmul, so the gradient of a chunk is summed over the ranks.
+  static auto op_reduce_scatter = Op::Get("raf.op._reduce_scatter");
+  return {Call(op_reduce_scatter,
+               {dy, MakeConstant(value::StringValue::make("sum")), orig_args[2]})};
+}
+
+RAF_OP_GRAD("raf.op._allgather", AllGatherGrad);
+
+Array<Expr> ReduceScatterGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                              const Expr& dy) {
+  static auto op_allgather = Op::Get("raf.op._allgather");
+  return {Call(op_allgather, {dy, MakeConstant(value::ScalarValue::make(0)), orig_args[2]})};
+}
+
+RAF_OP_GRAD("raf.op._reduce_scatter", ReduceScatterGrad);
+
+Array<Expr> SequenceScatterGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                const Var& y, const Expr& dy) {
+  // The replicated input gets the gradients of the chunks of all ranks.
+  static auto op_allgather = Op::Get("raf.op._allgather");
+  return {Call(op_allgather, {dy, MakeConstant(value::ScalarValue::make(0)), orig_args[1]})};
+}
+
+RAF_OP_GRAD("raf.op._sequence_scatter", SequenceScatterGrad);
+
+Array<Expr> SequenceGatherGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                               const Var& y, const Expr& dy) {
+  // The replicated consumer gives the same gradient on all ranks, so each takes its chunk.
+  static auto op_sequence_scatter = Op::Get("raf.op._sequence_scatter");
+  return {Call(op_sequence_scatter, {dy, orig_args[1]})};
+}
+
+RAF_OP_GRAD("raf.op._sequence_gather", SequenceGatherGrad);
+
 }  // namespace grad
 }  // namespace op
 }  // namespace raf
@@ -68,6 +68,18 @@ Array<Expr> CrossEntropyGrad(const Expr& orig_call, const Array<Expr> orig_args,
 
 RAF_OP_GRAD("raf.op.cross_entropy", CrossEntropyGrad);
 
+Array<Expr> SoftmaxCrossEntropyGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                    const Expr& y, const Expr& ograds) {
+  static auto dpred = Op::Get("raf.op.softmax_cross_entropy_dpred");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK_GE(call->args.size(), 2);
+  const Expr& true_ = call->args[0];
+  const Expr& pred = call->args[1];
+  return {NullValue<Expr>(), Call(dpred, {ograds, true_, pred})};
+}
+
+RAF_OP_GRAD("raf.op.softmax_cross_entropy", SoftmaxCrossEntropyGrad);
+
 }  // namespace grad
 }  // namespace op
 }  // namespace raf
@@ -45,6 +45,15 @@ Array<Expr> ContribDropoutGrad(const Expr& orig_call, const Array<Expr> orig_arg
 
 RAF_OP_GRAD("raf.op._contrib_dropout", ContribDropoutGrad);
 
+Array<Expr> CounterDropoutGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                               const Expr& dy) {
+  // The mask is regenerated from the key and the offset instead of being kept for the backward.
+  const static auto dropout_dx = Op::Get("raf.op.counter_dropout_dx");
+  return {Call(dropout_dx, {dy, orig_args[1], orig_args[2], orig_args[3]}), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.counter_dropout", CounterDropoutGrad);
+
 template <const char* GradOp>
 Array<Expr> PoolGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                      const Expr& dy) {
@@ -450,6 +459,135 @@ Array<Expr> LayerNormTrainGrad(const Expr& orig_call, const Array<Expr> orig_arg
 
 RAF_OP_GRAD("raf.op.layer_norm_train", LayerNormTrainGrad);
 
+Array<Expr> AttentionGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                          const Expr& dymv) {
+  static auto op_dx = Op::Get("raf.op.attention_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  const Expr& dy = AsTupleExpr(dymv, 2)[0];
+  const Array<Expr>& args = call->args;
+  // The attention probabilities are recomputed from the log-sum-exp, instead of being kept.
+  auto out = TupleGetItem(y, 0);
+  auto lse = TupleGetItem(y, 1);
+  const Expr& ret =
+      Call(op_dx, {args[0], args[1], args[2], args[3], out, lse, dy, args[4], args[5], args[6],
+                   args[7]});
+  // The mask is not differentiable.
+  return {TupleGetItem(ret, 0), TupleGetItem(ret, 1), TupleGetItem(ret, 2), NullValue<Expr>(),
+          NullValue<Expr>(),    NullValue<Expr>(),    NullValue<Expr>(),    NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.attention", AttentionGrad);
+
+Array<Expr> BlockSparseSddGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                               const Expr& dy) {
+  static auto op_dsd = Op::Get("raf.op.block_sparse_matmul_dsd");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  const Expr& x1 = call->args[0];
+  const Expr& x2 = call->args[1];
+  const Expr& layout = call->args[2];
+  const Expr& block = call->args[3];
+  // The gradients only read the non-zero blocks of dy: dx1 = dy * x2, and dx2 = dy^T * x1.
+  return {Call(op_dsd, {dy, x2, layout, block, MakeConstant(BoolValue::make(false))}),
+          Call(op_dsd, {dy, x1, layout, block, MakeConstant(BoolValue::make(true))}),
+          NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.block_sparse_matmul_sdd", BlockSparseSddGrad);
+
+Array<Expr> BlockSparseDsdGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
+                               const Expr& dy) {
+  static auto op_sdd = Op::Get("raf.op.block_sparse_matmul_sdd");
+  static auto op_dsd = Op::Get("raf.op.block_sparse_matmul_dsd");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  const Expr& a = call->args[0];
+  const Expr& x = call->args[1];
+  const Expr& layout = call->args[2];
+  const Expr& block = call->args[3];
+  const auto* transpose_const = call->args[4].as<ConstantNode>();
+  CHECK(transpose_const && transpose_const->value.defined())
+      << "The gradient of block_sparse_matmul_dsd expects a constant transpose_a";
+  bool transpose_a = transpose_const->value.as<BoolValueObj>()->value;
+  // y = a * x gives da = dy * x^T on the blocks and dx = a^T * dy, and y = a^T * x gives
+  // da = x * dy^T on the blocks and dx = a * dy.
+  Expr da = transpose_a ? Call(op_sdd, {x, dy, layout, block})
+                        : Call(op_sdd, {dy, x, layout, block});
+  Expr dx = Call(op_dsd, {a, dy, layout, block, MakeConstant(BoolValue::make(!transpose_a))});
+  return {da, dx, NullValue<Expr>(), NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.block_sparse_matmul_dsd", BlockSparseDsdGrad);
+
+Array<Expr> BlockSparseSoftmaxGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                   const Var& y, const Expr& dy) {
+  static auto op_dx = Op::Get("raf.op.block_sparse_softmax_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  const Expr& layout = call->args[1];
+  const Expr& block = call->args[2];
+  const Expr& scale = call->args[3];
+  // The inputs masked by causal have the probabilities of 0, so they get no gradient either.
+  return {Call(op_dx, {y, dy, layout, block, scale}), NullValue<Expr>(), NullValue<Expr>(),
+          NullValue<Expr>(), NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.block_sparse_softmax", BlockSparseSoftmaxGrad);
+
+Array<Expr> AddDropoutLayerNormGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                    const Var& y, const Expr& dymv) {
+  static auto op_dx = Op::Get("raf.op.add_dropout_layer_norm_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  const Expr& dy = AsTupleExpr(dymv, 5)[0];
+  const Array<Expr>& args = call->args;
+  auto mean = TupleGetItem(y, 1);
+  auto invvar = TupleGetItem(y, 2);
+  auto pre_norm = TupleGetItem(y, 3);
+  auto mask = TupleGetItem(y, 4);
+  const Expr& ret = Call(op_dx, {dy, pre_norm, args[2], mean, invvar, mask, args[4], args[5]});
+  return {TupleGetItem(ret, 0), TupleGetItem(ret, 1), TupleGetItem(ret, 2), TupleGetItem(ret, 3),
+          NullValue<Expr>(),    NullValue<Expr>(),    NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.add_dropout_layer_norm", AddDropoutLayerNormGrad);
+
+Array<Expr> EmbeddingLayerNormGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                   const Var& y, const Expr& dymv) {
+  static auto op_dx = Op::Get("raf.op.embedding_layer_norm_dx");
+  static auto op_embedding_dx = Op::Get("raf.op.embedding_dx");
+  const CallNode* call = orig_call.as<CallNode>();
+  CHECK(call != nullptr);
+  const Expr& dy = AsTupleExpr(dymv, 5)[0];
+  const Array<Expr>& args = call->args;
+  auto mean = TupleGetItem(y, 1);
+  auto invvar = TupleGetItem(y, 2);
+  auto pre_norm = TupleGetItem(y, 3);
+  auto mask = TupleGetItem(y, 4);
+  const Expr& ret = Call(op_dx, {dy, pre_norm, args[4], mean, invvar, mask, args[8], args[9]});
+  // The gradient of the sum is scattered to each table by embedding_dx.
+  Expr dsum = TupleGetItem(ret, 0);
+  auto table_grad = [&](int table) {
+    return Call(op_embedding_dx, {dsum, args[table + 1], GetShape(args[table])});
+  };
+  const auto* token_type = args[6].as<ConstantNode>();
+  bool has_token_type = !(token_type && !token_type->value.defined());
+  return {table_grad(0),
+          NullValue<Expr>(),
+          table_grad(2),
+          NullValue<Expr>(),
+          TupleGetItem(ret, 1),
+          TupleGetItem(ret, 2),
+          has_token_type ? table_grad(6) : NullValue<Expr>(),
+          NullValue<Expr>(),
+          NullValue<Expr>(),
+          NullValue<Expr>(),
+          NullValue<Expr>()};
+}
+
+RAF_OP_GRAD("raf.op.embedding_layer_norm", EmbeddingLayerNormGrad);
+
 Array<Expr> ReciprocalGrad(const Expr& orig_call, const Array<Expr> orig_args, const Var& y,
                            const Expr& dy) {
   static auto op_div = Op::Get("raf.op.divide");
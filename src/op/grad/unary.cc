@@ -18,6 +18,14 @@ using namespace raf::ir;
 RAF_OP_GRAD("raf.op.numel", NoGrads<1>);
 RAF_OP_GRAD("raf.op.shape_as_tensor", NoGrads<1>);
 
+Array<Expr> CheckpointBoundaryGrad(const Expr& orig_call, const Array<Expr> orig_args,
+                                   const Var& y, const Expr& dy) {
+  // The boundary is an alias of its input.
+  return {dy};
+}
+
+RAF_OP_GRAD("raf.op.checkpoint_boundary", CheckpointBoundaryGrad);
+
 }  // namespace grad
 }  // namespace op
 }  // namespace raf
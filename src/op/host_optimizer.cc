@@ -0,0 +1,345 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/op/host_optimizer.cc
+ * \brief Adam and AdamW on the host, which update the optimizer states offloaded to the (pinned)
+ * host memory with the threads of the TVM runtime.
+ */
+#include <tvm/runtime/c_backend_api.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "./schema/optimizer.h"
+#include "raf/op.h"
+#include "raf/value.h"
+#include "raf/device_api.h"
+
+namespace raf {
+namespace op {
+
+using namespace raf::ir;
+using namespace raf::value;
+using device_api::DeviceAPI;
+
+/*! \brief The number of elements updated by a task at a time. */
+constexpr int64_t kHostAdamChunkSize = 16384;
+
+inline float HalfToFloat(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+  uint32_t bits;
+  if (exp == 0x1f) {
+    bits = sign | 0x7f800000 | (mant << 13);
+  } else if (exp != 0) {
+    bits = sign | ((exp + 112) << 23) | (mant << 13);
+  } else if (mant == 0) {
+    bits = sign;
+  } else {
+    // Normalize the subnormal half.
+    exp = 113;
+    while ((mant & 0x400) == 0) {
+      mant <<= 1;
+      --exp;
+    }
+    bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+  }
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+inline uint16_t FloatToHalf(float f) {
+  uint32_t bits;
+  std::memcpy(&bits, &f, sizeof(bits));
+  uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  uint32_t abs = bits & 0x7fffffff;
+  if (abs >= 0x47800000) {
+    // Inf, nan, or too large for half.
+    return sign | (abs > 0x7f800000 ? 0x7e00 : 0x7c00);
+  }
+  if (abs < 0x38800000) {
+    // Subnormal or zero, which the float addition of 0.5 rounds to the nearest even.
+    uint32_t magic_bits = 0x3f000000;
+    float magic, af;
+    std::memcpy(&magic, &magic_bits, sizeof(magic));
+    std::memcpy(&af, &abs, sizeof(af));
+    af += magic;
+    uint32_t rounded;
+    std::memcpy(&rounded, &af, sizeof(rounded));
+    return sign | static_cast<uint16_t>(rounded - magic_bits);
+  }
+  uint32_t mant_odd = (abs >> 13) & 1;
+  abs += 0xc8000fff + mant_odd;  // Rebias the exponent and round to the nearest even.
+  return sign | static_cast<uint16_t>(abs >> 13);
+}
+
+inline float BFloat16ToFloat(uint16_t h) {
+  uint32_t bits = static_cast<uint32_t>(h) << 16;
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+inline uint16_t FloatToBFloat16(float f) {
+  uint32_t bits;
+  std::memcpy(&bits, &f, sizeof(bits));
+  if ((bits & 0x7fffffff) > 0x7f800000) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+/*! \brief Whether the host Adam reads and writes the dtype, i.e., float32, float16, bfloat16. */
+inline bool IsHostAdamDType(DLDataType dtype) {
+  if (dtype.lanes != 1) {
+    return false;
+  }
+  return (dtype.code == kDLFloat && (dtype.bits == 32 || dtype.bits == 16)) ||
+         (dtype.code == kDLBfloat && dtype.bits == 16);
+}
+
+/*! \brief Load n values of dtype to floats. */
+inline void LoadFloats(const void* src, DLDataType dtype, int64_t n, float* dst) {
+  if (dtype.bits == 32) {
+    std::memcpy(dst, src, n * sizeof(float));
+    return;
+  }
+  const uint16_t* h = static_cast<const uint16_t*>(src);
+  if (dtype.code == kDLBfloat) {
+    for (int64_t i = 0; i < n; ++i) {
+      dst[i] = BFloat16ToFloat(h[i]);
+    }
+  } else {
+    for (int64_t i = 0; i < n; ++i) {
+      dst[i] = HalfToFloat(h[i]);
+    }
+  }
+}
+
+/*! \brief Store n floats as dtype. */
+inline void StoreFloats(const float* src, int64_t n, DLDataType dtype, void* dst) {
+  if (dtype.bits == 32) {
+    std::memcpy(dst, src, n * sizeof(float));
+    return;
+  }
+  uint16_t* h = static_cast<uint16_t*>(dst);
+  if (dtype.code == kDLBfloat) {
+    for (int64_t i = 0; i < n; ++i) {
+      h[i] = FloatToBFloat16(src[i]);
+    }
+  } else {
+    for (int64_t i = 0; i < n; ++i) {
+      h[i] = FloatToHalf(src[i]);
+    }
+  }
+}
+
+/*!
+ * \brief The Adam step of a chunk in float32. The loop has no branches or aliasing, so that the
+ * compiler vectorizes it.
+ */
+inline void AdamChunk(const float* __restrict__ g, float* __restrict__ w, float* __restrict__ m,
+                      float* __restrict__ v, int64_t n, float lr, float beta1, float beta2,
+                      float eps, float l2_decay, float decoupled_decay, float inv_grad_scale,
+                      float inv_bias_correction1, float inv_sqrt_bias_correction2) {
+  for (int64_t i = 0; i < n; ++i) {
+    float weight = w[i];
+    float grad = g[i] * inv_grad_scale + l2_decay * weight;
+    float next_m = beta1 * m[i] + (1.0f - beta1) * grad;
+    float next_v = beta2 * v[i] + (1.0f - beta2) * grad * grad;
+    float denom = std::sqrt(next_v) * inv_sqrt_bias_correction2 + eps;
+    float update = next_m * inv_bias_correction1 / denom + decoupled_decay * weight;
+    w[i] = weight - lr * update;
+    m[i] = next_m;
+    v[i] = next_v;
+  }
+}
+
+/*!
+ * \brief Adam and AdamW of the tensors in the host memory, e.g., the fp32 master weights and the
+ * moments offloaded to the pinned memory, which are updated in place. The chunks of all the
+ * tensors are spread over the threads of the TVM runtime, whose number is set by TVM_NUM_THREADS.
+ * It supports the same tensor lists as the CUDA kernels except the dynamic loss scaler, and it
+ * falls back to the dialects for the tensors on the devices.
+ */
+class HostAdamOpEnv : public raf::op::OpEnv {
+ public:
+  explicit HostAdamOpEnv(const CallValues& cv, bool adamw) : adamw_(adamw) {
+    static auto fschema_index =
+        ir::Op::GetAttrMap<op::FRAFSchemaFieldIndex>("FRAFSchemaFieldIndex");
+    static auto adam_op = ir::Op::Get("raf.op.adam");
+    auto args = cv->args.as<op::schema::AdamArgs>();
+    this->arg_indices = {
+        fschema_index[adam_op]("tensor_list"),
+        fschema_index[adam_op]("step"),
+    };
+    auto dev_type = cv->device.device_type();
+    if (dev_type != DevType::kCPU() && dev_type != DevType::kCUDAHost()) {
+      this->error_msgs.push_back("[Host] Adam only updates the tensors in the host memory");
+      return;
+    }
+    pinned_ = dev_type == DevType::kCUDAHost();
+    if (args->dynamic_loss_scale) {
+      this->error_msgs.push_back("[Host] Adam does not support the dynamic loss scaling");
+      return;
+    }
+    if (args->quantize_states) {
+      this->error_msgs.push_back("[Host] Adam does not support the 8-bit states");
+      return;
+    }
+    const DLTensor* step = args->step;
+    if (step->ndim != 0 || step->dtype.code != kDLFloat || step->dtype.bits != 32 ||
+        (step->device.device_type != kDLCPU && step->device.device_type != kDLCUDAHost)) {
+      this->error_msgs.push_back("[Host] Adam expects a float32 scalar step on the host");
+      return;
+    }
+    learning_rate_ = args->learning_rate;
+    beta1_ = args->beta1;
+    beta2_ = args->beta2;
+    eps_ = args->eps;
+    weight_decay_ = args->weight_decay;
+    bias_correction_ = args->bias_correction;
+    inv_grad_scale_ = 1.0f / args->grad_scale;
+    mixed_precision_ = args->mixed_precision;
+
+    int ngroups = mixed_precision_ ? 5 : 4;
+    int ntensors = args->tensor_list.size() / ngroups;
+    const DLTensor* g0 = args->tensor_list[0];
+    grad_dtype_ = g0->dtype;
+    copy_dtype_ = grad_dtype_;
+    if (mixed_precision_) {
+      const DLTensor* copy0 = args->tensor_list[4 * ntensors];
+      copy_dtype_ = copy0->dtype;
+    }
+    if (!IsHostAdamDType(grad_dtype_) || !IsHostAdamDType(copy_dtype_)) {
+      this->error_msgs.push_back("[Host] Adam supports float32, float16 and bfloat16");
+      return;
+    }
+    for (int i = 0; i < ntensors; ++i) {
+      const DLTensor* g = args->tensor_list[i];
+      const DLTensor* copy = mixed_precision_ ? args->tensor_list[4 * ntensors + i] : g;
+      CHECK(DType(g->dtype) == DType(grad_dtype_)) << "Adam expects the same gradient dtype";
+      CHECK(DType(copy->dtype) == DType(copy_dtype_))
+          << "Adam expects the same dtype of the weight copies";
+      int64_t numel = 1;
+      for (int j = 0; j < g->ndim; ++j) {
+        numel *= g->shape[j];
+      }
+      for (int64_t offset = 0; offset < numel; offset += kHostAdamChunkSize) {
+        chunks_.push_back({i, offset, std::min(kHostAdamChunkSize, numel - offset)});
+      }
+    }
+    ntensors_ = ntensors;
+  }
+
+  void Execute(const CallValues& cv) override {
+    auto args = cv->args.as<op::schema::AdamArgs>();
+    Array<Value> tvalue = {args->tensor_list.begin(), args->tensor_list.end()};
+    Value tuple = TupleValue::make(tvalue);
+    Execute(std::vector<Value>{tuple, args->step}, cv->out);
+  }
+
+  void Execute(const std::vector<Value>& inputs, Value output) override {
+    TupleValue tuple = ir::Downcast<TupleValue>(inputs[0]);
+    DLTensor* step = ir::Downcast<TensorValue>(inputs[1]);
+    if (pinned_) {
+      // The gradients and the step may be still copied to the pinned memory on the stream.
+      static auto cuda_device_api = DeviceAPI::Get(DevType::kCUDA());
+      cuda_device_api->WaitStream(cuda_device_api->GetStream());
+    }
+    data_.clear();
+    for (const auto& field : tuple->fields) {
+      DLTensor* tensor = ir::Downcast<TensorValue>(field);
+      data_.push_back(tensor->data);
+    }
+    double t = *static_cast<const float*>(step->data);
+    double bias_correction1 = bias_correction_ ? 1.0 - std::pow(beta1_, t) : 1.0;
+    double bias_correction2 = bias_correction_ ? 1.0 - std::pow(beta2_, t) : 1.0;
+    inv_bias_correction1_ = static_cast<float>(1.0 / bias_correction1);
+    inv_sqrt_bias_correction2_ = static_cast<float>(1.0 / std::sqrt(bias_correction2));
+    if (!chunks_.empty()) {
+      CHECK_EQ(TVMBackendParallelLaunch(RunTask, this, 0), 0) << "Failed to launch host Adam";
+    }
+  }
+
+  std::string name() const override {
+    return TruncateName(GetUniqueName(adamw_ ? "raf.op.host.adamw" : "raf.op.host.adam"));
+  }
+
+  static OpEnv* make(const CallValues& cv) {
+    return new HostAdamOpEnv(cv, false);
+  }
+
+  static OpEnv* make_adamw(const CallValues& cv) {
+    return new HostAdamOpEnv(cv, true);
+  }
+
+ private:
+  /*! \brief The elements [offset, offset + n) of a tensor. */
+  struct Chunk {
+    int tensor;
+    int64_t offset;
+    int64_t n;
+  };
+
+  /*! \brief Each task updates every num_task-th chunk. */
+  static int RunTask(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+    auto self = static_cast<const HostAdamOpEnv*>(cdata);
+    std::vector<float> grad(kHostAdamChunkSize);
+    for (size_t c = task_id; c < self->chunks_.size(); c += penv->num_task) {
+      self->RunChunk(self->chunks_[c], grad.data());
+    }
+    return 0;
+  }
+
+  void RunChunk(const Chunk& chunk, float* grad) const {
+    int i = chunk.tensor;
+    int64_t grad_bytes = (grad_dtype_.bits + 7) / 8;
+    int64_t copy_bytes = (copy_dtype_.bits + 7) / 8;
+    const void* g = static_cast<const uint8_t*>(data_[i]) + chunk.offset * grad_bytes;
+    float* w = static_cast<float*>(data_[ntensors_ + i]) + chunk.offset;
+    float* m = static_cast<float*>(data_[2 * ntensors_ + i]) + chunk.offset;
+    float* v = static_cast<float*>(data_[3 * ntensors_ + i]) + chunk.offset;
+    LoadFloats(g, grad_dtype_, chunk.n, grad);
+    AdamChunk(grad, w, m, v, chunk.n, learning_rate_, beta1_, beta2_, eps_,
+              adamw_ ? 0.0f : weight_decay_, adamw_ ? weight_decay_ : 0.0f, inv_grad_scale_,
+              inv_bias_correction1_, inv_sqrt_bias_correction2_);
+    if (mixed_precision_) {
+      void* copy = static_cast<uint8_t*>(data_[4 * ntensors_ + i]) + chunk.offset * copy_bytes;
+      StoreFloats(w, chunk.n, copy_dtype_, copy);
+    }
+  }
+
+  bool adamw_;
+  /*! \brief Whether the tensors are in the pinned memory, which the CUDA streams copy to. */
+  bool pinned_ = false;
+  float learning_rate_ = 0;
+  float beta1_ = 0;
+  float beta2_ = 0;
+  float eps_ = 0;
+  float weight_decay_ = 0;
+  bool bias_correction_ = true;
+  float inv_grad_scale_ = 1;
+  bool mixed_precision_ = false;
+  /*! \brief The dtypes of the gradients and the weight copies. */
+  DLDataType grad_dtype_;
+  DLDataType copy_dtype_;
+  int ntensors_ = 0;
+  std::vector<Chunk> chunks_;
+  /*! \brief The data of the tensor list and the bias corrections of the running step. */
+  std::vector<void*> data_;
+  float inv_bias_correction1_ = 1;
+  float inv_sqrt_bias_correction2_ = 1;
+};
+
+RAF_OP_ENV_MAKER("raf.op.adam", HostAdamOpEnv::make);
+RAF_OP_ENV_MAKER("raf.op.adamw", HostAdamOpEnv::make_adamw);
+
+}  // namespace op
+}  // namespace raf
@@ -53,6 +53,26 @@ Type LogicalBroadcastInfer(const CallValues& value) {
 }
 
 RAF_OP_TYPE("raf.op.add", "BroadcastUfunc", BroadcastUfuncInfer);
+
+Type AddNInfer(const CallValues& value) {
+  const auto* args = value->args.as<AddNArgs>();
+  CHECK(args != nullptr);
+  CHECK_GE(args->x.size(), 1U);
+  TensorType x0 = Downcast<TensorType>(GetType(args->x[0]));
+  for (const auto& i : args->x) {
+    TensorType xi = Downcast<TensorType>(GetType(i));
+    CHECK_EQ(xi->dtype, x0->dtype) << "Data types mismatch (" << xi->dtype << " vs "
+                                   << x0->dtype << ")";
+    CHECK_EQ(xi->shape.size(), x0->shape.size()) << "add_n expects the inputs of the same shape";
+    for (size_t k = 0; k < x0->shape.size(); ++k) {
+      CHECK(TypeCheckCompare(xi->shape[k], x0->shape[k], std::equal_to<int>()))
+          << "add_n expects the inputs of the same shape";
+    }
+  }
+  return x0;
+}
+
+RAF_OP_TYPE("raf.op.add_n", "AddN", AddNInfer);
 RAF_OP_TYPE("raf.op.subtract", "BroadcastUfunc", BroadcastUfuncInfer);
 RAF_OP_TYPE("raf.op.multiply", "Broadcast", BroadcastInfer);
 RAF_OP_TYPE("raf.op.divide", "Broadcast", BroadcastInfer);
@@ -77,6 +77,54 @@ Type TensorIdentityType(const CallValues& value) {
 }
 
 RAF_OP_TYPE("raf.op._all_to_all", "NCCLAllToAll", TensorIdentityType<AllToAllArgs>);
+Type AllToAllvInfer(const CallValues& value) {
+  const auto* args = value->args.as<AllToAllvArgs>();
+  CHECK(args != nullptr);
+  return TupleType({GetType(args->x), GetType(args->send_counts)});
+}
+
+RAF_OP_TYPE("raf.op._all_to_allv", "NCCLAllToAllv", AllToAllvInfer);
+
+Type VocabParallelCrossEntropyInfer(const CallValues& value) {
+  const auto* args = value->args.as<VocabParallelCrossEntropyArgs>();
+  CHECK(args != nullptr);
+  TensorType pred = Downcast<TensorType>(GetType(args->y_pred));
+  return TensorType({1}, pred->dtype);
+}
+
+RAF_OP_TYPE("raf.op._vocab_parallel_cross_entropy", "NCCLVocabParallelCrossEntropy",
+            VocabParallelCrossEntropyInfer);
+
+Type VocabParallelCrossEntropyDpredInfer(const CallValues& value) {
+  const auto* args = value->args.as<VocabParallelCrossEntropyDpredArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->y_pred);
+}
+
+RAF_OP_TYPE("raf.op._vocab_parallel_cross_entropy_dpred", "NCCLVocabParallelCrossEntropyDpred",
+            VocabParallelCrossEntropyDpredInfer);
+
+Type SyncBatchNormTrainInfer(const CallValues& value) {
+  const auto* args = value->args.as<SyncBatchNormArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType running_mean = Downcast<TensorType>(GetType(args->running_mean));
+  TensorType running_var = Downcast<TensorType>(GetType(args->running_var));
+  return TupleType({x, running_mean, running_var});
+}
+
+RAF_OP_TYPE("raf.op._sync_batch_norm_train", "NCCLSyncBatchNormTrain", SyncBatchNormTrainInfer);
+
+Type SyncBatchNormTrainDxwbInfer(const CallValues& value) {
+  const auto* args = value->args.as<SyncBatchNormDxwbArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->w));
+  return TupleType({x, w, w});
+}
+
+RAF_OP_TYPE("raf.op._sync_batch_norm_train_dxwb", "NCCLSyncBatchNormTrainDxwb",
+            SyncBatchNormTrainDxwbInfer);
 RAF_OP_TYPE("raf.op._broadcast", "NCCLBroadcast", TensorIdentityType<BroadcastArgs>);
 RAF_OP_TYPE("raf.op._reduce", "NCCLReduce", TensorIdentityType<CommReduceArgs>);
 
@@ -181,5 +229,30 @@ Type GroupAllGatherInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op._group_allgather", "NCCLGroupAllGather", GroupAllGatherInfer);
 
+template <bool scatter>
+Type SequenceParallelInfer(const CallValues& value) {
+  const auto* args = value->args.as<SequenceParallelArgs>();
+  CHECK(args != nullptr);
+  int size;
+  if (args->rank_list.defined()) {
+    size = Communicator::Get("void", args->rank_list)->size;
+  } else {
+    size = GetGlobalCommunicator()->size;
+  }
+  auto ttype = GetType(args->x).as<TensorTypeNode>();
+  auto shape = ttype->shape;
+  auto old_size = shape[0].as<IntImmNode>()->value;
+  if (scatter) {
+    CHECK(old_size % size == 0);
+    shape.Set(0, Integer(old_size / size));
+  } else {
+    shape.Set(0, Integer(old_size * size));
+  }
+  return TensorType(shape, DataType(ttype->dtype));
+}
+
+RAF_OP_TYPE("raf.op._sequence_scatter", "NCCLSequenceScatter", SequenceParallelInfer<true>);
+RAF_OP_TYPE("raf.op._sequence_gather", "NCCLSequenceGather", SequenceParallelInfer<false>);
+
 }  // namespace op
 }  // namespace raf
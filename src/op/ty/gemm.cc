@@ -10,6 +10,7 @@
 #include <tvm/relay/type.h>
 #include "raf/type.h"
 #include "../schema/ufunc.h"
+#include "../schema/nn.h"
 #include "./utils.h"
 
 namespace raf {
@@ -18,6 +19,7 @@ namespace op {
 using namespace raf::ir;
 using namespace raf::value;
 using schema::BinaryArgs;
+using schema::GroupedMatmulArgs;
 
 template <bool transpose_a, bool transpose_b>
 Type MatmulInfer(const CallValues& value) {
@@ -81,5 +83,43 @@ RAF_OP_TYPE("raf.op.batch_matmul_nt", "BatchMatmulNT", (BatchMatmulInfer<false,
 RAF_OP_TYPE("raf.op.batch_matmul_tn", "BatchMatmulTN", (BatchMatmulInfer<true, false>));
 RAF_OP_TYPE("raf.op.batch_matmul_tt", "BatchMatmulTT", (BatchMatmulInfer<true, true>));
 
+/*! \brief The int8 GEMMs have the shapes of the float GEMMs, and the int32 outputs. */
+template <Type (*ShapeInfer)(const CallValues& value)>
+Type QnnGemmInfer(const CallValues& value) {
+  const auto* args = value->args.as<BinaryArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x1));
+  TensorType y = Downcast<TensorType>(GetType(args->x2));
+  CHECK(x->dtype == DataType::Int(8) && y->dtype == DataType::Int(8))
+      << "QnnGemm: expects int8 operands, but got " << x << " and " << y;
+  TensorType ty = Downcast<TensorType>(ShapeInfer(value));
+  return TensorType(ty->shape, DataType::Int(32));
+}
+
+RAF_OP_TYPE("raf.op.qnn_dense", "QnnDense", (QnnGemmInfer<MatmulInfer<false, true>>));
+RAF_OP_TYPE("raf.op.qnn_batch_matmul_nt", "QnnBatchMatmulNT",
+            (QnnGemmInfer<BatchMatmulInfer<false, true>>));
+
+Type GroupedMatmulInfer(const CallValues& value) {
+  const auto* args = value->args.as<GroupedMatmulArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->weight));
+  TensorType group_sizes = Downcast<TensorType>(GetType(args->group_sizes));
+  CHECK(x->shape.size() == 2 && w->shape.size() == 3 && group_sizes->shape.size() == 1)
+      << "GroupedMatmul: expects x of [T, K], weight of [G, K, N] and group_sizes of [G], but got "
+      << x << ", " << w << " and " << group_sizes;
+  CHECK(TypeCheckCompare(x->shape[1], w->shape[1], std::equal_to<int>()))
+      << "GroupedMatmul: shapes of x and weight is inconsistent, "
+      << " x shape=" << x->shape << ", weight shape=" << w->shape;
+  CHECK(TypeCheckCompare(w->shape[0], group_sizes->shape[0], std::equal_to<int>()))
+      << "GroupedMatmul: the number of groups of weight and group_sizes is inconsistent, "
+      << " weight shape=" << w->shape << ", group_sizes shape=" << group_sizes->shape;
+  Array<tvm::PrimExpr> oshape = {x->shape[0], w->shape[2]};
+  return TensorType(oshape, x->dtype);
+}
+
+RAF_OP_TYPE("raf.op.grouped_matmul", "GroupedMatmul", GroupedMatmulInfer);
+
 }  // namespace op
 }  // namespace raf
@@ -73,6 +73,8 @@ RAF_OP_TYPE("raf.op.smooth_l1_loss_dtrue", "SmoothL1Dtrue", SmoothL1Back);
 RAF_OP_TYPE("raf.op.cross_entropy", "CrossEntropy", NLLLossInfer);
 RAF_OP_TYPE("raf.op.cross_entropy_dpred", "CrossEntropyDpred", NLLLossBack);
 RAF_OP_TYPE("raf.op.cross_entropy_dtrue", "CrossEntropyDtrue", NLLLossBack);
+RAF_OP_TYPE("raf.op.softmax_cross_entropy", "SoftmaxCrossEntropy", NLLLossInfer);
+RAF_OP_TYPE("raf.op.softmax_cross_entropy_dpred", "SoftmaxCrossEntropyDpred", NLLLossBack);
 
 }  // namespace op
 }  // namespace raf
@@ -81,6 +81,37 @@ Type Conv2DInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.conv2d", "Conv2d", Conv2DInfer);
 
+Type QnnConv2DInfer(const CallValues& value) {
+  const auto* args = value->args.as<ConvArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  TensorType w = Downcast<TensorType>(GetType(args->w));
+  CHECK(x->dtype == DataType::Int(8) && w->dtype == DataType::Int(8))
+      << "QnnConv2d: expects int8 operands, but got " << x << " and " << w;
+  TensorType ty = Downcast<TensorType>(Conv2DInfer(value));
+  return TensorType(ty->shape, DataType::Int(32));
+}
+
+RAF_OP_TYPE("raf.op.qnn_conv2d", "QnnConv2d", QnnConv2DInfer);
+
+Type QuantizeInfer(const CallValues& value) {
+  const auto* args = value->args.as<QuantizeArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  return TensorType(x->shape, DataType(ir::String2DLDataType(args->dtype)));
+}
+
+RAF_OP_TYPE("raf.op.quantize", "Quantize", QuantizeInfer);
+
+Type DequantizeInfer(const CallValues& value) {
+  const auto* args = value->args.as<DequantizeArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  return TensorType(x->shape, DataType(ir::String2DLDataType(args->dtype)));
+}
+
+RAF_OP_TYPE("raf.op.dequantize", "Dequantize", DequantizeInfer);
+
 Type Conv2DTransInfer(const CallValues& value) {
   const auto* args = value->args.as<ConvTransArgs>();
   CHECK(args != nullptr);
@@ -334,6 +365,22 @@ Type ContribDropoutDxInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op._contrib_dropout_dx", "ContribDropoutDx", ContribDropoutDxInfer);
 
+Type CounterDropoutInfer(const CallValues& value) {
+  const auto* args = value->args.as<CounterDropoutArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->x);
+}
+
+RAF_OP_TYPE("raf.op.counter_dropout", "CounterDropout", CounterDropoutInfer);
+
+Type CounterDropoutDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<CounterDropoutDxArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->dy);
+}
+
+RAF_OP_TYPE("raf.op.counter_dropout_dx", "CounterDropoutDx", CounterDropoutDxInfer);
+
 RAF_OP_TYPE("raf.op.layer_norm", "LayerNorm", GeneralAxisInfer<LayerNormArgs>);
 
 Type LayerNormDxbInfer(const CallValues& value) {
@@ -444,5 +491,137 @@ Type LayerNormTrainDxbInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.layer_norm_train_dx", "LayerNormTrainDx", LayerNormTrainDxbInfer);
 
+Type AttentionInfer(const CallValues& value) {
+  const auto* args = value->args.as<AttentionArgs>();
+  CHECK(args != nullptr);
+  TensorType q = Downcast<TensorType>(GetType(args->q));
+  Array<PrimExpr> shape(q->shape.begin(), q->shape.end() - 1);
+  TensorType lse = TensorType(shape, DataType(ir::String2DLDataType("float32")));
+  return TupleType({q, lse});
+}
+
+RAF_OP_TYPE("raf.op.attention", "Attention", AttentionInfer);
+
+Type AttentionDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<AttentionDxArgs>();
+  CHECK(args != nullptr);
+  return TupleType({GetType(args->q), GetType(args->k), GetType(args->v)});
+}
+
+RAF_OP_TYPE("raf.op.attention_dx", "AttentionDx", AttentionDxInfer);
+
+Type PagedAttentionInfer(const CallValues& value) {
+  const auto* args = value->args.as<PagedAttentionArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->q);
+}
+
+RAF_OP_TYPE("raf.op.paged_attention", "PagedAttention", PagedAttentionInfer);
+
+Type BlockSparseSddInfer(const CallValues& value) {
+  const auto* args = value->args.as<BlockSparseSddArgs>();
+  CHECK(args != nullptr);
+  TensorType x1 = Downcast<TensorType>(GetType(args->x1));
+  CHECK_EQ(x1->shape.size(), 3) << "block_sparse_matmul_sdd expects x1 of (batch, m, k)";
+  BlockSparseShape shape = GetBlockSparseShape(args->layout, args->block);
+  Array<PrimExpr> oshape{x1->shape[0], Integer(shape.nnz), Integer(args->block),
+                         Integer(args->block)};
+  return TensorType(oshape, x1->dtype);
+}
+
+RAF_OP_TYPE("raf.op.block_sparse_matmul_sdd", "BlockSparseMatmulSdd", BlockSparseSddInfer);
+
+Type BlockSparseDsdInfer(const CallValues& value) {
+  const auto* args = value->args.as<BlockSparseDsdArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  CHECK_EQ(x->shape.size(), 3) << "block_sparse_matmul_dsd expects x of (batch, r, k)";
+  BlockSparseShape shape = GetBlockSparseShape(args->layout, args->block);
+  int64_t outer = args->transpose_a ? shape.cols : shape.rows;
+  Array<PrimExpr> oshape{x->shape[0], Integer(outer * args->block), x->shape[2]};
+  return TensorType(oshape, x->dtype);
+}
+
+RAF_OP_TYPE("raf.op.block_sparse_matmul_dsd", "BlockSparseMatmulDsd", BlockSparseDsdInfer);
+
+Type BlockSparseSoftmaxInfer(const CallValues& value) {
+  const auto* args = value->args.as<BlockSparseSoftmaxArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->x);
+}
+
+RAF_OP_TYPE("raf.op.block_sparse_softmax", "BlockSparseSoftmax", BlockSparseSoftmaxInfer);
+
+Type BlockSparseSoftmaxDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<BlockSparseSoftmaxDxArgs>();
+  CHECK(args != nullptr);
+  return GetType(args->y);
+}
+
+RAF_OP_TYPE("raf.op.block_sparse_softmax_dx", "BlockSparseSoftmaxDx", BlockSparseSoftmaxDxInfer);
+
+Type AddDropoutLayerNormInfer(const CallValues& value) {
+  const auto* args = value->args.as<AddDropoutLayerNormArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  PrimExpr n = Integer(1);
+  for (size_t i = 0; i + 1 < x->shape.size(); ++i) {
+    n *= x->shape[i];
+  }
+  TensorType mean = TensorType({n}, DataType(ir::String2DLDataType("float32")));
+  Array<PrimExpr> mask_shape;
+  if (args->p > 0) {
+    mask_shape = x->shape;
+  }
+  TensorType mask = TensorType(mask_shape, DataType::UInt(8));
+  return TupleType({x, mean, mean, x, mask});
+}
+
+RAF_OP_TYPE("raf.op.add_dropout_layer_norm", "AddDropoutLayerNorm", AddDropoutLayerNormInfer);
+
+Type AddDropoutLayerNormDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<AddDropoutLayerNormDxArgs>();
+  CHECK(args != nullptr);
+  Type dx = GetType(args->dy);
+  Type dscale = GetType(args->scale);
+  return TupleType({dx, dx, dscale, dscale});
+}
+
+RAF_OP_TYPE("raf.op.add_dropout_layer_norm_dx", "AddDropoutLayerNormDx",
+            AddDropoutLayerNormDxInfer);
+
+Type EmbeddingLayerNormInfer(const CallValues& value) {
+  const auto* args = value->args.as<EmbeddingLayerNormArgs>();
+  CHECK(args != nullptr);
+  TensorType word = Downcast<TensorType>(GetType(args->word));
+  TensorType ids = Downcast<TensorType>(GetType(args->word_ids));
+  CHECK_EQ(word->shape.size(), 2) << "embedding_layer_norm expects the tables of (num, hidden)";
+  PrimExpr n = Integer(1);
+  for (const auto& dim : ids->shape) {
+    n *= dim;
+  }
+  Array<PrimExpr> shape = ids->shape;
+  shape.push_back(word->shape[1]);
+  TensorType y = TensorType(shape, word->dtype);
+  TensorType mean = TensorType({n}, DataType(ir::String2DLDataType("float32")));
+  Array<PrimExpr> mask_shape;
+  if (args->p > 0) {
+    mask_shape = shape;
+  }
+  TensorType mask = TensorType(mask_shape, DataType::UInt(8));
+  return TupleType({y, mean, mean, y, mask});
+}
+
+RAF_OP_TYPE("raf.op.embedding_layer_norm", "EmbeddingLayerNorm", EmbeddingLayerNormInfer);
+
+Type EmbeddingLayerNormDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<AddDropoutLayerNormDxArgs>();
+  CHECK(args != nullptr);
+  Type dscale = GetType(args->scale);
+  return TupleType({GetType(args->dy), dscale, dscale});
+}
+
+RAF_OP_TYPE("raf.op.embedding_layer_norm_dx", "EmbeddingLayerNormDx", EmbeddingLayerNormDxInfer);
+
 }  // namespace op
 }  // namespace raf
@@ -39,11 +39,30 @@ Type SgdInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.sgd", "Sgd", SgdInfer);
 
+Type SparseSgdInfer(const CallValues& value) {
+  const auto* args = value->args.as<SparseSgdArgs>();
+  CHECK(args != nullptr);
+  TensorType x0 = Downcast<TensorType>(GetType(args->x));
+  TensorType rows = Downcast<TensorType>(GetType(args->rows));
+  TensorType values = Downcast<TensorType>(GetType(args->values));
+  TensorType v0 = Downcast<TensorType>(GetType(args->v));
+  CHECK_EQ(rows->shape.size(), 1);
+  CHECK_EQ(values->shape.size(), x0->shape.size());
+  CHECK_EQ(v0->shape.size(), x0->shape.size());
+  CHECK(TypeCheckCompare(values->shape[0], rows->shape[0], std::equal_to<int>()));
+  for (size_t i = 0; i < x0->shape.size(); ++i) {
+    CHECK(i == 0 || TypeCheckCompare(values->shape[i], x0->shape[i], std::equal_to<int>()));
+    CHECK(TypeCheckCompare(v0->shape[i], x0->shape[i], std::equal_to<int>()));
+  }
+  return TupleType({v0, x0});
+}
+
+RAF_OP_TYPE("raf.op.sparse_sgd", "SparseSgd", SparseSgdInfer);
+
 Type LansInfer(const CallValues& value) {
   const auto* args = value->args.as<LansArgs>();
   CHECK(args != nullptr);
-  int ntensors = args->tensor_list.size() / 4;
-  CHECK(args->tensor_list.size() % 4 == 0);
+  CHECK(args->tensor_list.size() % (args->quantize_states ? 5 : 4) == 0);
   Array<Type> res;
   for (int i = 0; i < args->tensor_list.size(); ++i) {
     res.push_back(Downcast<TensorType>(GetType(args->tensor_list[i])));
@@ -53,5 +72,56 @@ Type LansInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.lans", "Lans", LansInfer);
 
+Type AdamInfer(const CallValues& value) {
+  const auto* args = value->args.as<AdamArgs>();
+  CHECK(args != nullptr);
+  int nlist = static_cast<int>(args->tensor_list.size()) - (args->dynamic_loss_scale ? 1 : 0);
+  CHECK(nlist % (4 + args->mixed_precision + args->quantize_states) == 0);
+  Array<Type> res;
+  for (const auto& t : args->tensor_list) {
+    res.push_back(Downcast<TensorType>(GetType(t)));
+  }
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.adam", "Adam", AdamInfer);
+RAF_OP_TYPE("raf.op.adamw", "AdamW", AdamInfer);
+
+Type MultiTensorScaleInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorScaleArgs>();
+  CHECK(args != nullptr);
+  Array<Type> res;
+  for (const auto& t : args->tensor_list) {
+    TensorType x = Downcast<TensorType>(GetType(t));
+    DataType dtype = args->dtype.empty() ? x->dtype : DataType(String2DLDataType(args->dtype));
+    res.push_back(TensorType(x->shape, dtype));
+  }
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_scale", "MultiTensorScale", MultiTensorScaleInfer);
+
+Type MultiTensorL2normInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorL2normArgs>();
+  CHECK(args != nullptr);
+  return TensorType({}, DataType::Float(32));
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_l2norm", "MultiTensorL2norm", MultiTensorL2normInfer);
+
+Type MultiTensorClipByGlobalNormInfer(const CallValues& value) {
+  const auto* args = value->args.as<MultiTensorClipByGlobalNormArgs>();
+  CHECK(args != nullptr);
+  Array<Type> res;
+  for (const auto& t : args->tensor_list) {
+    res.push_back(Downcast<TensorType>(GetType(t)));
+  }
+  res.push_back(TensorType({}, DataType::Float(32)));
+  return TupleType(res);
+}
+
+RAF_OP_TYPE("raf.op.multi_tensor_clip_by_global_norm", "MultiTensorClipByGlobalNorm",
+            MultiTensorClipByGlobalNormInfer);
+
 }  // namespace op
 }  // namespace raf
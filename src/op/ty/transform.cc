@@ -258,6 +258,19 @@ Type ReshapeInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.reshape", "Reshape", ReshapeInfer);
 
+Type ViewInfer(const CallValues& value) {
+  const auto* args = value->args.as<ViewArgs>();
+  CHECK(args != nullptr);
+  TensorType x = Downcast<TensorType>(GetType(args->x));
+  Array<PrimExpr> shape;
+  for (int64_t dim : args->shape) {
+    shape.push_back(Integer(dim));
+  }
+  return TensorType(shape, x->dtype);
+}
+
+RAF_OP_TYPE("raf.op.view", "View", ViewInfer);
+
 Type TakeInfer(const CallValues& value) {
   const auto* args = value->args.as<TakeArgs>();
   CHECK(args != nullptr);
@@ -328,6 +341,23 @@ Type EmbeddingDxInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.embedding_dx", "EmbeddingDx", EmbeddingDxInfer);
 
+Type EmbeddingSparseDxInfer(const CallValues& value) {
+  const auto* args = value->args.as<EmbeddingDxArgs>();
+  CHECK(args != nullptr);
+  TensorType dy = Downcast<TensorType>(GetType(args->dy));
+  TensorType indices = Downcast<TensorType>(GetType(args->indices));
+  auto num_weight = GetShapeExprFromValue(args->num_weight);
+  PrimExpr n = 1;
+  for (const auto& dim : indices->shape) {
+    n = n * dim;
+  }
+  Array<PrimExpr> shape{n};
+  shape.insert(shape.end(), num_weight.begin() + 1, num_weight.end());
+  return TupleType({TensorType({n}, DataType::Int(64)), TensorType(shape, dy->dtype)});
+}
+
+RAF_OP_TYPE("raf.op.embedding_sparse_dx", "EmbeddingSparseDx", EmbeddingSparseDxInfer);
+
 Type ConcatenateInfer(const CallValues& value) {
   const auto* args = value->args.as<ConcatenateArgs>();
   CHECK(args != nullptr);
@@ -829,6 +859,38 @@ Type StridedSetInfer(const CallValues& value) {
 
 RAF_OP_TYPE("raf.op.strided_set", "StridedSet", StridedSetInfer);
 
+Type KvAppendInfer(const CallValues& value) {
+  const auto* args = value->args.as<KvAppendArgs>();
+  CHECK(args != nullptr);
+  TensorType cache = Downcast<TensorType>(GetType(args->cache));
+  TensorType v = Downcast<TensorType>(GetType(args->v));
+  CHECK_EQ(cache->shape.size(), v->shape.size());
+  int ndim = cache->shape.size();
+  for (int i = 0; i < ndim; ++i) {
+    CHECK(i == ndim - 2 || TypeCheckCompare(cache->shape[i], v->shape[i], std::equal_to<int>()))
+        << "Mismatched shapes of the cache and v at axis " << i;
+  }
+  return cache;
+}
+
+RAF_OP_TYPE("raf.op.kv_append", "KvAppend", KvAppendInfer);
+
+Type PagedKvAppendInfer(const CallValues& value) {
+  const auto* args = value->args.as<PagedKvAppendArgs>();
+  CHECK(args != nullptr);
+  TensorType cache = Downcast<TensorType>(GetType(args->cache));
+  TensorType v = Downcast<TensorType>(GetType(args->v));
+  CHECK_EQ(cache->shape.size(), 4U);
+  CHECK_EQ(v->shape.size(), 4U);
+  for (int i : {1, 3}) {
+    CHECK(TypeCheckCompare(cache->shape[i], v->shape[i], std::equal_to<int>()))
+        << "Mismatched shapes of the cache and v at axis " << i;
+  }
+  return cache;
+}
+
+RAF_OP_TYPE("raf.op.paged_kv_append", "PagedKvAppend", PagedKvAppendInfer);
+
 Type SqueezeInfer(const CallValues& value) {
   const auto* args = value->args.as<SqueezeArgs>();
   CHECK(args != nullptr);
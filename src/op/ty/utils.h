@@ -127,5 +127,30 @@ inline Array<PrimExpr> BroadcastShape(const TensorType& x1, const TensorType& x2
   return oshape;
 }
 
+/*! \brief The shape of a block-sparse matrix in blocks, and the number of its non-zero blocks. */
+struct BlockSparseShape {
+  int64_t rows;
+  int64_t cols;
+  int64_t nnz;
+};
+
+/*!
+ * \brief Check the block layout of a block-sparse matrix and get its shape. The layout is
+ * (num_block_rows, num_block_cols, mask...), where the mask is the row-major 0/1 mask of the
+ * blocks. The non-zero blocks are stored compactly in the row-major order as (nnz, block, block).
+ */
+inline BlockSparseShape GetBlockSparseShape(const std::vector<int64_t>& layout, int64_t block) {
+  CHECK_GT(block, 0) << "Invalid block size " << block;
+  CHECK_GE(layout.size(), 2) << "The block layout starts with its numbers of block rows and cols";
+  BlockSparseShape shape{layout[0], layout[1], 0};
+  CHECK_EQ(layout.size(), 2 + shape.rows * shape.cols)
+      << "Expected a block layout of " << shape.rows << " x " << shape.cols << " blocks";
+  for (size_t i = 2; i < layout.size(); ++i) {
+    CHECK(layout[i] == 0 || layout[i] == 1) << "The block mask must be 0 or 1";
+    shape.nnz += layout[i];
+  }
+  return shape;
+}
+
 }  // namespace op
 }  // namespace raf
@@ -0,0 +1,182 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file accumulate_gradient.cc
+ * \brief Given a model after AutoDiff and InlineBackward, this pass accumulates the local
+ * gradients of a micro-batch to persistent accumulation buffers, which are appended to the
+ * function parameters and updated in place. For the micro-batches other than the last one,
+ * the gradient communication (e.g., allreduce inserted by AutoDataParallel) is skipped, and the
+ * accumulated local gradients are returned. For the last micro-batch, the accumulated local
+ * gradients are communicated instead of the local gradients of this micro-batch.
+ */
+#include "raf/pass.h"
+
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace accumulate_gradient {
+
+class GradientAccumulator : public ExprMutator {
+ public:
+  GradientAccumulator(bool last_micro_batch, const Function& func)
+      : last_micro_batch_(last_micro_batch), func_(func) {
+    // Build the var to expr map for the ANF.
+    auto ell = ExplicitLetList::make(func->body);
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      var_to_expr_.Set(ell->vars[i], ell->exprs[i]);
+    }
+
+    // Assume output is a tuple of (forward out, (grads, ...))
+    auto ret = ell->exprs.back().as<TupleNode>();
+    CHECK(ret != nullptr) << "Expected a tuple output, but got " << ell->exprs.back()->GetTypeKey();
+    CHECK_EQ(ret->fields.size(), 2U)
+        << "Expected the output tuple to be (out, (grad, ...)) with 2 fields, but it has "
+        << ret->fields.size() << " fields";
+
+    // Traverse back to find the gradient tuple.
+    auto grad_tuple_var = Downcast<Var>(ret->fields[1]);
+    auto grads = var_to_expr_[grad_tuple_var];
+    while (!grads->IsInstance<TupleNode>()) {
+      auto tgi = grads.as<TupleGetItemNode>();
+      CHECK(tgi != nullptr) << "Expected TupleGetItem, but got " << grads->GetTypeKey();
+      auto tuple = Downcast<Tuple>(var_to_expr_[Downcast<Var>(tgi->tuple)]);
+      grad_tuple_var = Downcast<Var>(tuple->fields[tgi->index]);
+      grads = var_to_expr_[grad_tuple_var];
+    }
+
+    // Map the local gradients to the gradients.
+    for (auto field : Downcast<Tuple>(grads)->fields) {
+      if (auto var = field.as<VarNode>()) {
+        auto local_grad = GetLocalGrad(GetRef<Var>(var));
+        CHECK(local_grad->checked_type_.defined()) << "Please run InferType first";
+        if (local_grad->checked_type().as<TensorTypeNode>() && !local_grads_.count(local_grad)) {
+          local_grads_.Set(local_grad, GetRef<Var>(var));
+          local_grad_order_.push_back(local_grad);
+        }
+      }
+    }
+  }
+
+  Function Run() {
+    if (local_grads_.empty()) {  // No gradients to be accumulated.
+      return func_;
+    }
+    Array<Var> func_params{func_->params};
+    for (const auto& local_grad : local_grad_order_) {
+      auto name = "grad_acc_" + std::to_string(acc_vars_.size());
+      auto acc = MakeVar(name, local_grad->checked_type());
+      acc_vars_.Set(local_grad, acc);
+      func_params.push_back(acc);
+    }
+    auto new_body = this->Mutate(func_->body);
+    return Function(func_params, new_body, func_->ret_type, {}, func_->attrs);
+  }
+
+  Expr VisitExpr_(const VarNode* node) final {
+    auto var = GetRef<Var>(node);
+    auto it = var_map_.find(var);
+    return it != var_map_.end() ? (*it).second : var;
+  }
+
+  Expr VisitExpr_(const LetNode* node) final {
+    static const Op& add_op = Op::Get("raf.op.add");
+    scopes_.emplace_back(new LetList);
+    auto scope = scopes_.back().get();
+    Expr body;
+    do {
+      auto curr_var = node->var;
+      scope->Push(curr_var, VisitExpr(node->value));
+      if (acc_vars_.count(curr_var)) {
+        // Accumulate the local gradient to the buffer in place.
+        auto acc = acc_vars_[curr_var];
+        auto acc_grad = scope->Push(Call(add_op, {acc, curr_var, acc, MakeNull()}));
+        var_map_.Set(curr_var, acc_grad);
+        if (!last_micro_batch_) {
+          // Skip the communication by returning the accumulated local gradient directly.
+          var_map_.Set(local_grads_[curr_var], acc_grad);
+        }
+      }
+      body = node->body;
+      node = body.as<LetNode>();
+    } while (node);
+    auto ret = scopes_.back()->Get(this->Mutate(body));
+    scopes_.pop_back();
+    return ret;
+  }
+
+ private:
+  /*! \brief Check whether a given expression is a call expression with the given op. */
+  inline bool IsCallTo(const Expr& expr, const Op& op) {
+    if (auto call = expr.as<CallNode>()) {
+      if (auto node = call->op.as<OpNode>()) {
+        return GetRef<Op>(node) == op;
+      }
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Get the local gradient of the given gradient, which is the input of the allreduce
+   * (optionally followed by divide due to NCCL version<2.10) if any, or the gradient itself.
+   */
+  Var GetLocalGrad(const Var& grad) {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    static const Op& divide_op = Op::Get("raf.op.divide");
+    Expr expr = var_to_expr_.Get(grad).value_or(Expr());
+    if (expr.defined() && IsCallTo(expr, divide_op)) {
+      auto arg = Downcast<Call>(expr)->args[0].as<VarNode>();
+      expr = arg ? var_to_expr_.Get(GetRef<Var>(arg)).value_or(Expr()) : Expr();
+    }
+    if (!expr.defined() || !IsCallTo(expr, allreduce_op)) {
+      return grad;
+    }
+    auto arg_tuple = Downcast<Call>(expr)->args[0].as<VarNode>();
+    auto tuple = arg_tuple ? var_to_expr_.Get(GetRef<Var>(arg_tuple)).value_or(Expr()) : Expr();
+    if (!tuple.defined() || !tuple->IsInstance<TupleNode>() ||
+        Downcast<Tuple>(tuple)->fields.size() != 1 ||
+        !Downcast<Tuple>(tuple)->fields[0]->IsInstance<VarNode>()) {
+      // Folded constant gradients or fused allreduce are accumulated after the communication.
+      return grad;
+    }
+    return Downcast<Var>(Downcast<Tuple>(tuple)->fields[0]);
+  }
+
+  /*! \brief The scope stack of the let list. */
+  std::vector<std::unique_ptr<LetList>> scopes_;
+  /*! \brief Whether the function is for the last micro-batch. */
+  bool last_micro_batch_;
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief Mapping from let-binding var to the expression. */
+  Map<Var, Expr> var_to_expr_;
+  /*! \brief Mapping from a local gradient to the gradient in the output. */
+  Map<Var, Var> local_grads_;
+  /*! \brief The local gradients in the order of the gradient tuple. */
+  std::vector<Var> local_grad_order_;
+  /*! \brief Mapping from a local gradient to its accumulation buffer. */
+  Map<Var, Var> acc_vars_;
+  /*! \brief Mapping from a var to its replacement. */
+  Map<Var, Expr> var_map_;
+};
+
+}  // namespace accumulate_gradient
+
+Pass AccumulateGradient(bool last_micro_batch) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return accumulate_gradient::GradientAccumulator(last_micro_batch, f).Run();
+  };
+  auto accumulate_gradient = CreateRAFFunctionPass(pass_func, 0, "AccumulateGradientFunc", {});
+  return RAFSequential({accumulate_gradient, EraseType(), DeadCodeElimination()},
+                       "AccumulateGradient");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.AccumulateGradient").set_body_typed(AccumulateGradient);
+
+}  // namespace pass
+}  // namespace raf
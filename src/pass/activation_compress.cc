@@ -0,0 +1,406 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file activation_compress.cc
+ * \brief Compress the activations stashed for the backward to reduce peak memory footprint.
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+#include "./liveness_analysis.h"
+
+namespace raf {
+namespace pass {
+namespace activation_compress {
+
+using namespace raf::op;
+using namespace raf::value;
+using liveness_analysis::LivenessAnalyzer;
+using liveness_analysis::VSet;
+
+template <typename T>
+using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+
+constexpr float kMegaBytes = 1048576;
+
+/*! \brief A tensor chosen to be compressed in the gap between two of its uses. */
+struct CompressEntry {
+  /*! \brief The let-binding var of the tensor. */
+  Var var;
+  /*! \brief The bytes saved in the gap. */
+  int64_t saving;
+  /*! \brief The index of the let binding after which the tensor is compressed. */
+  int64_t compress_after;
+  /*! \brief The index of the let binding before which the tensor is decompressed. */
+  int64_t decompress_before;
+  /*! \brief Whether to keep the sign mask of a ReLU output instead of a lossy copy. */
+  bool mask;
+};
+
+/*!
+ * \brief Compress activations in the long gaps between their uses, which are usually the gaps
+ * between the forward and the backward. The algorithm is briefly described as follows:
+ * 1. Trace the memory consumption of each let binding with the liveness analysis.
+ * 2. For each tensor produced by a call node, find the longest gap between two of its uses, where
+ *    the tensor is live according to the liveness analysis. A ReLU output only used by relu_dx
+ *    after the gap keeps a uint8 mask of its sign, which is lossless since relu_dx only tests
+ *    the sign.
+ *    Other float32 tensors keep a copy in the lossy compression dtype.
+ * 3. Compress all candidates if there is no memory budget. Otherwise, while the peak memory
+ *    exceeds the budget, compress the candidate that saves the most memory at the peak.
+ * 4. Insert a cast right after the use before the gap, and a cast back right before the use after
+ *    the gap. The pass runs before the fusion, so the casts are fused into their neighbours and
+ *    the full tensors are not materialized when the neighbours are fusable.
+ */
+class ActivationCompressor {
+ public:
+  ActivationCompressor(const Function& func, int64_t budget, int64_t min_gap,
+                       const std::string& dtype)
+      : func_(func),
+        budget_(budget),
+        min_gap_(min_gap),
+        dtype_(dtype),
+        ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  Function Run() {
+    if (!Analyze()) {
+      LOG(WARNING) << "Activation compression is disabled because the function has control flow "
+                   << "or closures";
+      return func_;
+    }
+    auto chosen = Choose();
+    if (chosen.empty()) {
+      return func_;
+    }
+    return Rewrite(chosen);
+  }
+
+ private:
+  /*!
+   * \brief Collect the memory trace, live tensors and uses of the let-binding vars.
+   * \return Whether the function can be handled.
+   */
+  bool Analyze() {
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    int64_t n = exprs.size();
+    for (const auto& expr : exprs) {
+      if (expr->IsInstance<IfNode>() || expr->IsInstance<FunctionNode>()) {
+        return false;
+      }
+      if (auto call = expr.as<CallNode>()) {
+        if (!call->op->IsInstance<OpNode>()) {
+          return false;
+        }
+      }
+    }
+    analyzer_ = LivenessAnalyzer::Get(func_);
+    if (!analyzer_->IsSuccess()) {
+      return false;
+    }
+
+    // The live tensors at a line are its live-in tensors and its outputs.
+    StdMap<int64_t> tensor_bytes;
+    StdMap<int> num_owners;
+    auto add_tensors = [&](const Var& var, VSet* live) {
+      auto tensors = analyzer_->GetTensorVars(var);
+      std::vector<int64_t> sizes;
+      if (var->checked_type_.defined() && !var->checked_type().as<FuncTypeNode>()) {
+        sizes = liveness_analysis::CalcBytesCompactSizes(var->checked_type());
+      }
+      for (size_t i = 0; i < tensors.size(); ++i) {
+        if (sizes.size() == tensors.size()) {
+          tensor_bytes[tensors[i]] = std::max(tensor_bytes[tensors[i]], sizes[i]);
+        }
+        num_owners[tensors[i]]++;
+        if (live) {
+          live->insert(tensors[i]);
+        }
+      }
+    };
+    for (const auto& param : func_->params) {
+      add_tensors(param, nullptr);
+    }
+    live_.resize(n);
+    trace_.assign(n, 0);
+    for (int64_t i = 0; i < n; ++i) {
+      live_[i] = analyzer_->GetLiveVars(vars[i]);
+      add_tensors(vars[i], &live_[i]);
+    }
+    for (int64_t i = 0; i < n; ++i) {
+      for (const auto& tensor : live_[i]) {
+        auto it = tensor_bytes.find(tensor);
+        trace_[i] += it == tensor_bytes.end() ? 0 : it->second;
+      }
+    }
+
+    // Collect the uses of the call outputs that own their memory.
+    VSet outputs = analyzer_->GetOutputTensorVars();
+    for (int64_t i = 0; i < n; ++i) {
+      const auto& var = vars[i];
+      if (auto call = exprs[i].as<CallNode>()) {
+        for (size_t j = 0; j < call->args.size(); ++j) {
+          auto arg_var = call->args[j].as<VarNode>();
+          if (arg_var && def_.count(GetRef<Var>(arg_var))) {
+            uses_[GetRef<Var>(arg_var)].push_back({i, static_cast<int>(j)});
+          }
+        }
+        const auto* extended_var = static_cast<const ExtendedVarNode*>(var.operator->());
+        auto tensors = analyzer_->GetTensorVars(var);
+        if (extended_var->may_share.defined() || tensors.size() != 1 ||
+            num_owners[tensors[0]] != 1 || outputs.count(tensors[0]) ||
+            !var->checked_type()->IsInstance<TensorTypeNode>()) {
+          continue;
+        }
+        def_[var] = i;
+        bytes_[var] = tensor_bytes[tensors[0]];
+      } else if (auto alias = exprs[i].as<VarNode>()) {
+        // Aliased tensors are not compressed.
+        def_.erase(GetRef<Var>(alias));
+      } else if (auto tuple = exprs[i].as<TupleNode>()) {
+        for (const auto& field : tuple->fields) {
+          if (auto field_var = field.as<VarNode>()) {
+            def_.erase(GetRef<Var>(field_var));
+          }
+        }
+      }
+    }
+    if (auto ret = ell_->ret.as<VarNode>()) {
+      def_.erase(GetRef<Var>(ret));
+    }
+    return true;
+  }
+
+  /*! \brief Whether the use of a ReLU output only tests its sign. */
+  static bool IsSignUse(const Expr& expr, int arg_idx) {
+    static const Op& relu_dx_op = Op::Get("raf.op.relu_dx");
+    auto call = expr.as<CallNode>();
+    // The arguments of relu_dx are (x, y, dy), where either x or y is tested.
+    return call && call->op.same_as(relu_dx_op) && arg_idx < 2;
+  }
+
+  /*! \brief Choose the tensors to compress until the peak memory fits into the budget. */
+  std::vector<CompressEntry> Choose() {
+    static const Op& relu_op = Op::Get("raf.op.relu");
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    DataType lossy_dtype = dtype_.empty() ? DataType::Void() : DataType(String2DLDataType(dtype_));
+
+    std::vector<CompressEntry> candidates;
+    for (const auto& kv : def_) {
+      const auto& var = kv.first;
+      const auto& uses = uses_[var];
+      if (uses.empty()) {
+        continue;
+      }
+      // Find the longest gap between two consecutive uses.
+      int64_t prev = kv.second, after = -1, before = -1;
+      size_t reuse = 0;
+      for (size_t i = 0; i < uses.size(); ++i) {
+        int64_t gap = uses[i].first - prev;
+        if (gap >= min_gap_ && gap > before - after) {
+          after = prev;
+          before = uses[i].first;
+          reuse = i;
+        }
+        prev = uses[i].first;
+      }
+      if (after == -1) {
+        continue;
+      }
+      auto dtype = Downcast<TensorType>(var->checked_type())->dtype;
+      auto call = exprs[kv.second].as<CallNode>();
+      bool mask = call->op.same_as(relu_op);
+      for (size_t i = reuse; i < uses.size() && mask; ++i) {
+        mask = IsSignUse(exprs[uses[i].first], uses[i].second);
+      }
+      int64_t numel = bytes_[var] / ((dtype.bits() * dtype.lanes() + 7) / 8);
+      int64_t compressed_bytes;
+      if (mask) {
+        compressed_bytes = numel;
+      } else if (!lossy_dtype.is_void() && dtype == DataType::Float(32)) {
+        compressed_bytes = numel * ((lossy_dtype.bits() + 7) / 8);
+      } else {
+        continue;
+      }
+      if (compressed_bytes < bytes_[var]) {
+        candidates.push_back({var, bytes_[var] - compressed_bytes, after, before, mask});
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [this](const CompressEntry& a, const CompressEntry& b) {
+                return def_.at(a.var) < def_.at(b.var);
+              });
+
+    // The memory of a compressed tensor is saved in (compress_after, decompress_before).
+    auto apply = [this](const CompressEntry& cand) {
+      for (int64_t i = cand.compress_after + 1; i < cand.decompress_before; ++i) {
+        trace_[i] -= cand.saving;
+      }
+    };
+    std::vector<CompressEntry> chosen;
+    if (budget_ == 0) {
+      for (const auto& cand : candidates) {
+        apply(cand);
+      }
+      chosen = candidates;
+    } else {
+      std::vector<bool> used(candidates.size(), false);
+      while (true) {
+        auto peak = std::max_element(trace_.begin(), trace_.end()) - trace_.begin();
+        if (trace_[peak] <= budget_) {
+          break;
+        }
+        int best = -1;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+          const auto& cand = candidates[i];
+          if (used[i] || peak <= cand.compress_after || peak >= cand.decompress_before ||
+              !analyzer_->IsAlive(cand.var, live_[peak])) {
+            continue;
+          }
+          if (best == -1 || cand.saving > candidates[best].saving) {
+            best = i;
+          }
+        }
+        if (best == -1) {
+          LOG(WARNING) << "Memory consumption at " << vars[peak] << " is "
+                       << trace_[peak] / kMegaBytes
+                       << " MBs, which cannot be reduced to the budget (" << budget_ / kMegaBytes
+                       << " MBs) by compressing activations";
+          break;
+        }
+        used[best] = true;
+        apply(candidates[best]);
+        chosen.push_back(candidates[best]);
+      }
+    }
+    int64_t total = 0;
+    for (const auto& entry : chosen) {
+      total += entry.saving;
+    }
+    if (!chosen.empty()) {
+      DLOG(INFO) << "Compressing " << chosen.size() << " activations (saving "
+                 << total / kMegaBytes << " MBs). Estimated peak memory is "
+                 << *std::max_element(trace_.begin(), trace_.end()) / kMegaBytes << " MBs";
+    }
+    return chosen;
+  }
+
+  /*! \brief Insert the codecs of the chosen tensors and replace their uses after the gaps. */
+  Function Rewrite(const std::vector<CompressEntry>& chosen) {
+    std::unordered_map<int64_t, std::vector<const CompressEntry*>> compress_after,
+        decompress_before;
+    for (const auto& entry : chosen) {
+      compress_after[entry.compress_after].push_back(&entry);
+      decompress_before[entry.decompress_before].push_back(&entry);
+    }
+
+    StdMap<Var> compressed_vars, subst;
+    ExplicitLetList ell;
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    for (int64_t i = 0; i < static_cast<int64_t>(exprs.size()); ++i) {
+      for (const auto* entry : decompress_before[i]) {
+        auto dtype = Downcast<TensorType>(entry->var->checked_type())->dtype;
+        auto decompressed = MakeVar(entry->var->name_hint() + "_decompress", {});
+        ell.Push(decompressed, Cast(compressed_vars[entry->var], DLDataType2String(dtype)));
+        subst[entry->var] = decompressed;
+      }
+
+      Expr expr = exprs[i];
+      if (auto call = expr.as<CallNode>()) {
+        Array<Expr> args;
+        for (const auto& arg : call->args) {
+          auto arg_var = arg.as<VarNode>();
+          auto it = arg_var ? subst.find(GetRef<Var>(arg_var)) : subst.end();
+          args.push_back(it != subst.end() ? it->second : arg);
+        }
+        expr = Call(call->op, args, call->attrs, call->type_args);
+      }
+      ell.Push(vars[i], expr);
+
+      for (const auto* entry : compress_after[i]) {
+        Var data = entry->var;
+        if (entry->mask) {
+          // A ReLU output is non-negative, so its sign is the mask of the positive values.
+          static const Op& sign_op = Op::Get("raf.op.sign");
+          data = MakeVar(entry->var->name_hint() + "_sign", {});
+          ell.Push(data, Call(sign_op, {entry->var}));
+        }
+        auto compressed = MakeVar(entry->var->name_hint() + "_compress", {});
+        ell.Push(compressed, Cast(data, entry->mask ? "uint8" : dtype_));
+        compressed_vars[entry->var] = compressed;
+      }
+    }
+    ell.ret = ell_->ret;
+    return Function(func_->params, ell.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+  Expr Cast(const Var& data, const std::string& dtype) {
+    static const Op& op = Op::Get("raf.op.cast");
+    return Call(op, {data, MakeConstant(StringValue::make(dtype))});
+  }
+
+  /*! \brief The function to be transformed. */
+  const Function& func_;
+  /*! \brief The memory budget in bytes, or 0 to compress all candidates. */
+  int64_t budget_;
+  /*! \brief The minimum number of let bindings between two uses to compress a tensor. */
+  int64_t min_gap_;
+  /*! \brief The dtype of the lossy compression, or empty to only compress the ReLU masks. */
+  std::string dtype_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The liveness analysis of the function. */
+  std::shared_ptr<LivenessAnalyzer> analyzer_;
+  /*! \brief The live tensors of each let binding. */
+  std::vector<VSet> live_;
+  /*! \brief The memory consumption of each let binding in bytes. */
+  std::vector<int64_t> trace_;
+  /*! \brief The index of the let binding that produces each candidate tensor. */
+  StdMap<int64_t> def_;
+  /*! \brief The size of each candidate tensor in bytes. */
+  StdMap<int64_t> bytes_;
+  /*! \brief The indices of the call nodes that use each tensor and the argument indices. */
+  StdMap<std::vector<std::pair<int64_t, int>>> uses_;
+};
+
+}  // namespace activation_compress
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.compress_activation.enable", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.compress_activation.dtype", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.compress_activation.min_gap", IntImm);
+
+Pass ActivationCompression() {
+  PassContext pass_ctx = PassContext::Current();
+  int64_t memory_budget =
+      pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value().IntValue();
+  std::string dtype =
+      pass_ctx->GetConfig<String>("raf.compress_activation.dtype", String("bfloat16")).value();
+  int64_t min_gap =
+      pass_ctx->GetConfig("raf.compress_activation.min_gap", Integer(8)).value().IntValue();
+  CHECK_GE(min_gap, 1) << "The minimum gap must be positive";
+  CHECK(dtype.empty() || dtype == "bfloat16" || dtype == "float16")
+      << "Unsupported activation compression dtype: " << dtype;
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return activation_compress::ActivationCompressor(f, memory_budget, min_gap, dtype).Run();
+  };
+
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "ActivationCompressionHelper", {});
+  PassInfo pass_info(2, "ActivationCompression", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ActivationCompression").set_body_typed(ActivationCompression);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,414 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file activation_offload.cc
+ * \brief Offload activations to the host memory to reduce peak memory footprint.
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace activation_offload {
+
+using namespace raf::op;
+using namespace raf::value;
+using common::shape_utils::BytesCompactType;
+
+template <typename T>
+using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+
+constexpr float kMegaBytes = 1048576;
+
+/*! \brief A tensor chosen to be offloaded in the gap between two of its uses. */
+struct OffloadEntry {
+  /*! \brief The let-binding var of the tensor. */
+  Var var;
+  /*! \brief The size of the tensor in bytes. */
+  int64_t size;
+  /*! \brief The index of the let binding after which the tensor is copied to the host. */
+  int64_t offload_after;
+  /*! \brief The index of the let binding before which the tensor is copied back. */
+  int64_t prefetch_before;
+  /*! \brief The index of the let binding that uses the tensor after the gap. */
+  int64_t reuse_at;
+};
+
+/*!
+ * \brief Offload activations to the host when the memory budget cannot be met otherwise. The
+ * algorithm is briefly described as follows:
+ * 1. Trace the memory consumption of each let binding in the execution order.
+ * 2. For each tensor produced by a call node, find the longest gap between two of its uses. If the
+ *    tensor is copied to the host right after the first use and copied back `prefetch_distance`
+ *    bindings before the second use, its memory is not needed in between.
+ * 3. While the peak memory exceeds the budget, offload the largest tensor whose gap covers the
+ *    peak. If no tensor covers the peak, give up and leave the rest to rematerialization.
+ * 4. Insert the copies as async device_copy ops on a dedicated copy stream, synchronized with the
+ *    compute stream by add_event and wait_event, and replace the uses after the gap with the
+ *    prefetched tensor.
+ * Since the memory of a tensor may be reused as soon as it is released, the compute stream waits
+ * for the device-to-host copy right after issuing it, while the host-to-device copy overlaps with
+ * the computation in the prefetch window.
+ */
+class ActivationOffloader {
+ public:
+  ActivationOffloader(const Function& func, const Device& device, int64_t budget,
+                      int64_t prefetch_distance, int64_t copy_stream_id)
+      : func_(func),
+        device_(device),
+        budget_(budget),
+        prefetch_distance_(prefetch_distance),
+        copy_stream_id_(copy_stream_id),
+        ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  Function Run() {
+    if (!Analyze()) {
+      LOG(WARNING) << "Activation offloading is disabled because the function has control flow "
+                   << "or closures";
+      return func_;
+    }
+    auto chosen = Choose();
+    if (chosen.empty()) {
+      return func_;
+    }
+    return Rewrite(chosen);
+  }
+
+ private:
+  /*!
+   * \brief Collect the sizes, live ranges and uses of the let-binding vars.
+   * \return Whether the function can be handled.
+   */
+  bool Analyze() {
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    int64_t n = exprs.size();
+    for (const auto& param : func_->params) {
+      param_bytes_ += BytesCompactType(param->checked_type());
+    }
+
+    // Let-binding vars that do not allocate memory refer to the vars they alias.
+    StdMap<std::vector<Var>> roots;
+    auto get_roots = [&](const Var& var) {
+      auto it = roots.find(var);
+      return it == roots.end() ? std::vector<Var>{var} : it->second;
+    };
+    auto add_use = [&](const Var& var, int64_t idx, bool by_call) {
+      for (const auto& root : get_roots(var)) {
+        if (!def_.count(root)) {
+          continue;
+        }
+        last_use_[root] = idx;
+        if (by_call) {
+          uses_[root].push_back(idx);
+        } else {
+          not_offloadable_.insert(root);
+        }
+      }
+    };
+
+    for (int64_t i = 0; i < n; ++i) {
+      const auto& var = vars[i];
+      const auto& expr = exprs[i];
+      if (expr->IsInstance<IfNode>() || expr->IsInstance<FunctionNode>()) {
+        return false;
+      }
+      if (auto call = expr.as<CallNode>()) {
+        if (!call->op->IsInstance<OpNode>()) {
+          return false;
+        }
+        for (const auto& arg : call->args) {
+          if (auto arg_var = arg.as<VarNode>()) {
+            add_use(GetRef<Var>(arg_var), i, true);
+          }
+        }
+        const auto* extended_var = static_cast<const ExtendedVarNode*>(var.operator->());
+        if (extended_var->may_share.defined()) {
+          // In-place updates write to the memory of the shared tensor.
+          roots[var] = get_roots(extended_var->may_share);
+          for (const auto& root : roots[var]) {
+            not_offloadable_.insert(root);
+          }
+          continue;
+        }
+        def_[var] = i;
+        last_use_[var] = i;
+        size_[var] = BytesCompactType(var->checked_type());
+        if (!var->checked_type()->IsInstance<TensorTypeNode>()) {
+          not_offloadable_.insert(var);
+        }
+      } else if (auto alias = expr.as<VarNode>()) {
+        roots[var] = get_roots(GetRef<Var>(alias));
+        add_use(GetRef<Var>(alias), i, false);
+      } else if (auto tuple = expr.as<TupleNode>()) {
+        for (const auto& field : tuple->fields) {
+          if (auto field_var = field.as<VarNode>()) {
+            auto field_roots = get_roots(GetRef<Var>(field_var));
+            roots[var].insert(roots[var].end(), field_roots.begin(), field_roots.end());
+            add_use(GetRef<Var>(field_var), i, false);
+          }
+        }
+      } else if (auto tgi = expr.as<TupleGetItemNode>()) {
+        if (auto tuple_var = tgi->tuple.as<VarNode>()) {
+          roots[var] = get_roots(GetRef<Var>(tuple_var));
+          add_use(GetRef<Var>(tuple_var), i, false);
+        }
+      }
+    }
+    // The outputs are live until the end.
+    for (const auto& root : get_roots(ell_->ret)) {
+      if (def_.count(root)) {
+        last_use_[root] = n;
+        not_offloadable_.insert(root);
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Choose the tensors to offload until the peak memory fits into the budget. */
+  std::vector<OffloadEntry> Choose() {
+    int64_t n = ell_->exprs.size();
+    std::vector<int64_t> trace(n + 1, param_bytes_);
+    for (const auto& kv : def_) {
+      for (int64_t i = kv.second; i <= last_use_[kv.first]; ++i) {
+        trace[i] += size_[kv.first];
+      }
+    }
+
+    // Offload each candidate in the longest gap between its consecutive uses.
+    std::vector<OffloadEntry> candidates;
+    for (const auto& kv : def_) {
+      const auto& var = kv.first;
+      if (not_offloadable_.count(var) || uses_[var].empty()) {
+        continue;
+      }
+      OffloadEntry best{var, size_[var], -1, -1, -1};
+      int64_t prev = kv.second;
+      for (int64_t use : uses_[var]) {
+        int64_t prefetch = use - prefetch_distance_;
+        if (prefetch - prev > 1 && prefetch - prev > best.prefetch_before - best.offload_after) {
+          best.offload_after = prev;
+          best.prefetch_before = prefetch;
+          best.reuse_at = use;
+        }
+        prev = use;
+      }
+      if (best.offload_after != -1) {
+        candidates.push_back(best);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [this](const OffloadEntry& a, const OffloadEntry& b) {
+                return def_.at(a.var) < def_.at(b.var);
+              });
+
+    std::vector<OffloadEntry> chosen;
+    std::vector<bool> used(candidates.size(), false);
+    while (true) {
+      auto peak = std::max_element(trace.begin(), trace.end()) - trace.begin();
+      if (trace[peak] <= budget_) {
+        break;
+      }
+      // The memory of an offloaded tensor is freed in (offload_after, prefetch_before).
+      int best = -1;
+      for (size_t i = 0; i < candidates.size(); ++i) {
+        const auto& cand = candidates[i];
+        if (used[i] || peak <= cand.offload_after || peak >= cand.prefetch_before) {
+          continue;
+        }
+        if (best == -1 || cand.size > candidates[best].size) {
+          best = i;
+        }
+      }
+      if (best == -1) {
+        LOG(WARNING) << "Memory consumption at " << ell_->vars[std::min(peak, n - 1)] << " is "
+                     << trace[peak] / kMegaBytes << " MBs, which cannot be reduced to the budget ("
+                     << budget_ / kMegaBytes << " MBs) by offloading activations";
+        break;
+      }
+      used[best] = true;
+      const auto& cand = candidates[best];
+      for (int64_t i = cand.offload_after + 1; i < cand.prefetch_before; ++i) {
+        trace[i] -= cand.size;
+      }
+      chosen.push_back(cand);
+    }
+    int64_t total = 0;
+    for (const auto& entry : chosen) {
+      total += entry.size;
+    }
+    DLOG(INFO) << "Offloading " << chosen.size() << " activations (" << total / kMegaBytes
+               << " MBs) to the host. Estimated peak memory is "
+               << *std::max_element(trace.begin(), trace.end()) / kMegaBytes
+               << " MBs; while the budget is " << budget_ / kMegaBytes << " MBs";
+    return chosen;
+  }
+
+  /*! \brief Insert the copies of the chosen tensors and replace their uses after the gaps. */
+  Function Rewrite(const std::vector<OffloadEntry>& chosen) {
+    std::unordered_map<int64_t, std::vector<const OffloadEntry*>> offload_after, prefetch_before,
+        reuse_at;
+    for (const auto& entry : chosen) {
+      offload_after[entry.offload_after].push_back(&entry);
+      prefetch_before[entry.prefetch_before].push_back(&entry);
+      reuse_at[entry.reuse_at].push_back(&entry);
+    }
+
+    std::string device_str = "cuda(" + std::to_string(device_.device_id()) + ")";
+    StdMap<Var> host_vars, prefetched_vars, subst;
+    StdMap<int64_t> prefetch_events;
+    ExplicitLetList ell;
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    for (int64_t i = 0; i < static_cast<int64_t>(exprs.size()); ++i) {
+      for (const auto* entry : prefetch_before[i]) {
+        SetStream(&ell, copy_stream_id_);
+        auto copy = DeviceCopy(host_vars[entry->var], "cuda_host", device_str);
+        auto prefetched = MakeVar(entry->var->name_hint() + "_prefetch", {});
+        ell.Push(prefetched, copy);
+        prefetch_events[entry->var] = AddEvent(&ell, copy_stream_id_);
+        SetStream(&ell, kComputeStreamId);
+        prefetched_vars[entry->var] = prefetched;
+      }
+      for (const auto* entry : reuse_at[i]) {
+        WaitEvent(&ell, prefetch_events[entry->var], kComputeStreamId);
+        subst[entry->var] = prefetched_vars[entry->var];
+      }
+
+      Expr expr = exprs[i];
+      if (auto call = expr.as<CallNode>()) {
+        Array<Expr> args;
+        for (const auto& arg : call->args) {
+          auto arg_var = arg.as<VarNode>();
+          auto it = arg_var ? subst.find(GetRef<Var>(arg_var)) : subst.end();
+          args.push_back(it != subst.end() ? it->second : arg);
+        }
+        expr = Call(call->op, args, call->attrs, call->type_args);
+      }
+      ell.Push(vars[i], expr);
+
+      for (const auto* entry : offload_after[i]) {
+        auto ready = AddEvent(&ell, kComputeStreamId);
+        SetStream(&ell, copy_stream_id_);
+        WaitEvent(&ell, ready, copy_stream_id_);
+        auto copy = DeviceCopy(entry->var, device_str, "cuda_host");
+        auto host_var = MakeVar(entry->var->name_hint() + "_host", {});
+        ell.Push(host_var, copy);
+        auto done = AddEvent(&ell, copy_stream_id_);
+        SetStream(&ell, kComputeStreamId);
+        WaitEvent(&ell, done, kComputeStreamId);
+        host_vars[entry->var] = host_var;
+      }
+    }
+    ell.ret = ell_->ret;
+    return Function(func_->params, ell.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+  Expr DeviceCopy(const Var& data, const std::string& src, const std::string& dst) {
+    static const Op& op = Op::Get("raf.op.device_copy");
+    return Call(op, {data, MakeConstant(StringValue::make(src)),
+                     MakeConstant(StringValue::make(dst))});
+  }
+
+  void SetStream(ExplicitLetList* ell, int64_t stream_id) {
+    static const Op& op = Op::Get("raf.op.set_stream");
+    ell->Push(MakeVar("set_stream", {}),
+              Call(op, {MakeConstant(ScalarValue::make(static_cast<int64_t>(device_.device_id()))),
+                        MakeConstant(ScalarValue::make(stream_id))}));
+  }
+
+  int64_t AddEvent(ExplicitLetList* ell, int64_t stream_id) {
+    static const Op& op = Op::Get("raf.op.add_event");
+    int64_t event_id = next_event_id_++;
+    ell->Push(MakeVar("add_event", {}), Call(op, {MakeConstant(ScalarValue::make(event_id)),
+                                                  MakeConstant(ScalarValue::make(stream_id))}));
+    return event_id;
+  }
+
+  void WaitEvent(ExplicitLetList* ell, int64_t event_id, int64_t stream_id) {
+    static const Op& op = Op::Get("raf.op.wait_event");
+    ell->Push(MakeVar("wait_event", {}), Call(op, {MakeConstant(ScalarValue::make(event_id)),
+                                                   MakeConstant(ScalarValue::make(stream_id))}));
+  }
+
+  /*! \brief The stream to run the computation, which is the default one. */
+  static constexpr int64_t kComputeStreamId = 0;
+
+  /*! \brief The function to be transformed. */
+  const Function& func_;
+  /*! \brief The target device. */
+  Device device_;
+  /*! \brief The memory budget in bytes. */
+  int64_t budget_;
+  /*! \brief The number of let bindings to prefetch a tensor ahead of its use. */
+  int64_t prefetch_distance_;
+  /*! \brief The stream to run the copies. */
+  int64_t copy_stream_id_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The total size of the parameters in bytes. */
+  int64_t param_bytes_ = 0;
+  /*! \brief The index of the let binding that allocates each tensor. */
+  StdMap<int64_t> def_;
+  /*! \brief The index of the last let binding that uses each tensor. */
+  StdMap<int64_t> last_use_;
+  /*! \brief The indices of the call nodes that use each tensor, in order. */
+  StdMap<std::vector<int64_t>> uses_;
+  /*! \brief The size of each tensor in bytes. */
+  StdMap<int64_t> size_;
+  /*! \brief Tensors that are aliased, updated in-place, or outputs. */
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> not_offloadable_;
+  /*! \brief The next event id. */
+  int64_t next_event_id_ = 0;
+};
+
+}  // namespace activation_offload
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.offload.enable", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.offload.prefetch_distance", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.offload.copy_stream_id", IntImm);
+
+Pass ActivationOffload() {
+  PassContext pass_ctx = PassContext::Current();
+  int64_t memory_budget =
+      pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value().IntValue();
+  int64_t prefetch_distance =
+      pass_ctx->GetConfig("raf.offload.prefetch_distance", Integer(2)).value().IntValue();
+  int64_t copy_stream_id =
+      pass_ctx->GetConfig("raf.offload.copy_stream_id", Integer(1)).value().IntValue();
+  CHECK_GE(prefetch_distance, 1) << "The prefetch distance must be positive";
+  CHECK_NE(copy_stream_id, 0) << "The copy stream must not be the compute stream";
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    if (memory_budget == 0) {
+      return f;
+    }
+    auto device = Device::Current();
+    if (device.device_type() != DevType::kCUDA()) {
+      LOG(WARNING) << "Activation offloading only supports CUDA devices. Skip.";
+      return f;
+    }
+    return activation_offload::ActivationOffloader(f, device, memory_budget, prefetch_distance,
+                                                   copy_stream_id)
+        .Run();
+  };
+
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "ActivationOffloadHelper", {});
+  PassInfo pass_info(2, "ActivationOffload", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ActivationOffload").set_body_typed(ActivationOffload);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,300 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file batch_gemms.cc
+ * \brief Batch the independent GEMMs of the same shapes, e.g., of the attention heads, the experts
+ * or the branches of a model, into a batch_matmul. The batched GEMM covers all of them in one
+ * launch instead of a small launch of low occupancy per GEMM.
+ */
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace batch_gemms {
+
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief A group of independent GEMMs that become a batch_matmul. */
+struct GemmGroup {
+  /*! \brief The index of the first GEMM in the let list, where the batch_matmul is placed. */
+  size_t start;
+  /*! \brief The batch_matmul op. */
+  Op op;
+  /*! \brief The static shapes of the operands and the output of each GEMM. */
+  std::vector<int64_t> a_shape;
+  std::vector<int64_t> b_shape;
+  std::vector<int64_t> out_shape;
+  /*! \brief The operands of the GEMMs and the variables bound to them. */
+  std::vector<Expr> a;
+  std::vector<Expr> b;
+  std::vector<Var> vars;
+};
+
+class GemmBatcher {
+ public:
+  explicit GemmBatcher(const Function& func) : func_(func) {
+  }
+
+  Function Run() {
+    auto ell = ExplicitLetList::make(func_->body);
+    if (!ell->ret.defined()) {
+      return func_;
+    }
+    const auto& vars = ell->vars;
+    const auto& exprs = ell->exprs;
+    std::unordered_map<const VarNode*, size_t> def_index;
+    // The open group of each key, which can only take the operands defined before its start, so
+    // its GEMMs do not depend on each other.
+    std::unordered_map<std::string, size_t> open;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      def_index[vars[i].get()] = i;
+      bindings_[vars[i].get()] = exprs[i];
+      GemmGroup candidate;
+      std::string key = GetKey(exprs[i], &candidate);
+      if (key.empty()) {
+        continue;
+      }
+      const auto* call = exprs[i].as<CallNode>();
+      auto it = open.find(key);
+      bool early = it != open.end();
+      for (const auto& arg : call->args) {
+        auto def = def_index.find(arg.as<VarNode>());
+        early = early && (def == def_index.end() || def->second < groups_[it->second].start);
+      }
+      if (!early) {
+        open[key] = groups_.size();
+        candidate.start = i;
+        groups_.push_back(std::move(candidate));
+      }
+      auto& group = groups_[open[key]];
+      group.a.push_back(call->args[0]);
+      group.b.push_back(call->args[1]);
+      group.vars.push_back(vars[i]);
+    }
+
+    std::unordered_map<size_t, const GemmGroup*> starts;
+    std::unordered_set<const VarNode*> grouped;
+    for (const auto& group : groups_) {
+      if (group.vars.size() > 1) {
+        starts[group.start] = &group;
+        for (const auto& var : group.vars) {
+          grouped.insert(var.get());
+        }
+      }
+    }
+    if (starts.empty()) {
+      return func_;
+    }
+    static const Op& split_op = Op::Get("raf.op.split");
+    static const Op& reshape_op = Op::Get("raf.op.reshape");
+    ExplicitLetList ell_out;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      auto it = starts.find(i);
+      if (it != starts.end()) {
+        const auto* group = it->second;
+        int64_t batch = group->vars.size();
+        Var a = Batch(group->a, group->a_shape, &ell_out);
+        Var b = Batch(group->b, group->b_shape, &ell_out);
+        Var out = MakeVar("batch_gemm_out", {});
+        ell_out.Push(out, Call(group->op, {a, b}));
+        // The splits along the batch axis become the views of the batched output.
+        Var parts = MakeVar("batch_gemm_parts", {});
+        ell_out.Push(parts, Call(split_op, {out, MakeConstant(ScalarValue::make(batch)),
+                                            MakeConstant(ScalarValue::make(0))}));
+        for (int64_t j = 0; j < batch; ++j) {
+          Var part = MakeVar("batch_gemm_part", {});
+          ell_out.Push(part, TupleGetItem(parts, j));
+          ell_out.Push(group->vars[j], Call(reshape_op, {part, MakeShape(group->out_shape),
+                                                         MakeConstant(BoolValue::make(false))}));
+        }
+        DLOG(INFO) << "Batched " << batch << " GEMMs into " << group->op->name;
+      } else if (grouped.count(vars[i].get())) {
+        continue;
+      } else {
+        ell_out.Push(vars[i], exprs[i]);
+      }
+    }
+    ell_out.ret = ell->ret;
+    return Function(func_->params, ell_out.AsExpr(), {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Get the static shape of a float tensor type, or return false if it is not one. */
+  static bool GetFloatShape(const Type& type, std::vector<int64_t>* shape) {
+    auto ttype = type.as<TensorTypeNode>();
+    if (ttype == nullptr || !ttype->dtype.is_float()) {
+      return false;
+    }
+    shape->clear();
+    for (const auto& dim : ttype->shape) {
+      const auto* imm = dim.as<IntImmNode>();
+      if (imm == nullptr) {
+        return false;
+      }
+      shape->push_back(imm->value);
+    }
+    return true;
+  }
+
+  /*! \brief Make the constant of a shape with the batch axis prepended. */
+  static Expr MakeShape(const std::vector<int64_t>& shape, int64_t batch = -1) {
+    std::vector<int64_t> ret;
+    if (batch >= 0) {
+      ret.push_back(batch);
+    }
+    ret.insert(ret.end(), shape.begin(), shape.end());
+    return MakeConstant(ArrayToIntTuple(ret));
+  }
+
+  /*!
+   * \brief Get the key of a 2-D GEMM that can be batched, or an empty string otherwise. The
+   * batch_matmul op and the shapes are returned in the group.
+   */
+  static std::string GetKey(const Expr& expr, GemmGroup* group) {
+    static const std::unordered_map<std::string, std::string> batched_ops = {
+        {"raf.op.matmul", "raf.op.batch_matmul"},
+        {"raf.op.matmul_nt", "raf.op.batch_matmul_nt"},
+        {"raf.op.matmul_tn", "raf.op.batch_matmul_tn"},
+        {"raf.op.matmul_tt", "raf.op.batch_matmul_tt"},
+        {"raf.op.dense", "raf.op.batch_matmul_nt"},
+    };
+    auto call = expr.as<CallNode>();
+    const auto* op = call ? call->op.as<OpNode>() : nullptr;
+    if (op == nullptr || call->args.size() != 2) {
+      return "";
+    }
+    auto it = batched_ops.find(op->name);
+    if (it == batched_ops.end() || !GetFloatShape(call->args[0]->checked_type(), &group->a_shape) ||
+        !GetFloatShape(call->args[1]->checked_type(), &group->b_shape) ||
+        !GetFloatShape(call->checked_type(), &group->out_shape) || group->a_shape.size() != 2 ||
+        group->b_shape.size() != 2) {
+      return "";
+    }
+    auto dtype = call->checked_type().as<TensorTypeNode>()->dtype;
+    if (call->args[0]->checked_type().as<TensorTypeNode>()->dtype != dtype ||
+        call->args[1]->checked_type().as<TensorTypeNode>()->dtype != dtype) {
+      return "";
+    }
+    group->op = Op::Get(it->second);
+    std::ostringstream os;
+    os << it->second << " " << dtype;
+    for (auto dim : group->a_shape) {
+      os << " " << dim;
+    }
+    os << " x";
+    for (auto dim : group->b_shape) {
+      os << " " << dim;
+    }
+    return os.str();
+  }
+
+  /*!
+   * \brief Get the tensor of the operands stacked along a new batch axis. An operand shared by all
+   * the GEMMs is broadcast, and the consecutive parts of a split along its first axis are a view of
+   * the split tensor, so neither is copied. Otherwise the operands are stacked.
+   */
+  Var Batch(const std::vector<Expr>& operands, const std::vector<int64_t>& shape,
+            ExplicitLetList* ell) {
+    static const Op& stack_op = Op::Get("raf.op.stack");
+    static const Op& reshape_op = Op::Get("raf.op.reshape");
+    int64_t batch = operands.size();
+    Var ret = MakeVar("batch_gemm_in", {});
+    bool shared = std::all_of(operands.begin(), operands.end(),
+                              [&](const Expr& operand) { return operand.same_as(operands[0]); });
+    if (shared) {
+      ell->Push(ret, Call(reshape_op, {operands[0], MakeShape(shape, 1),
+                                       MakeConstant(BoolValue::make(false))}));
+      return ret;
+    }
+    Expr source = GetSplitSource(operands);
+    if (source.defined()) {
+      ell->Push(ret, Call(reshape_op, {source, MakeShape(shape, batch),
+                                       MakeConstant(BoolValue::make(false))}));
+      return ret;
+    }
+    Var tuple = MakeVar("batch_gemm_tuple", {});
+    ell->Push(tuple, Tuple(Array<Expr>(operands.begin(), operands.end())));
+    ell->Push(ret, Call(stack_op, {tuple, MakeConstant(ScalarValue::make(0))}));
+    return ret;
+  }
+
+  /*!
+   * \brief Get the tensor whose split along its first axis into the same number of sections gives
+   * the operands in order, or undefined if there is none.
+   */
+  Expr GetSplitSource(const std::vector<Expr>& operands) {
+    static const Op& split_op = Op::Get("raf.op.split");
+    Expr split;
+    for (size_t i = 0; i < operands.size(); ++i) {
+      auto it = bindings_.find(operands[i].as<VarNode>());
+      const auto* item = it != bindings_.end() ? it->second.as<TupleGetItemNode>() : nullptr;
+      if (item == nullptr || item->index != static_cast<int>(i) ||
+          (split.defined() && !item->tuple.same_as(split))) {
+        return Expr();
+      }
+      split = item->tuple;
+    }
+    auto it = bindings_.find(split.as<VarNode>());
+    const auto* call = it != bindings_.end() ? it->second.as<CallNode>() : nullptr;
+    if (call == nullptr || !call->op.same_as(split_op) || call->args.size() != 3) {
+      return Expr();
+    }
+    const auto* sections = call->args[1].as<ConstantNode>();
+    const auto* axis = call->args[2].as<ConstantNode>();
+    if (sections == nullptr || axis == nullptr || !sections->value.defined() ||
+        !axis->value.defined()) {
+      return Expr();
+    }
+    const auto* num_sections = sections->value.as<IntValueObj>();
+    const auto* axis_value = axis->value.as<IntValueObj>();
+    const auto* ttype = call->args[0]->checked_type().as<TensorTypeNode>();
+    if (num_sections == nullptr || axis_value == nullptr || ttype == nullptr ||
+        num_sections->value != static_cast<int64_t>(operands.size())) {
+      return Expr();
+    }
+    int64_t ndim = ttype->shape.size();
+    if (axis_value->value != 0 && axis_value->value != -ndim) {
+      return Expr();
+    }
+    return call->args[0];
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The expressions bound to the variables of the let list. */
+  std::unordered_map<const VarNode*, Expr> bindings_;
+  /*! \brief The groups in the order of their starts. */
+  std::vector<GemmGroup> groups_;
+};
+
+}  // namespace batch_gemms
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.batch_gemms", Bool);
+
+Pass BatchGemms() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return batch_gemms::GemmBatcher(f).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "BatchGemmsHelper", {});
+  PassInfo pass_info(1, "BatchGemms", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.BatchGemms").set_body_typed(BatchGemms);
+
+}  // namespace pass
+}  // namespace raf
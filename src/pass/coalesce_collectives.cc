@@ -0,0 +1,278 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file coalesce_collectives.cc
+ * \brief Coalesce the consecutive independent collectives of the same kind into a single NCCL
+ * launch. Allgathers and reduce-scatters become their group variants, which issue the NCCL calls
+ * in one ncclGroupStart/End, and allreduces are fused into one bucket. This saves the launch and
+ * synchronization latency of each collective, which dominates small messages.
+ */
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "raf/dist_config.h"
+#include "raf/communicator.h"
+
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace coalesce_collectives {
+
+using namespace raf::op;
+using raf::distributed::DistConfig;
+using namespace raf::distributed::communicator;
+
+/*! \brief A run of consecutive collectives to be coalesced. */
+struct CollectiveRun {
+  /*! \brief The kind and attributes of the collectives, which must be identical in a run. */
+  std::string key;
+  /*! \brief The variables bound to the collectives. */
+  std::vector<Var> vars;
+  /*! \brief The collective calls. */
+  std::vector<Call> calls;
+  /*! \brief The total number of elements. */
+  int64_t num_elements = 0;
+};
+
+class CollectiveCoalescer {
+ public:
+  CollectiveCoalescer(const Function& func, int64_t bucket_size)
+      : func_(func), bucket_size_(bucket_size) {
+  }
+
+  Function Run() {
+    auto ell = ExplicitLetList::make(func_->body);
+    const auto& vars = ell->vars;
+    const auto& exprs = ell->exprs;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      if (auto tuple = exprs[i].as<TupleNode>()) {
+        tuples_[vars[i].get()] = GetRef<Tuple>(tuple);
+      }
+    }
+
+    std::unordered_set<const Object*> run_vars;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      // A binding that uses the output of a pending collective ends the run.
+      bool depends = false;
+      for (const auto& var : FreeVars(exprs[i])) {
+        depends |= run_vars.count(var.get()) > 0;
+      }
+      auto call = exprs[i].as<CallNode>();
+      std::string key = call ? GetKey(GetRef<Call>(call)) : "";
+      int64_t num_elements = key.empty() ? 0 : NumElements(vars[i]->checked_type());
+      if (depends || (!key.empty() && (key != run_.key ||
+                                       run_.num_elements + num_elements > bucket_size_))) {
+        Flush();
+        run_vars.clear();
+      }
+      if (!key.empty()) {
+        run_.key = key;
+        run_.vars.push_back(vars[i]);
+        run_.calls.push_back(GetRef<Call>(call));
+        run_.num_elements += num_elements;
+        run_vars.insert(vars[i].get());
+      } else if (!run_.vars.empty() && (exprs[i]->IsInstance<TupleNode>() ||
+                                        exprs[i]->IsInstance<TupleGetItemNode>())) {
+        // Packing the arguments of the next collective does not end the run.
+        ell_.Push(vars[i], exprs[i]);
+      } else {
+        Flush();
+        run_vars.clear();
+        ell_.Push(vars[i], exprs[i]);
+      }
+    }
+    Flush();
+    ell_.ret = ell->ret;
+    if (num_coalesced_ > 0) {
+      DLOG(INFO) << "Coalesced " << num_coalesced_ << " collectives";
+    }
+    return Function(func_->params, ell_.AsExpr(), {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Get the key of a collective that can be coalesced, or an empty string otherwise.
+   * Allgathers and reduce-scatters have group variants only for the global communicator, and
+   * the group allgather only gathers along the first axis.
+   */
+  std::string GetKey(const Call& call) {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    static const Op& reduce_scatter_op = Op::Get("raf.op._reduce_scatter");
+    auto op = call->op.as<OpNode>();
+    if (op == nullptr) {
+      return "";
+    }
+    auto is_null = [](const Expr& expr) {
+      auto konst = expr.as<ConstantNode>();
+      return konst != nullptr && !konst->value.defined();
+    };
+    auto attr = [](const Expr& expr) {
+      return expr->IsInstance<ConstantNode>() ? raf::ir::AsText(expr, false) : "";
+    };
+    if (op == allreduce_op.get()) {
+      auto ttype = call->args[0]->checked_type().as<TupleTypeNode>();
+      auto rank_list = attr(call->args[2]);
+      if (ttype == nullptr || ttype->fields.empty() || rank_list.empty()) {
+        return "";
+      }
+      auto dtype = ttype->fields[0].as<TensorTypeNode>();
+      for (const auto& field : ttype->fields) {
+        auto field_type = field.as<TensorTypeNode>();
+        if (dtype == nullptr || field_type == nullptr || field_type->dtype != dtype->dtype) {
+          return "";
+        }
+      }
+      return "allreduce " + attr(call->args[1]) + " " + DLDataType2String(dtype->dtype) + " " +
+             rank_list;
+    } else if (op == allgather_op.get()) {
+      auto axis = call->args[1].as<ConstantNode>();
+      if (axis == nullptr || !is_null(call->args[2]) ||
+          GetScalarValueData<int64_t>(Downcast<Value>(axis->value)) != 0) {
+        return "";
+      }
+      return "allgather";
+    } else if (op == reduce_scatter_op.get()) {
+      if (!is_null(call->args[2])) {
+        return "";
+      }
+      return "reduce_scatter " + attr(call->args[1]);
+    }
+    return "";
+  }
+
+  /*! \brief Get the number of elements of a tensor or a tuple of tensors. */
+  static int64_t NumElements(const Type& type) {
+    if (auto ttype = type.as<TupleTypeNode>()) {
+      int64_t n = 0;
+      for (const auto& field : ttype->fields) {
+        n += NumElements(field);
+      }
+      return n;
+    }
+    auto ttype = type.as<TensorTypeNode>();
+    CHECK(ttype != nullptr) << "Expected a tensor type, but got " << type;
+    int64_t n = 1;
+    for (const auto& dim : ttype->shape) {
+      auto imm = dim.as<IntImmNode>();
+      CHECK(imm != nullptr) << "Do not support dynamic shape yet";
+      n *= imm->value;
+    }
+    return n;
+  }
+
+  /*! \brief Get the i-th tensor in the tuple x. */
+  Expr GetField(const Expr& x, int i) {
+    auto it = tuples_.find(x.get());
+    if (it != tuples_.end()) {
+      return it->second->fields[i];
+    }
+    auto field = MakeVar("field", {});
+    ell_.Push(field, TupleGetItem(x, i));
+    return field;
+  }
+
+  /*! \brief Emit the pending run as a single collective, and clear it. */
+  void Flush() {
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    static const Op& group_allgather_op = Op::Get("raf.op._group_allgather");
+    static const Op& group_reduce_scatter_op = Op::Get("raf.op._group_reduce_scatter");
+    static const Op& zeros_op = Op::Get("raf.op.zeros");
+    auto& calls = run_.calls;
+    if (calls.size() == 1) {
+      ell_.Push(run_.vars[0], calls[0]);
+    } else if (calls.size() > 1) {
+      Array<Expr> inputs;
+      // The number of tensors of each collective, which is only greater than 1 for allreduces.
+      std::vector<int> num_tensors;
+      for (const auto& call : calls) {
+        if (call->op.same_as(allreduce_op)) {
+          int n = call->args[0]->checked_type().as<TupleTypeNode>()->fields.size();
+          for (int i = 0; i < n; ++i) {
+            inputs.push_back(GetField(call->args[0], i));
+          }
+          num_tensors.push_back(n);
+        } else {
+          inputs.push_back(call->args[0]);
+          num_tensors.push_back(1);
+        }
+      }
+      auto input_tuple = MakeVar("coalesce_in", {});
+      auto coalesced = MakeVar("coalesced", {});
+      ell_.Push(input_tuple, Tuple(inputs));
+      if (calls[0]->op.same_as(allreduce_op)) {
+        ell_.Push(coalesced, Call(allreduce_op, {input_tuple, calls[0]->args[1],
+                                                 calls[0]->args[2]}));
+      } else if (run_.key == "allgather") {
+        auto device = "cuda(" + std::to_string(GetGlobalCommunicator()->local_rank) + ")";
+        Array<Expr> outputs;
+        for (const auto& var : run_.vars) {
+          auto ttype = var->checked_type().as<TensorTypeNode>();
+          auto zeros = MakeVar("coalesce_out", {});
+          ell_.Push(zeros, Call(zeros_op, {MakeConstant(ArrayToIntTuple(ttype->shape)),
+                                           MakeConstant(StringValue::make(
+                                               DLDataType2String(ttype->dtype))),
+                                           MakeConstant(StringValue::make(device))}));
+          outputs.push_back(zeros);
+        }
+        auto output_tuple = MakeVar("coalesce_outs", {});
+        ell_.Push(output_tuple, Tuple(outputs));
+        ell_.Push(coalesced, Call(group_allgather_op, {input_tuple, calls[0]->args[1],
+                                                       output_tuple}));
+      } else {
+        ell_.Push(coalesced, Call(group_reduce_scatter_op, {input_tuple, calls[0]->args[1]}));
+      }
+      int offset = 0;
+      for (size_t j = 0; j < calls.size(); ++j) {
+        if (num_tensors[j] == 1) {
+          ell_.Push(run_.vars[j], TupleGetItem(coalesced, offset));
+        } else {
+          Array<Expr> fields;
+          for (int i = 0; i < num_tensors[j]; ++i) {
+            auto field = MakeVar("field", {});
+            ell_.Push(field, TupleGetItem(coalesced, offset + i));
+            fields.push_back(field);
+          }
+          ell_.Push(run_.vars[j], Tuple(fields));
+        }
+        offset += num_tensors[j];
+      }
+      num_coalesced_ += calls.size();
+    }
+    run_ = CollectiveRun();
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The maximal number of elements in a coalesced collective. */
+  int64_t bucket_size_;
+  /*! \brief The let list of the output function. */
+  ExplicitLetList ell_;
+  /*! \brief The pending run of collectives. */
+  CollectiveRun run_;
+  /*! \brief Mapping from a variable to the tuple bound to it. */
+  std::unordered_map<const Object*, Tuple> tuples_;
+  /*! \brief The number of coalesced collectives. */
+  size_t num_coalesced_ = 0;
+};
+
+}  // namespace coalesce_collectives
+
+Pass CoalesceCollectives() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    auto bucket_size = DistConfig::Global()->group_bucket_size;
+    return coalesce_collectives::CollectiveCoalescer(f, bucket_size).Run();
+  };
+  auto coalesce = CreateRAFFunctionPass(pass_func, 0, "CoalesceCollectivesFunc", {});
+  return RAFSequential({InferType(), coalesce, InferType()}, "CoalesceCollectives");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.CoalesceCollectives").set_body_typed(CoalesceCollectives);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,308 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file convert_layout.cc
+ * \brief Convert the layout of conv nets from NCHW to NHWC, which is the native layout of tensor
+ * cores, and only transpose the tensors where the NHWC region begins and ends.
+ */
+#include <algorithm>
+#include <unordered_set>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace convert_layout {
+
+using namespace raf::op;
+using namespace raf::value;
+
+template <typename T>
+using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+
+/*! \brief The axes to transpose NCHW to NHWC, which also transpose OIHW to OHWI. */
+static const std::vector<int64_t> kToNHWC = {0, 2, 3, 1};
+/*! \brief The axes to transpose NHWC to NCHW. */
+static const std::vector<int64_t> kToNCHW = {0, 3, 1, 2};
+
+/*! \brief Get the rank of a tensor, or -1 if the expression is not a typed tensor. */
+int64_t GetRank(const Expr& expr) {
+  if (!expr->checked_type_.defined()) {
+    return -1;
+  }
+  const auto* ttype = expr->checked_type().as<TensorTypeNode>();
+  return ttype ? ttype->shape.size() : -1;
+}
+
+/*! \brief Get the value of a constant argument, or an undefined value if it is not a constant. */
+Value GetConstValue(const Expr& expr) {
+  const auto* node = expr.as<ConstantNode>();
+  return node ? Downcast<Value>(ConstantExtractValue(GetRef<Constant>(node))) : Value();
+}
+
+/*! \brief Whether the argument is the constant string. */
+bool IsConstString(const Expr& expr, const std::string& str) {
+  auto value = GetConstValue(expr);
+  const auto* node = value.as<StringValueObj>();
+  return node && node->value == str;
+}
+
+/*! \brief Whether the argument is one of the constant integers. */
+bool IsConstInt(const Expr& expr, const std::vector<int64_t>& ints) {
+  auto value = GetConstValue(expr);
+  const auto* node = value.as<IntValueObj>();
+  return node && std::find(ints.begin(), ints.end(), node->value) != ints.end();
+}
+
+/*! \brief Whether the argument is the constant tuple of integers. */
+bool IsConstInts(const Expr& expr, const std::vector<int64_t>& ints) {
+  auto value = GetConstValue(expr);
+  return value.defined() && value->IsInstance<TupleValueObj>() &&
+         GetShapeVecFromValue(value) == ints;
+}
+
+/*!
+ * \brief Rewrite the conv2d, the pools and the layout-agnostic ops that consume their outputs to
+ * the NHWC layout. Each let-binding var keeps its NCHW meaning: the NHWC value of a rewritten var
+ * is bound to a new var, and the NCHW value is only computed by a transpose right before the first
+ * use that does not take NHWC. A transpose from NHWC to NCHW in the input program is not computed
+ * at all if its result is only used in NHWC.
+ */
+class LayoutConverter {
+ public:
+  explicit LayoutConverter(const Function& func)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  Function Run() {
+    if (!ell_->ret.defined()) {
+      return func_;
+    }
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      if (RecordTransposeToNCHW(vars[i], exprs[i])) {
+        continue;
+      }
+      Expr nhwc = RewriteToNHWC(exprs[i]);
+      if (nhwc.defined()) {
+        Var nhwc_var = MakeVar(vars[i]->name_hint() + "_nhwc", {});
+        ell_out_.Push(nhwc_var, nhwc);
+        nhwc_[vars[i]] = nhwc_var;
+        pending_.insert(vars[i]);
+        continue;
+      }
+      for (const auto& var : FreeVars(exprs[i])) {
+        ToNCHW(var);
+      }
+      ell_out_.Push(vars[i], exprs[i]);
+    }
+    ToNCHW(ell_->ret);
+    ell_out_.ret = ell_->ret;
+    return Function(func_->params, ell_out_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Rewrite an expression to NHWC.
+   * \param expr The bound expression.
+   * \return The expression in NHWC, or an undefined expression if it is not rewritten.
+   */
+  Expr RewriteToNHWC(const Expr& expr) {
+    static const Op& conv2d = Op::Get("raf.op.conv2d");
+    static const Op& bias_add = Op::Get("raf.op.bias_add");
+    static const std::unordered_set<std::string> pools = {"raf.op.max_pool2d",
+                                                          "raf.op.avg_pool2d"};
+    static const std::unordered_set<std::string> adaptive_pools = {"raf.op.adaptive_max_pool2d",
+                                                                   "raf.op.adaptive_avg_pool2d"};
+    static const std::unordered_set<std::string> unary_ops = {
+        "raf.op.relu", "raf.op.gelu",     "raf.op.tanh", "raf.op.sigmoid",
+        "raf.op.copy", "raf.op.negative", "raf.op.cast", "raf.op.clip"};
+    static const std::unordered_set<std::string> binary_ops = {
+        "raf.op.add",    "raf.op.subtract", "raf.op.multiply",
+        "raf.op.divide", "raf.op.maximum",  "raf.op.minimum"};
+
+    auto call = expr.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>() || call->args.empty()) {
+      return Expr();
+    }
+    auto op = Downcast<Op>(call->op);
+    const auto& args = call->args;
+    Array<Expr> new_args(args.begin(), args.end());
+    if (op == conv2d) {
+      // Grouped convs are left in NCHW, as not all the backends have them in NHWC.
+      if (GetRank(args[0]) != 4 || GetRank(args[1]) != 4 || !IsConstString(args[6], "NCHW") ||
+          !IsConstString(args[7], "OIHW") || !IsConstString(args[8], "NCHW") ||
+          !IsConstInt(args[5], {1})) {
+        return Expr();
+      }
+      new_args.Set(0, ToNHWC(args[0]));
+      new_args.Set(1, ToNHWC(args[1]));
+      new_args.Set(6, MakeConstant(StringValue::make("NHWC")));
+      new_args.Set(7, MakeConstant(StringValue::make("OHWI")));
+      new_args.Set(8, MakeConstant(StringValue::make("NHWC")));
+    } else if (pools.count(op->name) || adaptive_pools.count(op->name)) {
+      size_t layout_idx = pools.count(op->name) ? 8 : 2;
+      if (GetRank(args[0]) != 4 || !IsConstString(args[layout_idx], "NCHW")) {
+        return Expr();
+      }
+      new_args.Set(0, ToNHWC(args[0]));
+      new_args.Set(layout_idx, MakeConstant(StringValue::make("NHWC")));
+    } else if (op == bias_add) {
+      // The other ops are only rewritten to continue the NHWC region of their inputs.
+      if (!IsNHWC(args[0]) || !IsConstInt(args[2], {1, -3})) {
+        return Expr();
+      }
+      new_args.Set(0, ToNHWC(args[0]));
+      new_args.Set(2, MakeConstant(ScalarValue::make(3)));
+    } else if (unary_ops.count(op->name)) {
+      if (!IsNHWC(args[0])) {
+        return Expr();
+      }
+      new_args.Set(0, ToNHWC(args[0]));
+    } else if (binary_ops.count(op->name)) {
+      if (GetRank(expr) != 4 || !(IsNHWC(args[0]) || IsNHWC(args[1])) ||
+          !CanBroadcastInNHWC(args[0]) || !CanBroadcastInNHWC(args[1])) {
+        return Expr();
+      }
+      new_args.Set(0, BroadcastInNHWC(args[0]));
+      new_args.Set(1, BroadcastInNHWC(args[1]));
+    } else {
+      return Expr();
+    }
+    return Call(op, new_args, call->attrs, call->type_args);
+  }
+
+  /*!
+   * \brief Record the NHWC value of a transpose from NHWC to NCHW in the input program, so the
+   * transpose is not computed if its result is only used in NHWC.
+   * \param var The var the expression is bound to.
+   * \param expr The bound expression.
+   * \return Whether the expression is such a transpose.
+   */
+  bool RecordTransposeToNCHW(const Var& var, const Expr& expr) {
+    static const Op& transpose = Op::Get("raf.op.transpose");
+    auto call = expr.as<CallNode>();
+    if (call == nullptr || call->op != transpose || !call->args[0]->IsInstance<VarNode>() ||
+        GetRank(call->args[0]) != 4 || !IsConstInts(call->args[1], kToNCHW)) {
+      return false;
+    }
+    auto x = Downcast<Var>(call->args[0]);
+    ToNCHW(x);
+    nhwc_[var] = x;
+    pending_.insert(var);
+    return true;
+  }
+
+  /*! \brief Whether the NHWC value of the expression is available without a transpose. */
+  bool IsNHWC(const Expr& expr) {
+    const auto* var = expr.as<VarNode>();
+    return var && nhwc_.count(GetRef<Var>(var));
+  }
+
+  /*! \brief Get the NHWC value of a 4-D tensor, which is transposed from NCHW if needed. */
+  Var ToNHWC(const Expr& expr) {
+    const auto* var = expr.as<VarNode>();
+    if (var == nullptr) {
+      return PushTranspose(expr, kToNHWC);
+    }
+    auto it = nhwc_.find(GetRef<Var>(var));
+    if (it != nhwc_.end()) {
+      return it->second;
+    }
+    return nhwc_[GetRef<Var>(var)] = PushTranspose(expr, kToNHWC);
+  }
+
+  /*! \brief Compute the NCHW value of a var, if it has not been computed. */
+  void ToNCHW(const Var& var) {
+    if (pending_.erase(var)) {
+      ell_out_.Push(var, Transpose(nhwc_.at(var), kToNCHW));
+    }
+  }
+
+  /*!
+   * \brief Whether an operand that is broadcast to a 4-D NCHW tensor can be broadcast to NHWC,
+   * i.e., it is a tensor of rank 3 or 4, or a tensor whose dimensions are all 1.
+   */
+  bool CanBroadcastInNHWC(const Expr& expr) {
+    int64_t rank = GetRank(expr);
+    if (rank == 3 || rank == 4) {
+      return true;
+    }
+    if (rank < 0) {
+      return false;
+    }
+    for (const auto& dim : expr->type_as<TensorTypeNode>()->shape) {
+      const auto* imm = dim.as<IntImmNode>();
+      if (imm == nullptr || imm->value != 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Get the operand that is broadcast to a 4-D NHWC tensor. */
+  Expr BroadcastInNHWC(const Expr& expr) {
+    int64_t rank = GetRank(expr);
+    if (rank == 4) {
+      return ToNHWC(expr);
+    } else if (rank == 3) {
+      // The operand is broadcast to the trailing (C, H, W) dimensions.
+      return PushTranspose(expr, {1, 2, 0});
+    }
+    return expr;
+  }
+
+  /*! \brief Bind a transpose of the expression to a new var. */
+  Var PushTranspose(const Expr& expr, const std::vector<int64_t>& axes) {
+    const auto* var = expr.as<VarNode>();
+    Var ret = MakeVar((var ? var->name_hint() : "x") + "_nhwc", {});
+    ell_out_.Push(ret, Transpose(expr, axes));
+    return ret;
+  }
+
+  /*! \brief Make a transpose. */
+  static Expr Transpose(const Expr& expr, const std::vector<int64_t>& axes) {
+    static const Op& op = Op::Get("raf.op.transpose");
+    return Call(op, {expr, MakeConstant(ArrayToIntTuple(axes))});
+  }
+
+  /*! \brief The function to be converted. */
+  const Function& func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The let list of the converted function. */
+  ExplicitLetList ell_out_;
+  /*! \brief The var of the NHWC value of each 4-D var. */
+  StdMap<Var> nhwc_;
+  /*! \brief The vars whose NCHW values have not been computed. */
+  std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> pending_;
+};
+
+}  // namespace convert_layout
+
+Pass ConvertLayout(String layout) {
+  CHECK_EQ(layout, "NHWC") << "Only converting to NHWC is supported, but got " << layout;
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return convert_layout::LayoutConverter(f).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "ConvertLayoutHelper", {});
+  PassInfo pass_info(1, "ConvertLayout", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ConvertLayout").set_body_typed(ConvertLayout);
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.layout.convert", String);
+
+}  // namespace pass
+}  // namespace raf
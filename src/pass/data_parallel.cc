@@ -242,6 +242,14 @@ struct DataParallel {
     } else {
       LOG(FATAL) << "Return of backward IR must be Var or tuple of Vars in Data Parallel Pass.";
     }
+    auto pass_ctx = PassContext::Current();
+    if (pass_ctx->GetConfig("raf.sparse_embedding_grad", Bool(false)).value()) {
+      for (const auto* var : SparsifyEmbeddingGrads(gradset)) {
+        gradset.erase(var);
+      }
+      fp_ell->exprs[fp_n - 2] = Function(bp_params, bp_ell->AsExpr(), {}, {});
+      bp_n = bp_ell->vars.size();
+    }
     if (gradset.empty()) {
       return Function(func->params, fp_ell->AsExpr(), {}, {});
     }
@@ -319,8 +327,8 @@ struct DataParallel {
     Array<Expr> new_bp_rt;
     if (const auto* tuple = bp_grads.as<TupleNode>()) {
       for (int i = 0; i < tuple->fields.size(); ++i) {
-        if (tuple->fields[i]->IsInstance<VarNode>()) {
-          auto it = var_var_map.find(tuple->fields[i]);
+        auto it = var_var_map.find(tuple->fields[i]);
+        if (it != var_var_map.end()) {
           new_bp_rt.push_back(it->second);
         } else {
           new_bp_rt.push_back(tuple->fields[i]);
@@ -328,7 +336,7 @@ struct DataParallel {
       }
     } else if (bp_grads->IsInstance<VarNode>()) {
       auto it = var_var_map.find(bp_grads);
-      new_bp_rt.push_back(it->second);
+      new_bp_rt.push_back(it != var_var_map.end() ? it->second : Downcast<Var>(bp_grads));
     } else {
       LOG(FATAL) << "Return of backward IR must be Var or tuple of Vars in Data Parallel Pass.";
     }
@@ -348,6 +356,53 @@ struct DataParallel {
     return Function(func->params, fp_ell->AsExpr(), {}, {});
   }
 
+  /*!
+   * \brief Communicate the gradients of embedding_dx in the row-sparse form, i.e., allgather the
+   * rows and the values of embedding_sparse_dx instead of allreducing the dense gradients. The
+   * gathered rows are scattered to the global gradient, which stays dense for the closure, but
+   * is folded into the row-sparse SGD by SparseEmbeddingGrad.
+   * \param gradset The gradients returned by the backward closure.
+   * \return The gradients that are communicated in the row-sparse form.
+   */
+  std::set<const VarNode*> SparsifyEmbeddingGrads(const std::set<const VarNode*>& gradset) {
+    static const Op& embedding_dx = Op::Get("raf.op.embedding_dx");
+    static const Op& sparse_dx = Op::Get("raf.op.embedding_sparse_dx");
+    static const Op& allgather = Op::Get("raf.op._allgather");
+    static const Op& divide = Op::Get("raf.op.divide");
+    auto comm = GetGlobalCommunicator();
+    auto axis = MakeConstant(ScalarValue::make(0));
+    auto rank_list = MakeConstant(NullValue<Value>());
+    auto size = MakeConstant(ScalarValue::make(float(comm->size)));
+    std::set<const VarNode*> sparse;
+    auto ell = std::make_unique<ExplicitLetList>();
+    for (size_t i = 0; i < bp_ell->vars.size(); ++i) {
+      const Var& var = bp_ell->vars[i];
+      const auto* call = bp_ell->exprs[i].as<CallNode>();
+      if (!gradset.count(var.get()) || call == nullptr || call->op != embedding_dx) {
+        ell->Push(var, bp_ell->exprs[i]);
+        continue;
+      }
+      Var local = MakeVar("sparse_grad", {});
+      Var rows = MakeVar("sparse_rows", {});
+      Var values = MakeVar("sparse_values", {});
+      Var g_rows = MakeVar("g_rows", {});
+      Var g_values_sum = MakeVar("g_values_sum", {});
+      Var g_values = MakeVar("g_values", {});
+      ell->Push(local, Call(sparse_dx, call->args));
+      ell->Push(rows, TupleGetItem(local, 0));
+      ell->Push(values, TupleGetItem(local, 1));
+      ell->Push(g_rows, Call(allgather, {rows, axis, rank_list}));
+      ell->Push(g_values_sum, Call(allgather, {values, axis, rank_list}));
+      ell->Push(g_values, Call(divide, {g_values_sum, size}));
+      // The padding rows of -1 are skipped by embedding_dx.
+      ell->Push(var, Call(embedding_dx, {g_values, g_rows, call->args[2]}));
+      sparse.insert(var.get());
+    }
+    ell->ret = bp_ell->ret;
+    bp_ell = std::move(ell);
+    return sparse;
+  }
+
  private:
   // initialized in constructor
   const FunctionNode* func;
@@ -8,6 +8,7 @@
  * \brief Schedules ops during data parallel training.
  */
 #include <queue>
+#include <set>
 #include <unordered_set>
 #include <relay/transforms/pass_utils.h>
 #include "raf/ir.h"
@@ -20,7 +21,9 @@
 #include "./common.h"
 #include "let_list.h"
 #include "stream_schedule.h"
+#include "optimizer_update.h"
 #include "raf/stream_pool.h"
+#include "../analysis/dependency_graph.h"
 
 namespace raf {
 namespace pass {
@@ -34,11 +37,85 @@ using stream_pool::StreamTagEnum;
 using tvm::OpAttrMap;
 using Node = DependencyGraph::Node;
 using LinkedList = tvm::relay::LinkedList<Node*>;
-using NodeExprMap = std::unordered_map<const Node*, Expr>;
+using analysis::dependency_graph::CSRGraph;
 using stream_schedule::StreamSchedulerBase;
+using optimizer_update::StepGraph;
+using optimizer_update::Updates;
+
+/*! \brief The expression of each node of the CSR graph of the dependency graph. */
+std::vector<Expr> GetNodeExprs(const DependencyGraph& dfg, const CSRGraph& graph) {
+  std::vector<Expr> node_expr(graph.size());
+  for (auto& it : dfg.expr_node) {
+    int i = graph.index(it.second);
+    if (i >= 0) {
+      node_expr[i] = it.first;
+    }
+  }
+  return node_expr;
+}
+
+/*! \brief The node of the primary output, which is the first field if the function returns a
+ * tuple, or -1 if not found. */
+int GetPrimaryNode(const DependencyGraph& dfg, const CSRGraph& graph,
+                   const std::vector<Expr>& node_expr) {
+  int num_nodes = graph.size();
+  if (num_nodes == 0) {
+    return -1;
+  }
+  int root = num_nodes - 1;
+  if (auto tuple = node_expr[root].as<TupleNode>()) {
+    auto it = dfg.expr_node.end();
+    if (!tuple->fields.empty()) {
+      it = dfg.expr_node.find(tuple->fields[0]);
+    }
+    return it != dfg.expr_node.end() ? graph.index(it->second) : -1;
+  }
+  return root;
+}
+
+/*!
+ * \brief Find the optimizer updates to overlap with the backward if it is enabled. The updates
+ * are issued as soon as they are ready, and EnforceSync runs them on their own stream.
+ * \param followers The updates to release after each node, in addition to its users.
+ */
+Updates FindOverlappedUpdates(const DependencyGraph& dfg, const CSRGraph& graph,
+                              const std::vector<Expr>& node_expr,
+                              const std::unordered_set<const Object*>& params, bool overlap,
+                              std::vector<std::vector<int>>* followers) {
+  int num_nodes = graph.size();
+  followers->assign(num_nodes, {});
+  if (!overlap) {
+    Updates ret;
+    ret.is_update.assign(num_nodes, false);
+    ret.readers.resize(num_nodes);
+    return ret;
+  }
+  StepGraph step;
+  step.exprs = node_expr;
+  step.producers.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    step.producers[i].assign(graph.children(i).begin(), graph.children(i).end());
+  }
+  step.primary = GetPrimaryNode(dfg, graph, node_expr);
+  step.root = num_nodes - 1;
+  Updates ret = optimizer_update::FindUpdates(step, params);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (int reader : ret.readers[i]) {
+      (*followers)[reader].push_back(i);
+    }
+  }
+  return ret;
+}
 
 class FIFOScheduler : public StreamSchedulerBase {
  public:
+  FIFOScheduler(const Array<Var>& params, bool overlap_optimizer)
+      : overlap_optimizer_(overlap_optimizer) {
+    for (const auto& param : params) {
+      params_.insert(param.get());
+    }
+  }
+
   /*! This scheduler schedules the execution order of ops so communication ops can better overlap
    * with computation ops. It works on BBNF/GNF and outputs the scheduled expression in ANF.
    *
@@ -101,70 +178,88 @@ class FIFOScheduler : public StreamSchedulerBase {
    *
    * By using a separate queue for ops that directly depends on a communication,
    * those ops are delayed until no other op is available, leaving more room for overlap.
+   *
+   * When raf.data_parallel_schedule.overlap_optimizer is set, the optimizer updates (see
+   * optimizer_update::FindUpdates) are instead issued as soon as they are ready, i.e., right
+   * after their gradients are reduced, so they run on their own stream along with the rest of
+   * the backward rather than after it.
    */
   Expr Schedule(Expr e) {
     // create the data flow graph
     Arena arena;
     DependencyGraph dfg = CreateDependencyGraph(&arena, e, /*prune_atomic_nodes=*/true);
+    CSRGraph graph(dfg.post_dfs_order);
     // map each node in the dependency graph to the expression it represents
-    NodeExprMap node_expr;
+    std::vector<Expr> node_expr = GetNodeExprs(dfg, graph);
     // ready queue for all ops that directly depends on a communication op
-    std::queue<Node*> comm_successor_ready_queue;
+    std::queue<int> comm_successor_ready_queue;
     // ready queue for all other ops
-    std::queue<Node*> ready_queue;
+    std::queue<int> ready_queue;
     // counter that keeps track of the number of each op's current unscheduled predecessors
     // the dependency graph in tvm is a data flow graph with edge direction reversed, so we
     // use out-degree here instead of in-degree.
-    std::unordered_map<Node*, int> out_degree;
+    std::vector<int> out_degree(graph.size());
     // keeps track of whether an op directly depends on a communication op
-    std::unordered_set<Node*> comm_successor_nodes;
-
-    for (auto& it : dfg.expr_node) {
-      node_expr[it.second] = it.first;
-    }
-    std::vector<Node*>& nodes = dfg.post_dfs_order;
+    std::vector<bool> comm_successor_nodes(graph.size(), false);
+    // ready queue for the optimizer updates, which are issued immediately
+    std::queue<int> update_ready_queue;
+    std::vector<std::vector<int>> followers;
+    Updates updates =
+        FindOverlappedUpdates(dfg, graph, node_expr, params_, overlap_optimizer_, &followers);
 
     // calculate out-degree for each node and populate comm_successor_nodes map
-    for (auto node_it = nodes.rbegin(); node_it != nodes.rend(); node_it++) {
-      out_degree[(*node_it)] = 0;
-      if (auto call_node = node_expr[*node_it].as<CallNode>()) {
+    for (int i = graph.size() - 1; i >= 0; --i) {
+      if (auto call_node = node_expr[i].as<CallNode>()) {
         if (IsCollectiveOp(call_node->op)) {
           // record direct successor nodes of communication op
-          for (auto parent = (*node_it)->parents.head; parent; parent = parent->next) {
-            comm_successor_nodes.insert(parent->value);
+          for (int parent : graph.parents(i)) {
+            comm_successor_nodes[parent] = true;
           }
         }
       }
-
-      for (auto child = (*node_it)->children.head; child; child = child->next) {
-        out_degree[(*node_it)]++;
-      }
+      out_degree[i] = graph.children(i).size() + updates.readers[i].size();
     }
     // push nodes with zero predecessors into the queue
-    for (auto& node : nodes) {
-      if (out_degree[node] == 0) {
-        ready_queue.push(node);
+    for (int i = 0; i < graph.size(); ++i) {
+      if (out_degree[i] == 0) {
+        ready_queue.push(i);
       }
     }
 
     Expr ret;
+    auto release = [&](int node) {
+      out_degree[node]--;
+      if (out_degree[node] == 0) {
+        if (updates.is_update[node]) {
+          update_ready_queue.push(node);
+        } else if (comm_successor_nodes[node]) {
+          comm_successor_ready_queue.push(node);
+        } else {
+          ready_queue.push(node);
+        }
+      }
+    };
+    auto issue = [&](int node) {
+      ret = VisitExpr(node_expr[node]);
+      for (int parent : graph.parents(node)) {
+        release(parent);
+      }
+      for (int follower : followers[node]) {
+        release(follower);
+      }
+    };
     // in each step, we pop an op out of the queue, add it to the ANF and
     // push all its ready successors into the corresponding ready queue
-    auto process_queue_element = [&](std::queue<Node*>& q) {
+    auto process_queue_element = [&](std::queue<int>& q) {
       while (!q.empty()) {
-        Node* node = q.front();
-        ret = VisitExpr(node_expr.at(node));
-        for (auto parent = node->parents.head; parent; parent = parent->next) {
-          out_degree[parent->value]--;
-          if (out_degree[parent->value] == 0) {
-            if (comm_successor_nodes.count(parent->value)) {
-              comm_successor_ready_queue.push(parent->value);
-            } else {
-              ready_queue.push(parent->value);
-            }
-          }
-        }
+        int node = q.front();
         q.pop();
+        issue(node);
+        while (!update_ready_queue.empty()) {
+          int update = update_ready_queue.front();
+          update_ready_queue.pop();
+          issue(update);
+        }
       }
     };
 
@@ -175,24 +270,265 @@ class FIFOScheduler : public StreamSchedulerBase {
 
     return let_list_.Get(ret);
   }
+
+ private:
+  /*! \brief The parameters of the function. */
+  std::unordered_set<const Object*> params_;
+  /*! \brief Whether to issue the optimizer updates as soon as they are ready. */
+  bool overlap_optimizer_;
 };
 
-Expr FIFOScheduleTransform(const Expr& e) {
-  return FIFOScheduler().Schedule(e);
-}
+class PriorityScheduler : public StreamSchedulerBase {
+ public:
+  PriorityScheduler(const Array<Var>& params, bool overlap_optimizer)
+      : overlap_optimizer_(overlap_optimizer) {
+    for (const auto& param : params) {
+      params_.insert(param.get());
+    }
+  }
+
+  /*!
+   * This scheduler extends the FIFO scheduler by ordering the collectives on the communication
+   * stream by when their outputs are needed, instead of by when they become ready. Since all
+   * collectives are serialized on a single communication stream, a collective issued early but
+   * needed late blocks the collectives needed by the computation stream sooner.
+   *
+   * The need time of a collective is the earliest position (in the FIFO order) of the computation
+   * ops consuming its output. However, the ops that only update the parameters returned to the
+   * next iteration (i.e., they reach neither the first output nor another collective) are not
+   * needed in this iteration at all. The need time of such ops is the first use of the parameters
+   * they depend on in this iteration, offset by the number of ops, because the next iteration
+   * uses the parameters in the same order. For example, the gradient allreduce (or the allgather
+   * of ZeRO) of the first layer is issued before the ones of the last layer when they are ready
+   * together, because the next forward pass needs the first layer first.
+   *
+   * To have more collectives ready together, the ready ops are issued in waves. After issuing the
+   * current wave of ready computation ops, all ready collectives are issued by their need time.
+   * Like the FIFO scheduler, the ops directly depending on a collective are delayed until no
+   * other op is ready, and the optimizer updates are issued as soon as they are ready when they
+   * overlap with the backward.
+   */
+  Expr Schedule(Expr e) {
+    Arena arena;
+    DependencyGraph dfg = CreateDependencyGraph(&arena, e, /*prune_atomic_nodes=*/true);
+    CSRGraph graph(dfg.post_dfs_order);
+    std::vector<Expr> node_expr = GetNodeExprs(dfg, graph);
+    std::vector<int64_t> need = ComputeNeedTime(dfg, graph, node_expr);
+
+    std::vector<int> out_degree(graph.size());
+    std::vector<bool> comm_successor_nodes(graph.size(), false);
+    std::queue<int> ready_queue;
+    std::queue<int> comm_successor_ready_queue;
+    // ready collectives ordered by (need time, post DFS position)
+    std::set<std::pair<int64_t, int>> comm_ready_set;
+    std::queue<int> update_ready_queue;
+    std::vector<std::vector<int>> followers;
+    Updates updates =
+        FindOverlappedUpdates(dfg, graph, node_expr, params_, overlap_optimizer_, &followers);
+    for (int i = 0; i < graph.size(); ++i) {
+      out_degree[i] = graph.children(i).size() + updates.readers[i].size();
+      if (IsCollective(node_expr[i])) {
+        for (int parent : graph.parents(i)) {
+          comm_successor_nodes[parent] = true;
+        }
+      }
+    }
+
+    auto push_ready = [&](int node) {
+      if (updates.is_update[node]) {
+        update_ready_queue.push(node);
+      } else if (IsCollective(node_expr[node])) {
+        comm_ready_set.emplace(need[node], node);
+      } else if (comm_successor_nodes[node]) {
+        comm_successor_ready_queue.push(node);
+      } else {
+        ready_queue.push(node);
+      }
+    };
+    for (int i = 0; i < graph.size(); ++i) {
+      if (out_degree[i] == 0) {
+        push_ready(i);
+      }
+    }
+
+    Expr ret;
+    auto issue = [&](int node) {
+      ret = VisitExpr(node_expr[node]);
+      for (int parent : graph.parents(node)) {
+        if (--out_degree[parent] == 0) {
+          push_ready(parent);
+        }
+      }
+      for (int follower : followers[node]) {
+        if (--out_degree[follower] == 0) {
+          push_ready(follower);
+        }
+      }
+      while (!update_ready_queue.empty()) {
+        int update = update_ready_queue.front();
+        update_ready_queue.pop();
+        ret = VisitExpr(node_expr[update]);
+        for (int parent : graph.parents(update)) {
+          if (--out_degree[parent] == 0) {
+            push_ready(parent);
+          }
+        }
+      }
+    };
+    // issue the ops in the queue at this moment, but not the ones becoming ready meanwhile
+    auto issue_wave = [&](std::queue<int>& q) {
+      for (size_t i = q.size(); i > 0; --i) {
+        int node = q.front();
+        q.pop();
+        issue(node);
+      }
+    };
+    auto issue_collectives = [&]() {
+      while (!comm_ready_set.empty()) {
+        auto it = comm_ready_set.begin();
+        int node = it->second;
+        comm_ready_set.erase(it);
+        issue(node);
+      }
+    };
+
+    while (!ready_queue.empty() || !comm_successor_ready_queue.empty() ||
+           !comm_ready_set.empty()) {
+      issue_collectives();
+      if (!ready_queue.empty()) {
+        issue_wave(ready_queue);
+      } else {
+        issue_wave(comm_successor_ready_queue);
+      }
+    }
+    return let_list_.Get(ret);
+  }
+
+ private:
+  /*! \brief Whether the expression is a call to a collective op. */
+  static bool IsCollective(const Expr& expr) {
+    auto call = expr.as<CallNode>();
+    return call && IsCollectiveOp(call->op);
+  }
+
+  /*! \brief Compute the need time of each node as described in Schedule. */
+  std::vector<int64_t> ComputeNeedTime(const DependencyGraph& dfg, const CSRGraph& graph,
+                                       const std::vector<Expr>& node_expr) {
+    int num_nodes = graph.size();
+
+    // The position of each node in the FIFO order, which is the baseline issue time.
+    std::vector<int64_t> pos(num_nodes);
+    {
+      std::vector<int> out_degree(num_nodes);
+      std::queue<int> q;
+      int64_t curr_pos = 0;
+      for (int i = 0; i < num_nodes; ++i) {
+        out_degree[i] = graph.children(i).size();
+        if (out_degree[i] == 0) {
+          q.push(i);
+        }
+      }
+      while (!q.empty()) {
+        int node = q.front();
+        q.pop();
+        pos[node] = curr_pos++;
+        for (int parent : graph.parents(node)) {
+          if (--out_degree[parent] == 0) {
+            q.push(parent);
+          }
+        }
+      }
+    }
+
+    // The first use of each parameter in this iteration.
+    std::unordered_map<const Object*, int64_t> first_use;
+    auto param_args = [&](int node) {
+      std::vector<const Object*> ret;
+      if (auto call = node_expr[node].as<CallNode>()) {
+        for (const auto& arg : call->args) {
+          if (params_.count(arg.get())) {
+            ret.push_back(arg.get());
+          }
+        }
+      }
+      return ret;
+    };
+    for (int i = 0; i < num_nodes; ++i) {
+      for (auto param : param_args(i)) {
+        auto it = first_use.find(param);
+        if (it == first_use.end() || it->second > pos[i]) {
+          first_use[param] = pos[i];
+        }
+      }
+    }
+
+    int primary = GetPrimaryNode(dfg, graph, node_expr);
+
+    // Visit the users before their dependencies.
+    std::vector<bool> needed_now(num_nodes, false);
+    std::vector<int64_t> next_use(num_nodes);
+    std::vector<int64_t> need(num_nodes);
+    for (int i = num_nodes - 1; i >= 0; --i) {
+      const Expr& expr = node_expr[i];
+      bool is_needed_now = i == primary;
+      int64_t node_next_use = num_nodes;
+      int64_t need_by_users = 2 * static_cast<int64_t>(num_nodes);
+      for (int user : graph.parents(i)) {
+        is_needed_now |= needed_now[user] || IsCollective(node_expr[user]);
+        node_next_use = std::min(node_next_use, next_use[user]);
+        need_by_users = std::min(need_by_users, need[user]);
+      }
+      for (auto param : param_args(i)) {
+        node_next_use = std::min(node_next_use, first_use.at(param));
+      }
+      needed_now[i] = is_needed_now;
+      next_use[i] = is_needed_now ? num_nodes : node_next_use;
+      if (expr.as<CallNode>() && !IsCollective(expr)) {
+        need[i] = is_needed_now ? pos[i] : num_nodes + node_next_use;
+      } else {
+        // Tuples, TupleGetItems and collectives are needed when their users are needed.
+        need[i] = need_by_users;
+      }
+    }
+    return need;
+  }
+
+  /*! \brief The parameters of the function. */
+  std::unordered_set<const Object*> params_;
+  /*! \brief Whether to issue the optimizer updates as soon as they are ready. */
+  bool overlap_optimizer_;
+};
 
 }  // namespace data_parallel_schedule
 
 Pass DataParallelSchedule() {
+  PassContext pass_ctx = PassContext::Current();
+  String policy = pass_ctx->GetConfig<String>("raf.data_parallel_schedule.policy", "fifo").value();
+  CHECK(policy == "fifo" || policy == "priority")
+      << "Cannot recognize data parallel schedule policy: " << policy
+      << ", candidates are fifo and priority";
+  bool overlap_optimizer =
+      pass_ctx->GetConfig<Bool>(optimizer_update::kOverlapOptimizer, Bool(false)).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(
-        tvm::relay::TransformF(data_parallel_schedule::FIFOScheduleTransform, f));
+    if (policy == "priority") {
+      auto transform = [&f, overlap_optimizer](const Expr& e) {
+        return data_parallel_schedule::PriorityScheduler(f->params, overlap_optimizer).Schedule(e);
+      };
+      return Downcast<Function>(tvm::relay::TransformF(transform, f));
+    }
+    auto transform = [&f, overlap_optimizer](const Expr& e) {
+      return data_parallel_schedule::FIFOScheduler(f->params, overlap_optimizer).Schedule(e);
+    };
+    return Downcast<Function>(tvm::relay::TransformF(transform, f));
   };
   return CreateRAFFunctionPass(pass_func, 0, "DataParallelSchedule", {});
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.DataParallelSchedule").set_body_typed(DataParallelSchedule);
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.data_parallel_schedule.policy", String);
+TVM_REGISTER_PASS_CONFIG_OPTION(optimizer_update::kOverlapOptimizer, Bool);
+
 }  // namespace pass
 }  // namespace raf
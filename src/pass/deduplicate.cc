@@ -46,26 +46,16 @@ class DataflowGraph {
     Node* dominator_parent_;
     /*! \brief The nodes this node dominates */
     std::vector<Node*> dominator_children_;
+    /*!
+     * \brief The preorder index of the node in the dominator tree, and the last preorder index of
+     * its subtree, so the dominance is checked in constant time.
+     */
+    size_t dom_begin_ = 0;
+    size_t dom_end_ = 0;
 
-    bool Dominates(const Node* other) {
-      std::stack<const Node*> stack;
-      std::unordered_set<const Node*> visited;
-      stack.push(this);
-      while (!stack.empty()) {
-        const Node* current = stack.top();
-        stack.pop();
-        for (auto node : current->dominator_children_) {
-          if (visited.count(node) == 0) {
-            if (other == node) {
-              return true;
-            } else {
-              stack.push(node);
-            }
-            visited.insert(node);
-          }
-        }
-      }
-      return false;
+    /*! \brief Whether the other node is a strict descendant of this node in the dominator tree. */
+    bool Dominates(const Node* other) const {
+      return dom_begin_ < other->dom_begin_ && other->dom_begin_ <= dom_end_;
     }
   };
   /*! \brief Construct the domination tree inside IndexedGraph */
@@ -83,6 +73,7 @@ class DataflowGraph {
         parent->dominator_children_.push_back(current);
       }
     }
+    NumberDominatorTree();
   }
   /*! \brief Map of input nodes to IndexedGraph Nodes */
   std::unordered_map<Expr, std::shared_ptr<Node>, ObjectPtrHash, ObjectPtrEqual> node_map_;
@@ -90,6 +81,31 @@ class DataflowGraph {
   std::vector<std::shared_ptr<Node>> topological_order_;
 
  protected:
+  /*! \brief Number the nodes in the preorder of the dominator tree without recursion. */
+  void NumberDominatorTree() {
+    size_t counter = 0;
+    std::stack<std::pair<Node*, size_t>> stack;
+    for (size_t i = topological_order_.size(); i != 0; --i) {
+      Node* root = topological_order_[i - 1].get();
+      if (root->dominator_parent_ != nullptr) {
+        continue;
+      }
+      root->dom_begin_ = counter++;
+      stack.push({root, 0});
+      while (!stack.empty()) {
+        auto& top = stack.top();
+        if (top.second < top.first->dominator_children_.size()) {
+          Node* child = top.first->dominator_children_[top.second++];
+          child->dom_begin_ = counter++;
+          stack.push({child, 0});
+        } else {
+          top.first->dom_end_ = counter - 1;
+          stack.pop();
+        }
+      }
+    }
+  }
+
   /*! \brief Find the least common ancestor of all outputs of a node */
   Node* LeastCommonAncestor(const std::vector<Node*>& outputs) {
     if (outputs.size() == 0) {
@@ -438,18 +454,66 @@ std::pair<std::vector<Nodes>, DomMasks> EnumerateValidSubgraph(const DataflowGra
   return std::make_pair(ret_nodes, ret_masks);
 }
 
-// Class for computing hash value of a subgraph and corresponding domination mask.
+/*!
+ * \brief The structural hashes of the types and the constants, which are memoized across the
+ * subgraphs and the rounds of merging, because the same nodes are hashed for every subgraph they
+ * are in.
+ */
+class DedupHashCache {
+ public:
+  uint64_t Hash(const ObjectRef& ref) {
+    auto it = hashes_.find(ref.get());
+    if (it != hashes_.end()) {
+      return it->second.second;
+    }
+    uint64_t hash = tvm::StructuralHash()(ref);
+    hashes_.emplace(ref.get(), std::make_pair(ref, hash));
+    return hash;
+  }
+
+ private:
+  /*! \brief The hashes, which keep their objects alive so the addresses are not reused. */
+  std::unordered_map<const Object*, std::pair<ObjectRef, uint64_t>> hashes_;
+};
+
+/*! \brief A token of the canonical form of a subgraph. */
+struct DedupToken {
+  /*! \brief The kind of the node and its attributes, e.g., the op name or the tuple index. */
+  uint64_t tag;
+  /*! \brief The object compared when the hashes are equal, e.g., a type or a constant value. */
+  ObjectRef ref;
+  /*! \brief Whether the object is compared structurally, or by the address. */
+  bool structural;
+
+  bool operator==(const DedupToken& other) const {
+    if (tag != other.tag) {
+      return false;
+    }
+    if (!ref.defined() || !other.ref.defined()) {
+      return ref.defined() == other.ref.defined();
+    }
+    return structural ? tvm::StructuralEqual()(ref, other.ref) : ref.same_as(other.ref);
+  }
+};
+
+/*!
+ * \brief Class for computing hash value of a subgraph and corresponding domination mask. The
+ * subgraph is visited from its root in a canonical order, where a node inside the subgraph gives
+ * its kind and attributes and a node outside gives a placeholder, so the cost is linear in the
+ * size of the subgraph. The tokens are kept to tell apart the subgraphs of colliding hashes.
+ */
 class DedupHasher : public ExprVisitor {
  public:
-  explicit DedupHasher(bool consider_type) : consider_type_(consider_type) {
+  DedupHasher(bool consider_type, DedupHashCache* cache)
+      : consider_type_(consider_type), cache_(cache) {
   }
   size_t GetHashKey(const Nodes& nodes, const DomMask& mask, const ir::Optional<ir::String>& salt) {
     for (auto v : nodes) {
-      exprs_.insert(v->ref_);
+      exprs_.insert(v->ref_.get());
     }
     VisitExpr(nodes[0]->ref_);
     for (auto i : mask) {
-      HashCombine(std::hash<int>()(i));
+      AddToken(static_cast<uint64_t>(i));
     }
     if (salt != nullptr) {
       HashCombine(std::hash<std::string>()(salt.value()));
@@ -457,49 +521,51 @@ class DedupHasher : public ExprVisitor {
     return hashkey;
   }
 
+  /*! \brief The canonical form of the subgraph. */
+  std::vector<DedupToken> tokens;
+
  protected:
   void HashCombine(const uint64_t value) {
     // Do not use std::hash in this function. This hash must be stable
     // across different platforms and std::hash is implementation dependent.
     hashkey = hashkey ^ (value + 0x9e3779b9 + (hashkey << 6) + (hashkey >> 2));
   }
+  void AddToken(uint64_t tag, ObjectRef ref = ObjectRef(), bool structural = false) {
+    HashCombine(tag);
+    if (ref.defined()) {
+      HashCombine(structural ? cache_->Hash(ref) : ObjectPtrHash()(ref));
+    }
+    tokens.push_back({tag, std::move(ref), structural});
+  }
   void HashForPlaceHolder(const ExprNode* op) {
     static const size_t placeholder_hash = std::hash<std::string>()("PlaceHolder");
-    HashCombine(std::hash<size_t>()(node_counter_++));
-    HashCombine(placeholder_hash);
     if (consider_type_) {
-      HashCombine(tvm::StructuralHash()(op->checked_type_));
+      AddToken(placeholder_hash, op->checked_type_, true);
+    } else {
+      AddToken(placeholder_hash);
     }
   }
   void VisitExpr_(const TupleNode* op) override {
-    if (exprs_.count(GetRef<Expr>(op))) {
-      HashCombine(std::hash<size_t>()(node_counter_++));
-      HashCombine(op->GetTypeKeyHash());
+    if (exprs_.count(op)) {
+      AddToken(op->GetTypeKeyHash());
       ExprVisitor::VisitExpr_(op);
     } else {
       HashForPlaceHolder(op);
     }
   }
   void VisitExpr_(const CallNode* op) override {
-    if (exprs_.count(GetRef<Expr>(op))) {
-      HashCombine(std::hash<size_t>()(node_counter_++));
-      HashCombine(op->GetTypeKeyHash());
-      if (op->op->IsInstance<OpNode>()) {
-        HashCombine(std::hash<std::string>()(Downcast<Op>(op->op)->name));
-      } else if (op->op->IsInstance<FunctionNode>()) {
-        ICHECK(op->op.as<FunctionNode>()->HasNonzeroAttr(attr::kPrimitive));
-        HashCombine(ObjectPtrHash()(op->op));
-      }
+    if (exprs_.count(op)) {
+      // The ops are singletons, and the functions, e.g., the ones extracted by the last rounds,
+      // are compared by their addresses.
+      AddToken(op->GetTypeKeyHash(), op->op);
       ExprVisitor::VisitExpr_(op);
     } else {
       HashForPlaceHolder(op);
     }
   }
   void VisitExpr_(const TupleGetItemNode* op) override {
-    if (exprs_.count(GetRef<Expr>(op))) {
-      HashCombine(std::hash<size_t>()(node_counter_++));
-      HashCombine(op->GetTypeKeyHash());
-      HashCombine(std::hash<int>()(op->index));
+    if (exprs_.count(op)) {
+      AddToken(op->GetTypeKeyHash() ^ (static_cast<uint64_t>(op->index) << 32));
       ExprVisitor::VisitExpr_(op);
     } else {
       HashForPlaceHolder(op);
@@ -510,14 +576,12 @@ class DedupHasher : public ExprVisitor {
   }
   void VisitExpr_(const RelayConstantNode* op) override {
     const ConstantNode* node = static_cast<const ConstantNode*>(op);
-    HashCombine(std::hash<size_t>()(node_counter_++));
-    HashCombine(op->GetTypeKeyHash());
-    HashCombine(tvm::StructuralHash()(node->value));
+    AddToken(op->GetTypeKeyHash(), node->value, true);
   }
-  std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual> exprs_;
-  int node_counter_{0};
+  std::unordered_set<const Object*> exprs_;
   size_t hashkey{0};
   bool consider_type_;
+  DedupHashCache* cache_;
 };
 
 // Class for extracting the function body of a given subgraph.
@@ -558,6 +622,8 @@ struct SubgraphGroup {
   std::vector<Nodes> subgraphs;
   DomMask mask;
   std::unordered_set<Node*> used_nodes;
+  // canonical form of the subgraphs, which tells apart the groups of colliding hashes
+  std::vector<DedupToken> signature;
   // extracted function
   Function function;
   // input expressions of each subgraph
@@ -700,10 +766,12 @@ class DeduplicateMutator : public MixedModeMutator {
 };
 
 /*!
- * \brief Extract one function and use it to merge the origin IR.
+ * \brief Extract one function and use it to merge the origin IR. Nothing is merged if the best
+ * group has subgraphs of fewer than min_size nodes.
  */
 Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, bool must_dominate,
-                      const ir::Optional<ir::String>& salt) {
+                      const ir::Optional<ir::String>& salt, DedupHashCache* cache,
+                      size_t min_size = 0) {
   DataflowGraph graph = CreateDataflowGraph(expr);
 
   int k = 2;
@@ -716,16 +784,27 @@ Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, b
     DomMasks masks;
     std::tie(subgraphs, masks) = EnumerateValidSubgraph(graph, k, must_dominate);
     DLOG(INFO) << "Num of subgraphs: " << subgraphs.size();
-    std::unordered_map<size_t, std::shared_ptr<SubgraphGroup>> group_map;
+    std::unordered_map<size_t, std::vector<std::shared_ptr<SubgraphGroup>>> group_map;
     for (size_t i = 0; i < subgraphs.size(); ++i) {
-      Nodes subgraph = subgraphs[i];
+      const Nodes& subgraph = subgraphs[i];
       DomMask mask = must_dominate ? DomMask{} : masks[i];
-      size_t hashkey = DedupHasher(consider_type).GetHashKey(subgraph, mask, salt);
-      if (group_map.count(hashkey) == 0) {
-        group_map[hashkey] = std::make_shared<SubgraphGroup>();
-        group_map[hashkey]->mask = mask;
+      DedupHasher hasher(consider_type, cache);
+      size_t hashkey = hasher.GetHashKey(subgraph, mask, salt);
+      // The canonical forms are only compared for the candidates of the same hash.
+      auto& candidates = group_map[hashkey];
+      std::shared_ptr<SubgraphGroup> group{nullptr};
+      for (const auto& candidate : candidates) {
+        if (candidate->signature == hasher.tokens) {
+          group = candidate;
+          break;
+        }
+      }
+      if (group == nullptr) {
+        group = std::make_shared<SubgraphGroup>();
+        group->mask = mask;
+        group->signature = std::move(hasher.tokens);
+        candidates.push_back(group);
       }
-      auto group = group_map[hashkey];
       bool no_overlap = true;
       for (auto node : subgraph) {
         if (group->used_nodes.count(node)) {
@@ -740,23 +819,21 @@ Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, b
         }
       }
     }
-    for (auto it = group_map.begin(); it != group_map.end();) {
-      if (!it->second->IsValid()) {
-        it = group_map.erase(it);
-      } else {
-        ++it;
-      }
-    }
-    for (auto pair : group_map) {
-      if (next_group) {
-        int largest_s = next_group->subgraphs.size() * (next_group->subgraphs[0].size() - 1);
-        int current_s = pair.second->subgraphs.size() * (pair.second->subgraphs[0].size() - 1);
-        DLOG(INFO) << "Current score: " << current_s;
-        if (current_s >= largest_s) {
-          next_group = pair.second;
+    for (const auto& pair : group_map) {
+      for (const auto& group : pair.second) {
+        if (!group->IsValid()) {
+          continue;
+        }
+        if (next_group) {
+          int largest_s = next_group->subgraphs.size() * (next_group->subgraphs[0].size() - 1);
+          int current_s = group->subgraphs.size() * (group->subgraphs[0].size() - 1);
+          DLOG(INFO) << "Current score: " << current_s;
+          if (current_s >= largest_s) {
+            next_group = group;
+          }
+        } else {
+          next_group = group;
         }
-      } else {
-        next_group = pair.second;
       }
     }
   };
@@ -782,6 +859,9 @@ Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, b
   }
   DLOG(INFO) << "Max score: "
              << next_group->subgraphs.size() * (next_group->subgraphs[0].size() - 1);
+  if (next_group->subgraphs[0].size() < min_size) {
+    return expr;
+  }
 
   Expr updated_expr;
   next_group->GenHelpInfo();
@@ -789,6 +869,38 @@ Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, b
   return updated_expr;
 }
 
+/*! \brief Merge the functions by MergeOneFunction until the IR stops changing. */
+Expr DeduplicateExpr(const Expr& expr, int forward_steps, bool consider_type, bool must_dominate,
+                     const ir::Optional<ir::String>& salt, size_t min_size) {
+  auto post = expr;
+  auto last = post;
+  // Mutate the IR by using MergeOneFunction until it stops changing
+  int count = 0;
+  bool equal = true;
+  static auto* structural_equal = tvm::runtime::Registry::Get("node.StructuralEqual");
+  ICHECK(structural_equal) << "node.StructuralEqual is not registered.";
+  // The hashes of the types and constants are shared by the rounds, as most nodes are kept.
+  DedupHashCache cache;
+  do {
+    last = post;
+    post = MergeOneFunction(post, forward_steps, consider_type, must_dominate, salt, &cache,
+                            min_size);
+    if (post.same_as(last)) {
+      // No group is merged, so the full comparison and type inference are skipped.
+      break;
+    }
+    if (consider_type) {
+      post = InferType(post);
+    }
+    equal = (*structural_equal)(last, post, false, true);
+    ++count;
+  } while (!equal && count < 100);
+  if (count >= 100) {
+    LOG(FATAL) << "Observed 100 MergeOneFunction runs, something must have gone wrong!";
+  }
+  return post;
+}
+
 }  // namespace deduplicate
 
 /*!
@@ -816,7 +928,7 @@ Expr MergeOneFunction(const Expr& expr, int forward_steps, bool consider_type, b
  * 1. Get the dataflow graph of input IR (body of the function).
  * 2. Enumerate valid subgraphs with size k from dataflow graph.
  * 3. Calculate hash (with an option to decide if consider type) of all these subgraphs,
- *    put those with the same hash and no overlap to the same group.
+ *    put those with the same hash, the same canonical form and no overlap to the same group.
  * 4. Remove the groups that only contain one subgraph.
  * 5. Choose the group with the largest score: (k - 1) * num of subgraphs.
  * 6. Go to 2 and increase k with 1, until no longer find larger group, then run this loop with
@@ -836,25 +948,8 @@ Pass Deduplicate(int forward_steps, bool consider_type, bool must_dominate,
                  ir::Optional<ir::String> salt) {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    auto expr = f->body;
-    auto post = expr;
-    auto last = post;
-    // Mutate the IR by using MergeOneFunction until it stops changing
-    int count = 0;
-    bool equal = true;
-    static auto* structural_equal = tvm::runtime::Registry::Get("node.StructuralEqual");
-    ICHECK(structural_equal) << "node.StructuralEqual is not registered.";
-    do {
-      last = post;
-      post = deduplicate::MergeOneFunction(post, forward_steps, consider_type, must_dominate, salt);
-      if (consider_type) {
-        post = InferType(post);
-      }
-      equal = (*structural_equal)(last, post, false, true);
-    } while (!equal && count < 100);
-    if (count >= 100) {
-      LOG(FATAL) << "Observed 100 MergeOneFunction runs, something must have gone wrong!";
-    }
+    auto post = deduplicate::DeduplicateExpr(f->body, forward_steps, consider_type, must_dominate,
+                                             salt, 0);
     Function updated_func = Function(f->params, post, f->ret_type, f->type_params);
     if (consider_type) {
       updated_func = Downcast<Function>(pass::InferType(updated_func));
@@ -864,7 +959,29 @@ Pass Deduplicate(int forward_steps, bool consider_type, bool must_dominate,
   return CreateRAFFunctionPass(pass_func, 0, "Deduplicate", {});
 }
 
+Pass OutlineLayers(int min_size, bool must_dominate) {
+  CHECK_GT(min_size, 1) << "A layer must have more than one node";
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    if (f->HasNonzeroAttr(attr::kPrimitive)) {
+      return f;
+    }
+    auto post = deduplicate::DeduplicateExpr(f->body, 0, true, must_dominate,
+                                             ir::Optional<ir::String>(), min_size);
+    if (post.same_as(f->body)) {
+      return f;
+    }
+    return Downcast<Function>(
+        pass::InferType(Function(f->params, post, f->ret_type, f->type_params, f->attrs)));
+  };
+  auto outline = CreateRAFFunctionPass(pass_func, 0, "OutlineLayersImpl", {});
+  // The extracted functions are lifted to the module, so the later function passes, e.g. FuseTVM,
+  // process one copy of them.
+  return RAFSequential({InferType(), outline, LambdaLift(), InferType()}, "OutlineLayers");
+}
+
 RAF_REGISTER_GLOBAL("raf.pass_.Deduplicate").set_body_typed(Deduplicate);
+RAF_REGISTER_GLOBAL("raf.pass_.OutlineLayers").set_body_typed(OutlineLayers);
 
 }  // namespace pass
 }  // namespace raf
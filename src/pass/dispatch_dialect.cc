@@ -7,12 +7,15 @@
  * \file src/pass/dispatch_dialect.cc
  * \brief Dispatch the base ops to device-specific dialect ops based on predefined plevels. Note
  * that some ops such as VM related ops do not have dialect ops, and they will remain the same after
- * this pass.
+ * this pass. With raf.dispatch_dialect.profile, the ops of more than one dialect are dispatched
+ * to the dialect whose kernel is the fastest for their shapes and dtypes instead.
  */
+#include <unordered_map>
 #include <vector>
 #include "raf/device.h"
 #include "raf/op.h"
 #include "raf/ir_ext.h"
+#include "raf/op_profiler.h"
 #include "raf/pass.h"
 
 namespace raf {
@@ -24,7 +27,8 @@ using namespace raf::op;
 
 class DispatchMutator : public MixedModeMutator {
  public:
-  DispatchMutator(DevType dev_type) : dev_type_(dev_type) {
+  DispatchMutator(DevType dev_type, op_profiler::OpProfiler* profiler = nullptr)
+      : dev_type_(dev_type), profiler_(profiler) {
   }
 
   Expr VisitExpr_(const FunctionNode* node) final {
@@ -46,18 +50,102 @@ class DispatchMutator : public MixedModeMutator {
     return op;
   }
 
+  Expr Rewrite_(const CallNode* pre, const Expr& post) final {
+    if (profiler_ == nullptr || !pre->op->IsInstance<OpNode>() || !pre->checked_type_.defined()) {
+      return post;
+    }
+    auto base_op = Downcast<Op>(pre->op);
+    if (IsDialectOp(base_op)) {
+      return post;
+    }
+    auto dialect_op = ProfileDispatch(GetRef<Call>(pre));
+    if (!dialect_op.defined()) {
+      return post;
+    }
+    const auto* call = post.as<CallNode>();
+    return Call(dialect_op, call->args, call->attrs, call->type_args);
+  }
+
  private:
+  /*!
+   * \brief Profile the call with the ops of each enabled dialect, and choose the fastest one. The
+   * latencies are cached by the profiler per op and argument types, so the calls of the same
+   * shapes and dtypes, in this or the later compilations with the saved cache, are not profiled
+   * again.
+   * \param call The call of the base op, whose types are inferred.
+   * \return The fastest dialect op, or undefined if there are less than 2 dialects to choose.
+   */
+  Op ProfileDispatch(const Call& call) {
+    auto base_op = Downcast<Op>(call->op);
+    std::vector<Op> candidates;
+    for (const auto& e : OpDialect::GetDispatchList(base_op, dev_type_)) {
+      if (e.plevel > 0) {
+        candidates.push_back(OpDialect::Lower(base_op, e.dialect));
+      }
+    }
+    if (candidates.size() < 2) {
+      return Op();
+    }
+    for (const auto& arg : call->args) {
+      if (!arg->checked_type_.defined()) {
+        return Op();
+      }
+    }
+    Op best;
+    float best_latency = 0;
+    for (const auto& op : candidates) {
+      auto candidate = Call(op, call->args, call->attrs, call->type_args);
+      candidate->checked_type_ = call->checked_type();
+      float latency = 0;
+      try {
+        auto latencies = profiler_->ProfileOp(candidate).first;
+        for (float lat : latencies) {
+          latency += lat / latencies.size();
+        }
+      } catch (const dmlc::Error& e) {
+        // The dialect does not support the call, e.g., of its attributes.
+        continue;
+      }
+      // The calls that cannot be built are not executed and have no latency.
+      if (latency > 0 && (!best.defined() || latency < best_latency)) {
+        best = op;
+        best_latency = latency;
+      }
+    }
+    return best;
+  }
+
   DevType dev_type_;
+  /*! \brief The profiler of the profile-guided dispatch, or nullptr to dispatch by plevels. */
+  op_profiler::OpProfiler* profiler_;
 };
 
-Expr Dispatch(const Expr& expr) {
+Expr Dispatch(const Expr& expr, const IRModule& mod) {
   auto dev = Device::Current(true);
   if (dev->device_type == DevType::kUnknown() || dev->device_id < 0) {
     LOG(WARNING) << "Device is not specified, skip DispatchDialect pass.";
     return expr;
   }
   DevType dev_type = dev.device_type();
-  return DispatchMutator(dev_type).Mutate(expr);
+  auto pass_ctx = PassContext::Current();
+  if (!pass_ctx->GetConfig<tvm::Bool>("raf.dispatch_dialect.profile", tvm::Bool(false)).value()) {
+    return DispatchMutator(dev_type).Mutate(expr);
+  }
+  // The profiler only supports the first device.
+  auto profiler = op_profiler::OpProfiler::Get(Device(dev_type, 0));
+  std::string latency_cache =
+      pass_ctx->GetConfig<String>("raf.dispatch_dialect.latency_cache", "").value();
+  if (!latency_cache.empty()) {
+    int n_loaded = profiler->LoadLatencyCache(latency_cache);
+    if (n_loaded >= 0) {
+      DLOG(INFO) << "Loaded " << n_loaded << " op latencies from " << latency_cache;
+    }
+  }
+  auto ret = DispatchMutator(dev_type, profiler).Mutate(InferTypeWithModule(expr, mod));
+  if (!latency_cache.empty()) {
+    profiler->SaveLatencyCache(latency_cache);
+  }
+  return ret;
 }
 
 }  // namespace dispatch_dialect
@@ -65,12 +153,15 @@ Expr Dispatch(const Expr& expr) {
 Pass DispatchDialect() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(dispatch_dialect::Dispatch(f));
+    return Downcast<Function>(dispatch_dialect::Dispatch(f, m));
   };
   return CreateRAFFunctionPass(pass_func, 1, "DispatchDialect", {});
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.DispatchDialect").set_body_typed(DispatchDialect);
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dispatch_dialect.profile", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.dispatch_dialect.latency_cache", String);
+
 }  // namespace pass
 }  // namespace raf
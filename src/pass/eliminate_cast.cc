@@ -0,0 +1,256 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file eliminate_cast.cc
+ * \brief Eliminate the redundant casts inserted by AutoCast, i.e., the repeated casts of the same
+ * value, the casts of tensors that already have the target dtype, and the chains of casts whose
+ * intermediate casts are lossless.
+ */
+#include <unordered_map>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace eliminate_cast {
+
+using namespace raf::op;
+using namespace raf::value;
+
+template <typename T>
+using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+
+/*! \brief The casts of a var, from the target dtypes to the cast values. */
+using CastMap = StdMap<std::unordered_map<std::string, Expr>>;
+
+/*! \brief Get the dtype of a typed tensor, or an empty string if it is not a typed tensor. */
+std::string GetDType(const Expr& expr) {
+  if (!expr->checked_type_.defined()) {
+    return "";
+  }
+  const auto* ttype = expr->checked_type().as<TensorTypeNode>();
+  return ttype ? tvm::runtime::DLDataType2String(ttype->dtype) : "";
+}
+
+/*! \brief Get the constant dtype argument of a cast, or an empty string if it is not constant. */
+std::string GetConstDType(const Expr& expr) {
+  const auto* node = expr.as<ConstantNode>();
+  if (node == nullptr) {
+    return "";
+  }
+  auto value = Downcast<Value>(ConstantExtractValue(GetRef<Constant>(node)));
+  const auto* str = value.as<StringValueObj>();
+  return str ? str->value : "";
+}
+
+/*!
+ * \brief Whether the cast from one dtype to another is lossless, so a following cast of the cast
+ * value is the same as casting the original value, e.g. float16 -> float32 -> bfloat16.
+ */
+bool IsLossless(const std::string& from, const std::string& to) {
+  if (from == to) {
+    return true;
+  }
+  DataType src(tvm::runtime::String2DLDataType(from));
+  DataType dst(tvm::runtime::String2DLDataType(to));
+  return src.lanes() == 1 && dst.lanes() == 1 && (src.is_float() || src.is_bfloat16()) &&
+         dst.is_float() && dst.bits() > src.bits();
+}
+
+/*!
+ * \brief Rewrite the casts and the group casts of a function in ANF. The first cast of a var to
+ * a dtype is kept, and the later casts of the same var to the same dtype, either by a cast or as
+ * a field of a group cast, reuse its value. The closures in the function reuse the casts of the
+ * outer scope as well.
+ */
+class CastEliminator {
+ public:
+  explicit CastEliminator(const Function& func, const CastMap& casts = {},
+                          const tvm::Map<Var, Var>& subst = {})
+      : func_(func), ell_(ExplicitLetList::make(func->body)), casts_(casts), subst_(subst) {
+  }
+
+  Function Run() {
+    if (!ell_->ret.defined()) {
+      return func_;
+    }
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      Expr expr = subst_.empty() ? exprs[i] : VarSubstitutor(subst_).Substitute(exprs[i]);
+      if (const auto* func = expr.as<FunctionNode>()) {
+        expr = CastEliminator(GetRef<Function>(func), casts_, subst_).Run();
+      } else if (const auto* tuple = expr.as<TupleNode>()) {
+        tuples_[vars[i]] = GetRef<Tuple>(tuple);
+      } else if (const auto* item = expr.as<TupleGetItemNode>()) {
+        RecordGroupCastField(vars[i], item);
+      } else if (const auto* call = expr.as<CallNode>()) {
+        expr = RewriteCast(vars[i], GetRef<Call>(call));
+        if (!expr.defined()) {
+          continue;
+        }
+      }
+      ell_out_.Push(vars[i], expr);
+    }
+    ell_out_.ret = subst_.count(ell_->ret) ? subst_.at(ell_->ret) : ell_->ret;
+    return Function(func_->params, ell_out_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Rewrite a cast or a group cast.
+   * \param var The var the call is bound to.
+   * \param call The bound call.
+   * \return The expression to be bound to the var, or an undefined expression if the var is
+   * substituted by another var.
+   */
+  Expr RewriteCast(const Var& var, const Call& call) {
+    static const Op& cast = Op::Get("raf.op.cast");
+    static const Op& group_cast = Op::Get("raf.op.group_cast");
+    if (call->op == cast) {
+      return RewriteSingleCast(var, call);
+    } else if (call->op == group_cast) {
+      return RewriteGroupCast(var, call);
+    }
+    return call;
+  }
+
+  Expr RewriteSingleCast(const Var& var, const Call& call) {
+    static const Op& cast = Op::Get("raf.op.cast");
+    const auto* data = call->args[0].as<VarNode>();
+    std::string dtype = GetConstDType(call->args[1]);
+    if (data == nullptr || dtype.empty()) {
+      return call;
+    }
+    Var x = GetRef<Var>(data);
+    // Skip the intermediate lossless casts, which are left to the dead code elimination.
+    auto it = sources_.find(x);
+    while (it != sources_.end() && IsLossless(GetDType(it->second), GetDType(x))) {
+      x = it->second;
+      it = sources_.find(x);
+    }
+    if (GetDType(x) == dtype) {
+      return Substitute(var, x);
+    }
+    if (const Expr* prev = FindCast(x, dtype)) {
+      return prev->as<VarNode>() ? Substitute(var, Downcast<Var>(*prev)) : *prev;
+    }
+    casts_[x][dtype] = var;
+    sources_[var] = x;
+    return x.same_as(call->args[0]) ? Expr(call) : Call(cast, {x, call->args[1]});
+  }
+
+  Expr RewriteGroupCast(const Var& var, const Call& call) {
+    const auto* data = call->args[0].as<VarNode>();
+    std::string dtype = GetConstDType(call->args[1]);
+    if (data == nullptr || dtype.empty() || !tuples_.count(GetRef<Var>(data))) {
+      return call;
+    }
+    const auto& fields = tuples_.at(GetRef<Var>(data))->fields;
+    // The group cast is replaced by a tuple if all its fields have been cast.
+    Array<Expr> cast_fields;
+    for (const auto& field : fields) {
+      const auto* field_var = field.as<VarNode>();
+      const Expr* prev = field_var ? FindCast(GetRef<Var>(field_var), dtype) : nullptr;
+      if (prev == nullptr && GetDType(field) != dtype) {
+        break;
+      }
+      if (prev == nullptr) {
+        cast_fields.push_back(field);
+      } else if (prev->as<VarNode>()) {
+        cast_fields.push_back(*prev);
+      } else {
+        Var cast_var = MakeVar(field_var->name_hint() + "_cast", {});
+        ell_out_.Push(cast_var, *prev);
+        cast_fields.push_back(cast_var);
+      }
+    }
+    if (cast_fields.size() == fields.size()) {
+      return Tuple(cast_fields);
+    }
+    // Otherwise the group cast is kept, and its fields are reused by the later casts.
+    for (size_t i = 0; i < fields.size(); ++i) {
+      const auto* field_var = fields[i].as<VarNode>();
+      if (field_var && !FindCast(GetRef<Var>(field_var), dtype)) {
+        casts_[GetRef<Var>(field_var)][dtype] = TupleGetItem(var, i);
+      }
+    }
+    group_casts_[var] = fields;
+    return call;
+  }
+
+  /*! \brief Record the field of a group cast that is bound to a var, to be reused as a var. */
+  void RecordGroupCastField(const Var& var, const TupleGetItemNode* item) {
+    const auto* tuple = item->tuple.as<VarNode>();
+    if (tuple == nullptr || !group_casts_.count(GetRef<Var>(tuple))) {
+      return;
+    }
+    const auto* field = group_casts_.at(GetRef<Var>(tuple))[item->index].as<VarNode>();
+    std::string dtype = GetDType(var);
+    if (field == nullptr || dtype.empty()) {
+      return;
+    }
+    auto& prev = casts_[GetRef<Var>(field)][dtype];
+    if (!prev.defined() || prev.as<TupleGetItemNode>()) {
+      prev = var;
+      sources_[var] = GetRef<Var>(field);
+    }
+  }
+
+  /*! \brief Find the previous cast of a var to a dtype. */
+  const Expr* FindCast(const Var& var, const std::string& dtype) {
+    auto it = casts_.find(var);
+    if (it == casts_.end()) {
+      return nullptr;
+    }
+    auto jt = it->second.find(dtype);
+    return jt == it->second.end() ? nullptr : &jt->second;
+  }
+
+  /*! \brief Substitute the var by another var in the rest of the function. */
+  Expr Substitute(const Var& var, const Var& other) {
+    subst_.Set(var, other);
+    return Expr();
+  }
+
+  /*! \brief The function to be rewritten. */
+  const Function& func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The let list of the rewritten function. */
+  ExplicitLetList ell_out_;
+  /*! \brief The casts of each var that have been computed. */
+  CastMap casts_;
+  /*! \brief The source var of each cast var in this function. */
+  StdMap<Var> sources_;
+  /*! \brief The tuples bound to vars. */
+  StdMap<Tuple> tuples_;
+  /*! \brief The fields of the tuples cast by the group casts, by the group cast vars. */
+  StdMap<Array<Expr>> group_casts_;
+  /*! \brief The vars that are substituted by the previous casts. */
+  tvm::Map<Var, Var> subst_;
+};
+
+}  // namespace eliminate_cast
+
+Pass EliminateCast() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return eliminate_cast::CastEliminator(f).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "EliminateCastHelper", {});
+  PassInfo pass_info(1, "EliminateCast", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.EliminateCast").set_body_typed(EliminateCast);
+
+}  // namespace pass
+}  // namespace raf
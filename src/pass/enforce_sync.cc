@@ -16,6 +16,7 @@
 #include "raf/op.h"
 #include "raf/op_utils.h"
 #include "./common.h"
+#include "./optimizer_update.h"
 #include "raf/stream_pool.h"
 
 namespace raf {
@@ -51,6 +52,8 @@ static int64_t compute_stream_idx = StreamTagEnum::CudaCompute();
 static int64_t communication_stream_idx = StreamTagEnum::CudaCommunicate();
 static int64_t fuse_tensor_stream_idx = StreamTagEnum::MemCudaToCuda1();
 static int64_t defuse_tensor_stream_idx = StreamTagEnum::MemCudaToCuda2();
+static int64_t peer_copy_stream_idx = StreamTagEnum::MemCudaPeer();
+static int64_t update_stream_idx = StreamTagEnum::CudaUpdate();
 static int64_t unknown_stream_idx = StreamTagEnum::Unknown();
 
 static std::unordered_map<int64_t, std::string> stream_name_hint = {
@@ -58,8 +61,29 @@ static std::unordered_map<int64_t, std::string> stream_name_hint = {
     {communication_stream_idx, "comm"},
     {fuse_tensor_stream_idx, "fuse"},
     {defuse_tensor_stream_idx, "defuse"},
+    {peer_copy_stream_idx, "peer_copy"},
+    {update_stream_idx, "update"},
 };
 
+/*! \brief Whether the call is a device_copy between two different GPUs. */
+bool IsPeerDeviceCopy(const CallNode* call) {
+  static auto fschema = Op::GetAttrMap<op::FRAFSchema>("FRAFSchema");
+  static auto* str2dev = tvm::runtime::Registry::Get("raf._core.core_utils.str2dev");
+  if (!IsDeviceCopyOp(call->op)) {
+    return false;
+  }
+  Array<Value> arg_values;
+  for (const auto& arg : call->args) {
+    arg_values.push_back(GetValue(arg));
+  }
+  auto args = fschema[Downcast<Op>(call->op)](arg_values).as<op::schema::DeviceCopyArgs>();
+  CHECK(args != nullptr);
+  Device src = Device((tvm::Device)(*str2dev)(args->src_device));
+  Device dst = Device((tvm::Device)(*str2dev)(args->dst_device));
+  return src.device_type() == DevType::kCUDA() && dst.device_type() == DevType::kCUDA() &&
+         src.device_id() != dst.device_id();
+}
+
 int IdentifyStream(const Expr& op) {
   int stream_idx = compute_stream_idx;
   if (op->IsInstance<CallNode>() && IsCollectiveOp(op.as<CallNode>()->op)) {
@@ -70,6 +94,9 @@ int IdentifyStream(const Expr& op) {
     stream_idx = fuse_tensor_stream_idx;
   } else if (op->IsInstance<CallNode>() && IsDefuseTensorOp(op.as<CallNode>()->op)) {
     stream_idx = defuse_tensor_stream_idx;
+  } else if (op->IsInstance<CallNode>() && IsPeerDeviceCopy(op.as<CallNode>())) {
+    // copies between GPUs overlap with the computation on their own stream.
+    stream_idx = peer_copy_stream_idx;
   }
   return stream_idx;
 }
@@ -79,10 +106,16 @@ class SyncAnalyzer : ExprVisitor {
   /*! \brief Analyse the needed dependency edges between ops. It stores the analysis result in
    * add_event_after_op, wait_event_before_op and set_stream_before_op.
    *
+   * \param expr The body of the function in ANF.
+   * \param params The parameters of the function.
+   * \param overlap_optimizer Whether to run the optimizer updates on their own stream.
    * \returns true if we need to add any dependency edge (i.e. if collective communication ops
-   * are found in expr).
+   * or copies between GPUs are found in expr).
    */
-  bool Analyse(const Expr& expr) {
+  bool Analyse(const Expr& expr, const Array<Var>& params, bool overlap_optimizer) {
+    if (overlap_optimizer) {
+      FindUpdates_(expr, params);
+    }
     VisitExpr(expr);
 
     DepSet dep_set;
@@ -100,6 +133,15 @@ class SyncAnalyzer : ExprVisitor {
     auto call_expr = GetRef<Expr>(call);
     UpdateStreamInfo_(call_expr);
     UpdateDependencyInfo_(call_expr, call->args);
+    if (update_readers_.count(current_idx_)) {
+      // The update may write the parameters in place after they are read on the other streams.
+      for (int reader : update_readers_[current_idx_]) {
+        if (reader < current_idx_) {
+          UpdateLastProducerMap_(current_idx_, reader);
+          UpdateFirstConsumerMap_(reader, current_idx_);
+        }
+      }
+    }
   }
 
   void VisitExpr_(const TupleNode* tuple) {
@@ -156,7 +198,8 @@ class SyncAnalyzer : ExprVisitor {
   // (previous_op_stream_idx_) is different from the executing stream
   // of the current op. It also updates previous_op_stream_idx_.
   void UpdateStreamInfo_(const Expr& op) {
-    idx_stream_map[current_idx_] = IdentifyStream(op);
+    idx_stream_map[current_idx_] =
+        update_readers_.count(current_idx_) ? update_stream_idx : IdentifyStream(op);
     int expected_stream_idx = idx_stream_map[current_idx_];
     if (previous_op_stream_idx_ == -1 || previous_op_stream_idx_ != expected_stream_idx) {
       // if the current op is the first op or last op's stream is not the stream for current op
@@ -341,6 +384,60 @@ class SyncAnalyzer : ExprVisitor {
     }
   }
 
+  // Find the optimizer updates to run on the update stream, and the ops reading their parameters.
+  void FindUpdates_(const Expr& expr, const Array<Var>& params) {
+    optimizer_update::StepGraph graph;
+    std::unordered_map<const Object*, int> var_index;
+    Expr body = expr;
+    while (auto let = body.as<LetNode>()) {
+      int idx = graph.exprs.size();
+      std::vector<int> producers;
+      auto add_producer = [&](const Expr& arg) {
+        auto it = var_index.find(arg.get());
+        if (it != var_index.end()) {
+          producers.push_back(it->second);
+        }
+      };
+      if (auto call = let->value.as<CallNode>()) {
+        for (const auto& arg : call->args) {
+          add_producer(arg);
+        }
+      } else if (auto tuple = let->value.as<TupleNode>()) {
+        for (const auto& field : tuple->fields) {
+          add_producer(field);
+        }
+      } else if (auto tuple_get_item = let->value.as<TupleGetItemNode>()) {
+        add_producer(tuple_get_item->tuple);
+      }
+      graph.exprs.push_back(let->value);
+      graph.producers.push_back(producers);
+      var_index[let->var.get()] = idx;
+      body = let->body;
+    }
+    auto it = var_index.find(body.get());
+    if (it == var_index.end()) {
+      return;
+    }
+    graph.root = graph.primary = it->second;
+    if (auto tuple = graph.exprs[graph.root].as<TupleNode>()) {
+      auto field = tuple->fields.empty() ? var_index.end() : var_index.find(tuple->fields[0].get());
+      graph.primary = field != var_index.end() ? field->second : -1;
+    }
+    std::unordered_set<const Object*> param_set;
+    for (const auto& param : params) {
+      param_set.insert(param.get());
+    }
+    auto updates = optimizer_update::FindUpdates(graph, param_set);
+    for (int i = 0; i < static_cast<int>(graph.exprs.size()); ++i) {
+      if (updates.is_update[i]) {
+        update_readers_[i] = updates.readers[i];
+      }
+    }
+  }
+
+  // maps the index of each optimizer update to the ops reading the parameters it writes
+  std::unordered_map<int, std::vector<int>> update_readers_;
+
   // current_idx_ keeps track of current "depth" (or the index of the op we are visiting in the ANF
   // order) when expanding the nested let exprs
   int current_idx_ = 0;
@@ -485,8 +582,12 @@ class SyncEnforcer : ExprVisitor {
     device_id_ = device.device_id();
     CHECK_EQ(device_id_, GetGlobalCommunicator()->local_rank) << "Current device id != local rank.";
 
-    if (!analyzer_.Analyse(func_->body)) {
-      // no collectives found in expr. do nothing.
+    bool overlap_optimizer =
+        PassContext::Current()
+            ->GetConfig<Bool>(optimizer_update::kOverlapOptimizer, Bool(false))
+            .value();
+    if (!analyzer_.Analyse(func_->body, func_->params, overlap_optimizer)) {
+      // no collectives or peer copies found in expr. do nothing.
       return GetRef<Function>(func_);
     }
 
@@ -8,6 +8,7 @@
  * \brief Estimate the computation FLOPS of the given function.
  */
 #include "estimate_flops.h"
+#include "../op/cost/cost_utils.h"
 
 namespace raf {
 namespace pass {
@@ -18,6 +19,57 @@ using namespace raf::op;
 template <typename T>
 using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
 
+/*! \brief Whether the types of the call and its arguments are checked. */
+bool IsTypeChecked(const CallNode* call) {
+  if (!call->checked_type_.defined()) {
+    return false;
+  }
+  for (const auto& arg : call->args) {
+    if (!arg->checked_type_.defined()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief Estimate the cost of a call to an op, or to a fused function of ops, by the analytic
+ * cost functions of the ops.
+ * \param call The call.
+ * \return The FLOPs, the bytes read and the bytes written, or empty if an op has no cost function
+ * or the shapes are dynamic.
+ */
+Array<FloatImm> AnalyticCost(const CallNode* call) {
+  static auto fcost_map = Op::GetAttrMap<FRAFOpCost>("FRAFOpCost");
+  if (!IsTypeChecked(call)) {
+    return {};
+  }
+  if (auto op_node = call->op.as<OpNode>()) {
+    auto op = GetRef<Op>(op_node);
+    auto fcost = fcost_map.get(IsDialectOp(op) ? GetBaseOp(op) : op, FRAFOpCost());
+    return fcost == nullptr ? Array<FloatImm>() : fcost(GetRef<Call>(call));
+  }
+  auto fn = call->op.as<FunctionNode>();
+  if (fn == nullptr || !fn->HasNonzeroAttr(attr::kPrimitive)) {
+    return {};
+  }
+  double flops = 0;
+  bool known = true;
+  PostOrderVisit(fn->body, [&](const Expr& expr) {
+    if (auto inner = expr.as<CallNode>()) {
+      auto cost = known ? AnalyticCost(inner) : Array<FloatImm>();
+      known = !cost.empty();
+      flops += known ? cost[0]->value : 0;
+    }
+  });
+  if (!known) {
+    return {};
+  }
+  // The fused ops pass the intermediate tensors to each other without the memory, so only the
+  // arguments and the output are counted.
+  return cost::MakeCost(GetRef<Call>(call), flops);
+}
+
 void FLOPSEstimater::VisitExpr_(const LetNode* op) {
   auto pre_visit = [this](const LetNode* op) {
     Expr ovalue = op->value;
@@ -56,6 +108,13 @@ void FLOPSEstimater::VisitExpr_(const LetNode* op) {
 }
 
 void FLOPSEstimater::VisitExpr_(const CallNode* call) {
+  auto cost = AnalyticCost(call);
+  if (!cost.empty()) {
+    var_flops_map_[curr_let_] = cost[0]->value / 1e9;
+    var_bytes_map_[curr_let_] = cost[1]->value + cost[2]->value;
+    return;
+  }
+  // Lower the op or the function to TVM to count its FLOPS.
   if (call->op.as<OpNode>()) {
     const Op& op = Downcast<Op>(call->op);
     auto base_op = IsDialectOp(op) ? GetBaseOp(op) : op;
@@ -134,7 +193,24 @@ PackedFLOPSMap EstimateGFLOPSPacked(const IRModule& mod) {
   return ret;
 }
 
+/*!
+ * \brief Estimate the GFLOPS and the bytes read and written of each let var of the main function,
+ * where the bytes are -1 if they are unknown, i.e., the FLOPS are estimated by lowering the ops.
+ */
+Map<Var, Array<FloatImm>> EstimateCostPacked(const IRModule& mod) {
+  auto device = Device::Current(false);
+  auto func = Downcast<Function>(mod->Lookup("main"));
+  auto estimator = estimate_flops::FLOPSEstimater();
+  Map<Var, Array<FloatImm>> ret;
+  for (const auto& it : estimator.Run(device, func, mod)) {
+    ret.Set(it.first, {FloatImm(DataType::Float(32), it.second),
+                       FloatImm(DataType::Float(32), estimator.GetBytes(it.first))});
+  }
+  return ret;
+}
+
 RAF_REGISTER_GLOBAL("raf.pass_.EstimateGFLOPS").set_body_typed(EstimateGFLOPSPacked);
+RAF_REGISTER_GLOBAL("raf.pass_.EstimateCost").set_body_typed(EstimateCostPacked);
 
 }  // namespace pass
 }  // namespace raf
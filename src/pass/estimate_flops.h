@@ -26,11 +26,12 @@ using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
 
 /*!
  * \brief A visitor to traverse an ANF graph and esitmate the compute FLOPS of each let var
- * that binds to a call expression on the target device. Since we done that by analyzing
- * TVM defined arithmetic expression of an op, the FLOPS may not be accurate if the op is
- * actually dispatched to a non-TVM-dialect, but it should still be sufficient for
- * rematerialization to estimate the relative latency cost between tensors generated
- * by different ops.
+ * that binds to a call expression on the target device. The FLOPS of an op, or of a fused
+ * function of such ops, is given by the analytic cost function registered as FRAFOpCost, which
+ * also gives the bytes it reads and writes. Otherwise, we analyze the TVM defined arithmetic
+ * expression of the op, so the FLOPS may not be accurate if the op is actually dispatched to a
+ * non-TVM-dialect, but it should still be sufficient for rematerialization to estimate the
+ * relative latency cost between tensors generated by different ops.
  */
 class FLOPSEstimater : public ExprVisitor {
  public:
@@ -49,6 +50,12 @@ class FLOPSEstimater : public ExprVisitor {
     return var_flops_map_[var];
   }
 
+  /*! \brief The bytes read and written by the expression of the var, or -1 if unknown. */
+  float GetBytes(const Var& var) {
+    auto it = var_bytes_map_.find(var);
+    return it == var_bytes_map_.end() ? -1 : it->second;
+  }
+
   void VisitExpr_(const LetNode* op) override;
   void VisitExpr_(const CallNode* op) override;
 
@@ -62,6 +69,9 @@ class FLOPSEstimater : public ExprVisitor {
   Device device_;
   /*! \brief Mapping from the let binding var to the GFLOPS of its expression. */
   StdMap<float> var_flops_map_;
+  /*! \brief Mapping from the let binding var to the bytes read and written by its expression,
+   * which are known if it is estimated analytically. */
+  StdMap<float> var_bytes_map_;
 };
 
 }  // namespace estimate_flops
@@ -5,14 +5,17 @@
 
 /*!
  * \file estimate_memory.cc
- * \brief Estimate the memory footprint. Note that this can only be used after ManifestAlloc pass.
+ * \brief Estimate the memory footprint. Note that the memory trace can only be estimated after
+ * ManifestAlloc pass, while the memory prediction works on the IR before compilation.
  */
+#include <algorithm>
 #include "raf/device.h"
 #include "raf/op.h"
 #include "raf/op_profiler.h"
 #include "raf/pass.h"
 #include "./let_list.h"
 #include "./common.h"
+#include "./liveness_analysis.h"
 #include "../common/shape_utils.h"
 
 namespace raf {
@@ -27,11 +30,19 @@ constexpr float kMegaBytes = 1048576;
 
 /*!
  * \brief A visitor to visit after ManifestAlloc ANF IR and estimate the memory footprint.
+ * When early free is enabled, the storages that are not freed by vm.free and do not back the
+ * output are released after the last use of them and the tensors, views and tuples referring
+ * to them, as the VM kills the registers at their last uses.
  */
 class MemoryTracer : public ExprVisitor {
  public:
-  MemoryTracer(const Device& device, const Function& func, const IRModule& mod, bool include_params)
+  MemoryTracer(const Device& device, const Function& func, const IRModule& mod, bool include_params,
+               bool early_free)
       : ell_(ExplicitLetList::make(func->body)), device_(device), mod_(mod) {
+    early_frees_.resize(ell_->vars.size());
+    if (early_free) {
+      PlanEarlyFrees();
+    }
     profiler_ = op_profiler::OpProfiler::Get(device);
     if (include_params) {
       for (const auto param : func->params) {
@@ -58,6 +69,19 @@ class MemoryTracer : public ExprVisitor {
       let_map_.Set(vars[i], exprs[i]);
       curr_let_ = vars[i];
       ExprVisitor::VisitExpr(exprs[i]);
+
+      for (const auto& storage_var : early_frees_[i]) {
+        auto it = storage_vars_.find(storage_var);
+        if (it != storage_vars_.end()) {
+          curr_memoey_mbs_ -= it->second;
+          early_freed_mbs_ += it->second;
+          storage_vars_.erase(it);
+        }
+      }
+    }
+    if (early_freed_mbs_ > 0) {
+      DLOG(INFO) << "Early free releases " << early_freed_mbs_
+                 << " MBs of storages at their last uses";
     }
 
     // Add the final trace. At this point, the memory usage should just include the outputs.
@@ -103,6 +127,70 @@ class MemoryTracer : public ExprVisitor {
   }
 
  private:
+  /*! \brief Find the line after which each storage without vm.free is released. */
+  void PlanEarlyFrees() {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+    static const Op& free_op = Op::Get("raf.op.vm.free");
+    static const Op& set_shape_op = Op::Get("raf.op.vm.set_shape");
+    using VSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    // The storages each var refers to, and the last line using each storage.
+    std::unordered_map<Var, VSet, ObjectPtrHash, ObjectPtrEqual> storages_of;
+    std::unordered_map<Var, size_t, ObjectPtrHash, ObjectPtrEqual> last_use;
+    VSet freed;
+    auto use = [&](const Expr& expr, size_t line, VSet* refs) {
+      if (auto var = expr.as<VarNode>()) {
+        auto it = storages_of.find(GetRef<Var>(var));
+        if (it != storages_of.end()) {
+          for (const auto& storage_var : it->second) {
+            last_use[storage_var] = line;
+            refs->insert(storage_var);
+          }
+        }
+      }
+    };
+    for (size_t i = 0; i < vars.size(); ++i) {
+      VSet refs;
+      if (auto call = exprs[i].as<CallNode>()) {
+        for (const auto& arg : call->args) {
+          use(arg, i, &refs);
+        }
+        if (call->op.same_as(alloc_storage_op)) {
+          refs.insert(vars[i]);
+          last_use[vars[i]] = i;
+        } else if (call->op.same_as(free_op)) {
+          freed.insert(Downcast<Var>(call->args[0]));
+        } else if (!call->op.same_as(alloc_tensor_op) && !call->op.same_as(set_shape_op)) {
+          // Other calls (e.g., invoke_op) only write to the given tensors.
+          refs.clear();
+        }
+      } else if (auto tuple = exprs[i].as<TupleNode>()) {
+        for (const auto& field : tuple->fields) {
+          use(field, i, &refs);
+        }
+      } else if (auto tgi = exprs[i].as<TupleGetItemNode>()) {
+        use(tgi->tuple, i, &refs);
+      } else {
+        use(exprs[i], i, &refs);
+      }
+      if (!refs.empty()) {
+        storages_of[vars[i]] = std::move(refs);
+      }
+    }
+
+    // The storages referred by the output are never released.
+    VSet outputs;
+    use(ell_->ret, vars.size(), &outputs);
+    for (const auto& kv : last_use) {
+      if (!freed.count(kv.first) && !outputs.count(kv.first)) {
+        early_frees_[kv.second].push_back(kv.first);
+      }
+    }
+  }
+
+
   /*! \brief The current processing let var. */
   Var curr_let_;
   /*! \brief Let binding vars to the expression. */
@@ -122,6 +210,130 @@ class MemoryTracer : public ExprVisitor {
   MemoryTrace trace_;
   /*! \brief Current memory usage. */
   float curr_memoey_mbs_ = 0;
+  /*! \brief The storages released early after each line. */
+  std::vector<std::vector<Var>> early_frees_;
+  /*! \brief The total size of the storages released early. */
+  float early_freed_mbs_ = 0;
+};
+
+/*!
+ * \brief Predict the memory footprint of an ANF function before compilation. The memory of each
+ * line is the total size of the tensors live at the line, which includes the parameters and the
+ * output of the line, plus the workspace of the op. Unlike MemoryTracer, the prediction assumes
+ * each tensor is freed right after its last use, which is what the memory planner approaches.
+ */
+class MemoryPredictor {
+ public:
+  MemoryPredictor(const Device& device, const Function& func, bool include_workspace)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+    if (include_workspace) {
+      profiler_ = op_profiler::OpProfiler::Get(device);
+    }
+  }
+
+  Map<String, ObjectRef> Run() {
+    auto analyzer = liveness_analysis::LivenessAnalyzer::Get(func_);
+    CHECK(analyzer->IsSuccess()) << "Liveness analysis was failed";
+    analyzer_ = analyzer.get();
+
+    float param_mbs = 0;
+    for (const auto& param : func_->params) {
+      for (const auto& tensor : AddTensorSizes(param)) {
+        param_tensors_.insert(tensor);
+        param_mbs += tensor_mbs_[tensor];
+      }
+    }
+
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    CHECK_EQ(vars.size(), exprs.size());
+    Array<Array<ObjectRef>> trace;
+    float peak_mbs = param_mbs, peak_activation_mbs = 0, peak_workspace_mbs = 0;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      // The live tensors at a line are its live-in tensors and its outputs.
+      liveness_analysis::VSet live = analyzer_->GetLiveVars(vars[i]);
+      for (const auto& tensor : AddTensorSizes(vars[i])) {
+        live.insert(tensor);
+      }
+      float activation_mbs = 0;
+      for (const auto& tensor : live) {
+        if (!param_tensors_.count(tensor) && tensor_mbs_.count(tensor)) {
+          activation_mbs += tensor_mbs_[tensor];
+        }
+      }
+      std::string name;
+      float workspace_mbs = 0;
+      if (!GetCallInfo(exprs[i], &name, &workspace_mbs)) {
+        continue;
+      }
+      trace.push_back({String(name), FloatImm(DataType::Float(32), activation_mbs),
+                       FloatImm(DataType::Float(32), workspace_mbs)});
+      if (param_mbs + activation_mbs + workspace_mbs > peak_mbs) {
+        peak_mbs = param_mbs + activation_mbs + workspace_mbs;
+        peak_activation_mbs = activation_mbs;
+        peak_workspace_mbs = workspace_mbs;
+      }
+    }
+    return {{"trace", trace},
+            {"param", FloatImm(DataType::Float(32), param_mbs)},
+            {"activation", FloatImm(DataType::Float(32), peak_activation_mbs)},
+            {"workspace", FloatImm(DataType::Float(32), peak_workspace_mbs)},
+            {"peak", FloatImm(DataType::Float(32), peak_mbs)}};
+  }
+
+ private:
+  /*! \brief Record the sizes of the tensors of the given var and return the tensors. */
+  Array<Var> AddTensorSizes(const Var& var) {
+    auto tensors = analyzer_->GetTensorVars(var);
+    if (!var->checked_type_.defined() || var->checked_type().as<FuncTypeNode>()) {
+      return tensors;
+    }
+    auto sizes = liveness_analysis::CalcBytesCompactSizes(var->checked_type());
+    if (sizes.size() == tensors.size()) {
+      for (size_t i = 0; i < sizes.size(); ++i) {
+        float& mbs = tensor_mbs_[tensors[i]];
+        mbs = std::max(mbs, sizes[i] / kMegaBytes);
+      }
+    }
+    return tensors;
+  }
+
+  /*! \brief Get the name and the workspace size of a call. Return false if it is not a call. */
+  bool GetCallInfo(const Expr& expr, std::string* name, float* workspace_mbs) {
+    auto call = expr.as<CallNode>();
+    if (call == nullptr) {
+      return false;
+    }
+    if (auto op = call->op.as<OpNode>()) {
+      *name = op->name;
+    } else if (auto func = call->op.as<FunctionNode>()) {
+      *name = func->GetAttr<String>(attr::kDialect).value_or("fused");
+    } else {
+      *name = "unknown";
+    }
+    if (profiler_ != nullptr && call->checked_type_.defined()) {
+      auto exec_time_and_ws_size = profiler_->ProfileOp(expr, 0, 0, 0);
+      *workspace_mbs = exec_time_and_ws_size.second / kMegaBytes;
+      auto op_env = profiler_->GetOpEnv(expr);
+      if (op_env != nullptr) {
+        *name = op_env->name();
+      }
+    }
+    return true;
+  }
+
+  /*! \brief The function to be analyzed. */
+  Function func_;
+  /*! \brief The explicit let list of func_. */
+  std::unique_ptr<ExplicitLetList> ell_{nullptr};
+  /*! \brief The liveness analyzer of func_. */
+  liveness_analysis::LivenessAnalyzer* analyzer_ = nullptr;
+  /*! \brief The profiler used to get the workspace sizes, or nullptr to ignore workspaces. */
+  op_profiler::OpProfiler* profiler_ = nullptr;
+  /*! \brief The sizes of the dummy tensors in MBs. */
+  std::unordered_map<Var, float, ObjectPtrHash, ObjectPtrEqual> tensor_mbs_;
+  /*! \brief The dummy tensors of the parameters. */
+  liveness_analysis::VSet param_tensors_;
 };
 
 }  // namespace estimate_memory
@@ -130,11 +342,19 @@ estimate_memory::MemoryTrace EstimateMemory(const IRModule& mod, const Device& d
                                             bool include_params) {
   auto entry = mod->GetGlobalVar("main");
   auto func = Downcast<Function>(mod->Lookup(entry));
-  auto estimator = estimate_memory::MemoryTracer(device, func, mod, include_params);
+  bool early_free = PassContext::Current()->GetConfig("raf.vm.early_free", Bool(true)).value();
+  auto estimator = estimate_memory::MemoryTracer(device, func, mod, include_params, early_free);
   return estimator.Run();
 }
 
+Map<String, ObjectRef> PredictMemory(const IRModule& mod, const Device& device,
+                                     bool include_workspace) {
+  auto func = Downcast<Function>(pass::InferType(mod->Lookup("main")));
+  return estimate_memory::MemoryPredictor(device, func, include_workspace).Run();
+}
+
 RAF_REGISTER_GLOBAL("raf.pass_.EstimateMemory").set_body_typed(EstimateMemory);
+RAF_REGISTER_GLOBAL("raf.pass_.PredictMemory").set_body_typed(PredictMemory);
 
 }  // namespace pass
 }  // namespace raf
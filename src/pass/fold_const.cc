@@ -13,6 +13,7 @@
 #include "raf/pass.h"
 #include "raf/executor.h"
 #include "raf/binding.h"
+#include "../common/shape_utils.h"
 
 namespace raf {
 namespace pass {
@@ -53,15 +54,165 @@ class ConstantChecker : private ExprVisitor {
   }
 };
 
+/*! \brief Count the uses of each expression, i.e., the number of expressions referring to it. */
+class UseCounter : public ExprVisitor {
+ public:
+  std::unordered_map<const Object*, int> Count(const Expr& expr) {
+    VisitExpr(expr);
+    return std::move(counts_);
+  }
+
+  void VisitExpr(const Expr& expr) override {
+    counts_[expr.get()]++;
+    ExprVisitor::VisitExpr(expr);
+  }
+
+  void VisitExpr_(const LetNode* op) override {
+    // Visit the let chain iteratively, as it can be too long to be visited recursively.
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      VisitExpr(let->value);
+      expr = let->body;
+    }
+    VisitExpr(expr);
+  }
+
+ private:
+  std::unordered_map<const Object*, int> counts_;
+};
+
+/*! \brief The options of the constant folding, which are read from the pass context. */
+struct FoldOptions {
+  /*!
+   * \brief Whether to defer the foldable calls and evaluate all of them in one batch, instead of
+   * interpreting each of them once it is found.
+   */
+  bool batch = false;
+  /*! \brief The max bytes of the output of a folded call, or non-positive for unlimited. */
+  int64_t max_bytes = 0;
+  /*! \brief The device that the batch runs on, or the devices of the constants if empty. */
+  std::string device;
+};
+
+/*! \brief Replace the placeholders of the deferred calls by their results. */
+class PlaceholderBinder : public ExprMutator {
+ public:
+  explicit PlaceholderBinder(const std::unordered_map<const VarNode*, Expr>& binds)
+      : binds_(binds) {
+  }
+
+  Expr VisitExpr_(const VarNode* op) final {
+    auto it = binds_.find(op);
+    return it != binds_.end() ? it->second : GetRef<Expr>(op);
+  }
+
+  Expr VisitExpr_(const LetNode* op) final {
+    auto pre_visit = [this](const LetNode* op) { this->Mutate(op->value); };
+    auto post_visit = [this](const LetNode* op) {
+      Expr expr = GetRef<Expr>(op);
+      Expr value = this->Mutate(op->value);
+      Expr body = this->Mutate(op->body);
+      if (value.same_as(op->value) && body.same_as(op->body)) {
+        this->memo_[expr] = expr;
+      } else {
+        this->memo_[expr] = Let(op->var, value, body);
+      }
+    };
+    ExpandANormalForm(op, pre_visit, post_visit);
+    return memo_[GetRef<Expr>(op)];
+  }
+
+ private:
+  const std::unordered_map<const VarNode*, Expr>& binds_;
+};
+
+/*! \brief Move the tensor constants to the device where they are folded. */
+class ConstantMover : public ExprMutator {
+ public:
+  explicit ConstantMover(const Device& device) : device_(device) {
+  }
+
+  Expr VisitExpr_(const RelayConstantNode* op) final {
+    const auto* node = static_cast<const ConstantNode*>(op);
+    if (!node->IsTensor()) {
+      return GetRef<Expr>(op);
+    }
+    return MakeConstant(CopyTo(Downcast<Value>(node->value), device_));
+  }
+
+ private:
+  Device device_;
+};
+
 class ConstantFolder : public ExprMutator {
  public:
+  explicit ConstantFolder(const Expr& expr, const FoldOptions& options = FoldOptions())
+      : use_counts_(UseCounter().Count(expr)), options_(options) {
+  }
+
+  /*!
+   * \brief Fold the constants of a function. In the batch mode, the deferred calls are evaluated
+   * at last, and the placeholders of their results are replaced by the constants.
+   */
+  Function Fold(const Function& func) {
+    auto ret = Downcast<Function>(Mutate(func));
+    if (pending_.empty()) {
+      return ret;
+    }
+    // The results used by the function, which are not the intermediate ones of the batch.
+    auto counts = UseCounter().Count(ret);
+    Array<Var> roots;
+    for (const auto& var : pending_order_) {
+      if (counts.count(var.get())) {
+        roots.push_back(var);
+      }
+    }
+    if (roots.empty()) {
+      return ret;
+    }
+    std::unordered_set<const VarNode*> needed;
+    std::vector<Var> stack(roots.begin(), roots.end());
+    while (!stack.empty()) {
+      Var var = stack.back();
+      stack.pop_back();
+      if (!needed.insert(var.get()).second) {
+        continue;
+      }
+      for (const auto& dep : FreeVars(pending_.at(var.get()))) {
+        if (pending_.count(dep.get())) {
+          stack.push_back(dep);
+        }
+      }
+    }
+    std::unique_ptr<ConstantMover> mover;
+    if (!options_.device.empty()) {
+      static auto* str2dev = tvm::runtime::Registry::Get("raf._core.core_utils.str2dev");
+      mover.reset(new ConstantMover(Device((tvm::Device)(*str2dev)(options_.device))));
+    }
+    // The deferred calls are created after their args, so they are bound in the creation order.
+    Expr batch = Tuple(Array<Expr>(roots.begin(), roots.end()));
+    for (auto it = pending_order_.rbegin(); it != pending_order_.rend(); ++it) {
+      if (needed.count(it->get())) {
+        Expr expr = pending_.at(it->get());
+        batch = Let(*it, mover ? mover->Mutate(expr) : expr, batch);
+      }
+    }
+    auto results = Downcast<TupleValue>(executor::interpreter::Interpret(batch, GlobalModule()));
+    std::unordered_map<const VarNode*, Expr> binds;
+    for (size_t i = 0; i < roots.size(); ++i) {
+      binds[roots[i].get()] = ObjectToExpr(results->fields[i]);
+    }
+    return Downcast<Function>(PlaceholderBinder(binds).Mutate(ret));
+  }
+
   Expr VisitExpr_(const LetNode* op) final {
     auto pre_visit = [this](const LetNode* op) {
       // Rely on the Memoizer to cache pre-visit values
       Expr value = this->Mutate(op->value);
-      if (value.as<ConstantNode>()) {
+      if (value.as<ConstantNode>() || IsPending(value)) {
         this->memo_[op->var] = value;
       } else {
+        this->bindings_[op->var.get()] = value;
         this->Mutate(op->var);
       }
     };
@@ -69,10 +220,15 @@ class ConstantFolder : public ExprMutator {
       Expr expr = GetRef<Expr>(op);
       // Rely on the Memoizer to cache pre-visit values
       Expr value = this->Mutate(op->value);
-      if (value.as<ConstantNode>()) {
+      if (value.as<ConstantNode>() || IsPending(value)) {
         this->memo_[expr] = this->Mutate(op->body);
       } else {
         Var var = Downcast<Var>(this->Mutate(op->var));
+        // The binding may have been rewritten when folding its only user.
+        auto it = this->rebound_.find(op->var.get());
+        if (it != this->rebound_.end()) {
+          value = it->second;
+        }
         Expr body = this->Mutate(op->body);
         if (var.same_as(op->var) && value.same_as(op->value) && body.same_as(op->body)) {
           this->memo_[expr] = expr;
@@ -90,6 +246,7 @@ class ConstantFolder : public ExprMutator {
                                                      "full"};
 
     auto origin_args = call->args;
+    const CallNode* origin_call = call;
     Expr res = ExprMutator::VisitExpr_(call);
     call = res.as<CallNode>();
 
@@ -102,6 +259,10 @@ class ConstantFolder : public ExprMutator {
     if (skip_list.count(op->name)) {
       return res;
     }
+    Expr folded_bn = FoldBatchNorm(call, origin_args[0]);
+    if (folded_bn.defined()) {
+      return folded_bn;
+    }
 
     // TODO(haibin): skip stateful ops.
     // TODO(haibin): Evaluate a call to the shape_of operator for tensors with constant shapes.
@@ -110,15 +271,14 @@ class ConstantFolder : public ExprMutator {
 
     bool all_const_args = true;
     for (Expr arg : call->args) {
-      if (!checker_.IsConstant(arg)) {
+      if (!IsFoldable(arg)) {
         all_const_args = false;
       }
     }
-    if (all_const_args) {
-      return ConstEvaluate(res);
-    } else {
+    if (!all_const_args || IsTooLarge(origin_call->checked_type_)) {
       return res;
     }
+    return options_.batch ? Defer(res) : ConstEvaluate(res);
   }
 
   Expr VisitExpr_(const TupleGetItemNode* op) final {
@@ -126,6 +286,8 @@ class ConstantFolder : public ExprMutator {
     op = res.as<TupleGetItemNode>();
     if (const auto* tuple = op->tuple.as<TupleNode>()) {
       return tuple->fields[op->index];
+    } else if (IsPending(op->tuple)) {
+      return Defer(res);
     } else if (const auto* relay_const = op->tuple.as<RelayConstantNode>()) {
       const auto* raf_const = static_cast<const ConstantNode*>(relay_const);
       auto value = Downcast<TupleValue>(raf_const->value);
@@ -138,6 +300,171 @@ class ConstantFolder : public ExprMutator {
  private:
   // Internal constant checker
   ConstantChecker checker_;
+  // The number of uses of each expression in the original function
+  std::unordered_map<const Object*, int> use_counts_;
+  // The (mutated) values bound to the let vars that are not constants
+  std::unordered_map<const VarNode*, Expr> bindings_;
+  // The let vars whose values are replaced when folding their users
+  std::unordered_map<const VarNode*, Expr> rebound_;
+  // The options of the folding
+  FoldOptions options_;
+  // The placeholders of the deferred calls in the batch mode, and the calls
+  std::unordered_map<const VarNode*, Expr> pending_;
+  // The placeholders in the order they are created
+  std::vector<Var> pending_order_;
+
+  bool IsPending(const Expr& expr) {
+    const auto* var = expr.as<VarNode>();
+    return var != nullptr && pending_.count(var);
+  }
+
+  // Whether an expression is a constant, or a result of the deferred calls.
+  bool IsFoldable(const Expr& expr) {
+    if (IsPending(expr)) {
+      return true;
+    }
+    if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const auto& field : tuple->fields) {
+        if (!IsFoldable(field)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return checker_.IsConstant(expr);
+  }
+
+  // Whether the output of a call is larger than the limit, which is unknown without its type.
+  bool IsTooLarge(const Type& type) {
+    if (options_.max_bytes <= 0 || !type.defined()) {
+      return false;
+    }
+    int64_t nbytes = 0;
+    std::function<bool(const Type&)> add_bytes = [&](const Type& ty) {
+      if (const auto* tensor_type = ty.as<TensorTypeNode>()) {
+        nbytes += common::shape_utils::BytesCompactTensor(tensor_type);
+        return true;
+      }
+      if (const auto* tuple_type = ty.as<TupleTypeNode>()) {
+        for (const auto& field : tuple_type->fields) {
+          if (!add_bytes(field)) {
+            return false;
+          }
+        }
+        return true;
+      }
+      return false;
+    };
+    return add_bytes(type) && nbytes > options_.max_bytes;
+  }
+
+  // Defer a foldable call to the batch, and return the placeholder of its result.
+  Var Defer(const Expr& expr) {
+    Var var = MakeVar("folded_" + std::to_string(pending_order_.size()), {});
+    pending_[var.get()] = expr;
+    pending_order_.push_back(var);
+    return var;
+  }
+
+  /*!
+   * \brief Fold batch_norm_infer(conv2d(x, w), mean, var, gamma, beta) into
+   *   bias_add(conv2d(x, w * scale), beta - mean * scale), where scale = gamma / sqrt(var + eps),
+   *   when the conv2d weight and the batch norm parameters are all constants, e.g., after binding
+   *   the parameters for inference. The conv2d must output NCHW with the output channel as the
+   *   first dimension of the weight, and must not be used by others.
+   * \param call The (mutated) call to batch_norm_infer.
+   * \param origin_x The original input of the batch norm, which is used to count its uses.
+   * \return The folded expression, or an undefined expression if it cannot be folded.
+   */
+  Expr FoldBatchNorm(const CallNode* call, const Expr& origin_x) {
+    static const Op bn_op = Op::Get("raf.op.batch_norm_infer");
+    static const Op conv_op = Op::Get("raf.op.conv2d");
+    static const Op add_op = Op::Get("raf.op.add");
+    static const Op subtract_op = Op::Get("raf.op.subtract");
+    static const Op multiply_op = Op::Get("raf.op.multiply");
+    static const Op rsqrt_op = Op::Get("raf.op.rsqrt");
+    static const Op negative_op = Op::Get("raf.op.negative");
+    static const Op expand_dims_op = Op::Get("raf.op.expand_dims");
+    static const Op bias_add_op = Op::Get("raf.op.bias_add");
+    if (!call->op.same_as(bn_op)) {
+      return Expr();
+    }
+    auto is_tensor = [](const Expr& expr) {
+      const auto* node = expr.as<ConstantNode>();
+      return node != nullptr && node->IsTensor();
+    };
+    auto is_null = [](const Expr& expr) {
+      const auto* node = expr.as<ConstantNode>();
+      return node != nullptr && !node->value.defined();
+    };
+    auto get_str = [](const Expr& expr) -> std::string {
+      const auto* node = expr.as<ConstantNode>();
+      const auto* str = node ? node->value.as<StringValueObj>() : nullptr;
+      return str ? str->value : "";
+    };
+    const Expr& mean = call->args[1];
+    const Expr& var = call->args[2];
+    const Expr& gamma = call->args[3];
+    const Expr& beta = call->args[4];
+    if (!is_tensor(mean) || !is_tensor(var) || !(is_tensor(gamma) || is_null(gamma)) ||
+        !(is_tensor(beta) || is_null(beta))) {
+      return Expr();
+    }
+
+    // The input is a let var in ANF, or the conv2d call itself in GNF.
+    const CallNode* conv = call->args[0].as<CallNode>();
+    const auto* conv_var = call->args[0].as<VarNode>();
+    if (conv_var != nullptr) {
+      auto it = bindings_.find(conv_var);
+      conv = it != bindings_.end() ? it->second.as<CallNode>() : nullptr;
+    }
+    auto it = use_counts_.find(origin_x.get());
+    if (conv == nullptr || !conv->op.same_as(conv_op) || !is_tensor(conv->args[1]) ||
+        it == use_counts_.end() || it->second != 1) {
+      return Expr();
+    }
+    std::string kernel_layout = get_str(conv->args[7]);
+    if (kernel_layout.empty() || kernel_layout[0] != 'O' || get_str(conv->args[8]) != "NCHW") {
+      return Expr();
+    }
+    auto get_tensor = [](const Expr& expr) -> DLTensor* {
+      return Downcast<TensorValue>(ConstantExtractValue(Downcast<Constant>(expr)));
+    };
+    DLTensor* w = get_tensor(conv->args[1]);
+    for (const Expr& param : {mean, var, gamma, beta}) {
+      if (is_tensor(param) && DType(get_tensor(param)->dtype) != DType(w->dtype)) {
+        return Expr();
+      }
+    }
+    double eps = GetScalarValueData<double>(
+        Downcast<Value>(ConstantExtractValue(Downcast<Constant>(call->args[6]))));
+
+    Expr scale = Call(rsqrt_op, {Call(add_op, {var, MakeConstant(ScalarValue::make(eps)),
+                                               MakeNull(), MakeNull()})});
+    if (is_tensor(gamma)) {
+      scale = Call(multiply_op, {gamma, scale});
+    }
+    scale = ConstEvaluate(scale);
+    // Scale the output channels, i.e., the first dimension of the weight.
+    Expr channel_scale = Call(expand_dims_op, {scale, MakeConstant(ScalarValue::make(1)),
+                                               MakeConstant(ScalarValue::make(w->ndim - 1))});
+    Expr new_w = ConstEvaluate(Call(multiply_op, {conv->args[1], channel_scale}));
+    Expr shift = Call(multiply_op, {mean, scale});
+    Expr new_b = is_tensor(beta) ? Call(subtract_op, {beta, shift, MakeNull(), MakeNull()})
+                                 : Call(negative_op, {shift});
+    new_b = ConstEvaluate(new_b);
+
+    Array<Expr> conv_args = conv->args;
+    conv_args.Set(1, new_w);
+    Expr new_conv = Call(conv->op, conv_args, conv->attrs, conv->type_args);
+    Expr conv_out = new_conv;
+    if (conv_var != nullptr) {
+      // Keep the ANF by rebinding the let var of the conv2d to the new conv2d.
+      rebound_[conv_var] = new_conv;
+      conv_out = GetRef<Var>(conv_var);
+    }
+    return Call(bias_add_op, {conv_out, new_b, MakeConstant(ScalarValue::make(1))});
+  }
 
   // Convert value to expression.
   Expr ObjectToExpr(const ObjectRef& value) {
@@ -225,11 +552,20 @@ ir::Expr BindParam(ir::Function func, ir::Array<ir::Expr> args) {
 Pass FoldConstant() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(fold_const::ConstantFolder().Mutate(f));
+    fold_const::FoldOptions options;
+    options.batch = pc->GetConfig<tvm::Bool>("raf.fold_constant.batch", tvm::Bool(false)).value();
+    options.max_bytes =
+        pc->GetConfig("raf.fold_constant.max_bytes", Integer(0)).value().IntValue();
+    options.device = pc->GetConfig<String>("raf.fold_constant.device", "").value();
+    return fold_const::ConstantFolder(f, options).Fold(f);
   };
   return CreateRAFFunctionPass(pass_func, 1, "FoldConstant", {});
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fold_constant.batch", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fold_constant.max_bytes", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fold_constant.device", String);
+
 RAF_REGISTER_GLOBAL("raf.pass_.is_constant").set_body_typed(IsConstant);
 RAF_REGISTER_GLOBAL("raf.pass_.FoldConstant").set_body_typed(FoldConstant);
 RAF_REGISTER_GLOBAL("raf.pass_.BindParam").set_body_typed(BindParam);
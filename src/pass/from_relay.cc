@@ -8,6 +8,8 @@
  * \brief Build raf ir from Relay
  */
 #include <map>
+#include <unordered_set>
+#include <tvm/relay/analysis.h>
 #include <tvm/relay/transform.h>
 #include <tvm/support/with.h>
 #include <relay/transforms/pattern_utils.h>
@@ -15,6 +17,7 @@
 #include "raf/op_utils.h"
 #include "raf/ir_ext.h"
 #include "raf/pass.h"
+#include "raf/tensor.h"
 #include "./let_list.h"
 #include "../op/dialect/tvm/tvm_attrs.h"
 
@@ -39,6 +42,8 @@ struct RelayPattern {
 
   /*! \brief The data flow pattern to match the Relay graph. */
   DFPattern pattern;
+  /*! \brief An op that every match contains, so a function without it is not partitioned. */
+  std::string anchor_op;
   /*! \brief The customized checker to further check if the matched pattern is valid. */
   PackedFunc check;
 };
@@ -52,6 +57,7 @@ struct ConvertDense : RelayPattern {
     in_1 = IsOp("transpose")({IsWildcard()}) || in_1;
     in_2 = IsOp("transpose")({IsWildcard()}) || in_2;
     this->pattern = IsOp("nn.dense")({in_1, in_2});
+    this->anchor_op = "nn.dense";
 
     // Checker always returns true
     this->check = PackedFunc([](TVMArgs args, TVMRetValue* rv) { *rv = true; });
@@ -98,6 +104,7 @@ struct CompositeGelu : RelayPattern {
   CompositeGelu() {
     // Match Patterns
     this->pattern = GetGeluPattern(64) || GetGeluPattern(32) || GetGeluPattern(16);
+    this->anchor_op = "erf";
 
     // Checker always returns true
     this->check = PackedFunc([](TVMArgs args, TVMRetValue* rv) { *rv = true; });
@@ -135,6 +142,7 @@ struct ConvertEmbedding : RelayPattern {
     // First match all take ops with the second input casted or constant.
     auto cast_or_const = IsOp("cast")({IsWildcard()}) || IsRelayConstant();
     this->pattern = IsOp("take")({IsWildcard(), cast_or_const});
+    this->anchor_op = "take";
 
     // Then check if it is from an embedding op.
     // TODO(comaniac): We do not have a better way to differentiate embedding ops from
@@ -204,14 +212,23 @@ String ValidateRelayParamName(const String var_name) {
   return String(name_str);
 }
 
+/*!
+ * \brief The RAF constants converted from the Relay constants, keyed by their NDArrays. It is
+ * shared by the functions of a module, so a constant used by many functions or many nodes, e.g.,
+ * after the Relay passes fold and duplicate the weights, is converted to a single constant.
+ */
+using ConstantMap = std::unordered_map<const Object*, Expr>;
+
 struct FromRelayMutator : public ExprMutator {
  public:
-  FromRelayMutator() {
+  explicit FromRelayMutator(ConstantMap* constants) : constants_(constants) {
     scopes_.emplace_back(new LetList);
   }
 
   Expr VisitExpr_(const VarNode* node) final {
-    return var_map_.at(GetRef<Var>(node));
+    auto it = var_map_.find(GetRef<Var>(node));
+    CHECK(it != var_map_.end()) << "Var " << node->name_hint() << " is not bound";
+    return it->second;
   }
 
   Expr VisitExpr_(const RelayConstantNode* node) final {
@@ -220,9 +237,15 @@ struct FromRelayMutator : public ExprMutator {
     if (node->data->data == fake_tensor->data->data) {
       return GetRef<Expr>(node);
     }
-    static const auto& from_tvm = registry::GetPackedFunc("raf.value.FromTVM");
-    auto tv = from_tvm(node->data);
-    return MakeConstant(tv);
+    auto it = constants_->find(node->data.get());
+    if (it != constants_->end()) {
+      return it->second;
+    }
+    // The tensor value shares the memory of the NDArray rather than copying it.
+    auto tv = TensorValue::make(tensor::Tensor::FromDLPack(node->data.ToDLPack()));
+    auto ret = MakeConstant(tv);
+    constants_->emplace(node->data.get(), ret);
+    return ret;
   }
 
   Expr VisitExpr_(const LetNode* node) final {
@@ -231,9 +254,9 @@ struct FromRelayMutator : public ExprMutator {
     Expr body;
     do {
       const Var& var = node->var;
-      CHECK_EQ(var_map_.count(var), 0) << "IR is malformed: cannot bind the same var twice";
       Var new_var = raf::ir::MakeVar("a" + std::to_string(++num_bound_var_), var->type_annotation);
-      var_map_.Set(var, new_var);
+      CHECK(var_map_.emplace(var, new_var).second)
+          << "IR is malformed: cannot bind the same var twice";
       curr_let_var_ = new_var;
       auto new_value = this->Mutate(node->value);
       var_value_map_.Set(var, new_value);
@@ -353,7 +376,7 @@ struct FromRelayMutator : public ExprMutator {
       auto name_hint = ValidateRelayParamName(param->name_hint());
       Var new_param = raf::ir::MakeVar(name_hint, param->type_annotation);
       params.push_back(new_param);
-      var_map_.Set(param, new_param);
+      var_map_[param] = new_param;
     }
 
     // Mutate the function body. Note that if this is a composite function, then
@@ -403,7 +426,9 @@ struct FromRelayMutator : public ExprMutator {
   /*! \brief The counter of bound variables. */
   int num_bound_var_ = 0;
   /*! \brief Map from var in Relay graph to the converted RAF graph. */
-  Map<Var, Var> var_map_;
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> var_map_;
+  /*! \brief The converted constants shared by the functions of the module. */
+  ConstantMap* constants_;
   /*! \brief Map from var in Relay graph to the converted RAF graph value. */
   Map<Var, Expr> var_value_map_;
   /*! \brief Map from unsupported op name to the appearance. */
@@ -419,9 +444,19 @@ struct FromRelayMutator : public ExprMutator {
 }  // namespace from_relay
 
 Function PartitionPatterns(Function func) {
+  // Collect the ops once, so the patterns whose anchor ops are absent skip the graph matching.
+  std::unordered_set<std::string> ops;
+  tvm::relay::PostOrderVisit(func, [&ops](const Expr& expr) {
+    if (auto op = expr.as<OpNode>()) {
+      ops.insert(op->name);
+    }
+  });
   Function ret = func;
   for (auto name_n_pattern : raf::pass::from_relay::composite_patterns) {
     auto pattern = name_n_pattern.second;
+    if (!ops.count(pattern->anchor_op)) {
+      continue;
+    }
     Map<String, ObjectRef> attrs;
     attrs.Set("Composite", name_n_pattern.first);
     attrs.Set("Primitive", Integer(1));
@@ -451,32 +486,36 @@ Pass FromRelay(Array<String> disabled_pass) {
       updated_mod = ApplyTransformSeq(updated_mod);
     }
 
-    // Convert each function
-    std::vector<std::pair<GlobalVar, Function>> updates;
+    // Convert each function, and replace it right away, so the Relay function and its
+    // intermediate forms are released before the next function is converted.
+    std::vector<GlobalVar> gvars;
     for (const auto& it : updated_mod->functions) {
-      if (auto* n = it.second.as<FunctionNode>()) {
-        Function func = GetRef<Function>(n);
-
+      if (it.second->IsInstance<FunctionNode>()) {
+        gvars.push_back(it.first);
+      }
+    }
+    from_relay::ConstantMap constants;
+    for (const auto& gvar : gvars) {
+      Function updated_func;
+      std::string unsupported_ops_str;
+      {
         // Partition RAF-specific Relay simplify patterns
-        auto updated_func = PartitionPatterns(func);
+        auto func = PartitionPatterns(Downcast<Function>(updated_mod->Lookup(gvar)));
 
         // Transform to ANF and convert Relay ops to RAF ops
-        auto anf_expr = Downcast<Function>(tvm::relay::transform::ToANormalForm(updated_func));
-        auto mutator = from_relay::FromRelayMutator();
+        auto anf_expr = Downcast<Function>(tvm::relay::transform::ToANormalForm(func));
+        func = Function();
+        auto mutator = from_relay::FromRelayMutator(&constants);
         updated_func = Downcast<Function>(mutator.Mutate(anf_expr));
-
-        // Check unsupported ops
-        auto unsupported_ops_str = mutator.ListUnsupportedOps();
-        if (!unsupported_ops_str.empty()) {
-          LOG(FATAL) << "One or more ops cannot be converted:\n" << unsupported_ops_str;
-          throw;
-        }
-        updates.push_back({it.first, updated_func});
+        unsupported_ops_str = mutator.ListUnsupportedOps();
       }
-    }
 
-    for (const auto& pair : updates) {
-      updated_mod->Add(pair.first, pair.second, true);
+      // Check unsupported ops
+      if (!unsupported_ops_str.empty()) {
+        LOG(FATAL) << "One or more ops cannot be converted:\n" << unsupported_ops_str;
+        throw;
+      }
+      updated_mod->Add(gvar, updated_func, true);
     }
     {
       tvm::With<pass::PassContext> ctx_scope(pass_ctx);
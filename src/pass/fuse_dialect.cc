@@ -143,9 +143,18 @@ class DialectPatternRewrite {
   DialectPatternRewrite(const IRModule& mod, DevType dev_type, DialectFusePattern pattern)
       : mod_(mod), dev_type_(dev_type), pattern_(pattern) {
     call_patterns_ = CallPatternExtractor().Extract(pattern_.pattern);
+    fusion_check_ = tvm::runtime::Registry::Get("raf.op." + pattern_.dialect + "._fusion_check");
   }
 
   Expr Callback(const Expr& pre, const Expr& post, const Map<DFPattern, Array<Expr>>& node_map) {
+    // A dialect can register a check to reject the matches it cannot run, e.g. because of the
+    // shapes or dtypes that a pattern cannot express. Rejected matches are left unchanged.
+    if (fusion_check_ != nullptr) {
+      Expr typed = pre->checked_type_.defined() ? pre : InferTypeWithModule(pre, mod_);
+      if (!static_cast<bool>((*fusion_check_)(typed))) {
+        return post;
+      }
+    }
     ExprSet call_set;
     for (auto call_pat : call_patterns_) {
       auto it = node_map.find(call_pat);
@@ -176,6 +185,8 @@ class DialectPatternRewrite {
   DialectFusePattern pattern_;
   /*! \brief A list of variant call patterns extracted from the pattern. */
   std::vector<DFPattern> call_patterns_;
+  /*! \brief The optional check of the matches registered by the dialect. */
+  const PackedFunc* fusion_check_;
   /*! \brief A cache of already created fused functions. */
   std::unordered_map<std::string, Function> func_cache_;
 };
@@ -206,7 +217,7 @@ Pass FuseDialect() {
                                                                              PassContext pc) {
     return Downcast<Function>(fuse_dialect::FuseDialectPatterns(f, m));
   };
-  return CreateRAFFunctionPass(pass_func, 2, "FuseDialect", {"InferType"});
+  return CreateRAFFunctionPass(pass_func, 2, "FuseDialect", {"InferType"}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.FuseDialect").set_body_typed(FuseDialect);
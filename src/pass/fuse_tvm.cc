@@ -67,6 +67,12 @@ using namespace tvm::support;
       will still run correctly.
   - CommitFuse: mark all the nodes between source and post-dominator as the same group.
   - We use an Union-Find data structure to manage the groups.
+
+  In addition to the producers fused into a reduction, the elementwise consumers that keep the
+  reduced shape (e.g., the division of a mean followed by a sqrt) are fused into the epilogue of
+  the reduction, so the reduced values are not written to memory and read back. Since the
+  reduction schedules only handle elementwise and broadcast ops after the reduction, injective
+  ops are not fused into the epilogue.
 */
 
 constexpr uint32_t kMaxFusedOps = 256;
@@ -128,6 +134,15 @@ class GraphPartitioner {
      * \brief The number of call nodes belonging to this group.
      */
     uint32_t num_call_nodes{0};
+    /*!
+     * \brief Whether the elementwise consumers can be fused into the epilogue of the reduction
+     * in this group.
+     */
+    bool allow_epilogue{false};
+    /*!
+     * \brief Whether the group has the consumers fused into the epilogue of a reduction.
+     */
+    bool is_epilogue{false};
   };
   /*!
    * \brief Partition a graph.
@@ -242,6 +257,34 @@ class GraphPartitioner {
     CommitFuse_(src, sink, target);
   }
 
+  /*!
+   * \brief Check whether the group has injective nodes, which cannot be scheduled after a
+   * reduction.
+   * \param graph The indexed forward graph.
+   * \param root The root of the group.
+   */
+  bool HasInjectiveNode(const IndexedForwardGraph& graph, Group* root) {
+    for (size_t nid = 0; nid < groups_.size(); ++nid) {
+      if (graph.post_dfs_order[nid]->pattern == kInjective && groups_[nid]->FindRoot() == root) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Whether the reduction schedules of the op handle the elementwise ops after the reduction.
+  static bool AllowEpilogue(const tvm::Object* ref) {
+    static const std::unordered_set<Op, ObjectPtrHash, ObjectPtrEqual> reduce_ops = {
+        Op::Get("raf.op.sum"), Op::Get("raf.op.mean"), Op::Get("raf.op.max"),
+        Op::Get("raf.op.min"), Op::Get("raf.op.prod"), Op::Get("raf.op.all"),
+        Op::Get("raf.op.any")};
+    const auto* call = ref->as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>()) {
+      return false;
+    }
+    return reduce_ops.count(Downcast<Op>(call->op)) > 0;
+  }
+
   // Initialize the groups.
   void InitGroups(const IndexedForwardGraph& graph) {
     groups_.resize(graph.post_dfs_order.size());
@@ -255,6 +298,9 @@ class GraphPartitioner {
       if (group_node->pattern == kOutEWiseFusable) {
         group_node->master_ref = graph_node->ref;
       }
+      if (group_node->pattern == kCommReduce) {
+        group_node->allow_epilogue = AllowEpilogue(graph_node->ref);
+      }
       groups_[nid] = group_node;
     }
   }
@@ -324,13 +370,17 @@ class GraphPartitioner {
         // Pre-condition: can only be fused to parent which is injective or reduction.
         if (dom_node->parent != nullptr &&
             (dom_node->pattern <= kInjective || dom_node->pattern == kCommReduce)) {
+          // The ops fused into the epilogue of a reduction must not be injective.
+          Group* dom_root_group = groups_[dom_parent_gindex]->FindRoot();
+          bool to_epilogue = dom_root_group->is_epilogue;
+          if (to_epilogue && HasInjectiveNode(graph, group_node->FindRoot())) continue;
           // Check if all the intermediate ops are still broadcast.
           // The final terminal node can already be fused to a OutEWiseFusable group.
-          auto fcond = [](OpPatternKind kind, bool is_sink) {
+          auto fcond = [to_epilogue](OpPatternKind kind, bool is_sink) {
             if (!is_sink) {
               // Elemwise, broadcast, and injective ops on the parallel branches
               // are allowed be fused to the elemwise/broadcast master.
-              return kind <= kInjective;
+              return to_epilogue ? kind <= kBroadcast : kind <= kInjective;
             } else {
               return (kind <= kBroadcast || kind == kCommReduce || kind == kInjective ||
                       kind == kOutEWiseFusable || kind == kTuple);
@@ -350,8 +400,23 @@ class GraphPartitioner {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       } else {
-        // do nothing.
         CHECK(group_node->pattern == kCommReduce);
+        // Path for CommReduce: sum, mean
+        // Fuse the consumers into the epilogue if the dominator relation is elemwise.
+        if (phase != 0 || !group_node->allow_epilogue) continue;
+        Group* dom_parent_group = groups_[dom_parent_gindex];
+        if (dom_node->pattern == kElemWise && dom_parent_group->parent == nullptr &&
+            !HasInjectiveNode(graph, dom_parent_group)) {
+          // The intermediate ops and the terminal node must be elemwise or broadcast.
+          auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kBroadcast; };
+          if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+            CommitFuse(graph_node, dom_node->parent->gnode);
+            // The consumers become the epilogue of the reduction.
+            dom_parent_group->pattern = kCommReduce;
+            dom_parent_group->allow_epilogue = true;
+            dom_parent_group->is_epilogue = true;
+          }
+        }
       }
     }
   }
@@ -404,6 +469,29 @@ struct DispatchToTVMOps : ExprMutator {
   }
 };
 
+/*! \brief Temporary information from each group. */
+struct GroupInfo {
+ public:
+  // The parameters of the function.
+  Array<Var> params;
+  // The arguments to call the functions.
+  Array<Expr> arguments;
+  // Get a new parameter or allocate an old one
+  Var GetOrAllocParam(const Expr& expr, const Type& type) {
+    // run linear scan as most fused groups contain only a few inputs.
+    for (size_t i = 0; i < arguments.size(); ++i) {
+      if (expr.same_as(arguments[i])) return params[i];
+    }
+    // create a new parameter.
+    std::ostringstream os;
+    os << "p" << params.size();
+    auto var = MakeVar(os.str(), type);
+    params.push_back(var);
+    arguments.push_back(expr);
+    return var;
+  }
+};
+
 class FuseMutator : private ExprMutator {
  public:
   // Run the transform
@@ -421,28 +509,6 @@ class FuseMutator : private ExprMutator {
   }
 
  private:
-  /*! \brief Temporary information from each group. */
-  struct GroupInfo {
-   public:
-    // The parameters of the function.
-    Array<Var> params;
-    // The arguments to call the functions.
-    Array<Expr> arguments;
-    // Get a new parameter or allocate an old one
-    Var GetOrAllocParam(const Expr& expr, const Type& type) {
-      // run linear scan as most fused groups contain only a few inputs.
-      for (size_t i = 0; i < arguments.size(); ++i) {
-        if (expr.same_as(arguments[i])) return params[i];
-      }
-      // create a new parameter.
-      std::ostringstream os;
-      os << "p" << params.size();
-      auto var = MakeVar(os.str(), type);
-      params.push_back(var);
-      arguments.push_back(expr);
-      return var;
-    }
-  };
   /*! \brief Internal arena. */
   Arena arena_;
   /*! \brief The group assignment map. */
@@ -656,8 +722,279 @@ class FuseMutator : private ExprMutator {
   }
 };
 
+/*!
+ * \brief Check whether a call can be fused horizontally with other calls, i.e., it is a single op
+ * or a fused function of elementwise, broadcast and injective ops that returns a tensor and does
+ * not update its inputs in place.
+ * \param call The call to be checked.
+ * \param num_call_nodes The number of ops in the call.
+ * \return Whether the call can be fused horizontally.
+ */
+bool IsHorizontalFusable(const CallNode* call, uint32_t* num_call_nodes) {
+  static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+  static auto finplace = Op::GetAttrMap<TRAFInplaceUpdate>("TRAFInplaceUpdate");
+  static auto add_op = Op::Get("raf.op.add");
+  static auto subtract_op = Op::Get("raf.op.subtract");
+  if (!call->checked_type_.defined() || !call->checked_type_.as<TensorTypeNode>()) {
+    return false;
+  }
+  auto is_fusable_op = [&](const Op& op, const Expr& out) {
+    auto base_op = IsDialectOp(op) ? GetBaseOp(op) : op;
+    auto tvm_op = IsDialectOp(op) ? op : OpDialect::Lower(op, "tvm");
+    if (!tvm_op.defined() || fpattern.get(tvm_op, kOpaque) > kInjective) {
+      return false;
+    }
+    if (finplace.count(base_op)) {
+      return false;
+    }
+    if ((base_op == add_op || base_op == subtract_op) && out.defined()) {
+      auto konst = out.as<ConstantNode>();
+      return konst != nullptr && !konst->value.defined();
+    }
+    return true;
+  };
+
+  if (const auto* op_node = call->op.as<OpNode>()) {
+    auto op = GetRef<Op>(op_node);
+    if (IsDialectOp(op)) {
+      // The op has been dispatched to another dialect by FuseDialect
+      return false;
+    }
+    *num_call_nodes = 1;
+    return is_fusable_op(op, call->args.size() > 2 ? call->args[2] : Expr());
+  }
+
+  const auto* func = call->op.as<FunctionNode>();
+  if (func == nullptr || !func->HasNonzeroAttr(attr::kPrimitive)) {
+    return false;
+  }
+  auto dialect = func->GetAttr<String>(attr::kDialect);
+  if (!dialect.defined() || dialect.value() != "tvm") {
+    return false;
+  }
+  std::unordered_map<const Object*, Expr> arg_map;
+  for (size_t i = 0; i < func->params.size(); ++i) {
+    arg_map[func->params[i].get()] = call->args[i];
+  }
+  bool fusable = true;
+  *num_call_nodes = 0;
+  tvm::relay::PostOrderVisit(func->body, [&](const Expr& expr) {
+    const auto* inner = expr.as<CallNode>();
+    if (inner == nullptr) return;
+    ++(*num_call_nodes);
+    const auto* op_node = inner->op.as<OpNode>();
+    Expr out;
+    if (inner->args.size() > 2) {
+      // Check the argument of the fused function that is bound to the out parameter
+      auto it = arg_map.find(inner->args[2].get());
+      out = (it != arg_map.end()) ? it->second : inner->args[2];
+    }
+    if (op_node == nullptr || !is_fusable_op(GetRef<Op>(op_node), out)) {
+      fusable = false;
+    }
+  });
+  return fusable;
+}
+
+/*!
+ * \brief Collect the horizontally fusable calls by their levels. The level of a call is the
+ * maximal number of fusable calls on a path from the inputs to it, so a call never depends on
+ * another call of the same level.
+ */
+class HorizontalCandidateCollector : public ExprVisitor {
+ public:
+  void VisitExpr_(const FunctionNode* node) final {
+    // Fused functions are collected as a whole, and closures are not supported.
+    if (!node->HasNonzeroAttr(attr::kPrimitive)) {
+      has_control_flow = true;
+    }
+  }
+
+  void VisitExpr_(const CallNode* node) final {
+    ExprVisitor::VisitExpr_(node);
+    uint32_t level = LevelOf(node->op);
+    for (const auto& arg : node->args) {
+      level = std::max(level, LevelOf(arg));
+    }
+    uint32_t num_call_nodes = 0;
+    if (IsHorizontalFusable(node, &num_call_nodes)) {
+      if (levels.size() <= level) {
+        levels.resize(level + 1);
+      }
+      levels[level].emplace_back(GetRef<Call>(node), num_call_nodes);
+      ++level;
+    }
+    level_[node] = level;
+  }
+
+  void VisitExpr_(const TupleNode* node) final {
+    ExprVisitor::VisitExpr_(node);
+    uint32_t level = 0;
+    for (const auto& field : node->fields) {
+      level = std::max(level, LevelOf(field));
+    }
+    level_[node] = level;
+  }
+
+  void VisitExpr_(const TupleGetItemNode* node) final {
+    ExprVisitor::VisitExpr_(node);
+    level_[node] = LevelOf(node->tuple);
+  }
+
+  // Only the dataflow graph is supported, where the dependencies are not hidden by the scopes.
+  void VisitExpr_(const LetNode* node) final {
+    has_control_flow = true;
+  }
+
+  void VisitExpr_(const IfNode* node) final {
+    has_control_flow = true;
+  }
+
+  void VisitExpr_(const RefCreateNode* node) final {
+    has_control_flow = true;
+  }
+
+  void VisitExpr_(const RefReadNode* node) final {
+    has_control_flow = true;
+  }
+
+  void VisitExpr_(const RefWriteNode* node) final {
+    has_control_flow = true;
+  }
+
+  void VisitExpr_(const tvm::relay::MatchNode* node) final {
+    has_control_flow = true;
+  }
+
+  /*! \brief The fusable calls and their numbers of ops at each level. */
+  std::vector<std::vector<std::pair<Call, uint32_t>>> levels;
+  /*! \brief Whether the expression is not a plain dataflow graph. */
+  bool has_control_flow = false;
+
+ private:
+  uint32_t LevelOf(const Expr& expr) {
+    auto it = level_.find(expr.get());
+    return it == level_.end() ? 0 : it->second;
+  }
+
+  /*! \brief The level of each visited expression. */
+  std::unordered_map<const Object*, uint32_t> level_;
+};
+
+/*!
+ * \brief Fuse the independent calls of the same level into one fused function that returns a
+ * tuple of their outputs, so that small kernels in parallel branches (e.g., the per-parameter
+ * updates of optimizers) are built and launched by one packed function call. Since a group of
+ * calls only depends on the groups of lower levels, the fusion never introduces a cycle.
+ */
+class HorizontalFuser : private ExprMutator {
+ public:
+  Expr Transform(const Expr& body) {
+    HorizontalCandidateCollector collector;
+    collector(body);
+    if (collector.has_control_flow) {
+      return body;
+    }
+    for (const auto& level : collector.levels) {
+      std::vector<Call> group;
+      uint32_t num_call_nodes = 0;
+      auto commit = [&]() {
+        if (group.size() > 1) {
+          for (size_t i = 0; i < group.size(); ++i) {
+            members_[group[i].get()] = std::make_pair(groups_.size(), i);
+          }
+          groups_.push_back(group);
+        }
+        group.clear();
+        num_call_nodes = 0;
+      };
+      for (const auto& it : level) {
+        if (group.size() == kMaxHorizontalFusedCalls ||
+            num_call_nodes + it.second > kMaxFusedOps) {
+          commit();
+        }
+        group.push_back(it.first);
+        num_call_nodes += it.second;
+      }
+      commit();
+    }
+    if (groups_.empty()) {
+      return body;
+    }
+    return this->Mutate(body);
+  }
+
+ private:
+  /*! \brief The maximal number of calls fused into one function. */
+  static constexpr size_t kMaxHorizontalFusedCalls = 32;
+  /*! \brief The groups of calls to be fused. */
+  std::vector<std::vector<Call>> groups_;
+  /*! \brief The group index and the output index of each call to be fused. */
+  std::unordered_map<const Object*, std::pair<size_t, size_t>> members_;
+  /*! \brief The new call of each group. */
+  std::unordered_map<size_t, Call> new_calls_;
+  /*! \brief A cache of already created fused functions. */
+  std::unordered_map<std::string, Function> func_cache_;
+
+  // Skip primitive function.
+  Expr VisitExpr_(const FunctionNode* fn_node) final {
+    return GetRef<Expr>(fn_node);
+  }
+
+  Expr VisitExpr_(const CallNode* call) final {
+    auto it = members_.find(call);
+    if (it == members_.end()) {
+      return ExprMutator::VisitExpr_(call);
+    }
+    size_t group_idx = it->second.first;
+    if (!new_calls_.count(group_idx)) {
+      new_calls_[group_idx] = MakeNewFunction(groups_[group_idx]);
+    }
+    return TupleGetItem(new_calls_.at(group_idx), it->second.second);
+  }
+
+  Call MakeNewFunction(const std::vector<Call>& group) {
+    GroupInfo ginfo;
+    Array<Expr> fields;
+    Array<Type> field_types;
+    for (const auto& call : group) {
+      if (const auto* func = call->op.as<FunctionNode>()) {
+        // Inline the fused function
+        tvm::Map<Var, Expr> args_map;
+        for (size_t i = 0; i < func->params.size(); ++i) {
+          const auto& arg = call->args[i];
+          args_map.Set(func->params[i], ginfo.GetOrAllocParam(Mutate(arg), arg->checked_type()));
+        }
+        fields.push_back(Substitute(func->body, args_map));
+      } else {
+        Array<Expr> new_args;
+        for (const auto& arg : call->args) {
+          new_args.push_back(ginfo.GetOrAllocParam(Mutate(arg), arg->checked_type()));
+        }
+        auto new_call = Call(call->op, new_args, call->attrs, call->type_args);
+        fields.push_back(DispatchToTVMOps().Mutate(new_call));
+      }
+      field_types.push_back(call->checked_type());
+    }
+    auto func = Function(ginfo.params, Tuple(fields), TupleType(field_types), {});
+    func = WithAttr(std::move(func), attr::kPrimitive, Integer(1));
+    func = WithAttr(std::move(func), attr::kDialect, String("tvm"));
+
+    // If the identical function has been created before, reuse it.
+    std::string func_cache_key = raf::ir::AsText(func);
+    if (func_cache_.count(func_cache_key)) {
+      func = func_cache_.at(func_cache_key);
+    } else {
+      func_cache_[func_cache_key] = func;
+    }
+    return Call(func, ginfo.arguments, Attrs());
+  }
+};
+
 }  // namespace fuse_tvm
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.fuse_tvm.horizontal", Bool);
+
 Pass FuseTVM() {
   PassContext pass_ctx = PassContext::Current();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
@@ -665,9 +1002,25 @@ Pass FuseTVM() {
     return Downcast<Function>(fuse_tvm::FuseMutator().Transform(f));
   };
 
-  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "FuseTVM", {});
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "FuseTVM", {}, true);
   PassInfo pass_info(2, "FuseTVM", {});
-  return RAFSequential({InferType(), func_pass}, pass_info);
+  if (!pass_ctx->GetConfig("raf.fuse_tvm.horizontal", Bool(false)).value()) {
+    return CachedPass(RAFSequential({InferType(), func_pass}, pass_info));
+  }
+  // The horizontal fusion checks the types of the fused functions.
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> horizontal_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        auto body = fuse_tvm::HorizontalFuser().Transform(f->body);
+        if (body.same_as(f->body)) {
+          return f;
+        }
+        return Function(f->params, body, f->ret_type, f->type_params, f->attrs);
+      };
+  Pass horizontal_pass =
+      CreateRAFFunctionPass(horizontal_func, 2, "FuseTVMHorizontal", {}, true);
+  return CachedPass(
+      RAFSequential({InferType(), func_pass, InferType(), horizontal_pass}, pass_info),
+      "horizontal");
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.FuseTVM").set_body_typed(FuseTVM);
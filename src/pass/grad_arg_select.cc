@@ -28,6 +28,7 @@ RAF_OP_GRAD_SKIP_INPUTS("raf.op.sqrt_dx", "x");
 RAF_OP_GRAD_SKIP_INPUTS("raf.op.tanh_dx", "x");
 RAF_OP_GRAD_SKIP_INPUTS("raf.op.conv2d_dx", "y");
 RAF_OP_GRAD_SKIP_INPUTS("raf.op.conv2d_dw", "y");
+RAF_OP_GRAD_SKIP_INPUTS("raf.op.erf_dx", "y");
 
 class GradientOp : public ExprMutator {
  public:
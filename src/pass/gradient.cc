@@ -94,8 +94,9 @@ struct ReverseAD : public ExprVisitor {
   RAF_NODE_NOT_IMPL(OpNode);  // replace OpNode with its corresponding GlobalVar's adjoint
 
  public:
-  explicit ReverseAD(std::unordered_map<const VarNode*, bool>& requires_grads_main_map)
-      : requires_grads_main_map_(requires_grads_main_map) {
+  explicit ReverseAD(std::unordered_map<const VarNode*, bool>& requires_grads_main_map,
+                     bool compact = false)
+      : requires_grads_main_map_(requires_grads_main_map), compact_(compact) {
   }
 
  public:  // visitor functions
@@ -307,7 +308,21 @@ struct ReverseAD : public ExprVisitor {
    */
   Array<Expr> GetOutputGrads() {
     const VarNode* var = let_var_.operator->();
-    return InitUndefinedGrads(tuple_grads[var]);
+    Array<Expr> ograds;
+    for (const auto& ograd : tuple_grads[var]) {
+      ograds.push_back(MaterializeGrad(ograd));
+    }
+    return InitUndefinedGrads(ograds);
+  }
+
+  /*! \brief Whether any output of the var has a gradient, i.e., is used by the backward. */
+  bool HasOutputGrad(const VarNode* var) {
+    for (const auto& ograd : tuple_grads[var]) {
+      if (ograd.defined()) {
+        return true;
+      }
+    }
+    return false;
   }
 
   /*!
@@ -553,23 +568,69 @@ struct ReverseAD : public ExprVisitor {
 
   Expr AddTensor(const Expr& x1, const Expr& x2) {
     static Op op = Op::Get("raf.op.add");
+    static Op add_n_op = Op::Get("raf.op.add_n");
     if (!x1.defined() && !x2.defined()) {
       return NullValue<Var>();
     }
     if (!x1.defined()) {
-      return x2->IsInstance<VarNode>() ? x2 : adjoint_ll_->Push(x2);
+      return x2->IsInstance<VarNode>() || IsPendingSum(x2) ? x2 : adjoint_ll_->Push(x2);
     }
     if (!x2.defined()) {
-      return x1->IsInstance<VarNode>() ? x1 : adjoint_ll_->Push(x1);
+      return x1->IsInstance<VarNode>() || IsPendingSum(x1) ? x1 : adjoint_ll_->Push(x1);
     }
     const auto* t1 = x1.as<TupleNode>();
     const auto* t2 = x2.as<TupleNode>();
     if (t1 && t2) {
       return Tuple(AddTensors(t1->fields, t2->fields));
     }
+    if (compact_) {
+      // Defer the accumulation until the gradient is used, so all the contributions to it are
+      // summed by a single add_n instead of a chain of adds.
+      Array<Expr> parts;
+      for (const Expr& x : {x1, x2}) {
+        if (IsPendingSum(x)) {
+          for (const auto& part : Downcast<Tuple>(x.as<CallNode>()->args[0])->fields) {
+            parts.push_back(part);
+          }
+        } else {
+          parts.push_back(x);
+        }
+      }
+      return Call(add_n_op, {Tuple(parts)});
+    }
     return adjoint_ll_->Push(Call(op, {x1, x2, MakeNull(), MakeNull()}));
   }
 
+  /*! \brief Whether the gradient is an accumulation deferred by AddTensor, which is not bound. */
+  bool IsPendingSum(const Expr& grad) {
+    static Op add_n_op = Op::Get("raf.op.add_n");
+    const auto* call = grad.as<CallNode>();
+    return compact_ && call != nullptr && call->op.same_as(add_n_op);
+  }
+
+  /*! \brief Bind the deferred accumulation of the gradient, where two parts are a plain add. */
+  Expr MaterializeGrad(const Expr& grad) {
+    static Op op = Op::Get("raf.op.add");
+    if (!grad.defined()) {
+      return grad;
+    }
+    if (const auto* tuple = grad.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const auto& field : tuple->fields) {
+        fields.push_back(MaterializeGrad(field));
+      }
+      return Tuple(fields);
+    }
+    if (!IsPendingSum(grad)) {
+      return grad;
+    }
+    const auto& parts = Downcast<Tuple>(grad.as<CallNode>()->args[0])->fields;
+    if (parts.size() == 2) {
+      return adjoint_ll_->Push(Call(op, {parts[0], parts[1], MakeNull(), MakeNull()}));
+    }
+    return adjoint_ll_->Push(grad);
+  }
+
  private:
   // Helper functions to assist in the creation of input and ret of the backward closure.
   /*!
@@ -634,7 +695,10 @@ struct ReverseAD : public ExprVisitor {
     Array<Expr> grads;
     for (const Var& var : targets) {
       const VarNode* var_node = var.operator->();
-      std::vector<Expr> var_grads(tuple_grads[var_node].begin(), tuple_grads[var_node].end());
+      std::vector<Expr> var_grads;
+      for (const auto& grad : tuple_grads[var_node]) {
+        var_grads.push_back(MaterializeGrad(grad));
+      }
       if (tuple_length.count(var_node)) {
         for (Expr& expr : var_grads) {
           if (!expr.defined()) {
@@ -708,6 +772,11 @@ struct ReverseAD : public ExprVisitor {
       // Walk through each expresion and set the tuple_grads accordingly.
       for (int i = n - 1; i >= 0; --i) {
         let_var_ = vars[i];
+        if (compact_ && !HasOutputGrad(vars[i].get()) && IsSkippable(exprs[i])) {
+          // Nothing downstream needs the gradient of this binding, so its backward only
+          // propagates zeros and is skipped instead of materializing zero placeholders.
+          continue;
+        }
         ExprVisitor::VisitExpr(exprs[i]);
       }
       return MakeClosureRet();
@@ -715,6 +784,19 @@ struct ReverseAD : public ExprVisitor {
     return adjoint_body;
   }
 
+  /*!
+   * \brief Whether the backward of the expression can be skipped when its outputs have no
+   * gradients. The calls to global functions and the if nodes are always visited, as their
+   * primal expressions are rewritten to the primal outputs of the differentiated functions.
+   */
+  bool IsSkippable(const Expr& expr) {
+    if (const auto* call = expr.as<CallNode>()) {
+      return call->op->IsInstance<OpNode>();
+    }
+    return expr->IsInstance<TupleNode>() || expr->IsInstance<TupleGetItemNode>() ||
+           expr->IsInstance<RelayConstantNode>();
+  }
+
   /*!
    * \brief This method bundles up the primal and adjoint computation together.
    */
@@ -896,6 +978,11 @@ struct ReverseAD : public ExprVisitor {
   std::unordered_map<const VarNode*, int> tuple_length;
   /*! \brief A map that tracks the computed grads in reverse AD. */
   std::unordered_map<const VarNode*, Array<Expr>> tuple_grads;
+  /*!
+   * \brief Whether to emit the compact backward, which sums the contributions to a gradient by a
+   * single add_n and skips the bindings whose gradients are not used.
+   */
+  bool compact_;
 };
 
 /*! \brief A helper to canonicalize the IR with AutoDiff if its backward is going to be inlined.
@@ -1018,7 +1105,8 @@ Pass AutoDiff(ir::Array<tvm::Bool> requires_grads) {
     // Parse the requires_grad array to a map for the main function.
     auto requires_grads_main_map = ParseRequireGradsMain(mod, requires_grads);
 
-    auto grad_computer = gradient::ReverseAD(requires_grads_main_map);
+    bool compact = pc->GetConfig<tvm::Bool>("raf.autodiff.compact", tvm::Bool(false)).value();
+    auto grad_computer = gradient::ReverseAD(requires_grads_main_map, compact);
 
     // Traverse through the functions and call Gradient on everyone
     for (auto gvar_func_pair : mod->functions) {
@@ -1039,6 +1127,10 @@ Pass AutoDiff(ir::Array<tvm::Bool> requires_grads) {
       auto func = it.second;
       mod->Add(gv, func, true);
     }
+    if (compact) {
+      // Drop the inputs that the gradient ops do not read, so the backward does not keep them.
+      mod = GradInputSelect()(mod);
+    }
 
     // Run InferType to get the collapse_ais and canonicalize the IR.
     // TODO: Infer type may fail if the module parameters do not have type information.
@@ -1055,9 +1147,16 @@ Pass AutoDiff(ir::Array<tvm::Bool> requires_grads) {
     }
     return mod;
   };
-  return CreateModulePass(pass_func, 1, "AutoDiff", {});
+  std::ostringstream key;
+  for (const auto& requires_grad : requires_grads) {
+    key << requires_grad->value;
+  }
+  return CachedPass(CreateModulePass(pass_func, 1, "AutoDiff", {}), key.str(),
+                    {"raf.autodiff.compact"});
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.autodiff.compact", tvm::Bool);
+
 RAF_REGISTER_GLOBAL("raf.pass_.AutoDiff").set_body_typed(AutoDiff);
 
 }  // namespace pass
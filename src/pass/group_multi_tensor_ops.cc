@@ -0,0 +1,211 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file group_multi_tensor_ops.cc
+ * \brief Group the independent per-tensor elementwise ops of the same kind, e.g., the scaling,
+ * zeroing and casting of each parameter or gradient, into a multi-tensor op. The multi-tensor
+ * op covers all the tensors in a few kernel launches instead of a launch per tensor.
+ */
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace group_multi_tensor_ops {
+
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief A group of per-tensor ops that become a multi-tensor op. */
+struct MultiTensorGroup {
+  /*! \brief The index of the first op in the let list, where the multi-tensor op is placed. */
+  size_t start;
+  /*! \brief The multi-tensor op and its arguments after the tensor list. */
+  Op op;
+  Array<Expr> attrs;
+  /*! \brief The input tensors and the variables bound to the per-tensor ops. */
+  Array<Expr> inputs;
+  std::vector<Var> vars;
+};
+
+class MultiTensorGrouper {
+ public:
+  explicit MultiTensorGrouper(const Function& func) : func_(func) {
+  }
+
+  Function Run() {
+    auto ell = ExplicitLetList::make(func_->body);
+    if (!ell->ret.defined()) {
+      return func_;
+    }
+    const auto& vars = ell->vars;
+    const auto& exprs = ell->exprs;
+    std::unordered_map<const VarNode*, size_t> def_index;
+    // The open group of each key, which can only take the inputs defined before its start.
+    std::unordered_map<std::string, size_t> open;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      def_index[vars[i].get()] = i;
+      Op op;
+      Array<Expr> attrs;
+      std::string key = GetKey(exprs[i], &op, &attrs);
+      if (key.empty()) {
+        continue;
+      }
+      Expr input = Downcast<Call>(exprs[i])->args[0];
+      auto it = open.find(key);
+      auto def = def_index.find(input.as<VarNode>());
+      bool early = def == def_index.end() ||
+                   (it != open.end() && def->second < groups_[it->second].start);
+      if (it == open.end() || !early) {
+        open[key] = groups_.size();
+        groups_.push_back(MultiTensorGroup{i, op, attrs, {}, {}});
+      }
+      auto& group = groups_[open[key]];
+      group.inputs.push_back(input);
+      group.vars.push_back(vars[i]);
+    }
+
+    std::unordered_map<size_t, const MultiTensorGroup*> starts;
+    std::unordered_set<const VarNode*> grouped;
+    for (const auto& group : groups_) {
+      if (group.vars.size() > 1) {
+        starts[group.start] = &group;
+        for (const auto& var : group.vars) {
+          grouped.insert(var.get());
+        }
+      }
+    }
+    if (starts.empty()) {
+      return func_;
+    }
+    ExplicitLetList ell_out;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      auto it = starts.find(i);
+      if (it != starts.end()) {
+        const auto* group = it->second;
+        Var tuple = MakeVar("multi_tensor_in", {});
+        Var out = MakeVar("multi_tensor_out", {});
+        Array<Expr> args = {tuple};
+        args.insert(args.end(), group->attrs.begin(), group->attrs.end());
+        ell_out.Push(tuple, Tuple(group->inputs));
+        ell_out.Push(out, Call(group->op, args));
+        for (size_t j = 0; j < group->vars.size(); ++j) {
+          ell_out.Push(group->vars[j], TupleGetItem(out, j));
+        }
+        DLOG(INFO) << "Grouped " << group->vars.size() << " ops into " << group->op->name;
+      } else if (grouped.count(vars[i].get())) {
+        continue;
+      } else {
+        ell_out.Push(vars[i], exprs[i]);
+      }
+    }
+    ell_out.ret = ell->ret;
+    return Function(func_->params, ell_out.AsExpr(), {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*! \brief Whether the type is a float tensor type of the static shape. */
+  static bool IsFloatTensor(const Type& type) {
+    auto ttype = type.as<TensorTypeNode>();
+    if (ttype == nullptr || (!ttype->dtype.is_float() && !ttype->dtype.is_bfloat16())) {
+      return false;
+    }
+    for (const auto& dim : ttype->shape) {
+      if (!dim->IsInstance<IntImmNode>()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Get the scale of a scalar constant, or return false if it is not. */
+  static bool GetScale(const Expr& expr, double* scale) {
+    auto konst = expr.as<ConstantNode>();
+    if (konst == nullptr || !konst->value.defined()) {
+      return false;
+    }
+    if (konst->value->IsInstance<FloatValueObj>() || konst->value->IsInstance<IntValueObj>()) {
+      *scale = GetScalarValueData<double>(Downcast<Value>(konst->value));
+      return true;
+    }
+    auto tv = konst->value.as<TensorValueObj>();
+    if (tv == nullptr || tv->tensor->ndim != 0 ||
+        DataType(tv->tensor->dtype) != DataType::Float(32)) {
+      return false;
+    }
+    *scale = GetScalarValueData<float>(Downcast<Value>(konst->value));
+    return true;
+  }
+
+  /*!
+   * \brief Get the key of a per-tensor op that can be grouped, or an empty string otherwise. The
+   * multi-tensor op and its arguments after the tensor list are returned in op and attrs.
+   */
+  static std::string GetKey(const Expr& expr, Op* op, Array<Expr>* attrs) {
+    static const Op& multiply_op = Op::Get("raf.op.multiply");
+    static const Op& zeros_like_op = Op::Get("raf.op.zeros_like");
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    static const Op& scale_op = Op::Get("raf.op.multi_tensor_scale");
+    static const Op& group_cast_op = Op::Get("raf.op.group_cast");
+    auto call = expr.as<CallNode>();
+    if (call == nullptr || call->args.empty() || !call->args[0]->IsInstance<VarNode>() ||
+        !IsFloatTensor(call->args[0]->checked_type()) || !IsFloatTensor(call->checked_type())) {
+      return "";
+    }
+    auto in_dtype = call->args[0]->checked_type().as<TensorTypeNode>()->dtype;
+    auto out_dtype = call->checked_type().as<TensorTypeNode>()->dtype;
+    std::ostringstream os;
+    // Tell the scales apart to the last bit.
+    os.precision(17);
+    double scale;
+    if (call->op == multiply_op && GetScale(call->args[1], &scale) && in_dtype == out_dtype) {
+      os << "scale " << scale << " " << in_dtype;
+      *op = scale_op;
+      *attrs = {MakeConstant(ScalarValue::make(scale)), MakeConstant(StringValue::make(""))};
+    } else if (call->op == zeros_like_op) {
+      os << "scale 0 " << in_dtype;
+      *op = scale_op;
+      *attrs = {MakeConstant(ScalarValue::make(0.0)), MakeConstant(StringValue::make(""))};
+    } else if (call->op == cast_op && call->args[1]->IsInstance<ConstantNode>()) {
+      os << "cast " << in_dtype << " " << out_dtype;
+      *op = group_cast_op;
+      *attrs = {call->args[1]};
+    } else {
+      return "";
+    }
+    return os.str();
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The groups in the order of their starts. */
+  std::vector<MultiTensorGroup> groups_;
+};
+
+}  // namespace group_multi_tensor_ops
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.group_multi_tensor_ops", Bool);
+
+Pass GroupMultiTensorOps() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return group_multi_tensor_ops::MultiTensorGrouper(f).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "GroupMultiTensorOpsHelper", {});
+  PassInfo pass_info(1, "GroupMultiTensorOps", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.GroupMultiTensorOps").set_body_typed(GroupMultiTensorOps);
+
+}  // namespace pass
+}  // namespace raf
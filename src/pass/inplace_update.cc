@@ -9,6 +9,7 @@
  * outputs and check the validity of memory sharing.
  */
 #include "raf/op.h"
+#include "raf/dialect.h"
 #include "raf/ir_ext.h"
 #include "raf/pass.h"
 #include "tvm/ir/type_functor.h"
@@ -503,6 +504,186 @@ class InplaceSimplifer : public ExprMutator {
   Map<Var, Var> mutated_vars_;
 };
 
+/*!
+ * \brief ElementwiseInplaceMutator marks may_share in the variables for elementwise ops, whose
+ * input dies at the op and has the same shape and dtype as the output, so the output overwrites
+ * the input. For example:
+ *   let %a1 = raf.op.relu(%x);
+ *   let %a2 = raf.op.tanh(%a1);
+ *   let %a3 = raf.op.add(%a2, %x, nullptr, nullptr);
+ *   %a3
+ *
+ * The transformed IR will become:
+ *   let %a1 = raf.op.relu(%x);
+ *   let %a2(share: %a1) = raf.op.tanh(%a1);
+ *   let %a3(share: %a2) = raf.op.add(%a2, %x, nullptr, nullptr);
+ *   %a3
+ *
+ * The tensors of the function parameters and the tensors that already share memory with others
+ * are never overwritten, because they are owned by the caller.
+ */
+class ElementwiseInplaceMutator {
+ public:
+  ElementwiseInplaceMutator(const Function& func, liveness_analysis::LivenessAnalyzer* analyzer)
+      : func_(func), analyzer_(analyzer) {
+  }
+
+  Function Run() {
+    if (!analyzer_->IsSuccess()) {
+      return func_;
+    }
+    auto ell = ExplicitLetList::make(func_->body);
+    auto& vars = ell->vars;
+    auto& exprs = ell->exprs;
+    int n = exprs.size();
+    for (const auto& expr : exprs) {
+      // The branches and closures are not handled, because they have their own let lists.
+      if (expr->IsInstance<IfNode>() ||
+          (expr->IsInstance<FunctionNode>() &&
+           !Downcast<Function>(expr)->HasNonzeroAttr(attr::kPrimitive))) {
+        return func_;
+      }
+    }
+
+    for (const auto& param : func_->params) {
+      for (const auto& tensor : analyzer_->GetTensorVars(param)) {
+        owned_tensors_.insert(tensor);
+      }
+    }
+    for (const auto& var : vars) {
+      auto ext_var = var.as<ExtendedVarNode>();
+      if (ext_var && ext_var->may_share.defined()) {
+        for (const auto& tensor : analyzer_->GetTensorVars(var)) {
+          owned_tensors_.insert(tensor);
+        }
+      }
+    }
+
+    int num_inplace = 0;
+    for (int i = 0; i < n; ++i) {
+      exprs[i] = Substitute(exprs[i]);
+      auto call = exprs[i].as<CallNode>();
+      if (!call || !IsElementwise(call->op)) {
+        continue;
+      }
+      const VSet& live_out = i + 1 < n ? analyzer_->GetLiveVars(vars[i + 1])
+                                       : analyzer_->GetOutputTensorVars();
+      for (const auto& arg : call->args) {
+        if (CanOverwrite(arg, vars[i], live_out)) {
+          Var new_var = MakeVar(vars[i]->name_hint(), vars[i]->type_annotation, Downcast<Var>(arg));
+          new_var->checked_type_ = vars[i]->checked_type();
+          var_update_map_.emplace(vars[i], new_var);
+          vars[i] = new_var;
+          num_inplace++;
+          break;
+        }
+      }
+    }
+    ell->ret = Downcast<Var>(Substitute(ell->ret));
+    DLOG(INFO) << num_inplace << " elementwise ops are updated in place";
+    return Function(func_->params, ell->AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  using VSet = liveness_analysis::VSet;
+
+  /*! \brief Whether the op is an elementwise or broadcast op without inplace semantics. */
+  bool IsElementwise(const Expr& expr) {
+    static auto finplace = Op::GetAttrMap<op::TRAFInplaceUpdate>("TRAFInplaceUpdate");
+    if (!expr->IsInstance<OpNode>()) {
+      return false;
+    }
+    auto op = Downcast<Op>(expr);
+    if (IsDialectOp(op)) {
+      op = GetBaseOp(op);
+    }
+    if (finplace.count(op)) {
+      return false;
+    }
+    auto tvm_op = OpDialect::Lower(op, "tvm");
+    if (!tvm_op.defined()) {
+      return false;
+    }
+    return GetOpAttrOrDefault<TOpPattern>(tvm_op, "TOpPattern", kOpaque) <= kBroadcast;
+  }
+
+  /*!
+   * \brief Whether the output var can overwrite the tensor of arg, which requires the arg to be a
+   * tensor of the same static shape and dtype as the output, and not to be live after this line.
+   */
+  bool CanOverwrite(const Expr& arg, const Var& out, const VSet& live_out) {
+    if (!arg->IsInstance<VarNode>()) {
+      return false;
+    }
+    auto arg_type = arg->checked_type().as<TensorTypeNode>();
+    auto out_type = out->checked_type().as<TensorTypeNode>();
+    if (!arg_type || !out_type || arg_type->dtype != out_type->dtype ||
+        arg_type->shape.size() != out_type->shape.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < arg_type->shape.size(); ++i) {
+      auto arg_dim = arg_type->shape[i].as<IntImmNode>();
+      auto out_dim = out_type->shape[i].as<IntImmNode>();
+      if (!arg_dim || !out_dim || arg_dim->value != out_dim->value) {
+        return false;
+      }
+    }
+    auto var = Downcast<Var>(arg);
+    auto tensors = analyzer_->GetTensorVars(var);
+    if (tensors.size() != 1 || owned_tensors_.count(tensors[0])) {
+      return false;
+    }
+    return !analyzer_->IsAlive(var, live_out);
+  }
+
+  /*! \brief Replace the vars in an ANF expression with their may_share annotated ones. */
+  Expr Substitute(const Expr& expr) {
+    auto update = [this](const Expr& e) -> Expr {
+      if (auto var = e.as<VarNode>()) {
+        auto it = var_update_map_.find(GetRef<Var>(var));
+        if (it != var_update_map_.end()) {
+          return it->second;
+        }
+      }
+      return e;
+    };
+    if (expr->IsInstance<VarNode>()) {
+      return update(expr);
+    } else if (auto call = expr.as<CallNode>()) {
+      Array<Expr> args;
+      for (const auto& arg : call->args) {
+        args.push_back(update(arg));
+      }
+      auto new_call = Call(call->op, args, call->attrs, call->type_args, call->span);
+      new_call->checked_type_ = call->checked_type_;
+      return new_call;
+    } else if (auto tuple = expr.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const auto& field : tuple->fields) {
+        fields.push_back(update(field));
+      }
+      auto new_tuple = Tuple(fields, tuple->span);
+      new_tuple->checked_type_ = tuple->checked_type_;
+      return new_tuple;
+    } else if (auto tuple_get = expr.as<TupleGetItemNode>()) {
+      auto new_tuple_get = TupleGetItem(update(tuple_get->tuple), tuple_get->index, tuple_get->span);
+      new_tuple_get->checked_type_ = tuple_get->checked_type_;
+      return new_tuple_get;
+    }
+    return expr;
+  }
+
+  /*! \brief The function to be transformed. */
+  Function func_;
+  /*! \brief The liveness analyzer of the function. */
+  liveness_analysis::LivenessAnalyzer* analyzer_;
+  /*! \brief The tensors that cannot be overwritten. */
+  VSet owned_tensors_;
+  /*! \brief Mapping from original var to updated var with may_share annotation. */
+  std::unordered_map<Var, Var, ObjectPtrHash, ObjectPtrEqual> var_update_map_;
+};
+
 }  // namespace inplace_update
 
 Pass InplaceUpdate() {
@@ -518,8 +699,8 @@ Pass InplaceUpdate() {
 Pass ValidateInplaceUpdate(bool enforce_inplace_update) {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    auto analyzer = liveness_analysis::LivenessAnalyzer(f);
-    analyzer.Run();
+    // The validator unites the tensors of valid inplace updates, so it works on a copy.
+    auto analyzer = *liveness_analysis::LivenessAnalyzer::Get(f);
     auto body =
         inplace_update::InplaceUpdateValidator(f->body, analyzer, enforce_inplace_update).Run();
     return Function(f->params, body, f->ret_type, f->type_params, f->attrs);
@@ -527,8 +708,20 @@ Pass ValidateInplaceUpdate(bool enforce_inplace_update) {
   return CreateRAFFunctionPass(pass_func, 1, "ValidateInplaceUpdate", {});
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.inplace_update.elementwise", Bool);
+
+Pass ElementwiseInplaceUpdate() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    auto analyzer = liveness_analysis::LivenessAnalyzer::Get(f);
+    return inplace_update::ElementwiseInplaceMutator(f, analyzer.get()).Run();
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "ElementwiseInplaceUpdate", {"InferType"});
+}
+
 RAF_REGISTER_GLOBAL("raf.pass_.InplaceUpdate").set_body_typed(InplaceUpdate);
 RAF_REGISTER_GLOBAL("raf.pass_.ValidateInplaceUpdate").set_body_typed(ValidateInplaceUpdate);
+RAF_REGISTER_GLOBAL("raf.pass_.ElementwiseInplaceUpdate").set_body_typed(ElementwiseInplaceUpdate);
 
 }  // namespace pass
 }  // namespace raf
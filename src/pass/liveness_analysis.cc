@@ -8,6 +8,9 @@
  * \brief A pass for analyzing tensor liveness.
  */
 #include "liveness_analysis.h"
+#include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include "raf/op.h"
 #include "raf/ir_ext.h"
@@ -103,6 +106,29 @@ MapVSet LivenessAnalyzer::Run() {
   return live_;
 }
 
+std::shared_ptr<LivenessAnalyzer> LivenessAnalyzer::Get(const Function& func) {
+  // A small LRU cache of the analyzed functions. The functions are held by the cache, so their
+  // addresses cannot be reused by other functions while being cached.
+  static constexpr size_t kCacheSize = 4;
+  static std::mutex mu;
+  static std::list<std::pair<Function, std::shared_ptr<LivenessAnalyzer>>> cache;
+
+  std::lock_guard<std::mutex> lock(mu);
+  for (auto it = cache.begin(); it != cache.end(); ++it) {
+    if (it->first.same_as(func)) {
+      cache.splice(cache.begin(), cache, it);
+      return cache.front().second;
+    }
+  }
+  auto analyzer = std::make_shared<LivenessAnalyzer>(func);
+  analyzer->Run();
+  cache.emplace_front(func, analyzer);
+  if (cache.size() > kCacheSize) {
+    cache.pop_back();
+  }
+  return analyzer;
+}
+
 void LivenessAnalyzer::FormChecker::VisitExpr_(const LetNode* node) {
   auto pre_visit = [this](const LetNode* node) {
     this->VisitExpr(node->var);
@@ -264,13 +290,13 @@ Var LivenessAnalyzer::ForwardAnalyzer::Run() {
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const VarNode* node) {
   auto vars = analyzer_->GetTensorVars(GetRef<Var>(node));
   CHECK_EQ(vars.size(), 1U);
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(vars[0])];
+  analyzer_->live_[let_var_] = MergeLive(vars[0]);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const FunctionNode* node) {
   Function f = GetRef<Function>(node);
   Array<Var> free_vars = FreeVars(f);
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(let_var_)];
+  analyzer_->live_[let_var_] = MergeLive(let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const CallNode* node) {
@@ -294,8 +320,7 @@ void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const CallNode* node) {
       }
     }
     Var d1 = analyzer_->Merge(vargs);
-    Var d2 = MergeLive(d1, let_var_);
-    analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+    analyzer_->live_[let_var_] = MergeLive(d1, let_var_);
   }
 }
 
@@ -309,19 +334,18 @@ void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const TupleNode* node) {
     }
   }
   Var d1 = analyzer_->Merge(var_fields);
-  Var d2 = MergeLive(d1, let_var_);
-  analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+  analyzer_->live_[let_var_] = MergeLive(d1, let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const TupleGetItemNode* node) {
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(let_var_)];
+  analyzer_->live_[let_var_] = MergeLive(let_var_);
 }
 
 void LivenessAnalyzer::BackwardAnalyzer::VisitExpr_(const IfNode* node) {
   Var free_true = analyzer_->Merge(FreeVars(node->true_branch));
   Var free_false = analyzer_->Merge(FreeVars(node->false_branch));
-  analyzer_->live_[let_var_] = analyzer_->vset_[MergeLive(
-      analyzer_->Merge({free_true, free_false, Downcast<Var>(node->cond)}), let_var_)];
+  analyzer_->live_[let_var_] =
+      MergeLive(analyzer_->Merge({free_true, free_false, Downcast<Var>(node->cond)}), let_var_);
   VisitBranch(node->true_branch, let_var_);
   VisitBranch(node->false_branch, let_var_);
 }
@@ -345,7 +369,7 @@ void LivenessAnalyzer::BackwardAnalyzer::Run(Var next_var) {
   // Backward analysis
   next_var_ = next_var;
   analyzer_->dummy_output_ = analyzer_->CreateNull();
-  analyzer_->live_[analyzer_->dummy_output_] = analyzer_->vset_[MergeLive(ell_->ret)];
+  analyzer_->live_[analyzer_->dummy_output_] = MergeLive(ell_->ret);
   for (int i = n - 1; i >= 0; --i) {
     let_var_ = vars[i];
     next_var_ = i == n - 1 ? analyzer_->dummy_output_ : vars[i + 1];
@@ -355,8 +379,7 @@ void LivenessAnalyzer::BackwardAnalyzer::Run(Var next_var) {
     if (exprs[i].as<OpNode>() || exprs[i].as<ConstantNode>() || exprs[i].as<FunctionNode>()) {
       auto dummy_vars = analyzer_->GetTensorVars(next_var_);
       Var d1 = analyzer_->Merge(dummy_vars);
-      Var d2 = MergeLive(d1, next_var_);
-      analyzer_->live_[let_var_] = analyzer_->vset_[d2];
+      analyzer_->live_[let_var_] = MergeLive(d1, next_var_);
     } else {
       CHECK_GT(analyzer_->live_.count(next_var_), 0);
     }
@@ -478,8 +501,7 @@ void DumpLivenessStat(const MapVSet& live_in) {
 liveness_analysis::MapVSet LivenessAnalysis(const IRModule& mod) {
   auto entry = mod->GetGlobalVar("main");
   auto func = Downcast<Function>(mod->Lookup(entry));
-  auto la = liveness_analysis::LivenessAnalyzer(func);
-  return la.Run();
+  return liveness_analysis::LivenessAnalyzer::Get(func)->GetLiveVarsMap();
 }
 
 // Put the live in set to an Array as std::unordered_set is not in the object system.
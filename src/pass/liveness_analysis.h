@@ -8,6 +8,7 @@
  * \brief A pass for analyzing tensor liveness.
  */
 #pragma once
+#include <memory>
 #include <vector>
 #include "raf/op.h"
 #include "raf/op_utils.h"
@@ -74,6 +75,16 @@ class LivenessAnalyzer {
 
   MapVSet Run();
 
+  /*!
+   * \brief Get the analyzed result of the given function. The results of the recently analyzed
+   * functions are cached, so the passes in a pipeline that analyze the same function share one
+   * analysis. The returned analyzer is shared and must not be mutated (e.g., by Unite); copy it
+   * before mutation.
+   * \param func The function to be analyzed.
+   * \return The analyzer that has been run on the function.
+   */
+  static std::shared_ptr<LivenessAnalyzer> Get(const Function& func);
+
   bool IsSuccess() {
     return !failure_;
   }
@@ -86,6 +97,11 @@ class LivenessAnalyzer {
     return live_.at(x);
   }
 
+  /*! \brief Get live in tensors of all lines. */
+  const MapVSet& GetLiveVarsMap() const {
+    return live_;
+  }
+
   /*! \brief Get the dummy tensor variables of the final outputs. */
   VSet GetOutputTensorVars() {
     return GetLiveVars(dummy_output_);
@@ -352,7 +368,7 @@ class LivenessAnalyzer {
 
  private:
   /*! \brief the function to be analyzed */
-  const Function& func_;
+  Function func_;
   /*! \brief whether func_ contains closure invoke */
   bool failure_{false};
   /*! \brief maps a var to the set of real or fake variables which share memory with the key */
@@ -468,18 +484,25 @@ class LivenessAnalyzer::BackwardAnalyzer : public ExprVisitor {
   /*! \brief returns live_[next_var_] - vset_[def] + vset_[cur]
              it's an instantiation of the following rule:
              live(l + 1, x) && !define(l, x) => live(l, x) */
-  Var MergeLive(const Var& cur, const Var& def = Var()) {
-    Var next_line_var = analyzer_->CreateTensorVar("ml");
-    CHECK(analyzer_->live_.find(next_var_) != analyzer_->live_.end());
-    analyzer_->vset_[next_line_var] = analyzer_->live_.at(next_var_);
-    Var remain = next_line_var;
-    if (def.defined()) {
-      remain = analyzer_->Remove(remain, def);
+  VSet MergeLive(const Var& cur, const Var& def = Var()) {
+    auto it = analyzer_->live_.find(next_var_);
+    CHECK(it != analyzer_->live_.end());
+    // The live set is computed in place instead of via dummy variables, which would otherwise
+    // keep a copy of the live set for each line in vset_.
+    VSet ret = it->second;
+    if (def.defined() && analyzer_->vset_.count(def)) {
+      for (const auto& var : analyzer_->vset_.at(def)) {
+        ret.erase(var);
+      }
+    }
+    if (cur.defined() && analyzer_->vset_.count(cur)) {
+      const VSet& vset = analyzer_->vset_.at(cur);
+      ret.insert(vset.begin(), vset.end());
     }
-    Var ret = analyzer_->Merge(remain, cur);
     return ret;
   }
 
+
  private:
   /*! \brief the expression to be analyzed */
   const Expr& body_;
@@ -0,0 +1,70 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file lower_compiler_regions.cc
+ * \brief Lower the functions created by PartitionGraph to the fused functions of their targets.
+ * A partitioned function captures its inputs from the enclosing scope and is called without
+ * arguments, which cannot be dispatched. This pass turns its free vars into parameters, passes
+ * them at the call site, and marks the function as primitive with the target as its dialect, so
+ * it is dispatched to the "raf.op.<target>._fused_op" OpEnv of the external backend.
+ */
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace lower_compiler_regions {
+
+using namespace raf::ir;
+
+/*!
+ * \brief Lower the partitioned functions called in an ANF expression.
+ * \param body The expression in ANF.
+ * \return The transformed expression.
+ */
+Expr LowerRegions(const Expr& body) {
+  if (!body->IsInstance<LetNode>()) {
+    return body;
+  }
+  auto ell = ExplicitLetList::make(body);
+  for (auto& expr : ell->exprs) {
+    auto call = expr.as<CallNode>();
+    auto func = call ? call->op.as<FunctionNode>() : nullptr;
+    if (func == nullptr) {
+      continue;
+    }
+    auto target = func->GetAttr<String>(attr::kCompiler);
+    // The ops of the default target are left to be fused and dispatched as usual.
+    if (!target.defined() || target.value() == "default" || !call->args.empty()) {
+      continue;
+    }
+    Array<Var> free_vars = FreeVars(GetRef<Function>(func));
+    Function lowered = CreateGlobalFunc(free_vars, func->body, func->ret_type);
+    lowered = WithAttr(std::move(lowered), attr::kPrimitive, tvm::Integer(1));
+    lowered = WithAttr(std::move(lowered), attr::kDialect, target.value());
+    Array<Expr> args(free_vars.begin(), free_vars.end());
+    expr = Call(lowered, args, call->attrs, call->type_args);
+  }
+  return ell->AsExpr();
+}
+
+}  // namespace lower_compiler_regions
+
+Pass LowerCompilerRegions() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    Expr body = lower_compiler_regions::LowerRegions(f->body);
+    return Function(f->params, body, f->ret_type, f->type_params, f->attrs);
+  };
+  return CreateRAFFunctionPass(pass_func, 0, "LowerCompilerRegions", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.LowerCompilerRegions").set_body_typed(LowerCompilerRegions);
+
+}  // namespace pass
+}  // namespace raf
@@ -173,6 +173,11 @@ class ManifestAllocMutator : public ExprMutator {
         }
         auto tensor_ty_node = out_types[0].as<TensorTypeNode>();
         new_args.push_back(MakeConstant(op::ArrayToIntTuple(tensor_ty_node->shape)));
+        static auto view_op = Op::Get("raf.op.view");
+        if (op::IsInOpSet(call->op, {view_op}) && call->args.size() > 2) {
+          // The offset of the view in the elements of its input.
+          new_args.push_back(call->args[2]);
+        }
         return Call(vm_set_shape_op, new_args);
       } else {
         // allocate necessary memory buffers and invoke ops
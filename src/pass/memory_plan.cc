@@ -18,6 +18,7 @@
 #include "raf/pass.h"
 #include "./let_list.h"
 #include "./liveness_analysis.h"
+#include "../common/interval_packing.h"
 #include "tvm/relay/attrs/memory.h"
 
 namespace raf {
@@ -54,6 +55,12 @@ struct TensorGroup {
 
   /*! \brief The alignment of this group. */
   int64_t alignment;
+
+  /*! \brief The byte offsets of the members packed one after another into the storage (e.g., the
+   * bucket of a fused allreduce), in which case the size is fixed to the total bytes of the
+   * members. Empty if all members start at the beginning of the storage.
+   */
+  StdMap<int64_t> offsets;
 };
 
 /*! \brief A list of tensor groups with manipulation utilities. */
@@ -141,7 +148,22 @@ class TensorGroups {
   void JoinGroup(size_t group_id, const Var& let_var, int64_t size = 0) {
     const Var target_var = GetTensorVar(let_var);
     groups[group_id].members[target_var] = std::make_pair(let_var, size);
-    groups[group_id].size = (groups[group_id].size > size) ? groups[group_id].size : size;
+    if (groups[group_id].offsets.empty()) {
+      groups[group_id].size = (groups[group_id].size > size) ? groups[group_id].size : size;
+    }
+  }
+
+  /*! \brief Join the given packed tensor group at the given byte offset. */
+  void JoinPackedGroup(size_t group_id, const Var& let_var, int64_t size, int64_t offset) {
+    JoinGroup(group_id, let_var, size);
+    groups[group_id].offsets[GetTensorVar(let_var)] = offset;
+  }
+
+  /*! \brief Get the byte offset of the tensor in its packed group, or -1 if not packed. */
+  int64_t GetOffset(size_t group_id, const Var& let_var) {
+    const auto& offsets = groups[group_id].offsets;
+    auto it = offsets.find(GetTensorVar(let_var));
+    return it != offsets.end() ? it->second : -1;
   }
 
   /*! \brief Create a new group and return its ID. */
@@ -150,6 +172,13 @@ class TensorGroups {
     return groups.size() - 1;
   }
 
+  /*! \brief Create a new packed group of the given total size and return its ID. */
+  int CreatePackedGroup(const Var& storage_var, int64_t alignment, int64_t size) {
+    auto group_id = CreateGroup(storage_var, alignment);
+    groups[group_id].size = size;
+    return group_id;
+  }
+
   /*! \brief Remove the tensor from the group, update the storage size, and return the size of
    * the removed tensor.
    */
@@ -157,7 +186,7 @@ class TensorGroups {
     const Var target_var = GetTensorVar(let_var);
     CHECK_GT(groups[group_id].members.count(target_var), 0U);
     auto storage_nbytes = groups[group_id].members[target_var].second;
-    if (groups[group_id].size == storage_nbytes) {
+    if (groups[group_id].offsets.empty() && groups[group_id].size == storage_nbytes) {
       // The storage size of this group may be reduced due to the removal of this tensor.
       int64_t max_size = 0;
       for (auto kv : groups[group_id].members) {
@@ -350,6 +379,17 @@ class MemoryPlanner : public ExprMutator {
         new_args.Set(4, own);
       }
 
+      // Place the tensor at its offset if the group is packed.
+      auto offset = tensor_groups_.GetOffset(group_id, curr_let_);
+      if (offset != -1) {
+        auto offset_arg = MakeConstant(ScalarValue::make(offset));
+        if (new_args.size() == 5) {
+          new_args.push_back(offset_arg);
+        } else {
+          new_args.Set(5, offset_arg);
+        }
+      }
+
       return Call(alloc_tensor_op, new_args);
     } else if (op_node && GetRef<Op>(op_node) == reshape_tensor_op) {
       // Other ops that will also create a new tensor/view. We do not need to mutate them,
@@ -394,6 +434,9 @@ class MemoryPlanner : public ExprMutator {
  * 1) has no other tensors in the live-in set of the current tensor,
  * 2) has the same the alignment, and
  * 3) has the closest storage size as the current tensor.
+ * In addition, the tensors of a bucket (i.e., the tuple input or output) of a fused allreduce
+ * are packed one after another into a single storage, so that the allreduce runs on the bucket
+ * directly instead of copying the tensors to and from a fused buffer.
  */
 class MemoryPlanner::TensorGrouper : public ExprVisitor {
  public:
@@ -411,6 +454,7 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
     for (size_t i = 0; i < n; ++i) {
       expr_map_[vars[i]] = exprs[i];
     }
+    PlanBuckets();
 
     for (int i = 0; i < n; ++i) {
       curr_let_ = vars[i];
@@ -453,6 +497,21 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
         storage_nbytes = size_val.as<IntValueObj>()->value;
       }
 
+      // Join the packed group of the bucket, which uses the storage of its first allocated tensor.
+      auto bucket_it = bucket_offsets_.find(tensor_groups_.GetTensorVar(curr_let_));
+      if (bucket_it != bucket_offsets_.end()) {
+        auto bucket_id = bucket_it->second.first;
+        if (bucket_groups_[bucket_id] == -1) {
+          bucket_groups_[bucket_id] =
+              tensor_groups_.CreatePackedGroup(storage_var, alignment, bucket_sizes_[bucket_id]);
+          DLOG(INFO) << "Create a new packed group " << bucket_groups_[bucket_id] << " for "
+                     << storage_var->name_hint();
+        }
+        tensor_groups_.JoinPackedGroup(bucket_groups_[bucket_id], curr_let_, storage_nbytes,
+                                       bucket_it->second.second);
+        return;
+      }
+
       // Create a new tensor group.
       auto cand_group_id = tensor_groups_.CreateGroup(storage_var, alignment);
       DLOG(INFO) << "Create a new group " << cand_group_id << " for " << storage_var->name_hint();
@@ -477,6 +536,103 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
     }
   }
 
+  /*!
+   * \brief Plan the offsets of the tensors in the buckets of fused allreduce, which are invoked
+   * as invoke_op(allreduce, ((x_0, x_1, ...), ...), (out_0, out_1, ...)). A bucket is packed only
+   * if all its tensors are allocated by us with static sizes, the same dtype and alignment, and
+   * the tensors except for the last one have sizes of multiples of the alignment, so the packed
+   * tensors are contiguous without paddings.
+   */
+  void PlanBuckets() {
+    static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
+    static const Op& allreduce_op = Op::Get("raf.op._allreduce");
+    static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+    auto get_expr = [&](const Expr& expr) {
+      auto var = expr.as<VarNode>();
+      auto it = var ? expr_map_.find(GetRef<Var>(var)) : expr_map_.end();
+      return it != expr_map_.end() ? it->second : Expr();
+    };
+
+    // Map the tensors to their alloc_tensor.
+    StdMap<const CallNode*> alloc_of;
+    for (const auto& kv : expr_map_) {
+      auto call = kv.second.as<CallNode>();
+      if (call && call->op.same_as(alloc_tensor_op)) {
+        auto tensor_vars = analyzer_->GetTensorVars(kv.first);
+        if (tensor_vars.size() == 1U) {
+          alloc_of[tensor_vars[0]] = call;
+        }
+      }
+    }
+
+    auto plan_bucket = [&](const Array<Expr>& fields) {
+      if (fields.size() < 2U) {
+        return;
+      }
+      std::vector<Var> members;
+      std::vector<int64_t> offsets;
+      VSet visited;
+      int64_t alignment = -1, offset = 0;
+      std::string dtype;
+      for (const auto& field : fields) {
+        auto var = field.as<VarNode>();
+        if (var == nullptr) {
+          return;
+        }
+        auto tensor_vars = analyzer_->GetTensorVars(GetRef<Var>(var));
+        if (tensor_vars.size() != 1U || alloc_of.count(tensor_vars[0]) == 0 ||
+            bucket_offsets_.count(tensor_vars[0]) > 0 || !visited.insert(tensor_vars[0]).second) {
+          return;
+        }
+        auto alloc_tensor = alloc_of[tensor_vars[0]];
+        auto storage = get_expr(alloc_tensor->args[0]).as<CallNode>();
+        if (!storage || !storage->args[0].as<ConstantNode>() ||
+            !storage->args[1].as<ConstantNode>() || !alloc_tensor->args[2].as<ConstantNode>()) {
+          return;
+        }
+        auto size_val = storage->args[0].as<ConstantNode>()->value.as<IntValueObj>();
+        auto align_val = storage->args[1].as<ConstantNode>()->value.as<IntValueObj>();
+        auto dtype_val = alloc_tensor->args[2].as<ConstantNode>()->value.as<StringValueObj>();
+        if (!size_val || !align_val || !dtype_val) {
+          return;
+        }
+        if (alignment == -1) {
+          alignment = align_val->value;
+          dtype = dtype_val->value;
+        } else if (align_val->value != alignment || dtype_val->value != dtype ||
+                   offset % alignment != 0) {
+          return;
+        }
+        members.push_back(tensor_vars[0]);
+        offsets.push_back(offset);
+        offset += size_val->value;
+      }
+      for (size_t i = 0; i < members.size(); ++i) {
+        bucket_offsets_[members[i]] = std::make_pair(bucket_sizes_.size(), offsets[i]);
+      }
+      bucket_sizes_.push_back(offset);
+      bucket_groups_.push_back(-1);
+    };
+
+    for (const auto& expr : ell_->exprs) {
+      auto call = expr.as<CallNode>();
+      if (!call || !call->op.same_as(invoke_op) ||
+          !get_expr(call->args[0]).same_as(allreduce_op)) {
+        continue;
+      }
+      auto ins = get_expr(call->args[1]).as<TupleNode>();
+      auto outs = get_expr(call->args[2]).as<TupleNode>();
+      if (ins && !ins->fields.empty()) {
+        if (auto x = get_expr(ins->fields[0]).as<TupleNode>()) {
+          plan_bucket(x->fields);
+        }
+      }
+      if (outs) {
+        plan_bucket(outs->fields);
+      }
+    }
+  }
+
   /*! \brief The current processing let var. */
   Var curr_let_;
   /*! \brief The let list. */
@@ -487,12 +643,113 @@ class MemoryPlanner::TensorGrouper : public ExprVisitor {
   liveness_analysis::LivenessAnalyzer* analyzer_;
   /*! \brief A list of storage allocation groups. */
   TensorGroups tensor_groups_;
+  /*! \brief Mapping from a dummy tensor in a bucket to the bucket ID and its byte offset. */
+  StdMap<std::pair<size_t, int64_t>> bucket_offsets_;
+  /*! \brief The total bytes of each bucket. */
+  std::vector<int64_t> bucket_sizes_;
+  /*! \brief The packed group ID of each bucket, or -1 if not created yet. */
+  std::vector<int> bucket_groups_;
 };
 
 TensorGroups MemoryPlanner::Group() {
   return TensorGrouper(func_, analyzer_).Run();
 }
 
+/*! \brief The statistics of packing the intermediate tensors into a single buffer. */
+struct OffsetPlanStat {
+  /*! \brief The total bytes of the intermediate tensors without any sharing. */
+  int64_t total = 0;
+  /*! \brief The bytes of the buffer with the tensors placed at the planned offsets. */
+  int64_t peak = 0;
+  /*! \brief The largest bytes of the tensors live at the same time. */
+  int64_t lower_bound = 0;
+};
+
+/*! \brief A planner to assign the intermediate tensors of static sizes byte offsets within
+ * a single buffer, by packing their live intervals (greedy-by-size best-fit). The final outputs
+ * own their storages and are not packed. Unlike tensor groups, tensors of different sizes can
+ * share the same bytes as long as their lifetimes do not overlap.
+ */
+class OffsetPlanner {
+ public:
+  OffsetPlanner(const Function& func, liveness_analysis::LivenessAnalyzer* analyzer)
+      : func_(func), analyzer_(analyzer), ell_(ExplicitLetList::make(func->body)) {
+    CHECK(analyzer_->IsSuccess());
+  }
+
+  OffsetPlanStat Run() {
+    static const Op& alloc_storage_op = Op::Get("raf.op.vm.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("raf.op.vm.alloc_tensor");
+    static const Op& reshape_tensor_op = Op::Get("raf.op.vm.set_shape");
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    auto out_vars = analyzer_->GetOutputTensorVars();
+
+    std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> expr_map;
+    // The interval of the storage each dummy tensor lives in.
+    StdMap<size_t> interval_of;
+    std::vector<common::interval_packing::Interval> intervals;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      expr_map[vars[i]] = exprs[i];
+      auto call = exprs[i].as<CallNode>();
+      auto op = call ? call->op.as<OpNode>() : nullptr;
+      if (op == nullptr) {
+        continue;
+      }
+      auto tensor_vars = analyzer_->GetTensorVars(vars[i]);
+      if (tensor_vars.size() != 1U || out_vars.count(tensor_vars[0]) > 0) {
+        continue;
+      }
+      if (GetRef<Op>(op) == alloc_tensor_op) {
+        auto storage_node = expr_map[Downcast<Var>(call->args[0])].as<CallNode>();
+        if (!storage_node || storage_node->op != alloc_storage_op) {
+          continue;
+        }
+        auto size_node = storage_node->args[0].as<ConstantNode>();
+        auto align_node = storage_node->args[1].as<ConstantNode>();
+        if (!size_node || !align_node) {
+          continue;
+        }
+        int64_t size = Downcast<IntValue>(size_node->value)->value;
+        int64_t alignment = Downcast<IntValue>(align_node->value)->value;
+        interval_of[tensor_vars[0]] = intervals.size();
+        intervals.push_back({static_cast<int64_t>(i), static_cast<int64_t>(i), size, alignment});
+      } else if (GetRef<Op>(op) == reshape_tensor_op) {
+        // A view extends the lifetime of the tensor it is created from.
+        auto src_vars = analyzer_->GetTensorVars(Downcast<Var>(call->args[0]));
+        if (src_vars.size() == 1U && interval_of.count(src_vars[0]) > 0) {
+          interval_of[tensor_vars[0]] = interval_of[src_vars[0]];
+        }
+      }
+    }
+    for (size_t i = 0; i < vars.size(); ++i) {
+      for (const auto& var : analyzer_->GetLiveVars(vars[i])) {
+        auto it = interval_of.find(var);
+        if (it != interval_of.end()) {
+          auto& interval = intervals[it->second];
+          interval.end = std::max(interval.end, static_cast<int64_t>(i));
+        }
+      }
+    }
+
+    OffsetPlanStat stat;
+    for (const auto& interval : intervals) {
+      stat.total += interval.size;
+    }
+    stat.lower_bound = common::interval_packing::GetLowerBound(intervals);
+    stat.peak = common::interval_packing::PackIntervals(&intervals);
+    return stat;
+  }
+
+ private:
+  /*! \brief The function to be planned. */
+  const Function& func_;
+  /*! \brief The liveness analyzer, including liveness analysis results. */
+  liveness_analysis::LivenessAnalyzer* analyzer_;
+  /*! \brief The let list. */
+  std::unique_ptr<ExplicitLetList> ell_{nullptr};
+};
+
 }  // namespace memory_plan
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_plan.dump_liveness_stat", Bool);
@@ -510,25 +767,40 @@ Pass MemoryPlan() {
       return f;
     }
 
-    auto analyzer = liveness_analysis::LivenessAnalyzer(func);
+    std::shared_ptr<liveness_analysis::LivenessAnalyzer> analyzer;
     try {
-      auto live_in = analyzer.Run();
-      if (!analyzer.IsSuccess()) {
+      analyzer = liveness_analysis::LivenessAnalyzer::Get(func);
+      if (!analyzer->IsSuccess()) {
         throw;
       }
       if (dump_stat) {
-        liveness_analysis::DumpLivenessStat(live_in);
+        liveness_analysis::DumpLivenessStat(analyzer->GetLiveVarsMap());
+        auto stat = memory_plan::OffsetPlanner(func, analyzer.get()).Run();
+        LOG(INFO) << "Intermediate tensors: " << stat.total / 1048576.0
+                  << " MBs, offset packing peak: " << stat.peak / 1048576.0
+                  << " MBs, lower bound: " << stat.lower_bound / 1048576.0 << " MBs";
       }
     } catch (const dmlc::Error& e) {
       LOG(WARNING) << "Memory planning is disabled because liveness analysis was failed";
       return func;
     }
-    return Downcast<ir::Function>(memory_plan::MemoryPlanner(func, &analyzer).Run());
+    return Downcast<ir::Function>(memory_plan::MemoryPlanner(func, analyzer.get()).Run());
   };
   return CreateRAFFunctionPass(pass_func, 2, "MemoryPlan", {});
 }
 
+Map<String, Integer> PlanMemoryOffsets(const IRModule& mod) {
+  auto func = Downcast<Function>(pass::InferType(mod->Lookup("main")));
+  auto analyzer = liveness_analysis::LivenessAnalyzer::Get(func);
+  CHECK(analyzer->IsSuccess()) << "Liveness analysis was failed";
+  auto stat = memory_plan::OffsetPlanner(func, analyzer.get()).Run();
+  return {{"total", Integer(stat.total)},
+          {"peak", Integer(stat.peak)},
+          {"lower_bound", Integer(stat.lower_bound)}};
+}
+
 RAF_REGISTER_GLOBAL("raf.pass_.MemoryPlan").set_body_typed(MemoryPlan);
+RAF_REGISTER_GLOBAL("raf.pass_.PlanMemoryOffsets").set_body_typed(PlanMemoryOffsets);
 
 }  // namespace pass
 }  // namespace raf
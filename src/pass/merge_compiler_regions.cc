@@ -13,11 +13,21 @@
  * This pass only introduces annotations to indicate the regions.
  * partition_graph must subsequently be called to lift these regions out
  * as external functions.
+ *
+ * When "raf.merge_regions.cost_model" is set, a region is only kept for its target
+ * if the estimated latency of offloading it, including the launch overhead of the
+ * external function and the traffic of its boundary tensors, is lower than running
+ * its operators natively. The other regions fall back to the default target.
  */
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
 #include "raf/op.h"
 #include "raf/ir_ext.h"
 #include "raf/pass.h"
 #include "./common.h"
+#include "./estimate_flops.h"
+#include "../common/shape_utils.h"
 #include "../op/dialect/tvm/tvm_attrs.h"
 
 namespace raf {
@@ -25,23 +35,185 @@ namespace pass {
 namespace merge_compiler_regions {
 
 using namespace raf::ir;
+using common::shape_utils::BytesCompactType;
 using raf::op::tvm_dialect::CompilerAttrs;
 
 static const Op& begin_op = CompilerBeginOp();
 static const Op& end_op = CompilerEndOp();
 
+/*! \brief The parameters of the cost model to decide whether to offload a region. */
+struct RegionCostModel {
+  /*! \brief The launch overhead of an external function in us. */
+  double region_overhead_us;
+  /*! \brief The launch overhead of a native operator in us. */
+  double op_overhead_us;
+  /*! \brief The compute speedup of the external target over the native ops in percent. */
+  double speedup_percent;
+  /*! \brief The native compute throughput in GFLOP/s. */
+  double native_gflops;
+  /*! \brief The bandwidth to move the boundary tensors of a region in GB/s. */
+  double boundary_gbps;
+
+  static RegionCostModel Current() {
+    auto pass_ctx = PassContext::Current();
+    auto get = [&pass_ctx](const std::string& key, int default_value) {
+      return static_cast<double>(
+          pass_ctx->GetConfig(key, Integer(default_value)).value().IntValue());
+    };
+    RegionCostModel model;
+    model.region_overhead_us = get("raf.merge_regions.region_overhead_us", 20);
+    model.op_overhead_us = get("raf.merge_regions.op_overhead_us", 5);
+    model.speedup_percent = std::max(get("raf.merge_regions.speedup_percent", 150), 1.0);
+    model.native_gflops = std::max(get("raf.merge_regions.native_gflops", 10000), 1.0);
+    model.boundary_gbps = std::max(get("raf.merge_regions.boundary_gbps", 500), 1.0);
+    return model;
+  }
+
+  /*!
+   * \brief Whether offloading a region is profitable.
+   * \param num_ops The number of operators in the region.
+   * \param gflops The GFLOPs of the region.
+   * \param boundary_bytes The bytes of the inputs and outputs of the region.
+   * \return Whether the region should be offloaded.
+   */
+  bool Profitable(size_t num_ops, double gflops, double boundary_bytes) const {
+    double native_us = num_ops * op_overhead_us + gflops / native_gflops * 1e6;
+    double external_us = region_overhead_us +
+                         gflops / (native_gflops * speedup_percent / 100) * 1e6 +
+                         boundary_bytes / (boundary_gbps * 1e3);
+    return external_us < native_us;
+  }
+};
+
+/*! \brief Replace the targets of the compiler annotations in an expression. */
+class Retargeter : public ExprMutator {
+ public:
+  explicit Retargeter(const String& target) {
+    auto attrs = make_object<CompilerAttrs>();
+    attrs->compiler = target;
+    attrs_ = Attrs(attrs);
+  }
+
+  Expr VisitExpr_(const CallNode* call) final {
+    Expr post = ExprMutator::VisitExpr_(call);
+    auto node = post.as<CallNode>();
+    if (node->op == begin_op || node->op == end_op) {
+      return Call(node->op, node->args, attrs_, node->type_args);
+    }
+    return post;
+  }
+
+ private:
+  /*! \brief The attributes with the new target. */
+  Attrs attrs_;
+};
+
+/*! \brief Get the target of an annotated let value. */
+String GetTarget(const Expr& expr) {
+  return expr.as<CallNode>()->attrs.as<CompilerAttrs>()->compiler;
+}
+
+/*!
+ * \brief Move the regions that are not worth offloading to the default target.
+ * \param func The annotated function.
+ * \param ell The let list of the function body, which is updated in place.
+ */
+void DemoteUnprofitableRegions(const Function& func, ExplicitLetList* ell) {
+  size_t n = ell->vars.size();
+  // Estimate the FLOPs and types on a copy without the annotations.
+  std::vector<Expr> plain_exprs;
+  for (const auto& expr : ell->exprs) {
+    plain_exprs.push_back(RemoveAnnotation(RemoveAnnotation(expr, begin_op), end_op));
+  }
+  ExplicitLetList plain = *ell;
+  plain.exprs = plain_exprs;
+  Function typed = Downcast<Function>(
+      InferType(Function(func->params, plain.AsExpr(), {}, func->type_params, func->attrs)));
+  auto typed_ell = ExplicitLetList::make(typed->body);
+  CHECK_EQ(typed_ell->vars.size(), n);
+  auto device = Device::Current();
+  estimate_flops::StdMap<float> flops;
+  if (device.device_type() != DevType::kUnknown() || device.device_id() != -1) {
+    flops = estimate_flops::FLOPSEstimater().Run(device, typed, IRModule());
+  }
+
+  // The index of the let that defines a var, and the index of the last let that uses it, where
+  // n stands for the result of the function.
+  std::unordered_map<const VarNode*, size_t> def_index, last_use;
+  for (size_t i = 0; i < n; ++i) {
+    def_index[typed_ell->vars[i].get()] = i;
+    for (const auto& var : FreeVars(typed_ell->exprs[i])) {
+      last_use[var.get()] = i;
+    }
+  }
+  last_use[typed_ell->ret.get()] = n;
+  auto get_bytes = [&](const Var& var) -> double {
+    auto type = var->checked_type_;
+    return type.defined() ? static_cast<double>(BytesCompactType(type)) : 0;
+  };
+
+  RegionCostModel model = RegionCostModel::Current();
+  std::vector<String> targets;
+  for (const auto& expr : ell->exprs) {
+    targets.push_back(GetTarget(expr));
+  }
+  for (size_t start = 0, end = 0; start < n; start = end) {
+    end = start + 1;
+    while (end < n && targets[end] == targets[start]) {
+      ++end;
+    }
+    if (targets[start] == "default") {
+      continue;
+    }
+    double gflops = 0, boundary_bytes = 0;
+    std::unordered_set<const VarNode*> inputs;
+    for (size_t i = start; i < end; ++i) {
+      auto it = flops.find(typed_ell->vars[i]);
+      if (it != flops.end() && std::isfinite(it->second)) {
+        gflops += std::max(it->second, 0.0f);
+      }
+      for (const auto& var : FreeVars(typed_ell->exprs[i])) {
+        auto def = def_index.find(var.get());
+        if (def != def_index.end() && def->second >= start) {
+          continue;
+        }
+        if (inputs.insert(var.get()).second) {
+          boundary_bytes += get_bytes(var);
+        }
+      }
+      if (last_use[typed_ell->vars[i].get()] >= end) {
+        boundary_bytes += get_bytes(typed_ell->vars[i]);
+      }
+    }
+    if (!model.Profitable(end - start, gflops, boundary_bytes)) {
+      DLOG(INFO) << "Move a region of " << end - start << " ops from " << targets[start]
+                 << " to default: " << gflops << " GFLOPs, " << boundary_bytes << " bytes";
+      Retargeter retargeter("default");
+      for (size_t i = start; i < end; ++i) {
+        ell->exprs[i] = retargeter.Mutate(ell->exprs[i]);
+      }
+    }
+  }
+}
+
 class MergeAnnotations : public ExprRewriter {
  public:
-  explicit MergeAnnotations() {
+  explicit MergeAnnotations(bool use_cost_model) : use_cost_model_(use_cost_model) {
   }
 
   Expr Rewrite_(const FunctionNode* func, const Expr& post) final {
     std::unique_ptr<ExplicitLetList> ell_ = ExplicitLetList::make(func->body);
-    const std::unique_ptr<ExplicitLetList> ref_ell_ = ExplicitLetList::make(func->body);
+    std::unique_ptr<ExplicitLetList> ref_ell_ = ExplicitLetList::make(func->body);
 
     size_t ell_n = ell_->vars.size();
     CHECK_GT(ell_n, 0U);
 
+    // The cost is only estimated for closed functions, whose types can be inferred.
+    if (use_cost_model_ && FreeVars(GetRef<Function>(func)).empty()) {
+      DemoteUnprofitableRegions(GetRef<Function>(func), ref_ell_.get());
+      ell_->exprs = ref_ell_->exprs;
+    }
+
     // Multiple ops inside the FunctionNode. Explore the possible of merging.
     if (ell_n > 1) {
       for (size_t i = 1; i < ell_n; ++i) {
@@ -49,8 +221,7 @@ class MergeAnnotations : public ExprRewriter {
         const CallNode* call = ell_->exprs[i].as<CallNode>();
 
         // Merge the CallNodes inside two LetNodes if they have the same target.
-        if (ref_ell_->exprs[i - 1].as<CallNode>()->attrs.as<CompilerAttrs>()->compiler ==
-            ref_ell_->exprs[i].as<CallNode>()->attrs.as<CompilerAttrs>()->compiler) {
+        if (GetTarget(ref_ell_->exprs[i - 1]) == GetTarget(ref_ell_->exprs[i])) {
           // Remove the compiler_begin annotations of the previous CallNode.
           Expr prev_expr = RemoveAnnotation(GetRef<Expr>(prev_call), end_op);
           ell_->exprs[i - 1] = prev_expr;
@@ -64,26 +235,38 @@ class MergeAnnotations : public ExprRewriter {
       Expr new_body = ell_->AsExpr();
 
       return Function(func->params, new_body, func->ret_type, func->type_params, func->attrs);
+    } else if (use_cost_model_) {
+      return Function(func->params, ell_->AsExpr(), func->ret_type, func->type_params,
+                      func->attrs);
     } else {
       return post;
     }
   }
 
  private:
-  ExplicitLetList ell_;
+  /*! \brief Whether to move the regions that are not worth offloading to default. */
+  bool use_cost_model_;
 };
 
-Expr MergeCompilerRegions(const Expr& expr) {
-  MergeAnnotations merge_anno = MergeAnnotations();
+Expr MergeCompilerRegions(const Expr& expr, bool use_cost_model) {
+  MergeAnnotations merge_anno = MergeAnnotations(use_cost_model);
   return PostOrderRewrite(expr, &merge_anno);
 }
 
 }  // namespace merge_compiler_regions
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.merge_regions.cost_model", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.merge_regions.region_overhead_us", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.merge_regions.op_overhead_us", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.merge_regions.speedup_percent", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.merge_regions.native_gflops", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.merge_regions.boundary_gbps", Integer);
+
 Pass MergeCompilerRegions() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(merge_compiler_regions::MergeCompilerRegions(f));
+    bool use_cost_model = pc->GetConfig("raf.merge_regions.cost_model", Bool(false)).value();
+    return Downcast<Function>(merge_compiler_regions::MergeCompilerRegions(f, use_cost_model));
   };
   return CreateRAFFunctionPass(pass_func, 0, "MergeCompilerRegions", {});
 }
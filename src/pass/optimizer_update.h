@@ -0,0 +1,131 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file optimizer_update.h
+ * \brief Find the optimizer updates of a data parallel training step, which are overlapped with the
+ * backward on their own stream.
+ */
+#pragma once
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "raf/ir_ext.h"
+#include "raf/op_utils.h"
+
+namespace raf {
+namespace pass {
+namespace optimizer_update {
+
+using namespace raf::ir;
+
+/*! \brief The pass config to overlap the optimizer updates with the backward. */
+constexpr const char* kOverlapOptimizer = "raf.data_parallel_schedule.overlap_optimizer";
+
+/*! \brief Whether the expression is a call to a collective reducing the gradients. */
+inline bool IsGradientReduction(const Expr& expr) {
+  static const op::OpSet reduction_ops{Op::Get("raf.op._allreduce"), Op::Get("raf.op._reduce"),
+                                       Op::Get("raf.op._reduce_scatter"),
+                                       Op::Get("raf.op._group_reduce_scatter")};
+  auto call = expr.as<CallNode>();
+  return call && op::IsInOpSet(call->op, reduction_ops);
+}
+
+/*! \brief The nodes of a training step in a topological order, i.e., producers first. */
+struct StepGraph {
+  /*! \brief The expression of each node. */
+  std::vector<Expr> exprs;
+  /*! \brief The nodes of the inputs of each node. */
+  std::vector<std::vector<int>> producers;
+  /*! \brief The node of the primary output, e.g., the loss, or -1 if unknown. */
+  int primary = -1;
+  /*! \brief The node of the function output. */
+  int root = -1;
+};
+
+/*! \brief The optimizer updates and the nodes they have to follow. */
+struct Updates {
+  /*! \brief Whether each node is an optimizer update. */
+  std::vector<bool> is_update;
+  /*! \brief The nodes reading the parameters written by each update, which are not its producers
+   * but have to run before it. */
+  std::vector<std::vector<int>> readers;
+};
+
+/*!
+ * \brief Find the optimizer updates of the step. An update depends on a gradient reduction but
+ * reaches neither the primary output nor another gradient reduction, i.e., it is not needed by
+ * the rest of the step, and can run as soon as its gradients are reduced. The function output
+ * is not an update, so it orders the updates before the next step. Since the updates may write
+ * the parameters they read in place, an update follows the other ops reading its parameters.
+ * \param graph The step.
+ * \param params The parameters of the function.
+ * \return The updates, all false if there is no primary output.
+ */
+inline Updates FindUpdates(const StepGraph& graph,
+                           const std::unordered_set<const Object*>& params) {
+  int num_nodes = graph.exprs.size();
+  Updates ret;
+  ret.is_update.assign(num_nodes, false);
+  ret.readers.resize(num_nodes);
+  if (graph.primary < 0) {
+    return ret;
+  }
+  std::vector<bool> after_reduction(num_nodes, false);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (int producer : graph.producers[i]) {
+      if (after_reduction[producer] || IsGradientReduction(graph.exprs[producer])) {
+        after_reduction[i] = true;
+      }
+    }
+  }
+  std::vector<bool> needed(num_nodes, false);
+  needed[graph.primary] = true;
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    if (needed[i] || IsGradientReduction(graph.exprs[i])) {
+      for (int producer : graph.producers[i]) {
+        needed[producer] = true;
+      }
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    auto call = graph.exprs[i].as<CallNode>();
+    ret.is_update[i] = after_reduction[i] && !needed[i] && i != graph.root &&
+                       !(call && op::IsCollectiveOp(call->op));
+  }
+
+  // The parameters read by the ops before the reductions, which cannot depend on an update.
+  std::unordered_map<const Object*, std::vector<int>> param_readers;
+  auto for_each_param = [&](int node, std::function<void(const Object*)> fvisit) {
+    if (auto call = graph.exprs[node].as<CallNode>()) {
+      for (const auto& arg : call->args) {
+        if (params.count(arg.get())) {
+          fvisit(arg.get());
+        }
+      }
+    }
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!after_reduction[i]) {
+      for_each_param(i, [&](const Object* param) { param_readers[param].push_back(i); });
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    if (ret.is_update[i]) {
+      for_each_param(i, [&](const Object* param) {
+        auto it = param_readers.find(param);
+        if (it != param_readers.end()) {
+          ret.readers[i].insert(ret.readers[i].end(), it->second.begin(), it->second.end());
+        }
+      });
+    }
+  }
+  return ret;
+}
+
+}  // namespace optimizer_update
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,218 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file partition_parameter.cc
+ * \brief ZeRO-3: Given a model after AutoDiff and InlineBackward, this pass replaces the
+ * parameters with their partitions along the first axis, and allgathers each parameter right
+ * before it is used. The allgathers of a layer are issued a few layers ahead (prefetch depth) so
+ * that they overlap with the computation, and a parameter is gathered again if it is used by a
+ * later layer, so that the gathered copy is released right after its last use in between.
+ */
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "raf/communicator.h"
+
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace partition_parameter {
+
+using namespace raf::op;
+using namespace raf::distributed::communicator;
+
+/*! \brief A range of the layers in which a gathered parameter is reused. */
+struct GatherWindow {
+  Var param;
+  /*! \brief The first layer using the gathered parameter. */
+  int first_layer;
+  /*! \brief The gathered parameter. */
+  Var gathered;
+};
+
+class ParameterPartitioner {
+ public:
+  ParameterPartitioner(const Function& func, const Array<Var>& params, int n_part,
+                       int prefetch_depth)
+      : func_(func), n_part_(n_part), prefetch_depth_(prefetch_depth) {
+    for (const auto& param : params) {
+      auto ttype = param->checked_type().as<TensorTypeNode>();
+      CHECK(ttype != nullptr && !ttype->shape.empty())
+          << "Expected a tensor parameter with at least one axis, but got "
+          << param->checked_type();
+      auto dim0 = ttype->shape[0].as<IntImmNode>();
+      CHECK(dim0 != nullptr) << "Do not support dynamic shape yet";
+      // Always pad the first axis to be divisible by the number of partitions.
+      int64_t part_dim0 = (dim0->value + n_part_ - 1) / n_part_;
+      Array<PrimExpr> shape = ttype->shape;
+      shape.Set(0, Integer(part_dim0));
+      shards_[param.get()] = MakeVar(param->name_hint(), TensorType(shape, ttype->dtype));
+      dim0_[param.get()] = dim0->value;
+      part_dim0_[param.get()] = part_dim0;
+    }
+  }
+
+  Function Run() {
+    if (shards_.empty()) {
+      return func_;
+    }
+    auto ell = ExplicitLetList::make(func_->body);
+    const auto& vars = ell->vars;
+    const auto& exprs = ell->exprs;
+    CHECK(!shards_.count(ell->ret.get())) << "Cannot return a partitioned parameter directly";
+
+    // Each binding that uses partitioned parameters is a layer.
+    std::vector<std::vector<Var>> used(vars.size());
+    std::vector<size_t> layer_bindings;
+    std::unordered_map<const Object*, int> last_layer;
+    std::vector<GatherWindow> windows;
+    std::vector<std::unordered_map<const Object*, size_t>> window_of(vars.size());
+    for (size_t i = 0; i < vars.size(); ++i) {
+      for (const auto& var : FreeVars(exprs[i])) {
+        if (shards_.count(var.get())) {
+          used[i].push_back(var);
+        }
+      }
+      if (used[i].empty()) {
+        continue;
+      }
+      int layer = layer_bindings.size();
+      layer_bindings.push_back(i);
+      for (const auto& param : used[i]) {
+        // Reuse the gathered parameter in the adjacent layers, or gather it again.
+        auto it = last_layer.find(param.get());
+        if (it == last_layer.end() || layer - it->second > 1) {
+          windows.push_back({param, layer, Var()});
+        }
+        for (size_t w = windows.size(); w-- > 0;) {
+          if (windows[w].param.same_as(param)) {
+            window_of[i][param.get()] = w;
+            break;
+          }
+        }
+        last_layer[param.get()] = layer;
+      }
+    }
+
+    // Issue the allgathers of each window prefetch_depth layers ahead.
+    std::unordered_map<size_t, std::vector<size_t>> issue_at;
+    for (size_t w = 0; w < windows.size(); ++w) {
+      int layer = std::max(windows[w].first_layer - prefetch_depth_, 0);
+      issue_at[layer_bindings[layer]].push_back(w);
+    }
+    ExplicitLetList ell_out;
+    for (size_t i = 0; i < vars.size(); ++i) {
+      if (issue_at.count(i)) {
+        Gather(&ell_out, &windows, issue_at[i]);
+      }
+      if (used[i].empty()) {
+        ell_out.Push(vars[i], exprs[i]);
+        continue;
+      }
+      tvm::Map<Var, Expr> mapping;
+      for (const auto& param : used[i]) {
+        mapping.Set(param, windows[window_of[i][param.get()]].gathered);
+      }
+      ell_out.Push(vars[i], Substitute(exprs[i], mapping));
+    }
+    ell_out.ret = ell->ret;
+
+    Array<Var> params;
+    for (const auto& param : func_->params) {
+      auto it = shards_.find(param.get());
+      params.push_back(it != shards_.end() ? it->second : param);
+    }
+    return Function(params, ell_out.AsExpr(), {}, func_->type_params, func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Allgather the parameters of the windows, and slice off the padding. Multiple
+   * parameters are gathered by a single group allgather.
+   */
+  void Gather(ExplicitLetList* ell, std::vector<GatherWindow>* windows,
+              const std::vector<size_t>& indices) {
+    static const Op& allgather_op = Op::Get("raf.op._allgather");
+    static const Op& group_allgather_op = Op::Get("raf.op._group_allgather");
+    static const Op& zeros_op = Op::Get("raf.op.zeros");
+    static const Op& slice_op = Op::Get("raf.op.strided_slice");
+    auto axis = MakeConstant(ScalarValue::make(0));
+    std::vector<Var> gathered;
+    if (indices.size() == 1) {
+      auto shard = shards_.at(windows->at(indices[0]).param.get());
+      gathered.push_back(MakeVar("gathered", {}));
+      ell->Push(gathered.back(), Call(allgather_op, {shard, axis, MakeNull()}));
+    } else {
+      auto device = "cuda(" + std::to_string(GetGlobalCommunicator()->local_rank) + ")";
+      Array<Expr> inputs, outputs;
+      for (auto w : indices) {
+        const auto& param = windows->at(w).param;
+        auto ttype = param->checked_type().as<TensorTypeNode>();
+        Array<PrimExpr> shape = ttype->shape;
+        shape.Set(0, Integer(part_dim0_.at(param.get()) * n_part_));
+        auto zeros = MakeVar("gather_out", {});
+        ell->Push(zeros, Call(zeros_op, {MakeConstant(ArrayToIntTuple(shape)),
+                                         MakeConstant(StringValue::make(
+                                             DLDataType2String(ttype->dtype))),
+                                         MakeConstant(StringValue::make(device))}));
+        inputs.push_back(shards_.at(param.get()));
+        outputs.push_back(zeros);
+      }
+      auto input_tuple = MakeVar("gather_in", {});
+      auto output_tuple = MakeVar("gather_outs", {});
+      auto group = MakeVar("group_gathered", {});
+      ell->Push(input_tuple, Tuple(inputs));
+      ell->Push(output_tuple, Tuple(outputs));
+      ell->Push(group, Call(group_allgather_op, {input_tuple, axis, output_tuple}));
+      for (size_t j = 0; j < indices.size(); ++j) {
+        gathered.push_back(MakeVar("gathered", {}));
+        ell->Push(gathered.back(), TupleGetItem(group, j));
+      }
+    }
+    for (size_t j = 0; j < indices.size(); ++j) {
+      auto& window = windows->at(indices[j]);
+      int64_t dim0 = dim0_.at(window.param.get());
+      window.gathered = gathered[j];
+      if (dim0 % n_part_ != 0) {
+        window.gathered = MakeVar("gathered", {});
+        ell->Push(window.gathered,
+                  Call(slice_op,
+                       {gathered[j], MakeConstant(TupleValue::make({ScalarValue::make(0)})),
+                        MakeConstant(TupleValue::make({ScalarValue::make(dim0)})),
+                        MakeConstant(TupleValue::make({ScalarValue::make(1)}))}));
+      }
+    }
+  }
+
+  /*! \brief The target function. */
+  Function func_;
+  /*! \brief The number of partitions. */
+  int n_part_;
+  /*! \brief The number of layers to issue the allgathers ahead. */
+  int prefetch_depth_;
+  /*! \brief Mapping from a parameter to its partition. */
+  std::unordered_map<const Object*, Var> shards_;
+  /*! \brief The length of the first axis of each parameter, and of its partition. */
+  std::unordered_map<const Object*, int64_t> dim0_;
+  std::unordered_map<const Object*, int64_t> part_dim0_;
+};
+
+}  // namespace partition_parameter
+
+Pass PartitionParameter(Array<Var> params, int n_part, int prefetch_depth) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return partition_parameter::ParameterPartitioner(f, params, n_part, prefetch_depth).Run();
+  };
+  auto partition_parameter = CreateRAFFunctionPass(pass_func, 0, "PartitionParameterFunc", {});
+  return RAFSequential({partition_parameter, InferType()}, "PartitionParameter");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PartitionParameter").set_body_typed(PartitionParameter);
+
+}  // namespace pass
+}  // namespace raf
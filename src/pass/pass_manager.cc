@@ -8,10 +8,26 @@
  * \brief Infrastructure for transformation passes.
  */
 #include <tvm/node/repr_printer.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "raf/file.h"
+#include "raf/metrics.h"
 #include "raf/pass.h"
 #include "raf/pass_manager.h"
+#include "raf/pass_profiler.h"
 #include "raf/registry.h"
 
 namespace raf {
@@ -108,6 +124,12 @@ std::string DumpAfterPassIRToFile(std::string dump_ir_path, const IRModule& mod,
   return dump_ir_path;
 }
 
+/*!
+ * \brief Run a pass in the scope of its record, except for a sequential or a cached pass, which
+ * records itself.
+ */
+IRModule RunPass(const Pass& pass, IRModule mod, const PassContext& pass_ctx);
+
 // TODO(zhiics): we currenlty only sequentially execute each pass in
 // a RAFSequential without the consideration of their orders. The phase
 // ordering problem needs to be handled in the future.
@@ -128,6 +150,10 @@ IRModule RAFSequentialNode::operator()(IRModule mod, const PassContext& pass_ctx
     DumpAfterPassIRToFile(dump_ir_path, mod, 0, "init");
   }
 
+  pass_profiler::PassProfiler::Scope seq_scope(pass_info->name, mod);
+  auto run = [&pass_ctx](const Pass& pass, IRModule mod) {
+    return RunPass(pass, std::move(mod), pass_ctx);
+  };
   size_t pass_cnt = 1;
   for (const Pass& pass : passes) {
     ICHECK(pass.defined()) << "Found undefined pass for optimization.";
@@ -135,16 +161,406 @@ IRModule RAFSequentialNode::operator()(IRModule mod, const PassContext& pass_ctx
     if (!pass_ctx.PassEnabled(pass_info)) continue;
     // resolve dependencies
     for (const auto& it : pass_info->required) {
-      mod = GetPass(it)(std::move(mod), pass_ctx);
+      mod = run(GetPass(it), std::move(mod));
     }
-    mod = pass(std::move(mod), pass_ctx);
+    mod = run(pass, std::move(mod));
     DumpAfterPassIRToFile(dump_ir_path, mod, pass_cnt++, pass_info->name);
   }
+  seq_scope.SetResult(mod);
   return mod;
 }
 
 RAF_REGISTER_OBJECT_REFLECT(RAFSequentialNode);
 
+/*! \brief Collect the vars and the global vars of a module in a deterministic order. */
+class VarCollector : public ExprVisitor {
+ public:
+  explicit VarCollector(const IRModule& mod) {
+    auto all_gvars = mod->GetGlobalVars();
+    gvars.assign(all_gvars.begin(), all_gvars.end());
+    std::sort(gvars.begin(), gvars.end(), [](const GlobalVar& lhs, const GlobalVar& rhs) {
+      return lhs->name_hint < rhs->name_hint;
+    });
+    for (const auto& gvar : gvars) {
+      if (const auto* func = mod->Lookup(gvar).as<FunctionNode>()) {
+        VisitExpr(GetRef<Function>(func));
+      }
+    }
+  }
+
+  void VisitExpr_(const VarNode* op) final {
+    vars.push_back(GetRef<Var>(op));
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    auto pre_visit = [this](const LetNode* op) {
+      this->VisitExpr(op->var);
+      this->VisitExpr(op->value);
+    };
+    auto post_visit = [this](const LetNode* op) { this->VisitExpr(op->body); };
+    ExpandANormalForm(op, pre_visit, post_visit);
+  }
+
+  std::vector<GlobalVar> gvars;
+  std::vector<Var> vars;
+};
+
+/*!
+ * \brief Replace the vars and the global vars of a cached result with the ones of the module the
+ * pass is applied to, which are matched by their orders in the structurally equal inputs.
+ */
+class VarRemapper : public ExprMutator {
+ public:
+  /*!
+   * \brief Match the vars of the cached input and the new input.
+   * \return Whether every var is matched to one var.
+   */
+  bool Match(const IRModule& from, const IRModule& to) {
+    VarCollector lhs(from), rhs(to);
+    if (lhs.vars.size() != rhs.vars.size() || lhs.gvars.size() != rhs.gvars.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < lhs.gvars.size(); ++i) {
+      gvar_map_[lhs.gvars[i].get()] = rhs.gvars[i];
+    }
+    for (size_t i = 0; i < lhs.vars.size(); ++i) {
+      auto it = var_map_.emplace(lhs.vars[i].get(), rhs.vars[i]).first;
+      if (!it->second.same_as(rhs.vars[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  IRModule Remap(const IRModule& mod) {
+    IRModule ret(Map<GlobalVar, BaseFunc>(), mod->type_definitions, mod->Imports(),
+                 mod->source_map);
+    for (const auto& kv : mod->functions) {
+      GlobalVar gvar = Downcast<GlobalVar>(VisitExpr(kv.first));
+      if (kv.second.as<FunctionNode>()) {
+        ret->Add(gvar, Downcast<Function>(VisitExpr(Downcast<Function>(kv.second))), true);
+      } else {
+        ret->Add(gvar, kv.second, true);
+      }
+    }
+    return ret;
+  }
+
+  Expr VisitExpr(const Expr& expr) final {
+    auto ret = ExprMutator::VisitExpr(expr);
+    ret->checked_type_ = expr->checked_type_;
+    return ret;
+  }
+
+  Expr VisitExpr_(const VarNode* op) final {
+    auto it = var_map_.find(op);
+    return it != var_map_.end() ? it->second : GetRef<Var>(op);
+  }
+
+  Expr VisitExpr_(const GlobalVarNode* op) final {
+    auto it = gvar_map_.find(op);
+    return it != gvar_map_.end() ? it->second : GetRef<GlobalVar>(op);
+  }
+
+  Expr VisitExpr_(const LetNode* op) final {
+    auto pre_visit = [this](const LetNode* op) {
+      this->VisitExpr(op->var);
+      this->VisitExpr(op->value);
+    };
+    auto post_visit = [this](const LetNode* op) {
+      Var var = Downcast<Var>(this->VisitExpr(op->var));
+      Expr value = this->VisitExpr(op->value);
+      Expr body = this->VisitExpr(op->body);
+      this->memo_[GetRef<Expr>(op)] = Let(var, value, body);
+    };
+    ExpandANormalForm(op, pre_visit, post_visit);
+    return memo_[GetRef<Expr>(op)];
+  }
+
+ private:
+  std::unordered_map<const Object*, Var> var_map_;
+  std::unordered_map<const Object*, GlobalVar> gvar_map_;
+};
+
+/*!
+ * \brief The results of the cached passes, which are looked up by the structural hash of the
+ * input module and verified by the structural equality. A cached result is returned with the
+ * vars of the module the pass is applied to, so it can be used as if the pass ran on the module.
+ */
+class PassResultCache {
+ public:
+  static PassResultCache* Get() {
+    static PassResultCache* inst = new PassResultCache();
+    return inst;
+  }
+
+  /*! \brief The maximum number of the cached results, where 0 disables the cache. */
+  size_t Capacity() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return capacity_;
+  }
+
+  void SetCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mu_);
+    capacity_ = capacity;
+    Shrink();
+  }
+
+  bool Get(size_t hash, const std::string& fingerprint, const IRModule& mod, IRModule* result) {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->hash != hash || it->fingerprint != fingerprint ||
+          !tvm::StructuralEqual()(it->input, mod)) {
+        continue;
+      }
+      VarRemapper remapper;
+      if (!remapper.Match(it->input, mod)) {
+        continue;
+      }
+      *result = remapper.Remap(it->output);
+      // Move to the most recently used end.
+      entries_.splice(entries_.begin(), entries_, it);
+      return true;
+    }
+    return false;
+  }
+
+  void Set(size_t hash, const std::string& fingerprint, const IRModule& mod,
+           const IRModule& result) {
+    std::lock_guard<std::mutex> lock(mu_);
+    // The modules are shallow copied, because a module may be updated in place by its user.
+    entries_.push_front({hash, fingerprint, Copy(mod), Copy(result)});
+    Shrink();
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    entries_.clear();
+  }
+
+ private:
+  PassResultCache() {
+    const char* capacity = getenv("RAF_PASS_CACHE_SIZE");
+    capacity_ = capacity != nullptr ? std::stoul(capacity) : 0;
+  }
+
+  struct Entry {
+    size_t hash;
+    std::string fingerprint;
+    IRModule input;
+    IRModule output;
+  };
+
+  static IRModule Copy(const IRModule& mod) {
+    return IRModule(mod->functions, mod->type_definitions, mod->Imports(), mod->source_map);
+  }
+
+  void Shrink() {
+    while (entries_.size() > capacity_) {
+      entries_.pop_back();
+    }
+  }
+
+  /*! \brief The entries from the most recently used one. */
+  std::list<Entry> entries_;
+  size_t capacity_;
+  std::mutex mu_;
+};
+
+/*!
+ * \brief A pass whose results are memoized across the compilations. The result is reused when
+ * the input module is structurally equal, and the key of the pass, the optimization level, the
+ * required and disabled passes, and the configs read by the pass are the same.
+ */
+class RAFCachedPassNode : public PassNode {
+ public:
+  /*! \brief The pass to be cached, which must be deterministic. */
+  Pass pass;
+  /*! \brief The key of the parameters the pass is created with. */
+  String key;
+  /*! \brief The configs of the pass context read by the pass. */
+  tvm::Array<String> config_keys;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("pass", &pass);
+    v->Visit("key", &key);
+    v->Visit("config_keys", &config_keys);
+  }
+
+  PassInfo Info() const override {
+    return pass->Info();
+  }
+
+  IRModule operator()(IRModule mod, const PassContext& pass_ctx) const final;
+
+  static constexpr const char* _type_key = "raf.pass_.RAFCachedPass";
+  RAF_FINAL_OBJECT(RAFCachedPassNode, PassNode);
+
+ private:
+  std::string Fingerprint(const PassContext& pass_ctx) const;
+};
+
+/*!
+ * \brief The normal forms of the functions. The table holds the functions, so a node is not reused
+ * by another function while its form is recorded, and drops the earliest recorded functions beyond
+ * its capacity.
+ */
+class NormalFormTable {
+ public:
+  static NormalFormTable* Get() {
+    static NormalFormTable* inst = new NormalFormTable();
+    return inst;
+  }
+
+  /*! \brief Get the recorded form of a function, or an empty string if it is unknown. */
+  std::string Lookup(const Function& func) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = forms_.find(func);
+    return it != forms_.end() ? it->second : "";
+  }
+
+  void Set(const Function& func, const std::string& form) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = forms_.find(func);
+    if (it != forms_.end()) {
+      it->second = form;
+      return;
+    }
+    forms_.emplace(func, form);
+    order_.push_back(func);
+    while (order_.size() > kCapacity) {
+      forms_.erase(order_.front());
+      order_.pop_front();
+    }
+  }
+
+ private:
+  static constexpr size_t kCapacity = 4096;
+  std::unordered_map<Function, std::string, ObjectPtrHash, ObjectPtrEqual> forms_;
+  /*! \brief The functions in the order they are recorded. */
+  std::list<Function> order_;
+  std::mutex mu_;
+};
+
+bool InNormalForm(const Function& func, const std::string& form) {
+  std::string recorded = NormalFormTable::Get()->Lookup(func);
+  return recorded == form || (form == normal_form::kBBNF && recorded == normal_form::kANF);
+}
+
+void SetNormalForm(const Function& func, const std::string& form) {
+  NormalFormTable::Get()->Set(func, form);
+}
+
+/*!
+ * \brief Whether a pass only updates the types of the functions, so the rewritten functions are in
+ * the forms of their inputs.
+ */
+bool KeepsNormalForm(const PassInfo& pass_info) {
+  static const std::unordered_set<std::string> passes = {"InferType", "EraseType"};
+  return passes.count(pass_info->name);
+}
+
+/*! \brief Record the forms of the input functions for the functions rewritten from them. */
+void KeepNormalForms(const Map<GlobalVar, BaseFunc>& inputs, const IRModule& mod) {
+  std::unordered_map<std::string, Function> input_funcs;
+  for (const auto& it : inputs) {
+    if (const auto* func = it.second.as<FunctionNode>()) {
+      input_funcs[it.first->name_hint] = GetRef<Function>(func);
+    }
+  }
+  for (const auto& it : mod->functions) {
+    const auto* func = it.second.as<FunctionNode>();
+    auto input = input_funcs.find(it.first->name_hint);
+    if (func == nullptr || input == input_funcs.end() || input->second.get() == func) {
+      continue;
+    }
+    std::string form = NormalFormTable::Get()->Lookup(input->second);
+    if (!form.empty()) {
+      SetNormalForm(GetRef<Function>(func), form);
+    }
+  }
+}
+
+IRModule RunPass(const Pass& pass, IRModule mod, const PassContext& pass_ctx) {
+  // The functions of the module, which are copied on write if the pass updates the module in place.
+  Map<GlobalVar, BaseFunc> inputs;
+  bool keeps_form = KeepsNormalForm(pass->Info());
+  if (keeps_form) {
+    inputs = mod->functions;
+  }
+  if (pass->IsInstance<RAFSequentialNode>() || pass->IsInstance<RAFCachedPassNode>()) {
+    mod = pass(std::move(mod), pass_ctx);
+  } else {
+    pass_profiler::PassProfiler::Scope scope(pass->Info()->name, mod);
+    mod = pass(std::move(mod), pass_ctx);
+    scope.SetResult(mod);
+  }
+  if (keeps_form) {
+    KeepNormalForms(inputs, mod);
+  }
+  return mod;
+}
+
+std::string RAFCachedPassNode::Fingerprint(const PassContext& pass_ctx) const {
+  std::ostringstream os;
+  os << Info()->name << "(" << key << ")";
+  os << ";opt_level=" << pass_ctx->opt_level << ";required=" << pass_ctx->required_pass
+     << ";disabled=" << pass_ctx->disabled_pass;
+  for (const auto& config_key : config_keys) {
+    auto it = pass_ctx->config.find(config_key);
+    os << ";" << config_key << "=";
+    if (it != pass_ctx->config.end()) {
+      os << (*it).second;
+    }
+  }
+  return os.str();
+}
+
+IRModule RAFCachedPassNode::operator()(IRModule mod, const PassContext& pass_ctx) const {
+  auto cache = PassResultCache::Get();
+  if (cache->Capacity() == 0) {
+    return RunPass(pass, std::move(mod), pass_ctx);
+  }
+  static auto* hits = metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_pass_cache_total", "The lookups of the pass result cache.", {{"result", "hit"}});
+  static auto* misses = metrics::MetricsRegistry::Get()->GetCounter(
+      "raf_pass_cache_total", "The lookups of the pass result cache.", {{"result", "miss"}});
+  size_t hash = tvm::StructuralHash()(mod);
+  std::string fingerprint = Fingerprint(pass_ctx);
+  IRModule result;
+  if (cache->Get(hash, fingerprint, mod, &result)) {
+    hits->Add();
+    pass_profiler::PassProfiler::Scope scope(Info()->name, mod);
+    scope.SetResult(result);
+    return result;
+  }
+  misses->Add();
+  result = RunPass(pass, mod, pass_ctx);
+  cache->Set(hash, fingerprint, mod, result);
+  return result;
+}
+
+Pass CachedPass(Pass pass, String key, tvm::Array<String> config_keys) {
+  auto n = make_object<RAFCachedPassNode>();
+  n->pass = std::move(pass);
+  n->key = std::move(key);
+  n->config_keys = std::move(config_keys);
+  return Pass(n);
+}
+
+RAF_REGISTER_OBJECT_REFLECT(RAFCachedPassNode);
+
+RAF_REGISTER_GLOBAL("raf.pass_.CachedPass").set_body_typed(CachedPass);
+RAF_REGISTER_GLOBAL("raf.pass_.ClearPassCache").set_body_typed([]() {
+  PassResultCache::Get()->Clear();
+});
+RAF_REGISTER_GLOBAL("raf.pass_.SetPassCacheSize").set_body_typed([](int64_t capacity) {
+  PassResultCache::Get()->SetCapacity(capacity);
+});
+RAF_REGISTER_GLOBAL("raf.pass_.GetNormalForm").set_body_typed([](Function func) {
+  return String(NormalFormTable::Get()->Lookup(func));
+});
+
 class RAFFunctionPass;
 
 /*!
@@ -168,6 +584,9 @@ class RAFFunctionPassNode : public PassNode {
    */
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func;
 
+  /*! \brief Whether the functions can be transformed concurrently. */
+  bool parallel = false;
+
   RAFFunctionPassNode() = default;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
@@ -213,19 +632,23 @@ class RAFFunctionPass : public Pass {
    * \param pass_info The pass info.
    */
   RAFFunctionPass(TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func,
-                  PassInfo pass_info);
+                  PassInfo pass_info, bool parallel = false);
 
   RAF_OBJECT_REF(RAFFunctionPass, Pass, RAFFunctionPassNode);
 };
 
 RAFFunctionPass::RAFFunctionPass(
-    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info) {
+    TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func, PassInfo pass_info,
+    bool parallel) {
   auto n = make_object<RAFFunctionPassNode>();
   n->pass_func = std::move(pass_func);
   n->pass_info = std::move(pass_info);
+  n->parallel = parallel;
   data_ = std::move(n);
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.function_pass.num_threads", Integer);
+
 // Perform Module -> Module optimizations at the Function level.
 IRModule RAFFunctionPassNode::operator()(IRModule mod, const PassContext& pass_ctx) const {
   const PassInfo& pass_info = Info();
@@ -243,9 +666,54 @@ IRModule RAFFunctionPassNode::operator()(IRModule mod, const PassContext& pass_c
   for (const auto& it : updated_mod->functions) {
     // only picks up relay::Function
     if (auto* n = it.second.as<FunctionNode>()) {
-      Function func = GetRef<Function>(n);
-      auto updated_func = SkipFunction(func) ? func : pass_func(func, updated_mod, pass_ctx);
-      updates.push_back({it.first, updated_func});
+      updates.push_back({it.first, GetRef<Function>(n)});
+    }
+  }
+
+  int num_threads = std::thread::hardware_concurrency();
+  num_threads = pass_ctx->GetConfig("raf.function_pass.num_threads", Integer(num_threads))
+                    .value()
+                    ->value;
+  num_threads = parallel ? std::min(num_threads, static_cast<int>(updates.size())) : 1;
+  if (num_threads <= 1) {
+    for (auto& update : updates) {
+      if (!SkipFunction(update.second)) {
+        update.second = pass_func(update.second, updated_mod, pass_ctx);
+      }
+    }
+  } else {
+    // The worker threads enter the pass context and the device of this thread, because they are
+    // thread local. The errors are raised in the order of the functions.
+    std::vector<std::exception_ptr> errors(updates.size());
+    std::atomic<size_t> next(0);
+    Device device = Device::Current(true);
+    auto worker = [&]() {
+      tvm::With<PassContext> ctx_scope(pass_ctx);
+      std::unique_ptr<tvm::With<Device>> device_scope;
+      if (device.device_type() != DevType::kUnknown()) {
+        device_scope = std::make_unique<tvm::With<Device>>(device);
+      }
+      for (size_t i = next++; i < updates.size(); i = next++) {
+        try {
+          if (!SkipFunction(updates[i].second)) {
+            updates[i].second = pass_func(updates[i].second, updated_mod, pass_ctx);
+          }
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
     }
   }
 
@@ -263,9 +731,9 @@ bool RAFFunctionPassNode::SkipFunction(const Function& func) const {
 
 Pass CreateRAFFunctionPass(
     const TypedPackedFunc<Function(Function, IRModule, PassContext)>& pass_func, int opt_level,
-    String name, tvm::Array<String> required) {
+    String name, tvm::Array<String> required, bool parallel) {
   PassInfo pass_info = PassInfo(opt_level, name, required);
-  return RAFFunctionPass(pass_func, pass_info);
+  return RAFFunctionPass(pass_func, pass_info, parallel);
 }
 
 RAF_REGISTER_OBJECT_REFLECT(RAFFunctionPassNode);
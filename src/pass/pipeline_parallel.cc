@@ -0,0 +1,613 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file pipeline_parallel.cc
+ * \brief Given a model after AutoDiff and InlineBackward, this pass partitions the model into
+ * pipeline stages (one stage per rank), splits the batch into micro-batches, and generates the
+ * program of the given stage. The program runs the forward and backward of the stage for each
+ * micro-batch in the 1F1B order, and sends/receives the tensors crossing the stage boundaries.
+ */
+#include <algorithm>
+#include <array>
+#include <map>
+#include <set>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+
+#include "./common.h"
+#include "./let_list.h"
+#include "./estimate_flops.h"
+
+namespace raf {
+namespace pass {
+namespace pipeline_parallel {
+
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief The phase of a binding, which is forward if the forward output depends on it. */
+enum Phase { kForward = 0, kBackward = 1 };
+
+/*! \brief An item of the program of a stage. */
+struct Item {
+  enum Kind { kUnit, kSend, kRecv };
+  Kind kind;
+  /*! \brief The phase of a unit, or the binding of the tensor to be sent or received. */
+  size_t index;
+  /*! \brief The micro-batch. */
+  int micro_batch;
+  /*! \brief The peer stage of send and recv. */
+  int peer;
+};
+
+class PipelineScheduler {
+ public:
+  PipelineScheduler(const Function& func, const IRModule& mod, int num_stages, int stage,
+                    int num_micro_batches, const Array<Var>& batch_inputs)
+      : func_(func),
+        mod_(mod),
+        num_stages_(num_stages),
+        stage_(stage),
+        num_micro_batches_(num_micro_batches),
+        ell_(ExplicitLetList::make(func->body)) {
+    for (const auto& var : batch_inputs) {
+      batch_inputs_.insert(var.get());
+    }
+  }
+
+  /*!
+   * \brief Generate the program of this stage:
+   *
+   * 1. The forward bindings are partitioned into contiguous stages with balanced FLOPS (or the
+   *    number of calls if the target device is unknown). A backward binding is assigned to the
+   *    lowest stage of its operands, which keeps the backward dataflow going from the later stages
+   *    to the earlier ones, e.g., the gradients of a layer are computed with its activations.
+   *
+   * 2. Each stage runs the forward (F) and backward (B) of its bindings for each micro-batch in
+   *    the 1F1B order, i.e., stage s runs min(#stages - s - 1, #micro-batches) forwards first, and
+   *    then alternates between one backward and one forward, so at most #stages - s micro-batches
+   *    keep their activations alive.
+   *
+   * 3. The order of all send/recv pairs is decided by simulating the programs of all stages, where
+   *    a tensor is sent right before its receiver needs it. All stages thus agree on the order of
+   *    the send/recv between each pair of stages, which are chained by their tokens.
+   *
+   * The batch inputs are split into micro-batches along the first axis. The gradients of the
+   * micro-batches are accumulated, and the forward output is the sum of the micro-batch outputs
+   * if it is a scalar (e.g., the loss), or their concatenation otherwise. Only the stage computing
+   * a gradient returns it, and the others return NoGrad instead.
+   */
+  Function Run() {
+    Init();
+    AssignStages();
+    auto programs = Simulate();
+    return Generate(programs[stage_]);
+  }
+
+ private:
+  /*! \brief Get the vars referred by an expression. */
+  static std::vector<Var> Operands(const Expr& expr) {
+    std::vector<Var> operands;
+    auto push = [&operands](const Expr& e) {
+      if (auto var = e.as<VarNode>()) {
+        operands.push_back(GetRef<Var>(var));
+      }
+    };
+    if (auto call = expr.as<CallNode>()) {
+      auto fn = call->op.as<FunctionNode>();
+      CHECK(!call->op.as<VarNode>() && (!fn || fn->HasNonzeroAttr(attr::kPrimitive)))
+          << "PipelineParallel does not support closures";
+      for (const auto& arg : call->args) {
+        push(arg);
+      }
+    } else if (auto tuple = expr.as<TupleNode>()) {
+      for (const auto& field : tuple->fields) {
+        push(field);
+      }
+    } else if (auto tgi = expr.as<TupleGetItemNode>()) {
+      push(tgi->tuple);
+    } else if (expr.as<VarNode>()) {
+      push(expr);
+    } else if (!expr.as<ConstantNode>() && !expr.as<OpNode>()) {
+      LOG(FATAL) << "PipelineParallel does not support " << expr->GetTypeKey();
+    }
+    return operands;
+  }
+
+  /*! \brief Build the dependencies and the phase of each binding. */
+  void Init() {
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    size_t n = vars.size();
+    for (size_t i = 0; i < func_->params.size(); ++i) {
+      param_index_[func_->params[i].get()] = i;
+    }
+    needs_.resize(n);
+    param_needs_.resize(n);
+    is_free_.resize(n, false);
+    for (size_t i = 0; i < n; ++i) {
+      // Tuples, aliases and constants do not compute, so they are emitted by every stage using
+      // them, and the bindings they refer to are needed instead. The same applies to the
+      // TupleGetItems of them.
+      const auto& expr = exprs[i];
+      if (auto tgi = expr.as<TupleGetItemNode>()) {
+        auto it = index_of_.find(tgi->tuple.get());
+        is_free_[i] = it == index_of_.end() || is_free_[it->second];
+      } else {
+        is_free_[i] = !expr.as<CallNode>();
+      }
+      std::set<size_t> needs, param_needs;
+      for (const auto& operand : Operands(expr)) {
+        auto it = index_of_.find(operand.get());
+        if (it == index_of_.end()) {
+          CHECK(param_index_.count(operand.get())) << "Unbound variable " << operand;
+          param_needs.insert(param_index_[operand.get()]);
+        } else if (is_free_[it->second]) {
+          needs.insert(needs_[it->second].begin(), needs_[it->second].end());
+          param_needs.insert(param_needs_[it->second].begin(), param_needs_[it->second].end());
+        } else {
+          needs.insert(it->second);
+        }
+      }
+      needs_[i].assign(needs.begin(), needs.end());
+      param_needs_[i].assign(param_needs.begin(), param_needs.end());
+      index_of_[vars[i].get()] = i;
+    }
+
+    // Assume output is a tuple of (forward out, (grads, ...))
+    CHECK(index_of_.count(ell_->ret.get())) << "Expected the output to be a let-binding var";
+    size_t ret_index = index_of_[ell_->ret.get()];
+    auto ret = exprs[ret_index].as<TupleNode>();
+    CHECK(ret != nullptr && ret->fields.size() == 2U)
+        << "Expected the output tuple to be (out, (grad, ...)) with 2 fields";
+    is_output_.resize(n, false);
+    is_output_[ret_index] = true;
+
+    // Traverse back to find the gradient tuple.
+    Expr grads = ret->fields[1];
+    while (grads.as<VarNode>() && index_of_.count(grads.get())) {
+      size_t index = index_of_[grads.get()];
+      is_output_[index] = true;
+      grads = exprs[index];
+      if (auto tgi = grads.as<TupleGetItemNode>()) {
+        auto tuple = exprs[index_of_.at(tgi->tuple.get())].as<TupleNode>();
+        CHECK(tuple != nullptr) << "Expected a tuple, but got " << tgi->tuple;
+        grads = tuple->fields[tgi->index];
+      }
+    }
+    auto grad_tuple = grads.as<TupleNode>();
+    CHECK(grad_tuple != nullptr) << "Expected the gradients to be a tuple, but got "
+                                 << grads->GetTypeKey();
+    grad_fields_ = grad_tuple->fields;
+
+    // The forward bindings are the ones the forward output depends on.
+    y_index_ = ResolveAlias(ret->fields[0]);
+    CHECK_GE(y_index_, 0) << "Expected the forward output to be computed by the model";
+    CHECK(vars[y_index_]->checked_type_.defined()) << "Please run InferType first";
+    CHECK(vars[y_index_]->checked_type().as<TensorTypeNode>())
+        << "Expected the forward output to be a tensor, but got "
+        << vars[y_index_]->checked_type();
+    phase_.resize(n, kBackward);
+    phase_[y_index_] = kForward;
+    for (int i = y_index_; i >= 0; --i) {
+      if (phase_[i] == kForward) {
+        for (auto operand : Operands(exprs[i])) {
+          auto it = index_of_.find(operand.get());
+          if (it != index_of_.end()) {
+            phase_[it->second] = kForward;
+          }
+        }
+      }
+    }
+  }
+
+  /*! \brief Get the binding computing the given expression through aliases, or -1 if none. */
+  int ResolveAlias(const Expr& expr) {
+    Expr curr = expr;
+    while (curr.as<VarNode>() && index_of_.count(curr.get())) {
+      size_t index = index_of_[curr.get()];
+      if (!is_free_[index]) {
+        return index;
+      }
+      curr = ell_->exprs[index];
+    }
+    return -1;
+  }
+
+  /*! \brief Assign the stage of each binding that computes. */
+  void AssignStages() {
+    const auto& vars = ell_->vars;
+    size_t n = vars.size();
+    auto device = Device::Current();
+    estimate_flops::StdMap<float> flops;
+    if (device.device_type() != DevType::kUnknown() || device.device_id() != -1) {
+      flops = estimate_flops::FLOPSEstimater().Run(device, func_, mod_);
+    }
+    std::vector<double> cost(n, 0);
+    double total = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (phase_[i] == kForward && !is_free_[i]) {
+        auto it = flops.find(vars[i]);
+        cost[i] = it != flops.end() ? std::max(it->second, 0.0f) : 0;
+        total += cost[i];
+      }
+    }
+    if (total == 0) {
+      for (size_t i = 0; i < n; ++i) {
+        cost[i] = phase_[i] == kForward && !is_free_[i] ? 1 : 0;
+        total += cost[i];
+      }
+    }
+
+    stage_of_.resize(n, -1);
+    std::vector<int> param_stage(func_->params.size(), num_stages_);
+    double prefix = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (phase_[i] != kForward || is_free_[i]) {
+        continue;
+      }
+      // The stage of a binding is decided by the middle of its cost.
+      int stage = static_cast<int>((prefix + cost[i] / 2) * num_stages_ / total);
+      stage_of_[i] = std::min(stage, num_stages_ - 1);
+      prefix += cost[i];
+      for (auto p : param_needs_[i]) {
+        param_stage[p] = std::min(param_stage[p], stage_of_[i]);
+      }
+    }
+    for (size_t i = 0; i < n; ++i) {
+      if (phase_[i] != kBackward || is_free_[i] || is_output_[i]) {
+        continue;
+      }
+      int stage = num_stages_ - 1;
+      for (auto j : needs_[i]) {
+        stage = std::min(stage, stage_of_[j]);
+      }
+      for (auto p : param_needs_[i]) {
+        stage = std::min(stage, param_stage[p]);
+      }
+      stage_of_[i] = stage;
+    }
+  }
+
+  /*! \brief The 1F1B order of the (phase, micro-batch) units of a stage. */
+  std::vector<std::pair<Phase, int>> UnitOrder(int stage) {
+    std::vector<std::pair<Phase, int>> order;
+    int num_warmup = std::min(num_stages_ - stage - 1, num_micro_batches_);
+    for (int m = 0; m < num_warmup; ++m) {
+      order.emplace_back(kForward, m);
+    }
+    for (int m = 0; m < num_micro_batches_ - num_warmup; ++m) {
+      order.emplace_back(kForward, m + num_warmup);
+      order.emplace_back(kBackward, m);
+    }
+    for (int m = num_micro_batches_ - num_warmup; m < num_micro_batches_; ++m) {
+      order.emplace_back(kBackward, m);
+    }
+    return order;
+  }
+
+  /*! \brief Simulate the units of all stages to generate their programs. */
+  std::vector<std::vector<Item>> Simulate() {
+    size_t n = ell_->vars.size();
+    // The bindings of other stages needed by each (stage, phase).
+    std::vector<std::array<std::set<size_t>, 2>> recvs(num_stages_);
+    for (size_t i = 0; i < n; ++i) {
+      if (stage_of_[i] == -1) {
+        continue;
+      }
+      for (auto j : needs_[i]) {
+        if (stage_of_[j] != stage_of_[i]) {
+          recvs[stage_of_[i]][phase_[i]].insert(j);
+        }
+      }
+    }
+    for (auto& it : recvs) {
+      // The tensors received by the forward of a micro-batch are reused by its backward.
+      for (auto j : it[kForward]) {
+        it[kBackward].erase(j);
+      }
+    }
+
+    std::vector<std::vector<Item>> programs(num_stages_);
+    std::vector<std::vector<std::pair<Phase, int>>> orders;
+    std::vector<std::array<std::vector<bool>, 2>> done(num_stages_);
+    for (int s = 0; s < num_stages_; ++s) {
+      orders.push_back(UnitOrder(s));
+      done[s][kForward].resize(num_micro_batches_, false);
+      done[s][kBackward].resize(num_micro_batches_, false);
+    }
+    std::vector<size_t> pos(num_stages_, 0);
+    size_t num_remaining = num_stages_ * num_micro_batches_ * 2;
+    while (num_remaining > 0) {
+      bool progress = false;
+      for (int s = 0; s < num_stages_; ++s) {
+        if (pos[s] == orders[s].size()) {
+          continue;
+        }
+        Phase phase = orders[s][pos[s]].first;
+        int m = orders[s][pos[s]].second;
+        const auto& needs = recvs[s][phase];
+        bool ready = std::all_of(needs.begin(), needs.end(), [&](size_t j) {
+          return done[stage_of_[j]][phase_[j]][m];
+        });
+        if (!ready) {
+          continue;
+        }
+        for (auto j : needs) {
+          programs[stage_of_[j]].push_back({Item::kSend, j, m, s});
+          programs[s].push_back({Item::kRecv, j, m, stage_of_[j]});
+        }
+        programs[s].push_back({Item::kUnit, static_cast<size_t>(phase), m, -1});
+        done[s][phase][m] = true;
+        pos[s]++;
+        num_remaining--;
+        progress = true;
+      }
+      CHECK(progress) << "Internal error: the pipeline schedule has a deadlock";
+    }
+    return programs;
+  }
+
+  /*! \brief Push a binding to the generated program. */
+  Var Push(const std::string& name, const Expr& expr, const Var& may_share = {}) {
+    auto var = MakeVar(name, {}, may_share);
+    out_ell_.Push(var, expr);
+    return var;
+  }
+
+  /*! \brief Get a function parameter for the given micro-batch. */
+  Expr GetParam(const Var& param, int m) {
+    if (num_micro_batches_ == 1 || !batch_inputs_.count(param.get())) {
+      return param;
+    }
+    auto key = std::make_pair(param.get(), m);
+    if (!slices_.count(key)) {
+      static const Op& split_op = Op::Get("raf.op.split");
+      auto ttype = param->checked_type().as<TensorTypeNode>();
+      CHECK(ttype && !ttype->shape.empty()) << "The batch input " << param->name_hint()
+                                            << " must be a tensor with at least one dimension";
+      auto batch_size = ttype->shape[0].as<IntImmNode>();
+      CHECK(batch_size && batch_size->value % num_micro_batches_ == 0)
+          << "The batch size of " << param->name_hint() << " is not divisible by "
+          << num_micro_batches_ << " micro-batches";
+      auto split = Push(param->name_hint() + "_split",
+                        Call(split_op, {param, MakeConstant(ScalarValue::make(num_micro_batches_)),
+                                        MakeConstant(ScalarValue::make(0))}));
+      for (int i = 0; i < num_micro_batches_; ++i) {
+        slices_[{param.get(), i}] =
+            Push(param->name_hint() + "_mb" + std::to_string(i), TupleGetItem(split, i));
+      }
+    }
+    return slices_.at(key);
+  }
+
+  /*! \brief Replace the var referred by the original program with the one of the micro-batch. */
+  Expr Remap(const Expr& expr, int m) {
+    auto it = index_of_.find(expr.get());
+    if (it != index_of_.end()) {
+      return GetClone(it->second, m);
+    }
+    if (param_index_.count(expr.get())) {
+      return GetParam(Downcast<Var>(expr), m);
+    }
+    return expr;
+  }
+
+  /*! \brief Get the var of a binding for the micro-batch, which is emitted if it is free. */
+  Var GetClone(size_t i, int m) {
+    auto it = clones_.find({i, m});
+    if (it != clones_.end()) {
+      return it->second;
+    }
+    CHECK(is_free_[i]) << "Internal error: " << ell_->vars[i]->name_hint() << " of micro-batch "
+                       << m << " is used before it is computed or received";
+    return Emit(i, m);
+  }
+
+  /*! \brief Emit a binding of the original program for the micro-batch. */
+  Var Emit(size_t i, int m) {
+    const auto& var = ell_->vars[i];
+    const auto& expr = ell_->exprs[i];
+    Expr new_expr;
+    if (auto call = expr.as<CallNode>()) {
+      Array<Expr> args;
+      for (const auto& arg : call->args) {
+        args.push_back(Remap(arg, m));
+      }
+      new_expr = Call(call->op, args, call->attrs, call->type_args);
+    } else if (auto tuple = expr.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const auto& field : tuple->fields) {
+        fields.push_back(Remap(field, m));
+      }
+      new_expr = Tuple(fields);
+    } else if (auto tgi = expr.as<TupleGetItemNode>()) {
+      new_expr = TupleGetItem(Remap(tgi->tuple, m), tgi->index);
+    } else {
+      new_expr = Remap(expr, m);
+    }
+    Var may_share;
+    auto ext_var = var.as<ExtendedVarNode>();
+    if (ext_var && ext_var->may_share.defined()) {
+      auto shared = Remap(ext_var->may_share, m);
+      if (shared.same_as(ext_var->may_share) || index_of_.count(ext_var->may_share.get())) {
+        may_share = Downcast<Var>(shared);
+      }
+    }
+    auto name = num_micro_batches_ > 1 ? var->name_hint() + "_mb" + std::to_string(m)
+                                       : var->name_hint();
+    auto new_var = Push(name, new_expr, may_share);
+    clones_[{i, m}] = new_var;
+    return new_var;
+  }
+
+  /*! \brief Sum up the vars of a binding over all micro-batches. */
+  Var Accumulate(size_t i) {
+    static const Op& add_op = Op::Get("raf.op.add");
+    Var acc = clones_.at({i, 0});
+    for (int m = 1; m < num_micro_batches_; ++m) {
+      acc = Push(ell_->vars[i]->name_hint() + "_acc",
+                 Call(add_op, {acc, clones_.at({i, m}), MakeNull(), MakeNull()}));
+    }
+    return acc;
+  }
+
+  /*! \brief Generate the function from the program of this stage. */
+  Function Generate(const std::vector<Item>& program) {
+    static const Op& send_op = Op::Get("raf.op._send");
+    static const Op& recv_op = Op::Get("raf.op._recv");
+    static const Op& add_op = Op::Get("raf.op.add");
+    static const Op& concat_op = Op::Get("raf.op.concatenate");
+    static const Op& zeros_op = Op::Get("raf.op.zeros");
+    static const Op& zeros_like_op = Op::Get("raf.op.zeros_like");
+    static const Op& cast_op = Op::Get("raf.op.cast");
+    const auto& vars = ell_->vars;
+    size_t n = vars.size();
+
+    // The token of the last send/recv, which orders the next one.
+    Expr token = MakeNull();
+    DataType token_dtype;
+    int num_sends = 0, num_recvs = 0;
+    for (const auto& item : program) {
+      int m = item.micro_batch;
+      if (item.kind == Item::kUnit) {
+        for (size_t i = 0; i < n; ++i) {
+          if (stage_of_[i] == stage_ && phase_[i] == static_cast<Phase>(item.index)) {
+            Emit(i, m);
+          }
+        }
+        continue;
+      }
+      auto ttype = vars[item.index]->checked_type().as<TensorTypeNode>();
+      CHECK(ttype != nullptr) << "Cannot send " << vars[item.index]->name_hint()
+                              << " across pipeline stages, which is not a tensor";
+      Expr peer = MakeConstant(ScalarValue::make(item.peer));
+      auto name = vars[item.index]->name_hint() + "_mb" + std::to_string(m);
+      if (item.kind == Item::kSend) {
+        token = Push(name + "_send", Call(send_op, {GetClone(item.index, m), peer, token}));
+        num_sends++;
+      } else {
+        auto recv = Push(name, Call(recv_op, {peer, MakeConstant(ArrayToIntTuple(ttype->shape)),
+                                              MakeConstant(StringValue::make(
+                                                  DLDataType2String(ttype->dtype))),
+                                              token}));
+        clones_[{item.index, m}] = recv;
+        token = recv;
+        num_recvs++;
+      }
+      token_dtype = ttype->dtype;
+    }
+
+    // The forward output, which is zero if it is computed by another stage.
+    auto y_type = Downcast<TensorType>(vars[y_index_]->checked_type());
+    auto y_dtype = MakeConstant(StringValue::make(DLDataType2String(y_type->dtype)));
+    Expr y;
+    if (stage_of_[y_index_] != stage_) {
+      y = Push("y", Call(zeros_op, {MakeConstant(ArrayToIntTuple(y_type->shape)), y_dtype}));
+    } else if (y_type->shape.empty()) {
+      y = Accumulate(y_index_);
+    } else if (num_micro_batches_ == 1) {
+      y = clones_.at({static_cast<size_t>(y_index_), 0});
+    } else {
+      Array<Expr> ys;
+      for (int m = 0; m < num_micro_batches_; ++m) {
+        ys.push_back(clones_.at({static_cast<size_t>(y_index_), m}));
+      }
+      auto tuple = Push("ys", Tuple(ys));
+      y = Push("y", Call(concat_op, {tuple, MakeConstant(ScalarValue::make(0))}));
+    }
+    if (num_sends + num_recvs > 0) {
+      // Make the output depend on the last send/recv, so the trailing sends are kept.
+      Expr zero = Push("token_zero", Call(zeros_like_op, {token}));
+      if (token_dtype != y_type->dtype) {
+        zero = Push("token_zero", Call(cast_op, {zero, y_dtype}));
+      }
+      y = Push("y", Call(add_op, {y, zero, MakeNull(), MakeNull()}));
+    }
+
+    // The accumulated gradients computed by this stage.
+    Array<Expr> grads;
+    for (const auto& field : grad_fields_) {
+      int index = ResolveAlias(field);
+      if (index == -1) {
+        CHECK(!index_of_.count(field.get()))
+            << "PipelineParallel does not support the gradient " << field;
+        grads.push_back(field);
+      } else if (stage_of_[index] == stage_) {
+        grads.push_back(Accumulate(index));
+      } else {
+        grads.push_back(MakeConstant(NoGradValue::make()));
+      }
+    }
+    auto grad_tuple = Push("grads", Tuple(grads));
+    out_ell_.ret = Push("ret", Tuple({y, grad_tuple}));
+    DLOG(INFO) << "Pipeline stage " << stage_ << " of " << num_stages_ << " has " << num_sends
+               << " sends and " << num_recvs << " recvs for " << num_micro_batches_
+               << " micro-batches";
+    return Function(func_->params, out_ell_.AsExpr(), {}, func_->type_params, func_->attrs);
+  }
+
+  /*! \brief The function to be partitioned. */
+  Function func_;
+  /*! \brief The IR module that the function belongs to. */
+  IRModule mod_;
+  /*! \brief The number of stages, the stage of this rank and the number of micro-batches. */
+  int num_stages_, stage_, num_micro_batches_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The function parameters to be split into micro-batches. */
+  std::unordered_set<const Object*> batch_inputs_;
+  /*! \brief Mapping from the let-binding vars and parameters to their indices. */
+  std::unordered_map<const Object*, size_t> index_of_, param_index_;
+  /*! \brief The computing bindings and the parameters each binding needs. */
+  std::vector<std::vector<size_t>> needs_, param_needs_;
+  /*! \brief Whether each binding does not compute, such as tuples, aliases and constants. */
+  std::vector<bool> is_free_;
+  /*! \brief Whether each binding only builds the output tuples. */
+  std::vector<bool> is_output_;
+  /*! \brief The phase and the stage (-1 if free) of each binding. */
+  std::vector<Phase> phase_;
+  std::vector<int> stage_of_;
+  /*! \brief The binding of the forward output. */
+  int y_index_ = -1;
+  /*! \brief The gradients returned by the original function. */
+  Array<Expr> grad_fields_;
+  /*! \brief The generated program. */
+  ExplicitLetList out_ell_;
+  /*! \brief The var of each (binding, micro-batch) in the generated program. */
+  std::map<std::pair<size_t, int>, Var> clones_;
+  /*! \brief The slice of each (batch input, micro-batch) in the generated program. */
+  std::map<std::pair<const Object*, int>, Var> slices_;
+};
+
+}  // namespace pipeline_parallel
+
+Pass PipelineParallel(int num_stages, int stage, int num_micro_batches,
+                      Array<Var> batch_inputs) {
+  CHECK_GT(num_stages, 0) << "The number of pipeline stages must be positive";
+  CHECK(stage >= 0 && stage < num_stages) << "Invalid pipeline stage " << stage;
+  CHECK_GT(num_micro_batches, 0) << "The number of micro-batches must be positive";
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    if (num_stages == 1 && num_micro_batches == 1) {
+      return f;
+    }
+    return pipeline_parallel::PipelineScheduler(f, m, num_stages, stage, num_micro_batches,
+                                                batch_inputs)
+        .Run();
+  };
+  auto pipeline_parallel = CreateRAFFunctionPass(pass_func, 0, "PipelineParallelFunc", {});
+  return RAFSequential({pipeline_parallel, EraseType(), DeadCodeElimination()},
+                       "PipelineParallel");
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PipelineParallel").set_body_typed(PipelineParallel);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,79 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/pass/precompile_tvm.cc
+ * \brief Build the fused functions of the TVM dialect ahead of time and in parallel. The IR is
+ * not changed by this pass; it only fills the build cache that is used when the ops are dispatched.
+ */
+#include <vector>
+#include "raf/device.h"
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+
+namespace raf {
+namespace pass {
+namespace precompile_tvm {
+
+using namespace raf::ir;
+
+/*! \brief Collect the calls to fused functions of the TVM dialect. */
+class FusedCallCollector : public ExprVisitor {
+ public:
+  void VisitExpr_(const FunctionNode* node) final {
+    if (node->HasNonzeroAttr(attr::kPrimitive)) {
+      // Don't go into fused functions
+      return;
+    }
+    ExprVisitor::VisitExpr_(node);
+  }
+
+  void VisitExpr_(const CallNode* node) final {
+    if (const auto* func = node->op.as<FunctionNode>()) {
+      auto dialect = func->GetAttr<String>(attr::kDialect);
+      if (func->HasNonzeroAttr(attr::kPrimitive) && dialect.defined() &&
+          dialect.value() == "tvm") {
+        calls.push_back(GetRef<Call>(node));
+      }
+    }
+    ExprVisitor::VisitExpr_(node);
+  }
+
+  /*! \brief The collected calls. */
+  Array<Call> calls;
+};
+
+}  // namespace precompile_tvm
+
+Pass PrecompileTVM() {
+  TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule mod,
+                                                                   PassContext pass_ctx) {
+    int num_threads =
+        pass_ctx->GetConfig("raf.tvm.parallel_build_threads", Integer(0)).value().IntValue();
+    static const auto* fbuild = tvm::runtime::Registry::Get("raf.op.tvm._parallel_build");
+    auto dev = Device::Current(true);
+    if (num_threads <= 1 || fbuild == nullptr || dev->device_type == DevType::kUnknown() ||
+        dev->device_id < 0) {
+      return mod;
+    }
+    precompile_tvm::FusedCallCollector collector;
+    for (const auto& it : mod->functions) {
+      if (it.second->IsInstance<FunctionNode>()) {
+        collector(it.second);
+      }
+    }
+    if (!collector.calls.empty()) {
+      (*fbuild)(collector.calls, num_threads);
+    }
+    return mod;
+  };
+  return CreateModulePass(pass_func, 1, "PrecompileTVM", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PrecompileTVM").set_body_typed(PrecompileTVM);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,210 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file prepack_weights.cc
+ * \brief Prepack the constant weights of an inference graph into the layouts preferred by the
+ * dispatched kernels, so that the weights are not transformed on every call.
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/op_utils.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "raf/executor.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace prepack_weights {
+
+using namespace raf::op;
+using namespace raf::value;
+
+template <typename T>
+using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+
+/*! \brief Whether the expression is a tensor constant, e.g., a weight bound by BindParam. */
+bool IsConstTensor(const Expr& expr) {
+  const auto* node = expr.as<ConstantNode>();
+  return node != nullptr && node->IsTensor();
+}
+
+/*! \brief Get the constant string, or empty if the expression is not a constant string. */
+std::string GetConstString(const Expr& expr) {
+  const auto* node = expr.as<ConstantNode>();
+  const auto* str = node ? node->value.as<StringValueObj>() : nullptr;
+  return str ? str->value : "";
+}
+
+/*! \brief Get the rank of a constant tensor. */
+int64_t GetRank(const Expr& expr) {
+  DLTensor* tensor = Downcast<TensorValue>(expr.as<ConstantNode>()->value);
+  return tensor->ndim;
+}
+
+/*!
+ * \brief Prepack the constant weights in ANF. The rewrites are as follows:
+ * 1. A transpose of a constant, e.g., of a filter transposed by ConvertLayout, is folded.
+ * 2. A GEMM whose second operand is a constant that is not transposed, e.g., matmul(x, w), takes
+ *    the transposed constant instead, e.g., matmul_nt(x, w^T). The reduction axis is then the
+ *    innermost axis of both operands, which the tensor core GEMMs load without transposing.
+ * 3. A conv2d with a constant filter takes the filter in OIHW for NCHW, or in OHWI for NHWC,
+ *    which are the filter layouts of the cuDNN and CUTLASS kernels.
+ * The weights are transformed once at compile time, so the dispatched kernels do not transform
+ * them on every call.
+ */
+class WeightPrepacker {
+ public:
+  explicit WeightPrepacker(const Function& func)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  Function Run() {
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      Expr expr = Substitute(exprs[i]);
+      if (auto call = expr.as<CallNode>()) {
+        Expr packed = Prepack(GetRef<Call>(call));
+        if (packed.defined()) {
+          expr = packed;
+        }
+      }
+      if (IsConstTensor(expr) && !exprs[i].as<ConstantNode>() && !vars[i].same_as(ell_->ret)) {
+        // The folded constant is used in place of the var.
+        folded_[vars[i]] = expr;
+        continue;
+      }
+      ell_out_.Push(vars[i], expr);
+    }
+    if (num_packed_ == 0) {
+      return func_;
+    }
+    DLOG(INFO) << "Prepacked " << num_packed_ << " constant weights";
+    ell_out_.ret = ell_->ret;
+    return Function(func_->params, ell_out_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*! \brief Replace the vars of the folded constants. */
+  Expr Substitute(const Expr& expr) {
+    auto subst = [this](const Expr& arg) {
+      auto var = arg.as<VarNode>();
+      auto it = var ? folded_.find(GetRef<Var>(var)) : folded_.end();
+      return it != folded_.end() ? it->second : arg;
+    };
+    if (auto call = expr.as<CallNode>()) {
+      Array<Expr> args;
+      for (const auto& arg : call->args) {
+        args.push_back(subst(arg));
+      }
+      return Call(call->op, args, call->attrs, call->type_args);
+    } else if (auto tuple = expr.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const auto& field : tuple->fields) {
+        fields.push_back(subst(field));
+      }
+      return Tuple(fields);
+    }
+    return subst(expr);
+  }
+
+  /*! \brief Prepack the constant arguments of the call, or return undefined if not applicable. */
+  Expr Prepack(const Call& call) {
+    static const Op& transpose_op = Op::Get("raf.op.transpose");
+    static const Op& conv2d_op = Op::Get("raf.op.conv2d");
+    // The GEMMs taking the second operand as is, and the ones taking it transposed.
+    static const std::unordered_map<std::string, std::pair<std::string, int64_t>> gemms{
+        {"raf.op.matmul", {"raf.op.matmul_nt", 2}},
+        {"raf.op.matmul_tn", {"raf.op.matmul_tt", 2}},
+        {"raf.op.batch_matmul", {"raf.op.batch_matmul_nt", 3}},
+        {"raf.op.batch_matmul_tn", {"raf.op.batch_matmul_tt", 3}}};
+
+    if (!call->op->IsInstance<OpNode>()) {
+      return Expr();
+    }
+    auto op = Downcast<Op>(call->op);
+    const auto& args = call->args;
+    if (op == transpose_op && IsConstTensor(args[0]) && args[1]->IsInstance<ConstantNode>()) {
+      num_packed_++;
+      return Evaluate(call);
+    }
+    auto it = gemms.find(op->name);
+    if (it != gemms.end() && args.size() == 2 && IsConstTensor(args[1]) &&
+        GetRank(args[1]) == it->second.second) {
+      std::vector<int64_t> axes{1, 0};
+      if (it->second.second == 3) {
+        axes = {0, 2, 1};
+      }
+      num_packed_++;
+      return Call(Op::Get(it->second.first), {args[0], Transpose(args[1], axes)});
+    }
+    if (op == conv2d_op && IsConstTensor(args[1]) && GetRank(args[1]) == 4) {
+      std::string layout = GetConstString(args[6]);
+      std::string kernel_layout = GetConstString(args[7]);
+      std::string preferred = layout == "NHWC" ? "OHWI" : layout == "NCHW" ? "OIHW" : "";
+      std::string sorted_layout = kernel_layout;
+      std::sort(sorted_layout.begin(), sorted_layout.end());
+      if (preferred.empty() || kernel_layout == preferred || sorted_layout != "HIOW") {
+        return Expr();
+      }
+      std::vector<int64_t> axes;
+      for (char dim : preferred) {
+        axes.push_back(kernel_layout.find(dim));
+      }
+      Array<Expr> new_args = args;
+      new_args.Set(1, Transpose(args[1], axes));
+      new_args.Set(7, MakeConstant(StringValue::make(preferred)));
+      num_packed_++;
+      return Call(op, new_args, call->attrs, call->type_args);
+    }
+    return Expr();
+  }
+
+  /*! \brief Transpose a constant at compile time. */
+  static Expr Transpose(const Expr& data, const std::vector<int64_t>& axes) {
+    static const Op& op = Op::Get("raf.op.transpose");
+    return Evaluate(Call(op, {data, MakeConstant(ArrayToIntTuple(axes))}));
+  }
+
+  /*! \brief Evaluate a call of constants. */
+  static Expr Evaluate(const Expr& expr) {
+    auto value = executor::interpreter::Interpret(expr, GlobalModule());
+    return MakeConstant(Downcast<TensorValue>(value));
+  }
+
+  /*! \brief The function to be prepacked. */
+  const Function& func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The let list of the prepacked function. */
+  ExplicitLetList ell_out_;
+  /*! \brief The constants folded from the let-binding vars. */
+  StdMap<Expr> folded_;
+  /*! \brief The number of prepacked weights. */
+  int num_packed_ = 0;
+};
+
+}  // namespace prepack_weights
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.prepack_weights", Bool);
+
+Pass PrepackWeights() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return prepack_weights::WeightPrepacker(f).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "PrepackWeightsHelper", {});
+  PassInfo pass_info(1, "PrepackWeights", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.PrepackWeights").set_body_typed(PrepackWeights);
+
+}  // namespace pass
+}  // namespace raf
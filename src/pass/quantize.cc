@@ -0,0 +1,186 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file quantize.cc
+ * \brief The passes of the int8 post-training quantization. QuantizeCalibrate exposes the float
+ * operands of the quantizable ops as outputs, so their ranges are collected by running the model
+ * on the calibration data, and QuantizeRealize rewrites the ops with the calibrated scales to the
+ * int8 ops.
+ */
+#include <unordered_map>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace quantize {
+
+using namespace raf::op;
+using namespace raf::value;
+
+/*!
+ * \brief Get the int8 op of a quantizable op with float32 operands, or an undefined op if the
+ * call cannot be quantized. The quantized ops take the same arguments, and only the two operands
+ * are quantized.
+ */
+Op GetQuantizedOp(const Call& call) {
+  static const std::unordered_map<std::string, std::string> qnn_ops = {
+      {"raf.op.dense", "raf.op.qnn_dense"},
+      {"raf.op.matmul_nt", "raf.op.qnn_dense"},
+      {"raf.op.batch_matmul_nt", "raf.op.qnn_batch_matmul_nt"},
+      {"raf.op.conv2d", "raf.op.qnn_conv2d"}};
+  const auto* op = call->op.as<OpNode>();
+  if (op == nullptr) {
+    return Op();
+  }
+  auto it = qnn_ops.find(op->name);
+  if (it == qnn_ops.end()) {
+    return Op();
+  }
+  for (int i = 0; i < 2; ++i) {
+    const auto& arg = call->args[i];
+    if (!(arg->IsInstance<VarNode>() || arg->IsInstance<ConstantNode>()) ||
+        !arg->checked_type_.defined()) {
+      return Op();
+    }
+    const auto* ttype = arg->checked_type().as<TensorTypeNode>();
+    if (ttype == nullptr || ttype->dtype != DataType::Float(32)) {
+      return Op();
+    }
+  }
+  return Op::Get(it->second);
+}
+
+/*! \brief Return the operands of the quantizable ops along with the output of the function. */
+Function Calibrate(const Function& func) {
+  std::unique_ptr<ExplicitLetList> ell = ExplicitLetList::make(func->body);
+  if (!ell->ret.defined()) {
+    return func;
+  }
+  Array<Expr> operands;
+  for (const auto& expr : ell->exprs) {
+    const auto* call = expr.as<CallNode>();
+    if (call != nullptr && GetQuantizedOp(GetRef<Call>(call)).defined()) {
+      operands.push_back(call->args[0]);
+      operands.push_back(call->args[1]);
+    }
+  }
+  Var operand_tuple = MakeVar("calib_operands", {});
+  Var ret = MakeVar("calib_ret", {});
+  ell->Push(operand_tuple, Tuple(operands));
+  ell->Push(ret, Tuple({ell->ret, operand_tuple}));
+  ell->ret = ret;
+  return Function(func->params, ell->AsExpr(), {}, func->type_params, func->attrs);
+}
+
+/*!
+ * \brief Rewrite the quantizable ops, in the same order as the operands of QuantizeCalibrate, to
+ * dequantize(qnn_op(quantize(a, s_a), quantize(b, s_b)), s_a * s_b). A var is only quantized once
+ * with the same scale, and the requantization between the int8 ops is fused by FuseTVM as both
+ * quantize and dequantize are element-wise.
+ */
+class Realizer {
+ public:
+  Realizer(const Function& func, const Array<FloatImm>& scales)
+      : func_(func), ell_(ExplicitLetList::make(func->body)), scales_(scales) {
+  }
+
+  Function Run() {
+    static const Op& dequantize = Op::Get("raf.op.dequantize");
+    if (!ell_->ret.defined()) {
+      return func_;
+    }
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      const auto* call = exprs[i].as<CallNode>();
+      Op qnn_op = call ? GetQuantizedOp(GetRef<Call>(call)) : Op();
+      if (!qnn_op.defined()) {
+        ell_out_.Push(vars[i], exprs[i]);
+        continue;
+      }
+      CHECK_LT(num_scales_ + 1, scales_.size())
+          << "The number of the scales does not match the quantizable ops";
+      double scale_a = scales_[num_scales_++]->value;
+      double scale_b = scales_[num_scales_++]->value;
+      Array<Expr> args(call->args.begin(), call->args.end());
+      args.Set(0, Quantize(call->args[0], scale_a));
+      args.Set(1, Quantize(call->args[1], scale_b));
+      Var acc = MakeVar(vars[i]->name_hint() + "_int32", {});
+      ell_out_.Push(acc, Call(qnn_op, args));
+      Expr acc_scale = MakeConstant(ScalarValue::make(scale_a * scale_b));
+      ell_out_.Push(vars[i], Call(dequantize, {acc, acc_scale,
+                                               MakeConstant(StringValue::make("float32"))}));
+    }
+    CHECK_EQ(num_scales_, scales_.size())
+        << "The number of the scales does not match the quantizable ops";
+    ell_out_.ret = ell_->ret;
+    return Function(func_->params, ell_out_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*! \brief Quantize an operand with the scale, reusing the previous quantization if any. */
+  Var Quantize(const Expr& expr, double scale) {
+    static const Op& quantize = Op::Get("raf.op.quantize");
+    for (const auto& entry : quantized_[expr]) {
+      if (entry.first == scale) {
+        return entry.second;
+      }
+    }
+    const auto* var = expr.as<VarNode>();
+    Var ret = MakeVar((var ? var->name_hint() : "c") + "_int8", {});
+    ell_out_.Push(ret, Call(quantize, {expr, MakeConstant(ScalarValue::make(scale)),
+                                       MakeConstant(StringValue::make("int8"))}));
+    quantized_[expr].emplace_back(scale, ret);
+    return ret;
+  }
+
+  /*! \brief The function to be rewritten. */
+  const Function& func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The let list of the rewritten function. */
+  ExplicitLetList ell_out_;
+  /*! \brief The scales of the operands of the quantizable ops. */
+  Array<FloatImm> scales_;
+  /*! \brief The number of the scales that have been used. */
+  size_t num_scales_ = 0;
+  /*! \brief The quantized vars of each operand, with their scales. */
+  std::unordered_map<Expr, std::vector<std::pair<double, Var>>, ObjectPtrHash, ObjectPtrEqual>
+      quantized_;
+};
+
+}  // namespace quantize
+
+Pass QuantizeCalibrate() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return quantize::Calibrate(f);
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "QuantizeCalibrateHelper", {});
+  PassInfo pass_info(1, "QuantizeCalibrate", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+Pass QuantizeRealize(Array<FloatImm> scales) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return quantize::Realizer(f, scales).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "QuantizeRealizeHelper", {});
+  PassInfo pass_info(1, "QuantizeRealize", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.QuantizeCalibrate").set_body_typed(QuantizeCalibrate);
+RAF_REGISTER_GLOBAL("raf.pass_.QuantizeRealize").set_body_typed(QuantizeRealize);
+
+}  // namespace pass
+}  // namespace raf
@@ -8,6 +8,8 @@
  * \brief Perform rematerialization to reduce peak memory footrpint.
  */
 #include <tvm/ir/type_functor.h>
+#include <chrono>
+#include <cmath>
 #include "raf/op.h"
 #include "raf/ir_ext.h"
 #include "raf/pass.h"
@@ -41,6 +43,9 @@ constexpr float kGigaBytes = 1073741824;
 // The max number of ops is allowed to rematerialized a tensor.
 #define MAX_REMAT_DEPTH 10
 
+// The number of size units used by the DP solver.
+#define DP_SIZE_UNITS 1024
+
 #if SHOW_VERBOSE_LOG == 1
 #define VERBOSE_LOG LOG(INFO)
 #else
@@ -85,6 +90,10 @@ struct TensorInfo {
   /*! \brief Workspace memory size of this tensor in bytes. -1 means recomputing this tensor is
    * invalid. */
   int64_t workspace_size = -1;
+  /*! \brief Whether this tensor is annotated as a checkpoint, which is freed last. */
+  bool is_checkpoint = false;
+  /*! \brief The checkpoint segment of this tensor, or -1 if it is not in any segment. */
+  int segment = -1;
   /*! \brief Only TensorInfos can change this status since TensorInfos has to maintain the live
    * tensor list. */
   bool IsDead() {
@@ -266,6 +275,81 @@ class TensorInfos {
   size_t tensor_idx_ = 0;
 };
 
+/*!
+ * \brief The checkpoint annotations of a function. Each raf.op.checkpoint_boundary closes a segment
+ * since the previous one, or since the beginning of the function for the first one. Its input is a
+ * checkpoint, which is kept, while the other tensors of the segment still used later are freed at
+ * the end of the segment and recomputed from the checkpoints when they are used again.
+ */
+struct Checkpoints {
+  /*! \brief The tensors annotated as checkpoints. */
+  VSet vars;
+  /*! \brief The segment of each let var in a segment, i.e., the number of boundaries before it. */
+  StdMap<int> segments;
+  /*! \brief The last let var before each boundary, and the segment closed by the boundary. */
+  StdMap<int> segment_ends;
+};
+
+/*!
+ * \brief Remove the checkpoint boundaries, which are the aliases of their inputs, and collect the
+ * checkpoints and segments they annotate.
+ */
+class CheckpointCollector : public ExprMutator {
+ public:
+  explicit CheckpointCollector(Checkpoints* checkpoints) : checkpoints_(checkpoints) {
+  }
+
+  Expr Run(const Function& func) {
+    auto ret = Mutate(func);
+    // The let vars after the last boundary are not in any segment.
+    for (auto it = checkpoints_->segments.begin(); it != checkpoints_->segments.end();) {
+      it = it->second >= num_boundaries_ ? checkpoints_->segments.erase(it) : std::next(it);
+    }
+    return ret;
+  }
+
+  Expr VisitExpr_(const VarNode* node) final {
+    auto var = GetRef<Var>(node);
+    auto it = aliases_.find(var);
+    return it != aliases_.end() ? it->second : var;
+  }
+
+  Expr VisitExpr_(const LetNode* node) final {
+    static const Op& boundary_op = Op::Get("raf.op.checkpoint_boundary");
+    LetList scope;
+    Expr body;
+    do {
+      auto value = VisitExpr(node->value);
+      const auto* call = value.as<CallNode>();
+      if (call && call->op.same_as(boundary_op) && call->args[0]->IsInstance<VarNode>()) {
+        auto checkpoint = Downcast<Var>(call->args[0]);
+        aliases_.emplace(node->var, checkpoint);
+        checkpoints_->vars.insert(checkpoint);
+        if (last_var_.defined()) {
+          checkpoints_->segment_ends[last_var_] = num_boundaries_;
+        }
+        num_boundaries_++;
+      } else {
+        scope.Push(node->var, value);
+        checkpoints_->segments[node->var] = num_boundaries_;
+        last_var_ = node->var;
+      }
+      body = node->body;
+      node = body.as<LetNode>();
+    } while (node);
+    return scope.Get(VisitExpr(body));
+  }
+
+ private:
+  Checkpoints* checkpoints_;
+  /*! \brief The boundaries removed, which are replaced by their inputs. */
+  StdMap<Var> aliases_;
+  /*! \brief The last let var kept. */
+  Var last_var_;
+  /*! \brief The number of boundaries visited. */
+  int num_boundaries_ = 0;
+};
+
 /*!
  * \brief Perform rematerialization algorithm to reduce the peak memory footprint. The algorithm
  * is briefly described as follows:
@@ -286,6 +370,12 @@ class TensorInfos {
  *    3.5. Repeat 3.3 - 3.4 until the total memory consumption is lower than the budget. If the
  *         memory still exceeds the budget but no more tensors can be marked as dead, then error out
  *         to let users adjust the budget.
+ * When the DP solver is enabled, step 3.4 instead solves the choice at this point as a min-cost
+ * knapsack: the candidates whose total size covers the excess memory with the lowest total
+ * recompute cost are marked as dead, so a large expensive tensor is not chosen when several cheap
+ * tensors would do. The greedy choice is used if the solver runs out of the time limit.
+ * The segments annotated by checkpoint boundaries are freed at their ends in addition, and the
+ * checkpoints are the last candidates to be freed to fit the budget.
  * Assumptions:
  * 1. Memory plan will be applied later to insert "free" properly to reflect the rematerialization.
  *    If memory plan is not applied, then rematerialization simply brings latency overheads.
@@ -296,13 +386,30 @@ class Rematerializer : public ExprMutator {
  public:
   explicit Rematerializer(liveness_analysis::LivenessAnalyzer* analyzer, const Device& device,
                           const Function& func, const IRModule& mod, const int64_t budget,
-                          op_profiler::OpProfiler* profiler)
+                          op_profiler::OpProfiler* profiler, bool use_dp = false,
+                          int64_t dp_time_limit_ms = 1000, const Checkpoints& checkpoints = {})
       : analyzer_(analyzer),
         func_(func),
         budget_(budget),
         profiler_(profiler),
+        use_dp_(use_dp),
+        dp_time_limit_ms_(dp_time_limit_ms),
+        segment_ends_(checkpoints.segment_ends),
         tensor_infos_(AnalyzeTensors(device, func, mod, analyzer, profiler)) {
     scopes_.emplace_back(new LetList);
+    for (const auto& var : checkpoints.vars) {
+      for (auto tensor_info : tensor_infos_.GetTensorInfoFromLetVar(var)) {
+        tensor_info->is_checkpoint = true;
+      }
+    }
+    for (const auto& it : checkpoints.segments) {
+      for (auto tensor_info : tensor_infos_.GetTensorInfoFromLetVar(it.first)) {
+        // An alias (e.g., let %b = %a) does not move the tensor to the segment of the alias.
+        if (tensor_info->let_var.same_as(it.first)) {
+          tensor_info->segment = it.second;
+        }
+      }
+    }
     VERBOSE_LOG << "Tensor infos:\n" << tensor_infos_.DebugDump();
   }
 
@@ -338,8 +445,11 @@ class Rematerializer : public ExprMutator {
     auto ret = this->Mutate(func_);
     std::stringstream ss;
     ss << "Estimated peak memory after rematerialization is " << peak_memory_ / kMegaBytes
-       << " MBs; while the budget is " << budget_ / kMegaBytes << " MBs. " << n_recompute_ops_
-       << " more ops were inserted";
+       << " MBs";
+    if (budget_ < std::numeric_limits<int64_t>::max()) {
+      ss << "; while the budget is " << budget_ / kMegaBytes << " MBs";
+    }
+    ss << ". " << n_recompute_ops_ << " more ops were inserted";
     if (profiler_) {
       ss << " with " << std::setw(2) << (total_recompute_cost_ / 1000.0) << " ms latency overhead";
     }
@@ -397,6 +507,10 @@ class Rematerializer : public ExprMutator {
       // Proceed to the next node
       scope->Push(node->var, new_value);
       let_vars_.emplace(node->var, new_value);
+      auto segment_end = segment_ends_.find(node->var);
+      if (segment_end != segment_ends_.end()) {
+        FreeSegments(segment_end->second);
+      }
       body = node->body;
       node = body.as<LetNode>();
     } while (node);
@@ -485,7 +599,7 @@ class Rematerializer : public ExprMutator {
           continue;
         }
 
-        auto cost = EstimateRematCost(tensor_info->liveness_var, node);
+        auto cost = EstimateRematCost(tensor_info->liveness_var, node, 1, !use_dp_);
         // Skip the tensors that cannot be rematerialized.
         if (cost != -1) {
           candidate_n_scores.push_back({tensor_info, cost});
@@ -501,6 +615,19 @@ class Rematerializer : public ExprMutator {
                   return (a.second == b.second) ? a.first->index > b.first->index
                                                 : a.second > b.second;
                 });
+      if (use_dp_) {
+        // Move the candidates chosen by the solver to the back, where they are freed first.
+        auto chosen = SolveKnapsack(candidate_n_scores, curr_mem_trace_ - budget_);
+        std::stable_partition(candidate_n_scores.begin(), candidate_n_scores.end(),
+                              [&](const std::pair<std::shared_ptr<TensorInfo>, float>& cand) {
+                                return chosen.count(cand.first) == 0;
+                              });
+      }
+      // The checkpoints are only freed when the other candidates do not fit the budget.
+      std::stable_partition(candidate_n_scores.begin(), candidate_n_scores.end(),
+                            [](const std::pair<std::shared_ptr<TensorInfo>, float>& cand) {
+                              return cand.first->is_checkpoint;
+                            });
       VERBOSE_LOG << "| |-Cands: " << DebugDumpCandidates(candidate_n_scores);
       while (curr_mem_trace_ > budget_) {
         // Mark a var (tensor) to be dead and remove its size from memory trace. This tensor
@@ -509,57 +636,13 @@ class Rematerializer : public ExprMutator {
           LOG(FATAL)
               << "Memory consumption at " << curr_let_ << " is " << curr_mem_trace_ / kMegaBytes
               << "MBs. Cannot rematerialize more tensors to meet the memory budget requirement ("
-              << budget_ / kMegaBytes << " MBs). Please try a higher memory budget";
+              << budget_ / kMegaBytes << " MBs). Please try a higher memory budget, or "
+              << "oversubscribe the device memory with InitPool(device, \"managed_pool\")";
           throw;
         }
         auto cand_tensor_info = candidate_n_scores.back().first;
         candidate_n_scores.pop_back();
-        tensor_infos_.MarkAsDead(cand_tensor_info);
-        curr_mem_trace_ -= cand_tensor_info->size;
-        VERBOSE_LOG << "| |-" << cand_tensor_info->liveness_var->name_hint() << " with "
-                    << cand_tensor_info->size / kMegaBytes << " MBs";
-        // Remove this tensor from the current live set
-        auto liveness_var = cand_tensor_info->liveness_var;
-        curr_live_in_vars_.erase(liveness_var);
-
-        // When deciding to rematerialize a tensor, increment the use count of its direct
-        // producers if they are still live. In this case, these tensors won't be considered
-        // "dead" before the rematerialization takes place. This helps in the following case:
-        /*
-          x = expensive_compute()
-          y = cheap_compute(x)
-          ...
-          # memory budget exceeded, decide to rematerialize y because it is cheap to compute
-          # notice that x is still live at this point, so the cost function won't include
-          # the cost of computing x
-          free(y)
-          ...
-          # lifetime of x ends here, x gets killed
-          free(x)
-          ...
-          # y is rematerialized here, but because x is already killed, it must be rematerialized too
-          x' = expensive_compute()
-          y' = cheap_compute(x')
-          ...
-        */
-        // TODO: to properly track the use count of all tensors over here, we actually need to
-        // recursively increment the use count of all affected tensors. Left for future work.
-        auto cand_let_var = cand_tensor_info->let_var;
-        auto cand_call_node = let_vars_[cand_let_var].as<CallNode>();
-        CHECK(cand_call_node != nullptr)
-            << "Tensor " << cand_let_var
-            << " is not generated by a call node: " << raf::ir::AsText(cand_let_var);
-        for (auto arg : cand_call_node->args) {
-          if (auto var_node = arg.as<VarNode>()) {
-            auto arg_var = GetRef<Var>(var_node);
-            for (auto tensor_info : tensor_infos_.GetTensorInfoFromLetVar(arg_var)) {
-              int64_t new_use_count = tensor_info->IncUseCount();
-              VERBOSE_LOG << "Increment use count of " << arg_var->name_hint() << "("
-                          << tensor_info->liveness_var->name_hint() << ")"
-                          << " to reflect remat decision, now use count is " << new_use_count;
-            }
-          }
-        }
+        FreeTensor(cand_tensor_info);
       }
       VERBOSE_LOG << "|-CurrMem: " << curr_mem_trace_ / kMegaBytes << " MBs";
     }
@@ -578,6 +661,85 @@ class Rematerializer : public ExprMutator {
  private:
   class TensorAnalyzer;
 
+  /*!
+   * \brief Mark a tensor to be dead and remove its size from memory trace. This tensor will be
+   * rematerialized later when necessary.
+   * \param tensor_info The tensor to be freed.
+   */
+  void FreeTensor(const std::shared_ptr<TensorInfo>& tensor_info) {
+    tensor_infos_.MarkAsDead(tensor_info);
+    curr_mem_trace_ -= tensor_info->size;
+    VERBOSE_LOG << "| |-" << tensor_info->liveness_var->name_hint() << " with "
+                << tensor_info->size / kMegaBytes << " MBs";
+    // Remove this tensor from the current live set
+    auto liveness_var = tensor_info->liveness_var;
+    curr_live_in_vars_.erase(liveness_var);
+
+    // When deciding to rematerialize a tensor, increment the use count of its direct
+    // producers if they are still live. In this case, these tensors won't be considered
+    // "dead" before the rematerialization takes place. This helps in the following case:
+    /*
+      x = expensive_compute()
+      y = cheap_compute(x)
+      ...
+      # memory budget exceeded, decide to rematerialize y because it is cheap to compute
+      # notice that x is still live at this point, so the cost function won't include
+      # the cost of computing x
+      free(y)
+      ...
+      # lifetime of x ends here, x gets killed
+      free(x)
+      ...
+      # y is rematerialized here, but because x is already killed, it must be rematerialized too
+      x' = expensive_compute()
+      y' = cheap_compute(x')
+      ...
+    */
+    // TODO: to properly track the use count of all tensors over here, we actually need to
+    // recursively increment the use count of all affected tensors. Left for future work.
+    auto let_var = tensor_info->let_var;
+    auto call_node = let_vars_[let_var].as<CallNode>();
+    CHECK(call_node != nullptr) << "Tensor " << let_var
+                                << " is not generated by a call node: " << raf::ir::AsText(let_var);
+    for (auto arg : call_node->args) {
+      if (auto var_node = arg.as<VarNode>()) {
+        auto arg_var = GetRef<Var>(var_node);
+        for (auto arg_info : tensor_infos_.GetTensorInfoFromLetVar(arg_var)) {
+          int64_t new_use_count = arg_info->IncUseCount();
+          VERBOSE_LOG << "Increment use count of " << arg_var->name_hint() << "("
+                      << arg_info->liveness_var->name_hint() << ")"
+                      << " to reflect remat decision, now use count is " << new_use_count;
+        }
+      }
+    }
+  }
+
+  /*!
+   * \brief Free the tensors of the segments up to the given one that are still used later, except
+   * the checkpoints. Freeing a tensor keeps its producers, so they are freed in turn if they are
+   * in the segments, and the tensors are recomputed from the checkpoints when used again.
+   * \param segment The segment just closed by a checkpoint boundary.
+   */
+  void FreeSegments(int segment) {
+    bool freed = true;
+    while (freed) {
+      freed = false;
+      for (const auto tensor_info : tensor_infos_.GetLiveTensorInfos()) {
+        if (tensor_info->segment < 0 || tensor_info->segment > segment ||
+            tensor_info->is_checkpoint || tensor_info->is_param || tensor_info->size <= 0 ||
+            !tensor_info->share_storage.empty() || tensor_info->tuple_field_idx != -1 ||
+            tensor_info->GetUseCount() <= 0 || tensor_info->compute_cost < 0 ||
+            tensor_info->compute_cost == std::numeric_limits<float>::max() ||
+            !let_vars_[tensor_info->let_var].as<CallNode>()) {
+          continue;
+        }
+        VERBOSE_LOG << "|-Free at the end of segment " << segment << ":";
+        FreeTensor(tensor_info);
+        freed = true;
+      }
+    }
+  }
+
   TensorInfos AnalyzeTensors(const Device& device, const Function& func, const IRModule& mod,
                              liveness_analysis::LivenessAnalyzer* analyzer,
                              op_profiler::OpProfiler* profiler);
@@ -741,6 +903,60 @@ class Rematerializer : public ExprMutator {
     return CorrectType(scope, var);
   }
 
+  /*!
+   * \brief Choose the candidates to free by solving a min-cost knapsack with dynamic programming:
+   * the total size of the chosen candidates must cover the excess memory, and their total
+   * recompute cost is minimized. Sizes are rounded down to units of 1/DP_SIZE_UNITS of the excess,
+   * so the chosen candidates always cover it.
+   * \param candidates The candidates with their unnormalized recompute costs.
+   * \param excess The memory in bytes to be freed.
+   * \return The chosen candidates, or an empty set if there is no solution or the solver runs out
+   * of the time limit.
+   */
+  std::unordered_set<std::shared_ptr<TensorInfo>> SolveKnapsack(
+      const std::vector<std::pair<std::shared_ptr<TensorInfo>, float>>& candidates,
+      int64_t excess) {
+    auto start = std::chrono::steady_clock::now();
+    const int64_t unit = (excess + DP_SIZE_UNITS - 1) / DP_SIZE_UNITS;
+    const int64_t target = (excess + unit - 1) / unit;
+    const double inf = std::numeric_limits<double>::infinity();
+    size_t n = candidates.size();
+    // min_cost[i][j] is the lowest cost to free at least j units with the first i candidates.
+    std::vector<std::vector<double>> min_cost(n + 1, std::vector<double>(target + 1, inf));
+    std::vector<int64_t> weights(n);
+    min_cost[0][0] = 0;
+    for (size_t i = 0; i < n; ++i) {
+      weights[i] = candidates[i].first->size / unit;
+      double cost = candidates[i].second;
+      bool valid = weights[i] > 0 && std::isfinite(cost);
+      for (int64_t j = 0; j <= target; ++j) {
+        min_cost[i + 1][j] = min_cost[i][j];
+        if (valid) {
+          double take = min_cost[i][std::max<int64_t>(0, j - weights[i])] + cost;
+          min_cost[i + 1][j] = std::min(min_cost[i + 1][j], take);
+        }
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start);
+      if (elapsed.count() > dp_time_limit_ms_) {
+        LOG(WARNING) << "Rematerialization solver runs out of " << dp_time_limit_ms_ << " ms at "
+                     << curr_let_->name_hint() << ". Fall back to the greedy choice.";
+        return {};
+      }
+    }
+    std::unordered_set<std::shared_ptr<TensorInfo>> chosen;
+    if (min_cost[n][target] == inf) {
+      return chosen;
+    }
+    for (int64_t i = n, j = target; i > 0 && j > 0; --i) {
+      if (min_cost[i][j] != min_cost[i - 1][j]) {
+        chosen.insert(candidates[i - 1].first);
+        j = std::max<int64_t>(0, j - weights[i - 1]);
+      }
+    }
+    return chosen;
+  }
+
   /*!
    * \brief Estimate the rematerialization cost of the given tensor (let_var). The cost is estimated
    * by the equation `(cost * use_count) / size`, where cost is the latency cost of rematerializing
@@ -750,10 +966,12 @@ class Rematerializer : public ExprMutator {
    * \param liveness_var The liveness var to be estimated.
    * \param curr_call_node The current processing call node.
    * \param curr_depth The current back trace depth of estimating cost of a tensor.
+   * \param normalize Whether to divide the cost by the tensor size. The DP solver accounts for
+   * the sizes by itself, so it uses `cost * use_count` instead.
    * \return The cost (lower the better). Note that -1 means rematerializing this tensor is invalid.
    */
   float EstimateRematCost(const Var& liveness_var, const CallNode* curr_call_node,
-                          size_t curr_depth = 1) {
+                          size_t curr_depth = 1, bool normalize = true) {
     if (curr_depth == MAX_REMAT_DEPTH) {
       return std::numeric_limits<float>::max();
     }
@@ -810,7 +1028,8 @@ class Rematerializer : public ExprMutator {
           return -1;
         }
         auto arg_cost =
-            EstimateRematCost(tensor_infos[0]->liveness_var, curr_call_node, curr_depth + 1);
+            EstimateRematCost(tensor_infos[0]->liveness_var, curr_call_node, curr_depth + 1,
+                              normalize);
         if (arg_cost == std::numeric_limits<float>::max()) {
           // Give up to rematerialize this tensor if it needs to rematerialize too many ops.
           return -1;
@@ -821,6 +1040,9 @@ class Rematerializer : public ExprMutator {
     }
 
     cost += 0.1;  // Avoid 0 cost.
+    if (!normalize) {
+      return cost * (tensor_info->GetUseCount() + 1);
+    }
     return (cost * (tensor_info->GetUseCount() + 1)) / (tensor_info->size / kGigaBytes);
   }
 
@@ -842,6 +1064,12 @@ class Rematerializer : public ExprMutator {
   op_profiler::OpProfiler* profiler_;
   /*! \brief The memory budget in bytes. */
   int64_t budget_;
+  /*! \brief Whether to choose the tensors to free with the DP solver. */
+  bool use_dp_;
+  /*! \brief The time limit of the DP solver at each over-budget point in milliseconds. */
+  int64_t dp_time_limit_ms_;
+  /*! \brief The last let var of each checkpoint segment, after which the segment is freed. */
+  StdMap<int> segment_ends_;
   /*! \brief The current memory consumption in bytes. */
   int64_t curr_mem_trace_ = 0;
   /*! \brief Peak mremory. */
@@ -998,6 +1226,9 @@ TensorInfos Rematerializer::AnalyzeTensors(const Device& device, const Function&
 
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.memory_budget", IntImm);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.use_gflops_cost", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.solver", String);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.solver_time_limit", IntImm);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.remat.latency_cache", String);
 
 Pass Rematerialization() {
   PassContext pass_ctx = PassContext::Current();
@@ -1005,12 +1236,29 @@ Pass Rematerialization() {
       pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value().IntValue();
   // Turn profiler on by default. With caching it is pretty fast now.
   bool use_profiler = !(pass_ctx->GetConfig("raf.remat.use_gflops_cost", Bool(false)).value());
+  // "greedy" frees the tensors with the lowest normalized costs one by one, while "dp" solves a
+  // min-cost knapsack at each over-budget point.
+  std::string solver = pass_ctx->GetConfig("raf.remat.solver", String("greedy")).value();
+  CHECK(solver == "greedy" || solver == "dp") << "Unknown rematerialization solver " << solver;
+  int64_t time_limit = pass_ctx->GetConfig("raf.remat.solver_time_limit", Integer(1000))
+                           .value()
+                           .IntValue();
+  // The file to load the measured latencies from and save them to after the pass.
+  std::string latency_cache = pass_ctx->GetConfig("raf.remat.latency_cache", String("")).value();
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    // We use budget 0 to diable this pass because it is guaranteed to fail.
-    if (memory_budget == 0) {
+    // The checkpoint boundaries are removed whether the budget is set or not.
+    rematerialization::Checkpoints checkpoints;
+    auto stripped = rematerialization::CheckpointCollector(&checkpoints).Run(f);
+    if (!checkpoints.vars.empty()) {
+      f = Downcast<Function>(InferTypeWithModule(stripped, m));
+    }
+    // We use budget 0 to diable this pass because it is guaranteed to fail, unless the segments
+    // are annotated, which are then rematerialized without a budget.
+    if (memory_budget == 0 && checkpoints.vars.empty()) {
       return f;
     }
+    int64_t budget = memory_budget > 0 ? memory_budget : std::numeric_limits<int64_t>::max();
     auto device = Device::Current();
     if (device.device_type() == DevType::kUnknown() && device.device_id() == -1) {
       LOG(WARNING) << "Target device is undefined. Skip rematerialization.";
@@ -1018,11 +1266,11 @@ Pass Rematerialization() {
     }
 
     VERBOSE_LOG << "Memory budget for rematerialization: "
-                << (float)memory_budget / rematerialization::kMegaBytes << " MBs";
+                << (float)memory_budget / rematerialization::kMegaBytes << " MBs with "
+                << checkpoints.vars.size() << " checkpoints";
 
-    auto analyzer = liveness_analysis::LivenessAnalyzer(f);
-    analyzer.Run();
-    if (!analyzer.IsSuccess()) {
+    auto analyzer = liveness_analysis::LivenessAnalyzer::Get(f);
+    if (!analyzer->IsSuccess()) {
       LOG(WARNING) << "Rematerialization is disabled because liveness analysis was failed";
       return f;
     }
@@ -1032,11 +1280,24 @@ Pass Rematerialization() {
       LOG(INFO)
           << "Using profiler-based cost estimation for rematerialization. This may take a while. ";
       profiler = op_profiler::OpProfiler::Get(device);
+      if (!latency_cache.empty()) {
+        int n_loaded = profiler->LoadLatencyCache(latency_cache);
+        if (n_loaded >= 0) {
+          LOG(INFO) << "Loaded " << n_loaded << " op latencies from " << latency_cache;
+        }
+      }
     } else {
       LOG(INFO) << "Using GFLOPS-based cost estimation. ";
     }
-    return Downcast<Function>(
-        rematerialization::Rematerializer(&analyzer, device, f, m, memory_budget, profiler).Run());
+    auto ret = Downcast<Function>(rematerialization::Rematerializer(analyzer.get(), device, f, m,
+                                                                    budget, profiler,
+                                                                    solver == "dp", time_limit,
+                                                                    checkpoints)
+                                      .Run());
+    if (profiler && !latency_cache.empty()) {
+      profiler->SaveLatencyCache(latency_cache);
+    }
+    return ret;
   };
 
   Pass func_pass = CreateRAFFunctionPass(pass_func, 2, "RematerializationHelper", {});
@@ -0,0 +1,317 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file rematerialization_schedule.cc
+ * \brief Reorder the independent computations of ANF IR under the memory budget before
+ * rematerialization, so that fewer tensors have to be rematerialized.
+ */
+#include <algorithm>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+
+#include "./common.h"
+#include "./let_list.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace rematerialization_schedule {
+
+using common::shape_utils::BytesCompactType;
+
+constexpr float kMegaBytes = 1048576;
+
+class RematScheduler {
+ public:
+  RematScheduler(const Function& func, int64_t budget)
+      : func_(func), budget_(budget), ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  /*!
+   * \brief Schedule the let-bindings by simulating the live memory in the issue order, where a
+   * tensor is released once all bindings using it (directly or through tuples) are issued:
+   *
+   * 1. Issue the ready binding that comes first in the original order if the live memory stays
+   *    within the budget.
+   *
+   * 2. Otherwise, issue the ready binding that increases the live memory the least, i.e., the one
+   *    releasing the most tensors at their last uses. In a training graph, this computes each
+   *    weight gradient right after the activation gradient it needs, so the forward activation is
+   *    released before the next activation gradient is computed.
+   *
+   * The IR is unchanged if the live memory never exceeds the budget, or if the new order does not
+   * reduce the estimated peak memory.
+   */
+  Function Run() {
+    if (!Init()) {
+      return func_;
+    }
+    size_t n = ell_->vars.size();
+    std::vector<size_t> orig_order(n);
+    for (size_t i = 0; i < n; ++i) {
+      orig_order[i] = i;
+    }
+    int64_t orig_peak = Simulate(orig_order);
+    if (orig_peak <= budget_) {
+      return func_;
+    }
+
+    std::vector<size_t> order;
+    std::vector<int> num_pending_deps(n);
+    std::vector<int> num_pending_readers(num_readers_of_);
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < n; ++i) {
+      num_pending_deps[i] = deps_[i].size();
+      if (deps_[i].empty()) {
+        ready.push_back(i);
+      }
+    }
+    // The memory released after issuing a binding, whose tensors are not used by others.
+    auto freed_bytes = [&](size_t i) {
+      int64_t freed = 0;
+      for (auto t : reads_[i]) {
+        if (num_pending_readers[t] == 1 && !is_output_[t]) {
+          freed += size_[t];
+        }
+      }
+      return freed;
+    };
+    int64_t live = param_bytes_;
+    while (!ready.empty()) {
+      auto it = std::min_element(ready.begin(), ready.end());
+      if (live + size_[*it] > budget_) {
+        it = std::min_element(ready.begin(), ready.end(), [&](size_t lhs, size_t rhs) {
+          int64_t lhs_delta = size_[lhs] - freed_bytes(lhs);
+          int64_t rhs_delta = size_[rhs] - freed_bytes(rhs);
+          return lhs_delta != rhs_delta ? lhs_delta < rhs_delta : lhs < rhs;
+        });
+      }
+      size_t curr = *it;
+      ready.erase(it);
+      order.push_back(curr);
+      live = Issue(curr, live, &num_pending_readers);
+      for (auto user : users_[curr]) {
+        if (--num_pending_deps[user] == 0) {
+          ready.push_back(user);
+        }
+      }
+    }
+    CHECK_EQ(order.size(), n) << "Internal error: the dependency graph has a cycle";
+
+    int64_t peak = Simulate(order);
+    if (peak >= orig_peak) {
+      return func_;
+    }
+    DLOG(INFO) << "Rematerialization schedule reduces the estimated peak memory from "
+               << orig_peak / kMegaBytes << " MBs to " << peak / kMegaBytes
+               << " MBs, while the budget is " << budget_ / kMegaBytes << " MBs";
+
+    ExplicitLetList ell;
+    for (auto i : order) {
+      ell.Push(ell_->vars[i], ell_->exprs[i]);
+    }
+    ell.ret = ell_->ret;
+    return Function(func_->params, ell.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Build the dependencies, sizes and readers of the let-bindings. Return false if the
+   * function cannot be scheduled, e.g., it has control flow or closures.
+   */
+  bool Init() {
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    size_t n = vars.size();
+    if (n == 0 || !ell_->ret.defined()) {
+      return false;
+    }
+    std::unordered_map<Var, size_t, ObjectPtrHash, ObjectPtrEqual> index_of;
+    for (const auto& param : func_->params) {
+      param_bytes_ += BytesCompactType(param->checked_type());
+    }
+
+    // The tensors (represented by the bindings of the calls generating them) each binding refers
+    // to. Tuples, TupleGetItems and vars alias the tensors of their operands.
+    std::vector<std::vector<size_t>> tensors(n);
+    std::vector<std::vector<size_t>> deps(n);
+    std::vector<int> share_of(n, -1);
+    size_.resize(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+      std::vector<Expr> operands;
+      const auto& expr = exprs[i];
+      if (auto call = expr.as<CallNode>()) {
+        if (call->op.as<FunctionNode>() &&
+            !call->op.as<FunctionNode>()->HasNonzeroAttr(attr::kPrimitive)) {
+          return false;
+        }
+        operands.push_back(call->op);
+        operands.insert(operands.end(), call->args.begin(), call->args.end());
+      } else if (auto tuple = expr.as<TupleNode>()) {
+        operands.insert(operands.end(), tuple->fields.begin(), tuple->fields.end());
+      } else if (auto tgi = expr.as<TupleGetItemNode>()) {
+        operands.push_back(tgi->tuple);
+      } else if (expr.as<VarNode>()) {
+        operands.push_back(expr);
+      } else if (!expr.as<ConstantNode>() && !expr.as<OpNode>()) {
+        // Control flow, closures, etc.
+        return false;
+      }
+      for (const auto& operand : operands) {
+        auto var = operand.as<VarNode>();
+        auto it = var ? index_of.find(GetRef<Var>(var)) : index_of.end();
+        if (it != index_of.end()) {
+          deps[i].push_back(it->second);
+        }
+      }
+      std::sort(deps[i].begin(), deps[i].end());
+      deps[i].erase(std::unique(deps[i].begin(), deps[i].end()), deps[i].end());
+
+      if (expr.as<CallNode>()) {
+        auto ext_var = vars[i].as<ExtendedVarNode>();
+        if (ext_var && ext_var->may_share.defined() && index_of.count(ext_var->may_share)) {
+          // The output is written to the memory of the shared tensor.
+          share_of[i] = index_of[ext_var->may_share];
+          tensors[i] = tensors[share_of[i]];
+        } else {
+          CHECK(vars[i]->checked_type_.defined()) << "Please run InferType first";
+          tensors[i] = {i};
+          size_[i] = BytesCompactType(vars[i]->checked_type());
+        }
+      } else {
+        for (auto dep : deps[i]) {
+          tensors[i].insert(tensors[i].end(), tensors[dep].begin(), tensors[dep].end());
+        }
+        std::sort(tensors[i].begin(), tensors[i].end());
+        tensors[i].erase(std::unique(tensors[i].begin(), tensors[i].end()), tensors[i].end());
+      }
+      index_of[vars[i]] = i;
+    }
+
+    // The tensors read by each binding, and the number of bindings reading each tensor.
+    reads_.resize(n);
+    std::vector<std::vector<size_t>> readers(n);
+    for (size_t i = 0; i < n; ++i) {
+      for (auto dep : deps[i]) {
+        reads_[i].insert(reads_[i].end(), tensors[dep].begin(), tensors[dep].end());
+      }
+      std::sort(reads_[i].begin(), reads_[i].end());
+      reads_[i].erase(std::unique(reads_[i].begin(), reads_[i].end()), reads_[i].end());
+      for (auto t : reads_[i]) {
+        readers[t].push_back(i);
+      }
+    }
+    is_output_.resize(n, false);
+    if (index_of.count(ell_->ret)) {
+      for (auto t : tensors[index_of[ell_->ret]]) {
+        is_output_[t] = true;
+      }
+    }
+    num_readers_of_.resize(n);
+    for (size_t t = 0; t < n; ++t) {
+      num_readers_of_[t] = readers[t].size();
+    }
+
+    // An in-place update keeps its order with all other bindings reading the updated tensors.
+    for (size_t i = 0; i < n; ++i) {
+      if (share_of[i] == -1) {
+        continue;
+      }
+      for (auto t : tensors[i]) {
+        for (auto j : readers[t]) {
+          if (j < i) {
+            deps[i].push_back(j);
+          } else if (j > i) {
+            deps[j].push_back(i);
+          }
+        }
+      }
+    }
+    deps_.resize(n);
+    users_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      std::sort(deps[i].begin(), deps[i].end());
+      deps[i].erase(std::unique(deps[i].begin(), deps[i].end()), deps[i].end());
+      deps_[i] = deps[i];
+      for (auto dep : deps[i]) {
+        users_[dep].push_back(i);
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Issue a binding and return the live memory after releasing the dead tensors. */
+  int64_t Issue(size_t i, int64_t live, std::vector<int>* num_pending_readers) {
+    live += size_[i];
+    peak_ = std::max(peak_, live);
+    for (auto t : reads_[i]) {
+      if (--(*num_pending_readers)[t] == 0 && !is_output_[t]) {
+        live -= size_[t];
+      }
+    }
+    if (size_[i] > 0 && num_readers_of_[i] == 0 && !is_output_[i]) {
+      // The output of this binding is never used.
+      live -= size_[i];
+    }
+    return live;
+  }
+
+  /*! \brief Simulate the live memory of the given order and return its peak. */
+  int64_t Simulate(const std::vector<size_t>& order) {
+    std::vector<int> num_pending_readers(num_readers_of_);
+    int64_t live = param_bytes_;
+    peak_ = param_bytes_;
+    for (auto i : order) {
+      live = Issue(i, live, &num_pending_readers);
+    }
+    return peak_;
+  }
+
+  /*! \brief The function to be scheduled. */
+  Function func_;
+  /*! \brief The memory budget in bytes. */
+  int64_t budget_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The total size of the function parameters in bytes. */
+  int64_t param_bytes_ = 0;
+  /*! \brief The bindings each binding depends on, and the bindings depending on it. */
+  std::vector<std::vector<size_t>> deps_, users_;
+  /*! \brief The size of the new tensor generated by each binding in bytes. */
+  std::vector<int64_t> size_;
+  /*! \brief The tensors read by each binding. */
+  std::vector<std::vector<size_t>> reads_;
+  /*! \brief The number of bindings reading each tensor. */
+  std::vector<int> num_readers_of_;
+  /*! \brief Whether each tensor is referred by the function output. */
+  std::vector<bool> is_output_;
+  /*! \brief The peak memory of the last simulation. */
+  int64_t peak_ = 0;
+};
+
+}  // namespace rematerialization_schedule
+
+Pass RematerializationSchedule() {
+  PassContext pass_ctx = PassContext::Current();
+  int64_t memory_budget =
+      pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value().IntValue();
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    if (memory_budget == 0) {
+      return f;
+    }
+    return rematerialization_schedule::RematScheduler(f, memory_budget).Run();
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "RematerializationSchedule", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.RematerializationSchedule")
+    .set_body_typed(RematerializationSchedule);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,258 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file remove_redundant_events.cc
+ * \brief Remove the redundant cross-stream synchronization of a multi-stream schedule. A wait is
+ * redundant if the waiting stream is already ordered after the event (transitively through other
+ * waits, a stream barrier or the stream order), and an event is removed if no wait uses it.
+ */
+#include <map>
+#include "raf/op.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+
+#include "./common.h"
+#include "./let_list.h"
+
+namespace raf {
+namespace pass {
+namespace remove_redundant_events {
+
+using namespace raf::value;
+
+/*! \brief A stream or an event is identified by (device id, stream or event id). */
+using Key = std::pair<int64_t, int64_t>;
+/*!
+ * \brief A vector clock that maps each stream to the number of events recorded on it, which are
+ * known to happen before the current point of a stream.
+ */
+using VectorClock = std::map<Key, int64_t>;
+
+class EventMinimizer {
+ public:
+  explicit EventMinimizer(const Function& func)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  /*!
+   * \brief Simulate the vector clock of each stream in the program order:
+   *
+   * 1. add_event on stream s increases the clock of s, and the event captures the vector clock
+   *    of s at this point.
+   *
+   * 2. wait_event on stream w is redundant if the clock of w already covers the event, i.e., w has
+   *    waited for the same or a later event of the recording stream. Otherwise, the vector clock of
+   *    w is merged with the one captured by the event.
+   *
+   * 3. stream_barrier synchronizes all streams, including the streams used afterwards.
+   *
+   * The events that are not waited by the remaining waits are then removed. The function is
+   * unchanged if it has control flow, closures or stream ops with non-constant arguments.
+   */
+  Function Run() {
+    static const Op& set_stream_op = Op::Get("raf.op.set_stream");
+    static const Op& add_event_op = Op::Get("raf.op.add_event");
+    static const Op& wait_event_op = Op::Get("raf.op.wait_event");
+    static const Op& stream_barrier_op = Op::Get("raf.op.stream_barrier");
+
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    size_t n = exprs.size();
+    for (size_t i = 0; i < n; ++i) {
+      if (exprs[i].as<ConstantNode>()) {
+        consts_[vars[i]] = exprs[i];
+      }
+    }
+
+    struct EventRecord {
+      /*! \brief The binding index of add_event. */
+      size_t index;
+      /*! \brief The recording stream. */
+      Key stream;
+      /*! \brief The vector clock of the recording stream after recording. */
+      VectorClock clock;
+      /*! \brief Whether a remaining wait uses this event. */
+      bool used = false;
+    };
+    std::vector<EventRecord> records;
+    std::map<Key, size_t> latest_record;
+    std::vector<bool> removed(n, false);
+    // Just like the VM, the schedule starts on the default stream of device 0.
+    Key curr_stream{0, 0};
+    int num_waits = 0, num_removed_waits = 0;
+    // The stream of an event op, which is the current stream unless specified.
+    auto event_stream = [&](const std::vector<int64_t>& args) {
+      return args.size() > 1 && args[1] != -1 ? Key{curr_stream.first, args[1]} : curr_stream;
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+      const auto& expr = exprs[i];
+      if (expr.as<IfNode>() || expr.as<FunctionNode>()) {
+        return func_;
+      }
+      auto call = expr.as<CallNode>();
+      if (!call) {
+        continue;
+      }
+      auto op = call->op.as<OpNode>();
+      if (!op) {
+        auto fn = call->op.as<FunctionNode>();
+        if (!fn || !fn->HasNonzeroAttr(attr::kPrimitive)) {
+          // The callee may switch the streams.
+          return func_;
+        }
+        continue;
+      }
+      const Op& callee = GetRef<Op>(op);
+      std::vector<int64_t> args;
+      if (callee == set_stream_op || callee == add_event_op || callee == wait_event_op) {
+        for (const auto& arg : call->args) {
+          int64_t value;
+          if (!GetInt(arg, &value)) {
+            return func_;
+          }
+          args.push_back(value);
+        }
+      }
+      if (callee == set_stream_op) {
+        curr_stream = {args[0], args[1]};
+      } else if (callee == add_event_op) {
+        Key stream = event_stream(args);
+        auto& clock = GetClock(stream);
+        clock[stream]++;
+        latest_record[{curr_stream.first, args[0]}] = records.size();
+        records.push_back({i, stream, clock});
+      } else if (callee == wait_event_op) {
+        num_waits++;
+        Key stream = event_stream(args);
+        auto it = latest_record.find({curr_stream.first, args[0]});
+        if (it == latest_record.end()) {
+          // The event is not recorded in this function, so keep the wait.
+          continue;
+        }
+        auto& record = records[it->second];
+        auto& clock = GetClock(stream);
+        if (clock[record.stream] >= record.clock.at(record.stream)) {
+          removed[i] = true;
+          num_removed_waits++;
+          continue;
+        }
+        Merge(record.clock, &clock);
+        record.used = true;
+      } else if (callee == stream_barrier_op) {
+        for (const auto& it : clocks_) {
+          Merge(it.second, &barrier_clock_);
+        }
+        for (auto& it : clocks_) {
+          it.second = barrier_clock_;
+        }
+      }
+    }
+
+    int num_removed_events = 0;
+    for (const auto& record : records) {
+      if (!record.used) {
+        removed[record.index] = true;
+        num_removed_events++;
+      }
+    }
+    if (num_removed_waits == 0 && num_removed_events == 0) {
+      return func_;
+    }
+
+    // Keep the bindings whose vars are used by others.
+    std::unordered_set<const Object*> used_vars{ell_->ret.get()};
+    for (size_t i = 0; i < n; ++i) {
+      Array<Expr> operands;
+      if (auto call = exprs[i].as<CallNode>()) {
+        operands = call->args;
+      } else if (auto tuple = exprs[i].as<TupleNode>()) {
+        operands = tuple->fields;
+      } else if (auto tgi = exprs[i].as<TupleGetItemNode>()) {
+        operands = {tgi->tuple};
+      } else {
+        operands = {exprs[i]};
+      }
+      for (const auto& operand : operands) {
+        used_vars.insert(operand.get());
+      }
+    }
+    ExplicitLetList ell;
+    for (size_t i = 0; i < n; ++i) {
+      if (!removed[i] || used_vars.count(vars[i].get())) {
+        ell.Push(vars[i], exprs[i]);
+      }
+    }
+    ell.ret = ell_->ret;
+    DLOG(INFO) << "Removed " << num_removed_waits << " of " << num_waits << " event waits and "
+               << num_removed_events << " of " << records.size() << " event records";
+    return Function(func_->params, ell.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*! \brief Get the integer value of a constant argument, or a var bound to a constant. */
+  bool GetInt(const Expr& arg, int64_t* value) {
+    Expr expr = arg;
+    if (auto var = arg.as<VarNode>()) {
+      auto it = consts_.find(GetRef<Var>(var));
+      if (it == consts_.end()) {
+        return false;
+      }
+      expr = it->second;
+    }
+    auto constant = expr.as<ConstantNode>();
+    auto int_value = constant ? constant->value.as<IntValueObj>() : nullptr;
+    if (!int_value) {
+      return false;
+    }
+    *value = int_value->value;
+    return true;
+  }
+
+  /*! \brief Get the vector clock of a stream, which starts from the last stream barrier. */
+  VectorClock& GetClock(const Key& stream) {
+    auto it = clocks_.find(stream);
+    if (it == clocks_.end()) {
+      it = clocks_.emplace(stream, barrier_clock_).first;
+    }
+    return it->second;
+  }
+
+  /*! \brief Merge the vector clock src into dst by taking the maximum of each stream. */
+  static void Merge(const VectorClock& src, VectorClock* dst) {
+    for (const auto& it : src) {
+      auto& value = (*dst)[it.first];
+      value = std::max(value, it.second);
+    }
+  }
+
+  /*! \brief The function to be simplified. */
+  Function func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief Mapping from the let-binding vars to the constants they bind. */
+  std::unordered_map<Var, Expr, ObjectPtrHash, ObjectPtrEqual> consts_;
+  /*! \brief The vector clock of each stream. */
+  std::map<Key, VectorClock> clocks_;
+  /*! \brief The vector clock known by all streams after the last stream barrier. */
+  VectorClock barrier_clock_;
+};
+
+}  // namespace remove_redundant_events
+
+Pass RemoveRedundantEvents() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return remove_redundant_events::EventMinimizer(f).Run();
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "RemoveRedundantEvents", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.RemoveRedundantEvents").set_body_typed(RemoveRedundantEvents);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,429 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file sequence_parallel.cc
+ * \brief Shard the replicated regions between the tensor-parallel matmuls, i.e., the layer norms,
+ * the dropouts and the residual adds, along the sequence, and replace the allreduce of the
+ * row-parallel matmuls by a reduce-scatter into such a region and an allgather out of it.
+ */
+#include <algorithm>
+#include <unordered_set>
+#include "raf/communicator.h"
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/sharding.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace sequence_parallel {
+
+using namespace raf::op;
+using namespace raf::sharding;
+using namespace raf::value;
+using namespace raf::distributed::communicator;
+
+template <typename T>
+using StdMap = std::unordered_map<Var, T, ObjectPtrHash, ObjectPtrEqual>;
+using VarSet = std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual>;
+
+/*!
+ * \brief The sequence axis, which is the first axis of the [seq, batch, hidden] layout, as the
+ * collectives scatter and gather along the first axis.
+ */
+constexpr int kSeqAxis = 0;
+/*! \brief The dimension of a replicated spec, and of the unset spec of the partial sums. */
+constexpr int kReplicated = -1;
+constexpr int kUnsetDim = -2;
+
+/*! \brief The matmul ops whose first operand has the rows on the sequence axis. */
+static const std::unordered_set<std::string> kRowMatmuls = {"raf.op.matmul", "raf.op.matmul_nt",
+                                                            "raf.op.dense"};
+
+/*! \brief Get the value of a constant argument, or an undefined value if it is not a constant. */
+Value GetConstValue(const Expr& expr) {
+  const auto* node = expr.as<ConstantNode>();
+  return node ? Downcast<Value>(ConstantExtractValue(GetRef<Constant>(node))) : Value();
+}
+
+/*! \brief The static shape of a tensor, or empty if it is not a typed tensor of static shape. */
+std::vector<int64_t> GetShape(const Type& type) {
+  std::vector<int64_t> shape;
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return {};
+  }
+  for (const auto& dim : ttype->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return {};
+    }
+    shape.push_back(imm->value);
+  }
+  return shape;
+}
+
+std::vector<int64_t> GetShape(const Expr& expr) {
+  return expr->checked_type_.defined() ? GetShape(expr->checked_type()) : std::vector<int64_t>();
+}
+
+/*!
+ * \brief Rewrite the allreduces of the output of the row-parallel matmuls to reduce-scatters
+ * along the sequence, and continue the sharded region to the elementwise and broadcast ops, the
+ * layer norms of the last axis and the dropouts that consume it. Each let-binding var keeps its
+ * replicated meaning: the local chunk of a sharded var is bound to a new var, and the replicated
+ * value is only gathered right before the first use out of the region. It is gathered by an
+ * allgather whose gradient is a reduce-scatter for the first operand of a matmul, which is a
+ * column-parallel matmul in a tensor-parallel model, or by _sequence_gather whose gradient takes
+ * the local chunk for the other ops, which are replicated. A replicated tensor enters a region by
+ * _sequence_scatter, which takes the local chunk without communication and whose gradient is an
+ * allgather. The collectives are annotated by ShardOpCallAttrs of the specs on the two sides.
+ *
+ * An allreduce whose result is only used out of the regions is kept, and the counter-based
+ * dropout is kept replicated, as its static offset would repeat the same mask on all chunks.
+ */
+class SequenceParallelizer {
+ public:
+  explicit SequenceParallelizer(const Function& func)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  Function Run() {
+    if (!ell_->ret.defined()) {
+      return func_;
+    }
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    // The tuple of a dropout can only be sharded if its other fields are unused.
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      if (auto tuple = exprs[i].as<TupleNode>()) {
+        tuples_[vars[i]] = GetRef<Tuple>(tuple);
+      }
+      auto tgi = exprs[i].as<TupleGetItemNode>();
+      if (tgi && tgi->index == 0 && tgi->tuple->IsInstance<VarNode>()) {
+        continue;
+      }
+      for (const auto& var : FreeVars(exprs[i])) {
+        escaping_.insert(var);
+      }
+    }
+    escaping_.insert(ell_->ret);
+
+    for (size_t i = 0; i < exprs.size(); ++i) {
+      const auto& var = vars[i];
+      const auto& expr = exprs[i];
+      if (RecordAllreduce(var, expr) || RewriteToSharded(var, expr)) {
+        continue;
+      }
+      if (auto call = expr.as<CallNode>()) {
+        auto op = call->op.as<OpNode>();
+        bool row_matmul = op && kRowMatmuls.count(op->name);
+        Array<Expr> args;
+        for (size_t j = 0; j < call->args.size(); ++j) {
+          if (auto arg_var = call->args[j].as<VarNode>()) {
+            args.push_back(Replicated(GetRef<Var>(arg_var), row_matmul && j == 0));
+          } else {
+            args.push_back(call->args[j]);
+          }
+        }
+        ell_out_.Push(var, Call(call->op, args, call->attrs, call->type_args));
+        continue;
+      }
+      for (const auto& free_var : FreeVars(expr)) {
+        Replicated(free_var, false);
+      }
+      ell_out_.Push(var, expr);
+    }
+    ell_out_.ret = Replicated(ell_->ret, false);
+    DLOG(INFO) << "Sequence parallelism converts " << num_allreduces_ << " allreduces, and shards "
+               << num_sharded_ << " ops";
+    return Function(func_->params, ell_out_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*!
+   * \brief Record an allreduce of a tensor whose sequence axis can be evenly sharded, which is
+   * not computed until its result is used.
+   * \param var The var the expression is bound to.
+   * \param expr The bound expression.
+   * \return Whether the expression is such an allreduce.
+   */
+  bool RecordAllreduce(const Var& var, const Expr& expr) {
+    static const Op& allreduce = Op::Get("raf.op._allreduce");
+    auto call = expr.as<CallNode>();
+    if (call == nullptr || call->op != allreduce || call->args.size() != 3) {
+      return false;
+    }
+    auto computation = GetConstValue(call->args[1]).as<StringValueObj>();
+    if (computation == nullptr || computation->value != "sum" ||
+        !call->args[2]->IsInstance<ConstantNode>()) {
+      return false;
+    }
+    // Only the allreduces of the same group are converted.
+    std::string group = raf::ir::AsText(call->args[2], false);
+    if (group_.empty()) {
+      auto rank_list = GetConstValue(call->args[2]);
+      int64_t size = rank_list.defined() ? Communicator::Get("void", rank_list)->size
+                                         : GetGlobalCommunicator()->size;
+      if (size <= 1) {
+        return false;
+      }
+      group_ = group;
+      rank_list_ = call->args[2];
+      size_ = size;
+      for (int64_t i = 0; i < size_; ++i) {
+        ranks_.push_back(Integer(i));
+      }
+    } else if (group != group_) {
+      return false;
+    }
+    Expr x = call->args[0];
+    if (auto tuple_var = x.as<VarNode>()) {
+      auto it = tuples_.find(GetRef<Var>(tuple_var));
+      x = it != tuples_.end() ? Expr(it->second) : x;
+    }
+    auto tuple = x.as<TupleNode>();
+    if (tuple == nullptr || tuple->fields.size() != 1 || !HasSeqAxis(tuple->fields[0])) {
+      return false;
+    }
+    allreduce_[var] = GetRef<Call>(call);
+    allreduce_input_[var] = tuple->fields[0];
+    return true;
+  }
+
+  /*!
+   * \brief Rewrite an op to its local chunk if it continues a sharded region, i.e., one of the
+   * inputs with the sequence axis is sharded or is the result of a recorded allreduce.
+   * \param var The var the expression is bound to.
+   * \param expr The bound expression.
+   * \return Whether the expression is rewritten.
+   */
+  bool RewriteToSharded(const Var& var, const Expr& expr) {
+    static const Op& layer_norm = Op::Get("raf.op.layer_norm");
+    static const Op& dropout = Op::Get("raf.op._contrib_dropout");
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    if (group_.empty()) {
+      return false;
+    }
+    if (auto tgi = expr.as<TupleGetItemNode>()) {
+      auto tuple_var = tgi->tuple.as<VarNode>();
+      auto it = tuple_var ? sharded_.find(GetRef<Var>(tuple_var)) : sharded_.end();
+      if (it == sharded_.end() || tgi->index != 0) {
+        return false;
+      }
+      Var local = MakeVar(var->name_hint() + "_sp", {});
+      ell_out_.Push(local, TupleGetItem(it->second, 0));
+      sharded_[var] = local;
+      unreplicated_.insert(var);
+      return true;
+    }
+    auto call = expr.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>()) {
+      return false;
+    }
+    auto op = Downcast<Op>(call->op);
+    bool tuple_out = false;
+    if (op == layer_norm) {
+      auto axis = GetConstValue(call->args[3]).as<IntValueObj>();
+      int64_t ndim = GetShape(call->args[0]).size();
+      if (axis == nullptr || ndim < 2 || (axis->value != -1 && axis->value != ndim - 1)) {
+        return false;
+      }
+    } else if (op == dropout) {
+      if (escaping_.count(var)) {
+        return false;
+      }
+      tuple_out = true;
+    } else {
+      auto tvm_op = OpDialect::Lower(op, "tvm");
+      if (!tvm_op.defined() || fpattern.get(tvm_op, kOpaque) > kBroadcast) {
+        return false;
+      }
+    }
+    auto out_type = var->checked_type();
+    if (tuple_out) {
+      out_type = Downcast<TupleType>(out_type)->fields[0];
+    }
+    auto out_shape = GetShape(out_type);
+    if (out_shape.empty() || out_shape[kSeqAxis] % size_ != 0) {
+      return false;
+    }
+    // The inputs that are broadcast along the sequence axis stay replicated.
+    auto on_seq_axis = [&out_shape](const Expr& arg) {
+      auto shape = GetShape(arg);
+      return shape.size() == out_shape.size() && shape[kSeqAxis] == out_shape[kSeqAxis];
+    };
+    bool continues = false;
+    for (const auto& arg : call->args) {
+      auto arg_var = arg.as<VarNode>();
+      continues |= arg_var && on_seq_axis(arg) &&
+                   (sharded_.count(GetRef<Var>(arg_var)) || allreduce_.count(GetRef<Var>(arg_var)));
+    }
+    if (!continues) {
+      return false;
+    }
+    Array<Expr> args;
+    for (const auto& arg : call->args) {
+      if (!arg->IsInstance<VarNode>()) {
+        args.push_back(arg);
+      } else if (on_seq_axis(arg)) {
+        args.push_back(Sharded(Downcast<Var>(arg)));
+      } else {
+        args.push_back(Replicated(Downcast<Var>(arg), false));
+      }
+    }
+    Var local = MakeVar(var->name_hint() + "_sp", {});
+    ell_out_.Push(local, Call(op, args, call->attrs, call->type_args));
+    sharded_[var] = local;
+    if (!tuple_out) {
+      unreplicated_.insert(var);
+    }
+    num_sharded_++;
+    return true;
+  }
+
+  /*! \brief Whether a tensor has a sequence axis that can be evenly sharded. */
+  bool HasSeqAxis(const Expr& expr) {
+    auto shape = GetShape(expr);
+    return !shape.empty() && shape[kSeqAxis] % size_ == 0;
+  }
+
+  /*! \brief The spec of a tensor of ndim dimensions, which is sharded on dim or replicated. */
+  ShardSpec MakeSpec(int dim, int ndim) {
+    std::vector<Integer> phy_shape(std::max(ndim, 1), Integer(1));
+    if (dim == kReplicated) {
+      phy_shape[0] = Integer(size_);
+      return ShardSpec::make(ranks_, phy_shape, phy_shape, true);
+    }
+    phy_shape[dim] = Integer(size_);
+    return ShardSpec::make(ranks_, phy_shape, std::vector<Integer>(phy_shape.size(), Integer(1)),
+                           true);
+  }
+
+  /*! \brief Bind a collective from the spec of the input to the spec of the output to a var. */
+  void PushCollective(const Var& ret, const Op& op, const Array<Expr>& args, int ndim,
+                      int from_dim, int to_dim) {
+    BaseShardSpec from = from_dim == kUnsetDim ? BaseShardSpec(UnsetShardSpec::make())
+                                               : BaseShardSpec(MakeSpec(from_dim, ndim));
+    ell_out_.Push(ret, Call(op, args, ShardOpCallAttrs::make({from}, {MakeSpec(to_dim, ndim)})));
+  }
+
+  /*!
+   * \brief Get the local chunk of a tensor, which reduce-scatters a recorded allreduce, or takes
+   * the chunk of a replicated tensor.
+   */
+  Var Sharded(const Var& var) {
+    static const Op& reduce_scatter = Op::Get("raf.op._reduce_scatter");
+    static const Op& sequence_scatter = Op::Get("raf.op._sequence_scatter");
+    auto it = sharded_.find(var);
+    if (it != sharded_.end()) {
+      return it->second;
+    }
+    int ndim = GetShape(var).size();
+    auto ar = allreduce_.find(var);
+    if (ar != allreduce_.end()) {
+      // The partial sums have an unset spec, as they are not a placement of the tensor.
+      Expr x = allreduce_input_.at(var);
+      if (x->IsInstance<VarNode>()) {
+        x = Replicated(Downcast<Var>(x), false);
+      }
+      Var local = MakeVar(var->name_hint() + "_rs", {});
+      PushCollective(local, reduce_scatter, {x, MakeConstant(StringValue::make("sum")), rank_list_},
+                     ndim, kUnsetDim, kSeqAxis);
+      allreduce_.erase(ar);
+      unreplicated_.insert(var);
+      num_allreduces_++;
+      return sharded_[var] = local;
+    }
+    Var local = MakeVar(var->name_hint() + "_sp", {});
+    PushCollective(local, sequence_scatter, {var, rank_list_}, ndim, kReplicated, kSeqAxis);
+    return sharded_[var] = local;
+  }
+
+  /*!
+   * \brief Get the replicated value of a var, which computes a recorded allreduce, or gathers the
+   * chunks of a sharded var if its replicated value is not computed.
+   * \param var The var.
+   * \param column_parallel Whether it is the first operand of a matmul.
+   */
+  Var Replicated(const Var& var, bool column_parallel) {
+    static const Op& allgather = Op::Get("raf.op._allgather");
+    static const Op& sequence_gather = Op::Get("raf.op._sequence_gather");
+    auto ar = allreduce_.find(var);
+    if (ar != allreduce_.end()) {
+      ell_out_.Push(var, ar->second);
+      allreduce_.erase(ar);
+      return var;
+    }
+    if (!unreplicated_.count(var)) {
+      return var;
+    }
+    Var local = sharded_.at(var);
+    int ndim = GetShape(var).size();
+    if (column_parallel) {
+      auto it = gathered_.find(var);
+      if (it != gathered_.end()) {
+        return it->second;
+      }
+      Var ret = MakeVar(var->name_hint() + "_ag", {});
+      PushCollective(ret, allgather, {local, MakeConstant(ScalarValue::make(kSeqAxis)), rank_list_},
+                     ndim, kSeqAxis, kReplicated);
+      return gathered_[var] = ret;
+    }
+    PushCollective(var, sequence_gather, {local, rank_list_}, ndim, kSeqAxis, kReplicated);
+    unreplicated_.erase(var);
+    return var;
+  }
+
+  /*! \brief The function to be converted. */
+  const Function& func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The let list of the converted function. */
+  ExplicitLetList ell_out_;
+  /*! \brief The rank list of the converted allreduces, its text, and the size of the group. */
+  Expr rank_list_;
+  std::string group_;
+  int64_t size_ = 1;
+  /*! \brief The ranks of the specs, which are the indices in the group. */
+  Array<Integer> ranks_;
+  /*! \brief The tuple of each tuple var. */
+  StdMap<Tuple> tuples_;
+  /*! \brief The vars that are used other than by taking the first field. */
+  VarSet escaping_;
+  /*! \brief The allreduces that have not been computed, and their tensor inputs. */
+  StdMap<Call> allreduce_;
+  StdMap<Expr> allreduce_input_;
+  /*! \brief The var of the local chunk of each sharded var. */
+  StdMap<Var> sharded_;
+  /*! \brief The sharded vars whose replicated values have not been computed. */
+  VarSet unreplicated_;
+  /*! \brief The allgathered value of each sharded var for the matmuls. */
+  StdMap<Var> gathered_;
+  /*! \brief The numbers of the converted allreduces and the sharded ops. */
+  int num_allreduces_ = 0;
+  int num_sharded_ = 0;
+};
+
+}  // namespace sequence_parallel
+
+Pass SequenceParallel() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return sequence_parallel::SequenceParallelizer(f).Run();
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "SequenceParallelHelper", {});
+  PassInfo pass_info(1, "SequenceParallel", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.SequenceParallel").set_body_typed(SequenceParallel);
+
+}  // namespace pass
+}  // namespace raf
@@ -0,0 +1,457 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file sharding_propagation.cc
+ * \brief Propagate the sharding specs from a few annotated ops to all ops, and insert the
+ * resharding ops with the minimal estimated communication where the spec of a tensor differs
+ * from the spec its user requires.
+ */
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/sharding.h"
+#include "raf/value.h"
+
+#include "./common.h"
+#include "./let_list.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace sharding_propagation {
+
+using namespace raf::sharding;
+using common::shape_utils::BytesCompactType;
+
+/*! \brief The layout of a spec, which is the sharded dimension or one of the following. */
+constexpr int kReplicated = -1;
+/*! \brief A spec sharded on multiple dimensions or with subgroups, which is kept as is. */
+constexpr int kUnsupported = -2;
+
+/*! \brief The layouts of the tensor inputs and the output of an op. */
+struct Strategy {
+  std::vector<int> in_dims;
+  int out_dim;
+};
+
+/*! \brief The (A row, B column) dimensions of the matmul ops, and whether they are batched. */
+static const std::unordered_map<std::string, std::tuple<int, int, bool>> kMatmulDims = {
+    {"raf.op.matmul", {0, 1, false}},       {"raf.op.matmul_nt", {0, 0, false}},
+    {"raf.op.matmul_tn", {1, 1, false}},    {"raf.op.matmul_tt", {1, 0, false}},
+    {"raf.op.dense", {0, 0, false}},        {"raf.op.batch_matmul", {1, 2, true}},
+    {"raf.op.batch_matmul_nt", {1, 1, true}}, {"raf.op.batch_matmul_tn", {2, 2, true}},
+    {"raf.op.batch_matmul_tt", {2, 1, true}},
+};
+
+class ShardingPropagator {
+ public:
+  explicit ShardingPropagator(const Function& func)
+      : func_(func), ell_(ExplicitLetList::make(func->body)) {
+  }
+
+  /*!
+   * \brief Propagate the specs in the program order. The specs annotated by ShardOpCallAttrs are
+   * kept, where the sin of a call are the specs of its tensor arguments in order, and an unset
+   * spec is inferred. A parameter takes the spec of its first annotated use, or replicated.
+   *
+   * For an op whose specs are not fully annotated, the candidate strategies are:
+   *
+   * 1. Elementwise and broadcast ops: the output is sharded on a dimension that an input is
+   *    sharded on, and the inputs are sharded on the aligned dimensions, or replicated if they are
+   *    broadcast on it.
+   *
+   * 2. Matmul ops: the rows of A are sharded, the columns of B are sharded, or the batch of both
+   *    is sharded, so no partial sums are produced.
+   *
+   * 3. All ops: the inputs and the output are replicated.
+   *
+   * The strategy with the minimal cost to reshard its inputs is selected, where slicing a
+   * replicated tensor is free, allgather costs (p-1)/p of the tensor size, all-to-all between two
+   * sharded dimensions costs (p-1)/p^2, and any other resharding costs the full size. A tensor
+   * with an immutable spec is only resharded if no other strategy applies.
+   */
+  Function Run() {
+    const auto& vars = ell_->vars;
+    const auto& exprs = ell_->exprs;
+    size_t n = vars.size();
+    // Find the ranks and the specs of the parameters from the annotations.
+    std::unordered_set<const Object*> params(func_->params.begin(), func_->params.end());
+    for (size_t i = 0; i < n; ++i) {
+      auto call = exprs[i].as<CallNode>();
+      auto attrs = call ? call->attrs.as<ShardOpCallAttrs>() : nullptr;
+      if (!attrs) {
+        continue;
+      }
+      auto inputs = TensorArgs(call);
+      for (size_t j = 0; j < attrs->sin.size() && j < inputs.size(); ++j) {
+        auto spec = attrs->sin[j].as<ShardSpecObj>();
+        if (spec && params.count(inputs[j].get()) && !spec_of_.count(inputs[j].get())) {
+          spec_of_[inputs[j].get()] = attrs->sin[j];
+        }
+        if (spec && !ranks_.defined()) {
+          ranks_ = spec->ranks;
+        }
+      }
+      for (const auto& spec : attrs->sout) {
+        if (spec.as<ShardSpecObj>() && !ranks_.defined()) {
+          ranks_ = Downcast<ShardSpec>(spec)->ranks;
+        }
+      }
+    }
+    if (!ranks_.defined() || ranks_.size() <= 1) {
+      return func_;
+    }
+    for (const auto& param : func_->params) {
+      if (!spec_of_.count(param.get()) && param->checked_type().as<TensorTypeNode>()) {
+        spec_of_[param.get()] = MakeSpec(kReplicated, NDim(param));
+      }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      const auto& var = vars[i];
+      const auto& expr = exprs[i];
+      if (auto call = expr.as<CallNode>()) {
+        bool annotatable = !call->attrs.defined() || call->attrs.as<ShardOpCallAttrs>();
+        if (call->op.as<OpNode>() && annotatable) {
+          ell_out_.Push(var, Propagate(var, call));
+          continue;
+        }
+      } else if (auto tgi = expr.as<TupleGetItemNode>()) {
+        auto it = tuple_specs_.find(tgi->tuple.get());
+        if (it != tuple_specs_.end() && tgi->index < static_cast<int>(it->second.size())) {
+          spec_of_[var.get()] = it->second[tgi->index];
+        }
+      } else if (auto tuple = expr.as<TupleNode>()) {
+        Array<BaseShardSpec> specs;
+        for (const auto& field : tuple->fields) {
+          auto it = spec_of_.find(field.get());
+          specs.push_back(it != spec_of_.end() ? it->second : UnsetShardSpec::make());
+        }
+        tuple_specs_[var.get()] = specs;
+      } else if (spec_of_.count(expr.get())) {
+        spec_of_[var.get()] = spec_of_[expr.get()];
+      }
+      ell_out_.Push(var, expr);
+    }
+    ell_out_.ret = ell_->ret;
+    DLOG(INFO) << "Sharding propagation inserts " << num_reshards_
+               << " reshards with the estimated communication of " << total_cost_ / 1048576.0
+               << " MBs";
+    return Function(func_->params, ell_out_.AsExpr(), func_->ret_type, func_->type_params,
+                    func_->attrs);
+  }
+
+ private:
+  /*! \brief The tensor arguments of a call. */
+  static std::vector<Var> TensorArgs(const CallNode* call) {
+    std::vector<Var> inputs;
+    for (const auto& arg : call->args) {
+      auto var = arg.as<VarNode>();
+      if (var && var->checked_type_.defined() && var->checked_type().as<TensorTypeNode>()) {
+        inputs.push_back(GetRef<Var>(var));
+      }
+    }
+    return inputs;
+  }
+
+  /*! \brief The static shape of a tensor, or empty if it is dynamic. */
+  static std::vector<int64_t> Shape(const Expr& expr) {
+    std::vector<int64_t> shape;
+    auto ttype = expr->checked_type().as<TensorTypeNode>();
+    for (const auto& dim : ttype->shape) {
+      auto imm = dim.as<IntImmNode>();
+      if (!imm) {
+        return {};
+      }
+      shape.push_back(imm->value);
+    }
+    return shape;
+  }
+
+  static int NDim(const Expr& expr) {
+    return expr->checked_type().as<TensorTypeNode>()->shape.size();
+  }
+
+  /*! \brief Make a spec with all ranks, which is replicated or sharded on one dimension. */
+  ShardSpec MakeSpec(int dim, int ndim) {
+    std::vector<Integer> phy_shape(std::max(ndim, 1), Integer(1));
+    int64_t size = ranks_.size();
+    if (dim == kReplicated) {
+      phy_shape[0] = Integer(size);
+      return ShardSpec::make(ranks_, phy_shape, phy_shape, true);
+    }
+    phy_shape[dim] = Integer(size);
+    return ShardSpec::make(ranks_, phy_shape, std::vector<Integer>(phy_shape.size(), Integer(1)),
+                           true);
+  }
+
+  /*! \brief The spec of a tensor var, which is replicated if it is produced by an opaque call. */
+  BaseShardSpec SpecOf(const Var& var) {
+    auto it = spec_of_.find(var.get());
+    if (it != spec_of_.end()) {
+      return it->second;
+    }
+    return spec_of_[var.get()] = MakeSpec(kReplicated, NDim(var));
+  }
+
+  /*! \brief Get the layout of a spec. */
+  int GetLayout(const BaseShardSpec& base) {
+    auto spec = base.as<ShardSpecObj>();
+    if (!spec || spec->ranks.size() != ranks_.size()) {
+      return kUnsupported;
+    }
+    for (size_t i = 0; i < ranks_.size(); ++i) {
+      if (spec->ranks[i]->value != ranks_[i]->value) {
+        return kUnsupported;
+      }
+    }
+    int dim = kReplicated;
+    for (size_t i = 0; i < spec->logic_shape.size(); ++i) {
+      if (spec->logic_shape[i]->value == 1) {
+        continue;
+      }
+      if (dim != kReplicated || spec->logic_shape[i]->value != spec->nshard_ ||
+          spec->ngroup_ != 1 || spec->nshard_ != static_cast<int64_t>(ranks_.size())) {
+        return kUnsupported;
+      }
+      dim = i;
+    }
+    return dim;
+  }
+
+  /*! \brief Whether two specs place the tensor in the same way. */
+  bool SameSpec(const BaseShardSpec& lhs, const BaseShardSpec& rhs) {
+    if (lhs.same_as(rhs)) {
+      return true;
+    }
+    int lhs_layout = GetLayout(lhs), rhs_layout = GetLayout(rhs);
+    if (lhs_layout != kUnsupported || rhs_layout != kUnsupported) {
+      return lhs_layout == rhs_layout;
+    }
+    auto l = lhs.as<ShardSpecObj>(), r = rhs.as<ShardSpecObj>();
+    return l && r && tvm::StructuralEqual()(l->ranks, r->ranks) &&
+           tvm::StructuralEqual()(l->phy_shape, r->phy_shape) &&
+           tvm::StructuralEqual()(l->subgroup_shape, r->subgroup_shape);
+  }
+
+  /*! \brief The estimated bytes to communicate for resharding a tensor. */
+  double ReshardCost(const BaseShardSpec& from, const BaseShardSpec& to, double bytes) {
+    if (SameSpec(from, to)) {
+      return 0;
+    }
+    int src = GetLayout(from), dst = GetLayout(to);
+    double p = ranks_.size();
+    if (src == kReplicated && dst >= 0) {
+      // Slicing is free, but still prefer not to reshard.
+      return 1;
+    } else if (src >= 0 && dst == kReplicated) {
+      return bytes * (p - 1) / p;
+    } else if (src >= 0 && dst >= 0) {
+      return bytes * (p - 1) / p / p;
+    }
+    return bytes;
+  }
+
+  /*!
+   * \brief Get the candidate strategies of a call, where the replicated one comes last. The
+   * elementwise strategies follow the annotated input specs, or the current ones if unset.
+   */
+  std::vector<Strategy> GetStrategies(const CallNode* call, const std::vector<Var>& inputs,
+                                      const Array<BaseShardSpec>& sin) {
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    std::vector<Strategy> strategies;
+    int64_t p = ranks_.size();
+    auto op = Downcast<Op>(call->op);
+    bool tensor_out = call->checked_type().as<TensorTypeNode>();
+    auto out_shape = tensor_out ? Shape(GetRef<Call>(call)) : std::vector<int64_t>();
+    if (!out_shape.empty()) {
+      auto matmul = kMatmulDims.find(op->name);
+      int pattern = kOpaque;
+      auto tvm_op = OpDialect::Lower(op, "tvm");
+      if (tvm_op.defined()) {
+        pattern = fpattern.get(tvm_op, kOpaque);
+      }
+      if (matmul != kMatmulDims.end() && inputs.size() == 2) {
+        int row, col;
+        bool batched;
+        std::tie(row, col, batched) = matmul->second;
+        int out_ndim = out_shape.size();
+        strategies.push_back({{row, kReplicated}, out_ndim - 2});
+        strategies.push_back({{kReplicated, col}, out_ndim - 1});
+        if (batched) {
+          strategies.push_back({{0, 0}, 0});
+        }
+      } else if (pattern <= kBroadcast) {
+        std::vector<int> out_dims;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+          bool annotated = i < sin.size() && sin[i].as<ShardSpecObj>();
+          int layout = GetLayout(annotated ? sin[i] : SpecOf(inputs[i]));
+          int dim = layout + static_cast<int>(out_shape.size()) - NDim(inputs[i]);
+          if (layout >= 0 &&
+              std::find(out_dims.begin(), out_dims.end(), dim) == out_dims.end()) {
+            out_dims.push_back(dim);
+          }
+        }
+        for (auto dim : out_dims) {
+          Strategy strategy{{}, dim};
+          for (const auto& input : inputs) {
+            auto in_shape = Shape(input);
+            int in_dim = dim - static_cast<int>(out_shape.size() - in_shape.size());
+            bool aligned = in_dim >= 0 && in_dim < static_cast<int>(in_shape.size()) &&
+                           in_shape[in_dim] == out_shape[dim];
+            strategy.in_dims.push_back(aligned ? in_dim : kReplicated);
+          }
+          strategies.push_back(strategy);
+        }
+      }
+      // Only keep the strategies that evenly shard the tensors.
+      std::vector<Strategy> valid;
+      for (const auto& strategy : strategies) {
+        bool ok = strategy.out_dim >= 0 &&
+                  strategy.out_dim < static_cast<int>(out_shape.size()) &&
+                  out_shape[strategy.out_dim] % p == 0;
+        for (size_t i = 0; i < inputs.size() && ok; ++i) {
+          auto in_shape = Shape(inputs[i]);
+          int dim = strategy.in_dims[i];
+          ok = dim == kReplicated ||
+               (dim < static_cast<int>(in_shape.size()) && in_shape[dim] % p == 0);
+        }
+        if (ok) {
+          valid.push_back(strategy);
+        }
+      }
+      strategies = valid;
+    }
+    strategies.push_back({std::vector<int>(inputs.size(), kReplicated), kReplicated});
+    return strategies;
+  }
+
+  /*! \brief Select the specs of a call and reshard its inputs. */
+  Expr Propagate(const Var& var, const CallNode* call) {
+    static const Op& reshard_op = Op::Get("raf.op._reshard");
+    auto inputs = TensorArgs(call);
+    Array<BaseShardSpec> sin, sout;
+    if (auto attrs = call->attrs.as<ShardOpCallAttrs>()) {
+      sin = attrs->sin;
+      sout = attrs->sout;
+    }
+    auto annotated = [](const Array<BaseShardSpec>& specs, size_t i) {
+      return i < specs.size() && specs[i].as<ShardSpecObj>();
+    };
+    bool tensor_out = call->checked_type().as<TensorTypeNode>();
+
+    // Select the strategy with the minimal cost.
+    Array<BaseShardSpec> best_in;
+    BaseShardSpec best_out;
+    double best_cost = std::numeric_limits<double>::infinity();
+    bool best_immutable = true;
+    auto strategies = GetStrategies(call, inputs, sin);
+    for (size_t k = 0; k < strategies.size(); ++k) {
+      const auto& strategy = strategies[k];
+      // The annotated specs are kept by the replicated strategy, and filter the others.
+      bool fallback = k + 1 == strategies.size();
+      bool conflict = false;
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        conflict |= annotated(sin, i) && GetLayout(sin[i]) != strategy.in_dims[i];
+      }
+      conflict |= tensor_out && annotated(sout, 0) && GetLayout(sout[0]) != strategy.out_dim;
+      if (conflict && !fallback) {
+        continue;
+      }
+      Array<BaseShardSpec> in_specs;
+      double cost = 0;
+      bool immutable = false;
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        auto spec = annotated(sin, i) ? sin[i] : MakeSpec(strategy.in_dims[i], NDim(inputs[i]));
+        auto curr = SpecOf(inputs[i]);
+        double bytes = BytesCompactType(inputs[i]->checked_type());
+        cost += ReshardCost(curr, spec, bytes);
+        auto curr_spec = curr.as<ShardSpecObj>();
+        immutable |= curr_spec && !curr_spec->mutable_ && !SameSpec(curr, spec);
+        in_specs.push_back(spec);
+      }
+      BaseShardSpec out_spec;
+      if (tensor_out) {
+        out_spec = annotated(sout, 0) ? sout[0] : MakeSpec(strategy.out_dim, NDim(var));
+      }
+      if ((best_immutable && !immutable) || (best_immutable == immutable && cost < best_cost)) {
+        best_in = in_specs;
+        best_out = out_spec;
+        best_cost = cost;
+        best_immutable = immutable;
+      }
+    }
+
+    // Reshard the inputs.
+    std::unordered_map<const Object*, Expr> resharded;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      auto curr = SpecOf(inputs[i]);
+      if (SameSpec(curr, best_in[i])) {
+        continue;
+      }
+      auto reshard = MakeVar(inputs[i]->name_hint() + "_reshard", inputs[i]->checked_type());
+      ell_out_.Push(reshard, Call(reshard_op, {inputs[i]}, ShardOpCallAttrs::make({curr},
+                                                                                  {best_in[i]})));
+      spec_of_[reshard.get()] = best_in[i];
+      resharded[inputs[i].get()] = reshard;
+      num_reshards_++;
+    }
+    total_cost_ += best_cost;
+    Array<Expr> args;
+    for (const auto& arg : call->args) {
+      auto it = resharded.find(arg.get());
+      args.push_back(it != resharded.end() ? it->second : arg);
+    }
+
+    // Record the specs of the outputs.
+    if (tensor_out) {
+      sout = {best_out};
+      spec_of_[var.get()] = best_out;
+    } else if (auto tuple_type = call->checked_type().as<TupleTypeNode>()) {
+      sout.clear();
+      for (const auto& field : tuple_type->fields) {
+        auto ttype = field.as<TensorTypeNode>();
+        sout.push_back(ttype ? BaseShardSpec(MakeSpec(kReplicated, ttype->shape.size()))
+                             : BaseShardSpec(UnsetShardSpec::make()));
+      }
+      tuple_specs_[var.get()] = sout;
+    }
+    return Call(call->op, args, ShardOpCallAttrs::make(best_in, sout), call->type_args);
+  }
+
+  /*! \brief The function to be annotated. */
+  Function func_;
+  /*! \brief The let list of the function. */
+  std::unique_ptr<ExplicitLetList> ell_;
+  /*! \brief The generated let list. */
+  ExplicitLetList ell_out_;
+  /*! \brief The ranks of the annotated specs. */
+  Array<Integer> ranks_;
+  /*! \brief The spec of each tensor var, and the specs of the fields of each tuple var. */
+  std::unordered_map<const Object*, BaseShardSpec> spec_of_;
+  std::unordered_map<const Object*, Array<BaseShardSpec>> tuple_specs_;
+  /*! \brief The number of inserted reshards and their estimated communication in bytes. */
+  int num_reshards_ = 0;
+  double total_cost_ = 0;
+};
+
+}  // namespace sharding_propagation
+
+Pass ShardingPropagation() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return sharding_propagation::ShardingPropagator(f).Run();
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "ShardingPropagation", {"InferType"});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ShardingPropagation").set_body_typed(ShardingPropagation);
+
+}  // namespace pass
+}  // namespace raf
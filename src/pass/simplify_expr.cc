@@ -9,6 +9,9 @@
  * \file simplify_expr.cc
  * \brief Simplifies the commonly seen patterns.
  */
+#include <map>
+#include <tuple>
+#include "raf/executor.h"
 #include "raf/op.h"
 #include "raf/ir_ext.h"
 #include "raf/op_utils.h"
@@ -638,6 +641,690 @@ class SimplifyReshape : public DFPatternRewrite {
   DFPattern data_pat_;
 };
 
+/*!
+ * \brief Get the normalized axes of a transpose.
+ * \param call The transpose call.
+ * \return The axes, or an empty vector if they are unknown at compile time.
+ */
+std::vector<int64_t> GetTransposeAxes(const Call& call) {
+  const auto* data_ty = call->args[0]->checked_type().as<TensorTypeNode>();
+  const auto* axes_node = call->args[1].as<ConstantNode>();
+  if (data_ty == nullptr || axes_node == nullptr) {
+    return {};
+  }
+  int64_t ndim = data_ty->shape.size();
+  auto axes_value = ConstantExtractValue(GetRef<Constant>(axes_node));
+  std::vector<int64_t> axes;
+  if (!axes_value.defined()) {
+    // The axes are reversed by default.
+    for (int64_t i = ndim - 1; i >= 0; --i) {
+      axes.push_back(i);
+    }
+    return axes;
+  }
+  if (!axes_value->IsInstance<TupleValueObj>()) {
+    return {};
+  }
+  axes = GetShapeVecFromValue(Downcast<Value>(axes_value));
+  if (static_cast<int64_t>(axes.size()) != ndim) {
+    return {};
+  }
+  for (auto& axis : axes) {
+    axis = axis < 0 ? axis + ndim : axis;
+  }
+  return axes;
+}
+
+/*!
+ * \brief Simplify identity transposes, and merge back-to-back transposes into one, which are
+ * commonly seen at the boundaries of the layout conversion.
+ */
+class SimplifyTranspose : public DFPatternRewrite {
+ public:
+  SimplifyTranspose() {
+    data_pat_ = IsWildcard();
+    pattern_ = IsOp("raf.op.transpose")({data_pat_, IsWildcard()});
+    pattern_ = IsOp("raf.op.transpose")({pattern_, IsWildcard()}) || pattern_;
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto transpose_op = Op::Get("raf.op.transpose");
+    auto call = Downcast<Call>(pre);
+    std::vector<int64_t> axes = GetTransposeAxes(call);
+    if (axes.empty()) {
+      return post;
+    }
+    // Compose the axes with the axes of the previous transpose.
+    if (auto prev_node = call->args[0].as<CallNode>()) {
+      if (prev_node->op->IsInstance<OpNode>() && Downcast<Op>(prev_node->op) == transpose_op) {
+        std::vector<int64_t> prev_axes = GetTransposeAxes(GetRef<Call>(prev_node));
+        if (prev_axes.empty()) {
+          return post;
+        }
+        for (auto& axis : axes) {
+          axis = prev_axes[axis];
+        }
+      }
+    }
+
+    auto data = node_map[data_pat_][0];
+    bool identity = true;
+    for (size_t i = 0; i < axes.size(); ++i) {
+      identity = identity && axes[i] == static_cast<int64_t>(i);
+    }
+    if (identity) {
+      return data;
+    }
+    auto ret = Call(transpose_op, {data, MakeConstant(ArrayToIntTuple(axes))});
+    ret->checked_type_ = pre->checked_type();
+    return ret;
+  }
+
+ private:
+  /*! \brief Pattern input. */
+  DFPattern data_pat_;
+};
+
+/*!
+ * \brief Fold the transposes of the last two axes of the operands of matmuls into the transpose
+ * flags of the matmuls, e.g., batch_matmul(a, transpose(b, (0, 2, 1))) to batch_matmul_nt(a, b),
+ * so the transposes of the heads of the attention are not materialized.
+ */
+class SimplifyMatmulTranspose : public DFPatternRewrite {
+ public:
+  SimplifyMatmulTranspose() {
+    pattern_ = IsOp("raf.op.dense") || IsOp("raf.op.matmul") || IsOp("raf.op.matmul_nt") ||
+               IsOp("raf.op.matmul_tn") || IsOp("raf.op.matmul_tt") ||
+               IsOp("raf.op.batch_matmul") || IsOp("raf.op.batch_matmul_nt") ||
+               IsOp("raf.op.batch_matmul_tn") || IsOp("raf.op.batch_matmul_tt");
+    pattern_ = pattern_({IsWildcard(), IsWildcard()});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto transpose_op = Op::Get("raf.op.transpose");
+    // The ops of the matmuls indexed by whether the operands are transposed.
+    static const std::vector<std::vector<Op>> matmul_ops{
+        {Op::Get("raf.op.matmul"), Op::Get("raf.op.matmul_nt"), Op::Get("raf.op.matmul_tn"),
+         Op::Get("raf.op.matmul_tt")},
+        {Op::Get("raf.op.batch_matmul"), Op::Get("raf.op.batch_matmul_nt"),
+         Op::Get("raf.op.batch_matmul_tn"), Op::Get("raf.op.batch_matmul_tt")}};
+    static auto dense_op = Op::Get("raf.op.dense");
+    auto call = Downcast<Call>(pre);
+    Op op = Downcast<Op>(call->op);
+    op = op == dense_op ? matmul_ops[0][1] : op;
+    int batched = -1, flags = -1;
+    for (int i = 0; i < 2; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        if (matmul_ops[i][j] == op) {
+          batched = i;
+          flags = j;
+        }
+      }
+    }
+    CHECK_GE(flags, 0);
+    bool changed = false;
+    std::vector<Expr> args{call->args[0], call->args[1]};
+    for (int i = 0; i < 2; ++i) {
+      const auto* arg = args[i].as<CallNode>();
+      if (arg == nullptr || !arg->op.same_as(transpose_op)) {
+        continue;
+      }
+      std::vector<int64_t> axes = GetTransposeAxes(GetRef<Call>(arg));
+      std::vector<int64_t> swap_last{0, 2, 1};
+      if (batched == 0) {
+        swap_last = {1, 0};
+      }
+      if (axes != swap_last) {
+        continue;
+      }
+      // The flags are (transpose_a << 1) | transpose_b.
+      args[i] = arg->args[0];
+      flags ^= i == 0 ? 2 : 1;
+      changed = true;
+    }
+    if (!changed) {
+      return post;
+    }
+    return Call(matmul_ops[batched][flags], {args[0], args[1]});
+  }
+};
+
+/*! \brief Get the value of a constant scalar, which may also be a 0-dim tensor. */
+bool GetScalarConst(const Expr& arg, double* value) {
+  if (auto node = arg.as<ConstantNode>()) {
+    if (auto val_obj = node->value.as<IntValueObj>()) {
+      *value = val_obj->value;
+      return true;
+    } else if (auto val_obj = node->value.as<FloatValueObj>()) {
+      *value = val_obj->value;
+      return true;
+    } else if (auto val_obj = node->value.as<TensorValueObj>()) {
+      tensor::Tensor tensor = val_obj->tensor;
+      if (tensor->ndim == 0 && (DataType(tensor->dtype) == DataType::Float(32) ||
+                                DataType(tensor->dtype) == DataType::Float(16))) {
+        *value = GetScalarValueData<float>(GetRef<TensorValue>(val_obj));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*!
+ * \brief Rewrite the attention of batch_matmul_nt -> (scale) -> (mask) -> softmax ->
+ * batch_matmul to the fused attention, which does not materialize the attention matrix.
+ * It is only applied on CUDA, where the fused attention has a kernel.
+ */
+class SimplifyAttention : public DFPatternRewrite {
+ public:
+  SimplifyAttention() {
+    q_pat_ = IsWildcard();
+    k_pat_ = IsWildcard();
+    v_pat_ = IsWildcard();
+    scale_pat_ = IsConstant();
+    mask_pat_ = IsWildcard();
+    axis_pat_ = IsConstant();
+    DFPattern score = IsOp("raf.op.batch_matmul_nt")({q_pat_, k_pat_});
+    scale_op_ = IsOp("raf.op.multiply") || IsOp("raf.op.divide");
+    score = scale_op_({score, scale_pat_}) || score;
+    mask_add_ = IsOp("raf.op.add")({score, mask_pat_, IsWildcard(), IsWildcard()});
+    score = mask_add_ || score;
+    DFPattern prob = IsOp("raf.op.softmax")({score, axis_pat_});
+    pattern_ = IsOp("raf.op.batch_matmul")({prob, v_pat_});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto attention_op = Op::Get("raf.op.attention");
+    static auto divide_op = Op::Get("raf.op.divide");
+    if (Device::Current(true).device_type() != DevType::kCUDA()) {
+      return post;
+    }
+    auto q = node_map[q_pat_][0];
+    auto k = node_map[k_pat_][0];
+    auto v = node_map[v_pat_][0];
+    auto q_ty = q->checked_type_.as<TensorTypeNode>();
+    auto k_ty = k->checked_type_.as<TensorTypeNode>();
+    auto v_ty = v->checked_type_.as<TensorTypeNode>();
+    if (q_ty == nullptr || k_ty == nullptr || v_ty == nullptr || q_ty->shape.size() != 3) {
+      return post;
+    }
+    auto dtype = q_ty->dtype;
+    if ((dtype != DataType::Float(32) && dtype != DataType::Float(16)) ||
+        k_ty->dtype != dtype || v_ty->dtype != dtype) {
+      return post;
+    }
+    std::vector<int64_t> q_shape, k_shape, v_shape;
+    try {
+      q_shape = ArrayToInt(q_ty->shape);
+      k_shape = ArrayToInt(k_ty->shape);
+      v_shape = ArrayToInt(v_ty->shape);
+    } catch (const dmlc::Error& e) {
+      // Shape is not static, don't fuse.
+      return post;
+    }
+    // The fused attention requires the same head dim of q, k and v.
+    if (q_shape[2] != k_shape[2] || q_shape[2] != v_shape[2] || q_shape[2] > 256) {
+      return post;
+    }
+    auto axis = node_map[axis_pat_][0].as<ConstantNode>()->value.as<IntValueObj>();
+    if (axis == nullptr || (axis->value != -1 && axis->value != 2)) {
+      return post;
+    }
+
+    double scale = 1.0;
+    if (node_map.count(scale_op_)) {
+      if (!GetScalarConst(node_map[scale_pat_][0], &scale)) {
+        return post;
+      }
+      if (Downcast<Op>(node_map[scale_op_][0]) == divide_op) {
+        scale = 1.0 / scale;
+      }
+      if (scale <= 0) {
+        return post;
+      }
+    }
+    Expr mask = MakeNull();
+    if (node_map.count(mask_add_)) {
+      mask = node_map[mask_pat_][0];
+      // Only the key padding mask of (batch, 1, seq_k) is fused.
+      auto mask_ty = mask->checked_type_.as<TensorTypeNode>();
+      if (mask_ty == nullptr || mask_ty->dtype != dtype || mask_ty->shape.size() != 3) {
+        return post;
+      }
+      if (!tvm::StructuralEqual()(mask_ty->shape, Array<PrimExpr>{q_ty->shape[0], Integer(1),
+                                                                  k_ty->shape[1]})) {
+        return post;
+      }
+    }
+    auto ret = Call(attention_op,
+                    {q, k, v, mask, MakeConstant(BoolValue::make(false)),
+                     MakeConstant(ScalarValue::make(scale)), MakeConstant(ScalarValue::make(0.0)),
+                     MakeConstant(ScalarValue::make(static_cast<int64_t>(0)))});
+    return TupleGetItem(ret, 0);
+  }
+
+ private:
+  /*! \brief Pattern input. */
+  DFPattern q_pat_, k_pat_, v_pat_, scale_pat_, mask_pat_, axis_pat_, scale_op_, mask_add_;
+};
+
+/*! \brief Count the uses of each expression, i.e., the number of expressions referring to it. */
+class UseCounter : public ExprVisitor {
+ public:
+  std::unordered_map<const Object*, int> Count(const Expr& expr) {
+    VisitExpr(expr);
+    return std::move(counts_);
+  }
+
+  void VisitExpr(const Expr& expr) override {
+    counts_[expr.get()]++;
+    ExprVisitor::VisitExpr(expr);
+  }
+
+ private:
+  std::unordered_map<const Object*, int> counts_;
+};
+
+/*!
+ * \brief Rewrite the layer_norm of residual + (dropout of) x on the last axis to the fused
+ * add_dropout_layer_norm. It is only applied on CUDA, where the fused op has a kernel, and only
+ * if the sum and the dropout are not used by others, e.g., the backward ops, since the fused op
+ * draws its own dropout mask.
+ */
+class SimplifyAddDropoutLayerNorm : public DFPatternRewrite {
+ public:
+  explicit SimplifyAddDropoutLayerNorm(const Expr& expr) {
+    use_counts_ = UseCounter().Count(expr);
+    x_pat_ = IsWildcard();
+    p_pat_ = IsConstant();
+    lhs_pat_ = IsWildcard();
+    residual_pat_ = IsWildcard();
+    scale_pat_ = IsWildcard();
+    bias_pat_ = IsWildcard();
+    axis_pat_ = IsConstant();
+    eps_pat_ = IsConstant();
+    dropout_ = IsOp("raf.op._contrib_dropout")({x_pat_, p_pat_, IsWildcard()});
+    dropout_out_ = IsTupleGetItem(dropout_, 0);
+    add_ = IsOp("raf.op.add")(
+        {dropout_out_ || lhs_pat_, residual_pat_, IsWildcard(), IsWildcard()});
+    layer_norm_ = IsOp("raf.op.layer_norm") || IsOp("raf.op.layer_norm_train");
+    pattern_ = layer_norm_({add_, scale_pat_, bias_pat_, axis_pat_, eps_pat_});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto fused_op = Op::Get("raf.op.add_dropout_layer_norm");
+    static auto layer_norm_op = Op::Get("raf.op.layer_norm");
+    if (Device::Current(true).device_type() != DevType::kCUDA()) {
+      return post;
+    }
+    bool has_dropout = node_map.count(dropout_) > 0;
+    std::vector<Expr> intermediates{node_map[add_][0]};
+    if (has_dropout) {
+      intermediates.push_back(node_map[dropout_out_][0]);
+      intermediates.push_back(node_map[dropout_][0]);
+    }
+    for (const auto& expr : intermediates) {
+      auto it = use_counts_.find(expr.get());
+      if (it == use_counts_.end() || it->second != 1) {
+        return post;
+      }
+    }
+    auto x = has_dropout ? node_map[x_pat_][0] : node_map[lhs_pat_][0];
+    auto residual = node_map[residual_pat_][0];
+    auto scale = node_map[scale_pat_][0];
+    auto bias = node_map[bias_pat_][0];
+    auto x_ty = x->checked_type_.as<TensorTypeNode>();
+    auto residual_ty = residual->checked_type_.as<TensorTypeNode>();
+    auto scale_ty = scale->checked_type_.as<TensorTypeNode>();
+    auto bias_ty = bias->checked_type_.as<TensorTypeNode>();
+    if (x_ty == nullptr || residual_ty == nullptr || scale_ty == nullptr || bias_ty == nullptr ||
+        x_ty->shape.empty()) {
+      return post;
+    }
+    auto dtype = x_ty->dtype;
+    if ((dtype != DataType::Float(32) && dtype != DataType::Float(16)) ||
+        residual_ty->dtype != dtype || scale_ty->dtype != dtype || bias_ty->dtype != dtype) {
+      return post;
+    }
+    // No broadcast of the residual, and the scale and bias are of the last dimension.
+    Array<PrimExpr> last_dim{x_ty->shape.back()};
+    if (!tvm::StructuralEqual()(x_ty->shape, residual_ty->shape) ||
+        !tvm::StructuralEqual()(scale_ty->shape, last_dim) ||
+        !tvm::StructuralEqual()(bias_ty->shape, last_dim)) {
+      return post;
+    }
+    auto axis = node_map[axis_pat_][0].as<ConstantNode>()->value.as<IntValueObj>();
+    int64_t ndim = x_ty->shape.size();
+    if (axis == nullptr || (axis->value != -1 && axis->value != ndim - 1)) {
+      return post;
+    }
+    double eps, p = 0.0;
+    if (!GetScalarConst(node_map[eps_pat_][0], &eps) ||
+        (has_dropout && !GetScalarConst(node_map[p_pat_][0], &p))) {
+      return post;
+    }
+    // Give each fused op its own seed, so the dropout masks of the layers are independent.
+    auto ret = Call(fused_op, {x, residual, scale, bias, MakeConstant(ScalarValue::make(p)),
+                               MakeConstant(ScalarValue::make(eps)),
+                               MakeConstant(ScalarValue::make(num_fused_++))});
+    if (Downcast<Op>(node_map[layer_norm_][0]) == layer_norm_op) {
+      return TupleGetItem(ret, 0);
+    }
+    return Tuple({TupleGetItem(ret, 0), TupleGetItem(ret, 1), TupleGetItem(ret, 2)});
+  }
+
+ private:
+  /*! \brief Pattern input. */
+  DFPattern x_pat_, p_pat_, lhs_pat_, residual_pat_, scale_pat_, bias_pat_, axis_pat_, eps_pat_;
+  /*! \brief The matched ops. */
+  DFPattern dropout_, dropout_out_, add_, layer_norm_;
+  /*! \brief The number of uses of each expression in the graph to be rewritten. */
+  std::unordered_map<const Object*, int> use_counts_;
+  /*! \brief The number of the fused ops, which is used as their seeds. */
+  mutable int64_t num_fused_ = 0;
+};
+
+/*!
+ * \brief Rewrite the layer_norm on the last axis of the sum of 2 or 3 embedding lookups, e.g., the
+ * word, position and token type embeddings of BERT, and the dropout of its output if any, to the
+ * fused embedding_layer_norm. It gathers the rows, sums, normalizes and drops them in one kernel
+ * instead of a kernel per lookup and add. Like add_dropout_layer_norm, it is only applied on CUDA
+ * and only if the intermediates are not used by others. The ids broadcast to those of the first
+ * lookup, e.g., the position ids of (1, seq).
+ */
+class SimplifyEmbeddingLayerNorm : public DFPatternRewrite {
+ public:
+  SimplifyEmbeddingLayerNorm(const Expr& expr, bool with_dropout) : with_dropout_(with_dropout) {
+    use_counts_ = UseCounter().Count(expr);
+    for (int i = 0; i < 3; ++i) {
+      table_pats_.push_back(IsWildcard());
+      ids_pats_.push_back(IsWildcard());
+      embeddings_.push_back(IsOp("raf.op.embedding")({table_pats_[i], ids_pats_[i]}));
+    }
+    add2_ = IsOp("raf.op.add")({embeddings_[0], embeddings_[1], IsWildcard(), IsWildcard()});
+    add3_ = IsOp("raf.op.add")({add2_, embeddings_[2], IsWildcard(), IsWildcard()});
+    scale_pat_ = IsWildcard();
+    bias_pat_ = IsWildcard();
+    axis_pat_ = IsConstant();
+    eps_pat_ = IsConstant();
+    p_pat_ = IsConstant();
+    layer_norm_ = IsOp("raf.op.layer_norm") || IsOp("raf.op.layer_norm_train");
+    norm_ = layer_norm_({add3_ || add2_, scale_pat_, bias_pat_, axis_pat_, eps_pat_});
+    if (with_dropout_) {
+      norm_out_ = IsTupleGetItem(norm_, 0) || norm_;
+      dropout_ = IsOp("raf.op._contrib_dropout")({norm_out_, p_pat_, IsWildcard()});
+      pattern_ = IsTupleGetItem(dropout_, 0);
+    } else {
+      pattern_ = norm_;
+    }
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    static auto fused_op = Op::Get("raf.op.embedding_layer_norm");
+    static auto layer_norm_op = Op::Get("raf.op.layer_norm");
+    static auto broadcast_to_op = Op::Get("raf.op.broadcast_to");
+    if (Device::Current(true).device_type() != DevType::kCUDA()) {
+      return post;
+    }
+    bool is_train = Downcast<Op>(node_map[layer_norm_][0]) != layer_norm_op;
+    if (with_dropout_ && is_train && node_map[norm_out_][0].as<TupleGetItemNode>() == nullptr) {
+      return post;
+    }
+    int num_tables = node_map.count(add3_) ? 3 : 2;
+    std::vector<Expr> intermediates{node_map[add2_][0]};
+    if (num_tables == 3) {
+      intermediates.push_back(node_map[add3_][0]);
+    }
+    for (int i = 0; i < num_tables; ++i) {
+      intermediates.push_back(node_map[embeddings_[i]][0]);
+    }
+    if (with_dropout_) {
+      intermediates.push_back(node_map[norm_][0]);
+      intermediates.push_back(node_map[dropout_][0]);
+      if (is_train) {
+        intermediates.push_back(node_map[norm_out_][0]);
+      }
+    }
+    for (const auto& expr : intermediates) {
+      auto it = use_counts_.find(expr.get());
+      if (it == use_counts_.end() || it->second != 1) {
+        return post;
+      }
+    }
+    std::vector<Expr> tables, ids;
+    for (int i = 0; i < num_tables; ++i) {
+      tables.push_back(node_map[table_pats_[i]][0]);
+      ids.push_back(node_map[ids_pats_[i]][0]);
+    }
+    auto scale = node_map[scale_pat_][0];
+    auto bias = node_map[bias_pat_][0];
+    auto table_ty = tables[0]->checked_type_.as<TensorTypeNode>();
+    auto ids_ty = ids[0]->checked_type_.as<TensorTypeNode>();
+    auto scale_ty = scale->checked_type_.as<TensorTypeNode>();
+    auto bias_ty = bias->checked_type_.as<TensorTypeNode>();
+    if (table_ty == nullptr || ids_ty == nullptr || scale_ty == nullptr || bias_ty == nullptr ||
+        table_ty->shape.size() != 2 || ids_ty->shape.empty()) {
+      return post;
+    }
+    auto dtype = table_ty->dtype;
+    auto ids_dtype = ids_ty->dtype;
+    if ((dtype != DataType::Float(32) && dtype != DataType::Float(16)) ||
+        (ids_dtype != DataType::Int(32) && ids_dtype != DataType::Int(64)) ||
+        scale_ty->dtype != dtype || bias_ty->dtype != dtype) {
+      return post;
+    }
+    Array<PrimExpr> last_dim{table_ty->shape[1]};
+    if (!tvm::StructuralEqual()(scale_ty->shape, last_dim) ||
+        !tvm::StructuralEqual()(bias_ty->shape, last_dim)) {
+      return post;
+    }
+    for (int i = 1; i < num_tables; ++i) {
+      auto ty = tables[i]->checked_type_.as<TensorTypeNode>();
+      auto id_ty = ids[i]->checked_type_.as<TensorTypeNode>();
+      if (ty == nullptr || id_ty == nullptr || ty->dtype != dtype || id_ty->dtype != ids_dtype ||
+          ty->shape.size() != 2 || !tvm::StructuralEqual()(ty->shape[1], table_ty->shape[1])) {
+        return post;
+      }
+      if (!tvm::StructuralEqual()(id_ty->shape, ids_ty->shape)) {
+        std::vector<int64_t> shape;
+        if (!IsBroadcastable(id_ty->shape, ids_ty->shape, &shape)) {
+          return post;
+        }
+        ids[i] = Call(broadcast_to_op, {ids[i], MakeConstant(ArrayToIntTuple(shape))});
+      }
+    }
+    auto axis = node_map[axis_pat_][0].as<ConstantNode>()->value.as<IntValueObj>();
+    int64_t ndim = ids_ty->shape.size() + 1;
+    if (axis == nullptr || (axis->value != -1 && axis->value != ndim - 1)) {
+      return post;
+    }
+    double eps, p = 0.0;
+    if (!GetScalarConst(node_map[eps_pat_][0], &eps) ||
+        (with_dropout_ && !GetScalarConst(node_map[p_pat_][0], &p))) {
+      return post;
+    }
+    Expr token_type = num_tables == 3 ? tables[2] : MakeNull();
+    Expr token_type_ids = num_tables == 3 ? ids[2] : MakeNull();
+    // Give each fused op its own seed, so the dropout masks of the layers are independent.
+    auto ret = Call(fused_op, {tables[0], ids[0], tables[1], ids[1], scale, bias, token_type,
+                               token_type_ids, MakeConstant(ScalarValue::make(p)),
+                               MakeConstant(ScalarValue::make(eps)),
+                               MakeConstant(ScalarValue::make(num_fused_++))});
+    if (with_dropout_ || !is_train) {
+      return TupleGetItem(ret, 0);
+    }
+    return Tuple({TupleGetItem(ret, 0), TupleGetItem(ret, 1), TupleGetItem(ret, 2)});
+  }
+
+ private:
+  /*! \brief Whether the shape broadcasts to the static target, which is returned as ints. */
+  static bool IsBroadcastable(const Array<PrimExpr>& shape, const Array<PrimExpr>& target,
+                              std::vector<int64_t>* ret) {
+    if (shape.size() != target.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < shape.size(); ++i) {
+      const auto* dim = shape[i].as<IntImmNode>();
+      const auto* target_dim = target[i].as<IntImmNode>();
+      if (dim == nullptr || target_dim == nullptr ||
+          (dim->value != 1 && dim->value != target_dim->value)) {
+        return false;
+      }
+      ret->push_back(target_dim->value);
+    }
+    return true;
+  }
+
+  /*! \brief Whether to match the dropout of the output. */
+  bool with_dropout_;
+  /*! \brief Pattern input. */
+  std::vector<DFPattern> table_pats_, ids_pats_;
+  DFPattern scale_pat_, bias_pat_, axis_pat_, eps_pat_, p_pat_;
+  /*! \brief The matched ops. */
+  std::vector<DFPattern> embeddings_;
+  DFPattern add2_, add3_, layer_norm_, norm_, norm_out_, dropout_;
+  /*! \brief The number of uses of each expression in the graph to be rewritten. */
+  std::unordered_map<const Object*, int> use_counts_;
+  /*! \brief The number of the fused ops, which is used as their seeds. */
+  mutable int64_t num_fused_ = 0;
+};
+
+/*!
+ * \brief Merge the sibling matmuls of the same input and constant weights, e.g., the projections
+ * of the queries, keys and values of the attention, into one wider matmul, whose output is sliced
+ * for each of them. The weights are concatenated once at compile time, so they must be bound as
+ * constants, e.g., by the params of the VM. The slices are fused with their consumers, e.g., the
+ * reshapes and transposes that split the heads, so they launch no extra kernels.
+ */
+class MergeParallelMatmul : public MixedModeMutator {
+ public:
+  explicit MergeParallelMatmul(const Expr& expr) {
+    PostOrderVisit(expr, [this](const Expr& e) {
+      int64_t axis;
+      if (const auto* call = e.as<CallNode>()) {
+        if (GetWeightAxis(call, &axis)) {
+          const auto* w_ty = call->args[1]->checked_type().as<TensorTypeNode>();
+          auto key = std::make_tuple(call->args[0].get(), call->op.get(),
+                                     tvm::runtime::DLDataType2String(w_ty->dtype),
+                                     Downcast<IntImm>(w_ty->shape[1 - axis])->value);
+          groups_[key].push_back(call);
+        }
+      }
+    });
+    for (const auto& kv : groups_) {
+      if (kv.second.size() < 2) {
+        continue;
+      }
+      for (const auto* call : kv.second) {
+        group_of_[call] = &kv.second;
+      }
+    }
+  }
+
+  Expr Rewrite_(const CallNode* pre, const Expr& post) final {
+    static auto concatenate_op = Op::Get("raf.op.concatenate");
+    static auto strided_slice_op = Op::Get("raf.op.strided_slice");
+    auto it = group_of_.find(pre);
+    if (it == group_of_.end()) {
+      return post;
+    }
+    const auto& group = *it->second;
+    int64_t axis;
+    GetWeightAxis(pre, &axis);
+    auto merged_it = merged_.find(it->second);
+    if (merged_it == merged_.end()) {
+      Array<Expr> weights;
+      for (const auto* call : group) {
+        weights.push_back(call->args[1]);
+      }
+      auto weight = executor::interpreter::Interpret(
+          Call(concatenate_op, {Tuple(weights), MakeConstant(ScalarValue::make(axis))}),
+          GlobalModule());
+      auto merged = Call(pre->op, {post.as<CallNode>()->args[0], MakeConstant(weight)});
+      merged_it = merged_.emplace(it->second, merged).first;
+    }
+    // Slice the output of this matmul on the last axis.
+    int64_t begin = 0;
+    for (const auto* call : group) {
+      if (call == pre) {
+        break;
+      }
+      begin += GetOutputDim(call, axis);
+    }
+    std::vector<int64_t> begins, ends, strides;
+    for (const auto& dim : pre->checked_type().as<TensorTypeNode>()->shape) {
+      begins.push_back(0);
+      ends.push_back(Downcast<IntImm>(dim)->value);
+      strides.push_back(1);
+    }
+    begins.back() = begin;
+    ends.back() = begin + GetOutputDim(pre, axis);
+    return Call(strided_slice_op,
+                {merged_it->second, MakeConstant(ArrayToIntTuple(begins)),
+                 MakeConstant(ArrayToIntTuple(ends)), MakeConstant(ArrayToIntTuple(strides)),
+                 MakeConstant(StringValue::make("end"))});
+  }
+
+ private:
+  /*!
+   * \brief Check whether the call is a matmul of a 2D constant weight of a static shape, whose
+   * output has a static shape, and get the axis of the output features of the weight.
+   */
+  static bool GetWeightAxis(const CallNode* call, int64_t* axis) {
+    static auto dense_op = Op::Get("raf.op.dense");
+    static auto matmul_nt_op = Op::Get("raf.op.matmul_nt");
+    static auto matmul_op = Op::Get("raf.op.matmul");
+    if (call->args.size() != 2) {
+      return false;
+    }
+    if (call->op.same_as(dense_op) || call->op.same_as(matmul_nt_op)) {
+      *axis = 0;
+    } else if (call->op.same_as(matmul_op)) {
+      *axis = 1;
+    } else {
+      return false;
+    }
+    const auto* weight = call->args[1].as<ConstantNode>();
+    if (weight == nullptr || !weight->IsTensor() || !call->checked_type_.defined()) {
+      return false;
+    }
+    const auto* w_ty = call->args[1]->checked_type().as<TensorTypeNode>();
+    const auto* out_ty = call->checked_type().as<TensorTypeNode>();
+    if (w_ty == nullptr || out_ty == nullptr || w_ty->shape.size() != 2) {
+      return false;
+    }
+    for (const auto& dims : {w_ty->shape, out_ty->shape}) {
+      for (const auto& dim : dims) {
+        if (dim.as<IntImmNode>() == nullptr) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Get the number of the output features of the matmul. */
+  static int64_t GetOutputDim(const CallNode* call, int64_t axis) {
+    const auto* w_ty = call->args[1]->checked_type().as<TensorTypeNode>();
+    return Downcast<IntImm>(w_ty->shape[axis])->value;
+  }
+
+  using GroupKey = std::tuple<const Object*, const Object*, std::string, int64_t>;
+  using Group = std::vector<const CallNode*>;
+
+  /*! \brief The matmuls grouped by the input, the op, the dtype and the input features. */
+  std::map<GroupKey, Group> groups_;
+  /*! \brief The group of each matmul to merge. */
+  std::unordered_map<const CallNode*, const Group*> group_of_;
+  /*! \brief The merged matmul of each group. */
+  std::unordered_map<const Group*, Expr> merged_;
+};
+
 Expr SimplifyExpr(const Expr& expr, const IRModule& mod) {
   // Phase 1: Single-op patterns that only need to be applied once.
   DFPatternRewriteComposer composer;
@@ -655,7 +1342,23 @@ Expr SimplifyExpr(const Expr& expr, const IRModule& mod) {
   composer.AddRewrite<SimplifyMatmulReshapeBiasAct>();
   composer.AddRewrite<SimplifyCast>();
   composer.AddRewrite<SimplifyReshape>();
-  return raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), ret, mod);
+  composer.AddRewrite<SimplifyTranspose>();
+  composer.AddRewrite<SimplifyMatmulTranspose>();
+  composer.AddRewrite<SimplifyAttention>();
+  ret = raf::ir::RAFRewritePatterns(composer.MakeCallbacks(), ret, mod);
+
+  // Phase 3: Fusions that need the uses of the matched intermediates in the whole graph. The
+  // embeddings go first, since their sum would be taken as the residual add.
+  SimplifyEmbeddingLayerNorm embedding_dropout_layer_norm(ret, true);
+  ret = raf::ir::RAFRewritePatterns({embedding_dropout_layer_norm.MakeCallback()}, ret, mod);
+  SimplifyEmbeddingLayerNorm embedding_layer_norm(ret, false);
+  ret = raf::ir::RAFRewritePatterns({embedding_layer_norm.MakeCallback()}, ret, mod);
+  SimplifyAddDropoutLayerNorm add_dropout_layer_norm(ret);
+  ret = raf::ir::RAFRewritePatterns({add_dropout_layer_norm.MakeCallback()}, ret, mod);
+
+  // Phase 4: Merge the sibling matmuls, which are not a pattern of a single output.
+  ret = InferTypeWithModule(ret, mod);
+  return MergeParallelMatmul(ret).Mutate(ret);
 }
 
 }  // namespace simplify_expr
@@ -665,7 +1368,7 @@ Pass SimplifyExpr() {
                                                                              PassContext pc) {
     return Downcast<Function>(simplify_expr::SimplifyExpr(f, m));
   };
-  return CreateRAFFunctionPass(pass_func, 0, "SimplifyExpr", {"InferType"});
+  return CreateRAFFunctionPass(pass_func, 0, "SimplifyExpr", {"InferType"}, true);
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.SimplifyExpr").set_body_typed(SimplifyExpr);
@@ -0,0 +1,137 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file sparse_embedding_grad.cc
+ * \brief Apply the gradients of embedding in the row-sparse form. The SGD of a dense gradient of
+ * embedding_dx is rewritten to the row-sparse SGD of embedding_sparse_dx, so the dense gradient
+ * of the whole table is never materialized.
+ */
+#include <unordered_map>
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace sparse_embedding_grad {
+
+using namespace raf::op;
+using namespace raf::value;
+
+/*! \brief Count the uses of each var. */
+class VarUseCounter : public ExprVisitor {
+ public:
+  std::unordered_map<const VarNode*, int> Count(const Expr& expr) {
+    VisitExpr(expr);
+    return std::move(counts_);
+  }
+
+  void VisitExpr(const Expr& expr) override {
+    // The visitor only dispatches an expression once, so the uses are counted before that.
+    if (const auto* var = expr.as<VarNode>()) {
+      counts_[var]++;
+    }
+    ExprVisitor::VisitExpr(expr);
+  }
+
+  void VisitExpr_(const LetNode* op) override {
+    // Visit the let chain iteratively, as it can be too long to be visited recursively.
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      VisitExpr(let->value);
+      expr = let->body;
+    }
+    VisitExpr(expr);
+  }
+
+ private:
+  std::unordered_map<const VarNode*, int> counts_;
+};
+
+/*!
+ * \brief Rewrite sgd(x, embedding_dx(dy, indices, num_weight), v, lr, mu), where the gradient is
+ * only used by the SGD, to sparse_sgd(x, embedding_sparse_dx(dy, indices, num_weight), v, lr, mu).
+ * The sparse SGD uses the lazy momentum, i.e., the momentum of the rows not in the gradient is
+ * not decayed, so the rewrite is opt-in by "raf.sparse_embedding_grad".
+ */
+Function Rewrite(const Function& func) {
+  static const Op& sgd = Op::Get("raf.op.sgd");
+  static const Op& embedding_dx = Op::Get("raf.op.embedding_dx");
+  static const Op& sparse_dx = Op::Get("raf.op.embedding_sparse_dx");
+  static const Op& sparse_sgd = Op::Get("raf.op.sparse_sgd");
+  std::unique_ptr<ExplicitLetList> ell = ExplicitLetList::make(func->body);
+  if (!ell->ret.defined()) {
+    return func;
+  }
+  const auto& vars = ell->vars;
+  const auto& exprs = ell->exprs;
+  std::unordered_map<const VarNode*, const CallNode*> grads;
+  for (size_t i = 0; i < exprs.size(); ++i) {
+    const auto* call = exprs[i].as<CallNode>();
+    if (call && call->op == embedding_dx) {
+      grads[vars[i].get()] = call;
+    }
+  }
+  if (grads.empty()) {
+    return func;
+  }
+  auto counts = VarUseCounter().Count(func->body);
+  // The gradients that are folded into the sparse SGD, which are removed.
+  std::unordered_map<const VarNode*, const CallNode*> folded;
+  for (const auto& expr : exprs) {
+    const auto* call = expr.as<CallNode>();
+    const auto* grad = call && call->op == sgd ? call->args[1].as<VarNode>() : nullptr;
+    if (grad && grads.count(grad) && counts[grad] == 1) {
+      folded[grad] = grads[grad];
+    }
+  }
+  if (folded.empty()) {
+    return func;
+  }
+  ExplicitLetList ell_out;
+  for (size_t i = 0; i < exprs.size(); ++i) {
+    if (folded.count(vars[i].get())) {
+      continue;
+    }
+    const auto* call = exprs[i].as<CallNode>();
+    const auto* grad = call && call->op == sgd ? call->args[1].as<VarNode>() : nullptr;
+    if (grad == nullptr || !folded.count(grad)) {
+      ell_out.Push(vars[i], exprs[i]);
+      continue;
+    }
+    Var sparse = MakeVar(grad->name_hint() + "_sparse", {});
+    Var rows = MakeVar(grad->name_hint() + "_rows", {});
+    Var values = MakeVar(grad->name_hint() + "_values", {});
+    ell_out.Push(sparse, Call(sparse_dx, folded[grad]->args));
+    ell_out.Push(rows, TupleGetItem(sparse, 0));
+    ell_out.Push(values, TupleGetItem(sparse, 1));
+    const auto& args = call->args;
+    ell_out.Push(vars[i], Call(sparse_sgd, {args[0], rows, values, args[2], args[3], args[4]}));
+  }
+  ell_out.ret = ell->ret;
+  return Function(func->params, ell_out.AsExpr(), func->ret_type, func->type_params, func->attrs);
+}
+
+}  // namespace sparse_embedding_grad
+
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.sparse_embedding_grad", Bool);
+
+Pass SparseEmbeddingGrad() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return sparse_embedding_grad::Rewrite(f);
+  };
+  Pass func_pass = CreateRAFFunctionPass(pass_func, 1, "SparseEmbeddingGradHelper", {});
+  PassInfo pass_info(1, "SparseEmbeddingGrad", {});
+  return RAFSequential({InferType(), func_pass, InferType()}, pass_info);
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.SparseEmbeddingGrad").set_body_typed(SparseEmbeddingGrad);
+
+}  // namespace pass
+}  // namespace raf
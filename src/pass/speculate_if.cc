@@ -0,0 +1,197 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file speculate_if.cc
+ * \brief Speculate the small branches of if nodes. The VM reads the condition of an if on the
+ * host, which synchronizes the device for every data-dependent branch. When both branches are
+ * small and free of side effects, this pass runs both of them and selects their results with
+ * raf.op.where on the device, so the condition never leaves the device.
+ */
+#include "raf/op.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "./common.h"
+
+namespace raf {
+namespace pass {
+namespace speculate_if {
+
+using namespace raf::ir;
+using namespace raf::op;
+
+class BranchSpeculator {
+ public:
+  BranchSpeculator(const IRModule& mod, int max_branch_ops)
+      : mod_(mod), max_branch_ops_(max_branch_ops) {
+  }
+
+  /*!
+   * \brief Speculate the if nodes in an ANF expression, including the ones in the branches that
+   * are not speculated.
+   * \param body The expression in ANF.
+   * \return The transformed expression.
+   */
+  Expr Run(const Expr& body) {
+    if (body->IsInstance<VarNode>()) {
+      return body;
+    }
+    auto ell = ExplicitLetList::make(body);
+    ExplicitLetList out;
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      const Var& var = ell->vars[i];
+      Expr expr = ell->exprs[i];
+      if (auto if_node = expr.as<IfNode>()) {
+        if (IsSpeculative(GetRef<If>(if_node), var)) {
+          Var t = Splice(if_node->true_branch, &out);
+          Var f = Splice(if_node->false_branch, &out);
+          out.Push(var, Select(if_node->cond, t, f, var->checked_type(), &out));
+          continue;
+        }
+        expr = If(if_node->cond, Run(if_node->true_branch), Run(if_node->false_branch));
+      }
+      out.Push(var, expr);
+    }
+    out.ret = ell->ret;
+    return out.AsExpr();
+  }
+
+ private:
+  /*! \brief Whether both branches are small enough and the result can be selected. */
+  bool IsSpeculative(const If& if_node, const Var& var) {
+    auto cond_type = if_node->cond->checked_type().as<TensorTypeNode>();
+    if (cond_type == nullptr || cond_type->shape.size() != 0) {
+      return false;
+    }
+    if (!IsSelectable(var->checked_type())) {
+      return false;
+    }
+    int true_ops = CountOps(if_node->true_branch, true);
+    int false_ops = CountOps(if_node->false_branch, true);
+    return true_ops >= 0 && false_ops >= 0 && true_ops + false_ops <= max_branch_ops_;
+  }
+
+  /*! \brief Whether a value of the type is a tensor or a (nested) tuple of tensors. */
+  bool IsSelectable(const Type& type) {
+    if (type.as<TensorTypeNode>()) {
+      return true;
+    }
+    if (auto tuple_type = type.as<TupleTypeNode>()) {
+      for (const auto& field : tuple_type->fields) {
+        if (!IsSelectable(field)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Count the ops of a branch.
+   * \param branch The branch in ANF.
+   * \param allow_calls Whether it may call a global function, e.g., the one lifted by
+   * LiftBranchBody, which is then counted as well. The callee itself may not call functions, so
+   * a recursive loop is never speculated.
+   * \return The number of ops, or -1 if the branch has side effects or nested control flow.
+   */
+  int CountOps(const Expr& branch, bool allow_calls) {
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    if (branch->IsInstance<VarNode>()) {
+      return 0;
+    }
+    if (!branch->IsInstance<LetNode>()) {
+      return -1;
+    }
+    auto ell = ExplicitLetList::make(branch);
+    int num_ops = 0;
+    for (const auto& expr : ell->exprs) {
+      if (expr->IsInstance<TupleNode>() || expr->IsInstance<TupleGetItemNode>() ||
+          expr->IsInstance<VarNode>() || expr->IsInstance<ConstantNode>()) {
+        continue;
+      }
+      auto call = expr.as<CallNode>();
+      if (call == nullptr) {
+        return -1;
+      }
+      if (auto gvar = call->op.as<GlobalVarNode>()) {
+        auto callee = mod_->Lookup(GetRef<GlobalVar>(gvar)).as<FunctionNode>();
+        int callee_ops = (allow_calls && callee) ? CountOps(callee->body, false) : -1;
+        if (callee_ops < 0) {
+          return -1;
+        }
+        num_ops += callee_ops;
+        continue;
+      }
+      if (!call->op->IsInstance<OpNode>()) {
+        return -1;
+      }
+      // Only the ops with a TVM compute are known to be pure, e.g., not the collectives, random
+      // ops or ops that update their inputs in place.
+      auto tvm_op = OpDialect::Lower(Downcast<Op>(call->op), "tvm");
+      if (!tvm_op.defined() || fpattern.get(tvm_op, kOpaque) >= kOpaque) {
+        return -1;
+      }
+      ++num_ops;
+    }
+    return num_ops;
+  }
+
+  /*! \brief Append the bindings of a branch, and return the var of its result. */
+  Var Splice(const Expr& branch, ExplicitLetList* out) {
+    if (auto var = branch.as<VarNode>()) {
+      return GetRef<Var>(var);
+    }
+    auto ell = ExplicitLetList::make(branch);
+    for (size_t i = 0; i < ell->vars.size(); ++i) {
+      out->Push(ell->vars[i], ell->exprs[i]);
+    }
+    return ell->ret;
+  }
+
+  /*! \brief Select the tensors of the results of two branches by the condition. */
+  Expr Select(const Expr& cond, const Var& t, const Var& f, const Type& type,
+              ExplicitLetList* out) {
+    static const Op& where = Op::Get("raf.op.where");
+    auto tuple_type = type.as<TupleTypeNode>();
+    if (tuple_type == nullptr) {
+      return Call(where, {cond, t, f});
+    }
+    Array<Expr> fields;
+    for (size_t i = 0; i < tuple_type->fields.size(); ++i) {
+      Var t_i = MakeVar(t->name_hint() + "_" + std::to_string(i), {});
+      Var f_i = MakeVar(f->name_hint() + "_" + std::to_string(i), {});
+      Var selected = MakeVar("spec", {});
+      out->Push(t_i, TupleGetItem(t, i));
+      out->Push(f_i, TupleGetItem(f, i));
+      out->Push(selected, Select(cond, t_i, f_i, tuple_type->fields[i], out));
+      fields.push_back(selected);
+    }
+    return Tuple(fields);
+  }
+
+  /*! \brief The module to look up the lifted branches. */
+  IRModule mod_;
+  /*! \brief The max number of ops of both branches of a speculated if. */
+  int max_branch_ops_;
+};
+
+}  // namespace speculate_if
+
+Pass SpeculateIf(int max_branch_ops) {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    speculate_if::BranchSpeculator speculator(m, max_branch_ops);
+    return Function(f->params, speculator.Run(f->body), f->ret_type, f->type_params, f->attrs);
+  };
+  return RAFSequential({InferType(), CreateRAFFunctionPass(pass_func, 1, "SpeculateIfHelper", {}),
+                        InferType()},
+                       PassInfo(1, "SpeculateIf", {}));
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.SpeculateIf").set_body_typed(SpeculateIf);
+
+}  // namespace pass
+}  // namespace raf
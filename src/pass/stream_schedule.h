@@ -65,11 +65,14 @@ class StreamSchedulerBase : public ExprMutator {
   }
 
  protected:
-  Expr AnnotateSetStream(int64_t device_id, int64_t stream_id) {
+  Expr AnnotateSetStream(int64_t device_id, int64_t stream_id, int64_t priority = 0) {
     static Op op = Op::Get("raf.op.set_stream");
     Expr device_id_e = MakeConstant(value::ScalarValue::make(device_id));
     Expr stream_id_e = MakeConstant(value::ScalarValue::make(stream_id));
     Array<Expr> args({device_id_e, stream_id_e});
+    if (priority != 0) {
+      args.push_back(MakeConstant(value::ScalarValue::make(priority)));
+    }
     return let_list_.Push(Call(op, args));
   }
 
@@ -13,15 +13,19 @@
 #include <thread>
 #include <relay/transforms/pass_utils.h>
 #include <tvm/runtime/device_api.h>
+#include <dmlc/memory_io.h>
 #include "raf/pass.h"
 #include "raf/analysis.h"
+#include "raf/cache.h"
 #include "raf/op.h"
 #include "raf/op_profiler.h"
 #include "raf/op_utils.h"
 #include "raf/profiler.h"
+#include "./estimate_flops.h"
 #include "./stream_schedule.h"
 #include "../requests.h"
 #include "../analysis/dependency_graph.h"
+#include "../3rdparty/tvm/src/runtime/file_utils.h"
 
 #ifdef RAF_USE_CUDA
 #include "../common/cuda_utils.h"
@@ -73,9 +77,49 @@ inline int CountOneBits(uint64_t v) {
   return c;
 }
 
-#ifdef RAF_USE_CUDA
+/*! \brief The cache entry of the latencies of a profiled stage in microseconds. */
+class StageLatencyCacheEntry {
+ public:
+  explicit StageLatencyCacheEntry(std::vector<float> latencies) : latencies_(std::move(latencies)) {
+  }
+
+  const std::vector<float>& Value() const {
+    return latencies_;
+  }
+
+  static StageLatencyCacheEntry Load(const std::string& path) {
+    std::string data;
+    tvm::runtime::LoadBinaryFromFile(path + "/value.bin", &data);
+    dmlc::MemoryStringStream reader(&data);
+    dmlc::Stream* stream = &reader;
+
+    std::vector<float> latencies;
+    CHECK(stream->Read(&latencies)) << "Failed to read the stage latencies";
+    return StageLatencyCacheEntry(latencies);
+  }
+
+  bool Save(const std::string& path) {
+    std::string data;
+    dmlc::MemoryStringStream writer(&data);
+    dmlc::Stream* stream = &writer;
+    stream->Write(latencies_);
+    tvm::runtime::SaveBinaryToFile(path + "/value.bin", data);
+    return true;
+  }
+
+ private:
+  std::vector<float> latencies_;
+};
+
+/*!
+ * \brief The profiled stage latencies, keyed by the stage signature and the device. It persists
+ * across compilations when the persistent cache is enabled (e.g., RAF_PERSIST_CACHE=1).
+ */
+MetaPersistCache<StageLatencyCacheEntry> CacheStageLatency("ios_stage_latency");
+
 /*!
- * \brief The cost model of IOS scheduler. It profile the latency of IOS proposed stage on device.
+ * \brief The cost model of IOS scheduler. It profiles the latency of IOS proposed stage on device,
+ * or estimates the latency analytically from the FLOPS of the operators.
  *
  * [Decision choice]
  * Because the purpose of this cost model it to get the latency of the proposed stage on raf
@@ -87,27 +131,46 @@ inline int CountOneBits(uint64_t v) {
  * Thus, we implements the CostModel directly by launching the kernels in the cost model directly.
  * This gives us the flexibility to profile (we can control the times of warmup and repeat). It is
  * also the most efficient way to profile. This decision is a trade-off between the profiling
- * accuracy and the compilation time.
+ * accuracy and the compilation time. The profiled latencies are cached by the stage signature, so
+ * the same stage is profiled only once even across compilations with the persistent cache.
  */
 class IOSCostModel {
-  using OpEnvCache = MetaCache<std::shared_ptr<OpEnv>>;
-
  public:
   /*!
    * \brief The IOS cost model.
    * \param device The target device. Must be a cuda device.
-   * \param num_stream The maximum number of streams to support.
+   * \param mod The module of the scheduled function, which is used to estimate the FLOPS.
+   * \param profile Whether to profile the stages on device. Otherwise, the stage latency is
+   * estimated analytically from the FLOPS of the operators and the device peak GFLOPS.
    * \param warmup The number of warmups before real execution.
    * \param number The number of executions as a repeat.
    * \param repeat The number of repeat times.
+   * \param peak_gflops The peak GFLOPS of the device used by the analytical estimation.
    */
-  IOSCostModel(Device device, int warmup, int number, int repeat) {
+  IOSCostModel(Device device, IRModule mod, bool profile, int warmup, int number, int repeat,
+               int peak_gflops) {
     CHECK_EQ(device.device_type(), DevType::kCUDA()) << "IOS cost model only supports CUDA.";
+    CHECK_GT(peak_gflops, 0) << "The peak GFLOPS must be positive, but got " << peak_gflops;
     this->device_ = device;
+    this->mod_ = mod;
+    this->profile_ = profile;
     this->warmup_ = warmup;
     this->number_ = number;
     this->repeat_ = repeat;
-    this->profiler_ = op_profiler::OpProfiler::Get(device);
+    this->peak_gflops_ = peak_gflops;
+#ifdef RAF_USE_CUDA
+    if (profile) {
+      this->profiler_ = op_profiler::OpProfiler::Get(device);
+      cudaDeviceProp prop;
+      CUDA_CALL(cudaGetDeviceProperties(&prop, device.device_id()));
+      this->device_name_ = prop.name;
+    }
+#else
+    if (profile) {
+      LOG(WARNING) << "Profiling requires CUDA, fall back to the analytical cost model.";
+      this->profile_ = false;
+    }
+#endif
   }
 
   /*!
@@ -116,6 +179,64 @@ class IOSCostModel {
    * \return The latency of the stage.
    */
   std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) {
+    if (!profile_) {
+      return {EstimateStageLatency(groups)};
+    }
+    HashKey key = StageKey(groups);
+    if (const auto* entry = CacheStageLatency.Get(key)) {
+      return entry->Value();
+    }
+    auto latencies = ProfileStageLatency(groups);
+    CacheStageLatency.Set(key, StageLatencyCacheEntry(latencies));
+    return latencies;
+  }
+
+ private:
+  /*!
+   * \brief Hash the stage signature and the device. The signature consists of the operators (or
+   * the fused functions), the argument types and constants of each group in order.
+   */
+  HashKey StageKey(const std::vector<std::vector<Expr>>& groups) {
+    HashKey key;
+    key << device_name_ << static_cast<int32_t>(device_.device_id());
+    for (const auto& group : groups) {
+      key << static_cast<int64_t>(group.size());
+      for (const auto& expr : group) {
+        auto call = expr.as<CallNode>();
+        CHECK(call) << "Expected a call in the stage, but got " << expr->GetTypeKey();
+        if (auto op = call->op.as<OpNode>()) {
+          key << op->name;
+        } else {
+          key << raf::ir::AsText(call->op, true);
+        }
+        for (const auto& arg : call->args) {
+          if (arg->IsInstance<ConstantNode>()) {
+            key << raf::ir::AsText(arg, true);
+          } else {
+            HashType(&key, arg->checked_type());
+          }
+        }
+        HashType(&key, expr->checked_type());
+      }
+    }
+    return key;
+  }
+
+  void HashType(HashKey* key, const Type& type) {
+    if (auto tensor_type = type.as<TensorTypeNode>()) {
+      *key << GetRef<TensorType>(tensor_type);
+    } else if (auto tuple_type = type.as<TupleTypeNode>()) {
+      *key << static_cast<int64_t>(tuple_type->fields.size());
+      for (const auto& field : tuple_type->fields) {
+        HashType(key, field);
+      }
+    } else {
+      *key << std::string(type->GetTypeKey());
+    }
+  }
+
+  std::vector<float> ProfileStageLatency(const std::vector<std::vector<Expr>>& groups) {
+#ifdef RAF_USE_CUDA
     std::vector<Expr> flat_group;
     std::vector<int> stream_ids;
     for (size_t i = 0; i < groups.size(); i++) {
@@ -127,33 +248,76 @@ class IOSCostModel {
     }
     auto prof_res = profiler_->ProfileOpGroup(flat_group, stream_ids, warmup_, number_, repeat_);
     return prof_res.first;
+#else
+    LOG(FATAL) << "Please build with CUDA enabled to profile IOS stages.";
+    throw;
+#endif
+  }
+
+  /*!
+   * \brief Estimate the latency of a stage in microseconds. The groups run concurrently, but
+   * they share the compute of the device, so the stage takes at least the total compute time. Each
+   * kernel takes at least the launch latency, and each additional stream adds a synchronization.
+   */
+  float EstimateStageLatency(const std::vector<std::vector<Expr>>& groups) {
+    static constexpr float kMinKernelLatency = 5.0f;
+    static constexpr float kStreamSyncLatency = 5.0f;
+    float max_group_latency = 0.0f, total_compute = 0.0f;
+    for (const auto& group : groups) {
+      float group_latency = 0.0f;
+      for (const auto& expr : group) {
+        float compute = GetGFLOPS(expr) / peak_gflops_ * 1e6f;
+        group_latency += std::max(compute, kMinKernelLatency);
+        total_compute += compute;
+      }
+      max_group_latency = std::max(max_group_latency, group_latency);
+    }
+    return std::max(max_group_latency, total_compute) +
+           kStreamSyncLatency * (std::max(groups.size(), size_t(1)) - 1);
+  }
+
+  /*! \brief Estimate the GFLOPS of a call, or 0 if it cannot be estimated. */
+  float GetGFLOPS(const Expr& expr) {
+    auto it = gflops_.find(expr);
+    if (it != gflops_.end()) {
+      return it->second;
+    }
+    // Bind the call to a var in a function for the estimater.
+    auto var = raf::ir::MakeVar("", expr->checked_type());
+    Function func({}, Let(var, expr, var), {}, {});
+    float gflops = estimate_flops::FLOPSEstimater().Run(device_, func, mod_)[var];
+    if (!std::isfinite(gflops) || gflops < 0) {
+      gflops = 0.0f;
+    }
+    gflops_[expr] = gflops;
+    return gflops;
   }
 
- private:
   /*The following data are configs. */
 
   /*! \brief Target device to profile on. */
   Device device_;
+  /*! \brief The name of the device, which is a part of the cache key. */
+  std::string device_name_;
+  /*! \brief The module of the scheduled function. */
+  IRModule mod_;
+  /*! \brief Whether to profile the stages on device. */
+  bool profile_;
   /*! \brief Number of warmups. */
   int warmup_;
   /*! \brief The number of executions as a repeat.*/
   int number_;
   /*! \brief The number of repeat times. */
   int repeat_;
+  /*! \brief The peak GFLOPS of the device for the analytical estimation. */
+  float peak_gflops_;
+  /*! \brief The estimated GFLOPS of each call. */
+  std::unordered_map<Expr, float, ObjectPtrHash, ObjectPtrEqual> gflops_;
+#ifdef RAF_USE_CUDA
   /*! \brief The op profiler. */
-  op_profiler::OpProfiler* profiler_;
-};
-#else
-class IOSCostModel {
- public:
-  IOSCostModel(Device device, int warmup, int number, int repeat) {
-    LOG(FATAL) << "Please build with CUDA enabled to use IOS schedule.";
-  }
-  std::vector<float> StageLatency(const std::vector<std::vector<Expr>>& groups) {
-    return {};
-  }
-};
+  op_profiler::OpProfiler* profiler_ = nullptr;
 #endif
+};
 
 class IOSScheduler : public StreamSchedulerBase {
   /*! \brief A group of nodes. */
@@ -179,8 +343,7 @@ class IOSScheduler : public StreamSchedulerBase {
  public:
   /*!
    * \brief The IOS scheduler.
-   * \param device The target device to schedule for. We need this because IOS scheduler is a
-   * profiling-based scheduler.
+   * \param cost_model The cost model that predicts the stage latency on the target device.
    * \param max_block_size The maximum number of operators in a block. If a natural block has more
    * operators, we will split it to satisfy this constraint.
    * \param max_stream_num The maximum number of streams to support. If there are more independent
@@ -191,16 +354,12 @@ class IOSScheduler : public StreamSchedulerBase {
    * even if they have already satisfied the stream constraint. This may slower the scheduling.
    * \param schedule_units The schedule units. A schedule unit is a sequence of operators. We will
    * schedule the model based on these units. This helps to reduce the search complexity.
-   * \param warmup The number of warmups before real execution.
-   * \param number The number of executions as a repeat.
-   * \param repeat The number of repeat times.
    * \param verbose Whether print the verbose message during scheduling.
    */
-  explicit IOSScheduler(Device device, int max_block_size = 20, int max_stream_num = 5,
+  explicit IOSScheduler(IOSCostModel cost_model, int max_block_size = 20, int max_stream_num = 5,
                         int max_stage_ops = 10, bool search_group_combination = true,
-                        Array<Array<Op>> schedule_units = {}, int warmup = 2, int number = 5,
-                        int repeat = 5, bool verbose = false)
-      : cost_model_(device, warmup, number, repeat), verbose_(this, verbose) {
+                        Array<Array<Op>> schedule_units = {}, bool verbose = false)
+      : cost_model_(std::move(cost_model)), verbose_(this, verbose) {
     CHECK_GE(max_stream_num, 1) << "Stream number must be greater or equal to 1, but got "
                                 << max_stream_num;
     CHECK_LE(max_block_size, 64) << "Only support maximum block size less or equal to 64, but got "
@@ -943,13 +1102,14 @@ class IOSScheduler : public StreamSchedulerBase {
  * information about the meaning of each config parameter.
  * \return The scheduled expression.
  */
-Expr IOSStreamSchedule(const Expr& e, Device device, int block_max_size = 20,
+Expr IOSStreamSchedule(const Expr& e, Device device, IRModule mod, int block_max_size = 20,
                        int max_stream_num = 5, int max_stage_ops = 10,
                        bool search_group_combination = true, Array<Array<Op>> schedule_units = {},
-                       int warmup = 1, int number = 5, int repeat = 5, bool verbose = false) {
-  IOSScheduler scheduler(device, block_max_size, max_stream_num, max_stage_ops,
-                         search_group_combination, std::move(schedule_units), warmup, number,
-                         repeat, verbose);
+                       bool profile = true, int warmup = 1, int number = 5, int repeat = 5,
+                       int peak_gflops = 15000, bool verbose = false) {
+  IOSCostModel cost_model(device, mod, profile, warmup, number, repeat, peak_gflops);
+  IOSScheduler scheduler(std::move(cost_model), block_max_size, max_stream_num, max_stage_ops,
+                         search_group_combination, std::move(schedule_units), verbose);
   return scheduler.Schedule(e);
 }
 
@@ -975,6 +1135,8 @@ Pass IOSStreamSchedule() {
   int warmup = get_int_config("warmup", 2);
   int number = get_int_config("number", 1);
   int repeat = get_int_config("repeat", 8);
+  bool profile = get_bool_config("profile", true);
+  int peak_gflops = get_int_config("peak_gflops", 15000);
   bool verbose = get_bool_config("verbose", true);
   Array<Array<Op>> schedule_units =
       ctx->GetConfig<Array<Array<Op>>>("raf.stream_schedule.ios.schedule_units", Array<Array<Op>>())
@@ -990,8 +1152,9 @@ Pass IOSStreamSchedule() {
       [=](Function f, IRModule m, PassContext pc) {
         auto transform = [=](Expr e) {
           return ios_stream_schedule::IOSStreamSchedule(
-              e, Device(DevType::kCUDA(), 0), block_max_size, max_stream_num, max_stage_ops,
-              search_group_combination, schedule_units, warmup, number, repeat, verbose);
+              e, Device(DevType::kCUDA(), 0), m, block_max_size, max_stream_num, max_stage_ops,
+              search_group_combination, schedule_units, profile, warmup, number, repeat,
+              peak_gflops, verbose);
         };
         return Downcast<Function>(tvm::relay::TransformF(transform, f));
       };
@@ -1006,6 +1169,8 @@ TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.search_group_combinatio
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.warmup", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.number", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.repeat", tvm::Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.profile", tvm::Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.peak_gflops", tvm::Integer);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.verbose", tvm::Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.ios.schedule_units", Array<Array<Op>>);
 }  // namespace pass
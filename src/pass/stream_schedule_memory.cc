@@ -0,0 +1,243 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/pass/stream_schedule_memory.cc
+ * \brief Memory-aware stream scheduler.
+ */
+#include <relay/transforms/pass_utils.h>
+#include "raf/pass.h"
+#include "raf/analysis.h"
+#include "./stream_schedule.h"
+#include "../common/shape_utils.h"
+
+namespace raf {
+namespace pass {
+namespace memory_aware_stream_schedule {
+
+using namespace raf::analysis;
+using common::shape_utils::BytesCompactType;
+using stream_schedule::StreamSchedulerBase;
+using Node = DependencyGraph::Node;
+
+constexpr float kMegaBytes = 1048576;
+
+class MemoryAwareScheduler : public StreamSchedulerBase {
+ public:
+  MemoryAwareScheduler(int64_t budget, int64_t param_bytes)
+      : budget_(budget), param_bytes_(param_bytes) {
+  }
+
+  /*!
+   * \brief Schedule the dataflow graph on multiple streams under a memory budget. The schedule
+   * simulates the live memory in the issue order, where the output of a node is released once all
+   * nodes using it are issued:
+   *
+   * 1. Among the ready nodes, prefer the one with the longest path to the sink, as ASAP does. If
+   *    issuing it keeps the live memory within the budget, issue it and launch it on a stream that
+   *    continues the chain of one of its inputs, or on a new stream for a new branch.
+   *
+   * 2. Otherwise, issue the ready node that increases the live memory the least, so the branches
+   *    that release memory are finished first. This node is launched on the stream of the last
+   *    issued node, because running another branch concurrently would keep its activations alive.
+   *
+   * Events are added for the nodes used on other streams, and waited before their uses. With a
+   * zero budget, all nodes are scheduled as in step 1.
+   */
+  Expr Schedule(const Expr& e) {
+    Arena arena;
+    dg_ = CreateDependencyGraph(&arena, e, true, true);
+    InitNodeInfo();
+
+    std::vector<Node*> order;
+    std::unordered_map<Node*, int> stream_of;
+    std::unordered_map<int, Node*> stream_last_node;
+    std::unordered_map<Node*, int> num_pending_children, num_pending_parents;
+    std::vector<Node*> ready;
+    for (auto node : dg_.post_dfs_order) {
+      num_pending_children[node] = info_[node].num_children;
+      num_pending_parents[node] = info_[node].num_parents;
+      if (info_[node].num_children == 0) {
+        ready.push_back(node);
+      }
+    }
+
+    int64_t live = param_bytes_, peak = param_bytes_;
+    int num_streams = 0, num_serialized = 0;
+    while (!ready.empty()) {
+      // The memory released after issuing a node, whose inputs are not used by other nodes.
+      auto freed_bytes = [&](Node* node) {
+        int64_t freed = 0;
+        for (auto iit = node->children.head; iit; iit = iit->next) {
+          if (num_pending_parents[iit->value] == 1) {
+            freed += info_[iit->value].size;
+          }
+        }
+        return freed;
+      };
+      auto deeper = [&](Node* lhs, Node* rhs) {
+        return info_[lhs].depth != info_[rhs].depth ? info_[lhs].depth > info_[rhs].depth
+                                                    : info_[lhs].index < info_[rhs].index;
+      };
+      auto it = std::min_element(ready.begin(), ready.end(), deeper);
+      bool fit = budget_ == 0 || live + info_[*it].size <= budget_;
+      if (!fit) {
+        it = std::min_element(ready.begin(), ready.end(), [&](Node* lhs, Node* rhs) {
+          int64_t lhs_delta = info_[lhs].size - freed_bytes(lhs);
+          int64_t rhs_delta = info_[rhs].size - freed_bytes(rhs);
+          return lhs_delta != rhs_delta ? lhs_delta < rhs_delta : deeper(lhs, rhs);
+        });
+      }
+      Node* node = *it;
+      ready.erase(it);
+
+      // Choose the stream.
+      int stream_id = -1;
+      if (!fit && !order.empty()) {
+        stream_id = stream_of[order.back()];
+        num_serialized++;
+      } else {
+        for (auto iit = node->children.head; iit; iit = iit->next) {
+          auto child_stream = stream_of.find(iit->value);
+          if (child_stream != stream_of.end() &&
+              stream_last_node[child_stream->second] == iit->value) {
+            stream_id = child_stream->second;
+            break;
+          }
+        }
+        if (stream_id == -1) {
+          stream_id = ++num_streams;
+        }
+      }
+      stream_of[node] = stream_id;
+      stream_last_node[stream_id] = node;
+      order.push_back(node);
+
+      // Update the live memory.
+      live += info_[node].size;
+      peak = std::max(peak, live);
+      live -= freed_bytes(node);
+      for (auto iit = node->children.head; iit; iit = iit->next) {
+        num_pending_parents[iit->value]--;
+      }
+      for (auto iit = node->parents.head; iit; iit = iit->next) {
+        if (--num_pending_children[iit->value] == 0) {
+          ready.push_back(iit->value);
+        }
+      }
+    }
+    DLOG(INFO) << "Memory-aware stream schedule uses " << num_streams << " streams with estimated "
+               << "peak memory " << peak / kMegaBytes << " MBs, while the budget is "
+               << budget_ / kMegaBytes << " MBs. " << num_serialized
+               << " ops are serialized to fit into the budget.";
+
+    // Issue the nodes with the stream-related operators.
+    int event_id_clock = 0;
+    int curr_stream = -1;
+    std::unordered_map<Node*, int> finish_event;
+    for (auto node : order) {
+      int stream_id = stream_of[node];
+      if (stream_id != curr_stream) {
+        AnnotateSetStream(0, stream_id);
+        curr_stream = stream_id;
+      }
+      std::unordered_set<int> waited;
+      for (auto iit = node->children.head; iit; iit = iit->next) {
+        Node* child = iit->value;
+        if (stream_of[child] != stream_id && waited.insert(finish_event.at(child)).second) {
+          AnnotateWaitEvent(finish_event.at(child));
+        }
+      }
+      VisitExpr(info_[node].expr);
+      for (auto iit = node->parents.head; iit; iit = iit->next) {
+        if (stream_of[iit->value] != stream_id) {
+          finish_event[node] = event_id_clock++;
+          AnnotateAddEvent(finish_event[node]);
+          break;
+        }
+      }
+    }
+    return let_list_.Get(VisitExpr(e));
+  }
+
+ private:
+  /*! \brief Fill the expression, size, depth and degrees of each node. */
+  void InitNodeInfo() {
+    for (auto& it : dg_.expr_node) {
+      auto& info = info_[it.second];
+      info.expr = it.first;
+      // Tuples and their fields alias the tensors of other nodes.
+      if (it.first->IsInstance<CallNode>() && it.first->checked_type_.defined()) {
+        info.size = BytesCompactType(it.first->checked_type());
+      }
+    }
+    for (size_t i = 0; i < dg_.post_dfs_order.size(); ++i) {
+      Node* node = dg_.post_dfs_order[i];
+      info_[node].index = i;
+      for (auto iit = node->children.head; iit; iit = iit->next) {
+        info_[node].num_children++;
+      }
+    }
+    for (size_t i = dg_.post_dfs_order.size(); i != 0; i--) {
+      Node* node = dg_.post_dfs_order[i - 1];
+      info_[node].depth = 1;
+      for (auto iit = node->parents.head; iit; iit = iit->next) {
+        info_[node].depth = std::max(info_[node].depth, info_[iit->value].depth + 1);
+        info_[node].num_parents++;
+      }
+    }
+  }
+
+  struct NodeInfo {
+    /*! \brief The expression corresponding to the node. */
+    Expr expr;
+    /*! \brief The size of the output in bytes. */
+    int64_t size{};
+    /*! \brief The index in the post DFS order, which breaks the ties. */
+    size_t index{};
+    /*! \brief The maximum number of nodes of all paths starting from the node to sink node. */
+    int depth{};
+    /*! \brief The number of nodes this node depends on. */
+    int num_children{};
+    /*! \brief The number of nodes depending on this node. */
+    int num_parents{};
+  };
+
+  /*! \brief The memory budget in bytes. 0 means unlimited. */
+  int64_t budget_;
+  /*! \brief The total size of the function parameters in bytes. */
+  int64_t param_bytes_;
+  /*! \brief Dependency graph of given expr. */
+  DependencyGraph dg_;
+  /*! \brief The info for each node. */
+  std::unordered_map<const Node*, NodeInfo> info_;
+};
+
+}  // namespace memory_aware_stream_schedule
+
+Pass MemoryAwareStreamSchedule() {
+  pass::PassContext pass_ctx = pass::PassContext::Current();
+  int64_t memory_budget =
+      pass_ctx->GetConfig("raf.memory_budget", Integer(static_cast<int>(0))).value().IntValue();
+  tvm::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        int64_t param_bytes = 0;
+        for (const auto& param : f->params) {
+          param_bytes += common::shape_utils::BytesCompactType(param->checked_type());
+        }
+        auto transform = [=](const Expr& e) {
+          return memory_aware_stream_schedule::MemoryAwareScheduler(memory_budget, param_bytes)
+              .Schedule(e);
+        };
+        return Downcast<Function>(tvm::relay::TransformF(transform, f));
+      };
+  return CreateRAFFunctionPass(pass_func, 1, "MemoryAwareStreamSchedule", {});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.MemoryAwareStreamSchedule")
+    .set_body_typed(MemoryAwareStreamSchedule);
+
+}  // namespace pass
+}  // namespace raf
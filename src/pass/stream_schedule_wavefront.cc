@@ -20,35 +20,25 @@ namespace wavefront_stream_schedule {
 using namespace raf::analysis;
 using stream_schedule::StreamSchedulerBase;
 using Node = DependencyGraph::Node;
-using NodeExprMap = std::unordered_map<const Node*, Expr>;
-using analysis::dependency_graph::GetListSize;
+using analysis::dependency_graph::CSRGraph;
 
-/*! Chain, Wave, and Partition are used to describe a wavefront schedule. */
-using Chain = std::vector<Node*>;
+/*! Chain, Wave, and Partition are used to describe a wavefront schedule of the node numbers. */
+using Chain = std::vector<int>;
 using Wave = std::vector<Chain>;
 using Partition = std::vector<Wave>;
 
 /*!
  * \brief Partition the dependency graph into waves of operator chains.
- * \param dg The dependency graph we want to partition.
+ * \param graph The dependency graph we want to partition.
  * \return The wavefront partition.
  */
-Partition WavefrontPartition(DependencyGraph* dg) {
-  std::vector<Node*>& nodes = dg->post_dfs_order;
-
-  std::unordered_map<Node*, int> in_degree, out_degree;
-  for (auto& node : nodes) {
-    for (auto child = node->children.head; child; child = child->next) {
-      Node* child_node = child->value;
-      in_degree[child_node]++;
-      out_degree[node]++;
-    }
-  }
-
-  std::vector<Node*> free_nodes;
-  for (auto& node : nodes) {
-    if (out_degree[node] == 0) {
-      free_nodes.push_back(node);
+Partition WavefrontPartition(const CSRGraph& graph) {
+  std::vector<int> out_degree(graph.size());
+  std::vector<int> free_nodes;
+  for (int i = 0; i < graph.size(); ++i) {
+    out_degree[i] = graph.children(i).size();
+    if (out_degree[i] == 0) {
+      free_nodes.push_back(i);
     }
   }
 
@@ -56,31 +46,31 @@ Partition WavefrontPartition(DependencyGraph* dg) {
   while (!free_nodes.empty()) {
     Wave wave;
 
-    for (auto node : free_nodes) {
+    for (int node : free_nodes) {
       // Each free node corresponds to a chain
       // There are three cases of the number of the free node's parents
       // case 1. no parent
       // case 2. one parents
       // case 3. two or more parents
       Chain chain;
-      if (GetListSize(node->parents) != 1) {
+      if (graph.parents(node).size() != 1) {
         // case 1 and case 3. There is only the free node in this chain
         chain.push_back(node);
       } else {
         // case 2. There are more than one nodes in this chain, starting from the free node
         chain.push_back(node);
-        Node* next_node = node->parents.head->value;
-        while (GetListSize(next_node->parents) == 1 && out_degree[next_node] == 1) {
+        int next_node = *graph.parents(node).begin();
+        while (graph.parents(next_node).size() == 1 && out_degree[next_node] == 1) {
           chain.push_back(next_node);
           node = next_node;
-          next_node = node->parents.head->value;
+          next_node = *graph.parents(node).begin();
           CHECK_GE(out_degree[next_node], 1);
         }
         // There are three sub cases to stop growing this chain:
         // sub case 1. There are two or more nodes next_node depends on after ignoring previous
         //             waves (out_degree[next_node] > 1).
         // sub case 2. The number of nodes that depends on next_node does not equal to 1
-        //             (GetListSize(next_node->parents) != 1).
+        //             (graph.parents(next_node).size() != 1).
         // sub case 3. Both of sub case 1 and sub case 2.
         // For sub case 2, we should also take next_node into this chain.
         if (out_degree[next_node] == 1) {
@@ -91,11 +81,9 @@ Partition WavefrontPartition(DependencyGraph* dg) {
     }
     free_nodes.clear();
     for (auto& chain : wave) {
-      Node* last_node = chain.back();
-      for (auto parent = last_node->parents.head; parent; parent = parent->next) {
-        Node* parent_node = parent->value;
-        if (--out_degree[parent_node] == 0) {
-          free_nodes.push_back(parent_node);
+      for (int parent : graph.parents(chain.back())) {
+        if (--out_degree[parent] == 0) {
+          free_nodes.push_back(parent);
         }
       }
     }
@@ -106,6 +94,14 @@ Partition WavefrontPartition(DependencyGraph* dg) {
 
 class WavefrontScheduler : public StreamSchedulerBase {
  public:
+  /*!
+   * \brief The wavefront scheduler.
+   * \param priority Whether to launch the critical-path chain of each wave on a high-priority
+   * stream, so the other chains fill the idle SMs without delaying it.
+   */
+  explicit WavefrontScheduler(bool priority = false) : priority_(priority) {
+  }
+
   /*!
    * Generate the wavefront stream schedule. The input expr e is a dataflow graph in GNF format and
    * the output is the scheduled e in ANF.
@@ -123,6 +119,11 @@ class WavefrontScheduler : public StreamSchedulerBase {
    *
    *  When we finish the above two steps, we get the ANF of the scheduled computation graph.
    *
+   *  In the priority mode, the chains of each wave are sorted by the longest path from the chain
+   *  to the sink in the dependency graph. The most critical chain is launched on stream 1 with a
+   *  high priority, and the other chains are launched on stream 2, 3, ... with the default
+   *  priority. The default stream 0 is not used because it does not support priorities.
+   *
    * \param e The expr that we want to schedule. It should be a pure dataflow graph expr and should
    *          not contains any node that introduces new scope (such as FunctionNode, LetNode, and
    *          IfNode).
@@ -132,22 +133,32 @@ class WavefrontScheduler : public StreamSchedulerBase {
   Expr Schedule(const Expr& e) {
     Arena arena;
     DependencyGraph dg = CreateDependencyGraph(&arena, e, true, true);
+    CSRGraph graph(dg.post_dfs_order);
 
-    NodeExprMap node_expr;
+    std::vector<Expr> node_expr(graph.size());
     for (auto& it : dg.expr_node) {
-      node_expr[it.second] = it.first;
+      int i = graph.index(it.second);
+      if (i >= 0) {
+        node_expr[i] = it.first;
+      }
     }
 
-    Partition partition = WavefrontPartition(&dg);
+    Partition partition = WavefrontPartition(graph);
+    if (priority_) {
+      SortByCriticality(graph, &partition);
+    }
 
     for (int i = 0; i < partition.size(); i++) {
       Wave& wave = partition.at(i);
       for (int j = 0; j < wave.size(); j++) {
         Chain& chain = wave[j];
-        AnnotateSetStream(0, j);
-        for (Node* node : chain) {
-          Expr expr = node_expr.at(node);
-          VisitExpr(expr);
+        if (priority_) {
+          AnnotateSetStream(0, j + 1, j == 0 ? kHighPriority : 0);
+        } else {
+          AnnotateSetStream(0, j);
+        }
+        for (int node : chain) {
+          VisitExpr(node_expr[node]);
         }
       }
       if (i + 1 < partition.size()) {
@@ -156,25 +167,57 @@ class WavefrontScheduler : public StreamSchedulerBase {
     }
     return let_list_.Get(VisitExpr(e));
   }
+
+ private:
+  /*!
+   * \brief Sort the chains of each wave in the descending order of the number of nodes on the
+   * longest path from the chain to the sink, so the first chain of each wave is on the critical
+   * path.
+   */
+  void SortByCriticality(const CSRGraph& graph, Partition* partition) {
+    std::vector<int> depth(graph.size(), 1);
+    // The parents of a node come before it in the reversed post DFS order.
+    for (int i = graph.size() - 1; i >= 0; --i) {
+      for (int parent : graph.parents(i)) {
+        depth[i] = std::max(depth[i], depth[parent] + 1);
+      }
+    }
+    for (auto& wave : *partition) {
+      std::stable_sort(wave.begin(), wave.end(), [&](const Chain& lhs, const Chain& rhs) {
+        return depth[lhs.front()] > depth[rhs.front()];
+      });
+    }
+  }
+
+  /*! \brief The priority of the stream for the critical-path chains. */
+  static constexpr int64_t kHighPriority = 1;
+  /*! \brief Whether to launch the critical-path chains on a high-priority stream. */
+  bool priority_;
 };
 
-Expr WavefrontScheduleTransform(const Expr& e) {
-  return WavefrontScheduler().Schedule(e);
+Expr WavefrontScheduleTransform(const Expr& e, bool priority) {
+  return WavefrontScheduler(priority).Schedule(e);
 }
 
 }  // namespace wavefront_stream_schedule
 
 Pass WavefrontStreamSchedule() {
   pass::PassContext pass_ctx = pass::PassContext::Current();
+  bool priority =
+      pass_ctx->GetConfig<tvm::Bool>("raf.stream_schedule.wavefront.priority", tvm::Bool(false))
+          .value();
   tvm::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
       [=](Function f, IRModule m, PassContext pc) {
-        auto transform = wavefront_stream_schedule::WavefrontScheduleTransform;
+        auto transform = [=](const Expr& e) {
+          return wavefront_stream_schedule::WavefrontScheduleTransform(e, priority);
+        };
         return Downcast<Function>(tvm::relay::TransformF(transform, f));
       };
   return CreateRAFFunctionPass(pass_func, 1, "WavefrontStreamSchedule", {});
 }
 
 RAF_REGISTER_GLOBAL("raf.pass_.WavefrontStreamSchedule").set_body_typed(WavefrontStreamSchedule);
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.stream_schedule.wavefront.priority", tvm::Bool);
 
 }  // namespace pass
 }  // namespace raf
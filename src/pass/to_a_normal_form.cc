@@ -189,14 +189,17 @@ IRModule ToANormalFormAux(IRModule m) {
   tvm::Map<GlobalVar, BaseFunc> updates;
   auto funcs = m->functions;
   for (const auto& it : funcs) {
-    ICHECK_EQ(FreeVars(it.second).size(), 0);
     if (const auto* n = it.second.as<FunctionNode>()) {
       if (n->GetAttr<String>(attr::kCompiler).defined()) continue;
+      // The function is kept as is if it is already in ANF.
+      if (InNormalForm(GetRef<Function>(n), normal_form::kANF)) continue;
     }
+    ICHECK_EQ(FreeVars(it.second).size(), 0);
     Expr ret = TransformF([&](const Expr& e) { return ToANormalFormExpr(e); },
                           Downcast<Function>(it.second));
     ICHECK_EQ(FreeVars(ret).size(), 0)
         << ir::AsText(ret) << "should not has free vars: " << FreeVars(ret);
+    SetNormalForm(Downcast<Function>(ret), normal_form::kANF);
     updates.Set(it.first, Downcast<Function>(ret));
   }
 
@@ -44,10 +44,14 @@ Expr ToBasicBlockNormalFormExpr(const Expr& expr) {
 Pass ToBasicBlockNormalForm() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
+    if (InNormalForm(f, normal_form::kBBNF)) {
+      return f;
+    }
     ICHECK_EQ(FreeVars(f).size(), 0);
     Expr ret = TransformF([&](const Expr& e) { return ToBasicBlockNormalFormExpr(e); }, f);
     ICHECK_EQ(FreeVars(ret).size(), 0)
         << ir::AsText(ret) << "should not has free vars: " << FreeVars(ret);
+    SetNormalForm(Downcast<Function>(ret), normal_form::kBBNF);
     return Downcast<Function>(ret);
   };
   return CreateRAFFunctionPass(pass_func, 1, "ToBasicBlockNormalForm", {});
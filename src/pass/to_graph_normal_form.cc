@@ -105,7 +105,12 @@ class GNFConverter : public MixedModeMutator {
 Pass ToGraphNormalForm() {
   TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
                                                                              PassContext pc) {
-    return Downcast<Function>(to_graph_normal_form::GNFConverter().Mutate(f));
+    if (InNormalForm(f, normal_form::kGNF)) {
+      return f;
+    }
+    auto ret = Downcast<Function>(to_graph_normal_form::GNFConverter().Mutate(f));
+    SetNormalForm(ret, normal_form::kGNF);
+    return ret;
   };
   return CreateRAFFunctionPass(pass_func, 1, "ToGraphNormalForm", {});
 }
@@ -11,7 +11,10 @@
 #include <tvm/ir/module.h>
 #include <tvm/ir/type_functor.h>
 #include <tvm/tir/op.h>
+#include <mutex>
 #include "raf/op.h"
+#include "raf/cache.h"
+#include "raf/metrics.h"
 #include "raf/ir_ext.h"
 #include "raf/pass.h"
 #include "raf/pass_manager.h"
@@ -31,6 +34,107 @@ using tvm::relay::PrettyPrint;
 
 Type Unify(const Type& src, const Type& dst);
 
+/*!
+ * \brief Append the signature of an arg of a primitive to the key of the type memo.
+ * \return Whether the type of the primitive only depends on the signature, i.e., the arg is not
+ * a tensor whose data may be read, e.g., by the shape ops, or a symbolic shape.
+ */
+bool AppendArgSignature(const Value& value, HashKey* key) {
+  if (!value.defined()) {
+    *key << static_cast<uint8_t>(0);
+  } else if (const auto* ttv = value.as<TensorTypeValueObj>()) {
+    *key << static_cast<uint8_t>(1) << DLDataType(ttv->type->dtype);
+    *key << static_cast<int64_t>(ttv->type->shape.size());
+    for (const auto& dim : ttv->type->shape) {
+      if (const auto* imm = dim.as<IntImmNode>()) {
+        *key << imm->value;
+      } else if (dim.as<ir::AnyNode>()) {
+        *key << static_cast<int64_t>(-1);
+      } else {
+        return false;
+      }
+    }
+  } else if (const auto* tup = value.as<TupleValueObj>()) {
+    *key << static_cast<uint8_t>(2) << static_cast<int64_t>(tup->fields.size());
+    for (const auto& field : tup->fields) {
+      if (!AppendArgSignature(field, key)) {
+        return false;
+      }
+    }
+  } else if (const auto* iv = value.as<IntValueObj>()) {
+    *key << static_cast<uint8_t>(3) << DLDataType(iv->dtype) << iv->value;
+  } else if (const auto* fv = value.as<FloatValueObj>()) {
+    *key << static_cast<uint8_t>(4) << DLDataType(fv->dtype) << fv->value;
+  } else if (const auto* bv = value.as<BoolValueObj>()) {
+    *key << static_cast<uint8_t>(5) << bv->value;
+  } else if (const auto* sv = value.as<StringValueObj>()) {
+    *key << static_cast<uint8_t>(6) << sv->value;
+  } else if (value->IsInstance<NoGradValueObj>() || value->IsInstance<VoidValueObj>()) {
+    *key << static_cast<uint8_t>(7) << static_cast<uint32_t>(value->type_index());
+  } else if (const auto* opv = value.as<OpValueObj>()) {
+    *key << static_cast<uint8_t>(8) << reinterpret_cast<uint64_t>(opv->op.get());
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/*!
+ * \brief The types of the primitives memoized by the op and the signature of the args, which is
+ * shared by the runs of InferType, since most passes rerun it on the functions with few changes.
+ * Its capacity is RAF_INFER_TYPE_MEMO_CAPACITY, or 65536 entries if it is not set.
+ */
+ShardedMetaCache<Type>* PrimitiveTypeMemo() {
+  static ShardedMetaCache<Type>* memo = []() {
+    const char* capacity = getenv("RAF_INFER_TYPE_MEMO_CAPACITY");
+    return new ShardedMetaCache<Type>(capacity != nullptr ? std::stoul(capacity) : 65536);
+  }();
+  return memo;
+}
+
+/*!
+ * \brief The functions produced by InferType, along with the global functions they call. A
+ * function left untouched by the passes since then is reused by the incremental InferType, unless
+ * it calls a function that is changed.
+ */
+class InferredFunctions {
+ public:
+  static InferredFunctions* Get() {
+    static InferredFunctions* inst = new InferredFunctions();
+    return inst;
+  }
+
+  bool Lookup(const Function& func, Array<GlobalVar>* callees) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = entries_.find(func);
+    if (it == entries_.end()) {
+      return false;
+    }
+    *callees = it->second;
+    return true;
+  }
+
+  void Add(const Function& func) {
+    Array<GlobalVar> callees;
+    PostOrderVisit(func->body, [&callees](const Expr& expr) {
+      if (const auto* gvar = expr.as<GlobalVarNode>()) {
+        callees.push_back(GetRef<GlobalVar>(gvar));
+      }
+    });
+    std::lock_guard<std::mutex> lock(mu_);
+    if (entries_.size() >= kCapacity) {
+      // The functions are only held to keep their addresses valid, so they are dropped in bulk.
+      entries_.clear();
+    }
+    entries_[func] = callees;
+  }
+
+ private:
+  static constexpr size_t kCapacity = 4096;
+  std::unordered_map<Function, Array<GlobalVar>, ObjectPtrHash, ObjectPtrEqual> entries_;
+  std::mutex mu_;
+};
+
 #define RAF_NODE_NOT_IMPL(NodeType)                     \
   Expr VisitExpr_(const NodeType* node) override {      \
     LOG(FATAL) << "NotImplementedError: " << #NodeType; \
@@ -77,8 +181,15 @@ class TypeInferencer : public ExprMutator {
     return std::move(GetRef<GlobalVar>(op));
   }
 
-  CallValues SchemaToValue(Array<Expr> args, const Op op) {
-    CallValues call_values = CallValues::make();
+  /*!
+   * \brief Reuse a function inferred by an earlier run as is, which is not visited again.
+   */
+  void Reuse(const Function& func) {
+    memo_[func] = func;
+    visited_.insert(func);
+  }
+
+  Array<Value> ArgValues(const Array<Expr>& args) {
     Array<Value> arg_values;
     for (const auto& arg : args) {
       if (var_value_map_.count(arg.as<VarNode>())) {
@@ -87,11 +198,20 @@ class TypeInferencer : public ExprMutator {
         arg_values.push_back(GetValue(arg));
       }
     }
+    return arg_values;
+  }
+
+  CallValues SchemaToValue(const Array<Value>& arg_values, const Op op) {
+    CallValues call_values = CallValues::make();
     call_values->args = GetOpAttr<op::FRAFSchema>(op, "FRAFSchema")(arg_values);
     call_values->callee = OpValue::make(op);
     return call_values;
   }
 
+  CallValues SchemaToValue(Array<Expr> args, const Op op) {
+    return SchemaToValue(ArgValues(args), op);
+  }
+
   Expr VisitExpr_(const CallNode* call) override {
     static const Op& invoke_op = Op::Get("raf.op.vm.invoke_op");
     const OpNode* opn = call->op.as<OpNode>();
@@ -193,13 +313,36 @@ class TypeInferencer : public ExprMutator {
         return IncompleteType(kType);
       }
     }
-    CallValues call_values = SchemaToValue(call->args, op);
+    static auto* hits = metrics::MetricsRegistry::Get()->GetCounter(
+        "raf_infer_type_memo_total", "The lookups of the type memo of the primitives.",
+        {{"result", "hit"}});
+    static auto* misses = metrics::MetricsRegistry::Get()->GetCounter(
+        "raf_infer_type_memo_total", "The lookups of the type memo of the primitives.",
+        {{"result", "miss"}});
+    Array<Value> arg_values = ArgValues(call->args);
+    HashKey key;
+    key << reinterpret_cast<uint64_t>(op.get()) << static_cast<int64_t>(arg_values.size());
+    bool memoizable = true;
+    for (const auto& value : arg_values) {
+      if (!AppendArgSignature(value, &key)) {
+        memoizable = false;
+        break;
+      }
+    }
+    Type memoized;
+    if (memoizable && PrimitiveTypeMemo()->Get(key, &memoized)) {
+      hits->Add();
+      return memoized;
+    }
+    misses->Add();
+    CallValues call_values = SchemaToValue(arg_values, op);
     // invoke type inference
     auto fty = Downcast<FuncType>(op->checked_type());
     CHECK_EQ(fty->type_constraints.size(), 1);
     TypeInference ti = Downcast<TypeInference>(fty->type_constraints[0]);
     try {
-      return ti->func(call_values);
+      Type type = ti->func(call_values);
+      return memoizable ? PrimitiveTypeMemo()->Set(key, type) : type;
     } catch (const dmlc::Error& e) {
       LOG(FATAL) << "Failed to infer type of the following primitive: " << std::endl
                  << raf::ir::AsText(call) << std::endl
@@ -612,24 +755,78 @@ void AddGlobalTypes(ir::IRModule mod) {
   }
 }
 
+/*!
+ * \brief Find the functions of a module that are produced by an earlier InferType and are not
+ * changed since then, excluding the ones that call a changed function.
+ */
+std::unordered_map<GlobalVar, Function, ObjectPtrHash, ObjectPtrEqual> FindInferredFunctions(
+    const ir::IRModule& mod) {
+  std::unordered_map<GlobalVar, Function, ObjectPtrHash, ObjectPtrEqual> inferred;
+  std::unordered_map<GlobalVar, Array<GlobalVar>, ObjectPtrHash, ObjectPtrEqual> callees;
+  for (const auto& kv : mod->functions) {
+    if (auto func = kv.second.as<ir::FunctionNode>()) {
+      Array<GlobalVar> func_callees;
+      if (type_infer::InferredFunctions::Get()->Lookup(GetRef<Function>(func), &func_callees)) {
+        inferred[kv.first] = GetRef<Function>(func);
+        callees[kv.first] = func_callees;
+      }
+    }
+  }
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto it = inferred.begin(); it != inferred.end();) {
+      bool stale = false;
+      for (const auto& callee : callees[it->first]) {
+        stale |= inferred.count(callee) == 0;
+      }
+      if (stale) {
+        it = inferred.erase(it);
+        changed = true;
+      } else {
+        ++it;
+      }
+    }
+  }
+  return inferred;
+}
+
 Pass InferType() {
-  return CreateModulePass(
+  return CachedPass(CreateModulePass(
       [=](IRModule mod, const PassContext& pass_ctx) {
         DLOG(INFO) << "pass::InferType";
+        bool incremental =
+            pass_ctx->GetConfig<tvm::Bool>("raf.infer_type.incremental", tvm::Bool(false)).value();
+        std::unordered_map<GlobalVar, Function, ObjectPtrHash, ObjectPtrEqual> inferred;
+        if (incremental) {
+          inferred = FindInferredFunctions(mod);
+        }
         ir::IRModule updated_mod = ir::IRModule(mod->functions);
         AddGlobalTypes(updated_mod);
         auto ti = type_infer::TypeInferencer(updated_mod);
+        for (const auto& kv : inferred) {
+          updated_mod->Add(kv.first, kv.second, true);
+          ti.Reuse(kv.second);
+        }
         for (auto kv : updated_mod->functions) {
-          if (kv.second.as<ir::FunctionNode>()) {
+          if (kv.second.as<ir::FunctionNode>() && inferred.count(kv.first) == 0) {
             auto func = tvm::runtime::Downcast<ir::Function>(ti.VisitExpr(kv.second));
             updated_mod->Add(kv.first, func, true);
           }
         }
+        if (incremental) {
+          for (const auto& kv : updated_mod->functions) {
+            if (auto func = kv.second.as<ir::FunctionNode>()) {
+              type_infer::InferredFunctions::Get()->Add(GetRef<Function>(func));
+            }
+          }
+        }
         return updated_mod;
       },
-      0, "InferType", {});
+      0, "InferType", {}));
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("raf.infer_type.incremental", Bool);
+
 Expr InferType(Expr func) {
   auto mod = GlobalModule();
   return type_infer::TypeInferencer(mod).VisitExpr(func);
@@ -0,0 +1,267 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/pass/view_propagation.cc
+ * \brief Rewrite the layout ops whose outputs are contiguous elements of their inputs to views,
+ * i.e., transposes that only move the unit dims, and slices and splits that take contiguous
+ * chunks. The views share the memory of their inputs, so no kernel is launched and no copy is
+ * made for them.
+ */
+#include <algorithm>
+#include <vector>
+#include "raf/op.h"
+#include "raf/op_utils.h"
+#include "raf/ir_ext.h"
+#include "raf/pass.h"
+#include "raf/value.h"
+
+namespace raf {
+namespace pass {
+namespace view_propagation {
+
+using namespace raf::ir;
+using namespace raf::op;
+using namespace raf::value;
+
+/*!
+ * \brief Get the static shape of a tensor type.
+ * \param type The type.
+ * \param shape The shape of the type.
+ * \return Whether the type is a tensor of a static shape.
+ */
+bool GetStaticShape(const Type& type, std::vector<int64_t>* shape) {
+  const auto* ttype = type.as<TensorTypeNode>();
+  if (ttype == nullptr) {
+    return false;
+  }
+  shape->clear();
+  for (const auto& dim : ttype->shape) {
+    const auto* imm = dim.as<IntImmNode>();
+    if (imm == nullptr) {
+      return false;
+    }
+    shape->push_back(imm->value);
+  }
+  return true;
+}
+
+/*! \brief Get the value of a constant argument, which is undefined if it is not a constant. */
+Value GetConstArg(const Expr& arg) {
+  const auto* node = arg.as<ConstantNode>();
+  if (node == nullptr) {
+    return Value();
+  }
+  auto value = ConstantExtractValue(GetRef<Constant>(node));
+  return value.defined() ? Downcast<Value>(value) : Value();
+}
+
+class ViewMutator : public MixedModeMutator {
+ public:
+  using MixedModeMutator::VisitExpr_;
+
+  Expr VisitExpr_(const FunctionNode* node) final {
+    if (node->HasNonzeroAttr(attr::kPrimitive)) {
+      // Don't go into fused functions
+      return GetRef<Function>(node);
+    }
+    return ExprMutator::VisitExpr_(node);
+  }
+
+  Expr Rewrite_(const CallNode* pre, const Expr& post) final {
+    static auto transpose_op = Op::Get("raf.op.transpose");
+    static auto strided_slice_op = Op::Get("raf.op.strided_slice");
+    static auto split_op = Op::Get("raf.op.split");
+    const auto* call = post.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>() || !pre->checked_type_.defined() ||
+        !call->args[0]->checked_type_.defined()) {
+      return post;
+    }
+    std::vector<int64_t> in_shape;
+    if (!GetStaticShape(call->args[0]->checked_type(), &in_shape)) {
+      return post;
+    }
+    const Op& op = Downcast<Op>(call->op);
+    Expr ret;
+    if (op == transpose_op) {
+      ret = RewriteTranspose(call, in_shape, pre->checked_type());
+    } else if (op == strided_slice_op) {
+      ret = RewriteStridedSlice(call, in_shape, pre->checked_type());
+    } else if (op == split_op) {
+      ret = RewriteSplit(call, in_shape, pre->checked_type());
+    }
+    return ret.defined() ? ret : post;
+  }
+
+  Expr Rewrite_(const TupleGetItemNode* pre, const Expr& post) final {
+    // Forward the views of a rewritten split.
+    const auto* node = post.as<TupleGetItemNode>();
+    if (const auto* tuple = node->tuple.as<TupleNode>()) {
+      return tuple->fields[node->index];
+    }
+    return post;
+  }
+
+ private:
+  /*! \brief A transpose that keeps the order of the non-unit dims is a reshape. */
+  Expr RewriteTranspose(const CallNode* call, const std::vector<int64_t>& in_shape,
+                        const Type& out_type) {
+    static auto reshape_op = Op::Get("raf.op.reshape");
+    std::vector<int64_t> out_shape;
+    if (!GetStaticShape(out_type, &out_shape)) {
+      return Expr();
+    }
+    std::vector<int64_t> axes;
+    if (call->args.size() < 2) {
+      return Expr();
+    }
+    auto axes_value = GetConstArg(call->args[1]);
+    int64_t ndim = in_shape.size();
+    if (!axes_value.defined() && call->args[1].as<ConstantNode>()) {
+      // The axes are reversed by default.
+      for (int64_t i = ndim - 1; i >= 0; --i) {
+        axes.push_back(i);
+      }
+    } else if (axes_value.defined() && axes_value->IsInstance<TupleValueObj>()) {
+      axes = GetShapeVecFromValue(axes_value);
+    }
+    if (static_cast<int64_t>(axes.size()) != ndim) {
+      return Expr();
+    }
+    int64_t last = -1;
+    for (auto axis : axes) {
+      axis = axis < 0 ? axis + ndim : axis;
+      if (in_shape[axis] == 1) {
+        continue;
+      }
+      if (axis < last) {
+        return Expr();
+      }
+      last = axis;
+    }
+    auto ret = Call(reshape_op, {call->args[0], MakeConstant(ArrayToIntTuple(out_shape)),
+                                 MakeConstant(BoolValue::make(false))});
+    ret->checked_type_ = out_type;
+    return ret;
+  }
+
+  /*! \brief A slice of unit steps is a view if it takes contiguous elements. */
+  Expr RewriteStridedSlice(const CallNode* call, const std::vector<int64_t>& in_shape,
+                           const Type& out_type) {
+    std::vector<int64_t> out_shape;
+    if (!GetStaticShape(out_type, &out_shape) || out_shape.size() != in_shape.size()) {
+      return Expr();
+    }
+    auto begin_value = GetConstArg(call->args[1]);
+    auto strides_value = call->args.size() > 3 ? GetConstArg(call->args[3]) : Value();
+    auto mode_value = call->args.size() > 4 ? GetConstArg(call->args[4]) : Value();
+    if (!begin_value.defined() || !begin_value->IsInstance<TupleValueObj>()) {
+      return Expr();
+    }
+    bool size_mode = mode_value.defined() && mode_value->IsInstance<StringValueObj>() &&
+                     Downcast<StringValue>(mode_value)->value == "size";
+    if (!size_mode && strides_value.defined() && strides_value->IsInstance<TupleValueObj>()) {
+      for (auto stride : GetShapeVecFromValue(strides_value)) {
+        if (stride != 1) {
+          return Expr();
+        }
+      }
+    } else if (!size_mode && call->args.size() > 3 && !call->args[3].as<ConstantNode>()) {
+      return Expr();
+    }
+    std::vector<int64_t> begin = GetShapeVecFromValue(begin_value);
+    int64_t ndim = in_shape.size();
+    begin.resize(ndim, 0);
+    for (int64_t i = 0; i < ndim; ++i) {
+      begin[i] = begin[i] < 0 ? begin[i] + in_shape[i] : begin[i];
+      begin[i] = std::min(std::max(begin[i], int64_t(0)), in_shape[i]);
+    }
+    return MakeView(call->args[0], in_shape, out_shape, begin, out_type);
+  }
+
+  /*! \brief A split is a tuple of views if the dims before its axis are all 1. */
+  Expr RewriteSplit(const CallNode* call, const std::vector<int64_t>& in_shape,
+                    const Type& out_type) {
+    const auto* tuple_type = out_type.as<TupleTypeNode>();
+    auto axis_value = call->args.size() > 2 ? GetConstArg(call->args[2]) : Value();
+    if (tuple_type == nullptr || !axis_value.defined() ||
+        !axis_value->IsInstance<IntValueObj>()) {
+      return Expr();
+    }
+    int64_t ndim = in_shape.size();
+    int64_t axis = Downcast<IntValue>(axis_value)->value;
+    axis = axis < 0 ? axis + ndim : axis;
+    Array<Expr> fields;
+    std::vector<int64_t> begin(ndim, 0);
+    for (const auto& field_type : tuple_type->fields) {
+      std::vector<int64_t> out_shape;
+      if (!GetStaticShape(field_type, &out_shape)) {
+        return Expr();
+      }
+      auto view = MakeView(call->args[0], in_shape, out_shape, begin, field_type);
+      if (!view.defined()) {
+        return Expr();
+      }
+      fields.push_back(view);
+      begin[axis] += out_shape[axis];
+    }
+    auto ret = Tuple(fields);
+    ret->checked_type_ = out_type;
+    return ret;
+  }
+
+  /*!
+   * \brief Make the view of the box of out_shape at begin of the compact input, which is
+   * undefined if the elements of the box are not contiguous, or the view is not aligned.
+   */
+  Expr MakeView(const Expr& x, const std::vector<int64_t>& in_shape,
+                const std::vector<int64_t>& out_shape, const std::vector<int64_t>& begin,
+                const Type& out_type) {
+    static auto view_op = Op::Get("raf.op.view");
+    int64_t ndim = in_shape.size();
+    // The box is contiguous if the dims before its first non-unit dim are 1, and the dims after
+    // it are full.
+    int64_t first = 0;
+    while (first < ndim && out_shape[first] == 1) {
+      ++first;
+    }
+    for (int64_t i = first + 1; i < ndim; ++i) {
+      if (out_shape[i] != in_shape[i]) {
+        return Expr();
+      }
+    }
+    int64_t offset = 0;
+    int64_t stride = 1;
+    for (int64_t i = ndim - 1; i >= 0; --i) {
+      offset += begin[i] * stride;
+      stride *= in_shape[i];
+    }
+    // The kernels assume their inputs are aligned as the allocated buffers.
+    const auto* ttype = out_type.as<TensorTypeNode>();
+    int64_t nbytes = (ttype->dtype.bits() * ttype->dtype.lanes() + 7) / 8;
+    if (offset * nbytes % kDefaultMemoryAlignment != 0) {
+      return Expr();
+    }
+    auto ret = Call(view_op, {x, MakeConstant(ArrayToIntTuple(out_shape)),
+                              MakeConstant(ScalarValue::make(offset))});
+    ret->checked_type_ = out_type;
+    return ret;
+  }
+};
+
+}  // namespace view_propagation
+
+Pass ViewPropagation() {
+  TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func = [=](Function f, IRModule m,
+                                                                             PassContext pc) {
+    return Downcast<Function>(view_propagation::ViewMutator().Mutate(f));
+  };
+  return CreateRAFFunctionPass(pass_func, 1, "ViewPropagation", {"InferType"});
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_.ViewPropagation").set_body_typed(ViewPropagation);
+
+}  // namespace pass
+}  // namespace raf
@@ -9,6 +9,7 @@
  */
 #include "raf/registry.h"
 #include "raf/profiler.h"
+#include "raf/tracer.h"
 
 namespace raf {
 namespace profiler {
@@ -26,9 +27,16 @@ Profiler* Profiler::Get() {
 
 void Profiler::AddNewProfileStat(std::string categories, std::string name, uint64_t start_time,
                                  uint64_t end_time, const std::vector<std::string>& args) {
-  std::unique_ptr<ProfileStat> stat =
-      std::unique_ptr<ProfileStat>(new ProfileStat(categories, name, start_time, end_time, args));
-  profile_stats_.opr_exec_stats_->enqueue(stat.release());
+  auto tracer = Tracer::Get();
+  std::string args_string;
+  if (!args.empty()) {
+    for (int i = 0; i < args.size() - 1; i++) {
+      args_string += args[i] + ";";
+    }
+    args_string += args[args.size() - 1];
+  }
+  tracer->Record(start_time, end_time, tracer->Intern(name), tracer->Intern(categories),
+                 tracer->Intern(args_string));
 }
 
 std::string Profiler::GetProfile() {
@@ -37,19 +45,13 @@ std::string Profiler::GetProfile() {
   ss << "{" << std::endl;
   ss << "    \"traceEvents\": [" << std::endl;
 
-  if (profile_stats_.opr_exec_stats_->size_approx() == 0 && !helpers_.empty()) {
-    CollectStat();
-  }
-  ProfileStat* stat;
   int stat_count = 0;
-  while (profile_stats_.opr_exec_stats_->try_dequeue(stat)) {
-    CHECK_NOTNULL(stat);
-    std::unique_ptr<ProfileStat> profile_stat(stat);  // manage lifecycle
-    CHECK_NE(profile_stat->categories_.c_str()[0], '\0') << "Category must be set";
+  for (auto& stat : GetProfileStats()) {
+    CHECK_NE(stat.categories_.c_str()[0], '\0') << "Category must be set";
     if (stat_count) {
       ss << ",\n";
     }
-    profile_stat->EmitEvents(&ss);
+    stat.EmitEvents(&ss);
     ++stat_count;
   }
   ss << "\n" << std::endl;
@@ -61,32 +63,30 @@ std::string Profiler::GetProfile() {
 
 std::vector<ProfileStat> Profiler::GetProfileStats() {
   std::lock_guard<std::recursive_mutex> lock{this->m_};
+  auto tracer = Tracer::Get();
   std::vector<ProfileStat> results;
-
-  if (profile_stats_.opr_exec_stats_->size_approx() == 0 && !helpers_.empty()) {
-    CollectStat();
-  }
-  ProfileStat* stat;
-  while (profile_stats_.opr_exec_stats_->try_dequeue(stat)) {
-    CHECK_NOTNULL(stat);
-    results.push_back(*stat);
+  // Decode the strings once per id instead of per event.
+  std::unordered_map<uint32_t, std::string> strings;
+  auto get_string = [&](uint32_t id) -> const std::string& {
+    auto it = strings.find(id);
+    if (it == strings.end()) {
+      it = strings.emplace(id, tracer->GetString(id)).first;
+    }
+    return it->second;
+  };
+  for (const auto& e : tracer->GetEvents()) {
+    std::vector<std::string> args;
+    if (e.args != 0) {
+      args.push_back(get_string(e.args));
+    }
+    results.emplace_back(get_string(e.category), get_string(e.name), e.start_us, e.end_us, args);
   }
   return results;
 }
 
 void Profiler::ClearProfile() {
   std::lock_guard<std::recursive_mutex> lock{this->m_};
-  helpers_.clear();
-}
-
-DeviceStats::~DeviceStats() {
-  std::shared_ptr<TQueue> es = opr_exec_stats_;
-  if (es) {
-    ProfileStat* stat = nullptr;
-    while (es->try_dequeue(stat)) {
-      delete stat;
-    }
-  }
+  Tracer::Get()->Clear();
 }
 
 ProfileStat::ProfileStat(std::string categories, std::string name, uint64_t start_time,
@@ -142,7 +142,7 @@ void DisableProfiler() {
 }
 
 void CollectBaseProfile() {
-  Profiler::Get()->CollectStat();
+  // The base events are recorded into the tracer when they stop, so there is nothing to collect.
 }
 
 std::string GetProfile() {
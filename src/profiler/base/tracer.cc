@@ -0,0 +1,199 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/base/tracer.cc
+ * \brief The ring buffers, the string interning and the offline export of the tracer
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include "raf/registry.h"
+#include "raf/profiler.h"
+#include "raf/tracer.h"
+
+namespace raf {
+namespace profiler {
+
+TraceBuffer::TraceBuffer(uint32_t thread, size_t capacity)
+    : thread_(thread), mask_(capacity - 1), events_(capacity) {
+  CHECK(capacity > 0 && (capacity & (capacity - 1)) == 0)
+      << "The capacity of the trace buffer must be a power of 2, but got " << capacity;
+}
+
+uint64_t TraceBuffer::Read(std::vector<TraceEvent>* out) const {
+  uint64_t capacity = mask_ + 1;
+  uint64_t head = head_.load(std::memory_order_acquire);
+  uint64_t tail = tail_.load(std::memory_order_relaxed);
+  uint64_t begin = std::max(tail, head > capacity ? head - capacity : 0);
+  size_t offset = out->size();
+  for (uint64_t i = begin; i < head; ++i) {
+    out->push_back(events_[i & mask_]);
+  }
+  // The owner may keep recording during the copy, and the events that it wraps around onto were
+  // copied torn, so drop them.
+  uint64_t now = head_.load(std::memory_order_acquire);
+  uint64_t valid = std::max(begin, now > capacity ? now - capacity : 0);
+  valid = std::min(valid, head);
+  out->erase(out->begin() + offset, out->begin() + offset + (valid - begin));
+  return valid - tail;
+}
+
+Tracer::Tracer() {
+  const char* val = getenv("RAF_TRACE_BUFFER_SIZE");
+  int64_t size = val == nullptr ? 0 : atoll(val);
+  // Round up to a power of 2, which is 64K events (2MB) per thread by default.
+  capacity_ = 1;
+  while (capacity_ < static_cast<size_t>(std::max<int64_t>(size, 1 << 16))) {
+    capacity_ <<= 1;
+  }
+  strings_.push_back("");
+  ids_[""] = 0;
+}
+
+Tracer* Tracer::Get() {
+  static Tracer tracer;
+  return &tracer;
+}
+
+uint32_t Tracer::Intern(const std::string& str) {
+  thread_local std::unordered_map<std::string, uint32_t> cache;
+  auto it = cache.find(str);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  uint32_t id;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto git = ids_.find(str);
+    if (git != ids_.end()) {
+      id = git->second;
+    } else {
+      id = strings_.size();
+      strings_.push_back(str);
+      ids_[str] = id;
+    }
+  }
+  cache[str] = id;
+  return id;
+}
+
+std::string Tracer::GetString(uint32_t id) {
+  std::lock_guard<std::mutex> lock(mu_);
+  CHECK_LT(id, strings_.size()) << "Unknown interned string " << id;
+  return strings_[id];
+}
+
+TraceBuffer* Tracer::NewBuffer() {
+  return NewTrack("");
+}
+
+TraceBuffer* Tracer::NewTrack(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mu_);
+  track_names_.push_back(name.empty() ? "Thread " + std::to_string(buffers_.size()) : name);
+  buffers_.emplace_back(new TraceBuffer(buffers_.size(), capacity_));
+  return buffers_.back().get();
+}
+
+std::vector<TraceEvent> Tracer::GetEvents() {
+  std::vector<TraceEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    dropped_ = 0;
+    for (const auto& buffer : buffers_) {
+      dropped_ += buffer->Read(&events);
+    }
+  }
+  if (dropped_ > 0) {
+    LOG(WARNING) << dropped_ << " trace events are overwritten. Set RAF_TRACE_BUFFER_SIZE to keep "
+                 << "more events per thread.";
+  }
+  std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+    return a.start_us < b.start_us;
+  });
+  return events;
+}
+
+void Tracer::Clear() {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (const auto& buffer : buffers_) {
+    buffer->Clear();
+  }
+  dropped_ = 0;
+}
+
+/*! \brief Write a string as a JSON string literal. */
+static void WriteJSONString(std::ostream* os, const std::string& str) {
+  *os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      *os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      *os << ' ';
+    } else {
+      *os << c;
+    }
+  }
+  *os << '"';
+}
+
+std::string Tracer::ExportChromeTrace() {
+  std::vector<TraceEvent> events = GetEvents();
+  size_t pid = current_process_id();
+  std::ostringstream os;
+  os << "{\"traceEvents\": [";
+  std::vector<std::string> track_names;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    track_names = track_names_;
+  }
+  for (uint32_t i = 0; i < track_names.size(); ++i) {
+    os << (i ? ",\n" : "\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+       << ", \"tid\": " << i << ", \"args\": {\"name\": ";
+    WriteJSONString(&os, track_names[i]);
+    os << "}}";
+  }
+  // Decode the strings once per id instead of per event.
+  std::unordered_map<uint32_t, std::string> strings;
+  auto get_string = [&](uint32_t id) -> const std::string& {
+    auto it = strings.find(id);
+    if (it == strings.end()) {
+      it = strings.emplace(id, GetString(id)).first;
+    }
+    return it->second;
+  };
+  for (const auto& e : events) {
+    os << ",\n{\"name\": ";
+    WriteJSONString(&os, get_string(e.name));
+    os << ", \"cat\": ";
+    WriteJSONString(&os, get_string(e.category));
+    os << ", \"ph\": \"" << static_cast<char>(kComplete) << "\", \"ts\": " << e.start_us
+       << ", \"dur\": " << e.end_us - e.start_us << ", \"pid\": " << pid
+       << ", \"tid\": " << e.thread;
+    if (e.args != 0) {
+      os << ", \"args\": {\"args_string\": ";
+      WriteJSONString(&os, get_string(e.args));
+      os << "}";
+    }
+    os << "}";
+  }
+  os << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": " << dropped_
+     << "}}\n";
+  return os.str();
+}
+
+void DumpTrace(std::string path) {
+  std::ofstream ofs(path);
+  CHECK(ofs.is_open()) << "Cannot open " << path;
+  ofs << Tracer::Get()->ExportChromeTrace();
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.DumpTrace").set_body_typed(DumpTrace);
+RAF_REGISTER_GLOBAL("raf.profiler.ExportTrace").set_body_typed([]() {
+  return Tracer::Get()->ExportChromeTrace();
+});
+
+}  // namespace profiler
+}  // namespace raf
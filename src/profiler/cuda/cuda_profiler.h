@@ -53,8 +53,8 @@ using raf::event_pool::Event;
 
 class CudaProfilerHelper : public ProfilerHelper {
  public:
-  CudaProfilerHelper(int dev_id, raf::DevType dev_type, void* stream, std::string name,
-                     std::string categories, std::vector<std::string> args = {});
+  CudaProfilerHelper(int dev_id, raf::DevType dev_type, void* stream, const std::string& name,
+                     const std::string& categories, const std::string& args = "");
 
   void start() {
     cuda_api->EventRecordOnStream(start_event->data(), stream);
@@ -62,6 +62,7 @@ class CudaProfilerHelper : public ProfilerHelper {
   void stop() {
     cuda_api->EventRecordOnStream(end_event->data(), stream);
   }
+  /*! \brief Wait for the end event, and record the event into the tracer. */
   void collect();
 
  public:
@@ -86,7 +87,7 @@ class CudaProfiler {
    * \return The elapsed time in microsecond.
    */
   uint64_t GetElapsedTimeInMicrosec(std::shared_ptr<Event> event);
-  /*! \brief Collect CUDA stats. */
+  /*! \brief Collect CUDA stats into the tracer, and drop the collected helpers. */
   void CollectCudaStat();
   /*! \brief Clear CUDA stats. */
   void ClearCudaStat();
@@ -0,0 +1,251 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cupti/cupti_profiler.cc
+ * \brief The CUPTI activity collector
+ */
+#include <cupti.h>
+#include <cxxabi.h>
+#include <cstdlib>
+#include "raf/registry.h"
+#include "./cupti_profiler.h"
+
+#define CUPTI_CALL(func)                                                  \
+  do {                                                                    \
+    CUptiResult e = (func);                                               \
+    if (e != CUPTI_SUCCESS) {                                             \
+      const char* msg;                                                    \
+      cuptiGetResultString(e, &msg);                                      \
+      LOG(FATAL) << "CUPTI: " #func " failed with error: " << msg;        \
+    }                                                                     \
+  } while (false)
+
+namespace raf {
+namespace profiler {
+
+/*! \brief The size of each activity buffer, which CUPTI fills before it is completed. */
+constexpr size_t kCuptiBufferSize = 8 << 20;
+
+/*! \brief The external correlation kind of the VM instructions. */
+constexpr CUpti_ExternalCorrelationKind kCorrelationKind = CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0;
+
+/*! \brief The device activities to record. */
+static const std::vector<CUpti_ActivityKind> kActivityKinds = {
+    CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL, CUPTI_ACTIVITY_KIND_MEMCPY, CUPTI_ACTIVITY_KIND_MEMSET,
+    CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION};
+
+static void CUPTIAPI BufferRequested(uint8_t** buffer, size_t* size, size_t* max_num_records) {
+  // The buffer must be aligned to 8 bytes, which malloc guarantees.
+  *buffer = static_cast<uint8_t*>(malloc(kCuptiBufferSize));
+  CHECK(*buffer != nullptr) << "Cannot allocate the CUPTI activity buffer";
+  *size = kCuptiBufferSize;
+  *max_num_records = 0;
+}
+
+static void CUPTIAPI BufferCompleted(CUcontext ctx, uint32_t stream_id, uint8_t* buffer,
+                                     size_t size, size_t valid_size) {
+  if (valid_size > 0) {
+    CuptiProfiler::Get()->AddBuffer(buffer, valid_size);
+  }
+  size_t dropped = 0;
+  CUPTI_CALL(cuptiActivityGetNumDroppedRecords(ctx, stream_id, &dropped));
+  if (dropped > 0) {
+    LOG(WARNING) << "CUPTI dropped " << dropped << " activity records";
+  }
+  free(buffer);
+}
+
+/*! \brief The category of a memcpy, e.g., CUPTI Memcpy HtoD. */
+static std::string MemcpyCategory(uint8_t kind) {
+  switch (kind) {
+    case CUPTI_ACTIVITY_MEMCPY_KIND_HTOD:
+      return "CUPTI Memcpy HtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOH:
+      return "CUPTI Memcpy DtoH";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOD:
+      return "CUPTI Memcpy DtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_PTOP:
+      return "CUPTI Memcpy PtoP";
+    default:
+      return "CUPTI Memcpy";
+  }
+}
+
+CuptiProfiler* CuptiProfiler::Get() {
+  static CuptiProfiler profiler;
+  return &profiler;
+}
+
+void CuptiProfiler::Enable() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (enabled_) {
+    return;
+  }
+  if (!registered_) {
+    CUPTI_CALL(cuptiActivityRegisterCallbacks(BufferRequested, BufferCompleted));
+    registered_ = true;
+  }
+  for (auto kind : kActivityKinds) {
+    CUPTI_CALL(cuptiActivityEnable(kind));
+  }
+  uint64_t cupti_ns;
+  CUPTI_CALL(cuptiGetTimestamp(&cupti_ns));
+  clock_offset_ns_ = static_cast<int64_t>(ProfileStat::NowInMicrosec() * 1000) -
+                     static_cast<int64_t>(cupti_ns);
+  enabled_ = true;
+}
+
+void CuptiProfiler::Disable() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!enabled_) {
+      return;
+    }
+    enabled_ = false;
+    for (auto kind : kActivityKinds) {
+      CUPTI_CALL(cuptiActivityDisable(kind));
+    }
+  }
+  // The flush calls back AddBuffer, which takes the lock.
+  CUPTI_CALL(cuptiActivityFlushAll(0));
+}
+
+CuptiLaunch CuptiProfiler::PushCorrelation(int64_t func_index, int64_t pc,
+                                           const std::string& name) {
+  // The launches the thread has seen, so a launch takes no lock after its first time.
+  thread_local std::map<std::tuple<int64_t, int64_t, uint32_t>, CuptiLaunch> cache;
+  auto tracer = Tracer::Get();
+  uint32_t name_id = tracer->Intern(name);
+  auto key = std::make_tuple(func_index, pc, name_id);
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    std::string args = "op: " + name + "; func: " + std::to_string(func_index) +
+                       "; pc: " + std::to_string(pc);
+    CuptiLaunch launch{0, name_id, tracer->Intern(args)};
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      launch.id = launches_.size() + 1;
+      launches_.push_back(launch);
+    }
+    it = cache.emplace(key, launch).first;
+  }
+  CUPTI_CALL(cuptiActivityPushExternalCorrelationId(kCorrelationKind, it->second.id));
+  return it->second;
+}
+
+void CuptiProfiler::PopCorrelation(const CuptiLaunch& launch, uint64_t start_us) {
+  static uint32_t category = Tracer::Get()->Intern("HostDispatch");
+  uint64_t last_id;
+  CUPTI_CALL(cuptiActivityPopExternalCorrelationId(kCorrelationKind, &last_id));
+  CHECK_EQ(last_id, launch.id) << "Unbalanced CUPTI external correlations";
+  Tracer::Get()->Record(start_us, ProfileStat::NowInMicrosec(), launch.name, category, launch.args);
+}
+
+void CuptiProfiler::AddBuffer(uint8_t* buffer, size_t valid_size) {
+  auto tracer = Tracer::Get();
+  std::lock_guard<std::mutex> lock(mu_);
+  CUpti_Activity* record = nullptr;
+  while (cuptiActivityGetNextRecord(buffer, valid_size, &record) == CUPTI_SUCCESS) {
+    switch (record->kind) {
+      case CUPTI_ACTIVITY_KIND_KERNEL:
+      case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
+        auto kernel = reinterpret_cast<CUpti_ActivityKernel4*>(record);
+        std::string mangled = kernel->name;
+        auto it = kernel_names_.find(mangled);
+        if (it == kernel_names_.end()) {
+          int status = 0;
+          char* demangled = abi::__cxa_demangle(kernel->name, nullptr, nullptr, &status);
+          std::string name = status == 0 ? demangled : mangled;
+          free(demangled);
+          it = kernel_names_.emplace(mangled, tracer->Intern(name)).first;
+        }
+        static uint32_t category = tracer->Intern("CUPTI Kernel");
+        activities_.push_back(CuptiActivity{kernel->start, kernel->end, it->second, category,
+                                            kernel->deviceId, kernel->streamId,
+                                            kernel->correlationId});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMCPY: {
+        auto copy = reinterpret_cast<CUpti_ActivityMemcpy*>(record);
+        uint32_t category = tracer->Intern(MemcpyCategory(copy->copyKind));
+        uint32_t name = tracer->Intern("Memcpy " + std::to_string(copy->bytes) + " bytes");
+        activities_.push_back(CuptiActivity{copy->start, copy->end, name, category,
+                                            copy->deviceId, copy->streamId,
+                                            copy->correlationId});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMSET: {
+        auto set = reinterpret_cast<CUpti_ActivityMemset*>(record);
+        static uint32_t category = tracer->Intern("CUPTI Memset");
+        uint32_t name = tracer->Intern("Memset " + std::to_string(set->bytes) + " bytes");
+        activities_.push_back(CuptiActivity{set->start, set->end, name, category,
+                                            set->deviceId, set->streamId,
+                                            set->correlationId});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION: {
+        auto corr = reinterpret_cast<CUpti_ActivityExternalCorrelation*>(record);
+        if (corr->externalKind == kCorrelationKind) {
+          externals_[corr->correlationId] = corr->externalId;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+void CuptiProfiler::Collect() {
+  if (!registered_) {
+    return;
+  }
+  CUPTI_CALL(cuptiActivityFlushAll(0));
+  std::lock_guard<std::mutex> lock(mu_);
+  auto tracer = Tracer::Get();
+  for (const auto& a : activities_) {
+    auto track = tracks_.find({a.device, a.stream});
+    if (track == tracks_.end()) {
+      std::string name = "GPU " + std::to_string(a.device) + " Stream " + std::to_string(a.stream);
+      track = tracks_.emplace(std::make_pair(a.device, a.stream), tracer->NewTrack(name)).first;
+    }
+    // The activities without an external correlation, e.g., the ones out of the VM, have no args.
+    uint32_t args = 0;
+    auto ext = externals_.find(a.correlation);
+    if (ext != externals_.end() && ext->second > 0 && ext->second <= launches_.size()) {
+      args = launches_[ext->second - 1].args;
+    }
+    track->second->Record((a.start_ns + clock_offset_ns_) / 1000,
+                          (a.end_ns + clock_offset_ns_) / 1000, a.name, a.category, args);
+  }
+  activities_.clear();
+  externals_.clear();
+}
+
+void CuptiProfiler::Clear() {
+  if (registered_) {
+    CUPTI_CALL(cuptiActivityFlushAll(0));
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  activities_.clear();
+  externals_.clear();
+}
+
+RAF_REGISTER_GLOBAL("raf.profiler.EnableCuptiProfiler").set_body_typed([]() {
+  CuptiProfiler::Get()->Enable();
+});
+RAF_REGISTER_GLOBAL("raf.profiler.DisableCuptiProfiler").set_body_typed([]() {
+  CuptiProfiler::Get()->Disable();
+});
+RAF_REGISTER_GLOBAL("raf.profiler.CollectCuptiProfile").set_body_typed([]() {
+  CuptiProfiler::Get()->Collect();
+});
+RAF_REGISTER_GLOBAL("raf.profiler.ClearCuptiProfile").set_body_typed([]() {
+  CuptiProfiler::Get()->Clear();
+});
+
+}  // namespace profiler
+}  // namespace raf
@@ -0,0 +1,134 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/cupti/cupti_profiler.h
+ * \brief The CUPTI activity collector, which records every kernel, memcpy and memset on the device,
+ * including the ones launched inside cuDNN, cuBLAS and NCCL, and correlates them to the VM
+ * instruction that launches them.
+ */
+#pragma once
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "raf/profiler.h"
+#include "raf/tracer.h"
+
+#ifdef RAF_USE_CUPTI
+
+/*!
+ * \brief Correlate the device activities launched by CODE_SNIPPET to the pc of the VM function and
+ * the op name, and record the host dispatch of the snippet.
+ */
+#define WITH_CUPTI_CORRELATION(FUNC_INDEX, PC, NAME, CODE_SNIPPET)              \
+  {                                                                             \
+    auto _cupti = raf::profiler::CuptiProfiler::Get();                          \
+    if (_cupti->enabled()) {                                                    \
+      uint64_t _cupti_start = raf::profiler::ProfileStat::NowInMicrosec();      \
+      auto _cupti_launch = _cupti->PushCorrelation(FUNC_INDEX, PC, NAME);       \
+      CODE_SNIPPET                                                              \
+      _cupti->PopCorrelation(_cupti_launch, _cupti_start);                      \
+    } else {                                                                    \
+      CODE_SNIPPET                                                              \
+    }                                                                           \
+  }
+
+#else
+
+#define WITH_CUPTI_CORRELATION(FUNC_INDEX, PC, NAME, CODE_SNIPPET) \
+  { CODE_SNIPPET }
+
+#endif
+
+namespace raf {
+namespace profiler {
+
+/*! \brief A device activity, which is kept until it is correlated when collected. */
+struct CuptiActivity {
+  /*! \brief The start and end timestamps in CUPTI nanoseconds. */
+  uint64_t start_ns;
+  uint64_t end_ns;
+  /*! \brief The interned name and category. */
+  uint32_t name;
+  uint32_t category;
+  uint32_t device;
+  uint32_t stream;
+  uint32_t correlation;
+};
+
+/*! \brief The host dispatch of a VM instruction. */
+struct CuptiLaunch {
+  /*! \brief The external correlation id, which is the index in the launches plus 1. */
+  uint64_t id;
+  /*! \brief The interned op name, and the arguments of the op name and the pc. */
+  uint32_t name;
+  uint32_t args;
+};
+
+class CuptiProfiler {
+ public:
+  static CuptiProfiler* Get();
+
+  /*! \brief Start to record the device activities. */
+  void Enable();
+  /*! \brief Stop recording, and flush the recorded activities. */
+  void Disable();
+
+  inline bool enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Push the external correlation of a VM instruction, which CUPTI attaches to the
+   * activities launched by the thread until it is popped.
+   * \return The launch of the external correlation.
+   */
+  CuptiLaunch PushCorrelation(int64_t func_index, int64_t pc, const std::string& name);
+
+  /*! \brief Pop the external correlation, and record the host dispatch since start_us. */
+  void PopCorrelation(const CuptiLaunch& launch, uint64_t start_us);
+
+  /*!
+   * \brief Flush the activities, and record them into the tracer on the tracks of their device
+   * streams, with the op name and the pc of their VM instruction as the arguments.
+   */
+  void Collect();
+
+  /*! \brief Drop the activities which are not collected yet. */
+  void Clear();
+
+  /*! \brief Parse a completed CUPTI buffer, which is called by the CUPTI callback. */
+  void AddBuffer(uint8_t* buffer, size_t valid_size);
+
+ private:
+  CuptiProfiler() = default;
+
+  /*! \brief Whether the activities are being recorded. */
+  std::atomic<bool> enabled_{false};
+  /*! \brief Whether the buffer callbacks are registered. */
+  bool registered_ = false;
+  /*! \brief The host clock minus the CUPTI clock in nanoseconds. */
+  int64_t clock_offset_ns_ = 0;
+  /*! \brief The launches, whose index plus 1 is the external correlation id. */
+  std::vector<CuptiLaunch> launches_;
+  /*! \brief The external correlation id of each CUPTI correlation id. */
+  std::unordered_map<uint32_t, uint64_t> externals_;
+  /*! \brief The activities which are not collected yet. */
+  std::vector<CuptiActivity> activities_;
+  /*! \brief The interned demangled kernel names by the mangled names. */
+  std::unordered_map<std::string, uint32_t> kernel_names_;
+  /*! \brief The track of each device stream. */
+  std::map<std::pair<uint32_t, uint32_t>, TraceBuffer*> tracks_;
+  /*! \brief Guard all the above, which are written by the CUPTI thread and the collector. */
+  std::mutex mu_;
+};
+
+}  // namespace profiler
+}  // namespace raf
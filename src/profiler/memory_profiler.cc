@@ -10,6 +10,7 @@
 #include "raf/registry.h"
 #include "raf/memory_profiler.h"
 #include "raf/memory_pool.h"
+#include "raf/profiler.h"
 
 namespace raf {
 namespace memory_profiler {
@@ -37,6 +38,96 @@ void MemoryProfiler::Record(const Device& device, const std::string& tag) {
 
 void MemoryProfiler::Reset() {
   memory_stats_.clear();
+  std::lock_guard<std::mutex> lock(timeline_mu_);
+  id_base_ += lifetimes_.size();
+  lifetimes_.clear();
+  live_.clear();
+  live_addresses_.clear();
+  live_bytes_.clear();
+  op_steps_.clear();
+}
+
+int64_t MemoryProfiler::RecordAlloc(const Device& device, int64_t nbytes, const void* data,
+                                    int64_t func_index, int64_t pc, int64_t reg,
+                                    const std::string& var) {
+  TensorLifetime lifetime;
+  lifetime.device = device.c_str();
+  lifetime.nbytes = nbytes;
+  lifetime.alloc_us = profiler::ProfileStat::NowInMicrosec();
+  lifetime.func_index = func_index;
+  lifetime.pc = pc;
+  lifetime.reg = reg;
+  lifetime.var = var;
+  std::lock_guard<std::mutex> lock(timeline_mu_);
+  int64_t id = id_base_ + lifetimes_.size();
+  live_bytes_[lifetime.device] += nbytes;
+  lifetimes_.push_back(std::move(lifetime));
+  if (data != nullptr) {
+    live_[data] = id;
+    live_addresses_[id].push_back(data);
+  }
+  return id;
+}
+
+void MemoryProfiler::RecordFree(int64_t id) {
+  uint64_t now = profiler::ProfileStat::NowInMicrosec();
+  std::lock_guard<std::mutex> lock(timeline_mu_);
+  // The storages allocated before the last reset are not tracked.
+  if (id < id_base_) {
+    return;
+  }
+  auto& lifetime = lifetimes_[id - id_base_];
+  lifetime.free_us = now;
+  live_bytes_[lifetime.device] -= lifetime.nbytes;
+  auto it = live_addresses_.find(id);
+  if (it != live_addresses_.end()) {
+    for (auto data : it->second) {
+      auto live = live_.find(data);
+      // The address may be reused by a later storage, e.g., of an arena.
+      if (live != live_.end() && live->second == id) {
+        live_.erase(live);
+      }
+    }
+    live_addresses_.erase(it);
+  }
+}
+
+void MemoryProfiler::RecordTensor(const void* storage, const void* data, const std::string& var) {
+  std::lock_guard<std::mutex> lock(timeline_mu_);
+  auto it = live_.find(storage);
+  if (it == live_.end()) {
+    return;
+  }
+  int64_t id = it->second;
+  lifetimes_[id - id_base_].tensors.push_back(var);
+  if (data != storage) {
+    live_[data] = id;
+    live_addresses_[id].push_back(data);
+  }
+}
+
+void MemoryProfiler::RecordOp(const Device& device, const std::string& op,
+                              const std::vector<const void*>& outputs) {
+  uint64_t now = profiler::ProfileStat::NowInMicrosec();
+  std::string device_str = device.c_str();
+  std::lock_guard<std::mutex> lock(timeline_mu_);
+  for (auto data : outputs) {
+    auto it = live_.find(data);
+    if (it != live_.end() && lifetimes_[it->second - id_base_].op.empty()) {
+      lifetimes_[it->second - id_base_].op = op;
+    }
+  }
+  op_steps_.push_back(OpMemoryStep{device_str, now, op, live_bytes_[device_str]});
+}
+
+std::vector<TensorLifetime> MemoryProfiler::GetTensorLifetimes() {
+  std::lock_guard<std::mutex> lock(timeline_mu_);
+  return lifetimes_;
+}
+
+std::vector<OpMemoryStep> MemoryProfiler::GetOpMemorySteps() {
+  std::lock_guard<std::mutex> lock(timeline_mu_);
+  return op_steps_;
 }
 
 Map<String, FloatImm> MemoryProfiler::GetMaxMemoryInfo(const Device& device) {
@@ -108,6 +199,45 @@ std::string GetMemoryTrace(const Device& device) {
   return MemoryProfiler::Get()->GetMemoryTrace(device);
 }
 
+static IntImm MakeInt(int64_t value) {
+  return IntImm(DataType::Int(64), value);
+}
+
+/*! \brief The lifetimes of the storages, with the timestamps in microseconds. */
+Array<Map<String, ObjectRef>> GetTensorTimeline() {
+  Array<Map<String, ObjectRef>> ret;
+  for (const auto& lifetime : MemoryProfiler::Get()->GetTensorLifetimes()) {
+    Array<String> tensors(lifetime.tensors.begin(), lifetime.tensors.end());
+    Map<String, ObjectRef> entry;
+    entry.Set("device", String(lifetime.device));
+    entry.Set("nbytes", MakeInt(lifetime.nbytes));
+    entry.Set("alloc_us", MakeInt(lifetime.alloc_us));
+    entry.Set("free_us", MakeInt(lifetime.free_us));
+    entry.Set("func_index", MakeInt(lifetime.func_index));
+    entry.Set("pc", MakeInt(lifetime.pc));
+    entry.Set("register", MakeInt(lifetime.reg));
+    entry.Set("var", String(lifetime.var));
+    entry.Set("tensors", tensors);
+    entry.Set("op", String(lifetime.op));
+    ret.push_back(entry);
+  }
+  return ret;
+}
+
+/*! \brief The live bytes after each op launched by the VM. */
+Array<Map<String, ObjectRef>> GetOpMemorySteps() {
+  Array<Map<String, ObjectRef>> ret;
+  for (const auto& step : MemoryProfiler::Get()->GetOpMemorySteps()) {
+    Map<String, ObjectRef> entry;
+    entry.Set("device", String(step.device));
+    entry.Set("time_us", MakeInt(step.time_us));
+    entry.Set("op", String(step.op));
+    entry.Set("live_bytes", MakeInt(step.live_bytes));
+    ret.push_back(entry);
+  }
+  return ret;
+}
+
 RAF_REGISTER_GLOBAL("raf.memory_profiler.EnableMemoryProfiler")
     .set_body_typed(EnableMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableMemoryeProfiler")
@@ -115,6 +245,8 @@ RAF_REGISTER_GLOBAL("raf.memory_profiler.DisableMemoryeProfiler")
 RAF_REGISTER_GLOBAL("raf.memory_profiler.ResetMemoryProfiler").set_body_typed(ResetMemoryProfiler);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMaxMemoryInfo").set_body_typed(GetMaxMemoryInfo);
 RAF_REGISTER_GLOBAL("raf.memory_profiler.GetMemoryTrace").set_body_typed(GetMemoryTrace);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetTensorTimeline").set_body_typed(GetTensorTimeline);
+RAF_REGISTER_GLOBAL("raf.memory_profiler.GetOpMemorySteps").set_body_typed(GetOpMemorySteps);
 
 }  // namespace memory_profiler
 }  // namespace raf
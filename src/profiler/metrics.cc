@@ -0,0 +1,269 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/metrics.cc
+ * \brief The metrics registry and its Prometheus export
+ */
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include "raf/cache.h"
+#include "raf/device_api.h"
+#include "raf/event_pool.h"
+#include "raf/metrics.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace metrics {
+
+using namespace raf::ir;
+
+void Summary::Observe(double value) {
+  count_.fetch_add(1, std::memory_order_relaxed);
+  // std::atomic<double> has no fetch_add in C++14.
+  double sum = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+  }
+  double max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+void Summary::Reset() {
+  count_ = 0;
+  sum_ = 0;
+  max_ = 0;
+}
+
+MetricsRegistry* MetricsRegistry::Get() {
+  static MetricsRegistry registry;
+  return &registry;
+}
+
+Counter* MetricsRegistry::GetCounter(const std::string& name, const std::string& help,
+                                     const Labels& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& family = counters_[name];
+  family.help = help;
+  auto& counter = family.metrics[labels];
+  if (counter == nullptr) {
+    counter = std::make_unique<Counter>();
+  }
+  return counter.get();
+}
+
+Summary* MetricsRegistry::GetSummary(const std::string& name, const std::string& help,
+                                     const Labels& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& family = summaries_[name];
+  family.help = help;
+  auto& summary = family.metrics[labels];
+  if (summary == nullptr) {
+    summary = std::make_unique<Summary>();
+  }
+  return summary.get();
+}
+
+void MetricsRegistry::AddCollector(Collector collector) {
+  std::lock_guard<std::mutex> lock(mu_);
+  collectors_.push_back(std::move(collector));
+}
+
+std::vector<Sample> MetricsRegistry::Collect() {
+  std::vector<Sample> samples;
+  std::vector<Collector> collectors;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& kv : counters_) {
+      for (const auto& metric : kv.second.metrics) {
+        samples.push_back(Sample{kv.first, kv.second.help, "counter", metric.first,
+                                 static_cast<double>(metric.second->value())});
+      }
+    }
+    for (const auto& kv : summaries_) {
+      for (const auto& metric : kv.second.metrics) {
+        const auto& s = metric.second;
+        samples.push_back(Sample{kv.first + "_count", kv.second.help, "counter", metric.first,
+                                 static_cast<double>(s->count())});
+        samples.push_back(
+            Sample{kv.first + "_sum", kv.second.help, "counter", metric.first, s->sum()});
+        samples.push_back(
+            Sample{kv.first + "_max", kv.second.help, "gauge", metric.first, s->max()});
+      }
+    }
+    collectors = collectors_;
+  }
+  // The collectors may take their own locks, e.g., of the caches, so call them out of mu_.
+  for (const auto& collector : collectors) {
+    collector(&samples);
+  }
+  return samples;
+}
+
+/*! \brief Write the name and the labels of a sample, e.g., name{key="value"}. */
+static void WriteSeries(std::ostream* os, const Sample& sample) {
+  *os << sample.name;
+  if (sample.labels.empty()) {
+    return;
+  }
+  *os << '{';
+  for (size_t i = 0; i < sample.labels.size(); ++i) {
+    *os << (i ? "," : "") << sample.labels[i].first << "=\"";
+    for (char c : sample.labels[i].second) {
+      if (c == '"' || c == '\\') {
+        *os << '\\' << c;
+      } else if (c == '\n') {
+        *os << "\\n";
+      } else {
+        *os << c;
+      }
+    }
+    *os << '"';
+  }
+  *os << '}';
+}
+
+std::string MetricsRegistry::ExportPrometheus() {
+  std::vector<Sample> samples = Collect();
+  // The samples of a family must be consecutive, and its HELP and TYPE are written once.
+  std::stable_sort(samples.begin(), samples.end(),
+                   [](const Sample& a, const Sample& b) { return a.name < b.name; });
+  std::ostringstream os;
+  os << std::setprecision(std::numeric_limits<double>::max_digits10);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const auto& s = samples[i];
+    if (i == 0 || samples[i - 1].name != s.name) {
+      os << "# HELP " << s.name << " " << s.help << "\n";
+      os << "# TYPE " << s.name << " " << s.type << "\n";
+    }
+    WriteSeries(&os, s);
+    os << " ";
+    if (std::isnan(s.value)) {
+      os << "NaN";
+    } else {
+      os << s.value;
+    }
+    os << "\n";
+  }
+  return os.str();
+}
+
+void MetricsRegistry::Reset() {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (auto& kv : counters_) {
+    for (auto& metric : kv.second.metrics) {
+      metric.second->Reset();
+    }
+  }
+  for (auto& kv : summaries_) {
+    for (auto& metric : kv.second.metrics) {
+      metric.second->Reset();
+    }
+  }
+}
+
+void MetricsRegistry::AddStepCallback(std::function<void()> callback) {
+  std::lock_guard<std::mutex> lock(step_mu_);
+  step_callbacks_.push_back(std::move(callback));
+  has_step_callbacks_ = true;
+}
+
+void MetricsRegistry::ClearStepCallbacks() {
+  std::lock_guard<std::mutex> lock(step_mu_);
+  step_callbacks_.clear();
+  has_step_callbacks_ = false;
+}
+
+void MetricsRegistry::RunStepCallbacks() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(step_mu_);
+    callbacks = step_callbacks_;
+  }
+  for (const auto& callback : callbacks) {
+    callback();
+  }
+}
+
+std::shared_ptr<event_pool::Event> DeviceTimer::Start(const Device& dev) {
+  auto api = device_api::DeviceAPI::Get(dev.device_type());
+  auto start = event_pool::EventPool::Get(dev)->GetEvent();
+  api->EventRecordOnStream(start->data(), nullptr /* default stream */);
+  return start;
+}
+
+void DeviceTimer::Stop(const Device& dev, std::shared_ptr<event_pool::Event> start) {
+  auto api = device_api::DeviceAPI::Get(dev.device_type());
+  auto end = event_pool::EventPool::Get(dev)->GetEvent();
+  api->EventRecordOnStream(end->data(), nullptr /* default stream */);
+  std::lock_guard<std::mutex> lock(mu_);
+  pending_.emplace_back(std::move(start), std::move(end));
+  // The work is finished in order on the stream, so stop at the first unfinished one.
+  while (!pending_.empty() && api->QueryEvent(pending_.front().second->data())) {
+    const auto& front = pending_.front();
+    summary_->Observe(
+        api->EventElapsedTimeInMilliSeconds(front.first->data(), front.second->data()) / 1e3);
+    pending_.pop_front();
+  }
+}
+
+/*! \brief The cache statistics of all the persistent caches, e.g., the TVM op caches. */
+static void CollectCacheMetrics(std::vector<Sample>* samples) {
+  static const std::string events_help = "The number of the events of the persistent caches.";
+  static const std::string ratio_help = "The hit ratio of the in-memory and persistent lookups.";
+  for (auto cache : MetaPersistCacheBase::Registry()) {
+    auto metric = dynamic_cast<MetaCacheMetric*>(cache);
+    if (metric == nullptr) {
+      continue;
+    }
+    auto stats = metric->GetMetric();
+    for (const auto& kv : stats) {
+      samples->push_back(Sample{"raf_cache_events_total", events_help, "counter",
+                                {{"cache", cache->persist_name()}, {"event", kv.first}},
+                                static_cast<double>(kv.second)});
+    }
+    auto gets = stats["CacheGet"];
+    double hits = stats["CacheHit"] + stats["PersistCacheHit"];
+    samples->push_back(Sample{"raf_cache_hit_ratio", ratio_help, "gauge",
+                              {{"cache", cache->persist_name()}},
+                              gets > 0 ? hits / gets : std::nan("")});
+  }
+}
+
+static bool RegisterCacheCollector() {
+  MetricsRegistry::Get()->AddCollector(CollectCacheMetrics);
+  return true;
+}
+
+static bool cache_collector_registered = RegisterCacheCollector();
+
+/*! \brief The metrics keyed by the series, e.g., raf_comm_bytes_total{collective="allreduce"}. */
+Map<String, FloatImm> GetMetrics() {
+  Map<String, FloatImm> ret;
+  for (const auto& s : MetricsRegistry::Get()->Collect()) {
+    std::ostringstream os;
+    WriteSeries(&os, s);
+    ret.Set(os.str(), FloatImm(DataType::Float(64), s.value));
+  }
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.metrics.GetMetrics").set_body_typed(GetMetrics);
+RAF_REGISTER_GLOBAL("raf.metrics.ExportPrometheus").set_body_typed([]() {
+  return MetricsRegistry::Get()->ExportPrometheus();
+});
+RAF_REGISTER_GLOBAL("raf.metrics.Reset").set_body_typed([]() { MetricsRegistry::Get()->Reset(); });
+RAF_REGISTER_GLOBAL("raf.metrics.AddStepCallback").set_body_typed([](registry::PackedFunc func) {
+  MetricsRegistry::Get()->AddStepCallback([func]() { func(); });
+});
+RAF_REGISTER_GLOBAL("raf.metrics.ClearStepCallbacks").set_body_typed([]() {
+  MetricsRegistry::Get()->ClearStepCallbacks();
+});
+
+}  // namespace metrics
+}  // namespace raf
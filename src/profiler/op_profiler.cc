@@ -11,8 +11,13 @@
 #include "raf/op_profiler.h"
 #include "raf/ir_ext.h"
 #include "../op/dialect/tvm/tvm_utils.h"
+#include "../pass/estimate_flops.h"
+#include "../common/shape_utils.h"
 #include "../requests.h"
 #include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
 
 namespace raf {
 namespace op_profiler {
@@ -46,6 +51,10 @@ OpWithData::OpWithData(const Device device, const Expr& op, const int stream_id)
   auto call = Downcast<Call>(op);
   CallValues call_values = CreateDummyCallValues(call, device);
   op_env = Dispatch(call_values);
+  if (op_env == nullptr) {
+    // The op is not supported by its dialect, so it is not profilable.
+    return;
+  }
 
   // Create the dummy inputs and outputs.
   output = CreateDummyValueFromType(op->checked_type(), device);
@@ -143,6 +152,59 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOpGroup(const std::vecto
   return latency_and_workspace_size_cache_[key];
 }
 
+void OpProfiler::SaveLatencyCache(const std::string& path) {
+  std::ofstream os(path, std::ios::binary);
+  CHECK(os.good()) << "Cannot open " << path << " to save the latency cache";
+  auto write = [&os](const void* data, size_t nbytes) {
+    os.write(static_cast<const char*>(data), nbytes);
+  };
+  uint64_t n_entries = latency_and_workspace_size_cache_.size();
+  write(&n_entries, sizeof(n_entries));
+  for (const auto& kv : latency_and_workspace_size_cache_) {
+    uint64_t key_size = kv.first.size();
+    uint64_t n_latencies = kv.second.first.size();
+    write(&key_size, sizeof(key_size));
+    write(kv.first.data(), key_size);
+    write(&n_latencies, sizeof(n_latencies));
+    write(kv.second.first.data(), n_latencies * sizeof(float));
+    write(&kv.second.second, sizeof(kv.second.second));
+  }
+}
+
+int OpProfiler::LoadLatencyCache(const std::string& path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.good()) {
+    return -1;
+  }
+  auto read = [&is](void* data, size_t nbytes) {
+    is.read(static_cast<char*>(data), nbytes);
+    return is.good();
+  };
+  uint64_t n_entries = 0;
+  int n_loaded = 0;
+  if (!read(&n_entries, sizeof(n_entries))) {
+    return -1;
+  }
+  for (uint64_t i = 0; i < n_entries; ++i) {
+    uint64_t key_size = 0, n_latencies = 0;
+    if (!read(&key_size, sizeof(key_size))) {
+      break;
+    }
+    std::string key(key_size, '\0');
+    if (!read(&key[0], key_size) || !read(&n_latencies, sizeof(n_latencies))) {
+      break;
+    }
+    std::pair<std::vector<float>, int64_t> entry;
+    entry.first.resize(n_latencies);
+    if (!read(entry.first.data(), n_latencies * sizeof(float)) ||
+        !read(&entry.second, sizeof(entry.second))) {
+      break;
+    }
+    n_loaded += latency_and_workspace_size_cache_.emplace(key, std::move(entry)).second ? 1 : 0;
+  }
+  return n_loaded;
+}
+
 // Profile one op and return its latency in microseconds on the target device.
 std::pair<std::vector<float>, float> OpProfiler::ProfileOp(const Expr& op, int32_t warmup,
                                                            int32_t exec_number, int32_t repeat) {
@@ -179,6 +241,74 @@ std::pair<std::vector<float>, float> OpProfiler::ProfileOp(const Expr& op, int32
   return std::make_pair(std::vector<float>(repeat, 0.0), 0.0f);
 }
 
+OpRoofline OpProfiler::ProfileRoofline(const Expr& op, int32_t warmup, int32_t exec_number,
+                                       int32_t repeat) {
+  OpRoofline ret;
+  auto lat_and_workspace_size = ProfileOp(op, warmup, exec_number, repeat);
+  const auto& latencies = lat_and_workspace_size.first;
+  for (float lat : latencies) {
+    ret.latency_us += lat / latencies.size();
+  }
+  ret.workspace_size = lat_and_workspace_size.second;
+  auto call_node = op.as<CallNode>();
+  if (call_node == nullptr) {
+    return ret;
+  }
+  auto call = GetRef<Call>(call_node);
+
+  // Estimate the compute by the TVM compute of the call, which is bound to a var for the estimater.
+  auto key = HashKeyToStr(HashCall(call));
+  if (gflop_cache_.count(key) == 0) {
+    auto var = raf::ir::MakeVar("", call->checked_type());
+    Function func({}, Let(var, call, var), {}, {});
+    float gflop = pass::estimate_flops::FLOPSEstimater().Run(device_, func, IRModule())[var];
+    gflop_cache_[key] = std::isfinite(gflop) && gflop > 0 ? gflop : 0.0f;
+  }
+  ret.gflop = gflop_cache_[key];
+  for (const auto& arg : call->args) {
+    if (!arg->checked_type().as<FuncTypeNode>()) {
+      ret.bytes += common::shape_utils::BytesCompactType(arg->checked_type());
+    }
+  }
+  ret.bytes += common::shape_utils::BytesCompactType(call->checked_type());
+
+  DevicePeak peak = GetDevicePeak();
+  double compute_us = ret.gflop / peak.gflops * 1e6;
+  double memory_us = ret.bytes / (peak.gbps * 1e3);
+  ret.roofline_latency_us = std::max(compute_us, memory_us);
+  ret.compute_bound = compute_us >= memory_us;
+  ret.arithmetic_intensity = ret.bytes > 0 ? ret.gflop * 1e9 / ret.bytes : 0;
+  if (ret.latency_us > 0) {
+    ret.achieved_gflops = ret.gflop / ret.latency_us * 1e6;
+    ret.achieved_gbps = ret.bytes / ret.latency_us / 1e3;
+    ret.efficiency = std::min(1.0, ret.roofline_latency_us / ret.latency_us);
+  }
+  return ret;
+}
+
+DevicePeak OpProfiler::GetDevicePeak() {
+  if (peak_.gflops <= 0 || peak_.gbps <= 0) {
+    peak_ = DetectDevicePeak();
+    const char* gflops = getenv("RAF_PEAK_GFLOPS");
+    const char* gbps = getenv("RAF_PEAK_GBPS");
+    if (gflops != nullptr) {
+      peak_.gflops = atof(gflops);
+    }
+    if (gbps != nullptr) {
+      peak_.gbps = atof(gbps);
+    }
+    CHECK(peak_.gflops > 0 && peak_.gbps > 0)
+        << "Invalid roofline of " << device_.c_str() << ": " << peak_.gflops << " GFLOP/s and "
+        << peak_.gbps << " GB/s";
+  }
+  return peak_;
+}
+
+DevicePeak CPUOpProfiler::DetectDevicePeak() {
+  double cores = std::max(1u, std::thread::hardware_concurrency());
+  return DevicePeak{cores * 2.5 * 32, cores * 10};
+}
+
 std::vector<float> CPUOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32_t warmup,
                                         int32_t exec_number, int32_t repeat) {
   if (!op_with_data->profilable()) {
@@ -239,6 +369,23 @@ std::vector<float> CPUOpProfiler::RunOpGroup(const std::vector<OpWithDataPtr>& o
 }
 
 #ifdef RAF_USE_CUDA
+DevicePeak CUDAOpProfiler::DetectDevicePeak() {
+  cudaDeviceProp prop;
+  CUDA_CALL(cudaGetDeviceProperties(&prop, device_.device_id()));
+  // The FP32 cores per SM of each architecture.
+  int cores = 64;
+  if (prop.major == 3) {
+    cores = 192;
+  } else if (prop.major == 5 || (prop.major == 6 && prop.minor > 0) ||
+             (prop.major == 8 && prop.minor > 0) || prop.major >= 9) {
+    cores = 128;
+  }
+  // An FMA is 2 FLOPs, and the memory transfers at both edges of its clock. The clocks are in kHz.
+  double gflops = 2.0 * prop.multiProcessorCount * cores * prop.clockRate / 1e6;
+  double gbps = 2.0 * prop.memoryClockRate * (prop.memoryBusWidth / 8) / 1e6;
+  return DevicePeak{gflops, gbps};
+}
+
 // Run the op on the CUDA device, return the profiled execution time in microseconds
 std::vector<float> CUDAOpProfiler::RunOp(const OpWithDataPtr& op_with_data, int32_t warmup,
                                          int32_t exec_number, int32_t repeat) {
@@ -389,6 +536,77 @@ RAF_REGISTER_GLOBAL("raf.op_profiler.ProfileGroup")
       *ret = results;
     });
 
+/*! \brief The roofline analysis in the object system. */
+Map<String, ObjectRef> RooflineToMap(const OpRoofline& roofline) {
+  auto to_float = [](double value) { return FloatImm(DataType::Float(64), value); };
+  Map<String, ObjectRef> ret;
+  ret.Set("latency", to_float(roofline.latency_us));
+  ret.Set("workspace_size", to_float(roofline.workspace_size));
+  ret.Set("gflop", to_float(roofline.gflop));
+  ret.Set("bytes", to_float(roofline.bytes));
+  ret.Set("achieved_gflops", to_float(roofline.achieved_gflops));
+  ret.Set("achieved_gbps", to_float(roofline.achieved_gbps));
+  ret.Set("arithmetic_intensity", to_float(roofline.arithmetic_intensity));
+  ret.Set("bound", String(roofline.compute_bound ? "compute" : "memory"));
+  ret.Set("roofline_latency", to_float(roofline.roofline_latency_us));
+  ret.Set("efficiency", to_float(roofline.efficiency));
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.ProfileRoofline")
+    .set_body([](tvm::runtime::TVMArgs args, tvm::runtime::TVMRetValue* ret) {
+      CHECK_GE(args.size(), 2U) << "Expected (expr, device, <warmup>, <exec>, <repeat>)";
+      Expr expr = args[0];
+      Device device = args[1];
+      int warmup = (args.size() >= 3) ? args[2] : 10;
+      int exec_number = (args.size() >= 4) ? args[3] : 10;
+      int repeat = (args.size() == 5) ? args[4] : 1;
+      *ret = RooflineToMap(OpProfiler::Get(device)->ProfileRoofline(expr, warmup, exec_number,
+                                                                        repeat));
+    });
+
+/*!
+ * \brief Profile every call in the main function of the module on the roofline. The module is
+ * converted to the A-normal form, and each entry has the name hint of its let var.
+ */
+Array<Map<String, ObjectRef>> RooflineReport(IRModule mod, Device device, int warmup,
+                                             int exec_number, int repeat) {
+  mod = pass::InferType()(pass::ToANormalForm()(mod));
+  auto func = Downcast<Function>(mod->Lookup("main"));
+  auto profiler = OpProfiler::Get(device);
+  Array<Map<String, ObjectRef>> ret;
+  auto ell = pass::ExplicitLetList::make(func->body);
+  for (size_t i = 0; i < ell->vars.size(); ++i) {
+    if (!ell->exprs[i]->IsInstance<CallNode>()) {
+      continue;
+    }
+    auto entry = RooflineToMap(profiler->ProfileRoofline(ell->exprs[i], warmup, exec_number,
+                                                         repeat));
+    entry.Set("name", String(ell->vars[i]->name_hint()));
+    auto call = Downcast<Call>(ell->exprs[i]);
+    if (auto op = call->op.as<OpNode>()) {
+      entry.Set("op", String(op->name));
+    } else {
+      entry.Set("op", String("fused"));
+    }
+    ret.push_back(entry);
+  }
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.RooflineReport").set_body_typed(RooflineReport);
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.GetDevicePeak").set_body_typed([](const Device& device) {
+  auto peak = OpProfiler::Get(device)->GetDevicePeak();
+  return Array<FloatImm>{FloatImm(DataType::Float(64), peak.gflops),
+                         FloatImm(DataType::Float(64), peak.gbps)};
+});
+
+RAF_REGISTER_GLOBAL("raf.op_profiler.SetDevicePeak")
+    .set_body_typed([](const Device& device, double gflops, double gbps) {
+      OpProfiler::Get(device)->SetDevicePeak(DevicePeak{gflops, gbps});
+    });
+
 RAF_REGISTER_GLOBAL("raf.op_profiler.ResetCache").set_body_typed([](const Device& device) {
   auto profiler = OpProfiler::Get(device);
   return profiler->Reset();
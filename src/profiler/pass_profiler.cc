@@ -0,0 +1,170 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file src/profiler/pass_profiler.cc
+ * \brief The profiler of the compilation passes.
+ */
+#include <unistd.h>
+#include <fstream>
+#include <unordered_set>
+#include "raf/pass_profiler.h"
+#include "raf/profiler.h"
+#include "raf/registry.h"
+
+namespace raf {
+namespace pass_profiler {
+
+/*! \brief The number of the records which enclose the running pass of this thread. */
+static thread_local int depth = 0;
+
+/*! \brief The resident memory of the process in KBs, or 0 if it is unknown. */
+static int64_t ResidentKB() {
+  std::ifstream statm("/proc/self/statm");
+  int64_t size = 0, resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+int64_t CountNodes(const IRModule& mod) {
+  // An explicit stack instead of a visitor, which would overflow on the long let chains.
+  std::unordered_set<const Object*> visited;
+  std::vector<Expr> stack;
+  for (const auto& kv : mod->functions) {
+    if (kv.second->IsInstance<FunctionNode>()) {
+      stack.push_back(Downcast<Function>(kv.second));
+    }
+  }
+  while (!stack.empty()) {
+    Expr expr = stack.back();
+    stack.pop_back();
+    if (!expr.defined() || !visited.insert(expr.get()).second) {
+      continue;
+    }
+    if (const auto* call = expr.as<CallNode>()) {
+      stack.push_back(call->op);
+      stack.insert(stack.end(), call->args.begin(), call->args.end());
+    } else if (const auto* let = expr.as<LetNode>()) {
+      stack.push_back(let->var);
+      stack.push_back(let->value);
+      stack.push_back(let->body);
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      stack.insert(stack.end(), tuple->fields.begin(), tuple->fields.end());
+    } else if (const auto* get = expr.as<TupleGetItemNode>()) {
+      stack.push_back(get->tuple);
+    } else if (const auto* func = expr.as<FunctionNode>()) {
+      stack.insert(stack.end(), func->params.begin(), func->params.end());
+      stack.push_back(func->body);
+    } else if (const auto* if_node = expr.as<IfNode>()) {
+      stack.push_back(if_node->cond);
+      stack.push_back(if_node->true_branch);
+      stack.push_back(if_node->false_branch);
+    }
+  }
+  return visited.size();
+}
+
+PassProfiler* PassProfiler::Get() {
+  static PassProfiler profiler;
+  return &profiler;
+}
+
+std::vector<PassRecord> PassProfiler::GetRecords() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return records_;
+}
+
+void PassProfiler::Reset() {
+  std::lock_guard<std::mutex> lock(mu_);
+  records_.clear();
+  ++generation_;
+}
+
+PassProfiler::Scope::Scope(const std::string& name, const IRModule& mod) {
+  auto prof = PassProfiler::Get();
+  if (!prof->IsProfiling()) {
+    return;
+  }
+  PassRecord record;
+  record.name = name;
+  record.depth = depth++;
+  record.nodes_before = mod.defined() ? CountNodes(mod) : -1;
+  record.rss_before_kb = ResidentKB();
+  // Start the clock after counting the nodes, which is not the time of the pass.
+  record.start_us = profiler::ProfileStat::NowInMicrosec();
+  std::lock_guard<std::mutex> lock(prof->mu_);
+  index_ = prof->records_.size();
+  generation_ = prof->generation_;
+  prof->records_.push_back(std::move(record));
+}
+
+void PassProfiler::Scope::SetResult(const IRModule& mod) {
+  if (index_ >= 0 && mod.defined()) {
+    // Stop the clock before counting the nodes.
+    uint64_t end_us = profiler::ProfileStat::NowInMicrosec();
+    nodes_after_ = CountNodes(mod);
+    auto prof = PassProfiler::Get();
+    std::lock_guard<std::mutex> lock(prof->mu_);
+    if (generation_ == prof->generation_) {
+      prof->records_[index_].end_us = end_us;
+    }
+  }
+}
+
+PassProfiler::Scope::~Scope() {
+  if (index_ < 0) {
+    return;
+  }
+  uint64_t end_us = profiler::ProfileStat::NowInMicrosec();
+  int64_t rss_kb = ResidentKB();
+  --depth;
+  auto prof = PassProfiler::Get();
+  std::lock_guard<std::mutex> lock(prof->mu_);
+  // The records may be reset while the pass runs.
+  if (generation_ != prof->generation_) {
+    return;
+  }
+  auto& record = prof->records_[index_];
+  if (record.end_us == 0) {
+    record.end_us = end_us;
+  }
+  record.nodes_after = nodes_after_;
+  record.rss_after_kb = rss_kb;
+}
+
+/*! \brief The records, with the timestamps in microseconds and the memory in KBs. */
+Array<Map<String, ObjectRef>> GetPassProfile() {
+  auto make_int = [](int64_t value) { return IntImm(DataType::Int(64), value); };
+  Array<Map<String, ObjectRef>> ret;
+  for (const auto& record : PassProfiler::Get()->GetRecords()) {
+    Map<String, ObjectRef> entry;
+    entry.Set("name", String(record.name));
+    entry.Set("depth", make_int(record.depth));
+    entry.Set("start_us", make_int(record.start_us));
+    entry.Set("end_us", make_int(record.end_us));
+    entry.Set("nodes_before", make_int(record.nodes_before));
+    entry.Set("nodes_after", make_int(record.nodes_after));
+    entry.Set("rss_before_kb", make_int(record.rss_before_kb));
+    entry.Set("rss_after_kb", make_int(record.rss_after_kb));
+    ret.push_back(entry);
+  }
+  return ret;
+}
+
+RAF_REGISTER_GLOBAL("raf.pass_profiler.EnablePassProfiler").set_body_typed([]() {
+  PassProfiler::Get()->SetProfile(true);
+});
+RAF_REGISTER_GLOBAL("raf.pass_profiler.DisablePassProfiler").set_body_typed([]() {
+  PassProfiler::Get()->SetProfile(false);
+});
+RAF_REGISTER_GLOBAL("raf.pass_profiler.ResetPassProfiler").set_body_typed([]() {
+  PassProfiler::Get()->Reset();
+});
+RAF_REGISTER_GLOBAL("raf.pass_profiler.GetPassProfile").set_body_typed(GetPassProfile);
+
+}  // namespace pass_profiler
+}  // namespace raf
@@ -0,0 +1,374 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tests/cpp/bench_collectives.cc
+ * \brief Benchmark of the collective communication operators through the OpEnv path, i.e., the
+ * dispatch to the NCCL dialect, the resource requests (fused buffers, streams and communicators)
+ * and the execution. It sweeps the message sizes and dtypes, and reports the algorithm and bus
+ * bandwidth in the way of nccl-tests. Launch it with MPI, e.g.,
+ *   mpirun -np 8 ./raf_bench_collectives --min-bytes 8 --max-bytes 256M --ops allreduce
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cuda_runtime.h>
+#include <mpi.h>
+
+#include <raf/communicator.h>
+#include <raf/device.h>
+#include <raf/memory_pool.h>
+#include <raf/op.h>
+#include <raf/stream_pool.h>
+#include <raf/value.h>
+
+#include "../../src/requests.h"
+
+using raf::Device;
+using raf::DevType;
+using raf::DType;
+using raf::DTypeCode;
+using raf::distributed::communicator::Communicator;
+using raf::distributed::communicator::CommunicatorObj;
+using raf::distributed::communicator::GetGlobalCommunicator;
+using raf::ir::Array;
+using raf::ir::Downcast;
+using raf::ir::Op;
+using raf::memory_pool::Memory;
+using raf::op::CallValues;
+using raf::op::FRAFDeclare;
+using raf::op::FRAFSchema;
+using raf::op::OpEnvPtr;
+using raf::requests::Requests;
+using raf::stream_pool::Stream;
+using raf::value::IntValue;
+using raf::value::NullValue;
+using raf::value::OpValue;
+using raf::value::ScalarValue;
+using raf::value::StringValue;
+using raf::value::TensorValue;
+using raf::value::TensorValueObj;
+using raf::value::TupleValue;
+using raf::value::TupleValueObj;
+using raf::value::Value;
+
+/*! \brief The options of the benchmark. */
+struct Options {
+  int64_t min_bytes = 8;
+  int64_t max_bytes = 256 << 20;
+  int64_t factor = 2;
+  int warmup = 5;
+  int iters = 20;
+  /*! \brief The number of tensors of the fused allreduce and the group collectives. */
+  int num_tensors = 4;
+  std::vector<std::string> ops;
+  std::vector<std::string> dtypes = {"float32", "float16"};
+};
+
+/*! \brief A collective to be benchmarked. */
+struct Collective {
+  /*! \brief The name in the report. */
+  std::string name;
+  /*! \brief The RAF operator. */
+  std::string op;
+  /*! \brief The number of tensors of the message. */
+  int num_tensors;
+  /*! \brief The factor from the algorithm bandwidth to the bus bandwidth for n ranks. */
+  std::function<double(int)> bus_factor;
+  /*!
+   * \brief Make the arguments of a message of count elements in total, which is the buffer size
+   * used to compute the bandwidth in nccl-tests.
+   */
+  std::function<Array<Value>(int64_t count, const std::vector<TensorValue>& outs)> make_args;
+  /*! \brief The number of elements of the outputs given as an argument, or 0 if not given. */
+  std::function<int64_t(int64_t count)> out_count;
+};
+
+/*! \brief The buffers of a benchmark, whose memory is kept alive until it ends. */
+class Buffers {
+ public:
+  Buffers(const Device& dev, const DType& dtype) : dev_(dev), dtype_(dtype) {
+  }
+
+  TensorValue Make(int64_t count) {
+    auto nbytes = count * ((dtype_.bits + 7) / 8);
+    auto memory = Memory::Alloc(dev_, nbytes);
+    if (nbytes > 0) {
+      // Zero the buffer, so the reductions never see NaN or Inf.
+      cudaMemset(memory->data, 0, nbytes);
+    }
+    memories_.push_back(memory);
+    return TensorValue::Assemble(dev_, dtype_, std::vector<int64_t>{count}, {}, memory->data,
+                                 memory);
+  }
+
+  std::vector<TensorValue> Make(int64_t count, int num) {
+    std::vector<TensorValue> ret;
+    for (int i = 0; i < num; ++i) {
+      ret.push_back(Make(count / num));
+    }
+    return ret;
+  }
+
+  /*! \brief Allocate the memory of the outputs made by the declare function. */
+  void Alloc(Value out) {
+    std::vector<TensorValue> tensors;
+    if (auto tup = out.as<TupleValueObj>()) {
+      for (const auto& field : tup->fields) {
+        tensors.push_back(Downcast<TensorValue>(field));
+      }
+    } else if (out->IsInstance<TensorValueObj>()) {
+      tensors.push_back(Downcast<TensorValue>(out));
+    }
+    for (auto& tensor : tensors) {
+      DLTensor* dlt = tensor;
+      if (dlt->data == nullptr) {
+        int64_t nbytes = (dlt->dtype.bits + 7) / 8;
+        for (int i = 0; i < dlt->ndim; ++i) {
+          nbytes *= dlt->shape[i];
+        }
+        auto memory = Memory::Alloc(dlt->device, nbytes);
+        dlt->data = memory->data;
+        tensor->mem = memory;
+      }
+    }
+  }
+
+ private:
+  Device dev_;
+  DType dtype_;
+  std::vector<std::shared_ptr<Memory>> memories_;
+};
+
+inline Value MakeTuple(const std::vector<TensorValue>& tensors) {
+  return TupleValue::make(Array<Value>(tensors.begin(), tensors.end()));
+}
+
+std::vector<Collective> GetCollectives(int size, int num_tensors, Buffers* bufs) {
+  auto null = NullValue<Value>();
+  auto sum = StringValue::make("sum");
+  auto ring = [](int n) { return 2.0 * (n - 1) / n; };
+  auto scatter = [](int n) { return 1.0 * (n - 1) / n; };
+  auto one = [](int) { return 1.0; };
+  auto no_out = [](int64_t) { return int64_t(0); };
+  std::vector<Collective> ret;
+  ret.push_back({"allreduce", "raf.op._allreduce", 1, ring,
+                 [=](int64_t count, const std::vector<TensorValue>&) {
+                   return Array<Value>{MakeTuple({bufs->Make(count)}), sum, null};
+                 },
+                 no_out});
+  // Multiple tensors are copied into the fused buffer of the allreduce.
+  ret.push_back({"allreduce_fused", "raf.op._allreduce", num_tensors, ring,
+                 [=](int64_t count, const std::vector<TensorValue>&) {
+                   return Array<Value>{MakeTuple(bufs->Make(count, num_tensors)), sum, null};
+                 },
+                 no_out});
+  ret.push_back({"reduce_scatter", "raf.op._reduce_scatter", 1, scatter,
+                 [=](int64_t count, const std::vector<TensorValue>&) {
+                   return Array<Value>{bufs->Make(count), sum, null};
+                 },
+                 no_out});
+  ret.push_back({"allgather", "raf.op._allgather", 1, scatter,
+                 [=](int64_t count, const std::vector<TensorValue>&) {
+                   return Array<Value>{bufs->Make(count / size), ScalarValue::make(0), null};
+                 },
+                 no_out});
+  ret.push_back({"all_to_all", "raf.op._all_to_all", 1, scatter,
+                 [=](int64_t count, const std::vector<TensorValue>&) {
+                   return Array<Value>{bufs->Make(count), null};
+                 },
+                 no_out});
+  ret.push_back({"broadcast", "raf.op._broadcast", 1, one,
+                 [=](int64_t count, const std::vector<TensorValue>&) {
+                   return Array<Value>{bufs->Make(count), ScalarValue::make(0), null};
+                 },
+                 no_out});
+  ret.push_back({"group_allgather", "raf.op._group_allgather", num_tensors, scatter,
+                 [=](int64_t count, const std::vector<TensorValue>& outs) {
+                   return Array<Value>{MakeTuple(bufs->Make(count / size, num_tensors)),
+                                       ScalarValue::make(0), MakeTuple(outs)};
+                 },
+                 [](int64_t count) { return count; }});
+  ret.push_back({"group_reduce_scatter", "raf.op._group_reduce_scatter", num_tensors, scatter,
+                 [=](int64_t count, const std::vector<TensorValue>&) {
+                   return Array<Value>{MakeTuple(bufs->Make(count, num_tensors)), sum};
+                 },
+                 no_out});
+  return ret;
+}
+
+/*!
+ * \brief Create the OpEnv of a call and fulfill its requests, as the executors do.
+ * \return The OpEnv, where the streams it runs on are appended to streams.
+ */
+OpEnvPtr Prepare(const CallValues& call, std::vector<std::shared_ptr<Stream>>* streams,
+                 std::vector<std::shared_ptr<Memory>>* workspace, Buffers* bufs) {
+  static const auto fdeclare = Op::GetAttrMap<FRAFDeclare>("FRAFDeclare");
+  const Op& op = Downcast<OpValue>(call->callee)->op;
+  fdeclare[op](call);
+  bufs->Alloc(call->out);
+  OpEnvPtr op_env = raf::op::Dispatch(call);
+  CHECK(op_env != nullptr) << "Cannot dispatch " << op->name;
+  std::shared_ptr<Requests> req = op_env->GetRequests();
+  for (auto& entry : req->workspace) {
+    entry.memory = Memory::Alloc(entry.device, entry.nbytes);
+    *entry.dest = entry.memory->data;
+    workspace->push_back(entry.memory);
+  }
+  for (auto& entry : req->stream) {
+    entry.stream = Stream::Get(entry.device, entry.tag_idx, entry.stream_idx);
+    *entry.dest = entry.stream->data();
+    streams->push_back(entry.stream);
+  }
+  for (auto& entry : req->distributed) {
+    *entry.dest = (void*)(Communicator::Get(entry.name, entry.rank_list).as<CommunicatorObj>());
+  }
+  return op_env;
+}
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*! \brief Benchmark a collective, and report the slowest rank. */
+void Run(const Collective& coll, const std::string& dtype_name, const DType& dtype,
+         const Options& opts, int size, int rank, Buffers* bufs) {
+  static const auto fschema = Op::GetAttrMap<FRAFSchema>("FRAFSchema");
+  Op op = Op::Get(coll.op);
+  int64_t dtype_size = (dtype.bits + 7) / 8;
+  // The messages of the allgather and reduce-scatter are partitioned to the ranks and tensors.
+  int64_t align = static_cast<int64_t>(size) * coll.num_tensors;
+  for (int64_t nbytes = opts.min_bytes; nbytes <= opts.max_bytes; nbytes *= opts.factor) {
+    int64_t count = nbytes / dtype_size / align * align;
+    if (count == 0) {
+      continue;
+    }
+    std::vector<TensorValue> outs;
+    if (coll.out_count(count) > 0) {
+      outs = bufs->Make(coll.out_count(count), coll.num_tensors);
+    }
+    auto call = CallValues::make(OpValue::make(op), fschema[op](coll.make_args(count, outs)));
+    std::vector<std::shared_ptr<Stream>> streams;
+    std::vector<std::shared_ptr<Memory>> workspace;
+
+    // The setup includes the dispatch, the fused buffers and the communicator of the first use.
+    auto start = std::chrono::steady_clock::now();
+    OpEnvPtr op_env = Prepare(call, &streams, &workspace, bufs);
+    double setup = Seconds(start);
+
+    auto sync = [&]() {
+      for (const auto& stream : streams) {
+        stream->Wait();
+      }
+      cudaDeviceSynchronize();
+    };
+    for (int i = 0; i < opts.warmup; ++i) {
+      op_env->Execute(call);
+    }
+    sync();
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < opts.iters; ++i) {
+      op_env->Execute(call);
+    }
+    sync();
+    double times[2] = {setup, Seconds(start) / opts.iters};
+    MPI_Allreduce(MPI_IN_PLACE, times, 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    if (rank == 0) {
+      double bytes = static_cast<double>(count * dtype_size);
+      double algbw = bytes / times[1] / 1e9;
+      printf("%22s %8s %12ld %12ld %10.1f %10.1f %8.2f %8.2f\n", coll.name.c_str(),
+             dtype_name.c_str(), static_cast<long>(count * dtype_size), static_cast<long>(count),
+             times[0] * 1e6, times[1] * 1e6, algbw, algbw * coll.bus_factor(size));
+    }
+  }
+}
+
+int64_t ParseBytes(const std::string& str) {
+  int64_t value = std::stoll(str);
+  switch (str.back()) {
+    case 'G':
+      return value << 30;
+    case 'M':
+      return value << 20;
+    case 'K':
+      return value << 10;
+    default:
+      return value;
+  }
+}
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> ret;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    ret.push_back(item);
+  }
+  return ret;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i], value = argv[i + 1];
+    if (key == "--min-bytes") {
+      opts.min_bytes = ParseBytes(value);
+    } else if (key == "--max-bytes") {
+      opts.max_bytes = ParseBytes(value);
+    } else if (key == "--factor") {
+      opts.factor = std::stoll(value);
+    } else if (key == "--warmup") {
+      opts.warmup = std::stoi(value);
+    } else if (key == "--iters") {
+      opts.iters = std::stoi(value);
+    } else if (key == "--tensors") {
+      opts.num_tensors = std::stoi(value);
+    } else if (key == "--ops") {
+      opts.ops = Split(value);
+    } else if (key == "--dtypes") {
+      opts.dtypes = Split(value);
+    } else {
+      LOG(FATAL) << "Unknown option " << key;
+    }
+  }
+  CHECK_GT(opts.factor, 1) << "The factor must be greater than 1";
+  CHECK_GT(opts.iters, 0) << "The number of iterations must be positive";
+  return opts;
+}
+
+int main(int argc, char** argv) {
+  Options opts = ParseOptions(argc, argv);
+  // The global communicator initializes MPI.
+  auto comm = GetGlobalCommunicator();
+  int size = comm->size, rank = comm->rank;
+  Device dev(DevType::kCUDA(), comm->local_rank);
+  cudaSetDevice(comm->local_rank);
+  if (rank == 0) {
+    printf("# ranks %d, warmup %d, iters %d, tensors %d\n", size, opts.warmup, opts.iters,
+           opts.num_tensors);
+    printf("%22s %8s %12s %12s %10s %10s %8s %8s\n", "op", "dtype", "size(B)", "count",
+           "setup(us)", "time(us)", "algbw", "busbw");
+  }
+  for (const auto& dtype_name : opts.dtypes) {
+    DType dtype = dtype_name == "float16" ? DType(DTypeCode::kFloat(), 16)
+                                          : DType(DTypeCode::kFloat(), 32);
+    CHECK(dtype_name == "float16" || dtype_name == "float32") << "Unsupported dtype " << dtype_name;
+    Buffers bufs(dev, dtype);
+    for (const auto& coll : GetCollectives(size, opts.num_tensors, &bufs)) {
+      if (opts.ops.empty() ||
+          std::find(opts.ops.begin(), opts.ops.end(), coll.name) != opts.ops.end()) {
+        Run(coll, dtype_name, dtype, opts, size, rank, &bufs);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,496 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file tests/cpp/bench_ops.cc
+ * \brief Microbenchmark of an operator on each of its dialects through the OpEnv path, i.e., the
+ * declaration of the output, the make of the dialect OpEnv, the resource requests and the
+ * execution. The arguments are given as a list separated by ';', where a tensor is its dtype and
+ * shape, e.g., float32[1,64,56,56], a tuple of ints is (1,1), and the others are ints, floats,
+ * true/false, None or strings. Each --args is one benchmark. For example,
+ *   ./raf_bench_ops --op conv2d --device cuda --dialects cudnn,tvm \
+ *       --args "float32[32,64,56,56];float32[64,64,3,3];(1,1);(1,1);(1,1);1" \
+ *       --json conv2d.json
+ * It times the iterations until --min-time seconds, as Google Benchmark does, repeats it for
+ * --repetitions, and writes the results in the JSON format of Google Benchmark, so its comparing
+ * tools apply to them.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <raf/device_api.h>
+#include <raf/dialect.h>
+#include <raf/memory_pool.h>
+#include <raf/op.h>
+#include <raf/stream_pool.h>
+#include <raf/value.h>
+
+#include "../../src/requests.h"
+
+using raf::Device;
+using raf::DevType;
+using raf::DType;
+using raf::device_api::DeviceAPI;
+using raf::ir::Array;
+using raf::ir::Downcast;
+using raf::ir::Op;
+using raf::memory_pool::Memory;
+using raf::op::CallValues;
+using raf::op::FRAFDeclare;
+using raf::op::FRAFSchema;
+using raf::op::OpDialect;
+using raf::op::OpEnvMaker;
+using raf::op::OpEnvPtr;
+using raf::requests::Requests;
+using raf::stream_pool::Stream;
+using raf::value::NullValue;
+using raf::value::OpValue;
+using raf::value::ScalarValue;
+using raf::value::StringValue;
+using raf::value::TensorValue;
+using raf::value::TensorValueObj;
+using raf::value::TupleValue;
+using raf::value::TupleValueObj;
+using raf::value::Value;
+
+/*! \brief The options of the benchmark. */
+struct Options {
+  std::string op;
+  std::string device = "cuda";
+  /*! \brief The dialects to compare, or all the enabled ones on the device if empty. */
+  std::vector<std::string> dialects;
+  /*! \brief The arguments of each benchmark. */
+  std::vector<std::string> args;
+  double min_time = 0.1;
+  int repetitions = 3;
+  int warmup = 3;
+  std::string json;
+};
+
+/*! \brief The result of a benchmark on a dialect. */
+struct Result {
+  std::string name;
+  std::string dialect;
+  std::string args;
+  bool ok = false;
+  std::string error;
+  double setup_us = 0;
+  int64_t iterations = 0;
+  /*! \brief The time per iteration of each repetition in microseconds. */
+  std::vector<double> times_us;
+};
+
+std::vector<std::string> Split(const std::string& str, char sep) {
+  std::vector<std::string> ret;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, sep)) {
+    if (!item.empty()) {
+      ret.push_back(item);
+    }
+  }
+  return ret;
+}
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*! \brief A random bit pattern of a half in [-2, -0.125] or [0.125, 2]. */
+uint16_t RandomHalf(std::mt19937* rng) {
+  uint32_t bits = (*rng)();
+  uint16_t sign = bits & 0x8000;
+  uint16_t exponent = 12 + (bits >> 16) % 4;
+  return sign | (exponent << 10) | (bits & 0x3ff);
+}
+
+/*! \brief Fill the host buffer of a tensor with small random values of its dtype. */
+void FillRandom(const DType& dtype, int64_t count, void* data, std::mt19937* rng) {
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  std::uniform_int_distribution<int> small(0, 7);
+  DLDataType dl = dtype;
+  for (int64_t i = 0; i < count; ++i) {
+    if (dl.code == kDLFloat && dl.bits == 32) {
+      static_cast<float*>(data)[i] = uniform(*rng);
+    } else if (dl.code == kDLFloat && dl.bits == 64) {
+      static_cast<double*>(data)[i] = uniform(*rng);
+    } else if (dl.code == kDLFloat && dl.bits == 16) {
+      static_cast<uint16_t*>(data)[i] = RandomHalf(rng);
+    } else if (dl.bits == 64) {
+      static_cast<int64_t*>(data)[i] = small(*rng);
+    } else if (dl.bits == 32) {
+      static_cast<int32_t*>(data)[i] = small(*rng);
+    } else if (dl.bits == 16) {
+      static_cast<int16_t*>(data)[i] = small(*rng);
+    } else {
+      static_cast<uint8_t*>(data)[i] = small(*rng) & 1;
+    }
+  }
+}
+
+/*! \brief The tensors of the benchmarks, whose memory is kept alive until they end. */
+class Buffers {
+ public:
+  explicit Buffers(const Device& dev) : dev_(dev), rng_(0) {
+  }
+
+  /*! \brief Make a tensor of random values. */
+  TensorValue Make(const DType& dtype, const std::vector<int64_t>& shape) {
+    int64_t count = 1;
+    for (auto dim : shape) {
+      count *= dim;
+    }
+    int64_t nbytes = count * ((dtype.bits + 7) / 8);
+    std::vector<uint8_t> host(nbytes);
+    FillRandom(dtype, count, host.data(), &rng_);
+    auto memory = Memory::Alloc(dev_, nbytes);
+    memories_.push_back(memory);
+    auto tensor = TensorValue::Assemble(dev_, dtype, shape, {}, memory->data, memory);
+    if (dev_.device_type() == DevType::kCPU()) {
+      std::copy(host.begin(), host.end(), static_cast<uint8_t*>(memory->data));
+    } else {
+      auto host_tensor =
+          TensorValue::Assemble(Device(DevType::kCPU(), 0), dtype, shape, {}, host.data());
+      auto api = DeviceAPI::Get(dev_.device_type());
+      api->CopyDataFromTo(host_tensor, tensor);
+      api->WaitDevice(dev_);
+    }
+    return tensor;
+  }
+
+  /*! \brief Allocate the memory of the outputs made by the declare function. */
+  void Alloc(Value out) {
+    std::vector<TensorValue> tensors;
+    if (auto tup = out.as<TupleValueObj>()) {
+      for (const auto& field : tup->fields) {
+        tensors.push_back(Downcast<TensorValue>(field));
+      }
+    } else if (out->IsInstance<TensorValueObj>()) {
+      tensors.push_back(Downcast<TensorValue>(out));
+    }
+    for (auto& tensor : tensors) {
+      DLTensor* dlt = tensor;
+      if (dlt->data == nullptr) {
+        int64_t nbytes = (dlt->dtype.bits + 7) / 8;
+        for (int i = 0; i < dlt->ndim; ++i) {
+          nbytes *= dlt->shape[i];
+        }
+        auto memory = Memory::Alloc(dlt->device, nbytes);
+        dlt->data = memory->data;
+        tensor->mem = memory;
+      }
+    }
+  }
+
+ private:
+  Device dev_;
+  std::mt19937 rng_;
+  std::vector<std::shared_ptr<Memory>> memories_;
+};
+
+/*! \brief Parse an argument, which is a tensor, a tuple of ints or a scalar. */
+Value ParseArg(const std::string& str, Buffers* bufs) {
+  auto lbracket = str.find('[');
+  if (lbracket != std::string::npos) {
+    CHECK_EQ(str.back(), ']') << "Invalid tensor " << str;
+    DType dtype(tvm::runtime::String2DLDataType(str.substr(0, lbracket)));
+    std::vector<int64_t> shape;
+    for (const auto& dim : Split(str.substr(lbracket + 1, str.size() - lbracket - 2), ',')) {
+      shape.push_back(std::stoll(dim));
+    }
+    return bufs->Make(dtype, shape);
+  }
+  if (str.front() == '(') {
+    CHECK_EQ(str.back(), ')') << "Invalid tuple " << str;
+    Array<Value> fields;
+    for (const auto& field : Split(str.substr(1, str.size() - 2), ',')) {
+      fields.push_back(ScalarValue::make(static_cast<int64_t>(std::stoll(field))));
+    }
+    return TupleValue::make(fields);
+  }
+  if (str == "None") {
+    return NullValue<Value>();
+  }
+  if (str == "true" || str == "false") {
+    return ScalarValue::make(str == "true");
+  }
+  char* end = nullptr;
+  int64_t int_value = std::strtoll(str.c_str(), &end, 10);
+  if (*end == '\0') {
+    return ScalarValue::make(int_value);
+  }
+  double float_value = std::strtod(str.c_str(), &end);
+  if (*end == '\0') {
+    return ScalarValue::make(float_value);
+  }
+  return StringValue::make(str);
+}
+
+/*!
+ * \brief Make the OpEnv of a dialect op for a call, and fulfill its requests, as the executors
+ * do. Unlike the dispatch, it does not fall back to the other dialects.
+ * \return The OpEnv, or nullptr with the error if the dialect does not support the call.
+ */
+OpEnvPtr Prepare(const std::string& dialect_op, const CallValues& call,
+                 std::vector<std::shared_ptr<Memory>>* workspace, std::string* error) {
+  const auto* maker = OpEnvMaker::Get(dialect_op);
+  if (maker == nullptr) {
+    *error = "no OpEnv is registered";
+    return nullptr;
+  }
+  OpEnvPtr op_env;
+  try {
+    op_env = OpEnvPtr((*maker)(call));
+  } catch (const dmlc::Error& e) {
+    *error = e.what();
+    return nullptr;
+  }
+  if (op_env == nullptr || op_env->HasError()) {
+    *error = op_env == nullptr || op_env->error_msgs.empty() ? "unsupported call"
+                                                             : op_env->error_msgs[0];
+    return nullptr;
+  }
+  std::shared_ptr<Requests> req = op_env->GetRequests();
+  for (auto& entry : req->workspace) {
+    entry.memory = Memory::Alloc(entry.device, entry.nbytes);
+    *entry.dest = entry.memory->data;
+    workspace->push_back(entry.memory);
+  }
+  for (auto& entry : req->stream) {
+    entry.stream = Stream::Get(entry.device, entry.tag_idx, entry.stream_idx);
+    *entry.dest = entry.stream->data();
+  }
+  return op_env;
+}
+
+/*! \brief Benchmark a call on a dialect. */
+Result Run(const Op& op, const std::string& dialect, const std::string& dialect_op,
+           const Array<Value>& args, const std::string& args_str, const Device& dev,
+           const Options& opts, Buffers* bufs) {
+  static const auto fschema = Op::GetAttrMap<FRAFSchema>("FRAFSchema");
+  static const auto fdeclare = Op::GetAttrMap<FRAFDeclare>("FRAFDeclare");
+  Result ret;
+  ret.dialect = dialect;
+  ret.args = args_str;
+  ret.name = op->name.substr(op->name.rfind('.') + 1) + "/" + dialect + "/" + args_str;
+  // The call of the dialect op, whose output is declared by the base op.
+  auto call = CallValues::make(OpValue::make(Op::Get(dialect_op)), fschema[op](args));
+  call->device = dev;
+  fdeclare[op](call);
+  bufs->Alloc(call->out);
+
+  // The setup includes the make of the OpEnv, e.g., the JIT of TVM or the algorithm search of
+  // cuDNN, and the resource requests.
+  std::vector<std::shared_ptr<Memory>> workspace;
+  auto start = std::chrono::steady_clock::now();
+  OpEnvPtr op_env = Prepare(dialect_op, call, &workspace, &ret.error);
+  ret.setup_us = Seconds(start) * 1e6;
+  if (op_env == nullptr) {
+    return ret;
+  }
+  auto api = DeviceAPI::Get(dev.device_type());
+  auto run = [&](int64_t iters) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iters; ++i) {
+      op_env->Execute(call);
+    }
+    api->WaitDevice(dev);
+    return Seconds(begin);
+  };
+  run(opts.warmup);
+  // Double the iterations until they take the minimal time, and then scale them to it.
+  int64_t iters = 1;
+  double elapsed = run(iters);
+  while (elapsed < opts.min_time && iters < (int64_t(1) << 30)) {
+    int64_t next = elapsed > opts.min_time / 100
+                       ? static_cast<int64_t>(std::ceil(iters * 1.4 * opts.min_time / elapsed))
+                       : iters * 10;
+    iters = std::max(next, iters + 1);
+    elapsed = run(iters);
+  }
+  ret.iterations = iters;
+  ret.times_us.push_back(elapsed / iters * 1e6);
+  for (int r = 1; r < opts.repetitions; ++r) {
+    ret.times_us.push_back(run(iters) / iters * 1e6);
+  }
+  ret.ok = true;
+  return ret;
+}
+
+double Mean(const std::vector<double>& values) {
+  double sum = 0;
+  for (auto v : values) {
+    sum += v;
+  }
+  return sum / values.size();
+}
+
+double Median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+double Stddev(const std::vector<double>& values) {
+  if (values.size() < 2) {
+    return 0;
+  }
+  double mean = Mean(values), sum = 0;
+  for (auto v : values) {
+    sum += (v - mean) * (v - mean);
+  }
+  return std::sqrt(sum / (values.size() - 1));
+}
+
+std::string Escape(const std::string& str) {
+  std::string ret;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      ret.push_back('\\');
+      ret.push_back(c);
+    } else if (c == '\n') {
+      ret += "\\n";
+    } else {
+      ret.push_back(c);
+    }
+  }
+  return ret;
+}
+
+/*!
+ * \brief Write the results in the JSON format of Google Benchmark, i.e., an entry per repetition
+ * and the mean, median and stddev aggregates, with the real times in microseconds. The failed
+ * dialects are entries with the error.
+ */
+void WriteJSON(const std::string& path, const Options& opts, const std::vector<Result>& results) {
+  std::ofstream os(path);
+  CHECK(os.is_open()) << "Cannot open " << path;
+  os << "{\n  \"context\": {\"executable\": \"raf_bench_ops\", \"op\": \"" << Escape(opts.op)
+     << "\", \"device\": \"" << Escape(opts.device) << "\", \"min_time\": " << opts.min_time
+     << ", \"repetitions\": " << opts.repetitions << "},\n  \"benchmarks\": [";
+  bool first = true;
+  auto entry = [&](const Result& res, const std::string& name, const std::string& run_type,
+                   const std::string& aggregate, double time_us, int64_t iterations) {
+    os << (first ? "\n" : ",\n") << "    {\"name\": \"" << Escape(name) << "\", \"run_name\": \""
+       << Escape(res.name) << "\", \"run_type\": \"" << run_type << "\"";
+    if (!aggregate.empty()) {
+      os << ", \"aggregate_name\": \"" << aggregate << "\"";
+    }
+    os << ", \"dialect\": \"" << Escape(res.dialect) << "\", \"args\": \"" << Escape(res.args)
+       << "\", \"iterations\": " << iterations << ", \"real_time\": " << time_us
+       << ", \"cpu_time\": " << time_us << ", \"setup_time\": " << res.setup_us
+       << ", \"time_unit\": \"us\"";
+    if (!res.ok) {
+      os << ", \"error_occurred\": true, \"error_message\": \"" << Escape(res.error) << "\"";
+    }
+    os << "}";
+    first = false;
+  };
+  for (const auto& res : results) {
+    if (!res.ok) {
+      entry(res, res.name, "iteration", "", 0, 0);
+      continue;
+    }
+    for (auto time : res.times_us) {
+      entry(res, res.name, "iteration", "", time, res.iterations);
+    }
+    entry(res, res.name + "_mean", "aggregate", "mean", Mean(res.times_us), res.iterations);
+    entry(res, res.name + "_median", "aggregate", "median", Median(res.times_us), res.iterations);
+    entry(res, res.name + "_stddev", "aggregate", "stddev", Stddev(res.times_us),
+          res.iterations);
+  }
+  os << "\n  ]\n}\n";
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i], value = argv[i + 1];
+    if (key == "--op") {
+      opts.op = value;
+    } else if (key == "--device") {
+      opts.device = value;
+    } else if (key == "--dialects") {
+      opts.dialects = Split(value, ',');
+    } else if (key == "--args") {
+      opts.args.push_back(value);
+    } else if (key == "--min-time") {
+      opts.min_time = std::stod(value);
+    } else if (key == "--repetitions") {
+      opts.repetitions = std::stoi(value);
+    } else if (key == "--warmup") {
+      opts.warmup = std::stoi(value);
+    } else if (key == "--json") {
+      opts.json = value;
+    } else {
+      LOG(FATAL) << "Unknown option " << key;
+    }
+  }
+  CHECK(!opts.op.empty()) << "The op is not given by --op";
+  CHECK(!opts.args.empty()) << "The arguments are not given by --args";
+  CHECK_GT(opts.repetitions, 0) << "The number of repetitions must be positive";
+  return opts;
+}
+
+int main(int argc, char** argv) {
+  Options opts = ParseOptions(argc, argv);
+  std::string op_name = opts.op.find("raf.op.") == 0 ? opts.op : "raf.op." + opts.op;
+  Op op = Op::Get(op_name);
+  CHECK(opts.device == "cpu" || opts.device == "cuda") << "Unsupported device " << opts.device;
+  Device dev(opts.device == "cpu" ? DevType::kCPU() : DevType::kCUDA(), 0);
+  // The dialects of the op on the device in the dispatch order.
+  std::vector<std::pair<std::string, std::string>> dialects;
+  for (const auto& entry : OpDialect::GetDispatchList(op, dev.device_type())) {
+    if (opts.dialects.empty() || std::find(opts.dialects.begin(), opts.dialects.end(),
+                                           entry.dialect) != opts.dialects.end()) {
+      dialects.emplace_back(entry.dialect, entry.dialect_op);
+    }
+  }
+  CHECK(!dialects.empty()) << "No dialect of " << op_name << " is enabled on " << opts.device;
+
+  Buffers bufs(dev);
+  std::vector<Result> results;
+  printf("%-12s %12s %12s %12s %10s  %s\n", "dialect", "setup(us)", "time(us)", "stddev(us)",
+         "vs. best", "args");
+  for (const auto& args_str : opts.args) {
+    Array<Value> args;
+    for (const auto& arg : Split(args_str, ';')) {
+      args.push_back(ParseArg(arg, &bufs));
+    }
+    size_t begin = results.size();
+    for (const auto& kv : dialects) {
+      results.push_back(Run(op, kv.first, kv.second, args, args_str, dev, opts, &bufs));
+    }
+    double best = 0;
+    for (size_t i = begin; i < results.size(); ++i) {
+      if (results[i].ok && (best == 0 || Median(results[i].times_us) < best)) {
+        best = Median(results[i].times_us);
+      }
+    }
+    for (size_t i = begin; i < results.size(); ++i) {
+      const auto& res = results[i];
+      if (res.ok) {
+        double median = Median(res.times_us);
+        printf("%-12s %12.1f %12.2f %12.2f %9.2fx  %s\n", res.dialect.c_str(), res.setup_us,
+               median, Stddev(res.times_us), median / best, args_str.c_str());
+      } else {
+        printf("%-12s %12s %12s %12s %10s  %s (%s)\n", res.dialect.c_str(), "-", "-", "-", "-",
+               args_str.c_str(), res.error.c_str());
+      }
+    }
+  }
+  if (!opts.json.empty()) {
+    WriteJSON(opts.json, opts, results);
+  }
+  return 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*!
+ * \file smoke_runtime.cc
+ * \brief The smoke test of the runtime library, which is linked against raf_runtime instead of raf,
+ * so a source left out of the runtime library but still referenced fails the link.
+ */
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <raf/registry.h>
+#include <raf/vm/executable.h>
+#include <raf/vm/vm.h>
+
+using raf::executor::vm::CreateVirtualMachine;
+using raf::executor::vm::Executable;
+using raf::registry::Registry;
+
+TEST(Runtime, Registry) {
+  ASSERT_NE(Registry::Get("raf.vm.VirtualMachine"), nullptr);
+  ASSERT_NE(Registry::Get("raf.vm.Load_ExecutableDeployment"), nullptr);
+  // The VM compiler is left out of the runtime library.
+  ASSERT_EQ(Registry::Get("raf.vm.VMCompiler"), nullptr);
+}
+
+TEST(Runtime, CreateVirtualMachine) {
+  auto exec = tvm::runtime::make_object<Executable>();
+  tvm::runtime::Module vm = CreateVirtualMachine(exec.get(), false, false, true, false, 1);
+  ASSERT_EQ(std::string(vm->type_key()), "VirtualMachine");
+}
+
+TEST(Runtime, LoadDeployment) {
+  ASSERT_ANY_THROW(Executable::LoadDeployment("exec.bin", "/nonexistent/kernel/bundle"));
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <raf/cache.h>
+
+using raf::op::Hash128;
+using raf::op::HashKey;
+using raf::op::MetaCache;
+using raf::op::StreamHasher128;
+
+TEST(HashKey, StreamingHash) {
+  std::string bytes;
+  for (int i = 0; i < 100; ++i) {
+    bytes.push_back(static_cast<char>(i * 37));
+  }
+  Hash128 expected = StreamHasher128::Hash(bytes.data(), bytes.size());
+  // The hash does not depend on how the bytes are split into the updates.
+  for (size_t step = 1; step < 10; ++step) {
+    StreamHasher128 hasher;
+    for (size_t i = 0; i < bytes.size(); i += step) {
+      hasher.Update(bytes.data() + i, std::min(step, bytes.size() - i));
+    }
+    ASSERT_EQ(hasher.Finalize(), expected);
+  }
+  // The trailing zeros are a part of the hash.
+  std::string zeros(16, '\0');
+  ASSERT_NE(StreamHasher128::Hash(zeros.data(), 8), StreamHasher128::Hash(zeros.data(), 16));
+}
+
+TEST(HashKey, Spill) {
+  HashKey key;
+  std::vector<int64_t> shape{1, 3, 224, 224};
+  for (int i = 0; i < 64; ++i) {
+    key << shape << static_cast<int32_t>(i);
+  }
+  // Each round is the type code, 4 dims, the terminator and an int32.
+  ASSERT_EQ(key.size(), 64 * (1 + 5 * 8 + 4));
+  std::string bytes = key.str();
+  ASSERT_EQ(key.bytes(), std::vector<uint8_t>(bytes.begin(), bytes.end()));
+  ASSERT_EQ(key.hash(), StreamHasher128::Hash(bytes.data(), bytes.size()));
+  HashKey copy = key;
+  ASSERT_EQ(copy.str(), bytes);
+}
+
+TEST(MetaCache, HashKey) {
+  MetaCache<int> cache;
+  HashKey key;
+  key << "conv2d" << std::vector<int64_t>{1, 3, 224, 224};
+  ASSERT_EQ(cache.Get(key), nullptr);
+  cache.Set(key, 1);
+  // The lookups by the other views of the same bytes hit the entry.
+  ASSERT_EQ(*cache.Get(key.str()), 1);
+  ASSERT_TRUE(cache.Has(key.bytes()));
+  HashKey other;
+  other << "conv2d" << std::vector<int64_t>{1, 3, 224, 225};
+  ASSERT_FALSE(cache.Has(other));
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -3,6 +3,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <future>
+#include <thread>
+
 #include <gtest/gtest.h>
 
 #include <raf/device.h>
@@ -13,6 +16,7 @@ using raf::DevType;
 using raf::kDefaultMemoryAlignment;
 using raf::memory_pool::Memory;
 using raf::memory_pool::MemoryPool;
+using raf::memory_pool::TenantScope;
 
 TEST(NoPool, CPU) {
   Device dev{DevType::kCPU(), 0};
@@ -60,6 +64,191 @@ TEST(PageUnitPool, CPU) {
   result.reset();
   pool_size = Memory::GetPoolSize(dev);
   ASSERT_EQ(pool_size.first, 0);
+
+  // Stream-ordered allocations share the chunks with the others.
+  void* data = nullptr;
+  {
+    std::shared_ptr<Memory> async_result = Memory::AllocAsync(dev, 4096, nullptr);
+    data = async_result->data;
+  }
+  result = Memory::Alloc(dev, 4096, kDefaultMemoryAlignment);
+  ASSERT_EQ(result->data, data);
+  result.reset();
+  Memory::RemovePool(dev);
+}
+
+TEST(CachingPool, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "caching_pool");
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 0);
+    ASSERT_EQ(result.use_count(), 1);
+    ASSERT_EQ(result->data, nullptr);
+  }
+  for (int memory : {11, 19, 2019, 1024124, 4194304}) {
+    for (int align : {(int)kDefaultMemoryAlignment, 512, 1024, 4096}) {
+      std::shared_ptr<Memory> result = Memory::Alloc(dev, memory, align);
+      ASSERT_EQ(result.use_count(), 1);
+      int64_t address = (int64_t)result->data;
+      ASSERT_EQ(address % align, 0);
+    }
+  }
+  auto pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);  // No block is used.
+  ASSERT_GT(pool_size.second, 0);  // The segments are cached.
+
+  // Adjacent free blocks are coalesced, so a larger request reuses them.
+  void* first = nullptr;
+  {
+    std::shared_ptr<Memory> a = Memory::Alloc(dev, 1024);
+    std::shared_ptr<Memory> b = Memory::Alloc(dev, 1024);
+    ASSERT_EQ((char*)b->data - (char*)a->data, 1024);
+    first = a->data;
+  }
+  std::shared_ptr<Memory> result = Memory::Alloc(dev, 2048);
+  ASSERT_EQ(result->data, first);
+  pool_size = Memory::GetPoolSize(dev);
+  auto used_size = pool_size.first * 1048576.0;
+  auto abs_diff = (used_size > 2048) ? used_size - 2048 : 2048 - used_size;
+  ASSERT_LE(abs_diff, 1);
+  result.reset();
+  pool_size = Memory::GetPoolSize(dev);
+  ASSERT_EQ(pool_size.first, 0);
+  Memory::RemovePool(dev);
+}
+
+TEST(ThreadCache, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "no_pool");
+  Memory::SetThreadCacheSize(1 << 20);
+  void* data = nullptr;
+  {
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 4096);
+    data = result->data;
+  }
+  {
+    // The released chunk is cached by this thread instead of being freed by no_pool.
+    std::shared_ptr<Memory> result = Memory::Alloc(dev, 4096);
+    ASSERT_EQ(result->data, data);
+    std::shared_ptr<Memory> other = Memory::Alloc(dev, 4096);
+    ASSERT_NE(other->data, data);
+  }
+  Memory::SetThreadCacheSize(0);
+  Memory::RemovePool(dev);
+}
+
+TEST(Compact, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  for (const char* name : {"page_unit_pool", "caching_pool"}) {
+    Memory::InitPool(dev, name);
+    std::shared_ptr<Memory> used = Memory::Alloc(dev, 4096);
+    Memory::Alloc(dev, 8 << 20).reset();
+    // Only the free memory is reclaimed.
+    ASSERT_GE(Memory::Compact(dev), 8 << 20);
+    ASSERT_EQ(Memory::Compact(dev), 0);
+    ASSERT_NE(used->data, nullptr);
+    used.reset();
+    Memory::RemovePool(dev);
+  }
+}
+
+TEST(Compact, ThreadCache) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "page_unit_pool");
+  Memory::SetThreadCacheSize(1 << 20);
+  std::promise<void> cached, compacted;
+  std::thread thread([&]() {
+    // The released chunk is parked in the cache of this thread, which is alive until compacted.
+    Memory::Alloc(dev, 4096).reset();
+    cached.set_value();
+    compacted.get_future().wait();
+  });
+  cached.get_future().wait();
+  int64_t reclaimed = Memory::Compact(dev);
+  compacted.set_value();
+  thread.join();
+  ASSERT_EQ(reclaimed, 4096);
+  Memory::SetThreadCacheSize(0);
+  Memory::RemovePool(dev);
+}
+
+TEST(PoolStats, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "page_unit_pool");
+  const auto& stats = *Memory::GetPool(dev)->stats;
+  int tag = Memory::InternTag("op");
+  ASSERT_EQ(Memory::InternTag("op"), tag);
+  {
+    std::shared_ptr<Memory> a = Memory::Alloc(dev, 4096);
+    std::shared_ptr<Memory> b = Memory::Alloc(dev, 8192);
+    ASSERT_EQ(stats.bytes_in_use, 4096 + 8192);
+    Memory::RecordTag(dev, tag);
+  }
+  // Reused from the pool without allocating from the device.
+  Memory::Alloc(dev, 4096).reset();
+  ASSERT_EQ(stats.num_allocs, 3);
+  ASSERT_EQ(stats.num_device_allocs, 2);
+  // The pool notices the released chunks when they are settled.
+  ASSERT_EQ(stats.bytes_in_use, 4096 + 8192);
+  ASSERT_EQ(Memory::GetPool(dev)->GetBytesInUse(), 0);
+  ASSERT_EQ(stats.bytes_in_use, 0);
+  ASSERT_EQ(stats.peak_bytes_in_use, 4096 + 8192);
+  ASSERT_EQ(stats.size_histogram[13], 2);  // [4096, 8192)
+  ASSERT_EQ(stats.size_histogram[14], 1);  // [8192, 16384)
+  Memory::RecordTag(dev, tag);
+  ASSERT_EQ(Memory::GetPool(dev)->stats->tag_peak_bytes[tag], 4096 + 8192);
+  Memory::RemovePool(dev);
+}
+
+TEST(PoolStats, Release) {
+  Device dev{DevType::kCPU(), 0};
+  for (const char* name : {"no_pool", "caching_pool", "page_unit_pool"}) {
+    Memory::InitPool(dev, name);
+    MemoryPool* pool = Memory::GetPool(dev);
+    std::shared_ptr<Memory> memory = Memory::Alloc(dev, 1000);
+    ASSERT_EQ(pool->GetBytesInUse(), Memory::GetAllocBytes(dev, 1000)) << name;
+    memory.reset();
+    ASSERT_EQ(pool->GetBytesInUse(), 0) << name;
+    ASSERT_EQ(pool->stats->peak_bytes_in_use, Memory::GetAllocBytes(dev, 1000)) << name;
+    Memory::RemovePool(dev);
+  }
+}
+
+TEST(TenantQuota, CPU) {
+  Device dev{DevType::kCPU(), 0};
+  Memory::InitPool(dev, "no_pool");
+  const int64_t kb = 1024;
+  Memory::SetPartitionCapacity(dev, 1024 * kb);
+  Memory::SetTenantQuota(dev, "a", 512 * kb);
+  Memory::SetTenantQuota(dev, "b", 0, 256 * kb);
+  std::shared_ptr<Memory> a;
+  {
+    TenantScope scope("a");
+    a = Memory::Alloc(dev, 384 * kb);
+    // The quota of a is exceeded.
+    ASSERT_THROW(Memory::Alloc(dev, 256 * kb), dmlc::Error);
+  }
+  // The default tenant cannot take the memory reserved for b.
+  ASSERT_THROW(Memory::Alloc(dev, 512 * kb), dmlc::Error);
+  std::shared_ptr<Memory> other = Memory::Alloc(dev, 384 * kb);
+  {
+    TenantScope scope("b");
+    std::shared_ptr<Memory> b = Memory::Alloc(dev, 256 * kb);
+    auto stats = Memory::GetTenantStats(dev);
+    ASSERT_EQ(stats.at("a").bytes_in_use, 384 * kb);
+    ASSERT_EQ(stats.at("a").num_rejected, 1);
+    ASSERT_EQ(stats.at("b").bytes_in_use, 256 * kb);
+    ASSERT_EQ(stats.at("").num_rejected, 1);
+  }
+  a.reset();
+  other.reset();
+  auto stats = Memory::GetTenantStats(dev);
+  ASSERT_EQ(stats.at("a").bytes_in_use, 0);
+  ASSERT_EQ(stats.at("a").peak_bytes_in_use, 384 * kb);
+  ASSERT_EQ(stats.at("b").bytes_in_use, 0);
+  Memory::SetTenantQuota(dev, "a", 0);
+  Memory::SetTenantQuota(dev, "b", 0);
+  Memory::SetPartitionCapacity(dev, 0);
   Memory::RemovePool(dev);
 }
 
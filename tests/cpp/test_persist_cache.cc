@@ -0,0 +1,109 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <unistd.h>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <raf/cache.h>
+
+using raf::op::HashKey;
+using raf::op::MetaPersistCache;
+using raf::op::PersistCacheIndex;
+
+struct IntCacheEntry {
+  explicit IntCacheEntry(int value) : value(value) {
+  }
+
+  bool Save(const std::string& path) {
+    std::ofstream ofs(path + "/value");
+    ofs << value;
+    return ofs.good();
+  }
+
+  static IntCacheEntry Load(const std::string& path) {
+    std::ifstream ifs(path + "/value");
+    int value;
+    CHECK(ifs >> value) << "Failed to load " << path;
+    return IntCacheEntry(value);
+  }
+
+  int value;
+};
+
+class PersistCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/raf_persist_cache_XXXXXX";
+    ASSERT_NE(mkdtemp(path), nullptr);
+    root_ = path;
+  }
+
+  void TearDown() override {
+    raf::RemovePath(root_);
+  }
+
+  static HashKey MakeKey(int i) {
+    HashKey key;
+    key << "conv2d" << static_cast<int64_t>(i);
+    return key;
+  }
+
+  std::string root_;
+};
+
+TEST_F(PersistCacheTest, SharedEntries) {
+  MetaPersistCache<IntCacheEntry> writer("test_cache");
+  MetaPersistCache<IntCacheEntry> reader("test_cache");
+  writer.SetPersistRoot(root_);
+  reader.SetPersistRoot(root_);
+  writer.Set(MakeKey(0), IntCacheEntry(42));
+  // The entry persisted by the writer is found by the index of the reader.
+  const auto* entry = reader.Get(MakeKey(0));
+  ASSERT_NE(entry, nullptr);
+  ASSERT_EQ(entry->value, 42);
+  ASSERT_EQ(reader.Get(MakeKey(1)), nullptr);
+  auto metrics = reader.GetMetric();
+  ASSERT_EQ(metrics["PersistCacheHit"], 1);
+  ASSERT_EQ(metrics["PersistCacheMiss"], 1);
+  // The entries are indexed in the cache directory.
+  std::ifstream index(root_ + "/test_cache/" + PersistCacheIndex::INDEX_FILE);
+  ASSERT_TRUE(index.good());
+  reader.SetPersistRoot("");
+  writer.SetPersistRoot("");
+}
+
+TEST_F(PersistCacheTest, CollectGarbage) {
+  MetaPersistCache<IntCacheEntry> writer("test_cache");
+  writer.SetPersistRoot(root_);
+  for (int i = 0; i < 3; ++i) {
+    writer.Set(MakeKey(i), IntCacheEntry(i));
+    usleep(2000);
+  }
+  MetaPersistCache<IntCacheEntry> reader("test_cache");
+  reader.SetPersistRoot(root_);
+  // Loading the first entry makes it the most recently used one.
+  ASSERT_NE(reader.Get(MakeKey(0)), nullptr);
+  PersistCacheIndex index;
+  index.Open(root_ + "/test_cache");
+  int64_t entry_bytes = index.TotalBytes() / 3;
+  ASSERT_EQ(writer.CollectGarbage(entry_bytes), 2);
+
+  MetaPersistCache<IntCacheEntry> other("test_cache");
+  other.SetPersistRoot(root_);
+  ASSERT_NE(other.Get(MakeKey(0)), nullptr);
+  ASSERT_EQ(other.Get(MakeKey(1)), nullptr);
+  ASSERT_EQ(other.Get(MakeKey(2)), nullptr);
+  for (auto* cache : {&writer, &reader, &other}) {
+    cache->SetPersistRoot("");
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
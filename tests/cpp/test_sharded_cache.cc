@@ -0,0 +1,86 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <raf/cache.h>
+
+using raf::op::CacheKeyView;
+using raf::op::ShardedMetaCache;
+
+TEST(ShardedMetaCache, GetSet) {
+  ShardedMetaCache<int> cache;
+  std::string key = "conv2d(1,3,224,224)";
+  int value = 0;
+  ASSERT_FALSE(cache.Get(key, &value));
+  ASSERT_EQ(cache.Set(key, 1), 1);
+  // The key of the same bytes and another tag is another key.
+  ASSERT_FALSE(cache.Has(CacheKeyView(key, 1)));
+  ASSERT_EQ(cache.Set(CacheKeyView(key, 1), 2), 2);
+  // The cached value is kept.
+  ASSERT_EQ(cache.Set(key, 3), 1);
+  ASSERT_TRUE(cache.Get(std::vector<uint8_t>(key.begin(), key.end()), &value));
+  ASSERT_EQ(value, 1);
+  ASSERT_TRUE(cache.Get(CacheKeyView(key, 1), &value));
+  ASSERT_EQ(value, 2);
+  ASSERT_EQ(cache.Size(), 2);
+  ASSERT_TRUE(cache.Erase(key));
+  ASSERT_FALSE(cache.Erase(key));
+  cache.Clear();
+  ASSERT_EQ(cache.Size(), 0);
+  ASSERT_EQ(cache.Evictions(), 0);
+}
+
+TEST(ShardedMetaCache, Evict) {
+  ShardedMetaCache<int> cache(/*capacity=*/3, /*num_shards=*/1);
+  std::vector<std::string> evicted;
+  cache.SetEvictCallback(
+      [&](const std::string& key, uint64_t tag, const int& value) { evicted.push_back(key); });
+  cache.Set(std::string("a"), 0);
+  cache.Set(std::string("b"), 1);
+  cache.Set(std::string("c"), 2);
+  int value;
+  // The hit of "a" gives it a second chance, so "b" is evicted.
+  ASSERT_TRUE(cache.Get(std::string("a"), &value));
+  cache.Set(std::string("d"), 3);
+  ASSERT_EQ(evicted, std::vector<std::string>({"b"}));
+  ASSERT_EQ(cache.Size(), 3);
+  ASSERT_TRUE(cache.Has(std::string("a")));
+  ASSERT_TRUE(cache.Has(std::string("d")));
+  // The hand is at "c", which is not referenced, so it is evicted.
+  cache.Set(std::string("e"), 4);
+  ASSERT_EQ(evicted, std::vector<std::string>({"b", "c"}));
+  ASSERT_EQ(cache.Evictions(), 2);
+}
+
+TEST(ShardedMetaCache, Concurrent) {
+  ShardedMetaCache<int> cache(/*capacity=*/256);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < 10000; ++i) {
+        std::string key = std::to_string((i * 7 + t) % 512);
+        int value;
+        if (!cache.Get(key, &value)) {
+          value = cache.Set(key, std::stoi(key));
+        }
+        ASSERT_EQ(value, std::stoi(key));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_LE(cache.Size(), 256);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
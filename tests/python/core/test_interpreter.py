@@ -0,0 +1,65 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,attribute-defined-outside-init,no-self-use
+import numpy as np
+import pytest
+import raf
+from raf.testing import get_testable_devices, randn, check
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_memoized_primitives(device):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            z = raf.add(x, y)
+            z = raf.multiply(raf.relu(z), x)
+            return raf.sum(z, axis=1, keepdims=True)
+
+    model = Model()
+    # The calls of the same types reuse the declared outputs and the OpEnvs of the first call,
+    # which must still compute with the new inputs. A new shape is declared and dispatched again.
+    for shape in [[3, 4], [3, 4], [5, 6], [3, 4]]:
+        m_x, n_x = randn(shape, device=device)
+        m_y, n_y = randn(shape, device=device)
+        m_z = model(m_x, m_y)
+        n_z = np.sum(np.maximum(n_x + n_y, 0) * n_x, axis=1, keepdims=True)
+        check(m_z, n_z)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_async_interpret(device):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            z = raf.matmul(x, y)
+            return raf.relu(raf.add(z, x))
+
+    model = Model()
+    m_x, n_x = randn([8, 8], device=device)
+    m_y, n_y = randn([8, 8], device=device)
+    raf._core.executor.set_async_interpret(True)
+    try:
+        # The outputs of the previous iterations are consumed before they are read by the host.
+        m_z, n_z = m_x, n_x
+        for i in range(4):
+            m_z = model(m_z, m_y)
+            n_z = np.maximum(np.matmul(n_z, n_y) + n_z, 0)
+            if i == 1:
+                check(m_z, n_z, rtol=1e-4, atol=1e-4)
+        raf._core.executor.synchronize()
+        check(m_z, n_z, rtol=1e-4, atol=1e-4)
+    finally:
+        raf._core.executor.set_async_interpret(False)
+    assert not raf._core.executor.is_async_interpret()
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
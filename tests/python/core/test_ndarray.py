@@ -10,6 +10,7 @@ import tvm
 from raf._core.value import TensorValue
 from raf._core.ndarray import ndarray
 from raf._ffi.value import ToTVM
+from raf.testing import get_testable_devices
 
 
 def test_requires_grad():
@@ -67,5 +68,36 @@ def test_bf16_ndarray():
     np.testing.assert_equal(n_x, n_y)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_dlpack_torch(device):
+    # pylint: disable=import-outside-toplevel
+    torch = pytest.importorskip("torch")
+    from raf._core.executor import VMExecutor
+
+    # A torch tensor is shared without copying, and kept alive by the array.
+    t_x = torch.arange(6, dtype=torch.float32, device=device).reshape(2, 3)
+    m_x = raf.from_dlpack(t_x)
+    t_x.add_(1)
+    np.testing.assert_equal(m_x.numpy(), t_x.cpu().numpy())
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            return raf.relu(raf.add(x, x))
+
+    model = Model()
+    model.infer_mode()
+    mod = model._internal(m_x).mod
+    vm = VMExecutor(mod, device).vm
+    # The VM consumes the torch tensor, and torch consumes the output in place.
+    t_y = torch.from_dlpack(vm.run(t_x))
+    assert t_y.device == t_x.device
+    del model, vm
+    np.testing.assert_allclose(t_y.cpu().numpy(), np.maximum(t_x.cpu().numpy() * 2, 0))
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -1,14 +1,50 @@
 # Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 # SPDX-License-Identifier: Apache-2.0
 
+import os
+import shutil
+import threading
 import pytest
 import numpy as np
+import tvm
 import raf
 from raf._core.executor import VMExecutor
 from raf.testing import check, compile_vm_model, run_vm_model, get_arr_addr, randn
 from raf.testing import get_testable_devices
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("num_workers", [1, 2])
+def test_batch_server(device, num_workers):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            return raf.relu(y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([4, 3], device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device)
+    server = raf._core.vm.BatchServer(
+        executor.vm, max_batch_size=4, max_delay_us=10000, buckets=[4], num_workers=num_workers
+    )
+    # The requests are batched and padded to the executable's batch size of 4.
+    n_xs = [np.random.randn(rows, 3).astype("float32") for rows in [1, 2, 1, 3, 2]]
+    ids = [server.submit(n_x) for n_x in n_xs]
+    for n_x, request_id in zip(n_xs, ids):
+        out = server.wait(request_id)
+        assert out.shape == n_x.shape
+        np.testing.assert_allclose(out.numpy(), np.maximum(n_x * 2, 0), rtol=1e-5, atol=1e-5)
+    check(server.infer(n_xs[0]), np.maximum(n_xs[0] * 2, 0))
+    server.stop()
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [[3, 3], [4, 4]])
 def test_vm(device, shape):
@@ -42,6 +78,297 @@ def test_vm(device, shape):
     np.testing.assert_allclose(m_z, ref_z, rtol=1e-5, atol=1e-5)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("enable_cuda_graph", [False, True])
+def test_update_constants(device, enable_cuda_graph):
+    # pylint: disable=protected-access
+    if enable_cuda_graph and device != "cuda":
+        pytest.skip("CUDA graph requires CUDA")
+    shape = (3, 5)
+    n_w = np.random.randn(1, 5).astype("float32")
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.add(x, raf.ir.const(n_w))
+    mod = raf.ir.IRModule()
+    mod["main"] = tvm.relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    with raf.ir.PassContext(opt_level=1):
+        executor = VMExecutor(mod, device, enable_cuda_graph=enable_cuda_graph)
+    constants = executor.executable.constants
+    index = [i for i, c in enumerate(constants) if getattr(c, "shape", None) == (1, 5)][0]
+
+    vm = executor.vm
+    m_x, n_x = randn(shape, device=device)
+    check(vm.run(m_x), n_x + n_w)
+    # The staged weights are not used until they are swapped in.
+    n_w2 = np.random.randn(1, 5).astype("float32")
+    vm.stage_constants({index: n_w2})
+    check(vm.run(m_x), n_x + n_w)
+    assert vm.swap_constants() == 1
+    check(vm.run(m_x), n_x + n_w2)
+    check(vm.get_constant(index), n_w2)
+    # The swapped out buffers are reused by the next update.
+    n_w3 = np.random.randn(1, 5).astype("float32")
+    assert vm.update_constants({index: n_w3}) == 1
+    check(vm.run(m_x), n_x + n_w3)
+    with pytest.raises(Exception):
+        vm.update_constants({index: np.zeros((2, 5), dtype="float32")})
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_share_constants(device):
+    # pylint: disable=protected-access
+    from raf._core.vm import VirtualMachine, get_shared_constant_stats, release_shared_constants
+
+    shape = (3, 5)
+    n_w = np.random.randn(1, 5).astype("float32")
+
+    def make_mod():
+        x = raf.ir.var("x", shape=shape)
+        y = raf.ir.op.add(x, raf.ir.const(n_w.copy()))
+        mod = raf.ir.IRModule()
+        mod["main"] = tvm.relay.Function([x], y)
+        return raf._ffi.pass_.ToANormalForm()(mod)
+
+    release_shared_constants()
+    base_count, base_bytes = get_shared_constant_stats()
+    m_x, n_x = randn(shape, device=device)
+    vms = []
+    # Two models compiled separately with the same weights, and two replicas of the first one.
+    with raf.ir.PassContext(opt_level=1):
+        exes = [VMExecutor(make_mod(), device).executable for _ in range(2)]
+    for exe in [exes[0], exes[0], exes[1]]:
+        vm = VirtualMachine(exe, raf.Device(device))
+        vm.share_constants()
+        check(vm.run(m_x), n_x + n_w)
+        vms.append(vm)
+    count, nbytes = get_shared_constant_stats()
+    assert count == base_count + 1
+    assert nbytes == base_bytes + n_w.nbytes
+    index = [i for i, c in enumerate(exes[0].constants) if getattr(c, "shape", None) == (1, 5)][0]
+    addrs = {get_arr_addr(vm.get_constant(index)) for vm in vms}
+    assert len(addrs) == 1
+    # The constants are released with the last VM using them.
+    del vm, vms
+    release_shared_constants()
+    assert get_shared_constant_stats() == (base_count, base_bytes)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_async_compile():
+    # pylint: disable=protected-access
+    from raf._core.vm import VirtualMachine
+
+    shape = (4, 16)
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.softmax(raf.ir.op.tanh(x))
+    mod = raf.ir.IRModule()
+    mod["main"] = tvm.relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    with raf.ir.PassContext(opt_level=1):
+        exe = VMExecutor(mod, "cuda").executable
+    vm = VirtualMachine(exe, raf.Device("cuda"))
+    vm.async_compile(num_threads=1)
+
+    m_x, n_x = randn(shape, device="cuda")
+    n_t = np.exp(np.tanh(n_x))
+    n_y = n_t / n_t.sum(axis=-1, keepdims=True)
+    # The TVM softmax is built in the background, and the cuDNN softmax is used meanwhile.
+    check(vm.run(m_x), n_y, rtol=1e-5, atol=1e-5)
+    vm.wait_async_compile()
+    check(vm.run(m_x), n_y, rtol=1e-5, atol=1e-5)
+    check(vm.run(m_x), n_y, rtol=1e-5, atol=1e-5)
+    stats = vm.async_compile_stats()
+    assert stats["num_compiled"] == stats["num_submitted"]
+    assert stats["num_failed"] == 0
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_numerics_watchdog(device):
+    # pylint: disable=protected-access
+    from raf._core.vm import VirtualMachine
+
+    shape = (4, 8)
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.op.tanh(raf.ir.op.log(x))
+    mod = raf.ir.IRModule()
+    mod["main"] = tvm.relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    with raf.ir.PassContext(opt_level=1):
+        exe = VMExecutor(mod, device).executable
+    vm = VirtualMachine(exe, raf.Device(device))
+    vm.watch_numerics()
+
+    n_x = np.random.uniform(1, 2, size=shape).astype("float32")
+    vm.run(raf.array(n_x, device=device))
+    report = vm.numerics_report()
+    assert report["num_steps"] == 1
+    assert report["num_bad_steps"] == 0
+    assert report["abs_max"] > 0
+
+    n_x[0, 0] = -1
+    vm.run(raf.array(n_x, device=device))
+    report = vm.numerics_report()
+    assert report["num_steps"] == 2
+    assert report["num_bad_steps"] == 1
+    # The NaN written by the log propagates through the tanh.
+    assert report["num_nonfinite"] == 2
+    assert "log" in report["first_op"]
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("depth", [1, 3])
+def test_run_pipelined(device, depth):
+    # pylint: disable=protected-access
+    from raf._core.vm import VirtualMachine
+
+    shape = (4, 8)
+    x = raf.ir.var("x", shape=shape)
+    y = raf.ir.var("y", shape=shape)
+    z = raf.ir.op.tanh(raf.ir.op.add(x, y))
+    mod = raf.ir.IRModule()
+    mod["main"] = tvm.relay.Function([x, y], tvm.relay.Tuple([z, x]))
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    with raf.ir.PassContext(opt_level=1):
+        exe = VMExecutor(mod, device).executable
+    vm = VirtualMachine(exe, raf.Device(device))
+
+    # The host inputs are uploaded and the outputs are downloaded in the order of the batches.
+    batches = [[np.random.randn(*shape).astype("float32") for _ in range(2)] for _ in range(5)]
+    outs = list(vm.run_pipelined(batches, depth=depth))
+    assert len(outs) == len(batches)
+    for out, (n_x, n_y) in zip(outs, batches):
+        check(out[0], np.tanh(n_x + n_y), rtol=1e-5, atol=1e-5)
+        check(out[1], n_x)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("buffer_kb", [40, 8])
+@pytest.mark.parametrize("loaded", [False, True])
+def test_weight_streaming(buffer_kb, loaded):
+    # pylint: disable=protected-access
+    from raf._core.vm import Executable, VirtualMachine
+
+    shape = (8, 64)
+    n_ws = [np.random.randn(64, 64).astype("float32") / 8 for _ in range(4)]
+    x = raf.ir.var("x", shape=shape)
+    y = x
+    for n_w in n_ws:
+        y = raf.ir.op.relu(raf.ir.op.matmul(y, raf.ir.const(n_w)))
+    mod = raf.ir.IRModule()
+    mod["main"] = tvm.relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    with raf.ir.PassContext(opt_level=1):
+        exe = VMExecutor(mod, "cuda").executable
+    if loaded:
+        # The functions of a loaded executable are decoded lazily.
+        exe = Executable.load_exec(*exe.save())
+
+    m_x, n_x = randn(shape, device="cuda")
+    n_y = n_x
+    for n_w in n_ws:
+        n_y = np.maximum(np.matmul(n_y, n_w), 0)
+    vm = VirtualMachine(exe, raf.Device("cuda"))
+    vm.stream_weights(buffer_kb / 1024, min_kb=4)
+    for _ in range(3):
+        check(vm.run(m_x), n_y, rtol=1e-4, atol=1e-4)
+    stats = vm.weight_streaming_stats()
+    assert stats["num_loads"] == 3 * len(n_ws)
+    if buffer_kb >= 16:
+        # The weights are prefetched into the buffer, which holds two of them.
+        assert stats["num_prefetched"] > 0
+    else:
+        # The weights do not fit into the buffer, so they are copied on the compute stream.
+        assert stats["num_fallbacks"] == 3 * len(n_ws)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("num_iters", [0, 3])
+def test_tail_call_loop(device, num_iters):
+    # pylint: disable=protected-access, too-many-locals
+    from raf._core.vm import VirtualMachine
+
+    shape = (4, 4)
+    ty = tvm.relay.TensorType(shape)
+    i_ty = tvm.relay.TensorType((), dtype="int64")
+    loop = tvm.relay.GlobalVar("loop")
+
+    def make_params():
+        return [
+            raf.ir.var("i", i_ty),
+            raf.ir.var("n", i_ty),
+            raf.ir.var("x", ty),
+            raf.ir.var("w", ty),
+        ]
+
+    # The square of w does not change across the iterations, so it is hoisted before the loop.
+    i, n, x, w = make_params()
+    one = raf.ir.const(np.array(1, dtype="int64"))
+    y = raf.ir.op.tanh(raf.ir.op.matmul(x, raf.ir.op.multiply(w, w)))
+    then_ = tvm.relay.Call(loop, [raf.ir.op.add(i, one), n, y, w])
+    body = tvm.relay.If(raf.ir.op.less(i, n), then_, x)
+    mod = raf.ir.IRModule()
+    mod[loop] = tvm.relay.Function([i, n, x, w], body, ty)
+    params = make_params()
+    mod["main"] = tvm.relay.Function(params, tvm.relay.Call(loop, params), ty)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    exe = VMExecutor(mod, device).executable
+    # The tail call jumps back instead of pushing a frame.
+    assert "goto -" in exe.bytecode
+
+    n_w = np.random.randn(*shape).astype("float32")
+    m_x, n_x = randn(shape, device=device)
+    n_y = n_x
+    for _ in range(num_iters):
+        n_y = np.tanh(np.matmul(n_y, n_w * n_w))
+    args = [
+        raf.array(np.array(0, dtype="int64"), device=device),
+        raf.array(np.array(num_iters, dtype="int64"), device=device),
+        m_x,
+        raf.array(n_w, device=device),
+    ]
+    vm = VirtualMachine(exe, raf.Device(device))
+    check(vm.run(*args), n_y, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("loaded", [False, True])
+def test_l2_persistence(loaded):
+    # pylint: disable=protected-access
+    from raf._core.vm import Executable, VirtualMachine
+
+    shape = (8, 64)
+    n_w = np.random.randn(64, 64).astype("float32") / 8
+    x = raf.ir.var("x", shape=shape)
+    w = raf.ir.const(n_w)
+    y = x
+    for _ in range(4):
+        y = raf.ir.op.relu(raf.ir.op.matmul(y, w))
+    mod = raf.ir.IRModule()
+    mod["main"] = tvm.relay.Function([x], y)
+    mod = raf._ffi.pass_.ToANormalForm()(mod)
+    with raf.ir.PassContext(opt_level=1):
+        exe = VMExecutor(mod, "cuda").executable
+    if loaded:
+        # The functions of a loaded executable are decoded lazily.
+        exe = Executable.load_exec(*exe.save())
+
+    m_x, n_x = randn(shape, device="cuda")
+    n_y = n_x
+    for _ in range(4):
+        n_y = np.maximum(np.matmul(n_y, n_w), 0)
+    vm = VirtualMachine(exe, raf.Device("cuda"))
+    vm.persist_l2(1, min_reuses=4)
+    for _ in range(2):
+        check(vm.run(m_x), n_y, rtol=1e-4, atol=1e-4)
+    stats = vm.l2_persistence_stats()
+    # The weight is read by the four matmuls.
+    assert stats["num_hot_tensors"] == 1
+    # The older GPUs do not set aside the cache, and no window is set.
+    assert stats["num_windows"] == (2 if stats["persisting_bytes"] > 0 else 0)
+    vm.persist_l2(0)
+    assert vm.l2_persistence_stats()["num_hot_tensors"] == 0
+
+
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("shape", [[3, 3], [4, 4]])
 def test_cuda_graph(shape):
@@ -77,6 +404,198 @@ def test_cuda_graph(shape):
     assert executable.globals[0] == "main"
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_concurrent_cuda_graph():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    import threading
+
+    shape = [4, 4]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            z = raf.add(x, y)
+            return z
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    num_ctx = 3
+    m_xs = [randn(shape, device=dev)[0] for _ in range(num_ctx)]
+    mod = model._internal(m_xs[0]).mod
+    executor = VMExecutor(mod, dev, enable_cuda_graph=True, max_concurrency=num_ctx)
+    ctxs = [executor.vm.prepare_context("main", m_x) for m_x in m_xs]
+    outs = [None] * num_ctx
+
+    def _run(idx):
+        outs[idx] = executor.vm._run(ctxs[idx]).numpy()
+
+    threads = [threading.Thread(target=_run, args=(i,)) for i in range(num_ctx)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for m_x, out in zip(m_xs, outs):
+        np.testing.assert_allclose(out, model(m_x).numpy(), rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_managed_pool():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    from raf._ffi.memory_pool import InitPool, RemovePool
+
+    shape = [64, 64]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            return raf.multiply(z, x)
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=dev)
+    InitPool(raf.Device(dev), "managed_pool")
+    try:
+        out = run_vm_model(model, dev, [m_x])
+        check(out, model(m_x))
+    finally:
+        RemovePool(raf.Device(dev))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_virtual_pool():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    from raf._ffi.memory_pool import InitPool, RemovePool, Compact
+    from raf._ffi.memory_pool.virtual_pool import GetStats
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            return raf.multiply(z, x)
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    InitPool(raf.Device(dev), "virtual_pool")
+    try:
+        # The shapes change across the runs, which are served by the same segments.
+        for length in [64, 256, 32]:
+            m_x, _ = randn([length, 64], device=dev)
+            out = run_vm_model(model, dev, [m_x])
+            check(out, model(m_x))
+        del out, m_x
+        Compact(raf.Device(dev))
+        stats = GetStats(raf.Device(dev))
+        assert stats["mapped"].value <= stats["frontier"].value <= stats["reserved"].value
+    finally:
+        RemovePool(raf.Device(dev))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_cuda_graph_shape_cache():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(x)
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn([8, 8], device=dev)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, dev, enable_cuda_graph=True)
+    executor.vm.set_cuda_graph_cache(2, buckets=[8])
+
+    for length in [8, 3, 7, 2]:
+        m_x, n_x = randn([length, 8], device=dev)
+        m_y = executor.vm.run(m_x).numpy()
+        assert m_y.shape[0] == 8
+        np.testing.assert_allclose(m_y[:length], np.maximum(n_x, 0), rtol=1e-5, atol=1e-5)
+        np.testing.assert_allclose(m_y[length:], 0, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("num_streams", [0, 2])
+def test_cuda_graph_multi_stream(num_streams):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    from raf._ffi.stream_pool import Configure
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            p_0 = raf.atan(x)
+            p_1 = raf.atan(raf.atan(x))
+            p_2 = raf.atan(raf.atan(raf.atan(x)))
+            return raf.concatenate([p_0, p_1, p_2])
+
+    dev = "cuda"
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn([2, 2], device=dev)
+    mod = model._internal(m_x).mod
+    # The schedule of 3 streams shares the configured compute streams, if any.
+    Configure(raf.Device(dev), 1, num_streams, 0, True)
+    try:
+        config = {"raf.stream_schedule.policy": "wavefront"}
+        with raf.ir.PassContext(opt_level=2, config=config):
+            executor = VMExecutor(mod, dev, enable_cuda_graph=True)
+            for _ in range(2):
+                m_y = executor.vm.run(m_x)
+        n_atan = np.arctan
+        n_y = np.concatenate([n_atan(n_x), n_atan(n_atan(n_x)), n_atan(n_atan(n_atan(n_x)))])
+        check(m_y, n_y)
+    finally:
+        Configure(raf.Device(dev), 1, 0, 0, False)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_run_prefetched(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [4, 4]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            return raf.relu(y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    executor = VMExecutor(mod, device)
+    n_xs = [np.random.randn(*shape).astype("float32") for _ in range(5)]
+    outs = list(executor.vm.run_prefetched([[n_x] for n_x in n_xs]))
+    assert len(outs) == len(n_xs)
+    for n_x, out in zip(n_xs, outs):
+        np.testing.assert_allclose(out.numpy(), np.maximum(n_x * 2, 0), rtol=1e-5, atol=1e-5)
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [[3, 3], [4, 4]])
 def test_tuple(device, shape):
@@ -218,5 +737,599 @@ def test_reshape():
     check(out, ref_out)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_fast_dispatch(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [4, 4]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = x
+            for _ in range(16):
+                y = raf.add(y, x)
+            return raf.split(y, indices_or_sections=2, axis=0)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    ref_executor = VMExecutor(mod, device)
+    fast_executor = VMExecutor(mod, device, fast_dispatch=True)
+    ref_outs = ref_executor.make_executor()(m_x)
+    fast_outs = fast_executor.make_executor()(m_x)
+    for ref_out, fast_out in zip(ref_outs, fast_outs):
+        check(ref_out, fast_out)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_static_op_env(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [3, 3]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            return raf.multiply(z, y)
+
+    model = Model()
+    model.infer_mode()
+    executor = None
+    for _ in range(3):
+        m_x, _ = randn(shape, device=device)
+        if executor is None:
+            mod = model._internal(m_x).mod
+            executor = VMExecutor(mod, device, fast_dispatch=True, static_op_env=True)
+        m_z = executor.vm.run(m_x)
+        ref_z = model(m_x)
+        check(m_z, ref_z)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_precompute_args(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [3, 4]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            # The axis and the keepdims are constant args of the op.
+            z = raf.sum(raf.relu(y), axis=1, keepdims=True)
+            return raf.multiply(z, y)
+
+    model = Model()
+    model.infer_mode()
+    executor = None
+    for _ in range(3):
+        m_x, _ = randn(shape, device=device)
+        if executor is None:
+            mod = model._internal(m_x).mod
+            executor = VMExecutor(mod, device, precompute_args=True)
+        m_z = executor.vm.run(m_x)
+        ref_z = model(m_x)
+        check(m_z, ref_z)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_fuse_instructions(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [3, 3]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            z = raf.relu(y)
+            return raf.multiply(z, y)
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    disabled_pass = ["FuseTVM", "FuseDialect"]
+    with tvm.transform.PassContext(
+        opt_level=3, disabled_pass=disabled_pass, config={"raf.vm.fuse_instructions": False}
+    ):
+        ref_executor = VMExecutor(mod, device)
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass):
+        executor = VMExecutor(mod, device)
+
+    # No Free is left right after an InvokeJit.
+    def get_instrs(executable):
+        lines = executable.bytecode.splitlines()
+        return [line.split("# ", 1)[-1] for line in lines if "# " in line and ": " in line]
+
+    instrs = get_instrs(executor.executable)
+    ref_instrs = get_instrs(ref_executor.executable)
+    for prev, curr in zip(instrs[:-1], instrs[1:]):
+        assert not (prev.startswith("invoke_jit ") and curr.startswith("free "))
+    num_ref_frees = sum(instr.startswith("free ") for instr in ref_instrs)
+    assert len(instrs) <= len(ref_instrs) and len(ref_instrs) - len(instrs) <= num_ref_frees
+
+    # The superinstructions survive a serialization round trip.
+    code, lib = executor.executable.save()
+    des_exec = raf._core.vm.Executable.load_exec(code, lib)
+    assert des_exec.bytecode == executor.executable.bytecode
+    des_vm = raf._core.vm.VirtualMachine(des_exec, device)
+
+    ref_z = ref_executor.vm.run(m_x)
+    check(executor.vm.run(m_x), ref_z)
+    check(des_vm.run(m_x), ref_z)
+
+
+def get_reg_file_size(executable):
+    for line in executable.bytecode.splitlines():
+        if line.startswith("# reg file size = "):
+            return int(line.split("=")[-1])
+    return None
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_reuse_registers(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [3, 3]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            for _ in range(4):
+                y = raf.relu(raf.add(y, x))
+            return y
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    disabled_pass = ["FuseTVM", "FuseDialect"]
+    with tvm.transform.PassContext(
+        opt_level=3, disabled_pass=disabled_pass, config={"raf.vm.reuse_registers": False}
+    ):
+        ref_executor = VMExecutor(mod, device)
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass):
+        executor = VMExecutor(mod, device)
+    assert get_reg_file_size(executor.executable) < get_reg_file_size(ref_executor.executable)
+    check(executor.vm.run(m_x), ref_executor.vm.run(m_x))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_reuse_registers_multi_stream():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            p_0 = raf.atan(x)
+            p_1 = raf.atan(raf.atan(x))
+            p_2 = raf.atan(raf.atan(raf.atan(x)))
+            return raf.concatenate([p_0, p_1, p_2])
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn([2, 2], device="cuda")
+    mod = model._internal(m_x).mod
+    config = {"raf.stream_schedule.policy": "wavefront"}
+    with raf.ir.PassContext(opt_level=2, config={**config, "raf.vm.reuse_registers": False}):
+        ref_executor = VMExecutor(mod, "cuda")
+    with raf.ir.PassContext(opt_level=2, config=config):
+        executor = VMExecutor(mod, "cuda")
+    # A register overwritten on one stream may drop a tensor still read on another one, so the
+    # registers of the multi-stream functions are not reused.
+    assert "cuda_set_stream" in executor.executable.bytecode
+    assert get_reg_file_size(executor.executable) == get_reg_file_size(ref_executor.executable)
+    n_atan = np.arctan
+    n_y = np.concatenate([n_atan(n_x), n_atan(n_atan(n_x)), n_atan(n_atan(n_atan(n_x)))])
+    check(executor.vm.run(m_x), n_y)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_save_load_stream_barrier():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            p_0 = raf.atan(x)
+            p_1 = raf.atan(raf.atan(x))
+            return raf.concatenate([p_0, p_1])
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn([2, 2], device="cuda")
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(opt_level=2, config={"raf.stream_schedule.policy": "wavefront"}):
+        executor = VMExecutor(mod, "cuda")
+    assert "cuda_stream_barrier" in executor.executable.bytecode
+
+    # The barriers are not mistaken for Fatal after a serialization round trip.
+    code, lib = executor.executable.save()
+    des_exec = raf._core.vm.Executable.load_exec(code, lib)
+    assert des_exec.bytecode == executor.executable.bytecode
+    des_vm = raf._core.vm.VirtualMachine(des_exec, "cuda")
+    n_y = np.concatenate([np.arctan(n_x), np.arctan(np.arctan(n_x))])
+    check(des_vm.run(m_x), n_y)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_static_arena(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [3, 3]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            for _ in range(4):
+                y = raf.relu(raf.add(y, x))
+            return y
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    disabled_pass = ["FuseTVM", "FuseDialect"]
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass):
+        ref_executor = VMExecutor(mod, device)
+    with tvm.transform.PassContext(
+        opt_level=3, disabled_pass=disabled_pass, config={"raf.vm.static_arena": True}
+    ):
+        executor = VMExecutor(mod, device)
+
+    # The intermediate storages are placed in the arena, but the returned one is not.
+    lines = executor.executable.bytecode.splitlines()
+    storages = [line for line in lines if "alloc_storage " in line]
+    placed = [line for line in storages if " arena[" in line]
+    assert placed and len(placed) < len(storages)
+    assert "arena[" not in ref_executor.executable.bytecode
+
+    # The placement survives a serialization round trip.
+    code, lib = executor.executable.save()
+    des_exec = raf._core.vm.Executable.load_exec(code, lib)
+    assert des_exec.bytecode == executor.executable.bytecode
+    des_vm = raf._core.vm.VirtualMachine(des_exec, device)
+
+    ref_z = ref_executor.vm.run(m_x)
+    for _ in range(2):
+        check(executor.vm.run(m_x), ref_z)
+    check(des_vm.run(m_x), ref_z)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_early_free(device):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    shape = [4, 4]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.split(raf.add(x, x), 2)
+            z = raf.relu(y[0])
+            return raf.multiply(z, y[1])
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    disabled_pass = ["FuseTVM", "FuseDialect"]
+    with tvm.transform.PassContext(
+        opt_level=3, disabled_pass=disabled_pass, config={"raf.vm.early_free": False}
+    ):
+        ref_executor = VMExecutor(mod, device)
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass):
+        executor = VMExecutor(mod, device)
+    assert "kill $" in executor.executable.bytecode
+    assert "kill $" not in ref_executor.executable.bytecode
+
+    # The kills survive a serialization round trip.
+    code, lib = executor.executable.save()
+    des_exec = raf._core.vm.Executable.load_exec(code, lib)
+    assert des_exec.bytecode == executor.executable.bytecode
+    des_vm = raf._core.vm.VirtualMachine(des_exec, device)
+
+    ref_z = ref_executor.vm.run(m_x)
+    check(executor.vm.run(m_x), ref_z)
+    check(des_vm.run(m_x), ref_z)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_save_to_file(device, tmp_path):
+    shape = [3, 3]
+    mul_op = raf._ffi.op.GetOp("raf.op.multiply")
+    n_c = np.random.randn(*shape).astype("float32")
+
+    data_x = raf.ir.var("x", shape=shape, dtype="float32")
+    sb = raf.ir.ScopeBuilder()
+    out = sb.let("a1", tvm.relay.Call(mul_op, [data_x, raf.ir.const(raf.array(n_c))]))
+    sb.ret(out)
+    mod = tvm.IRModule.from_expr(tvm.relay.Function([data_x], sb.get()))
+    executable = raf._core.vm.compile(mod, device)
+
+    path = str(tmp_path / "model.ro")
+    lib = executable.save_to_file(path)
+    loaded = raf._core.vm.Executable.load_from_file(path, lib)
+    assert loaded.bytecode == executable.bytecode
+
+    m_x, n_x = randn(shape, device=device)
+    out = raf._core.vm.VirtualMachine(loaded, device).run(m_x)
+    check(out, n_x * n_c)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("background", [False, True])
+def test_lazy_load(device, background):
+    shape = [3, 3]
+    mul_op = raf._ffi.op.GetOp("raf.op.multiply")
+    n_c = np.random.randn(*shape).astype("float32")
+
+    data_x = raf.ir.var("x", shape=shape, dtype="float32")
+    sb = raf.ir.ScopeBuilder()
+    out = sb.let("a1", tvm.relay.Call(mul_op, [data_x, raf.ir.const(raf.array(n_c))]))
+    sb.ret(out)
+    mod = tvm.IRModule.from_expr(tvm.relay.Function([data_x], sb.get()))
+    executable = raf._core.vm.compile(mod, device)
+    code, lib = executable.save()
+
+    # The functions are decoded on the first run.
+    m_x, n_x = randn(shape, device=device)
+    vm = raf._core.vm.VirtualMachine(raf._core.vm.Executable.load_exec(code, lib), device)
+    check(vm.run(m_x), n_x * n_c)
+    check(vm.run(m_x), n_x * n_c)
+
+    # The functions are decoded ahead of the first run.
+    loaded = raf._core.vm.Executable.load_exec(code, lib)
+    vm = raf._core.vm.VirtualMachine(loaded, device)
+    vm.warmup(background)
+    check(vm.run(m_x), n_x * n_c)
+    assert loaded.bytecode == executable.bytecode
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_build_op_envs(device, tmp_path):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    # Use a distinct shape so that the kernel is not built by the other tests.
+    shape = [4, 19]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.add(x, x))
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    executable = raf._core.vm.compile(mod, device)
+
+    bundle = str(tmp_path / "kernels")
+    vm = raf._core.vm.VirtualMachine(executable, device)
+    try:
+        vm.build_op_envs(m_x, bundle=bundle)
+    finally:
+        raf._core.vm.set_kernel_bundle(None)
+    assert os.path.isdir(bundle)
+    # The fused TVM kernel is linked into a bundle with an index.
+    index = os.path.join(bundle, "tvm_" + device, "bundles", "0", "index.txt")
+    with open(index) as index_file:
+        assert len(index_file.readlines()) == 1
+    check(vm.run(m_x), np.maximum(n_x + n_x, 0))
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_load_deployment(device, tmp_path):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    # Use a distinct shape so that the kernel is not built by the other tests.
+    shape = [5, 23]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.multiply(x, x))
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn(shape, device=device)
+    mod = model._internal(m_x).mod
+    executable = raf._core.vm.compile(mod, device)
+
+    bundle = str(tmp_path / "kernels")
+    path = str(tmp_path / "model.ro")
+    vm = raf._core.vm.VirtualMachine(executable, device)
+    try:
+        vm.build_op_envs(m_x, bundle=bundle)
+        executable.save_to_file(path)
+        # The executable and the bundle are all a deployment needs.
+        loaded = raf._core.vm.Executable.load_deployment(path, bundle)
+        check(raf._core.vm.VirtualMachine(loaded, device).run(m_x), np.maximum(n_x * n_x, 0))
+    finally:
+        raf._core.vm.set_kernel_bundle(None)
+    with pytest.raises(Exception):
+        raf._core.vm.Executable.load_deployment(path, str(tmp_path / "missing"))
+
+
+@pytest.mark.parametrize("backend", ["dir", "funcs"])
+def test_remote_cache(backend, tmp_path):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    # Use a distinct shape of each case so that the kernel is not cached in memory.
+    shape = [5, 23] if backend == "dir" else [5, 29]
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.multiply(x, x))
+
+    remote = str(tmp_path / "remote")
+    uploaded = []
+
+    def fetch(key, local_dir):
+        path = os.path.join(remote, key)
+        if not os.path.isdir(path):
+            return False
+        shutil.copytree(path, local_dir, dirs_exist_ok=True)
+        return True
+
+    def upload(key, local_dir):
+        shutil.copytree(local_dir, os.path.join(remote, key), dirs_exist_ok=True)
+        uploaded.append(key)
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn(shape, device="cpu")
+    raf._core.vm.set_kernel_bundle(str(tmp_path / "node0"))
+    if backend == "dir":
+        raf._core.vm.set_remote_cache(path=remote)
+    else:
+        raf._core.vm.set_remote_cache(fetch=fetch, upload=upload)
+    try:
+        v_y = run_vm_model(model, "cpu", [m_x])
+        check(v_y, np.maximum(n_x * n_x, 0))
+        # The built kernel is uploaded, and published in the manifest of the model.
+        assert raf._core.vm.publish_remote_cache("model") > 0
+        assert os.listdir(os.path.join(remote, "tvm_cpu"))
+        assert backend == "dir" or uploaded
+        # Another node fetches the kernel into its empty bundle.
+        node1 = str(tmp_path / "node1")
+        raf._core.vm.set_kernel_bundle(node1)
+        assert raf._core.vm.prefetch_remote_cache("model") > 0
+        assert os.listdir(os.path.join(node1, "tvm_cpu"))
+        assert raf._core.vm.prefetch_remote_cache("model") == 0
+    finally:
+        raf._core.vm.set_remote_cache()
+        raf._core.vm.set_kernel_bundle(None)
+
+
+@pytest.mark.parametrize("num_threads", [1, 2])
+def test_num_threads(num_threads):
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            y = raf.relu(raf.matmul(x, w))
+            return raf.sum(raf.multiply(y, y), axis=1)
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn((32, 64))
+    m_w, n_w = randn((64, 48))
+    mod = model._internal(m_x, m_w).mod
+    n_y = np.maximum(np.matmul(n_x, n_w), 0)
+    n_y = np.sum(n_y * n_y, axis=1)
+
+    # Each VM runs the CPU kernels with its own number of threads on its own thread.
+    def run(outs, idx, threads):
+        executor = VMExecutor(mod, "cpu", num_threads=threads)
+        outs[idx] = executor.make_executor()(m_x, m_w)
+
+    outs = [None, None]
+    workers = [threading.Thread(target=run, args=(outs, i, num_threads + i)) for i in range(2)]
+    for worker in workers:
+        worker.start()
+    for worker in workers:
+        worker.join()
+    for out in outs:
+        check(out, n_y, rtol=1e-4, atol=1e-4)
+
+
+def test_numa_node():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.add(x, x))
+
+    model = Model()
+    model.infer_mode()
+    m_x, n_x = randn((256, 256))
+    mod = model._internal(m_x).mod
+    num_nodes = raf._ffi.device_api.cpu.GetNumNumaNodes()
+    # The VMs bound to different nodes run on their own threads.
+    def run(outs, node):
+        executor = VMExecutor(mod, "cpu", numa_node=node)
+        outs[node] = (executor.make_executor()(m_x), raf._ffi.device_api.cpu.GetNumaNode())
+
+    outs = [None] * num_nodes
+    workers = [threading.Thread(target=run, args=(outs, node)) for node in range(num_nodes)]
+    for worker in workers:
+        worker.start()
+    for worker in workers:
+        worker.join()
+    for node, (out, bound_node) in enumerate(outs):
+        assert bound_node == node
+        check(out, np.maximum(n_x + n_x, 0))
+
+
+def test_executable_cache():
+    # pylint: disable=protected-access, attribute-defined-outside-init, no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.subtract(x, x))
+
+    model = Model()
+    model.infer_mode()
+    raf._core.vm.clear_executable_cache()
+    # Bucketed batch shapes: each shape is traced and compiled once.
+    for batch in [2, 4, 2, 4, 2]:
+        m_x, n_x = randn([batch, 7], device="cpu")
+        mod = model._internal(m_x).mod
+        out = VMExecutor(mod, "cpu").make_executor()(m_x)
+        check(out, np.maximum(n_x - n_x, 0))
+    stats = raf._core.vm.get_executable_cache_stats()
+    assert stats == {"size": 2, "hits": 3, "misses": 2}, stats
+    # The pass config is a part of the key.
+    with raf.ir.PassContext(config={"raf.vm.fuse_instructions": False}):
+        VMExecutor(mod, "cpu")
+    assert raf._core.vm.get_executable_cache_stats()["misses"] == 3
+    raf._core.vm.set_executable_cache_capacity(1)
+    assert raf._core.vm.get_executable_cache_stats()["size"] == 1
+    raf._core.vm.set_executable_cache_capacity(16)
+    raf._core.vm.clear_executable_cache()
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -51,15 +51,49 @@ def test_vm_debugger(device, shape):
     check(outs[1], ref_z)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_vm_debugger_timing(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):  # pylint: disable=no-self-use
+            y = raf.add(x, x)
+            z = raf.matmul(y, x)
+            return z
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((16, 16), device=device)
+    mod = model._internal(m_x).mod
+    with raf.ir.PassContext(opt_level=1):
+        executor = VMDebugExecutor(mod, device, timing_only=True)
+
+    func = executor.make_executor()
+    for _ in range(3):
+        m_z = func(m_x).numpy()
+    check(m_z, model(m_x).numpy(), rtol=1e-5, atol=1e-5)
+    # No values are captured in the timing mode.
+    names, ins, outs = executor.get_interm_tensors()
+    assert not names and not ins and not outs
+    lats = executor.get_op_latency()
+    assert len(lats) == 2
+    for lat in lats:
+        assert lat["count"] == 3
+        assert lat["total_ms"] >= lat["max_ms"] >= lat["min_ms"] >= 0
+        assert lat["shapes"] == "[(16,16),(16,16)],(16,16)"
+    assert lats[0]["total_ms"] >= lats[1]["total_ms"]
+    executor.reset()
+    assert not executor.get_op_latency()
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("pool_name", ["no_pool", "page_unit_pool"])
 def test_vm_memory_profiler(device, pool_name):
     # pylint: disable=protected-access
-    if device == "cuda" and pool_name == "page_unit_pool" and float(raf.build.with_cuda()) >= 11.3:
-        pytest.skip(
-            "Skip this because VM will use cudaAllocAsync to allocate memory. The "
-            "underlying cuda memory pool is not compatible with raf page_unit_pool"
-        )
 
     class Model(raf.Model):
         # pylint: disable=attribute-defined-outside-init,no-self-use
@@ -113,5 +147,56 @@ def test_vm_memory_profiler(device, pool_name):
             assert peak_memory == 0
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_vm_tensor_timeline(device):
+    # pylint: disable=protected-access
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init,no-self-use
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.matmul(x, x)
+            z = raf.relu(y)
+            return z
+
+    model = Model()
+    m_x, _ = randn((16, 16), device=device)
+    mod = model._internal(m_x).mod
+    with tvm.transform.PassContext(opt_level=0):
+        raf.utils.memory_profiler.reset()
+        raf.utils.memory_profiler.start()
+        VMExecutor(mod, device).make_executor()(m_x)
+        raf.utils.memory_profiler.stop()
+
+    timeline = raf.utils.memory_profiler.get_tensor_timeline(raf.Device(device))
+    steps = raf.utils.memory_profiler.get_op_memory_steps(raf.Device(device))
+    ops = [raf.utils.trace_analysis.normalize_op_name(s["op"]) for s in steps]
+    assert ops == ["matmul", "relu"], ops
+
+    # Each output is attributed to the op and the IR var that produce it.
+    produced = {raf.utils.trace_analysis.normalize_op_name(t["op"]): t for t in timeline if t["op"]}
+    assert set(produced.keys()) == {"matmul", "relu"}
+    for lifetime in produced.values():
+        assert lifetime["nbytes"] >= 16 * 16 * 4
+        assert lifetime["tensors"] and not lifetime["tensors"][0].startswith("%")
+        assert lifetime["pc"] >= 0 and lifetime["register"] >= 0
+    # The output of matmul is dead after relu, while the output of relu is returned.
+    assert produced["matmul"]["free_us"] >= produced["matmul"]["alloc_us"] > 0
+    assert steps[1]["live_bytes"] >= produced["relu"]["nbytes"]
+
+    events = raf.utils.memory_profiler.tensor_timeline_trace_events(timeline, steps)
+    assert len([e for e in events if e["ph"] == "b"]) == len(timeline)
+    assert len([e for e in events if e["ph"] == "C"]) == len(steps)
+
+    estimate = [("raf.op.matmul", 0.0), ("raf.op.relu", 0.0)]
+    rows = raf.utils.memory_profiler.diff_with_estimate(estimate, raf.Device(device))
+    assert [row["estimated_mb"] for row in rows] == [0.0, 0.0]
+    assert all(row["diff_mb"] == row["measured_mb"] for row in rows)
+    raf.utils.memory_profiler.reset()
+    assert not raf.utils.memory_profiler.get_tensor_timeline()
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
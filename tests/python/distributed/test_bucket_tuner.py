@@ -0,0 +1,58 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+from unittest.mock import patch
+import pytest
+
+from raf.distributed import BucketSizeTuner
+
+
+class MockConfig:
+    def __init__(self, enable=True):
+        self.enable_auto_dp_profiling = enable
+        self.auto_dp_profiling_start_iter = 2
+        self.auto_dp_profiling_end_iter = 7
+        self.group_bucket_size = 5000000000
+
+
+class MockComm:
+    def __init__(self):
+        self.size = 1
+
+
+@patch("raf.distributed.bucket_tuner.get_communicator")
+@patch("raf.distributed.bucket_tuner.get_config")
+@patch("raf.distributed.bucket_tuner.ffi")
+@pytest.mark.parametrize("enable", [True, False])
+def test_bucket_tuner(mock_ffi, mock_get_config, mock_get_comm, enable):
+    mock_get_config.return_value = MockConfig(enable)
+    mock_get_comm.return_value = MockComm()
+    candidates = [100, 200, 300]
+    # The latency of each candidate, where the first (warm-up) iteration is slow.
+    latency = {100: 3.0, 200: 1.0, 300: 2.0, 5000000000: 4.0}
+    tuner = BucketSizeTuner(candidates)
+    bucket_sizes = []
+    num_recompiles = 0
+    for _ in range(10):
+        num_recompiles += tuner.begin()
+        bucket_sizes.append(tuner.curr)
+        warmup = len(bucket_sizes) < 2 or bucket_sizes[-1] != bucket_sizes[-2]
+        tuner.end(latency[tuner.curr] + (10.0 if warmup else 0.0))
+    if not enable:
+        assert num_recompiles == 0
+        assert all(size == 5000000000 for size in bucket_sizes)
+        return
+    # 2 iterations for each candidate in [2, 7], and the best candidate afterwards.
+    assert bucket_sizes == [5000000000] * 2 + [100, 100, 200, 200, 300, 300] + [200] * 2
+    assert num_recompiles == 4
+    mock_ffi.GroupBucketSize.assert_called_with(200)
+
+
+@patch("raf.distributed.bucket_tuner.get_config")
+def test_too_few_iterations(mock_get_config):
+    mock_get_config.return_value = MockConfig()
+    with pytest.raises(ValueError):
+        BucketSizeTuner(list(range(1, 10)))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
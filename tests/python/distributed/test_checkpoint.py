@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init
+import os
+
+import numpy as np
+import pytest
+
+import raf
+from raf import distributed as dist
+from raf.optim.utils import split_ndarray_with_padding
+from raf.testing import check
+
+
+class ShardedModel(raf.Model):
+    def build(self, size):
+        self.w = raf.array(np.zeros((5, 2), dtype="float32"))
+        # The ZeRO partition of the SGD variant of w.
+        setattr(self, "w.sgd_v", raf.array(np.zeros((-(-5 // size), 2), dtype="float32")))
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.add(x, self.w)
+
+
+def test_save_load_with_resharding(tmp_path):
+    dcfg = dist.get_config()
+    comm = dist.get_communicator()
+    if not isinstance(comm, dist.communicator.VoidCommunicator) or comm.size != 1:
+        pytest.skip("The test changes the world of a single-process VoidCommunicator")
+    zero_opt_level = dcfg.zero_opt_level
+    dcfg.zero_opt_level = 1
+    dcfg.enable_elastic = True
+    # The generations must be greater than the ones of the other tests in the process.
+    generation = 100
+    path = str(tmp_path / "ckpt")
+    try:
+        w_np = np.random.randn(5, 2).astype("float32")
+        v_np = np.random.randn(5, 2).astype("float32")
+        # Each rank of a world of 2 ranks saves its partition, one after another.
+        for rank in range(2):
+            generation += 1
+            dist.rebuild(generation, 2, rank, 2, rank)
+            model = ShardedModel(2)
+            model.w[:] = w_np
+            getattr(model, "w.sgd_v")[:] = split_ndarray_with_padding(v_np, 2)[rank]
+            dist.save_checkpoint(model, path, step=3).wait()
+        assert sorted(os.listdir(path)) == ["manifest.json", "shard_0.bin", "shard_1.bin"]
+
+        # Each rank of a world of 3 ranks loads the re-partitioned states.
+        for rank in range(3):
+            generation += 1
+            dist.rebuild(generation, 3, rank, 3, rank)
+            model = ShardedModel(3)
+            assert dist.load_checkpoint(model, path) == 3
+            check(model.w, w_np)
+            check(getattr(model, "w.sgd_v"), split_ndarray_with_padding(v_np, 3)[rank])
+
+        # A single rank loads the full states.
+        generation += 1
+        dist.rebuild(generation, 1, 0, 1, 0)
+        model = ShardedModel(1)
+        assert dist.load_checkpoint(model, path) == 3
+        check(getattr(model, "w.sgd_v"), v_np)
+    finally:
+        dist.rebuild(generation + 1, 1, 0, 1, 0)
+        dcfg.zero_opt_level = zero_opt_level
+        dcfg.enable_elastic = False
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
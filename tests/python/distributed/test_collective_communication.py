@@ -12,10 +12,12 @@ import os
 import sys
 import pytest
 import numpy as np
+import tvm
 
 import raf
 from raf import distributed as dist
 from raf._core.ndarray import Symbol
+from raf._core.executor import VMExecutor
 from raf.testing import check, get_dist_comm_info, skip_dist_test, run_vm_model, run_model
 
 SKIP_REASON = "Distribution is not enabled or #rank is not expected"
@@ -121,6 +123,136 @@ def test_allreduce_with_tensor(dtype, computation):
         check(y, target_y)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("fuse_instructions", [False, True])
+def test_allreduce_in_cuda_graph(fuse_instructions):
+    """Testing allreduce captured into a CUDA graph together with the computation. The collectives
+    fused with the frees after them into invoke_jit_free are captured as well."""
+    # pylint: disable=protected-access
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.add(x, x)
+            y = raf.allreduce(y, computation="sum")
+            return raf.multiply(y, x)
+
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    model.to(device=device)
+    x = raf.array(np.ones(shape=(4, 4), dtype="float32") * (rank + 1), device=device)
+    mod = model._internal(x).mod
+    config = {"raf.vm.fuse_instructions": fuse_instructions}
+    with raf.ir.PassContext(opt_level=2, config=config):
+        executor = VMExecutor(mod, device, enable_cuda_graph=True)
+    assert fuse_instructions or "invoke_jit_free" not in executor.executable.bytecode
+    target_y = np.ones(shape=(4, 4), dtype="float32") * 2 * sum(range(1, total_rank + 1))
+    # The first run captures the graph, and the following ones replay it.
+    for _ in range(3):
+        y = executor.vm.run(x)
+        check(y, target_y * (rank + 1))
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("shape", [(4, 4), (3, 5)])
+def test_hierarchical_allreduce(shape):
+    """Testing the hierarchical allreduce, which falls back to the flat allreduce on one host,
+    and allreduces the elements not evenly divided by the local size with the flat allreduce."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.allreduce(x, computation="sum")
+
+    dcfg = dist.get_config()
+    dcfg.enable_hierarchical_allreduce = True
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x_np = np.arange(np.prod(shape), dtype="float32").reshape(shape) * (rank + 1)
+    x = raf.array(x_np, device=device)
+    model.to(device=device)
+    y = run_vm_model(model, device, [x])
+    dcfg.enable_hierarchical_allreduce = False
+    target_y = x_np / (rank + 1) * sum(range(1, total_rank + 1))
+    check(y, target_y)
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("hierarchical", [False, True])
+def test_topology_aware_allreduce(hierarchical):
+    """Testing the allreduce with the ranks ordered by the topology, whose result does not depend
+    on the order of the ring."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.allreduce(x, computation="sum")
+
+    shape = (4, 4)
+    dcfg = dist.get_config()
+    dcfg.enable_topology_aware_ring = True
+    dcfg.enable_hierarchical_allreduce = hierarchical
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x_np = np.arange(np.prod(shape), dtype="float32").reshape(shape) * (rank + 1)
+    x = raf.array(x_np, device=device)
+    model.to(device=device)
+    y = run_vm_model(model, device, [x])
+    dcfg.enable_topology_aware_ring = False
+    dcfg.enable_hierarchical_allreduce = False
+    target_y = x_np / (rank + 1) * sum(range(1, total_rank + 1))
+    check(y, target_y)
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("compression", ["fp16", "bf16", "topk"])
+def test_compressed_allreduce(compression):
+    """Testing the compressed allreduce of a bucket. The top-k compression with ratio 1 sends
+    all elements, so its result is exact."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x1, x2):
+            x = raf.allreduce([x1, x2], computation="sum")
+            return raf.concatenate((x[0], x[1]))
+
+    if compression == "bf16" and raf.build.with_nccl() < 21000:
+        pytest.skip("bfloat16 is not supported in NCCL < 2.10")
+
+    dcfg = dist.get_config()
+    dcfg.allreduce_compression = compression
+    dcfg.allreduce_topk_ratio = 1.0
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x1_np = np.random.uniform(-1, 1, (4, 4)).astype("float32")
+    x2_np = np.random.uniform(-1, 1, (4, 4)).astype("float32")
+    x1 = raf.array(x1_np * (rank + 1), device=device)
+    x2 = raf.array(x2_np * (rank + 1), device=device)
+    model.to(device=device)
+    y = run_vm_model(model, device, [x1, x2])
+    dcfg.allreduce_compression = "none"
+    dcfg.allreduce_topk_ratio = 0.01
+    target_y = np.concatenate([x1_np, x2_np]) * sum(range(1, total_rank + 1))
+    tol = {"fp16": 1e-2, "bf16": 5e-2, "topk": 1e-5}[compression]
+    check(y, target_y, rtol=tol, atol=tol * total_rank)
+
+
 @pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
 @pytest.mark.parametrize("computation", ["sum", "prod", "min", "max"])
 def test_allreduce_with_tensor_list(computation):
@@ -855,6 +987,292 @@ def test_all_to_all_with_rank_list(rank_list, dtype):
     check(y, target_y)
 
 
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_expert_dispatch_combine(dtype):
+    """Testing all_to_allv by dispatching and combining a variable number of tokens."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, send_counts):
+            dispatched = raf.expert_dispatch(x, send_counts)
+            combined = raf.expert_combine(raf.relu(dispatched[0]), dispatched[1])
+            return dispatched[0], dispatched[1], combined
+
+    if raf.build.with_nccl() < 20700:
+        pytest.skip("all_to_allv is not supported in NCCL < 2.7")
+
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    # Each src rank s sends (d + 1) tokens with value (s * total_rank + d) to dst rank d, and the
+    # capacity of each segment is total_rank tokens.
+    capacity = total_rank
+    x_np = np.zeros(shape=(total_rank * capacity, 4), dtype=dtype)
+    for d in range(total_rank):
+        x_np[d * capacity : d * capacity + d + 1] = rank * total_rank + d
+    counts_np = np.arange(1, total_rank + 1, dtype="int64")
+    x = raf.array(x_np, device=device)
+    send_counts = raf.array(counts_np, device=device)
+    model.to(device=device)
+    y, recv_counts, combined = model(x, send_counts)
+
+    check(recv_counts, np.full((total_rank,), rank + 1, dtype="int64"))
+    y = y.numpy()
+    combined = combined.numpy()
+    for s in range(total_rank):
+        segment = y[s * capacity : s * capacity + rank + 1]
+        check(segment, np.full(segment.shape, s * total_rank + rank, dtype=dtype))
+    # The combined tokens are sent back to the original segments.
+    for d in range(total_rank):
+        segment = slice(d * capacity, d * capacity + d + 1)
+        check(combined[segment], x_np[segment])
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+def test_async_collectives():
+    """Testing the asynchronous allreduce that overlaps with the independent computation."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            a = raf.allreduce(x)
+            b = raf.relu(raf.matmul(y, y))
+            return raf.add(a, b)
+
+    model = TestModel()
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    x_np = np.ones(shape=(4, 4), dtype="float32") * (rank + 1)
+    y_np = np.ones(shape=(4, 4), dtype="float32")
+    x = raf.array(x_np, device=device)
+    y = raf.array(y_np, device=device)
+    model.to(device=device)
+    mod = model._internal(x, y).mod
+    with tvm.transform.PassContext(opt_level=3, config={"raf.vm.async_collectives": True}):
+        executor = VMExecutor(mod, device)
+
+    # The matmul is launched before the wait of the allreduce.
+    instrs = [line.split("# ", 1)[-1] for line in executor.executable.bytecode.splitlines()]
+    start = [i for i, instr in enumerate(instrs) if instr.startswith("invoke_jit_async ")]
+    end = [i for i, instr in enumerate(instrs) if instr.startswith("wait $")]
+    assert len(start) == 1 and len(end) == 1 and start[0] < end[0]
+    assert any(instr.startswith("invoke_jit") for instr in instrs[start[0] + 1 : end[0]])
+
+    z = executor.make_executor()(x, y)
+    target = np.full((4, 4), sum(range(1, total_rank + 1)), dtype="float32")
+    target += np.maximum(y_np @ y_np, 0)
+    check(z, target)
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_vocab_parallel_cross_entropy(dtype):
+    """Testing the cross entropy of the logits sharded along the vocab."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, y_true, y_pred):
+            return raf.vocab_parallel_cross_entropy(y_true, y_pred)
+
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    n, v = 6, 37
+    # All the ranks generate the same full logits and labels, and each takes its own shard.
+    rng = np.random.RandomState(0)
+    logits = rng.randn(n, v * total_rank).astype("float32")
+    labels = rng.randint(0, v * total_rank, size=(n,)).astype("int64")
+    dy = np.array([0.5], dtype="float32")
+    y_true = raf.array(labels, device=device)
+    y_pred = raf.array(logits[:, rank * v : (rank + 1) * v].astype(dtype), device=device)
+    y_pred.requires_grad = True
+    model = TestModel()
+    model.to(device=device)
+    loss = model(y_true, y_pred)
+    loss.backward(raf.array(dy.astype(dtype), device=device))
+
+    shifted = logits - logits.max(axis=1, keepdims=True)
+    prob = np.exp(shifted) / np.exp(shifted).sum(axis=1, keepdims=True)
+    target = -np.log(prob[np.arange(n), labels]).mean()
+    prob[np.arange(n), labels] -= 1
+    grad = prob * dy[0] / n
+    tol = 1e-5 if dtype == "float32" else 1e-2
+    check(loss, np.array([target], dtype=dtype), rtol=tol, atol=tol)
+    check(y_pred.grad, grad[:, rank * v : (rank + 1) * v].astype(dtype), rtol=tol, atol=tol)
+
+
+
+@pytest.mark.skipif(skip_dist_test(min_rank_num=2), reason=SKIP_REASON)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_sync_batch_norm(dtype):
+    """Testing the batch norm whose stats are of the global batch of the ranks."""
+    total_rank, rank, local_rank = get_dist_comm_info(verbose=True)
+    device = f"cuda({local_rank})"
+    n, c, h, eps, momentum = 2, 3, 5, 1e-5, 0.1
+    # All the ranks generate the same global batch, and each takes its own part.
+    rng = np.random.RandomState(0)
+    n_x = rng.randn(n * total_rank, c, h).astype("float32")
+    n_dy = rng.randn(n * total_rank, c, h).astype("float32")
+    n_w = rng.rand(c).astype("float32") + 0.5
+    n_b = rng.randn(c).astype("float32")
+    model = raf.model.SyncBatchNorm(c, eps=eps, momentum=momentum)
+    model.w = raf.array(n_w)
+    model.w.requires_grad = True
+    model.b = raf.array(n_b)
+    model.b.requires_grad = True
+    model.to(device=device)
+    model.train_mode()
+    local = slice(rank * n, (rank + 1) * n)
+    m_x = raf.array(n_x[local].astype(dtype), device=device)
+    m_x.requires_grad = True
+    m_y = model(m_x)
+    m_y.backward(raf.array(n_dy[local].astype(dtype), device=device))
+
+    mean = n_x.mean(axis=(0, 2), keepdims=True)
+    var = n_x.var(axis=(0, 2), keepdims=True)
+    invstd = 1 / np.sqrt(var + eps)
+    x_hat = (n_x - mean) * invstd
+    n_y = x_hat * n_w.reshape(1, c, 1) + n_b.reshape(1, c, 1)
+    g_dy = n_dy - n_dy.mean(axis=(0, 2), keepdims=True)
+    g_dy -= x_hat * (n_dy * x_hat).mean(axis=(0, 2), keepdims=True)
+    n_dx = g_dy * invstd * n_w.reshape(1, c, 1)
+    count = n * total_rank * h
+    running_var = (1 - momentum) + momentum * var.flatten() * count / (count - 1)
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_y, n_y[local].astype(dtype), rtol=tol, atol=tol)
+    check(m_x.grad, n_dx[local].astype(dtype), rtol=tol, atol=tol)
+    # The gradients of w and b are of the local batch.
+    check(model.w.grad, (n_dy * x_hat)[local].sum(axis=(0, 2)), rtol=tol, atol=tol)
+    check(model.b.grad, n_dy[local].sum(axis=(0, 2)), rtol=tol, atol=tol)
+    check(model.running_mean, momentum * mean.flatten(), rtol=tol, atol=tol)
+    check(model.running_var, running_var, rtol=tol, atol=tol)
+
+
+def skip_cpu_dist_test():
+    """The CPU collectives run on the MPI communicator of at least 2 ranks."""
+    if not raf.build.with_mpi() or os.environ.get("RAF_FILE_STORE_PATH", None):
+        return True
+    size, _, _ = get_dist_comm_info()
+    return size < 2
+
+
+CPU_SKIP_REASON = "MPI is not enabled or #rank is less than 2"
+
+
+@pytest.mark.skipif(skip_cpu_dist_test(), reason=CPU_SKIP_REASON)
+@pytest.mark.parametrize("shape", [(4, 4), (1000, 700)])
+@pytest.mark.parametrize("computation", ["sum", "prod", "min", "max", "avg"])
+def test_cpu_allreduce(shape, computation):
+    """Testing the ring allreduce of the CPU tensors, where the large one is sent in segments."""
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.allreduce(x, computation=computation)
+
+    model = TestModel()
+    total_rank, rank, _ = get_dist_comm_info(verbose=True)
+    x = raf.array(np.ones(shape=shape, dtype="float32") * (rank + 1), device="cpu")
+    y = run_vm_model(model, "cpu", [x])
+    ranks = np.arange(1, total_rank + 1, dtype="float32")
+    target = {
+        "sum": ranks.sum(),
+        "prod": ranks.prod(),
+        "min": ranks.min(),
+        "max": ranks.max(),
+        "avg": ranks.mean(),
+    }[computation]
+    check(y, np.ones(shape=shape, dtype="float32") * target)
+
+
+@pytest.mark.skipif(skip_cpu_dist_test(), reason=CPU_SKIP_REASON)
+def test_cpu_allreduce_with_tensor_list():
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            return raf.allreduce([x, y])
+
+    model = TestModel()
+    total_rank, rank, _ = get_dist_comm_info(verbose=True)
+    n_x = np.ones(shape=(3, 5), dtype="int64") * (rank + 1)
+    n_y = np.ones(shape=(7,), dtype="int64") * (rank + 2)
+    args = [raf.array(n_x, device="cpu"), raf.array(n_y, device="cpu")]
+    z = run_vm_model(model, "cpu", args)
+    ranks = np.arange(total_rank)
+    check(z[0], np.ones(shape=(3, 5), dtype="int64") * (ranks + 1).sum())
+    check(z[1], np.ones(shape=(7,), dtype="int64") * (ranks + 2).sum())
+
+
+@pytest.mark.skipif(skip_cpu_dist_test(), reason=CPU_SKIP_REASON)
+def test_cpu_reduce_scatter():
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.reduce_scatter(x)
+
+    model = TestModel()
+    total_rank, rank, _ = get_dist_comm_info(verbose=True)
+    n_x = np.arange(total_rank * 6, dtype="float32").reshape(total_rank * 2, 3) * (rank + 1)
+    y = run_vm_model(model, "cpu", [raf.array(n_x, device="cpu")])
+    n_sum = np.arange(total_rank * 6, dtype="float32").reshape(total_rank * 2, 3)
+    n_sum = n_sum * sum(range(1, total_rank + 1))
+    check(y, n_sum[rank * 2 : (rank + 1) * 2])
+
+
+@pytest.mark.skipif(skip_cpu_dist_test(), reason=CPU_SKIP_REASON)
+@pytest.mark.parametrize("axis", [0, 1])
+def test_cpu_allgather(axis):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.allgather(x, axis=axis)
+
+    model = TestModel()
+    total_rank, rank, _ = get_dist_comm_info(verbose=True)
+    x = np.ones(shape=(4, 3), dtype="float32") * (rank + 1)
+    y = run_vm_model(model, "cpu", [raf.array(x, device="cpu")])
+    target_y = np.concatenate([x / (rank + 1) * (r + 1) for r in range(total_rank)], axis=axis)
+    check(y, target_y)
+
+
+@pytest.mark.skipif(skip_cpu_dist_test(), reason=CPU_SKIP_REASON)
+def test_cpu_broadcast():
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.broadcast(x, 0)
+
+    model = TestModel()
+    _, rank, _ = get_dist_comm_info(verbose=True)
+    x = np.ones(shape=(4, 4), dtype="float32") * (rank + 1)
+    y = run_vm_model(model, "cpu", [raf.array(x, device="cpu")])
+    check(y, np.ones(shape=(4, 4), dtype="float32"))
+
+
 if __name__ == "__main__":
     if os.environ.get("RAF_FILE_STORE_PATH", None):
         dist.set_default_communicator("void")
@@ -0,0 +1,62 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init
+import numpy as np
+import pytest
+
+import raf
+from raf import distributed as dist
+from raf._lib import _TVMError
+from raf.testing import check
+
+
+class ShardedModel(raf.Model):
+    def build(self, size):
+        self.w = raf.array(np.zeros((5, 2), dtype="float32"))
+        # The ZeRO partition of the SGD variant of w.
+        setattr(self, "w.sgd_v", raf.array(np.zeros((-(-5 // size), 2), dtype="float32")))
+
+    @raf.model.trace
+    def forward(self, x):
+        return raf.add(x, self.w)
+
+
+def test_restore_with_repartition():
+    dcfg = dist.get_config()
+    comm = dist.get_communicator()
+    if not isinstance(comm, dist.communicator.VoidCommunicator) or comm.size != 1:
+        pytest.skip("The test changes the world of a single-process VoidCommunicator")
+    zero_opt_level = dcfg.zero_opt_level
+    dcfg.zero_opt_level = 1
+    dcfg.enable_elastic = True
+    try:
+        w_np = np.random.randn(5, 2).astype("float32")
+        v_np = np.random.randn(5, 2).astype("float32")
+        # The snapshot is taken from a world of a single rank, where nothing is partitioned.
+        model = ShardedModel(1)
+        model.w[:] = w_np
+        getattr(model, "w.sgd_v")[:] = v_np
+        snapshot = dist.take_snapshot(model, step=7)
+        assert snapshot.world_size == 1
+        check(snapshot.states["w.sgd_v"], v_np)
+
+        # Rank 1 of the new world of 2 ranks restores the second partition, which is padded.
+        dist.rebuild(1, 2, 1, 2, 1)
+        assert comm.size == 2 and comm.rank == 1
+        new_model = ShardedModel(2)
+        assert dist.restore_snapshot(new_model, snapshot) == 7
+        check(new_model.w, w_np)
+        check(getattr(new_model, "w.sgd_v"), np.concatenate([v_np[3:], np.zeros((1, 2))]))
+
+        with pytest.raises(_TVMError):
+            # The generation must increase.
+            dist.rebuild(1, 1, 0, 1, 0)
+    finally:
+        dist.rebuild(2, 1, 0, 1, 0)
+        dcfg.zero_opt_level = zero_opt_level
+        dcfg.enable_elastic = False
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
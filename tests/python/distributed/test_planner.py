@@ -0,0 +1,98 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+from unittest.mock import patch
+import pytest
+
+from raf.distributed import CommModel, ModelProfile, ParallelPlan, plan_parallelism
+
+MB = 1 << 20
+
+BENCHMARK = """# ranks 8, warmup 5, iters 20, tensors 8
+                    op    dtype      size(B)        count  setup(us)   time(us)    algbw    busbw
+             allreduce  float32         1024          256      100.0       20.0     0.05     0.09
+             allreduce  float32      1048576       262144      100.0      120.0     8.74    15.29
+             allreduce  float16      1048576       524288      100.0      120.0     8.74    15.29
+             allgather  float32      1048576       262144      100.0       70.0    14.98    13.11
+"""
+
+
+def get_profile(param_mb, activation_mb):
+    return ModelProfile(
+        gflops=100000.0,
+        param_bytes=param_mb * MB,
+        activation_bytes=activation_mb * MB,
+        batch_size=64,
+        tp_comm_bytes=256 * MB,
+        num_tp_comms=64,
+        num_layers=16,
+        device_gflops=100000.0,
+    )
+
+
+def test_comm_model():
+    model = CommModel.from_benchmark(BENCHMARK)
+    assert model.tables["allreduce"] == (8, [(1024, 20.0), (1048576, 120.0)])
+    # Interpolated, and extrapolated by the last bandwidth.
+    assert model.time_us("allreduce", 1024 + (1048576 - 1024) // 2, 8) == pytest.approx(70.0)
+    assert model.time_us("allreduce", 2 * 1048576 - 1024, 8) == pytest.approx(220.0)
+    # Scaled by the bus factor to the other numbers of ranks.
+    assert model.time_us("allgather", 1048576, 2) == pytest.approx(70.0 * 0.5 / (7.0 / 8))
+    assert model.time_us("allreduce", 1048576, 1) == 0.0
+    # Not profiled: the ring model.
+    analytic = model.time_us("reduce_scatter", 1e9, 4)
+    assert analytic == pytest.approx(3 * 10.0 + 0.75e9 / 1e5)
+
+    with pytest.raises(ValueError):
+        CommModel.from_benchmark("\n".join(BENCHMARK.splitlines()[1:]))
+
+
+def test_plan_data_parallel():
+    # The model fits in a device, so data parallelism without ZeRO is the best.
+    plan = plan_parallelism(get_profile(100, 1000), 8, 16000)
+    assert (plan.dp, plan.tp, plan.pp, plan.zero_opt_level) == (8, 1, 1, 0)
+    assert plan.num_micro_batches == 1
+    # 4x of the parameters for the gradients and Adam, and 1/8 of the activations.
+    assert plan.memory_bytes == 400 * MB + 125 * MB
+
+
+def test_plan_memory_budget():
+    profile = get_profile(8000, 8000)
+    plans = plan_parallelism(profile, 8, 16000, return_all=True)
+    assert all(plan.memory_bytes <= 16000 * MB for plan in plans)
+    assert plans == sorted(plans, key=lambda plan: plan.iteration_us)
+    # Without ZeRO, the model states do not fit with data parallelism only.
+    dp_only = [plan for plan in plans if plan.dp == 8]
+    assert dp_only and all(plan.zero_opt_level >= 1 for plan in dp_only)
+    # ZeRO-3 alone does not fit, but the pipeline keeps fewer activations.
+    plan = plan_parallelism(profile, 8, 4500)
+    assert plan.pp > 1
+    with pytest.raises(ValueError):
+        plan_parallelism(profile, 8, 4500, strategies=("dp", "zero"))
+    with pytest.raises(ValueError):
+        plan_parallelism(profile, 8, 100)
+
+
+def test_plan_pipeline():
+    plan = plan_parallelism(get_profile(8000, 8000), 8, 50000, strategies=("pp",))
+    assert (plan.dp, plan.tp, plan.pp) == (1, 1, 8)
+    # More micro-batches shrink the bubble.
+    assert plan.num_micro_batches == 32
+    # At half of the peak compute by default.
+    assert plan.breakdown["compute"] == pytest.approx(2e6 / 8 * (32 + 7) / 32)
+
+
+@patch("raf.distributed.planner.get_config")
+def test_apply(mock_get_config):
+    class MockConfig:
+        enable_data_parallel = False
+        zero_opt_level = 0
+
+    mock_get_config.return_value = MockConfig()
+    dcfg = ParallelPlan(dp=4, tp=2, pp=1, zero_opt_level=2, num_micro_batches=1).apply()
+    assert dcfg.enable_data_parallel
+    assert dcfg.zero_opt_level == 2
+    assert ParallelPlan(4, 2, 1, 2, 1).tp_ranks(5) == [4, 5]
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
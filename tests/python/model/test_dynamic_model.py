@@ -18,6 +18,7 @@ from raf.testing import (
 )
 from raf._core.ndarray import Symbol
 from raf.model.trace import _get_func_inputs
+from raf.utils import metrics
 
 
 @pytest.mark.parametrize("device", get_testable_devices())
@@ -189,5 +190,35 @@ def test_mlp(config, device, fuse):
     mlp.check_params(m_model, t_model)
 
 
+@pytest.mark.parametrize("fuse", [True, False])
+def test_infer_type_cache(fuse):
+    # pylint: disable=no-self-use
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.argwhere(x)
+            y = raf.abs(y)
+            return y
+
+    def get_hits():
+        return metrics.get().get('raf_vm_infer_type_cache_total{result="hit"}', 0)
+
+    model = Model()
+    m_x = raf.array(np.ones((2, 2)).astype("float32"))
+    record = model._internal(m_x)
+    vm = get_vm_executor(record.mod, "cpu", disable_fusion=not fuse)
+    # The types of the same shapes are inferred once, and the ones of the other shapes are not
+    # mixed up with them.
+    for n_x in [np.ones((2, 2)), np.eye(2), np.ones((2, 2)), np.eye(2)]:
+        m_x = raf.array(n_x.astype("float32"))
+        last_hits = get_hits()
+        v_res = vm(*_get_func_inputs(record, [m_x], {}, get_handle=False))
+        check(v_res, np.argwhere(n_x).astype("int32"))
+    assert get_hits() > last_hits
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,152 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init,too-many-locals,too-many-arguments
+import numpy as np
+import pytest
+import raf
+from raf.model import DecodeExecutor, KVCache, PagedKVCache
+from raf.testing import check, get_testable_devices
+
+
+class Decoder(raf.Model):
+    def build(self, batch_size, num_heads, head_dim, max_len, weights, device):
+        self.batch_size = batch_size
+        self.num_heads = num_heads
+        self.head_dim = head_dim
+        self.wq, self.wk, self.wv = [raf.array(w, device=device) for w in weights]
+        self.cache = KVCache(1, batch_size, num_heads, max_len, head_dim, device=device)
+
+    def _split_heads(self, x, w):
+        y = raf.reshape(raf.matmul(x, w), (self.batch_size, -1, self.num_heads, self.head_dim))
+        return raf.transpose(y, (0, 2, 1, 3))
+
+    @raf.model.trace
+    def forward(self, x, pos, mask):
+        # The number of the new tokens is -1 in the shapes, as it is only known by the inputs.
+        batch, heads, head_dim = self.batch_size, self.num_heads, self.head_dim
+        q = self._split_heads(x, self.wq)
+        k = self._split_heads(x, self.wk)
+        v = self._split_heads(x, self.wv)
+        keys, values = self.cache(0, k, v, pos)
+        bucket = self.cache.bucket
+        q = raf.reshape(q, (batch * heads, -1, head_dim))
+        keys = raf.reshape(keys, (batch * heads, bucket, head_dim))
+        values = raf.reshape(values, (batch * heads, bucket, head_dim))
+        score = raf.reshape(raf.batch_matmul_nt(q, keys), (batch, heads, -1, bucket))
+        score = raf.add(score, raf.reshape(mask, (batch, 1, -1, bucket)))
+        prob = raf.reshape(raf.softmax(score, axis=-1), (batch * heads, -1, bucket))
+        return raf.reshape(raf.batch_matmul(prob, values), (batch, heads, -1, head_dim))
+
+
+def attention_ref(xs, weights, num_heads, head_dim):
+    batch_size, length, _ = xs.shape
+    q, k, v = [
+        (xs @ w).reshape(batch_size, length, num_heads, head_dim).transpose(0, 2, 1, 3)
+        for w in weights
+    ]
+    score = q @ k.transpose(0, 1, 3, 2)
+    score = np.where(np.tril(np.ones((length, length), dtype=bool)), score, -np.inf)
+    prob = np.exp(score - score.max(axis=-1, keepdims=True))
+    prob = prob / prob.sum(axis=-1, keepdims=True)
+    return prob @ v
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_decode(device):
+    batch_size, num_heads, head_dim, max_len, hidden = 2, 2, 4, 8, 8
+    weights = [np.random.randn(hidden, hidden).astype("float32") * 0.3 for _ in range(3)]
+    model = Decoder(batch_size, num_heads, head_dim, max_len, weights, device)
+    model.infer_mode()
+    executor = DecodeExecutor(model, model.cache, device, buckets=[4, 8])
+    # The prefill of 3 tokens and 3 decode steps, where the last step moves to the next bucket.
+    xs = np.random.randn(batch_size, 6, hidden).astype("float32")
+    ref = attention_ref(xs, weights, num_heads, head_dim)
+    out = executor.step(xs[:, :3])
+    check(out, ref[:, :, :3], rtol=1e-4, atol=1e-4)
+    for i in range(3, 6):
+        out = executor.step(xs[:, i : i + 1])
+        check(out, ref[:, :, i : i + 1], rtol=1e-4, atol=1e-4)
+    assert list(model.cache.lengths) == [6, 6]
+    # A step of each bucket and shape is compiled once.
+    assert len(executor._steps) == 3  # pylint: disable=protected-access
+
+    # The new sequences overwrite the caches.
+    model.cache.reset()
+    out = executor.step(xs[:, :3])
+    check(out, ref[:, :, :3], rtol=1e-4, atol=1e-4)
+
+
+
+class PagedDecoder(raf.Model):
+    def build(self, batch_size, num_heads, head_dim, weights, cache):
+        self.batch_size = batch_size
+        self.num_heads = num_heads
+        self.head_dim = head_dim
+        self.wq, self.wk, self.wv = [raf.array(w, device=cache.device) for w in weights]
+        self.cache = cache
+
+    def _split_heads(self, x, w):
+        y = raf.reshape(raf.matmul(x, w), (self.batch_size, -1, self.num_heads, self.head_dim))
+        return raf.transpose(y, (0, 2, 1, 3))
+
+    @raf.model.trace
+    def forward(self, x, block_table, pos, lengths):
+        q = self._split_heads(x, self.wq)
+        k = self._split_heads(x, self.wk)
+        v = self._split_heads(x, self.wv)
+        return self.cache(0, q, k, v, block_table, pos, lengths)
+
+
+def test_block_allocator():
+    cache = PagedKVCache(1, 4, 2, 1, 4, max_blocks=3)
+    assert cache.reserve(0, 3)
+    assert cache.num_free_blocks == 2
+    # The blocks are all or nothing.
+    assert not cache.reserve(1, 5)
+    assert cache.num_free_blocks == 2
+    assert cache.reserve(1, 4)
+    assert cache.num_free_blocks == 0
+    # The freed blocks are reused by the new sequences.
+    cache.free(0)
+    assert cache.num_free_blocks == 2
+    assert cache.reserve(2, 3)
+    # A sequence has at most max_blocks blocks.
+    cache.free(1)
+    assert not cache.reserve(2, 7)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_paged_decode(device):
+    batch_size, num_heads, head_dim, hidden = 2, 2, 4, 8
+    weights = [np.random.randn(hidden, hidden).astype("float32") * 0.3 for _ in range(3)]
+    cache = PagedKVCache(1, 8, 2, num_heads, head_dim, max_blocks=4, device=device)
+    model = PagedDecoder(batch_size, num_heads, head_dim, weights, cache)
+    model.infer_mode()
+    xs = [np.random.randn(1, 7, hidden).astype("float32") for _ in range(2)]
+    refs = [attention_ref(x, weights, num_heads, head_dim) for x in xs]
+
+    def run(seq_ids, tokens):
+        x = np.zeros((batch_size, tokens[0].shape[1], hidden), dtype="float32")
+        for i, token in enumerate(tokens):
+            x[i] = token
+        return model(raf.array(x, device=device), *cache.prepare(seq_ids, x.shape[1])).numpy()
+
+    # The sequences of different lengths are prefilled in the slots of the batch in turn.
+    out = run([0, None], [xs[0][:, :3], np.zeros((1, 3, hidden), dtype="float32")])
+    check(out[0], refs[0][0, :, :3], rtol=1e-4, atol=1e-4)
+    check(out[1], np.zeros_like(out[1]))
+    out = run([None, 1], [np.zeros((1, 5, hidden), dtype="float32"), xs[1][:, :5]])
+    check(out[1], refs[1][0, :, :5], rtol=1e-4, atol=1e-4)
+    for i in range(2):
+        out = run([0, 1], [xs[0][:, 3 + i : 4 + i], xs[1][:, 5 + i : 6 + i]])
+        check(out[0], refs[0][0, :, 3 + i : 4 + i], rtol=1e-4, atol=1e-4)
+        check(out[1], refs[1][0, :, 5 + i : 6 + i], rtol=1e-4, atol=1e-4)
+    # The sequences of 5 and 7 tokens take 3 and 4 blocks of 2 tokens.
+    assert cache.num_free_blocks == 1
+    cache.free(1)
+    assert cache.num_free_blocks == 5
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
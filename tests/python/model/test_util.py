@@ -7,6 +7,7 @@ import numpy as np
 import raf
 from raf._core.ndarray import ndarray
 from raf.model.model import calc_model_gflops, get_param_size
+from raf.model.model import predict_memory, search_max_batch_size
 from raf.testing import check, randn
 
 
@@ -58,5 +59,34 @@ def test_calc_gflops():
     check(gflops, 1056 / 1e9, rtol=1e-1, atol=1e-1)
 
 
+def test_predict_memory():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a_1 = raf.relu(x)
+            a_2 = raf.relu(a_1)
+            a_3 = raf.add(a_1, a_2)
+            return a_3
+
+    def get_model_and_args(batch_size):
+        m_x, _ = randn((batch_size, 1024), device="cpu")  # 4 KBs per sample
+        return Model(), [m_x]
+
+    model, args = get_model_and_args(256)  # 1 MB
+    pred = predict_memory(model, "cpu", args, include_workspace=False)
+    # The peak is at a_3, where x, a_1, a_2 and a_3 are alive.
+    check(pred["peak"], 4)
+    check(pred["input"], 1)
+    check(pred["activation"], 3)
+    assert pred["parameter"] == 0 and pred["gradient"] == 0
+    assert [name for name, _, _ in pred["trace"]] == ["raf.op.relu", "raf.op.relu", "raf.op.add"]
+
+    # Four tensors of 4 KBs are alive per sample, so at most 64 samples fit into 1 MB.
+    assert search_max_batch_size(get_model_and_args, "cpu", 1, 512) == 64
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,56 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-arguments,protected-access,no-self-use,attribute-defined-outside-init
+import numpy as np
+import pytest
+import raf
+from raf.testing import check, randn, run_vm_model, with_dialect
+
+pytestmark = pytest.mark.skipif(not raf.build.with_cblas(), reason="CPU BLAS is not enabled")
+
+
+@with_dialect(["cblas", "tvm"])
+@pytest.mark.parametrize("transpose_a", [True, False])
+@pytest.mark.parametrize("transpose_b", [True, False])
+@pytest.mark.parametrize("dtype", ["float32", "float64"])
+def test_matmul(transpose_a, transpose_b, dtype):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            raf_op = [[raf.matmul, raf.matmul_nt], [raf.matmul_tn, raf.matmul_tt]]
+            return raf_op[transpose_a][transpose_b](m_a, m_b)
+
+    n, k, m = 12, 20, 8
+    m_a, n_a = randn((k, n) if transpose_a else (n, k), dtype=dtype)
+    m_b, n_b = randn((m, k) if transpose_b else (k, m), dtype=dtype)
+    v_c = run_vm_model(TestModel(), "cpu", [m_a, m_b])
+    n_c = np.matmul(n_a.T if transpose_a else n_a, n_b.T if transpose_b else n_b)
+    check(v_c, n_c, rtol=1e-5, atol=1e-5)
+
+
+@with_dialect(["cblas", "tvm"])
+@pytest.mark.parametrize("broadcast", ["none", "a", "b"])
+@pytest.mark.parametrize("transpose_b", [True, False])
+def test_batch_matmul(broadcast, transpose_b):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            return (raf.batch_matmul_nt if transpose_b else raf.batch_matmul)(m_a, m_b)
+
+    b, n, k, m = 3, 6, 10, 4
+    m_a, n_a = randn((1 if broadcast == "a" else b, n, k))
+    m_b, n_b = randn((1 if broadcast == "b" else b,) + ((m, k) if transpose_b else (k, m)))
+    v_c = run_vm_model(TestModel(), "cpu", [m_a, m_b])
+    n_c = np.matmul(n_a, np.swapaxes(n_b, -1, -2) if transpose_b else n_b)
+    check(v_c, n_c, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -48,6 +48,28 @@ def test_raf_matmul(n, k, m, transpose_a, transpose_b, dtype):
     check(m_b.grad, t_b.grad)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("op", ["matmul_nt", "batch_matmul"])
+def test_bfloat16_matmul(op):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            m_a = raf.cast(m_a, "bfloat16")
+            m_b = raf.cast(m_b, "bfloat16")
+            return raf.cast(getattr(raf, op)(m_a, m_b), "float32")
+
+    ashape, bshape = ((8, 16), (4, 16)) if op == "matmul_nt" else ((2, 8, 16), (2, 16, 4))
+    m_a, t_a = randn_torch(ashape, device="cuda")
+    m_b, t_b = randn_torch(bshape, device="cuda")
+    v_c = run_vm_model(TestModel(), "cuda", [m_a, m_b])
+    t_b = t_b.T if op == "matmul_nt" else t_b
+    t_c = torch.matmul(t_a.bfloat16(), t_b.bfloat16()).float()
+    check(v_c, t_c, rtol=2e-2, atol=2e-2)
+
+
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize("dtype", ["float32", "float16"])
 @pytest.mark.parametrize("b", [2, 4])
@@ -0,0 +1,144 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,no-self-use
+# pylint: disable=attribute-defined-outside-init
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, DialectChecker
+
+# The cuBLASLt fusion is a fallback of the CUTLASS fusion, which takes the same patterns first.
+pytestmark = pytest.mark.skipif(
+    not raf.build.with_cublas() or raf.build.with_cutlass(),
+    reason="cuBLAS is not enabled or the patterns go to CUTLASS",
+)
+
+
+def fuse(mod):
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.InferType()(mod)
+        return raf._ffi.pass_.FuseDialect()(mod)
+
+
+@pytest.mark.parametrize("matmul", ["matmul", "dense", "matmul_tn", "batch_matmul_nt"])
+@pytest.mark.parametrize("bias", ["vector", "matrix", None])
+@pytest.mark.parametrize("act", [None, "relu", "gelu"])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_matmul_epilogue(matmul, bias, act, dtype):
+    if bias is None and act is None:
+        pytest.skip("A single matmul is not fused")
+
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, b):
+            y = getattr(raf, matmul)(x, w)
+            y = raf.add(y, b) if bias else y
+            y = getattr(raf, act)(y) if act else y
+            return y
+
+    m, n, k, batch = 24, 40, 32, 3
+    xshape = (k, m) if matmul == "matmul_tn" else (m, k)
+    wshape = (n, k) if matmul in ("dense", "batch_matmul_nt") else (k, n)
+    yshape = (m, n)
+    if matmul.startswith("batch"):
+        xshape, wshape, yshape = (batch, *xshape), (batch, *wshape), (batch, *yshape)
+    bshape = (n,) if bias == "vector" else yshape
+    m_x, t_x = randn_torch(xshape, device="cuda", dtype=dtype)
+    m_w, t_w = randn_torch(wshape, device="cuda", dtype=dtype)
+    m_b, t_b = randn_torch(bshape, device="cuda", dtype=dtype)
+    model = TestModel()
+    mod = fuse(model._internal(m_x, m_w, m_b).mod)
+    # The tanh-approximated GELU epilogue is only used in half precision.
+    if act == "gelu" and dtype == "float32":
+        assert "cublaslt" not in raf.ir.AsText(mod)
+    else:
+        DialectChecker("cublaslt").visit(mod["main"])
+    m_y = run_vm_model(model, "cuda", [m_x, m_w, m_b])
+
+    t_x = t_x.transpose(-1, -2) if matmul == "matmul_tn" else t_x
+    t_w = t_w.transpose(-1, -2) if matmul in ("dense", "batch_matmul_nt") else t_w
+    t_y = torch.matmul(t_x.float(), t_w.float())
+    t_y = t_y + t_b.float() if bias else t_y
+    if act == "relu":
+        t_y = torch.relu(t_y)
+    elif act == "gelu":
+        t_y = torch.nn.functional.gelu(t_y)
+    tol = 1e-2 if dtype == "float32" else 5e-2
+    check(m_y, t_y.to(t_x.dtype), rtol=tol, atol=tol)
+
+
+def test_unsupported_bias():
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, b):
+            return raf.relu(raf.add(raf.dense(x, w), b))
+
+    m_x, _ = randn_torch((16, 32), device="cuda")
+    m_w, _ = randn_torch((8, 32), device="cuda")
+    # A bias broadcast along the rows cannot be expressed by cuBLASLt.
+    m_b, _ = randn_torch((16, 1), device="cuda")
+    mod = fuse(TestModel()._internal(m_x, m_w, m_b).mod)
+    assert "cublaslt" not in raf.ir.AsText(mod)
+
+
+@pytest.mark.parametrize("act", [None, "relu"])
+def test_cast_output(act):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            y = raf.dense(x, w)
+            y = getattr(raf, act)(y) if act else y
+            return raf.cast(y, "float32")
+
+    m_x, t_x = randn_torch((24, 32), device="cuda", dtype="float16")
+    m_w, t_w = randn_torch((40, 32), device="cuda", dtype="float16")
+    model = TestModel()
+    mod = fuse(model._internal(m_x, m_w).mod)
+    # The float16 GEMM writes the float32 output, so the cast is not computed on its own.
+    DialectChecker("cublaslt").visit(mod["main"])
+    assert "raf.op.tvm.cast" not in raf.ir.AsText(mod)
+    m_y = run_vm_model(model, "cuda", [m_x, m_w])
+    t_y = torch.matmul(t_x.float(), t_w.float().t())
+    t_y = torch.relu(t_y) if act else t_y
+    assert m_y.dtype == "float32"
+    check(m_y, t_y, rtol=5e-2, atol=5e-2)
+
+
+@pytest.mark.skipif(
+    not torch.cuda.is_available() or torch.cuda.get_device_capability()[0] < 9,
+    reason="fp8 GEMM requires Hopper",
+)
+def test_fp8_dense():
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, b):
+            return raf.relu(raf.add(raf.dense(x, w), b))
+
+    m_x, t_x = randn_torch((32, 64), device="cuda", dtype="float16")
+    m_w, t_w = randn_torch((16, 64), device="cuda", dtype="float16")
+    m_b, t_b = randn_torch((16,), device="cuda", dtype="float16")
+    with raf.ir.PassContext(config={"raf.cublaslt.fp8": True}):
+        m_y = run_vm_model(TestModel(), "cuda", [m_x, m_w, m_b])
+    t_y = torch.relu(torch.matmul(t_x.float(), t_w.float().T) + t_b.float())
+    # The per-tensor scaled e4m3 operands keep about 2 significant digits.
+    check(m_y, t_y.half(), rtol=0.1, atol=0.5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,61 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,attribute-defined-outside-init,no-self-use
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, p):
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, x, residual, scale, bias):
+        return raf.add_dropout_layer_norm(x, residual, scale, bias, p=self.p)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(4, 7, 64), (6, 30)])
+@pytest.mark.parametrize("p", [0.0, 0.3])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_add_dropout_layer_norm(shape, p, dtype):
+    m_x, t_x = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+    m_r, t_r = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+    m_w, t_w = randn_torch(shape[-1:], device="cuda", dtype=dtype, requires_grad=True)
+    m_b, t_b = randn_torch(shape[-1:], device="cuda", dtype=dtype, requires_grad=True)
+    model = TestModel(p)
+    args = [m_x, m_r, m_w, m_b]
+    m_out = model(*args)
+    v_out = run_vm_model(model, "cuda", args)
+    # Apply the dropout mask drawn by the op to the reference.
+    t_keep = torch.ones(shape, device="cuda", dtype=t_x.dtype)
+    if p > 0:
+        t_keep = torch.tensor(m_out[4].numpy(), device="cuda").to(t_x.dtype) / (1 - p)
+        drop_ratio = 1 - m_out[4].numpy().mean()
+        assert abs(drop_ratio - p) < 0.1, drop_ratio
+    t_sum = t_r + t_x * t_keep
+    t_y = torch.nn.functional.layer_norm(t_sum.float(), shape[-1:], t_w.float(), t_b.float())
+    t_y = t_y.to(t_x.dtype)
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_out[0], t_y, rtol=tol, atol=tol)
+    check(m_out[3], t_sum, rtol=tol, atol=tol)
+    if p == 0:
+        check(v_out[0], t_y, rtol=tol, atol=tol)
+    # backward
+    m_dy, t_dy = randn_torch(shape, device="cuda", dtype=dtype)
+    m_out[0].backward(m_dy)
+    t_y.backward(t_dy)
+    tol = 1e-4 if dtype == "float32" else 5e-2
+    check(m_x.grad, t_x.grad, rtol=tol, atol=tol)
+    check(m_r.grad, t_r.grad, rtol=tol, atol=tol)
+    check(m_w.grad, t_w.grad, rtol=tol, atol=tol)
+    check(m_b.grad, t_b.grad, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,146 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,attribute-defined-outside-init
+# pylint: disable=no-self-use
+import math
+
+import pytest
+import torch
+import numpy as np
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect
+
+
+def torch_attention(q, k, v, mask, causal, scale):
+    score = torch.matmul(q, k.transpose(-1, -2)) * scale
+    if mask is not None:
+        score = score + mask.reshape(mask.shape[0], *([1] * (score.dim() - 2)), mask.shape[-1])
+    if causal:
+        causal_mask = torch.ones(score.shape[-2:], dtype=torch.bool, device=score.device).triu(1)
+        score = score.masked_fill(causal_mask, float("-inf"))
+    return torch.matmul(torch.softmax(score.float(), dim=-1).to(q.dtype), v)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(2, 3, 37, 64), (4, 50, 80)])
+@pytest.mark.parametrize("seq_k", [None, 21])
+@pytest.mark.parametrize("masked", [False, True])
+@pytest.mark.parametrize("causal", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_attention(shape, seq_k, masked, causal, dtype):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k, v):
+            return raf.attention(q, k, v, causal=causal)[0]
+
+    class TestMaskModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k, v, mask):
+            return raf.attention(q, k, v, mask, causal=causal)[0]
+
+    kv_shape = shape if seq_k is None else shape[:-2] + (seq_k, shape[-1])
+    m_q, t_q = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+    m_k, t_k = randn_torch(kv_shape, device="cuda", dtype=dtype, requires_grad=True)
+    m_v, t_v = randn_torch(kv_shape, device="cuda", dtype=dtype, requires_grad=True)
+    model, args, t_mask = TestModel(), [m_q, m_k, m_v], None
+    if masked:
+        # Pad the last 5 keys of the first batch.
+        mask_np = np.zeros((shape[0], kv_shape[-2]), dtype=dtype)
+        mask_np[0, -5:] = -10000
+        m_mask = raf.array(mask_np, device="cuda")
+        t_mask = torch.tensor(mask_np, device="cuda")
+        model, args = TestMaskModel(), args + [m_mask]
+    # forward
+    m_y = model(*args)
+    v_y = run_vm_model(model, "cuda", args)
+    t_y = torch_attention(t_q, t_k, t_v, t_mask, causal, 1 / math.sqrt(shape[-1]))
+    rtol = 1e-4 if dtype == "float32" else 4e-2
+    atol = 1e-4 if dtype == "float32" else 4e-2
+    check(m_y, t_y, rtol=rtol, atol=atol)
+    check(v_y, t_y, rtol=rtol, atol=atol)
+    # backward
+    m_dy, t_dy = randn_torch(t_y.shape, device="cuda", dtype=dtype)
+    m_y.backward(m_dy)
+    t_y.backward(t_dy)
+    check(m_q.grad, t_q.grad, rtol=rtol, atol=atol)
+    check(m_k.grad, t_k.grad, rtol=rtol, atol=atol)
+    check(m_v.grad, t_v.grad, rtol=rtol, atol=atol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_attention_dropout():
+    shape = (2, 4, 64, 32)
+
+    class TestModel(raf.Model):
+        def build(self, seed):
+            self.seed = seed
+
+        @raf.model.trace
+        def forward(self, q, k, v):
+            return raf.attention(q, k, v, dropout_p=0.5, seed=self.seed)[0]
+
+    m_q, _ = randn_torch(shape, device="cuda")
+    m_k, _ = randn_torch(shape, device="cuda")
+    m_v, _ = randn_torch(shape, device="cuda")
+    y_1 = TestModel(1)(m_q, m_k, m_v).numpy()
+    y_2 = TestModel(2)(m_q, m_k, m_v).numpy()
+    # The dropout is determined by the seed, so the backward regenerates it.
+    check(TestModel(1)(m_q, m_k, m_v), y_1)
+    assert not np.allclose(y_1, y_2)
+
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("seq_q", [1, 5])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_paged_attention(seq_q, dtype):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k_cache, v_cache, block_table, lengths):
+            return raf.paged_attention(q, k_cache, v_cache, block_table, lengths)
+
+    batch, heads, head_dim, num_blocks, block_size, max_blocks = 3, 2, 64, 16, 4, 5
+    lengths = np.array([seq_q, 13, 20], dtype="int64")
+    # The blocks of the sequences are scattered over the caches.
+    table = np.random.permutation(num_blocks - 1)[: batch * max_blocks].reshape(batch, max_blocks)
+    m_q, t_q = randn_torch((batch, heads, seq_q, head_dim), device="cuda", dtype=dtype)
+    m_k, t_k = randn_torch((num_blocks, heads, block_size, head_dim), device="cuda", dtype=dtype)
+    m_v, t_v = randn_torch((num_blocks, heads, block_size, head_dim), device="cuda", dtype=dtype)
+    m_table = raf.array(table.astype("int64"), device="cuda")
+    m_lengths = raf.array(lengths, device="cuda")
+    args = [m_q, m_k, m_v, m_table, m_lengths]
+    m_y = TestModel()(*args)
+    v_y = run_vm_model(TestModel(), "cuda", args)
+    for b, length in enumerate(lengths):
+        # Gather the tokens of the sequence, where the query i is at the token
+        # length - seq_q + i.
+        blocks = torch.tensor(table[b], device="cuda")
+        t_kb = t_k[blocks].transpose(0, 1).reshape(heads, -1, head_dim)[:, :length]
+        t_vb = t_v[blocks].transpose(0, 1).reshape(heads, -1, head_dim)[:, :length]
+        score = torch.matmul(t_q[b].float(), t_kb.float().transpose(-1, -2)) / math.sqrt(head_dim)
+        causal = torch.ones((seq_q, length), dtype=torch.bool, device="cuda")
+        causal = causal.triu(length - seq_q + 1)
+        score = score.masked_fill(causal, float("-inf"))
+        t_y = torch.matmul(torch.softmax(score, dim=-1), t_vb.float()).to(t_q.dtype)
+        rtol = 1e-4 if dtype == "float32" else 4e-2
+        atol = 1e-4 if dtype == "float32" else 4e-2
+        check(m_y.numpy()[b], t_y, rtol=rtol, atol=atol)
+        check(v_y.numpy()[b], t_y, rtol=rtol, atol=atol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,113 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,attribute-defined-outside-init
+import math
+
+import pytest
+import torch
+import numpy as np
+
+import raf
+from raf.model import BlockSparseAttention, block_sparse_layout
+from raf.testing import randn_torch, run_vm_model, check, with_dialect
+
+
+def dense_mask(layout, block):
+    rows, cols = layout[:2]
+    mask = np.array(layout[2:], dtype="bool").reshape(rows, cols)
+    return torch.tensor(np.kron(mask, np.ones((block, block), dtype="bool")), device="cuda")
+
+
+def to_blocks(dense, layout, block):
+    """Gather the non-zero blocks of (batch, m, n) into (batch, nnz, block, block)."""
+    rows, cols = layout[:2]
+    mask = np.array(layout[2:]).reshape(rows, cols)
+    blocks = [
+        dense[:, r * block : (r + 1) * block, c * block : (c + 1) * block]
+        for r in range(rows)
+        for c in range(cols)
+        if mask[r, c]
+    ]
+    return torch.stack(blocks, dim=1)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("block", [16, 32])
+@pytest.mark.parametrize("k", [24, 64])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_block_sparse_matmul(block, k, dtype):
+    class SddModel(raf.Model):
+        def build(self, layout):
+            self.layout = layout
+
+        @raf.model.trace
+        def forward(self, x1, x2):
+            return raf.block_sparse_matmul_sdd(x1, x2, self.layout, block)
+
+    class DsdModel(raf.Model):
+        def build(self, layout, transpose_a):
+            self.layout = layout
+            self.transpose_a = transpose_a
+
+        @raf.model.trace
+        def forward(self, a, x):
+            return raf.block_sparse_matmul_dsd(a, x, self.layout, block, self.transpose_a)
+
+    # A non-square layout of 3 x 4 blocks with an empty block row.
+    layout = (3, 4) + (1, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0)
+    batch, m, n = 2, 3 * block, 4 * block
+    rtol = atol = 1e-4 if dtype == "float32" else 1e-2
+    m_x1, t_x1 = randn_torch((batch, m, k), device="cuda", dtype=dtype)
+    m_x2, t_x2 = randn_torch((batch, n, k), device="cuda", dtype=dtype)
+    t_dense = torch.matmul(t_x1.float(), t_x2.float().transpose(1, 2))
+    t_sparse = to_blocks(t_dense, layout, block).to(t_x1.dtype)
+    m_sparse = run_vm_model(SddModel(layout), "cuda", [m_x1, m_x2])
+    check(m_sparse, t_sparse, rtol=rtol, atol=atol)
+
+    t_masked = t_dense * dense_mask(layout, block)
+    m_a = raf.array(t_sparse.cpu().numpy(), device="cuda")
+    m_x, t_x = randn_torch((batch, n, k), device="cuda", dtype=dtype)
+    t_y = torch.matmul(t_masked, t_x.float()).to(t_x.dtype)
+    check(run_vm_model(DsdModel(layout, False), "cuda", [m_a, m_x]), t_y, rtol=rtol, atol=atol)
+    m_x, t_x = randn_torch((batch, m, k), device="cuda", dtype=dtype)
+    t_y = torch.matmul(t_masked.transpose(1, 2), t_x.float()).to(t_x.dtype)
+    check(run_vm_model(DsdModel(layout, True), "cuda", [m_a, m_x]), t_y, rtol=rtol, atol=atol)
+
+
+@with_dialect(["cuda"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("block", [16, 32])
+@pytest.mark.parametrize("causal", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_block_sparse_attention(block, causal, dtype):
+    num_blocks, head_dim = 6, 32
+    layout = block_sparse_layout(num_blocks, local=1, num_global=1, causal=causal)
+    shape = (3, num_blocks * block, head_dim)
+    m_q, t_q = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+    m_k, t_k = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+    m_v, t_v = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+    model = BlockSparseAttention(layout, head_dim, block, causal)
+    m_out = model(m_q, m_k, m_v)
+
+    mask = dense_mask(layout, block)
+    if causal:
+        mask = mask & torch.ones_like(mask).tril()
+    score = torch.matmul(t_q.float(), t_k.float().transpose(1, 2)) / math.sqrt(head_dim)
+    prob = torch.softmax(score.masked_fill(~mask, float("-inf")), dim=-1)
+    t_out = torch.matmul(prob, t_v.float()).to(t_q.dtype)
+    rtol = atol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_out, t_out, rtol=rtol, atol=atol)
+    check(run_vm_model(model, "cuda", [m_q, m_k, m_v]), t_out, rtol=rtol, atol=atol)
+
+    m_dy, t_dy = randn_torch(shape, device="cuda", dtype=dtype)
+    m_out.backward(m_dy)
+    t_out.backward(t_dy)
+    check(m_q.grad, t_q.grad, rtol=rtol, atol=atol)
+    check(m_k.grad, t_k.grad, rtol=rtol, atol=atol)
+    check(m_v.grad, t_v.grad, rtol=rtol, atol=atol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
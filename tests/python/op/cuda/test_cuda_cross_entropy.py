@@ -0,0 +1,48 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,attribute-defined-outside-init
+import pytest
+import torch
+import torch.nn.functional as F
+import numpy as np
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, with_dialect
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(4, 10), (7, 1031)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_softmax_cross_entropy(shape, dtype):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, y_true, y_pred):
+            return raf.softmax_cross_entropy(y_true, y_pred)
+
+    n, v = shape
+    labels = np.random.randint(0, v, size=(n,)).astype("int64")
+    m_true = raf.array(labels, device="cuda")
+    m_pred, t_pred = randn_torch(shape, device="cuda", dtype=dtype, requires_grad=True)
+    model = TestModel()
+    # forward
+    m_loss = model(m_true, m_pred)
+    v_loss = run_vm_model(model, "cuda", [m_true, m_pred])
+    t_loss = F.cross_entropy(t_pred.float(), torch.tensor(labels, device="cuda"))
+    rtol = 1e-5 if dtype == "float32" else 1e-2
+    atol = 1e-5 if dtype == "float32" else 1e-2
+    check(m_loss, t_loss.reshape(1).to(t_pred.dtype), rtol=rtol, atol=atol)
+    check(v_loss, t_loss.reshape(1).to(t_pred.dtype), rtol=rtol, atol=atol)
+    # backward
+    m_dy, t_dy = randn_torch((1,), device="cuda", dtype=dtype)
+    m_loss.backward(m_dy)
+    t_loss.backward(t_dy[0].float())
+    check(m_pred.grad, t_pred.grad, rtol=rtol, atol=atol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,94 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=no-self-use,protected-access,attribute-defined-outside-init
+import pytest
+import numpy as np
+
+import raf
+from raf.testing import run_vm_model, check, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, op, **kwargs):
+        self.op = op
+        self.attrs = kwargs
+
+    @raf.model.trace
+    def forward(self, *args):
+        return self.op(*args, **self.attrs)
+
+
+def sigmoid(x):
+    return 1 / (1 + np.exp(-x))
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "op,n_op",
+    [
+        ("relu", lambda x: np.maximum(x, 0)),
+        ("negative", np.negative),
+        ("abs", np.abs),
+        ("sigmoid", sigmoid),
+        ("tanh", np.tanh),
+        ("exp", np.exp),
+        ("log", lambda x: np.log(np.abs(x))),
+        ("sqrt", lambda x: np.sqrt(np.abs(x))),
+    ],
+)
+@pytest.mark.parametrize("shape", [(3, 5), (1027,)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_unary(op, n_op, shape, dtype):
+    n_x = np.random.uniform(-2, 2, size=shape).astype(dtype)
+    if op in ("log", "sqrt"):
+        n_x = np.abs(n_x) + 0.1
+    m_x = raf.array(n_x, device="cuda")
+    model = TestModel(getattr(raf._op.sym, op))
+    tol = 1e-5 if dtype == "float32" else 1e-2
+    n_y = n_op(n_x.astype("float32")).astype(dtype)
+    check(run_vm_model(model, "cuda", [m_x]), n_y, rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "op,n_op",
+    [
+        ("add", np.add),
+        ("subtract", np.subtract),
+        ("multiply", np.multiply),
+        ("divide", np.divide),
+        ("maximum", np.maximum),
+        ("minimum", np.minimum),
+    ],
+)
+@pytest.mark.parametrize(
+    "shapes", [((4, 33), (4, 33)), ((4, 1, 7), (5, 1)), ((8,), (2, 3, 8))]
+)
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_binary(op, n_op, shapes, dtype):
+    n_x1 = np.random.uniform(1, 2, size=shapes[0]).astype(dtype)
+    n_x2 = np.random.uniform(1, 2, size=shapes[1]).astype(dtype)
+    m_x1 = raf.array(n_x1, device="cuda")
+    m_x2 = raf.array(n_x2, device="cuda")
+    model = TestModel(getattr(raf._op.sym, op))
+    tol = 1e-5 if dtype == "float32" else 1e-2
+    n_y = n_op(n_x1, n_x2)
+    check(run_vm_model(model, "cuda", [m_x1, m_x2]), n_y, rtol=tol, atol=tol)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("src,dst", [("float32", "float16"), ("float16", "float32")])
+def test_cast(src, dst):
+    # The values are exact in both dtypes.
+    n_x = np.random.randint(-64, 64, size=(7, 9)).astype(src)
+    m_x = raf.array(n_x, device="cuda")
+    model = TestModel(raf._op.sym.cast, dtype=dst)
+    check(run_vm_model(model, "cuda", [m_x]), n_x.astype(dst))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
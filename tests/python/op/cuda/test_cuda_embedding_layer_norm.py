@@ -0,0 +1,91 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,protected-access,attribute-defined-outside-init,no-self-use
+# pylint: disable=too-many-arguments
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, randint, run_vm_model, check, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, p):
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, word, word_ids, pos, pos_ids, scale, bias, token_type, token_type_ids):
+        return raf.embedding_layer_norm(
+            word, word_ids, pos, pos_ids, scale, bias, token_type, token_type_ids, p=self.p
+        )
+
+
+class TestModelNoTokenType(raf.Model):
+    def build(self, p):
+        self.p = p
+
+    @raf.model.trace
+    def forward(self, word, word_ids, pos, pos_ids, scale, bias):
+        return raf.embedding_layer_norm(word, word_ids, pos, pos_ids, scale, bias, p=self.p)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("ids_shape", [(4, 7), (30,)])
+@pytest.mark.parametrize("hidden", [64, 30])
+@pytest.mark.parametrize("p", [0.0, 0.3])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@pytest.mark.parametrize("ids_dtype", ["int64", "int32"])
+@pytest.mark.parametrize("token_type", [False, True])
+def test_embedding_layer_norm(ids_shape, hidden, p, dtype, ids_dtype, token_type):
+    # pylint: disable=too-many-statements
+    num_tables = 3 if token_type else 2
+    sizes = [50, 40, 2][:num_tables]
+    m_tables, t_tables, m_ids, t_ids = [], [], [], []
+    for size in sizes:
+        m_t, t_t = randn_torch((size, hidden), device="cuda", dtype=dtype, requires_grad=True)
+        m_i, n_i = randint(ids_shape, high=size, device="cuda", dtype=ids_dtype)
+        m_tables.append(m_t)
+        t_tables.append(t_t)
+        m_ids.append(m_i)
+        t_ids.append(torch.tensor(n_i, device="cuda", dtype=torch.int64))
+    m_w, t_w = randn_torch((hidden,), device="cuda", dtype=dtype, requires_grad=True)
+    m_b, t_b = randn_torch((hidden,), device="cuda", dtype=dtype, requires_grad=True)
+    args = [m_tables[0], m_ids[0], m_tables[1], m_ids[1], m_w, m_b]
+    if token_type:
+        model = TestModel(p)
+        args += [m_tables[2], m_ids[2]]
+    else:
+        model = TestModelNoTokenType(p)
+    m_out = model(*args)
+    v_out = run_vm_model(model, "cuda", args)
+    shape = ids_shape + (hidden,)
+    t_sum = sum(torch.nn.functional.embedding(i, t) for t, i in zip(t_tables, t_ids))
+    t_y = torch.nn.functional.layer_norm(t_sum.float(), (hidden,), t_w.float(), t_b.float())
+    t_y = t_y.to(t_sum.dtype)
+    # Apply the dropout mask drawn by the op to the reference.
+    if p > 0:
+        t_keep = torch.tensor(m_out[4].numpy(), device="cuda").to(t_y.dtype) / (1 - p)
+        drop_ratio = 1 - m_out[4].numpy().mean()
+        assert abs(drop_ratio - p) < 0.1, drop_ratio
+        t_y = t_y * t_keep
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    assert m_out[0].shape == shape
+    check(m_out[0], t_y, rtol=tol, atol=tol)
+    check(m_out[3], t_sum, rtol=tol, atol=tol)
+    if p == 0:
+        check(v_out[0], t_y, rtol=tol, atol=tol)
+    # backward
+    m_dy, t_dy = randn_torch(shape, device="cuda", dtype=dtype)
+    m_out[0].backward(m_dy)
+    t_y.backward(t_dy)
+    tol = 1e-4 if dtype == "float32" else 5e-2
+    for m_t, t_t in zip(m_tables, t_tables):
+        check(m_t.grad, t_t.grad, rtol=tol, atol=tol)
+    check(m_w.grad, t_w.grad, rtol=tol, atol=tol)
+    check(m_b.grad, t_b.grad, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,76 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=no-self-use,attribute-defined-outside-init,too-many-locals
+import pytest
+import numpy as np
+
+import raf
+from raf.testing import randn, check, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, op, **kwargs):
+        self.op = op
+        self.attrs = kwargs
+
+    @raf.model.trace
+    def forward(self, x, indices):
+        return self.op(x, indices, **self.attrs)
+
+
+# The cases with fewer than 4 indices per row use atomics, and the others are reduced by sorting.
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize(
+    "shape", [[(1000, 16), (64,)], [(20, 16), (8, 64)], [(4, 50, 3), (300,)], [(7, 5), (1000,)]]
+)
+@pytest.mark.parametrize("axis", [0, 1])
+@pytest.mark.parametrize("mode", ["clip", "wrap"])
+def test_take_dx(shape, axis, mode):
+    x_shape, i_shape = shape
+    axis = min(axis, len(x_shape) - 1)
+    m_x, n_x = randn(x_shape, device="cuda")
+    m_x.requires_grad = True
+    n_indices = np.random.randint(-2, x_shape[axis] + 2, size=i_shape).astype("int64")
+    m_indices = raf.array(n_indices, device="cuda")
+    model = TestModel(raf.take, axis=axis, mode=mode)
+    m_y = model(m_x, m_indices)
+    m_dy, n_dy = randn(m_y.shape, device="cuda")
+    m_y.backward(m_dy)
+    if mode == "clip":
+        rows = np.clip(n_indices, 0, x_shape[axis] - 1)
+    else:
+        rows = np.mod(n_indices, x_shape[axis])
+    n_dx = np.zeros(x_shape, dtype="float32")
+    # Move the axis to the front, and add the rows of dy by the indices.
+    n_dx = np.moveaxis(n_dx, axis, 0)
+    n_dy = np.moveaxis(n_dy, list(range(axis, axis + len(i_shape))), list(range(len(i_shape))))
+    np.add.at(n_dx, rows.reshape(-1), n_dy.reshape((-1,) + n_dx.shape[1:]))
+    check(m_x.grad, np.moveaxis(n_dx, 0, axis), rtol=1e-4, atol=1e-4)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dshape", [(3, 40), (50, 4, 6)])
+@pytest.mark.parametrize("axis", [0, 1])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_gather_dx(dshape, axis, dtype):
+    m_x, n_x = randn(dshape, device="cuda", dtype=dtype)
+    m_x.requires_grad = True
+    n_indices = np.random.randint(0, dshape[axis], size=dshape).astype("int64")
+    m_indices = raf.array(n_indices, device="cuda")
+    model = TestModel(lambda x, i, axis: raf.gather(x, axis, i), axis=axis)
+    m_y = model(m_x, m_indices)
+    m_dy, n_dy = randn(m_y.shape, device="cuda", dtype=dtype)
+    m_y.backward(m_dy)
+    n_dx = np.zeros(dshape, dtype="float32")
+    coords = list(np.indices(dshape))
+    coords[axis] = n_indices
+    np.add.at(n_dx, tuple(coords), n_dy.astype("float32"))
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    check(m_x.grad, n_dx.astype(dtype), rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
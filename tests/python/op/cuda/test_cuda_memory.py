@@ -43,5 +43,44 @@ def test_tensor_fusion_and_defusion(shape, dtype):
     check(x, y_c, rtol=rtol, atol=atol)
 
 
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("num", [3, 100])
+@pytest.mark.parametrize("axis", [0, 1, -1])
+@pytest.mark.parametrize("dtype", ["float32", "float16", "uint8"])
+def test_concatenate_and_split(num, axis, dtype):
+    # The odd sizes break the alignments of the vectorized copies.
+    sizes = [np.random.randint(1, 9) for _ in range(num)]
+    shapes = []
+    for size in sizes:
+        shape = [4, 6, 5]
+        shape[axis] = size
+        shapes.append(shape)
+    indices = [int(i) for i in np.cumsum(sizes)[:-1]]
+
+    class Concatenate(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, *xs):
+            return raf.concatenate(xs, axis=axis)
+
+    class Split(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.split(x, indices, axis=axis)
+
+    n_xs = [(np.random.randn(*shape) * 10).astype(dtype) for shape in shapes]
+    m_xs = [raf.array(x, device="cuda") for x in n_xs]
+    m_y = run_model(Concatenate(), m_xs, "cuda")
+    check(m_y, np.concatenate(n_xs, axis=axis))
+    m_parts = run_model(Split(), [m_y], "cuda")
+    for m_part, n_x in zip(m_parts, n_xs):
+        check(m_part, n_x)
+
 if __name__ == "__main__":
     pytest.main([__file__])
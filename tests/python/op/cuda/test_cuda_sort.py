@@ -0,0 +1,70 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=no-self-use,protected-access,attribute-defined-outside-init
+import pytest
+import numpy as np
+
+import raf
+from raf.testing import run_vm_model, check, with_dialect
+
+
+class TestModel(raf.Model):
+    def build(self, op, **kwargs):
+        self.op = op
+        self.attrs = kwargs
+
+    @raf.model.trace
+    def forward(self, x):
+        return self.op(x, **self.attrs)
+
+
+def distinct_data(shape, dtype):
+    # The keys of a row are distinct, so the orders of ties do not matter.
+    rows = [np.random.permutation(shape[-1]) for _ in range(int(np.prod(shape[:-1])))]
+    return np.stack(rows).reshape(shape).astype(dtype)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 5000), (6, 7, 33)])
+@pytest.mark.parametrize("dtype", ["float32", "int64"])
+@pytest.mark.parametrize("is_ascend", [True, False])
+def test_sort_argsort(shape, dtype, is_ascend):
+    n_x = distinct_data(shape, dtype)
+    m_x = raf.array(n_x, device="cuda")
+    n_idx = np.argsort(n_x, axis=-1)
+    if not is_ascend:
+        n_idx = np.flip(n_idx, axis=-1)
+    n_y = np.take_along_axis(n_x, n_idx, axis=-1)
+    model = TestModel(raf._op.sym.sort, is_ascend=is_ascend)
+    check(run_vm_model(model, "cuda", [m_x]), n_y)
+    model = TestModel(raf._op.sym.argsort, is_ascend=is_ascend, dtype="int64")
+    check(run_vm_model(model, "cuda", [m_x]), n_idx)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 2048), (8, 1031)])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@pytest.mark.parametrize("k", [1, 4])
+@pytest.mark.parametrize("ret_type", ["both", "values", "indices"])
+def test_topk(shape, dtype, k, ret_type):
+    # float16 keeps the integers up to 2048 exactly.
+    n_x = distinct_data(shape, dtype)
+    m_x = raf.array(n_x, device="cuda")
+    n_idx = np.flip(np.argsort(n_x, axis=-1), axis=-1)[:, :k].astype("int64")
+    n_val = np.take_along_axis(n_x, n_idx, axis=-1)
+    model = TestModel(raf._op.sym.topk, k=k, ret_type=ret_type)
+    m_y = run_vm_model(model, "cuda", [m_x])
+    if ret_type == "both":
+        check(m_y[0], n_val)
+        check(m_y[1], n_idx)
+    elif ret_type == "values":
+        check(m_y, n_val)
+    else:
+        check(m_y, n_idx)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,142 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=no-self-use,attribute-defined-outside-init,too-many-locals,too-many-arguments
+import pytest
+import numpy as np
+
+import raf
+from raf.testing import run_vm_model, check, with_dialect
+
+
+def make_boxes(batch, num_boxes, num_classes):
+    # (class id, score, x1, y1, x2, y2), where the scores are distinct.
+    data = np.zeros((batch, num_boxes, 6), dtype="float32")
+    data[:, :, 0] = np.random.randint(-1, num_classes, size=(batch, num_boxes))
+    for i in range(batch):
+        data[i, :, 1] = np.random.permutation(num_boxes) / num_boxes
+    corners = np.random.uniform(0, 100, size=(batch, num_boxes, 2))
+    sizes = np.random.uniform(5, 30, size=(batch, num_boxes, 2))
+    data[:, :, 2:4] = corners
+    data[:, :, 4:6] = corners + sizes
+    return data
+
+
+def iou(a, b):
+    w = max(0.0, min(a[2], b[2]) - max(a[0], b[0]))
+    h = max(0.0, min(a[3], b[3]) - max(a[1], b[1]))
+    inter = w * h
+    union = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter
+    return 0.0 if union <= 0 else inter / union
+
+
+def ref_nms(data, valid_count, indices, max_output_size, iou_threshold, force_suppress, top_k):
+    batch, num_boxes, _ = data.shape
+    out = np.full(data.shape, -1, dtype="float32")
+    box_indices = np.full((batch, num_boxes), -1, dtype="int32")
+    counts = np.zeros((batch, 1), dtype="int32")
+    for b in range(batch):
+        order = np.argsort(-data[b, : valid_count[b], 1], kind="stable")
+        if 0 < top_k < len(order):
+            order = order[:top_k]
+        boxes = data[b, order].copy()
+        kept = []
+        for j, box in enumerate(boxes):
+            if 0 <= max_output_size <= len(kept):
+                break
+            if box[1] <= -1:
+                continue
+            suppressed = False
+            for k in kept:
+                same = force_suppress or boxes[k][0] == box[0]
+                if same and box[1] > 0 and iou(boxes[k][2:], box[2:]) >= iou_threshold:
+                    suppressed = True
+                    break
+            if not suppressed:
+                kept.append(j)
+        for j, box in enumerate(boxes):
+            out[b, j] = box
+            if j not in kept:
+                out[b, j, :2] = -1
+        for c, j in enumerate(kept):
+            box_indices[b, c] = indices[b, order[j]]
+        counts[b] = len(kept)
+    return out, box_indices, counts
+
+
+class NMSModel(raf.Model):
+    def build(self, force_suppress, top_k, return_indices):
+        self.force_suppress = force_suppress
+        self.top_k = top_k
+        self.return_indices = return_indices
+
+    @raf.model.trace
+    def forward(self, data, valid_count, indices, max_output_size, iou_threshold):
+        return raf.non_max_suppression(
+            data,
+            valid_count,
+            indices,
+            max_output_size,
+            iou_threshold,
+            force_suppress=self.force_suppress,
+            top_k=self.top_k,
+            return_indices=self.return_indices,
+        )
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 100), (3, 700)])
+@pytest.mark.parametrize("force_suppress", [True, False])
+@pytest.mark.parametrize("top_k", [-1, 50])
+@pytest.mark.parametrize("max_output_size", [-1, 20])
+def test_nms(shape, force_suppress, top_k, max_output_size):
+    batch, num_boxes = shape
+    n_data = make_boxes(batch, num_boxes, 3)
+    n_valid_count = np.random.randint(num_boxes // 2, num_boxes + 1, size=(batch,)).astype("int32")
+    n_indices = np.tile(np.arange(num_boxes, dtype="int32"), (batch, 1))
+    n_max_output_size = np.array(max_output_size).astype("int32")
+    n_iou_threshold = np.array(0.3).astype("float32")
+    inputs = [n_data, n_valid_count, n_indices, n_max_output_size, n_iou_threshold]
+    m_inputs = [raf.array(x, device="cuda") for x in inputs]
+    n_out, n_box_indices, n_counts = ref_nms(
+        n_data, n_valid_count, n_indices, max_output_size, 0.3, force_suppress, top_k
+    )
+    model = NMSModel(force_suppress, top_k, False)
+    check(run_vm_model(model, "cuda", m_inputs), n_out)
+    model = NMSModel(force_suppress, top_k, True)
+    v_out = run_vm_model(model, "cuda", m_inputs)
+    check(v_out[0], n_box_indices)
+    check(v_out[1], n_counts)
+
+
+@with_dialect(["cuda", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape", [(1, 2500, 6), (4, 700, 6)])
+def test_get_valid_counts(shape):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            return raf.get_valid_counts(x, y, 0, 1)
+
+    n_x = np.random.randn(*shape).astype("float32")
+    n_s = np.array(0.3).astype("float32")
+    n_count = np.zeros((shape[0],), dtype="int32")
+    n_out = np.full(shape, -1, dtype="float32")
+    n_indices = np.full(shape[:2], -1, dtype="int32")
+    for b in range(shape[0]):
+        valid = np.nonzero((n_x[b, :, 1] > 0.3) & (n_x[b, :, 0] >= 0))[0]
+        n_count[b] = len(valid)
+        n_out[b, : len(valid)] = n_x[b, valid]
+        n_indices[b, : len(valid)] = valid
+    v_out = run_vm_model(TestModel(), "cuda", [raf.array(n_x, device="cuda"), raf.array(n_s)])
+    check(v_out[0], n_count)
+    check(v_out[1], n_out)
+    check(v_out[2], n_indices)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -51,6 +51,76 @@ def test_raf_conv2d(xshape, wshape, stride, dilation, padding, dtype):
     check(m_w.grad, t_w.grad, rtol=rtol, atol=atol)
 
 
+@with_dialect(["cudnn", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("benchmark", [False, True])
+def test_raf_conv2d_algo_search(tmp_path, benchmark):
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            return raf.conv2d(x, w, padding=1)
+
+    config = raf._core.backends.cudnn
+    old_benchmark, old_limit = config.benchmark, config.workspace_limit
+    raf._ffi.cache.SetPersistCacheRoot(str(tmp_path))
+    try:
+        config.benchmark = benchmark
+        config.workspace_limit = 1 << 20
+        # Use different shapes for each case, as the algorithms are also cached in memory.
+        channels = 16 if benchmark else 8
+        m_x, t_x = randn_torch((4, channels, 28, 28), device="cuda", std=0.1)
+        m_w, t_w = randn_torch((32, channels, 3, 3), device="cuda", std=0.1)
+        v_y = run_vm_model(TestModel(), "cuda", [m_x, m_w])
+        check(v_y, F.conv2d(t_x, t_w, padding=1), rtol=1e-4, atol=1e-4)
+        # The picked algorithm is persisted for the other processes sharing the cache.
+        entries = list((tmp_path / "cudnn_conv_fwd_algo_perf").iterdir())
+        assert any((entry / "timestamp").exists() for entry in entries)
+    finally:
+        config.benchmark, config.workspace_limit = old_benchmark, old_limit
+        raf._ffi.cache.SetPersistCacheRoot("")
+
+
+@with_dialect(["cudnn", "tvm"])
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("bias_op", ["bias_add", "add"])
+@pytest.mark.parametrize("relu", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_raf_conv2d_bias_act(bias_op, relu, dtype):
+    # pylint: disable=protected-access
+    class TestModel(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, b):
+            y = raf.conv2d(x, w, padding=1)
+            if bias_op == "bias_add":
+                y = raf.bias_add(y, b, axis=1)
+            else:
+                y = raf.add(y, raf.reshape(b, (16, 1, 1)))
+            return raf.relu(y) if relu else y
+
+    model = TestModel()
+    m_x, t_x = randn_torch((8, 3, 32, 32), device="cuda", std=0.1, dtype=dtype)
+    m_w, t_w = randn_torch((16, 3, 3, 3), device="cuda", std=0.1, dtype=dtype)
+    m_b, t_b = randn_torch((16,), device="cuda", dtype=dtype)
+    mod = model._internal(m_x, m_w, m_b).mod
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.InferType()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+    assert "conv2d_fusion" in raf.ir.AsText(mod["main"])
+    v_y = run_vm_model(model, "cuda", [m_x, m_w, m_b])
+    t_y = F.conv2d(t_x, t_w, t_b, padding=1)
+    t_y = torch.relu(t_y) if relu else t_y
+    tol = 1e-4 if dtype == "float32" else 4e-2
+    check(v_y, t_y, rtol=tol, atol=tol)
+
+
 @with_dialect(["cudnn", "tvm"])
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 @pytest.mark.parametrize(
@@ -0,0 +1,67 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=too-many-locals,too-many-arguments,protected-access,no-member
+# pylint: disable=attribute-defined-outside-init
+import numpy as np
+import pytest
+import torch
+
+import raf
+from raf.testing import randn_torch, run_vm_model, check, DialectChecker
+
+
+def verify_ir(mod):
+    with raf.device("cuda"):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+        DialectChecker("cutlass").visit(mod["main"])
+
+
+@pytest.mark.skipif(not raf.build.with_cutlass(), reason="CUTLASS is not enabled")
+@pytest.mark.parametrize("group_sizes", [[7, 0, 9], [16, 32, 8, 24]])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+@pytest.mark.parametrize(
+    "epilogue",
+    [
+        [None, None],
+        [raf._op.sym.relu, torch.nn.functional.relu],
+        [raf._op.sym.gelu, torch.nn.GELU()],
+    ],
+)
+@pytest.mark.parametrize("with_residual", [False, True])
+def test_grouped_matmul_epilogue(group_sizes, dtype, epilogue, with_residual):
+    m_epilogue, t_epilogue = epilogue
+
+    class TestModel(raf.Model):
+        def build(self):
+            self.epilogue = m_epilogue
+
+        @raf.model.trace
+        def forward(self, x, w, sizes, residual):  # pylint: disable=no-self-use
+            y = raf.grouped_matmul(x, w, sizes)
+            y = raf.add(y, residual) if with_residual else y
+            y = self.epilogue(y) if self.epilogue else y
+            return y
+
+    device = "cuda"
+    k, n = 32, 16
+    m_x, t_x = randn_torch([sum(group_sizes), k], device=device, dtype=dtype)
+    m_w, t_w = randn_torch([len(group_sizes), k, n], device=device, dtype=dtype)
+    m_r, t_r = randn_torch([sum(group_sizes), n], device=device, dtype=dtype)
+    m_sizes = raf.array(np.array(group_sizes, dtype="int64"), device=device)
+    model = TestModel()
+    model.to(device=device)
+    mod = model._internal(m_x, m_w, m_sizes, m_r).mod
+    verify_ir(mod)
+    m_y = run_vm_model(model, device, [m_x, m_w, m_sizes, m_r])
+    t_y = torch.cat([torch.matmul(x, w) for x, w in zip(torch.split(t_x, group_sizes), t_w)])
+    t_y = t_y + t_r if with_residual else t_y
+    t_y = t_epilogue(t_y) if t_epilogue else t_y
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_y, t_y, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,43 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, no-self-use
+import pytest
+import torch
+
+import raf
+from raf._core.executor import VMExecutor
+from raf._core.vm import VMCompiler
+from raf.testing import randn_torch, check
+
+
+@pytest.mark.skipif(not raf.build.with_tensorrt(), reason="TensorRT is not enabled")
+@pytest.mark.parametrize("transpose_b", [False, True])
+def test_matmul_bias_relu(transpose_b):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, bias):
+            y = raf.matmul_nt(x, w) if transpose_b else raf.matmul(x, w)
+            return raf.relu(raf.add(y, bias))
+
+    device = "cuda"
+    m_x, t_x = randn_torch((16, 32), device=device)
+    m_w, t_w = randn_torch((64, 32) if transpose_b else (32, 64), device=device)
+    m_bias, t_bias = randn_torch((64,), device=device)
+    model = Model()
+    mod = model._internal(m_x, m_w, m_bias).mod
+    with raf.ir.PassContext(opt_level=3, config={"raf.partition.target": "tensorrt"}):
+        opt_mod, _ = VMCompiler().optimize(mod, device)
+        executor = VMExecutor(mod, device)
+    assert 'Dialect="tensorrt"' in raf.ir.AsText(opt_mod["main"])
+    m_y = executor.make_executor()(m_x, m_w, m_bias)
+    t_w = t_w.t() if transpose_b else t_w
+    t_y = torch.relu(torch.matmul(t_x, t_w) + t_bias)
+    check(m_y, t_y, rtol=1e-3, atol=1e-3)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
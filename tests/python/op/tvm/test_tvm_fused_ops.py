@@ -46,5 +46,74 @@ def test_avg_pool2d_dx_fuse_relu_dx(device):
     run_vm_model(model, device, [x])
 
 
+def test_schedule_database(tmp_path):
+    # pylint: disable=attribute-defined-outside-init, import-outside-toplevel, protected-access
+    from raf.utils.tuner import set_schedule_database
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.add(x, x))
+
+    def num_cache_set():
+        metric = raf._ffi.cache.DumpTVMCacheMetric("tvm_cpu")
+        return int(metric["CacheSet"]) if "CacheSet" in metric else 0
+
+    model = Model()
+    x = raf.array(np.random.randn(3, 17), dtype="float32", device="cpu")
+    run_vm_model(model, "cpu", [x])
+
+    # The kernels compiled with the tuning records are not taken from the kernels compiled with
+    # the builtin schedules.
+    log_file = str(tmp_path / "records.json")
+    open(log_file, "w").close()  # pylint: disable=consider-using-with
+    num_set = num_cache_set()
+    try:
+        set_schedule_database(log_file)
+        out = run_vm_model(model, "cpu", [x])
+    finally:
+        set_schedule_database(None)
+    assert num_cache_set() == num_set + 1
+    np.testing.assert_allclose(out.numpy(), np.maximum(x.numpy() * 2, 0), rtol=1e-5)
+
+
+def test_symbolic_shape():
+    # pylint: disable=attribute-defined-outside-init, protected-access
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            return raf.relu(raf.add(x, y))
+
+    def num_cache_set():
+        metric = raf._ffi.cache.DumpTVMCacheMetric("tvm_cpu")
+        return int(metric["CacheSet"]) if "CacheSet" in metric else 0
+
+    def run(seq_length):
+        model = Model()
+        n_x = np.random.randn(3, seq_length, 23).astype("float32")
+        n_y = np.random.randn(1, seq_length, 23).astype("float32")
+        m_x = raf.array(n_x, device="cpu")
+        m_y = raf.array(n_y, device="cpu")
+        mod = model._internal(m_x, m_y).mod
+        with raf.ir.PassContext(config={"raf.tvm.symbolic_shape": True}):
+            executable = raf._core.vm.compile(mod, "cpu")
+            out = raf._core.vm.VirtualMachine(executable, "cpu").run(m_x, m_y)
+        np.testing.assert_allclose(out.numpy(), np.maximum(n_x + n_y, 0), rtol=1e-5)
+
+    # The sequence lengths in [32, 64) share a kernel.
+    num_set = num_cache_set()
+    run(33)
+    run(47)
+    assert num_cache_set() == num_set + 1
+    run(64)
+    assert num_cache_set() == num_set + 2
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
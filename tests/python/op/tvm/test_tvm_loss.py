@@ -175,5 +175,34 @@ def test_sgd(shape):
     np.testing.assert_allclose(m_x1.numpy(), n_x1, 1e-4, 1e-4)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_multi_tensor_ops(device, dtype):
+    shapes = [[3, 5], [70000], [1]]
+    n_xs = [np.random.randn(*shape).astype(dtype) for shape in shapes]
+    m_xs = [raf.array(n_x, device=device) for n_x in n_xs]
+    atol = 1e-5 if dtype == "float32" else 1e-2
+
+    m_ys = raf.multi_tensor_scale(m_xs, 0.5, "float32")
+    for m_y, n_x in zip(m_ys, n_xs):
+        assert m_y.dtype == "float32"
+        np.testing.assert_allclose(m_y.numpy(), n_x.astype("float32") * 0.5, atol, atol)
+    m_zs = raf.multi_tensor_scale(m_xs, 0.0)
+    for m_z, n_x in zip(m_zs, n_xs):
+        assert m_z.dtype == dtype
+        np.testing.assert_equal(m_z.numpy(), np.zeros_like(n_x))
+
+    n_norm = np.sqrt(sum(np.sum(n_x.astype("float32") ** 2) for n_x in n_xs))
+    m_norm = raf.multi_tensor_l2norm(m_xs)
+    np.testing.assert_allclose(m_norm.numpy(), n_norm, 1e-4, 1e-4)
+
+    for max_norm in [n_norm * 0.5, n_norm * 2]:
+        outs = raf.multi_tensor_clip_by_global_norm(m_xs, max_norm)
+        coef = min(1.0, max_norm / (n_norm + 1e-6))
+        np.testing.assert_allclose(outs[-1].numpy(), n_norm, 1e-4, 1e-4)
+        for m_y, n_x in zip(outs[:-1], n_xs):
+            np.testing.assert_allclose(m_y.numpy(), n_x.astype("float32") * coef, atol, atol)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -117,6 +117,58 @@ def test_dense(n, m, k, device):
     check(m_b.grad, np.matmul(n_dyt, n_a))
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("group_sizes", [[3, 0, 5], [1, 2, 3, 4]])
+def test_grouped_matmul(group_sizes, device):
+    class GroupedMatmul(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w, sizes):
+            return raf.grouped_matmul(x, w, sizes)
+
+    model = GroupedMatmul()
+    k, n = 4, 6
+    m_x, n_x = randn((sum(group_sizes), k), device=device)
+    m_w, n_w = randn((len(group_sizes), k, n), device=device)
+    m_sizes = raf.array(np.array(group_sizes, dtype="int64"), device=device)
+    m_y = model(m_x, m_w, m_sizes)
+    v_y = run_vm_model(model, device, [m_x, m_w, m_sizes])
+    offsets = np.cumsum([0] + group_sizes)
+    n_y = np.concatenate(
+        [np.matmul(n_x[offsets[i] : offsets[i + 1]], n_w[i]) for i in range(len(group_sizes))]
+    )
+    check(m_y, n_y, rtol=1e-4, atol=1e-4)
+    check(v_y, n_y, rtol=1e-4, atol=1e-4)
+
+
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("batched", [False, True])
+def test_qnn_dense(batched, device):
+    class QnnDense(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            q_x = raf.quantize(x, 0.02, "int8")
+            q_w = raf.quantize(w, 0.01, "int8")
+            acc = raf.qnn_batch_matmul_nt(q_x, q_w) if batched else raf.qnn_dense(q_x, q_w)
+            return raf.dequantize(acc, 0.0002, "float32")
+
+    shape = (2, 8, 16) if batched else (8, 16)
+    m_x, n_x = randn(shape, device=device)
+    m_w, n_w = randn(shape[:-2] + (12, 16), device=device)
+    v_y = run_vm_model(QnnDense(), device, [m_x, m_w])
+    q_x = np.clip(np.round(n_x / 0.02), -127, 127).astype("int32")
+    q_w = np.clip(np.round(n_w / 0.01), -127, 127).astype("int32")
+    n_y = np.matmul(q_x, np.swapaxes(q_w, -1, -2)).astype("float32") * 0.0002
+    check(v_y, n_y, rtol=1e-5, atol=1e-5)
+
+
 # pylint: disable=no-member
 # pylint: disable=protected-access
 @with_dialect("tvm")
@@ -820,6 +872,39 @@ def test_raf_dropout(dropout, device):
     check_dropout(x, m_y, x.grad, dy)
 
 
+@with_dialect("tvm")
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("p", [0.1, 0.6])
+def test_counter_dropout(device, p):
+    class TestModel(raf.Model):
+        def build(self, offset):
+            self.offset = offset
+
+        @raf.model.trace
+        def forward(self, x, key):
+            return raf.counter_dropout(x, key, p, self.offset)
+
+    shape = [64, 128]
+    m_x, n_x = randint(shape, low=10, high=20, dtype="float32", device=device)
+    m_x.requires_grad = True
+    key = raf.array(np.array([42], dtype="uint64"), device=device)
+    model = TestModel(0)
+    m_y = model(m_x, key)
+    n_y = m_y.numpy()
+    mask = n_y != 0
+    check(n_y, mask * n_x / (1 - p), rtol=1e-5, atol=1e-5)
+    assert p - 0.05 < np.sum(~mask) / n_y.size < p + 0.05
+    # The mask is a function of the key and the offset, so the VM regenerates the same one.
+    check(run_vm_model(model, device, [m_x, key]), n_y)
+    assert not np.array_equal(TestModel(1)(m_x, key).numpy(), n_y)
+    other_key = raf.array(np.array([7], dtype="uint64"), device=device)
+    assert not np.array_equal(model(m_x, other_key).numpy(), n_y)
+    # The backward regenerates the mask of the forward.
+    m_dy, n_dy = randn(shape, device=device)
+    m_y.backward(m_dy)
+    check(m_x.grad, mask * n_dy / (1 - p), rtol=1e-5, atol=1e-5)
+
+
 @with_seed(0)
 @pytest.mark.parametrize("shape", [(1, 2, 4)])
 @pytest.mark.parametrize("device", get_testable_devices())
@@ -259,6 +259,30 @@ def test_strided_set(device, params, dtype):
     check(v_y, n_y)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("pos", [2, [0, 3, 5]])
+def test_kv_append(device, pos):
+    m_cache, n_cache = randn((3, 2, 6, 4), device=device)
+    m_v, n_v = randn((3, 2, 2, 4), device=device)
+    n_pos = np.array(pos, dtype="int64")
+    m_pos = raf.array(n_pos, device=device)
+    n_y = n_cache.copy()
+    for b in range(3):
+        p = int(n_pos if n_pos.ndim == 0 else n_pos[b])
+        # The steps beyond the max length are dropped.
+        steps = min(2, 6 - p)
+        n_y[b, :, p : p + steps] = n_v[b, :, :steps]
+
+    model = TestModel(raf._op.sym.kv_append)
+    m_y = model(m_cache, m_v, m_pos)
+    check(m_y, n_y)
+    # The cache is updated in place.
+    check(m_cache, n_y)
+    # Appending the same steps again is idempotent.
+    v_y = run_vm_model(model, device, [m_cache, m_v, m_pos])
+    check(v_y, n_y)
+
+
 @pytest.mark.parametrize(
     "shape",
     [
@@ -1068,6 +1092,26 @@ def test_embedding(device, num_weight, hiddend_state, seq_length, dtype):
     check(m_x.grad, mx_x.grad)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_embedding_sparse_dx(device):
+    num_weight, hidden = 50, 8
+    model = TestModel(raf._op.sym.embedding_sparse_dx, num_weight=(num_weight, hidden))
+    n_ind = np.array([[3, 7, 3, -1], [42, 7, 3, 0]], dtype="int64")
+    m_ind = raf.array(n_ind, device=device)
+    m_dy, n_dy = randn((2, 4, hidden), device=device)
+    m_rows, m_values = run_vm_model(model, device, [m_dy, m_ind])
+
+    # The unique rows in the ascending order, and then the padding rows of -1 with zero values.
+    n_rows = np.full((8,), -1, dtype="int64")
+    n_values = np.zeros((8, hidden), dtype="float32")
+    flat_ind, flat_dy = n_ind.reshape(-1), n_dy.reshape(-1, hidden)
+    for i, row in enumerate(np.unique(flat_ind[flat_ind >= 0])):
+        n_rows[i] = row
+        n_values[i] = flat_dy[flat_ind == row].sum(axis=0)
+    check(m_rows, n_rows)
+    check(m_values, n_values, rtol=1e-5, atol=1e-5)
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("shape", [(3, 5)])
 @pytest.mark.parametrize("axis", [0, 1])
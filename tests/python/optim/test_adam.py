@@ -0,0 +1,197 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=unused-variable, attribute-defined-outside-init, protected-access
+from unittest.mock import patch
+import pytest
+import numpy as np
+import torch
+import torch.nn.functional as F
+
+import raf
+from raf.testing import run_vm_model, randn_torch, t2m_param, check
+
+
+class TorchSimpleTest(torch.nn.Module):  # pylint: disable=abstract-method
+    def __init__(self, shape):
+        super(TorchSimpleTest, self).__init__()
+        self.x = torch.nn.Parameter(torch.randn(*shape))
+        self.x.requires_grad = True
+
+    def forward(self):  # pylint: disable=arguments-differ
+        y = F.relu(self.x)
+        return y
+
+
+class RAFSimpleTest(raf.Model):
+    def build(self, shape, dtype="float32"):
+        self.x = raf.array(np.random.randn(*shape).astype(dtype))
+
+    @raf.model.trace
+    def forward(self):
+        y = raf.relu(self.x)
+        return y
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("adamw", [False, True])
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_traced_adam_simple(adamw, dtype):
+    device = "cuda"
+    shape = (2, 3)
+    t_model = TorchSimpleTest(shape)
+    t_model.train()
+    t_model.to(device)
+    optim_cls = torch.optim.AdamW if adamw else torch.optim.Adam
+    t_optimizer = optim_cls(t_model.parameters(), lr=1e-2, weight_decay=0.01)
+    m_model = RAFSimpleTest(shape, dtype)
+    m_model.x = t2m_param(t_model.x.to(getattr(torch, dtype)), device=device)
+    m_model.train_mode()
+    with_optim = raf.optim.with_adamw if adamw else raf.optim.with_adam
+    m_optimizer = with_optim(lr=1e-2, weight_decay=0.01)(m_model)
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    for i in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, requires_grad=False, dtype=dtype)
+        run_vm_model(m_optimizer, device, [m_dy])
+        t_optimizer.zero_grad()
+        t_loss = t_model()
+        t_loss.backward(t_dy.float())
+        t_optimizer.step()
+        check(m_model.x, t_model.x.to(getattr(torch, dtype)), rtol=tol, atol=tol)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_dynamic_loss_scale():
+    device = "cuda"
+    shape = (2, 3)
+    t_model = TorchSimpleTest(shape)
+    t_model.train()
+    t_model.to(device)
+    t_optimizer = torch.optim.Adam(t_model.parameters(), lr=1e-2)
+    m_model = RAFSimpleTest(shape)
+    m_model.x = t2m_param(t_model.x, device=device)
+    m_model.train_mode()
+    m_optimizer = raf.optim.with_adam(
+        lr=1e-2, dynamic_loss_scale=True, init_scale=1024.0, scale_window=2
+    )(m_model)
+    for i in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, requires_grad=False)
+        if i == 1:
+            # The overflowed step is skipped, so the weight is not changed.
+            m_dy = raf.array(np.full(shape, np.inf, dtype="float32"), device=device)
+            run_vm_model(m_optimizer, device, [m_dy])
+        else:
+            run_vm_model(m_optimizer, device, [m_dy])
+            t_optimizer.zero_grad()
+            t_loss = t_model()
+            t_loss.backward(t_dy)
+            t_optimizer.step()
+        check(m_model.x, t_model.x, rtol=1e-4, atol=1e-4)
+    # The scale is halved by the overflow, and doubled again after 2 finite steps.
+    check(m_optimizer.loss_scaler, np.array([1024, 0, 1, 0], dtype="float32"))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_offload(dtype):
+    device = "cuda"
+    shape = (2, 3)
+    t_model = TorchSimpleTest(shape)
+    t_model.train()
+    t_model.to(device)
+    t_optimizer = torch.optim.AdamW(t_model.parameters(), lr=1e-2, weight_decay=0.01)
+    m_model = RAFSimpleTest(shape, dtype)
+    m_model.x = t2m_param(t_model.x.to(getattr(torch, dtype)), device=device)
+    m_model.train_mode()
+    m_optimizer = raf.optim.with_adamw(lr=1e-2, weight_decay=0.01, offload=True)(m_model)
+    # The states are in the pinned memory, and the parameter stays on the device.
+    assert getattr(m_optimizer, "x.m").device == "cpu_pinned"
+    tol = 1e-4 if dtype == "float32" else 1e-2
+    for i in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, requires_grad=False, dtype=dtype)
+        run_vm_model(m_optimizer, device, [m_dy])
+        t_optimizer.zero_grad()
+        t_loss = t_model()
+        t_loss.backward(t_dy.float())
+        t_optimizer.step()
+        assert m_model.x.device.startswith("cuda")
+        check(m_model.x, t_model.x.to(getattr(torch, dtype)), rtol=tol, atol=tol)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("adamw", [False, True])
+def test_quantize_states(adamw):
+    device = "cuda"
+    # Spans a partial block of the states.
+    shape = (3, 1000)
+    t_model = TorchSimpleTest(shape)
+    t_model.train()
+    t_model.to(device)
+    optim_cls = torch.optim.AdamW if adamw else torch.optim.Adam
+    t_optimizer = optim_cls(t_model.parameters(), lr=1e-2, weight_decay=0.01)
+    m_model = RAFSimpleTest(shape)
+    m_model.x = t2m_param(t_model.x, device=device)
+    m_model.train_mode()
+    with_optim = raf.optim.with_adamw if adamw else raf.optim.with_adam
+    m_optimizer = with_optim(lr=1e-2, weight_decay=0.01, quantize_states=True)(m_model)
+    assert getattr(m_optimizer, "x.m").dtype == "int8"
+    assert getattr(m_optimizer, "x.v").dtype == "uint8"
+    assert getattr(m_optimizer, "x.adam_scales").shape == (4,)
+    for i in range(4):
+        m_dy, t_dy = randn_torch(shape, device=device, requires_grad=False)
+        run_vm_model(m_optimizer, device, [m_dy])
+        t_optimizer.zero_grad()
+        t_loss = t_model()
+        t_loss.backward(t_dy)
+        t_optimizer.step()
+        # The 8-bit moments are within a few percents, so are the updates.
+        check(m_model.x, t_model.x, rtol=5e-3, atol=5e-3)
+    v_absmax = getattr(m_optimizer, "x.adam_scales").numpy()[2:]
+    t_v = t_optimizer.state[t_model.x]["exp_avg_sq"].cpu().numpy().reshape(-1)
+    np.testing.assert_allclose(v_absmax, [t_v[:2048].max(), t_v[2048:].max()], rtol=0.1)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@patch("raf.distributed.get_communicator")
+@patch("raf.distributed.get_config")
+def test_state_partition_overlap(mock_get_config, mock_get_comm):
+    """Each bucket of the partitioned Adam updates has its own Adam op. This test only verifies
+    the IR, so it does not require multiple devices.
+    """
+
+    class MockConfig:
+        def __init__(self):
+            self.enable_data_parallel = True
+            self.zero_opt_level = 1
+            self.group_bucket_size = 50000000
+
+    mock_get_config.return_value = MockConfig()
+
+    class MockComm:
+        def __init__(self):
+            self.size = 4
+            self.rank = 3
+
+    mock_get_comm.return_value = MockComm()
+
+    class Model(raf.Model):
+        def build(self):
+            self.w1 = raf.array(np.random.randn(8, 8).astype("float32"))
+            self.w2 = raf.array(np.random.randn(8, 8).astype("float32"))
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.matmul(raf.matmul(x, self.w1), self.w2)
+
+    m_model = Model()
+    m_model.train_mode()
+    m_optimizer = raf.optim.with_adamw(overlap_buckets=2)(m_model)
+    m_x, _ = randn_torch((4, 8), device="cuda")
+    m_dy, _ = randn_torch((4, 8), device="cuda")
+    text = raf.ir.AsText(m_optimizer._internal(m_dy, m_x).mod)
+    assert text.count("raf.op.adamw") == 2, text
+    assert text.count("raf.op._allgather") == 2, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -210,6 +210,42 @@ def test_traced_sgd(config):
         check(m_model.bn1.b, t_model.bn1.bias, rtol=1e-4, atol=1e-4)
 
 
+class RAFEmbeddingTest(raf.Model):
+    # pylint: disable=attribute-defined-outside-init
+    def build(self, num_weight, hidden):
+        self.w = raf.array(np.random.randn(num_weight, hidden).astype("float32"))
+
+    @raf.model.trace
+    def forward(self, indices):
+        return raf.embedding(self.w, indices)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_sparse_embedding_sgd(device):
+    # pylint: disable=protected-access
+    num_weight, hidden, lr = 100, 4, 0.1
+    m_model = RAFEmbeddingTest(num_weight, hidden)
+    m_model.to(device=device)
+    m_model.train_mode()
+    n_w = m_model.w.numpy()
+    n_ind = np.array([5, 17, 5, 99, 0, 17], dtype="int64")
+    m_ind = raf.array(n_ind, device=device)
+    m_dy, n_dy = randn_torch((6, hidden), device=device)
+    n_dy = n_dy.cpu().numpy()
+    with raf.ir.PassContext(config={"raf.sparse_embedding_grad": True}):
+        # The lazy momentum is the same as SGD without momentum.
+        m_optimizer = raf.optim.sgd.with_sgd(learning_rate=lr, momentum=0.0)(m_model)
+        mod = m_optimizer._internal(m_dy, m_ind).mod
+        mod = raf._ffi.pass_.InferType()(mod)
+        mod = raf._ffi.pass_.InlineLet()(mod)
+        mod = raf._ffi.pass_.DeadCodeElimination()(mod)
+        text = raf.ir.AsText(raf._ffi.pass_.SparseEmbeddingGrad()(mod))
+        assert "raf.op.sparse_sgd" in text and "raf.op.embedding_dx" not in text, text
+        run_vm_model(m_optimizer, device, [m_dy, m_ind])
+    np.add.at(n_w, n_ind, -lr * n_dy)
+    check(m_model.w, n_w, rtol=1e-5, atol=1e-5)
+
+
 @with_seed(0)
 @pytest.mark.parametrize("device", get_testable_devices())
 def test_mxnet_model(device):
@@ -0,0 +1,62 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import pytest
+
+import raf
+from raf._lib import relay
+from raf._ffi.pass_ import AccumulateGradient, InferType
+from raf.model import Linear
+from raf.optim.optim import with_autodiff
+from raf.testing import randn
+
+
+class Model(raf.Model):
+    def build(self):
+        self.linear1 = Linear(16, 8)
+        self.linear2 = Linear(8, 4)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = self.linear1(x)
+        out = raf.relu(out)
+        out = self.linear2(out)
+        return out
+
+
+@pytest.mark.parametrize("last_micro_batch", [False, True])
+def test_basic(last_micro_batch):
+    model = Model()
+    model.train_mode()
+    ad_model = with_autodiff(model)
+    m_x, _ = randn((4, 16), dtype="float32")
+    m_dy, _ = randn((4, 4), dtype="float32")
+    mod = InferType()(ad_model._internal(m_dy, m_x).mod)
+    n_params = len(mod["main"].params)
+
+    mod = InferType()(AccumulateGradient(last_micro_batch)(mod))
+    func = mod["main"]
+    text = raf.ir.AsText(func)
+
+    # Each of the 4 weights and biases has an accumulation buffer, which is updated in place.
+    acc_params = [p for p in func.params if p.name_hint.startswith("grad_acc_")]
+    assert len(func.params) == n_params + 4 == n_params + len(acc_params), text
+    let_values = {}
+    body = func.body
+    while isinstance(body, relay.Let):
+        let_values[body.var] = body.value
+        body = body.body
+    acc_grads = set()
+    for var, value in let_values.items():
+        if isinstance(value, relay.Call) and value.args[0] in acc_params:
+            assert value.op.name == "raf.op.add" and value.args[2] == value.args[0]
+            acc_grads.add(var)
+    assert len(acc_grads) == 4, text
+
+    # The returned gradients are the accumulated ones.
+    grads = let_values[let_values[body].fields[1]]
+    assert all(field in acc_grads for field in grads.fields), text
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,84 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,too-many-locals
+import numpy as np
+import pytest
+import raf
+import tvm
+from tvm import relay
+from raf._core.executor import VMExecutor
+from raf._ffi.pass_ import ActivationCompression, InferType
+from raf.ir import ScopeBuilder
+from raf.testing import check, randn
+
+
+def get_mod(shape, n_relus):
+    relu_op = raf._ffi.op.GetOp("raf.op.relu")
+    relu_dx_op = raf._ffi.op.GetOp("raf.op.relu_dx")
+    tanh_op = raf._ffi.op.GetOp("raf.op.tanh")
+    multiply_op = raf._ffi.op.GetOp("raf.op.multiply")
+    null = raf.ir.const(None)
+
+    # The ReLU output and the tanh output are stashed across the relu chain, like the activations
+    # stashed for the backward.
+    sb = ScopeBuilder()
+    p_0 = raf.ir.var("p0", shape=shape)
+    p_1 = raf.ir.var("p1", shape=shape)
+    a_1 = sb.let("a1", relay.Call(relu_op, [p_0]))
+    t_1 = sb.let("t1", relay.Call(tanh_op, [p_0]))
+    b_n = p_1
+    for i in range(n_relus):
+        b_n = sb.let("b%d" % (i + 1), relay.Call(relu_op, [b_n]))
+    d_y = sb.let("dy", relay.Call(multiply_op, [t_1, b_n]))
+    out = sb.let("out", relay.Call(relu_dx_op, [null, a_1, d_y]))
+    sb.ret(out)
+    return tvm.IRModule.from_expr(relay.Function([p_0, p_1], sb.get()))
+
+
+def test_compress():
+    shape = (16, 16)
+    mod = get_mod(shape, 10)
+
+    with raf.ir.PassContext(config={"raf.compress_activation.min_gap": 8}):
+        compressed = ActivationCompression()(InferType()(mod))
+    text = raf.ir.AsText(compressed["main"])
+    # The ReLU output keeps its sign mask, and the tanh output keeps a bfloat16 copy.
+    assert "a1_sign" in text and "a1_compress" in text and "a1_decompress" in text, text
+    assert "t1_compress" in text and "t1_decompress" in text, text
+    assert '"uint8"' in text and '"bfloat16"' in text, text
+
+    # Only the ReLU masks are compressed without the lossy dtype.
+    with raf.ir.PassContext(config={"raf.compress_activation.dtype": ""}):
+        compressed = ActivationCompression()(InferType()(mod))
+    text = raf.ir.AsText(compressed["main"])
+    assert "a1_compress" in text and "t1_compress" not in text, text
+
+    # The masks are lossless.
+    m_p0, n_p0 = randn(shape)
+    m_p1, n_p1 = randn(shape)
+    with raf.ir.PassContext(
+        config={"raf.compress_activation.enable": True, "raf.compress_activation.dtype": ""}
+    ):
+        out = VMExecutor(mod, "cpu").make_executor()(m_p0, m_p1)
+    n_out = np.where(n_p0 > 0, np.tanh(n_p0) * np.maximum(n_p1, 0), 0)
+    check(out, n_out, rtol=1e-5, atol=1e-5)
+
+
+def test_no_compress():
+    shape = (16, 16)
+    mod = InferType()(get_mod(shape, 4))
+
+    # The IR is unchanged when the gaps are shorter than the minimum.
+    compressed = ActivationCompression()(mod)
+    assert tvm.ir.structural_equal(compressed["main"], mod["main"])
+
+    # The IR is unchanged when the peak memory is within the budget.
+    mod = InferType()(get_mod(shape, 10))
+    with raf.ir.PassContext(config={"raf.memory_budget": 1048576}):
+        compressed = ActivationCompression()(mod)
+    assert tvm.ir.structural_equal(compressed["main"], mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,71 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,too-many-locals
+import numpy as np
+import pytest
+import raf
+import tvm
+from tvm import relay
+from raf._core.device import Device
+from raf._core.executor import VMExecutor
+from raf._ffi.pass_ import ActivationOffload, InferType
+from raf.ir import ScopeBuilder
+from raf.testing import check, randn
+
+
+def get_mod(shape, n_relus):
+    relu_op = raf._ffi.op.GetOp("raf.op.relu")
+    add_op = raf._ffi.op.GetOp("raf.op.add")
+    null = raf.ir.const(None)
+
+    sb = ScopeBuilder()
+    p_0 = raf.ir.var("p0", shape=shape)
+    a_1 = sb.let("a1", relay.Call(relu_op, [p_0]))
+    a_n = a_1
+    for i in range(n_relus):
+        a_n = sb.let("a%d" % (i + 2), relay.Call(relu_op, [a_n]))
+    out = sb.let("out", relay.Call(add_op, [a_1, a_n, null, null]))
+    sb.ret(out)
+    return tvm.IRModule.from_expr(relay.Function([p_0], sb.get()))
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_offload():
+    shape = (1024, 1024)  # 4 MBs
+    mod = get_mod(shape, 5)
+
+    with Device("cuda"):
+        with raf.ir.PassContext(config={"raf.memory_budget": 12 * 1048576}):
+            offloaded = ActivationOffload()(InferType()(mod))
+
+    text = raf.ir.AsText(offloaded["main"])
+    # a1 is copied to the host after its first use and prefetched before the add.
+    assert text.count("raf.op.device_copy") == 2, text
+    assert "a1_host" in text and "a1_prefetch" in text, text
+    assert text.count("raf.op.add_event") == 3, text
+    assert text.count("raf.op.wait_event") == 3, text
+
+    m_p0, n_p0 = randn(shape, device="cuda")
+    with raf.ir.PassContext(
+        config={"raf.memory_budget": 12 * 1048576, "raf.offload.enable": True}
+    ):
+        out = VMExecutor(mod, "cuda").make_executor()(m_p0)
+    n_out = np.maximum(n_p0, 0) * 2
+    check(out, n_out)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_no_offload():
+    shape = (1024, 1024)
+    mod = InferType()(get_mod(shape, 5))
+
+    # The IR is unchanged when the peak memory is within the budget.
+    with Device("cuda"):
+        with raf.ir.PassContext(config={"raf.memory_budget": 64 * 1048576}):
+            offloaded = ActivationOffload()(mod)
+    assert tvm.ir.structural_equal(offloaded["main"], mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
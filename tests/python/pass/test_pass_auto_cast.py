@@ -79,6 +79,27 @@ def test_basic():
         verify_correctness(model, device, args, tol=1e-1)
 
 
+def test_bfloat16():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w):
+            return raf.relu(raf.matmul(x, w))
+
+    model = Model()
+    m_x, _ = randn((4, 8))
+    m_w, _ = randn((8, 4))
+    amp_model = raf.amp.autocast(model, [m_x, m_w], dtype="bfloat16", out_dtype="float32")
+    mod = raf._ffi.pass_.InferType()(amp_model._internal(m_x, m_w).mod)
+    text = AsText(mod["main"])
+    assert "float16" not in text.replace("bfloat16", ""), text
+    # Cast x and w to bf16, and cast the output back to fp32.
+    assert text.count("raf.op.cast") == 3, text
+    assert mod["main"].checked_type.ret_type.dtype == "float32"
+
+
 @pytest.mark.parametrize("out_dtype", ["float16", "float32"])
 def test_tuple_n_output_dtype(out_dtype):
     xshape = (1, 3, 224, 224)
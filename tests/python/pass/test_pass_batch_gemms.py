@@ -0,0 +1,70 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import numpy as np
+import pytest
+
+import raf
+from raf._ffi.pass_ import BatchGemms, InferType
+from raf.testing import get_testable_devices, randn, run_vm_model, check
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, w1, w2, w3, y):
+        # The dense ops share x, which is broadcast in the batch.
+        d_1 = raf.dense(x, w1)
+        d_2 = raf.dense(x, w2)
+        # Depends on d_1, so it cannot be batched with d_1.
+        d_3 = raf.dense(raf.relu(d_1), w3)
+        # The parts of a split are a view of the split tensor.
+        parts = raf.split(y, 2, axis=0)
+        m_1 = raf.matmul(parts[0], w1)
+        m_2 = raf.matmul(parts[1], w2)
+        return d_1, d_2, d_3, m_1, m_2
+
+
+def test_batch_gemms():
+    m_x, _ = randn((4, 8))
+    m_w1, _ = randn((8, 8))
+    m_w2, _ = randn((8, 8))
+    m_w3, _ = randn((8, 8))
+    m_y, _ = randn((16, 8))
+    mod = Model()._internal(m_x, m_w1, m_w2, m_w3, m_y).mod
+    mod = BatchGemms()(InferType()(mod))
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op.batch_matmul_nt(") == 1, text
+    assert text.count("raf.op.batch_matmul(") == 1, text
+    assert text.count("raf.op.dense(") == 1, text
+    assert text.count("raf.op.matmul(") == 0, text
+    # Only the weights of the dense ops and the matmuls are stacked.
+    assert text.count("raf.op.stack(") == 2, text
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_batch_gemms_vm(device):
+    m_x, n_x = randn((4, 8), device=device)
+    m_w1, n_w1 = randn((8, 8), device=device)
+    m_w2, n_w2 = randn((8, 8), device=device)
+    m_w3, n_w3 = randn((8, 8), device=device)
+    m_y, n_y = randn((16, 8), device=device)
+    model = Model()
+    model.to(device=device)
+    with raf.ir.PassContext(config={"raf.batch_gemms": True}):
+        outs = run_vm_model(model, device, [m_x, m_w1, m_w2, m_w3, m_y])
+    n_d1 = np.matmul(n_x, n_w1.T)
+    n_d2 = np.matmul(n_x, n_w2.T)
+    n_d3 = np.matmul(np.maximum(n_d1, 0), n_w3.T)
+    n_m1 = np.matmul(n_y[:8], n_w1)
+    n_m2 = np.matmul(n_y[8:], n_w2)
+    expected = [n_d1, n_d2, n_d3, n_m1, n_m2]
+    for out, n_out in zip(outs, expected):
+        check(out, n_out, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,83 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+
+import raf
+from raf import distributed as dist
+from raf._ffi.pass_ import CoalesceCollectives, ToGraphNormalForm, ToBasicBlockNormalForm
+from raf._ffi.pass_ import ToANormalForm, InferType
+from raf.testing import randn
+
+
+def optimize(model, args):
+    mod = model._internal(*args).mod
+    mod = ToGraphNormalForm()(mod)
+    mod = ToBasicBlockNormalForm()(mod)
+    mod = ToANormalForm()(mod)
+    mod = InferType()(mod)
+    return CoalesceCollectives()(mod)
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_coalesce_allgather_reduce_scatter():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y, z):
+            a_x = dist.allgather(x, 0)
+            a_y = dist.allgather(y, 0)
+            a_z = dist.allgather(z, 0)
+            out = raf.add(raf.add(a_x, a_y), a_z)
+            r_x = dist.reduce_scatter(out)
+            r_y = dist.reduce_scatter(raf.relu(out))
+            return r_x, r_y
+
+    m_x, _ = randn((4, 4), device="cuda")
+    m_y, _ = randn((4, 4), device="cuda")
+    m_z, _ = randn((4, 4), device="cuda")
+    text = raf.ir.AsText(optimize(Model(), [m_x, m_y, m_z])["main"])
+    # The three independent allgathers are coalesced, while the reduce-scatters are not,
+    # because relu is in between.
+    assert text.count("raf.op._group_allgather") == 1, text
+    assert text.count("raf.op._allgather") == 0, text
+    assert text.count("raf.op._reduce_scatter") == 2, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_coalesce_allreduce():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y, z):
+            a_x = dist.allreduce(x)
+            a_y = dist.allreduce([y, z])
+            # Depends on a_x, so it cannot be in the same launch as a_x.
+            a_z = dist.allreduce(a_x)
+            a_w = dist.allreduce(x, computation="max")
+            return a_y, a_z, a_w
+
+    m_x, _ = randn((4, 4), device="cuda")
+    m_y, _ = randn((4, 4), device="cuda")
+    m_z, _ = randn((4, 4), device="cuda")
+    func = optimize(Model(), [m_x, m_y, m_z])["main"]
+    text = raf.ir.AsText(func)
+    assert text.count("raf.op._allreduce") == 3, text
+
+    # The first two allreduces are fused into one launch of 3 tensors.
+    body = func.body
+    while isinstance(body, raf._lib.relay.Let):
+        value = body.value
+        if isinstance(value, raf._lib.relay.Call) and value.op.name == "raf.op._allreduce":
+            assert len(value.args[0].checked_type.fields) == 3, text
+            break
+        body = body.body
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
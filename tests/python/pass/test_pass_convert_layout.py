@@ -0,0 +1,70 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,attribute-defined-outside-init,too-many-locals
+import pytest
+import torch
+import torch.nn.functional as F
+
+import raf
+from raf._ffi.pass_ import ConvertLayout, InferType
+from raf.testing import check, randn_torch, run_vm_model
+
+
+class ConvNet(raf.Model):
+    def build(self, w_1, b_1, w_2):
+        self.w_1 = w_1
+        self.b_1 = b_1
+        self.w_2 = w_2
+
+    @raf.model.trace
+    def forward(self, x):
+        y = raf.conv2d(x, self.w_1, padding=1)
+        y = raf.bias_add(y, self.b_1)
+        y = raf.relu(y)
+        y = raf.max_pool2d(y, kernel=2, stride=2)
+        z = raf.conv2d(y, self.w_2, padding=1)
+        z = raf.add(z, y)
+        z = raf.adaptive_avg_pool2d(z, (1, 1))
+        return raf.batch_flatten(z)
+
+
+def get_model(device, dtype):
+    m_x, t_x = randn_torch((2, 8, 16, 16), device=device, dtype=dtype)
+    m_w_1, t_w_1 = randn_torch((8, 8, 3, 3), device=device, dtype=dtype)
+    m_b_1, t_b_1 = randn_torch((8,), device=device, dtype=dtype)
+    m_w_2, t_w_2 = randn_torch((8, 8, 3, 3), device=device, dtype=dtype)
+    model = ConvNet(m_w_1, m_b_1, m_w_2)
+    model.to(device=device)
+
+    t_y = F.relu(F.conv2d(t_x, t_w_1, t_b_1, padding=1))
+    t_y = F.max_pool2d(t_y, kernel_size=2, stride=2)
+    t_z = F.conv2d(t_y, t_w_2, padding=1) + t_y
+    t_z = torch.flatten(F.adaptive_avg_pool2d(t_z, (1, 1)), 1)
+    return model, m_x, t_z
+
+
+def test_convert_layout_ir():
+    model, m_x, _ = get_model("cpu", "float32")
+    mod = ConvertLayout("NHWC")(InferType()(model._internal(m_x).mod))
+    text = raf.ir.AsText(mod["main"])
+    assert text.count('"NHWC"') == 6, text
+    assert '"OHWI"' in text and '"NCHW"' not in text, text
+    # The input and the weights are transposed to NHWC, and only the output of the last pool is
+    # transposed back to NCHW for batch_flatten.
+    assert text.count("raf.op.transpose") == 4, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("dtype", ["float32", "float16"])
+def test_convert_layout_vm(dtype):
+    device = "cuda"
+    model, m_x, t_z = get_model(device, dtype)
+    with raf.ir.PassContext(config={"raf.layout.convert": "NHWC"}):
+        m_z = run_vm_model(model, device, [m_x])
+    tol = 1e-4 if dtype == "float32" else 2e-2
+    check(m_z, t_z, rtol=tol, atol=tol)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -599,5 +599,117 @@ def test_fifo_schedule(model_class, shape):
     assert equal_to_any, "\n".join(err_msgs)
 
 
+def get_allreduce_input_ops(func):
+    """Get the ops generating the inputs of the allreduces in the order of issuing."""
+    bindings = {}
+    order = []
+    body = func.body
+    while isinstance(body, tvm.relay.Let):
+        bindings[body.var] = body.value
+        value = body.value
+        if isinstance(value, tvm.relay.Call) and value.op.name == "raf.op._allreduce":
+            order.append(value.args[0])
+        body = body.body
+    return [bindings[bindings[tup].fields[0]].op.name for tup in order]
+
+
+def priority_schedule(func):
+    mod = tvm.IRModule.from_expr(func)
+    with raf.ir.PassContext(config={"raf.data_parallel_schedule.policy": "priority"}):
+        mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+    return mod["main"]
+
+
+def test_priority_schedule_in_iteration():
+    #       /-> atan -> allreduce -----------------------> mul ->
+    #  -> x                                               /
+    #       \-> relu -> allreduce -> atan -> atan -------/
+    shape = (64, 128)
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape)
+    a = builder.call("atan", [x])
+    b = builder.call("relu", [x])
+    r_a = builder.call("_allreduce", [builder.make_tuple([a]), builder.const("sum")])
+    r_b = builder.call("_allreduce", [builder.make_tuple([b]), builder.const("sum")])
+    c = builder.call("atan", [r_b])
+    d = builder.call("atan", [c])
+    e = builder.call("multiply", [r_a, d])
+    func = priority_schedule(tvm.relay.Function([x], builder.ret(e)))
+    # The allreduce of relu is needed earlier by the atan chain.
+    assert get_allreduce_input_ops(func) == ["raf.op.relu", "raf.op.atan"], raf.ir.AsText(func)
+
+
+def test_priority_schedule_next_iteration():
+    # The updated weights are returned for the next iteration, which needs w1 before w2.
+    shape = (64, 64)
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape)
+    w_1 = extended_var("w1", shape=shape)
+    w_2 = extended_var("w2", shape=shape)
+    null = builder.const(None)
+    y_1 = builder.call("matmul", [x, w_1])
+    y_2 = builder.call("matmul", [y_1, w_2])
+    g_1 = builder.call("atan", [y_2])
+    g_2 = builder.call("relu", [y_2])
+    r_1 = builder.call("_allreduce", [builder.make_tuple([g_1]), builder.const("sum")])
+    r_2 = builder.call("_allreduce", [builder.make_tuple([g_2]), builder.const("sum")])
+    new_w1 = builder.call("subtract", [w_1, r_1, null, null])
+    new_w2 = builder.call("subtract", [w_2, r_2, null, null])
+    ret = builder.make_tuple([y_2, new_w2, new_w1])
+    func = priority_schedule(tvm.relay.Function([x, w_1, w_2], builder.ret(ret)))
+    # The gradient of w1 is communicated first, although its update is returned last.
+    assert get_allreduce_input_ops(func) == ["raf.op.atan", "raf.op.relu"], raf.ir.AsText(func)
+
+
+@pytest.mark.parametrize("policy", ["fifo", "priority"])
+@pytest.mark.parametrize("overlap", [True, False])
+def test_overlap_optimizer(policy, overlap):
+    # The update of w2 is ready once its gradient is reduced, but the backward of w1 is not done.
+    shape = (64, 64)
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape)
+    w_1 = extended_var("w1", shape=shape)
+    w_2 = extended_var("w2", shape=shape)
+    null = builder.const(None)
+    y_1 = builder.call("matmul", [x, w_1])
+    y_2 = builder.call("matmul", [y_1, w_2])
+    g_2 = builder.call("relu", [y_2])
+    d_1 = builder.call("matmul", [g_2, w_2])
+    g_1 = builder.call("atan", [builder.call("atan", [d_1])])
+    r_2 = builder.call("_allreduce", [builder.make_tuple([g_2]), builder.const("sum")])
+    r_1 = builder.call("_allreduce", [builder.make_tuple([g_1]), builder.const("sum")])
+    new_w1 = builder.call("subtract", [w_1, r_1, null, null])
+    new_w2 = builder.call("subtract", [w_2, r_2, null, null])
+    ret = builder.make_tuple([y_2, new_w1, new_w2])
+    func = tvm.relay.Function([x, w_1, w_2], builder.ret(ret))
+
+    mod = tvm.IRModule.from_expr(func)
+    config = {
+        "raf.data_parallel_schedule.policy": policy,
+        "raf.data_parallel_schedule.overlap_optimizer": overlap,
+    }
+    with raf.ir.PassContext(config=config):
+        mod = RAFSequential([ToGraphNormalForm(), DataParallelSchedule()])(mod)
+    ops = []
+    body = mod["main"].body
+    while isinstance(body, tvm.relay.Let):
+        value = body.value
+        if isinstance(value, tvm.relay.Call):
+            name = value.op.name
+            if name == "raf.op.subtract":
+                name += "_w1" if value.args[0].same_as(w_1) else "_w2"
+            ops.append(name)
+        body = body.body
+    text = raf.ir.AsText(mod["main"])
+    update = ops.index("raf.op.subtract_w2")
+    last_allreduce = len(ops) - 1 - ops[::-1].index("raf.op._allreduce")
+    if overlap:
+        # Issued right after the reduction of its gradient, and after the matmuls reading w2.
+        assert ops[update - 1] == "raf.op._allreduce", text
+        assert update < last_allreduce, text
+    else:
+        assert update > last_allreduce, text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
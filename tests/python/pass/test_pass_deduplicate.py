@@ -10,7 +10,8 @@ import raf
 from raf._core.module import IRModule
 from raf._lib import relay
 from raf.testing import resnet_cifar10 as resnet
-from raf.testing import check, run_vm_model, with_seed
+from raf._core.executor import VMExecutor
+from raf.testing import check, randn, run_vm_model, with_seed
 
 
 def test_simple_dedeplicate1():
@@ -69,6 +70,50 @@ def test_simple_no_dedeplicate2():
     assert tvm.ir.structural_equal(mod, new_mod)
 
 
+def test_dedeplicate_typed():
+    # The chains of the same ops but different types are not merged when the types are considered.
+    x = raf.ir.var("x", shape=(2, 2))
+    y = raf.ir.var("y", shape=(3, 3))
+    a = raf.ir.op.relu(raf.ir.op.relu(x))
+    b = raf.ir.op.relu(raf.ir.op.relu(y))
+    c = raf.ir.op.relu(raf.ir.op.relu(x))
+    f = relay.Function([x, y], relay.Tuple([a, b, c]))
+    mod = raf._ffi.pass_.InferType()(IRModule.from_expr(f))
+    typed_mod = raf._ffi.pass_.Deduplicate(0, True, True, None)(mod)
+    untyped_mod = raf._ffi.pass_.Deduplicate(0, False, True, None)(mod)
+    assert raf.ir.AsText(typed_mod).count("relu") == 4
+    assert raf.ir.AsText(untyped_mod).count("relu") == 2
+
+
+class Layers(raf.Model):
+    def build(self, num_layers):
+        self.num_layers = num_layers
+
+    @raf.model.trace
+    def forward(self, x, w):
+        for _ in range(self.num_layers):
+            x = raf.relu(raf.add(raf.matmul(x, w), x))
+        return x
+
+
+def test_outline_layers():
+    model = Layers(4)
+    m_x, _ = randn((4, 4))
+    m_w, _ = randn((4, 4))
+    ref_y = model(m_x, m_w)
+    mod = model._internal(m_x, m_w).mod
+    mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+    outlined_mod = raf._ffi.pass_.OutlineLayers(3, False)(mod)
+    assert len(outlined_mod.functions) > 1
+    # The patterns smaller than the minimal size are not outlined.
+    assert len(raf._ffi.pass_.OutlineLayers(100, False)(mod).functions) == 1
+
+    with raf.ir.PassContext(opt_level=3, config={"raf.vm.outline_layers": 3}):
+        vm = VMExecutor(raf._ffi.pass_.InferType()(mod), "cpu").make_executor()
+        y = vm(m_x, m_w)
+    check(y, ref_y)
+
+
 @pytest.mark.parametrize("must_dominate", [True, False])
 def test_resnet_infer(must_dominate):
     x = np.random.randn(1, 3, 32, 32)
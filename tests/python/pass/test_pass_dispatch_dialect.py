@@ -3,6 +3,8 @@
 
 # pylint: disable=attribute-defined-outside-init,invalid-name,protected-access
 # pylint: disable=too-many-locals,too-many-statements,too-many-arguments,no-self-use
+import os
+
 import pytest
 import raf
 from raf.model import Conv2d
@@ -36,9 +38,10 @@ def test_simple():
             return y
 
     def expected(shape):
-        add_op = raf._ffi.op.GetOp("raf.op.tvm.add")
+        # The precompiled kernels of the cuda dialect are dispatched before TVM.
+        add_op = raf._ffi.op.GetOp("raf.op.cuda.add")
         relu_op = raf._ffi.op.GetOp("raf.op.cudnn.relu")
-        log_op = raf._ffi.op.GetOp("raf.op.tvm.log")
+        log_op = raf._ffi.op.GetOp("raf.op.cuda.log")
         null = raf.ir.const(None)
 
         x = raf.ir.var("x", shape=shape)
@@ -76,7 +79,7 @@ def test_conv2d():
         nchw = raf.ir.const("NCHW")
         oihw = raf.ir.const("OIHW")
         null = raf.ir.const(None)
-        add_op = raf._ffi.op.GetOp("raf.op.tvm.add")
+        add_op = raf._ffi.op.GetOp("raf.op.cuda.add")
         conv2d_op = raf._ffi.op.GetOp("raf.op.cudnn.conv2d")
 
         x = raf.ir.var("x", shape=(1, 16, 64, 64))
@@ -134,5 +137,30 @@ def test_dialect_pref():
     assert tvm.ir.structural_equal(mod["main"], func_expected)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_profile_dispatch(tmp_path):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.softmax(raf.relu(x))
+
+    model = Model()
+    m_x, _ = randn((32, 128), device="cpu")
+    cache = str(tmp_path / "latency.bin")
+    config = {"raf.dispatch_dialect.profile": True, "raf.dispatch_dialect.latency_cache": cache}
+    texts = []
+    for _ in range(2):
+        # The second dispatch reuses the latencies saved by the first one.
+        with raf.ir.PassContext(config=config):
+            texts.append(raf.ir.AsText(optimize(model._internal(m_x).mod)["main"]))
+        assert os.path.exists(cache)
+    assert texts[0] == texts[1]
+    assert "raf.op.tvm.softmax" in texts[0] or "raf.op.cudnn.softmax" in texts[0], texts[0]
+    assert any(f"raf.op.{d}.relu" in texts[0] for d in ["tvm", "cudnn", "cuda"]), texts[0]
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
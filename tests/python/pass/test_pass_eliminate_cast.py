@@ -0,0 +1,53 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,attribute-defined-outside-init,no-self-use
+import pytest
+
+import raf
+from raf._ffi.pass_ import EliminateCast, InferType
+from raf.ir import AsText
+from raf.testing import check, randn, run_vm_model
+
+
+class CastModel(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, y):
+        x_1 = raf.cast(x, "float16")
+        x_2 = raf.cast(x, "float16")  # Reuses x_1.
+        y_1 = raf.group_cast((x, y), "float16")
+        y_2 = raf.cast(y, "float16")  # Reuses the field of y_1.
+        x_3 = raf.cast(raf.cast(x_1, "float32"), "float16")  # Reuses x_1 from the chain.
+        z = raf.add(raf.add(x_1, x_2), raf.add(y_1[0], y_2))
+        return raf.cast(raf.add(z, raf.add(y_1[1], x_3)), "float32")
+
+
+def test_eliminate_cast_ir():
+    m_x, _ = randn((4, 4))
+    m_y, _ = randn((4, 4))
+    mod = CastModel()._internal(m_x, m_y).mod
+    mod = EliminateCast()(InferType()(mod))
+    text = AsText(mod["main"])
+    # The cast of x, the output cast and the unused inner cast of the chain.
+    assert text.count("raf.op.cast(") == 3, text
+    # The group cast is kept for y, as y has not been cast before.
+    assert text.count("raf.op.group_cast(") == 1, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_eliminate_cast_vm():
+    device = "cuda"
+    m_x, n_x = randn((4, 4), device=device)
+    m_y, n_y = randn((4, 4), device=device)
+    model = CastModel()
+    m_z = run_vm_model(model, device, [m_x, m_y])
+    n_x, n_y = n_x.astype("float16"), n_y.astype("float16")
+    n_z = (n_x + n_x + n_x + n_y + n_y + n_x).astype("float32")
+    check(m_z, n_z, rtol=1e-2, atol=1e-2)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
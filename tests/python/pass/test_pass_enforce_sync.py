@@ -637,5 +637,88 @@ def test_dependency_analysis(
     dcfg.enable_data_parallel = False
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape,comp_stream,peer_copy_stream", [[(64, 128), 1, 7]])
+def test_peer_device_copy(shape, comp_stream, peer_copy_stream):
+    with Device("cuda(0)"):
+
+        def construct_model_func():
+            # x -> atan -> device_copy -> atan
+            #  \
+            #   -> atan (overlaps with the copy)
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            x_0 = builder.call("atan", [x])
+            x_1 = builder.call(
+                "device_copy", [x_0, raf.ir.const("cuda(0)"), raf.ir.const("cuda(1)")]
+            )
+            x_2 = builder.call("atan", [x])
+            x_3 = builder.call("atan", [x_1])
+            x_4 = builder.make_tuple([x_2, x_3])
+            return tvm.relay.Function([x], builder.ret(x_4))
+
+        mod = tvm.IRModule()
+        mod["main"] = construct_model_func()
+        mod = RAFSequential([EnforceSync()])(mod)
+
+    ops = []
+    for line in raf.ir.AsText(mod["main"]).splitlines():
+        if "raf.op." in line:
+            ops.append(line.split("raf.op.")[1].strip().rstrip(";"))
+    set_peer_stream = f"set_stream(int64(0), int64({peer_copy_stream}))"
+    set_comp_stream = f"set_stream(int64(0), int64({comp_stream}))"
+    copy = ops.index(set_peer_stream)
+    assert ops[copy + 1].startswith("wait_event(") and ops[copy + 1].endswith(
+        f"int64({peer_copy_stream}))"
+    ), ops
+    assert ops[copy + 2].startswith("device_copy"), ops
+    assert ops[copy + 3].startswith("add_event"), ops
+    # The independent atan runs before the compute stream waits for the copy.
+    assert ops[copy + 4] == set_comp_stream, ops
+    assert ops[copy + 5].startswith("atan"), ops
+    assert ops[copy + 6].startswith("wait_event"), ops
+    assert ops[copy + 7].startswith("atan"), ops
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+@pytest.mark.parametrize("shape,comp_stream,update_stream", [[(64, 128), 1, 8]])
+def test_overlap_optimizer(shape, comp_stream, update_stream):
+    with Device("cuda(0)"):
+
+        def construct_model_func():
+            # The update of w follows the allreduce of its gradient, and the multiply reading w.
+            builder = ANFBuilder()
+            x = extended_var("x", shape=shape)
+            w = extended_var("w", shape=shape)
+            null = raf.ir.const(None)
+            x_0 = builder.call("multiply", [x, w])
+            x_1 = builder.call("atan", [x_0])
+            x_2 = builder.make_tuple([x_1])
+            x_3 = builder.call("_allreduce", [x_2, raf.ir.const("sum"), null])
+            x_4 = builder.call("atan", [x_0])
+            x_5 = builder.call("subtract", [w, x_3, null, null])
+            x_6 = builder.make_tuple([x_4, x_5])
+            return tvm.relay.Function([x, w], builder.ret(x_6))
+
+        mod = tvm.IRModule()
+        mod["main"] = construct_model_func()
+        with PassContext(config={"raf.data_parallel_schedule.overlap_optimizer": True}):
+            mod = RAFSequential([EnforceSync()])(mod)
+
+    streams = {}
+    stream = None
+    for line in raf.ir.AsText(mod["main"]).splitlines():
+        if "raf.op." not in line:
+            continue
+        op = line.split("raf.op.")[1].strip().rstrip(";")
+        if op.startswith("set_stream"):
+            stream = int(op.split("int64(")[2].split(")")[0])
+        else:
+            streams.setdefault(op.split("(")[0], []).append(stream)
+    assert streams["subtract"] == [update_stream], streams
+    assert streams["atan"] == [comp_stream, comp_stream], streams
+    assert streams["multiply"] == [comp_stream], streams
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -8,7 +8,7 @@ import tvm
 from tvm import relay
 
 from raf._core.device import Device
-from raf._ffi.pass_ import EstimateGFLOPS
+from raf._ffi.pass_ import EstimateGFLOPS, EstimateCost
 from raf.ir import ScopeBuilder
 from raf.testing import run_infer_type
 
@@ -105,6 +105,29 @@ def test_multi_func():
     verify_flops(get_mod(), {"b1": 10 * 5 * 2})
 
 
+def test_analytic_cost():
+    def get_mod():
+        x = raf.ir.var("x", shape=(4, 8))
+        w = raf.ir.var("w", shape=(16, 8))
+
+        sb = ScopeBuilder()
+        a_1 = sb.let("a1", raf.ir.op.dense(x, w))
+        a_2 = sb.let("a2", raf.ir.op.reshape(a_1, (8, 8)))
+        sb.ret(a_2)
+        func = relay.Function([x, w], sb.get())
+        return tvm.IRModule.from_expr(func)
+
+    mod = get_mod()
+    verify_flops(mod, {"a1": 2 * 4 * 16 * 8, "a2": 0})
+    with Device("cpu"):
+        ret = EstimateCost(run_infer_type(mod))
+        ret = {k.name_hint: [v.value for v in cost] for k, cost in ret.items()}
+    # The bytes read and written are estimated together with the FLOPS.
+    assert ret["a1"][1] == (4 * 8 + 16 * 8 + 4 * 16) * 4
+    # Reshape is a view of its input.
+    assert ret["a2"] == [0, 0]
+
+
 def test_comm():
     shape = (10, 5)
 
@@ -13,16 +13,25 @@ from raf.ir import ScopeBuilder
 from raf.testing import check
 
 
-def verify_memory(mod, device, expected_trace, disable_fusion=True, include_param=False):
-    disabled_pass = []
+def verify_memory(
+    mod,
+    device,
+    expected_trace,
+    disable_fusion=True,
+    include_param=False,
+    disabled_pass=None,
+    config=None,
+):
+    disabled_pass = list(disabled_pass or [])
     if disable_fusion:
         disabled_pass += ["FuseDialect", "FuseTVM"]
 
     compiler = VMCompiler()
-    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass):
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass, config=config):
         mod, _ = compiler.optimize(mod, device)
-    mod = InferType()(mod)
-    trace = [(name, mem.value) for name, mem in EstimateMemory(mod, Device(device), include_param)]
+        mod = InferType()(mod)
+        trace = EstimateMemory(mod, Device(device), include_param)
+    trace = [(name, mem.value) for name, mem in trace]
     assert len(trace) == len(expected_trace)
     for (name, mem), expected in zip(trace, expected_trace):
         assert name != "unknown"
@@ -51,6 +60,12 @@ def test_basic():
     verify_memory(get_mod(), device, [2, 3, 3, 2], True, True)  # Individual ops with parameters.
     verify_memory(get_mod(), device, [1, 1], False)  # Fused to one op.
 
+    # Without memory planning, the storages are released at their last uses by early free.
+    no_plan = ["MemoryPlan"]
+    verify_memory(get_mod(), device, [1, 2, 2, 1], True, disabled_pass=no_plan)
+    config = {"raf.vm.early_free": False}
+    verify_memory(get_mod(), device, [1, 2, 3, 3], True, disabled_pass=no_plan, config=config)
+
 
 @pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
 def test_workspace():
@@ -2,8 +2,9 @@
 # SPDX-License-Identifier: Apache-2.0
 
 import pytest
+import torch
 import raf
-from raf.testing import get_testable_devices, randn, check
+from raf.testing import get_testable_devices, randn, randn_torch, check
 import tvm
 
 
@@ -83,5 +84,90 @@ def test_fold_const_ir(device, shape):
     assert tvm.ir.structural_equal(func_folded, func_expected)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+@pytest.mark.parametrize("with_affine", [True, False])
+def test_fold_conv_batch_norm(device, with_affine):
+    # pylint: disable=protected-access, too-many-locals
+    m_w, t_w = randn_torch([8, 4, 3, 3], device=device)
+    m_mean, t_mean = randn_torch([8], device=device)
+    m_var, t_var = randn_torch([8], device=device, positive=True)
+    m_scale, t_scale = randn_torch([8], device=device)
+    m_shift, t_shift = randn_torch([8], device=device)
+    eps = 1e-3
+
+    class ConvBN(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.w = m_w
+            self.mean = m_mean
+            self.var = m_var
+            self.scale = m_scale if with_affine else None
+            self.shift = m_shift if with_affine else None
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.conv2d(x, self.w, padding=1)
+            y = raf.batch_norm_infer(y, self.mean, self.var, self.scale, self.shift, eps=eps)
+            return raf.relu(y)
+
+    model = ConvBN()
+    model.infer_mode()
+    m_x, t_x = randn_torch([2, 4, 6, 6], device=device)
+    func = model._internal(m_x).mod["main"]
+    params = [model.w, model.mean, model.var]
+    params += [model.scale, model.shift] if with_affine else []
+    args = [m_x._ndarray__handle] + [param._ndarray__handle for param in params]
+    mod = raf._core.module.IRModule.from_expr(raf._ffi.pass_.BindParam(func, args))
+    text = raf.ir.AsText(raf._ffi.pass_.FoldConstant()(mod)["main"])
+    assert "batch_norm_infer" not in text
+    assert "bias_add" in text
+
+    m_y = model(m_x)
+    t_y = torch.nn.functional.conv2d(t_x, t_w, padding=1)
+    t_y = torch.nn.functional.batch_norm(
+        t_y, t_mean, t_var, t_scale if with_affine else None, t_shift if with_affine else None,
+        eps=eps
+    )
+    check(m_y, torch.relu(t_y), rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_fold_const_batch(device):
+    # pylint: disable=protected-access
+    shape = [4, 4]
+    const, _ = randn(shape, device=device)
+
+    class ModelWithConst(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            self.c = const
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.matmul(self.c, self.c)
+            w = raf.transpose(raf.add(y, self.c))
+            return raf.matmul(x, raf.multiply(y, w))
+
+    model = ModelWithConst()
+    model.infer_mode()
+    m_x, _ = randn(shape, device=device)
+    m_ref = model(m_x)
+    with raf.ir.PassContext(config={"raf.fold_constant.batch": True}):
+        m_y = model(m_x)
+    check(m_y, m_ref)
+
+    func = model._internal(m_x).mod["main"]
+    args = [m_x._ndarray__handle, model.c._ndarray__handle]
+    mod = raf._core.module.IRModule.from_expr(raf._ffi.pass_.BindParam(func, args))
+    mod = raf._ffi.pass_.InferType()(mod)
+    for max_bytes, folded in [(0, True), (16, False)]:
+        config = {"raf.fold_constant.batch": True, "raf.fold_constant.max_bytes": max_bytes}
+        with raf.ir.PassContext(config=config):
+            text = raf.ir.AsText(raf._ffi.pass_.FoldConstant()(mod)["main"])
+        # The outputs of 64 bytes are not folded beyond the limit.
+        assert ("raf.op.transpose" not in text) == folded, text
+        assert text.count("raf.op.matmul") == (1 if folded else 2), text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -91,6 +91,27 @@ def test_raf_constant():
     check(data, model())
 
 
+def test_shared_constant():
+    # The functions share an NDArray, e.g., a weight duplicated by the Relay passes.
+    data = _tvm.nd.array(np.random.randn(2, 3).astype("float32"))
+    r_mod = _tvm.IRModule()
+    x = _relay.var("x", shape=(2, 3))
+    r_mod["main"] = _relay.Function([x], _relay.add(x, _relay.Constant(data)))
+    y = _relay.var("y", shape=(2, 3))
+    r_mod["other"] = _relay.Function([y], _relay.multiply(y, _relay.Constant(data)))
+    m_mod = FromRelay()(r_mod)
+
+    constants = []
+    for name in ["main", "other"]:
+        _relay.analysis.post_order_visit(
+            m_mod[name],
+            lambda expr: constants.append(expr) if isinstance(expr, _relay.Constant) else None,
+        )
+    assert len(constants) == 2
+    # It is converted once for both functions.
+    assert constants[0].same_as(constants[1])
+
+
 @pytest.mark.parametrize("use_kwargs", [False, True])
 def test_raf_module(use_kwargs):
     f1 = _relay.GlobalVar("f1")  # pylint: disable=invalid-name
@@ -9,7 +9,7 @@ import raf
 from raf.ir import ScopeBuilder
 from raf.model import Conv2d
 from raf.model.trace import trace_mutate_attr
-from raf.testing import run_infer_type, randn
+from raf.testing import run_infer_type, randn, check, run_vm_model
 import tvm
 from tvm import relay
 
@@ -714,5 +714,77 @@ def test_deduplicate():
     assert tvm.ir.structural_equal(mod_after["main"], func_expected)
 
 
+def test_horizontal():
+    shape = (4, 6)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y, z):
+            a = raf.relu(raf.add(x, x))
+            b = raf.exp(y)
+            c = raf.tanh(z)
+            return a, b, c
+
+    m_x, n_x = randn(shape, device="cpu")
+    m_y, n_y = randn(shape, device="cpu")
+    m_z, n_z = randn(shape, device="cpu")
+    model = Model()
+    mod = model._internal(m_x, m_y, m_z).mod
+
+    def num_fused_funcs(mod):
+        text = raf.ir.AsText(mod["main"])
+        return text.count("Primitive=1")
+
+    with raf.ir.PassContext(config={"raf.fuse_tvm.horizontal": True}):
+        mod_after = fuse_module(mod)
+    # The relu(add) group, exp and tanh are independent, so they are fused into one function
+    # returning a tuple.
+    assert num_fused_funcs(mod_after) == 1
+    fused_func = mod_after["main"].body.fields[2].tuple.op
+    assert len(fused_func.body.fields) == 3
+    assert num_fused_funcs(fuse_module(mod)) == 1
+
+    with raf.ir.PassContext(config={"raf.fuse_tvm.horizontal": True}):
+        executable = raf._core.vm.compile(mod, "cpu")
+        m_a, m_b, m_c = raf._core.vm.VirtualMachine(executable, "cpu").run(m_x, m_y, m_z)
+    check(m_a, np.maximum(n_x + n_x, 0))
+    check(m_b, np.exp(n_y), rtol=1e-5, atol=1e-5)
+    check(m_c, np.tanh(n_z), rtol=1e-5, atol=1e-5)
+
+
+def test_reduce_epilogue():
+    shape = (4, 6)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            # A custom norm: mean -> subtract -> square -> mean -> sqrt.
+            mu = raf.mean(x, axis=1, keepdims=True)
+            var = raf.mean(raf.multiply(raf.subtract(x, mu), raf.subtract(x, mu)), axis=1)
+            return raf.sqrt(raf.exp(var))
+
+    m_x, n_x = randn(shape, device="cpu")
+    model = Model()
+    mod = fuse_module(model._internal(m_x).mod)
+    # The producers are fused into the second mean, and the elementwise consumers are fused
+    # into its epilogue. The first mean is broadcast to its consumers, so it is a single op.
+    call = mod["main"].body
+    assert call.op.body.op.name == "raf.op.tvm.sqrt"
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("Primitive=1") == 1
+    assert "raf.op.tvm.mean" in text
+
+    m_y = run_vm_model(model, "cpu", [m_x])
+    n_mu = np.mean(n_x, axis=1, keepdims=True)
+    n_y = np.sqrt(np.exp(np.mean((n_x - n_mu) * (n_x - n_mu), axis=1)))
+    check(m_y, n_y, rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
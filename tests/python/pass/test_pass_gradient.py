@@ -890,5 +890,44 @@ def test_simplify_sum():
     assert len(list(filter(lambda x: x, sum_ops))) == 1
 
 
+def test_compact_fanout():
+    def get_mod():
+        mod = tvm.IRModule()
+        x = raf.ir.var("x", shape=(1, 100), dtype="float32")
+        a = relay.tanh(x)
+        b = relay.nn.relu(a)
+        c = relay.erf(a)
+        d = relay.multiply(a, a)
+        out = relay.add(relay.add(b, c), d)
+        mod["main"] = relay.Function([x], out)
+        return mod
+
+    def count_ops(mod, name):
+        ops = list()
+        find_op = lambda x: ops.append(isinstance(x, tvm.relay.Call) and x.op.name == name)
+        tvm.relay.analysis.post_order_visit(mod["main"], find_op)
+        return len(list(filter(lambda x: x, ops)))
+
+    mod = FromRelay()(get_mod())
+    ad_mod = ad_passes(mod)
+    with raf.ir.PassContext(config={"raf.autodiff.compact": True}):
+        compact_mod = ad_passes(mod)
+    # The 4 contributions to the gradient of a are summed by a single add_n.
+    assert count_ops(ad_mod, "raf.op.add_n") == 0
+    assert count_ops(compact_mod, "raf.op.add_n") == 1
+    assert count_ops(compact_mod, "raf.op.add") < count_ops(ad_mod, "raf.op.add")
+    assert ad_mod["main"].ret_type == compact_mod["main"].ret_type
+
+    m_x, _ = randn((1, 100))
+    m_dy, _ = randn((1, 100))
+    vm_executor = utils.get_vm_executor(mod, "cpu", pass_seq=vm_passes)
+    expected = vm_executor(m_x, m_dy)
+    with raf.ir.PassContext(config={"raf.autodiff.compact": True}):
+        vm_executor = utils.get_vm_executor(mod, "cpu", pass_seq=vm_passes)
+        actual = vm_executor(m_x, m_dy)
+    check(actual[0], expected[0])
+    check(actual[1], expected[1])
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
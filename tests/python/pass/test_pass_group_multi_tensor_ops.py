@@ -0,0 +1,59 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import numpy as np
+import pytest
+
+import raf
+from raf._ffi.pass_ import GroupMultiTensorOps, InferType
+from raf.testing import get_testable_devices, randn, run_vm_model, check
+
+
+class Model(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x, y, z):
+        a_x = raf.multiply(x, 0.5)
+        a_y = raf.multiply(y, 0.5)
+        # Depends on a_x, so it cannot be grouped with a_x.
+        a_z = raf.multiply(raf.relu(a_x), 0.5)
+        c_x = raf.cast(x, "float16")
+        c_y = raf.cast(y, "float16")
+        c_z = raf.cast(z, "float16")
+        return a_x, a_y, a_z, c_x, c_y, c_z
+
+
+def test_group_multi_tensor_ops():
+    m_x, _ = randn((4, 4))
+    m_y, _ = randn((8,))
+    m_z, _ = randn((2, 3))
+    mod = Model()._internal(m_x, m_y, m_z).mod
+    mod = GroupMultiTensorOps()(InferType()(mod))
+    text = raf.ir.AsText(mod["main"])
+    assert text.count("raf.op.multi_tensor_scale(") == 1, text
+    assert text.count("raf.op.multiply(") == 1, text
+    assert text.count("raf.op.group_cast(") == 1, text
+    assert text.count("raf.op.cast(") == 0, text
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_group_multi_tensor_ops_vm(device):
+    m_x, n_x = randn((4, 4), device=device)
+    m_y, n_y = randn((8,), device=device)
+    m_z, n_z = randn((2, 3), device=device)
+    model = Model()
+    model.to(device=device)
+    with raf.ir.PassContext(config={"raf.group_multi_tensor_ops": True}):
+        outs = run_vm_model(model, device, [m_x, m_y, m_z])
+    n_ax, n_ay = n_x * 0.5, n_y * 0.5
+    n_az = np.maximum(n_ax, 0) * 0.5
+    expected = [n_ax, n_ay, n_az, n_x, n_y, n_z]
+    for out, n_out in zip(outs, expected):
+        check(out, n_out, rtol=1e-2, atol=1e-2)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
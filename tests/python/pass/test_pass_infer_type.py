@@ -13,6 +13,7 @@ from raf._core.ir_ext import extended_var
 from raf._ffi.pass_ import AutoDiff, ExtractBinding, FromRelay, InferType, LambdaLift
 from raf._op import sym as op
 from raf.testing import check, randn, run_infer_type
+from raf.utils import metrics
 from tvm import relay
 
 
@@ -505,5 +506,48 @@ def test_multi_functions():
     assert mod["main"].checked_type == expected_ty
 
 
+def get_two_func_mod():
+    f1 = relay.GlobalVar("f1")
+    x = relay.var("x", shape=(1, 100))
+    tvm_mod = tvm.IRModule()
+    tvm_mod[f1] = relay.Function([x], relay.tanh(x))
+    y = relay.var("y", shape=(1, 100))
+    tvm_mod[relay.GlobalVar("main")] = relay.Function([y], relay.sigmoid(f1(y)))
+    tvm_mod = relay.transform.InferType()(tvm_mod)
+    return FromRelay()(tvm_mod)
+
+
+def test_primitive_type_memo():
+    def get_hits():
+        return metrics.get().get('raf_infer_type_memo_total{result="hit"}', 0)
+
+    mod = InferType()(get_two_func_mod())
+    last_hits = get_hits()
+    # The types of the same primitives with the same arg types are inferred once.
+    mod = InferType()(get_two_func_mod())
+    assert get_hits() >= last_hits + 2
+    assert mod["main"].checked_type.ret_type == relay.TensorType((1, 100))
+
+
+def test_incremental():
+    with raf.ir.PassContext(config={"raf.infer_type.incremental": True}):
+        mod = InferType()(get_two_func_mod())
+        f1 = mod.get_global_var("f1")
+        f1_func = mod["f1"]
+        # Only the changed function is inferred again.
+        y = relay.var("y", shape=(1, 100))
+        mod["main"] = relay.Function([y], relay.Call(f1, [y]))
+        mod = InferType()(mod)
+        assert mod["f1"].same_as(f1_func)
+        assert mod["main"].checked_type.ret_type == relay.TensorType((1, 100))
+
+        # The callers of a changed function are inferred again.
+        x = relay.var("x", shape=(1, 100))
+        mod[f1] = relay.Function([x], relay.Tuple([x, x]))
+        mod = InferType()(mod)
+        assert mod["main"].checked_type.ret_type == relay.TupleType(
+            [relay.TensorType((1, 100)), relay.TensorType((1, 100))]
+        )
+
 if __name__ == "__main__":
     pytest.main([__file__])
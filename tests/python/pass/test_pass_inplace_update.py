@@ -8,6 +8,7 @@ import numpy as np
 import raf
 import tvm
 from raf._ffi import pass_
+from raf._core.executor import VMExecutor
 from raf._core.ir_ext import ExtendedVar
 from raf.ir import ScopeBuilder
 from raf.model.nn import BatchNorm
@@ -370,5 +371,66 @@ def test_group_allgather():
     assert bytecode.count("alloc_tensor") == 0
 
 
+def test_elementwise():
+    def get_mod():
+        relu_op = raf._ffi.op.GetOp("raf.op.relu")
+        tanh_op = raf._ffi.op.GetOp("raf.op.tanh")
+        add_op = raf._ffi.op.GetOp("raf.op.add")
+        matmul_op = raf._ffi.op.GetOp("raf.op.matmul")
+        null = raf.ir.const(None)
+
+        data = raf.ir.var("x", shape=(16, 16))
+        sb = ScopeBuilder()
+        a_1 = sb.let("a1", relay.Call(relu_op, [data]))
+        a_2 = sb.let("a2", relay.Call(tanh_op, [a_1]))
+        a_3 = sb.let("a3", relay.Call(relu_op, [a_2]))
+        a_4 = sb.let("a4", relay.Call(add_op, [a_2, a_3, null, null]))
+        a_5 = sb.let("a5", relay.Call(matmul_op, [a_4, a_4]))
+        sb.ret(a_5)
+        func = relay.Function([data], sb.get())
+        return pass_.InferType()(tvm.IRModule.from_expr(func))
+
+    mod = pass_.ElementwiseInplaceUpdate()(get_mod())
+    variables = extract_vars(mod["main"].body)
+    # %a1 cannot overwrite the parameter, %a3 cannot overwrite %a2 which is used by %a4,
+    # and %a5 is not an elementwise op.
+    alias = {
+        variables[1]: variables[0],
+        variables[3]: variables[1],
+    }
+    checkir(variables, alias)
+
+    device = "cpu"
+    m_x, n_x = randn((16, 16), device=device)
+    with raf.ir.PassContext(config={"raf.inplace_update.elementwise": True}):
+        out = VMExecutor(get_mod(), device).make_executor()(m_x)
+    n_a2 = np.tanh(np.maximum(n_x, 0))
+    n_a4 = n_a2 + np.maximum(n_a2, 0)
+    check(out, np.matmul(n_a4, n_a4), rtol=1e-4, atol=1e-4)
+
+
+def test_sgd():
+    sgd_op = raf._ffi.op.GetOp("raf.op.sgd")
+    shape = (4, 4)
+    x = raf.ir.var("x", shape=shape)
+    dx = raf.ir.var("dx", shape=shape)
+    v = raf.ir.var("v", shape=shape)
+    sb = ScopeBuilder()
+    out = sb.let("a1", relay.Call(sgd_op, [x, dx, v, raf.ir.const(0.1), raf.ir.const(0.01)]))
+    v_1 = sb.let("a2", relay.TupleGetItem(out, 0))
+    x_1 = sb.let("a3", relay.TupleGetItem(out, 1))
+    ret = sb.let("a4", relay.Tuple([v_1, x_1]))
+    sb.ret(ret)
+    mod = optimize(tvm.IRModule.from_expr(relay.Function([x, dx, v], sb.get())))
+    func = mod["main"]
+    variables = extract_vars(func.body)
+    # The momentum and the weight are updated in place.
+    alias = {
+        variables[1]: func.params[2],
+        variables[2]: func.params[0],
+    }
+    checkir(variables, alias)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
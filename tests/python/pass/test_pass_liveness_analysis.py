@@ -510,5 +510,30 @@ def test_fuse_closure():
     verify_live_in_set(mod, expected)
 
 
+def test_cached_result():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            t_0 = raf.relu(x)
+            t_1 = raf.add(t_0, x)
+            return t_1
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((5, 5))
+    mod = InferType()(model._internal(m_x).mod)
+
+    # Analyzing the same function again reuses the cached result, whose dummy vars are the same.
+    ret0 = LivenessAnalysis(mod)
+    ret1 = LivenessAnalysis(mod)
+    assert len(ret0) == len(ret1)
+    for key, var_list in ret0.items():
+        assert key in ret1
+        assert {v.handle.value for v in var_list} == {v.handle.value for v in ret1[key]}
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,67 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+import raf
+from raf.ir import RAFSequential
+from raf._ffi.pass_ import AnnotateTarget, MergeCompilerRegions, PartitionGraph
+from raf._ffi.pass_ import LowerCompilerRegions, InferType
+from raf._lib import tvm
+from raf._lib import relay as _relay
+from raf.testing import randn
+
+
+def test_lower_region():
+    # pylint: disable=redefined-builtin, unused-variable
+    target = "test_lower_region"
+
+    @tvm.ir.register_op_attr("raf.op.relu", "target." + target)
+    def relu(attrs, args):  # pylint: disable=unused-argument
+        return True
+
+    @tvm.ir.register_op_attr("raf.op.abs", "target." + target)
+    def abs(attrs, args):  # pylint: disable=unused-argument
+        return True
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a_1 = raf.abs(raf.relu(x))
+            return raf.tanh(a_1)
+
+    m_x, _ = randn((10, 10), device="cpu")
+    mod = Model()._internal(m_x).mod
+    seq = RAFSequential(
+        [
+            AnnotateTarget([target]),
+            MergeCompilerRegions(),
+            PartitionGraph(),
+            LowerCompilerRegions(),
+            InferType(),
+        ]
+    )
+    mod = seq(mod)
+
+    calls = []
+
+    def visit(expr):
+        if isinstance(expr, _relay.Call) and isinstance(expr.op, _relay.Function):
+            calls.append(expr)
+
+    _relay.analysis.post_order_visit(mod["main"].body, visit)
+    assert len(calls) == 1
+    call = calls[0]
+    # The captured input is passed as an argument of the primitive function of the target.
+    assert call.op.attrs["Primitive"] == 1
+    assert call.op.attrs["Dialect"] == target
+    assert len(call.op.params) == 1 and call.args[0] == mod["main"].params[0]
+    assert not _relay.analysis.free_vars(call.op)
+    assert tuple(mod["main"].checked_type.ret_type.shape) == (10, 10)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -14,7 +14,8 @@ from tvm.ir.transform import module_pass
 from tvm.relay.transform import function_pass, FunctionPass
 from raf._ffi import pass_
 from raf._ffi.pass_ import FromRelay
-from raf.ir import RAFSequential
+from raf.ir import RAFSequential, set_pass_cache_size
+from raf.utils import metrics
 
 
 def get_var_func():
@@ -156,5 +157,74 @@ def test_sequential_pass():
     assert isinstance(ret_mod["mySub"].body.checked_type, tvm.ir.TensorType)
 
 
+def test_pass_cache():
+    def get_mod():
+        x = relay.var("x", relay.TensorType((10,), "float32"))
+        mod = tvm.IRModule({relay.GlobalVar("main"): relay.Function([x], relay.log(x))})
+        return FromRelay()(mod)
+
+    def get_hits():
+        return metrics.get().get('raf_pass_cache_total{result="hit"}', 0)
+
+    set_pass_cache_size(8)
+    try:
+        mod_1, mod_2 = get_mod(), get_mod()
+        ret_1 = pass_.InferType()(mod_1)
+        hits = get_hits()
+        ret_2 = pass_.InferType()(mod_2)
+        assert get_hits() == hits + 1
+        assert tvm.ir.structural_equal(ret_1, ret_2)
+        # The cached result uses the vars of the module it is applied to.
+        assert ret_2["main"].params[0].same_as(mod_2["main"].params[0])
+        assert isinstance(ret_2["main"].body.checked_type, tvm.ir.TensorType)
+        # Another config of the pass context is another key.
+        with PassContext(opt_level=3):
+            pass_.InferType()(mod_2)
+        assert get_hits() == hits + 1
+    finally:
+        set_pass_cache_size(0)
+
+
+def test_parallel_function_pass():
+    def get_mod():
+        funcs = {}
+        for i in range(8):
+            x = relay.var("x", relay.TensorType((10,), "float32"))
+            funcs[relay.GlobalVar("f%d" % i)] = relay.Function([x], relay.exp(relay.log(x)))
+        return pass_.InferType()(FromRelay()(tvm.IRModule(funcs)))
+
+    mod = get_mod()
+    rets = []
+    for num_threads in [1, 4]:
+        with PassContext(opt_level=3, config={"raf.function_pass.num_threads": num_threads}):
+            rets.append(pass_.FuseTVM()(mod))
+    assert tvm.ir.structural_equal(rets[0], rets[1])
+    assert [gvar.name_hint for gvar, _ in rets[0].functions.items()] == [
+        gvar.name_hint for gvar, _ in rets[1].functions.items()
+    ]
+
+
+def test_normal_form():
+    x = relay.var("x", relay.TensorType((10,), "float32"))
+    y = relay.log(x)
+    func = relay.Function([x], relay.exp(relay.add(y, y)))
+    mod = FromRelay()(tvm.IRModule({relay.GlobalVar("main"): func}))
+    assert pass_.GetNormalForm(mod["main"]) == ""
+    # The form is kept by the type inference in the sequential pass.
+    mod = RAFSequential([pass_.ToANormalForm(), pass_.InferType()])(mod)
+    anf_func = mod["main"]
+    assert pass_.GetNormalForm(anf_func) == "ANF"
+    # The conversions to the forms the function is in return it as is.
+    assert pass_.ToANormalForm()(mod)["main"].same_as(anf_func)
+    assert pass_.ToBasicBlockNormalForm()(mod)["main"].same_as(anf_func)
+    mod = pass_.ToGraphNormalForm()(mod)
+    gnf_func = mod["main"]
+    assert pass_.GetNormalForm(gnf_func) == "GNF"
+    assert pass_.ToGraphNormalForm()(mod)["main"].same_as(gnf_func)
+    # A rewritten function is in no known form.
+    mod = pass_.FuseTVM()(pass_.InferType()(mod))
+    assert pass_.GetNormalForm(mod["main"]) == ""
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
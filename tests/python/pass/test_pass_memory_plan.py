@@ -6,6 +6,10 @@
 import pytest
 import raf
 from raf._lib import tvm
+from raf._core.device import Device
+from raf._core.ir_ext import extended_var
+from raf._ffi.pass_ import InferType, ManifestAlloc, MemoryPlan
+from raf.ir import ANFBuilder
 from raf.testing import get_testable_devices, randn, check, run_vm_model
 
 
@@ -105,6 +109,34 @@ def test_memory_plan_basic(device, fusion):
     verify_correctness(model_before, device, args, fusion=fusion)
 
 
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_plan_memory_offsets(device):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a, b):
+            t0 = raf.add(a, a)
+            t1 = raf.add(t0, b)
+            t2 = raf.add(t1, t0)
+            t3 = raf.add(t2, b)
+            t4 = raf.add(t3, t0)
+            return t4
+
+    shape = (5, 5)
+    model = Model()
+    model.infer_mode()
+    m_a, _ = randn(shape, device=device)
+    m_b, _ = randn(shape, device=device)
+    mod = optimize(model._internal(m_a, m_b).mod, device)
+
+    # t0 is live till the end, while t1 and t3 do not overlap, so they share the same bytes.
+    stat = {k: v.value for k, v in raf._ffi.pass_.PlanMemoryOffsets(mod).items()}
+    assert stat["total"] == 400
+    assert stat["lower_bound"] <= stat["peak"] < stat["total"]
+
+
 @pytest.mark.parametrize("device", get_testable_devices())
 @pytest.mark.parametrize("fusion", [False, True])
 def test_memory_plan_multi_outs(device, fusion):
@@ -167,5 +199,34 @@ def test_set_shape():
     verify_correctness(model, "cpu", args, fusion=False)
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_allreduce_bucket():
+    shape = [64, 64]  # 16 KBs
+
+    builder = ANFBuilder()
+    x = extended_var("x", shape=shape)
+    y = extended_var("y", shape=shape)
+    a_1 = builder.call("relu", [x])
+    a_2 = builder.call("relu", [y])
+    x_1 = builder.make_tuple([a_1, a_2])
+    x_2 = builder.call("_allreduce", [x_1, raf.ir.const("sum")])
+    mod = tvm.IRModule.from_expr(tvm.relay.Function([x, y], builder.ret(x_2)))
+
+    mod = InferType()(mod)
+    with Device("cuda"):
+        mod = ManifestAlloc()(mod)
+    mod = MemoryPlan()(mod)
+
+    # The inputs and outputs of the allreduce are packed into one storage respectively.
+    text = raf.ir.AsText(mod["main"])
+    lines = text.split("\n")
+    storages = [line for line in lines if "raf.op.vm.alloc_storage" in line]
+    assert len(storages) == 2, text
+    assert all("int64(32768)" in line for line in storages), text
+    tensors = [line for line in lines if "raf.op.vm.alloc_tensor" in line]
+    assert len(tensors) == 4, text
+    assert sum("int64(16384)" in line for line in tensors) == 2, text
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -281,5 +281,55 @@ def test_tuple_merge():
     assert tvm.ir.structural_equal(func, expected_func)
 
 
+def test_cost_model():
+    # pylint: disable=no-self-use
+    target = "test_cost_model"
+
+    @tvm.ir.register_op_attr("raf.op.relu", "target." + target)
+    def relu(attrs, args):  # pylint: disable=unused-argument
+        return True
+
+    @tvm.ir.register_op_attr("raf.op.negative", "target." + target)
+    def negative(attrs, args):  # pylint: disable=unused-argument
+        return True
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a_1 = raf.relu(x)
+            out = raf.negative(a_1)
+            return out
+
+    model = Model()
+    x = raf.array(np.random.randn(10, 10), dtype="float32")
+    mod = AnnotateTarget([target])(model._internal(x).mod)
+
+    def merge(**configs):
+        configs = {"raf.merge_regions." + k: v for k, v in configs.items()}
+        configs["raf.merge_regions.cost_model"] = True
+        with raf.Device("cpu"):
+            with tvm.transform.PassContext(config=configs):
+                return MergeCompilerRegions()(mod)["main"]
+
+    def get_begin_targets(func):
+        begin_op = raf._ffi.op.GetOp("raf.op.compiler_begin")
+        targets = []
+
+        def visit(node):
+            if isinstance(node, _relay.Call) and node.op == begin_op:
+                targets.append(node.attrs.compiler)
+
+        _relay.analysis.post_order_visit(func, visit)
+        return targets
+
+    # Launching an external function costs more than the two tiny ops.
+    assert get_begin_targets(merge()) == ["default"]
+    # The region is kept when the native ops are expensive to launch.
+    assert get_begin_targets(merge(op_overhead_us=100)) == [target]
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,83 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import pytest
+
+import raf
+from raf._lib import relay
+from raf._ffi.pass_ import PartitionParameter, InferType
+from raf.model import Linear
+from raf.optim.optim import with_autodiff
+from raf.testing import randn
+
+
+class Model(raf.Model):
+    def build(self):
+        self.linear1 = Linear(16, 10)
+        self.linear2 = Linear(10, 8)
+        self.linear3 = Linear(8, 4)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = self.linear1(x)
+        out = raf.relu(out)
+        out = self.linear2(out)
+        out = raf.relu(out)
+        out = self.linear3(out)
+        return out
+
+
+def get_mod():
+    model = Model()
+    model.train_mode()
+    ad_model = with_autodiff(model)
+    m_x, _ = randn((4, 16), dtype="float32")
+    m_dy, _ = randn((4, 4), dtype="float32")
+    return InferType()(ad_model._internal(m_dy, m_x).mod)
+
+
+def get_bindings(func):
+    bindings = []
+    body = func.body
+    while isinstance(body, relay.Let):
+        bindings.append(body.value)
+        body = body.body
+    return bindings
+
+
+def is_op(expr, name):
+    return isinstance(expr, relay.Call) and getattr(expr.op, "name", None) == name
+
+
+@pytest.mark.parametrize("prefetch_depth", [0, 2])
+def test_partition_parameter(prefetch_depth):
+    mod = get_mod()
+    params = list(mod["main"].params[2:])
+    func = PartitionParameter(params, 4, prefetch_depth)(mod)["main"]
+    text = raf.ir.AsText(func)
+
+    # The parameters are partitioned along the first axis with padding.
+    for old, new in zip(params, func.params[2:]):
+        old_shape = [int(s) for s in old.checked_type.shape]
+        new_shape = [int(s) for s in new.checked_type.shape]
+        assert new_shape == [(old_shape[0] + 3) // 4] + old_shape[1:], text
+    # Only the first axis of linear1 (10) is not divisible.
+    assert text.count("raf.op.strided_slice") >= 2, text
+
+    bindings = get_bindings(func)
+    num_gathers = 0
+    for binding in bindings:
+        if is_op(binding, "raf.op._allgather"):
+            num_gathers += 1
+        elif is_op(binding, "raf.op._group_allgather"):
+            num_gathers += len(binding.args[0].checked_type.fields)
+    # The weights used by both forward and backward are gathered again in backward.
+    assert num_gathers > len(params), text
+    # Without prefetching, each parameter is gathered right before its use. Otherwise, the
+    # parameters of the first layers are gathered together by a group allgather.
+    assert ("raf.op._group_allgather" in text) == (prefetch_depth > 0), text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
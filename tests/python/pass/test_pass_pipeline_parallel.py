@@ -0,0 +1,92 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, attribute-defined-outside-init
+import pytest
+
+import raf
+from raf._lib import relay
+from raf._ffi.pass_ import PipelineParallel, InferType
+from raf.model import Linear
+from raf.optim.optim import with_autodiff
+from raf.testing import randn
+
+
+class Model(raf.Model):
+    def build(self):
+        self.linear1 = Linear(16, 8)
+        self.linear2 = Linear(8, 8)
+        self.linear3 = Linear(8, 4)
+
+    @raf.model.trace
+    def forward(self, x):
+        out = self.linear1(x)
+        out = raf.relu(out)
+        out = self.linear2(out)
+        out = raf.relu(out)
+        out = self.linear3(out)
+        return out
+
+
+def get_mod():
+    model = Model()
+    model.train_mode()
+    ad_model = with_autodiff(model)
+    m_x, _ = randn((4, 16), dtype="float32")
+    m_dy, _ = randn((4, 4), dtype="float32")
+    return InferType()(ad_model._internal(m_dy, m_x).mod)
+
+
+def get_outputs(func):
+    let_values = {}
+    body = func.body
+    while isinstance(body, relay.Let):
+        let_values[body.var] = body.value
+        body = body.body
+    ret = let_values[body]
+    return let_values[ret.fields[0]], let_values[ret.fields[1]].fields
+
+
+def run_pipeline(mod, num_stages, stage, num_micro_batches):
+    dy, x = mod["main"].params[:2]
+    mod = PipelineParallel(num_stages, stage, num_micro_batches, [x, dy])(mod)
+    return InferType()(mod)["main"]
+
+
+@pytest.mark.parametrize("num_micro_batches", [1, 2, 4])
+def test_two_stages(num_micro_batches):
+    mod = get_mod()
+    funcs = [run_pipeline(mod, 2, stage, num_micro_batches) for stage in range(2)]
+    texts = [raf.ir.AsText(func) for func in funcs]
+    num_sends = [text.count("raf.op._send") for text in texts]
+    num_recvs = [text.count("raf.op._recv") for text in texts]
+
+    # Each micro-batch sends the activations forward and the gradients backward, and each send
+    # is matched by a recv of the other stage.
+    assert num_sends[0] == num_recvs[1] > 0 and num_sends[0] % num_micro_batches == 0, texts
+    assert num_sends[1] == num_recvs[0] > 0 and num_sends[1] % num_micro_batches == 0, texts
+
+    # Each gradient is returned by exactly one stage.
+    grads = [get_outputs(func)[1] for func in funcs]
+    for ref, grad0, grad1 in zip(get_outputs(mod["main"])[1], *grads):
+        if not isinstance(ref, relay.Constant):
+            assert isinstance(grad0, relay.Constant) != isinstance(grad1, relay.Constant), texts
+
+    # The output of the last stage has the full batch.
+    assert [int(s) for s in funcs[1].checked_type.ret_type.fields[0].shape] == [4, 4]
+
+
+def test_micro_batches():
+    mod = get_mod()
+    func = run_pipeline(mod, 1, 0, 2)
+    text = raf.ir.AsText(func)
+    assert "raf.op._send" not in text and "raf.op._recv" not in text, text
+    assert text.count("raf.op.split") == 2, text
+    y, grads = get_outputs(func)
+    assert y.op.name == "raf.op.concatenate", text
+    for ref, grad in zip(get_outputs(mod["main"])[1], grads):
+        assert isinstance(ref, relay.Constant) == isinstance(grad, relay.Constant), text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,63 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=attribute-defined-outside-init,protected-access,no-self-use
+import numpy as np
+import pytest
+import raf
+from raf.testing import randn, run_vm_model, check
+
+
+def get_metric(name):
+    metric = raf._ffi.cache.DumpTVMCacheMetric("tvm_cpu")
+    return int(metric[name]) if name in metric else 0
+
+
+def precompile(mod, threads):
+    config = {"raf.tvm.parallel_build_threads": threads}
+    with raf.ir.PassContext(config=config):
+        with raf.device("cpu"):
+            mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+            mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+            mod = raf._ffi.pass_.InferType()(mod)
+            mod = raf._ffi.pass_.FuseTVM()(mod)
+            mod = raf._ffi.pass_.DispatchDialect()(mod)
+            mod = raf._ffi.pass_.InferType()(mod)
+            return raf._ffi.pass_.PrecompileTVM()(mod)
+
+
+@pytest.mark.parametrize("threads", [1, 4])
+def test_precompile(threads):
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, y):
+            a = raf.relu(raf.add(x, x))
+            b = raf.exp(raf.multiply(y, y))
+            return a, b
+
+    # Use distinct shapes so that the fused ops are not in the cache yet.
+    m_x, n_x = randn((3, 7, 10 + threads), device="cpu")
+    m_y, n_y = randn((5, 13 + threads), device="cpu")
+    model = Model()
+    mod = model._internal(m_x, m_y).mod
+
+    num_set = get_metric("CacheSet")
+    precompile(mod, threads)
+    # A single thread means the fused ops are built lazily when they are dispatched.
+    expected = 2 if threads > 1 else 0
+    assert get_metric("CacheSet") - num_set == expected
+
+    num_set = get_metric("CacheSet")
+    m_a, m_b = run_vm_model(model, "cpu", [m_x, m_y])
+    if threads > 1:
+        # The dispatched fused ops are taken from the cache.
+        assert get_metric("CacheSet") == num_set
+    check(m_a, (n_x + n_x).clip(min=0))
+    check(m_b, np.exp(n_y * n_y), rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,85 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,attribute-defined-outside-init
+import pytest
+
+import raf
+from raf._core.executor import VMExecutor
+from raf._ffi.pass_ import BindParam, ConvertLayout, InferType, PrepackWeights
+from raf.testing import check, randn
+
+
+def bind_params(model, m_x, params):
+    func = model._internal(m_x).mod["main"]
+    args = [m_x._ndarray__handle] + [param._ndarray__handle for param in params]
+    return InferType()(raf._core.module.IRModule.from_expr(BindParam(func, args)))
+
+
+def test_prepack_matmul():
+    class MatmulNet(raf.Model):
+        def build(self, w):
+            self.w = w
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.matmul(x, self.w))
+
+    m_w, _ = randn((16, 32))
+    model = MatmulNet(m_w)
+    model.infer_mode()
+    m_x, _ = randn((8, 16))
+    mod = bind_params(model, m_x, [model.w])
+
+    prepacked = PrepackWeights()(mod)
+    text = raf.ir.AsText(prepacked["main"])
+    # The weight is transposed at compile time, so the reduction axis is the innermost one.
+    assert "raf.op.matmul_nt" in text and "raf.op.matmul(" not in text, text
+
+    m_ref = VMExecutor(mod, "cpu").make_executor()(m_x)
+    m_y = VMExecutor(prepacked, "cpu").make_executor()(m_x)
+    check(m_y, m_ref)
+
+
+def test_prepack_conv2d():
+    class ConvNet(raf.Model):
+        def build(self, w):
+            self.w = w
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(raf.conv2d(x, self.w, padding=1))
+
+    m_w, _ = randn((8, 4, 3, 3))
+    model = ConvNet(m_w)
+    model.infer_mode()
+    m_x, _ = randn((2, 4, 8, 8))
+    mod = ConvertLayout("NHWC")(bind_params(model, m_x, [model.w]))
+    assert raf.ir.AsText(mod["main"]).count("raf.op.transpose") == 3
+
+    # The transpose of the constant filter to OHWI is folded, so it is not computed on each call.
+    text = raf.ir.AsText(PrepackWeights()(mod)["main"])
+    assert text.count("raf.op.transpose") == 2, text
+    assert '"OHWI"' in text, text
+
+
+def test_no_prepack():
+    shape = (8, 8)
+    m_x, _ = randn(shape)
+
+    class Net(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.matmul(x, x)
+
+    # The IR is unchanged without constant weights.
+    mod = bind_params(Net(), m_x, [])
+    prepacked = PrepackWeights()(mod)
+    assert raf.ir.AsText(prepacked["main"]) == raf.ir.AsText(mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,74 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import json
+import os
+import tempfile
+
+import pytest
+import raf
+from raf._ffi.pass_ import SimplifyExpr, ToGraphNormalForm, ToBasicBlockNormalForm
+from raf.ir import RAFSequential
+from raf.testing import randn
+from raf.utils import pass_profiler
+
+
+def test_pass_profiler():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.relu(x)
+
+    m_x, _ = randn((10, 5))
+    mod = Model()._internal(m_x).mod
+    seq = RAFSequential(
+        [ToGraphNormalForm(), ToBasicBlockNormalForm(), SimplifyExpr()], name="simplify"
+    )
+    pass_profiler.reset()
+    pass_profiler.start()
+    with raf.Device("cpu"):
+        seq(mod)
+    pass_profiler.stop()
+    # Not recorded after the profiler stops.
+    with raf.Device("cpu"):
+        seq(mod)
+
+    records = pass_profiler.get()
+    names = [r["name"] for r in records]
+    # The required InferType runs before SimplifyExpr in the sequential.
+    assert names == [
+        "simplify",
+        "ToGraphNormalForm",
+        "ToBasicBlockNormalForm",
+        "InferType",
+        "SimplifyExpr",
+    ], names
+    assert [r["depth"] for r in records] == [0, 1, 1, 1, 1]
+    seq_record = records[0]
+    for record in records[1:]:
+        assert seq_record["start_us"] <= record["start_us"] <= record["end_us"]
+        assert record["end_us"] <= seq_record["end_us"]
+        assert record["nodes_before"] > 0 and record["nodes_after"] > 0
+    assert seq_record["nodes_before"] == records[1]["nodes_before"]
+    assert seq_record["nodes_after"] == records[-1]["nodes_after"]
+    children = sum(r["end_us"] - r["start_us"] for r in records[1:])
+    assert seq_record["self_us"] == seq_record["end_us"] - seq_record["start_us"] - children
+
+    table = pass_profiler.report(records)
+    assert "SimplifyExpr" in table and "simplify" in table
+    with tempfile.TemporaryDirectory() as temp_dir:
+        path = os.path.join(temp_dir, "pass_profile.json")
+        pass_profiler.dump_trace(path, records)
+        with open(path, "r") as in_file:
+            events = json.load(in_file)["traceEvents"]
+    assert [e["name"] for e in events] == names
+    pass_profiler.reset()
+    assert not pass_profiler.get()
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,69 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access,attribute-defined-outside-init,no-self-use
+import numpy as np
+import pytest
+
+import raf
+from raf._ffi.pass_ import InferType, QuantizeCalibrate
+from raf.ir import AsText
+from raf.quantization import calibrate, quantize_model
+from raf.testing import check, get_testable_devices, randn, run_vm_model
+
+
+class ConvDense(raf.Model):
+    def build(self, w_conv, w_dense):
+        self.w_conv = w_conv
+        self.w_dense = w_dense
+
+    @raf.model.trace
+    def forward(self, x):
+        y = raf.relu(raf.conv2d(x, self.w_conv, padding=1))
+        y = raf.reshape(y, (-1, 64))
+        y = raf.relu(raf.dense(y, self.w_dense))
+        return raf.dense(y, self.w_dense)
+
+
+def make_model(device):
+    n_conv = (np.random.randn(4, 3, 3, 3) * 0.3).astype("float32")
+    n_dense = (np.random.randn(64, 64) * 0.2).astype("float32")
+    m_conv, m_dense = raf.array(n_conv, device=device), raf.array(n_dense, device=device)
+    return ConvDense(m_conv, m_dense)
+
+
+def test_quantize_ir():
+    model = make_model("cpu")
+    m_x, _ = randn((1, 3, 4, 4))
+    mod = QuantizeCalibrate()(InferType()(model._internal(m_x).mod))
+    # The two operands of each of the conv2d and the two dense are returned.
+    assert len(mod["main"].checked_type.ret_type.fields[1].fields) == 6
+
+    scales = [0.1] * 6
+    text = AsText(quantize_model(model, scales, [m_x])._FrameworkModel__infer_mod["main"])
+    assert text.count("raf.op.qnn_conv2d(") == 1, text
+    assert text.count("raf.op.qnn_dense(") == 2, text
+    assert text.count("raf.op.dequantize(") == 3, text
+    # w_dense is quantized once with the same scale for both dense.
+    assert text.count("raf.op.quantize(") == 5, text
+
+
+@pytest.mark.parametrize("device", get_testable_devices())
+def test_quantize_accuracy(device):
+    model = make_model(device)
+    dataset = [[randn((2, 3, 4, 4), device=device)[0]] for _ in range(4)]
+    scales = calibrate(model, dataset, device)
+    assert len(scales) == 6 and all(scale > 0 for scale in scales)
+
+    m_x = dataset[0][0]
+    q_model = quantize_model(model, scales, [m_x])
+    m_ref = run_vm_model(model, device, [m_x]).numpy()
+    m_y = run_vm_model(q_model, device, [m_x]).numpy()
+    # The per-tensor int8 quantization keeps the outputs within a few percent of the range.
+    err = np.abs(m_y - m_ref).max() / np.abs(m_ref).max()
+    assert err < 0.05, err
+    check(m_y, m_ref, rtol=0.1, atol=0.1 * np.abs(m_ref).max())
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -18,7 +18,7 @@ import tvm
 from tvm import relay
 
 
-def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks):
+def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks, solver="greedy"):
     """Verify the result of rematerialization pass.
 
     Parameters
@@ -33,6 +33,8 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
         The expected IR after rematerialization.
     expected_peaks: Tuple[float, float]
         The expected peak memory in MBs without and with rematerialization.
+    solver: str
+        The solver to choose the tensors to be rematerialized.
     """
     if not isinstance(model_or_mod, tvm.IRModule):
         record = model_or_mod._internal(*args)
@@ -47,6 +49,7 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
             config={
                 "raf.memory_budget": int(budget_in_mbs * 1048576),
                 "raf.remat.use_gflops_cost": True,
+                "raf.remat.solver": solver,
             }
         ):
             ir_mod = raf._ffi.pass_.InferType()(ir_mod)
@@ -78,6 +81,7 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
                 "raf.memory_budget": int(budget * 1048576),
                 # Use GFLOPS cost to avoid flaky behavior in tests
                 "raf.remat.use_gflops_cost": True,
+                "raf.remat.solver": solver,
             },
         ):
             raf.utils.memory_profiler.reset()
@@ -95,7 +99,8 @@ def verify_remat(model_or_mod, args, budget_in_mbs, expected_ir, expected_peaks)
 
 
 @pytest.mark.parametrize("budget_type", ["low", "remat", "high"])
-def test_simple(budget_type):
+@pytest.mark.parametrize("solver", ["greedy", "dp"])
+def test_simple(budget_type, solver):
     shape = (16, 16, 64, 64)  # 4 MBs
     data_size, weight_size = np.prod(shape), np.prod((16, 16, 3, 3))
 
@@ -239,7 +244,7 @@ def test_simple(budget_type):
         sb.ret(a_9)
         return relay.Function([data, weight], sb.get())
 
-    verify_remat(model, [m_x], budget, expected(), (before_peak, budget))
+    verify_remat(model, [m_x], budget, expected(), (before_peak, budget), solver)
 
 
 def test_closure():
@@ -666,5 +671,96 @@ def test_concat():
     verify_remat(get_mod(), [m_p0, m_p1], 32, get_mod()["main"], (24.00, 24.00))
 
 
+def test_checkpoint_boundary():
+    shape = (512, 512)  # 1 MB.
+    add_op = raf._ffi.op.GetOp("raf.op.add")
+    relu_op = raf._ffi.op.GetOp("raf.op.relu")
+    boundary_op = raf._ffi.op.GetOp("raf.op.checkpoint_boundary")
+    null = raf.ir.const(None)
+
+    def get_mod():
+        p_0 = raf.ir.var("x", shape=shape)
+
+        sb = ScopeBuilder()
+        a_1 = sb.let("a1", relay.Call(relu_op, [p_0]))
+        a_2 = sb.let("a2", relay.Call(relu_op, [a_1]))
+        a_3 = sb.let("a3", relay.Call(boundary_op, [a_2]))
+        a_4 = sb.let("a4", relay.Call(relu_op, [a_3]))
+        a_5 = sb.let("a5", relay.Call(add_op, [a_4, a_1, null, null]))
+        sb.ret(a_5)
+        return tvm.IRModule.from_expr(relay.Function([p_0], sb.get()))
+
+    def expected():
+        """The boundary is removed. a1 is freed at the end of its segment without a budget, and
+        recomputed from the input, while the checkpoint a2 is kept."""
+        p_0 = raf.ir.var("x", shape=shape)
+
+        sb = ScopeBuilder()
+        a_1 = sb.let("a1", relay.Call(relu_op, [p_0]))
+        a_2 = sb.let("a2", relay.Call(relu_op, [a_1]))
+        a_4 = sb.let("a4", relay.Call(relu_op, [a_2]))
+        x_0 = sb.let("x_0", relay.Call(relu_op, [p_0]))
+        a_5 = sb.let("a5", relay.Call(add_op, [a_4, x_0, null, null]))
+        sb.ret(a_5)
+        return relay.Function([p_0], sb.get())
+
+    with Device("cpu"):
+        with raf.ir.PassContext(config={"raf.remat.use_gflops_cost": True}):
+            mod = raf._ffi.pass_.InferType()(get_mod())
+            mod = raf._ffi.pass_.Rematerialization()(mod)
+    expected_func = run_infer_type(expected())
+    assert tvm.ir.structural_equal(mod["main"], expected_func), "\nExpected:\n%s\nGot\n%s" % (
+        raf.ir.AsText(expected_func),
+        raf.ir.AsText(mod["main"]),
+    )
+
+    m_x, n_x = randn(shape, device="cpu")
+    with tvm.transform.PassContext(config={"raf.remat.use_gflops_cost": True}):
+        m_y = VMExecutor(get_mod(), "cpu").make_executor()(m_x)
+    n_a1 = np.maximum(n_x, 0)
+    np.testing.assert_allclose(m_y.numpy(), n_a1 + n_a1, rtol=1e-5, atol=1e-5)
+
+
+def test_latency_cache(tmp_path):
+    shape = (16, 16, 64, 64)  # 4 MBs
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            a_1 = raf.relu(x)
+            a_2 = raf.relu(a_1)
+            a_3 = raf.relu(a_2)
+            a_4 = raf.add(a_1, a_3)
+            return a_4
+
+    model = Model()
+    m_x, _ = randn(shape, device="cpu")
+    record = model._internal(m_x)
+    mod = record.mod
+    cache_path = str(tmp_path / "latency.bin")
+
+    def run_remat():
+        with Device("cpu"):
+            with raf.ir.PassContext(
+                config={
+                    "raf.memory_budget": int(12 * 1048576),
+                    "raf.remat.solver": "dp",
+                    "raf.remat.latency_cache": cache_path,
+                }
+            ):
+                ir_mod = raf._ffi.pass_.InferType()(mod)
+                return raf._ffi.pass_.Rematerialization()(ir_mod)
+
+    run_remat()
+    size = (tmp_path / "latency.bin").stat().st_size
+    assert size > 0
+    # The second run loads the measured latencies, so the cache does not grow.
+    run_remat()
+    assert (tmp_path / "latency.bin").stat().st_size == size
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,56 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+import raf
+import tvm
+from tvm import relay
+from raf._ffi.pass_ import InferType, RematerializationSchedule
+from raf.ir import ScopeBuilder
+
+
+def get_mod():
+    """
+    a_i = relu(p0), g_i = add(a_i, a_i) for i = 1, 2, 3, and the output sums up all g_i.
+    All relus are issued first in the original order, so all activations are alive together.
+    """
+    relu_op = raf._ffi.op.GetOp("raf.op.relu")
+    add_op = raf._ffi.op.GetOp("raf.op.add")
+    null = raf.ir.const(None)
+
+    sb = ScopeBuilder()
+    p_0 = raf.ir.var("p0", shape=(512, 512))  # 1 MB
+    acts = [sb.let("a%d" % (i + 1), relay.Call(relu_op, [p_0])) for i in range(3)]
+    grads = [
+        sb.let("g%d" % (i + 1), relay.Call(add_op, [act, act, null, null]))
+        for i, act in enumerate(acts)
+    ]
+    s_1 = sb.let("s1", relay.Call(add_op, [grads[0], grads[1], null, null]))
+    s_2 = sb.let("s2", relay.Call(add_op, [s_1, grads[2], null, null]))
+    sb.ret(s_2)
+    return InferType()(tvm.IRModule.from_expr(relay.Function([p_0], sb.get())))
+
+
+def schedule(mod, budget):
+    with raf.ir.PassContext(config={"raf.memory_budget": budget}):
+        return InferType()(RematerializationSchedule()(mod))
+
+
+def test_reorder():
+    mod = get_mod()
+    text = raf.ir.AsText(schedule(mod, 3 * 1048576)["main"])
+    # a3 is computed after a1 and a2 are released, so the peak memory is 4 MBs instead of 5 MBs.
+    assert text.index("%a3 =") > text.index("%s1 ="), text
+    assert text.index("%g2 =") < text.index("%s1 ="), text
+
+
+@pytest.mark.parametrize("budget", [0, 64 * 1048576])
+def test_no_reorder(budget):
+    mod = get_mod()
+    # The IR is unchanged without a budget or when the peak memory is within the budget.
+    assert tvm.ir.structural_equal(schedule(mod, budget)["main"], mod["main"])
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
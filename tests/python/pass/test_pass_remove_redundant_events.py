@@ -0,0 +1,57 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+import raf
+import tvm
+from raf._core.ir_ext import extended_var
+from raf._ffi.pass_ import RemoveRedundantEvents
+from raf.ir import ANFBuilder
+
+
+def get_mod(barrier=False):
+    """
+    stream 1: a = atan(x), event 1, wait event 1 (same stream), event 3 (never waited)
+    stream 2: wait event 1, b = atan(a), event 2
+    stream 3: wait event 2, wait event 1 (implied by event 2), c = concatenate(a, b)
+    """
+    sb = ANFBuilder()
+    x = extended_var("x", shape=(2, 2))
+    sb.set_stream(0, 1)
+    a = sb.call("atan", [x])
+    sb.add_event(1, -1)
+    sb.wait_event(1, -1)
+    sb.add_event(3, -1)
+    sb.set_stream(0, 2)
+    if barrier:
+        sb.call("stream_barrier", [])
+    sb.wait_event(1, -1)
+    b = sb.call("atan", [a])
+    sb.add_event(2, -1)
+    sb.set_stream(0, 3)
+    sb.wait_event(2, -1)
+    sb.wait_event(1, -1)
+    c = sb.call("concatenate", [sb.make_tuple([a, b]), sb.const(0)])
+    return tvm.IRModule.from_expr(tvm.relay.Function([x], sb.ret(c)))
+
+
+def test_remove_redundant_events():
+    mod = RemoveRedundantEvents()(get_mod())
+    text = raf.ir.AsText(mod["main"])
+    # Only stream 2 waits for event 1, and stream 3 waits for event 2.
+    assert text.count("raf.op.wait_event") == 2, text
+    assert text.count("raf.op.add_event") == 2, text
+    assert "raf.op.add_event(int64(3)" not in text, text
+
+
+def test_stream_barrier():
+    mod = RemoveRedundantEvents()(get_mod(barrier=True))
+    text = raf.ir.AsText(mod["main"])
+    # The barrier orders stream 2 and 3 after event 1, so only the wait for event 2 is kept.
+    assert text.count("raf.op.wait_event") == 1, text
+    assert text.count("raf.op.add_event") == 1, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
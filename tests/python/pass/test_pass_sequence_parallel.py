@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, too-many-arguments, attribute-defined-outside-init
+import pytest
+import raf
+from raf._ffi.pass_ import SequenceParallel
+from raf.testing import randn
+
+RANK_LIST = [[0, 1]]
+
+
+def parallelize(model, *args):
+    return SequenceParallel()(model._internal(*args).mod)
+
+
+class RowParallelBlock(raf.Model):
+    """The row-parallel matmul, whose partial sums are allreduced and added to the residual, and
+    the layer norm, which feeds a column-parallel matmul or is returned."""
+
+    def build(self, return_norm):
+        self.return_norm = return_norm
+
+    @raf.model.trace
+    def forward(self, x, w1, residual, w2):
+        y = raf.allreduce(raf.matmul(x, w1), rank_list=RANK_LIST)
+        norm = raf.layer_norm(raf.add(y, residual))
+        if self.return_norm:
+            return norm
+        return raf.matmul(norm, w2)
+
+
+@pytest.mark.parametrize("return_norm", [False, True])
+def test_layer_norm_region(return_norm):
+    model = RowParallelBlock(return_norm)
+    m_x, _ = randn((8, 4), device="cpu")
+    m_w1, _ = randn((4, 16), device="cpu")
+    m_res, _ = randn((8, 16), device="cpu")
+    m_w2, _ = randn((16, 8), device="cpu")
+    mod = parallelize(model, m_x, m_w1, m_res, m_w2)
+    text = raf.ir.AsText(mod["main"])
+    assert "raf.op._allreduce" not in text, text
+    assert "raf.op._reduce_scatter" in text, text
+    # The replicated residual takes its local chunk.
+    assert "raf.op._sequence_scatter" in text, text
+    # The column-parallel matmul takes an allgather, which reduce-scatters the gradients.
+    assert ("raf.op._allgather" in text) != return_norm, text
+    assert ("raf.op._sequence_gather" in text) == return_norm, text
+    out_shape = (8, 16) if return_norm else (8, 8)
+    assert tuple(mod["main"].checked_type.ret_type.shape) == out_shape
+
+
+def test_replicated_users():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, w1, w2):
+            y = raf.allreduce(raf.matmul(x, w1), rank_list=RANK_LIST)
+            return raf.matmul(y, w2)
+
+    model = Model()
+    m_x, _ = randn((8, 4), device="cpu")
+    m_w1, _ = randn((4, 16), device="cpu")
+    m_w2, _ = randn((16, 8), device="cpu")
+    text = raf.ir.AsText(parallelize(model, m_x, m_w1, m_w2)["main"])
+    # The allreduce is kept if no op after it can be sharded.
+    assert "raf.op._allreduce" in text and "raf.op._reduce_scatter" not in text, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -3,7 +3,16 @@
 
 # pylint: disable=missing-function-docstring, missing-class-docstring, invalid-name, protected-access
 import pytest
-from raf.distributed.sharding import make_replicated_spec, make_shard_spec, make_unset_spec
+import tvm
+import raf
+from raf._lib import relay
+from raf._ffi.pass_ import InferType, ShardingPropagation
+from raf.distributed.sharding import (
+    ShardOpCallAttrs,
+    make_replicated_spec,
+    make_shard_spec,
+    make_unset_spec,
+)
 from tvm.ir import structural_equal
 
 
@@ -32,5 +41,68 @@ def test_shardspec():
     assert not structural_equal(a, i)
 
 
+def build_mlp(x_spec, relu_attrs=None, out_attrs=None):
+    """Build x -> matmul -> relu -> matmul, where x is annotated in the first matmul."""
+    matmul_op = raf._ffi.op.GetOp("raf.op.matmul")
+    relu_op = raf._ffi.op.GetOp("raf.op.relu")
+    x = raf.ir.var("x", shape=(8, 16))
+    w1 = raf.ir.var("w1", shape=(16, 16))
+    w2 = raf.ir.var("w2", shape=(16, 8))
+    a1, a2, a3 = raf.ir.var("a1"), raf.ir.var("a2"), raf.ir.var("a3")
+    attrs1 = ShardOpCallAttrs([x_spec, make_unset_spec()], [make_unset_spec()])
+    let3 = relay.Let(a3, relay.Call(matmul_op, [a2, w2], out_attrs), a3)
+    let2 = relay.Let(a2, relay.Call(relu_op, [a1], relu_attrs), let3)
+    let1 = relay.Let(a1, relay.Call(matmul_op, [x, w1], attrs1), let2)
+    mod = tvm.IRModule.from_expr(relay.Function([x, w1, w2], let1))
+    return InferType()(mod)
+
+
+def get_specs(mod):
+    """Get the output specs of the op calls and the resharding calls in order."""
+    body = mod["main"].body
+    specs, reshards = [], []
+    while isinstance(body, relay.Let):
+        call = body.value
+        if isinstance(call, relay.Call) and call.op.name == "raf.op._reshard":
+            reshards.append((call.attrs.sin[0], call.attrs.sout[0]))
+        elif isinstance(call, relay.Call):
+            specs.append(call.attrs.sout[0])
+        body = body.body
+    return specs, reshards
+
+
+def test_propagate_row_sharding():
+    mod = ShardingPropagation()(build_mlp(make_shard_spec([4, 1], ranks=4)))
+    specs, reshards = get_specs(mod)
+    assert not reshards, raf.ir.AsText(mod)
+    for spec in specs:
+        assert structural_equal(spec, make_shard_spec([4, 1], ranks=4)), raf.ir.AsText(mod)
+
+
+def test_reshard_to_replicated():
+    out_attrs = ShardOpCallAttrs(
+        [make_replicated_spec(2, ranks=4), make_unset_spec()], [make_unset_spec()]
+    )
+    mod = ShardingPropagation()(build_mlp(make_shard_spec([4, 1], ranks=4), None, out_attrs))
+    specs, reshards = get_specs(mod)
+    assert len(reshards) == 1, raf.ir.AsText(mod)
+    assert structural_equal(reshards[0][0], make_shard_spec([4, 1], ranks=4))
+    assert structural_equal(reshards[0][1], make_replicated_spec(2, ranks=4))
+    assert structural_equal(specs[-1], make_replicated_spec(2, ranks=4)), raf.ir.AsText(mod)
+
+
+def test_reshard_all_to_all():
+    relu_attrs = ShardOpCallAttrs([make_shard_spec([1, 4], ranks=4)], [make_unset_spec()])
+    mod = ShardingPropagation()(build_mlp(make_shard_spec([4, 1], ranks=4), relu_attrs))
+    specs, reshards = get_specs(mod)
+    # The relu output is sharded on the columns, and it is cheaper to reshard it back to rows
+    # with all-to-all than to gather it for the column-sharded matmul.
+    assert len(reshards) == 2, raf.ir.AsText(mod)
+    assert structural_equal(reshards[0][0], make_shard_spec([4, 1], ranks=4))
+    assert structural_equal(reshards[0][1], make_shard_spec([1, 4], ranks=4))
+    assert structural_equal(specs[1], make_shard_spec([1, 4], ranks=4)), raf.ir.AsText(mod)
+    assert structural_equal(specs[2], make_shard_spec([4, 1], ranks=4)), raf.ir.AsText(mod)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
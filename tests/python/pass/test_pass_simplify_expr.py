@@ -2,6 +2,7 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=protected-access, no-self-use, too-many-locals
+import numpy as np
 import pytest
 import raf
 from raf._core.ir_ext import extended_var
@@ -14,7 +15,7 @@ from raf._ffi.pass_ import (
     AutoDiff,
 )
 from raf.ir import RAFSequential, ScopeBuilder
-from raf.testing import randn
+from raf.testing import check, get_vm_executor, randn, randint, run_vm_model
 
 import tvm
 from tvm import relay
@@ -151,6 +152,35 @@ def test_reshape():
     assert "raf.op.reshape" not in text, text
 
 
+@pytest.mark.parametrize(
+    "params", [[(0, 2, 3, 1), (0, 3, 1, 2), 0], [(0, 2, 3, 1), (3, 2, 1, 0), 1]]
+)
+def test_transpose(params):
+    axes_1, axes_2, n_transpose = params
+    device = "cpu"
+    shape = (2, 3, 4, 5)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.transpose(x, axes_1)
+            y = raf.transpose(y, axes_2)
+            return y
+
+    model = Model()
+    m_x, n_x = randn(shape, device=device, dtype="float32")
+    mod = model._internal(m_x).mod
+    mod = simplify(mod, device)
+    text = raf.ir.AsText(mod["main"])
+    # Back-to-back transposes are merged into one, which is removed if it is an identity.
+    assert text.count("raf.op.transpose") == n_transpose, text
+    n_y = np.transpose(np.transpose(n_x, axes_1), axes_2)
+    check(run_vm_model(model, device, [m_x]), n_y)
+
+
 @pytest.mark.parametrize("ndim", [2, 3])
 @pytest.mark.parametrize("act", [False, True])
 @pytest.mark.parametrize("shape_compatible", [False, True])
@@ -295,5 +325,178 @@ def test_dropout():
     assert "raf.op._contrib_dropout" not in text, text
 
 
+@pytest.mark.parametrize("device", ["cpu", "cuda"])
+@pytest.mark.parametrize("masked", [False, True])
+def test_attention(device, masked):
+    if device == "cuda" and not raf.build.with_cuda():
+        pytest.skip("CUDA is not enabled")
+    shape = (6, 32, 16)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, q, k, v, mask):
+            score = raf.batch_matmul_nt(q, k)
+            score = raf.divide(score, 4.0)
+            if masked:
+                score = raf.add(score, mask)
+            return raf.batch_matmul(raf.softmax(score), v)
+
+    model = Model()
+    args = [randn(shape, device=device, dtype="float32")[0] for _ in range(3)]
+    m_mask, _ = randn((shape[0], 1, shape[1]), device=device, dtype="float32")
+    mod = model._internal(*args, m_mask).mod
+    mod = InferType()(simplify(mod, device))
+    text = raf.ir.AsText(mod["main"])
+    # The fused attention is only available on CUDA.
+    assert ("raf.op.attention" in text) == (device == "cuda"), text
+    if device == "cuda":
+        assert "raf.op.softmax" not in text, text
+        assert "raf.op.divide" not in text and "raf.op.add" not in text, text
+
+
+@pytest.mark.parametrize("device", ["cpu", "cuda"])
+@pytest.mark.parametrize("dropout", [False, True])
+def test_add_dropout_layer_norm(device, dropout):
+    if device == "cuda" and not raf.build.with_cuda():
+        pytest.skip("CUDA is not enabled")
+    shape = (4, 6, 32)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x, residual, scale, bias):
+            if dropout:
+                x = raf._op.sym._contrib_dropout(x, p=0.1)[0]
+            return raf.layer_norm(raf.add(x, residual), scale, bias)
+
+    model = Model()
+    args = [randn(shape, device=device, dtype="float32")[0] for _ in range(2)]
+    args += [randn(shape[-1:], device=device, dtype="float32")[0] for _ in range(2)]
+    mod = model._internal(*args).mod
+    mod = InferType()(simplify(mod, device))
+    text = raf.ir.AsText(mod["main"])
+    # The fused op is only available on CUDA.
+    assert ("raf.op.add_dropout_layer_norm" in text) == (device == "cuda"), text
+    if device == "cuda":
+        assert "raf.op.layer_norm(" not in text and "raf.op.add(" not in text, text
+
+
+@pytest.mark.parametrize("device", ["cpu", "cuda"])
+@pytest.mark.parametrize("dropout", [False, True])
+@pytest.mark.parametrize("token_type", [False, True])
+def test_embedding_layer_norm(device, dropout, token_type):
+    if device == "cuda" and not raf.build.with_cuda():
+        pytest.skip("CUDA is not enabled")
+    batch, seq, hidden = 4, 6, 32
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, word, word_ids, pos, pos_ids, token, token_ids, scale, bias):
+            x = raf.add(raf.embedding(word, word_ids), raf.embedding(pos, pos_ids))
+            if token_type:
+                x = raf.add(x, raf.embedding(token, token_ids))
+            x = raf.layer_norm(x, scale, bias)
+            if dropout:
+                x = raf._op.sym._contrib_dropout(x, p=0.1)[0]
+            return x
+
+    model = Model()
+    args = [
+        randn((50, hidden), device=device)[0],
+        randint((batch, seq), high=50, device=device)[0],
+        randn((seq, hidden), device=device)[0],
+        # The position ids are broadcast to those of the words.
+        randint((1, seq), high=seq, device=device)[0],
+        randn((2, hidden), device=device)[0],
+        randint((batch, seq), high=2, device=device)[0],
+    ]
+    args += [randn((hidden,), device=device)[0] for _ in range(2)]
+    mod = model._internal(*args).mod
+    mod = InferType()(simplify(mod, device))
+    text = raf.ir.AsText(mod["main"])
+    # The fused op is only available on CUDA.
+    assert ("raf.op.embedding_layer_norm" in text) == (device == "cuda"), text
+    if device == "cuda":
+        assert "raf.op.layer_norm(" not in text and "raf.op.add(" not in text, text
+        assert "raf.op.embedding(" not in text and "raf.op.add_dropout" not in text, text
+        assert "raf.op._contrib_dropout" not in text, text
+
+
+@pytest.mark.parametrize("op", ["dense", "matmul"])
+def test_merge_parallel_matmul(op):
+    device = "cpu"
+    hidden, heads = 16, 2
+
+    class Model(raf.Model):
+        # pylint: disable=attribute-defined-outside-init
+        def build(self):
+            weights = [randn((hidden, hidden), device=device)[0] for _ in range(3)]
+            self.wq, self.wk, self.wv = weights
+
+        @raf.model.trace
+        def forward(self, x):
+            outs = []
+            for weight in [self.wq, self.wk, self.wv]:
+                y = getattr(raf, op)(x, weight)
+                y = raf.reshape(y, (4, 8, heads, hidden // heads))
+                outs.append(raf.transpose(y, (0, 2, 1, 3)))
+            return raf.add(raf.add(outs[0], outs[1]), outs[2])
+
+    model = Model()
+    model.infer_mode()
+    m_x, _ = randn((32, hidden), device=device)
+    func = model._internal(m_x).mod["main"]
+    params = [model.wq, model.wk, model.wv]
+    handles = [m_x._ndarray__handle] + [param._ndarray__handle for param in params]
+    mod = raf._core.module.IRModule.from_expr(raf._ffi.pass_.BindParam(func, handles))
+    text = raf.ir.AsText(simplify(mod, device)["main"])
+    # The weights are concatenated at compile time, and the matmul is sliced for each.
+    assert text.count("raf.op.%s(" % op) == 1, text
+    assert text.count("raf.op.strided_slice(") == 3, text
+    assert "raf.op.concatenate" not in text, text
+
+    m_y = get_vm_executor(mod, device)(m_x)
+    check(m_y, model(m_x), rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize("trans_a", [False, True])
+@pytest.mark.parametrize("trans_b", [False, True])
+def test_matmul_transpose(trans_a, trans_b):
+    device = "cpu"
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, a, b):
+            if trans_a:
+                a = raf.transpose(a, (0, 2, 1))
+            if trans_b:
+                b = raf.transpose(b, (0, 2, 1))
+            return raf.batch_matmul(a, b)
+
+    model = Model()
+    m_a, n_a = randn((2, 4, 8) if trans_a else (2, 8, 4), device=device)
+    m_b, n_b = randn((2, 6, 4) if trans_b else (2, 4, 6), device=device)
+    mod = simplify(model._internal(m_a, m_b).mod, device)
+    text = raf.ir.AsText(mod["main"])
+    assert "raf.op.transpose" not in text, text
+    suffix = "_" + ("t" if trans_a else "n") + ("t" if trans_b else "n")
+    suffix = suffix if trans_a or trans_b else ""
+    assert "raf.op.batch_matmul%s(" % suffix in text, text
+    n_a = np.transpose(n_a, (0, 2, 1)) if trans_a else n_a
+    n_b = np.transpose(n_b, (0, 2, 1)) if trans_b else n_b
+    check(run_vm_model(model, device, [m_a, m_b]), np.matmul(n_a, n_b), rtol=1e-4, atol=1e-4)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,70 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+import tvm
+import raf
+from raf._ffi.pass_ import FromRelay, InferType, LiftBranchBody, SpeculateIf, ToANormalForm
+from raf.ir import ScopeBuilder
+from tvm import relay
+
+
+def get_mod(lift=False, num_ops=1):
+    sb = ScopeBuilder()
+    mod = tvm.IRModule()
+    p = relay.var("p", shape=(), dtype="float32")
+    x = relay.var("x", shape=(1, 100), dtype="float32")
+    then_branch = x
+    for _ in range(num_ops):
+        then_branch = relay.tanh(then_branch)
+    with sb.if_scope(relay.greater(p, relay.const(0.0))):
+        sb.ret(relay.Tuple([then_branch, x]))
+    with sb.else_scope():
+        sb.ret(relay.Tuple([relay.sigmoid(x), relay.sigmoid(x)]))
+    mod["main"] = relay.Function([p, x], sb.get())
+    mod = relay.transform.InferType()(mod)
+    mod = InferType()(FromRelay()(mod))
+    if lift:
+        mod = InferType()(LiftBranchBody()(mod))
+    return ToANormalForm()(mod)
+
+
+@pytest.mark.parametrize("lift", [False, True])
+def test_small_branches(lift):
+    mod = SpeculateIf(4)(get_mod(lift))
+    text = raf.ir.AsText(mod["main"])
+    assert " if (" not in text, text
+    assert text.count("raf.op.where") == 2, text
+    assert mod["main"].checked_type.ret_type == relay.TupleType(
+        [relay.TensorType((1, 100)), relay.TensorType((1, 100))]
+    )
+
+
+def test_large_branches():
+    mod = SpeculateIf(4)(get_mod(num_ops=4))
+    text = raf.ir.AsText(mod["main"])
+    assert " if (" in text and "raf.op.where" not in text, text
+
+
+def test_recursive_loop():
+    loop = relay.GlobalVar("loop")
+    sb = ScopeBuilder()
+    mod = tvm.IRModule()
+    ti32 = relay.scalar_type("int32")
+    n = relay.var("n", ti32)
+    x = relay.var("x", shape=(1, 100), dtype="float32")
+    with sb.if_scope(relay.equal(n, relay.const(0, ti32))):
+        sb.ret(x)
+    with sb.else_scope():
+        sb.ret(loop(relay.subtract(n, relay.const(1, ti32)), relay.tanh(x)))
+    mod[loop] = relay.Function([n, x], sb.get())
+    mod = relay.transform.InferType()(mod)
+    mod = ToANormalForm()(InferType()(LiftBranchBody()(InferType()(FromRelay()(mod)))))
+    mod = SpeculateIf(16)(mod)
+    # The loop calls itself in a branch, which is never speculated.
+    text = raf.ir.AsText(mod["loop"])
+    assert " if (" in text and "raf.op.where" not in text, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -2,6 +2,7 @@
 # SPDX-License-Identifier: Apache-2.0
 
 # pylint: disable=no-self-use, protected-access, unused-variable, too-many-locals, too-many-statements
+import os
 import pytest
 import raf
 from raf.testing import randn
@@ -215,5 +216,63 @@ def test_ios_schedule_stacked_blocks():
     verify_schedule(mod)
 
 
+class BranchModel(raf.Model):
+    """Three independent chains of atan with lengths 1, 2 and 3."""
+
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x):
+        p_0 = raf.atan(x)
+        p_1 = raf.atan(raf.atan(x))
+        p_2 = raf.atan(raf.atan(raf.atan(x)))
+        return raf.concatenate([p_0, p_1, p_2])
+
+
+def ios_schedule(config):
+    x, _ = randn([2, 2])
+    mod = BranchModel()._internal(x).mod
+    config = {
+        "raf.stream_schedule.ios.search_group_combination": False,
+        "raf.stream_schedule.ios.warmup": 1,
+        "raf.stream_schedule.ios.number": 2,
+        "raf.stream_schedule.ios.repeat": 2,
+        "raf.stream_schedule.ios.verbose": False,
+        **config,
+    }
+    with raf.ir.PassContext(config=config):
+        mod = raf._ffi.pass_.ToGraphNormalForm()(mod)
+        mod = raf._ffi.pass_.ToBasicBlockNormalForm()(mod)
+        mod = raf._ffi.pass_.FuseDialect()(mod)
+        mod = raf._ffi.pass_.FuseTVM()(mod)
+        mod = raf._ffi.pass_.DispatchDialect()(mod)
+        mod = raf._ffi.pass_.EraseType()(mod)
+        mod = raf._ffi.pass_.InferType()(mod)
+        mod = raf._ffi.pass_.IOSStreamSchedule()(mod)
+    verify_schedule(mod)
+    return mod
+
+
+def test_ios_schedule_analytical():
+    # The analytical cost model estimates the stage latency from FLOPS without profiling.
+    mod = ios_schedule({"raf.stream_schedule.ios.profile": False})
+    assert "raf.op.set_stream" in raf.ir.AsText(mod["main"])
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_ios_schedule_persist_cache(tmp_path):
+    raf._ffi.cache.SetPersistCacheRoot(str(tmp_path))
+    try:
+        mod = ios_schedule({})
+        # The profiled stage latencies are persisted and reused by the next compilation.
+        assert os.listdir(os.path.join(str(tmp_path), "ios_stage_latency"))
+        text, cached_text = raf.ir.AsText(mod["main"]), raf.ir.AsText(ios_schedule({})["main"])
+        for op in ["raf.op.set_stream", "raf.op.stream_barrier"]:
+            assert text.count(op) == cached_text.count(op), cached_text
+    finally:
+        raf._ffi.cache.SetPersistCacheRoot("")
+
+
 if __name__ == "__main__":
     pytest.main([__file__, "-s"])
@@ -0,0 +1,73 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import re
+import pytest
+import raf
+from raf.testing import randn
+from raf.ir.pass_manager import RAFSequential
+from raf._ffi.pass_ import ToGraphNormalForm, InferType, MemoryAwareStreamSchedule
+
+
+class Model(raf.Model):
+    """
+     ┌───────x──────┐
+     │       │      │
+     ▼       ▼      ▼
+    atan0  atan1  atan2
+     │       │      │
+     │       ▼      ▼
+     │     atan3  atan4
+     │       │      │
+     │       │      ▼
+     └───┐   │    atan5
+         │   │   ┌───
+         ▼   ▼   ▼
+        concatenate
+    """
+
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, x):
+        p_0 = raf.atan(x)
+        p_1 = raf.atan(x)
+        p_1 = raf.atan(p_1)
+        p_2 = raf.atan(x)
+        p_2 = raf.atan(p_2)
+        p_2 = raf.atan(p_2)
+        return raf.concatenate([p_0, p_1, p_2])
+
+
+def schedule(budget):
+    x, _ = randn([256, 1024])  # 1 MB
+    mod = Model()._internal(x).mod
+    with raf.ir.PassContext(config={"raf.memory_budget": budget}):
+        mod = RAFSequential([InferType(), ToGraphNormalForm(), MemoryAwareStreamSchedule()])(mod)
+    text = raf.ir.AsText(mod["main"])
+    streams = set(re.findall(r"set_stream\(int64\(0\), int64\((\d+)\)\)", text))
+    return text, streams
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_unlimited_budget():
+    text, streams = schedule(0)
+    # Each branch is launched on its own stream.
+    assert streams == {"1", "2", "3"}, text
+    assert text.count("raf.op.add_event") == 2, text
+    assert text.count("raf.op.atan") == 6, text
+
+
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_tight_budget():
+    text, streams = schedule(1)
+    # All branches are serialized on one stream when nothing fits into the budget.
+    assert streams == {"1"}, text
+    assert "raf.op.add_event" not in text, text
+    assert text.count("raf.op.atan") == 6, text
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -3,11 +3,12 @@
 
 # pylint: disable=no-self-use, protected-access, unused-variable, too-many-locals, too-many-statements
 from typing import Dict, List
+import numpy as np
 import pytest
 import tvm
 import tvm.relay
 import raf
-from raf.testing import randn
+from raf.testing import check, randn, run_vm_model
 from raf.ir.pass_manager import RAFSequential
 from raf._ffi.pass_ import ToGraphNormalForm, WavefrontStreamSchedule
 from raf._core.ir_ext import extended_var
@@ -319,5 +320,65 @@ def test_wavefront_schedule_stacked_blocks():
     assert tvm.ir.structural_equal(mod["main"], expected())
 
 
+@pytest.mark.skipif(not raf.build.with_cuda(), reason="CUDA is not enabled")
+def test_wavefront_schedule_priority():
+    class Model(raf.Model):
+        # wave 1 in the order of criticality
+        #   chain 1: op 4, op 5, op 6 (high-priority stream 1)
+        #   chain 2: op 2, op 3 (stream 2)
+        #   chain 3: op 1 (stream 3)
+        # wave 2
+        #   chain 1: op 7 (high-priority stream 1)
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            p_0 = raf.atan(x)  # op 1
+
+            p_1 = raf.atan(x)  # op 2
+            p_1 = raf.atan(p_1)  # op 3
+
+            p_2 = raf.atan(x)  # op 4
+            p_2 = raf.atan(p_2)  # op 5
+            p_2 = raf.atan(p_2)  # op 6
+            return raf.concatenate([p_0, p_1, p_2])  # op 7
+
+    model = Model()
+    m_x, n_x = randn([2, 2], device="cuda")
+    mod = model._internal(m_x).mod
+    config = {
+        "raf.stream_schedule.policy": "wavefront",
+        "raf.stream_schedule.wavefront.priority": True,
+    }
+    with raf.ir.PassContext(opt_level=2, config=config):
+        mod = RAFSequential([ToGraphNormalForm(), WavefrontStreamSchedule()])(mod)
+
+    text = raf.ir.AsText(mod["main"])
+    calls = [line.split("= raf.op.")[1] for line in text.splitlines() if "= raf.op." in line]
+    # Keep the stream ops and the names of the other ops.
+    calls = [call if "stream" in call else call.split("(")[0] for call in calls]
+    assert calls == [
+        "set_stream(int64(0), int64(1), int64(1));",
+        "atan",
+        "atan",
+        "atan",
+        "set_stream(int64(0), int64(2));",
+        "atan",
+        "atan",
+        "set_stream(int64(0), int64(3));",
+        "atan",
+        "stream_barrier();",
+        "set_stream(int64(0), int64(1), int64(1));",
+        "concatenate",
+    ], text
+
+    n_atan = np.arctan
+    n_y = np.concatenate([n_atan(n_x), n_atan(n_atan(n_x)), n_atan(n_atan(n_atan(n_x)))])
+    with raf.ir.PassContext(config=config):
+        m_y = run_vm_model(model, "cuda", [m_x])
+    check(m_y, n_y)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,86 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access, too-many-locals
+import numpy as np
+import pytest
+import raf
+from raf._ffi.pass_ import ViewPropagation, ToGraphNormalForm, InferType
+from raf.ir import RAFSequential
+from raf.testing import check, randn, run_vm_model
+
+
+def propagate(mod):
+    seq = RAFSequential([ToGraphNormalForm(), InferType(), ViewPropagation()])
+    return seq(mod)
+
+
+def test_split():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            y = raf.split(x, 2, axis=1)
+            return raf.add(y[0], y[1])
+
+    model = Model()
+    m_x, n_x = randn((1, 8, 16), device="cpu")
+    text = raf.ir.AsText(propagate(model._internal(m_x).mod)["main"])
+    assert "raf.op.split" not in text and "raf.op.view" in text, text
+    n_y = np.split(n_x, 2, axis=1)
+    check(run_vm_model(model, "cpu", [m_x]), n_y[0] + n_y[1])
+
+
+@pytest.mark.parametrize(
+    "params",
+    [
+        # The rows of a matrix are contiguous.
+        ((4, 16), [1, 0], [3, 16], True),
+        # The columns are not.
+        ((4, 16), [0, 0], [4, 8], False),
+        # The chunk after the unit dims is contiguous.
+        ((1, 4, 16), [0, -2, 0], [1, 4, 16], True),
+    ],
+)
+def test_strided_slice(params):
+    shape, begin, end, is_view = params
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.strided_slice(x, begin, end)
+
+    model = Model()
+    m_x, n_x = randn(shape, device="cpu")
+    text = raf.ir.AsText(propagate(model._internal(m_x).mod)["main"])
+    assert ("raf.op.view" in text) == is_view, text
+    n_y = n_x[tuple(slice(b, e) for b, e in zip(begin, end))]
+    check(run_vm_model(model, "cpu", [m_x]), n_y)
+
+
+@pytest.mark.parametrize("params", [((2, 1, 8), (1, 0, 2), True), ((2, 3, 8), (1, 0, 2), False)])
+def test_transpose(params):
+    shape, axes, is_reshape = params
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.transpose(x, axes)
+
+    model = Model()
+    m_x, n_x = randn(shape, device="cpu")
+    text = raf.ir.AsText(propagate(model._internal(m_x).mod)["main"])
+    assert ("raf.op.reshape" in text) == is_reshape, text
+    check(run_vm_model(model, "cpu", [m_x]), np.transpose(n_x, axes))
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
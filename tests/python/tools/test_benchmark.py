@@ -0,0 +1,45 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import json
+import os
+import tempfile
+
+import pytest
+from raf.testing import benchmark
+from raf.testing.benchmark import BenchmarkConfig
+
+
+@pytest.mark.parametrize("train", [False, True])
+def test_run_suite(train):
+    config = BenchmarkConfig("mlp", batch_size=4, train=train, device="cpu")
+    with tempfile.TemporaryDirectory() as temp_dir:
+        path = os.path.join(temp_dir, "bench.json")
+        suite = benchmark.run_suite([config], output=path, warmup=1, number=5)
+        with open(path, "r") as in_file:
+            assert json.load(in_file)["results"] == suite["results"]
+    result = suite["results"][0]
+    assert "error" not in result, result["error"]
+    assert result["name"] == config.name
+    assert result["throughput"] > 0
+    assert result["latency_p50_ms"] <= result["latency_p99_ms"]
+    assert result["compile_s"] > 0
+    assert "mlp" in benchmark.report(suite)
+
+
+def test_compare():
+    base = {"name": "m", "throughput": 100.0, "latency_p50_ms": 10.0, "peak_memory_mb": 50.0}
+    curr = {"name": "m", "throughput": 90.0, "latency_p50_ms": 10.2, "peak_memory_mb": 40.0}
+    other = {"name": "n", "throughput": 1.0, "latency_p50_ms": 1.0, "peak_memory_mb": 1.0}
+    metrics = ["throughput", "latency_p50_ms", "peak_memory_mb"]
+    ret = benchmark.compare([curr, other], {"results": [base]}, 0.05, metrics)
+    regressions = {c["metric"]: c["regression"] for c in ret}
+    # The throughput drops by 10%, the latency grows by 2%, and the memory drops.
+    assert regressions == {"throughput": True, "latency_p50_ms": False, "peak_memory_mb": False}
+    assert all(c["name"] == "m" for c in ret)
+    suite = {"results": [], "comparisons": ret}
+    assert "1 regression(s)" in benchmark.report(suite)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
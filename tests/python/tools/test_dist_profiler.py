@@ -0,0 +1,79 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import os
+import tempfile
+
+import pytest
+
+from raf.utils import dist_profiler, trace_analysis
+
+
+def make_trace(events):
+    """The B/E pairs of raf.utils.profiler.get() for (name, stream, start, end)."""
+    trace = []
+    for name, stream, start, end in events:
+        for phase, ts in (("B", start), ("E", end)):
+            trace.append({"name": name, "cat": stream, "ph": phase, "ts": ts, "tid": stream})
+    return {"traceEvents": trace}
+
+
+def make_rank_traces(directory):
+    # The clock of rank 1 is 1000us ahead of rank 0, and its matmul is 3x slower, so rank 0 waits
+    # in the allreduce.
+    rank0 = make_trace(
+        [
+            ("raf_op_cublas_matmul", "Default Stream", 0, 10),
+            ("raf_op_nccl__allreduce", "Default Stream", 10, 40),
+            ("raf_op_tvm_relu", "Default Stream", 40, 45),
+            ("raf_op_nccl__allreduce_1", "Default Stream", 45, 50),
+            ("VM", "VMInstruction", 0, 50),
+        ]
+    )
+    rank1 = make_trace(
+        [
+            ("raf_op_cublas_matmul", "Default Stream", 1000, 1030),
+            ("raf_op_nccl__allreduce", "Default Stream", 1030, 1040),
+            ("raf_op_tvm_relu", "Default Stream", 1040, 1044),
+            ("raf_op_nccl__allreduce_1", "Default Stream", 1044, 1050),
+        ]
+    )
+    dist_profiler.dump_rank_trace(directory, rank0, rank=0, offset_us=0)
+    dist_profiler.dump_rank_trace(directory, rank1, rank=1, offset_us=1000)
+
+
+def test_merge_traces():
+    with tempfile.TemporaryDirectory() as directory:
+        make_rank_traces(directory)
+        path = os.path.join(directory, "merged.json")
+        merged = dist_profiler.merge_traces(directory, path)
+        assert os.path.exists(path)
+    names = [e["args"]["name"] for e in merged["traceEvents"] if e["name"] == "process_name"]
+    assert names == ["Rank 0", "Rank 1"]
+    rank1 = [e for e in merged["traceEvents"] if e["pid"] == 1 and e.get("ph") != "M"]
+    events = trace_analysis.load_events({"traceEvents": rank1})
+    assert (events[0].start, events[0].end) == (0, 30)
+
+
+def test_straggler_report():
+    with tempfile.TemporaryDirectory() as directory:
+        make_rank_traces(directory)
+        ret = dist_profiler.straggler_report(directory)
+    assert len(ret.collectives) == 2
+    first = ret.collectives[0]
+    assert first["collective"] == "_allreduce" and first["index"] == 0
+    assert first["straggler"] == 1
+    assert first["skew"] == 20 and first["wait"] == 20
+    assert first["delaying_op"] == "matmul"
+    assert first["delaying_op_us"] == 30 and first["delaying_op_median_us"] == 10
+    # Rank 0 is 1us late to the second allreduce after relu.
+    second = ret.collectives[1]
+    assert second["straggler"] == 0 and second["skew"] == 1
+    assert second["delaying_op"] == "relu"
+    assert ret.rank_delay == {1: 20, 0: 1}
+    assert ret.op_delay == {"matmul": 20, "relu": 1}
+    assert "rank 1: caused 20.0" in ret.report()
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
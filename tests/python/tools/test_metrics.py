@@ -0,0 +1,57 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+
+import raf
+from raf._op import sym
+from raf.utils import metrics
+from raf.testing import randn, run_vm_model
+
+
+class TestMatmul(raf.Model):
+    def build(self):
+        pass
+
+    @raf.model.trace
+    def forward(self, m_a, m_b):  # pylint: disable=no-self-use
+        return sym.relu(sym.matmul(m_a, m_b))
+
+
+def test_metrics(tmp_path):
+    m_x, _ = randn((4, 8))
+    m_y, _ = randn((8, 4))
+    model = TestMatmul()
+    metrics.reset()
+    steps = []
+    metrics.register_callback(steps.append)
+    try:
+        for _ in range(3):
+            run_vm_model(model, "cpu", [m_x, m_y])
+    finally:
+        metrics.clear_callbacks()
+    assert len(steps) == 3
+
+    values = metrics.get()
+    assert values["raf_vm_run_seconds_count"] == 3
+    assert values["raf_vm_run_seconds_sum"] >= values["raf_vm_run_seconds_max"] > 0
+    assert values["raf_vm_op_launches_total"] >= 3
+    assert values['raf_vm_op_env_cache_total{result="miss"}'] >= 1
+    assert values['raf_memory_alloc_bytes_total{device="cpu(0)"}'] > 0
+    # The callback sees the metrics at the end of its step.
+    assert [step["raf_vm_run_seconds_count"] for step in steps] == [1, 2, 3]
+
+    path = str(tmp_path / "metrics.prom")
+    text = metrics.dump_prometheus(path)
+    with open(path, "r") as f:  # pylint: disable=invalid-name
+        assert f.read() == text
+    assert "# TYPE raf_vm_op_launches_total counter\n" in text
+    assert "# TYPE raf_vm_run_seconds_max gauge\n" in text
+    assert text.count("# TYPE raf_vm_op_env_cache_total ") == 1
+
+    metrics.reset()
+    assert metrics.get()["raf_vm_run_seconds_count"] == 0
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -6,6 +6,8 @@ import pytest
 
 import raf
 from raf._ffi.op_profiler import Profile, ProfileGroup, ResetCache, GetCacheSize
+from raf._ffi.op_profiler import ProfileRoofline
+from raf.utils import roofline
 from raf.testing import get_testable_devices, run_infer_type, randn
 
 
@@ -151,6 +153,45 @@ def test_default_stream():
     ProfileGroup([expr, expr], device, [-1, -1], 2, 1, 5)
     assert GetCacheSize(device) == 1
 
+def test_roofline():
+    device = raf.Device("cpu")
+    x = raf.ir.var("x", shape=(64, 64))
+    y = raf.ir.var("y", shape=(64, 64))
+    matmul = run_infer_type(raf.ir.op.matmul(x, y)).body
+    relu = run_infer_type(raf.ir.op.relu(x)).body
+
+    # A roofline whose ridge point is 10 FLOP/byte.
+    roofline.set_device_peak(device, 100.0, 10.0)
+    ResetCache(device)
+    res = ProfileRoofline(matmul, device, 1, 1, 1)
+    # 64^3 FMAs over the 3 * 64 * 64 floats of the inputs and the output.
+    assert res["gflop"].value == pytest.approx(2 * 64**3 / 1e9, rel=0.01)
+    assert res["bytes"].value == 3 * 64 * 64 * 4
+    assert res["bound"] == "compute"
+    assert res["roofline_latency"].value == pytest.approx(2 * 64**3 / 1e9 / 100.0 * 1e6, rel=0.01)
+    assert 0 < res["efficiency"].value <= 1
+    res = ProfileRoofline(relu, device, 1, 1, 1)
+    assert res["bound"] == "memory"
+    assert res["roofline_latency"].value == pytest.approx(2 * 64 * 64 * 4 / 10e3)
+
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, m_a, m_b):
+            return raf.relu(raf.matmul(m_a, m_b))
+
+    m_a, _ = randn((64, 64))
+    m_b, _ = randn((64, 64))
+    mod = Model()._internal(m_a, m_b).mod
+    entries = roofline.profile(mod, device, 1, 1, 1)
+    assert sorted(item["op"] for item in entries) == ["raf.op.matmul", "raf.op.relu"]
+    assert all(entries[i]["gap"] >= entries[i + 1]["gap"] for i in range(len(entries) - 1))
+    text = roofline.report(mod, "cpu", top=1, warmup=1, number=1, repeat=1)
+    assert "100.0 GFLOP/s, 10.0 GB/s" in text
+    assert len(text.splitlines()) == 4
+
 
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -1,13 +1,15 @@
 # Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
 # SPDX-License-Identifier: Apache-2.0
 
+import json
+
 import pytest
 import numpy as np
 
 import raf
 from raf._op import sym
 from raf.utils import profiler
-from raf.testing import randn
+from raf.testing import randn, run_vm_model
 
 
 class TestNet(raf.Model):
@@ -105,5 +107,60 @@ def test_profiler_without_cuda(i):
     assert len(data["traceEvents"]) == 0
 
 
+def test_profiler_dump_trace(tmp_path):
+    profiler.clear()
+    profiler.start()
+    m_x, _ = randn((4, 8))
+    m_y, _ = randn((8, 4))
+    model = TestCuda()
+    for _ in range(3):
+        model(m_x, m_y)
+    profiler.stop()
+    # Reading the events does not drop them.
+    data = profiler.get()
+    assert len(profiler.get()["traceEvents"]) == len(data["traceEvents"])
+
+    path = str(tmp_path / "trace.json")
+    profiler.dump_trace(path)
+    with open(path, "r") as f:  # pylint: disable=invalid-name
+        trace = json.load(f)
+    events = [e for e in trace["traceEvents"] if e["ph"] == "X"]
+    assert len([e for e in events if e["name"] == "raf.op.matmul"]) >= 3
+    assert all(e["dur"] >= 0 for e in events)
+    threads = {e["tid"] for e in trace["traceEvents"] if e["ph"] == "M"}
+    assert {e["tid"] for e in events} <= threads
+    assert trace["otherData"]["dropped_events"] == 0
+    profiler.clear()
+    assert len(profiler.get()["traceEvents"]) == 0
+
+
+@pytest.mark.skipif(not raf.build.with_cupti(), reason="CUPTI is not enabled")
+def test_profiler_cupti(tmp_path):
+    device = "cuda"
+    m_x, _ = randn((64, 128), device=device)
+    m_y, _ = randn((128, 64), device=device)
+    model = TestCuda()
+    model.to(device=device)
+    profiler.clear()
+    profiler.start(cupti=True)
+    run_vm_model(model, device, [m_x, m_y])
+    profiler.stop()
+    path = str(tmp_path / "trace.json")
+    profiler.dump_trace(path)
+    profiler.clear()
+    with open(path, "r") as f:  # pylint: disable=invalid-name
+        trace = json.load(f)
+    tracks = {e["tid"]: e["args"]["name"] for e in trace["traceEvents"] if e["ph"] == "M"}
+    events = [e for e in trace["traceEvents"] if e["ph"] == "X"]
+    dispatches = [e for e in events if e["cat"] == "HostDispatch"]
+    assert any("matmul" in e["name"] for e in dispatches)
+    kernels = [e for e in events if e["cat"] == "CUPTI Kernel"]
+    assert kernels
+    # The kernels are on the tracks of their streams, and attributed to their VM instructions.
+    assert all(tracks[e["tid"]].startswith("GPU ") for e in kernels)
+    matmul = [e for e in kernels if "matmul" in e.get("args", {}).get("args_string", "")]
+    assert matmul and all("pc: " in e["args"]["args_string"] for e in matmul)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
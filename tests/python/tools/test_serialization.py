@@ -37,6 +37,26 @@ def test_ext_constant():
     check(out_origin, out_loaded)
 
 
+def test_binary(tmp_path):
+    x_const, _ = randn((1, 3, 8, 8), device="cpu")
+    x_value = raf._core.value.TensorValue.from_numpy(x_const.numpy())
+    x = raf._ffi.ir._make.Constant(x_value)
+    # The constant used twice is saved once.
+    pooled = raf.ir.op.max_pool2d(raf.ir.op.add(x, x), 3, 1, 0)
+    ovar = extended_var("out")
+    func_origin = relay.Function([], relay.Let(ovar, pooled, ovar))
+    mod_origin = IRModule.from_expr(func_origin)
+    out_origin = _unwrap(RunModel(mod_origin, []))
+
+    path = str(tmp_path / "func.bin")
+    raf.ir.save_binary(mod_origin, path)
+    mod_loaded = raf.ir.load_binary(path)
+    out_loaded = _unwrap(RunModel(mod_loaded, []))
+
+    assert tvm.ir.structural_equal(mod_loaded, mod_origin)
+    check(out_origin, out_loaded)
+
+
 def test_tuple_ext_constant():
     def expected():
         x_const, _ = randn((1, 3, 8, 8), device="cpu")
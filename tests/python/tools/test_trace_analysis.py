@@ -0,0 +1,111 @@
+# Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+# pylint: disable=protected-access
+import pytest
+
+import raf
+from raf._ffi.pass_ import ToGraphNormalForm
+from raf.testing import randn
+from raf.utils import profiler, trace_analysis
+
+
+def make_trace(events):
+    """The B/E pairs of raf.utils.profiler.get() for (name, stream, start, end)."""
+    trace = []
+    for name, stream, start, end in events:
+        for phase, ts in (("B", start), ("E", end)):
+            trace.append({"name": name, "cat": stream, "ph": phase, "ts": ts, "tid": stream})
+    return {"traceEvents": trace}
+
+
+def test_normalize_op_name():
+    assert trace_analysis.normalize_op_name("raf_op_cublas_matmul_2") == "matmul"
+    assert trace_analysis.normalize_op_name("raf_op_nccl__allreduce") == "_allreduce"
+    assert trace_analysis.normalize_op_name("raf.op.atan") == "atan"
+
+
+def test_stream_utilization_and_gaps():
+    trace = make_trace(
+        [
+            ("raf_op_tvm_atan", "Default Stream", 0, 10),
+            ("raf_op_nccl__allreduce", "Stream 1", 5, 30),
+            ("raf_op_tvm_atan_1", "Default Stream", 40, 50),
+            ("VM", "VMInstruction", 0, 50),
+        ]
+    )
+    ret = trace_analysis.analyze(trace)
+    assert ret.makespan == 50
+    assert ret.streams["Default Stream"]["busy"] == 20
+    assert ret.streams["Stream 1"]["utilization"] == 0.5
+    assert "VMInstruction" not in ret.streams
+    assert ret.communication == 25
+    assert ret.exposed_communication == 20
+    assert ret.host_bound == 10
+    assert ret.host_gaps == [(30.0, 40.0, "raf_op_tvm_atan_1")]
+    # Without the dependencies, the critical path follows the last stream.
+    assert [e.name for e in ret.critical_path] == ["raf_op_tvm_atan", "raf_op_tvm_atan_1"]
+    assert ret.critical_path_wait == 30
+    assert ret.opportunities[0][0] == 20
+    assert "Makespan: 0.050 ms" in ret.report()
+
+
+def test_dependencies_from_expr():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            p_0 = raf.atan(x)
+            p_1 = raf.cos(x)
+            p_1 = raf.sin(p_1)
+            return raf.add(p_0, p_1)
+
+    x, _ = randn([2, 2])
+    mod = ToGraphNormalForm()(Model()._internal(x).mod)
+    # The four independent-ish ops run serially on the default stream.
+    trace = make_trace(
+        [
+            ("raf_op_tvm_atan", "Default Stream", 0, 40),
+            ("raf_op_tvm_cos", "Default Stream", 40, 50),
+            ("raf_op_tvm_sin", "Default Stream", 50, 60),
+            ("raf_op_tvm_add", "Default Stream", 60, 70),
+        ]
+    )
+    events = trace_analysis.load_events(trace)
+    deps = trace_analysis.dependencies_from_expr(mod["main"].body, events)
+    assert deps == {0: set(), 1: set(), 2: {1}, 3: {0, 2}}
+    ret = trace_analysis.analyze(trace, expr=mod["main"].body)
+    # atan runs in parallel with cos and sin in the ideal schedule.
+    assert ret.dependency_bound == 50
+    assert ret.multi_stream_gain == 20
+    assert ret.schedule_policy == "ios"
+    ret = trace_analysis.analyze(trace, expr=mod["main"].body, ios_gain_ratio=0.5)
+    assert ret.schedule_policy == "wavefront"
+
+
+def test_analyze_profile():
+    class Model(raf.Model):
+        def build(self):
+            pass
+
+        @raf.model.trace
+        def forward(self, x):
+            return raf.cos(raf.atan(x))
+
+    x, _ = randn([2, 2])
+    model = Model()
+    profiler.clear()
+    profiler.start()
+    model(x)
+    profiler.stop()
+    ret = trace_analysis.analyze(profiler.get())
+    profiler.clear()
+    assert ret.makespan > 0
+    assert ret.critical_path
+    assert ret.schedule_policy == "sequential"
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])